@@ -0,0 +1,42 @@
+// Test that applyOps applies runs of operations on one namespace together, including batches of
+// inserts, with the same results as applying them one at a time.
+(function() {
+    "use strict";
+    var t = db.apply_ops_grouped;
+    var other = db.apply_ops_grouped_other;
+    t.drop();
+    other.drop();
+
+    var ops = [];
+    for (var i = 0; i < 10; i++) {
+        ops.push({op: "i", ns: t.getFullName(), o: {_id: i, x: i}});
+    }
+    // A repeated _id ends the batch and is applied as an upsert, as it always has been.
+    ops.push({op: "i", ns: t.getFullName(), o: {_id: 0, x: 100}});
+    ops.push({op: "n", ns: "", o: {}});
+    ops.push({op: "i", ns: other.getFullName(), o: {_id: 1}});
+    ops.push({op: "u", ns: t.getFullName(), o2: {_id: 1}, o: {$set: {x: 101}}});
+    ops.push({op: "d", ns: t.getFullName(), o: {_id: 2}});
+    ops.push({op: "i", ns: t.getFullName(), o: {_id: 20, x: 20}});
+    ops.push({op: "i", ns: t.getFullName(), o: {_id: 21, x: 21}});
+
+    var res = db.adminCommand({applyOps: ops});
+    assert.commandWorked(res);
+    assert.eq(ops.length - 1, res.applied);
+    assert.eq(ops.length - 1, res.results.length);
+    res.results.forEach(function(r) { assert.eq(true, r); });
+
+    assert.eq(11, t.count());
+    assert.eq(100, t.findOne({_id: 0}).x);
+    assert.eq(101, t.findOne({_id: 1}).x);
+    assert.eq(null, t.findOne({_id: 2}));
+    assert.eq(21, t.findOne({_id: 21}).x);
+    assert.eq(1, other.count());
+
+    // Inserting over existing documents still replaces them.
+    res = db.adminCommand({applyOps: [{op: "i", ns: t.getFullName(), o: {_id: 20, y: 1}},
+                                      {op: "i", ns: t.getFullName(), o: {_id: 30, y: 1}}]});
+    assert.commandWorked(res);
+    assert.eq({_id: 20, y: 1}, t.findOne({_id: 20}));
+    assert.eq({_id: 30, y: 1}, t.findOne({_id: 30}));
+}());
@@ -0,0 +1,58 @@
+// Test that large insert batches, whose documents are inserted in groups, report the same results
+// as inserting the documents one at a time, and index every document.
+(function() {
+    "use strict";
+    var t = db.batch_insert_groups;
+
+    function makeDocs(n, dupEvery) {
+        var docs = [];
+        for (var i = 0; i < n; i++) {
+            // Every dupEvery-th document duplicates the unique key of the one before it
+            var key = (dupEvery && i % dupEvery == dupEvery - 1) ? i - 1 : i;
+            docs.push({_id: i, u: key, tags: ["a" + (i % 5), "b" + (i % 3)], s: "x" + (i % 17)});
+        }
+        return docs;
+    }
+
+    function runInsert(docs, ordered) {
+        return db.runCommand({insert: t.getName(), documents: docs, ordered: ordered});
+    }
+
+    t.drop();
+    assert.commandWorked(t.ensureIndex({u: 1}, {unique: true}));
+    assert.commandWorked(t.ensureIndex({tags: 1}));
+    assert.commandWorked(t.ensureIndex({s: -1}));
+
+    // No errors
+    var res = runInsert(makeDocs(1000), true);
+    assert.commandWorked(res);
+    assert.eq(1000, res.n);
+    assert.eq(1000, t.find().hint({u: 1}).itcount());
+    assert.eq(1000, t.find({tags: "a0"}).hint({tags: 1}).itcount()
+                    + t.find({tags: {$in: ["a1", "a2", "a3", "a4"]}}).hint({tags: 1}).itcount());
+    assert.eq(1000, t.find().hint({s: -1}).itcount());
+    assert(t.find({tags: "b1"}).hint({tags: 1}).explain().queryPlanner.winningPlan.inputStage
+            .isMultiKey);
+
+    // Unordered, with duplicates inside groups: every error is reported at its own index
+    t.remove({});
+    res = runInsert(makeDocs(1000, 100), false);
+    assert.eq(990, res.n);
+    assert.eq(10, res.writeErrors.length);
+    for (var i = 0; i < res.writeErrors.length; i++) {
+        assert.eq(100 * i + 99, res.writeErrors[i].index);
+        assert.eq(ErrorCodes.DuplicateKey, res.writeErrors[i].code);
+    }
+    assert.eq(990, t.find().hint({u: 1}).itcount());
+    assert.eq(990, t.find().hint({s: -1}).itcount());
+    assert.eq(990, t.count());
+
+    // Ordered stops at the first error, with everything before it inserted
+    t.remove({});
+    res = runInsert(makeDocs(1000, 150), true);
+    assert.eq(149, res.n);
+    assert.eq(1, res.writeErrors.length);
+    assert.eq(149, res.writeErrors[0].index);
+    assert.eq(149, t.find().hint({s: -1}).itcount());
+    assert.eq(149, t.count());
+})();
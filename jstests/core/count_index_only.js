@@ -0,0 +1,53 @@
+// Test that count and $group over predicates an index answers from its keys do not fetch
+// documents, even when the bounds are not a single interval.
+
+// Include helpers for analyzing explain output.
+load("jstests/libs/analyze_plan.js");
+
+var collName = "jstests_count_index_only";
+var t = db[collName];
+t.drop();
+
+for (var i = 0; i < 100; i++) {
+    assert.writeOK(t.insert({a: i % 5, b: i, s: "str" + i}));
+}
+assert.commandWorked(t.ensureIndex({a: 1, b: 1}));
+assert.commandWorked(t.ensureIndex({a: 1, s: 1}));
+
+function checkIndexOnlyCount(query, hint, nCounted) {
+    assert.eq(nCounted, t.find(query).hint(hint).count());
+
+    var explain = db.runCommand({explain: {count: collName, query: query, hint: hint},
+                                 verbosity: "executionStats"});
+    assert.commandWorked(explain);
+    assert(isIndexOnly(explain.queryPlanner.winningPlan), tojson(explain));
+    assert.eq(0, explain.executionStats.totalDocsExamined, tojson(explain));
+}
+
+// Several intervals on the leading field.
+checkIndexOnlyCount({a: {$in: [1, 3]}, b: {$gte: 50}}, {a: 1, b: 1}, 20);
+
+// A filter applied to the index keys.
+checkIndexOnlyCount({a: 2, s: /7/}, {a: 1, s: 1}, 11);
+
+// Predicates the index can't answer still fetch, and still count correctly.
+var explain = db.runCommand({explain: {count: collName, query: {a: 1, c: null}},
+                             verbosity: "executionStats"});
+assert.commandWorked(explain);
+assert(planHasStage(explain.queryPlanner.winningPlan, "FETCH"), tojson(explain));
+assert.eq(20, t.count({a: 1, c: null}));
+
+// A $match+$group reading only indexed fields is answered from the index keys.
+var pipeline = [{$match: {a: {$gte: 3}}}, {$group: {_id: "$a", total: {$sum: "$b"}}},
+                {$sort: {_id: 1}}];
+var results = t.aggregate(pipeline).toArray();
+assert.eq([{_id: 3, total: 1010}, {_id: 4, total: 1030}], results);
+
+explain = t.aggregate(pipeline, {explain: true});
+var cursorStage = explain.stages[0].$cursor;
+assert(isIndexOnly(cursorStage.queryPlanner.winningPlan), tojson(explain));
+
+// A multikey index can't cover the $group, but the results are the same.
+assert.writeOK(t.insert({a: 5, b: [1, 2]}));
+results = t.aggregate([{$match: {a: 5}}, {$group: {_id: "$a", n: {$sum: 1}}}]).toArray();
+assert.eq([{_id: 5, n: 1}], results);
@@ -0,0 +1,43 @@
+// Tests the order independent dbhash, which hashes documents regardless of their storage order
+// and serves unchanged collections from a cache.
+
+var a = db.dbhash_oi_a;
+var b = db.dbhash_oi_b;
+
+a.drop();
+b.drop();
+
+function oiHash( coll ) {
+    var ret = db.runCommand( { dbhash: 1, orderIndependent: true,
+                               collections: [ coll.getName() ] } );
+    assert.commandWorked( ret, "dbhash failure" );
+    assert( ret.orderIndependent, tojson( ret ) );
+    return ret;
+}
+
+for ( var i = 0; i < 100; i++ ) {
+    a.insert( { _id: i, x: "v" + i } );
+    b.insert( { _id: 99 - i, x: "v" + ( 99 - i ) } );
+}
+
+var ha = oiHash( a );
+var hb = oiHash( b );
+assert.eq( ha.collections[a.getName()], hb.collections[b.getName()], "insertion order matters" );
+
+// An unchanged collection is answered from the cache with the same hash.
+var again = oiHash( a );
+assert.eq( ha.collections[a.getName()], again.collections[a.getName()], "cached hash differs" );
+assert.contains( a.getFullName(), again.fromCache, tojson( again ) );
+
+// A write invalidates the cached hash.
+a.update( { _id: 5 }, { $set: { x: "changed" } } );
+var changed = oiHash( a );
+assert.neq( ha.collections[a.getName()], changed.collections[a.getName()], "write not seen" );
+assert.eq( -1, changed.fromCache.indexOf( a.getFullName() ), tojson( changed ) );
+
+// Undoing the write gives back the original hash.
+a.update( { _id: 5 }, { $set: { x: "v5" } } );
+assert.eq( ha.collections[a.getName()], oiHash( a ).collections[a.getName()], "undo differs" );
+
+a.drop();
+b.drop();
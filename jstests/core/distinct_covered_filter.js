@@ -0,0 +1,23 @@
+// Tests that distinct uses a covered index scan when the query filters on the index keys in a way
+// which rules out skipping from one value to the next.
+
+var t = db.distinct_covered_filter;
+t.drop();
+
+for ( var i = 0; i < 100; i++ ) {
+    t.insert( { a: i % 10, b: "v" + ( i % 4 ) } );
+}
+t.ensureIndex( { a: 1, b: 1 } );
+
+var res = t.runCommand( "distinct", { key: "a", query: { a: { $gte: 0 }, b: /3$/ } } );
+assert.commandWorked( res );
+assert.eq( [ 1, 3, 5, 7, 9 ], res.values.sort() );
+assert.eq( 0, res.stats.nscannedObjects, tojson( res ) );
+
+// Values equal as numbers are one value.
+t.insert( { a: NumberLong( 1 ), b: "v3" } );
+t.insert( { a: 1.0, b: "v3" } );
+res = t.runCommand( "distinct", { key: "a", query: { a: { $gte: 0 }, b: /3$/ } } );
+assert.eq( 5, res.values.length, tojson( res ) );
+
+t.drop();
@@ -0,0 +1,49 @@
+// Test that a $text query sorted by text score with a limit returns the same results as reading
+// every match, while examining fewer index keys.
+(function() {
+    "use strict";
+    var t = db.fts_score_sort_limit;
+    t.drop();
+
+    // "rare" is in a few documents, "common" in all of them, with varying frequency.
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        var words = ["common"];
+        for (var j = 0; j < i % 7; j++) {
+            words.push("common");
+        }
+        if (i % 50 == 0) {
+            words.push("rare rare rare");
+        }
+        words.push("filler" + i);
+        bulk.insert({_id: i, a: words.join(" ")});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({a: "text"}));
+
+    var proj = {score: {$meta: "textScore"}};
+    var sort = {score: {$meta: "textScore"}};
+
+    function scores(cursor) {
+        return cursor.toArray().map(function(doc) { return doc.score; });
+    }
+
+    ["rare common", "common", "rare"].forEach(function(search) {
+        var query = {$text: {$search: search}};
+        var all = scores(t.find(query, proj).sort(sort));
+        assert.eq(all.slice(0, 5), scores(t.find(query, proj).sort(sort).limit(5)), search);
+        assert.eq(all.slice(3, 8), scores(t.find(query, proj).sort(sort).skip(3).limit(5)),
+                  search);
+    });
+
+    var query = {$text: {$search: "rare common"}};
+    var full = t.find(query, proj).sort(sort).explain("executionStats");
+    var limited = t.find(query, proj).sort(sort).limit(5).explain("executionStats");
+    assert.lt(limited.executionStats.totalKeysExamined, full.executionStats.totalKeysExamined,
+              tojson(limited));
+
+    // Phrases are only checked for the returned documents, so they turn the early stop off.
+    var phrase = {$text: {$search: "common \"rare rare\""}};
+    assert.eq(scores(t.find(phrase, proj).sort(sort)).slice(0, 3),
+              scores(t.find(phrase, proj).sort(sort).limit(3)));
+})();
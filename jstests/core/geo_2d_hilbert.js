@@ -0,0 +1,54 @@
+// Test that 2d indexes with Hilbert order keys ({2dIndexVersion: 2}) answer the same queries as
+// the default Z order keys.
+(function() {
+    "use strict";
+    var t = db.geo_2d_hilbert;
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var x = -20; x <= 20; x++) {
+        for (var y = -20; y <= 20; y++) {
+            bulk.insert({loc: [x * 0.5, y * 0.5], x: x});
+        }
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandFailed(t.ensureIndex({loc: "2d"}, {"2dIndexVersion": 3}));
+
+    var queries = [
+        {loc: {$within: {$box: [[-3.2, -1.1], [2.7, 4.4]]}}},
+        {loc: {$within: {$center: [[0.1, -0.3], 3]}}},
+        {loc: {$within: {$polygon: [[-5, -5], [0, 6], [5, -5]]}}},
+        {loc: {$within: {$centerSphere: [[0, 0], 0.05]}}},
+        {loc: {$within: {$box: [[-3, -3], [3, 3]]}}, x: {$gt: 0}}
+    ];
+
+    function idsOf(query, hint) {
+        return t.find(query).hint(hint).toArray().map(function(doc) {
+            return doc._id.str;
+        }).sort();
+    }
+
+    function nearOf(query) {
+        return t.find(query).limit(50).toArray().map(function(doc) {
+            return Math.sqrt(Math.pow(doc.loc[0] - 1.3, 2) + Math.pow(doc.loc[1] + 0.4, 2));
+        });
+    }
+
+    var expected = queries.map(function(query) { return idsOf(query, {$natural: 1}); });
+    var near = {loc: {$near: [1.3, -0.4]}};
+
+    [{}, {"2dIndexVersion": 2}].forEach(function(options) {
+        t.dropIndexes();
+        assert.commandWorked(t.ensureIndex({loc: "2d"}, options));
+        queries.forEach(function(query, i) {
+            assert.eq(expected[i], idsOf(query, {loc: "2d"}), tojson(query) + tojson(options));
+        });
+
+        var distances = nearOf(near);
+        assert.eq(50, distances.length);
+        for (var i = 1; i < distances.length; i++) {
+            assert.lte(distances[i - 1], distances[i], tojson(options));
+        }
+    });
+})();
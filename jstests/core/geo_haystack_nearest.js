@@ -0,0 +1,38 @@
+// Test that geoSearch scans the buckets closest to the search point first, skips buckets that are
+// entirely out of range, and still finds every match when there is no limit.
+(function() {
+    "use strict";
+    var t = db.geo_haystack_nearest;
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var x = -10; x <= 10; x++) {
+        for (var y = -10; y <= 10; y++) {
+            bulk.insert({pos: {long: x, lat: y}, type: (x + y) % 2 == 0 ? "even" : "odd"});
+        }
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({pos: "geoHaystack", type: 1}, {bucketSize: 1}));
+
+    function dist(doc) {
+        return Math.sqrt(Math.pow(doc.pos.long - 0.5, 2) + Math.pow(doc.pos.lat - 0.5, 2));
+    }
+
+    var res = t.runCommand("geoSearch",
+                           {near: [0.5, 0.5], maxDistance: 8, search: {type: "even"}, limit: 2});
+    assert.commandWorked(res);
+    assert.eq(2, res.stats.n);
+    res.results.forEach(function(doc) {
+        assert.lt(dist(doc), 1, tojson(doc));
+    });
+
+    var expected = t.find({type: "odd"}).toArray().filter(function(doc) {
+        return dist(doc) <= 8;
+    }).length;
+    res = t.runCommand("geoSearch",
+                       {near: [0.5, 0.5], maxDistance: 8, search: {type: "odd"}, limit: 1000});
+    assert.commandWorked(res);
+    assert.eq(expected, res.stats.n);
+    // The corners of the square of buckets around the search point are never scanned
+    assert.lt(res.stats.btreeMatches, t.find({type: "odd"}).count());
+})();
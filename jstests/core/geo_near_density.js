@@ -0,0 +1,49 @@
+// Test that $near returns results in distance order when the data density changes sharply
+// between annuli, so that the annulus width has to both grow and shrink during one query.
+(function() {
+    "use strict";
+    var t = db.geo_near_density;
+
+    function checkSorted(indexType, center, distance) {
+        var results = t.find({loc: {$near: center}}).toArray();
+        assert.eq(t.count(), results.length, indexType);
+        for (var i = 1; i < results.length; i++) {
+            assert.lte(distance(center, results[i - 1].loc), distance(center, results[i].loc),
+                       indexType + " " + tojson(results[i]));
+        }
+    }
+
+    function planar(a, b) {
+        return Math.sqrt(Math.pow(a[0] - b[0], 2) + Math.pow(a[1] - b[1], 2));
+    }
+
+    function spherical(a, b) {
+        var toRad = Math.PI / 180;
+        var lat1 = a[1] * toRad, lat2 = b[1] * toRad;
+        var dLng = (b[0] - a[0]) * toRad;
+        var c = Math.sin(lat1) * Math.sin(lat2) + Math.cos(lat1) * Math.cos(lat2) * Math.cos(dLng);
+        return Math.acos(Math.min(1, Math.max(-1, c)));
+    }
+
+    ["2d", "2dsphere"].forEach(function(indexType) {
+        t.drop();
+        var bulk = t.initializeUnorderedBulkOp();
+        // A few sparse points close by, a dense cluster further out, then sparse points again.
+        for (var i = 0; i < 20; i++) {
+            bulk.insert({loc: [i * 0.01, 0]});
+        }
+        for (var i = 0; i < 3000; i++) {
+            bulk.insert({loc: [1 + (i % 60) * 0.001, 1 + Math.floor(i / 60) * 0.001]});
+        }
+        for (var i = 0; i < 50; i++) {
+            bulk.insert({loc: [10 + i, -5]});
+        }
+        assert.writeOK(bulk.execute());
+        var index = {};
+        index.loc = indexType;
+        assert.commandWorked(t.ensureIndex(index));
+
+        checkSorted(indexType, [0, 0], indexType == "2d" ? planar : spherical);
+        checkSorted(indexType, [1.03, 1.02], indexType == "2d" ? planar : spherical);
+    });
+})();
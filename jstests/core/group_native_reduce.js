@@ -0,0 +1,35 @@
+// Tests that group gives the same results for reducers which run without Javascript as for
+// equivalent reducers which can only run in Javascript.
+
+var t = db.group_native_reduce;
+t.drop();
+
+for ( var i = 0; i < 100; i++ ) {
+    t.insert( { a: i % 7, b: ( i % 3 == 0 ) ? "x" : NumberInt( i % 3 ), x: i / 2,
+                y: NumberLong( i ), z: ( i % 5 == 0 ) ? null : true } );
+}
+t.insert( { a: 8 } );
+
+function groupBoth( key, initial, nativeReduce, scriptReduce ) {
+    var native = t.group( { key: key, initial: initial, reduce: nativeReduce } );
+    var script = t.group( { key: key, initial: initial, reduce: scriptReduce } );
+    assert.eq( tojson( script ), tojson( native ) );
+    return native;
+}
+
+groupBoth( { a: 1 }, { count: 0, total: 0 },
+           function( cur, result ) { result.count++; result.total += cur.x; },
+           function( cur, result ) { if ( true ) { result.count++; result.total += cur.x; } } );
+
+groupBoth( { a: 1, b: 1 }, { n: NumberInt( 0 ), s: 1.5, label: "l" },
+           function( doc, out ) { ++out.n; out.s = out.s + doc.y; out.s += doc.z; out.n += 2 },
+           function( doc, out ) { if ( true ) { ++out.n; out.s += doc.y + doc.z; out.n += 2 } } );
+
+// A string midway through moves the groups reduced so far to Javascript.
+t.insert( { a: 1, x: "str" } );
+var res = groupBoth( { a: 1 }, { total: 0 },
+                     function( cur, result ) { result.total += cur.x; },
+                     function( cur, result ) { if ( true ) result.total += cur.x; } );
+assert.eq( 1, res.filter( function( g ) { return typeof g.total == "string"; } ).length );
+
+t.drop();
@@ -0,0 +1,48 @@
+// Hashed indexes with hashVersion 1 (murmur3) alongside the default md5 version 0.
+
+load("jstests/libs/analyze_plan.js");
+
+var t = db.hashindex_version;
+t.drop();
+
+var hash = function(v, hashVersion) {
+    return db.runCommand({_hashBSONElement: v, hashVersion: hashVersion}).out;
+};
+
+// The two versions hash differently but squash numeric types the same way
+assert.neq(hash(42, 0), hash(42, 1));
+assert.eq(hash(42, 1), hash(NumberLong(42), 1));
+assert.eq(hash(NumberInt(42), 1), hash(42.2, 1));
+assert.commandFailed(db.runCommand({_hashBSONElement: 42, hashVersion: 2}));
+
+// Unknown hash versions are rejected at index creation
+assert.commandFailed(t.ensureIndex({a: "hashed"}, {hashVersion: 2}));
+assert.eq(1, t.getIndexes().length);
+
+assert.commandWorked(t.ensureIndex({a: "hashed"}, {hashVersion: 1}));
+assert.eq(2, t.getIndexes().length);
+
+for (var i = 0; i < 20; i++) {
+    t.insert({a: i});
+}
+t.insert({a: 3.1});
+t.insert({b: 1});
+
+// Equality and $in bounds are hashed with the index's version
+assert.eq(1, t.find({a: 3}).hint({a: "hashed"}).itcount());
+assert.eq(3.1, t.find({a: 3.1}).hint({a: "hashed"}).next().a);
+assert.eq(2, t.find({a: {$in: [5, 7]}}).hint({a: "hashed"}).itcount());
+assert.eq(1, t.find({a: null}).hint({a: "hashed"}).itcount());
+assert(isIxscan(t.find({a: 1}).explain().queryPlanner.winningPlan), "not using hashed index");
+
+// Index keys are the version 1 hashes
+var keys = t.find({a: 7}).hint({a: "hashed"}).returnKey().toArray();
+assert.eq([{a: hash(7, 1)}], keys);
+
+// Updates and removes keep the index consistent
+t.update({a: 7}, {$set: {a: 70}});
+assert.eq(0, t.find({a: 7}).hint({a: "hashed"}).itcount());
+assert.eq(1, t.find({a: 70}).hint({a: "hashed"}).itcount());
+t.remove({a: 70});
+assert.eq(0, t.find({a: 70}).hint({a: "hashed"}).itcount());
+assert(t.validate(true).valid);
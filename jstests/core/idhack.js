@@ -80,3 +80,33 @@ assert.eq( { _id: 1 }, t.find( { _id: 1 } )._addSpecial( "$returnKey", true ).ne
 
 // Non-simple: $returnKey overrides other projections.
 assert.eq( { _id: 1 }, t.find( { _id: 1 }, { a: 1 } )._addSpecial( "$returnKey", true ).next() );
+
+//
+// $in on _id is answered by the ID hack as well.
+//
+
+t.drop();
+for ( var i = 0; i < 20; i++ ) {
+    t.insert( { _id: i, a: i } );
+}
+t.insert( { _id: { x: 1 }, a: 100 } );
+
+var inQuery = { _id: { $in: [ 15, 3, { x: 1 }, 7, 3, 99, "3" ] } };
+var inExplain = t.find( inQuery ).explain( true );
+print( "explain for $in query = " + tojson( inExplain ) );
+assert( isIdhack(inExplain.queryPlanner.winningPlan), "H1" );
+assert.eq( 4, inExplain.executionStats.nReturned, "H2" );
+assert.eq( [ 3, 7, 15, { x: 1 } ], t.find( inQuery ).map( function(doc) { return doc._id; } ),
+           "H3" );
+assert.eq( [ { a: 3 }, { a: 7 } ],
+           t.find( { _id: { $in: [ 7, 3 ] } }, { _id: 0, a: 1 } ).toArray(), "H4" );
+assert.eq( 0, t.find( { _id: { $in: [] } } ).itcount(), "H5" );
+
+// Queries that need a plan over the $in results don't use the ID hack.
+assert( !isIdhack(t.find( inQuery ).sort( { a: 1 } ).explain().queryPlanner.winningPlan), "I1" );
+assert( !isIdhack(t.find( { _id: { $in: [ 1, /2/ ] } } ).explain().queryPlanner.winningPlan),
+        "I2" );
+assert( !isIdhack(t.find( { _id: { $in: [ 1, 2 ] }, a: 1 } ).explain().queryPlanner.winningPlan),
+        "I3" );
+assert.eq( [ 1, 2 ], t.find( { _id: { $in: [ 2, 1 ] } } ).sort( { _id: 1 } ).map(
+    function(doc) { return doc._id; } ), "I4" );
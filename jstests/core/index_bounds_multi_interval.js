@@ -0,0 +1,55 @@
+// Check index scans over several intervals of a single field index, and min/max scans, in both
+// directions and on ascending and descending indexes, against a collection scan.
+var t = db.index_bounds_multi_interval;
+t.drop();
+
+var values = [MinKey, -5, -1.5, 0, 1, 1.0, NumberLong(2), 3, 3.5, 4, 10, "", "a", "ab", "b",
+              {}, {x: 1}, [], [1, 5], BinData(0, "AAAA"), ObjectId("000000000000000000000000"),
+              false, true, new Date(0), null, MaxKey];
+for (var i = 0; i < values.length; i++) {
+    for (var j = 0; j < 3; j++) {
+        assert.writeOK(t.insert({a: values[i], i: i, j: j}));
+    }
+}
+assert.writeOK(t.insert({b: 1}));
+
+var queries = [
+    {a: {$in: [-1.5, 1, 3, "ab", true, null]}},
+    {a: {$in: [1, 5, 100]}},
+    {a: {$in: []}},
+    {$or: [{a: {$gt: -2, $lt: 1}}, {a: {$gte: 3, $lte: 4}}, {a: {$gt: "a", $lte: "b"}}]},
+    {$or: [{a: {$gte: 0, $lt: 2}}, {a: {$gt: 3.5}}]},
+    {$or: [{a: {$lt: 0}}, {a: {$gt: 3}}]},
+    {$or: [{a: {$lte: 0}}, {a: 1}, {a: {$gte: 10}}]}
+];
+
+function sortedIds(cursor) {
+    return cursor.map(function(doc) { return tojson(doc._id); }).sort();
+}
+
+[{a: 1}, {a: -1}].forEach(function(keyPattern) {
+    assert.commandWorked(t.ensureIndex(keyPattern));
+    queries.forEach(function(query) {
+        var expected = sortedIds(t.find(query).hint({$natural: 1}));
+        [1, -1].forEach(function(dir) {
+            var actual = sortedIds(t.find(query).hint(keyPattern).sort({a: dir}));
+            assert.eq(expected, actual, tojson({index: keyPattern, query: query, dir: dir}));
+        });
+    });
+
+    // Simple ranges, which include min and exclude max in index order.
+    if (keyPattern.a == 1) {
+        var expected = t.find({a: {$gte: -1.5, $lt: 4}}).hint({$natural: 1}).count();
+        assert.eq(expected, t.find().min({a: -1.5}).max({a: 4}).hint(keyPattern).itcount());
+        expected = t.find({a: {$gte: "", $lt: "b"}}).hint({$natural: 1}).count();
+        assert.eq(expected, t.find().min({a: ""}).max({a: "b"}).hint(keyPattern).itcount());
+    }
+    else {
+        var expected = t.find({a: {$gt: -1.5, $lte: 4}}).hint({$natural: 1}).count();
+        assert.eq(expected, t.find().min({a: 4}).max({a: -1.5}).hint(keyPattern).itcount());
+        expected = t.find({a: {$gt: "", $lte: "b"}}).hint({$natural: 1}).count();
+        assert.eq(expected, t.find().min({a: "b"}).max({a: ""}).hint(keyPattern).itcount());
+    }
+
+    assert.commandWorked(t.dropIndex(keyPattern));
+});
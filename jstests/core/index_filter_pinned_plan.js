@@ -0,0 +1,53 @@
+// Test pinning a plan to a query shape with planCacheSetFilter. Queries of the shape use the
+// pinned plan without a trial period until an index it needs goes away.
+(function() {
+    "use strict";
+    var t = db.index_filter_pinned_plan;
+    t.drop();
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(t.insert({a: i % 10, b: i}));
+    }
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    assert.commandWorked(t.ensureIndex({b: 1}));
+
+    var shape = {query: {a: 1, b: 1}, sort: {}, projection: {}};
+    function pinnedPlanMetrics() {
+        return db.serverStatus().metrics.queryExecutor.pinnedPlan;
+    }
+
+    // Nothing is cached for the shape yet.
+    assert.commandFailed(t.runCommand("planCacheSetFilter", Object.extend(
+        {indexes: [{a: 1}, {b: 1}], pinCachedPlan: true}, shape)));
+
+    // Race the two indexes once, so that the winner gets cached, then pin it.
+    assert.eq(1, t.find({a: 1, b: 1}).itcount());
+    assert.commandWorked(t.runCommand("planCacheSetFilter", Object.extend(
+        {indexes: [{a: 1}, {b: 1}], pinCachedPlan: true}, shape)));
+
+    var filters = assert.commandWorked(t.runCommand("planCacheListFilters")).filters;
+    assert.eq(1, filters.length, tojson(filters));
+    assert(filters[0].pinnedPlan, tojson(filters));
+
+    var before = pinnedPlanMetrics();
+    assert.eq(1, t.find({a: 1, b: 11}).itcount());
+    var explain = t.find({a: 1, b: 11}).explain(true);
+    assert.eq(0, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    assert(explain.queryPlanner.indexFilterSet, tojson(explain));
+    assert.lt(before.used, pinnedPlanMetrics().used);
+
+    // The same plan can be pinned from its listed form.
+    assert.commandWorked(t.runCommand("planCacheSetFilter", Object.extend(
+        {indexes: [{a: 1}, {b: 1}], pinnedPlan: filters[0].pinnedPlan}, shape)));
+
+    // Once an index the plan uses is dropped, the query is planned normally again.
+    assert.commandWorked(t.dropIndex({a: 1}));
+    assert.commandWorked(t.dropIndex({b: 1}));
+    before = pinnedPlanMetrics();
+    assert.eq(1, t.find({a: 1, b: 11}).itcount());
+    assert.lt(before.invalid, pinnedPlanMetrics().invalid);
+
+    assert.commandFailed(t.runCommand("planCacheSetFilter", Object.extend(
+        {indexes: [{a: 1}], pinnedPlan: 1}, shape)));
+    assert.commandWorked(t.runCommand("planCacheClearFilters"));
+}());
@@ -0,0 +1,70 @@
+// Test that mapReduce gives the same results whether a summing reduce function is run natively
+// or in JS.
+(function() {
+    "use strict";
+    var t = db.mr_native_sum;
+    t.drop();
+
+    for (var i = 0; i < 200; i++) {
+        t.insert({_id: i, k: i % 7, n: i, d: i + 0.25, s: "x" + (i % 3)});
+    }
+
+    var sums = [
+        function(key, values) { return Array.sum(values); },
+        function(key, values) {
+            var total = 0;
+            for (var i = 0; i < values.length; i++) {
+                total += values[i];
+            }
+            return total;
+        },
+        function(key, values) {
+            var total = 0;
+            values.forEach(function(v) { total += v; });
+            return total;
+        },
+    ];
+
+    // Written so that it can't be recognized, but reduces the same way as the ones above.
+    var jsSum = function(key, values) {
+        var total = null;
+        for (var i = 0; i < values.length; i++) {
+            total = (total === null) ? values[i] : total + values[i];
+        }
+        return total;
+    };
+
+    function results(map, reduce, jsMode) {
+        var res = t.mapReduce(map, reduce, {out: {inline: 1}, jsMode: !!jsMode});
+        assert.commandWorked(res);
+        return res.results.sort(function(a, b) { return a._id - b._id; });
+    }
+
+    var maps = [
+        function() { emit(this.k, 1); },
+        function() { emit(this.k, this.n); },
+        function() { emit(this.k, this.d); },
+        function() { emit(this.k, NumberInt(this.n)); },
+    ];
+
+    maps.forEach(function(map) {
+        var expected = results(map, jsSum);
+        sums.forEach(function(reduce) {
+            assert.eq(expected, results(map, reduce), tojson(reduce));
+            assert.eq(expected, results(map, reduce, true), tojson(reduce));
+        });
+    });
+
+    // Strings in the values have to go through JS. Only Array.sum starts from the first value
+    // the way jsSum does; the loops start from 0.
+    var mixed = function() { emit(this.k, this.n % 2 ? this.n : this.s); };
+    assert.eq(results(mixed, jsSum), results(mixed, sums[0]));
+
+    // Finalize sees the summed value
+    var res = t.mapReduce(function() { emit(this.k, 1); }, sums[0],
+                          {out: {inline: 1}, finalize: function(key, value) { return value * 2; }});
+    assert.commandWorked(res);
+    res.results.forEach(function(doc) {
+        assert.eq(0, doc.value % 2, tojson(doc));
+    });
+})();
@@ -0,0 +1,30 @@
+// Test that the profiler records the storage bytes an operation read and wrote, and the CPU time
+// it used where the platform can measure it.
+(function() {
+    'use strict';
+    // special db so that it can be run in parallel tests
+    var testDB = db.getSisterDB("profile_resource_accounting");
+    var t = testDB.profile_resource_accounting;
+    t.drop();
+
+    testDB.setProfilingLevel(0);
+    testDB.system.profile.drop();
+    testDB.setProfilingLevel(2);
+
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(t.insert({a: i, s: "xxxxxxxxxxxxxxxxxxxx"}));
+    }
+    assert.eq(20, t.find({s: {$exists: true}}).itcount());
+    testDB.setProfilingLevel(0);
+
+    var insert = testDB.system.profile.find({op: "insert", ns: t.getFullName()}).next();
+    assert.gt(insert.storageBytesWritten, 0, tojson(insert));
+
+    var query = testDB.system.profile.find({op: "query", ns: t.getFullName()}).next();
+    assert.gt(query.storageBytesRead, 0, tojson(query));
+    if (query.hasOwnProperty("cpuMicros")) {
+        assert.gte(query.cpuMicros, 0, tojson(query));
+    }
+
+    testDB.system.profile.drop();
+})();
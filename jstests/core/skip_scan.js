@@ -0,0 +1,32 @@
+// Test that predicates over the later fields of a compound index whose leading field has few
+// values can use the index by skipping from one leading value to the next.
+
+// Include helpers for analyzing explain output.
+load("jstests/libs/analyze_plan.js");
+
+var t = db.jstests_skip_scan;
+t.drop();
+
+var bulk = t.initializeUnorderedBulkOp();
+for (var i = 0; i < 2000; i++) {
+    bulk.insert({a: i % 4, b: i, c: i % 7});
+}
+assert.writeOK(bulk.execute());
+assert.commandWorked(t.ensureIndex({a: 1, b: 1}));
+
+assert.eq(1, t.find({b: 1234}).itcount());
+assert.eq(2, t.find({b: {$in: [5, 6, 7]}, c: {$ne: 6}}).itcount());
+assert.eq([{a: 2, b: 10}], t.find({b: 10}, {_id: 0, a: 1, b: 1}).toArray());
+
+var explain = t.find({b: 1234}).explain("executionStats");
+assert(isIxscan(explain.queryPlanner.winningPlan), tojson(explain));
+assert.gt(100, explain.executionStats.totalKeysExamined, tojson(explain));
+
+// Too many leading values: the index is only scanned for predicates on its leading field.
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQuerySkipScanMaxLeadingValues: 2}));
+t.getPlanCache().clear();
+t.dropIndex({a: 1, b: 1});
+assert.commandWorked(t.ensureIndex({a: 1, b: 1}));
+explain = t.find({b: 1234}).explain();
+assert(isCollscan(explain.queryPlanner.winningPlan), tojson(explain));
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQuerySkipScanMaxLeadingValues: 100}));
@@ -0,0 +1,35 @@
+// Test the maxStalenessSecs option of dbStats and collStats: cached storage and index sizes are
+// reused, and invalidated by index changes.
+(function() {
+    "use strict";
+    var t = db.stats_max_staleness;
+    t.drop();
+
+    for (var i = 0; i < 100; i++) {
+        t.insert({_id: i, a: i});
+    }
+
+    assert.commandFailed(t.runCommand("collStats", {maxStalenessSecs: -1}));
+    assert.commandFailed(db.runCommand({dbStats: 1, maxStalenessSecs: "x"}));
+
+    var fresh = assert.commandWorked(t.runCommand("collStats"));
+    var cached = assert.commandWorked(t.runCommand("collStats", {maxStalenessSecs: 3600}));
+    assert.eq(100, cached.count);
+    assert.eq(fresh.nindexes, cached.nindexes);
+    assert.eq(Object.keySet(fresh.indexSizes), Object.keySet(cached.indexSizes));
+
+    // Counts are always current, even when sizes come from the cache
+    t.insert({_id: 100, a: 100});
+    cached = assert.commandWorked(t.runCommand("collStats", {maxStalenessSecs: 3600}));
+    assert.eq(101, cached.count);
+
+    // Building an index resets the cached sizes
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    cached = assert.commandWorked(t.runCommand("collStats", {maxStalenessSecs: 3600}));
+    assert(cached.indexSizes.hasOwnProperty("a_1"), tojson(cached));
+    assert.eq(2, cached.nindexes);
+
+    var dbStats = assert.commandWorked(db.runCommand({dbStats: 1, maxStalenessSecs: 3600}));
+    assert.gte(dbStats.indexes, 2);
+    assert.gt(dbStats.indexSize, 0);
+})();
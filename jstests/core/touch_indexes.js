@@ -0,0 +1,24 @@
+// Test the touch command on every storage engine, including touching only selected indexes.
+(function() {
+    "use strict";
+    var t = db.touch_indexes;
+    t.drop();
+
+    for (var i = 0; i < 1000; i++) {
+        assert.writeOK(t.insert({_id: i, a: i, b: -i}));
+    }
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    assert.commandWorked(t.ensureIndex({b: 1}));
+
+    var res = assert.commandWorked(db.runCommand({touch: t.getName(), data: true, index: true}));
+    assert(res.data, tojson(res));
+    assert.eq(3, res.indexes.num, tojson(res));
+
+    res = assert.commandWorked(db.runCommand({touch: t.getName(), indexes: ["_id_", "a_1"]}));
+    assert.eq(undefined, res.data, tojson(res));
+    assert.eq(2, res.indexes.num, tojson(res));
+
+    assert.commandFailed(db.runCommand({touch: t.getName(), indexes: ["nope_1"]}));
+    assert.commandFailed(db.runCommand({touch: t.getName(), indexes: "_id_"}));
+    assert.commandFailed(db.runCommand({touch: t.getName()}));
+}());
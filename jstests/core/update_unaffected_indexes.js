@@ -0,0 +1,66 @@
+// Test that an update which doesn't touch an index's fields leaves that index's keys intact,
+// while the indexes over the changed fields are still maintained.
+(function() {
+    "use strict";
+    var t = db.update_unaffected_indexes;
+    t.drop();
+
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    assert.commandWorked(t.ensureIndex({"b.c": 1}));
+    assert.commandWorked(t.ensureIndex({tags: 1}));
+    assert.commandWorked(t.ensureIndex({u: 1}, {unique: true}));
+
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(t.insert({_id: i, a: i, b: {c: i}, tags: ["x" + i], u: i, pad: ""}));
+    }
+
+    function check(query, hint, expected) {
+        assert.eq(expected, t.find(query).hint(hint).itcount(), tojson(query));
+    }
+
+    // Growing the document moves it, so every index has to point at the new location
+    assert.writeOK(t.update({_id: 1}, {$set: {pad: new Array(1000).join("x")}}));
+    check({a: 1}, {a: 1}, 1);
+    check({"b.c": 1}, {"b.c": 1}, 1);
+    check({tags: "x1"}, {tags: 1}, 1);
+    check({u: 1}, {u: 1}, 1);
+
+    // Only the index over 'b.c' changes
+    assert.writeOK(t.update({_id: 2}, {$set: {"b.c": 102}}));
+    check({"b.c": 2}, {"b.c": 1}, 0);
+    check({"b.c": 102}, {"b.c": 1}, 1);
+    check({a: 2}, {a: 1}, 1);
+
+    // A parent of an indexed path
+    assert.writeOK(t.update({_id: 3}, {$set: {b: {c: 103}}}));
+    check({"b.c": 3}, {"b.c": 1}, 0);
+    check({"b.c": 103}, {"b.c": 1}, 1);
+
+    // Multikey changes through $push, $pull and the positional operator
+    assert.writeOK(t.update({_id: 4}, {$push: {tags: "y"}, $set: {pad: "z"}}));
+    check({tags: "y"}, {tags: 1}, 1);
+    assert.writeOK(t.update({_id: 4}, {$pull: {tags: "x4"}}));
+    check({tags: "x4"}, {tags: 1}, 0);
+    assert.writeOK(t.update({_id: 5, tags: "x5"}, {$set: {"tags.$": "w"}}));
+    check({tags: "x5"}, {tags: 1}, 0);
+    check({tags: "w"}, {tags: 1}, 1);
+
+    // Renaming away from and onto an indexed field
+    assert.writeOK(t.update({_id: 6}, {$rename: {a: "old_a"}}));
+    check({a: 6}, {a: 1}, 0);
+    assert.writeOK(t.update({_id: 6}, {$rename: {old_a: "a"}}));
+    check({a: 6}, {a: 1}, 1);
+
+    // Unique constraints are still enforced for the indexes that change
+    assert.writeError(t.update({_id: 7}, {$set: {u: 8, pad: "p"}}));
+    assert.eq(7, t.findOne({_id: 7}).u);
+    check({u: 7}, {u: 1}, 1);
+
+    // Replacements recompute every index
+    assert.writeOK(t.update({_id: 8}, {a: 108, b: {c: 108}, tags: [], u: 108}));
+    check({a: 108}, {a: 1}, 1);
+    check({tags: "x8"}, {tags: 1}, 0);
+
+    var res = t.validate(true);
+    assert(res.valid, tojson(res));
+})();
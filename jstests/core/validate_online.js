@@ -0,0 +1,31 @@
+// Tests validate with online: true, which compares the indexes with the records without blocking
+// writes.
+
+var t = db.validate_online;
+t.drop();
+
+for ( var i = 0; i < 1000; i++ ) {
+    t.insert( { _id: i, a: i % 10, b: [ i, i + 1 ], c: { d: "x" + i } } );
+}
+assert.commandWorked( t.ensureIndex( { a: 1 } ) );
+assert.commandWorked( t.ensureIndex( { b: 1, "c.d": -1 } ) );
+
+var res = t.runCommand( "validate", { online: true } );
+assert.commandWorked( res );
+assert( res.valid, tojson( res ) );
+assert( res.online, tojson( res ) );
+assert.eq( 1000, res.nrecords, tojson( res ) );
+assert.eq( 3, res.nIndexes, tojson( res ) );
+assert.eq( 2000, res.keysPerIndex[t.getFullName() + ".$b_1_c.d_-1"], tojson( res ) );
+assert( res.consistencyChecked, tojson( res ) );
+
+// A throttled run gets the same answer.
+res = t.runCommand( "validate", { online: true, maxItemsPerSecond: 100000 } );
+assert.commandWorked( res );
+assert( res.valid, tojson( res ) );
+
+// Online validation replaces the full structural check.
+assert.commandFailed( t.runCommand( "validate", { online: true, full: true } ) );
+assert.commandFailed( db.validate_online_missing.runCommand( "validate", { online: true } ) );
+
+t.drop();
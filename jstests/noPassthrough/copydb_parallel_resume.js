@@ -0,0 +1,59 @@
+// Test that copydb copies collections in parallel from another server, builds their indexes, and
+// with resume: true keeps the collections a previous copy finished while recopying partial ones.
+(function() {
+    "use strict";
+    var source = MongoRunner.runMongod({});
+    var target = MongoRunner.runMongod({});
+
+    var srcDB = source.getDB("copydb_parallel");
+    var padding = new Array(256).join("x");
+    for (var c = 0; c < 4; c++) {
+        var bulk = srcDB["coll" + c].initializeUnorderedBulkOp();
+        for (var i = 0; i < 1000 * (c + 1); i++) {
+            bulk.insert({_id: i, x: i % 10, padding: padding});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(srcDB["coll" + c].ensureIndex({x: 1}));
+    }
+
+    function copy(extra) {
+        var cmd = {copydb: 1, fromhost: source.host, fromdb: srcDB.getName(),
+                   todb: srcDB.getName(), parallelCollections: 3};
+        return target.getDB("admin").runCommand(Object.extend(cmd, extra || {}));
+    }
+
+    function checkCopy() {
+        var dstDB = target.getDB(srcDB.getName());
+        for (var c = 0; c < 4; c++) {
+            assert.eq(srcDB["coll" + c].count(), dstDB["coll" + c].count(), "coll" + c);
+            assert.eq(2, dstDB["coll" + c].getIndexes().length, "coll" + c);
+        }
+    }
+
+    assert.commandWorked(copy());
+    checkCopy();
+
+    // Bad option values are rejected.
+    assert.commandFailed(copy({parallelCollections: 0}));
+    assert.commandFailed(copy({splitCollectionMinMB: -1}));
+
+    // Without resume the existing collections make the copy fail.
+    assert.commandFailed(copy());
+
+    // Pretend an earlier copy was interrupted half way through coll2 and before its indexes.
+    var dstDB = target.getDB(srcDB.getName());
+    assert.writeOK(dstDB.coll2.remove({_id: {$gte: 1500}}));
+    assert.commandWorked(dstDB.coll3.dropIndex({x: 1}));
+    var kept = dstDB.coll0.findOne({_id: 0});
+    assert.writeOK(dstDB.coll0.update({_id: 0}, {$set: {marker: 1}}));
+
+    assert.commandWorked(copy({resume: true}));
+    checkCopy();
+
+    // coll0 was complete, so it was not copied again.
+    assert.eq(1, dstDB.coll0.findOne({_id: 0}).marker);
+    assert.eq(kept.padding, dstDB.coll0.findOne({_id: 0}).padding);
+
+    MongoRunner.stopMongod(source);
+    MongoRunner.stopMongod(target);
+}());
@@ -0,0 +1,48 @@
+// Test that with getMorePrefetchBytes set, the results for a cursor's next getMore are produced
+// after each getMore reply, and that the cursor returns the same documents as without it.
+(function() {
+    'use strict';
+    var conn = MongoRunner.runMongod({setParameter: "getMorePrefetchBytes=100000"});
+    var coll = conn.getDB("test").getmore_prefetch;
+
+    var nDocs = 5000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < nDocs; i++) {
+        bulk.insert({_id: i, x: i % 7, pad: new Array(200).join("x")});
+    }
+    assert.writeOK(bulk.execute());
+
+    function prefetchMetrics() {
+        var status = conn.getDB("admin").runCommand({serverStatus: 1});
+        assert.commandWorked(status);
+        return status.metrics.cursor.prefetch;
+    }
+
+    var before = prefetchMetrics();
+    var ids = coll.find().sort({_id: 1}).batchSize(100).map(function(doc) { return doc._id; });
+    assert.eq(nDocs, ids.length);
+    for (var i = 0; i < nDocs; i++) {
+        assert.eq(i, ids[i]);
+    }
+    var after = prefetchMetrics();
+    assert.gt(after.docs, before.docs, tojson(after));
+    assert.gt(after.docsReturned, before.docsReturned, tojson(after));
+
+    // Results prefetched but never asked for go away with the cursor
+    var cursor = coll.find({x: 3}).batchSize(10);
+    for (var i = 0; i < 25; i++) {
+        assert.eq(3, cursor.next().x);
+    }
+    cursor.close();
+
+    // A filter that matches nothing beyond the prefetched results ends the cursor
+    assert.eq(Math.ceil(nDocs / 7), coll.find({x: 0}).batchSize(50).itcount());
+
+    // With prefetching off the cursor returns the same documents
+    assert.commandWorked(conn.adminCommand({setParameter: 1, getMorePrefetchBytes: 0}));
+    var docs = prefetchMetrics().docs;
+    assert.eq(nDocs, coll.find().batchSize(100).itcount());
+    assert.eq(docs, prefetchMetrics().docs);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,60 @@
+// Test that _id point lookups served from the document cache see every write to the collection.
+// The cache is only used by storage engines without document-level locking.
+(function() {
+    'use strict';
+    var baseDir = "jstests_idhack_document_cache";
+    var port = allocatePorts(1)[0];
+    var dbpath = MongoRunner.dataPath + baseDir + "/";
+
+    var m = MongoRunner.runMongod({dbpath: dbpath,
+                                   port: port,
+                                   storageEngine: "mmapv1",
+                                   setParameter: "internalDocumentCacheSizeBytes=1048576"});
+    var coll = m.getDB("test").idhack_document_cache;
+
+    function findById(id) {
+        return coll.find({_id: id}).toArray();
+    }
+
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i}));
+    }
+
+    // Repeated lookups of a hot _id are admitted and then served from the cache
+    for (var i = 0; i < 5; i++) {
+        assert.eq([{_id: 1, a: 1}], findById(1));
+    }
+    var explain = coll.find({_id: 1}).explain("executionStats");
+    assert.eq("IDHACK", explain.executionStats.executionStages.stage, tojson(explain));
+    assert.gt(explain.executionStats.executionStages.documentCacheHits, 0, tojson(explain));
+
+    // In-place and growing updates
+    assert.writeOK(coll.update({_id: 1}, {$inc: {a: 1}}));
+    assert.eq([{_id: 1, a: 2}], findById(1));
+    assert.writeOK(coll.update({_id: 1}, {$set: {b: new Array(1000).join("x")}}));
+    assert.eq(2, findById(1)[0].a);
+    assert.eq(999, findById(1)[0].b.length);
+
+    assert.writeOK(coll.update({_id: 1}, {_id: 1, c: 1}));
+    assert.eq([{_id: 1, c: 1}], findById(1));
+
+    // Delete and re-insert
+    for (var i = 0; i < 5; i++) {
+        findById(2);
+    }
+    assert.writeOK(coll.remove({_id: 2}));
+    assert.eq([], findById(2));
+    assert.writeOK(coll.insert({_id: 2, a: "new"}));
+    assert.eq([{_id: 2, a: "new"}], findById(2));
+
+    // Dropping and re-creating the collection
+    for (var i = 0; i < 5; i++) {
+        findById(3);
+    }
+    coll.drop();
+    assert.eq([], findById(3));
+    assert.writeOK(coll.insert({_id: 3, a: "again"}));
+    assert.eq([{_id: 3, a: "again"}], findById(3));
+
+    MongoRunner.stopMongod(port);
+})();
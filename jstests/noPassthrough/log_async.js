@@ -0,0 +1,33 @@
+// Test that with logAsyncBufferBytes set, messages make it to the --logpath file, including the
+// ones logged around a log rotation and at shutdown.
+(function() {
+    'use strict';
+    var baseDir = MongoRunner.dataPath + "jstests_log_async/";
+    var logPath = baseDir + "mongod.log";
+    mkdir(baseDir);
+    removeFile(logPath);
+
+    var port = allocatePorts(1)[0];
+    var m = MongoRunner.runMongod({port: port,
+                                   logpath: logPath,
+                                   setParameter: "logAsyncBufferBytes=65536"});
+    var testDB = m.getDB("test");
+
+    // Log every operation as slow, so the collection names show up in the log
+    assert.commandWorked(testDB.setProfilingLevel(0, -1));
+    testDB.before_rotation.findOne();
+    assert.commandWorked(m.getDB("admin").runCommand({logRotate: 1}));
+    testDB.after_rotation.findOne();
+
+    var rotated = listFiles(baseDir).filter(function(file) {
+        return file.name.indexOf("mongod.log.") != -1;
+    });
+    assert.eq(1, rotated.length, tojson(listFiles(baseDir)));
+    assert.neq(-1, cat(rotated[0].name).indexOf("test.before_rotation"));
+
+    MongoRunner.stopMongod(port);
+
+    var log = cat(logPath);
+    assert.neq(-1, log.indexOf("test.after_rotation"), log);
+    assert.neq(-1, log.indexOf("dbexit"), log);
+})();
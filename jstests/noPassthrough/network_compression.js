@@ -0,0 +1,52 @@
+/**
+ * Test that isMaster negotiates message compression, and that compressed replies and oplog
+ * fetching return the same documents.
+ */
+(function() {
+    "use strict";
+    var big = new Array(16 * 1024).join("x");
+
+    // Not negotiated unless the server enables a compressor
+    var plain = MongoRunner.runMongod({});
+    var res = plain.getDB("admin").runCommand({isMaster: 1, compression: ["snappy"]});
+    assert.commandWorked(res);
+    assert(!res.hasOwnProperty("compression"), tojson(res));
+    MongoRunner.stopMongod(plain);
+
+    var conn = MongoRunner.runMongod({setParameter: "networkMessageCompressors=snappy"});
+    var admin = conn.getDB("admin");
+    res = admin.runCommand({isMaster: 1});
+    assert(!res.hasOwnProperty("compression"), tojson(res));
+
+    // Unknown compressors are skipped; replies on this connection may be compressed from now on
+    res = admin.runCommand({isMaster: 1, compression: ["bogus", "snappy"]});
+    assert.commandWorked(res);
+    assert.eq(["snappy"], res.compression, tojson(res));
+
+    var t = conn.getDB("test").network_compression;
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(t.insert({_id: i, s: big}));
+    }
+    var docs = t.find().sort({_id: 1}).toArray();
+    assert.eq(100, docs.length);
+    docs.forEach(function(doc, i) {
+        assert.eq(i, doc._id);
+        assert.eq(big, doc.s);
+    });
+    MongoRunner.stopMongod(conn);
+
+    // Secondaries fetch the oplog over compressed connections
+    var rst = new ReplSetTest({nodes: 2,
+                               nodeOptions: {setParameter: "networkMessageCompressors=snappy"}});
+    rst.startSet();
+    rst.initiate();
+    var coll = rst.getPrimary().getDB("test").network_compression;
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, s: big}));
+    }
+    rst.awaitReplication();
+    var secondary = rst.getSecondary();
+    secondary.setSlaveOk();
+    assert.eq(100, secondary.getDB("test").network_compression.find({s: big}).itcount());
+    rst.stopSet();
+})();
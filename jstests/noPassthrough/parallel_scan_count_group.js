@@ -0,0 +1,51 @@
+/**
+ * Test that count and a leading $group return the same results when their collection scan is
+ * split across worker threads.
+ */
+(function() {
+    "use strict";
+    var baseDir = "jstests_parallel_scan_count_group";
+    var port = allocatePorts( 1 )[ 0 ];
+    var dbpath = MongoRunner.dataPath + baseDir + "/";
+
+    var m = MongoRunner.runMongod({dbpath: dbpath,
+                                   port: port,
+                                   setParameter: "internalQueryExecParallelScanMinRecords=0"});
+    var db = m.getDB( "test" );
+    var t = db.parallel_scan_count_group;
+    t.drop();
+
+    // Small extents so that MMAPv1 has several partitions to hand out.
+    assert.commandWorked(db.createCollection(t.getName(), {size: 4096}));
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 5000; i++) {
+        bulk.insert({_id: i, a: i % 7, b: i, s: "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"});
+    }
+    assert.writeOK(bulk.execute());
+
+    var pipeline = [{$match: {b: {$gte: 100}}},
+                    {$group: {_id: "$a", n: {$sum: 1}, avg: {$avg: "$b"}, max: {$max: "$b"}}},
+                    {$sort: {_id: 1}}];
+
+    function runQueries() {
+        return {count: t.count({b: {$gte: 100}}),
+                all: t.find({b: {$ne: null}}).count(),
+                groups: t.aggregate(pipeline).toArray()};
+    }
+
+    var serial = runQueries();
+    assert.eq(4900, serial.count);
+    assert.eq(5000, serial.all);
+    assert.eq(7, serial.groups.length);
+
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          internalQueryExecParallelScanWorkers: 4}));
+    var parallel = runQueries();
+    assert.eq(serial, parallel);
+
+    // Skip and limit still need the documents in order.
+    assert.eq(10, t.find({b: {$ne: null}}).skip(4990).count(true));
+    assert.eq(5, t.find({b: {$ne: null}}).limit(5).count(true));
+
+    MongoRunner.stopMongod(port);
+})();
@@ -0,0 +1,58 @@
+// Test that plan cache entries saved to local.plan_cache are loaded back by a restarted mongod,
+// and that entries using an index which no longer exists are not.
+(function() {
+    'use strict';
+    var baseDir = "jstests_plan_cache_persistence";
+    var port = allocatePorts(1)[0];
+    var dbpath = MongoRunner.dataPath + baseDir + "/";
+
+    var m = MongoRunner.runMongod({dbpath: dbpath,
+                                   port: port,
+                                   setParameter: "planCachePersistenceEnabled=true"});
+    assert.commandWorked(m.adminCommand({setParameter: 1, planCachePersistIntervalSecs: 1}));
+
+    var coll = m.getDB("test").plan_cache_persistence;
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({a: i, b: i % 10, c: i}));
+    }
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}));
+    assert.commandWorked(coll.ensureIndex({c: 1}));
+
+    // Both shapes have two candidate plans, so their winners get cached
+    assert.eq(1, coll.find({a: 5, b: 5}).itcount());
+    assert.eq(1, coll.find({c: 7, b: 7}).itcount());
+    assert.eq(2, coll.getPlanCache().listQueryShapes().length);
+
+    assert.soon(function() {
+        return m.getDB("local").plan_cache.count() == 2;
+    }, "plan cache entries were not saved");
+
+    MongoRunner.stopMongod(port);
+
+    m = MongoRunner.runMongod({dbpath: dbpath,
+                               port: port,
+                               noCleanData: true,
+                               setParameter: "planCachePersistenceEnabled=true"});
+    coll = m.getDB("test").plan_cache_persistence;
+    var shapes = coll.getPlanCache().listQueryShapes();
+    assert.eq(2, shapes.length, tojson(shapes));
+    assert.eq(1, coll.find({a: 6, b: 6}).itcount());
+
+    // An entry whose plans use a dropped index is not restored
+    assert.commandWorked(m.adminCommand({setParameter: 1, planCachePersistIntervalSecs: 1}));
+    assert.commandWorked(coll.dropIndex({c: 1}));
+    assert.eq(1, coll.find({a: 5, b: 5}).itcount());
+    MongoRunner.stopMongod(port);
+
+    m = MongoRunner.runMongod({dbpath: dbpath,
+                               port: port,
+                               noCleanData: true,
+                               setParameter: "planCachePersistenceEnabled=true"});
+    shapes = m.getDB("test").plan_cache_persistence.getPlanCache().listQueryShapes();
+    assert.lte(shapes.length, 1, tojson(shapes));
+    shapes.forEach(function(shape) {
+        assert.eq({a: 5, b: 5}, shape.query);
+    });
+    MongoRunner.stopMongod(port);
+})();
@@ -0,0 +1,67 @@
+// Test that with profileBufferSize set, profiled operations are kept in memory and returned by
+// the profileBuffer command instead of being written to system.profile, and that they are moved
+// to system.profile once profileBufferOffloadSecs is set.
+(function() {
+    'use strict';
+    var baseDir = "jstests_profile_buffer";
+    var port = allocatePorts(1)[0];
+    var dbpath = MongoRunner.dataPath + baseDir + "/";
+
+    var m = MongoRunner.runMongod({dbpath: dbpath,
+                                   port: port,
+                                   setParameter: "profileBufferSize=1000"});
+    var testDB = m.getDB("test");
+    var coll = testDB.profile_buffer;
+    assert.writeOK(coll.insert({a: 1}));
+
+    assert.commandWorked(testDB.setProfilingLevel(2));
+    for (var i = 0; i < 10; i++) {
+        assert.eq(1, coll.find({a: 1, i: {$ne: i}}).itcount());
+    }
+    assert.commandWorked(testDB.setProfilingLevel(0));
+
+    assert.eq(0, testDB.system.profile.find({ns: coll.getFullName()}).itcount());
+
+    var res = assert.commandWorked(testDB.runCommand({profileBuffer: 1}));
+    assert(res.enabled, tojson(res));
+    assert.eq(false, res.truncated);
+    var queries = res.docs.filter(function(doc) {
+        return doc.op == "query" && doc.ns == coll.getFullName();
+    });
+    assert.eq(10, queries.length, tojson(res.docs));
+    for (var i = 1; i < queries.length; i++) {
+        assert.lte(queries[i - 1].ts, queries[i].ts);
+    }
+
+    // Other databases don't see this database's documents
+    res = assert.commandWorked(m.getDB("other").runCommand({profileBuffer: 1}));
+    assert.eq(0, res.docs.length, tojson(res));
+
+    // clear empties this database's part of the buffer
+    assert.commandWorked(testDB.runCommand({profileBuffer: 1, clear: true}));
+    res = assert.commandWorked(testDB.runCommand({profileBuffer: 1}));
+    assert.eq(0, res.docs.length, tojson(res));
+
+    // A sample rate of 0 records nothing
+    assert.commandWorked(m.adminCommand({setParameter: 1, profileSampleRate: 0}));
+    assert.commandWorked(testDB.setProfilingLevel(2));
+    assert.eq(1, coll.find({a: 1}).itcount());
+    assert.commandWorked(testDB.setProfilingLevel(0));
+    res = assert.commandWorked(testDB.runCommand({profileBuffer: 1}));
+    assert.eq(0, res.docs.length, tojson(res));
+    assert.commandWorked(m.adminCommand({setParameter: 1, profileSampleRate: 1}));
+
+    // Buffered documents move to system.profile once offloading is on
+    assert.commandWorked(testDB.setProfilingLevel(2));
+    assert.eq(0, coll.find({b: 1}).itcount());
+    assert.commandWorked(testDB.setProfilingLevel(0));
+    assert.commandWorked(m.adminCommand({setParameter: 1, profileBufferOffloadSecs: 1}));
+    assert.soon(function() {
+        return testDB.system.profile.find({ns: coll.getFullName(), "query.b": 1}).itcount() == 1;
+    });
+    res = assert.commandWorked(testDB.runCommand({profileBuffer: 1}));
+    assert.eq(0, res.docs.filter(function(doc) { return doc.ns == coll.getFullName(); }).length,
+              tojson(res));
+
+    MongoRunner.stopMongod(port);
+})();
@@ -0,0 +1,45 @@
+// Test that an unindexed sort larger than internalQueryExecMaxBlockingSortBytes spills to disk
+// when internalQueryExecAllowBlockingSortSpill is set, and still fails when it is not.
+(function() {
+    'use strict';
+    var baseDir = "jstests_sort_spill";
+    var port = allocatePorts(1)[0];
+    var dbpath = MongoRunner.dataPath + baseDir + "/";
+
+    var m = MongoRunner.runMongod({dbpath: dbpath,
+                                   port: port,
+                                   setParameter: "internalQueryExecMaxBlockingSortBytes=10000"});
+    var coll = m.getDB("test").sort_spill;
+    var pad = new Array(100).join("x");
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, a: (i * 7) % 1000, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Spilling is off by default
+    assert.throws(function() {
+        coll.find().sort({a: 1}).itcount();
+    });
+
+    assert.commandWorked(m.adminCommand({setParameter: 1,
+                                         internalQueryExecAllowBlockingSortSpill: true}));
+    var results = coll.find().sort({a: 1}).toArray();
+    assert.eq(1000, results.length);
+    for (var i = 0; i < results.length; i++) {
+        assert.eq(i, results[i].a);
+    }
+
+    var explain = coll.find().sort({a: -1}).explain("executionStats");
+    assert.eq(1000, explain.executionStats.nReturned);
+    var sortStage = explain.executionStats.executionStages;
+    while (sortStage.stage != "SORT") {
+        sortStage = sortStage.inputStage;
+    }
+    assert.gt(sortStage.spilledDocs, 0, tojson(sortStage));
+
+    // A top-k sort keeps only the limit in memory and never needs to spill
+    assert.eq(999, coll.find().sort({a: -1}).limit(5).next().a);
+
+    MongoRunner.stopMongod(port);
+})();
@@ -0,0 +1,54 @@
+// Test that the TTL monitor deletes a backlog of expired documents in batches of
+// ttlDeleteBatchSize, spread over consecutive passes, and reports the backlog in serverStatus.
+(function() {
+    'use strict';
+    var port = allocatePorts(1)[0];
+    var m = MongoRunner.runMongod({port: port, setParameter: "ttlMonitorEnabled=false"});
+    var testDB = m.getDB("test");
+    assert.commandWorked(m.adminCommand({setParameter: 1,
+                                         ttlMonitorSleepSecs: 1,
+                                         ttlDeleteBatchSize: 50,
+                                         ttlMonitorWorkers: 2}));
+
+    var past = new Date(new Date().getTime() - 3600 * 1000);
+    var bulk;
+    ["a", "b"].forEach(function(collName) {
+        bulk = testDB[collName].initializeUnorderedBulkOp();
+        for (var i = 0; i < 500; i++) {
+            bulk.insert({x: past});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(testDB[collName].ensureIndex({x: 1}, {expireAfterSeconds: 60}));
+    });
+
+    function ttlMetrics() {
+        return assert.commandWorked(testDB.serverStatus()).metrics.ttl;
+    }
+
+    var passesBefore = ttlMetrics().passes;
+    assert.commandWorked(m.adminCommand({setParameter: 1, ttlMonitorEnabled: true}));
+
+    // A single pass deletes no more than one batch per collection
+    assert.soon(function() {
+        return ttlMetrics().passes > passesBefore && testDB.a.count() < 500;
+    });
+    var metrics = ttlMetrics();
+    if (testDB.a.count() > 0) {
+        assert.lte(500 - testDB.a.count(), 50 * (metrics.passes - passesBefore), tojson(metrics));
+    }
+
+    assert.soon(function() {
+        var metrics = ttlMetrics();
+        return metrics.backlogIndexes > 0 && metrics.oldestExpiredSecs >= 3500;
+    }, "backlog not reported: " + tojson(ttlMetrics()));
+
+    assert.soon(function() {
+        return testDB.a.count() == 0 && testDB.b.count() == 0;
+    }, "backlog not deleted", 60 * 1000);
+    assert.soon(function() {
+        return ttlMetrics().backlogIndexes == 0;
+    });
+    assert.eq(0, ttlMetrics().oldestExpiredSecs);
+
+    MongoRunner.stopMongod(port);
+})();
@@ -0,0 +1,43 @@
+/**
+ * This test is only for WiredTiger storageEngine
+ * Test that compact runs online: it succeeds on a replica set primary without force, and writes
+ * to the collection go on while it runs.
+ */
+if ( typeof(TestData) != "object" ||
+     !TestData.storageEngine ||
+     TestData.storageEngine != "wiredTiger" ) {
+    jsTestLog("Skipping test because storageEngine is not wiredTiger");
+}
+else {
+    var name = "wt_compact_online";
+    var replTest = new ReplSetTest({name: name, nodes: 1});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getMaster();
+    var coll = primary.getDB("test").compactme;
+    var padding = new Array(1024).join("x");
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 20000; i++) {
+        bulk.insert({_id: i, x: i, padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({x: 1}));
+    assert.writeOK(coll.remove({_id: {$lt: 15000}}));
+
+    var compactShell = startParallelShell(
+        "assert.commandWorked(db.getSiblingDB('test').runCommand({compact: 'compactme'}));",
+        primary.port);
+
+    // The collection is only intent locked, so writes are not held up.
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: 100000 + i, x: i}));
+    }
+
+    compactShell();
+    assert.eq(5100, coll.count());
+    assert.eq(5100, coll.find().hint({x: 1}).itcount());
+
+    replTest.stopSet();
+}
@@ -0,0 +1,60 @@
+// Test that the oplog of a wiredTiger mongod is truncated in the background, keeping it close to
+// its capped size while the newest entries survive, and that it is truncated again after a
+// restart.
+(function() {
+    'use strict';
+    if (typeof(TestData) != "object" ||
+        !TestData.storageEngine ||
+        TestData.storageEngine != "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    var baseDir = "jstests_wt_oplog_truncation";
+    var port = allocatePorts(1)[0];
+    var dbpath = MongoRunner.dataPath + baseDir + "/";
+    var oplogSize = 2 * 1024 * 1024;
+
+    function start(restart) {
+        return MongoRunner.runMongod({dbpath: dbpath,
+                                      port: port,
+                                      master: "",
+                                      oplogSize: 2,
+                                      storageEngine: "wiredTiger",
+                                      restart: restart});
+    }
+
+    function fill(conn, start) {
+        var pad = new Array(1024).join("x");
+        var coll = conn.getDB("test").wt_oplog_truncation;
+        for (var batch = 0; batch < 10; batch++) {
+            var bulk = coll.initializeUnorderedBulkOp();
+            for (var i = 0; i < 1000; i++) {
+                bulk.insert({_id: start + batch * 1000 + i, pad: pad});
+            }
+            assert.writeOK(bulk.execute());
+        }
+        return start + 10000;
+    }
+
+    function checkTruncated(conn, lastId) {
+        var oplog = conn.getDB("local").oplog.$main;
+        assert.soon(function() {
+            return oplog.stats().size <= oplogSize * 1.1;
+        }, "oplog wasn't truncated: " + tojson(oplog.stats()));
+        var newest = oplog.find().sort({$natural: -1}).limit(1).next();
+        assert.eq(lastId, newest.o._id, tojson(newest));
+        assert.gt(oplog.count(), 0);
+    }
+
+    var conn = start(false);
+    var next = fill(conn, 0);
+    checkTruncated(conn, next - 1);
+
+    MongoRunner.stopMongod(port);
+    conn = start(true);
+    next = fill(conn, next);
+    checkTruncated(conn, next - 1);
+
+    MongoRunner.stopMongod(port);
+})();
@@ -0,0 +1,34 @@
+// Test parsing of the aggregate command's cursor.exhaust option.  Streaming itself needs a
+// driver that reads exhaust replies, so this only checks the command side.
+(function() {
+    'use strict';
+    var t = db.jstests_agg_exhaust_cursor;
+    t.drop();
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(t.insert({_id: i}));
+    }
+
+    function agg(cursor) {
+        return t.runCommand('aggregate', {pipeline: [{$sort: {_id: 1}}], cursor: cursor});
+    }
+
+    var res = assert.commandWorked(agg({exhaust: true}));
+    assert.eq(0, res.cursor.id, tojson(res));
+    assert.eq(10, res.cursor.firstBatch.length, tojson(res));
+
+    res = assert.commandWorked(agg({batchSize: 20, exhaust: false}));
+    assert.eq(0, res.cursor.id, tojson(res));
+    assert.eq(10, res.cursor.firstBatch.length, tojson(res));
+
+    res = assert.commandWorked(agg({batchSize: 4, exhaust: true}));
+    assert.neq(0, res.cursor.id, tojson(res));
+    assert.eq(4, res.cursor.firstBatch.length, tojson(res));
+    new DBCommandCursor(db.getMongo(), res, 4).close();
+
+    assert.commandFailed(agg({exhaust: 1}));
+    assert.commandFailed(agg({exhaust: true, foo: 1}));
+
+    // Other cursor commands don't accept the option
+    assert.commandFailed(t.runCommand('listIndexes', {cursor: {exhaust: true}}));
+    assert.commandFailed(db.runCommand({listCollections: 1, cursor: {exhaust: true}}));
+})();
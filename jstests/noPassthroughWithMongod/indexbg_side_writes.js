@@ -0,0 +1,45 @@
+// Test that a background index build that loads its keys through the external sorter ends up
+// with the same index as a foreground build when documents are inserted, updated and removed
+// while it runs.
+(function() {
+    'use strict';
+    var t = db.jstests_indexbg_side_writes;
+    t.drop();
+
+    var nDocs = 50000;
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < nDocs; i++) {
+        bulk.insert({_id: i, a: i % 1000, b: [i, i + 1]});
+    }
+    assert.writeOK(bulk.execute());
+
+    var join = startParallelShell(
+        "assert.commandWorked(db.jstests_indexbg_side_writes.ensureIndex(" +
+        "{a: 1, b: 1}, {background: true}));");
+
+    // Keep writing until the build has finished
+    var i = 0;
+    while (i < 1000 || (i < 20000 && t.getIndexes().length < 2)) {
+        assert.writeOK(t.insert({_id: nDocs + i, a: i % 1000, b: [-i]}));
+        assert.writeOK(t.update({_id: i * 7 % nDocs}, {$set: {a: -1, b: [i, "x"]}}));
+        assert.writeOK(t.remove({_id: i * 11 % nDocs + 1}));
+        i++;
+    }
+    join();
+    assert.eq(2, t.getIndexes().length);
+
+    var res = t.validate(true);
+    assert(res.valid, tojson(res));
+
+    // Every document has one key per element of b
+    var expected = 0;
+    t.find().forEach(function(doc) { expected += doc.b.length; });
+    var explain = t.find().hint({a: 1, b: 1}).explain("executionStats");
+    assert.eq(expected, explain.executionStats.totalKeysExamined, tojson(explain));
+
+    [-1, 0, 17, 999].forEach(function(a) {
+        assert.eq(t.find({a: a}).hint({$natural: 1}).itcount(),
+                  t.find({a: a}).hint({a: 1, b: 1}).itcount(),
+                  "a: " + a);
+    });
+})();
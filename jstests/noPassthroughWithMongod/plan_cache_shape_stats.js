@@ -0,0 +1,58 @@
+// Test the planCacheShapeStats command, which returns cumulative execution statistics for each
+// query shape run against a collection.
+(function() {
+    'use strict';
+    var t = db.jstests_plan_cache_shape_stats;
+    t.drop();
+
+    function shapeStats() {
+        var res = t.runCommand('planCacheShapeStats');
+        assert.commandWorked(res, 'planCacheShapeStats failed');
+        assert(res.hasOwnProperty('shapes'), 'shapes missing from planCacheShapeStats result');
+        return res.shapes;
+    }
+
+    function findShape(shapes, query, sort) {
+        for (var i = 0; i < shapes.length; i++) {
+            if (bsonWoCompare(shapes[i].query, query) == 0 &&
+                bsonWoCompare(shapes[i].sort, sort) == 0) {
+                return shapes[i];
+            }
+        }
+        return null;
+    }
+
+    // Collection doesn't exist - no shapes
+    assert.eq(0, shapeStats().length);
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(t.insert({a: i % 10, b: i}));
+    }
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    assert.commandWorked(t.ensureIndex({b: 1}));
+
+    // Two indexes can answer this shape, so later runs use the cached plan.
+    for (var i = 0; i < 5; i++) {
+        assert.eq(10, t.find({a: i, b: {$gte: 0}}).itcount());
+    }
+    assert.eq(100, t.find().sort({b: -1}).itcount());
+
+    var shapes = shapeStats();
+    var shape = findShape(shapes, {a: 0, b: {$gte: 0}}, {});
+    assert.neq(null, shape, tojson(shapes));
+    assert.eq(5, shape.count, tojson(shape));
+    assert.eq(50, shape.nReturned, tojson(shape));
+    assert.gte(shape.totalKeysExamined, 50, tojson(shape));
+    assert.gte(shape.totalDocsExamined, 50, tojson(shape));
+    assert.gte(shape.totalMicros, shape.maxMicros, tojson(shape));
+    assert.gt(shape.planCacheHits, 0, tojson(shape));
+    assert.lt(shape.planCacheHits, 5, tojson(shape));
+
+    var sortShape = findShape(shapes, {}, {b: -1});
+    assert.neq(null, sortShape, tojson(shapes));
+    assert.eq(1, sortShape.count, tojson(sortShape));
+
+    // Dropping the collection drops its shape statistics
+    t.drop();
+    assert.eq(0, shapeStats().length);
+})();
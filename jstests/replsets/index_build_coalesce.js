@@ -0,0 +1,72 @@
+// Test that several indexes created together on the primary are all built on the secondary,
+// where index builds on the same collection that follow each other in the oplog are applied
+// with one collection scan.
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({name: "index_build_coalesce", nodes: 2});
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondary();
+    secondary.setSlaveOk();
+    var coll = primary.getDB("test").index_build_coalesce;
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, a: i, b: [i, -i], c: "c" + i, d: i % 10});
+    }
+    assert.writeOK(bulk.execute());
+    rst.awaitReplication();
+
+    function coalescedBuilds() {
+        var status = secondary.getDB("admin").runCommand({serverStatus: 1});
+        assert.commandWorked(status);
+        return status.metrics.repl.apply.coalescedIndexBuilds;
+    }
+
+    function checkIndexes(specs) {
+        var secondaryColl = secondary.getDB("test").index_build_coalesce;
+        specs.forEach(function(key) {
+            assert.eq(coll.find().hint(key).itcount(), secondaryColl.find().hint(key).itcount(),
+                      tojson(key));
+        });
+        var res = secondaryColl.validate(true);
+        assert(res.valid, tojson(res));
+    }
+
+    // Hold the secondary's applier so the index builds are queued up together.
+    var before = coalescedBuilds();
+    assert.commandWorked(secondary.adminCommand({configureFailPoint: "rsSyncApplyStop",
+                                                 mode: "alwaysOn"}));
+    var foreground = [{a: 1}, {b: 1}, {c: 1, d: 1}];
+    assert.commandWorked(coll.getDB().runCommand({
+        createIndexes: coll.getName(),
+        indexes: foreground.map(function(key, i) { return {key: key, name: "fg" + i}; })
+    }));
+    sleep(1000);
+    assert.commandWorked(secondary.adminCommand({configureFailPoint: "rsSyncApplyStop",
+                                                 mode: "off"}));
+    rst.awaitReplication();
+    checkIndexes(foreground);
+    print("index builds coalesced: " + (coalescedBuilds() - before));
+
+    var background = [{d: 1}, {a: 1, c: 1}];
+    assert.commandWorked(coll.getDB().runCommand({
+        createIndexes: coll.getName(),
+        indexes: background.map(function(key, i) {
+            return {key: key, name: "bg" + i, background: true};
+        })
+    }));
+    rst.awaitReplication();
+    assert.soon(function() {
+        return secondary.getDB("test").index_build_coalesce.getIndexes().length == 6;
+    });
+    assert.soon(function() {
+        return secondary.getDB("admin").currentOp({"msg": /Index Build/}).inprog.length == 0;
+    });
+    checkIndexes(background);
+
+    rst.stopSet();
+})();
@@ -0,0 +1,69 @@
+// Test that initial sync clones several collections at once, splits a large collection across
+// the clone workers, and reports per-collection progress in the "cloner" serverStatus section.
+(function() {
+    "use strict";
+    var name = "initial_sync_parallel_clone";
+    var replTest = new ReplSetTest({name: name, nodes: 1, oplogSize: 50});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var db = master.getDB("test");
+    var padding = new Array(512).join("x");
+
+    // Small extents so that MMAPv1 can hand the big collection out as several cursors
+    assert.commandWorked(db.createCollection("big", {size: 4096}));
+    var bulk = db.big.initializeUnorderedBulkOp();
+    for (var i = 0; i < 5000; i++) {
+        bulk.insert({_id: i, padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(db.big.ensureIndex({x: 1}));
+
+    for (var c = 0; c < 6; c++) {
+        bulk = db["small" + c].initializeUnorderedBulkOp();
+        for (var i = 0; i < 200; i++) {
+            bulk.insert({_id: i, c: c});
+        }
+        assert.writeOK(bulk.execute());
+    }
+    assert.commandWorked(db.small0.ensureIndex({c: 1}));
+
+    // initialSyncParallelCollections defaults to 4 workers
+    var slave = replTest.add({setParameter: "initialSyncSplitCollectionMinMB=1"});
+    replTest.reInitiate();
+    replTest.awaitSecondaryNodes();
+    replTest.awaitReplication();
+
+    slave.setSlaveOk();
+    var slaveDB = slave.getDB("test");
+    assert.eq(5000, slaveDB.big.count());
+    assert.eq(2, slaveDB.big.getIndexes().length, tojson(slaveDB.big.getIndexes()));
+    for (var c = 0; c < 6; c++) {
+        assert.eq(200, slaveDB["small" + c].count({c: c}));
+    }
+    assert.eq(2, slaveDB.small0.getIndexes().length, tojson(slaveDB.small0.getIndexes()));
+
+    var cloner = slaveDB.serverStatus().cloner;
+    assert(cloner, "no cloner section in serverStatus");
+    var big = cloner["test.big"];
+    assert(big, tojson(cloner));
+    assert.eq(5000, big.documents + big.duplicatesSkipped, tojson(big));
+    assert(big.done, tojson(big));
+    assert.gte(big.parts, 1, tojson(big));
+    assert.gt(big.bytes, 5000 * 512, tojson(big));
+    for (var c = 0; c < 6; c++) {
+        var small = cloner["test.small" + c];
+        assert(small, tojson(cloner));
+        assert.eq(200, small.documents, tojson(small));
+        assert.eq(1, small.parts, tojson(small));
+        assert(small.done, tojson(small));
+    }
+
+    // Writes after initial sync still replicate
+    assert.writeOK(db.big.insert({_id: "last"}));
+    replTest.awaitReplication();
+    assert.eq(1, slaveDB.big.count({_id: "last"}));
+
+    replTest.stopSet();
+})();
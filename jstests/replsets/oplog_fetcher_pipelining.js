@@ -0,0 +1,59 @@
+// Test that a secondary keeping several getMores in flight on its sync source's oplog applies
+// every op, in order, and reports how it is fetching in replSetGetStatus.
+(function() {
+    "use strict";
+    var name = "oplog_fetcher_pipelining";
+    var replTest = new ReplSetTest({name: name,
+                                    nodes: 2,
+                                    oplogSize: 50,
+                                    nodeOptions: {
+                                        setParameter: "replOplogFetcherMaxGetMoresInFlight=4"}});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var coll = master.getDB("test").oplog_fetcher_pipelining;
+    var padding = new Array(1024).join("x");
+    for (var round = 0; round < 5; round++) {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 2000; i++) {
+            bulk.insert({_id: round * 2000 + i, padding: padding});
+        }
+        assert.writeOK(bulk.execute());
+
+        // Updates depend on the inserts before them having been applied
+        bulk = coll.initializeOrderedBulkOp();
+        for (var i = 0; i < 2000; i += 10) {
+            bulk.find({_id: round * 2000 + i}).updateOne({$set: {round: round}});
+        }
+        assert.writeOK(bulk.execute());
+    }
+    replTest.awaitReplication();
+
+    var slave = replTest.liveNodes.slaves[0];
+    slave.setSlaveOk();
+    var slaveColl = slave.getDB("test").oplog_fetcher_pipelining;
+    assert.eq(10000, slaveColl.count());
+    assert.eq(1000, slaveColl.count({round: {$exists: true}}));
+    for (var round = 0; round < 5; round++) {
+        assert.eq(200, slaveColl.count({round: round}));
+    }
+
+    var status = slave.adminCommand({replSetGetStatus: 1});
+    assert.commandWorked(status);
+    var fetcher = status.oplogFetcher;
+    assert(fetcher, tojson(status));
+    assert.eq(4, fetcher.maxGetMoresInFlight, tojson(fetcher));
+    assert.gt(fetcher.batches, 0, tojson(fetcher));
+    assert.gte(fetcher.getMoresInFlight, 1, tojson(fetcher));
+    assert.lte(fetcher.getMoresInFlight, 4, tojson(fetcher));
+
+    // Turning pipelining off at runtime still replicates
+    assert.commandWorked(slave.adminCommand({setParameter: 1,
+                                             replOplogFetcherMaxGetMoresInFlight: 1}));
+    assert.writeOK(coll.insert({_id: "last"}));
+    replTest.awaitReplication();
+    assert.eq(1, slaveColl.count({_id: "last"}));
+
+    replTest.stopSet();
+})();
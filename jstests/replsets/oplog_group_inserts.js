@@ -0,0 +1,50 @@
+// Test that with oplogGroupInserts set, a multi-document insert is logged as a few oplog
+// entries holding arrays of documents, and that secondaries apply them, including when the
+// entries are replayed over documents that are already there.
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({name: "oplog_group_inserts",
+                               nodes: 2,
+                               nodeOptions: {setParameter: "oplogGroupInserts=true"}});
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondary();
+    secondary.setSlaveOk();
+    var coll = primary.getDB("test").oplog_group_inserts;
+    assert.commandWorked(coll.getDB().createCollection(coll.getName()));
+
+    var docs = [];
+    for (var i = 0; i < 1000; i++) {
+        docs.push({_id: i, a: i, s: "document " + i});
+    }
+    assert.writeOK(coll.insert(docs));
+    rst.awaitReplication();
+
+    var oplog = primary.getDB("local").oplog.rs;
+    var entries = oplog.find({op: "i", ns: coll.getFullName()}).toArray();
+    assert.lt(entries.length, docs.length, "inserts were not grouped");
+    var logged = 0;
+    entries.forEach(function(entry) {
+        logged += Array.isArray(entry.o) ? entry.o.length : 1;
+    });
+    assert.eq(docs.length, logged);
+
+    var secondaryColl = secondary.getDB("test").oplog_group_inserts;
+    assert.eq(docs.length, secondaryColl.find().itcount());
+    assert.eq(docs[999], secondaryColl.findOne({_id: 999}));
+
+    // Replaying an entry over documents already there applies them one upsert at a time.
+    // applyOps is itself replicated, so this replays the entry on the secondary too.
+    assert.commandWorked(primary.getDB("admin").runCommand({applyOps: [entries[0]]}));
+    rst.awaitReplication();
+    assert.eq(docs.length, coll.find().itcount());
+    assert.eq(docs.length, secondaryColl.find().itcount());
+
+    var valid = secondaryColl.validate(true);
+    assert(valid.valid, tojson(valid));
+
+    rst.stopSet();
+})();
@@ -0,0 +1,39 @@
+// Test that a secondary prefetching each batch ahead of apply ends up with the same data.
+(function() {
+    "use strict";
+    var name = "pipelined_prefetch";
+    var replTest = new ReplSetTest({name: name,
+                                    nodes: 2,
+                                    oplogSize: 10,
+                                    nodeOptions: {setParameter: "replPipelinedPrefetch=true"}});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var coll = master.getDB("test").pipelined_prefetch;
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 2000; i++) {
+        bulk.insert({_id: i, a: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 2000; i += 2) {
+        bulk.find({_id: i}).updateOne({$inc: {a: 1}});
+    }
+    assert.writeOK(bulk.execute());
+    replTest.awaitReplication();
+
+    var slave = replTest.liveNodes.slaves[0];
+    var slaveColl = slave.getDB("test").pipelined_prefetch;
+    assert.eq(2000, slaveColl.count());
+    assert.eq(coll.find().sort({_id: 1}).toArray(), slaveColl.find().sort({_id: 1}).toArray());
+
+    var preload = slave.getDB("admin").serverStatus().metrics.repl.preload;
+    assert.lt(0, preload.pipelined.batches, tojson(preload));
+    assert.lt(0, preload.docHits, tojson(preload));
+
+    replTest.stopSet();
+})();
@@ -0,0 +1,83 @@
+// Test that rollback refetches the documents it must restore in small $in batches, across
+// several collections, and leaves the rolled back node with the same data as the new primary.
+(function() {
+    "use strict";
+    var name = "rollback_batched_refetch";
+    var replTest = new ReplSetTest({name: name,
+                                    nodes: 3,
+                                    nodeOptions: {setParameter: "rollbackRefetchBatchSize=7"}});
+    var nodes = replTest.nodeList();
+    replTest.startSet();
+    replTest.initiate({"_id": name,
+                       "members": [
+                           { "_id": 0, "host": nodes[0] },
+                           { "_id": 1, "host": nodes[1] },
+                           { "_id": 2, "host": nodes[2], arbiterOnly: true}]
+                      });
+
+    var a_conn = replTest.getMaster();
+    var b_conn = replTest.liveNodes.slaves[0];
+    var AID = replTest.getNodeId(a_conn);
+    var BID = replTest.getNodeId(b_conn);
+    var colls = ["c0", "c1", "c2"];
+
+    // Data both nodes have
+    colls.forEach(function(c) {
+        var bulk = a_conn.getDB(name)[c].initializeUnorderedBulkOp();
+        for (var i = 0; i < 100; i++) {
+            bulk.insert({_id: i, v: "common"});
+        }
+        assert.writeOK(bulk.execute({w: 2, wtimeout: 60000}));
+    });
+
+    // Writes only B gets, which it will have to roll back
+    replTest.stop(AID);
+    var master = replTest.getMaster();
+    assert(b_conn.host === master.host, "b_conn assumed to be master");
+    colls.forEach(function(c) {
+        var bColl = b_conn.getDB(name)[c];
+        for (var i = 0; i < 30; i++) {
+            assert.writeOK(bColl.update({_id: i}, {$set: {v: "b"}}));
+        }
+        for (var i = 30; i < 45; i++) {
+            assert.writeOK(bColl.remove({_id: i}));
+        }
+        for (var i = 100; i < 120; i++) {
+            assert.writeOK(bColl.insert({_id: i, v: "b"}));
+        }
+    });
+
+    // Different writes to some of the same documents on A
+    replTest.stop(BID);
+    replTest.restart(AID);
+    master = replTest.getMaster();
+    assert(a_conn.host === master.host, "a_conn assumed to be master");
+    colls.forEach(function(c) {
+        var aColl = a_conn.getDB(name)[c];
+        for (var i = 0; i < 10; i++) {
+            assert.writeOK(aColl.update({_id: i}, {$set: {v: "a"}}));
+        }
+        assert.writeOK(aColl.insert({_id: 105, v: "a"}));
+    });
+
+    // B rolls back and catches up to A
+    replTest.restart(BID);
+    replTest.awaitSecondaryNodes();
+    replTest.awaitReplication();
+
+    b_conn.setSlaveOk();
+    colls.forEach(function(c) {
+        var expected = a_conn.getDB(name)[c].find().sort({_id: 1}).toArray();
+        var actual = b_conn.getDB(name)[c].find().sort({_id: 1}).toArray();
+        assert.eq(101, expected.length);
+        assert.eq(expected, actual, c);
+    });
+
+    var log = b_conn.adminCommand({getLog: "global"}).log;
+    var refetched = log.filter(function(line) {
+        return /rollback refetched 195 documents in 30 batches/.test(line);
+    });
+    assert.eq(1, refetched.length, tojson(log));
+
+    replTest.stopSet();
+})();
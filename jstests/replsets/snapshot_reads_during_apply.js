@@ -0,0 +1,66 @@
+// Test that a secondary which holds back batch commits so that reads see the last applied batch
+// still applies every op, and that it only does so on storage engines with document locking.
+(function() {
+    "use strict";
+    var name = "snapshot_reads_during_apply";
+    var replTest = new ReplSetTest({name: name,
+                                    nodes: 2,
+                                    nodeOptions: {
+                                        setParameter: "replSnapshotReadsDuringApply=true"}});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var coll = master.getDB("test").snapshot_reads_during_apply;
+    assert.writeOK(coll.insert({_id: "first"}));
+    replTest.awaitReplication();
+
+    var slave = replTest.liveNodes.slaves[0];
+    slave.setSlaveOk();
+    var slaveColl = slave.getDB("test").snapshot_reads_during_apply;
+    var before = slave.getDB("admin").serverStatus().metrics.repl.apply.deferredCommit;
+
+    for (var round = 0; round < 5; round++) {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 1000; i++) {
+            bulk.insert({_id: round * 1000 + i, round: round});
+        }
+        assert.writeOK(bulk.execute());
+
+        // Reads on the secondary see whole batches, never fewer documents than before
+        var seen = 0;
+        for (var j = 0; j < 10; j++) {
+            var n = slaveColl.count({round: {$exists: true}});
+            assert.gte(n, seen);
+            seen = n;
+        }
+
+        bulk = coll.initializeOrderedBulkOp();
+        for (var i = 0; i < 1000; i += 10) {
+            bulk.find({_id: round * 1000 + i}).updateOne({$set: {updated: true}});
+        }
+        assert.writeOK(bulk.execute());
+    }
+    replTest.awaitReplication();
+
+    assert.eq(5000, slaveColl.count({round: {$exists: true}}));
+    assert.eq(500, slaveColl.count({updated: true}));
+
+    var after = slave.getDB("admin").serverStatus().metrics.repl.apply.deferredCommit;
+    var engine = jsTest.options().storageEngine;
+    if (engine === "wiredTiger" || engine === "rocksdb") {
+        assert.gt(after.batches, before.batches, tojson(after));
+    }
+    else if (!engine || engine === "mmapv1") {
+        assert.eq(after.batches, before.batches, tojson(after));
+    }
+
+    // An index build gets a batch of its own, applied with readers held off as before
+    assert.commandWorked(coll.ensureIndex({round: 1}));
+    assert.writeOK(coll.insert({_id: "last", round: 5}));
+    replTest.awaitReplication();
+    assert.eq(1, slaveColl.count({round: 5}));
+    assert.eq(2, slaveColl.getIndexes().length);
+
+    replTest.stopSet();
+})();
@@ -0,0 +1,69 @@
+// Sharding on a hashed key whose index uses hashVersion 1.
+var st = new ShardingTest({ shards: 2, chunkSize: 1, other: { shardOptions: { verbose: 1 }} });
+st.stopBalancer();
+
+var testDB = st.s.getDB('test');
+var configDB = st.s.getDB('config');
+assert.commandWorked(testDB.adminCommand({ enableSharding: 'test' }));
+
+// hashVersion only applies to hashed keys and must be known
+assert.commandFailed(testDB.adminCommand({ shardCollection: 'test.ranged', key: { x: 1 },
+                                           hashVersion: 1 }));
+assert.commandFailed(testDB.adminCommand({ shardCollection: 'test.user', key: { x: 'hashed' },
+                                           hashVersion: 2 }));
+
+// The version must match an existing hashed index
+assert.commandWorked(testDB.mismatch.ensureIndex({ x: 'hashed' }));
+assert.commandFailed(testDB.adminCommand({ shardCollection: 'test.mismatch',
+                                           key: { x: 'hashed' }, hashVersion: 1 }));
+
+assert.commandWorked(testDB.adminCommand({ shardCollection: 'test.user', key: { x: 'hashed' },
+                                           hashVersion: 1 }));
+assert.eq(1, configDB.collections.findOne({ _id: 'test.user' }).hashVersion);
+
+var index = testDB.user.getIndexes().filter(function(idx) { return idx.key.x == 'hashed'; })[0];
+assert.eq(1, index.hashVersion);
+
+var chunkCount = configDB.chunks.count({ ns: 'test.user' });
+assert.gt(chunkCount, 1);
+
+var bulk = testDB.user.initializeUnorderedBulkOp();
+for (var x = 0; x < 1000; x++) {
+    bulk.insert({ x: x });
+}
+assert.writeOK(bulk.execute());
+
+// Every document landed on the shard owning the chunk of its version 1 hash
+var chunks = configDB.chunks.find({ ns: 'test.user' }).toArray();
+configDB.shards.find().forEach(function(shard) {
+    var shardColl = new Mongo(shard.host).getDB('test').user;
+    shardColl.find().forEach(function(doc) {
+        var hashKey = { x: testDB.adminCommand({ _hashBSONElement: doc.x, hashVersion: 1 }).out };
+        var owner = chunks.filter(function(chunk) {
+            return bsonWoCompare(hashKey, chunk.min) >= 0 && bsonWoCompare(hashKey, chunk.max) < 0;
+        });
+        assert.eq(1, owner.length, tojson(doc));
+        assert.eq(shard._id, owner[0].shard, tojson(doc));
+    });
+});
+
+// Targeted reads and writes route by the version 1 hash
+for (var x = 0; x < 1000; x += 97) {
+    assert.eq(1, testDB.user.find({ x: x }).itcount());
+    var explain = testDB.user.find({ x: x }).explain();
+    assert.eq(1, explain.queryPlanner.winningPlan.shards.length, tojson(explain));
+}
+assert.writeOK(testDB.user.update({ x: 5 }, { $set: { y: 1 } }));
+assert.eq(1, testDB.user.findOne({ x: 5 }).y);
+assert.writeOK(testDB.user.remove({ x: 5 }));
+assert.eq(999, testDB.user.count());
+
+// Migrations keep using the index's hash function
+var chunk = configDB.chunks.findOne({ ns: 'test.user' });
+var otherShard = configDB.shards.findOne({ _id: { $ne: chunk.shard } })._id;
+assert.commandWorked(testDB.adminCommand({ moveChunk: 'test.user', bounds: [chunk.min, chunk.max],
+                                           to: otherShard, _waitForDelete: true }));
+assert.eq(999, testDB.user.find().itcount());
+assert.eq(999, testDB.user.count());
+
+st.stop();
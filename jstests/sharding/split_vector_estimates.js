@@ -0,0 +1,85 @@
+//
+// Tests that splitVector answers from the shard's estimate of a chunk once it has scanned the
+// chunk, and that the estimate follows inserts into the chunk.
+//
+
+var options = { separateConfig : true,
+                mongosOptions : { noAutoSplit : "" }
+              };
+
+var st = new ShardingTest({ shards : 1, mongos : 1, other : options });
+st.stopBalancer();
+
+var mongos = st.s0;
+var admin = mongos.getDB( "admin" );
+var shardAdmin = st.shard0.getDB( "admin" );
+var coll = mongos.getCollection( "foo.bar" );
+
+assert.commandWorked( admin.runCommand({ enableSharding : coll.getDB() + "" }) );
+assert.commandWorked( admin.runCommand({ shardCollection : coll + "", key : { x : 1 } }) );
+
+var padding = new Array( 200 ).join( "x" );
+var bulk = coll.initializeUnorderedBulkOp();
+for ( var i = 0; i < 20000; i++ ) {
+    bulk.insert({ x : i, padding : padding });
+}
+assert.writeOK( bulk.execute() );
+
+function splitVectorCounts() {
+    var res = shardAdmin.runCommand({ serverStatus : 1 });
+    assert.commandWorked( res );
+    return res.metrics.sharding.splitVector;
+}
+
+function splitKeys() {
+    var res = shardAdmin.runCommand({ splitVector : coll + "",
+                                      keyPattern : { x : 1 },
+                                      min : { x : MinKey },
+                                      max : { x : MaxKey },
+                                      maxChunkSizeBytes : 512 * 1024 });
+    assert.commandWorked( res );
+    return res.splitKeys;
+}
+
+jsTest.log( "The first request scans the chunk..." );
+
+var before = splitVectorCounts();
+var scannedKeys = splitKeys();
+var after = splitVectorCounts();
+assert.eq( before.scanned + 1, after.scanned, tojson( after ) );
+assert.gt( scannedKeys.length, 1, tojson( scannedKeys ) );
+
+jsTest.log( "...and the next one is answered from the estimate it left behind" );
+
+var estimatedKeys = splitKeys();
+before = after;
+after = splitVectorCounts();
+assert.eq( before.estimated + 1, after.estimated, tojson( after ) );
+assert.eq( before.scanned, after.scanned, tojson( after ) );
+assert.lte( Math.abs( scannedKeys.length - estimatedKeys.length ), 1,
+            tojson( scannedKeys ) + " " + tojson( estimatedKeys ) );
+for ( var i = 1; i < estimatedKeys.length; i++ ) {
+    assert.lt( estimatedKeys[i - 1].x, estimatedKeys[i].x, tojson( estimatedKeys ) );
+}
+
+jsTest.log( "Inserts into the chunk grow the estimate..." );
+
+bulk = coll.initializeUnorderedBulkOp();
+for ( var i = 0; i < 20000; i++ ) {
+    bulk.insert({ x : 20000 + i, padding : padding });
+}
+assert.writeOK( bulk.execute() );
+
+var grownKeys = splitKeys();
+assert.gt( grownKeys.length, estimatedKeys.length + 1, tojson( grownKeys ) );
+assert.eq( after.scanned, splitVectorCounts().scanned );
+
+jsTest.log( "...and the estimate isn't used when splitVectorUseEstimates is off" );
+
+assert.commandWorked( shardAdmin.runCommand({ setParameter : 1,
+                                              splitVectorUseEstimates : false }) );
+before = splitVectorCounts();
+splitKeys();
+assert.eq( before.scanned + 1, splitVectorCounts().scanned );
+
+st.stop();
@@ -0,0 +1,41 @@
+// Test that repeated SSL connections to the same server resume their TLS session, and that
+// --sslSessionCacheSize 0 turns resumption off.  The handshake counters are reported in the
+// security section of serverStatus.
+ports = allocatePorts( 2 );
+
+var baseName = "jstests_ssl_ssl_session_resumption";
+
+function handshakes(conn) {
+    var status = conn.getDB("admin").runCommand({serverStatus: 1});
+    assert.commandWorked(status);
+    return status.security.SSLHandshakes.server;
+}
+
+function reconnect(port, times) {
+    for (var i = 0; i < times; i++) {
+        var conn = new Mongo("localhost:" + port);
+        assert.commandWorked(conn.getDB("admin").runCommand({ping: 1}));
+    }
+}
+
+var md = startMongod( "--port", ports[0], "--dbpath", MongoRunner.dataPath + baseName + "1",
+                      "--sslMode", "requireSSL",
+                      "--sslPEMKeyFile", "jstests/libs/server.pem",
+                      "--sslCAFile", "jstests/libs/ca.pem");
+
+var before = handshakes(md);
+reconnect(ports[0], 5);
+var after = handshakes(md);
+assert.gt(after.resumed, before.resumed, tojson(after));
+assert.gte(after.totalMicros, before.totalMicros, tojson(after));
+
+var md2 = startMongod( "--port", ports[1], "--dbpath", MongoRunner.dataPath + baseName + "2",
+                       "--sslMode", "requireSSL",
+                       "--sslPEMKeyFile", "jstests/libs/server.pem",
+                       "--sslCAFile", "jstests/libs/ca.pem",
+                       "--sslSessionCacheSize", "0");
+
+reconnect(ports[1], 5);
+after = handshakes(md2);
+assert.eq(0, after.resumed, tojson(after));
+assert.gte(after.full, 5, tojson(after));
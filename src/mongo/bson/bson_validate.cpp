@@ -28,7 +28,7 @@
  */
 
 #include <cstring>
-#include <deque>
+#include <vector>
 
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_validate.h"
@@ -168,10 +168,53 @@ namespace mongo {
         };
 
         /**
+         * The frames of the objects being validated. The first kInlineFrames live in the stack
+         * frame of validateBSONIterative, so that validating a document of ordinary depth doesn't
+         * allocate; deeper nesting spills into a vector.
+         */
+        class ValidationFrameStack {
+        public:
+            ValidationFrameStack() : _size(0) {}
+
+            /** Pushes a zeroed frame and returns it. */
+            ValidationObjectFrame& push() {
+                if (_size < kInlineFrames) {
+                    ValidationObjectFrame& frame = _inline[_size++];
+                    frame = ValidationObjectFrame();
+                    return frame;
+                }
+                _size++;
+                _overflow.push_back(ValidationObjectFrame());
+                return _overflow.back();
+            }
+
+            void pop() {
+                if (_size-- > kInlineFrames)
+                    _overflow.pop_back();
+            }
+
+            ValidationObjectFrame& back() {
+                return _size > kInlineFrames ? _overflow.back() : _inline[_size - 1];
+            }
+
+            size_t size() const { return _size; }
+            bool empty() const { return _size == 0; }
+
+        private:
+            static const size_t kInlineFrames = 32;
+
+            size_t _size;
+            ValidationObjectFrame _inline[kInlineFrames];
+            std::vector<ValidationObjectFrame> _overflow;
+        };
+
+        /**
+         * Sets 'name' to the element's field name unless the element is EOO.
          * WARNING: only pass in a non-EOO idElem if it has been fully validated already!
          */
         Status validateElementInfo(Buffer* buffer,
                                    ValidationState::State* nextState,
+                                   StringData* name,
                                    BSONElement idElem) {
             Status status = Status::OK();
 
@@ -184,8 +227,7 @@ namespace mongo {
                 return Status::OK();
             }
 
-            StringData name;
-            status = buffer->readCString( &name );
+            status = buffer->readCString( name );
             if ( !status.isOK() )
                 return status;
 
@@ -267,7 +309,7 @@ namespace mongo {
         }
 
         Status validateBSONIterative(Buffer* buffer) {
-            std::deque<ValidationObjectFrame> frames;
+            ValidationFrameStack frames;
             ValidationObjectFrame* curr = NULL;
             ValidationState::State state = ValidationState::BeginObj;
 
@@ -277,8 +319,7 @@ namespace mongo {
             while (state != ValidationState::Done) {
                 switch (state) {
                 case ValidationState::BeginObj:
-                    frames.push_back(ValidationObjectFrame());
-                    curr = &frames.back();
+                    curr = &frames.push();
                     curr->setStartPosition(buffer->position());
                     curr->setIsCodeWithScope(false);
                     if (!buffer->readNumber<int>(&curr->expectedSize)) {
@@ -297,14 +338,14 @@ namespace mongo {
 
                     const uint64_t elemStartPos = buffer->position();
                     ValidationState::State nextState = state;
-                    Status status = validateElementInfo(buffer, &nextState, idElem);
+                    StringData name;
+                    Status status = validateElementInfo(buffer, &nextState, &name, idElem);
                     if (!status.isOK())
                         return status;
 
-                    // we've already validated that fieldname is safe to access as long as we aren't
-                    // at the end of the object, since EOO doesn't have a fieldname.
+                    // EOO doesn't have a fieldname.
                     if (nextState != ValidationState::EndObj && idElem.eoo() && atTopLevel) {
-                        if (strcmp(buffer->getBasePtr() + elemStartPos + 1/*type*/, "_id") == 0) {
+                        if (name == "_id") {
                             idElemStartPos = elemStartPos;
                         }
                     }
@@ -317,7 +358,7 @@ namespace mongo {
                     if ( actualLength != curr->expectedSize ) {
                         return makeError("bson length doesn't match what we found", idElem);
                     }
-                    frames.pop_back();
+                    frames.pop();
                     if (frames.empty()) {
                         state = ValidationState::Done;
                     }
@@ -331,8 +372,7 @@ namespace mongo {
                     break;
                 }
                 case ValidationState::BeginCodeWScope: {
-                    frames.push_back(ValidationObjectFrame());
-                    curr = &frames.back();
+                    curr = &frames.push();
                     curr->setStartPosition(buffer->position());
                     curr->setIsCodeWithScope(true);
                     if ( !buffer->readNumber<int>( &curr->expectedSize ) )
@@ -349,7 +389,7 @@ namespace mongo {
                         return makeError("bson length for CodeWScope doesn't match what we found",
                                          idElem);
                     }
-                    frames.pop_back();
+                    frames.pop();
                     if (frames.empty())
                         return makeError("unnested CodeWScope", idElem);
                     curr = &frames.back();
@@ -292,4 +292,15 @@ namespace {
         ASSERT_NOT_OK(status);
         ASSERT_EQUALS(status.reason(), "not null terminated string in object with unknown _id");
     }
+
+    TEST(BSONValidateFast, DeeplyNested) {
+        // Deeper than the frames validateBSON keeps without allocating
+        BSONObj x = BSON("x" << 1);
+        for (int i = 0; i < 100; i++) {
+            x = BSON("a" << x << "b" << BSON_ARRAY(i));
+        }
+        ASSERT_OK(validateBSON(x.objdata(), x.objsize()));
+        ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize() - 1));
+        ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize() / 2));
+    }
 }
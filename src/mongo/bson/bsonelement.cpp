@@ -932,13 +932,14 @@ namespace mongo {
         return -1;
     }
  
-    size_t BSONElement::Hasher::operator()(const BSONElement& elem) const {
+namespace {
+    size_t hashElement(const BSONElement& elem, bool includeFieldName) {
         size_t hash = 0;
 
         boost::hash_combine(hash, elem.canonicalType());
 
         const StringData fieldName = elem.fieldNameStringData();
-        if (!fieldName.empty()) {
+        if (includeFieldName && !fieldName.empty()) {
             boost::hash_combine(hash, StringData::Hasher()(fieldName));
         }
 
@@ -1019,5 +1020,14 @@ namespace mongo {
         }
         return hash;
     }
+} // namespace
+
+    size_t BSONElement::Hasher::operator()(const BSONElement& elem) const {
+        return hashElement(elem, true);
+    }
+
+    size_t BSONElement::ValueHasher::operator()(const BSONElement& elem) const {
+        return hashElement(elem, false);
+    }
 
 } // namespace mongo
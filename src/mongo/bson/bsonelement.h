@@ -409,6 +409,14 @@ namespace mongo {
             size_t operator() (const BSONElement& elem) const;
         };
 
+        /**
+         * Like Hasher, but leaves out the field name, so that elements which are equal by
+         * woCompare(e, false) hash the same.
+         */
+        struct ValueHasher {
+            size_t operator() (const BSONElement& elem) const;
+        };
+
         const char * rawdata() const { return data; }
 
         /** 0 == Equality, just not defined yet */
@@ -172,6 +172,9 @@ namespace mongo {
         */
         bool isOwned() const { return _ownedBuffer.get() != 0; }
 
+        /** The buffer an owned object lives in, or an empty SharedBuffer if it isn't owned. */
+        const SharedBuffer& sharedBuffer() const { return _ownedBuffer; }
+
         /** assure the data buffer is under the control of this BSONObj and not a remote buffer
             @see isOwned()
         */
@@ -45,12 +45,6 @@ namespace mutablebson {
         return root().writeTo(builder);
     }
 
-    inline BSONObj Document::getObject() const {
-        BSONObjBuilder builder;
-        writeTo(&builder);
-        return builder.obj();
-    }
-
     inline Element Document::root() {
         return _root;
     }
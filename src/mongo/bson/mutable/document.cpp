@@ -31,6 +31,8 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/static_assert.hpp>
+#include <boost/thread/tss.hpp>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
@@ -611,6 +613,48 @@ namespace mutablebson {
             _objects.push_back(_leafBuilder.asTempObj());
         }
 
+        // Returns an Impl in its freshly constructed state, reusing one released earlier on
+        // this thread if there is one.
+        static Impl* acquire(Document::InPlaceMode inPlaceMode) {
+            Pool* const pool = _pool.get();
+            if (!pool || pool->free.empty())
+                return new Impl(inPlaceMode);
+            Impl* const impl = pool->free.back();
+            pool->free.pop_back();
+            impl->_inPlaceMode = inPlaceMode;
+            return impl;
+        }
+
+        // Resets 'impl' and keeps it for a later acquire on this thread, unless the pool is
+        // full or 'impl' holds on to more memory than is worth keeping.
+        static void release(Impl* impl) {
+            if (impl->retainedBytes() > kMaxPooledBytes) {
+                delete impl;
+                return;
+            }
+            Pool* pool = _pool.get();
+            if (!pool) {
+                pool = new Pool;
+                _pool.reset(pool);
+            }
+            if (pool->free.size() >= kMaxPooledImpls) {
+                delete impl;
+                return;
+            }
+            impl->reset(Document::kInPlaceDisabled);
+            pool->free.push_back(impl);
+        }
+
+        // An estimate of the serialized size of the document, used to size the buffer that
+        // getObject writes into. Elements that are still unmodified in the original object
+        // and the new leaves built since then together bound the output in the common case.
+        int serializedSizeHint() const {
+            size_t hint = _leafBuf.len();
+            for (size_t i = kLeafObjIdx + 1; i < _objects.size(); ++i)
+                hint += _objects[i].objsize();
+            return static_cast<int>(std::min<size_t>(hint, BSONObjMaxInternalSize));
+        }
+
         // Obtain the ElementRep for the given rep id.
         ElementRep& getElementRep(Element::RepIdx id) {
             return const_cast<ElementRep&>(const_cast<const Impl*>(this)->getElementRep(id));
@@ -1107,8 +1151,36 @@ namespace mutablebson {
         // Queue of damage events and status bit for whether  in-place updates are possible.
         DamageVector _damages;
         Document::InPlaceMode _inPlaceMode;
+
+        // Impls released by destroyed Documents, kept per thread so that code building one
+        // Document after another (an update per write, say) does not pay for allocating and
+        // tearing down the element vectors and leaf buffer each time.
+        struct Pool {
+            ~Pool() {
+                for (size_t i = 0; i < free.size(); ++i)
+                    delete free[i];
+            }
+            std::vector<Impl*> free;
+        };
+
+        static const size_t kMaxPooledImpls = 4;
+        static const size_t kMaxPooledBytes = 1024 * 1024;
+
+        // Heap memory this Impl would keep across a reset.
+        size_t retainedBytes() const {
+            return _slowElements.capacity() * sizeof(ElementRep) +
+                _objects.capacity() * sizeof(BSONObj) +
+                _fieldNames.capacity() +
+                static_cast<size_t>(_leafBuf.getSize()) +
+                _fieldNameScratch.capacity() +
+                _damages.capacity() * sizeof(DamageEvent);
+        }
+
+        static boost::thread_specific_ptr<Pool> _pool;
     };
 
+    boost::thread_specific_ptr<Document::Impl::Pool> Document::Impl::_pool;
+
     Status Element::addSiblingLeft(Element e) {
         verify(ok());
         verify(e.ok());
@@ -2222,13 +2294,13 @@ namespace mutablebson {
     }
 
     Document::Document()
-        : _impl(new Impl(Document::kInPlaceDisabled))
+        : _impl(Impl::acquire(Document::kInPlaceDisabled))
         , _root(makeRootElement()) {
         dassert(_root._repIdx == kRootRepIdx);
     }
 
     Document::Document(const BSONObj& value, InPlaceMode inPlaceMode)
-        : _impl(new Impl(inPlaceMode))
+        : _impl(Impl::acquire(inPlaceMode))
         , _root(makeRootElement(value)) {
         dassert(_root._repIdx == kRootRepIdx);
     }
@@ -2247,7 +2319,15 @@ namespace mutablebson {
         dassert(_root._repIdx == kRootRepIdx);
     }
 
-    Document::~Document() {}
+    Document::~Document() {
+        Impl::release(_impl);
+    }
+
+    BSONObj Document::getObject() const {
+        BSONObjBuilder builder(getImpl().serializedSizeHint());
+        writeTo(&builder);
+        return builder.obj();
+    }
 
     void Document::reserveDamageEvents(size_t expectedEvents) {
         return getImpl().reserveDamageEvents(expectedEvents);
@@ -2659,11 +2739,11 @@ namespace mutablebson {
         // pointer is non-null, but we already know that to be always and forever true, and
         // otherwise the assertion code gets spammed into every method that inlines the call to
         // this function. We just dereference the pointer returned from 'get' ourselves.
-        return *_impl.get();
+        return *_impl;
     }
 
     inline const Document::Impl& Document::getImpl() const {
-        return *_impl.get();
+        return *_impl;
     }
 
 } // namespace mutablebson
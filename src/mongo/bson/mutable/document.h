@@ -298,7 +298,7 @@ namespace mutablebson {
         /** Serialize the Elements reachable from the root Element of this Document and return
          *  the result as a BSONObj.
          */
-        inline BSONObj getObject() const;
+        BSONObj getObject() const;
 
 
         //
@@ -509,7 +509,8 @@ namespace mutablebson {
         Element makeRootElement(const BSONObj& value);
         Element makeElement(ConstElement element, const StringData* fieldName);
 
-        const boost::scoped_ptr<Impl> _impl;
+        // Owned; returned to a per-thread pool of Impls on destruction.
+        Impl* const _impl;
 
         // The root element of this document.
         const Element _root;
@@ -2461,6 +2461,36 @@ namespace {
         ASSERT_EQUALS(mongo::fromjson(outJson), doc.getObject());
     }
 
+    TEST(Document, ReusedDocumentsStartClean) {
+        // Documents created one after another on a thread reuse each other's storage, which
+        // must not leak elements, damages, or the in-place mode into the next Document.
+        {
+            mmb::Document doc(mongo::fromjson("{ a : 1, b : [ 1, 2, 3 ] }"),
+                              mmb::Document::kInPlaceEnabled);
+            ASSERT_OK(doc.root()["a"].setValueInt(2));
+            for (int i = 0; i < 500; ++i)
+                ASSERT_OK(doc.root().appendString("s", "a somewhat longer string value"));
+            ASSERT_TRUE(doc.getObject().objsize() > 500 * 30);
+        }
+        {
+            mmb::Document doc;
+            ASSERT_FALSE(doc.isInPlaceModeEnabled());
+            ASSERT_FALSE(doc.root().hasChildren());
+            ASSERT_EQUALS(mongo::BSONObj(), doc.getObject());
+        }
+        {
+            const mongo::BSONObj obj = mongo::fromjson("{ a : 1 }");
+            mmb::Document doc(obj, mmb::Document::kInPlaceEnabled);
+            ASSERT_TRUE(doc.isInPlaceModeEnabled());
+            ASSERT_OK(doc.root()["a"].setValueInt(5));
+            mmb::DamageVector damages;
+            const char* source = NULL;
+            ASSERT_TRUE(doc.getInPlaceUpdates(&damages, &source));
+            ASSERT_EQUALS(1U, damages.size());
+            ASSERT_EQUALS(mongo::fromjson("{ a : 5 }"), doc.getObject());
+        }
+    }
+
     TEST(DocumentInPlace, EphemeralDocumentsDoNotUseInPlaceMode) {
         mmb::Document doc;
         ASSERT_FALSE(doc.isInPlaceModeEnabled());
@@ -38,6 +38,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/hex.h"
 
 namespace mongo {
@@ -45,6 +46,18 @@ namespace mongo {
 namespace {
     boost::scoped_ptr<AtomicUInt32> counter;
 
+    // Threads take counter values from the shared counter in blocks of this size and hand them
+    // out locally, so concurrent inserts don't all bounce the counter's cache line.  A block is
+    // only used within the second it was reserved in: a thread can't reuse a (timestamp,
+    // counter) pair unless the whole 24-bit counter wraps within one second, as before.
+    const uint32_t kIncrementBlockSize = 256;
+
+    struct IncrementBlock {
+        OID::Timestamp timestamp;
+        uint32_t next;
+        uint32_t remaining;
+    };
+
     const std::size_t kTimestampOffset = 0;
     const std::size_t kInstanceUniqueOffset = kTimestampOffset +
                                               OID::kTimestampSize;
@@ -61,13 +74,51 @@ namespace {
         return Status::OK();
     }
 
-    OID::Increment OID::Increment::next() {
-        uint64_t nextCtr = counter->fetchAndAdd(1);
+#if defined(MONGO_HAVE___THREAD)
+    __thread IncrementBlock _incrementBlock;
+    static IncrementBlock* getIncrementBlock() {
+        return &_incrementBlock;
+    }
+#elif defined(MONGO_HAVE___DECLSPEC_THREAD)
+    __declspec( thread ) IncrementBlock _incrementBlock;
+    static IncrementBlock* getIncrementBlock() {
+        return &_incrementBlock;
+    }
+#else
+    TSP_DEFINE(IncrementBlock, _incrementBlock);
+    static IncrementBlock* getIncrementBlock() {
+        return _incrementBlock.getMake();
+    }
+#endif
+
+    /**
+     * Reserves 'count' consecutive counter values for OIDs generated at 'timestamp' by the
+     * calling thread and returns the first one.
+     */
+    static uint32_t reserveIncrements(OID::Timestamp timestamp, uint32_t count) {
+        if (count > kIncrementBlockSize) {
+            return counter->fetchAndAdd(count);
+        }
+
+        IncrementBlock* block = getIncrementBlock();
+        if (block->timestamp != timestamp || block->remaining < count) {
+            block->timestamp = timestamp;
+            block->next = counter->fetchAndAdd(kIncrementBlockSize);
+            block->remaining = kIncrementBlockSize;
+        }
+
+        const uint32_t first = block->next;
+        block->next += count;
+        block->remaining -= count;
+        return first;
+    }
+
+    OID::Increment OID::Increment::fromCounter(uint32_t counter) {
         OID::Increment incr;
 
-        incr.bytes[0] = uint8_t(nextCtr >> 16);
-        incr.bytes[1] = uint8_t(nextCtr >> 8);
-        incr.bytes[2] = uint8_t(nextCtr);
+        incr.bytes[0] = uint8_t(counter >> 16);
+        incr.bytes[1] = uint8_t(counter >> 8);
+        incr.bytes[2] = uint8_t(counter);
 
         return incr;
     }
@@ -132,13 +183,27 @@ namespace {
 
     void OID::justForked() {
         regenMachineId();
+        getIncrementBlock()->remaining = 0;
     }
 
     void OID::init() {
+        const Timestamp now = time(0);
+
         // each set* method handles endianness
-        setTimestamp(time(0));
+        setTimestamp(now);
         setInstanceUnique(_instanceUnique);
-        setIncrement(Increment::next());
+        setIncrement(Increment::fromCounter(reserveIncrements(now, 1)));
+    }
+
+    void OID::genMany(OID* oids, std::size_t count) {
+        const Timestamp now = time(0);
+
+        uint32_t next = reserveIncrements(now, uint32_t(count));
+        for (std::size_t i = 0; i < count; ++i, ++next) {
+            oids[i].setTimestamp(now);
+            oids[i].setInstanceUnique(_instanceUnique);
+            oids[i].setIncrement(Increment::fromCounter(next));
+        }
     }
 
     void OID::init( const std::string& s ) {
@@ -115,6 +115,12 @@ namespace mongo {
             return o;
         }
 
+        /**
+         * Fills 'oids' with 'count' new OIDs, e.g. the _ids of a batch insert.  They share a
+         * timestamp and have consecutive counters, as if generated one after another.
+         */
+        static void genMany(OID* oids, std::size_t count);
+
         // Caller must ensure that the buffer is valid for kOIDSize bytes.
         // this is templated because some places use unsigned char vs signed char
         template<typename T>
@@ -170,7 +176,8 @@ namespace mongo {
 
         struct Increment {
         public:
-            static Increment next();
+            // The low 3 bytes of 'counter', big endian
+            static Increment fromCounter(uint32_t counter);
             uint8_t bytes[kIncrementSize];
         };
 
@@ -27,6 +27,9 @@
 
 #include "mongo/bson/oid.h"
 
+#include <set>
+#include <vector>
+
 #include "mongo/platform/endian.h"
 #include "mongo/unittest/unittest.h"
 
@@ -103,6 +106,34 @@ namespace {
         ASSERT_EQUALS(uint8_t(oidBytes[2]), 0xDEu);
     }
 
+    uint32_t incrementToInt(const OID::Increment& i) {
+        return (uint32_t(i.bytes[0]) << 16) | (uint32_t(i.bytes[1]) << 8) | uint32_t(i.bytes[2]);
+    }
+
+    TEST(Basic, GenMany) {
+        // More than one thread-local block's worth
+        const std::size_t count = 1000;
+        std::vector<OID> oids(count);
+        OID::genMany(&oids[0], count);
+
+        for (std::size_t i = 1; i < count; ++i) {
+            ASSERT_EQUALS(oids[i].getTimestamp(), oids[0].getTimestamp());
+            ASSERT_EQUALS(incrementToInt(oids[i].getIncrement()),
+                          (incrementToInt(oids[i - 1].getIncrement()) + 1) & 0xFFFFFFu);
+        }
+
+        // Single and bulk generation draw from the same counter
+        std::set<OID> all(oids.begin(), oids.end());
+        for (std::size_t i = 0; i < count; ++i) {
+            ASSERT_TRUE(all.insert(OID::gen()).second);
+            OID few[3];
+            OID::genMany(few, 3);
+            for (std::size_t j = 0; j < 3; ++j) {
+                ASSERT_TRUE(all.insert(few[j]).second);
+            }
+        }
+    }
+
     TEST(Basic, Deserialize) {
 
         uint8_t OIDbytes[] = {
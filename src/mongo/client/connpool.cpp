@@ -37,10 +37,14 @@
 #include "mongo/client/connpool.h"
 #include "mongo/client/replica_set_monitor.h"
 #include "mongo/client/syncclusterconnection.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 #include "mongo/s/shard.h"
 
+#include <boost/thread/thread.hpp>
+
 namespace mongo {
 
     using std::endl;
@@ -56,7 +60,48 @@ namespace mongo {
         clear();
     }
 
+    int PoolForHost::getMaxPoolSize() const {
+        scoped_lock lk(_mutex);
+        return _maxPoolSize;
+    }
+
+    void PoolForHost::setMaxPoolSize( int maxPoolSize ) {
+        scoped_lock lk(_mutex);
+        _maxPoolSize = maxPoolSize;
+    }
+
+    int PoolForHost::numAvailable() const {
+        scoped_lock lk(_mutex);
+        return (int)_pool.size();
+    }
+
+    long long PoolForHost::numCreated() const {
+        scoped_lock lk(_mutex);
+        return _created;
+    }
+
+    long long PoolForHost::numReused() const {
+        scoped_lock lk(_mutex);
+        return _reused;
+    }
+
+    long long PoolForHost::totalConnectMicros() const {
+        scoped_lock lk(_mutex);
+        return _connectMicros;
+    }
+
+    ConnectionString::ConnectionType PoolForHost::type() const {
+        scoped_lock lk(_mutex);
+        verify(_created);
+        return _type;
+    }
+
     void PoolForHost::clear() {
+        scoped_lock lk(_mutex);
+        _clear();
+    }
+
+    void PoolForHost::_clear() {
         while ( ! _pool.empty() ) {
             StoredConnection sc = _pool.top();
             delete sc.conn;
@@ -65,11 +110,12 @@ namespace mongo {
     }
 
     void PoolForHost::done(DBConnectionPool* pool, DBClientBase* c) {
+        scoped_lock lk(_mutex);
 
         bool isFailed = c->isFailed();
 
         // Remember that this host had a broken connection for later
-        if (isFailed) reportBadConnectionAt(c->getSockCreationMicroSec());
+        if (isFailed) _reportBadConnectionAt(c->getSockCreationMicroSec());
 
         if (isFailed ||
             // Another (later) connection was reported as broken to this host
@@ -86,17 +132,23 @@ namespace mongo {
     }
 
     void PoolForHost::reportBadConnectionAt(uint64_t microSec) {
+        scoped_lock lk(_mutex);
+        _reportBadConnectionAt(microSec);
+    }
+
+    void PoolForHost::_reportBadConnectionAt(uint64_t microSec) {
         if (microSec != DBClientBase::INVALID_SOCK_CREATION_TIME &&
                 microSec > _minValidCreationTimeMicroSec) {
             _minValidCreationTimeMicroSec = microSec;
             log() << "Detected bad connection created at " << _minValidCreationTimeMicroSec
                     << " microSec, clearing pool for " << _hostName
                     << " of " << _pool.size() << " connections" << endl;
-            clear();
+            _clear();
         }
     }
 
     bool PoolForHost::isBadSocketCreationTime(uint64_t microSec) {
+        scoped_lock lk(_mutex);
         return microSec != DBClientBase::INVALID_SOCK_CREATION_TIME &&
                 microSec <= _minValidCreationTimeMicroSec;
     }
@@ -105,6 +157,7 @@ namespace mongo {
 
         time_t now = time(0);
         
+        scoped_lock lk(_mutex);
         while ( ! _pool.empty() ) {
             StoredConnection sc = _pool.top();
             _pool.pop();
@@ -117,6 +170,7 @@ namespace mongo {
             
             verify( sc.conn->getSoTimeout() == socketTimeout );
 
+            _reused++;
             return sc.conn;
 
         }
@@ -125,6 +179,7 @@ namespace mongo {
     }
 
     void PoolForHost::flush() {
+        scoped_lock lk(_mutex);
         while (!_pool.empty()) {
             StoredConnection c = _pool.top();
             _pool.pop();
@@ -135,6 +190,7 @@ namespace mongo {
     void PoolForHost::getStaleConnections( vector<DBClientBase*>& stale ) {
         time_t now = time(0);
 
+        scoped_lock lk(_mutex);
         vector<StoredConnection> all;
         while ( ! _pool.empty() ) {
             StoredConnection c = _pool.top();
@@ -162,18 +218,26 @@ namespace mongo {
         return conn->isStillConnected();
     }
 
-    void PoolForHost::createdOne( DBClientBase * base) {
+    void PoolForHost::createdOne( DBClientBase * base, long long connectMicros ) {
+        scoped_lock lk(_mutex);
         if ( _created == 0 )
             _type = base->type();
         _created++;
+        _connectMicros += connectMicros;
     }
 
     void PoolForHost::initializeHostName(const std::string& hostName) {
+        scoped_lock lk(_mutex);
         if (_hostName.empty()) {
             _hostName = hostName;
         }
     }
 
+    std::string PoolForHost::getHostName() const {
+        scoped_lock lk(_mutex);
+        return _hostName;
+    }
+
     // ------ DBConnectionPool ------
 
     DBConnectionPool pool;
@@ -184,27 +248,27 @@ namespace mongo {
         : _mutex("DBConnectionPool") , 
           _name( "dbconnectionpool" ) , 
           _maxPoolSize(PoolForHost::kPoolSizeUnlimited) ,
+          _minPoolSize(0) ,
           _hooks( new list<DBConnectionHook*>() ) {
     }
 
-    DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
-        uassert(17382, "Can't use connection pool during shutdown",
-                !inShutdown());
+    PoolForHost& DBConnectionPool::_getPool(const string& ident , double socketTimeout ) {
         scoped_lock L(_mutex);
         PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
         p.setMaxPoolSize(_maxPoolSize);
         p.initializeHostName(ident);
-        return p.get( this , socketTimeout );
+        return p;
     }
 
-    DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
-        {
-            scoped_lock L(_mutex);
-            PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
-            p.setMaxPoolSize(_maxPoolSize);
-            p.initializeHostName(host);
-            p.createdOne( conn );
-        }
+    DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
+        uassert(17382, "Can't use connection pool during shutdown",
+                !inShutdown());
+        return _getPool( ident , socketTimeout ).get( this , socketTimeout );
+    }
+
+    DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ,
+                                                   long long connectMicros ) {
+        _getPool( host , socketTimeout ).createdOne( conn , connectMicros );
         
         try {
             onCreate( conn );
@@ -232,10 +296,11 @@ namespace mongo {
         }
 
         string errmsg;
+        Timer connectTimer;
         c = url.connect( errmsg, socketTimeout );
         uassert( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg , c );
 
-        return _finishCreate( url.toString() , socketTimeout , c );
+        return _finishCreate( url.toString() , socketTimeout , c , connectTimer.micros() );
     }
 
     DBClientBase* DBConnectionPool::get(const string& host, double socketTimeout) {
@@ -255,10 +320,11 @@ namespace mongo {
         ConnectionString cs = ConnectionString::parse( host , errmsg );
         uassert( 13071 , (string)"invalid hostname [" + host + "]" + errmsg , cs.isValid() );
 
+        Timer connectTimer;
         c = cs.connect( errmsg, socketTimeout );
         if ( ! c )
             throw SocketException( SocketException::CONNECT_ERROR , host , 11002 , str::stream() << _name << " error: " << errmsg );
-        return _finishCreate( host , socketTimeout , c );
+        return _finishCreate( host , socketTimeout , c , connectTimer.micros() );
     }
 
     void DBConnectionPool::onRelease(DBClientBase* conn) {
@@ -274,8 +340,82 @@ namespace mongo {
     void DBConnectionPool::release(const string& host, DBClientBase *c) {
         onRelease(c);
 
+        const double socketTimeout = c->getSoTimeout();
+        const bool isFailed = c->isFailed();
+        _getPool( host , socketTimeout ).done( this , c );
+
+        // A broken connection empties the pool, so refill it before the next callers need it
+        if ( isFailed && _minPoolSize > 0 )
+            _warmUpInBackground( host , socketTimeout );
+    }
+
+    void DBConnectionPool::_warmUp( const string& ident , double socketTimeout ) {
+        const PoolKey key( ident , socketTimeout );
+        int missing;
+        {
+            scoped_lock L(_mutex);
+            if ( _minPoolSize <= 0 || inShutdown() )
+                return;
+            // Only one warm up per host at a time, or together they would overshoot
+            if ( !_warmingUp.insert( key ).second )
+                return;
+            missing = _minPoolSize;
+            if ( _maxPoolSize >= 0 && _maxPoolSize < missing )
+                missing = _maxPoolSize;
+        }
+        missing -= _getPool( ident , socketTimeout ).numAvailable();
+
+        if ( missing > 0 ) {
+            LOG(1) << "opening " << missing << " connections to " << ident
+                   << " to fill the " << _name << endl;
+
+            boost::thread_group connecting;
+            try {
+                for ( int i = 0; i < missing; i++ ) {
+                    connecting.create_thread( stdx::bind( &DBConnectionPool::_createPooled ,
+                                                          this , ident , socketTimeout ) );
+                }
+            }
+            catch ( const boost::thread_resource_error& ) {
+                // Make do with the threads that did start
+            }
+            connecting.join_all();
+        }
+
         scoped_lock L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+        _warmingUp.erase( key );
+    }
+
+    void DBConnectionPool::_createPooled( const string& ident , double socketTimeout ) {
+        string errmsg;
+        ConnectionString cs = ConnectionString::parse( ident , errmsg );
+        if ( ! cs.isValid() )
+            return;
+
+        Timer connectTimer;
+        DBClientBase* c = NULL;
+        try {
+            c = cs.connect( errmsg , socketTimeout );
+            if ( ! c ) {
+                LOG(1) << _name << " couldn't open a connection to " << ident << " : "
+                       << errmsg << endl;
+                return;
+            }
+
+            PoolForHost& p = _getPool( ident , socketTimeout );
+            p.createdOne( c , connectTimer.micros() );
+            onCreate( c );
+            p.done( this , c );
+        }
+        catch ( const std::exception& e ) {
+            LOG(1) << _name << " couldn't open a connection to " << ident << causedBy( e ) << endl;
+            delete c;
+        }
+    }
+
+    void DBConnectionPool::_warmUpInBackground( const string& ident , double socketTimeout ) {
+        boost::thread( stdx::bind( &DBConnectionPool::_warmUp , this , ident , socketTimeout ) )
+            .detach();
     }
 
 
@@ -362,6 +502,8 @@ namespace mongo {
                 BSONObjBuilder temp( bb.subobjStart( s ) );
                 temp.append( "available" , i->second.numAvailable() );
                 temp.appendNumber( "created" , i->second.numCreated() );
+                temp.appendNumber( "reused" , i->second.numReused() );
+                temp.appendNumber( "connectMicros" , i->second.totalConnectMicros() );
                 temp.done();
 
                 avail += i->second.numAvailable();
@@ -448,12 +590,9 @@ namespace mongo {
             return false;
         }
 
-        {
-            scoped_lock sl(_mutex);
-            PoolForHost& pool = _pools[PoolKey(hostName, conn->getSoTimeout())];
-            if (pool.isBadSocketCreationTime(conn->getSockCreationMicroSec())) {
-                return false;
-            }
+        PoolForHost& pool = _getPool(hostName, conn->getSoTimeout());
+        if (pool.isBadSocketCreationTime(conn->getSockCreationMicroSec())) {
+            return false;
         }
 
         return true;
@@ -461,6 +600,7 @@ namespace mongo {
 
     void DBConnectionPool::taskDoWork() { 
         vector<DBClientBase*> toDelete;
+        vector<PoolKey> used;
         
         {
             // we need to get the connections inside the lock
@@ -468,6 +608,8 @@ namespace mongo {
             scoped_lock lk( _mutex );
             for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
                 i->second.getStaleConnections( toDelete );
+                if ( i->second.numCreated() > 0 )
+                    used.push_back( i->first );
             }
         }
 
@@ -480,6 +622,10 @@ namespace mongo {
                 // we don't care if there was a socket error
             }
         }
+
+        for ( size_t i=0; i<used.size(); i++ ) {
+            _warmUp( used[i].ident , used[i].timeout );
+        }
     }
 
     // ------ ScopedDbConnection ------
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <set>
 #include <stack>
 
 #include "mongo/client/dbclientinterface.h"
@@ -37,6 +38,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/cstdint.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
@@ -44,8 +46,9 @@ namespace mongo {
     class DBConnectionPool;
 
     /**
-     * not thread safe
-     * thread safety is handled by DBConnectionPool
+     * The connections pooled for one host and socket timeout.
+     * thread safe: each host has its own mutex, so that getting and returning connections to
+     * different hosts doesn't contend. DBConnectionPool's mutex only guards its map of these.
      */
     class MONGO_CLIENT_API PoolForHost {
     public:
@@ -54,14 +57,20 @@ namespace mongo {
         static const int kPoolSizeUnlimited;
 
         PoolForHost() :
+            _mutex("PoolForHost"),
             _created(0),
+            _reused(0),
+            _connectMicros(0),
             _minValidCreationTimeMicroSec(0),
             _type(ConnectionString::INVALID),
             _maxPoolSize(kPoolSizeUnlimited) {
         }
 
         PoolForHost(const PoolForHost& other) :
+            _mutex("PoolForHost"),
             _created(other._created),
+            _reused(other._reused),
+            _connectMicros(other._connectMicros),
             _minValidCreationTimeMicroSec(other._minValidCreationTimeMicroSec),
             _type(other._type),
             _maxPoolSize(other._maxPoolSize) {
@@ -74,19 +83,32 @@ namespace mongo {
         /**
          * Returns the maximum number of connections stored in the pool
          */
-        int getMaxPoolSize() { return _maxPoolSize; }
+        int getMaxPoolSize() const;
 
         /**
          * Sets the maximum number of connections stored in the pool
          */
-        void setMaxPoolSize( int maxPoolSize ) { _maxPoolSize = maxPoolSize; }
+        void setMaxPoolSize( int maxPoolSize );
 
-        int numAvailable() const { return (int)_pool.size(); }
+        int numAvailable() const;
 
-        void createdOne( DBClientBase * base );
-        long long numCreated() const { return _created; }
+        /**
+         * Records a new connection to the host, which took 'connectMicros' to establish.
+         */
+        void createdOne( DBClientBase * base, long long connectMicros );
+        long long numCreated() const;
 
-        ConnectionString::ConnectionType type() const { verify(_created); return _type; }
+        /**
+         * Returns how many connections were handed out from the pool rather than created.
+         */
+        long long numReused() const;
+
+        /**
+         * Returns the total time spent establishing the connections created.
+         */
+        long long totalConnectMicros() const;
+
+        ConnectionString::ConnectionType type() const;
 
         /**
          * gets a connection or return NULL
@@ -119,8 +141,14 @@ namespace mongo {
          */
         void initializeHostName(const std::string& hostName);
 
+        std::string getHostName() const;
+
     private:
 
+        // These do the work of the public methods of the same name, with _mutex already held.
+        void _clear();
+        void _reportBadConnectionAt(uint64_t microSec);
+
         struct StoredConnection {
             StoredConnection( DBClientBase * c );
 
@@ -130,10 +158,14 @@ namespace mongo {
             time_t when;
         };
 
+        mutable mongo::mutex _mutex;
+
         std::string _hostName;
         std::stack<StoredConnection> _pool;
 
         int64_t _created;
+        int64_t _reused;
+        int64_t _connectMicros;
         uint64_t _minValidCreationTimeMicroSec;
         ConnectionString::ConnectionType _type;
 
@@ -191,6 +223,18 @@ namespace mongo {
          */
         void setMaxPoolSize( int maxPoolSize ) { _maxPoolSize = maxPoolSize; }
 
+        /**
+         * Returns the number of connections kept open per-host.
+         */
+        int getMinPoolSize() { return _minPoolSize; }
+
+        /**
+         * Sets the number of connections kept open per-host once a host has been used. Missing
+         * connections are opened in parallel by the periodic cleaner, and straight away when a
+         * bad connection to the host made the pool drop the rest.
+         */
+        void setMinPoolSize( int minPoolSize ) { _minPoolSize = minPoolSize; }
+
         void onCreate( DBClientBase * conn );
         void onHandedOut( DBClientBase * conn );
         void onDestroy( DBClientBase * conn );
@@ -238,7 +282,29 @@ namespace mongo {
 
         DBClientBase* _get( const std::string& ident , double socketTimeout );
 
-        DBClientBase* _finishCreate( const std::string& ident , double socketTimeout, DBClientBase* conn );
+        DBClientBase* _finishCreate( const std::string& ident , double socketTimeout, DBClientBase* conn,
+                                     long long connectMicros );
+
+        /**
+         * Returns the pool for the key, creating it if needed. Pools are never removed from
+         * _pools, so the reference stays valid.
+         */
+        PoolForHost& _getPool( const std::string& ident , double socketTimeout );
+
+        /**
+         * Opens connections to the host in parallel until its pool holds _minPoolSize.
+         */
+        void _warmUp( const std::string& ident , double socketTimeout );
+
+        /**
+         * Connects to 'ident' and adds the connection to its pool, for _warmUp().
+         */
+        void _createPooled( const std::string& ident , double socketTimeout );
+
+        /**
+         * Runs _warmUp() for the host on its own thread.
+         */
+        void _warmUpInBackground( const std::string& ident , double socketTimeout );
 
         struct PoolKey {
             PoolKey( const std::string& i , double t ) : ident( i ) , timeout( t ) {}
@@ -260,8 +326,14 @@ namespace mongo {
         // 0 effectively disables the pool
         int _maxPoolSize;
 
+        // The number of connections _warmUp() keeps open per-host, 0 to not open any ahead
+        int _minPoolSize;
+
         PoolMap _pools;
 
+        // The pools that _warmUp() is filling
+        std::set<PoolKey,poolKeyCompare> _warmingUp;
+
         // pointers owned by me, right now they leak on shutdown
         // _hooks itself also leaks because it creates a shutdown race condition
         std::list<DBConnectionHook*> * _hooks;
@@ -1074,10 +1074,42 @@ namespace mongo {
         int sslModeVal = sslGlobalParams.sslMode.load();
         if (sslModeVal == SSLGlobalParams::SSLMode_preferSSL ||
             sslModeVal == SSLGlobalParams::SSLMode_requireSSL) {
-            return p->secure( sslManager(), _server.host() );
+            if ( !p->secure( sslManager(), _server.host() ) ) {
+                return false;
+            }
         }
 #endif
 
+        if ( !_compressors.empty() ) {
+            return _negotiateCompression( errmsg );
+        }
+
+        return true;
+    }
+
+    bool DBClientConnection::_negotiateCompression( string& errmsg ) {
+        BSONObjBuilder cmd;
+        cmd.append("isMaster", 1);
+        appendMessageCompressionRequest(_compressors, &cmd);
+
+        BSONObj info;
+        try {
+            // Servers which don't know about compression ignore the extra field
+            DBClientWithCommands::runCommand("admin", cmd.obj(), info);
+        }
+        catch ( const DBException& e ) {
+            errmsg = str::stream() << "couldn't negotiate compression with " << toString()
+                                   << ": " << e.toString();
+            _failed = true;
+            return false;
+        }
+
+        const MessageCompressor compressor = negotiatedMessageCompressor(info);
+        p->setCompressor(compressor);
+        if ( compressor != MessageCompressor_none ) {
+            LOG( 1 ) << "compressing messages to " << toString() << " with "
+                     << messageCompressorName(compressor) << endl;
+        }
         return true;
     }
 
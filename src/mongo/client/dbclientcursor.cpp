@@ -33,6 +33,8 @@
 
 #include "mongo/client/dbclientcursor.h"
 
+#include <algorithm>
+
 #include "mongo/client/connpool.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/namespace_string.h"
@@ -41,6 +43,7 @@
 #include "mongo/util/debug_util.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -55,15 +58,15 @@ namespace mongo {
         _originalHost = _client->getServerAddress();
     }
 
-    int DBClientCursor::nextBatchSize() {
+    int DBClientCursor::batchSizeFor( int toReturn ) const {
 
-        if ( nToReturn == 0 )
+        if ( toReturn == 0 )
             return batchSize;
 
         if ( batchSize == 0 )
-            return nToReturn;
+            return toReturn;
 
-        return batchSize < nToReturn ? batchSize : nToReturn;
+        return batchSize < toReturn ? batchSize : toReturn;
     }
 
     void DBClientCursor::_assembleInit( Message& toSend ) {
@@ -157,6 +160,16 @@ namespace mongo {
     void DBClientCursor::requestMore() {
         verify( cursorId && batch.pos == batch.nReturned );
 
+        if ( _readAheadPending || _readAheadReply.get() ) {
+            readAheadRequestMore();
+            return;
+        }
+
+        if ( _getMoresInFlight > 1 || !_pendingGetMores.empty() ) {
+            pipelinedRequestMore();
+            return;
+        }
+
         if (haveLimit) {
             nToReturn -= batch.nReturned;
             verify(nToReturn > 0);
@@ -172,7 +185,9 @@ namespace mongo {
         auto_ptr<Message> response(new Message());
 
         if ( _client ) {
+            const unsigned long long start = curTimeMicros64();
             _client->call( toSend, *response );
+            _lastGetMoreMicros = curTimeMicros64() - start;
             this->batch.m = response;
             dataReceived();
         }
@@ -188,6 +203,170 @@ namespace mongo {
         }
     }
 
+    void DBClientCursor::pipelinedRequestMore() {
+        verify( _client );
+        verify( tailable() );
+        verify( !haveLimit );
+
+        while ( static_cast<int>( _pendingGetMores.size() ) < std::max( _getMoresInFlight, 1 ) ) {
+            BufBuilder b;
+            b.appendNum(opts);
+            b.appendStr(ns);
+            b.appendNum(nextBatchSize());
+            b.appendNum(cursorId);
+
+            Message toSend;
+            toSend.setData(dbGetMore, b.buf(), b.len());
+            _client->say( toSend );
+            _pendingGetMores.push_back( std::make_pair( toSend.header().getId(),
+                                                        curTimeMicros64() ) );
+        }
+
+        auto_ptr<Message> response(new Message());
+        if ( !_client->recv( *response ) ) {
+            _pendingGetMores.clear();
+            uasserted( 28613, "recv failed while tailing cursor" );
+        }
+
+        const std::pair<MSGID, unsigned long long> sent = _pendingGetMores.front();
+        _pendingGetMores.pop_front();
+        if ( response->header().getResponseTo() != sent.first ) {
+            _pendingGetMores.clear();
+            uasserted( 28614, str::stream() << "getMore reply out of order, expected a reply to "
+                                            << sent.first << " but got one to "
+                                            << response->header().getResponseTo() );
+        }
+        _lastGetMoreMicros = curTimeMicros64() - sent.second;
+
+        batch.m = response;
+        dataReceived();
+
+        if ( cursorId == 0 ) {
+            // The rest can only report that the cursor is gone
+            drainGetMores();
+        }
+    }
+
+    void DBClientCursor::drainGetMores() {
+        while ( !_pendingGetMores.empty() ) {
+            Message response;
+            if ( !_client->recv( response ) ) {
+                _pendingGetMores.clear();
+                return;
+            }
+            _pendingGetMores.pop_front();
+        }
+    }
+
+    void DBClientCursor::maybeReadAhead() {
+        if ( !_readAhead || _readAheadPending || _readAheadReply.get() || !cursorId ) {
+            return;
+        }
+
+        if ( tailable() || ( opts & QueryOption_Exhaust ) ) {
+            return;
+        }
+
+        // Pipelined getMores already keep the connection busy
+        if ( _getMoresInFlight > 1 || !_pendingGetMores.empty() ) {
+            return;
+        }
+
+        // Send once half the batch has been consumed
+        if ( batch.pos * 2 < batch.nReturned ) {
+            return;
+        }
+
+        int toReturn = nToReturn;
+        if ( haveLimit ) {
+            toReturn -= batch.nReturned;
+            if ( toReturn <= 0 ) {
+                return;
+            }
+        }
+
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(batchSizeFor(toReturn));
+        b.appendNum(cursorId);
+
+        Message toSend;
+        toSend.setData(dbGetMore, b.buf(), b.len());
+
+        if ( _client ) {
+            _client->say( toSend );
+        }
+        else {
+            verify( _scopedHost.size() );
+            boost::shared_ptr<ScopedDbConnection> conn( new ScopedDbConnection( _scopedHost ) );
+            conn->get()->say( toSend );
+            _readAheadConn = conn;
+        }
+
+        _readAheadPending = true;
+        _readAheadId = toSend.header().getId();
+        _readAheadSentMicros = curTimeMicros64();
+    }
+
+    auto_ptr<Message> DBClientCursor::recvReadAhead() {
+        verify( _readAheadPending );
+        _readAheadPending = false;
+
+        // Only returned to the pool once the reply has been read
+        boost::shared_ptr<ScopedDbConnection> conn;
+        conn.swap( _readAheadConn );
+        DBClientBase* client = conn ? conn->get() : _client;
+        verify( client );
+
+        auto_ptr<Message> response(new Message());
+        if ( !client->recv( *response ) ) {
+            uasserted( 28634, "recv failed while reading ahead on cursor" );
+        }
+
+        if ( response->header().getResponseTo() != _readAheadId ) {
+            uasserted( 28635, str::stream() << "getMore reply out of order, expected a reply to "
+                                            << _readAheadId << " but got one to "
+                                            << response->header().getResponseTo() );
+        }
+        _lastGetMoreMicros = curTimeMicros64() - _readAheadSentMicros;
+
+        if ( conn ) {
+            conn->done();
+        }
+        return response;
+    }
+
+    void DBClientCursor::readAheadRequestMore() {
+        if (haveLimit) {
+            nToReturn -= batch.nReturned;
+            verify(nToReturn > 0);
+        }
+
+        auto_ptr<Message> response;
+        if ( _readAheadReply.get() ) {
+            response = _readAheadReply;
+        }
+        else {
+            response = recvReadAhead();
+        }
+
+        if ( _client ) {
+            this->batch.m = response;
+            dataReceived();
+        }
+        else {
+            // dataReceived() checks the reply through a connection to the host
+            verify( _scopedHost.size() );
+            ScopedDbConnection conn(_scopedHost);
+            _client = conn.get();
+            this->batch.m = response;
+            dataReceived();
+            _client = 0;
+            conn.done();
+        }
+    }
+
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
     void DBClientCursor::exhaustReceiveMore() {
         verify( cursorId && batch.pos == batch.nReturned );
@@ -275,6 +454,8 @@ namespace mongo {
         BSONObj o(batch.data);
         batch.data += o.objsize();
         /* todo would be good to make data null at end of batch for safety */
+
+        maybeReadAhead();
         return o;
     }
 
@@ -338,6 +519,11 @@ namespace mongo {
         verify( conn );
         verify( conn->get() );
 
+        if ( _readAheadPending && !_readAheadConn ) {
+            // The reply is due on the connection we are about to give up
+            _readAheadReply = recvReadAhead();
+        }
+
         if ( conn->get()->type() == ConnectionString::SET ||
              conn->get()->type() == ConnectionString::SYNC ) {
             if( _lazyHost.size() > 0 )
@@ -359,6 +545,15 @@ namespace mongo {
     DBClientCursor::~DBClientCursor() {
         DESTRUCTOR_GUARD (
 
+        if ( !_pendingGetMores.empty() && !inShutdown() ) {
+            // Leave the connection ready for whoever uses it next
+            drainGetMores();
+        }
+
+        if ( _readAheadPending && !inShutdown() ) {
+            recvReadAhead();
+        }
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
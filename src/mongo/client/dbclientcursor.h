@@ -30,6 +30,8 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <deque>
 #include <stack>
 
 #include "mongo/client/dbclientinterface.h"
@@ -41,6 +43,7 @@
 namespace mongo {
 
     class AScopedConnection;
+    class ScopedDbConnection;
 
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here
         @see DBClientMockCursor
@@ -69,6 +72,9 @@ namespace mongo {
         int objsLeftInBatch() const { _assertIfNull(); return _putBack.size() + batch.nReturned - batch.pos; }
         bool moreInCurrentBatch() { return objsLeftInBatch() > 0; }
 
+        /** The size in bytes of the batch currently held from the server. */
+        int bufferedBytes() const { return batch.m->empty() ? 0 : batch.m->size(); }
+
         /** next
            @return next object in the result cursor.
            on an error at the remote server, you will get back:
@@ -136,6 +142,33 @@ namespace mongo {
         /// Change batchSize after construction. Can change after requesting first batch.
         void setBatchSize(int newBatchSize) { batchSize = newBatchSize; }
 
+        /**
+         * For tailable cursors on a DBClientConnection: when more() needs another batch, send
+         * getMores ahead so that up to 'n' are outstanding, and the following batches are
+         * already on their way while this one is consumed.  The server answers them in order.
+         * Each uses the batch size set when it is sent.  1, the default, sends one at a time.
+         */
+        void setGetMoresInFlight(int n) { _getMoresInFlight = n; }
+
+        /**
+         * Read ahead: once half of the current batch has been consumed, send the getMore for the
+         * next one without waiting for its reply, so the server produces the next batch while
+         * this one is processed.  At most one batch is read ahead.  Ignored for tailable and
+         * exhaust cursors.
+         *
+         * The cursor's connection must not be used for anything else while the cursor is open:
+         * the reply to the getMore sent ahead is the next message it will read.  An attached
+         * cursor (see attach()) holds a pooled connection while a getMore is outstanding.
+         */
+        void setReadAhead(bool readAhead) { _readAhead = readAhead; }
+
+        /**
+         * Microseconds from sending the getMore for the current batch to receiving its reply.
+         * With several in flight this includes the time the server spent answering the ones
+         * ahead of it.
+         */
+        long long lastGetMoreMicros() const { return _lastGetMoreMicros; }
+
         DBClientCursor( DBClientBase* client, const std::string &_ns, BSONObj _query, int _nToReturn,
                         int _nToSkip, const BSONObj *_fieldsToReturn, int queryOptions , int bs ) :
             _client(client),
@@ -150,7 +183,13 @@ namespace mongo {
             resultFlags(0),
             cursorId(),
             _ownCursor( true ),
-            wasError( false ) {
+            wasError( false ),
+            _getMoresInFlight( 1 ),
+            _lastGetMoreMicros( 0 ),
+            _readAhead( false ),
+            _readAheadPending( false ),
+            _readAheadId( 0 ),
+            _readAheadSentMicros( 0 ) {
             _finishConsInit();
         }
 
@@ -166,7 +205,13 @@ namespace mongo {
             resultFlags(0),
             cursorId(_cursorId),
             _ownCursor(true),
-            wasError(false) {
+            wasError(false),
+            _getMoresInFlight(1),
+            _lastGetMoreMicros(0),
+            _readAhead(false),
+            _readAheadPending(false),
+            _readAheadId(0),
+            _readAheadSentMicros(0) {
             _finishConsInit();
         }
 
@@ -219,7 +264,8 @@ namespace mongo {
         friend class DBClientBase;
         friend class DBClientConnection;
 
-        int nextBatchSize();
+        int nextBatchSize() { return batchSizeFor( nToReturn ); }
+        int batchSizeFor( int toReturn ) const;
         void _finishConsInit();
 
         Batch batch;
@@ -244,8 +290,29 @@ namespace mongo {
         void dataReceived() { bool retry; std::string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, std::string& lazyHost );
         void requestMore();
+        void pipelinedRequestMore();
+        void drainGetMores();
+
+        int _getMoresInFlight;
+        long long _lastGetMoreMicros;
+        // Ids and send times of the getMores sent ahead whose replies haven't been read yet
+        std::deque< std::pair<MSGID, unsigned long long> > _pendingGetMores;
         void exhaustReceiveMore(); // for exhaust
 
+        // Read ahead, see setReadAhead()
+        bool _readAhead;
+        // A getMore was sent ahead and its reply not read yet
+        bool _readAheadPending;
+        MSGID _readAheadId;
+        unsigned long long _readAheadSentMicros;
+        // The pooled connection the getMore went out on if the cursor is attached
+        boost::shared_ptr<ScopedDbConnection> _readAheadConn;
+        // The reply to the getMore sent ahead, if it had to be read before it was needed
+        std::auto_ptr<Message> _readAheadReply;
+        void maybeReadAhead();
+        std::auto_ptr<Message> recvReadAhead();
+        void readAheadRequestMore();
+
         // Don't call from a virtual function
         void _assertIfNull() const { uassert(13348, "connection died", this); }
 
@@ -44,6 +44,7 @@
 #include "mongo/stdx/functional.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/message_port.h"
 
 namespace mongo {
@@ -1239,7 +1240,8 @@ namespace mongo {
            Connect timeout is fixed, but short, at 5 seconds.
          */
         DBClientConnection(bool _autoReconnect=false, DBClientReplicaSet* cp=0, double so_timeout=0) :
-            clientSet(cp), _failed(false), autoReconnect(_autoReconnect), autoReconnectBackoff(1000, 2000), _so_timeout(so_timeout) {
+            clientSet(cp), _failed(false), autoReconnect(_autoReconnect), autoReconnectBackoff(1000, 2000), _so_timeout(so_timeout),
+            _compressors(enabledMessageCompressors()) {
             _numConnections.fetchAndAdd(1);
         }
 
@@ -1352,6 +1354,20 @@ namespace mongo {
 
         uint64_t getSockCreationMicroSec() const;
 
+        /**
+         * Sets the compressors to offer the server, in order of preference, when this next
+         * connects.  Defaults to those enabled by the networkMessageCompressors server parameter;
+         * empty means don't compress.
+         */
+        void setCompressors(const std::vector<std::string>& compressors) {
+            _compressors = compressors;
+        }
+
+        /** The compressor the server picked for this connection, if any. */
+        MessageCompressor getCompressor() const {
+            return p ? p->compressor() : MessageCompressor_none;
+        }
+
     protected:
         friend class SyncClusterConnection;
         virtual void _auth(const BSONObj& params);
@@ -1373,7 +1389,9 @@ namespace mongo {
 
         std::map<std::string, BSONObj> authCache;
         double _so_timeout;
+        std::vector<std::string> _compressors;
         bool _connect( std::string& errmsg );
+        bool _negotiateCompression( std::string& errmsg );
 
         static AtomicInt32 _numConnections;
         static bool _lazyKillCursor; // lazy means we piggy back kill cursors on next op
@@ -42,6 +42,7 @@
 #endif
 
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/util/md5.hpp"
 
 #ifndef MIN
 #define MIN(a,b) ( (a) < (b) ? (a) : (b) )
@@ -57,8 +58,10 @@ namespace mongo {
     using std::ofstream;
     using std::ostream;
     using std::string;
+    using std::vector;
 
     const unsigned DEFAULT_CHUNK_SIZE = 255 * 1024;
+    const unsigned DEFAULT_CHUNKS_IN_FLIGHT = 8;
 
     GridFSChunk::GridFSChunk( BSONObj o ) {
         _data = o;
@@ -77,6 +80,7 @@ namespace mongo {
         _filesNS = dbName + "." + prefix + ".files";
         _chunksNS = dbName + "." + prefix + ".chunks";
         _chunkSize = DEFAULT_CHUNK_SIZE;
+        _chunksInFlight = DEFAULT_CHUNKS_IN_FLIGHT;
 
         client.ensureIndex( _filesNS , BSON( "filename" << 1 ) );
         client.ensureIndex( _chunksNS , BSON( "files_id" << 1 << "n" << 1 ) , /*unique=*/true );
@@ -95,6 +99,24 @@ namespace mongo {
         return _chunkSize;
     }
 
+    void GridFS::setChunksInFlight(unsigned int n) {
+        massert( 28637 , "invalid number of chunks in flight is specified", (n != 0 ));
+        _chunksInFlight = n;
+    }
+
+    unsigned int GridFS::getChunksInFlight() const {
+        return _chunksInFlight;
+    }
+
+    void GridFS::insertChunks(vector<BSONObj>* chunks, int* chunkBytes) {
+        if (chunks->empty())
+            return;
+
+        _client.insert( _chunksNS , *chunks );
+        chunks->clear();
+        *chunkBytes = 0;
+    }
+
     BSONObj GridFS::storeFile( const char* data , size_t length , const string& remoteName , const string& contentType) {
         char const * const end = data + length;
 
@@ -102,17 +124,33 @@ namespace mongo {
         id.init();
         BSONObj idObj = BSON("_id" << id);
 
+        // The md5 is taken as the chunks go out, rather than with filemd5 once they are all in
+        md5_state_t md5;
+        md5_init(&md5);
+
+        vector<BSONObj> chunks;
+        int chunkBytes = 0;
+
         int chunkNumber = 0;
         while (data < end) {
             int chunkLen = MIN(_chunkSize, (unsigned)(end-data));
             GridFSChunk c(idObj, chunkNumber, data, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
+            md5_append(&md5, reinterpret_cast<const md5_byte_t*>(data), chunkLen);
+
+            chunks.push_back(c._data);
+            chunkBytes += c._data.objsize();
+            if (chunks.size() >= _chunksInFlight || chunkBytes >= BSONObjMaxUserSize)
+                insertChunks(&chunks, &chunkBytes);
 
             chunkNumber++;
             data += chunkLen;
         }
+        insertChunks(&chunks, &chunkBytes);
 
-        return insertFile(remoteName, id, length, contentType);
+        md5digest digest;
+        md5_finish(&md5, digest);
+
+        return insertFile(remoteName, id, length, contentType, digestToString(digest));
     }
 
 
@@ -130,6 +168,12 @@ namespace mongo {
         id.init();
         BSONObj idObj = BSON("_id" << id);
 
+        md5_state_t md5;
+        md5_init(&md5);
+
+        vector<BSONObj> chunks;
+        int chunkBytes = 0;
+
         int chunkNumber = 0;
         gridfs_offset length = 0;
         while (!feof(fd)) {
@@ -146,20 +190,31 @@ namespace mongo {
             }
 
             GridFSChunk c(idObj, chunkNumber, buf, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
+            md5_append(&md5, reinterpret_cast<const md5_byte_t*>(buf), chunkLen);
+
+            chunks.push_back(c._data);
+            chunkBytes += c._data.objsize();
+            if (chunks.size() >= _chunksInFlight || chunkBytes >= BSONObjMaxUserSize)
+                insertChunks(&chunks, &chunkBytes);
 
             length += chunkLen;
             chunkNumber++;
             delete[] buf;
         }
+        insertChunks(&chunks, &chunkBytes);
 
         if (fd != stdin)
             fclose( fd );
 
-        return insertFile((remoteName.empty() ? fileName : remoteName), id, length, contentType);
+        md5digest digest;
+        md5_finish(&md5, digest);
+
+        return insertFile((remoteName.empty() ? fileName : remoteName), id, length, contentType,
+                          digestToString(digest));
     }
 
-    BSONObj GridFS::insertFile(const string& name, const OID& id, gridfs_offset length, const string& contentType) {
+    BSONObj GridFS::insertFile(const string& name, const OID& id, gridfs_offset length,
+                               const string& contentType, const string& md5) {
         // Wait for any pending writebacks to finish
         BSONObj errObj = _client.getLastErrorDetailed();
         uassert( 16428,
@@ -167,16 +222,12 @@ namespace mongo {
                                << ", error: " << errObj,
                  DBClientWithCommands::getLastErrorString(errObj) == "" );
 
-        BSONObj res;
-        if ( ! _client.runCommand( _dbName.c_str() , BSON( "filemd5" << id << "root" << _prefix ) , res ) )
-            throw UserException( 9008 , "filemd5 failed" );
-
         BSONObjBuilder file;
         file << "_id" << id
              << "filename" << name
              << "chunkSize" << _chunkSize
              << "uploadDate" << DATENOW
-             << "md5" << res["md5"]
+             << "md5" << md5
              ;
 
         if (length < 1024*1024*1024) { // 2^30
@@ -249,18 +300,59 @@ namespace mongo {
 
     gridfs_offset GridFile::write( ostream & out ) const {
         _exists();
+        return write( out , 0 , getContentLength() );
+    }
+
+    gridfs_offset GridFile::write( ostream & out , gridfs_offset offset , gridfs_offset length ) const {
+        _exists();
 
-        const int num = getNumChunks();
+        const gridfs_offset contentLength = getContentLength();
+        if ( offset >= contentLength || length == 0 )
+            return 0;
+        if ( length > contentLength - offset )
+            length = contentLength - offset;
 
-        for ( int i=0; i<num; i++ ) {
-            GridFSChunk c = getChunk( i );
+        const gridfs_offset end = offset + length;
+        const gridfs_offset chunkSize = getChunkSize();
+        uassert( 28638 , "invalid chunk size" , chunkSize > 0 );
+
+        const int firstChunk = (int)( offset / chunkSize );
+        const int lastChunk = (int)( ( end - 1 ) / chunkSize );
+
+        BSONObjBuilder b;
+        b.appendAs( _obj["_id"] , "files_id" );
+        b.append( "n" , BSON( "$gte" << firstChunk << "$lte" << lastChunk ) );
+
+        // One query streams the chunks back a batch at a time, with the next batch requested
+        // while the current one is written out
+        auto_ptr<DBClientCursor> cursor = _grid->_client.query( _grid->_chunksNS ,
+                                                                Query( b.obj() ).sort( "n" ) ,
+                                                                0 , 0 , 0 , 0 ,
+                                                                _grid->_chunksInFlight );
+        uassert( 28639 , "could not query chunks" , cursor.get() );
+        cursor->setReadAhead( true );
+
+        gridfs_offset pos = (gridfs_offset)firstChunk * chunkSize;
+        for ( int n = firstChunk; n <= lastChunk; n++ ) {
+            uassert( 10014 ,  "chunk is empty!" , cursor->more() );
+            BSONObj o = cursor->nextSafe();
+            uassert( 28640 , str::stream() << "missing chunk " << n << " of file "
+                                           << getFilename() ,
+                     o["n"].numberInt() == n );
 
             int len;
-            const char * data = c.data( len );
-            out.write( data , len );
+            const char * data = GridFSChunk( o ).data( len );
+
+            // Only the part of the chunk inside the range is written
+            const gridfs_offset from = std::max( pos , offset );
+            const gridfs_offset to = std::min( pos + len , end );
+            if ( to > from )
+                out.write( data + ( from - pos ) , to - from );
+
+            pos += len;
         }
 
-        return getContentLength();
+        return length;
     }
 
     gridfs_offset GridFile::write( const string& where ) const {
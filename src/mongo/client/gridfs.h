@@ -83,6 +83,14 @@ namespace mongo {
 
         unsigned int getChunkSize() const;
 
+        /**
+         * Sets how many chunks are sent to the server in one insert when storing a file, and
+         * requested in one batch when reading one back.
+         */
+        void setChunksInFlight(unsigned int n);
+
+        unsigned int getChunksInFlight() const;
+
         /**
          * puts the file reference by fileName into the db
          * @param fileName local filename relative to process
@@ -139,9 +147,14 @@ namespace mongo {
         std::string _filesNS;
         std::string _chunksNS;
         unsigned int _chunkSize;
+        unsigned int _chunksInFlight;
+
+        // sends the buffered chunks to the server in one insert and clears them
+        void insertChunks(std::vector<BSONObj>* chunks, int* chunkBytes);
 
         // insert fileobject. All chunks must be in DB.
-        BSONObj insertFile(const std::string& name, const OID& id, gridfs_offset length, const std::string& contentType);
+        BSONObj insertFile(const std::string& name, const OID& id, gridfs_offset length,
+                           const std::string& contentType, const std::string& md5);
 
         friend class GridFile;
     };
@@ -200,6 +213,14 @@ namespace mongo {
          */
         gridfs_offset write( std::ostream & out ) const;
 
+        /**
+           write length bytes of the file starting at offset to the output stream, fetching only
+           the chunks they are stored in
+           @return the number of bytes written, which is less than length if the range runs
+                   past the end of the file
+         */
+        gridfs_offset write( std::ostream & out , gridfs_offset offset , gridfs_offset length ) const;
+
         /**
            write the file to this filename
          */
@@ -42,6 +42,7 @@
 #include "mongo/client/replica_set_monitor.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/query/lite_parsed_query.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
@@ -62,6 +63,9 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    // Have shard cursors request their next batch while the current one is being merged
+    MONGO_EXPORT_SERVER_PARAMETER(shardCursorReadAhead, bool, false);
+
     LabeledLevel pc( "pcursor", 2 );
 
     void ParallelSortClusteredCursor::init() {
@@ -792,6 +796,8 @@ namespace mongo {
                                                                  _qSpec.options(), // options
                                                                  0 ) ); // batchSize
                     }
+
+                    state->cursor->setReadAhead( shardCursorReadAhead );
                 }
 
                 bool lazyInit = state->conn->get()->lazySupported();
@@ -1483,6 +1489,18 @@ namespace mongo {
         }
     }
 
+    long long ParallelSortClusteredCursor::getBufferedBytes() const {
+        if (!_cursors)
+            return 0;
+
+        long long bytes = 0;
+        for ( int i=0; i<_numServers; i++ ) {
+            if (_cursors[i].get())
+                bytes += _cursors[i].get()->bufferedBytes();
+        }
+        return bytes;
+    }
+
     bool ParallelSortClusteredCursor::more() {
 
         if ( _needToSkip > 0 ) {
@@ -212,6 +212,11 @@ namespace mongo {
          */
         void setBatchSize(int newBatchSize);
 
+        /**
+         * Returns the bytes held in the batches received from the shards.
+         */
+        long long getBufferedBytes() const;
+
         /**
          * Returns whether the collection was sharded when the cursors were established.
          */
@@ -76,6 +76,26 @@ namespace {
 
     const double socketTimeoutSecs = 5;
 
+    /**
+     * Sends isMaster to host. Returns the reply, or an empty object if the host couldn't be
+     * reached, and sets pingMicros to the round trip time.
+     */
+    BSONObj sendIsMaster(const HostAndPort& host, int64_t* pingMicros) {
+        BSONObj reply; // empty on error
+        try {
+            ScopedDbConnection conn(ConnectionString(host), socketTimeoutSecs);
+            bool ignoredOutParam = false;
+            Timer timer;
+            conn->isMaster(ignoredOutParam, &reply);
+            *pingMicros = timer.micros();
+            conn.done(); // return to pool on success.
+        }
+        catch (...) {
+            reply = BSONObj(); // should be a no-op but want to be sure
+        }
+        return reply;
+    }
+
     /*  Replica Set Monitor shared state:
      *      If a program (such as one built with the C++ driver) exits (by either calling exit()
      *      or by returning from main()), static objects will be destroyed in the reverse order
@@ -270,6 +290,8 @@ namespace {
     // Defaults to random selection as required by the spec
     bool ReplicaSetMonitor::useDeterministicHostSelection = false;
 
+    int ReplicaSetMonitor::maxParallelHostChecks = 8;
+
     ReplicaSetMonitor::ReplicaSetMonitor(StringData name, const std::set<HostAndPort>& seeds)
             : _state(boost::make_shared<SetState>(name, seeds)) {
         LogstreamBuilder lsb = log();
@@ -492,6 +514,12 @@ namespace {
         _startedNewScan = true;
     }
 
+    Refresher::Refresher(const SetStatePtr& setState, const ScanStatePtr& scan)
+            : _set(setState)
+            , _scan(scan)
+            , _startedNewScan(false) {
+    }
+
     Refresher::NextStep Refresher::getNextStep() {
         if (_scan != _set->currentScan)
             return NextStep(NextStep::DONE); // No longer the current scan.
@@ -767,22 +795,25 @@ namespace {
                 continue;
 
             case NextStep::CONTACT_HOST: {
-                BSONObj reply; // empty on error
+                // Check the other hosts waiting to be scanned at the same time. Their replies
+                // are applied as they arrive and wake us through the condition variable.
+                for (int i = 1; i < ReplicaSetMonitor::maxParallelHostChecks
+                                && !_scan->hostsToScan.empty(); i++) {
+                    const NextStep other = getNextStep();
+                    invariant(other.step == NextStep::CONTACT_HOST);
+                    if (!_checkHostInBackground(other.host)) {
+                        // Leave it for this thread to contact later
+                        _scan->waitingFor.erase(other.host);
+                        _scan->hostsToScan.push_back(other.host);
+                        break;
+                    }
+                }
+
                 int64_t pingMicros = 0;
 
                 DEV _set->checkInvariants();
                 lk.unlock(); // relocked after attempting to call isMaster
-                try {
-                    ScopedDbConnection conn(ConnectionString(ns.host), socketTimeoutSecs);
-                    bool ignoredOutParam = false;
-                    Timer timer;
-                    conn->isMaster(ignoredOutParam, &reply);
-                    pingMicros = timer.micros();
-                    conn.done(); // return to pool on success.
-                }
-                catch (...) {
-                    reply = BSONObj(); // should be a no-op but want to be sure
-                }
+                const BSONObj reply = sendIsMaster(ns.host, &pingMicros);
                 lk.lock();
 
                 // Ignore the reply and return if we are no longer the current scan. This might
@@ -799,6 +830,33 @@ namespace {
         }
     }
 
+    bool Refresher::_checkHostInBackground(const HostAndPort& host) {
+        try {
+            boost::thread(stdx::bind(&Refresher::_checkHost, _set, _scan, host)).detach();
+        }
+        catch (const boost::thread_resource_error&) {
+            return false;
+        }
+        return true;
+    }
+
+    void Refresher::_checkHost(SetStatePtr set, ScanStatePtr scan, HostAndPort host) {
+        int64_t pingMicros = 0;
+        const BSONObj reply = sendIsMaster(host, &pingMicros);
+
+        boost::mutex::scoped_lock lk(set->mutex);
+
+        // As in _refreshUntilMatches, a reply to a scan that has been replaced is ignored.
+        if (scan != set->currentScan)
+            return;
+
+        Refresher refresher(set, scan);
+        if (reply.isEmpty())
+            refresher.failedHost(host);
+        else
+            refresher.receivedIsMaster(host, pingMicros, reply);
+    }
+
     void IsMasterReply::parse(const BSONObj& obj) {
         try {
             raw = obj.getOwned(); // don't use obj again after this line
@@ -185,6 +185,13 @@ namespace mongo {
          */
         static int maxConsecutiveFailedChecks;
 
+        /**
+         * The number of hosts a refresh sends isMaster to at the same time. The hosts beyond the
+         * first are checked on threads of their own, so that one slow or unreachable member
+         * doesn't hold up finding the rest of the set. 1 checks the hosts one after another.
+         */
+        static int maxParallelHostChecks;
+
         //
         // internal types (defined in replica_set_monitor_internal.h)
         //
@@ -327,6 +334,19 @@ namespace mongo {
          */
         HostAndPort _refreshUntilMatches(const ReadPreferenceSetting* criteria);
 
+        /**
+         * Joins the given scan without starting a new one, for _checkHostInBackground.
+         */
+        Refresher(const SetStatePtr& setState, const ScanStatePtr& scan);
+
+        /**
+         * Sends isMaster to a host returned from getNextStep on a thread of its own, which
+         * reports the reply to the scan. Returns false if the thread couldn't be started.
+         */
+        bool _checkHostInBackground(const HostAndPort& host);
+
+        static void _checkHost(SetStatePtr set, ScanStatePtr scan, HostAndPort host);
+
         // Both pointers are never NULL
         SetStatePtr _set;
         ScanStatePtr _scan; // May differ from _set->currentScan if a new scan has started.
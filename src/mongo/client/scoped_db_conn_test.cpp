@@ -242,6 +242,7 @@ namespace mongo_test {
             delete _dummyServer;
 
             mongo::pool.setMaxPoolSize(_maxPoolSizePerHost);
+            mongo::pool.setMinPoolSize(0);
         }
 
     protected:
@@ -426,4 +427,26 @@ namespace mongo_test {
 
         conn1Again.done();
     }
+
+    TEST_F(DummyServerFixture, WarmUpOpensMinPoolSizeConns) {
+        mongo::pool.setMinPoolSize(3);
+
+        ScopedDbConnection conn1(TARGET_HOST);
+        conn1.done();
+
+        // The cleaner opens the connections missing from a host that has been used
+        mongo::pool.taskDoWork();
+        const uint64_t warmedUpTime = mongo::curTimeMicros64();
+
+        ScopedDbConnection conn2(TARGET_HOST);
+        ScopedDbConnection conn3(TARGET_HOST);
+        ScopedDbConnection conn4(TARGET_HOST);
+        ASSERT_LESS_THAN(conn2->getSockCreationMicroSec(), warmedUpTime);
+        ASSERT_LESS_THAN(conn3->getSockCreationMicroSec(), warmedUpTime);
+        ASSERT_LESS_THAN(conn4->getSockCreationMicroSec(), warmedUpTime);
+
+        conn2.done();
+        conn3.done();
+        conn4.done();
+    }
 }
@@ -400,6 +400,7 @@ namespace {
     }
 
     static const int resourceSearchListCapacity = 5;
+    static const size_t kMaxUserActionsCacheSize = 1000;
     /**
      * Builds from "target" an exhaustive list of all ResourcePatterns that match "target".
      *
@@ -493,6 +494,7 @@ namespace {
 
     void AuthorizationSession::_refreshUserInfoAsNeeded(OperationContext* txn) {
         AuthorizationManager& authMan = getAuthorizationManager();
+        bool usersChanged = false;
         UserSet::iterator it = _authenticatedUsers.begin();
         while (it != _authenticatedUsers.end()) {
             User* user = *it;
@@ -509,6 +511,7 @@ namespace {
                     // Success! Replace the old User object with the updated one.
                     fassert(17067, _authenticatedUsers.replaceAt(it, updatedUser) == user);
                     authMan.releaseUser(user);
+                    usersChanged = true;
                     LOG(1) << "Updated session cache of user information for " << name;
                     break;
                 }
@@ -516,6 +519,7 @@ namespace {
                     // User does not exist anymore; remove it from _authenticatedUsers.
                     fassert(17068, _authenticatedUsers.removeAt(it) == user);
                     authMan.releaseUser(user);
+                    usersChanged = true;
                     log() << "Removed deleted user " << name <<
                         " from session cache of user information.";
                     continue;  // No need to advance "it" in this case.
@@ -530,10 +534,13 @@ namespace {
             }
             ++it;
         }
-        _buildAuthenticatedRolesVector();
+        if (usersChanged) {
+            _buildAuthenticatedRolesVector();
+        }
     }
 
     void AuthorizationSession::_buildAuthenticatedRolesVector() {
+        _userActionsCache.clear();
         _authenticatedRoleNames.clear();
         for (UserSet::iterator it = _authenticatedUsers.begin();
                 it != _authenticatedUsers.end();
@@ -550,40 +557,59 @@ namespace {
     bool AuthorizationSession::_isAuthorizedForPrivilege(const Privilege& privilege) {
         const ResourcePattern& target(privilege.getResourcePattern());
 
-        ResourcePattern resourceSearchList[resourceSearchListCapacity];
-        const int resourceSearchListLength = buildResourceSearchList(target, resourceSearchList);
-
         ActionSet unmetRequirements = privilege.getActions();
 
         PrivilegeVector defaultPrivileges = getDefaultPrivileges();
-        for (PrivilegeVector::iterator it = defaultPrivileges.begin();
-                it != defaultPrivileges.end(); ++it) {
+        if (!defaultPrivileges.empty()) {
+            ResourcePattern resourceSearchList[resourceSearchListCapacity];
+            const int resourceSearchListLength = buildResourceSearchList(target,
+                                                                         resourceSearchList);
 
-            for (int i = 0; i < resourceSearchListLength; ++i) {
-                if (!(it->getResourcePattern() == resourceSearchList[i]))
-                    continue;
+            for (PrivilegeVector::iterator it = defaultPrivileges.begin();
+                    it != defaultPrivileges.end(); ++it) {
+
+                for (int i = 0; i < resourceSearchListLength; ++i) {
+                    if (!(it->getResourcePattern() == resourceSearchList[i]))
+                        continue;
 
-                ActionSet userActions = it->getActions();
-                unmetRequirements.removeAllActionsFromSet(userActions);
+                    ActionSet userActions = it->getActions();
+                    unmetRequirements.removeAllActionsFromSet(userActions);
 
-                if (unmetRequirements.empty())
-                    return true;
+                    if (unmetRequirements.empty())
+                        return true;
+                }
             }
         }
 
+        unmetRequirements.removeAllActionsFromSet(_getUserActionsForResource(target));
+        return unmetRequirements.empty();
+    }
+
+    ActionSet AuthorizationSession::_getUserActionsForResource(const ResourcePattern& target) {
+        unordered_map<ResourcePattern, ActionSet>::const_iterator cached =
+            _userActionsCache.find(target);
+        if (cached != _userActionsCache.end()) {
+            return cached->second;
+        }
+
+        ResourcePattern resourceSearchList[resourceSearchListCapacity];
+        const int resourceSearchListLength = buildResourceSearchList(target, resourceSearchList);
+
+        ActionSet actions;
         for (UserSet::iterator it = _authenticatedUsers.begin();
                 it != _authenticatedUsers.end(); ++it) {
             User* user = *it;
             for (int i = 0; i < resourceSearchListLength; ++i) {
-                ActionSet userActions = user->getActionsForResource(resourceSearchList[i]);
-                unmetRequirements.removeAllActionsFromSet(userActions);
-
-                if (unmetRequirements.empty())
-                    return true;
+                actions.addAllActionsFromSet(user->getActionsForResource(resourceSearchList[i]));
             }
         }
 
-        return false;
+        // A session that touches very many namespaces starts over rather than growing forever
+        if (_userActionsCache.size() >= kMaxUserActionsCacheSize) {
+            _userActionsCache.clear();
+        }
+        _userActionsCache[target] = actions;
+        return actions;
     }
 
     void AuthorizationSession::setImpersonatedUserData(std::vector<UserName> usernames,
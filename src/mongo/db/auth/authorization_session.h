@@ -42,6 +42,7 @@
 #include "mongo/db/auth/user_name.h"
 #include "mongo/db/auth/user_set.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
@@ -229,6 +230,11 @@ namespace mongo {
         // lock on the admin database (to update out-of-date user privilege information).
         bool _isAuthorizedForPrivilege(const Privilege& privilege);
 
+        // Returns every action the authenticated users may perform on 'target', whether granted
+        // on 'target' itself or on a broader resource pattern that matches it. Results are cached
+        // in _userActionsCache.
+        ActionSet _getUserActionsForResource(const ResourcePattern& target);
+
         boost::scoped_ptr<AuthzSessionExternalState> _externalState;
 
         // All Users who have been authenticated on this connection.
@@ -237,6 +243,11 @@ namespace mongo {
         // users set is changed.
         std::vector<RoleName> _authenticatedRoleNames;
 
+        // Actions the authenticated users hold on each resource checked so far. The User objects
+        // in _authenticatedUsers never change, so this is only cleared when the set of users
+        // does, which is also when _authenticatedRoleNames is rebuilt.
+        unordered_map<ResourcePattern, ActionSet> _userActionsCache;
+
         // A vector of impersonated UserNames and a vector of those users' RoleNames.
         // These are used in the auditing system. They are not used for authz checks.
         std::vector<UserName> _impersonatedUserNames;
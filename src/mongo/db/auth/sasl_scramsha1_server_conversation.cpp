@@ -32,15 +32,22 @@
 
 #include "mongo/db/auth/sasl_scramsha1_server_conversation.h"
 
+#include <algorithm>
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <map>
 
 #include "mongo/crypto/crypto.h"
 #include "mongo/crypto/mechanism_scram.h"
 #include "mongo/db/auth/sasl_options.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 #include "mongo/util/base64.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/password_digest.h"
@@ -52,6 +59,121 @@ namespace mongo {
     using boost::scoped_ptr;
     using std::string;
 
+namespace {
+
+    // Maximum number of mixed mode SCRAM credential derivations running at once.  Logins that
+    // need a derivation while all slots are busy queue for one.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(scramMixedModeDerivationConcurrency, int, 4);
+
+    // Upper bound on the number of derived mixed mode credentials kept in memory.  The cache
+    // is emptied when it fills up.
+    const size_t kMaxCachedMixedModeCredentials = 10000;
+
+    /**
+     * SCRAM credentials derived from the MONGODB-CR password digest of users that have no
+     * stored SCRAM credentials.  Entries are keyed by that digest, which already incorporates
+     * the user name and changes with the password, so a stale entry is never looked up again.
+     */
+    class MixedModeCredentialsCache {
+        MONGO_DISALLOW_COPYING(MixedModeCredentialsCache);
+    public:
+        MixedModeCredentialsCache() : _mutex("MixedModeCredentialsCache") {}
+
+        bool get(const std::string& passwordDigest, User::SCRAMCredentials* out) {
+            SimpleMutex::scoped_lock lk(_mutex);
+            std::map<std::string, User::SCRAMCredentials>::const_iterator it =
+                _creds.find(passwordDigest);
+            if (it == _creds.end()) {
+                return false;
+            }
+            *out = it->second;
+            return true;
+        }
+
+        void put(const std::string& passwordDigest, const User::SCRAMCredentials& creds) {
+            SimpleMutex::scoped_lock lk(_mutex);
+            if (_creds.size() >= kMaxCachedMixedModeCredentials) {
+                _creds.clear();
+            }
+            _creds[passwordDigest] = creds;
+        }
+
+        size_t size() {
+            SimpleMutex::scoped_lock lk(_mutex);
+            return _creds.size();
+        }
+
+    private:
+        SimpleMutex _mutex;
+        std::map<std::string, User::SCRAMCredentials> _creds;
+    };
+
+    MixedModeCredentialsCache mixedModeCredentialsCache;
+    AtomicInt64 mixedModeCacheHits;
+    AtomicInt64 mixedModeDerivations;
+
+    TicketHolder* getDerivationTickets() {
+        // Created on first use so that the startup parameter has already been parsed.
+        static TicketHolder* tickets =
+            new TicketHolder(std::max(1, scramMixedModeDerivationConcurrency));
+        return tickets;
+    }
+
+    /**
+     * Fills in the SCRAM part of 'creds' from the MONGODB-CR password digest, deriving the keys
+     * at most once per password.
+     */
+    void getMixedModeCredentials(User::CredentialData* creds) {
+        if (mixedModeCredentialsCache.get(creds->password, &creds->scram)) {
+            mixedModeCacheHits.fetchAndAdd(1);
+            return;
+        }
+
+        ScopedTicket ticket(getDerivationTickets());
+
+        // Another login for the same user may have finished the derivation while we queued.
+        if (mixedModeCredentialsCache.get(creds->password, &creds->scram)) {
+            mixedModeCacheHits.fetchAndAdd(1);
+            return;
+        }
+
+        // Use a default value of 5000 for the scramIterationCount when in mixed mode,
+        // overriding the default value (10000) used for SCRAM mode or the user-given value.
+        const int mixedModeScramIterationCount = 5000;
+        BSONObj scramCreds = scram::generateCredentials(creds->password,
+                                                        mixedModeScramIterationCount);
+        creds->scram.iterationCount = scramCreds[scram::iterationCountFieldName].Int();
+        creds->scram.salt = scramCreds[scram::saltFieldName].String();
+        creds->scram.storedKey = scramCreds[scram::storedKeyFieldName].String();
+        creds->scram.serverKey = scramCreds[scram::serverKeyFieldName].String();
+
+        mixedModeDerivations.fetchAndAdd(1);
+        mixedModeCredentialsCache.put(creds->password, creds->scram);
+    }
+
+    class MixedModeCredentialsMetric : public ServerStatusMetric {
+    public:
+        MixedModeCredentialsMetric() : ServerStatusMetric("auth.scramMixedModeCredentials") {}
+
+        virtual void appendAtLeaf(BSONObjBuilder& b) const {
+            BSONObjBuilder credsBuilder(b.subobjStart(_leafName));
+            credsBuilder.appendNumber("cached",
+                                      static_cast<long long>(mixedModeCredentialsCache.size()));
+            credsBuilder.appendNumber("cacheHits", mixedModeCacheHits.load());
+            credsBuilder.appendNumber("derivations", mixedModeDerivations.load());
+
+            TicketHolder* tickets = getDerivationTickets();
+            const TicketHolder::WaitStats stats =
+                tickets->getWaitStats(TicketHolder::kNormalPriority);
+            credsBuilder.append("derivationsInProgress", tickets->used());
+            credsBuilder.appendNumber("queuedDerivations", stats.waits);
+            credsBuilder.appendNumber("totalQueuedMicros", stats.totalWaitMicros);
+            credsBuilder.doneFast();
+        }
+    } mixedModeCredentialsMetric;
+
+} // namespace
+
     SaslSCRAMSHA1ServerConversation::SaslSCRAMSHA1ServerConversation(
                                                     SaslAuthenticationSession* saslAuthSession) :
         SaslServerConversation(saslAuthSession),
@@ -189,15 +311,7 @@ namespace mongo {
 
         // Generate SCRAM credentials on the fly for mixed MONGODB-CR/SCRAM mode.
         if (_creds.scram.salt.empty() && !_creds.password.empty()) {
-            // Use a default value of 5000 for the scramIterationCount when in mixed mode,
-            // overriding the default value (10000) used for SCRAM mode or the user-given value.
-            const int mixedModeScramIterationCount = 5000;
-            BSONObj scramCreds = scram::generateCredentials(_creds.password,
-                                                            mixedModeScramIterationCount);
-            _creds.scram.iterationCount = scramCreds[scram::iterationCountFieldName].Int();
-            _creds.scram.salt = scramCreds[scram::saltFieldName].String();
-            _creds.scram.storedKey = scramCreds[scram::storedKeyFieldName].String();
-            _creds.scram.serverKey = scramCreds[scram::serverKeyFieldName].String();
+            getMixedModeCredentials(&_creds);
         }
 
         // Generate server-first-message
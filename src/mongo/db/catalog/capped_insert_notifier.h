@@ -0,0 +1,79 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    /**
+     * Lets tailable awaitData cursors on a capped collection wait for the next insert rather
+     * than poll for it.
+     *
+     * Waiters read the version before looking for new documents, and then wait for it to change,
+     * so an insert committed in between is never missed. The collection bumps the version when
+     * an insert commits, and kills the notifier when it is destroyed. Waiters hold the notifier
+     * through a shared_ptr, so they can wait without the collection lock.
+     */
+    class CappedInsertNotifier {
+        MONGO_DISALLOW_COPYING(CappedInsertNotifier);
+    public:
+        CappedInsertNotifier();
+
+        /** Wakes all waiters. Called when an insert into the collection commits. */
+        void notifyAll();
+
+        /**
+         * Waits until the version differs from 'prevVersion', the notifier is killed or
+         * 'timeoutMillis' have passed, whichever comes first.
+         */
+        void waitForInsert(uint64_t prevVersion, int64_t timeoutMillis) const;
+
+        uint64_t getVersion() const;
+
+        /** Wakes all waiters for good, once the collection goes away. */
+        void kill();
+
+        bool isDead() const;
+
+    private:
+        mutable boost::mutex _mutex;
+        mutable boost::condition_variable _notifier;
+
+        // guarded by _mutex
+        uint64_t _version;
+        bool _dead;
+    };
+
+}  // namespace mongo
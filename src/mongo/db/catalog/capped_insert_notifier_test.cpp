@@ -0,0 +1,91 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/capped_insert_notifier.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    namespace {
+        void notifyAfter(CappedInsertNotifier* notifier, int millis) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(millis));
+            notifier->notifyAll();
+        }
+    }
+
+    TEST(CappedInsertNotifier, WaitTimesOut) {
+        CappedInsertNotifier notifier;
+        Timer timer;
+        notifier.waitForInsert(notifier.getVersion(), 50);
+        ASSERT_GREATER_THAN_OR_EQUALS(timer.millis(), 40);
+    }
+
+    TEST(CappedInsertNotifier, InsertBeforeWaitIsNotMissed) {
+        CappedInsertNotifier notifier;
+        const uint64_t version = notifier.getVersion();
+        notifier.notifyAll();
+        ASSERT_NOT_EQUALS(version, notifier.getVersion());
+
+        // Returns right away rather than after the timeout.
+        Timer timer;
+        notifier.waitForInsert(version, 60 * 1000);
+        ASSERT_LESS_THAN(timer.millis(), 30 * 1000);
+    }
+
+    TEST(CappedInsertNotifier, InsertWakesWaiter) {
+        CappedInsertNotifier notifier;
+        const uint64_t version = notifier.getVersion();
+        boost::thread inserter(boost::bind(notifyAfter, &notifier, 10));
+
+        Timer timer;
+        notifier.waitForInsert(version, 60 * 1000);
+        ASSERT_LESS_THAN(timer.millis(), 30 * 1000);
+        ASSERT_NOT_EQUALS(version, notifier.getVersion());
+        inserter.join();
+    }
+
+    TEST(CappedInsertNotifier, KillWakesWaiters) {
+        CappedInsertNotifier notifier;
+        ASSERT_FALSE(notifier.isDead());
+        notifier.kill();
+        ASSERT_TRUE(notifier.isDead());
+
+        Timer timer;
+        notifier.waitForInsert(notifier.getVersion(), 60 * 1000);
+        ASSERT_LESS_THAN(timer.millis(), 30 * 1000);
+    }
+
+}  // namespace mongo
@@ -38,11 +38,14 @@
 
 #include "mongo/base/counter.h"
 #include "mongo/base/owned_pointer_map.h"
+#include "mongo/db/field_ref_set.h"
+#include "mongo/db/catalog/capped_insert_notifier.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/document_cache.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/operation_context.h"
@@ -97,13 +100,21 @@ namespace mongo {
           _cursorManager( fullNS ) {
         _magic = 1357924;
         _indexCatalog.init(txn);
-        if ( isCapped() )
+        if ( isCapped() ) {
             _recordStore->setCappedDeleteCallback( this );
+            _cappedNotifier.reset( new CappedInsertNotifier() );
+        }
         _infoCache.reset(txn);
     }
 
     Collection::~Collection() {
         verify( ok() );
+        if ( _cappedNotifier ) {
+            _cappedNotifier->kill();
+        }
+        if ( DocumentCache* cache = DocumentCache::get() ) {
+            cache->invalidateAll( this );
+        }
         _magic = 0;
     }
 
@@ -168,7 +179,9 @@ namespace mongo {
     }
 
     BSONObj Collection::docFor(OperationContext* txn, const RecordId& loc) const {
-        return  _recordStore->dataFor( txn, loc ).releaseToBson();
+        BSONObj obj = _recordStore->dataFor( txn, loc ).releaseToBson();
+        txn->getCurOp()->recordStorageBytesRead( obj.objsize() );
+        return obj;
     }
 
     bool Collection::findDoc(OperationContext* txn, const RecordId& loc, BSONObj* out) const {
@@ -193,6 +206,8 @@ namespace mongo {
         if ( !loc.isOK() )
             return loc;
 
+        _notifyCappedWaitersOnCommit( txn );
+
         return StatusWith<RecordId>( loc );
     }
 
@@ -215,6 +230,45 @@ namespace mongo {
         return res;
     }
 
+    Status Collection::insertDocuments( OperationContext* txn,
+                                        const vector<BSONObj>& docs,
+                                        bool enforceQuota ) {
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
+        invariant( !isCapped() );
+
+        uint64_t txnId = txn->recoveryUnit()->getMyTransactionCount();
+
+        const bool needIds = _indexCatalog.findIdIndex( txn );
+
+        vector<RecordId> locs;
+        locs.reserve( docs.size() );
+        for ( vector<BSONObj>::const_iterator it = docs.begin(); it != docs.end(); ++it ) {
+            if ( needIds && (*it)["_id"].eoo() ) {
+                return Status( ErrorCodes::InternalError,
+                               str::stream() << "Collection::insertDocuments got "
+                               "document without _id for ns:" << _ns.ns() );
+            }
+
+            StatusWith<RecordId> loc = _recordStore->insertRecord( txn,
+                                                                  it->objdata(),
+                                                                  it->objsize(),
+                                                                  _enforceQuota( enforceQuota ) );
+            if ( !loc.isOK() )
+                return loc.getStatus();
+
+            invariant( RecordId::min() < loc.getValue() );
+            invariant( loc.getValue() < RecordId::max() );
+            locs.push_back( loc.getValue() );
+        }
+
+        _infoCache.notifyOfWriteOp();
+        _infoCache.notifyOfContentChange( txn );
+
+        Status s = _indexCatalog.indexRecords( txn, docs, locs );
+        invariant( txnId == txn->recoveryUnit()->getMyTransactionCount() );
+        return s;
+    }
+
     StatusWith<RecordId> Collection::insertDocument( OperationContext* txn,
                                                     const BSONObj& doc,
                                                     MultiIndexBlock* indexBlock,
@@ -233,6 +287,8 @@ namespace mongo {
         if ( !status.isOK() )
             return StatusWith<RecordId>( status );
 
+        _notifyCappedWaitersOnCommit( txn );
+
         return loc;
     }
 
@@ -257,19 +313,43 @@ namespace mongo {
                                                               _enforceQuota( enforceQuota ) );
         if ( !loc.isOK() )
             return loc;
+        txn->getCurOp()->recordStorageBytesWritten( docToInsert.objsize() );
 
         invariant( RecordId::min() < loc.getValue() );
         invariant( loc.getValue() < RecordId::max() );
 
         _infoCache.notifyOfWriteOp();
+        _infoCache.notifyOfContentChange( txn );
 
         Status s = _indexCatalog.indexRecord(txn, docToInsert, loc.getValue());
         if (!s.isOK())
             return StatusWith<RecordId>(s);
 
+        _notifyCappedWaitersOnCommit( txn );
+
         return loc;
     }
 
+    namespace {
+        class NotifyCappedWaitersChange : public RecoveryUnit::Change {
+        public:
+            explicit NotifyCappedWaitersChange( const boost::shared_ptr<CappedInsertNotifier>& n )
+                : _notifier( n ) { }
+
+            virtual void commit() { _notifier->notifyAll(); }
+            virtual void rollback() { }
+
+        private:
+            const boost::shared_ptr<CappedInsertNotifier> _notifier;
+        };
+    }
+
+    void Collection::_notifyCappedWaitersOnCommit( OperationContext* txn ) {
+        if ( _cappedNotifier ) {
+            txn->recoveryUnit()->registerChange( new NotifyCappedWaitersChange( _cappedNotifier ) );
+        }
+    }
+
     Status Collection::aboutToDeleteCapped( OperationContext* txn, const RecordId& loc ) {
 
         BSONObj doc = docFor( txn, loc );
@@ -277,8 +357,14 @@ namespace mongo {
         /* check if any cursors point to us.  if so, advance them. */
         _cursorManager.invalidateDocument(txn, loc, INVALIDATION_DELETION);
 
+        if ( DocumentCache* cache = DocumentCache::get() ) {
+            cache->invalidate( this, loc );
+        }
+
         _indexCatalog.unindexRecord(txn, doc, loc, false);
 
+        _infoCache.notifyOfContentChange( txn );
+
         return Status::OK();
     }
 
@@ -305,11 +391,16 @@ namespace mongo {
         /* check if any cursors point to us.  if so, advance them. */
         _cursorManager.invalidateDocument(txn, loc, INVALIDATION_DELETION);
 
+        if ( DocumentCache* cache = DocumentCache::get() ) {
+            cache->invalidate( this, loc );
+        }
+
         _indexCatalog.unindexRecord(txn, doc, loc, noWarn);
 
         _recordStore->deleteRecord( txn, loc );
 
         _infoCache.notifyOfWriteOp();
+        _infoCache.notifyOfContentChange( txn );
     }
 
     Counter64 moveCounter;
@@ -321,7 +412,8 @@ namespace mongo {
                                                      const BSONObj& objNew,
                                                      bool enforceQuota,
                                                      bool indexesAffected,
-                                                     OpDebug* debug ) {
+                                                     OpDebug* debug,
+                                                     const FieldRefSet* modifiedPaths ) {
         dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
 
         uint64_t txnId = txn->recoveryUnit()->getMyTransactionCount();
@@ -332,6 +424,10 @@ namespace mongo {
                                          "in Collection::updateDocument _id mismatch",
                                          13596 );
 
+        if ( DocumentCache* cache = DocumentCache::get() ) {
+            cache->invalidate( this, oldLocation );
+        }
+
         // At the end of this step, we will have a map of UpdateTickets, one per index, which
         // represent the index updates needed to be done, based on the changes between objOld and
         // objNew.
@@ -340,6 +436,9 @@ namespace mongo {
             IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator( txn, true );
             while ( ii.more() ) {
                 IndexDescriptor* descriptor = ii.next();
+                if ( !_indexKeysMightChange( txn, descriptor, modifiedPaths ) ) {
+                    continue;
+                }
                 IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
 
                 InsertDeleteOptions options;
@@ -369,11 +468,13 @@ namespace mongo {
         if ( !newLocation.isOK() ) {
             return newLocation;
         }
+        txn->getCurOp()->recordStorageBytesWritten( objNew.objsize() );
 
         // At this point, the old object may or may not still be indexed, depending on if it was
         // moved.
 
         _infoCache.notifyOfWriteOp();
+        _infoCache.notifyOfContentChange( txn );
 
         // If the object did move, we need to add the new location to all indexes.
         if ( newLocation.getValue() != oldLocation ) {
@@ -401,11 +502,15 @@ namespace mongo {
             IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator( txn, true );
             while ( ii.more() ) {
                 IndexDescriptor* descriptor = ii.next();
+                std::map<IndexDescriptor*, UpdateTicket*>::const_iterator ticket =
+                    updateTickets.map().find( descriptor );
+                if ( ticket == updateTickets.map().end() ) {
+                    continue;
+                }
                 IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
 
                 int64_t updatedKeys;
-                Status ret = iam->update(
-                    txn, *updateTickets.mutableMap()[descriptor], &updatedKeys);
+                Status ret = iam->update( txn, *ticket->second, &updatedKeys );
                 if ( !ret.isOK() )
                     return StatusWith<RecordId>( ret );
                 if ( debug )
@@ -435,6 +540,28 @@ namespace mongo {
     }
 
 
+    bool Collection::_indexKeysMightChange( OperationContext* txn,
+                                            const IndexDescriptor* descriptor,
+                                            const FieldRefSet* modifiedPaths ) const {
+        if ( !modifiedPaths ) {
+            return true;
+        }
+
+        const UpdateIndexData* indexKeys = _infoCache.indexKeys( txn, descriptor->indexName() );
+        if ( !indexKeys ) {
+            return true;
+        }
+
+        for ( FieldRefSet::const_iterator it = modifiedPaths->begin();
+              it != modifiedPaths->end();
+              ++it ) {
+            if ( indexKeys->mightBeIndexed( (*it)->dottedField() ) ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     Status Collection::updateDocumentWithDamages( OperationContext* txn,
                                                   const RecordId& loc,
                                                   const RecordData& oldRec,
@@ -445,6 +572,12 @@ namespace mongo {
         // Broadcast the mutation so that query results stay correct.
         _cursorManager.invalidateDocument(txn, loc, INVALIDATION_MUTATION);
 
+        if ( DocumentCache* cache = DocumentCache::get() ) {
+            cache->invalidate( this, loc );
+        }
+
+        _infoCache.notifyOfContentChange( txn );
+
         return _recordStore->updateWithDamages( txn, loc, oldRec, damageSource, damages );
     }
 
@@ -528,8 +661,12 @@ namespace mongo {
             return status;
         _cursorManager.invalidateAll( false );
         _infoCache.reset( txn );
+        if ( DocumentCache* cache = DocumentCache::get() ) {
+            cache->invalidateAll( this );
+        }
 
         // 3) truncate record store
+        _infoCache.notifyOfContentChange( txn );
         status = _recordStore->truncate(txn);
         if ( !status.isOK() )
             return status;
@@ -550,6 +687,12 @@ namespace mongo {
         dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
         invariant( isCapped() );
 
+        if ( DocumentCache* cache = DocumentCache::get() ) {
+            cache->invalidateAll( this );
+        }
+
+        _infoCache.notifyOfContentChange( txn );
+
         _recordStore->temp_cappedTruncateAfter( txn, end, inclusive );
     }
 
@@ -626,27 +769,55 @@ namespace mongo {
 
     Status Collection::touch( OperationContext* txn,
                               bool touchData, bool touchIndexes,
+                              const std::set<std::string>& indexNames,
                               BSONObjBuilder* output ) const {
         if ( touchData ) {
             BSONObjBuilder b;
             Status status = _recordStore->touch( txn, &b );
+            if ( status.code() == ErrorCodes::CommandNotSupported ) {
+                // Reading every record pulls it into whatever cache the engine keeps.
+                Timer t;
+                long long numRecords = 0;
+                long long dataSize = 0;
+                scoped_ptr<RecordIterator> it( _recordStore->getIterator( txn ) );
+                while ( !it->isEOF() ) {
+                    dataSize += it->dataFor( it->getNext() ).size();
+                    if ( ++numRecords % 1024 == 0 )
+                        txn->checkForInterrupt();
+                }
+                b.append( "numRecords", numRecords );
+                b.append( "dataSize", dataSize );
+                b.append( "millis", t.millis() );
+                status = Status::OK();
+            }
             if ( !status.isOK() )
                 return status;
             output->append( "data", b.obj() );
         }
 
         if ( touchIndexes ) {
+            for ( std::set<std::string>::const_iterator it = indexNames.begin();
+                  it != indexNames.end(); ++it ) {
+                if ( !_indexCatalog.findIndexByName( txn, *it ) )
+                    return Status( ErrorCodes::IndexNotFound,
+                                   str::stream() << "index not found: " << *it );
+            }
+
             Timer t;
+            int numTouched = 0;
             IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator( txn, false );
             while ( ii.more() ) {
                 const IndexDescriptor* desc = ii.next();
+                if ( !indexNames.empty() && !indexNames.count( desc->indexName() ) )
+                    continue;
                 const IndexAccessMethod* iam = _indexCatalog.getIndex( desc );
                 Status status = iam->touch( txn );
                 if ( !status.isOK() )
                     return status;
+                numTouched++;
             }
 
-            output->append( "indexes", BSON( "num" << _indexCatalog.numIndexesTotal( txn ) <<
+            output->append( "indexes", BSON( "num" << numTouched <<
                                              "millis" << t.millis() ) );
         }
 
@@ -30,8 +30,11 @@
 
 #pragma once
 
+#include <set>
 #include <string>
 
+#include <boost/shared_ptr.hpp>
+
 #include "mongo/base/string_data.h"
 #include "mongo/bson/mutable/damage_vector.h"
 #include "mongo/db/catalog/collection_info_cache.h"
@@ -46,6 +49,7 @@
 
 namespace mongo {
 
+    class CappedInsertNotifier;
     class CollectionCatalogEntry;
     class DatabaseCatalogEntry;
     class ExtentManager;
@@ -57,6 +61,7 @@ namespace mongo {
     class RecordFetcher;
 
     class OpDebug;
+    class FieldRefSet;
 
     struct CompactOptions {
 
@@ -180,6 +185,18 @@ namespace mongo {
                                             const DocWriter* doc,
                                             bool enforceQuota );
 
+        /**
+         * Inserts several documents at once, with the same requirements as the BSONObj version
+         * of insertDocument.  All the records are written first, then each index gets the keys
+         * of all the documents in key order.  On failure some of the documents may have been
+         * written, so the caller must not commit its WriteUnitOfWork.
+         *
+         * Not for capped collections, which may delete a record inserted earlier in the batch.
+         */
+        Status insertDocuments( OperationContext* txn,
+                                const std::vector<BSONObj>& docs,
+                                bool enforceQuota );
+
         StatusWith<RecordId> insertDocument( OperationContext* txn,
                                             const BSONObj& doc,
                                             MultiIndexBlock* indexBlock,
@@ -202,6 +219,9 @@ namespace mongo {
          * if the document fits in the old space, it is put there
          * if not, it is moved
          * @return the post update location of the doc (may or may not be the same as oldLocation)
+         *
+         * If 'modifiedPaths' is not NULL, only the indexes over one of those paths get their
+         * keys recomputed, the others can't have changed.
          */
         StatusWith<RecordId> updateDocument( OperationContext* txn,
                                              const RecordId& oldLocation,
@@ -209,7 +229,8 @@ namespace mongo {
                                              const BSONObj& newDoc,
                                              bool enforceQuota,
                                              bool indexesAffected,
-                                             OpDebug* debug );
+                                             OpDebug* debug,
+                                             const FieldRefSet* modifiedPaths = NULL );
 
         /**
          * right now not allowed to modify indexes
@@ -244,9 +265,13 @@ namespace mongo {
 
         /**
          * forces data into cache
+         * if 'indexNames' is not empty only the named indexes are touched, rather than all ready
+         * indexes.  Engines that cannot touch a record store natively have its records read
+         * instead.
          */
         Status touch( OperationContext* txn,
                       bool touchData, bool touchIndexes,
+                      const std::set<std::string>& indexNames,
                       BSONObjBuilder* output ) const;
 
         /**
@@ -281,6 +306,14 @@ namespace mongo {
                               BSONObjBuilder* details = NULL,
                               int scale = 1);
 
+        /**
+         * Returns the notifier tailable awaitData cursors wait on for inserts, or NULL if the
+         * collection isn't capped. It stays valid, though killed, after the collection is gone.
+         */
+        boost::shared_ptr<CappedInsertNotifier> getCappedInsertNotifier() const {
+            return _cappedNotifier;
+        }
+
         // --- end suspect things
 
     private:
@@ -306,6 +339,14 @@ namespace mongo {
 
         bool _enforceQuota( bool userEnforeQuota ) const;
 
+        /** Wakes the awaitData cursors of a capped collection once the insert commits. */
+        void _notifyCappedWaitersOnCommit( OperationContext* txn );
+
+        // Can an update changing 'modifiedPaths' (all paths, if NULL) change the index's keys?
+        bool _indexKeysMightChange( OperationContext* txn,
+                                    const IndexDescriptor* descriptor,
+                                    const FieldRefSet* modifiedPaths ) const;
+
         int _magic;
 
         NamespaceString _ns;
@@ -320,6 +361,9 @@ namespace mongo {
         // should be about the data.
         mutable CursorManager _cursorManager;
 
+        // Only set for capped collections.
+        boost::shared_ptr<CappedInsertNotifier> _cappedNotifier;
+
         friend class Database;
         friend class IndexCatalog;
         friend class NamespaceDetails;
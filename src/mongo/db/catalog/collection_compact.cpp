@@ -39,10 +39,12 @@
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/document_cache.h"
 #include "mongo/db/catalog/index_key_validate.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/util/log.h"
+#include "mongo/util/progress_meter.h"
 #include "mongo/util/touch_pages.h"
 
 namespace mongo {
@@ -103,7 +105,7 @@ namespace mongo {
 
     StatusWith<CompactStats> Collection::compact( OperationContext* txn,
                                                   const CompactOptions* compactOptions ) {
-        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_X));
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
 
         if ( !_recordStore->compactSupported() )
             return StatusWith<CompactStats>( ErrorCodes::CommandNotSupported,
@@ -112,16 +114,37 @@ namespace mongo {
                                              _recordStore->name() );
 
         if (_recordStore->compactsInPlace()) {
-            // Since we are compacting in-place, we don't need to touch the indexes.
-            // TODO SERVER-16856 compact indexes
+            // Compacting in place moves no document and changes no index entry, so reads and
+            // writes go on; the intent lock held only keeps the indexes from being dropped.
+            // The record store and then each index are compacted in turn, and the storage
+            // engine checks for killOp as it goes.
+            ProgressMeterHolder progress(*txn->setMessage("compact",
+                                                          "Compact Progress",
+                                                          1 + _indexCatalog.numIndexesReady(txn)));
+
             CompactStats stats;
             Status status = _recordStore->compact(txn, NULL, compactOptions, &stats);
             if (!status.isOK())
                 return StatusWith<CompactStats>(status);
+            progress.hit();
+
+            IndexCatalog::IndexIterator ii( _indexCatalog.getIndexIterator( txn, false ) );
+            while ( ii.more() ) {
+                IndexDescriptor* descriptor = ii.next();
+                LOG(1) << "compact index " << descriptor->indexName();
 
+                status = _indexCatalog.getIndex(descriptor)->compact(txn);
+                if (!status.isOK() && status.code() != ErrorCodes::CommandNotSupported)
+                    return StatusWith<CompactStats>(status);
+                progress.hit();
+            }
+
+            progress.finished();
             return StatusWith<CompactStats>(stats);
         }
 
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_X));
+
         if ( _indexCatalog.numIndexesInProgress( txn ) )
             return StatusWith<CompactStats>( ErrorCodes::BadValue,
                                              "cannot compact when indexes in progress" );
@@ -130,6 +153,11 @@ namespace mongo {
         // same data, but might perform a little different after compact?
         _infoCache.reset( txn );
 
+        // compacting moves documents to new RecordIds
+        if ( DocumentCache* cache = DocumentCache::get() ) {
+            cache->invalidateAll( this );
+        }
+
         vector<BSONObj> indexSpecs;
         {
             IndexCatalog::IndexIterator ii( _indexCatalog.getIndexIterator( txn, false ) );
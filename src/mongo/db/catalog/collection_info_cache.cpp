@@ -37,30 +37,96 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/fts/fts_spec.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/storage/recovery_unit.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 
 namespace mongo {
 
+namespace {
+    AtomicUInt64 nextContentIncarnation;
+
+    /**
+     * Moves a collection's content generation on when the write that registered it commits or
+     * rolls back.
+     */
+    class ContentChange : public RecoveryUnit::Change {
+    public:
+        explicit ContentChange( AtomicUInt64* generation ) : _generation( generation ) { }
+        virtual void commit() { _generation->fetchAndAdd( 1 ); }
+        virtual void rollback() { _generation->fetchAndAdd( 1 ); }
+
+    private:
+        AtomicUInt64* const _generation;
+    };
+}  // namespace
+
     CollectionInfoCache::CollectionInfoCache( Collection* collection )
         : _collection( collection ),
           _keysComputed( false ),
           _planCache(new PlanCache(collection->ns().ns())),
-          _querySettings(new QuerySettings()) { }
+          _querySettings(new QuerySettings()),
+          _indexStatsCache(new IndexStatsCache()),
+          _queryShapeStats(new QueryShapeStats()),
+          _storageSizesComputed(false),
+          _storageSizesComputedAtMillis(0),
+          _contentIncarnation(nextContentIncarnation.fetchAndAdd(1)) { }
 
     void CollectionInfoCache::reset( OperationContext* txn ) {
         LOG(1) << _collection->ns().ns() << ": clearing plan cache - collection info cache reset";
         clearQueryCache();
+        _indexStatsCache->clear();
+        {
+            boost::mutex::scoped_lock lk( _storageSizesMutex );
+            _storageSizesComputed = false;
+        }
         _keysComputed = false;
         computeIndexKeys( txn );
         // query settings is not affected by info cache reset.
         // index filters should persist throughout life of collection
     }
 
+    CollectionInfoCache::StorageSizes CollectionInfoCache::getStorageSizes( OperationContext* txn,
+                                                                            int maxStalenessSecs ) {
+        if ( maxStalenessSecs > 0 ) {
+            boost::mutex::scoped_lock lk( _storageSizesMutex );
+            if ( _storageSizesComputed &&
+                 curTimeMillis64() - _storageSizesComputedAtMillis <=
+                     static_cast<long long>( maxStalenessSecs ) * 1000 ) {
+                return _storageSizes;
+            }
+        }
+
+        StorageSizes sizes;
+        {
+            BSONObjBuilder extraInfo;
+            sizes.storageSize = _collection->getRecordStore()->storageSize( txn, &extraInfo );
+            sizes.storageExtraInfo = extraInfo.obj();
+        }
+
+        IndexCatalog* indexCatalog = _collection->getIndexCatalog();
+        IndexCatalog::IndexIterator ii = indexCatalog->getIndexIterator( txn, true );
+        while ( ii.more() ) {
+            IndexDescriptor* descriptor = ii.next();
+            long long size = indexCatalog->getIndex( descriptor )->getSpaceUsedBytes( txn );
+            sizes.totalIndexSize += size;
+            sizes.indexSizes.push_back( std::make_pair( descriptor->indexName(), size ) );
+        }
+
+        boost::mutex::scoped_lock lk( _storageSizesMutex );
+        _storageSizes = sizes;
+        _storageSizesComputed = true;
+        _storageSizesComputedAtMillis = curTimeMillis64();
+        return sizes;
+    }
+
     const UpdateIndexData& CollectionInfoCache::indexKeys( OperationContext* txn ) const {
         // This requires "some" lock, and MODE_IS is an expression for that, for now.
         dassert(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_IS));
@@ -68,50 +134,94 @@ namespace mongo {
         return _indexedPaths;
     }
 
+    const UpdateIndexData* CollectionInfoCache::indexKeys( OperationContext* txn,
+                                                           const std::string& indexName ) const {
+        dassert(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_IS));
+        invariant(_keysComputed);
+        std::map<std::string, UpdateIndexData>::const_iterator it =
+            _indexedPathsByIndex.find(indexName);
+        return it == _indexedPathsByIndex.end() ? NULL : &it->second;
+    }
+
+    // Adds the paths that the keys of the index described by 'descriptor' depend on
+    static void addIndexPaths( const IndexDescriptor* descriptor, UpdateIndexData* indexedPaths ) {
+        if (descriptor->getAccessMethodName() != IndexNames::TEXT) {
+            BSONObj key = descriptor->keyPattern();
+            BSONObjIterator j(key);
+            while (j.more()) {
+                BSONElement e = j.next();
+                indexedPaths->addPath(e.fieldName());
+            }
+        }
+        else {
+            fts::FTSSpec ftsSpec(descriptor->infoObj());
+
+            if (ftsSpec.wildcard()) {
+                indexedPaths->allPathsIndexed();
+            }
+            else {
+                for (size_t i = 0; i < ftsSpec.numExtraBefore(); ++i) {
+                    indexedPaths->addPath(ftsSpec.extraBefore(i));
+                }
+                for (fts::Weights::const_iterator it = ftsSpec.weights().begin();
+                     it != ftsSpec.weights().end();
+                     ++it) {
+                    indexedPaths->addPath(it->first);
+                }
+                for (size_t i = 0; i < ftsSpec.numExtraAfter(); ++i) {
+                    indexedPaths->addPath(ftsSpec.extraAfter(i));
+                }
+                // Any update to a path containing "language" as a component could change the
+                // language of a subdocument.  Add the override field as a path component.
+                indexedPaths->addPathComponent(ftsSpec.languageOverrideField());
+            }
+        }
+    }
+
     void CollectionInfoCache::computeIndexKeys( OperationContext* txn ) {
         // This function modified objects attached to the Collection so we need a write lock
         invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
         _indexedPaths.clear();
+        _indexedPathsByIndex.clear();
 
         IndexCatalog::IndexIterator i = _collection->getIndexCatalog()->getIndexIterator(txn, true);
         while (i.more()) {
             IndexDescriptor* descriptor = i.next();
+            addIndexPaths(descriptor, &_indexedPaths);
+            addIndexPaths(descriptor, &_indexedPathsByIndex[descriptor->indexName()]);
+        }
 
-            if (descriptor->getAccessMethodName() != IndexNames::TEXT) {
-                BSONObj key = descriptor->keyPattern();
-                BSONObjIterator j(key);
-                while (j.more()) {
-                    BSONElement e = j.next();
-                    _indexedPaths.addPath(e.fieldName());
-                }
-            }
-            else {
-                fts::FTSSpec ftsSpec(descriptor->infoObj());
+        _keysComputed = true;
 
-                if (ftsSpec.wildcard()) {
-                    _indexedPaths.allPathsIndexed();
-                }
-                else {
-                    for (size_t i = 0; i < ftsSpec.numExtraBefore(); ++i) {
-                        _indexedPaths.addPath(ftsSpec.extraBefore(i));
-                    }
-                    for (fts::Weights::const_iterator it = ftsSpec.weights().begin();
-                         it != ftsSpec.weights().end();
-                         ++it) {
-                        _indexedPaths.addPath(it->first);
-                    }
-                    for (size_t i = 0; i < ftsSpec.numExtraAfter(); ++i) {
-                        _indexedPaths.addPath(ftsSpec.extraAfter(i));
-                    }
-                    // Any update to a path containing "language" as a component could change the
-                    // language of a subdocument.  Add the override field as a path component.
-                    _indexedPaths.addPathComponent(ftsSpec.languageOverrideField());
-                }
-            }
+    }
+
+    CollectionInfoCache::ContentVersion CollectionInfoCache::getContentVersion() const {
+        ContentVersion version;
+        version.incarnation = _contentIncarnation;
+        version.generation = _contentGeneration.load();
+        return version;
+    }
+
+    bool CollectionInfoCache::getContentHash( const ContentVersion& version,
+                                              std::string* hash ) const {
+        boost::mutex::scoped_lock lk( _contentHashMutex );
+        if ( _contentHash.empty() || !( _contentHashVersion == version ) ) {
+            return false;
         }
+        *hash = _contentHash;
+        return true;
+    }
 
-        _keysComputed = true;
+    void CollectionInfoCache::setContentHash( const ContentVersion& version,
+                                              const std::string& hash ) {
+        boost::mutex::scoped_lock lk( _contentHashMutex );
+        _contentHashVersion = version;
+        _contentHash = hash;
+    }
 
+    void CollectionInfoCache::notifyOfContentChange( OperationContext* txn ) {
+        _contentGeneration.fetchAndAdd( 1 );
+        txn->recoveryUnit()->registerChange( new ContentChange( &_contentGeneration ) );
     }
 
     void CollectionInfoCache::notifyOfWriteOp() {
@@ -134,4 +244,12 @@ namespace mongo {
         return _querySettings.get();
     }
 
+    IndexStatsCache* CollectionInfoCache::getIndexStatsCache() const {
+        return _indexStatsCache.get();
+    }
+
+    QueryShapeStats* CollectionInfoCache::getQueryShapeStats() const {
+        return _queryShapeStats.get();
+    }
+
 }
@@ -31,10 +31,18 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "mongo/db/query/index_stats.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_settings.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -68,6 +76,75 @@ namespace mongo {
          */
         QuerySettings* getQuerySettings() const;
 
+        /**
+         * Get the sampled index key statistics used to cost candidate plans.
+         */
+        IndexStatsCache* getIndexStatsCache() const;
+
+        /**
+         * Get the cumulative execution statistics of this collection's query shapes.
+         */
+        QueryShapeStats* getQueryShapeStats() const;
+
+        //
+        // Storage stats
+        //
+
+        /**
+         * The sizes dbStats and collStats report that have to be computed by walking storage
+         * structures, such as every extent of an MMAPv1 collection.
+         */
+        struct StorageSizes {
+            StorageSizes() : storageSize(0), totalIndexSize(0) { }
+
+            long long storageSize;
+            BSONObj storageExtraInfo; // what RecordStore::storageSize() added, e.g. numExtents
+            long long totalIndexSize;
+            std::vector<std::pair<std::string, long long> > indexSizes; // by index name
+        };
+
+        /**
+         * Returns the last StorageSizes computed for this collection if they are at most
+         * 'maxStalenessSecs' old, and computes and remembers new ones otherwise. A
+         * 'maxStalenessSecs' of 0 always computes them.
+         */
+        StorageSizes getStorageSizes( OperationContext* txn, int maxStalenessSecs );
+
+        //
+        // Content hash
+        //
+
+        /**
+         * Identifies the documents in this collection: it changes whenever one is inserted,
+         * updated or deleted, and no two collections, even of the same name, ever share one.
+         */
+        struct ContentVersion {
+            ContentVersion() : incarnation(0), generation(0) { }
+
+            bool operator==( const ContentVersion& other ) const {
+                return incarnation == other.incarnation && generation == other.generation;
+            }
+
+            unsigned long long incarnation;
+            unsigned long long generation;
+        };
+
+        ContentVersion getContentVersion() const;
+
+        /**
+         * Fetches the hash dbHash last computed of this collection's documents, if it was
+         * computed at 'version'.
+         */
+        bool getContentHash( const ContentVersion& version, std::string* hash ) const;
+        void setContentHash( const ContentVersion& version, const std::string& hash );
+
+        /**
+         * Called by every write to the collection's documents. The version changes both now
+         * and when the write commits or rolls back, so a hash computed while it was in flight
+         * is never taken to describe the documents after it.
+         */
+        void notifyOfContentChange( OperationContext* txn );
+
         // -------------------
 
         /* get set of index keys for this namespace.  handy to quickly check if a given
@@ -75,6 +152,13 @@ namespace mongo {
         */
         const UpdateIndexData& indexKeys( OperationContext* txn ) const;
 
+        /**
+         * The paths of a single index, by index name, or NULL if the index isn't known to the
+         * cache.
+         */
+        const UpdateIndexData* indexKeys( OperationContext* txn,
+                                          const std::string& indexName ) const;
+
         // ---------------------
 
         /**
@@ -94,6 +178,7 @@ namespace mongo {
         // ---  index keys cache
         bool _keysComputed;
         UpdateIndexData _indexedPaths;
+        std::map<std::string, UpdateIndexData> _indexedPathsByIndex;
 
         // A cache for query plans.
         boost::scoped_ptr<PlanCache> _planCache;
@@ -102,6 +187,25 @@ namespace mongo {
         // Includes index filters.
         boost::scoped_ptr<QuerySettings> _querySettings;
 
+        // Index key statistics for plan costing; cleared by reset().
+        boost::scoped_ptr<IndexStatsCache> _indexStatsCache;
+
+        // Execution statistics by query shape; not affected by reset().
+        boost::scoped_ptr<QueryShapeStats> _queryShapeStats;
+
+        // Concurrent stats commands only hold the collection in a shared mode.
+        boost::mutex _storageSizesMutex;
+        bool _storageSizesComputed;
+        long long _storageSizesComputedAtMillis;
+        StorageSizes _storageSizes;
+
+        const unsigned long long _contentIncarnation;
+        AtomicUInt64 _contentGeneration;
+
+        mutable boost::mutex _contentHashMutex;
+        ContentVersion _contentHashVersion;
+        std::string _contentHash; // empty if there is none
+
         /**
          * Must be called under exclusive DB lock.
          */
@@ -0,0 +1,713 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/collection_validate_online.h"
+
+#include <algorithm>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <set>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/parallel_scan.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_yield.h"
+#include "mongo/db/storage/record_fetcher.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
+
+namespace mongo {
+
+    using std::set;
+    using std::string;
+    using std::vector;
+
+namespace {
+
+    // How many records or keys a thread reads between checks of the throttle.
+    const long long kThrottleBatch = 128;
+
+    // The longest a thread pauses at once, so that it notices being killed.
+    const long long kMaxPauseMillis = 1000;
+
+    // Keys at least this large are refused by the storage engines, so an index which was
+    // allowed to skip them (failIndexKeyTooLong) legitimately lacks them.
+    const int kKeyMaxSize = 1024;
+
+    const size_t kMaxInvalidReported = 10;
+
+    /**
+     * Appends 'obj' to 'buf' in a form which is the same for every key the storage engines
+     * consider equal. Numbers are written as doubles, since an index may not keep their type.
+     */
+    void appendCanonical(BufBuilder* buf, const BSONObj& obj, bool withFieldNames) {
+        BSONObjIterator it(obj);
+        while (it.more()) {
+            const BSONElement e = it.next();
+            buf->appendNum(e.canonicalType());
+            if (withFieldNames) {
+                buf->appendStr(e.fieldName());
+            }
+
+            if (e.isNumber()) {
+                const double d = e.numberDouble();
+                buf->appendNum(d == 0 ? 0.0 : d);
+            }
+            else if (e.type() == CodeWScope) {
+                buf->appendStr(e.codeWScopeCode());
+                appendCanonical(buf, e.codeWScopeObject(), true);
+            }
+            else if (e.isABSONObj()) {
+                appendCanonical(buf, e.embeddedObject(), true);
+            }
+            else {
+                buf->appendBuf(e.value(), e.valuesize());
+            }
+        }
+        buf->appendNum(static_cast<int>(EOO));
+    }
+
+    /**
+     * The count and order independent hash of a set of (key, RecordId) pairs.
+     */
+    struct KeyHash {
+        KeyHash() : count(0) {
+            sums[0] = sums[1] = 0;
+        }
+
+        void add(const BSONObj& key, const RecordId& loc, BufBuilder* scratch) {
+            scratch->reset();
+            appendCanonical(scratch, key, false);
+            scratch->appendNum(static_cast<long long>(loc.repr()));
+
+            uint64_t hash[2];
+            MurmurHash3_x64_128(scratch->buf(), scratch->len(), 0, hash);
+            sums[0] += hash[0];
+            sums[1] += hash[1];
+            count++;
+        }
+
+        void merge(const KeyHash& other) {
+            sums[0] += other.sums[0];
+            sums[1] += other.sums[1];
+            count += other.count;
+        }
+
+        bool operator==(const KeyHash& other) const {
+            return count == other.count && sums[0] == other.sums[0] && sums[1] == other.sums[1];
+        }
+
+        long long count;
+        uint64_t sums[2];
+    };
+
+    /**
+     * Limits the rate at which all the threads of a validation read records and keys.
+     */
+    class ValidateThrottle {
+    public:
+        explicit ValidateThrottle(long long maxItemsPerSecond)
+            : _maxItemsPerSecond(maxItemsPerSecond) { }
+
+        /**
+         * Counts 'items' more items read, and returns how many millis the caller should pause
+         * to stay under the rate.
+         */
+        long long itemsRead(long long items) {
+            if (_maxItemsPerSecond <= 0) {
+                return 0;
+            }
+            const long long total = _items.addAndFetch(items);
+            const long long dueMillis = total * 1000 / _maxItemsPerSecond;
+            return std::max(0LL, std::min(dueMillis - _timer.millis(), kMaxPauseMillis));
+        }
+
+    private:
+        const long long _maxItemsPerSecond;
+        AtomicInt64 _items;
+        const Timer _timer;
+    };
+
+    /**
+     * Sleeps while the locks are yielded.
+     */
+    class ThrottlePause : public RecordFetcher {
+    public:
+        explicit ThrottlePause(long long millis) : _millis(millis) { }
+        virtual void setup() { }
+        virtual void fetch() { sleepmillis(_millis); }
+
+    private:
+        const long long _millis;
+    };
+
+    /**
+     * Pauses the thread running 'exec' if it is over the throttle's rate, without holding its
+     * locks. Returns false if 'exec' was killed meanwhile.
+     */
+    bool pauseIfThrottled(OperationContext* txn,
+                          PlanExecutor* exec,
+                          ValidateThrottle* throttle,
+                          long long itemsRead) {
+        const long long millis = throttle->itemsRead(itemsRead);
+        if (millis <= 0) {
+            return true;
+        }
+
+        exec->saveState();
+        ThrottlePause pause(millis);
+        QueryYield::yieldAllLocks(txn, &pause);
+        return exec->restoreState(txn);
+    }
+
+    Status executorFailure(PlanExecutor::ExecState state, const string& what) {
+        return Status(ErrorCodes::OperationFailed,
+                      str::stream() << "executor returned " << PlanExecutor::statestr(state)
+                                    << " while " << what);
+    }
+
+    /**
+     * Checks the documents of one partition of the collection, and hashes the keys each index
+     * should have for them.
+     */
+    class RecordChecker : public ParallelScanWorker {
+    public:
+        RecordChecker(const string& ns, const vector<string>& indexNames, ValidateThrottle* throttle)
+            : nrecords(0),
+              dataSize(0),
+              nInvalid(0),
+              keys(indexNames.size()),
+              keysTooLong(indexNames.size(), 0),
+              _nss(ns),
+              _indexNames(indexNames),
+              _throttle(throttle) { }
+
+        virtual Status run(OperationContext* txn, PlanExecutor* exec) {
+            BSONObj obj;
+            RecordId loc;
+            long long sinceThrottled = 0;
+            PlanExecutor::ExecState state;
+            while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &loc))) {
+                nrecords++;
+                if (!validateBSON(obj.objdata(), obj.objsize()).isOK()) {
+                    if (invalid.size() < kMaxInvalidReported) {
+                        invalid.push_back(loc);
+                    }
+                    nInvalid++;
+                    continue;
+                }
+                dataSize += obj.objsize();
+                _addKeys(txn, obj, loc);
+
+                if (++sinceThrottled >= kThrottleBatch) {
+                    if (!pauseIfThrottled(txn, exec, _throttle, sinceThrottled)) {
+                        return executorFailure(PlanExecutor::DEAD, "validating records");
+                    }
+                    sinceThrottled = 0;
+                }
+            }
+
+            if (PlanExecutor::IS_EOF != state) {
+                return executorFailure(state, "validating records");
+            }
+            return Status::OK();
+        }
+
+        long long nrecords;
+        long long dataSize;
+        long long nInvalid;
+        vector<RecordId> invalid;
+        vector<KeyHash> keys;
+        vector<long long> keysTooLong;
+
+    private:
+        void _addKeys(OperationContext* txn, const BSONObj& obj, const RecordId& loc) {
+            // The executor has just reacquired the locks, so the collection exists but any of its
+            // indexes may have been dropped while it yielded.
+            Database* db = dbHolder().get(txn, _nss.db());
+            invariant(db);
+            Collection* collection = db->getCollection(_nss.ns());
+            invariant(collection);
+            IndexCatalog* catalog = collection->getIndexCatalog();
+
+            for (size_t i = 0; i < _indexNames.size(); i++) {
+                const IndexDescriptor* descriptor = catalog->findIndexByName(txn, _indexNames[i]);
+                if (NULL == descriptor) {
+                    continue;
+                }
+
+                BSONObjSet indexKeys;
+                catalog->getIndex(descriptor)->getKeys(obj, &indexKeys);
+                for (BSONObjSet::const_iterator it = indexKeys.begin();
+                     it != indexKeys.end();
+                     ++it) {
+                    if (it->objsize() >= kKeyMaxSize) {
+                        keysTooLong[i]++;
+                    }
+                    keys[i].add(*it, loc, &_scratch);
+                }
+            }
+        }
+
+        const NamespaceString _nss;
+        const vector<string>& _indexNames;
+        ValidateThrottle* const _throttle;
+        BufBuilder _scratch;
+    };
+
+    struct IndexToCheck {
+        IndexToCheck() : keysTooLong(0), status(Status::OK()) { }
+
+        string name;
+        string indexNs;
+        KeyHash fromRecords;
+        KeyHash fromIndex;
+        long long keysTooLong;
+        Status status;
+    };
+
+    /**
+     * One attempt at validating the collection.
+     */
+    struct ValidatePass {
+        ValidatePass()
+            : workers(0), nrecords(0), dataSize(0), nInvalid(0), numRecords(0), unchanged(false) { }
+
+        string ns;
+        CollectionInfoCache::ContentVersion version;
+        vector<string> indexNames;
+        vector<IndexToCheck> indexes;
+        size_t workers;
+
+        long long nrecords;
+        long long dataSize;
+        long long nInvalid;
+        vector<RecordId> invalid;
+
+        // The record count kept by the record store, and whether nothing was written to the
+        // collection during the pass.
+        long long numRecords;
+        bool unchanged;
+    };
+
+    /**
+     * Shared between the thread validating a collection and the threads walking its indexes.
+     */
+    class IndexScanState {
+    public:
+        IndexScanState(ValidatePass* pass, ValidateThrottle* throttle)
+            : pass(pass), throttle(throttle), _running(0), _killed(false) { }
+
+        ValidatePass* const pass;
+        ValidateThrottle* const throttle;
+
+        void workerStarting() {
+            boost::mutex::scoped_lock lk(_mutex);
+            _running++;
+        }
+
+        /**
+         * Records the operation of a thread so that it can be killed. Returns false if the
+         * scans were already killed, in which case the thread should not start.
+         */
+        bool registerOp(unsigned int opId) {
+            boost::mutex::scoped_lock lk(_mutex);
+            if (_killed) {
+                return false;
+            }
+            _opIds.insert(opId);
+            return true;
+        }
+
+        void workerDone(unsigned int opId) {
+            boost::mutex::scoped_lock lk(_mutex);
+            _opIds.erase(opId);
+            _running--;
+            _doneCondition.notify_all();
+        }
+
+        /**
+         * Waits for all threads to finish, killing them if 'txn' is interrupted. Returns the
+         * interruption, if any.
+         */
+        Status waitForWorkers(OperationContext* txn) {
+            Status interruptStatus = Status::OK();
+
+            boost::mutex::scoped_lock lk(_mutex);
+            while (_running > 0) {
+                _doneCondition.timed_wait(lk, boost::posix_time::milliseconds(100));
+                if (_killed) {
+                    continue;
+                }
+
+                interruptStatus = txn->checkForInterruptNoAssert();
+                if (!interruptStatus.isOK()) {
+                    _killAll_inlock();
+                }
+            }
+            return interruptStatus;
+        }
+
+        void kill() {
+            boost::mutex::scoped_lock lk(_mutex);
+            _killAll_inlock();
+        }
+
+    private:
+        void _killAll_inlock() {
+            _killed = true;
+            for (set<unsigned int>::const_iterator it = _opIds.begin(); it != _opIds.end(); ++it) {
+                getGlobalEnvironment()->killOperation(*it);
+            }
+        }
+
+        boost::mutex _mutex;
+        boost::condition_variable _doneCondition;
+
+        // All protected by _mutex.
+        size_t _running;
+        bool _killed;
+        set<unsigned int> _opIds;
+    };
+
+    /**
+     * Hashes every (key, RecordId) pair in an index.
+     */
+    Status scanIndex(OperationContext* txn, IndexScanState* state, IndexToCheck* index) {
+        AutoGetCollectionForRead ctx(txn, state->pass->ns);
+        Collection* collection = ctx.getCollection();
+        if (NULL == collection) {
+            return Status(ErrorCodes::NamespaceNotFound,
+                          str::stream() << state->pass->ns << " was dropped during validation");
+        }
+
+        const IndexDescriptor* descriptor =
+            collection->getIndexCatalog()->findIndexByName(txn, index->name);
+        if (NULL == descriptor) {
+            return Status(ErrorCodes::IndexNotFound,
+                          str::stream() << index->indexNs << " was dropped during validation");
+        }
+
+        const boost::scoped_ptr<PlanExecutor> exec(
+            InternalPlanner::indexScan(txn, collection, descriptor, BSONObj(), BSONObj(), false));
+        exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+        BufBuilder scratch;
+        BSONObj key;
+        RecordId loc;
+        long long sinceThrottled = 0;
+        PlanExecutor::ExecState execState;
+        while (PlanExecutor::ADVANCED == (execState = exec->getNext(&key, &loc))) {
+            index->fromIndex.add(key, loc, &scratch);
+
+            if (++sinceThrottled >= kThrottleBatch) {
+                if (!pauseIfThrottled(txn, exec.get(), state->throttle, sinceThrottled)) {
+                    execState = PlanExecutor::DEAD;
+                    break;
+                }
+                sinceThrottled = 0;
+            }
+        }
+
+        if (PlanExecutor::IS_EOF != execState) {
+            // An index dropped while the scan yielded kills the scan.
+            if (NULL == collection->getIndexCatalog()->findIndexByName(txn, index->name)) {
+                return Status(ErrorCodes::IndexNotFound,
+                              str::stream() << index->indexNs << " was dropped during validation");
+            }
+            return executorFailure(execState, "validating index " + index->indexNs);
+        }
+        return Status::OK();
+    }
+
+    void runIndexScanThread(IndexScanState* state, IndexToCheck* index) {
+        Client::initThread("validate");
+
+        unsigned int opId = 0;
+        try {
+            OperationContextImpl txn;
+            opId = txn.getCurOp()->opNum();
+            if (state->registerOp(opId)) {
+                index->status = scanIndex(&txn, state, index);
+            }
+            else {
+                index->status = Status(ErrorCodes::Interrupted, "validate was killed");
+            }
+        }
+        catch (const DBException& ex) {
+            index->status = ex.toStatus();
+        }
+        catch (const std::exception& ex) {
+            index->status = Status(ErrorCodes::InternalError, ex.what());
+        }
+
+        state->workerDone(opId);
+        cc().shutdown();
+    }
+
+    vector<string> readyIndexNames(OperationContext* txn, Collection* collection) {
+        vector<string> names;
+        IndexCatalog::IndexIterator it =
+            collection->getIndexCatalog()->getIndexIterator(txn, false);
+        while (it.more()) {
+            names.push_back(it.next()->indexName());
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    /**
+     * Remembers how the collection looks before a pass.
+     */
+    Status startPass(OperationContext* txn, ValidatePass* pass) {
+        AutoGetCollectionForRead ctx(txn, pass->ns);
+        Collection* collection = ctx.getCollection();
+        if (NULL == collection) {
+            return Status(ErrorCodes::NamespaceNotFound, "ns not found");
+        }
+
+        pass->version = collection->infoCache()->getContentVersion();
+        pass->indexNames = readyIndexNames(txn, collection);
+        pass->indexes.resize(pass->indexNames.size());
+        for (size_t i = 0; i < pass->indexNames.size(); i++) {
+            IndexToCheck& index = pass->indexes[i];
+            index.name = pass->indexNames[i];
+            index.indexNs = IndexDescriptor::makeIndexNamespace(pass->ns, index.name);
+        }
+        pass->workers = std::max<size_t>(1, parallelScanWorkers(txn, collection));
+        return Status::OK();
+    }
+
+    /**
+     * Checks whether the collection was written to during the pass.
+     */
+    Status finishPass(OperationContext* txn, ValidatePass* pass) {
+        AutoGetCollectionForRead ctx(txn, pass->ns);
+        Collection* collection = ctx.getCollection();
+        if (NULL == collection) {
+            return Status(ErrorCodes::NamespaceNotFound,
+                          str::stream() << pass->ns << " was dropped during validation");
+        }
+
+        pass->numRecords = collection->getRecordStore()->numRecords(txn);
+        pass->unchanged = pass->unchanged &&
+            collection->infoCache()->getContentVersion() == pass->version &&
+            readyIndexNames(txn, collection) == pass->indexNames;
+        return Status::OK();
+    }
+
+    Status runPass(OperationContext* txn, ValidateThrottle* throttle, ValidatePass* pass) {
+        Status status = startPass(txn, pass);
+        if (!status.isOK()) {
+            return status;
+        }
+        pass->unchanged = true;
+
+        // The indexes are walked on their own threads while the records are scanned here.
+        IndexScanState state(pass, throttle);
+        boost::thread_group threads;
+        try {
+            for (size_t i = 0; i < pass->indexes.size(); i++) {
+                state.workerStarting();
+                try {
+                    threads.create_thread(stdx::bind(&runIndexScanThread,
+                                                     &state,
+                                                     &pass->indexes[i]));
+                }
+                catch (...) {
+                    pass->indexes[i].status = Status(ErrorCodes::InternalError,
+                                                     "couldn't start index validation thread");
+                    state.workerDone(0);
+                    throw;
+                }
+            }
+
+            OwnedPointerVector<ParallelScanWorker> workers;
+            for (size_t i = 0; i < pass->workers; i++) {
+                workers.mutableVector().push_back(
+                    new RecordChecker(pass->ns, pass->indexNames, throttle));
+            }
+            status = runParallelCollectionScan(txn, pass->ns, BSONObj(), workers.vector());
+
+            for (size_t i = 0; status.isOK() && i < workers.size(); i++) {
+                const RecordChecker* checker = static_cast<RecordChecker*>(workers[i]);
+                pass->nrecords += checker->nrecords;
+                pass->dataSize += checker->dataSize;
+                pass->nInvalid += checker->nInvalid;
+                for (size_t j = 0; j < checker->invalid.size(); j++) {
+                    if (pass->invalid.size() < kMaxInvalidReported) {
+                        pass->invalid.push_back(checker->invalid[j]);
+                    }
+                }
+                for (size_t j = 0; j < pass->indexes.size(); j++) {
+                    pass->indexes[j].fromRecords.merge(checker->keys[j]);
+                    pass->indexes[j].keysTooLong += checker->keysTooLong[j];
+                }
+            }
+        }
+        catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+        catch (const std::exception& ex) {
+            status = Status(ErrorCodes::InternalError, ex.what());
+        }
+
+        if (!status.isOK()) {
+            state.kill();
+        }
+        const Status interruptStatus = state.waitForWorkers(txn);
+        threads.join_all();
+        if (!status.isOK()) {
+            return status;
+        }
+        if (!interruptStatus.isOK()) {
+            return interruptStatus;
+        }
+
+        for (size_t i = 0; i < pass->indexes.size(); i++) {
+            const Status& indexStatus = pass->indexes[i].status;
+            if (indexStatus.code() == ErrorCodes::IndexNotFound) {
+                pass->unchanged = false;
+            }
+            else if (!indexStatus.isOK()) {
+                return indexStatus;
+            }
+        }
+
+        return finishPass(txn, pass);
+    }
+
+}  // namespace
+
+    Status validateCollectionOnline(OperationContext* txn,
+                                    const string& ns,
+                                    const OnlineValidateOptions& options,
+                                    ValidateResults* results,
+                                    BSONObjBuilder* output) {
+        invariant(!txn->lockState()->isLocked());
+
+        ValidateThrottle throttle(options.maxItemsPerSecond);
+        ValidatePass pass;
+        int attempts = 0;
+        while (true) {
+            attempts++;
+            pass = ValidatePass();
+            pass.ns = ns;
+            Status status = runPass(txn, &throttle, &pass);
+            if (!status.isOK()) {
+                return status;
+            }
+            if (pass.unchanged || attempts >= options.maxAttempts) {
+                break;
+            }
+            LOG(1) << ns << " changed during online validation, starting over";
+        }
+
+        vector<string> warnings;
+
+        if (pass.nInvalid > 0) {
+            for (size_t i = 0; i < pass.invalid.size(); i++) {
+                log() << "invalid BSON document in " << ns << " at " << pass.invalid[i];
+            }
+            results->errors.push_back(str::stream() << pass.nInvalid << " invalid BSON documents"
+                                                    << " (see logs for more info)");
+            results->valid = false;
+        }
+
+        BSONObjBuilder keysPerIndex;
+        for (size_t i = 0; i < pass.indexes.size(); i++) {
+            const IndexToCheck& index = pass.indexes[i];
+            keysPerIndex.appendNumber(index.indexNs, index.fromIndex.count);
+
+            if (!pass.unchanged || index.fromIndex == index.fromRecords) {
+                continue;
+            }
+
+            const string mismatch = str::stream()
+                << "index " << index.indexNs << " has " << index.fromIndex.count
+                << " keys which do not match the " << index.fromRecords.count
+                << " keys generated by the records";
+            if (index.keysTooLong > 0) {
+                warnings.push_back(str::stream() << mismatch << ", but " << index.keysTooLong
+                                                 << " keys are too large to index and may"
+                                                 << " have been skipped");
+            }
+            else {
+                results->errors.push_back(mismatch);
+                results->valid = false;
+            }
+        }
+
+        if (pass.unchanged && pass.numRecords != pass.nrecords) {
+            warnings.push_back(str::stream() << "record count of " << pass.numRecords
+                                             << " differs from the " << pass.nrecords
+                                             << " records found");
+        }
+        if (!pass.unchanged) {
+            warnings.push_back(str::stream() << "collection kept changing during " << attempts
+                                             << " attempts, indexes were not compared with the"
+                                             << " records");
+        }
+
+        output->appendBool("online", true);
+        output->appendNumber("nrecords", pass.nrecords);
+        output->appendNumber("datasize", pass.dataSize);
+        output->append("nIndexes", static_cast<int>(pass.indexes.size()));
+        output->append("keysPerIndex", keysPerIndex.obj());
+        output->appendBool("consistencyChecked", pass.unchanged);
+        output->append("attempts", attempts);
+        if (!warnings.empty()) {
+            output->append("warnings", warnings);
+        }
+
+        return Status::OK();
+    }
+
+}  // namespace mongo
@@ -0,0 +1,71 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/status.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class OperationContext;
+    struct ValidateResults;
+
+    struct OnlineValidateOptions {
+        OnlineValidateOptions() : maxItemsPerSecond(0), maxAttempts(3) { }
+
+        // Records read plus index keys read, across all threads. 0 means unthrottled.
+        long long maxItemsPerSecond;
+
+        // How many times to start over when the collection is written to during a pass.
+        int maxAttempts;
+    };
+
+    /**
+     * Validates the collection 'ns' while it stays available for writes. The caller must not
+     * hold any locks.
+     *
+     * The records are read by a parallel collection scan, which checks each document's BSON and
+     * recomputes the keys each index should hold for it. At the same time every index is walked
+     * on its own thread. Each side folds its (key, RecordId) pairs into an order independent
+     * hash and count per index, so the index and the records are compared without looking up
+     * every key. All of the scans take intent locks and yield.
+     *
+     * The comparison only holds if nothing was written to the collection while it ran. If
+     * something was, the check is retried up to 'options.maxAttempts' times, after which the
+     * result is reported with "consistencyChecked" set to false.
+     */
+    Status validateCollectionOnline(OperationContext* txn,
+                                    const std::string& ns,
+                                    const OnlineValidateOptions& options,
+                                    ValidateResults* results,
+                                    BSONObjBuilder* output);
+
+}  // namespace mongo
@@ -328,18 +328,24 @@ namespace mongo {
     }
 
     void CursorManager::invalidateAll( bool collectionGoingAway ) {
-        SimpleMutex::scoped_lock lk( _mutex );
-
-        for ( ExecSet::iterator it = _nonCachedExecutors.begin();
-              it != _nonCachedExecutors.end();
-              ++it ) {
-
-            // we kill the executor, but it deletes itself
-            PlanExecutor* exec = *it;
-            exec->kill();
-            invariant( exec->collection() == NULL );
+        for ( size_t i = 0; i < kNumExecutorPartitions; ++i ) {
+            ExecutorPartition& partition = _executorPartitions[i];
+            SimpleMutex::scoped_lock lk( partition.mutex );
+
+            for ( ExecSet::iterator it = partition.executors.begin();
+                  it != partition.executors.end();
+                  ++it ) {
+
+                // we kill the executor, but it deletes itself
+                PlanExecutor* exec = *it;
+                exec->kill();
+                invariant( exec->collection() == NULL );
+            }
+            _numNonCachedExecutors.subtractAndFetch( partition.executors.size() );
+            partition.executors.clear();
         }
-        _nonCachedExecutors.clear();
+
+        SimpleMutex::scoped_lock lk( _mutex );
 
         if ( collectionGoingAway ) {
             // we're going to wipe out the world
@@ -405,16 +411,25 @@ namespace mongo {
             return;
         }
 
-        SimpleMutex::scoped_lock lk( _mutex );
+        // Writers that invalidate hold the collection exclusively, and executors only register
+        // and deregister under a collection lock, so the count can't change under us.
+        if ( _numNonCachedExecutors.load() != 0 ) {
+            for ( size_t i = 0; i < kNumExecutorPartitions; ++i ) {
+                ExecutorPartition& partition = _executorPartitions[i];
+                SimpleMutex::scoped_lock lk( partition.mutex );
 
-        for ( ExecSet::iterator it = _nonCachedExecutors.begin();
-              it != _nonCachedExecutors.end();
-              ++it ) {
+                for ( ExecSet::iterator it = partition.executors.begin();
+                      it != partition.executors.end();
+                      ++it ) {
 
-            PlanExecutor* exec = *it;
-            exec->invalidate(txn, dl, type);
+                    PlanExecutor* exec = *it;
+                    exec->invalidate(txn, dl, type);
+                }
+            }
         }
 
+        SimpleMutex::scoped_lock lk( _mutex );
+
         for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
             PlanExecutor* exec = i->second->getExecutor();
             if ( exec ) {
@@ -445,15 +460,24 @@ namespace mongo {
         return toDelete.size();
     }
 
+    CursorManager::ExecutorPartition& CursorManager::partitionFor( PlanExecutor* exec ) {
+        // Drop the low bits, which are the same for every heap allocated executor.
+        const size_t bits = reinterpret_cast<size_t>( exec ) >> 4;
+        return _executorPartitions[ ( bits ^ ( bits >> 8 ) ) % kNumExecutorPartitions ];
+    }
+
     void CursorManager::registerExecutor( PlanExecutor* exec ) {
-        SimpleMutex::scoped_lock lk(_mutex);
-        const std::pair<ExecSet::iterator, bool> result = _nonCachedExecutors.insert(exec);
+        ExecutorPartition& partition = partitionFor( exec );
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        const std::pair<ExecSet::iterator, bool> result = partition.executors.insert(exec);
         invariant(result.second); // make sure this was inserted
+        _numNonCachedExecutors.fetchAndAdd( 1 );
     }
 
     void CursorManager::deregisterExecutor( PlanExecutor* exec ) {
-        SimpleMutex::scoped_lock lk(_mutex);
-        _nonCachedExecutors.erase(exec);
+        ExecutorPartition& partition = partitionFor( exec );
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        _numNonCachedExecutors.subtractAndFetch( partition.executors.erase(exec) );
     }
 
     ClientCursor* CursorManager::find( CursorId id, bool pin ) {
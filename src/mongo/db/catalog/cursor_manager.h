@@ -36,6 +36,7 @@
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/unordered_set.h"
 #include "mongo/util/concurrency/mutex.h"
 
@@ -143,10 +144,28 @@ namespace mongo {
         unsigned _collectionCacheRuntimeId;
         boost::scoped_ptr<PseudoRandom> _random;
 
+        // Protects _cursors.  Never held together with an ExecutorPartition's mutex.
         mutable SimpleMutex _mutex;
 
         typedef unordered_set<PlanExecutor*> ExecSet;
-        ExecSet _nonCachedExecutors;
+
+        // Executors register and deregister around every query on the collection, so they are
+        // spread over several sets, each with its own mutex, rather than all contending for
+        // _mutex.  Invalidations visit every partition.
+        struct ExecutorPartition {
+            ExecutorPartition() : mutex("CursorManagerExecutors") { }
+            SimpleMutex mutex;
+            ExecSet executors;
+        };
+
+        static const size_t kNumExecutorPartitions = 16;
+
+        ExecutorPartition& partitionFor(PlanExecutor* exec);
+
+        ExecutorPartition _executorPartitions[kNumExecutorPartitions];
+
+        // Number of executors in all partitions.
+        AtomicUInt32 _numNonCachedExecutors;
 
         typedef std::map<CursorId,ClientCursor*> CursorMap;
         CursorMap _cursors;
@@ -303,7 +303,10 @@ namespace mongo {
         return Status::OK();
     }
 
-    void Database::getStats( OperationContext* opCtx, BSONObjBuilder* output, double scale ) {
+    void Database::getStats( OperationContext* opCtx,
+                             BSONObjBuilder* output,
+                             double scale,
+                             int maxStalenessSecs ) {
         list<string> collections;
         _dbEntry->getCollectionNamespaces( &collections );
 
@@ -326,12 +329,13 @@ namespace mongo {
             objects += collection->numRecords(opCtx);
             size += collection->dataSize(opCtx);
 
-            BSONObjBuilder temp;
-            storageSize += collection->getRecordStore()->storageSize( opCtx, &temp );
-            numExtents += temp.obj()["numExtents"].numberInt(); // XXX
+            const CollectionInfoCache::StorageSizes sizes =
+                collection->infoCache()->getStorageSizes( opCtx, maxStalenessSecs );
+            storageSize += sizes.storageSize;
+            numExtents += sizes.storageExtraInfo["numExtents"].numberInt(); // XXX
 
             indexes += collection->getIndexCatalog()->numIndexesTotal( opCtx );
-            indexSize += collection->getIndexSize(opCtx);
+            indexSize += sizes.totalIndexSize;
         }
 
         output->appendNumber( "collections" , ncollections );
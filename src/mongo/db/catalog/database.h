@@ -78,7 +78,14 @@ namespace mongo {
         int getProfilingLevel() const { return _profile; }
         const char* getProfilingNS() const { return _profileName.c_str(); }
 
-        void getStats( OperationContext* opCtx, BSONObjBuilder* output, double scale = 1 );
+        /**
+         * Sizes that are expensive to compute may be served from each collection's cache if
+         * they are at most 'maxStalenessSecs' old. See CollectionInfoCache::getStorageSizes().
+         */
+        void getStats( OperationContext* opCtx,
+                       BSONObjBuilder* output,
+                       double scale = 1,
+                       int maxStalenessSecs = 0 );
 
         const DatabaseCatalogEntry* getDatabaseCatalogEntry() const;
 
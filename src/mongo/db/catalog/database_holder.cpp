@@ -42,6 +42,7 @@
 #include "mongo/db/global_environment_experiment.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/storage/storage_engine.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/file_allocator.h"
 #include "mongo/util/log.h"
 
@@ -71,8 +72,65 @@ namespace {
 
     DatabaseHolder _dbHolder;
 
+    /**
+     * The last few databases a thread looked up. An entry stays good while the holder's close
+     * epoch is unchanged: opening other databases doesn't move existing ones, and the lock the
+     * caller holds on its database keeps that one from being closed during the lookup.
+     */
+    class DatabaseLookupCache {
+    public:
+        DatabaseLookupCache() : _next(0) {
+            for (int i = 0; i < kNumEntries; ++i) {
+                _entries[i].holder = NULL;
+                _entries[i].db = NULL;
+            }
+        }
+
+        Database* find(const DatabaseHolder* holder,
+                       unsigned long long closeEpoch,
+                       const StringData& name) const {
+            for (int i = 0; i < kNumEntries; ++i) {
+                const Entry& entry = _entries[i];
+                if (entry.holder == holder && entry.closeEpoch == closeEpoch &&
+                    name == entry.name) {
+                    return entry.db;
+                }
+            }
+            return NULL;
+        }
+
+        void add(const DatabaseHolder* holder,
+                 unsigned long long closeEpoch,
+                 const StringData& name,
+                 Database* db) {
+            Entry& entry = _entries[_next];
+            _next = (_next + 1) % kNumEntries;
+
+            entry.holder = holder;
+            entry.closeEpoch = closeEpoch;
+            entry.name.assign(name.rawData(), name.size());
+            entry.db = db;
+        }
+
+    private:
+        enum { kNumEntries = 4 };
+
+        struct Entry {
+            const DatabaseHolder* holder;
+            unsigned long long closeEpoch;
+            std::string name;
+            Database* db;
+        };
+
+        Entry _entries[kNumEntries];
+        int _next;
+    };
+
 } // namespace
 
+    TSP_DECLARE(DatabaseLookupCache, databaseLookupCache);
+    TSP_DEFINE(DatabaseLookupCache, databaseLookupCache);
+
 
     DatabaseHolder& dbHolder() {
         return _dbHolder;
@@ -85,9 +143,16 @@ namespace {
         const StringData db = _todb(ns);
         invariant(txn->lockState()->isDbLockedForMode(db, MODE_IS));
 
+        DatabaseLookupCache* cache = databaseLookupCache.getMake();
+        Database* cached = cache->find(this, _closeEpoch.load(), db);
+        if (cached) {
+            return cached;
+        }
+
         SimpleMutex::scoped_lock lk(_m);
         DBs::const_iterator it = _dbs.find(db);
         if (it != _dbs.end()) {
+            cache->add(this, _closeEpoch.load(), db, it->second);
             return it->second;
         }
 
@@ -162,6 +227,8 @@ namespace {
             return;
         }
 
+        _closeEpoch.fetchAndAdd(1);
+
         it->second->close( txn );
         delete it->second;
         _dbs.erase(it);
@@ -194,6 +261,8 @@ namespace {
                 continue;
             }
 
+            _closeEpoch.fetchAndAdd(1);
+
             Database* db = _dbs[name];
             db->close( txn );
             delete db;
@@ -32,6 +32,7 @@
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
 
@@ -49,6 +50,9 @@ namespace mongo {
         /**
          * Retrieves an already opened database or returns NULL. Must be called with the database
          * locked in at least IS-mode.
+         *
+         * Databases a thread has already found are returned from a small per-thread cache without
+         * taking the registry mutex, for as long as no database has been closed since.
          */
         Database* get(OperationContext* txn, const StringData& ns) const;
 
@@ -91,6 +95,9 @@ namespace mongo {
 
         mutable SimpleMutex _m;
         DBs _dbs;
+
+        // Bumped, under _m, whenever a database is closed, to invalidate the per-thread caches
+        AtomicUInt64 _closeEpoch;
     };
 
     DatabaseHolder& dbHolder();
@@ -0,0 +1,230 @@
+// document_cache.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/document_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    namespace {
+        // Rough size of the bookkeeping for one cached document.
+        const long long kEntryOverheadBytes = 128;
+    }
+
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(internalDocumentCacheSizeBytes, long long, 0);
+
+    // static
+    DocumentCache* DocumentCache::get() {
+        static DocumentCache* cache = internalDocumentCacheSizeBytes > 0 ?
+            new DocumentCache(internalDocumentCacheSizeBytes) : NULL;
+        return cache;
+    }
+
+    bool DocumentCache::Key::operator<(const Key& other) const {
+        if (collection != other.collection) {
+            return std::less<const Collection*>()(collection, other.collection);
+        }
+        return id.woCompare(other.id, BSONObj(), false) < 0;
+    }
+
+    DocumentCache::DocumentCache(long long budgetBytes)
+        : _budgetBytes(budgetBytes),
+          _bytesUsed(0),
+          _sketch(kSketchRows * kSketchWidth, 0),
+          _accessesSinceReset(0) { }
+
+    // static
+    uint32_t DocumentCache::_hash(const Collection* collection, const BSONElement& id) {
+        // FNV-1a. Numbers are hashed by value so that equal _ids of different numeric types
+        // usually share their frequency count.
+        uint32_t hash = 2166136261U;
+        const uintptr_t ptr = reinterpret_cast<uintptr_t>(collection);
+        const char* data;
+        size_t size;
+        double number;
+        if (id.isNumber()) {
+            number = id.numberDouble();
+            data = reinterpret_cast<const char*>(&number);
+            size = sizeof(number);
+        }
+        else {
+            data = id.value();
+            size = id.valuesize();
+        }
+
+        const char* ptrBytes = reinterpret_cast<const char*>(&ptr);
+        for (size_t i = 0; i < sizeof(ptr); i++) {
+            hash = (hash ^ static_cast<uint8_t>(ptrBytes[i])) * 16777619U;
+        }
+        hash = (hash ^ static_cast<uint8_t>(id.canonicalType())) * 16777619U;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619U;
+        }
+        return hash;
+    }
+
+    namespace {
+        size_t sketchIndex(uint32_t hash, int row, int width) {
+            uint32_t h = hash + row * 0x9e3779b9U;
+            h ^= h >> 15;
+            h *= 0x2c1b3c6dU;
+            h ^= h >> 12;
+            return row * width + (h & (width - 1));
+        }
+    }
+
+    void DocumentCache::_recordAccess(uint32_t hash) {
+        for (int row = 0; row < kSketchRows; row++) {
+            uint8_t& count = _sketch[sketchIndex(hash, row, kSketchWidth)];
+            if (count < kMaxCount) {
+                count++;
+            }
+        }
+
+        // Halve every counter once in a while so that keys which used to be hot stop crowding
+        // out keys that are hot now.
+        if (++_accessesSinceReset >= 10 * kSketchWidth) {
+            for (size_t i = 0; i < _sketch.size(); i++) {
+                _sketch[i] /= 2;
+            }
+            _accessesSinceReset = 0;
+        }
+    }
+
+    int DocumentCache::_frequency(uint32_t hash) const {
+        int frequency = kMaxCount;
+        for (int row = 0; row < kSketchRows; row++) {
+            frequency = std::min(frequency,
+                                 static_cast<int>(_sketch[sketchIndex(hash, row, kSketchWidth)]));
+        }
+        return frequency;
+    }
+
+    bool DocumentCache::find(const Collection* collection, const BSONObj& idKey,
+                             RecordId* locOut, BSONObj* objOut) {
+        boost::mutex::scoped_lock lk(_mutex);
+        _recordAccess(_hash(collection, idKey.firstElement()));
+
+        EntryMap::iterator it = _entries.find(Key(collection, idKey));
+        if (it == _entries.end()) {
+            return false;
+        }
+
+        _lru.splice(_lru.begin(), _lru, it->second.lruPos);
+        *locOut = it->second.loc;
+        *objOut = it->second.obj;
+        return true;
+    }
+
+    bool DocumentCache::insert(const Collection* collection, const BSONObj& idKey,
+                               const RecordId& loc, const BSONObj& obj) {
+        const long long bytes = obj.objsize() + idKey.objsize() + kEntryOverheadBytes;
+        if (bytes > _budgetBytes) {
+            return false;
+        }
+
+        BSONObj ownedKey = idKey.getOwned();
+        BSONObj ownedObj = obj.getOwned();
+        const uint32_t hash = _hash(collection, ownedKey.firstElement());
+
+        boost::mutex::scoped_lock lk(_mutex);
+
+        Key key(collection, ownedKey);
+        EntryMap::iterator existing = _entries.find(key);
+        if (existing != _entries.end()) {
+            _erase(existing);
+        }
+        LocMap::iterator atLoc = _byLoc.find(std::make_pair(collection, loc));
+        if (atLoc != _byLoc.end()) {
+            _erase(atLoc->second);
+        }
+
+        const int frequency = _frequency(hash);
+        while (_bytesUsed + bytes > _budgetBytes) {
+            EntryMap::iterator victim = _lru.back();
+            if (frequency <= _frequency(victim->second.hash)) {
+                return false;
+            }
+            _erase(victim);
+        }
+
+        EntryMap::iterator it = _entries.insert(std::make_pair(key, Entry())).first;
+        Entry& entry = it->second;
+        entry.loc = loc;
+        entry.obj = ownedObj;
+        entry.bytes = bytes;
+        entry.hash = hash;
+        entry.lruPos = _lru.insert(_lru.begin(), it);
+        _byLoc[std::make_pair(collection, loc)] = it;
+        _bytesUsed += bytes;
+        return true;
+    }
+
+    void DocumentCache::invalidate(const Collection* collection, const RecordId& loc) {
+        boost::mutex::scoped_lock lk(_mutex);
+        LocMap::iterator it = _byLoc.find(std::make_pair(collection, loc));
+        if (it != _byLoc.end()) {
+            _erase(it->second);
+        }
+    }
+
+    void DocumentCache::invalidateAll(const Collection* collection) {
+        boost::mutex::scoped_lock lk(_mutex);
+        // Entries are ordered by collection first, and no _id key is empty.
+        EntryMap::iterator it = _entries.lower_bound(Key(collection, BSONObj()));
+        while (it != _entries.end() && it->first.collection == collection) {
+            _erase(it++);
+        }
+    }
+
+    void DocumentCache::_erase(EntryMap::iterator it) {
+        _bytesUsed -= it->second.bytes;
+        _byLoc.erase(std::make_pair(it->first.collection, it->second.loc));
+        _lru.erase(it->second.lruPos);
+        _entries.erase(it);
+    }
+
+    long long DocumentCache::bytesUsed() const {
+        boost::mutex::scoped_lock lk(_mutex);
+        return _bytesUsed;
+    }
+
+    size_t DocumentCache::numEntries() const {
+        boost::mutex::scoped_lock lk(_mutex);
+        return _entries.size();
+    }
+
+}
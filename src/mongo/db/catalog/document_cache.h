@@ -0,0 +1,145 @@
+// document_cache.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+
+namespace mongo {
+
+    class Collection;
+
+    /**
+     * A process-wide cache of whole documents keyed by their collection and _id, which lets
+     * IDHackStage answer repeated point lookups without touching the _id index or the record
+     * store.
+     *
+     * The cache holds at most 'budgetBytes' of owned BSON. A document that doesn't fit only gets
+     * in if it has been asked for more often than the least recently used entry it would push out;
+     * access frequencies are tracked in a small count-min sketch whose counters are halved
+     * periodically (TinyLFU admission).
+     *
+     * The cache doesn't know about snapshots. Callers may only insert documents they read while
+     * no writer could be modifying the collection, and every write must call invalidate() before
+     * it changes or removes a document. IDHackStage therefore only uses it on storage engines
+     * without document-level locking, where writers hold the collection exclusively.
+     *
+     * Collections are only used as keys and are never dereferenced.
+     */
+    class DocumentCache {
+        MONGO_DISALLOW_COPYING(DocumentCache);
+    public:
+        explicit DocumentCache(long long budgetBytes);
+
+        /**
+         * The cache used by the server, sized by the internalDocumentCacheSizeBytes startup
+         * parameter. Returns NULL when the parameter is 0, which is the default.
+         */
+        static DocumentCache* get();
+
+        /**
+         * Looks up the document with _id equal to the first element of 'idKey'. On a hit fills
+         * in 'locOut' and 'objOut' (owned) and returns true. Every call, hit or miss, counts
+         * towards the key's access frequency.
+         */
+        bool find(const Collection* collection, const BSONObj& idKey,
+                  RecordId* locOut, BSONObj* objOut);
+
+        /**
+         * Offers a document read at 'loc' to the cache. Returns whether it was admitted.
+         */
+        bool insert(const Collection* collection, const BSONObj& idKey,
+                    const RecordId& loc, const BSONObj& obj);
+
+        /**
+         * Removes the document stored at 'loc', if cached.
+         */
+        void invalidate(const Collection* collection, const RecordId& loc);
+
+        /**
+         * Removes every document of 'collection'.
+         */
+        void invalidateAll(const Collection* collection);
+
+        long long bytesUsed() const;
+        size_t numEntries() const;
+
+    private:
+        struct Key {
+            Key(const Collection* c, const BSONObj& i) : collection(c), id(i) { }
+            const Collection* collection;
+            BSONObj id; // {"": <_id value>}, owned once stored
+            bool operator<(const Key& other) const;
+        };
+
+        struct Entry;
+        typedef std::map<Key, Entry> EntryMap;
+        typedef std::list<EntryMap::iterator> LruList;
+
+        struct Entry {
+            RecordId loc;
+            BSONObj obj;
+            long long bytes;
+            uint32_t hash;
+            LruList::iterator lruPos;
+        };
+
+        typedef std::map<std::pair<const Collection*, RecordId>, EntryMap::iterator> LocMap;
+
+        static uint32_t _hash(const Collection* collection, const BSONElement& id);
+
+        // Count-min sketch with saturating 4-bit style counters kept in bytes
+        void _recordAccess(uint32_t hash);
+        int _frequency(uint32_t hash) const;
+
+        void _erase(EntryMap::iterator it);
+
+        const long long _budgetBytes;
+
+        mutable boost::mutex _mutex;
+        EntryMap _entries;
+        LocMap _byLoc;
+        LruList _lru; // most recently used at the front
+        long long _bytesUsed;
+
+        static const int kSketchRows = 4;
+        static const int kSketchWidth = 4096; // must be a power of two
+        static const uint8_t kMaxCount = 15;
+        std::vector<uint8_t> _sketch;
+        int _accessesSinceReset;
+    };
+
+}
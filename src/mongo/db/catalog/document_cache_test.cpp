@@ -0,0 +1,164 @@
+// document_cache_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/document_cache.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+    namespace {
+        // The cache never dereferences collections, it only compares their addresses.
+        const Collection* fakeCollection(int n) {
+            static char storage[4];
+            return reinterpret_cast<const Collection*>(&storage[n]);
+        }
+
+        BSONObj doc(int id, int size = 10) {
+            return BSON("_id" << id << "pad" << std::string(size, 'x'));
+        }
+
+        BSONObj idKey(int id) {
+            return BSON("_id" << id);
+        }
+    }
+
+    TEST(DocumentCache, FindAfterInsert) {
+        DocumentCache cache(1024 * 1024);
+        const Collection* coll = fakeCollection(0);
+
+        RecordId loc;
+        BSONObj obj;
+        ASSERT_FALSE(cache.find(coll, idKey(1), &loc, &obj));
+        ASSERT_TRUE(cache.insert(coll, idKey(1), RecordId(5), doc(1)));
+
+        ASSERT_TRUE(cache.find(coll, idKey(1), &loc, &obj));
+        ASSERT_EQUALS(RecordId(5), loc);
+        ASSERT_EQUALS(doc(1), obj);
+
+        // _id comparison follows index key semantics, not the field name or numeric type
+        ASSERT_TRUE(cache.find(coll, BSON("" << 1.0), &loc, &obj));
+
+        ASSERT_FALSE(cache.find(coll, idKey(2), &loc, &obj));
+        ASSERT_FALSE(cache.find(fakeCollection(1), idKey(1), &loc, &obj));
+    }
+
+    TEST(DocumentCache, Invalidate) {
+        DocumentCache cache(1024 * 1024);
+        const Collection* coll = fakeCollection(0);
+        const Collection* other = fakeCollection(1);
+        ASSERT_TRUE(cache.insert(coll, idKey(1), RecordId(1), doc(1)));
+        ASSERT_TRUE(cache.insert(coll, idKey(2), RecordId(2), doc(2)));
+        ASSERT_TRUE(cache.insert(other, idKey(1), RecordId(1), doc(1)));
+
+        RecordId loc;
+        BSONObj obj;
+        cache.invalidate(coll, RecordId(1));
+        ASSERT_FALSE(cache.find(coll, idKey(1), &loc, &obj));
+        ASSERT_TRUE(cache.find(coll, idKey(2), &loc, &obj));
+        ASSERT_TRUE(cache.find(other, idKey(1), &loc, &obj));
+
+        cache.invalidateAll(coll);
+        ASSERT_FALSE(cache.find(coll, idKey(2), &loc, &obj));
+        ASSERT_TRUE(cache.find(other, idKey(1), &loc, &obj));
+        ASSERT_EQUALS(1U, cache.numEntries());
+
+        cache.invalidateAll(other);
+        ASSERT_EQUALS(0U, cache.numEntries());
+        ASSERT_EQUALS(0, cache.bytesUsed());
+    }
+
+    TEST(DocumentCache, ReinsertAtSameLocReplaces) {
+        DocumentCache cache(1024 * 1024);
+        const Collection* coll = fakeCollection(0);
+        ASSERT_TRUE(cache.insert(coll, idKey(1), RecordId(1), doc(1)));
+        ASSERT_TRUE(cache.insert(coll, idKey(1), RecordId(1), doc(1, 20)));
+        ASSERT_EQUALS(1U, cache.numEntries());
+
+        // A different document now stored at the same RecordId
+        ASSERT_TRUE(cache.insert(coll, idKey(2), RecordId(1), doc(2)));
+        ASSERT_EQUALS(1U, cache.numEntries());
+
+        RecordId loc;
+        BSONObj obj;
+        ASSERT_FALSE(cache.find(coll, idKey(1), &loc, &obj));
+    }
+
+    TEST(DocumentCache, StaysWithinBudget) {
+        const long long budget = 16 * 1024;
+        DocumentCache cache(budget);
+        const Collection* coll = fakeCollection(0);
+
+        // Too large to cache at all
+        ASSERT_FALSE(cache.insert(coll, idKey(0), RecordId(1), doc(0, budget)));
+
+        for (int i = 0; i < 1000; i++) {
+            RecordId loc;
+            BSONObj obj;
+            // make every key more frequent than anything already cached
+            for (int j = 0; j < 3; j++) {
+                cache.find(coll, idKey(i), &loc, &obj);
+            }
+            cache.insert(coll, idKey(i), RecordId(i + 1), doc(i, 100));
+            ASSERT_LESS_THAN_OR_EQUALS(cache.bytesUsed(), budget);
+        }
+        ASSERT_GREATER_THAN(cache.numEntries(), 0U);
+    }
+
+    TEST(DocumentCache, AdmissionPrefersFrequentKeys) {
+        // Room for three documents
+        DocumentCache cache(1024);
+        const Collection* coll = fakeCollection(0);
+        RecordId loc;
+        BSONObj obj;
+
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 5; j++) {
+                cache.find(coll, idKey(i), &loc, &obj);
+            }
+            ASSERT_TRUE(cache.insert(coll, idKey(i), RecordId(i + 1), doc(i, 100)));
+        }
+        const size_t hotEntries = cache.numEntries();
+
+        // A key seen once doesn't push out the hot ones
+        cache.find(coll, idKey(100), &loc, &obj);
+        ASSERT_FALSE(cache.insert(coll, idKey(100), RecordId(101), doc(100, 100)));
+        ASSERT_EQUALS(hotEntries, cache.numEntries());
+
+        // but one asked for more often than the coldest hot key does
+        for (int j = 0; j < 10; j++) {
+            cache.find(coll, idKey(200), &loc, &obj);
+        }
+        ASSERT_TRUE(cache.insert(coll, idKey(200), RecordId(201), doc(200, 100)));
+        ASSERT_TRUE(cache.find(coll, idKey(200), &loc, &obj));
+    }
+
+}
@@ -34,6 +34,7 @@
 
 #include "mongo/db/catalog/index_catalog.h"
 
+#include <set>
 #include <vector>
 
 #include "mongo/db/audit.h"
@@ -883,6 +884,13 @@ namespace {
         return entry->isMultikey();
     }
 
+    unsigned long long IndexCatalog::getMultikeyPaths( OperationContext* txn,
+                                                       const IndexDescriptor* idx ) {
+        IndexCatalogEntry* entry = _entries.find( idx );
+        invariant( entry );
+        return entry->getMultikeyPaths();
+    }
+
 
     // ---------------------------
 
@@ -1131,6 +1139,26 @@ namespace {
         return Status::OK();
     }
 
+    Status IndexCatalog::indexRecords(OperationContext* txn,
+                                      const std::vector<BSONObj>& objs,
+                                      const std::vector<RecordId>& locs) {
+
+        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+              i != _entries.end();
+              ++i ) {
+            InsertDeleteOptions options;
+            options.logIfError = false;
+            options.dupsAllowed = isDupsAllowed( (*i)->descriptor() );
+
+            int64_t inserted;
+            Status s = (*i)->accessMethod()->insertMany(txn, objs, locs, options, &inserted);
+            if (!s.isOK())
+                return s;
+        }
+
+        return Status::OK();
+    }
+
     void IndexCatalog::unindexRecord(OperationContext* txn,
                                      const BSONObj& obj,
                                      const RecordId& loc,
@@ -1210,13 +1238,12 @@ namespace {
 
     std::vector<BSONObj>
     IndexCatalog::killMatchingIndexBuilds(const IndexCatalog::IndexKillCriteria& criteria) {
-        std::vector<BSONObj> indexes;
+        std::set<unsigned int> opsToKill;
         for (InProgressIndexesMap::iterator it = _inProgressIndexes.begin();
              it != _inProgressIndexes.end();
              it++) {
             // check criteria
             IndexDescriptor* desc = it->first;
-            unsigned int opNum = it->second;
             if (!criteria.ns.empty() && (desc->parentNS() != criteria.ns)) {
                 continue;
             }
@@ -1226,14 +1253,29 @@ namespace {
             if (!criteria.key.isEmpty() && (desc->keyPattern() != criteria.key)) {
                 continue;
             }
-            indexes.push_back(desc->keyPattern().getOwned());
-            log() << "halting index build: " << desc->keyPattern();
+            opsToKill.insert(it->second);
+        }
+
+        // One operation may be building several indexes, which are all halted with it.
+        std::vector<BSONObj> indexes;
+        for (InProgressIndexesMap::iterator it = _inProgressIndexes.begin();
+             it != _inProgressIndexes.end();
+             it++) {
+            if (opsToKill.count(it->second)) {
+                indexes.push_back(it->first->keyPattern().getOwned());
+                log() << "halting index build: " << it->first->keyPattern();
+            }
+        }
+
+        for (std::set<unsigned int>::const_iterator it = opsToKill.begin();
+             it != opsToKill.end();
+             it++) {
             // Note that we can only be here if the background index build in question is
             // yielding. The bg index code is set up specially to check for interrupt
             // immediately after it recovers from yield, such that no further work is done
             // on the index build. Thus this thread does not have to synchronize with the
             // bg index operation; we can just assume that it is safe to proceed.
-            getGlobalEnvironment()->killOperation(opNum);
+            getGlobalEnvironment()->killOperation(*it);
         }
 
         if (indexes.size() > 0) {
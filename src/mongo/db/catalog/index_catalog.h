@@ -230,6 +230,9 @@ namespace mongo {
 
         bool isMultikey( OperationContext* txn, const IndexDescriptor* idex );
 
+        // See IndexCatalogEntry::getMultikeyPaths()
+        unsigned long long getMultikeyPaths( OperationContext* txn, const IndexDescriptor* idex );
+
         // --- these probably become private?
 
 
@@ -289,6 +292,14 @@ namespace mongo {
         // this throws for now
         Status indexRecord(OperationContext* txn, const BSONObj& obj, const RecordId &loc);
 
+        /**
+         * Indexes 'objs[i]' at 'locs[i]' for every i, one index at a time with the keys of each
+         * index inserted in order.
+         */
+        Status indexRecords(OperationContext* txn,
+                            const std::vector<BSONObj>& objs,
+                            const std::vector<RecordId>& locs);
+
         void unindexRecord(OperationContext* txn,
                            const BSONObj& obj,
                            const RecordId& loc,
@@ -99,6 +99,7 @@ namespace mongo {
         _isReady = _catalogIsReady( txn );
         _head = _catalogHead( txn );
         _isMultikey = _catalogIsMultikey( txn );
+        _multikeyPaths.store( _isMultikey ? ~0ULL : 0 );
     }
 
     const RecordId& IndexCatalogEntry::head( OperationContext* txn ) const {
@@ -115,6 +116,27 @@ namespace mongo {
         return _isMultikey;
     }
 
+    unsigned long long IndexCatalogEntry::getMultikeyPaths() const {
+        return _multikeyPaths.load();
+    }
+
+    void IndexCatalogEntry::addMultikeyPaths( unsigned long long paths ) {
+        unsigned long long current = _multikeyPaths.load();
+        while ( ( current | paths ) != current ) {
+            const unsigned long long seen = _multikeyPaths.compareAndSwap( current,
+                                                                           current | paths );
+            if ( seen == current ) {
+                if ( _infoCache ) {
+                    LOG(1) << _ns << ": clearing plan cache - index "
+                           << _descriptor->keyPattern() << " has new multikey paths.";
+                    _infoCache->clearQueryCache();
+                }
+                return;
+            }
+            current = seen;
+        }
+    }
+
     // ---
 
     void IndexCatalogEntry::setIsReady( bool newIsReady ) {
@@ -35,6 +35,7 @@
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/ordering.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -84,6 +85,19 @@ namespace mongo {
 
         void setMultikey( OperationContext* txn );
 
+        /**
+         * Returns a bit per key pattern field, set if an indexed document holds an array on the
+         * path to that field. Only tracked in memory: if the index was already multikey when it
+         * was loaded, every bit is set.
+         */
+        unsigned long long getMultikeyPaths() const;
+
+        /**
+         * Records that indexed documents hold arrays on the paths to the given fields, and drops
+         * the cached plans which may have relied on them not doing so.
+         */
+        void addMultikeyPaths( unsigned long long paths );
+
         // if this ready is ready for queries
         bool isReady( OperationContext* txn ) const;
 
@@ -117,6 +131,7 @@ namespace mongo {
         bool _isReady; // cache of NamespaceDetails info
         RecordId _head; // cache of IndexDetails
         bool _isMultikey; // cache of NamespaceDetails info
+        AtomicUInt64 _multikeyPaths; // see getMultikeyPaths()
     };
 
     class IndexCatalogEntryContainer {
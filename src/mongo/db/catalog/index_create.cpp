@@ -48,6 +48,8 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
@@ -58,6 +60,64 @@ namespace mongo {
     using std::string;
     using std::endl;
 
+    // Build non-unique background indexes through the external sorter, recording concurrent
+    // writes to the index on the side until the sorted keys have been loaded.
+    MONGO_EXPORT_SERVER_PARAMETER(useBulkForBackgroundIndexBuilds, bool, true);
+
+namespace {
+    // Documents read by the collection scan, waiting to be added to the external sorters
+    struct DocumentBatch {
+        DocumentBatch() : bytes(0) { }
+
+        void add(const BSONObj& doc, const RecordId& loc) {
+            docs.push_back(doc.getOwned());
+            locs.push_back(loc);
+            bytes += doc.objsize();
+        }
+
+        bool full() const { return docs.size() >= 1000 || bytes >= 16 * 1024 * 1024; }
+
+        std::vector<BSONObj> docs;
+        std::vector<RecordId> locs;
+        size_t bytes;
+    };
+
+    void feedSorter(OperationContext* txn,
+                    IndexAccessMethod* bulk,
+                    const InsertDeleteOptions* options,
+                    const DocumentBatch* batch,
+                    Status* status) {
+        try {
+            int64_t unused;
+            *status = bulk->insertMany(txn, batch->docs, batch->locs, *options, &unused);
+        }
+        catch (const DBException& e) {
+            *status = e.toStatus();
+        }
+    }
+
+    // Adds 'batch' to every sorter in 'bulks', each on a thread of 'pool', and empties it.
+    Status feedSorters(OperationContext* txn,
+                       ThreadPool* pool,
+                       const std::vector<IndexAccessMethod*>& bulks,
+                       const std::vector<const InsertDeleteOptions*>& options,
+                       DocumentBatch* batch) {
+        std::vector<Status> statuses(bulks.size(), Status::OK());
+        for (size_t i = 0; i < bulks.size(); i++) {
+            pool->schedule(feedSorter, txn, bulks[i], options[i], batch, &statuses[i]);
+        }
+        pool->join();
+
+        *batch = DocumentBatch();
+        for (size_t i = 0; i < statuses.size(); i++) {
+            if (!statuses[i].isOK()) {
+                return statuses[i];
+            }
+        }
+        return Status::OK();
+    }
+} // namespace
+
     /**
      * On rollback sets MultiIndexBlock::_needToCleanup to true.
      */
@@ -161,12 +221,6 @@ namespace mongo {
             if ( !status.isOK() )
                 return status;
 
-            if (!_buildInBackground) {
-                // Bulk build process requires foreground building as it assumes nothing is changing
-                // under it.
-                index.bulk.reset(index.real->initiateBulk(_txn));
-            }
-
             const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
 
             index.options.logIfError = false; // logging happens elsewhere if needed.
@@ -175,6 +229,23 @@ namespace mongo {
                                      || repl::getGlobalReplicationCoordinator()
                                                     ->shouldIgnoreUniqueIndex(descriptor);
 
+            if (!_buildInBackground) {
+                // Bulk build process requires foreground building as it assumes nothing is changing
+                // under it.
+                index.bulk.reset(index.real->initiateBulk(_txn));
+            }
+            else if (useBulkForBackgroundIndexBuilds && !descriptor->unique()) {
+                // Writes made while the collection scan yields are applied after the bulk
+                // commit.  Unique indexes are left out, as a document moved ahead of the scan
+                // would be sorted twice and fail the build with a duplicate key.
+                index.bulk.reset(index.real->initiateBulk(_txn));
+                if (index.bulk) {
+                    status = index.real->startSideWrites();
+                    if ( !status.isOK() )
+                        return status;
+                }
+            }
+
             log() << "build index on: " << ns << " properties: " << descriptor->toString();
             if (index.bulk)
                 log() << "\t building index using bulk method";
@@ -196,18 +267,24 @@ namespace mongo {
         return Status::OK();
     }
 
-    IndexDescriptor* MultiIndexBlock::registerIndexBuild() {
+    std::vector<IndexDescriptor*> MultiIndexBlock::registerIndexBuild() {
         // Register background index build so that it can be found and killed when necessary
         invariant(_collection);
-        invariant(_indexes.size() == 1);
         invariant(_buildInBackground);
-        IndexDescriptor* descriptor = _indexes[0].block->getEntry()->descriptor();
-        _collection->getIndexCatalog()->registerIndexBuild(descriptor, _txn->getCurOp()->opNum());
-        return descriptor;
+        std::vector<IndexDescriptor*> descriptors;
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            IndexDescriptor* descriptor = _indexes[i].block->getEntry()->descriptor();
+            _collection->getIndexCatalog()->registerIndexBuild(descriptor,
+                                                               _txn->getCurOp()->opNum());
+            descriptors.push_back(descriptor);
+        }
+        return descriptors;
     }
 
-    void MultiIndexBlock::unregisterIndexBuild(IndexDescriptor* descriptor) {
-        _collection->getIndexCatalog()->unregisterIndexBuild(descriptor);
+    void MultiIndexBlock::unregisterIndexBuild(const std::vector<IndexDescriptor*>& descriptors) {
+        for (size_t i = 0; i < descriptors.size(); i++) {
+            _collection->getIndexCatalog()->unregisterIndexBuild(descriptors[i]);
+        }
     }
 
     Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsOut) {
@@ -228,6 +305,22 @@ namespace mongo {
             exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
         }
 
+        // With several indexes loaded through the external sorter, each sorter is fed on a
+        // thread of its own, a batch of documents at a time.
+        std::vector<IndexAccessMethod*> bulks;
+        std::vector<const InsertDeleteOptions*> bulkOptions;
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            if (_indexes[i].bulk) {
+                bulks.push_back(_indexes[i].bulk.get());
+                bulkOptions.push_back(&_indexes[i].options);
+            }
+        }
+        scoped_ptr<ThreadPool> sorterThreads;
+        if (bulks.size() > 1) {
+            sorterThreads.reset(new ThreadPool(bulks.size(), "index build sorter "));
+        }
+        DocumentBatch batch;
+
         BSONObj objToIndex;
         RecordId loc;
         PlanExecutor::ExecState state;
@@ -238,7 +331,7 @@ namespace mongo {
 
                 bool shouldCommitWUnit = true;
                 WriteUnitOfWork wunit(_txn);
-                Status ret = insert(objToIndex, loc);
+                Status ret = _insert(objToIndex, loc, !sorterThreads);
                 if (!ret.isOK()) {
                     if (dupsOut && ret.code() == ErrorCodes::DuplicateKey) {
                         // If dupsOut is non-null, we should only fail the specific insert that
@@ -251,8 +344,17 @@ namespace mongo {
                     }
                 }
 
-                if (shouldCommitWUnit)
+                if (shouldCommitWUnit) {
                     wunit.commit();
+                    if (sorterThreads)
+                        batch.add(objToIndex, loc);
+                }
+            }
+
+            if (batch.full()) {
+                Status ret = feedSorters(_txn, sorterThreads.get(), bulks, bulkOptions, &batch);
+                if (!ret.isOK())
+                    return ret;
             }
 
             n++;
@@ -266,6 +368,12 @@ namespace mongo {
                       "Unable to complete index build as the collection is no longer readable");
         }
 
+        if (!batch.docs.empty()) {
+            Status ret = feedSorters(_txn, sorterThreads.get(), bulks, bulkOptions, &batch);
+            if (!ret.isOK())
+                return ret;
+        }
+
         progress->finished();
 
         Status ret = doneInserting(dupsOut);
@@ -279,7 +387,13 @@ namespace mongo {
     }
 
     Status MultiIndexBlock::insert(const BSONObj& doc, const RecordId& loc) {
+        return _insert(doc, loc, true);
+    }
+
+    Status MultiIndexBlock::_insert(const BSONObj& doc, const RecordId& loc, bool includeBulk) {
         for ( size_t i = 0; i < _indexes.size(); i++ ) {
+            if ( _indexes[i].bulk && !includeBulk )
+                continue;
             int64_t unused;
             Status idxStatus = _indexes[i].forInsert()->insert( _txn,
                                                                doc,
@@ -305,6 +419,13 @@ namespace mongo {
             if ( !status.isOK() ) {
                 return status;
             }
+
+            if (_buildInBackground) {
+                status = _indexes[i].real->drainSideWrites(_txn);
+                if ( !status.isOK() ) {
+                    return status;
+                }
+            }
         }
 
         return Status::OK();
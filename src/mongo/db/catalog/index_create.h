@@ -115,17 +115,16 @@ namespace mongo {
          * Manages in-progress background index builds.
          * Call registerIndexBuild() after calling init() to record this build in the catalog's 
          * in-progress map.
-         * The build must be a background build and it must be a single index build (the size of
-         * _indexes must be 1).
-         * registerIndexBuild() returns the descriptor for the index build. You must subsequently
-         * call unregisterIndexBuild() with that same descriptor before this MultiIndexBlock goes
-         * out of scope.
+         * The build must be a background build.
+         * registerIndexBuild() returns the descriptors of the indexes being built. You must
+         * subsequently call unregisterIndexBuild() with those same descriptors before this
+         * MultiIndexBlock goes out of scope.
          * These functions are only intended to be used by the replication system. No internal
          * concurrency control is performed; it is expected that the code has already taken steps
          * to ensure calls to these functions are serialized, for a particular IndexCatalog.
          */
-        IndexDescriptor* registerIndexBuild();
-        void unregisterIndexBuild(IndexDescriptor* descriptor);
+        std::vector<IndexDescriptor*> registerIndexBuild();
+        void unregisterIndexBuild(const std::vector<IndexDescriptor*>& descriptors);
 
         /**
          * Inserts all documents in the Collection into the indexes and logs with timing info.
@@ -198,6 +197,10 @@ namespace mongo {
     private:
         class SetNeedToCleanupOnRollback;
 
+        // Like insert(), but leaves out the indexes loaded through the external sorter unless
+        // 'includeBulk' is set.
+        Status _insert(const BSONObj& wholeDocument, const RecordId& loc, bool includeBulk);
+
         struct IndexToBuild {
             IndexToBuild() : real(NULL) {}
 
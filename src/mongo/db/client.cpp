@@ -517,6 +517,14 @@ namespace {
         }
 
         s << " numYields:" << curop.numYields();
+        if ( curop.yieldMicros() > 0 )
+            s << " yieldMicros:" << curop.yieldMicros();
+        if ( curop.storageBytesRead() > 0 )
+            s << " storageBytesRead:" << curop.storageBytesRead();
+        if ( curop.storageBytesWritten() > 0 )
+            s << " storageBytesWritten:" << curop.storageBytesWritten();
+        if ( curop.cpuMicros() >= 0 )
+            s << " cpuMicros:" << curop.cpuMicros();
         
         OPDEBUG_TOSTRING_HELP( nreturned );
         if ( responseLength > 0 )
@@ -604,6 +612,12 @@ namespace {
         OPDEBUG_APPEND_NUMBER( writeConflicts );
 
         b.appendNumber("numYield", curop.numYields());
+        b.appendNumber("yieldMicros", curop.yieldMicros());
+        b.appendNumber("storageBytesRead", curop.storageBytesRead());
+        b.appendNumber("storageBytesWritten", curop.storageBytesWritten());
+        if (curop.cpuMicros() >= 0) {
+            b.appendNumber("cpuMicros", curop.cpuMicros());
+        }
 
         if ( ! exceptionInfo.empty() )
             exceptionInfo.append( b , "exception" , "exceptionCode" );
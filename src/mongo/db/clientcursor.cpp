@@ -114,6 +114,10 @@ namespace mongo {
         _leftoverMaxTimeMicros = 0;
         _pos = 0;
 
+        _prefetchedBytes = 0;
+        _prefetchEnded = false;
+        _prefetchEndState = PlanExecutor::ADVANCED;
+
         if (_queryOptions & QueryOption_NoCursorTimeout) {
             // cursors normally timeout after an inactivity period to prevent excess memory use
             // setting this prevents timeout of the cursor in question.
@@ -217,6 +221,36 @@ namespace mongo {
         return _ownedRU.release();
     }
 
+    void ClientCursor::stashPrefetched(const BSONObj& obj) {
+        dassert(obj.isOwned());
+        invariant(!_prefetchEnded);
+        _prefetched.push_back(obj);
+        _prefetchedBytes += obj.objsize();
+    }
+
+    void ClientCursor::setPrefetchEnd(PlanExecutor::ExecState state, const BSONObj& obj) {
+        invariant(PlanExecutor::ADVANCED != state);
+        _prefetchEnded = true;
+        _prefetchEndState = state;
+        _prefetchEndObj = obj.getOwned();
+    }
+
+    bool ClientCursor::nextPrefetched(PlanExecutor::ExecState* state, BSONObj* obj) {
+        if (!_prefetched.empty()) {
+            *obj = _prefetched.front();
+            _prefetched.pop_front();
+            _prefetchedBytes -= obj->objsize();
+            *state = PlanExecutor::ADVANCED;
+            return true;
+        }
+        if (_prefetchEnded) {
+            *obj = _prefetchEndObj;
+            *state = _prefetchEndState;
+            return true;
+        }
+        return false;
+    }
+
     //
     // Pin methods
     //
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <deque>
 #include <boost/noncopyable.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread/recursive_mutex.hpp>
@@ -202,6 +203,33 @@ namespace mongo {
          */
         RecoveryUnit* releaseOwnedRecoveryUnit();
 
+        //
+        // Results produced after a getMore replied and before the next getMore arrived.  See
+        // prefetchGetMore in db/query/find.h.
+        //
+
+        /**
+         * Appends 'obj', which must be owned, to the results for the next getMore.
+         */
+        void stashPrefetched(const BSONObj& obj);
+
+        /**
+         * Records that the executor returned 'state', which is not ADVANCED, while prefetching.
+         * No more results are prefetched; the next getMore sees 'state' and 'obj' once it has
+         * returned the stashed results.
+         */
+        void setPrefetchEnd(PlanExecutor::ExecState state, const BSONObj& obj);
+
+        /**
+         * Takes the next prefetched result, or the state the prefetch ended in once those are
+         * used up.  Returns false if the executor should be asked instead.
+         */
+        bool nextPrefetched(PlanExecutor::ExecState* state, BSONObj* obj);
+
+        size_t prefetchedBytes() const { return _prefetchedBytes; }
+
+        bool prefetchEnded() const { return _prefetchEnded; }
+
     private:
         friend class CursorManager;
         friend class ClientCursorPin;
@@ -272,6 +300,14 @@ namespace mongo {
         // is coming from (or a vestige of) an ongoing migration.
         CollectionMetadataPtr _collMetadata;
 
+        // Owned results for the next getMore, the bytes they take, and whether the executor
+        // stopped advancing while producing them.
+        std::deque<BSONObj> _prefetched;
+        size_t _prefetchedBytes;
+        bool _prefetchEnded;
+        PlanExecutor::ExecState _prefetchEndState;
+        BSONObj _prefetchEndObj;
+
         // Only one of these is not-NULL.
         RecoveryUnit* _unownedRU;
         std::auto_ptr<RecoveryUnit> _ownedRU;
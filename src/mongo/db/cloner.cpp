@@ -34,31 +34,42 @@
 
 #include "mongo/db/cloner.h"
 
+#include <algorithm>
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <map>
 
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/copydb.h"
 #include "mongo/db/commands/rename_collection.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/index_builder.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
 #include "mongo/db/repl/isself.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -72,6 +83,153 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(skipCorruptDocumentsWhenCloning, bool, false);
 
+namespace {
+
+    /**
+     * Documents and bytes copied so far for each collection being cloned into this process,
+     * reported in the "cloner" serverStatus section.  A collection read through several cursors
+     * counts as done once every one of them has been drained.  The entries for a database are
+     * dropped when the next clone of that database starts.
+     */
+    class CloneProgress {
+    public:
+        void beginDatabase(const string& dbName) {
+            boost::mutex::scoped_lock lk(_mutex);
+            const string prefix = dbName + '.';
+            Map::iterator it = _collections.lower_bound(prefix);
+            while (it != _collections.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+                _collections.erase(it++);
+            }
+        }
+
+        void beginCollection(const NamespaceString& ns, int parts) {
+            boost::mutex::scoped_lock lk(_mutex);
+            Entry& entry = _collections[ns.ns()];
+            entry = Entry();
+            entry.parts = parts;
+            entry.startMillis = entry.lastMillis = curTimeMillis64();
+        }
+
+        void addBatch(const NamespaceString& ns,
+                      long long docs,
+                      long long bytes,
+                      long long duplicates) {
+            boost::mutex::scoped_lock lk(_mutex);
+            Map::iterator it = _collections.find(ns.ns());
+            if (it == _collections.end())
+                return;
+            it->second.docs += docs;
+            it->second.bytes += bytes;
+            it->second.duplicates += duplicates;
+            it->second.lastMillis = curTimeMillis64();
+        }
+
+        void endPart(const NamespaceString& ns) {
+            Entry done;
+            {
+                boost::mutex::scoped_lock lk(_mutex);
+                Map::iterator it = _collections.find(ns.ns());
+                if (it == _collections.end())
+                    return;
+                it->second.lastMillis = curTimeMillis64();
+                if (++it->second.partsDone < it->second.parts)
+                    return;
+                done = it->second;
+            }
+
+            const long long millis = done.lastMillis - done.startMillis;
+            log() << "cloned " << ns << ": " << done.docs << " documents, " << done.bytes
+                  << " bytes in " << millis << "ms ("
+                  << (done.bytes * 1000 / std::max(millis, 1LL)) / (1024 * 1024) << " MB/s), "
+                  << done.duplicates << " duplicate _ids skipped";
+        }
+
+        BSONObj toBSON() const {
+            boost::mutex::scoped_lock lk(_mutex);
+            BSONObjBuilder b;
+            for (Map::const_iterator it = _collections.begin(); it != _collections.end(); ++it) {
+                const Entry& entry = it->second;
+                const long long millis = std::max(entry.lastMillis - entry.startMillis, 1LL);
+
+                BSONObjBuilder coll(b.subobjStart(it->first));
+                coll.appendNumber("documents", entry.docs);
+                coll.appendNumber("bytes", entry.bytes);
+                coll.appendNumber("duplicatesSkipped", entry.duplicates);
+                coll.append("parts", entry.parts);
+                coll.append("partsDone", entry.partsDone);
+                coll.append("done", entry.partsDone >= entry.parts);
+                coll.appendNumber("elapsedMillis", entry.lastMillis - entry.startMillis);
+                coll.appendNumber("documentsPerSec", entry.docs * 1000 / millis);
+                coll.appendNumber("bytesPerSec", entry.bytes * 1000 / millis);
+                coll.done();
+            }
+            return b.obj();
+        }
+
+    private:
+        struct Entry {
+            Entry() : docs(0), bytes(0), duplicates(0), parts(0), partsDone(0),
+                      startMillis(0), lastMillis(0) {}
+
+            long long docs;
+            long long bytes;
+            long long duplicates;
+            int parts;
+            int partsDone;
+            long long startMillis;
+            long long lastMillis;
+        };
+        typedef std::map<string, Entry> Map;
+
+        mutable boost::mutex _mutex;
+        Map _collections;
+    };
+
+    CloneProgress cloneProgress;
+
+    class ClonerServerStatusSection : public ServerStatusSection {
+    public:
+        ClonerServerStatusSection() : ServerStatusSection("cloner") {}
+
+        virtual bool includeByDefault() const { return true; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            return cloneProgress.toBSON();
+        }
+    } clonerServerStatusSection;
+
+    /**
+     * The locks Cloner::Fun holds while it inserts a batch.  A clone which is the only writer
+     * takes the global write lock; one of several concurrent clones takes intent locks on the
+     * database and the collection, so clones of different collections don't wait on each other.
+     */
+    class CloneBatchLock {
+        MONGO_DISALLOW_COPYING(CloneBatchLock);
+    public:
+        CloneBatchLock(OperationContext* txn, const NamespaceString& ns, bool concurrent) {
+            if (concurrent) {
+                _transaction.reset(new ScopedTransaction(txn, MODE_IX));
+                _dbLock.reset(new Lock::DBLock(txn->lockState(), ns.db(), MODE_IX));
+                _collectionLock.reset(new Lock::CollectionLock(txn->lockState(), ns.ns(),
+                                                               MODE_IX));
+            }
+            else {
+                _transaction.reset(new ScopedTransaction(txn, MODE_X));
+                _globalWrite.reset(new Lock::GlobalWrite(txn->lockState()));
+            }
+        }
+
+    private:
+        // Declared in acquisition order so that they are released in reverse.
+        scoped_ptr<ScopedTransaction> _transaction;
+        scoped_ptr<Lock::GlobalWrite> _globalWrite;
+        scoped_ptr<Lock::DBLock> _dbLock;
+        scoped_ptr<Lock::CollectionLock> _collectionLock;
+    };
+
+}  // namespace
+
     BSONElement getErrField(const BSONObj& o);
 
     /* for index info object:
@@ -109,6 +267,29 @@ namespace mongo {
         return res;
     }
 
+    Status parseCloneCommandOptions(const BSONObj& cmdObj, CloneOptions* opts) {
+        const BSONElement parallel = cmdObj["parallelCollections"];
+        if (!parallel.eoo()) {
+            if (!parallel.isNumber() || parallel.numberInt() < 1 || parallel.numberInt() > 64) {
+                return Status(ErrorCodes::BadValue,
+                              "parallelCollections must be a number between 1 and 64");
+            }
+            opts->parallelCollections = parallel.numberInt();
+        }
+
+        const BSONElement splitMB = cmdObj["splitCollectionMinMB"];
+        if (!splitMB.eoo()) {
+            if (!splitMB.isNumber() || splitMB.numberLong() < 0) {
+                return Status(ErrorCodes::BadValue,
+                              "splitCollectionMinMB must be a non-negative number");
+            }
+            opts->splitCollectionMinBytes = splitMB.numberLong() * 1024 * 1024;
+        }
+
+        opts->resume = cmdObj["resume"].trueValue();
+        return Status::OK();
+    }
+
     Cloner::Cloner() { }
 
     struct Cloner::Fun {
@@ -121,17 +302,43 @@ namespace mongo {
         void operator()( DBClientCursorBatchIterator &i ) {
             invariant(from_collection.coll() != "system.indexes");
 
-            // XXX: can probably take dblock instead
-            scoped_ptr<ScopedTransaction> scopedXact(new ScopedTransaction(txn, MODE_X));
-            scoped_ptr<Lock::GlobalWrite> globalWriteLock(new Lock::GlobalWrite(txn->lockState()));
+            scoped_ptr<CloneBatchLock> batchLock(
+                new CloneBatchLock(txn, to_collection, _concurrent));
 
-            // Make sure database still exists after we resume from the temp release
-            Database* db = dbHolder().openDb(txn, _dbName);
+            long long batchDocs = 0;
+            long long batchBytes = 0;
+            long long batchDuplicates = 0;
 
-            bool createdCollection = false;
+            Database* db = NULL;
             Collection* collection = NULL;
 
-            collection = db->getCollection( to_collection );
+            if (_concurrent) {
+                // The collection was created before the concurrent clones started, and only the
+                // database intent lock is held here so it cannot be created now.
+                db = dbHolder().get(txn, _dbName);
+                uassert(28615,
+                        str::stream() << "Database " << _dbName << " dropped while cloning",
+                        db != NULL);
+                collection = db->getCollection(to_collection);
+                uassert(28616,
+                        str::stream() << "Collection " << to_collection.ns()
+                                      << " dropped while cloning",
+                        collection != NULL);
+                if (logForRepl) {
+                    uassert(28642,
+                            str::stream() << "Cannot write to db: " << _dbName,
+                            repl::getGlobalReplicationCoordinator()->
+                                canAcceptWritesForDatabase(_dbName));
+                }
+            }
+            else {
+                // Make sure database still exists after we resume from the temp release
+                db = dbHolder().openDb(txn, _dbName);
+                collection = db->getCollection( to_collection );
+            }
+
+            bool createdCollection = false;
+
             if ( !collection ) {
                 massert( 17321,
                          str::stream()
@@ -151,8 +358,13 @@ namespace mongo {
                 wunit.commit();
             }
 
+            // Documents read since the last flush, inserted together through the bulk path.
+            vector<BSONObj> pending;
+
             while( i.moreInCurrentBatch() ) {
                 if ( numSeen % 128 == 127 ) {
+                    _flush(collection, &pending, &batchDocs, &batchBytes, &batchDuplicates);
+
                     time_t now = time(0);
                     if( now - lastLog >= 60 ) {
                         // report progress
@@ -166,13 +378,11 @@ namespace mongo {
                     }
 
                     if (_mayYield) {
-                        scopedXact.reset();
-                        globalWriteLock.reset();
+                        batchLock.reset();
 
                         txn->getCurOp()->yielded();
 
-                        scopedXact.reset(new ScopedTransaction(txn, MODE_X));
-                        globalWriteLock.reset(new Lock::GlobalWrite(txn->lockState()));
+                        batchLock.reset(new CloneBatchLock(txn, to_collection, _concurrent));
 
                         // Check if everything is still all right.
                         if (logForRepl) {
@@ -214,11 +424,63 @@ namespace mongo {
                 }
 
                 ++numSeen;
+                pending.push_back(tmp);
+
+                RARELY if ( time( 0 ) - saveLast > 60 ) {
+                    log() << numSeen << " objects cloned so far from collection " << from_collection;
+                    saveLast = time( 0 );
+                }
+            }
+
+            _flush(collection, &pending, &batchDocs, &batchBytes, &batchDuplicates);
+
+            cloneProgress.addBatch(to_collection, batchDocs, batchBytes, batchDuplicates);
+        }
+
+        /**
+         * Inserts 'docs' into 'collection' and clears it.  A batch goes in through the bulk
+         * insertDocuments() path in one unit of work; if that fails, or the collection is capped,
+         * the documents are inserted one at a time so that a duplicate _id only skips its own
+         * document.
+         */
+        void _flush(Collection* collection,
+                    vector<BSONObj>* docs,
+                    long long* batchDocs,
+                    long long* batchBytes,
+                    long long* batchDuplicates) {
+            if (docs->empty())
+                return;
+
+            if (docs->size() > 1 && !collection->isCapped()) {
                 WriteUnitOfWork wunit(txn);
+                if (collection->insertDocuments(txn, *docs, true).isOK()) {
+                    if (logForRepl)
+                        repl::logInsertOps(txn, to_collection.ns().c_str(), *docs);
+                    wunit.commit();
 
-                BSONObj js = tmp;
+                    for (size_t j = 0; j < docs->size(); j++) {
+                        *batchBytes += (*docs)[j].objsize();
+                    }
+                    *batchDocs += docs->size();
+                    docs->clear();
+                    return;
+                }
+                // The unit of work rolls back; retry one at a time to find the bad document.
+            }
+
+            for (size_t j = 0; j < docs->size(); j++) {
+                WriteUnitOfWork wunit(txn);
+
+                const BSONObj& js = (*docs)[j];
 
                 StatusWith<RecordId> loc = collection->insertDocument( txn, js, true );
+                if (_concurrent && loc.getStatus().code() == ErrorCodes::DuplicateKey) {
+                    // Concurrent clones insert with the _id index in place.  The source is not
+                    // read from a snapshot, so a document it moved may be seen twice; keep the
+                    // first copy, the oplog applied afterwards brings it up to date.
+                    ++*batchDuplicates;
+                    continue;
+                }
                 if ( !loc.isOK() ) {
                     error() << "error: exception cloning object in " << from_collection
                             << ' ' << loc.toString() << " obj:" << js;
@@ -228,12 +490,10 @@ namespace mongo {
                     repl::logOp(txn, "i", to_collection.ns().c_str(), js);
 
                 wunit.commit();
-
-                RARELY if ( time( 0 ) - saveLast > 60 ) {
-                    log() << numSeen << " objects cloned so far from collection " << from_collection;
-                    saveLast = time( 0 );
-                }
+                ++*batchDocs;
+                *batchBytes += js.objsize();
             }
+            docs->clear();
         }
 
         time_t lastLog;
@@ -247,6 +507,7 @@ namespace mongo {
         bool logForRepl;
         bool _mayYield;
         bool _mayBeInterrupted;
+        bool _concurrent;
     };
 
     /* copy the specified collection
@@ -260,6 +521,8 @@ namespace mongo {
                       bool slaveOk,
                       bool mayYield,
                       bool mayBeInterrupted,
+                      bool concurrent,
+                      long long cursorId,
                       Query query) {
         LOG(2) << "\t\tcloning collection " << from_collection << " to " << to_collection << " on " << _conn->getServerAddress() << " with filter " << query.toString() << endl;
 
@@ -271,12 +534,23 @@ namespace mongo {
         f.logForRepl = logForRepl;
         f._mayYield = mayYield;
         f._mayBeInterrupted = mayBeInterrupted;
+        f._concurrent = concurrent;
 
         int options = QueryOption_NoCursorTimeout | ( slaveOk ? QueryOption_SlaveOk : 0 );
         {
             Lock::TempRelease tempRelease(txn->lockState());
-            _conn->query(stdx::function<void(DBClientCursorBatchIterator &)>(f), from_collection,
-                         query, 0, options);
+            if (cursorId) {
+                // One of the cursors a parallelCollectionScan opened on the source
+                DBClientCursor cursor(_conn.get(), from_collection.ns(), cursorId, 0, options);
+                while (cursor.more()) {
+                    DBClientCursorBatchIterator i(cursor);
+                    f(i);
+                }
+            }
+            else {
+                _conn->query(stdx::function<void(DBClientCursorBatchIterator &)>(f),
+                             from_collection, query, 0, options);
+            }
         }
     }
 
@@ -390,7 +664,7 @@ namespace mongo {
         // main data
         copy(txn, dbname,
              nss, nss,
-             logForRepl, false, true, mayYield, mayBeInterrupted,
+             logForRepl, false, true, mayYield, mayBeInterrupted, false, 0,
              Query(query).snapshot());
 
         /* TODO : copyIndexes bool does not seem to be implemented! */
@@ -407,6 +681,227 @@ namespace mongo {
         return true;
     }
 
+    /**
+     * Work shared by the threads cloneInParallel() starts.  Each worker opens its own connection
+     * to the source and takes tasks until there are none left or one of the workers has failed.
+     */
+    struct Cloner::ParallelClone {
+        struct Task {
+            NamespaceString from;
+            NamespaceString to;
+            long long cursorId; // a parallelCollectionScan cursor, or 0 to query the collection
+        };
+
+        ParallelClone(const ConnectionString& cs,
+                      const CloneOptions& opts,
+                      const string& toDBName)
+            : cs(cs),
+              opts(opts),
+              toDBName(toDBName) {
+        }
+
+        bool next(Task* task) {
+            boost::mutex::scoped_lock lk(mutex);
+            if (!errmsg.empty() || tasks.empty())
+                return false;
+            *task = tasks.front();
+            tasks.pop_front();
+            return true;
+        }
+
+        void fail(const string& msg) {
+            boost::mutex::scoped_lock lk(mutex);
+            if (errmsg.empty())
+                errmsg = msg;
+        }
+
+        const ConnectionString cs;
+        const CloneOptions& opts;
+        const string toDBName;
+
+        boost::mutex mutex;
+        std::deque<Task> tasks;
+        string errmsg; // the first failure, empty while all is well
+    };
+
+    void Cloner::parallelCloneWorker(ParallelClone* state) {
+        Client::initThread("clonerWorker");
+        cc().getAuthorizationSession()->grantInternalAuthorization();
+
+        try {
+            string errmsg;
+            auto_ptr<DBClientBase> conn(state->cs.connect(errmsg));
+            if (!conn.get()) {
+                state->fail(errmsg);
+            }
+            else if (getGlobalAuthorizationManager()->isAuthEnabled() &&
+                     !authenticateInternalUser(conn.get())) {
+                state->fail("clone worker couldn't authenticate to " + state->cs.toString());
+            }
+            else {
+                Cloner cloner;
+                cloner.setConnection(conn.release());
+                OperationContextImpl txn;
+
+                const CloneOptions& opts = state->opts;
+                ParallelClone::Task task;
+                while (state->next(&task)) {
+                    LOG(1) << "\t\t cloning " << task.from << " -> " << task.to
+                           << (task.cursorId ? " from a parallel scan cursor" : "");
+                    Query q;
+                    if (opts.snapshot && !task.cursorId)
+                        q.snapshot();
+
+                    cloner.copy(&txn,
+                                state->toDBName,
+                                task.from,
+                                task.to,
+                                opts.logForRepl,
+                                false,
+                                opts.slaveOk,
+                                opts.mayYield,
+                                opts.mayBeInterrupted,
+                                true,
+                                task.cursorId,
+                                q);
+                    cloneProgress.endPart(task.to);
+                }
+            }
+        }
+        catch (const DBException& ex) {
+            state->fail(ex.toString());
+        }
+        catch (const std::exception& ex) {
+            state->fail(ex.what());
+        }
+
+        cc().shutdown();
+    }
+
+    bool Cloner::cloneInParallel(OperationContext* txn,
+                                 const string& toDBName,
+                                 const ConnectionString& cs,
+                                 const CloneOptions& opts,
+                                 const list<BSONObj>& toClone,
+                                 string& errmsg) {
+        const int queryOptions = opts.slaveOk ? QueryOption_SlaveOk : 0;
+
+        // Create every collection up front, while the caller's lock is held, so that the workers
+        // only need intent locks.  The _id index is created with the collection and kept up to
+        // date as the documents stream in, rather than built under the database lock after each
+        // collection.
+        Database* db = dbHolder().openDb(txn, toDBName);
+        for (list<BSONObj>::const_iterator i = toClone.begin(); i != toClone.end(); ++i) {
+            const NamespaceString to_name(toDBName, (*i)["name"].valuestr());
+
+            WriteUnitOfWork wunit(txn);
+            Status createStatus = userCreateNS(txn,
+                                               db,
+                                               to_name.ns(),
+                                               i->getObjectField("options"),
+                                               opts.logForRepl,
+                                               true);
+            if ( !createStatus.isOK() ) {
+                errmsg = str::stream() << "failed to create collection \""
+                                       << to_name.ns() << "\": "
+                                       << createStatus.reason();
+                return false;
+            }
+            wunit.commit();
+        }
+
+        ParallelClone state(cs, opts, toDBName);
+        {
+            // The workers take their own locks, which they would otherwise queue behind.
+            Lock::TempRelease tempRelease(txn->lockState());
+            invariant(!txn->lockState()->isLocked());
+
+            // Queue the largest collections first so that none of them is left for a single
+            // worker to copy at the end.
+            vector<std::pair<long long, string> > bySize;
+            for (list<BSONObj>::const_iterator i = toClone.begin(); i != toClone.end(); ++i) {
+                const string name = (*i)["name"].valuestr();
+                BSONObj stats;
+                long long size = 0;
+                if (_conn->runCommand(opts.fromDB, BSON("collStats" << name), stats,
+                                      queryOptions)) {
+                    size = stats["size"].numberLong();
+                }
+                bySize.push_back(std::make_pair(size, name));
+            }
+            std::sort(bySize.rbegin(), bySize.rend());
+
+            for (size_t i = 0; i < bySize.size(); i++) {
+                ParallelClone::Task task;
+                task.from = NamespaceString(opts.fromDB, bySize[i].second);
+                task.to = NamespaceString(toDBName, bySize[i].second);
+                task.cursorId = 0;
+
+                // A large collection is split across the workers by the cursors of a
+                // parallelCollectionScan on the source, where its storage engine can divide it.
+                vector<long long> cursorIds;
+                if (opts.splitCollectionMinBytes > 0 &&
+                        bySize[i].first >= opts.splitCollectionMinBytes) {
+                    BSONObj res;
+                    BSONObj cmd = BSON("parallelCollectionScan" << bySize[i].second
+                                       << "numCursors" << opts.parallelCollections
+                                       << "noCursorTimeout" << true);
+                    if (_conn->runCommand(opts.fromDB, cmd, res, queryOptions) &&
+                            res["cursors"].isABSONObj()) {
+                        BSONObjIterator it(res["cursors"].Obj());
+                        while (it.more()) {
+                            const long long id = it.next().Obj()["cursor"]["id"].numberLong();
+                            if (id)
+                                cursorIds.push_back(id);
+                        }
+                    }
+                    else {
+                        warning() << "couldn't split " << task.from << " for cloning: " << res;
+                    }
+                }
+
+                cloneProgress.beginCollection(task.to,
+                                              std::max(static_cast<int>(cursorIds.size()), 1));
+                if (cursorIds.empty()) {
+                    state.tasks.push_back(task);
+                }
+                for (size_t j = 0; j < cursorIds.size(); j++) {
+                    task.cursorId = cursorIds[j];
+                    state.tasks.push_back(task);
+                }
+            }
+
+            const size_t workers = std::min(static_cast<size_t>(opts.parallelCollections),
+                                            state.tasks.size());
+            log() << "cloning " << toClone.size() << " collections of " << toDBName
+                  << " from " << cs.toString() << " with " << workers << " workers";
+
+            boost::thread_group threads;
+            try {
+                for (size_t i = 0; i < workers; i++) {
+                    threads.create_thread(stdx::bind(&Cloner::parallelCloneWorker, &state));
+                }
+            }
+            catch (const std::exception& ex) {
+                state.fail(str::stream() << "couldn't start clone worker: " << ex.what());
+            }
+            threads.join_all();
+
+            // Cursors asked not to time out stay open on the source until they are killed.
+            for (std::deque<ParallelClone::Task>::const_iterator it = state.tasks.begin();
+                    it != state.tasks.end(); ++it) {
+                if (it->cursorId)
+                    _conn->killCursor(it->cursorId);
+            }
+        }
+
+        if (!state.errmsg.empty()) {
+            errmsg = state.errmsg;
+            return false;
+        }
+        return true;
+    }
+
     bool Cloner::go(OperationContext* txn,
                     const std::string& toDBName,
                     const string& masterHost,
@@ -476,6 +971,9 @@ namespace mongo {
             clonedColls->clear();
         }
 
+        // Documents in each source collection, to tell which ones a resumed clone finished.
+        std::map<string, long long> sourceCounts;
+
         {
             // getCollectionInfos may make a remote call, which may block indefinitely, so release
             // the global lock that we are entering with.
@@ -532,12 +1030,68 @@ namespace mongo {
                     clonedColls->insert(ns.ns());
                 }
 
+                if (opts.resume && opts.syncData) {
+                    sourceCounts[e.valuestr()] =
+                        _conn->count(ns.ns(), BSONObj(), opts.slaveOk ? QueryOption_SlaveOk : 0);
+                }
+
                 toClone.push_back( collection.getOwned() );
             }
         }
 
+        // The collections whose data is copied: all of them, unless a resumed clone has already
+        // finished some.  A partial copy is dropped and copied again from the start.
+        list<BSONObj> toCopy;
         if ( opts.syncData ) {
+            Database* db = opts.resume ? dbHolder().get(txn, toDBName) : NULL;
             for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
+                const string collectionName = (*i)["name"].valuestr();
+                const NamespaceString to_name(toDBName, collectionName);
+
+                Collection* existing = db ? db->getCollection(to_name) : NULL;
+                if (existing) {
+                    const long long docs = existing->numRecords(txn);
+                    if (docs == sourceCounts[collectionName]) {
+                        log() << "resuming clone of " << toDBName << ": keeping " << to_name
+                              << " with " << docs << " documents";
+                        continue;
+                    }
+
+                    log() << "resuming clone of " << toDBName << ": dropping partial copy of "
+                          << to_name << " with " << docs << " of "
+                          << sourceCounts[collectionName] << " documents";
+
+                    WriteUnitOfWork wunit(txn);
+                    Status dropStatus = db->dropCollection(txn, to_name.ns());
+                    if (!dropStatus.isOK()) {
+                        errmsg = str::stream() << "failed to drop partial copy of \""
+                                               << to_name.ns() << "\": "
+                                               << dropStatus.reason();
+                        return false;
+                    }
+                    if (opts.logForRepl) {
+                        repl::logOp(txn,
+                                    "c",
+                                    (toDBName + ".$cmd").c_str(),
+                                    BSON("drop" << to_name.coll()));
+                    }
+                    wunit.commit();
+                }
+
+                toCopy.push_back(*i);
+            }
+
+            cloneProgress.beginDatabase(toDBName);
+        }
+
+        if (opts.syncData && opts.parallelCollections > 1 &&
+                !masterSameProcess && toCopy.size() > 1) {
+            if (!cloneInParallel(txn, toDBName, cs, opts, toCopy, errmsg)) {
+                return false;
+            }
+        }
+        else if ( opts.syncData ) {
+            for ( list<BSONObj>::iterator i=toCopy.begin(); i != toCopy.end(); i++ ) {
                 BSONObj collection = *i;
                 LOG(2) << "  really will clone: " << collection << endl;
                 const char* collectionName = collection["name"].valuestr();
@@ -574,6 +1128,7 @@ namespace mongo {
                 if( opts.snapshot )
                     q.snapshot();
 
+                cloneProgress.beginCollection(to_name, 1);
                 copy(txn,
                      toDBName,
                      from_name,
@@ -583,7 +1138,10 @@ namespace mongo {
                      opts.slaveOk,
                      opts.mayYield,
                      opts.mayBeInterrupted,
+                     false,
+                     0,
                      q);
+                cloneProgress.endPart(to_name);
 
                 // Copy releases the lock, so we need to re-load the database. This should
                 // probably throw if the database has changed in between, but for now preserve
@@ -78,6 +78,8 @@ namespace mongo {
                   bool slaveOk,
                   bool mayYield,
                   bool mayBeInterrupted,
+                  bool concurrent,
+                  long long cursorId,
                   Query q);
 
         void copyIndexes(OperationContext* txn,
@@ -90,7 +92,17 @@ namespace mongo {
                          bool mayYield,
                          bool mayBeInterrupted);
 
+        bool cloneInParallel(OperationContext* txn,
+                             const std::string& toDBName,
+                             const ConnectionString& cs,
+                             const CloneOptions& opts,
+                             const std::list<BSONObj>& toClone,
+                             std::string& errmsg);
+
         struct Fun;
+        struct ParallelClone;
+        static void parallelCloneWorker(ParallelClone* state);
+
         std::auto_ptr<DBClientBase> _conn;
     };
 
@@ -100,6 +112,13 @@ namespace mongo {
      *  snapshot    - use $snapshot mode for copying collections.  note this should not be used
      *                when it isn't required, as it will be slower.  for example,
      *                repairDatabase need not use it.
+     *  parallelCollections - number of collections to copy at once, each over its own connection.
+     *                only honoured when the source is another process.
+     *  splitCollectionMinBytes - when copying in parallel, collections at least this large are
+     *                read through several parallelCollectionScan cursors.  0 never splits.
+     *  resume      - keep what an earlier, interrupted clone finished: an existing collection with
+     *                as many documents as its source is not copied again, any other existing
+     *                collection is dropped and copied afresh.  Missing indexes are built either way.
      */
     struct CloneOptions {
         CloneOptions() {
@@ -112,6 +131,10 @@ namespace mongo {
 
             syncData = true;
             syncIndexes = true;
+
+            parallelCollections = 1;
+            splitCollectionMinBytes = 0;
+            resume = false;
         }
 
         std::string fromDB;
@@ -126,6 +149,16 @@ namespace mongo {
 
         bool syncData;
         bool syncIndexes;
+
+        int parallelCollections;
+        long long splitCollectionMinBytes;
+        bool resume;
     };
 
+    /**
+     * Reads the optional "parallelCollections", "splitCollectionMinMB" and "resume" fields of a
+     * clone or copydb command into 'opts'.
+     */
+    Status parseCloneCommandOptions(const BSONObj& cmdObj, CloneOptions* opts);
+
 } // namespace mongo
@@ -267,9 +267,13 @@ namespace mongo {
 
     Status Command::parseCommandCursorOptions(const BSONObj& cmdObj,
                                               long long defaultBatchSize,
-                                              long long* batchSize) {
+                                              long long* batchSize,
+                                              bool* exhaust) {
         invariant(batchSize);
         *batchSize = defaultBatchSize;
+        if (exhaust) {
+            *exhaust = false;
+        }
 
         BSONElement cursorElem = cmdObj["cursor"];
         if (cursorElem.eoo()) {
@@ -282,11 +286,22 @@ namespace mongo {
 
         BSONObj cursor = cursorElem.embeddedObject();
         BSONElement batchSizeElem = cursor["batchSize"];
+        BSONElement exhaustElem = exhaust ? cursor["exhaust"] : BSONElement();
 
-        const int expectedNumberOfCursorFields = batchSizeElem.eoo() ? 0 : 1;
+        const int expectedNumberOfCursorFields =
+            (batchSizeElem.eoo() ? 0 : 1) + (exhaustElem.eoo() ? 0 : 1);
         if (cursor.nFields() != expectedNumberOfCursorFields) {
             return Status(ErrorCodes::BadValue,
-                          "cursor object can't contain fields other than batchSize");
+                          exhaust ? "cursor object can't contain fields other than batchSize "
+                                    "and exhaust" :
+                                    "cursor object can't contain fields other than batchSize");
+        }
+
+        if (!exhaustElem.eoo()) {
+            if (exhaustElem.type() != mongo::Bool) {
+                return Status(ErrorCodes::TypeMismatch, "cursor.exhaust must be a boolean");
+            }
+            *exhaust = exhaustElem.boolean();
         }
 
         if (batchSizeElem.eoo()) {
@@ -298,10 +298,15 @@ namespace mutablebson {
          *
          * If an error occurred while parsing, returns an error Status.  If this is the case, the
          * value pointed to by "batchSize" is unspecified.
+         *
+         * Commands whose cursors can be read in exhaust mode pass "exhaust", which also accepts
+         * "cursor.exhaust" and fills in whether it was set.  getMores on such a cursor stream
+         * every remaining batch, as for a query sent with QueryOption_Exhaust.
          */
         static Status parseCommandCursorOptions(const BSONObj& cmdObj,
                                                 long long defaultBatchSize,
-                                                long long* batchSize);
+                                                long long* batchSize,
+                                                bool* exhaust = NULL);
 
         /**
          * Builds a cursor response object from the provided cursor identifiers and "firstBatch",
@@ -26,6 +26,7 @@
 *    it in the license file.
 */
 
+#include <boost/scoped_ptr.hpp>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -40,7 +41,9 @@
 #include "mongo/db/commands/dbhash.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/matcher/matcher.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/repl/oplog.h"
 
@@ -84,10 +87,18 @@ namespace mongo {
                 }
             }
 
-            // SERVER-4328 todo : is global ok or does this take a long time? i believe multiple 
-            // ns used so locking individually requires more analysis
-            ScopedTransaction scopedXact(txn, MODE_X);
-            Lock::GlobalWrite globalWriteLock(txn->lockState());
+            // Operations which all fall in one database, and are not commands, only need that
+            // database locked. Anything else is applied under the global lock.
+            const string lockedDb = _singleDatabase(ops, cmdObj["preCondition"]);
+            ScopedTransaction scopedXact(txn, lockedDb.empty() ? MODE_X : MODE_IX);
+            boost::scoped_ptr<Lock::GlobalWrite> globalWriteLock;
+            boost::scoped_ptr<Lock::DBLock> dbWriteLock;
+            if (lockedDb.empty()) {
+                globalWriteLock.reset(new Lock::GlobalWrite(txn->lockState()));
+            }
+            else {
+                dbWriteLock.reset(new Lock::DBLock(txn->lockState(), lockedDb, MODE_X));
+            }
 
             // Preconditions check reads the database state, so needs to be done locked
             if ( cmdObj["preCondition"].type() == Array ) {
@@ -114,33 +125,44 @@ namespace mongo {
             int num = 0;
             int errors = 0;
             
-            BSONObjIterator i( ops );
             BSONArrayBuilder ab;
             const bool alwaysUpsert = cmdObj.hasField("alwaysUpsert") ?
                     cmdObj["alwaysUpsert"].trueValue() : true;
-            
-            while ( i.more() ) {
-                BSONElement e = i.next();
-                const BSONObj& temp = e.Obj();
 
-                // Ignore 'n' operations.
-                const char *opType = temp["op"].valuestrsafe();
-                if (*opType == 'n') continue;
+            // Ignore 'n' operations.
+            std::vector<BSONObj> toApply;
+            BSONForEach(e, ops) {
+                if (*e.Obj()["op"].valuestrsafe() != 'n') {
+                    toApply.push_back(e.Obj());
+                }
+            }
 
-                const string ns = temp["ns"].String();
+            size_t next = 0;
+            while (next < toApply.size()) {
+                const string ns = toApply[next]["ns"].String();
 
                 // Run operations under a nested lock as a hack to prevent yielding.
                 //
                 // The list of operations is supposed to be applied atomically; yielding
                 // would break atomicity by allowing an interruption or a shutdown to occur
                 // after only some operations are applied.  We are already locked globally
-                // at this point, so taking a DBLock on the namespace creates a nested lock,
-                // and yields are disallowed for operations that hold a nested lock.
+                // (or on the one database written to) at this point, so taking the lock
+                // again creates a nested lock, and yields are disallowed for operations
+                // that hold a nested lock.
                 //
                 // We do not have a wrapping WriteUnitOfWork so it is possible for a journal
                 // commit to happen with a subset of ops applied.
                 // TODO figure out what to do about this.
-                Lock::GlobalWrite globalWriteLockDisallowTempRelease(txn->lockState());
+                boost::scoped_ptr<Lock::GlobalWrite> globalWriteLockDisallowTempRelease;
+                boost::scoped_ptr<Lock::DBLock> dbWriteLockDisallowTempRelease;
+                if (lockedDb.empty()) {
+                    globalWriteLockDisallowTempRelease.reset(
+                        new Lock::GlobalWrite(txn->lockState()));
+                }
+                else {
+                    dbWriteLockDisallowTempRelease.reset(
+                        new Lock::DBLock(txn->lockState(), lockedDb, MODE_X));
+                }
 
                 // Ensures that yielding will not happen (see the comment above).
                 DEV {
@@ -148,17 +170,51 @@ namespace mongo {
                     invariant(!txn->lockState()->saveLockStateAndUnlock(&lockSnapshot));
                 };
 
+                // Consecutive operations on the same namespace share one context, and runs of
+                // inserts among them are applied as a single batch.
                 Client::Context ctx(txn, ns);
-                bool failed = repl::applyOperation_inlock(txn,
-                                                          ctx.db(),
-                                                          temp,
-                                                          false,
-                                                          alwaysUpsert);
-                ab.append(!failed);
-                if ( failed )
-                    errors++;
+                do {
+                    const size_t numInserts = _countBatchableInserts(toApply, next);
+                    if (numInserts > 1) {
+                        BSONArrayBuilder docs;
+                        for (size_t j = 0; j < numInserts; j++) {
+                            docs.append(toApply[next + j]["o"].Obj());
+                        }
+                        repl::applyOperation_inlock(txn,
+                                                    ctx.db(),
+                                                    BSON("op" << "i"
+                                                         << "ns" << ns
+                                                         << "o" << docs.arr()),
+                                                    false,
+                                                    alwaysUpsert);
+                        for (size_t j = 0; j < numInserts; j++) {
+                            ab.append(true);
+                        }
+                        num += numInserts;
+                        next += numInserts;
+                        continue;
+                    }
 
-                num++;
+                    const BSONObj& temp = toApply[next];
+                    bool failed = repl::applyOperation_inlock(txn,
+                                                              ctx.db(),
+                                                              temp,
+                                                              false,
+                                                              alwaysUpsert);
+                    ab.append(!failed);
+                    if ( failed )
+                        errors++;
+
+                    num++;
+                    next++;
+
+                    // Commands may do anything to the namespace, so they are applied alone.
+                    if (*temp["op"].valuestrsafe() == 'c') {
+                        break;
+                    }
+                } while (next < toApply.size()
+                         && toApply[next]["ns"].String() == ns
+                         && *toApply[next]["op"].valuestrsafe() != 'c');
 
                 logOpForDbHash(ns.c_str());
             }
@@ -201,6 +257,74 @@ namespace mongo {
         }
 
     private:
+        /**
+         * Returns the database which all of the CRUD operations in 'ops' and all of the
+         * 'preConditions' are on, or an empty string if there is no single such database or
+         * if 'ops' contains any other kind of operation.
+         */
+        static string _singleDatabase(const BSONObj& ops, const BSONElement& preConditions) {
+            std::vector<string> namespaces;
+            BSONForEach(e, ops) {
+                const BSONObj op = e.Obj();
+                const char* opType = op["op"].valuestrsafe();
+                if (*opType == 'n') {
+                    continue;
+                }
+                if (strcmp(opType, "i") != 0 && strcmp(opType, "u") != 0
+                        && strcmp(opType, "d") != 0) {
+                    return "";
+                }
+                namespaces.push_back(op["ns"].String());
+            }
+
+            if (preConditions.type() == Array) {
+                BSONForEach(e, preConditions.Obj()) {
+                    if (e.type() != Object || e.Obj()["ns"].type() != String) {
+                        return "";
+                    }
+                    namespaces.push_back(e.Obj()["ns"].String());
+                }
+            }
+
+            string db;
+            for (size_t i = 0; i < namespaces.size(); i++) {
+                const string nsDb = nsToDatabase(namespaces[i]);
+                if (nsDb.empty() || (!db.empty() && nsDb != db)) {
+                    return "";
+                }
+                db = nsDb;
+            }
+            return db;
+        }
+
+        /**
+         * Returns how many of the operations starting at 'ops[start]' are plain inserts into the
+         * same collection, each with a distinct _id, which can be inserted as one batch.
+         */
+        static size_t _countBatchableInserts(const std::vector<BSONObj>& ops, size_t start) {
+            const string ns = ops[start]["ns"].String();
+            if (nsToCollectionSubstring(ns) == "system.indexes") {
+                return 0;
+            }
+
+            BSONElementSet ids;
+            size_t end = start;
+            for (; end < ops.size(); end++) {
+                const BSONObj& op = ops[end];
+                if (strcmp(op["op"].valuestrsafe(), "i") != 0
+                        || op["ns"].String() != ns
+                        || op["o"].type() != Object) {
+                    break;
+                }
+
+                const BSONElement id = op["o"].Obj()["_id"];
+                if (id.eoo() || !ids.insert(id).second) {
+                    break;
+                }
+            }
+            return end - start;
+        }
+
         /**
          * Returns true if 'e' contains a valid operation.
          */
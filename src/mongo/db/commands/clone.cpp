@@ -72,7 +72,8 @@ namespace mongo {
 
         virtual void help( stringstream &help ) const {
             help << "clone this database from an instance of the db on another host\n";
-            help << "{ clone : \"host13\" }";
+            help << "{ clone : \"host13\"[, parallelCollections: <n>, splitCollectionMinMB: <n>"
+                 << ", resume: <bool>] }";
         }
 
         virtual Status checkAuthForCommand(ClientBasic* client,
@@ -104,6 +105,11 @@ namespace mongo {
             opts.fromDB = dbname;
             opts.logForRepl = ! fromRepl;
 
+            Status optionsStatus = parseCloneCommandOptions(cmdObj, &opts);
+            if (!optionsStatus.isOK()) {
+                return appendCommandStatus(result, optionsStatus);
+            }
+
             // See if there's any collections we should ignore
             if( cmdObj["collsToIgnore"].type() == Array ){
                 BSONObjIterator it( cmdObj["collsToIgnore"].Obj() );
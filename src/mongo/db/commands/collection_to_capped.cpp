@@ -40,6 +40,7 @@
 #include "mongo/db/query/find.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/util/progress_meter.h"
 
 namespace mongo {
 
@@ -49,6 +50,10 @@ namespace mongo {
 
 namespace {
 
+    // Documents copied per unit of work.
+    const size_t kCloneBatchMaxDocs = 1000;
+    const size_t kCloneBatchMaxBytes = 16 * 1024 * 1024;
+
     Status cloneCollectionAsCapped( OperationContext* txn,
                                     Database* db,
                                     const string& shortFrom,
@@ -101,6 +106,14 @@ namespace {
                                                                        fromCollection,
                                                                        InternalPlanner::FORWARD ) );
 
+        ProgressMeterHolder progress(*txn->setMessage("cloneCollectionAsCapped: copying documents",
+                                                      "Clone Progress",
+                                                      fromCollection->numRecords(txn)));
+
+        // Documents are inserted a batch per unit of work.  They go in one at a time all the
+        // same, as a capped collection may delete a record inserted earlier in the batch.
+        std::vector<BSONObj> batch;
+        size_t batchBytes = 0;
 
         while ( true ) {
             BSONObj obj;
@@ -108,23 +121,45 @@ namespace {
 
             switch( state ) {
             case PlanExecutor::IS_EOF:
-                return Status::OK();
+                break;
             case PlanExecutor::DEAD:
                 db->dropCollection( txn, toNs );
                 return Status( ErrorCodes::InternalError, "executor turned dead while iterating" );
             case PlanExecutor::FAILURE:
                 return Status( ErrorCodes::InternalError, "executor error while iterating" );
             case PlanExecutor::ADVANCED:
+                progress.hit();
                 if ( excessSize > 0 ) {
                     excessSize -= ( 4 * obj.objsize() ); // 4x is for padding, power of 2, etc...
                     continue;
                 }
 
+                batch.push_back( obj.getOwned() );
+                batchBytes += obj.objsize();
+                if ( batch.size() < kCloneBatchMaxDocs && batchBytes < kCloneBatchMaxBytes )
+                    continue;
+            }
+
+            if ( !batch.empty() ) {
+                txn->checkForInterrupt();
+
                 WriteUnitOfWork wunit(txn);
-                toCollection->insertDocument( txn, obj, true );
+                for ( size_t i = 0; i < batch.size(); i++ ) {
+                    Status status = toCollection->insertDocument( txn, batch[i], true ).getStatus();
+                    if ( !status.isOK() )
+                        return status;
+                }
                 if ( logForReplication )
-                    repl::logOp(txn, "i", toNs.c_str(), obj);
+                    repl::logInsertOps(txn, toNs.c_str(), batch);
                 wunit.commit();
+
+                batch.clear();
+                batchBytes = 0;
+            }
+
+            if ( state == PlanExecutor::IS_EOF ) {
+                progress.finished();
+                return Status::OK();
             }
         }
 
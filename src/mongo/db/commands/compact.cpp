@@ -68,10 +68,11 @@ namespace mongo {
         }
         virtual void help( stringstream& help ) const {
             help << "compact collection\n"
-                "warning: this operation locks the database and is slow. you can cancel with killOp()\n"
+                "warning: with MMAPv1 this operation locks the database and is slow. you can cancel with killOp()\n"
+                "with storage engines that compact in place it runs online, under intent locks\n"
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
                 "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
-                "  force - allows to run on a replica set primary\n"
+                "  force - allows an offline compact to run on a replica set primary\n"
                 "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n";
         }
         CompactCmd() : Command("compact") { }
@@ -89,12 +90,6 @@ namespace mongo {
         virtual bool run(OperationContext* txn, const string& db, BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl) {
             const std::string nsToCompact = parseNsCollectionRequired(db, cmdObj);
 
-            repl::ReplicationCoordinator* replCoord = repl::getGlobalReplicationCoordinator();
-            if (replCoord->getMemberState().primary() && !cmdObj["force"].trueValue()) {
-                errmsg = "will not run compact on an active replica set primary as this is a slow blocking operation. use force:true to force";
-                return false;
-            }
-
             NamespaceString ns(nsToCompact);
             if ( !ns.isNormal() ) {
                 errmsg = "bad namespace name";
@@ -141,6 +136,45 @@ namespace mongo {
             if ( cmdObj.hasElement("validate") )
                 compactOptions.validateDocuments = cmdObj["validate"].trueValue();
 
+            {
+                // A record store that compacts in place, such as WiredTiger's, moves no
+                // documents, so it is compacted online: only intent locks are held, reads and
+                // writes go on, and it may run on a primary.
+                ScopedTransaction transaction(txn, MODE_IX);
+                AutoGetDb autoDb(txn, db, MODE_IX);
+                Lock::CollectionLock collLock(txn->lockState(), ns.ns(), MODE_IX);
+                Database* const collDB = autoDb.getDb();
+                Collection* collection = collDB ? collDB->getCollection(ns) : NULL;
+
+                // If db/collection does not exist, short circuit and return.
+                if ( !collDB || !collection ) {
+                    errmsg = "namespace does not exist";
+                    return false;
+                }
+
+                RecordStore* recordStore = collection->getRecordStore();
+                if ( recordStore->compactSupported() && recordStore->compactsInPlace() ) {
+                    if ( collection->isCapped() ) {
+                        errmsg = "cannot compact a capped collection";
+                        return false;
+                    }
+
+                    log() << "compact " << ns << " begin (online)";
+
+                    StatusWith<CompactStats> status = collection->compact( txn, &compactOptions );
+                    if ( !status.isOK() )
+                        return appendCommandStatus( result, status.getStatus() );
+
+                    log() << "compact " << ns << " end";
+                    return true;
+                }
+            }
+
+            repl::ReplicationCoordinator* replCoord = repl::getGlobalReplicationCoordinator();
+            if (replCoord->getMemberState().primary() && !cmdObj["force"].trueValue()) {
+                errmsg = "will not run compact on an active replica set primary as this is a slow blocking operation. use force:true to force";
+                return false;
+            }
 
             ScopedTransaction transaction(txn, MODE_IX);
             AutoGetDb autoDb(txn, db, MODE_X);
@@ -60,7 +60,9 @@ namespace mongo {
 
     /* Usage:
      * admindb.$cmd.findOne( { copydb: 1, fromhost: <connection string>, fromdb: <db>,
-     *                         todb: <db>[, username: <username>, nonce: <nonce>, key: <key>] } );
+     *                         todb: <db>[, username: <username>, nonce: <nonce>, key: <key>,
+ *                         parallelCollections: <n>, splitCollectionMinMB: <n>,
+ *                         resume: <bool>] } );
      *
      * The "copydb" command is used to copy a database.  Note that this is a very broad definition.
      * This means that the "copydb" command can be used in the following ways:
@@ -119,7 +121,8 @@ namespace mongo {
         virtual void help( stringstream &help ) const {
             help << "copy a database from another host to this host\n";
             help << "usage: {copydb: 1, fromhost: <connection string>, fromdb: <db>, todb: <db>"
-                 << "[, slaveOk: <bool>, username: <username>, nonce: <nonce>, key: <key>]}";
+                 << "[, slaveOk: <bool>, username: <username>, nonce: <nonce>, key: <key>"
+                 << ", parallelCollections: <n>, splitCollectionMinMB: <n>, resume: <bool>]}";
         }
 
         virtual bool run(OperationContext* txn,
@@ -148,6 +151,11 @@ namespace mongo {
             cloneOptions.mayYield = true;
             cloneOptions.mayBeInterrupted = false;
 
+            Status optionsStatus = parseCloneCommandOptions(cmdObj, &cloneOptions);
+            if (!optionsStatus.isOK()) {
+                return appendCommandStatus(result, optionsStatus);
+            }
+
             string todb = cmdObj.getStringField("todb");
             if ( fromhost.empty() || todb.empty() || cloneOptions.fromDB.empty() ) {
                 errmsg = "params missing - {copydb: 1, fromhost: <connection string>, "
@@ -179,6 +187,10 @@ namespace mongo {
                     }
                 }
                 cloner.setConnection( authConn_.release() );
+
+                // The parallel workers open their own connections, which can't log in as the
+                // user.
+                cloneOptions.parallelCollections = 1;
             }
             else if (cmdObj.hasField(saslCommandConversationIdFieldName) &&
                      cmdObj.hasField(saslCommandPayloadFieldName)) {
@@ -200,6 +212,7 @@ namespace mongo {
 
                 result.append("done", true);
                 cloner.setConnection( authConn_.release() );
+                cloneOptions.parallelCollections = 1;
             }
             else if (!fromSelf) {
                 // If fromSelf leave the cloner's conn empty, it will use a DBDirectClient instead.
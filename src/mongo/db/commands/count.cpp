@@ -32,16 +32,20 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/client.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/exec/count.h"
+#include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/parallel_scan.h"
 #include "mongo/db/range_preserver.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/s/d_state.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -49,6 +53,89 @@ namespace mongo {
     using boost::scoped_ptr;
     using std::string;
     using std::stringstream;
+    using std::vector;
+
+namespace {
+
+    /**
+     * Counts the documents of one partition of a parallel count.
+     */
+    class CountPartitionWorker : public ParallelScanWorker {
+    public:
+        CountPartitionWorker() : nCounted(0) { }
+
+        virtual Status run(OperationContext* txn, PlanExecutor* exec) {
+            BSONObj obj;
+            PlanExecutor::ExecState state;
+            while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
+                nCounted++;
+            }
+
+            if (PlanExecutor::DEAD == state) {
+                return Status(ErrorCodes::OperationFailed,
+                              "collection dropped during parallel count");
+            }
+            if (PlanExecutor::FAILURE == state) {
+                return Status(ErrorCodes::OperationFailed,
+                              str::stream() << "parallel count failed: "
+                                            << WorkingSetCommon::toStatusString(obj));
+            }
+            return Status::OK();
+        }
+
+        long long nCounted;
+    };
+
+    /**
+     * Returns how many workers the count planned as 'exec' should be split across, or 0 if it
+     * should run as planned. Only plain collection scans are split: a count answered from an
+     * index is cheap already, and skip and limit need the documents in order.
+     */
+    size_t parallelCountWorkers(OperationContext* txn,
+                                const Collection* collection,
+                                const CountRequest& request,
+                                PlanExecutor* exec) {
+        if (request.skip != 0 || request.limit != 0 || request.explain) {
+            return 0;
+        }
+
+        // Workers don't filter out orphaned documents or hold off chunk cleanup.
+        if (shardingState.needCollectionMetadata(request.ns)) {
+            return 0;
+        }
+
+        const vector<PlanStage*> children = exec->getRootStage()->getChildren();
+        if (children.size() != 1 || STAGE_COLLSCAN != children[0]->stageType()) {
+            return 0;
+        }
+
+        return parallelScanWorkers(txn, collection);
+    }
+
+    Status runParallelCount(OperationContext* txn,
+                            const CountRequest& request,
+                            size_t numWorkers,
+                            long long* nCounted) {
+        OwnedPointerVector<CountPartitionWorker> counters;
+        vector<ParallelScanWorker*> workers;
+        for (size_t i = 0; i < numWorkers; i++) {
+            counters.push_back(new CountPartitionWorker());
+            workers.push_back(counters[i]);
+        }
+
+        Status status = runParallelCollectionScan(txn, request.ns, request.query, workers);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        *nCounted = 0;
+        for (size_t i = 0; i < counters.size(); i++) {
+            *nCounted += counters[i]->nCounted;
+        }
+        return Status::OK();
+    }
+
+}  // namespace
 
     /* select count(*) */
     class CmdCount : public Command {
@@ -122,42 +209,67 @@ namespace mongo {
                 return appendCommandStatus(result, parseStatus);
             }
 
-            AutoGetCollectionForRead ctx(txn, request.ns);
-            Collection* collection = ctx.getCollection();
+            // Parallel workers take their own locks, so they can't be used if the caller already
+            // holds some.
+            const bool mayScanInParallel = !txn->lockState()->isLocked();
+            size_t numWorkers = 0;
+
+            {
+                AutoGetCollectionForRead ctx(txn, request.ns);
+                Collection* collection = ctx.getCollection();
+
+                // Prevent chunks from being cleaned up during yields - this allows us to only check
+                // the version on initial entry into count.
+                RangePreserver preserver(collection);
+
+                PlanExecutor* rawExec;
+                Status getExecStatus = getExecutorCount(txn,
+                                                        collection,
+                                                        request,
+                                                        PlanExecutor::YIELD_AUTO,
+                                                        &rawExec);
+                if (!getExecStatus.isOK()) {
+                    return appendCommandStatus(result, getExecStatus);
+                }
 
-            // Prevent chunks from being cleaned up during yields - this allows us to only check the
-            // version on initial entry into count.
-            RangePreserver preserver(collection);
+                scoped_ptr<PlanExecutor> exec(rawExec);
 
-            PlanExecutor* rawExec;
-            Status getExecStatus = getExecutorCount(txn,
-                                                    collection,
-                                                    request,
-                                                    PlanExecutor::YIELD_AUTO,
-                                                    &rawExec);
-            if (!getExecStatus.isOK()) {
-                return appendCommandStatus(result, getExecStatus);
-            }
+                // Store the plan summary string in CurOp.
+                if (NULL != txn->getCurOp()) {
+                    txn->getCurOp()->debug().planSummary = Explain::getPlanSummary(exec.get());
+                }
 
-            scoped_ptr<PlanExecutor> exec(rawExec);
+                if (mayScanInParallel) {
+                    numWorkers = parallelCountWorkers(txn, collection, request, exec.get());
+                }
 
-            // Store the plan summary string in CurOp.
-            if (NULL != txn->getCurOp()) {
-                txn->getCurOp()->debug().planSummary = Explain::getPlanSummary(exec.get());
+                if (numWorkers == 0) {
+                    Status execPlanStatus = exec->executePlan();
+                    if (!execPlanStatus.isOK()) {
+                        return appendCommandStatus(result, execPlanStatus);
+                    }
+
+                    // Plan is done executing. We just need to pull the count out of the root
+                    // stage.
+                    invariant(STAGE_COUNT == exec->getRootStage()->stageType());
+                    CountStage* countStage = static_cast<CountStage*>(exec->getRootStage());
+                    const CountStats* countStats =
+                        static_cast<const CountStats*>(countStage->getSpecificStats());
+
+                    result.appendNumber("n", countStats->nCounted);
+                    return true;
+                }
             }
 
-            Status execPlanStatus = exec->executePlan();
-            if (!execPlanStatus.isOK()) {
-                return appendCommandStatus(result, execPlanStatus);
+            // The collection lock is released here: the workers scan the partitions of the
+            // collection under their own locks.
+            long long nCounted;
+            Status parallelStatus = runParallelCount(txn, request, numWorkers, &nCounted);
+            if (!parallelStatus.isOK()) {
+                return appendCommandStatus(result, parallelStatus);
             }
 
-            // Plan is done executing. We just need to pull the count out of the root stage.
-            invariant(STAGE_COUNT == exec->getRootStage()->stageType());
-            CountStage* countStage = static_cast<CountStage*>(exec->getRootStage());
-            const CountStats* countStats =
-                static_cast<const CountStats*>(countStage->getSpecificStats());
-
-            result.appendNumber("n", countStats->nCounted);
+            result.appendNumber("n", nCounted);
             return true;
         }
 
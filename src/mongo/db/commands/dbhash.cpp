@@ -33,15 +33,29 @@
 #include "mongo/db/commands/dbhash.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <cstdio>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/parallel_scan.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/log.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/timer.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
@@ -55,6 +69,204 @@ namespace mongo {
 
     DBHashCmd dbhashCmd;
 
+namespace {
+
+    // How many collections an orderIndependent dbHash hashes at once. Each of them is also
+    // split across the workers a parallel collection scan would use.
+    MONGO_EXPORT_SERVER_PARAMETER(dbHashParallelCollections, int, 4);
+
+    /**
+     * Sums 128 bit hashes of the documents of one partition of a collection. The sums of all
+     * the partitions add up to a hash of the collection that doesn't depend on the order its
+     * documents were read in.
+     */
+    class DocumentHashSummer : public ParallelScanWorker {
+    public:
+        DocumentHashSummer() {
+            sums[0] = 0;
+            sums[1] = 0;
+        }
+
+        virtual Status run(OperationContext* txn, PlanExecutor* exec) {
+            BSONObj obj;
+            PlanExecutor::ExecState state;
+            while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
+                uint64_t hash[2];
+                MurmurHash3_x64_128(obj.objdata(), obj.objsize(), 0, hash);
+                sums[0] += hash[0];
+                sums[1] += hash[1];
+            }
+            if (PlanExecutor::IS_EOF != state) {
+                return Status(ErrorCodes::OperationFailed,
+                              str::stream() << "executor returned "
+                                            << PlanExecutor::statestr(state)
+                                            << " while hashing collection");
+            }
+            return Status::OK();
+        }
+
+        uint64_t sums[2];
+    };
+
+    struct CollectionToHash {
+        string ns;
+        CollectionInfoCache::ContentVersion version; // when the hash was started
+        size_t workers;
+
+        string hash;
+        bool changed; // written to while it was hashed
+        Status status;
+
+        CollectionToHash() : workers(0), changed(false), status(Status::OK()) { }
+    };
+
+    /**
+     * Shared between the thread running an orderIndependent dbHash and the threads hashing its
+     * collections.
+     */
+    class ParallelHashState {
+    public:
+        ParallelHashState(vector<CollectionToHash>* collections)
+            : collections(*collections), _next(0), _running(0), _killed(false) { }
+
+        vector<CollectionToHash>& collections;
+
+        /**
+         * Hands out the next collection to hash, or returns false if there are none left or the
+         * hash was killed. 'opId' is the operation to kill to stop the caller.
+         */
+        bool nextCollection(unsigned int opId, size_t* index) {
+            boost::mutex::scoped_lock lk(_mutex);
+            if (_killed || _next == collections.size()) {
+                return false;
+            }
+            _opIds.insert(opId);
+            *index = _next++;
+            return true;
+        }
+
+        void workerStarting() {
+            boost::mutex::scoped_lock lk(_mutex);
+            _running++;
+        }
+
+        void workerDone(unsigned int opId) {
+            boost::mutex::scoped_lock lk(_mutex);
+            _opIds.erase(opId);
+            _running--;
+            _doneCondition.notify_all();
+        }
+
+        /**
+         * Waits for all threads to finish, killing them if 'txn' is interrupted.
+         */
+        Status waitForWorkers(OperationContext* txn) {
+            Status interruptStatus = Status::OK();
+
+            boost::mutex::scoped_lock lk(_mutex);
+            while (_running > 0) {
+                _doneCondition.timed_wait(lk, boost::posix_time::milliseconds(100));
+                if (_killed) {
+                    continue;
+                }
+
+                interruptStatus = txn->checkForInterruptNoAssert();
+                if (!interruptStatus.isOK()) {
+                    _killAll_inlock();
+                }
+            }
+            return interruptStatus;
+        }
+
+        void kill() {
+            boost::mutex::scoped_lock lk(_mutex);
+            _killAll_inlock();
+        }
+
+    private:
+        void _killAll_inlock() {
+            _killed = true;
+            for (set<unsigned int>::const_iterator it = _opIds.begin(); it != _opIds.end(); ++it) {
+                getGlobalEnvironment()->killOperation(*it);
+            }
+        }
+
+        boost::mutex _mutex;
+        boost::condition_variable _doneCondition;
+
+        // All protected by _mutex.
+        size_t _next;
+        size_t _running;
+        bool _killed;
+        set<unsigned int> _opIds;
+    };
+
+    string formatHash(const uint64_t sums[2]) {
+        char buf[33];
+        snprintf(buf, sizeof(buf), "%016llx%016llx",
+                 static_cast<unsigned long long>(sums[0]),
+                 static_cast<unsigned long long>(sums[1]));
+        return buf;
+    }
+
+    void hashCollection(OperationContext* txn, CollectionToHash* toHash) {
+        OwnedPointerVector<ParallelScanWorker> workers;
+        for (size_t i = 0; i < toHash->workers; i++) {
+            workers.mutableVector().push_back(new DocumentHashSummer());
+        }
+
+        toHash->status = runParallelCollectionScan(txn, toHash->ns, BSONObj(), workers.vector());
+        if (!toHash->status.isOK()) {
+            return;
+        }
+
+        uint64_t sums[2] = {0, 0};
+        for (size_t i = 0; i < workers.size(); i++) {
+            const DocumentHashSummer* summer = static_cast<DocumentHashSummer*>(workers[i]);
+            sums[0] += summer->sums[0];
+            sums[1] += summer->sums[1];
+        }
+        toHash->hash = formatHash(sums);
+
+        // Only a collection nobody wrote to while it was read has a hash worth remembering.
+        AutoGetCollectionForRead ctx(txn, toHash->ns);
+        Collection* collection = ctx.getCollection();
+        if (collection &&
+            collection->infoCache()->getContentVersion() == toHash->version) {
+            collection->infoCache()->setContentHash(toHash->version, toHash->hash);
+        }
+        else {
+            toHash->changed = true;
+        }
+    }
+
+    void runHashThread(ParallelHashState* state) {
+        Client::initThread("dbHash");
+
+        unsigned int opId = 0;
+        {
+            OperationContextImpl txn;
+            opId = txn.getCurOp()->opNum();
+            size_t index;
+            while (state->nextCollection(opId, &index)) {
+                CollectionToHash* toHash = &state->collections[index];
+                try {
+                    hashCollection(&txn, toHash);
+                }
+                catch (const DBException& ex) {
+                    toHash->status = ex.toStatus();
+                }
+                catch (const std::exception& ex) {
+                    toHash->status = Status(ErrorCodes::InternalError, ex.what());
+                }
+            }
+        }
+        state->workerDone(opId);
+        cc().shutdown();
+    }
+
+} // namespace
+
 
     void logOpForDbHash(const char* ns) {
         dbhashCmd.wipeCacheForCollection( ns );
@@ -156,6 +368,10 @@ namespace mongo {
             }
         }
 
+        if ( cmdObj["orderIndependent"].trueValue() ) {
+            return runOrderIndependent( txn, dbname, cmdObj, desiredCollections, errmsg, result );
+        }
+
         list<string> colls;
         const string ns = parseNs(dbname, cmdObj);
 
@@ -216,6 +432,132 @@ namespace mongo {
         return 1;
     }
 
+    bool DBHashCmd::runOrderIndependent( OperationContext* txn,
+                                         const string& dbname,
+                                         const BSONObj& cmdObj,
+                                         const set<string>& desiredCollections,
+                                         string& errmsg,
+                                         BSONObjBuilder& result ) {
+        Timer timer;
+        const string ns = parseNs(dbname, cmdObj);
+
+        // Each collection is read without holding the database, so that the collections can be
+        // hashed on other threads. Hashes are by short name, which sorts the same as full names.
+        std::map<string, string> hashes;
+        vector<string> cached;
+        vector<CollectionToHash> toHash;
+        long long numCollections = 0;
+        {
+            ScopedTransaction scopedXact(txn, MODE_IS);
+            AutoGetDb autoDb(txn, ns, MODE_IS);
+            Database* db = autoDb.getDb();
+            list<string> colls;
+            if (db) {
+                db->getDatabaseCatalogEntry()->getCollectionNamespaces(&colls);
+            }
+            numCollections = colls.size();
+
+            for ( list<string>::iterator i = colls.begin(); i != colls.end(); i++ ) {
+                const string& fullCollectionName = *i;
+                if ( fullCollectionName.size() -1 <= dbname.size() ) {
+                    errmsg  = str::stream() << "weird fullCollectionName [" << fullCollectionName << "]";
+                    return false;
+                }
+                const string shortCollectionName = fullCollectionName.substr( dbname.size() + 1 );
+
+                if ( shortCollectionName.find( "system." ) == 0 )
+                    continue;
+
+                if ( desiredCollections.size() > 0 &&
+                     desiredCollections.count( shortCollectionName ) == 0 )
+                    continue;
+
+                Lock::CollectionLock collLock( txn->lockState(), fullCollectionName, MODE_IS );
+                Collection* collection = db->getCollection( fullCollectionName );
+                if ( !collection ) {
+                    hashes[shortCollectionName] = "";
+                    continue;
+                }
+
+                CollectionToHash next;
+                next.ns = fullCollectionName;
+                next.version = collection->infoCache()->getContentVersion();
+                string hash;
+                if ( collection->infoCache()->getContentHash( next.version, &hash ) ) {
+                    hashes[shortCollectionName] = hash;
+                    cached.push_back( fullCollectionName );
+                    continue;
+                }
+                next.workers = std::max<size_t>( 1, parallelScanWorkers( txn, collection ) );
+                toHash.push_back( next );
+            }
+        }
+
+        if ( !toHash.empty() ) {
+            ParallelHashState state( &toHash );
+            const size_t nThreads =
+                std::min( toHash.size(), static_cast<size_t>( std::max( 1, dbHashParallelCollections ) ) );
+
+            boost::thread_group threads;
+            try {
+                for ( size_t i = 0; i < nThreads; i++ ) {
+                    state.workerStarting();
+                    try {
+                        threads.create_thread( stdx::bind( &runHashThread, &state ) );
+                    }
+                    catch (...) {
+                        state.workerDone( 0 );
+                        throw;
+                    }
+                }
+            }
+            catch ( const std::exception& ex ) {
+                warning() << "dbHash of " << dbname << " failed to start: " << ex.what();
+                state.kill();
+            }
+
+            const Status status = state.waitForWorkers( txn );
+            threads.join_all();
+            uassertStatusOK( status );
+        }
+
+        vector<string> changed;
+        for ( size_t i = 0; i < toHash.size(); i++ ) {
+            const CollectionToHash& hashed = toHash[i];
+            uassertStatusOK( hashed.status );
+            uassert( 28629,
+                     str::stream() << "dbHash stopped before hashing " << hashed.ns,
+                     !hashed.hash.empty() );
+            hashes[hashed.ns.substr( dbname.size() + 1 )] = hashed.hash;
+            if ( hashed.changed )
+                changed.push_back( hashed.ns );
+        }
+
+        result.appendNumber( "numCollections" , numCollections );
+        result.append( "host" , prettyHostName() );
+
+        md5_state_t globalState;
+        md5_init(&globalState);
+
+        BSONObjBuilder bb( result.subobjStart( "collections" ) );
+        for ( std::map<string, string>::const_iterator i = hashes.begin(); i != hashes.end(); ++i ) {
+            bb.append( i->first, i->second );
+            md5_append( &globalState , (const md5_byte_t*)i->second.c_str() , i->second.size() );
+        }
+        bb.done();
+
+        md5digest d;
+        md5_finish(&globalState, d);
+
+        result.append( "md5" , digestToString( d ) );
+        result.appendBool( "orderIndependent", true );
+        result.appendNumber( "timeMillis", timer.millis() );
+        result.append( "fromCache", cached );
+        result.append( "changedDuringHash", changed );
+
+        return true;
+    }
+
     void DBHashCmd::wipeCacheForCollection( const StringData& ns ) {
         if ( !isCachable( ns ) )
             return;
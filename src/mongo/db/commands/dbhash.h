@@ -56,6 +56,18 @@ namespace mongo {
 
         std::string hashCollection( OperationContext* opCtx, Database* db, const std::string& fullCollectionName, bool* fromCache );
 
+        /**
+         * Hashes each collection as the sum of hashes of its documents, which can be computed
+         * over partitions of the collection in parallel, several collections at a time, and is
+         * cached until the collection is next written to.
+         */
+        bool runOrderIndependent( OperationContext* txn,
+                                  const std::string& dbname,
+                                  const BSONObj& cmdObj,
+                                  const std::set<std::string>& desiredCollections,
+                                  std::string& errmsg,
+                                  BSONObjBuilder& result );
+
         std::map<std::string,std::string> _cachedHashed;
         mutex _cachedHashedMutex;
 
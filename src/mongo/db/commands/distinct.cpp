@@ -37,11 +37,13 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/platform/unordered_set.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -50,6 +52,26 @@ namespace mongo {
     using std::string;
     using std::stringstream;
 
+namespace {
+
+    // Hashes and compares values the way BSONElementSet orders them, ignoring field names and
+    // the types of numbers.
+    struct DistinctValueHash {
+        size_t operator()(const BSONElement& elt) const {
+            return BSONElementHasher::hash64(elt, BSONElementHasher::DEFAULT_HASH_SEED);
+        }
+    };
+
+    struct DistinctValueEqual {
+        bool operator()(const BSONElement& lhs, const BSONElement& rhs) const {
+            return lhs.woCompare(rhs, false) == 0;
+        }
+    };
+
+    typedef unordered_set<BSONElement, DistinctValueHash, DistinctValueEqual> DistinctValueSet;
+
+}  // namespace
+
     class DistinctCommand : public Command {
     public:
         DistinctCommand() : Command("distinct") {}
@@ -98,8 +120,9 @@ namespace mongo {
             BufBuilder bb( bufSize );
             char * start = bb.buf();
 
+            // The values live in 'bb', which is capped, so the set needs no accounting of its own.
             BSONArrayBuilder arr( bb );
-            BSONElementSet values;
+            DistinctValueSet values;
 
             const string ns = parseNs(dbname, cmdObj);
             AutoGetCollectionForRead ctx(txn, ns);
@@ -201,7 +201,8 @@ namespace mongo {
         //             query: <query>,
         //             sort: <sort>,
         //             projection: <projection>,
-        //             indexes: [<index1>, <index2>, <index3>, ...]
+        //             indexes: [<index1>, <index2>, <index3>, ...],
+        //             pinnedPlan: <plan>  (only if a plan is pinned)
         //         }
         //  }
         BSONArrayBuilder hintsBuilder(bob->subarrayStart("filters"));
@@ -223,6 +224,9 @@ namespace mongo {
                 indexesBuilder.append(index);
             }
             indexesBuilder.doneFast();
+            if (!entry->pinnedPlan.isEmpty()) {
+                hintBob.append("pinnedPlan", entry->pinnedPlan);
+            }
         }
         hintsBuilder.doneFast();
         return Status::OK();
@@ -325,7 +329,8 @@ namespace mongo {
     }
 
     SetFilter::SetFilter() : IndexFilterCommand("planCacheSetFilter",
-        "Sets index filter for a query shape. Overrides existing filter.") { }
+        "Sets index filter for a query shape, optionally pinning a plan to it. "
+        "Overrides existing filter.") { }
 
     Status SetFilter::runIndexFilterCommand(OperationContext* txn,
                                             const std::string& ns,
@@ -385,8 +390,37 @@ namespace mongo {
         }
         scoped_ptr<CanonicalQuery> cq(cqRaw);
 
+        // pinnedPlan and pinCachedPlan - optional
+        BSONObj pinnedPlan;
+        BSONElement pinnedPlanElt = cmdObj.getField("pinnedPlan");
+        const bool pinCachedPlan = cmdObj.getField("pinCachedPlan").trueValue();
+        if (!pinnedPlanElt.eoo()) {
+            if (pinCachedPlan) {
+                return Status(ErrorCodes::BadValue,
+                              "pinnedPlan and pinCachedPlan cannot both be specified");
+            }
+            if (pinnedPlanElt.type() != mongo::Object) {
+                return Status(ErrorCodes::BadValue, "pinnedPlan must be an object");
+            }
+            pinnedPlan = pinnedPlanElt.Obj();
+            if (pinnedPlan["type"].type() != mongo::String) {
+                return Status(ErrorCodes::BadValue, "pinnedPlan must have a string type");
+            }
+        }
+        else if (pinCachedPlan) {
+            PlanCacheEntry* entryRaw;
+            Status status = planCache->getEntry(*cq, &entryRaw);
+            if (!status.isOK()) {
+                return Status(ErrorCodes::BadValue,
+                              "pinCachedPlan requires a cached plan for the query shape");
+            }
+            scoped_ptr<PlanCacheEntry> entry(entryRaw);
+            invariant(!entry->plannerData.empty());
+            pinnedPlan = entry->plannerData[0]->toBSON();
+        }
+
         // Add allowed indices to query settings, overriding any previous entries.
-        querySettings->setAllowedIndices(*cq, indexes);
+        querySettings->setAllowedIndices(*cq, indexes, pinnedPlan);
 
         // Remove entry from plan cache.
         planCache->remove(*cq);
@@ -155,9 +155,15 @@ namespace mongo {
      *     query: <query>,
      *     sort: <sort>,
      *     projection: <projection>,
-     *     indexes: [ <index1>, <index2>, <index3>, ... ]
+     *     indexes: [ <index1>, <index2>, <index3>, ... ],
+     *     pinCachedPlan: <bool>,
+     *     pinnedPlan: <plan>
      * }
      *
+     * pinCachedPlan pins the plan currently cached for the query shape, and pinnedPlan pins a
+     * plan in the form planCacheListFilters reports it. Queries of a shape with a pinned plan
+     * are planned from it directly, with no enumeration or trial period, for as long as the
+     * indexes it uses exist and are allowed by the filter.
      */
     class SetFilter : public IndexFilterCommand {
     public:
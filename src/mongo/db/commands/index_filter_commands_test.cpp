@@ -329,4 +329,50 @@ namespace {
         ASSERT_FALSE(planCacheContains(planCache, "{b: 1}", "{}", "{}"));
     }
 
+    TEST(IndexFilterCommandsTest, SetFilterPinnedPlan) {
+        QuerySettings querySettings;
+        PlanCache planCache;
+        OperationContextNoop txn;
+
+        // Nothing cached for the shape yet, so there is no plan to pin.
+        ASSERT_NOT_OK(SetFilter::set(&txn, &querySettings, &planCache, ns,
+            fromjson("{query: {a: 1}, indexes: [{a: 1}], pinCachedPlan: true}")));
+        // pinnedPlan must be an object with a type.
+        ASSERT_NOT_OK(SetFilter::set(&txn, &querySettings, &planCache, ns,
+            fromjson("{query: {a: 1}, indexes: [{a: 1}], pinnedPlan: 1}")));
+        ASSERT_NOT_OK(SetFilter::set(&txn, &querySettings, &planCache, ns,
+            fromjson("{query: {a: 1}, indexes: [{a: 1}], pinnedPlan: {}}")));
+        ASSERT_TRUE(getFilters(querySettings).empty());
+
+        // Pinning the cached plan records its planner data with the filter.
+        addQueryShapeToPlanCache(&planCache, "{a: 1}", "{}", "{}");
+        ASSERT_OK(SetFilter::set(&txn, &querySettings, &planCache, ns,
+            fromjson("{query: {a: 1}, indexes: [{a: 1}], pinCachedPlan: true}")));
+        ASSERT_FALSE(planCacheContains(planCache, "{a: 1}", "{}", "{}"));
+        vector<BSONObj> filters = getFilters(querySettings);
+        ASSERT_EQUALS(filters.size(), 1U);
+        BSONObj pinnedPlan = filters[0].getObjectField("pinnedPlan");
+        ASSERT_EQUALS(pinnedPlan.getStringField("type"), std::string("indexTags"));
+
+        // The listed plan can be pinned again as is, and both ways of pinning are exclusive.
+        ASSERT_OK(SetFilter::set(&txn, &querySettings, &planCache, ns,
+            BSON("query" << BSON("b" << 1) << "indexes" << BSON_ARRAY(BSON("b" << 1))
+                 << "pinnedPlan" << pinnedPlan)));
+        ASSERT_NOT_OK(SetFilter::set(&txn, &querySettings, &planCache, ns,
+            BSON("query" << BSON("c" << 1) << "indexes" << BSON_ARRAY(BSON("c" << 1))
+                 << "pinnedPlan" << pinnedPlan << "pinCachedPlan" << true)));
+        filters = getFilters(querySettings);
+        ASSERT_EQUALS(filters.size(), 2U);
+
+        // A filter without a pinned plan lists none.
+        ASSERT_OK(SetFilter::set(&txn, &querySettings, &planCache, ns,
+                                 fromjson("{query: {a: 1}, indexes: [{a: 1}]}")));
+        filters = getFilters(querySettings);
+        for (size_t i = 0; i < filters.size(); ++i) {
+            if (filters[i].getObjectField("query") == fromjson("{a: 1}")) {
+                ASSERT_FALSE(filters[i].hasField("pinnedPlan"));
+            }
+        }
+    }
+
 }  // namespace
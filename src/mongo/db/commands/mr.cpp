@@ -35,6 +35,7 @@
 #include "mongo/db/commands/mr.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <pcrecpp.h>
 
 #include "mongo/client/connpool.h"
 #include "mongo/client/parallel.h"
@@ -49,11 +50,13 @@
 #include "mongo/db/instance.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/matcher/matcher.h"
+#include "mongo/db/memory_broker.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/range_preserver.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/storage_options.h"
@@ -134,16 +137,111 @@ namespace mongo {
             return b.obj();
         }
 
+        namespace {
+            // Set to false to always run reduce functions in JS
+            MONGO_EXPORT_SERVER_PARAMETER(internalMapReduceNativeSum, bool, true);
+
+            // An identifier in the patterns below. The patterns make sure the accumulator, the
+            // loop variable and the values argument are all different names.
+            const char* const kIdent = "([A-Za-z_$][\\w$]*)";
+
+            // function(key, values) { return Array.sum(values); }
+            const pcrecpp::RE arraySumPattern(
+                str::stream() << "^\\s*function\\s*\\(\\s*" << kIdent << "\\s*,\\s*" << kIdent
+                              << "\\s*\\)\\s*\\{\\s*return\\s+Array\\.sum\\s*\\(\\s*\\2\\s*\\)"
+                              << "\\s*;?\\s*\\}\\s*;?\\s*$");
+
+            // function(key, values) {
+            //     var total = 0;
+            //     for (var i = 0; i < values.length; i++) { total += values[i]; }
+            //     return total;
+            // }
+            const pcrecpp::RE forLoopSumPattern(
+                str::stream() << "^\\s*function\\s*\\(\\s*" << kIdent << "\\s*,\\s*" << kIdent
+                              << "\\s*\\)\\s*\\{\\s*var\\s+(?!\\2\\b)" << kIdent << "\\s*=\\s*0\\s*;"
+                              << "\\s*for\\s*\\(\\s*var\\s+(?!\\2\\b|\\3\\b)" << kIdent
+                              << "\\s*=\\s*0\\s*;"
+                              << "\\s*\\4\\s*<\\s*\\2\\s*\\.\\s*length\\s*;"
+                              << "\\s*(?:\\4\\s*\\+\\+|\\+\\+\\s*\\4)\\s*\\)"
+                              << "\\s*(\\{)?\\s*\\3\\s*\\+=\\s*\\2\\s*\\[\\s*\\4\\s*\\]\\s*;?"
+                              << "\\s*(?(5)\\})\\s*return\\s+\\3\\s*;?\\s*\\}\\s*;?\\s*$");
+
+            // function(key, values) {
+            //     var total = 0;
+            //     values.forEach(function(v) { total += v; });
+            //     return total;
+            // }
+            const pcrecpp::RE forEachSumPattern(
+                str::stream() << "^\\s*function\\s*\\(\\s*" << kIdent << "\\s*,\\s*" << kIdent
+                              << "\\s*\\)\\s*\\{\\s*var\\s+(?!\\2\\b)" << kIdent << "\\s*=\\s*0\\s*;"
+                              << "\\s*\\2\\s*\\.\\s*forEach\\s*\\(\\s*function\\s*\\(\\s*(?!\\3\\b)"
+                              << kIdent
+                              << "\\s*\\)\\s*\\{\\s*\\3\\s*\\+=\\s*\\4\\s*;?\\s*\\}\\s*\\)\\s*;?"
+                              << "\\s*return\\s+\\3\\s*;?\\s*\\}\\s*;?\\s*$");
+        }
+
+        JSReducer::JSReducer( const BSONElement& code )
+            : _func( "_reduce" , code ),
+              _isSum( isSumFunction( code ) ) {
+        }
+
+        bool JSReducer::isSumFunction( const BSONElement& code ) {
+            if ( code.type() == CodeWScope && !code.codeWScopeObject().isEmpty() ) {
+                // the scope could change what the names in the function refer to
+                return false;
+            }
+            if ( code.type() != Code && code.type() != CodeWScope && code.type() != String ) {
+                return false;
+            }
+
+            const std::string source = code._asCode();
+            return arraySumPattern.FullMatch( source ) ||
+                   forLoopSumPattern.FullMatch( source ) ||
+                   forEachSumPattern.FullMatch( source );
+        }
+
         void JSReducer::init( State * state ) {
             _func.init( state );
         }
 
+        bool JSReducer::_sumNatively( const BSONList& tuples,
+                                      const StringData& keyField,
+                                      const StringData& valueField,
+                                      BSONObjBuilder* out ) {
+            if ( !_isSum || !internalMapReduceNativeSum ) {
+                return false;
+            }
+
+            // JS numbers are doubles, so this adds up in the same order and with the same
+            // rounding as the JS function. NumberLongs are objects in JS and are left to it.
+            double total = 0;
+            for ( unsigned i = 0; i < tuples.size(); i++ ) {
+                BSONObjIterator it( tuples[i] );
+                it.next();
+                const BSONElement value = it.next();
+                if ( value.type() != NumberInt && value.type() != NumberDouble ) {
+                    return false;
+                }
+                total += value.numberDouble();
+            }
+
+            ++numReduces;
+            out->appendAs( tuples[0].firstElement() , keyField );
+            out->append( valueField , total );
+            return true;
+        }
+
         /**
          * Reduces a list of tuple objects (key, value) to a single tuple {"0": key, "1": value}
          */
         BSONObj JSReducer::reduce( const BSONList& tuples ) {
             if (tuples.size() <= 1)
                 return tuples[0];
+
+            BSONObjBuilder sum;
+            if ( _sumNatively( tuples , "0" , "1" , &sum ) )
+                return sum.obj();
+
             BSONObj key;
             int endSizeEstimate = 16;
             _reduce( tuples , key , endSizeEstimate );
@@ -162,6 +260,7 @@ namespace mongo {
 
             BSONObj res;
             BSONObj key;
+            BSONObjBuilder sum;
 
             if (tuples.size() == 1) {
                 // 1 obj, just use it
@@ -172,6 +271,9 @@ namespace mongo {
                 b.appendAs( it.next() , "value" );
                 res = b.obj();
             }
+            else if ( _sumNatively( tuples , "_id" , "value" , &sum ) ) {
+                res = sum.obj();
+            }
             else {
                 // need to reduce
                 int endSizeEstimate = 16;
@@ -1279,6 +1381,9 @@ namespace mongo {
 
                 uassert( 16149 , "cannot run map reduce without the js engine", globalScriptEngine );
 
+                // Don't start buffering more while the server is short of memory
+                MemoryBroker::waitForAdmission(txn);
+
                 CollectionMetadataPtr collMetadata;
 
                 // Prevent sharding state from changing during the MR.
@@ -129,14 +129,30 @@ namespace mongo {
 
         class JSReducer : public Reducer {
         public:
-            JSReducer( const BSONElement& code ) : _func( "_reduce" , code ) {}
+            JSReducer( const BSONElement& code );
             virtual void init( State * state );
 
             virtual BSONObj reduce( const BSONList& tuples );
             virtual BSONObj finalReduce( const BSONList& tuples , Finalizer * finalizer );
 
+            /**
+             * Returns true if 'code' is a reduce function that only sums its values, such as
+             * function(key, values) { return Array.sum(values); }
+             */
+            static bool isSumFunction( const BSONElement& code );
+
         private:
 
+            /**
+             * Sums the values of 'tuples' without calling into JS, producing the same double the
+             * JS reduce function would. Returns false, leaving 'out' alone, unless this reducer is
+             * a sum function and every value is an int or a double.
+             */
+            bool _sumNatively( const BSONList& tuples,
+                               const StringData& keyField,
+                               const StringData& valueField,
+                               BSONObjBuilder* out );
+
             /**
              * result in "__returnValue"
              * @param key OUT
@@ -145,6 +161,7 @@ namespace mongo {
             void _reduce( const BSONList& values , BSONObj& key , int& endSizeEstimate );
 
             JSFunction _func;
+            const bool _isSum;
         };
 
         class JSFinalizer : public Finalizer  {
@@ -134,6 +134,11 @@ namespace mongo {
                 mis->addIterator(iterators.releaseAt(i));
             }
 
+            // A reader that works through the cursors at its own pace, like initial sync, can ask
+            // for them not to be timed out while they wait their turn.
+            const int cursorOptions =
+                cmdObj["noCursorTimeout"].trueValue() ? QueryOption_NoCursorTimeout : 0;
+
             {
                 BSONArrayBuilder bucketsBuilder;
                 for (size_t i = 0; i < execs.size(); i++) {
@@ -141,7 +146,8 @@ namespace mongo {
                     // lifetime).
                     ClientCursor* cc = new ClientCursor( collection->getCursorManager(),
                                                          execs.releaseAt(i),
-                                                         ns.ns() );
+                                                         ns.ns(),
+                                                         cursorOptions );
 
                     BSONObjBuilder threadResult;
                     appendCursorResponseObject( cc->cursorid(),
@@ -41,6 +41,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/exec/pipeline_proxy.h"
 #include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/memory_broker.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source.h"
@@ -82,7 +83,11 @@ namespace mongo {
 
         const long long defaultBatchSize = 101; // Same as query.
         long long batchSize;
-        uassertStatusOK(Command::parseCommandCursorOptions(cmdObj, defaultBatchSize, &batchSize));
+        bool exhaust;
+        uassertStatusOK(Command::parseCommandCursorOptions(cmdObj,
+                                                           defaultBatchSize,
+                                                           &batchSize,
+                                                           &exhaust));
 
         // can't use result BSONObjBuilder directly since it won't handle exceptions correctly.
         BSONArrayBuilder resultsArray;
@@ -190,6 +195,21 @@ namespace mongo {
             if (!pPipeline.get())
                 return false;
 
+            // Don't start buffering more while the server is short of memory
+            MemoryBroker::waitForAdmission(txn);
+
+            // With cursor.exhaust set, getMores on the resulting cursor stream all remaining
+            // batches back to back, the same as a query sent with QueryOption_Exhaust.
+            long long batchSize;
+            bool exhaust;
+            Status cursorStatus = Command::parseCommandCursorOptions(cmdObj,
+                                                                     0,
+                                                                     &batchSize,
+                                                                     &exhaust);
+            if (!cursorStatus.isOK()) {
+                return appendCommandStatus(result, cursorStatus);
+            }
+
 #if _DEBUG
             // This is outside of the if block to keep the object alive until the pipeline is finished.
             BSONObj parsed;
@@ -266,7 +286,7 @@ namespace mongo {
                     ClientCursor* cursor = new ClientCursor(collection->getCursorManager(),
                                                             execHolder.release(),
                                                             nss.ns(),
-                                                            0,
+                                                            exhaust ? QueryOption_Exhaust : 0,
                                                             BSONObj(),
                                                             isAggCursor);
                     pin.reset(new ClientCursorPin(collection->getCursorManager(),
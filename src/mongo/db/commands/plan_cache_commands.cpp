@@ -104,6 +104,7 @@ namespace {
         new PlanCacheListQueryShapes();
         new PlanCacheClear();
         new PlanCacheListPlans();
+        new PlanCacheShapeStats();
 
         return Status::OK();
     }
@@ -443,4 +444,43 @@ namespace mongo {
         return Status::OK();
     }
 
+    PlanCacheShapeStats::PlanCacheShapeStats() : PlanCacheCommand("planCacheShapeStats",
+        "Displays cumulative execution statistics for each query shape in a collection.",
+        ActionType::planCacheRead) { }
+
+    Status PlanCacheShapeStats::runPlanCacheCommand(OperationContext* txn,
+                                                    const string& ns,
+                                                    BSONObj& cmdObj,
+                                                    BSONObjBuilder* bob) {
+        // The shape statistics are owned by the collection.
+        AutoGetCollectionForRead ctx(txn, ns);
+
+        Collection* collection = ctx.getCollection();
+        if (NULL == collection) {
+            // No collection - return results with empty shapes array.
+            BSONArrayBuilder arrayBuilder(bob->subarrayStart("shapes"));
+            arrayBuilder.doneFast();
+            return Status::OK();
+        }
+        return list(*collection->infoCache()->getQueryShapeStats(), bob);
+    }
+
+    // static
+    Status PlanCacheShapeStats::list(const QueryShapeStats& shapeStats, BSONObjBuilder* bob) {
+        invariant(bob);
+
+        const vector<QueryShapeStatsEntry> entries = shapeStats.getAllEntries();
+
+        BSONArrayBuilder arrayBuilder(bob->subarrayStart("shapes"));
+        for (vector<QueryShapeStatsEntry>::const_iterator i = entries.begin();
+             i != entries.end(); ++i) {
+            BSONObjBuilder shapeBuilder(arrayBuilder.subobjStart());
+            i->toBSON(&shapeBuilder);
+            shapeBuilder.doneFast();
+        }
+        arrayBuilder.doneFast();
+
+        return Status::OK();
+    }
+
 } // namespace mongo
@@ -30,6 +30,7 @@
 
 #include "mongo/db/commands.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/query_shape_stats.h"
 
 namespace mongo {
 
@@ -180,4 +181,25 @@ namespace mongo {
                            BSONObjBuilder* bob);
     };
 
+    /**
+     * planCacheShapeStats
+     *
+     * { planCacheShapeStats: <collection> }
+     *
+     */
+    class PlanCacheShapeStats : public PlanCacheCommand {
+    public:
+        PlanCacheShapeStats();
+        virtual Status runPlanCacheCommand(OperationContext* txn,
+                                           const std::string& ns,
+                                           BSONObj& cmdObj,
+                                           BSONObjBuilder* bob);
+
+        /**
+         * Appends the execution statistics of every query shape in 'shapeStats', most
+         * recently executed first.
+         */
+        static Status list(const QueryShapeStats& shapeStats, BSONObjBuilder* bob);
+    };
+
 }  // namespace mongo
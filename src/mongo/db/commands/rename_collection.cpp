@@ -45,6 +45,7 @@
 #include "mongo/db/ops/insert.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/util/progress_meter.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -53,6 +54,14 @@ namespace mongo {
     using std::string;
     using std::stringstream;
 
+namespace {
+
+    // Documents copied per unit of work when renaming across databases.
+    const size_t kRenameBatchMaxDocs = 1000;
+    const size_t kRenameBatchMaxBytes = 16 * 1024 * 1024;
+
+}  // namespace
+
     class CmdRenameCollection : public Command {
     public:
         CmdRenameCollection() : Command( "renameCollection" ) {}
@@ -284,6 +293,62 @@ namespace mongo {
             // Dismissed on success
             ScopeGuard targetCollectionDropper = MakeGuard(dropCollection, txn, targetDB, target);
 
+            {
+                // Copy over all the data from source collection to target collection, a batch of
+                // documents per unit of work.  The target has no indexes yet, so this only writes
+                // records.
+                ProgressMeterHolder progress(*txn->setMessage("renameCollection: copying documents",
+                                                              "Rename Progress",
+                                                              sourceColl->numRecords(txn)));
+
+                const bool capped = targetColl->isCapped();
+                std::vector<BSONObj> batch;
+                size_t batchBytes = 0;
+
+                boost::scoped_ptr<RecordIterator> sourceIt(sourceColl->getIterator(txn));
+                while (!sourceIt->isEOF() || !batch.empty()) {
+                    if (!sourceIt->isEOF()) {
+                        txn->checkForInterrupt();
+
+                        const BSONObj obj = sourceColl->docFor(txn, sourceIt->getNext());
+                        batch.push_back(obj);
+                        batchBytes += obj.objsize();
+                        progress.hit();
+
+                        if (batch.size() < kRenameBatchMaxDocs &&
+                                batchBytes < kRenameBatchMaxBytes && !sourceIt->isEOF()) {
+                            continue;
+                        }
+                    }
+
+                    WriteUnitOfWork wunit(txn);
+                    // No logOp necessary because the entire renameCollection command is one logOp.
+                    if (capped) {
+                        // A capped collection may delete a record inserted earlier in the batch,
+                        // which insertDocuments() does not allow.
+                        for (size_t i = 0; i < batch.size(); i++) {
+                            Status status =
+                                targetColl->insertDocument(txn, batch[i], true).getStatus();
+                            if (!status.isOK())
+                                return appendCommandStatus(result, status);
+                        }
+                    }
+                    else {
+                        Status status = targetColl->insertDocuments(txn, batch, true);
+                        if (!status.isOK())
+                            return appendCommandStatus(result, status);
+                    }
+                    wunit.commit();
+
+                    batch.clear();
+                    batchBytes = 0;
+                }
+
+                progress.finished();
+            }
+
+            // Build every index of the source at once, from a scan of the target through the
+            // external sorter, rather than maintaining them while the documents were copied.
             MultiIndexBlock indexer(txn, targetColl);
             indexer.allowInterruption();
 
@@ -301,27 +366,13 @@ namespace mongo {
                     newIndex.appendElementsUnique(currIndex);
                     indexesToCopy.push_back(newIndex.obj());
                 }
-                indexer.init(indexesToCopy);
-            }
-
-            {
-                // Copy over all the data from source collection to target collection.
-                boost::scoped_ptr<RecordIterator> sourceIt(sourceColl->getIterator(txn));
-                while (!sourceIt->isEOF()) {
-                    txn->checkForInterrupt();
 
-                    const BSONObj obj = sourceColl->docFor(txn, sourceIt->getNext());
-
-                    WriteUnitOfWork wunit(txn);
-                    // No logOp necessary because the entire renameCollection command is one logOp.
-                    Status status = targetColl->insertDocument(txn, obj, &indexer, true).getStatus();
-                    if (!status.isOK())
-                        return appendCommandStatus(result, status);
-                    wunit.commit();
-                }
+                Status status = indexer.init(indexesToCopy);
+                if (!status.isOK())
+                    return appendCommandStatus(result, status);
             }
 
-            Status status = indexer.doneInserting();
+            Status status = indexer.insertAllDocumentsInCollection();
             if (!status.isOK())
                 return appendCommandStatus(result, status);
 
@@ -42,8 +42,10 @@
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_internal.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/memory_broker.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/platform/process_id.h"
+#include "mongo/util/huge_pages.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/ssl_manager.h"
@@ -216,6 +218,8 @@ namespace mongo {
                 bb.append( "current" , Listener::globalTicketHolder.used() );
                 bb.append( "available" , Listener::globalTicketHolder.available() );
                 bb.append( "totalCreated" , Listener::globalConnectionNumber.load() );
+                bb.append( "acceptBatches" , Listener::globalAcceptBatches.load() );
+                bb.append( "acceptMicros" , Listener::globalAcceptMicros.load() );
                 return bb.obj();
             }
 
@@ -276,6 +280,36 @@ namespace mongo {
                 
         } network;
 
+        class HugePagesSection : public ServerStatusSection {
+        public:
+            HugePagesSection() : ServerStatusSection( "hugePages" ){}
+            virtual bool includeByDefault() const { return true; }
+
+            BSONObj generateSection(OperationContext* txn,
+                                    const BSONElement& configElement) const {
+
+                BSONObjBuilder b;
+                HugePages::appendStats(&b);
+                return b.obj();
+            }
+
+        } hugePages;
+
+        class MemoryBrokerSection : public ServerStatusSection {
+        public:
+            MemoryBrokerSection() : ServerStatusSection( "memoryBroker" ){}
+            virtual bool includeByDefault() const { return true; }
+
+            BSONObj generateSection(OperationContext* txn,
+                                    const BSONElement& configElement) const {
+
+                BSONObjBuilder b;
+                MemoryBroker::appendStats(&b);
+                return b.obj();
+            }
+
+        } memoryBroker;
+
 #ifdef MONGO_SSL
         class Security : public ServerStatusSection {
         public:
@@ -284,12 +318,14 @@ namespace mongo {
 
             BSONObj generateSection(OperationContext* txn,
                                     const BSONElement& configElement) const {
-                BSONObj result;
+                BSONObjBuilder result;
                 if (getSSLManager()) {
-                    result = getSSLManager()->getSSLConfiguration().getServerStatusBSON();
+                    result.appendElements(
+                        getSSLManager()->getSSLConfiguration().getServerStatusBSON());
+                    result.append("SSLHandshakes", getSSLManager()->getHandshakeStatsBSON());
                 }
 
-                return result;
+                return result.obj();
             }
         } security;
 #endif
@@ -32,6 +32,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -63,8 +64,10 @@ namespace mongo {
         virtual void help( stringstream& help ) const {
             help << "touch collection\n"
                 "Page in all pages of memory containing every extent for the given collection\n"
-                "{ touch : <collection_name>, [data : true] , [index : true] }\n"
-                " at least one of data or index must be true; default is both are false\n";
+                "{ touch : <collection_name>, [data : true] , [index : true],"
+                " [indexes : [<index_name>, ...]] }\n"
+                " at least one of data or index must be true; default is both are false\n"
+                " indexes limits index : true to the named indexes, e.g. [\"_id_\"]\n";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -98,6 +101,25 @@ namespace mongo {
                 return false;
             }
 
+            std::set<std::string> indexNames;
+            BSONElement indexesElt = cmdObj["indexes"];
+            if ( !indexesElt.eoo() ) {
+                if ( indexesElt.type() != Array ) {
+                    errmsg = "indexes must be an array of index names";
+                    return false;
+                }
+                BSONObjIterator it( indexesElt.Obj() );
+                while ( it.more() ) {
+                    BSONElement e = it.next();
+                    if ( e.type() != String ) {
+                        errmsg = "indexes must be an array of index names";
+                        return false;
+                    }
+                    indexNames.insert( e.String() );
+                }
+                touch_indexes = true;
+            }
+
             AutoGetCollectionForRead context(txn, nss);
 
             Collection* collection = context.getCollection();
@@ -109,6 +131,7 @@ namespace mongo {
             return appendCommandStatus( result,
                                         collection->touch( txn,
                                                            touch_data, touch_indexes,
+                                                           indexNames,
                                                            &result ) );
         }
 
@@ -36,6 +36,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_validate_online.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -53,7 +54,9 @@ namespace mongo {
         }
 
         virtual void help(stringstream& h) const { h << "Validate contents of a namespace by scanning its data structures for correctness.  Slow.\n"
-                                                        "Add full:true option to do a more thorough check"; }
+                                                        "Add full:true option to do a more thorough check\n"
+                                                        "Add online:true to check the records against the indexes without blocking writes,\n"
+                                                        "throttled by maxItemsPerSecond:<n> if given"; }
 
         virtual bool isWriteCommandForConfigServer() const { return false; }
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -63,7 +66,8 @@ namespace mongo {
             actions.addAction(ActionType::validate);
             out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
         }
-        //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool> } */
+        //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool>]
+        //  [, online: <bool> [, maxItemsPerSecond: <n>]] } */
 
         bool run(OperationContext* txn, const string& dbname , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
             string ns = dbname + "." + cmdObj.firstElement().valuestrsafe();
@@ -81,6 +85,32 @@ namespace mongo {
                 LOG(0) << "CMD: validate " << ns << endl;
             }
 
+            if ( cmdObj["online"].trueValue() ) {
+                if ( full ) {
+                    errmsg = "full and online validation can't co-exist";
+                    return false;
+                }
+
+                OnlineValidateOptions options;
+                options.maxItemsPerSecond = cmdObj["maxItemsPerSecond"].safeNumberLong();
+
+                result.append( "ns", ns );
+
+                ValidateResults results;
+                Status status = validateCollectionOnline( txn, ns, options, &results, &result );
+                if ( !status.isOK() )
+                    return appendCommandStatus( result, status );
+
+                result.appendBool("valid", results.valid);
+                result.append("errors", results.errors);
+
+                if ( !results.valid ) {
+                    result.append("advice", "ns corrupt. See http://dochub.mongodb.org/core/data-recovery");
+                }
+
+                return true;
+            }
+
             AutoGetCollectionForRead ctx(txn, ns_string.ns());
 
             Collection* collection = ctx.getCollection();
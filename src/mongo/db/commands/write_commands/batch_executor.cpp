@@ -828,6 +828,29 @@ namespace mongo {
         }
     }
 
+    // A group of inserts stops at whichever of these limits comes first
+    static const size_t kMaxInsertGroupDocs = 64;
+    static const int kMaxInsertGroupBytes = 256 * 1024;
+
+    // Returns the end of the run of valid documents, starting at state.currIndex, that can be
+    // inserted as a group
+    static size_t insertGroupEnd(const WriteBatchExecutor::ExecInsertsState& state) {
+        if (state.request->isInsertIndexRequest()) {
+            return state.currIndex;
+        }
+
+        size_t end = state.currIndex;
+        int bytes = 0;
+        while (end < state.normalizedInserts.size()
+               && end - state.currIndex < kMaxInsertGroupDocs
+               && bytes < kMaxInsertGroupBytes
+               && state.normalizedInserts[end].isOK()) {
+            bytes += state.request->getInsertRequest()->getDocumentsAt(end).objsize();
+            ++end;
+        }
+        return end;
+    }
+
     void WriteBatchExecutor::execInserts( const BatchedCommandRequest& request,
                                           std::vector<WriteErrorDetail*>* errors ) {
 
@@ -850,9 +873,16 @@ namespace mongo {
         // particularly on operation interruption.  These kinds of errors necessarily prevent
         // further insertOne calls, and stop the batch.  As a result, the only expected source of
         // such exceptions are interruptions.
+        //
+        // Runs of valid documents are first tried as a group in one unit of work, see
+        // execInsertGroup().  A group that fails is redone with insertOne(), so that errors are
+        // reported exactly as if the documents had been inserted one at a time.
         ExecInsertsState state(_txn, &request);
         normalizeInserts(request, &state.normalizedInserts);
 
+        // Documents before this index are inserted one at a time
+        size_t oneAtATimeUntil = 0;
+
         // Yield frequency is based on the same constants used by PlanYieldPolicy.
         ElapsedTracker elapsedTracker(internalQueryExecYieldIterations,
                                       internalQueryExecYieldPeriodMS);
@@ -878,6 +908,17 @@ namespace mongo {
                 elapsedTracker.resetLastTime();
             }
 
+            if (state.currIndex >= oneAtATimeUntil) {
+                const size_t groupEnd = insertGroupEnd(state);
+                if (groupEnd > state.currIndex + 1) {
+                    if (execInsertGroup(&state, groupEnd)) {
+                        state.currIndex = groupEnd - 1;
+                        continue;
+                    }
+                    oneAtATimeUntil = groupEnd;
+                }
+            }
+
             WriteErrorDetail* error = NULL;
             execOneInsert(&state, &error);
             if (error) {
@@ -1101,6 +1142,60 @@ namespace mongo {
         }
     }
 
+    bool WriteBatchExecutor::execInsertGroup(ExecInsertsState* state, size_t groupEnd) {
+        // Lock errors are reported by the one at a time path
+        WriteOpResult lockResult;
+        if (!state->lockAndCheck(&lockResult)) {
+            return false;
+        }
+
+        Collection* collection = state->getCollection();
+        if (collection->isCapped()) {
+            return false;
+        }
+
+        vector<BSONObj> docs;
+        docs.reserve(groupEnd - state->currIndex);
+        for (size_t i = state->currIndex; i < groupEnd; ++i) {
+            const BSONObj& normalized = state->normalizedInserts[i].getValue();
+            docs.push_back(normalized.isEmpty() ?
+                           state->request->getInsertRequest()->getDocumentsAt(i) : normalized);
+        }
+
+        const string& insertNS = collection->ns().ns();
+        invariant(_txn->lockState()->isCollectionLockedForMode(insertNS, MODE_IX));
+
+        try {
+            WriteUnitOfWork wunit(_txn);
+            if (!collection->insertDocuments(_txn, docs, true).isOK()) {
+                return false;
+            }
+            repl::logInsertOps(_txn, insertNS.c_str(), docs);
+            wunit.commit();
+        }
+        catch (const DBException& ex) {
+            Status status(ex.toStatus());
+            if (ErrorCodes::isInterruption(status.code()))
+                throw;
+            return false;
+        }
+
+        // Each document still counts as its own operation
+        for (size_t i = state->currIndex; i < groupEnd; ++i) {
+            BatchItemRef currInsertItem(state->request, i);
+            CurOp currentOp( _txn->getClient(), _txn->getClient()->curop() );
+            beginCurrentOp( &currentOp, _txn->getClient(), currInsertItem );
+            incOpStats(currInsertItem);
+
+            WriteOpResult result;
+            result.getStats().n = 1;
+            incWriteStats(currInsertItem, result.getStats(), NULL, &currentOp);
+            finishCurrentOp(_txn, &currentOp, NULL);
+        }
+
+        return true;
+    }
+
     /**
      * Perform a single insert into a collection.  Requires the insert be preprocessed and the
      * collection already has been created.
@@ -104,6 +104,14 @@ namespace mongo {
          */
         void execOneInsert( ExecInsertsState* state, WriteErrorDetail** error );
 
+        /**
+         * Inserts the documents from state->currIndex up to, but excluding, "groupEnd" in a
+         * single unit of work.  Returns false, without having inserted any of them, if the group
+         * can't be inserted as a whole; the caller then inserts them one at a time so that each
+         * gets its own result.
+         */
+        bool execInsertGroup( ExecInsertsState* state, size_t groupEnd );
+
         /**
          * Executes an update item (which may update many documents or upsert), and returns the
          * upserted _id on upsert or error on failure.
@@ -32,6 +32,7 @@
 
 #include <string>
 
+#include "mongo/db/concurrency/lock_contention_profiler.h"
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/db/global_environment_experiment.h"
 #include "mongo/db/namespace_string.h"
@@ -174,6 +175,8 @@ namespace mongo {
         else {
             _lockState->lock(_id, isRead ? MODE_S : MODE_X);
         }
+
+        LockContentionProfiler::global.nameIfContended(_id, db);
     }
 
     Lock::DBLock::~DBLock() {
@@ -218,6 +221,8 @@ namespace mongo {
         } else if (enableCollectionLocking) {
             _lockState->lock(_id, isRead ? MODE_S : MODE_X);
         }
+
+        LockContentionProfiler::global.nameIfContended(_id, ns);
     }
 
     Lock::CollectionLock::~CollectionLock() {
@@ -0,0 +1,235 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/concurrency/lock_contention_profiler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    // Whether lock waits are recorded per resource. The cost is only paid by acquisitions which
+    // already had to wait, so it is on by default.
+    MONGO_EXPORT_SERVER_PARAMETER(lockContentionProfiling, bool, true);
+
+namespace {
+
+#if defined(MONGO_HAVE___THREAD)
+    __thread uint64_t lastContendedResource = 0;
+#elif defined(MONGO_HAVE___DECLSPEC_THREAD)
+    __declspec( thread ) uint64_t lastContendedResource = 0;
+#endif
+
+    void setLastContendedResource(ResourceId resId) {
+#if defined(MONGO_HAVE___THREAD) || defined(MONGO_HAVE___DECLSPEC_THREAD)
+        lastContendedResource = resId;
+#endif
+    }
+
+    /**
+     * Returns true, and forgets the resource, if 'resId' was the last one the calling thread
+     * waited for. Without thread local storage resources stay unnamed.
+     */
+    bool takeLastContendedResource(ResourceId resId) {
+#if defined(MONGO_HAVE___THREAD) || defined(MONGO_HAVE___DECLSPEC_THREAD)
+        if (lastContendedResource != resId) {
+            return false;
+        }
+        lastContendedResource = 0;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Orders by descending total wait time.
+    bool moreContended(const std::pair<long long, ResourceId>& lhs,
+                       const std::pair<long long, ResourceId>& rhs) {
+        return lhs.first > rhs.first;
+    }
+
+} // namespace
+
+    LockContentionProfiler LockContentionProfiler::global;
+
+    LockContentionProfiler::ContendedResource::ContendedResource() : totalWaitMicros(0) {
+        for (int mode = 0; mode < LockModesCount; mode++) {
+            waits[mode] = 0;
+        }
+    }
+
+    LockContentionProfiler::LockContentionProfiler() { }
+
+    LockContentionProfiler::~LockContentionProfiler() {
+        reset();
+    }
+
+    void LockContentionProfiler::recordWait(ResourceId resId,
+                                            LockMode mode,
+                                            uint64_t waitMicros) {
+        if (!lockContentionProfiling) {
+            return;
+        }
+
+        Partition& partition = _getPartition(resId);
+        SimpleMutex::scoped_lock lk(partition.mutex);
+
+        ResourceMap::iterator it = partition.resources.find(resId);
+        if (it == partition.resources.end()) {
+            if (partition.resources.size() >= MaxResourcesPerPartition) {
+                partition.untrackedWaits++;
+                return;
+            }
+            it = partition.resources.insert(
+                    ResourceMap::value_type(resId, new ContendedResource())).first;
+        }
+
+        ContendedResource* resource = it->second;
+        resource->waits[mode]++;
+        resource->totalWaitMicros += waitMicros;
+        resource->histogram.record(waitMicros);
+
+        if (resource->name.empty()) {
+            setLastContendedResource(resId);
+        }
+    }
+
+    void LockContentionProfiler::nameIfContended(ResourceId resId, const StringData& name) {
+        if (!takeLastContendedResource(resId)) {
+            return;
+        }
+
+        Partition& partition = _getPartition(resId);
+        SimpleMutex::scoped_lock lk(partition.mutex);
+
+        ResourceMap::iterator it = partition.resources.find(resId);
+        if (it != partition.resources.end() && it->second->name.empty()) {
+            it->second->name = name.toString();
+        }
+    }
+
+    void LockContentionProfiler::report(BSONObjBuilder* builder, size_t topN) const {
+        // Rank without holding more than one partition lock at a time, then look the winners up
+        // again. A resource reset in between is simply left out.
+        std::vector<std::pair<long long, ResourceId> > ranked;
+        long long untrackedWaits = 0;
+        for (int i = 0; i < NumPartitions; i++) {
+            Partition& partition = _partitions[i];
+            SimpleMutex::scoped_lock lk(partition.mutex);
+
+            untrackedWaits += partition.untrackedWaits;
+            for (ResourceMap::const_iterator it = partition.resources.begin();
+                 it != partition.resources.end();
+                 ++it) {
+                ranked.push_back(std::make_pair(it->second->totalWaitMicros, it->first));
+            }
+        }
+
+        const size_t numReported = std::min(topN, ranked.size());
+        std::partial_sort(ranked.begin(),
+                          ranked.begin() + numReported,
+                          ranked.end(),
+                          moreContended);
+
+        BSONArrayBuilder resources(builder->subarrayStart("resources"));
+        for (size_t i = 0; i < numReported; i++) {
+            const ResourceId resId = ranked[i].second;
+            Partition& partition = _getPartition(resId);
+            SimpleMutex::scoped_lock lk(partition.mutex);
+
+            ResourceMap::const_iterator it = partition.resources.find(resId);
+            if (it == partition.resources.end()) {
+                continue;
+            }
+
+            BSONObjBuilder resourceBuilder(resources.subobjStart());
+            _append(&resourceBuilder, resId, *it->second);
+            resourceBuilder.done();
+        }
+        resources.done();
+
+        builder->appendNumber("trackedResources", static_cast<long long>(ranked.size()));
+        builder->appendNumber("untrackedWaits", untrackedWaits);
+    }
+
+    void LockContentionProfiler::reset() {
+        for (int i = 0; i < NumPartitions; i++) {
+            Partition& partition = _partitions[i];
+            SimpleMutex::scoped_lock lk(partition.mutex);
+
+            for (ResourceMap::iterator it = partition.resources.begin();
+                 it != partition.resources.end();
+                 ++it) {
+                delete it->second;
+            }
+            partition.resources.clear();
+            partition.untrackedWaits = 0;
+        }
+    }
+
+    LockContentionProfiler::Partition& LockContentionProfiler::_getPartition(
+                                                                    ResourceId resId) const {
+        // The low bits of the id come from the name hash, the type lives in the top bits.
+        return _partitions[resId.getHashId() % NumPartitions];
+    }
+
+    void LockContentionProfiler::_append(BSONObjBuilder* builder,
+                                         ResourceId resId,
+                                         const ContendedResource& resource) {
+        builder->append("type", resourceTypeName(resId.getType()));
+        if (resource.name.empty()) {
+            builder->append("resource", resId.toString());
+        }
+        else {
+            builder->append("name", resource.name);
+        }
+
+        // All indexing below starts from offset 1, because position 0 is MODE_NONE.
+        {
+            BSONObjBuilder waits(builder->subobjStart("waitCount"));
+            for (int mode = 1; mode < LockModesCount; mode++) {
+                if (resource.waits[mode] > 0) {
+                    waits.appendNumber(legacyModeName(static_cast<LockMode>(mode)),
+                                       resource.waits[mode]);
+                }
+            }
+            waits.done();
+        }
+
+        BSONObjBuilder histogram(builder->subobjStart("waitMicros"));
+        resource.histogram.append(&histogram);
+        histogram.done();
+    }
+
+} // namespace mongo
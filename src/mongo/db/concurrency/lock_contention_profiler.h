@@ -0,0 +1,113 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/concurrency/lock_manager_defs.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Keeps a wait time histogram for each resource whose lock acquisitions have had to wait,
+     * so that the most contended databases and collections can be found.
+     *
+     * Only acquisitions which actually waited are recorded. Uncontended ones cost nothing, which
+     * keeps the profiler cheap enough to leave on (see the lockContentionProfiling parameter).
+     * The number of tracked resources is bounded; waits on resources past the bound are only
+     * counted.
+     */
+    class LockContentionProfiler {
+        MONGO_DISALLOW_COPYING(LockContentionProfiler);
+    public:
+        LockContentionProfiler();
+        ~LockContentionProfiler();
+
+        /**
+         * Records that an acquisition of 'resId' in 'mode' waited for 'waitMicros', whether or
+         * not it was granted in the end. Remembers 'resId' as the last contended resource of the
+         * calling thread, for nameIfContended().
+         */
+        void recordWait(ResourceId resId, LockMode mode, uint64_t waitMicros);
+
+        /**
+         * Resource ids are hashes, so the names are supplied by the callers which have them,
+         * right after acquiring the lock. Cheap unless the calling thread's previous wait was
+         * on 'resId' and the resource has not been named yet.
+         */
+        void nameIfContended(ResourceId resId, const StringData& name);
+
+        /**
+         * Appends the 'topN' resources with the largest total wait time, most contended first,
+         * along with the number of waits on untracked resources.
+         */
+        void report(BSONObjBuilder* builder, size_t topN) const;
+
+        void reset();
+
+        static LockContentionProfiler global;
+
+    private:
+        struct ContendedResource {
+            ContendedResource();
+
+            std::string name;
+            long long totalWaitMicros;
+            long long waits[LockModesCount];
+            LatencyHistogram histogram;
+        };
+
+        typedef unordered_map<ResourceId, ContendedResource*> ResourceMap;
+
+        struct Partition {
+            Partition() : mutex("LockContentionProfiler"), untrackedWaits(0) { }
+            SimpleMutex mutex;
+            ResourceMap resources;
+            long long untrackedWaits;
+        };
+
+        Partition& _getPartition(ResourceId resId) const;
+
+        static void _append(BSONObjBuilder* builder,
+                            ResourceId resId,
+                            const ContendedResource& resource);
+
+        enum { NumPartitions = 16, MaxResourcesPerPartition = 64 };
+
+        mutable Partition _partitions[NumPartitions];
+    };
+
+} // namespace mongo
@@ -0,0 +1,145 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/concurrency/lock_contention_profiler.h"
+#include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    std::vector<BSONElement> reportedResources(const LockContentionProfiler& profiler,
+                                               size_t topN,
+                                               BSONObj* report) {
+        BSONObjBuilder builder;
+        profiler.report(&builder, topN);
+        *report = builder.obj();
+        return (*report)["resources"].Array();
+    }
+
+    TEST(LockContentionProfiler, RecordsOnlyWaits) {
+        const ResourceId resId(RESOURCE_COLLECTION, std::string("Profiler.RecordsOnlyWaits"));
+        LockContentionProfiler::global.reset();
+
+        LockerForTests locker(MODE_IX);
+        locker.lock(resId, MODE_X);
+
+        BSONObj report;
+        ASSERT_EQUALS(0U, reportedResources(LockContentionProfiler::global, 10, &report).size());
+
+        {
+            LockerForTests lockerConflict(MODE_IX);
+            ASSERT_EQUALS(LOCK_WAITING, lockerConflict.lockBegin(resId, MODE_S));
+            ASSERT_EQUALS(LOCK_TIMEOUT, lockerConflict.lockComplete(resId, MODE_S, 1, false));
+        }
+
+        locker.unlock(resId);
+
+        std::vector<BSONElement> resources =
+            reportedResources(LockContentionProfiler::global, 10, &report);
+        ASSERT_EQUALS(1U, resources.size());
+
+        const BSONObj resource = resources[0].Obj();
+        ASSERT_EQUALS(std::string("Collection"), resource["type"].String());
+        ASSERT_EQUALS(resId.toString(), resource["resource"].String());
+        ASSERT_EQUALS(1, resource["waitCount"]["R"].numberLong());
+        ASSERT_EQUALS(1, resource["waitMicros"]["count"].numberLong());
+        ASSERT_GREATER_THAN(resource["waitMicros"]["totalMicros"].numberLong(), 0);
+    }
+
+    TEST(LockContentionProfiler, NamesResourceAfterWait) {
+        const ResourceId resId(RESOURCE_COLLECTION, std::string("Profiler.Names"));
+        const ResourceId otherResId(RESOURCE_COLLECTION, std::string("Profiler.Other"));
+        LockContentionProfiler profiler;
+
+        // Only the resource the thread last waited for can be named
+        profiler.recordWait(resId, MODE_IX, 10);
+        profiler.nameIfContended(otherResId, "Profiler.Other");
+        profiler.nameIfContended(resId, "Profiler.Names");
+
+        // Once named the name sticks
+        profiler.recordWait(resId, MODE_IX, 10);
+        profiler.nameIfContended(resId, "Profiler.Renamed");
+
+        BSONObj report;
+        std::vector<BSONElement> resources = reportedResources(profiler, 10, &report);
+        ASSERT_EQUALS(1U, resources.size());
+        ASSERT_EQUALS(std::string("Profiler.Names"), resources[0].Obj()["name"].String());
+        ASSERT_EQUALS(2, resources[0].Obj()["waitCount"]["w"].numberLong());
+    }
+
+    TEST(LockContentionProfiler, ReportsMostContendedFirst) {
+        LockContentionProfiler profiler;
+
+        for (int i = 1; i <= 20; i++) {
+            const ResourceId resId(RESOURCE_DATABASE, static_cast<uint64_t>(i));
+            profiler.recordWait(resId, MODE_S, i * 1000);
+        }
+
+        BSONObj report;
+        std::vector<BSONElement> resources = reportedResources(profiler, 3, &report);
+        ASSERT_EQUALS(3U, resources.size());
+        ASSERT_EQUALS(20, report["trackedResources"].numberLong());
+
+        long long previous = resources[0].Obj()["waitMicros"]["totalMicros"].numberLong();
+        ASSERT_EQUALS(20000, previous);
+        for (size_t i = 1; i < resources.size(); i++) {
+            const long long total = resources[i].Obj()["waitMicros"]["totalMicros"].numberLong();
+            ASSERT_LESS_THAN(total, previous);
+            previous = total;
+        }
+
+        profiler.reset();
+        ASSERT_EQUALS(0U, reportedResources(profiler, 3, &report).size());
+    }
+
+    TEST(LockContentionProfiler, BoundsTrackedResources) {
+        LockContentionProfiler profiler;
+
+        const int numResources = 5000;
+        for (int i = 0; i < numResources; i++) {
+            const ResourceId resId(RESOURCE_COLLECTION, static_cast<uint64_t>(i));
+            profiler.recordWait(resId, MODE_IX, 1);
+        }
+
+        BSONObj report;
+        reportedResources(profiler, 1, &report);
+        const long long tracked = report["trackedResources"].numberLong();
+        ASSERT_LESS_THAN(tracked, numResources);
+        ASSERT_EQUALS(numResources, tracked + report["untrackedWaits"].numberLong());
+    }
+
+} // namespace
+} // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/db/concurrency/lock_manager.h"
 
 #include "mongo/db/concurrency/locker.h"
+#include "mongo/util/concurrency/partitioned_counter.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stringutils.h"
@@ -413,12 +414,12 @@ namespace {
     const unsigned LockManager::_numLockBuckets(128);
 
     // Balance scalability of intent locks against potential added cost of conflicting locks.
-    // The exact value doesn't appear very important, but should be power of two
-    const unsigned LockManager::_numPartitions = 32;
+    // Only the partitions that actually hold a resource are visited when it is migrated, so the
+    // cost of a conflicting lock grows with the number of CPUs in use, not with this value.
+    const unsigned LockManager::_numPartitions;
 
     LockManager::LockManager() {
         _lockBuckets = new LockBucket[_numLockBuckets];
-        _partitions = new Partition[_numPartitions];
     }
 
     LockManager::~LockManager() {
@@ -430,7 +431,6 @@ namespace {
         }
 
         delete[] _lockBuckets;
-        delete[] _partitions;
     }
 
     LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -441,6 +441,7 @@ namespace {
 
         // For intent modes, try the PartitionedLockHead
         if (request->partitioned) {
+            request->partitionId = currentCpuPartition(_numPartitions);
             Partition* partition = _getPartition(request);
             SimpleMutex::scoped_lock scopedLock(partition->mutex);
 
@@ -794,7 +795,7 @@ namespace {
     }
 
     LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-        return &_partitions[request->locker->getId() % _numPartitions];
+        return &_partitions[request->partitionId];
     }
 
     void LockManager::dump() const {
@@ -1106,6 +1107,7 @@ namespace {
         next = NULL;
         status = STATUS_NEW;
         partitioned = false;
+        partitionId = 0;
         mode = MODE_NONE;
         convertMode = MODE_NONE;
     }
@@ -1128,6 +1130,10 @@ namespace {
                                                         LockConflictsTable[coveringMode];
     }
 
+    bool isModeConflicting(LockMode mode, LockMode grantedMode) {
+        return conflicts(mode, modeMask(grantedMode));
+    }
+
     const char* resourceTypeName(ResourceType resourceType) {
         return ResourceTypeNames[resourceType];
     }
@@ -137,10 +137,12 @@ namespace mongo {
             LockHead* findOrInsert(ResourceId resId);
         };
 
-        // Each locker maps to a partition that is used for resources acquired in intent modes
-        // modes and potentially other modes that don't conflict with themselves. This avoids
-        // contention on the regular LockHead in the lock manager.
-        struct Partition {
+        // Each intent mode request maps to a partition, picked by the CPU the requesting thread
+        // is running on, that is used for resources acquired in intent modes and potentially
+        // other modes that don't conflict with themselves. This avoids contention on the regular
+        // LockHead in the lock manager. Partitions are cache line aligned, so that threads on
+        // different cores do not bounce each other's partition mutex.
+        struct MONGO_COMPILER_ALIGN_TYPE(64) Partition {
             Partition() : mutex("LockManager") { }
             PartitionedLockHead* find(ResourceId resId);
             PartitionedLockHead* findOrInsert(ResourceId resId);
@@ -157,7 +159,9 @@ namespace mongo {
 
 
         /**
-         * Retrieves the Partition that a particular LockRequest should use for intent locking.
+         * Retrieves the Partition that a particular LockRequest uses for intent locking. The
+         * partition is chosen once, when the request is first made, so that unlock finds it
+         * again even if the thread has since moved to another CPU.
          */
         Partition* _getPartition(LockRequest* request) const;
 
@@ -182,8 +186,9 @@ namespace mongo {
         static const unsigned _numLockBuckets;
         LockBucket* _lockBuckets;
 
-        static const unsigned _numPartitions;
-        Partition* _partitions;
+        // Enough for one partition per core on large multi-socket machines.
+        static const unsigned _numPartitions = 64;
+        Partition _partitions[_numPartitions];
     };
 
 
@@ -84,6 +84,13 @@ namespace mongo {
      */
     bool isModeCovered(LockMode mode, LockMode coveringMode);
 
+    /**
+     * Returns whether a request for 'mode' has to wait for a request already granted in
+     * 'grantedMode' on the same resource. For example X conflicts with IS, but IS does not
+     * conflict with IX.
+     */
+    bool isModeConflicting(LockMode mode, LockMode grantedMode);
+
 
     /**
      * Return values for the locking functions of the lock manager.
@@ -326,6 +333,10 @@ namespace mongo {
         // this pointer hanging around.
         LockHead* lock;
 
+        // Index of the LockManager partition used by a partitioned request. Only meaningful when
+        // 'partitioned' is set.
+        unsigned partitionId;
+
         // Pointer to the partitioned lock to which this request belongs, or null if it is not
         // partitioned. Only one of 'lock' and 'partitionedLock' is non-NULL, and a request can
         // only transition from 'partitionedLock' to 'lock', never the other way around.
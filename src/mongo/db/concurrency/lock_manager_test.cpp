@@ -26,8 +26,20 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -819,4 +831,148 @@ namespace mongo {
         ASSERT(lockMgr.unlock(&requestX));
     }
 
+    namespace {
+
+        /**
+         * Repeatedly acquires and releases 'resId' in MODE_IX, checking that no exclusive holder
+         * is present while the intent lock is granted.
+         */
+        void intentLockLoop(LockManager* lockMgr,
+                            ResourceId resId,
+                            int iterations,
+                            AtomicInt32* intentHolders,
+                            AtomicInt32* exclusiveHolders,
+                            AtomicInt32* failures) {
+            MMAPV1LockerImpl locker;
+            CondVarLockGrantNotification notify;
+
+            for (int i = 0; i < iterations; i++) {
+                LockRequest request;
+                request.initNew(&locker, &notify);
+                notify.clear();
+
+                LockResult result = lockMgr->lock(resId, &request, MODE_IX);
+                if (result == LOCK_WAITING) {
+                    result = notify.wait(UINT_MAX);
+                }
+                if (result != LOCK_OK) {
+                    failures->fetchAndAdd(1);
+                    continue;
+                }
+
+                intentHolders->fetchAndAdd(1);
+                if (exclusiveHolders->load() != 0) {
+                    failures->fetchAndAdd(1);
+                }
+                intentHolders->fetchAndSubtract(1);
+
+                lockMgr->unlock(&request);
+            }
+        }
+
+    } // namespace
+
+    TEST(LockManager, IntentLocksFromManyThreadsExcludeConflictingLock) {
+        LockManager lockMgr;
+        const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+        AtomicInt32 intentHolders;
+        AtomicInt32 exclusiveHolders;
+        AtomicInt32 failures;
+
+        // Enough threads that the intent requests land in several partitions, so that every
+        // exclusive request has to migrate them back to the LockHead.
+        const int numThreads = 16;
+        std::vector<boost::shared_ptr<boost::thread> > threads;
+        for (int i = 0; i < numThreads; i++) {
+            threads.push_back(boost::shared_ptr<boost::thread>(
+                new boost::thread(boost::bind(&intentLockLoop,
+                                              &lockMgr,
+                                              resId,
+                                              20000,
+                                              &intentHolders,
+                                              &exclusiveHolders,
+                                              &failures))));
+        }
+
+        MMAPV1LockerImpl locker;
+        CondVarLockGrantNotification notify;
+        for (int i = 0; i < 200; i++) {
+            LockRequest request;
+            request.initNew(&locker, &notify);
+            notify.clear();
+
+            LockResult result = lockMgr.lock(resId, &request, MODE_X);
+            if (result == LOCK_WAITING) {
+                result = notify.wait(UINT_MAX);
+            }
+            ASSERT_EQUALS(LOCK_OK, result);
+
+            exclusiveHolders.fetchAndAdd(1);
+            ASSERT_EQUALS(0, intentHolders.load());
+            exclusiveHolders.fetchAndSubtract(1);
+
+            lockMgr.unlock(&request);
+        }
+
+        for (int i = 0; i < numThreads; i++) {
+            threads[i]->join();
+        }
+
+        ASSERT_EQUALS(0, failures.load());
+    }
+
+
+    // Measures how uncontended intent locks on a single resource scale with the number of
+    // threads. It is not practical to run this on debug builds.
+#ifndef _DEBUG
+
+    namespace {
+
+        void intentLockPerfLoop(LockManager* lockMgr, ResourceId resId, int iterations) {
+            MMAPV1LockerImpl locker;
+            TrackingLockGrantNotification notify;
+
+            LockRequest request;
+            for (int i = 0; i < iterations; i++) {
+                request.initNew(&locker, &notify);
+                invariant(LOCK_OK == lockMgr->lock(resId, &request, MODE_IS));
+                lockMgr->unlock(&request);
+            }
+        }
+
+    } // namespace
+
+    TEST(LockManager, PerformanceIntentLocksScaling) {
+        const ResourceId resId(RESOURCE_GLOBAL, 1);
+        const int iterations = 200 * 1000;
+
+        for (int numThreads = 1; numThreads <= 128; numThreads = numThreads * 2) {
+            LockManager lockMgr;
+
+            Timer t;
+
+            std::vector<boost::shared_ptr<boost::thread> > threads;
+            for (int i = 0; i < numThreads; i++) {
+                threads.push_back(boost::shared_ptr<boost::thread>(
+                    new boost::thread(boost::bind(&intentLockPerfLoop,
+                                                  &lockMgr,
+                                                  resId,
+                                                  iterations))));
+            }
+            for (int i = 0; i < numThreads; i++) {
+                threads[i]->join();
+            }
+
+            const double totalOps = static_cast<double>(iterations) * numThreads;
+            log() << numThreads
+                  << " threads: "
+                  << static_cast<double>(t.micros()) * 1000.0 / static_cast<double>(iterations)
+                  << " ns per thread per lock, "
+                  << totalOps / (static_cast<double>(t.micros()) + 1) << " locks per us";
+        }
+    }
+
+#endif  // _DEBUG
+
 } // namespace mongo
@@ -32,6 +32,7 @@
 
 #include "mongo/db/concurrency/lock_state.h"
 
+#include "mongo/db/concurrency/lock_contention_profiler.h"
 #include "mongo/db/global_environment_experiment.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/platform/compiler.h"
@@ -137,6 +138,9 @@ namespace {
     // Partitioned global lock statistics, so we don't hit the same bucket
     PartitionedInstanceWideLockStats globalStats;
 
+    // Number of lockers currently sleeping in lockComplete, by the mode they are waiting for
+    AtomicInt32 waitingLockersByMode[LockModesCount];
+
 
     /**
      * Returns whether the passed in mode is S or IS. Used for validation checks.
@@ -512,6 +516,39 @@ namespace {
         return ResourceId();
     }
 
+    template<bool IsForMMAPV1>
+    bool LockerImpl<IsForMMAPV1>::hasConflictingWaiters() const {
+        // Fast path for the common uncontended case, where nobody is waiting at all
+        uint32_t waitingModes = 0;
+        for (uint32_t i = 1; i < LockModesCount; i++) {
+            if (waitingLockersByMode[i].load() > 0) {
+                waitingModes |= (1 << i);
+            }
+        }
+
+        if (!waitingModes) {
+            return false;
+        }
+
+        scoped_spinlock scopedLock(_lock);
+
+        LockRequestsMap::ConstIterator it = _requests.begin();
+        while (!it.finished()) {
+            if (it->status == LockRequest::STATUS_GRANTED) {
+                for (uint32_t i = 1; i < LockModesCount; i++) {
+                    if ((waitingModes & (1 << i)) &&
+                            isModeConflicting(static_cast<LockMode>(i), it->mode)) {
+                        return true;
+                    }
+                }
+            }
+
+            it.next();
+        }
+
+        return false;
+    }
+
     template<bool IsForMMAPV1>
     void LockerImpl<IsForMMAPV1>::getLockerInfo(LockerInfo* lockerInfo) const {
         invariant(lockerInfo);
@@ -697,6 +734,9 @@ namespace {
 
         LockResult result;
 
+        // Lets operations holding conflicting locks know that they should yield
+        waitingLockersByMode[mode].fetchAndAdd(1);
+
         // Don't go sleeping without bound in order to be able to report long waits or wake up for
         // deadlock detection.
         unsigned waitTimeMs = std::min(timeoutMs, DeadlockTimeoutMs);
@@ -737,6 +777,13 @@ namespace {
             }
         }
 
+        waitingLockersByMode[mode].fetchAndSubtract(1);
+
+        // The statistics above are updated at every wake up, the profiler wants the whole wait
+        LockContentionProfiler::global.recordWait(resId,
+                                                  mode,
+                                                  curTimeMicros64() - _requestStartTime);
+
         // Cleanup the state, since this is an unused lock now
         if (result != LOCK_OK) {
             LockRequestsMap::Iterator it = _requests.find(resId);
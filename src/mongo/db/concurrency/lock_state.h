@@ -124,6 +124,8 @@ namespace mongo {
 
         virtual ResourceId getWaitingResource() const;
 
+        virtual bool hasConflictingWaiters() const;
+
         virtual void getLockerInfo(LockerInfo* lockerInfo) const;
 
         virtual bool saveLockStateAndUnlock(LockSnapshot* stateOut);
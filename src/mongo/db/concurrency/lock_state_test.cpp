@@ -30,12 +30,15 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include <vector>
 
 #include "mongo/db/concurrency/lock_manager_test_help.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -117,6 +120,47 @@ namespace {
         locker2.unlockAll();
     }
 
+    namespace {
+
+        void lockAfterWait(Locker* locker, ResourceId resId, LockMode mode) {
+            ASSERT(LOCK_OK == locker->lockGlobal(MODE_IX));
+            ASSERT(LOCK_OK == locker->lock(resId, mode, 10 * 1000));
+            ASSERT(locker->unlockAll());
+        }
+
+    } // namespace
+
+    TEST(LockerImpl, HasConflictingWaiters) {
+        const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+        DefaultLockerImpl locker1;
+        ASSERT(LOCK_OK == locker1.lockGlobal(MODE_IX));
+        ASSERT(LOCK_OK == locker1.lock(resId, MODE_X));
+        ASSERT(!locker1.hasConflictingWaiters());
+
+        DefaultLockerImpl locker2;
+        boost::thread waiter(boost::bind(&lockAfterWait, &locker2, resId, MODE_S));
+
+        Timer t;
+        while (!locker1.hasConflictingWaiters()) {
+            ASSERT_LESS_THAN(t.seconds(), 10);
+            sleepmillis(1);
+        }
+
+        // A locker holding nothing which conflicts with S does not see the waiter
+        DefaultLockerImpl locker3;
+        ASSERT(LOCK_OK == locker3.lockGlobal(MODE_IS));
+        ASSERT(!locker3.hasConflictingWaiters());
+        ASSERT(locker3.unlockAll());
+
+        ASSERT(locker1.unlockAll());
+        waiter.join();
+
+        ASSERT(LOCK_OK == locker1.lockGlobal(MODE_IX));
+        ASSERT(!locker1.hasConflictingWaiters());
+        ASSERT(locker1.unlockAll());
+    }
+
     TEST(LockerImpl, ReadTransaction) {
         DefaultLockerImpl locker;
 
@@ -314,6 +358,44 @@ namespace {
         }
     }
 
+    namespace {
+
+        void lockerPerfLoop(ResourceId resIdDb, int iterations) {
+            DefaultLockerImpl locker;
+            for (int i = 0; i < iterations; i++) {
+                locker.lockGlobal(MODE_IX);
+                locker.lock(resIdDb, MODE_IX);
+                locker.unlockAll();
+            }
+        }
+
+    } // namespace
+
+    // Exercises the global and database intent locks through LockerImpl from many threads at
+    // once, which is where a shared intent lock partition shows up as cache line bouncing.
+    TEST(Locker, PerformanceLockerMultiThreaded) {
+        const ResourceId resIdDb(RESOURCE_DATABASE, std::string("TestDB"));
+        const int iterations = 50 * 1000;
+
+        for (int numThreads = 1; numThreads <= 64; numThreads = numThreads * 2) {
+            Timer t;
+
+            std::vector<boost::shared_ptr<boost::thread> > threads;
+            for (int i = 0; i < numThreads; i++) {
+                threads.push_back(boost::shared_ptr<boost::thread>(
+                    new boost::thread(boost::bind(&lockerPerfLoop, resIdDb, iterations))));
+            }
+            for (int i = 0; i < numThreads; i++) {
+                threads[i]->join();
+            }
+
+            log() << numThreads
+                  << " threads: "
+                  << static_cast<double>(t.micros()) * 1000.0 / static_cast<double>(iterations)
+                  << " ns per thread per global+database lock";
+        }
+    }
+
 #endif  // _DEBUG
 
 } // namespace mongo
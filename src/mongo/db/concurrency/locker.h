@@ -182,6 +182,15 @@ namespace mongo {
          */
         virtual ResourceId getWaitingResource() const = 0;
 
+        /**
+         * Returns whether some other locker is currently blocked on a lock request in a mode,
+         * which conflicts with one of the modes this locker holds. Waiters are counted per mode
+         * rather than per resource, so this may report contention on a resource this locker
+         * does not hold, but it never misses a waiter, which has started sleeping. Cheap enough
+         * to be called periodically by long running operations deciding whether to yield.
+         */
+        virtual bool hasConflictingWaiters() const = 0;
+
         /**
          * Describes a single lock acquisition for reporting/serialization purposes.
          */
@@ -114,6 +114,10 @@ namespace mongo {
             invariant(false);
         }
 
+        virtual bool hasConflictingWaiters() const {
+            return false;
+        }
+
         virtual void getLockerInfo(LockerInfo* lockerInfo) const {
             invariant(false);
         }
@@ -37,6 +37,8 @@ namespace mongo {
 
     int ConnPoolOptions::maxConnsPerHost(200);
     int ConnPoolOptions::maxShardedConnsPerHost(200);
+    int ConnPoolOptions::minConnsPerHost(0);
+    int ConnPoolOptions::minShardedConnsPerHost(0);
 
     namespace {
 
@@ -54,6 +56,20 @@ namespace mongo {
                                         true,
                                         false /* can't change at runtime */);
 
+        ExportedServerParameter<int> //
+        minConnsPerHostParameter(ServerParameterSet::getGlobal(),
+                                 "connPoolMinConnsPerHost",
+                                 &ConnPoolOptions::minConnsPerHost,
+                                 true,
+                                 false /* can't change at runtime */);
+
+        ExportedServerParameter<int> //
+        minShardedConnsPerHostParameter(ServerParameterSet::getGlobal(),
+                                        "connPoolMinShardedConnsPerHost",
+                                        &ConnPoolOptions::minShardedConnsPerHost,
+                                        true,
+                                        false /* can't change at runtime */);
+
         MONGO_INITIALIZER(InitializeConnectionPools)(InitializerContext* context) {
 
             // Initialize the sharded and unsharded outgoing connection pools
@@ -64,9 +80,11 @@ namespace mongo {
 
             pool.setName("connection pool");
             pool.setMaxPoolSize(ConnPoolOptions::maxConnsPerHost);
+            pool.setMinPoolSize(ConnPoolOptions::minConnsPerHost);
 
             shardConnectionPool.setName("sharded connection pool");
             shardConnectionPool.setMaxPoolSize(ConnPoolOptions::maxShardedConnsPerHost);
+            shardConnectionPool.setMinPoolSize(ConnPoolOptions::minShardedConnsPerHost);
 
             return Status::OK();
         }
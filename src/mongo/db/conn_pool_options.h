@@ -49,6 +49,16 @@ namespace mongo {
          * Maximum connections per host the sharded conn pool should use
          */
         static int maxShardedConnsPerHost;
+
+        /**
+         * Connections per host the connection pool keeps open once the host has been used
+         */
+        static int minConnsPerHost;
+
+        /**
+         * Connections per host the sharded conn pool keeps open once the host has been used
+         */
+        static int minShardedConnsPerHost;
     };
 
 }
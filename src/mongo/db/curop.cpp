@@ -37,6 +37,7 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/memory_broker.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -72,6 +73,7 @@ namespace mongo {
         _op = 0;
         _opNum = _nextOpNum.fetchAndAdd(1);
         _command = NULL;
+        _prevMemoryAccount = MemoryBroker::setOpAccount(&_memoryBytes);
     }
 
     void CurOp::_reset() {
@@ -84,6 +86,12 @@ namespace mongo {
         _progressMeter.finished();
         _killPending.store(0);
         _numYields = 0;
+        _startCpuMicros = -1;
+        _endCpuMicros = -1;
+        _storageBytesRead = 0;
+        _storageBytesWritten = 0;
+        _yieldMicros = 0;
+        _memoryBytes = 0;
         _expectedLatencyMs = 0;
     }
 
@@ -131,6 +139,9 @@ namespace mongo {
             _client->_curOp = _wrapped;
         }
         _client = 0;
+        if (MemoryBroker::getOpAccount() == &_memoryBytes) {
+            MemoryBroker::setOpAccount(_prevMemoryAccount);
+        }
     }
 
     void CurOp::setNS( const StringData& ns ) {
@@ -141,6 +152,7 @@ namespace mongo {
     void CurOp::ensureStarted() {
         if ( _start == 0 ) {
             _start = curTimeMicros64();
+            _startCpuMicros = curThreadCpuTimeMicros();
 
             // If ensureStarted() is invoked after setMaxTimeMicros(), then time limit tracking will
             // start here.  This is because time limit tracking can only commence after the
@@ -212,6 +224,10 @@ namespace mongo {
             builder->append("killPending", true);
 
         builder->append( "numYields" , _numYields );
+        builder->appendNumber( "yieldMicros" , _yieldMicros );
+        builder->appendNumber( "storageBytesRead" , _storageBytesRead );
+        builder->appendNumber( "storageBytesWritten" , _storageBytesWritten );
+        builder->appendNumber( "memoryBytes" , memoryBytes() );
     }
 
     BSONObj CurOp::description() {
@@ -31,6 +31,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <boost/noncopyable.hpp>
 
 #include "mongo/db/client.h"
@@ -258,6 +259,7 @@ namespace mongo {
         void done() {
             _active = false;
             _end = curTimeMicros64();
+            _endCpuMicros = curThreadCpuTimeMicros();
         }
 
         long long totalTimeMicros() {
@@ -302,6 +304,40 @@ namespace mongo {
         bool killPending() const { return _killPending.loadRelaxed(); }
         void yielded() { _numYields++; }
         int numYields() const { return _numYields; }
+
+        //
+        // Resource accounting.  Only the thread running the operation updates these.
+        //
+
+        /**
+         * CPU time used by the thread running this operation between its start and done(), or
+         * -1 if the operation isn't done or the platform can't measure thread CPU time.
+         */
+        long long cpuMicros() const {
+            if (_active || _startCpuMicros < 0 || _endCpuMicros < _startCpuMicros) {
+                return -1;
+            }
+            return _endCpuMicros - _startCpuMicros;
+        }
+
+        /** Counts the size of records read from the storage engine by this operation. */
+        void recordStorageBytesRead(long long bytes) { _storageBytesRead += bytes; }
+        long long storageBytesRead() const { return _storageBytesRead; }
+
+        /** Counts the size of records written to the storage engine by this operation. */
+        void recordStorageBytesWritten(long long bytes) { _storageBytesWritten += bytes; }
+        long long storageBytesWritten() const { return _storageBytesWritten; }
+
+        /**
+         * Memory reserved from the MemoryBroker by this operation's stages.  Reservations made
+         * on this thread are charged here; one released by a later operation, e.g. when a
+         * cursor is killed, may be charged to that one instead.
+         */
+        long long memoryBytes() const { return std::max(_memoryBytes, 0LL); }
+
+        /** Counts time spent yielding, including waiting to get the locks back. */
+        void recordYieldMicros(long long micros) { _yieldMicros += micros; }
+        long long yieldMicros() const { return _yieldMicros; }
         
         long long getExpectedLatencyMs() const { return _expectedLatencyMs; }
         void setExpectedLatencyMs( long long latency ) { _expectedLatencyMs = latency; }
@@ -338,6 +374,13 @@ namespace mongo {
         ProgressMeter _progressMeter;
         AtomicInt32 _killPending;
         int _numYields;
+        long long _startCpuMicros;
+        long long _endCpuMicros;
+        long long _storageBytesRead;
+        long long _storageBytesWritten;
+        long long _yieldMicros;
+        long long _memoryBytes;
+        long long* _prevMemoryAccount; // restored when this CurOp goes away
         
         // this is how much "extra" time a query might take
         // a writebacklisten for example will block for 30s 
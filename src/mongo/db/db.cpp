@@ -71,7 +71,9 @@
 #include "mongo/db/log_process_details.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/find.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_cache_persistence.h"
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repair_database.h"
 #include "mongo/db/repl/network_interface_impl.h"
@@ -89,6 +91,7 @@
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/ttl.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/assert_util.h"
@@ -102,6 +105,7 @@
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/ntservice.h"
 #include "mongo/util/options_parser/startup_options.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/quick_exit.h"
 #include "mongo/util/ramlog.h"
 #include "mongo/util/scopeguard.h"
@@ -145,6 +149,21 @@ namespace mongo {
 
     QueryResult::View emptyMoreResult(long long);
 
+    // Pins each connection thread to one NUMA node, round robin, so that the memory it touches
+    // first (its stack, its allocator caches, the storage engine sessions it picks) is local.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(numaThreadPinning, bool, false);
+
+    namespace {
+        AtomicUInt32 nextNumaNode;
+
+        void bindConnectionThreadToNumaNode() {
+            const unsigned numNodes = ProcessInfo().getNumNumaNodes();
+            if (numNodes > 1) {
+                ProcessInfo::bindCurrentThreadToNumaNode(nextNumaNode.fetchAndAdd(1) % numNodes);
+            }
+        }
+    } // namespace
+
 
     /* todo: make this a real test.  the stuff in dbtests/ seem to do all dbdirectclient which exhaust doesn't support yet. */
 // QueryOption_Exhaust
@@ -190,6 +209,10 @@ namespace mongo {
     public:
         virtual void connected( AbstractMessagingPort* p ) {
             Client::initThread("conn", p);
+
+            if (numaThreadPinning) {
+                bindConnectionThreadToNumaNode();
+            }
         }
 
         virtual void process( Message& m , AbstractMessagingPort* port , LastError * le) {
@@ -230,6 +253,12 @@ namespace mongo {
                             continue; // this goes back to top loop
                         }
                     }
+                    else if ( !dbresponse.prefetchNS.empty() ) {
+                        // The client is busy receiving the reply; produce its next batch.
+                        QueryResult::View qr = dbresponse.response->header().view2ptr();
+                        prefetchGetMore(&txn, port->remote(), dbresponse.prefetchNS,
+                                        qr.getCursorId());
+                    }
                 }
                 break;
             }
@@ -456,6 +485,16 @@ namespace mongo {
         DEV log(LogComponent::kControl) << "_DEBUG build (which is slower)" << endl;
         logMongodStartupWarnings(storageGlobalParams);
 
+        if (numaThreadPinning) {
+            const unsigned numNodes = ProcessInfo().getNumNumaNodes();
+            if (numNodes > 1) {
+                log() << "pinning connection threads to " << numNodes << " NUMA nodes";
+            }
+            else {
+                log() << "numaThreadPinning has no effect: no NUMA nodes to pin to";
+            }
+        }
+
 #if defined(_WIN32)
         printTargetMinOS();
 #endif
@@ -591,10 +630,12 @@ namespace mongo {
                 exitCleanly(EXIT_NEED_UPGRADE);
             }
 
-            getDeleter()->startWorkers();
+            getDeleter()->startWorkers(rangeDeleterWorkers);
 
             restartInProgressIndexesFromLastShutdown(&txn);
 
+            restorePersistedPlanCaches(&txn);
+
             repl::getGlobalReplicationCoordinator()->startReplication(&txn);
 
             const unsigned long long missingRepl = checkIfReplMissingFromCommandLine(&txn);
@@ -614,10 +655,14 @@ namespace mongo {
                 startTTLBackgroundJob();
             }
 
+            startPlanCachePersisterBackgroundJob();
+
         }
 
         startClientCursorMonitor();
 
+        startProfileBufferOffloader();
+
         PeriodicTask::startRunningPeriodicTasks();
 
         logStartup();
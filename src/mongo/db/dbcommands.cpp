@@ -68,11 +68,13 @@
 #include "mongo/db/ops/insert.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repair_database.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/stats/profile_buffer.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/write_concern.h"
@@ -392,6 +394,84 @@ namespace mongo {
 
     } cmdProfile;
 
+    class CmdProfileBuffer : public Command {
+    public:
+        virtual bool slaveOk() const {
+            return true;
+        }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+
+        virtual void help( stringstream& help ) const {
+            help << "returns the profile documents of this database kept in memory when the\n";
+            help << "server runs with the profileBufferSize parameter\n";
+            help << "{ profileBuffer : 1, clear : <bool> }\n";
+            help << "clear also empties this database's part of the buffer";
+        }
+
+        virtual Status checkAuthForCommand(ClientBasic* client,
+                                           const std::string& dbname,
+                                           const BSONObj& cmdObj) {
+            AuthorizationSession* authzSession = client->getAuthorizationSession();
+            if (cmdObj["clear"].trueValue() &&
+                !authzSession->isAuthorizedForActionsOnResource(
+                        ResourcePattern::forDatabaseName(dbname), ActionType::enableProfiler)) {
+                return Status(ErrorCodes::Unauthorized, "unauthorized");
+            }
+
+            // Reading the buffer is equivalent to reading system.profile.
+            if (!authzSession->isAuthorizedForActionsOnResource(
+                    ResourcePattern::forExactNamespace(NamespaceString(dbname, "system.profile")),
+                    ActionType::find)) {
+                return Status(ErrorCodes::Unauthorized, "unauthorized");
+            }
+
+            return Status::OK();
+        }
+
+        CmdProfileBuffer() : Command("profileBuffer") {}
+
+        bool run(OperationContext* txn,
+                 const string& dbname,
+                 BSONObj& cmdObj,
+                 int options,
+                 string& errmsg,
+                 BSONObjBuilder& result,
+                 bool fromRepl) {
+
+            ProfileBuffer* const buffer = getProfileBuffer();
+            result.appendBool("enabled", buffer != NULL);
+            if (!buffer) {
+                return true;
+            }
+
+            std::vector<BSONObj> docs;
+            buffer->copy(dbname, &docs);
+            if (cmdObj["clear"].trueValue()) {
+                buffer->clear(dbname);
+            }
+
+            result.appendNumber("capacity", static_cast<long long>(buffer->capacity()));
+            result.appendNumber("appended", buffer->appended());
+            result.appendNumber("overwritten", buffer->overwritten());
+
+            // Leave room in the reply for the fields above and the command status.
+            const int maxDocsSize = BSONObjMaxUserSize - 1024;
+            BSONArrayBuilder docsBuilder(result.subarrayStart("docs"));
+            size_t returned = 0;
+            for (; returned < docs.size(); returned++) {
+                if (docsBuilder.len() + docs[returned].objsize() > maxDocsSize) {
+                    break;
+                }
+                docsBuilder.append(docs[returned]);
+            }
+            docsBuilder.doneFast();
+            result.appendBool("truncated", returned < docs.size());
+            return true;
+        }
+
+    } cmdProfileBuffer;
+
     class CmdDiagLogging : public Command {
     public:
         virtual bool slaveOk() const {
@@ -891,6 +971,27 @@ namespace mongo {
 
     } cmdDatasize;
 
+    /**
+     * Parses the optional 'maxStalenessSecs' of dbStats and collStats: how old cached storage
+     * and index sizes may be. Defaults to 0, which always recomputes them.
+     */
+    static bool parseMaxStalenessSecs(const BSONObj& cmdObj, int* out, string& errmsg) {
+        *out = 0;
+        BSONElement elem = cmdObj["maxStalenessSecs"];
+        if (elem.isNumber()) {
+            *out = elem.numberInt();
+            if (*out < 0) {
+                errmsg = "maxStalenessSecs has to be >= 0";
+                return false;
+            }
+        }
+        else if (elem.trueValue()) {
+            errmsg = "maxStalenessSecs has to be a number >= 0";
+            return false;
+        }
+        return true;
+    }
+
     class CollectionStats : public Command {
     public:
         CollectionStats() : Command( "collStats", false, "collstats" ) {
@@ -901,7 +1002,8 @@ namespace mongo {
         virtual bool isWriteCommandForConfigServer() const { return false; }
         virtual void help( stringstream &help ) const {
             help << "{ collStats:\"blog.posts\" , scale : 1 } scale divides sizes e.g. for KB use 1024\n"
-                    "    avgObjSize - in bytes";
+                    "    avgObjSize - in bytes\n"
+                    "    maxStalenessSecs - storage and index sizes may be reused if this recent";
         }
 
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -928,6 +1030,11 @@ namespace mongo {
 
             bool verbose = jsobj["verbose"].trueValue();
 
+            int maxStalenessSecs;
+            if (!parseMaxStalenessSecs(jsobj, &maxStalenessSecs, errmsg)) {
+                return false;
+            }
+
             const NamespaceString nss(parseNs(dbname, jsobj));
 
             if (nss.coll().empty()) {
@@ -956,11 +1063,18 @@ namespace mongo {
             if( numRecords )
                 result.append( "avgObjSize" , collection->averageObjectSize(txn) );
 
-            result.appendNumber("storageSize",
-                                static_cast<long long>(collection->getRecordStore()
-                                                       ->storageSize(txn,
-                                                                     &result,
-                                                                     verbose ? 1 : 0)) / scale);
+            // The verbose extent list is never cached
+            CollectionInfoCache::StorageSizes sizes =
+                collection->infoCache()->getStorageSizes(txn, verbose ? 0 : maxStalenessSecs);
+            if (verbose) {
+                result.appendNumber("storageSize",
+                                    static_cast<long long>(collection->getRecordStore()
+                                                           ->storageSize(txn, &result, 1)) / scale);
+            }
+            else {
+                result.appendElements(sizes.storageExtraInfo);
+                result.appendNumber("storageSize", sizes.storageSize / scale);
+            }
 
             collection->getRecordStore()->appendCustomStats( txn, &result, scale );
 
@@ -985,11 +1099,18 @@ namespace mongo {
             result.append("indexDetails", indexDetails.done());
 
             BSONObjBuilder indexSizes;
-            long long indexSize = collection->getIndexSize(txn, &indexSizes, scale);
+            for (size_t i = 0; i < sizes.indexSizes.size(); i++) {
+                indexSizes.appendNumber(sizes.indexSizes[i].first,
+                                        sizes.indexSizes[i].second / scale);
+            }
 
-            result.appendNumber("totalIndexSize", indexSize / scale);
+            result.appendNumber("totalIndexSize", sizes.totalIndexSize / scale);
             result.append("indexSizes", indexSizes.obj());
 
+            BSONObjBuilder planCacheStats(result.subobjStart("planCache"));
+            collection->infoCache()->getPlanCache()->appendStats(&planCacheStats);
+            planCacheStats.doneFast();
+
             return true;
         }
 
@@ -1139,7 +1260,8 @@ namespace mongo {
             help <<
                 "Get stats on a database. Not instantaneous. Slower for databases with large "
                 ".ns files.\n"
-                "Example: { dbStats:1, scale:1 }";
+                "Example: { dbStats:1, scale:1 }\n"
+                "maxStalenessSecs - storage and index sizes may be reused if this recent";
         }
 
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -1164,6 +1286,11 @@ namespace mongo {
                 return false;
             }
 
+            int maxStalenessSecs;
+            if (!parseMaxStalenessSecs(jsobj, &maxStalenessSecs, errmsg)) {
+                return false;
+            }
+
             const string ns = parseNs(dbname, jsobj);
 
             // TODO: Client::Context legacy, needs to be removed
@@ -1199,7 +1326,7 @@ namespace mongo {
                 // TODO: Client::Context legacy, needs to be removed
                 txn->getCurOp()->enter(dbname.c_str(), db->getProfilingLevel());
 
-                db->getStats(txn, &result, scale);
+                db->getStats(txn, &result, scale, maxStalenessSecs);
             }
 
             return true;
@@ -55,6 +55,7 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/db/operation_context_impl.h"
@@ -73,9 +74,18 @@ namespace mongo {
     using std::set;
     using std::string;
     using std::stringstream;
+    using std::vector;
 
     using logger::LogComponent;
 
+    // Documents removeRange deletes in one unit of work while holding the write lock
+    MONGO_EXPORT_SERVER_PARAMETER(removeRangeBatchSize, int, 64);
+
+    namespace {
+        // A batch whose deletes take longer than this to replicate halves the next batch
+        const long long kSlowRemoveRangeReplicationMillis = 1000;
+    }
+
     const BSONObj reverseNaturalObj = BSON( "$natural" << -1 );
 
     void Helpers::ensureIndex(OperationContext* txn,
@@ -377,7 +387,15 @@ namespace mongo {
         
         long long millisWaitingForReplication = 0;
 
+        // Shrinks while secondaries are slow to confirm batches, and grows back when they
+        // catch up
+        const int maxBatchSize = std::max(1, removeRangeBatchSize);
+        int batchSize = maxBatchSize;
+
         while ( 1 ) {
+            bool done = false;
+            long long deletedThisBatch = 0;
+
             // Scoping for write lock.
             {
                 Client::WriteContext ctx(txn, ns);
@@ -389,94 +407,113 @@ namespace mongo {
                     collection->getIndexCatalog()->findIndexByKeyPattern( txn,
                                                                           indexKeyPattern.toBSON() );
 
+                // The scan doesn't yield, so the documents of the batch stay valid until they
+                // are deleted below under the same lock
                 auto_ptr<PlanExecutor> exec(InternalPlanner::indexScan(txn, collection, desc,
                                                                        min, max,
                                                                        maxInclusive,
                                                                        InternalPlanner::FORWARD,
                                                                        InternalPlanner::IXSCAN_FETCH));
-                exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
+                vector<RecordId> locs;
+                vector<BSONObj> objs;
                 RecordId rloc;
                 BSONObj obj;
-                PlanExecutor::ExecState state;
-                // This may yield so we cannot touch nsd after this.
-                state = exec->getNext(&obj, &rloc);
+                PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+                while ( static_cast<int>( locs.size() ) < batchSize ) {
+                    state = exec->getNext(&obj, &rloc);
+                    if (PlanExecutor::ADVANCED != state) {
+                        done = true;
+                        break;
+                    }
+
+                    locs.push_back(rloc);
+                    objs.push_back(obj.getOwned());
+                }
                 exec.reset();
-                if (PlanExecutor::IS_EOF == state) { break; }
 
                 if (PlanExecutor::DEAD == state) {
                     warning(LogComponent::kSharding) << "cursor died: aborting deletion for "
                               << min << " to " << max << " in " << ns
                               << endl;
-                    break;
                 }
-
-                if (PlanExecutor::FAILURE == state) {
+                else if (PlanExecutor::FAILURE == state) {
                     warning(LogComponent::kSharding) << "cursor error while trying to delete "
                               << min << " to " << max
                               << " in " << ns << ": "
                               << WorkingSetCommon::toStatusString(obj) << endl;
-                    break;
                 }
 
-                verify(PlanExecutor::ADVANCED == state);
+                if ( locs.empty() )
+                    break;
 
-                WriteUnitOfWork wuow(txn);
+                if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(ns)) {
+                    warning() << "stepped down from primary while deleting chunk; "
+                              << "orphaning data in " << ns
+                              << " in range [" << min << ", " << max << ")";
+                    return numDeleted;
+                }
 
+                CollectionMetadataPtr metadataNow;
                 if ( onlyRemoveOrphanedDocs ) {
-                    // Do a final check in the write lock to make absolutely sure that our
-                    // collection hasn't been modified in a way that invalidates our migration
-                    // cleanup.
-
                     // We should never be able to turn off the sharding state once enabled, but
                     // in the future we might want to.
                     verify(shardingState.enabled());
 
                     // In write lock, so will be the most up-to-date version
-                    CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
-
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        ShardKeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractShardKeyFromDoc(obj);
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
-                    }
-                    else {
-                        docIsOrphan = false;
-                    }
+                    metadataNow = shardingState.getCollectionMetadata( ns );
+                }
 
-                    if ( !docIsOrphan ) {
-                        warning(LogComponent::kSharding)
-                                  << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
+                // One unit of work per batch, so the storage engine commits the document and
+                // index entry removals of the batch together
+                WriteUnitOfWork wuow(txn);
+
+                for ( size_t i = 0; i < locs.size(); i++ ) {
+                    const BSONObj& doc = objs[i];
+
+                    if ( onlyRemoveOrphanedDocs ) {
+                        // Do a final check in the write lock to make absolutely sure that our
+                        // collection hasn't been modified in a way that invalidates our migration
+                        // cleanup.
+                        bool docIsOrphan;
+                        if ( metadataNow ) {
+                            ShardKeyPattern kp( metadataNow->getKeyPattern() );
+                            BSONObj key = kp.extractShardKeyFromDoc(doc);
+                            docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                && !metadataNow->keyIsPending( key );
+                        }
+                        else {
+                            docIsOrphan = false;
+                        }
+
+                        if ( !docIsOrphan ) {
+                            warning(LogComponent::kSharding)
+                                      << "aborting migration cleanup for chunk " << min << " to " << max
+                                      << ( metadataNow ? (string) " at document " + doc.toString() : "" )
+                                      << ", collection " << ns << " has changed " << endl;
+                            done = true;
+                            break;
+                        }
                     }
-                }
 
-                if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(ns)) {
-                    warning() << "stepped down from primary while deleting chunk; "
-                              << "orphaning data in " << ns
-                              << " in range [" << min << ", " << max << ")";
-                    return numDeleted;
-                }
+                    if ( callback )
+                        callback->goingToDelete( doc );
 
-                if ( callback )
-                    callback->goingToDelete( obj );
+                    BSONObj deletedId;
+                    collection->deleteDocument( txn, locs[i], false, false, &deletedId );
+                    // The above throws on failure, and so is not logged
+                    repl::logOp(txn, "d", ns.c_str(), deletedId, 0, 0, fromMigrate);
+                    deletedThisBatch++;
+                }
 
-                BSONObj deletedId;
-                collection->deleteDocument( txn, rloc, false, false, &deletedId );
-                // The above throws on failure, and so is not logged
-                repl::logOp(txn, "d", ns.c_str(), deletedId, 0, 0, fromMigrate);
                 wuow.commit();
-                numDeleted++;
+                numDeleted += deletedThisBatch;
             }
 
             // TODO remove once the yielding below that references this timer has been removed
             Timer secondaryThrottleTime;
 
-            if (writeConcern.shouldWaitForOtherNodes() && numDeleted > 0) {
+            if (writeConcern.shouldWaitForOtherNodes() && deletedThisBatch > 0) {
                 repl::ReplicationCoordinator::StatusAndDuration replStatus =
                         repl::getGlobalReplicationCoordinator()->awaitReplication(txn,
                                                                                   txn->getClient()->getLastOp(),
@@ -489,8 +526,20 @@ namespace mongo {
                 else {
                     massertStatusOK(replStatus.status);
                 }
-                millisWaitingForReplication += replStatus.duration.total_milliseconds();
+
+                const long long replMillis = replStatus.duration.total_milliseconds();
+                millisWaitingForReplication += replMillis;
+
+                if ( replMillis > kSlowRemoveRangeReplicationMillis ) {
+                    batchSize = std::max( 1, batchSize / 2 );
+                }
+                else if ( replMillis < kSlowRemoveRangeReplicationMillis / 10 ) {
+                    batchSize = std::min( maxBatchSize, batchSize * 2 );
+                }
             }
+
+            if ( done )
+                break;
         }
         
         if (writeConcern.shouldWaitForOtherNodes())
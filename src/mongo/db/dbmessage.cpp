@@ -176,18 +176,18 @@ namespace mongo {
                       int nReturned, int startingFrom,
                       long long cursorId 
                       ) {
-        BufBuilder b(32768);
-        b.skip(sizeof(QueryResult::Value));
-        b.appendBuf(data, size);
-        QueryResult::View qr = b.buf();
+        // Built in a recycled buffer of the final size rather than a BufBuilder grown by realloc.
+        const int len = sizeof(QueryResult::Value) + size;
+        QueryResult::View qr = MessageBufferPool::allocate(len);
+        memcpy(qr.view2ptr() + sizeof(QueryResult::Value), data, size);
         qr.setResultFlags(queryResultFlags);
-        qr.msgdata().setLen(b.len());
+        qr.msgdata().setLen(len);
         qr.msgdata().setOperation(opReply);
         qr.setCursorId(cursorId);
         qr.setStartingFrom(startingFrom);
         qr.setNReturned(nReturned);
-        b.decouple();
-        Message resp(qr.view2ptr(), true);
+        Message resp;
+        resp.setPooledData(qr.view2ptr());
         p->reply(requestMsg, resp, requestMsg.header().getId());
     }
 
@@ -207,22 +207,19 @@ namespace mongo {
     }
 
     void replyToQuery( int queryResultFlags, Message& response, const BSONObj& resultObj ) {
-        BufBuilder bufBuilder;
-        bufBuilder.skip( sizeof( QueryResult::Value ));
-        bufBuilder.appendBuf( reinterpret_cast< void *>(
-                const_cast< char* >( resultObj.objdata() )), resultObj.objsize() );
-
-        QueryResult::View queryResult = bufBuilder.buf();
-        bufBuilder.decouple();
+        const int len = sizeof( QueryResult::Value ) + resultObj.objsize();
+        QueryResult::View queryResult = MessageBufferPool::allocate( len );
+        memcpy( queryResult.view2ptr() + sizeof( QueryResult::Value ),
+                resultObj.objdata(), resultObj.objsize() );
 
         queryResult.setResultFlags(queryResultFlags);
-        queryResult.msgdata().setLen(bufBuilder.len());
+        queryResult.msgdata().setLen(len);
         queryResult.msgdata().setOperation( opReply );
         queryResult.setCursorId(0);
         queryResult.setStartingFrom(0);
         queryResult.setNReturned(1);
 
-        response.setData( queryResult.view2ptr(), true ); // transport will free
+        response.setPooledData( queryResult.view2ptr() ); // transport will free
     }
 
 }
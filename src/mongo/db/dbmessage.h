@@ -309,6 +309,7 @@ namespace mongo {
         Message *response;
         MSGID responseTo;
         std::string exhaustNS; /* points to ns if exhaust mode. 0=normal mode*/
+        std::string prefetchNS; /* ns of a getMore whose next batch to prefetch after replying */
         DbResponse(Message *r, MSGID rt) : response(r), responseTo(rt){ }
         DbResponse() {
             response = 0;
@@ -110,7 +110,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -356,13 +356,14 @@ namespace mongo {
             }
 
             verify(member->hasLoc());
-            if (_dataMap.end() == _dataMap.find(member->loc)) {
+            DataMap::const_iterator hit = _dataMap.find(member->loc);
+            if (_dataMap.end() == hit) {
                 // Ignore.  It's not in any previous child.
             }
             else {
                 // We have a hit.  Copy data into the WSM we already have.
                 _seenMap.insert(member->loc);
-                WorkingSetMember* olderMember = _ws->get(_dataMap[member->loc]);
+                WorkingSetMember* olderMember = _ws->get(hit->second);
                 size_t memUsageBefore = olderMember->getMemUsage();
 
                 AndCommon::mergeFrom(olderMember, *member);
@@ -381,7 +382,7 @@ namespace mongo {
             // Keep elements of _dataMap that are in _seenMap.
             DataMap::iterator it = _dataMap.begin();
             while (it != _dataMap.end()) {
-                if (_seenMap.end() == _seenMap.find(it->first)) {
+                if (!_seenMap.contains(it->first)) {
                     DataMap::iterator toErase = it;
                     ++it;
 
@@ -33,6 +33,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_set.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
 #include "mongo/platform/unordered_set.h"
@@ -124,8 +125,7 @@ namespace mongo {
 
         // Keeps track of what elements from _dataMap subsequent children have seen.
         // Only used while _hashingChildren.
-        typedef unordered_set<RecordId, RecordId::Hasher> SeenMap;
-        SeenMap _seenMap;
+        RecordIdSet _seenMap;
 
         // True if we're still intersecting _children[0..._children.size()-1].
         bool _hashingChildren;
@@ -26,9 +26,25 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
 #include "mongo/db/exec/cached_plan.h"
+
+#include <algorithm>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/explain.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/stage_builder.h"
+#include "mongo/db/storage/record_fetcher.h"
+#include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 
 // for updateCache
@@ -42,23 +58,46 @@
 namespace mongo {
 
     using std::auto_ptr;
+    using std::list;
     using std::vector;
 
+    namespace {
+        Counter64 cachedPlanTrialCounter;
+        Counter64 cachedPlanReplanCounter;
+
+        ServerStatusMetricField<Counter64> displayCachedPlanTrials(
+            "queryExecutor.cachedPlan.trials", &cachedPlanTrialCounter);
+        ServerStatusMetricField<Counter64> displayCachedPlanReplans(
+            "queryExecutor.cachedPlan.replans", &cachedPlanReplanCounter);
+    }
+
     // static
     const char* CachedPlanStage::kStageType = "CACHED_PLAN";
 
-    CachedPlanStage::CachedPlanStage(const Collection* collection,
+    CachedPlanStage::CachedPlanStage(OperationContext* txn,
+                                     Collection* collection,
+                                     WorkingSet* ws,
                                      CanonicalQuery* cq,
+                                     const QueryPlannerParams& params,
+                                     size_t decisionWorks,
+                                     unsigned replanBackoff,
                                      PlanStage* mainChild,
                                      QuerySolution* mainQs,
                                      PlanStage* backupChild,
                                      QuerySolution* backupQs)
-        : _collection(collection),
+        : _txn(txn),
+          _collection(collection),
+          _ws(ws),
           _canonicalQuery(cq),
+          _plannerParams(params),
+          _decisionWorks(decisionWorks),
+          _replanBackoff(replanBackoff),
           _mainQs(mainQs),
           _backupQs(backupQs),
           _mainChildPlan(mainChild),
           _backupChildPlan(backupChild),
+          _trialEndState(PlanStage::NEED_TIME),
+          _trialEndId(WorkingSet::INVALID_ID),
           _usingBackupChild(false),
           _alreadyProduced(false),
           _updatedCache(false),
@@ -72,18 +111,201 @@ namespace mongo {
         }
     }
 
-    bool CachedPlanStage::isEOF() { return getActiveChild()->isEOF(); }
+    Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
+        const double ratio = internalQueryCacheReplanRatio;
+        if (0 == _decisionWorks || ratio <= 0) {
+            return Status::OK();
+        }
+
+        // The time spent here is part of executionTimeMillis, as in MultiPlanStage.
+        ScopedTimer timer(&_commonStats);
+        cachedPlanTrialCounter.increment();
+
+        const size_t maxWorks = static_cast<size_t>(ratio * _decisionWorks * _replanBackoff);
+
+        // Stop after a batch as big as the trial period that cached the plan would have taken.
+        size_t numResults = static_cast<size_t>(internalQueryPlanEvaluationMaxResults);
+        const size_t numToReturn = _canonicalQuery->getParsed().getNumToReturn();
+        if (numToReturn > 0) {
+            numResults = std::min(numToReturn, numResults);
+        }
+
+        for (size_t works = 0; works < maxWorks; ++works) {
+            Status yieldStatus = tryYield(yieldPolicy);
+            if (!yieldStatus.isOK()) {
+                return yieldStatus;
+            }
+
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = getActiveChild()->work(&id);
+
+            if (PlanStage::ADVANCED == state) {
+                _alreadyProduced = true;
+                _results.push_back(id);
+                if (_results.size() >= numResults) {
+                    return Status::OK();
+                }
+            }
+            else if (PlanStage::IS_EOF == state) {
+                return Status::OK();
+            }
+            else if (PlanStage::NEED_FETCH == state) {
+                WorkingSetMember* member = _ws->get(id);
+                invariant(member->hasFetcher());
+                _fetcher.reset(member->releaseFetcher());
+            }
+            else if (PlanStage::FAILURE == state
+                     && !_alreadyProduced
+                     && !_usingBackupChild
+                     && NULL != _backupChildPlan.get()) {
+                _usingBackupChild = true;
+            }
+            else if (PlanStage::NEED_TIME != state) {
+                // FAILURE or DEAD. work() reports it after the buffered results.
+                _trialEndState = state;
+                _trialEndId = id;
+                return Status::OK();
+            }
+        }
+
+        return replan(yieldPolicy);
+    }
+
+    Status CachedPlanStage::tryYield(PlanYieldPolicy* yieldPolicy) {
+        if (NULL != yieldPolicy && (yieldPolicy->shouldYield() || NULL != _fetcher.get())) {
+            if (!yieldPolicy->yield(_fetcher.get())) {
+                return Status(ErrorCodes::OperationFailed,
+                              "PlanExecutor killed during plan selection");
+            }
+        }
+
+        _fetcher.reset();
+        return Status::OK();
+    }
+
+    Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy) {
+        cachedPlanReplanCounter.increment();
+        _specificStats.replanned = true;
+
+        LOG(1) << "Cached plan needed more than " << internalQueryCacheReplanRatio << " * "
+               << _replanBackoff << " times its " << _decisionWorks
+               << " trial works, replanning: " << _canonicalQuery->toStringShort()
+               << ", planSummary: " << Explain::getPlanSummary(getActiveChild());
+
+        // The entry is going away, so it gets no feedback. Whatever wins below replaces it.
+        _updatedCache = true;
+        PlanCache* cache = _collection->infoCache()->getPlanCache();
+        cache->remove(*_canonicalQuery);
+
+        vector<QuerySolution*> rawSolutions;
+        Status status = QueryPlanner::plan(*_canonicalQuery, _plannerParams, &rawSolutions);
+        if (!status.isOK()) {
+            return Status(ErrorCodes::BadValue,
+                          "error processing query: " + _canonicalQuery->toString() +
+                          " planner returned error: " + status.reason());
+        }
+
+        OwnedPointerVector<QuerySolution> solutions(rawSolutions);
+
+        if (0 == solutions.size()) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream()
+                          << "error processing query: "
+                          << _canonicalQuery->toString()
+                          << " No query solutions");
+        }
+
+        // Nothing has been returned yet, so the buffered results and the old plan can go.
+        _results.clear();
+        _fetcher.reset();
+        _ws->clear();
+        _usingBackupChild = false;
+        _backupChildPlan.reset();
+        _mainChildPlan.reset();
+
+        if (1 == solutions.size()) {
+            PlanStage* root;
+            verify(StageBuilder::build(_txn, _collection, *solutions[0], _ws, &root));
+            _replannedChildPlan.reset(root);
+            _replannedQs.reset(solutions.popAndReleaseBack());
+            return Status::OK();
+        }
+
+        // Many solutions. The MultiPlanStage picks one and caches it.
+        MultiPlanStage* multiPlanStage = new MultiPlanStage(_txn, _collection, _canonicalQuery);
+        _replannedChildPlan.reset(multiPlanStage);
+
+        for (size_t ix = 0; ix < solutions.size(); ++ix) {
+            if (solutions[ix]->cacheData.get()) {
+                solutions[ix]->cacheData->indexFilterApplied = _plannerParams.indexFiltersApplied;
+            }
+
+            PlanStage* nextPlanRoot;
+            verify(StageBuilder::build(_txn, _collection, *solutions[ix], _ws, &nextPlanRoot));
+
+            // Takes ownership of 'solutions[ix]' and 'nextPlanRoot'.
+            multiPlanStage->addPlan(solutions.releaseAt(ix), nextPlanRoot, _ws);
+        }
+
+        Status planSelectStat = multiPlanStage->pickBestPlan(yieldPolicy);
+        if (!planSelectStat.isOK()) {
+            return planSelectStat;
+        }
+
+        // Make the next replan of this query shape wait longer, so shapes whose best plan
+        // depends on their parameters don't flip back and forth on every run.
+        unsigned replanBackoff = _replanBackoff * 2;
+        if (replanBackoff > kMaxReplanBackoff) {
+            replanBackoff = kMaxReplanBackoff;
+        }
+        cache->setReplanBackoff(*_canonicalQuery, replanBackoff);
+
+        return Status::OK();
+    }
+
+    bool CachedPlanStage::isEOF() {
+        return _results.empty()
+            && PlanStage::NEED_TIME == _trialEndState
+            && getActiveChild()->isEOF();
+    }
 
     PlanStage::StageState CachedPlanStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
+        // Return results buffered by the trial period first.
+        if (!_results.empty()) {
+            *out = _results.front();
+            _results.pop_front();
+            _commonStats.advanced++;
+            return PlanStage::ADVANCED;
+        }
+
+        if (PlanStage::NEED_TIME != _trialEndState) {
+            *out = _trialEndId;
+            return _trialEndState;
+        }
+
         StageState childStatus = getActiveChild()->work(out);
 
+        if (NULL != _replannedChildPlan.get()) {
+            // The cache entry for the replanned query belongs to its MultiPlanStage.
+            if (PlanStage::ADVANCED == childStatus) {
+                _commonStats.advanced++;
+            }
+            else if (PlanStage::NEED_FETCH == childStatus) {
+                _commonStats.needFetch++;
+            }
+            else if (PlanStage::NEED_TIME == childStatus) {
+                _commonStats.needTime++;
+            }
+            return childStatus;
+        }
+
         if (PlanStage::ADVANCED == childStatus) {
             // we'll skip backupPlan processing now
             _alreadyProduced = true;
@@ -113,43 +335,71 @@ namespace mongo {
     }
 
     void CachedPlanStage::saveState() {
-        _mainChildPlan->saveState();
-
+        _txn = NULL;
+        if (NULL != _mainChildPlan.get()) {
+            _mainChildPlan->saveState();
+        }
         if (NULL != _backupChildPlan.get()) {
             _backupChildPlan->saveState();
         }
+        if (NULL != _replannedChildPlan.get()) {
+            _replannedChildPlan->saveState();
+        }
         ++_commonStats.yields;
     }
 
     void CachedPlanStage::restoreState(OperationContext* opCtx) {
-        _mainChildPlan->restoreState(opCtx);
+        invariant(_txn == NULL);
+        _txn = opCtx;
 
+        if (NULL != _mainChildPlan.get()) {
+            _mainChildPlan->restoreState(opCtx);
+        }
         if (NULL != _backupChildPlan.get()) {
             _backupChildPlan->restoreState(opCtx);
         }
+        if (NULL != _replannedChildPlan.get()) {
+            _replannedChildPlan->restoreState(opCtx);
+        }
         ++_commonStats.unyields;
     }
 
     void CachedPlanStage::invalidate(OperationContext* txn,
                                      const RecordId& dl,
                                      InvalidationType type) {
-        if (! _usingBackupChild) {
-            _mainChildPlan->invalidate(txn, dl, type);
+        if (NULL != _replannedChildPlan.get()) {
+            _replannedChildPlan->invalidate(txn, dl, type);
         }
-        if (NULL != _backupChildPlan.get()) {
-            _backupChildPlan->invalidate(txn, dl, type);
+        else {
+            if (! _usingBackupChild) {
+                _mainChildPlan->invalidate(txn, dl, type);
+            }
+            if (NULL != _backupChildPlan.get()) {
+                _backupChildPlan->invalidate(txn, dl, type);
+            }
+        }
+
+        // Buffered results can't wait for the document to be fetched later.
+        for (list<WorkingSetID>::iterator it = _results.begin(); it != _results.end();) {
+            WorkingSetMember* member = _ws->get(*it);
+            if (member->hasLoc() && member->loc == dl) {
+                list<WorkingSetID>::iterator next = it;
+                ++next;
+                WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+                _ws->flagForReview(*it);
+                _results.erase(it);
+                it = next;
+            }
+            else {
+                ++it;
+            }
         }
         ++_commonStats.invalidates;
     }
 
     vector<PlanStage*> CachedPlanStage::getChildren() const {
         vector<PlanStage*> children;
-        if (_usingBackupChild) {
-            children.push_back(_backupChildPlan.get());
-        }
-        else {
-            children.push_back(_mainChildPlan.get());
-        }
+        children.push_back(getActiveChild());
         return children;
     }
 
@@ -158,13 +408,7 @@ namespace mongo {
 
         auto_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_CACHED_PLAN));
         ret->specific.reset(new CachedPlanStats(_specificStats));
-
-        if (_usingBackupChild) {
-            ret->children.push_back(_backupChildPlan->getStats());
-        }
-        else {
-            ret->children.push_back(_mainChildPlan->getStats());
-        }
+        ret->children.push_back(getActiveChild()->getStats());
 
         return ret.release();
     }
@@ -198,6 +442,9 @@ namespace mongo {
     }
 
     PlanStage* CachedPlanStage::getActiveChild() const {
+        if (NULL != _replannedChildPlan.get()) {
+            return _replannedChildPlan.get();
+        }
         return _usingBackupChild ? _backupChildPlan.get() : _mainChildPlan.get();
     }
 
@@ -28,10 +28,15 @@
 
 #pragma once
 
+#include <boost/scoped_ptr.hpp>
+#include <list>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_planner_params.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/record_id.h"
 
@@ -41,6 +46,10 @@ namespace mongo {
      * This stage outputs its mainChild, and possibly its backup child
      * and also updates the cache.
      *
+     * Before producing output, pickBestPlan() runs the cached plan for a trial period. If it
+     * needs many times the works it took to win its place in the cache, the entry is evicted
+     * and the query replanned, and this stage outputs the newly chosen plan instead.
+     *
      * Preconditions: Valid RecordId.
      *
      */
@@ -48,9 +57,18 @@ namespace mongo {
     public:
         /**
          * Takes ownership of 'mainChild', 'mainQs', 'backupChild', and 'backupQs'.
+         *
+         * 'decisionWorks' is how many works the cached plan needed in the trial period that
+         * chose it, and 'replanBackoff' the backoff of its cache entry. A 'decisionWorks' of zero
+         * turns replanning off.
          */
-        CachedPlanStage(const Collection* collection,
+        CachedPlanStage(OperationContext* txn,
+                        Collection* collection,
+                        WorkingSet* ws,
                         CanonicalQuery* cq,
+                        const QueryPlannerParams& params,
+                        size_t decisionWorks,
+                        unsigned replanBackoff,
                         PlanStage* mainChild,
                         QuerySolution* mainQs,
                         PlanStage* backupChild = NULL,
@@ -76,18 +94,55 @@ namespace mongo {
 
         virtual const SpecificStats* getSpecificStats();
 
+        /**
+         * Works the cached plan until it returns a batch of results or hits EOF, buffering the
+         * results. If that takes more than the allowed number of works, evicts the cache entry
+         * and replans the query from scratch.
+         *
+         * If 'yieldPolicy' is non-NULL, locks may be yielded between works.
+         *
+         * Returns a non-OK status if killed during a yield or if replanning fails.
+         */
+        Status pickBestPlan(PlanYieldPolicy* yieldPolicy);
+
+        /** Returns true if the cached plan was abandoned for a newly chosen one. */
+        bool replanned() const { return _specificStats.replanned; }
+
         static const char* kStageType;
 
     private:
         PlanStage* getActiveChild() const;
         void updateCache();
 
+        /**
+         * Throws away the cached plan and its buffered results, removes its cache entry and
+         * plans the query again. The new plan is cached, with a longer backoff, as usual.
+         */
+        Status replan(PlanYieldPolicy* yieldPolicy);
+
+        /** Yields if 'yieldPolicy' says so or a fetch is pending. See MultiPlanStage. */
+        Status tryYield(PlanYieldPolicy* yieldPolicy);
+
+        // The longest a cache entry's backoff can grow.
+        static const unsigned kMaxReplanBackoff = 64;
+
         // not owned
-        const Collection* _collection;
+        OperationContext* _txn;
+
+        // not owned
+        Collection* _collection;
+
+        // not owned
+        WorkingSet* _ws;
 
         // not owned
         CanonicalQuery* _canonicalQuery;
 
+        QueryPlannerParams _plannerParams;
+
+        size_t _decisionWorks;
+        unsigned _replanBackoff;
+
         // Owned by us. Must be deleted after the corresponding PlanStage trees, as
         // those trees point into the query solutions.
         boost::scoped_ptr<QuerySolution> _mainQs;
@@ -98,6 +153,22 @@ namespace mongo {
         boost::scoped_ptr<PlanStage> _mainChildPlan;
         boost::scoped_ptr<PlanStage> _backupChildPlan;
 
+        // Set if the query was replanned. The solution is only kept when there was a single
+        // one; a MultiPlanStage owns its own.
+        boost::scoped_ptr<QuerySolution> _replannedQs;
+        boost::scoped_ptr<PlanStage> _replannedChildPlan;
+
+        // Results produced by the trial period in pickBestPlan(), returned before any others.
+        std::list<WorkingSetID> _results;
+
+        // A fetch requested by the child during the trial period, done at the next yield.
+        boost::scoped_ptr<RecordFetcher> _fetcher;
+
+        // A FAILURE or DEAD state that ended the trial period, and the WorkingSetID that came
+        // with it. NEED_TIME if there was none.
+        StageState _trialEndState;
+        WorkingSetID _trialEndId;
+
         // True if the main plan errors before producing results
         // and if a backup plan is available (can happen with blocking sorts)
         bool _usingBackupChild;
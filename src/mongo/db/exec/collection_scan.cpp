@@ -31,6 +31,7 @@
 #include "mongo/db/exec/collection_scan.h"
 
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -50,6 +51,9 @@ namespace mongo {
     // static
     const char* CollectionScan::kStageType = "COLLSCAN";
 
+    // static
+    const size_t CollectionScan::kMaxRecordsPerWork = 64;
+
     CollectionScan::CollectionScan(OperationContext* txn,
                                    const CollectionScanParams& params,
                                    WorkingSet* workingSet,
@@ -75,7 +79,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (_isDead) { return PlanStage::DEAD; }
 
@@ -111,64 +115,69 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
 
-        // Should we try getNext() on the underlying _iter?
-        if (isEOF())
-            return PlanStage::IS_EOF;
-
-        const RecordId curr = _iter->curr();
-        if (curr.isNull()) {
-            // We just hit EOF
-            if (_params.tailable)
-                _iter.reset(); // pick up where we left off on the next call to work()
-            return PlanStage::IS_EOF;
-        }
+        // Records rejected by the filter are skipped inside this loop rather than being handed
+        // back up the tree one NEED_TIME at a time, and are tested against the raw record data
+        // so that they never cost a WorkingSetMember. The loop is bounded so that a very
+        // selective scan still returns to the executor often enough to yield.
+        for (size_t scanned = 1; ; ++scanned) {
+            // Should we try getNext() on the underlying _iter?
+            if (isEOF())
+                return PlanStage::IS_EOF;
+
+            const RecordId curr = _iter->curr();
+            if (curr.isNull()) {
+                // We just hit EOF
+                if (_params.tailable)
+                    _iter.reset(); // pick up where we left off on the next call to work()
+                return PlanStage::IS_EOF;
+            }
 
-        _lastSeenLoc = curr;
-
-        // See if the record we're about to access is in memory. If not, pass a fetch request up.
-        // Note that curr() does not touch the record (on MMAPv1 which is the only place we use
-        // NEED_FETCH) so we are able to yield before touching the record, as long as we do so
-        // before calling getNext().
-        {
-            std::auto_ptr<RecordFetcher> fetcher(
-                _params.collection->documentNeedsFetch(_txn, curr));
-            if (NULL != fetcher.get()) {
-                WorkingSetMember* member = _workingSet->get(_wsidForFetch);
-                member->loc = curr;
-                // Pass the RecordFetcher off to the WSM.
-                member->setFetcher(fetcher.release());
-                *out = _wsidForFetch;
-                _commonStats.needFetch++;
-                return NEED_FETCH;
+            _lastSeenLoc = curr;
+
+            // See if the record we're about to access is in memory. If not, pass a fetch request
+            // up. Note that curr() does not touch the record (on MMAPv1 which is the only place
+            // we use NEED_FETCH) so we are able to yield before touching the record, as long as
+            // we do so before calling getNext().
+            {
+                std::auto_ptr<RecordFetcher> fetcher(
+                    _params.collection->documentNeedsFetch(_txn, curr));
+                if (NULL != fetcher.get()) {
+                    WorkingSetMember* member = _workingSet->get(_wsidForFetch);
+                    member->loc = curr;
+                    // Pass the RecordFetcher off to the WSM.
+                    member->setFetcher(fetcher.release());
+                    *out = _wsidForFetch;
+                    _commonStats.needFetch++;
+                    return NEED_FETCH;
+                }
             }
-        }
 
-        WorkingSetID id = _workingSet->allocate();
-        WorkingSetMember* member = _workingSet->get(id);
-        member->loc = curr;
-        member->obj = _iter->dataFor(member->loc).releaseToBson();
-        member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+            RecordData data = _iter->dataFor(curr);
+            ++_specificStats.docsTested;
+            _txn->getCurOp()->recordStorageBytesRead(data.size());
 
-        // Advance the iterator.
-        invariant(_iter->getNext() == curr);
+            if (Filter::passes(data.toBson(), _filter)) {
+                WorkingSetID id = _workingSet->allocate();
+                WorkingSetMember* member = _workingSet->get(id);
+                member->loc = curr;
+                member->obj = data.releaseToBson();
+                member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
 
-        return returnIfMatches(member, id, out);
-    }
+                // Advance the iterator.
+                invariant(_iter->getNext() == curr);
 
-    PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
-                                                          WorkingSetID memberID,
-                                                          WorkingSetID* out) {
-        ++_specificStats.docsTested;
+                *out = id;
+                ++_commonStats.advanced;
+                return PlanStage::ADVANCED;
+            }
 
-        if (Filter::passes(member, _filter)) {
-            *out = memberID;
-            ++_commonStats.advanced;
-            return PlanStage::ADVANCED;
-        }
-        else {
-            _workingSet->free(memberID);
-            ++_commonStats.needTime;
-            return PlanStage::NEED_TIME;
+            // Advance the iterator.
+            invariant(_iter->getNext() == curr);
+
+            if (scanned >= kMaxRecordsPerWork) {
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
         }
     }
 
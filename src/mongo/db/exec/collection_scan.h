@@ -73,15 +73,11 @@ namespace mongo {
 
         static const char* kStageType;
 
-    private:
-        /**
-         * If the member (with id memberID) passes our filter, set *out to memberID and return that
-         * ADVANCED.  Otherwise, free memberID and return NEED_TIME.
-         */
-        StageState returnIfMatches(WorkingSetMember* member,
-                                   WorkingSetID memberID,
-                                   WorkingSetID* out);
+        // The most records a single call to work() will examine before returning NEED_TIME
+        // when none of them pass the filter.
+        static const size_t kMaxRecordsPerWork;
 
+    private:
         // transactional context for read locks. Not owned by us
         OperationContext* _txn;
 
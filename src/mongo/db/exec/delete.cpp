@@ -36,6 +36,7 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/query/canonical_query.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/util/log.h"
@@ -69,6 +70,9 @@ namespace mongo {
         if (!_params.isMulti && _specificStats.docsDeleted > 0) {
             return true;
         }
+        if (_params.limit > 0 && _specificStats.docsDeleted >= _params.limit) {
+            return true;
+        }
         return _child->isEOF();
     }
 
@@ -76,7 +80,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
         invariant(_collection); // If isEOF() returns false, we must have a collection.
@@ -97,6 +101,11 @@ namespace mongo {
                 return PlanStage::NEED_TIME;
             }
             RecordId rloc = member->loc;
+            BSONObj docToReturn;
+            if (_params.returnDeleted) {
+                invariant(member->hasObj());
+                docToReturn = member->obj;
+            }
 
             // If the working set member is in the owned obj with loc state, then the document may
             // have already been deleted after-being force-fetched.
@@ -107,8 +116,21 @@ namespace mongo {
                     ++_commonStats.needTime;
                     return PlanStage::NEED_TIME;
                 }
+
+                // The doc may also have been updated since being force-fetched, so make sure it
+                // still matches the predicate.
+                CanonicalQuery* cq = _params.canonicalQuery;
+                if (cq && !cq->root()->matchesBSON(deletedDoc, NULL)) {
+                    ++_commonStats.needTime;
+                    return PlanStage::NEED_TIME;
+                }
+                docToReturn = deletedDoc;
             }
 
+            // The returned document must outlive the record we are about to delete.
+            if (_params.returnDeleted) {
+                docToReturn = docToReturn.getOwned();
+            }
             _ws->free(id);
 
             BSONObj deletedDoc;
@@ -151,6 +173,15 @@ namespace mongo {
 
             ++_specificStats.docsDeleted;
 
+            if (_params.returnDeleted) {
+                *out = _ws->allocate();
+                WorkingSetMember* deleted = _ws->get(*out);
+                deleted->obj = docToReturn;
+                deleted->state = WorkingSetMember::OWNED_OBJ;
+                ++_commonStats.advanced;
+                return PlanStage::ADVANCED;
+            }
+
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
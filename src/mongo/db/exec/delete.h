@@ -35,6 +35,7 @@
 
 namespace mongo {
 
+    class CanonicalQuery;
     class OperationContext;
     class PlanExecutor;
 
@@ -43,7 +44,10 @@ namespace mongo {
             isMulti(false),
             shouldCallLogOp(false),
             fromMigrate(false),
-            isExplain(false) { }
+            isExplain(false),
+            returnDeleted(false),
+            limit(0),
+            canonicalQuery(NULL) { }
 
         // Should we delete all documents returned from the child (a "multi delete"), or at most one
         // (a "single delete")?
@@ -58,11 +62,22 @@ namespace mongo {
 
         // Are we explaining a delete command rather than actually executing it?
         bool isExplain;
+
+        // Should we return each deleted document to our caller? Only single deletes may.
+        bool returnDeleted;
+
+        // For a multi delete, stop after deleting this many documents. Zero means no limit.
+        long long limit;
+
+        // The parsed query predicate, used to rematch documents that may have changed while
+        // we yielded. Not owned here. NULL for idhack deletes.
+        CanonicalQuery* canonicalQuery;
     };
 
     /**
      * This stage delete documents by RecordId that are returned from its child.  NEED_TIME
-     * is returned after deleting a document.
+     * is returned after deleting a document, or ADVANCED with an owned copy of the deleted
+     * document if returnDeleted is set.
      *
      * Callers of work() must be holding a write lock (and, for shouldCallLogOp=true deletes,
      * callers must have had the replication coordinator approve the write).
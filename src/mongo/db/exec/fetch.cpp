@@ -32,7 +32,9 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -41,6 +43,24 @@ namespace mongo {
     using std::auto_ptr;
     using std::vector;
 
+    namespace {
+
+        size_t readAheadWindow(const Collection* collection) {
+            if (NULL == collection || internalQueryExecFetchReadAheadDocs <= 0) {
+                return 0;
+            }
+
+            // Queued RecordIds are only safe to keep across yields if the storage engine
+            // invalidates them, which is what supportsPrefetch() promises.
+            if (!collection->getRecordStore()->supportsPrefetch()) {
+                return 0;
+            }
+
+            return internalQueryExecFetchReadAheadDocs;
+        }
+
+    }  // namespace
+
     // static
     const char* FetchStage::kStageType = "FETCH";
 
@@ -55,9 +75,15 @@ namespace mongo {
           _child(child),
           _filter(filter),
           _idBeingPagedIn(WorkingSet::INVALID_ID),
+          _readAheadWindow(readAheadWindow(collection)),
           _commonStats(kStageType) { }
 
-    FetchStage::~FetchStage() { }
+    FetchStage::~FetchStage() {
+        for (std::map<WorkingSetID, RecordFetcher*>::const_iterator it = _queuedFetchers.begin();
+             it != _queuedFetchers.end(); ++it) {
+            delete it->second;
+        }
+    }
 
     bool FetchStage::isEOF() {
         if (WorkingSet::INVALID_ID != _idBeingPagedIn) {
@@ -66,6 +92,10 @@ namespace mongo {
             return false;
         }
 
+        if (!_readAhead.empty()) {
+            return false;
+        }
+
         return _child->isEOF();
     }
 
@@ -73,7 +103,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -88,49 +118,143 @@ namespace mongo {
             return returnIfMatches(member, id, out);
         }
 
+        if (_readAheadWindow > 0) {
+            return workWithReadAhead(out);
+        }
+
         // If we're here, we're not waiting for a RecordId to be fetched.  Get another to-be-fetched
         // result from our child.
         WorkingSetID id = WorkingSet::INVALID_ID;
         StageState status = _child->work(&id);
 
         if (PlanStage::ADVANCED == status) {
-            WorkingSetMember* member = _ws->get(id);
+            return fetchMember(id, out);
+        }
+
+        return propagateChildState(status, id, out);
+    }
+
+    PlanStage::StageState FetchStage::workWithReadAhead(WorkingSetID* out) {
+        // Top up the queue from the child, remembering which of the new results have a record
+        // left to read.
+        std::vector<RecordId> toCheck;
+        std::vector<WorkingSetID> toCheckIds;
+        StageState status = PlanStage::ADVANCED;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        while (_readAhead.size() < _readAheadWindow && !_child->isEOF()) {
+            id = WorkingSet::INVALID_ID;
+            status = _child->work(&id);
+            if (PlanStage::ADVANCED != status) {
+                break;
+            }
 
-            // If there's an obj there, there is no fetching to perform.
-            if (member->hasObj()) {
-                ++_specificStats.alreadyHasObj;
+            WorkingSetMember* member = _ws->get(id);
+            if (!member->hasObj() && member->hasLoc() && !member->loc.isNull()) {
+                toCheck.push_back(member->loc);
+                toCheckIds.push_back(id);
             }
-            else {
-                // We need a valid loc to fetch from and this is the only state that has one.
-                verify(WorkingSetMember::LOC_AND_IDX == member->state);
-                verify(member->hasLoc());
-
-                // We might need to retrieve 'nextLoc' from secondary storage, in which case we send
-                // a NEED_FETCH request up to the PlanExecutor.
-                if (!member->loc.isNull()) {
-                    std::auto_ptr<RecordFetcher> fetcher(
-                        _collection->documentNeedsFetch(_txn, member->loc));
-                    if (NULL != fetcher.get()) {
-                        // There's something to fetch. Hand the fetcher off to the WSM, and pass up
-                        // a fetch request.
-                        _idBeingPagedIn = id;
-                        member->setFetcher(fetcher.release());
-                        *out = id;
-                        _commonStats.needFetch++;
-                        return NEED_FETCH;
-                    }
+            _readAhead.push_back(id);
+        }
+
+        if (!toCheck.empty()) {
+            // Find out which of the new records are in memory all at once, and only prefetch the
+            // ones which are not. The answers are used when the results are fetched, so that
+            // those are not checked again one by one.
+            OwnedPointerVector<RecordFetcher> fetchers;
+            _collection->getRecordStore()->recordsNeedFetch(_txn, toCheck, &fetchers);
+            invariant(fetchers.size() == toCheck.size());
+
+            std::vector<RecordId> toPrefetch;
+            for (size_t i = 0; i < toCheck.size(); i++) {
+                if (NULL != fetchers[i]) {
+                    toPrefetch.push_back(toCheck[i]);
                 }
+                _queuedFetchers[toCheckIds[i]] = fetchers.releaseAt(i);
+            }
 
-                // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
-                // as well as an unowned object
-                member->obj = _collection->docFor(_txn, member->loc);
-                member->keyData.clear();
-                member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+            if (!toPrefetch.empty()) {
+                _collection->getRecordStore()->prefetchRecords(_txn, toPrefetch);
+                _specificStats.docsPrefetched += toPrefetch.size();
             }
+        }
 
-            return returnIfMatches(member, id, out);
+        // A NEED_TIME from the child just means the queue gets topped up on the next call, as
+        // long as there is something queued to return now.
+        const bool keepGoing = PlanStage::ADVANCED == status
+                               || PlanStage::IS_EOF == status
+                               || (PlanStage::NEED_TIME == status && !_readAhead.empty());
+        if (!keepGoing) {
+            return propagateChildState(status, id, out);
         }
-        else if (PlanStage::FAILURE == status) {
+
+        if (_readAhead.empty()) {
+            // The child ran out and there is nothing left queued.
+            return PlanStage::IS_EOF;
+        }
+
+        WorkingSetID next = _readAhead.front();
+        _readAhead.pop_front();
+        return fetchMember(next, out);
+    }
+
+    bool FetchStage::takeQueuedFetcher(WorkingSetID id, std::auto_ptr<RecordFetcher>* fetcher) {
+        std::map<WorkingSetID, RecordFetcher*>::iterator it = _queuedFetchers.find(id);
+        if (it == _queuedFetchers.end()) {
+            return false;
+        }
+
+        fetcher->reset(it->second);
+        _queuedFetchers.erase(it);
+        return true;
+    }
+
+    PlanStage::StageState FetchStage::fetchMember(WorkingSetID id, WorkingSetID* out) {
+        WorkingSetMember* member = _ws->get(id);
+
+        // Whether the record is in memory may already be known from when 'id' was read ahead.
+        std::auto_ptr<RecordFetcher> fetcher;
+        const bool fetchChecked = takeQueuedFetcher(id, &fetcher);
+
+        // If there's an obj there, there is no fetching to perform.
+        if (member->hasObj()) {
+            ++_specificStats.alreadyHasObj;
+        }
+        else {
+            // We need a valid loc to fetch from and this is the only state that has one.
+            verify(WorkingSetMember::LOC_AND_IDX == member->state);
+            verify(member->hasLoc());
+
+            // We might need to retrieve 'nextLoc' from secondary storage, in which case we send
+            // a NEED_FETCH request up to the PlanExecutor.
+            if (!member->loc.isNull()) {
+                if (!fetchChecked) {
+                    fetcher.reset(_collection->documentNeedsFetch(_txn, member->loc));
+                }
+                if (NULL != fetcher.get()) {
+                    // There's something to fetch. Hand the fetcher off to the WSM, and pass up
+                    // a fetch request.
+                    _idBeingPagedIn = id;
+                    member->setFetcher(fetcher.release());
+                    *out = id;
+                    _commonStats.needFetch++;
+                    return NEED_FETCH;
+                }
+            }
+
+            // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
+            // as well as an unowned object
+            member->obj = _collection->docFor(_txn, member->loc);
+            member->keyData.clear();
+            member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+        }
+
+        return returnIfMatches(member, id, out);
+    }
+
+    PlanStage::StageState FetchStage::propagateChildState(StageState status,
+                                                          WorkingSetID id,
+                                                          WorkingSetID* out) {
+        if (PlanStage::FAILURE == status) {
             *out = id;
             // If a stage fails, it may create a status WSM to indicate why it
             // failed, in which case 'id' is valid.  If ID is invalid, we
@@ -181,6 +305,19 @@ namespace mongo {
                 WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
             }
         }
+
+        // The same goes for any result queued for read ahead.
+        for (std::deque<WorkingSetID>::const_iterator it = _readAhead.begin();
+             it != _readAhead.end(); ++it) {
+            WorkingSetMember* member = _ws->get(*it);
+            if (member->hasLoc() && (member->loc == dl)) {
+                WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+                ++_specificStats.forcedFetches;
+
+                std::auto_ptr<RecordFetcher> stale;
+                takeQueuedFetcher(*it, &stale);
+            }
+        }
     }
 
     PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
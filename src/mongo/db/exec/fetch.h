@@ -29,6 +29,8 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <deque>
+#include <map>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
@@ -44,7 +46,14 @@ namespace mongo {
      * the record at the provided loc.  Returns verbatim any data that already has an object.
      *
      * Preconditions: Valid RecordId.
+     *
+     * If internalQueryExecFetchReadAheadDocs is set and the record store supports prefetching,
+     * the stage keeps up to that many results from its child queued and passes the RecordIds of
+     * newly queued results to the storage engine, so that their I/O overlaps with returning the
+     * results ahead of them. Results are still returned in the order the child produced them.
      */
+    class RecordFetcher;
+
     class FetchStage : public PlanStage {
     public:
         FetchStage(OperationContext* txn,
@@ -83,6 +92,30 @@ namespace mongo {
         StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID,
                                    WorkingSetID* out);
 
+        /**
+         * Turns the child's result 'id' into a document, or requests a fetch for it. Returns
+         * what work() should return.
+         */
+        StageState fetchMember(WorkingSetID id, WorkingSetID* out);
+
+        /**
+         * Handles a child state other than ADVANCED, returning what work() should return.
+         */
+        StageState propagateChildState(StageState status, WorkingSetID id, WorkingSetID* out);
+
+        /**
+         * work() when reading ahead: tops up '_readAhead' from the child, prefetches what was
+         * added and then returns the oldest queued result.
+         */
+        StageState workWithReadAhead(WorkingSetID* out);
+
+        /**
+         * Forgets whether the record of the queued result 'id' was in memory when it was queued.
+         * Returns true if that was known, in which case 'fetcher' takes what the storage engine
+         * gave back for it: NULL if the record was in memory.
+         */
+        bool takeQueuedFetcher(WorkingSetID id, std::auto_ptr<RecordFetcher>* fetcher);
+
         OperationContext* _txn;
 
         // Collection which is used by this stage. Used to resolve record ids retrieved by child
@@ -110,6 +143,20 @@ namespace mongo {
         // CollectionScan for when '_idBeingPagedIn' is invalidated before it can be returned.
         WorkingSetID _idBeingPagedIn;
 
+        // Maximum number of results queued in '_readAhead', or zero if this stage doesn't read
+        // ahead.
+        const size_t _readAheadWindow;
+
+        // Results from the child, in the order they were produced, whose RecordIds have been
+        // handed to the storage engine for prefetching. Invalidations are handled as for
+        // '_idBeingPagedIn'.
+        std::deque<WorkingSetID> _readAhead;
+
+        // For results in '_readAhead' whose records the storage engine was asked about in one
+        // batch as they were queued, what it answered: NULL if the record was in memory, or else
+        // the RecordFetcher with which to page it in. Owns the RecordFetchers.
+        std::map<WorkingSetID, RecordFetcher*> _queuedFetchers;
+
         // Stats
         CommonStats _commonStats;
         FetchStats _specificStats;
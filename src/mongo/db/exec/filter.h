@@ -31,6 +31,7 @@
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/matchable.h"
+#include "mongo/db/matcher/path_internal.h"
 
 namespace mongo {
 
@@ -93,6 +94,15 @@ namespace mongo {
             delete iterator;
         }
 
+        virtual bool getSingleElement(const ElementPath* path, BSONElement* out) const {
+            if (!_wsm->hasObj()) {
+                return false;
+            }
+            size_t idxPath = 0;
+            *out = getFieldDottedOrArray(_wsm->obj, path->fieldRef(), &idxPath);
+            return out->type() != Array;
+        }
+
     private:
         WorkingSetMember* _wsm;
     };
@@ -158,6 +168,15 @@ namespace mongo {
             return filter->matches(&doc, NULL);
         }
 
+        /**
+         * Returns true if filter is NULL or if the full document 'obj' satisfies the filter.
+         * Lets a stage test a record before paying for a WorkingSetMember.
+         */
+        static bool passes(const BSONObj& obj, const MatchExpression* filter) {
+            if (NULL == filter) { return true; }
+            return filter->matchesBSON(obj, NULL);
+        }
+
         static bool passes(const BSONObj& keyData,
                            const BSONObj& keyPattern,
                            const MatchExpression* filter) {
@@ -66,6 +66,41 @@ namespace mongo {
 
     namespace {
 
+        /**
+         * Picks the width of the next annulus from the density of results buffered in the last
+         * one, so that the next annulus is expected to buffer about
+         * internalGeoNearQueryTargetResultsPerAnnulus results.  This keeps the buffer (and the
+         * latency before the first result) bounded in dense regions while covering sparse regions
+         * in few steps.
+         *
+         * The area is approximated as planar, and the width may change by at most a factor of 4
+         * per interval so that a single unusually sparse or dense annulus can't throw it off.
+         */
+        double nextBoundsIncrement(const IntervalStats& lastIntervalStats,
+                                   double lastIncrement) {
+
+            const double kMaxIncrementChange = 4.0;
+
+            if (lastIntervalStats.numResultsBuffered <= 0) {
+                return lastIncrement * 2;
+            }
+
+            const double inner = std::max(lastIntervalStats.minDistanceAllowed, 0.0);
+            const double outer = lastIntervalStats.maxDistanceAllowed;
+            const double lastArea = outer * outer - inner * inner;
+            if (lastArea <= 0) {
+                return lastIncrement * 2;
+            }
+
+            const double target = std::max(internalGeoNearQueryTargetResultsPerAnnulus, 1);
+            const double nextArea =
+                lastArea * target / static_cast<double>(lastIntervalStats.numResultsBuffered);
+            const double nextIncrement = sqrt(outer * outer + nextArea) - outer;
+
+            return std::min(std::max(nextIncrement, lastIncrement / kMaxIncrementChange),
+                            lastIncrement * kMaxIncrementChange);
+        }
+
         /**
          * Structure that holds BSON addresses (BSONElements) and the corresponding geometry parsed
          * at those locations.
@@ -338,6 +373,9 @@ namespace mongo {
         vector<GeoHash> neighbors;
         // Return the neighbors of closest vertex to this cell at the given level.
         _centroidCell.appendVertexNeighbors(_currentLevel, &neighbors);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            neighbors[i] = _converter->toKeyOrder(neighbors[i]);
+        }
         std::sort(neighbors.begin(), neighbors.end());
 
         for (vector<GeoHash>::const_iterator it = neighbors.begin(); it != neighbors.end(); it++) {
@@ -537,7 +575,8 @@ namespace mongo {
             virtual bool matchesSingleElement(const BSONElement& e) const {
                 // Something has gone terribly wrong if this doesn't hold.
                 invariant(BinData == e.type());
-                return !_region->fastDisjoint(_unhasher.unhashToBoxCovering(_unhasher.hash(e)));
+                const GeoHash cell = _unhasher.fromKeyOrder(_unhasher.hash(e));
+                return !_region->fastDisjoint(_unhasher.unhashToBoxCovering(cell));
             }
 
             //
@@ -657,12 +696,7 @@ namespace mongo {
         if (!stats->intervalStats.empty()) {
 
             const IntervalStats& lastIntervalStats = stats->intervalStats.back();
-
-            // TODO: Generally we want small numbers of results fast, then larger numbers later
-            if (lastIntervalStats.numResultsBuffered < 300)
-                _boundsIncrement *= 2;
-            else if (lastIntervalStats.numResultsBuffered > 600)
-                _boundsIncrement /= 2;
+            _boundsIncrement = nextBoundsIncrement(lastIntervalStats, _boundsIncrement);
         }
 
         _boundsIncrement = max(_boundsIncrement,
@@ -1118,12 +1152,7 @@ namespace mongo {
         if (!stats->intervalStats.empty()) {
 
             const IntervalStats& lastIntervalStats = stats->intervalStats.back();
-
-            // TODO: Generally we want small numbers of results fast, then larger numbers later
-            if (lastIntervalStats.numResultsBuffered < 300)
-                _boundsIncrement *= 2;
-            else if (lastIntervalStats.numResultsBuffered > 600)
-                _boundsIncrement /= 2;
+            _boundsIncrement = nextBoundsIncrement(lastIntervalStats, _boundsIncrement);
         }
 
         invariant(_boundsIncrement > 0.0);
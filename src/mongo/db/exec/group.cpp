@@ -122,6 +122,18 @@ namespace mongo {
         }
     }
 
+    void GroupStage::switchToScripting() {
+        invariant(_nativeReducer);
+        initGroupScripting();
+
+        for (size_t i = 0; i < _nativeReducer->numGroups(); i++) {
+            _scope->setObject("$nativeGroup", _nativeReducer->getGroup(i), false);
+            _scope->exec("$arr.push($nativeGroup);", "$group native groups", false, true, true,
+                         100);
+        }
+        _nativeReducer.reset();
+    }
+
     Status GroupStage::processObject(const BSONObj& obj) {
         BSONObj key;
         Status getKeyStatus = getKey(obj, _request.keyPattern, _keyFunction, _scope.get(),
@@ -130,16 +142,27 @@ namespace mongo {
             return getKeyStatus;
         }
 
+        if (_nativeReducer && !_nativeReducer->canReduce(key, obj)) {
+            switchToScripting();
+        }
+
         int& n = _groupMap[key];
         if (n == 0) {
             n = _groupMap.size();
-            _scope->setObject("$key", key, true);
+            if (!_nativeReducer) {
+                _scope->setObject("$key", key, true);
+            }
             if (n > 20000) {
                 return Status(ErrorCodes::BadValue,
                               "group() can't handle more than 20000 unique keys");
             }
         }
 
+        if (_nativeReducer) {
+            _nativeReducer->reduce(n - 1, key, obj);
+            return Status::OK();
+        }
+
         _scope->setObject("obj", obj, true);
         _scope->setNumber("n", n - 1);
         if (_scope->invoke(_reduceFunction, 0, 0, 0, true)) {
@@ -151,6 +174,16 @@ namespace mongo {
     }
 
     BSONObj GroupStage::finalizeResults() {
+        if (_nativeReducer) {
+            _specificStats.nGroups = _groupMap.size();
+
+            BSONArrayBuilder results;
+            for (size_t i = 0; i < _nativeReducer->numGroups(); i++) {
+                results.append(_nativeReducer->getGroup(i));
+            }
+            return results.obj();
+        }
+
         if (!_request.finalize.empty()) {
             _scope->exec("$finalize = " + _request.finalize, "$group finalize define", false,
                          true, true, 100);
@@ -178,13 +211,17 @@ namespace mongo {
     PlanStage::StageState GroupStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
-        // On the first call to work(), call initGroupScripting().
+        // On the first call to work(), call initGroupScripting(), unless the reduce function
+        // can run without Javascript.
         if (_groupState == GroupState_Initializing) {
-            initGroupScripting();
+            _nativeReducer.reset(NativeGroupReducer::make(_request));
+            if (!_nativeReducer) {
+                initGroupScripting();
+            }
             _groupState = GroupState_ReadingFromChild;
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
@@ -30,6 +30,7 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "mongo/db/exec/group_native_reducer.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/scripting/engine.h"
 
@@ -125,6 +126,10 @@ namespace mongo {
         // Initializes _scope, _reduceFunction and _keyFunction using the global scripting engine.
         void initGroupScripting();
 
+        // Moves the groups reduced so far by _nativeReducer into "$arr", so that the rest of the
+        // documents are reduced by Javascript.
+        void switchToScripting();
+
         // Updates _groupMap and _scope to account for the group key associated with this object.
         // Returns an error status if an error occurred, else Status::OK().
         Status processObject(const BSONObj& obj);
@@ -161,6 +166,9 @@ namespace mongo {
         // Initialized by initGroupScripting().  Owned by _scope.
         ScriptingFunction _keyFunction;
 
+        // Reduces the documents without Javascript while it can, else NULL.  Owned here.
+        boost::scoped_ptr<NativeGroupReducer> _nativeReducer;
+
         // Map from group key => group index.  The group index is used to index into "$arr", a
         // variable owned by _scope which contains the group data for this key.
         std::map<BSONObj, int, BSONObjCmp> _groupMap;
@@ -0,0 +1,381 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/group_native_reducer.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <set>
+
+#include "mongo/db/exec/group.h"
+
+namespace mongo {
+
+    using std::auto_ptr;
+    using std::set;
+    using std::string;
+    using std::vector;
+
+namespace {
+
+    bool isIdentifierStart(char c) {
+        return isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+    }
+
+    bool isIdentifierChar(char c) {
+        return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+    }
+
+    /**
+     * Reads the source of a reduce function from which all whitespace was removed.
+     */
+    class CodeCursor {
+    public:
+        explicit CodeCursor(const string& code) : _code(code), _pos(0) { }
+
+        bool atEnd() const {
+            return _pos == _code.size();
+        }
+
+        char peek() const {
+            return atEnd() ? '\0' : _code[_pos];
+        }
+
+        bool consume(const char* token) {
+            const size_t len = strlen(token);
+            if (_code.compare(_pos, len, token) != 0) {
+                return false;
+            }
+            _pos += len;
+            return true;
+        }
+
+        bool consumeExactly(const string& identifier) {
+            const size_t end = _pos + identifier.size();
+            if (_code.compare(_pos, identifier.size(), identifier) != 0 ||
+                (end < _code.size() && isIdentifierChar(_code[end]))) {
+                return false;
+            }
+            _pos = end;
+            return true;
+        }
+
+        bool identifier(string* out) {
+            if (atEnd() || !isIdentifierStart(_code[_pos])) {
+                return false;
+            }
+            const size_t start = _pos;
+            while (!atEnd() && isIdentifierChar(_code[_pos])) {
+                _pos++;
+            }
+            *out = _code.substr(start, _pos - start);
+            return true;
+        }
+
+        /**
+         * Reads a decimal literal, such as 1 or 2.5.
+         */
+        bool number(double* out) {
+            size_t end = _pos;
+            while (end < _code.size() && isdigit(static_cast<unsigned char>(_code[end]))) {
+                end++;
+            }
+            if (end == _pos) {
+                return false;
+            }
+            if (end < _code.size() && _code[end] == '.') {
+                end++;
+                while (end < _code.size() && isdigit(static_cast<unsigned char>(_code[end]))) {
+                    end++;
+                }
+            }
+            if (end < _code.size() && isIdentifierChar(_code[end])) {
+                return false;
+            }
+            *out = strtod(_code.substr(_pos, end - _pos).c_str(), NULL);
+            _pos = end;
+            return true;
+        }
+
+    private:
+        const string _code;
+        size_t _pos;
+    };
+
+    /**
+     * Whether Javascript gives back an element of this type unchanged, but for numbers becoming
+     * doubles.
+     */
+    bool isPlainScalar(const BSONElement& e) {
+        switch (e.type()) {
+        case NumberDouble:
+        case NumberInt:
+        case NumberLong:
+        case String:
+        case Bool:
+        case jstNULL:
+        case jstOID:
+        case Date:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void appendAsJavascriptWould(BSONObjBuilder* b, const BSONElement& e) {
+        if (NumberInt == e.type()) {
+            b->append(e.fieldName(), static_cast<double>(e.numberInt()));
+        }
+        else {
+            b->append(e);
+        }
+    }
+
+    /**
+     * Whether adding 'e' to a number in Javascript gives a number.
+     */
+    bool isSummable(const BSONElement& e) {
+        switch (e.type()) {
+        case EOO:
+        case Undefined:
+        case jstNULL:
+        case Bool:
+        case NumberDouble:
+        case NumberInt:
+        case NumberLong:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    double summandOf(const BSONElement& e) {
+        switch (e.type()) {
+        case EOO:
+        case Undefined:
+            return std::numeric_limits<double>::quiet_NaN();
+        case jstNULL:
+            return 0;
+        case Bool:
+            return e.boolean() ? 1 : 0;
+        default:
+            return e.numberDouble();
+        }
+    }
+
+}  // namespace
+
+    // static
+    NativeGroupReducer* NativeGroupReducer::make(const GroupRequest& request) {
+        if (!request.keyFunctionCode.empty() ||
+            !request.finalize.empty() ||
+            !request.reduceScope.isEmpty()) {
+            return NULL;
+        }
+
+        set<string> keyFields;
+        BSONForEach(e, request.keyPattern) {
+            keyFields.insert(e.fieldName());
+        }
+
+        auto_ptr<NativeGroupReducer> reducer(new NativeGroupReducer());
+
+        // A key field which is also in the initial object, or a field repeated in it, would be
+        // merged by Javascript.
+        set<string> initialFields;
+        BSONObjBuilder initial;
+        BSONForEach(e, request.initial) {
+            if (!isPlainScalar(e) ||
+                keyFields.count(e.fieldName()) ||
+                !initialFields.insert(e.fieldName()).second) {
+                return NULL;
+            }
+            appendAsJavascriptWould(&initial, e);
+        }
+        reducer->_initial = initial.obj();
+
+        if (!reducer->_parse(request.reduceCode)) {
+            return NULL;
+        }
+        return reducer.release();
+    }
+
+    bool NativeGroupReducer::_parse(const string& code) {
+        string stripped;
+        for (size_t i = 0; i < code.size(); i++) {
+            if (!isspace(static_cast<unsigned char>(code[i]))) {
+                stripped += code[i];
+            }
+        }
+
+        CodeCursor cursor(stripped);
+        string name;
+        string doc;
+        string result;
+        if (!cursor.consume("function")) {
+            return false;
+        }
+        cursor.identifier(&name);
+        if (!cursor.consume("(") ||
+            !cursor.identifier(&doc) ||
+            !cursor.consume(",") ||
+            !cursor.identifier(&result) ||
+            !cursor.consume(")") ||
+            !cursor.consume("{") ||
+            doc == result) {
+            return false;
+        }
+
+        while (!cursor.consume("}")) {
+            if (cursor.consume(";")) {
+                continue;
+            }
+
+            string field;
+            const bool preIncrement = cursor.consume("++");
+            if (!cursor.consumeExactly(result) ||
+                !cursor.consume(".") ||
+                !cursor.identifier(&field)) {
+                return false;
+            }
+
+            Accumulator accumulator;
+            accumulator.constant = 1;
+            if (!preIncrement && !cursor.consume("++")) {
+                // Either 'result.f += operand' or 'result.f = result.f + operand'.
+                string sameField;
+                if (!cursor.consume("+=") &&
+                    !(cursor.consume("=") &&
+                      cursor.consumeExactly(result) &&
+                      cursor.consume(".") &&
+                      cursor.identifier(&sameField) &&
+                      sameField == field &&
+                      cursor.consume("+"))) {
+                    return false;
+                }
+
+                if (!cursor.number(&accumulator.constant)) {
+                    if (!cursor.consumeExactly(doc) ||
+                        !cursor.consume(".") ||
+                        !cursor.identifier(&accumulator.sourceField)) {
+                        return false;
+                    }
+                }
+            }
+
+            if (cursor.peek() != ';' && cursor.peek() != '}') {
+                return false;
+            }
+
+            const BSONElement initialValue = _initial[field];
+            if (NumberDouble != initialValue.type()) {
+                return false;
+            }
+            accumulator.sum = _sumFor(field);
+            _initialSums[accumulator.sum] = initialValue.numberDouble();
+            _accumulators.push_back(accumulator);
+        }
+
+        cursor.consume(";");
+        return cursor.atEnd();
+    }
+
+    size_t NativeGroupReducer::_sumFor(const string& field) {
+        for (size_t i = 0; i < _sumFields.size(); i++) {
+            if (_sumFields[i] == field) {
+                return i;
+            }
+        }
+        _sumFields.push_back(field);
+        _initialSums.push_back(0);
+        return _sumFields.size() - 1;
+    }
+
+    bool NativeGroupReducer::canReduce(const BSONObj& key, const BSONObj& obj) const {
+        BSONForEach(e, key) {
+            if (!isPlainScalar(e)) {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < _accumulators.size(); i++) {
+            const Accumulator& accumulator = _accumulators[i];
+            if (!accumulator.sourceField.empty() && !isSummable(obj[accumulator.sourceField])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void NativeGroupReducer::reduce(size_t group, const BSONObj& key, const BSONObj& obj) {
+        if (group == _groups.size()) {
+            BSONObjBuilder base;
+            BSONForEach(e, key) {
+                appendAsJavascriptWould(&base, e);
+            }
+            base.appendElements(_initial);
+
+            _groups.push_back(Group());
+            _groups.back().base = base.obj();
+            _groups.back().sums = _initialSums;
+        }
+        invariant(group < _groups.size());
+
+        vector<double>& sums = _groups[group].sums;
+        for (size_t i = 0; i < _accumulators.size(); i++) {
+            const Accumulator& accumulator = _accumulators[i];
+            sums[accumulator.sum] += accumulator.sourceField.empty() ?
+                accumulator.constant : summandOf(obj[accumulator.sourceField]);
+        }
+    }
+
+    BSONObj NativeGroupReducer::getGroup(size_t group) const {
+        invariant(group < _groups.size());
+        const Group& g = _groups[group];
+
+        BSONObjBuilder b;
+        BSONForEach(e, g.base) {
+            size_t sum = 0;
+            while (sum < _sumFields.size() && _sumFields[sum] != e.fieldName()) {
+                sum++;
+            }
+            if (sum < _sumFields.size()) {
+                b.append(e.fieldName(), g.sums[sum]);
+            }
+            else {
+                b.append(e);
+            }
+        }
+        return b.obj();
+    }
+
+}  // namespace mongo
@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    struct GroupRequest;
+
+    /**
+     * Runs the reduce function of a group command without Javascript, for the common reducers
+     * which only count or sum into numeric fields of the initial object, such as
+     *
+     *     function(cur, result) { result.count++; result.total += cur.amount; }
+     *
+     * Each statement of the reducer must be one of
+     *
+     *     result.f++            ++result.f            result.f += <number>
+     *     result.f += cur.g     result.f = result.f + cur.g     result.f = result.f + <number>
+     *
+     * where 'f' is a number in the initial object and 'g' is a top level field of the document.
+     * The groups are returned just as Javascript would have left them, with every number in the
+     * key and the initial object turned into a double.
+     */
+    class NativeGroupReducer {
+        MONGO_DISALLOW_COPYING(NativeGroupReducer);
+    public:
+        /**
+         * Returns a reducer for 'request', or NULL if its reduce function needs Javascript. The
+         * caller owns the reducer.
+         */
+        static NativeGroupReducer* make(const GroupRequest& request);
+
+        /**
+         * Returns whether 'obj', which belongs to the group 'key', can be reduced here. If it
+         * can't, for instance because a summed field holds a string, the caller must move the
+         * groups to Javascript and go on there.
+         */
+        bool canReduce(const BSONObj& key, const BSONObj& obj) const;
+
+        /**
+         * Reduces 'obj' into the group numbered 'group', which is either an existing group or
+         * the next one, for 'key'.
+         */
+        void reduce(size_t group, const BSONObj& key, const BSONObj& obj);
+
+        size_t numGroups() const { return _groups.size(); }
+
+        /**
+         * Returns the group numbered 'group' as the reduce function would have left it.
+         */
+        BSONObj getGroup(size_t group) const;
+
+    private:
+        // One statement of the reducer: adds either a field of the document or a constant to
+        // one of the sums.
+        struct Accumulator {
+            size_t sum;
+            std::string sourceField;
+            double constant;
+        };
+
+        struct Group {
+            BSONObj base;
+            std::vector<double> sums;
+        };
+
+        NativeGroupReducer() { }
+
+        bool _parse(const std::string& code);
+
+        size_t _sumFor(const std::string& field);
+
+        // The initial object, with its numbers turned into doubles.
+        BSONObj _initial;
+
+        // The fields of the initial object which are summed, and their initial values.
+        std::vector<std::string> _sumFields;
+        std::vector<double> _initialSums;
+
+        std::vector<Accumulator> _accumulators;
+        std::vector<Group> _groups;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/exec/group_native_reducer.cpp
+ */
+
+#include <boost/scoped_ptr.hpp>
+#include <cmath>
+
+#include "mongo/db/exec/group.h"
+#include "mongo/db/exec/group_native_reducer.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    GroupRequest makeRequest(const char* key, const char* initial, const std::string& reduce) {
+        GroupRequest request;
+        request.ns = "test.group";
+        request.keyPattern = fromjson(key);
+        request.initial = fromjson(initial);
+        request.reduceCode = reduce;
+        request.explain = false;
+        return request;
+    }
+
+    NativeGroupReducer* make(const char* key, const char* initial, const std::string& reduce) {
+        return NativeGroupReducer::make(makeRequest(key, initial, reduce));
+    }
+
+    TEST(NativeGroupReducerTest, CountsAndSums) {
+        boost::scoped_ptr<NativeGroupReducer> reducer(
+            make("{a: 1}", "{count: 0, total: 0}",
+                 "function(cur, result) {\n"
+                 "    result.count++;\n"
+                 "    result.total += cur.x;\n"
+                 "}"));
+        ASSERT(reducer);
+
+        const BSONObj keyOne = BSON("a" << 1);
+        const BSONObj keyTwo = BSON("a" << "two");
+        ASSERT(reducer->canReduce(keyOne, BSON("x" << 2)));
+        reducer->reduce(0, keyOne, BSON("x" << 2));
+        reducer->reduce(1, keyTwo, BSON("x" << 1.5));
+        reducer->reduce(0, keyOne, BSON("x" << 3LL));
+
+        ASSERT_EQUALS(2U, reducer->numGroups());
+        ASSERT_EQUALS(BSON("a" << 1.0 << "count" << 2.0 << "total" << 5.0),
+                      reducer->getGroup(0));
+        ASSERT_EQUALS(NumberDouble, reducer->getGroup(0)["a"].type());
+        ASSERT_EQUALS(BSON("a" << "two" << "count" << 1.0 << "total" << 1.5),
+                      reducer->getGroup(1));
+    }
+
+    TEST(NativeGroupReducerTest, StatementForms) {
+        boost::scoped_ptr<NativeGroupReducer> reducer(
+            make("{a: 1}", "{n: 0, m: 10, s: 0}",
+                 "function reduce(doc, out) { ++out.n; out.m = out.m + 2.5; "
+                 "out.s = out.s + doc.v;; out.n += 1 }"));
+        ASSERT(reducer);
+
+        const BSONObj key = BSON("a" << 1);
+        reducer->reduce(0, key, BSON("v" << true));
+        reducer->reduce(0, key, BSON("v" << BSONNULL));
+        ASSERT_EQUALS(BSON("a" << 1.0 << "n" << 4.0 << "m" << 15.0 << "s" << 1.0),
+                      reducer->getGroup(0));
+    }
+
+    TEST(NativeGroupReducerTest, MissingFieldGivesNaN) {
+        boost::scoped_ptr<NativeGroupReducer> reducer(
+            make("{a: 1}", "{total: 0}", "function(cur, result) { result.total += cur.x; }"));
+        ASSERT(reducer);
+
+        const BSONObj key = BSON("a" << 1);
+        ASSERT(reducer->canReduce(key, BSON("y" << 1)));
+        reducer->reduce(0, key, BSON("y" << 1));
+        ASSERT(std::isnan(reducer->getGroup(0)["total"].numberDouble()));
+    }
+
+    TEST(NativeGroupReducerTest, ValuesJavascriptWouldNotAddAsNumbers) {
+        boost::scoped_ptr<NativeGroupReducer> reducer(
+            make("{a: 1}", "{total: 0}", "function(cur, result) { result.total += cur.x; }"));
+        ASSERT(reducer);
+
+        ASSERT_FALSE(reducer->canReduce(BSON("a" << 1), BSON("x" << "string")));
+        ASSERT_FALSE(reducer->canReduce(BSON("a" << 1), BSON("x" << BSON("y" << 1))));
+        ASSERT_FALSE(reducer->canReduce(BSON("a" << BSON("b" << 1)), BSON("x" << 1)));
+    }
+
+    TEST(NativeGroupReducerTest, ReducersNeedingJavascript) {
+        const char* unsupported[] = {
+            "function(cur, result) { result.total += cur.x.y; }",
+            "function(cur, result) { result.total += cur.x * 2; }",
+            "function(cur, result) { result.total -= cur.x; }",
+            "function(cur, result) { result.other += 1; }",
+            "function(cur, result) { result.name += 1; }",
+            "function(cur, result) { if (cur.x) result.total++; }",
+            "function(cur, result) { result.total = cur.x; }",
+            "function(cur, result) { result.total++ }; foo()",
+            "function(cur) { cur.total++; }",
+            "function(result, result) { result.total++; }",
+        };
+        for (size_t i = 0; i < sizeof(unsupported) / sizeof(unsupported[0]); i++) {
+            boost::scoped_ptr<NativeGroupReducer> reducer(
+                make("{a: 1}", "{total: 0, name: 'x'}", unsupported[i]));
+            ASSERT_FALSE(reducer) << unsupported[i];
+        }
+
+        // A long counter, a key field in the initial object, a key function or a finalizer.
+        const std::string count = "function(cur, result) { result.count++; }";
+        ASSERT_FALSE(boost::scoped_ptr<NativeGroupReducer>(
+            make("{a: 1}", "{count: NumberLong(0)}", count)));
+        ASSERT_FALSE(boost::scoped_ptr<NativeGroupReducer>(
+            make("{a: 1}", "{a: 0, count: 0}", count)));
+
+        GroupRequest request = makeRequest("{}", "{count: 0}", count);
+        request.keyFunctionCode = "function(doc) { return {a: doc.a}; }";
+        ASSERT_FALSE(boost::scoped_ptr<NativeGroupReducer>(NativeGroupReducer::make(request)));
+
+        request = makeRequest("{a: 1}", "{count: 0}", count);
+        request.finalize = "function(result) { result.avg = 1; }";
+        ASSERT_FALSE(boost::scoped_ptr<NativeGroupReducer>(NativeGroupReducer::make(request)));
+    }
+
+}  // namespace
@@ -31,11 +31,15 @@
 #include "mongo/db/exec/idhack.h"
 
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/catalog/document_cache.h"
 #include "mongo/db/exec/projection.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
-#include "mongo/db/index/btree_access_method.h"
+#include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_cursor.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/s/d_state.h"
 
@@ -47,15 +51,42 @@ namespace mongo {
     // static
     const char* IDHackStage::kStageType = "IDHACK";
 
+    namespace {
+        /**
+         * The DocumentCache, if configured, and if it can be trusted. It has no notion of
+         * snapshots, so it is only used when collection writers exclude all readers.
+         */
+        DocumentCache* usableDocumentCache() {
+            DocumentCache* cache = DocumentCache::get();
+            if (NULL == cache || supportsDocLocking()) {
+                return NULL;
+            }
+            return cache;
+        }
+    }
+
     IDHackStage::IDHackStage(OperationContext* txn, const Collection* collection,
                              CanonicalQuery* query, WorkingSet* ws)
         : _txn(txn),
           _collection(collection),
           _workingSet(ws),
-          _key(query->getQueryObj()["_id"].wrap()),
+          _keyIdx(0),
           _done(false),
           _idBeingPagedIn(WorkingSet::INVALID_ID),
           _commonStats(kStageType) {
+        if (isIdInQuery(*query)) {
+            // The equalities are a set ordered the way the index orders its keys.
+            const BSONElementSet& values =
+                static_cast<const InMatchExpression*>(query->root())->getData().equalities();
+            for (BSONElementSet::const_iterator it = values.begin(); it != values.end(); ++it) {
+                _keys.push_back(it->wrap("_id"));
+            }
+            _done = _keys.empty();
+        }
+        else {
+            _keys.push_back(query->getQueryObj()["_id"].wrap());
+        }
+
         if (NULL != query->getProj()) {
             _addKeyMetadata = query->getProj()->wantIndexKey();
         }
@@ -69,7 +100,8 @@ namespace mongo {
         : _txn(txn),
           _collection(collection),
           _workingSet(ws),
-          _key(key),
+          _keys(1, key),
+          _keyIdx(0),
           _done(false),
           _addKeyMetadata(false),
           _idBeingPagedIn(WorkingSet::INVALID_ID),
@@ -91,7 +123,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (_done) { return PlanStage::IS_EOF; }
 
@@ -101,6 +133,7 @@ namespace mongo {
             WorkingSetMember* member = _workingSet->get(id);
 
             WorkingSetCommon::completeFetch(_txn, member, _collection);
+            offerToDocumentCache(member);
 
             return advance(id, member, out);
         }
@@ -115,19 +148,47 @@ namespace mongo {
             return PlanStage::IS_EOF;
         }
 
-        // This may not be valid always.  See SERVER-12397.
-        const BtreeBasedAccessMethod* accessMethod =
-            static_cast<const BtreeBasedAccessMethod*>(catalog->getIndex(idDesc));
+        const BSONObj& key = _keys[_keyIdx];
 
-        // Look up the key by going directly to the Btree.
-        RecordId loc = accessMethod->findSingle(_txn, _key);
+        if (DocumentCache* cache = usableDocumentCache()) {
+            RecordId loc;
+            BSONObj obj;
+            if (cache->find(_collection, key, &loc, &obj)) {
+                ++_specificStats.documentCacheHits;
 
-        // Key not found.
-        if (loc.isNull()) {
-            _done = true;
-            return PlanStage::IS_EOF;
+                WorkingSetID id = _workingSet->allocate();
+                WorkingSetMember* member = _workingSet->get(id);
+                member->loc = loc;
+                member->obj = obj;
+                member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+                return advance(id, member, out);
+            }
+        }
+
+        if (!_cursor) {
+            CursorOptions cursorOptions;
+            cursorOptions.direction = CursorOptions::INCREASING;
+
+            IndexCursor* cursor;
+            Status s = catalog->getIndex(idDesc)->newCursor(_txn, cursorOptions, &cursor);
+            verify(s.isOK());
+            _cursor.reset(cursor);
         }
 
+        // Look up the key by going directly to the Btree.  If we found something, it could be a
+        // key after 'key'.
+        _cursor->seek(key);
+        if (_cursor->isEOF() || 0 != key.woCompare(_cursor->getKey(), BSONObj(), false)) {
+            // Key not found, move on to the next one.
+            nextKey();
+            if (_done) {
+                return PlanStage::IS_EOF;
+            }
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+        const RecordId loc = _cursor->getValue();
+
         ++_specificStats.keysExamined;
         ++_specificStats.docsExamined;
 
@@ -151,9 +212,25 @@ namespace mongo {
 
         // The doc was already in memory, so we go ahead and return it.
         member->obj = _collection->docFor(_txn, member->loc);
+        offerToDocumentCache(member);
         return advance(id, member, out);
     }
 
+    void IDHackStage::offerToDocumentCache(const WorkingSetMember* member) {
+        DocumentCache* cache = usableDocumentCache();
+        if (NULL == cache || !member->hasLoc() || !member->hasObj()) {
+            return;
+        }
+
+        // Writers hold the collection exclusively; such an operation may have written this
+        // document in a unit of work that can still roll back.
+        if (_txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X)) {
+            return;
+        }
+
+        cache->insert(_collection, _keys[_keyIdx], member->loc, member->obj);
+    }
+
     PlanStage::StageState IDHackStage::advance(WorkingSetID id,
                                                WorkingSetMember* member,
                                                WorkingSetID* out) {
@@ -162,17 +239,24 @@ namespace mongo {
         if (_addKeyMetadata) {
             BSONObjBuilder bob;
             BSONObj ownedKeyObj = member->obj["_id"].wrap().getOwned();
-            bob.appendKeys(_key, ownedKeyObj);
+            bob.appendKeys(_keys[_keyIdx], ownedKeyObj);
             member->addComputed(new IndexKeyComputedData(bob.obj()));
         }
 
-        _done = true;
+        nextKey();
         ++_commonStats.advanced;
         *out = id;
         return PlanStage::ADVANCED;
     }
 
+    void IDHackStage::nextKey() {
+        ++_keyIdx;
+        _done = _keyIdx >= _keys.size();
+    }
+
     void IDHackStage::saveState() {
+        // Each lookup seeks from scratch, so there is no position to save.
+        _cursor.reset();
         _txn = NULL;
         ++_commonStats.yields;
     }
@@ -204,11 +288,48 @@ namespace mongo {
 
     // static
     bool IDHackStage::supportsQuery(const CanonicalQuery& query) {
-        return !query.getParsed().showDiskLoc()
-            && query.getParsed().getHint().isEmpty()
-            && 0 == query.getParsed().getSkip()
-            && CanonicalQuery::isSimpleIdQuery(query.getParsed().getFilter())
-            && !query.getParsed().getOptions().tailable;
+        if (query.getParsed().showDiskLoc()
+            || !query.getParsed().getHint().isEmpty()
+            || 0 != query.getParsed().getSkip()
+            || query.getParsed().getOptions().tailable) {
+            return false;
+        }
+
+        if (CanonicalQuery::isSimpleIdQuery(query.getParsed().getFilter())) {
+            return true;
+        }
+
+        // Several documents may match a $in, so the query can't have anything that a plan
+        // would have to apply to them as a whole.
+        return query.getParsed().getSort().isEmpty()
+            && query.getParsed().wantMore()
+            && 0 == query.getParsed().getMaxScan()
+            && query.getParsed().getMin().isEmpty()
+            && query.getParsed().getMax().isEmpty()
+            && isIdInQuery(query);
+    }
+
+    // static
+    bool IDHackStage::isIdInQuery(const CanonicalQuery& query) {
+        const MatchExpression* root = query.root();
+        if (MatchExpression::MATCH_IN != root->matchType() || "_id" != root->path()) {
+            return false;
+        }
+
+        const ArrayFilterEntries& entries = static_cast<const InMatchExpression*>(root)->getData();
+        if (entries.numRegexes() > 0 || entries.hasEmptyArray()) {
+            return false;
+        }
+
+        // Only values that equality on _id would accept: an _id is never an array, and any
+        // other value matches exactly the index keys that equal it.
+        const BSONElementSet& values = entries.equalities();
+        for (BSONElementSet::const_iterator it = values.begin(); it != values.end(); ++it) {
+            if (!it->isSimpleType() && BinData != it->type() && Object != it->type()) {
+                return false;
+            }
+        }
+        return true;
     }
 
     vector<PlanStage*> IDHackStage::getChildren() const {
@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <boost/scoped_ptr.hpp>
+#include <vector>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/query/canonical_query.h"
@@ -35,9 +38,15 @@
 
 namespace mongo {
 
+    class IndexCursor;
+
     /**
      * A standalone stage implementing the fast path for key-value retrievals
      * via the _id index.
+     *
+     * Besides equality on _id, it answers {_id: {$in: [...]}} without planning: the values are
+     * looked up in index order through one cursor on the _id index, and each document found
+     * is returned as it is fetched.
      */
     class IDHackStage : public PlanStage {
     public:
@@ -62,6 +71,12 @@ namespace mongo {
          */
         static bool supportsQuery(const CanonicalQuery& query);
 
+        /**
+         * True if 'query' is a $in on _id, with no other predicates, whose values can all be
+         * looked up as _id index keys.
+         */
+        static bool isIdInQuery(const CanonicalQuery& query);
+
         virtual std::vector<PlanStage*> getChildren() const;
 
         virtual StageType stageType() const { return STAGE_IDHACK; }
@@ -82,6 +97,17 @@ namespace mongo {
          */
         StageState advance(WorkingSetID id, WorkingSetMember* member, WorkingSetID* out);
 
+        /**
+         * Moves on to the next key to look up, marking this stage as done after the last one.
+         */
+        void nextKey();
+
+        /**
+         * Offers a document just read from the collection to the DocumentCache, unless this
+         * operation could be holding uncommitted writes to the collection.
+         */
+        void offerToDocumentCache(const WorkingSetMember* member);
+
         // transactional context for read locks. Not owned by us
         OperationContext* _txn;
 
@@ -91,10 +117,16 @@ namespace mongo {
         // The WorkingSet we annotate with results.  Not owned by us.
         WorkingSet* _workingSet;
 
-        // The value to match against the _id field.
-        BSONObj _key;
+        // The values to match against the _id field, as {_id: <value>}, in index order.
+        std::vector<BSONObj> _keys;
+
+        // The position in _keys of the key we are looking up.
+        size_t _keyIdx;
+
+        // Positioned on _id index keys as we seek to each of _keys.  Reopened after a yield.
+        boost::scoped_ptr<IndexCursor> _cursor;
 
-        // Have we returned our one document?
+        // Have we looked up all of _keys?
         bool _done;
 
         // Do we need to add index key metadata for $returnKey?
@@ -0,0 +1,256 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/inclusion_projection.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using std::auto_ptr;
+    using std::string;
+
+    namespace {
+
+        // Past this many children a trie node indexes them by name instead of scanning.
+        const size_t kMaxScannedChildren = 8;
+
+    }  // namespace
+
+    /**
+     * One field of an included path. A leaf includes the whole field; an inner node includes
+     * only the listed subfields of the subdocuments it holds.
+     */
+    class InclusionProjection::Node {
+        MONGO_DISALLOW_COPYING(Node);
+    public:
+        Node() : isLeaf(false) { }
+
+        ~Node() {
+            for (size_t i = 0; i < children.size(); ++i) {
+                delete children[i].second;
+            }
+        }
+
+        /**
+         * Adds the dotted path 'path' below this node. Returns false if it conflicts with a
+         * path added before.
+         */
+        bool add(const StringData& path) {
+            const size_t dot = path.find('.');
+            const StringData name = path.substr(0, dot);
+            if (name.empty() || name[0] == '$') {
+                return false;
+            }
+
+            Node* child = const_cast<Node*>(find(name));
+            if (NULL == child) {
+                child = new Node();
+                children.push_back(std::make_pair(name.toString(), child));
+                if (children.size() > kMaxScannedChildren) {
+                    _reindex();
+                }
+            }
+
+            if (string::npos == dot) {
+                // Including a field and one of its subfields is left to ProjectionExec.
+                if (!child->children.empty()) {
+                    return false;
+                }
+                child->isLeaf = true;
+                return true;
+            }
+
+            if (child->isLeaf) {
+                return false;
+            }
+            return child->add(path.substr(dot + 1));
+        }
+
+        const Node* find(const StringData& name) const {
+            if (children.size() > kMaxScannedChildren) {
+                Index::const_iterator it = _index.find(name);
+                return _index.end() == it ? NULL : children[it->second].second;
+            }
+
+            for (size_t i = 0; i < children.size(); ++i) {
+                if (name == children[i].first) {
+                    return children[i].second;
+                }
+            }
+            return NULL;
+        }
+
+        bool isLeaf;
+
+        std::vector<std::pair<string, Node*> > children;
+
+    private:
+        typedef unordered_map<StringData, size_t, StringData::Hasher> Index;
+
+        void _reindex() {
+            _index.clear();
+            for (size_t i = 0; i < children.size(); ++i) {
+                _index[children[i].first] = i;
+            }
+        }
+
+        // Keys point into 'children' and are rebuilt whenever a child is added.
+        Index _index;
+    };
+
+    InclusionProjection::InclusionProjection() : _root(new Node()), _includeId(true) { }
+
+    InclusionProjection::~InclusionProjection() { }
+
+    // static
+    InclusionProjection* InclusionProjection::make(const BSONObj& spec) {
+        auto_ptr<InclusionProjection> projection(new InclusionProjection());
+        bool includesField = false;
+
+        BSONObjIterator it(spec);
+        while (it.more()) {
+            BSONElement elt = it.next();
+            if (!elt.isNumber() && !elt.isBoolean()) {
+                return NULL;
+            }
+
+            const StringData name = elt.fieldNameStringData();
+            if (name == "_id") {
+                projection->_includeId = elt.trueValue();
+                if (!projection->_includeId) {
+                    continue;
+                }
+            }
+            else if (!elt.trueValue()) {
+                return NULL;
+            }
+
+            if (!projection->_root->add(name)) {
+                return NULL;
+            }
+            includesField = true;
+        }
+
+        // {_id: 0} alone excludes rather than includes.
+        if (!includesField) {
+            return NULL;
+        }
+
+        return projection.release();
+    }
+
+    void InclusionProjection::transform(const BSONObj& in, BSONObjBuilder* bob) const {
+        appendObject(*_root, in, bob, true);
+    }
+
+    void InclusionProjection::appendObject(const Node& node,
+                                           const BSONObj& in,
+                                           BSONObjBuilder* bob,
+                                           bool topLevel) const {
+        // The bytes of the adjacent whole fields included so far, not yet copied to 'bob'.
+        const char* runStart = NULL;
+        const char* runEnd = NULL;
+
+        BSONObjIterator it(in);
+        while (it.more()) {
+            BSONElement elt = it.next();
+            const StringData name = elt.fieldNameStringData();
+
+            // Like ProjectionExec, a top level _id is kept whole unless excluded.
+            const bool isId = topLevel && name == "_id";
+            const Node* child = isId ? NULL : node.find(name);
+            const bool wholeField = isId ? _includeId : (NULL != child && child->isLeaf);
+
+            if (wholeField) {
+                if (runEnd != elt.rawdata()) {
+                    if (NULL != runStart) {
+                        bob->bb().appendBuf(runStart, runEnd - runStart);
+                    }
+                    runStart = elt.rawdata();
+                }
+                runEnd = elt.rawdata() + elt.size();
+                continue;
+            }
+
+            if (NULL == child || (Object != elt.type() && Array != elt.type())) {
+                continue;
+            }
+
+            if (NULL != runStart) {
+                bob->bb().appendBuf(runStart, runEnd - runStart);
+                runStart = runEnd = NULL;
+            }
+
+            if (Object == elt.type()) {
+                BSONObjBuilder sub(bob->subobjStart(name));
+                appendObject(*child, elt.embeddedObject(), &sub, false);
+                sub.doneFast();
+            }
+            else {
+                BSONObjBuilder sub(bob->subarrayStart(name));
+                appendArray(*child, elt.embeddedObject(), &sub);
+                sub.doneFast();
+            }
+        }
+
+        if (NULL != runStart) {
+            bob->bb().appendBuf(runStart, runEnd - runStart);
+        }
+    }
+
+    void InclusionProjection::appendArray(const Node& node,
+                                          const BSONObj& in,
+                                          BSONObjBuilder* bob) const {
+        // Scalars in the array are dropped: only subdocuments can hold the included subfields.
+        int index = 0;
+        BSONObjIterator it(in);
+        while (it.more()) {
+            BSONElement elt = it.next();
+            if (Object == elt.type()) {
+                BSONObjBuilder sub(bob->subobjStart(BSONObjBuilder::numStr(index++)));
+                appendObject(node, elt.embeddedObject(), &sub, false);
+                sub.doneFast();
+            }
+            else if (Array == elt.type()) {
+                BSONObjBuilder sub(bob->subarrayStart(BSONObjBuilder::numStr(index++)));
+                appendArray(node, elt.embeddedObject(), &sub);
+                sub.doneFast();
+            }
+        }
+    }
+
+}  // namespace mongo
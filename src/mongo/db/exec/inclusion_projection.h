@@ -0,0 +1,78 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * An inclusion-only projection such as {a: 1, 'b.c': 1, _id: 0} compiled into a trie of the
+     * included paths. transform() makes a single pass over the document: runs of adjacent
+     * included fields are copied with one memcpy, and only the subdocuments and arrays on the
+     * path to a dotted field are rebuilt.
+     *
+     * Produces the same documents as ProjectionExec for the projections make() accepts.
+     */
+    class InclusionProjection {
+        MONGO_DISALLOW_COPYING(InclusionProjection);
+    public:
+        ~InclusionProjection();
+
+        /**
+         * Returns NULL unless 'spec' only includes plain (possibly dotted) fields and optionally
+         * excludes _id. Positional, $slice, $elemMatch and $meta projections are left to
+         * ProjectionExec, as are specs where one included path is a prefix of another.
+         */
+        static InclusionProjection* make(const BSONObj& spec);
+
+        void transform(const BSONObj& in, BSONObjBuilder* bob) const;
+
+    private:
+        class Node;
+
+        InclusionProjection();
+
+        void appendObject(const Node& node,
+                          const BSONObj& in,
+                          BSONObjBuilder* bob,
+                          bool topLevel) const;
+
+        void appendArray(const Node& node, const BSONObj& in, BSONObjBuilder* bob) const;
+
+        boost::scoped_ptr<Node> _root;
+
+        bool _includeId;
+    };
+
+}  // namespace mongo
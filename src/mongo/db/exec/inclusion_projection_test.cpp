@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+/**
+ * This file contains tests for mongo/db/exec/inclusion_projection.cpp
+ */
+
+#include "mongo/db/exec/inclusion_projection.h"
+
+#include <memory>
+
+#include "mongo/db/exec/projection_exec.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    using std::auto_ptr;
+
+    /**
+     * Projects 'objStr' through 'specStr' and checks the result against both 'expectedStr' and
+     * what ProjectionExec produces.
+     */
+    void testTransform(const char* specStr, const char* objStr, const char* expectedStr) {
+        BSONObj spec = fromjson(specStr);
+        BSONObj obj = fromjson(objStr);
+
+        auto_ptr<InclusionProjection> projection(InclusionProjection::make(spec));
+        ASSERT(NULL != projection.get());
+
+        BSONObjBuilder bob;
+        projection->transform(obj, &bob);
+        BSONObj actual = bob.obj();
+
+        BSONObj expected;
+        ProjectionExec exec(spec, NULL);
+        ASSERT_OK(exec.transform(obj, &expected));
+
+        ASSERT_EQUALS(fromjson(expectedStr), actual);
+        ASSERT_EQUALS(expected.objsize(), actual.objsize());
+        ASSERT_EQUALS(0, memcmp(expected.objdata(), actual.objdata(), actual.objsize()));
+    }
+
+    TEST(InclusionProjectionTest, TopLevelFields) {
+        testTransform("{a: 1}", "{_id: 0, a: 1, b: 2}", "{_id: 0, a: 1}");
+        testTransform("{a: 1, _id: 0}", "{_id: 0, a: 1, b: 2}", "{a: 1}");
+        testTransform("{a: true, c: 1}", "{a: 1, b: 2, c: 3, d: 4}", "{a: 1, c: 3}");
+        testTransform("{a: 1, b: 1}", "{b: 1, x: 5, a: 2, b: 3}", "{b: 1, a: 2, b: 3}");
+        testTransform("{_id: 1}", "{a: 1, _id: 2}", "{_id: 2}");
+        testTransform("{z: 1}", "{a: 1}", "{}");
+    }
+
+    TEST(InclusionProjectionTest, DottedFields) {
+        testTransform("{'a.b': 1}", "{a: {b: 1, c: 2}, d: 3}", "{a: {b: 1}}");
+        testTransform("{'a.b': 1, 'a.c': 1}", "{a: {b: 1, c: 2, d: 3}}", "{a: {b: 1, c: 2}}");
+        testTransform("{'a.b.c': 1, x: 1}", "{x: 0, a: {b: {c: 1, d: 2}, e: 3}}",
+                      "{x: 0, a: {b: {c: 1}}}");
+        testTransform("{'a.b': 1}", "{a: 5}", "{}");
+        testTransform("{'a.b': 1}", "{a: {c: 1}}", "{a: {}}");
+        testTransform("{'_id.x': 1}", "{_id: {x: 1, y: 2}, a: 1}", "{_id: {x: 1, y: 2}}");
+    }
+
+    TEST(InclusionProjectionTest, DottedFieldsThroughArrays) {
+        testTransform("{'a.b': 1}", "{a: [{b: 1, c: 2}, 5, {c: 3}]}", "{a: [{b: 1}, {}]}");
+        testTransform("{'a.b': 1}", "{a: [[{b: 1, c: 2}], 7]}", "{a: [[{b: 1}]]}");
+        testTransform("{a: 1}", "{a: [1, {b: 2}]}", "{a: [1, {b: 2}]}");
+    }
+
+    TEST(InclusionProjectionTest, ManyFields) {
+        testTransform("{a: 1, b: 1, c: 1, d: 1, e: 1, f: 1, g: 1, h: 1, i: 1, j: 1, 'k.l': 1}",
+                      "{j: 1, z: 2, a: 3, k: {l: 4, m: 5}, e: 6}",
+                      "{j: 1, a: 3, k: {l: 4}, e: 6}");
+    }
+
+    TEST(InclusionProjectionTest, NotCompiled) {
+        const char* specs[] = {
+            "{}",
+            "{_id: 0}",
+            "{a: 0}",
+            "{a: 1, b: 0}",
+            "{'a.$': 1}",
+            "{a: {$slice: 1}}",
+            "{a: {$elemMatch: {b: 1}}}",
+            "{a: {$meta: 'textScore'}}",
+            "{a: 1, 'a.b': 1}",
+            "{'a.b': 1, a: 1}",
+            "{'a..b': 1}",
+        };
+
+        for (size_t i = 0; i < sizeof(specs) / sizeof(specs[0]); ++i) {
+            auto_ptr<InclusionProjection> projection(InclusionProjection::make(fromjson(specs[i])));
+            ASSERT(NULL == projection.get());
+        }
+    }
+
+}  // namespace
@@ -30,6 +30,9 @@
 
 #include "mongo/db/exec/index_scan.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_computed_data.h"
@@ -37,6 +40,7 @@
 #include "mongo/db/index/index_cursor.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/util/log.h"
 
 namespace {
@@ -48,6 +52,38 @@ namespace {
         return i > 0 ? 1 : -1;
     }
 
+    /**
+     * Encode 'key' as a KeyString which sorts just before (if 'before') or just after every index
+     * key equal to 'key'.
+     */
+    std::string encodeKeyStringBound(const mongo::BSONObj& key,
+                                     bool before,
+                                     mongo::Ordering ord) {
+        mongo::BSONObjBuilder bob;
+        mongo::BSONObjIterator it(key);
+        while (it.more()) {
+            mongo::BSONElement elt = it.next();
+            // KeyString appends a marker after a field named "l" or "g", the same way
+            // IndexEntryComparison::makeQueryObject() asks for seek positions.
+            bob.appendAs(elt, it.more() ? "" : (before ? "l" : "g"));
+        }
+        mongo::KeyString ks(bob.obj(), ord);
+        return std::string(ks.getBuffer(), ks.getSize());
+    }
+
+    // Does 'key' come after the encoded 'bound' when scanning in 'direction'?  The key may be
+    // followed by its RecordId, which never matters since the bound ends in a marker.
+    bool isAfterKeyStringBound(const mongo::KeyString& key,
+                               const std::string& bound,
+                               int direction) {
+        const size_t len = std::min(key.getSize(), bound.size());
+        int cmp = memcmp(key.getBuffer(), bound.data(), len);
+        if (0 == cmp) {
+            cmp = key.getSize() < bound.size() ? -1 : 1;
+        }
+        return (cmp > 0) == (1 == direction);
+    }
+
 }  // namespace
 
 namespace mongo {
@@ -72,7 +108,9 @@ namespace mongo {
           _btreeCursor(NULL),
           _keyEltsToUse(0),
           _movePastKeyElts(false),
-          _endKeyInclusive(false) {
+          _endKeyInclusive(false),
+          _keyStringBoundsInitialized(false),
+          _curInterval(0) {
         _iam = _params.descriptor->getIndexCatalog()->getIndex(_params.descriptor);
         _keyPattern = _params.descriptor->keyPattern().getOwned();
 
@@ -81,6 +119,7 @@ namespace mongo {
         _specificStats.keyPattern = _keyPattern;
         _specificStats.indexName = _params.descriptor->indexName();
         _specificStats.isMultiKey = _params.descriptor->isMultikey(_txn);
+        _specificStats.estimatedKeys = _params.estimatedKeys;
     }
 
     void IndexScan::initIndexScan() {
@@ -183,7 +222,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (INITIALIZING == _scanState) {
             invariant(NULL == _indexCursor.get());
@@ -370,12 +409,93 @@ namespace mongo {
         }
     }
 
+    void IndexScan::initKeyStringBounds() {
+        invariant(!_keyStringBoundsInitialized);
+        _keyStringBoundsInitialized = true;
+
+        // TODO: Get rid of this cast. See SERVER-12397.
+        BtreeIndexCursor* cursor = static_cast<BtreeIndexCursor*>(_indexCursor.get());
+        if (NULL == cursor->getKeyString()) {
+            // The index doesn't store KeyStrings.
+            return;
+        }
+
+        const Ordering ord = Ordering::make(_keyPattern);
+        const bool forward = (1 == _params.direction);
+
+        if (_params.bounds.isSimpleRange) {
+            const BSONObj& endKey = _params.bounds.endKey;
+
+            // A shorter end key compares differently than its encoding would, so leave those to
+            // the BSON comparison.
+            if (!endKey.isEmpty() && endKey.nFields() == _keyPattern.nFields()) {
+                const bool before = (_params.bounds.endKeyInclusive != forward);
+                _endKeyString = encodeKeyStringBound(endKey, before, ord);
+            }
+        }
+        else if (_checker && 1 == _params.bounds.fields.size()) {
+            const OrderedIntervalList& oil = _params.bounds.fields[0];
+            _intervalStartKeyStrings.reserve(oil.intervals.size());
+            _intervalEndKeyStrings.reserve(oil.intervals.size());
+            for (size_t i = 0; i < oil.intervals.size(); ++i) {
+                const Interval& interval = oil.intervals[i];
+                _intervalStartKeyStrings.push_back(
+                    encodeKeyStringBound(interval.start.wrap(""),
+                                         interval.startInclusive == forward,
+                                         ord));
+                _intervalEndKeyStrings.push_back(
+                    encodeKeyStringBound(interval.end.wrap(""),
+                                         interval.endInclusive != forward,
+                                         ord));
+            }
+        }
+    }
+
+    void IndexScan::checkEndKeyStringIntervals() {
+        const KeyString* key = _btreeCursor->getKeyString();
+        invariant(key);
+
+        // Move past the intervals that end before the key.
+        while (isAfterKeyStringBound(*key, _intervalEndKeyStrings[_curInterval],
+                                     _params.direction)) {
+            ++_curInterval;
+            if (_intervalEndKeyStrings.size() == _curInterval) {
+                _scanState = HIT_END;
+                return;
+            }
+        }
+
+        // This seems weird but it's the old definition of nscanned.
+        ++_specificStats.keysExamined;
+
+        if (isAfterKeyStringBound(*key, _intervalStartKeyStrings[_curInterval],
+                                  _params.direction)) {
+            _scanState = GETTING_NEXT;
+            return;
+        }
+
+        // The key is between two intervals.  Seek to the start of the next one.
+        const Interval& interval = _params.bounds.fields[0].intervals[_curInterval];
+        _keyElts[0] = &interval.start;
+        _keyEltsInc[0] = interval.startInclusive;
+        _btreeCursor->seek(_keyElts, _keyEltsInc);
+
+        // Must check underlying cursor EOF after every cursor movement.
+        if (_btreeCursor->isEOF()) {
+            _scanState = HIT_END;
+        }
+    }
+
     void IndexScan::checkEnd() {
         if (isEOF()) {
             _commonStats.isEOF = true;
             return;
         }
 
+        if (!_keyStringBoundsInitialized) {
+            initKeyStringBounds();
+        }
+
         if (_params.bounds.isSimpleRange) {
             _scanState = GETTING_NEXT;
 
@@ -386,10 +506,21 @@ namespace mongo {
             // If there is an empty endKey we will scan until we run out of index to scan over.
             if (_params.bounds.endKey.isEmpty()) { return; }
 
-            int cmp = sgn(_params.bounds.endKey.woCompare(_indexCursor->getKey(), _keyPattern));
+            bool pastEnd;
+            if (!_endKeyString.empty()) {
+                // TODO: Get rid of this cast. See SERVER-12397.
+                const KeyString* key =
+                    static_cast<BtreeIndexCursor*>(_indexCursor.get())->getKeyString();
+                pastEnd = isAfterKeyStringBound(*key, _endKeyString, _params.direction);
+            }
+            else {
+                int cmp = sgn(_params.bounds.endKey.woCompare(_indexCursor->getKey(),
+                                                              _keyPattern));
+                pastEnd = (cmp != 0 && cmp != _params.direction)
+                          || (cmp == 0 && !_params.bounds.endKeyInclusive);
+            }
 
-            if ((cmp != 0 && cmp != _params.direction)
-                || (cmp == 0 && !_params.bounds.endKeyInclusive)) {
+            if (pastEnd) {
                 _scanState = HIT_END;
             }
             else {
@@ -410,6 +541,9 @@ namespace mongo {
                 ++_specificStats.keysExamined;
             }
         }
+        else if (!_intervalEndKeyStrings.empty()) {
+            checkEndKeyStringIntervals();
+        }
         else {
             verify(NULL != _btreeCursor);
             verify(NULL != _checker.get());
@@ -29,6 +29,8 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <string>
+#include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/index/btree_index_cursor.h"
@@ -51,7 +53,8 @@ namespace mongo {
                             direction(1),
                             doNotDedup(false),
                             maxScan(0),
-                            addKeyMetadata(false) { }
+                            addKeyMetadata(false),
+                            estimatedKeys(-1) { }
 
         const IndexDescriptor* descriptor;
 
@@ -66,6 +69,9 @@ namespace mongo {
 
         // Do we want to add the key as metadata?
         bool addKeyMetadata;
+
+        // The planner's estimate of how many keys we will look at, or -1. Only reported.
+        long long estimatedKeys;
     };
 
     /**
@@ -135,6 +141,18 @@ namespace mongo {
         /** See if the cursor is pointing at or past _endKey, if _endKey is non-empty. */
         void checkEnd();
 
+        /**
+         * If the index stores its keys as KeyStrings, encode the bounds we can check with memcmp.
+         * Called once, when the cursor first points at a key.
+         */
+        void initKeyStringBounds();
+
+        /**
+         * checkEnd() for a single field index scanned with several intervals whose bounds are
+         * encoded as KeyStrings.
+         */
+        void checkEndKeyStringIntervals();
+
         // transactional context for read locks. Not owned by us
         OperationContext* _txn;
 
@@ -210,6 +228,28 @@ namespace mongo {
 
         // Is the end key included in the range?
         bool _endKeyInclusive;
+
+        //
+        // If the index stores its keys as KeyStrings, the end of a simple range and the intervals
+        // of a single field index are also kept as encoded KeyStrings.  The key the cursor points
+        // at is then checked against the bounds with a memcmp, without decoding it to BSON.  Each
+        // encoded bound sorts strictly between index keys, so a key never compares equal to one.
+        //
+
+        // Has initKeyStringBounds() run?
+        bool _keyStringBoundsInitialized;
+
+        // The encoded end of a simple range, or empty.
+        std::string _endKeyString;
+
+        // The encoded start and end of each interval of a single field index, or empty.  A key
+        // is in interval i if, in the direction of the scan, it comes after
+        // _intervalStartKeyStrings[i] and before _intervalEndKeyStrings[i].
+        std::vector<std::string> _intervalStartKeyStrings;
+        std::vector<std::string> _intervalEndKeyStrings;
+
+        // The interval the cursor is in or before.
+        size_t _curInterval;
     };
 
 }  // namespace mongo
@@ -98,7 +98,7 @@ namespace mongo {
 
     PlanStage::StageState MultiPlanStage::work(WorkingSetID* out) {
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (_failure) {
             *out = _statusMemberId;
@@ -187,7 +187,7 @@ namespace mongo {
         // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
         // execution work that happens here, so this is needed for the time accounting to
         // make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         // Run each plan some number of times. This number is at least as great as
         // 'internalQueryPlanEvaluationWorks', but may be larger for big collections.
@@ -219,6 +219,7 @@ namespace mongo {
         for (size_t ix = 0; ix < numWorks; ++ix) {
             bool moreToDo = workAllPlans(numResults, yieldPolicy);
             if (!moreToDo) { break; }
+            pruneLaggingPlans(numResults);
         }
 
         if (_failure) {
@@ -333,6 +334,38 @@ namespace mongo {
         return Status::OK();
     }
 
+    void MultiPlanStage::pruneLaggingPlans(size_t numResults) {
+        const double ratio = internalQueryPlanEvaluationTrialPruneRatio;
+        if (ratio <= 0) {
+            return;
+        }
+
+        size_t mostResults = 0;
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            const CandidatePlan& candidate = _candidates[ix];
+            if (!candidate.failed && !candidate.pruned) {
+                mostResults = std::max(mostResults, candidate.results.size());
+            }
+        }
+
+        // Early in the trial a few results either way are noise, so wait for the leader to get
+        // halfway to the limit.
+        if (mostResults < kMinResultsBeforePruning || mostResults * 2 < numResults) {
+            return;
+        }
+
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            CandidatePlan& candidate = _candidates[ix];
+            if (candidate.failed || candidate.pruned) { continue; }
+
+            if (candidate.results.size() * ratio < mostResults) {
+                QLOG() << "Pruning candidate " << ix << " with " << candidate.results.size()
+                       << " results, leader has " << mostResults << endl;
+                candidate.pruned = true;
+            }
+        }
+    }
+
     vector<PlanStageStats*> MultiPlanStage::generateCandidateStats() {
         OwnedPointerVector<PlanStageStats> candidateStats;
 
@@ -354,7 +387,7 @@ namespace mongo {
 
         for (size_t ix = 0; ix < _candidates.size(); ++ix) {
             CandidatePlan& candidate = _candidates[ix];
-            if (candidate.failed) { continue; }
+            if (candidate.failed || candidate.pruned) { continue; }
 
             // Might need to yield between calls to work due to the timer elapsing.
             if (!(tryYield(yieldPolicy)).isOK()) {
@@ -142,6 +142,13 @@ namespace mongo {
          */
         bool workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolicy);
 
+        /**
+         * Stops working candidates that have fallen so far behind the one with the most results
+         * that they can't realistically catch up before the trial period ends. Every candidate
+         * costs one work() per round, so this shortens plan selection when there are many.
+         */
+        void pruneLaggingPlans(size_t numResults);
+
         /**
          * Checks whether we need to perform either a timing-based yield or a yield for a document
          * fetch. If so, then uses 'yieldPolicy' to actually perform the yield.
@@ -152,6 +159,9 @@ namespace mongo {
 
         static const int kNoSuchPlan = -1;
 
+        // The leading candidate must have at least this many results before others are pruned.
+        static const size_t kMinResultsBeforePruning = 10;
+
         // not owned here
         OperationContext* _txn;
         const Collection* _collection;
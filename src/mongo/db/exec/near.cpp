@@ -97,7 +97,7 @@ namespace mongo {
         ++_stats->common.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_stats->common.executionTimeMillis);
+        ScopedTimer timer(&_stats->common);
 
         WorkingSetID toReturn = WorkingSet::INVALID_ID;
         Status error = Status::OK();
@@ -58,7 +58,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -76,18 +76,14 @@ namespace mongo {
             if (_dedup && member->hasLoc()) {
                 ++_specificStats.dupsTested;
 
-                // ...and we've seen the RecordId before
-                if (_seen.end() != _seen.find(member->loc)) {
-                    // ...drop it.
+                // ...and we've seen the RecordId before, drop it.  Otherwise, note that we've
+                // seen it.
+                if (!_seen.insert(member->loc)) {
                     ++_specificStats.dupsDropped;
                     _ws->free(id);
                     ++_commonStats.needTime;
                     return PlanStage::NEED_TIME;
                 }
-                else {
-                    // Otherwise, note that we've seen it.
-                    _seen.insert(member->loc);
-                }
             }
 
             if (Filter::passes(member, _filter)) {
@@ -170,10 +166,8 @@ namespace mongo {
         // If we see DL again it is not the same record as it once was so we still want to
         // return it.
         if (_dedup && INVALIDATION_DELETION == type) {
-            unordered_set<RecordId, RecordId::Hasher>::iterator it = _seen.find(dl);
-            if (_seen.end() != it) {
+            if (_seen.erase(dl)) {
                 ++_specificStats.locsForgotten;
-                _seen.erase(dl);
             }
         }
     }
@@ -192,6 +186,8 @@ namespace mongo {
             _commonStats.filter = bob.obj();
         }
 
+        _specificStats.memUsage = _seen.memUsage();
+
         auto_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_OR));
         ret->specific.reset(new OrStats(_specificStats));
         for (size_t i = 0; i < _children.size(); ++i) {
@@ -206,6 +202,7 @@ namespace mongo {
     }
 
     const SpecificStats* OrStage::getSpecificStats() {
+        _specificStats.memUsage = _seen.memUsage();
         return &_specificStats;
     }
 
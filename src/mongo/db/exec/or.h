@@ -29,10 +29,10 @@
 #pragma once
 
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_set.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
-#include "mongo/platform/unordered_set.h"
 
 namespace mongo {
 
@@ -87,7 +87,7 @@ namespace mongo {
         bool _dedup;
 
         // Which RecordIds have we returned?
-        unordered_set<RecordId, RecordId::Hasher> _seen;
+        RecordIdSet _seen;
 
         // Stats
         CommonStats _commonStats;
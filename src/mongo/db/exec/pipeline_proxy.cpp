@@ -115,6 +115,7 @@ namespace mongo {
     }
 
     boost::optional<BSONObj> PipelineProxyStage::getNextBson() {
+        DocumentStoragePool::Scope poolScope(&_pipeline->getContext()->documentPool);
         if (boost::optional<Document> next = _pipeline->output()->getNext()) {
             if (_includeMetaData) {
                 return next->toBsonWithMetaData();
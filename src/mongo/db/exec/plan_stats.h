@@ -66,6 +66,7 @@ namespace mongo {
                         needTime(0),
                         needFetch(0),
                         executionTimeMillis(0),
+                        executionTimeNanos(0),
                         isEOF(false) { }
         // String giving the type of the stage. Not owned.
         const char* stageTypeStr;
@@ -88,6 +89,10 @@ namespace mongo {
         // Time elapsed while working inside this stage.
         long long executionTimeMillis;
 
+        // Time elapsed while working inside this stage, from the cycle clock. An estimate from
+        // sampled calls, zero unless stage timing is sampled or the plan is being explained.
+        long long executionTimeNanos;
+
         // TODO: have some way of tracking WSM sizes (or really any series of #s).  We can measure
         // the size of our inputs and the size of our outputs.  We can do a lot with the WS here.
 
@@ -200,11 +205,14 @@ namespace mongo {
     };
 
     struct CachedPlanStats : public SpecificStats {
-        CachedPlanStats() { }
+        CachedPlanStats() : replanned(false) { }
 
         virtual SpecificStats* clone() const {
             return new CachedPlanStats(*this);
         }
+
+        // True if the cached plan took too long and the query was planned again.
+        bool replanned;
     };
 
     struct CollectionScanStats : public SpecificStats {
@@ -300,7 +308,8 @@ namespace mongo {
         FetchStats() : alreadyHasObj(0),
                        forcedFetches(0),
                        matchTested(0),
-                       docsExamined(0) { }
+                       docsExamined(0),
+                       docsPrefetched(0) { }
 
         virtual ~FetchStats() { }
 
@@ -324,6 +333,9 @@ namespace mongo {
 
         // The total number of full documents touched by the fetch stage.
         size_t docsExamined;
+
+        // How many records were handed to the storage engine to page in ahead of being fetched?
+        size_t docsPrefetched;
     };
 
     struct GroupStats : public SpecificStats {
@@ -342,7 +354,8 @@ namespace mongo {
 
     struct IDHackStats : public SpecificStats {
         IDHackStats() : keysExamined(0),
-                        docsExamined(0) { }
+                        docsExamined(0),
+                        documentCacheHits(0) { }
 
         virtual ~IDHackStats() { }
 
@@ -357,6 +370,9 @@ namespace mongo {
         // Number of documents retrieved from the collection while executing the idhack.
         size_t docsExamined;
 
+        // Number of times the document was served by the DocumentCache instead.
+        size_t documentCacheHits;
+
     };
 
     struct IndexScanStats : public SpecificStats {
@@ -366,7 +382,8 @@ namespace mongo {
                            dupsDropped(0),
                            seenInvalidated(0),
                            matchTested(0),
-                           keysExamined(0) { }
+                           keysExamined(0),
+                           estimatedKeys(-1) { }
 
         virtual ~IndexScanStats() { }
 
@@ -410,6 +427,9 @@ namespace mongo {
         // Number of entries retrieved from the index during the scan.
         size_t keysExamined;
 
+        // Number of entries the planner expected the scan to retrieve, or -1 if not estimated.
+        long long estimatedKeys;
+
     };
 
     struct LimitStats : public SpecificStats {
@@ -442,7 +462,8 @@ namespace mongo {
     struct OrStats : public SpecificStats {
         OrStats() : dupsTested(0),
                     dupsDropped(0),
-                    locsForgotten(0) { }
+                    locsForgotten(0),
+                    memUsage(0) { }
 
         virtual ~OrStats() { }
 
@@ -457,6 +478,9 @@ namespace mongo {
         // How many calls to invalidate(...) actually removed a RecordId from our deduping map?
         size_t locsForgotten;
 
+        // Bytes used by the set of RecordIds we dedup against.
+        size_t memUsage;
+
         // We know how many passed (it's the # of advanced) and therefore how many failed.
         std::vector<size_t> matchTested;
     };
@@ -474,7 +498,7 @@ namespace mongo {
     };
 
     struct SortStats : public SpecificStats {
-        SortStats() : forcedFetches(0), memUsage(0), memLimit(0) { }
+        SortStats() : forcedFetches(0), memUsage(0), memLimit(0), spilledDocs(0) { }
 
         virtual ~SortStats() { }
 
@@ -497,6 +521,9 @@ namespace mongo {
 
         // The pattern according to which we are sorting.
         BSONObj sortPattern;
+
+        // How many results did we hand to the external sorter after running out of memory?
+        size_t spilledDocs;
     };
 
     struct MergeSortStats : public SpecificStats {
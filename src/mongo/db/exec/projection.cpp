@@ -60,6 +60,10 @@ namespace mongo {
 
         _projObj = params.projObj;
 
+        // Inclusion-only projections, dotted ones included, are copied straight out of the
+        // document through a precomputed field trie.
+        _inclusion.reset(InclusionProjection::make(_projObj));
+
         if (ProjectionStageParams::NO_FAST_PATH == _projImpl) {
             _exec.reset(new ProjectionExec(params.projObj, 
                                            params.fullExpression,
@@ -153,7 +157,8 @@ namespace mongo {
 
     Status ProjectionStage::transform(WorkingSetMember* member) {
         // The default no-fast-path case.
-        if (ProjectionStageParams::NO_FAST_PATH == _projImpl) {
+        if (ProjectionStageParams::NO_FAST_PATH == _projImpl &&
+            !(_inclusion && member->hasObj())) {
             return _exec->transform(member);
         }
 
@@ -165,12 +170,17 @@ namespace mongo {
         // is not available.
         //
         // SIMPLE_DOC implies that we expect an object so it's kind of redundant.
-        if ((ProjectionStageParams::SIMPLE_DOC == _projImpl) || member->hasObj()) {
+        if ((ProjectionStageParams::COVERED_ONE_INDEX != _projImpl) || member->hasObj()) {
             // If we got here because of SIMPLE_DOC the planner shouldn't have messed up.
             invariant(member->hasObj());
 
             // Apply the SIMPLE_DOC projection.
-            transformSimpleInclusion(member->obj, _includedFields, bob);
+            if (_inclusion) {
+                _inclusion->transform(member->obj, &bob);
+            }
+            else {
+                transformSimpleInclusion(member->obj, _includedFields, bob);
+            }
         }
         else {
             invariant(ProjectionStageParams::COVERED_ONE_INDEX == _projImpl);
@@ -206,7 +216,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         WorkingSetID id = WorkingSet::INVALID_ID;
         StageState status = _child->work(&id);
@@ -30,6 +30,7 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "mongo/db/exec/inclusion_projection.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/projection_exec.h"
 #include "mongo/db/jsobj.h"
@@ -126,6 +127,10 @@ namespace mongo {
 
         boost::scoped_ptr<ProjectionExec> _exec;
 
+        // Set if the projection only includes fields. Used instead of _exec and the SIMPLE_DOC
+        // field set whenever we have the document.
+        boost::scoped_ptr<InclusionProjection> _inclusion;
+
         // _ws is not owned by us.
         WorkingSet* _ws;
         boost::scoped_ptr<PlanStage> _child;
@@ -0,0 +1,227 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_set.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+    namespace {
+        const size_t kBitmapWords = (1 << 16) / 64;
+
+        // What a std::map node costs beyond its value: three links and the color, rounded up.
+        const size_t kMapNodeOverhead = 4 * sizeof(void*);
+    }
+
+    const size_t RecordIdSet::kMaxArrayEntries;
+    const size_t RecordIdSet::kMinChunksForHashSet;
+    const size_t RecordIdSet::kMinEntriesPerChunk;
+
+    bool RecordIdSet::Chunk::insert(uint16_t low) {
+        if (!bitmap.empty()) {
+            uint64_t& word = bitmap[low / 64];
+            const uint64_t bit = uint64_t(1) << (low % 64);
+            if (word & bit)
+                return false;
+            word |= bit;
+            ++count;
+            return true;
+        }
+
+        std::vector<uint16_t>::iterator it = std::lower_bound(array.begin(), array.end(), low);
+        if (it != array.end() && *it == low)
+            return false;
+
+        if (array.size() < kMaxArrayEntries) {
+            array.insert(it, low);
+            ++count;
+            return true;
+        }
+
+        bitmap.assign(kBitmapWords, 0);
+        for (size_t i = 0; i < array.size(); ++i) {
+            bitmap[array[i] / 64] |= uint64_t(1) << (array[i] % 64);
+        }
+        std::vector<uint16_t>().swap(array);
+        return insert(low);
+    }
+
+    bool RecordIdSet::Chunk::contains(uint16_t low) const {
+        if (!bitmap.empty())
+            return bitmap[low / 64] & (uint64_t(1) << (low % 64));
+        return std::binary_search(array.begin(), array.end(), low);
+    }
+
+    bool RecordIdSet::Chunk::erase(uint16_t low) {
+        if (!bitmap.empty()) {
+            uint64_t& word = bitmap[low / 64];
+            const uint64_t bit = uint64_t(1) << (low % 64);
+            if (!(word & bit))
+                return false;
+            word &= ~bit;
+            --count;
+            return true;
+        }
+
+        std::vector<uint16_t>::iterator it = std::lower_bound(array.begin(), array.end(), low);
+        if (it == array.end() || *it != low)
+            return false;
+        array.erase(it);
+        --count;
+        return true;
+    }
+
+    size_t RecordIdSet::Chunk::memUsage() const {
+        return array.capacity() * sizeof(uint16_t) + bitmap.capacity() * sizeof(uint64_t);
+    }
+
+    RecordIdSet::RecordIdSet()
+        : _lastChunk(_chunks.end()),
+          _usingHashSet(false),
+          _size(0),
+          _chunkBytes(0) { }
+
+    RecordIdSet::Chunk* RecordIdSet::findChunk(int64_t high) const {
+        ChunkMap& chunks = const_cast<ChunkMap&>(_chunks);
+        if (_lastChunk == chunks.end() || _lastChunk->first != high) {
+            ChunkMap::iterator it = chunks.find(high);
+            if (it == chunks.end())
+                return NULL;
+            _lastChunk = it;
+        }
+        return &_lastChunk->second;
+    }
+
+    bool RecordIdSet::insert(const RecordId& loc) {
+        if (_usingHashSet) {
+            if (!_hashSet.insert(loc).second)
+                return false;
+            ++_size;
+            return true;
+        }
+
+        const int64_t high = highPart(loc);
+        Chunk* chunk = findChunk(high);
+        if (!chunk) {
+            if (_chunks.size() >= kMinChunksForHashSet &&
+                _size < _chunks.size() * kMinEntriesPerChunk) {
+                switchToHashSet();
+                return insert(loc);
+            }
+            _lastChunk = _chunks.insert(std::make_pair(high, Chunk())).first;
+            chunk = &_lastChunk->second;
+        }
+
+        const size_t bytesBefore = chunk->memUsage();
+        if (!chunk->insert(lowPart(loc)))
+            return false;
+        _chunkBytes += chunk->memUsage() - bytesBefore;
+        ++_size;
+        return true;
+    }
+
+    bool RecordIdSet::contains(const RecordId& loc) const {
+        if (_usingHashSet)
+            return _hashSet.end() != _hashSet.find(loc);
+
+        const Chunk* chunk = findChunk(highPart(loc));
+        return chunk && chunk->contains(lowPart(loc));
+    }
+
+    bool RecordIdSet::erase(const RecordId& loc) {
+        if (_usingHashSet) {
+            if (!_hashSet.erase(loc))
+                return false;
+            --_size;
+            return true;
+        }
+
+        Chunk* chunk = findChunk(highPart(loc));
+        if (!chunk)
+            return false;
+
+        const size_t bytesBefore = chunk->memUsage();
+        if (!chunk->erase(lowPart(loc)))
+            return false;
+        _chunkBytes -= bytesBefore - chunk->memUsage();
+        --_size;
+
+        if (chunk->count == 0) {
+            _chunkBytes -= chunk->memUsage();
+            _chunks.erase(_lastChunk);
+            _lastChunk = _chunks.end();
+        }
+        return true;
+    }
+
+    void RecordIdSet::clear() {
+        _chunks.clear();
+        _lastChunk = _chunks.end();
+        _hashSet.clear();
+        _usingHashSet = false;
+        _size = 0;
+        _chunkBytes = 0;
+    }
+
+    size_t RecordIdSet::memUsage() const {
+        if (_usingHashSet) {
+            // Each entry is a node holding the RecordId and a link, and each bucket a pointer.
+            return _hashSet.size() * (sizeof(RecordId) + 2 * sizeof(void*)) +
+                _hashSet.bucket_count() * sizeof(void*);
+        }
+        return _chunkBytes + _chunks.size() * (sizeof(ChunkMap::value_type) + kMapNodeOverhead);
+    }
+
+    void RecordIdSet::switchToHashSet() {
+        _hashSet.rehash(_size);
+        for (ChunkMap::const_iterator it = _chunks.begin(); it != _chunks.end(); ++it) {
+            const Chunk& chunk = it->second;
+            const int64_t base = it->first << 16;
+            if (chunk.bitmap.empty()) {
+                for (size_t i = 0; i < chunk.array.size(); ++i) {
+                    _hashSet.insert(RecordId(base | chunk.array[i]));
+                }
+                continue;
+            }
+            for (size_t word = 0; word < chunk.bitmap.size(); ++word) {
+                for (size_t bit = 0; bit < 64; ++bit) {
+                    if (chunk.bitmap[word] & (uint64_t(1) << bit))
+                        _hashSet.insert(RecordId(base | int64_t(word * 64 + bit)));
+                }
+            }
+        }
+
+        _chunks.clear();
+        _lastChunk = _chunks.end();
+        _chunkBytes = 0;
+        _usingHashSet = true;
+    }
+
+}  // namespace mongo
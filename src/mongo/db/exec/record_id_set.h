@@ -0,0 +1,138 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/record_id.h"
+#include "mongo/platform/cstdint.h"
+#include "mongo/platform/unordered_set.h"
+
+namespace mongo {
+
+    /**
+     * A set of RecordIds for the stages that deduplicate or intersect the RecordIds their
+     * children produce.
+     *
+     * RecordIds are split into a high part and the low 16 bits, and each high part gets a
+     * chunk of the low parts it has seen.  A chunk holds a sorted array of them while it has
+     * fewer than kMaxArrayEntries, and a 65536 bit bitmap afterwards.  Record stores hand out
+     * RecordIds that cluster (sequential ids, or offsets within the same extent), so this takes
+     * a few bytes per RecordId where a hash set takes several words and an allocation.
+     *
+     * If the RecordIds turn out to be spread so thinly that most chunks hold only a few of them,
+     * the set moves its contents to a hash set and uses that from then on.
+     *
+     * Not thread safe.
+     */
+    class RecordIdSet {
+        MONGO_DISALLOW_COPYING(RecordIdSet);
+    public:
+        RecordIdSet();
+
+        /**
+         * Adds 'loc' to the set.  Returns false if it was already there.
+         */
+        bool insert(const RecordId& loc);
+
+        bool contains(const RecordId& loc) const;
+
+        /**
+         * Removes 'loc' from the set.  Returns false if it was not there.
+         */
+        bool erase(const RecordId& loc);
+
+        void clear();
+
+        size_t size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        /**
+         * An estimate of the memory used by the set, in bytes.
+         */
+        size_t memUsage() const;
+
+        /**
+         * True once the set has given up on chunks and keeps its RecordIds in a hash set.
+         */
+        bool usingHashSet() const { return _usingHashSet; }
+
+        // A chunk switches from an array to a bitmap once it has this many entries, which is
+        // where the array would be as large as the bitmap.
+        static const size_t kMaxArrayEntries = 4096;
+
+        // Fall back to the hash set once there are at least this many chunks, averaging fewer
+        // than kMinEntriesPerChunk RecordIds each.
+        static const size_t kMinChunksForHashSet = 1024;
+        static const size_t kMinEntriesPerChunk = 4;
+
+    private:
+        struct Chunk {
+            Chunk() : count(0) { }
+
+            bool insert(uint16_t low);
+            bool contains(uint16_t low) const;
+            bool erase(uint16_t low);
+            size_t memUsage() const;
+
+            // Sorted low parts while the chunk is small, empty once it has moved to 'bitmap'.
+            std::vector<uint16_t> array;
+            std::vector<uint64_t> bitmap;
+            size_t count;
+        };
+
+        typedef std::map<int64_t, Chunk> ChunkMap;
+        typedef unordered_set<RecordId, RecordId::Hasher> HashSet;
+
+        static int64_t highPart(const RecordId& loc) { return loc.repr() >> 16; }
+        static uint16_t lowPart(const RecordId& loc) { return loc.repr() & 0xFFFF; }
+
+        /**
+         * Returns the chunk for 'high', or NULL if there is none.  Consecutive lookups tend to
+         * hit the same chunk, so the last one found is remembered.
+         */
+        Chunk* findChunk(int64_t high) const;
+
+        void switchToHashSet();
+
+        ChunkMap _chunks;
+        mutable ChunkMap::iterator _lastChunk;
+
+        HashSet _hashSet;
+        bool _usingHashSet;
+
+        size_t _size;
+
+        // Memory held by the chunks' arrays and bitmaps.
+        size_t _chunkBytes;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,133 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/exec/record_id_set.cpp
+ */
+
+#include <set>
+
+#include "mongo/db/exec/record_id_set.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    TEST(RecordIdSetTest, InsertContainsErase) {
+        RecordIdSet set;
+        ASSERT_TRUE(set.empty());
+        ASSERT_TRUE(set.insert(RecordId(5)));
+        ASSERT_FALSE(set.insert(RecordId(5)));
+        ASSERT_TRUE(set.insert(RecordId(1, 12)));
+        ASSERT_EQUALS(2U, set.size());
+
+        ASSERT_TRUE(set.contains(RecordId(5)));
+        ASSERT_TRUE(set.contains(RecordId(1, 12)));
+        ASSERT_FALSE(set.contains(RecordId(6)));
+        ASSERT_FALSE(set.contains(RecordId(2, 12)));
+
+        ASSERT_TRUE(set.erase(RecordId(5)));
+        ASSERT_FALSE(set.erase(RecordId(5)));
+        ASSERT_FALSE(set.contains(RecordId(5)));
+        ASSERT_EQUALS(1U, set.size());
+
+        set.clear();
+        ASSERT_TRUE(set.empty());
+        ASSERT_FALSE(set.contains(RecordId(1, 12)));
+    }
+
+    // Sequential RecordIds fill chunks past the array limit, so they end up in bitmaps.
+    TEST(RecordIdSetTest, DenseRecordIdsAreCompact) {
+        RecordIdSet set;
+        const int64_t n = 200 * 1000;
+        for (int64_t i = 1; i <= n; ++i) {
+            ASSERT_TRUE(set.insert(RecordId(i)));
+        }
+        ASSERT_EQUALS(size_t(n), set.size());
+        ASSERT_FALSE(set.usingHashSet());
+        ASSERT_LESS_THAN(set.memUsage(), size_t(n) / 2);
+
+        for (int64_t i = 1; i <= n; ++i) {
+            ASSERT_TRUE(set.contains(RecordId(i)));
+            ASSERT_FALSE(set.insert(RecordId(i)));
+        }
+        ASSERT_FALSE(set.contains(RecordId(n + 1)));
+
+        for (int64_t i = 1; i <= n; i += 2) {
+            ASSERT_TRUE(set.erase(RecordId(i)));
+        }
+        ASSERT_EQUALS(size_t(n / 2), set.size());
+        for (int64_t i = 1; i <= n; ++i) {
+            ASSERT_EQUALS(i % 2 == 0, set.contains(RecordId(i)));
+        }
+    }
+
+    // RecordIds with one per chunk don't compress, and the set moves to a hash set.
+    TEST(RecordIdSetTest, SparseRecordIdsFallBackToHashSet) {
+        RecordIdSet set;
+        const size_t n = RecordIdSet::kMinChunksForHashSet * 4;
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_TRUE(set.insert(RecordId(int64_t(i) << 20)));
+        }
+        ASSERT_TRUE(set.usingHashSet());
+        ASSERT_EQUALS(n, set.size());
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_TRUE(set.contains(RecordId(int64_t(i) << 20)));
+            ASSERT_FALSE(set.insert(RecordId(int64_t(i) << 20)));
+        }
+        ASSERT_TRUE(set.erase(RecordId(0)));
+        ASSERT_FALSE(set.contains(RecordId(0)));
+        ASSERT_EQUALS(n - 1, set.size());
+
+        set.clear();
+        ASSERT_FALSE(set.usingHashSet());
+    }
+
+    // The set agrees with std::set on a mix of mmapv1-style RecordIds.
+    TEST(RecordIdSetTest, MatchesStdSet) {
+        RecordIdSet set;
+        std::set<RecordId> expected;
+        unsigned seed = 12345;
+        for (int i = 0; i < 50000; ++i) {
+            seed = seed * 1103515245 + 12345;
+            const RecordId loc((seed >> 8) % 3, ((seed >> 12) % (1 << 20)) * 4);
+            if (seed % 5 == 0) {
+                ASSERT_EQUALS(expected.erase(loc) == 1, set.erase(loc));
+            }
+            else {
+                ASSERT_EQUALS(expected.insert(loc).second, set.insert(loc));
+            }
+        }
+        ASSERT_EQUALS(expected.size(), set.size());
+        for (std::set<RecordId>::const_iterator it = expected.begin(); it != expected.end();
+             ++it) {
+            ASSERT_TRUE(set.contains(*it));
+        }
+    }
+
+}  // namespace
@@ -30,18 +30,71 @@
 
 #include "mongo/db/exec/scoped_timer.h"
 
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/cycle_clock.h"
 #include "mongo/util/net/listen.h"
 
 namespace mongo {
 
-    ScopedTimer::ScopedTimer(long long* counter) :
-        _counter(counter),
-        _start(Listener::getElapsedTimeMillis()) {
+    // Time one in this many calls into each plan stage with the cycle clock. Zero only does so
+    // while explaining.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecStageTimingSampleRate, int, 0);
+
+namespace {
+
+#if defined(MONGO_HAVE___THREAD)
+    __thread int timeAllWorkDepth = 0;
+#elif defined(MONGO_HAVE___DECLSPEC_THREAD)
+    __declspec( thread ) int timeAllWorkDepth = 0;
+#endif
+
+    /**
+     * Returns how much time a call with the given number of works should count for, or zero if
+     * the call is not sampled. Without thread local storage explain gets the sampled times too.
+     */
+    long long sampleWeight(size_t works) {
+#if defined(MONGO_HAVE___THREAD) || defined(MONGO_HAVE___DECLSPEC_THREAD)
+        if (timeAllWorkDepth > 0) {
+            return 1;
+        }
+#endif
+        const int rate = internalQueryExecStageTimingSampleRate;
+        if (rate <= 0 || works % rate != 0) {
+            return 0;
+        }
+        return rate;
+    }
+
+} // namespace
+
+    ScopedTimer::ScopedTimer(CommonStats* stats) :
+        _stats(stats),
+        _start(Listener::getElapsedTimeMillis()),
+        _sampleWeight(sampleWeight(stats->works)),
+        _startTicks(_sampleWeight ? CycleClock::now() : 0) {
     }
 
     ScopedTimer::~ScopedTimer() {
         long long elapsed = Listener::getElapsedTimeMillis() - _start;
-        *_counter += elapsed;
+        _stats->executionTimeMillis += elapsed;
+
+        if (_sampleWeight) {
+            const long long nanos = CycleClock::toNanos(CycleClock::now() - _startTicks);
+            _stats->executionTimeNanos += nanos * _sampleWeight;
+        }
+    }
+
+    ScopedTimer::TimeAllWork::TimeAllWork() {
+#if defined(MONGO_HAVE___THREAD) || defined(MONGO_HAVE___DECLSPEC_THREAD)
+        ++timeAllWorkDepth;
+#endif
+    }
+
+    ScopedTimer::TimeAllWork::~TimeAllWork() {
+#if defined(MONGO_HAVE___THREAD) || defined(MONGO_HAVE___DECLSPEC_THREAD)
+        --timeAllWorkDepth;
+#endif
     }
 
 }  // namespace mongo
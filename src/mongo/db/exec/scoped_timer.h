@@ -32,26 +32,48 @@
 
 namespace mongo {
 
+    struct CommonStats;
+
     /**
-     * This class increments a counter by a rough estimate of the time elapsed since its
-     * construction when it goes out of scope.
+     * This class adds a rough estimate of the time elapsed since its construction to a stage's
+     * executionTimeMillis when it goes out of scope.
+     *
+     * Sampled timers, and all of them while a TimeAllWork is in scope, also measure the elapsed
+     * time with the cycle clock and add it to executionTimeNanos, scaled up by the sample rate.
      */
     class ScopedTimer {
         MONGO_DISALLOW_COPYING(ScopedTimer);
     public:
-        ScopedTimer(long long* counter);
+        ScopedTimer(CommonStats* stats);
 
         ~ScopedTimer();
 
+        /**
+         * While one is in scope every ScopedTimer on the thread is sampled, so that explain
+         * reports the time spent in each stage precisely.
+         */
+        class TimeAllWork {
+            MONGO_DISALLOW_COPYING(TimeAllWork);
+        public:
+            TimeAllWork();
+            ~TimeAllWork();
+        };
+
     private:
         // Default constructor disallowed.
         ScopedTimer();
 
-        // Reference to the counter that we are incrementing with the elapsed time.
-        long long* _counter;
+        // The stats that we are adding the elapsed time to.
+        CommonStats* _stats;
 
         // Time at which the timer was constructed.
         long long _start;
+
+        // What the cycle-clock time of this call counts for, or zero if it is not sampled.
+        long long _sampleWeight;
+
+        // Cycle clock reading at construction, if sampled.
+        unsigned long long _startTicks;
     };
 
 }  // namespace mongo
@@ -33,7 +33,6 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
-#include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -47,7 +46,11 @@ namespace mongo {
     ShardFilterStage::ShardFilterStage(const CollectionMetadataPtr& metadata,
                                        WorkingSet* ws,
                                        PlanStage* child)
-        : _ws(ws), _child(child), _commonStats(kStageType), _metadata(metadata) { }
+        : _ws(ws), _child(child), _commonStats(kStageType), _metadata(metadata) {
+        if (_metadata) {
+            _shardKeyPattern.reset(new ShardKeyPattern(_metadata->getKeyPattern()));
+        }
+    }
 
     ShardFilterStage::~ShardFilterStage() { }
 
@@ -57,7 +60,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         // If we've returned as many results as we're limited to, isEOF will be true.
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -71,10 +74,9 @@ namespace mongo {
             // aborted migrations
             if (_metadata) {
 
-                ShardKeyPattern shardKeyPattern(_metadata->getKeyPattern());
                 WorkingSetMember* member = _ws->get(*out);
                 WorkingSetMatchableDocument matchable(member);
-                BSONObj shardKey = shardKeyPattern.extractShardKeyFromMatchable(matchable);
+                BSONObj shardKey = _shardKeyPattern->extractShardKeyFromMatchable(matchable);
 
                 if (shardKey.isEmpty()) {
 
@@ -102,7 +104,7 @@ namespace mongo {
                               << "document may have been inserted manually into shard";
                 }
 
-                if (!_metadata->keyBelongsToMe(shardKey)) {
+                if (!_metadata->keyBelongsToMe(shardKey, &_rangeCursor)) {
                     _ws->free(*out);
                     ++_specificStats.chunkSkips;
                     return PlanStage::NEED_TIME;
@@ -35,6 +35,7 @@
 #include "mongo/db/record_id.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/d_state.h"
+#include "mongo/s/shard_key_pattern.h"
 
 namespace mongo {
 
@@ -108,6 +109,13 @@ namespace mongo {
         // Note: it is important that this is the metadata from the time this stage is constructed.
         // See class comment for details.
         const CollectionMetadataPtr _metadata;
+
+        // Parsed once from the metadata's key pattern, rather than for every document. Null if
+        // there is no metadata.
+        boost::scoped_ptr<ShardKeyPattern> _shardKeyPattern;
+
+        // The owned range the previous document's shard key fell in.
+        CollectionMetadata::RangeCursor _rangeCursor;
     };
 
 }  // namespace mongo
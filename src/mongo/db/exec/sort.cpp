@@ -40,6 +40,7 @@
 #include "mongo/db/query/qlog.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage_options.h"
 
 namespace mongo {
 
@@ -47,6 +48,71 @@ namespace mongo {
     using std::endl;
     using std::vector;
 
+namespace {
+
+    /**
+     * Orders spilled results like WorkingSetComparator orders buffered ones: by sort key, then by
+     * RecordId.
+     */
+    class SpillComparator {
+    public:
+        typedef std::pair<BSONObj, SortStageSpilledDoc> Data;
+
+        explicit SpillComparator(const BSONObj& pattern) : _pattern(pattern) { }
+
+        int operator()(const Data& lhs, const Data& rhs) const {
+            // False means ignore field names.
+            int result = lhs.first.woCompare(rhs.first, _pattern, false);
+            if (0 != result) {
+                return result;
+            }
+            return lhs.second.loc.compare(rhs.second.loc);
+        }
+
+    private:
+        BSONObj _pattern;
+    };
+
+    /**
+     * Returns true if 'member' has computed data, such as a text score, which a spilled copy of
+     * its document would lose.
+     */
+    bool hasComputedData(const WorkingSetMember& member) {
+        for (int i = 0; i < WSM_COMPUTED_NUM_TYPES; ++i) {
+            if (member.hasComputed(static_cast<WorkingSetComputedDataType>(i))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+}  // namespace
+
+    void SortStageSpilledDoc::serializeForSorter(BufBuilder& buf) const {
+        loc.serializeForSorter(buf);
+        obj.serializeForSorter(buf);
+    }
+
+    // static
+    SortStageSpilledDoc SortStageSpilledDoc::deserializeForSorter(
+            BufReader& buf, const SorterDeserializeSettings&) {
+        SortStageSpilledDoc doc;
+        doc.loc = RecordId::deserializeForSorter(buf, RecordId::SorterDeserializeSettings());
+        doc.obj = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+        return doc;
+    }
+
+    int SortStageSpilledDoc::memUsageForSorter() const {
+        return sizeof(SortStageSpilledDoc) + obj.objsize();
+    }
+
+    SortStageSpilledDoc SortStageSpilledDoc::getOwned() const {
+        SortStageSpilledDoc doc;
+        doc.loc = loc;
+        doc.obj = obj.getOwned();
+        return doc;
+    }
+
     // static
     const char* SortStage::kStageType = "SORT";
 
@@ -295,7 +361,8 @@ namespace mongo {
           _sorted(false),
           _resultIterator(_data.end()),
           _commonStats(kStageType),
-          _memUsage(0) {
+          _memUsage(0),
+          _earlySpillFailed(false) {
     }
 
     SortStage::~SortStage() { }
@@ -303,30 +370,25 @@ namespace mongo {
     bool SortStage::isEOF() {
         // We're done when our child has no more results, we've sorted the child's results, and
         // we've returned all sorted results.
-        return _child->isEOF() && _sorted && (_data.end() == _resultIterator);
+        return _child->isEOF() && _sorted && (_data.end() == _resultIterator)
+            && (NULL == _spillIterator.get() || !_spillIterator->more());
     }
 
     PlanStage::StageState SortStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (NULL == _sortKeyGen) {
             // This is heavy and should be done as part of work().
             _sortKeyGen.reset(new SortStageKeyGenerator(_collection, _pattern, _query));
             _sortKeyComparator.reset(new WorkingSetComparator(_sortKeyGen->getSortComparator()));
-            // If limit > 1, we need to initialize _dataSet here to maintain ordered
-            // set of data items while fetching from the child stage.
-            if (_limit > 1) {
-                const WorkingSetComparator& cmp = *_sortKeyComparator;
-                _dataSet.reset(new SortableDataItemSet(cmp));
-            }
             return PlanStage::NEED_TIME;
         }
 
         const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
-        if (_memUsage > maxBytes) {
+        if (_memUsage > maxBytes && !spillBuffer()) {
             mongoutils::str::stream ss;
             ss << "sort stage buffered data usage of " << _memUsage
                << " bytes exceeds internal limit of " << maxBytes << " bytes";
@@ -335,6 +397,12 @@ namespace mongo {
             return PlanStage::FAILURE;
         }
 
+        if (!_memory.set(_memUsage) && !_earlySpillFailed) {
+            // Once spilled, the spill sorter holds its own reservation.
+            _earlySpillFailed = !spillBuffer();
+            _memory.set(_memUsage);
+        }
+
         if (isEOF()) { return PlanStage::IS_EOF; }
 
         // Still reading in results to sort.
@@ -356,10 +424,11 @@ namespace mongo {
                     _wsidByDiskLoc[member->loc] = id;
                 }
 
-                // The data remains in the WorkingSet and we wrap the WSID with the sort key.
+                // The data remains in the WorkingSet and we wrap the WSID with the sort key. The
+                // key is extracted once here and reused by every comparison.
                 SortableDataItem item;
                 Status sortKeyStatus = _sortKeyGen->getSortKey(*member, &item.sortKey);
-                if (!_sortKeyGen->getSortKey(*member, &item.sortKey).isOK()) {
+                if (!sortKeyStatus.isOK()) {
                     *out = WorkingSetCommon::allocateStatusMember(_ws, sortKeyStatus);
                     return PlanStage::FAILURE;
                 }
@@ -369,7 +438,19 @@ namespace mongo {
                     item.loc = member->loc;
                 }
 
-                addToBuffer(item);
+                if (_spillSorter) {
+                    if (hasComputedData(*member)) {
+                        mongoutils::str::stream ss;
+                        ss << "sort stage can't spill a result carrying computed data";
+                        Status status(ErrorCodes::Overflow, ss);
+                        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+                        return PlanStage::FAILURE;
+                    }
+                    addToSpill(item);
+                }
+                else {
+                    addToBuffer(item);
+                }
 
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
@@ -377,7 +458,13 @@ namespace mongo {
             else if (PlanStage::IS_EOF == code) {
                 // TODO: We don't need the lock for this.  We could ask for a yield and do this work
                 // unlocked.  Also, this is performing a lot of work for one call to work(...)
-                sortBuffer();
+                if (_spillSorter) {
+                    _spillIterator.reset(_spillSorter->done());
+                    _spillSorter.reset();
+                }
+                else {
+                    sortBuffer();
+                }
                 _resultIterator = _data.begin();
                 _sorted = true;
                 ++_commonStats.needTime;
@@ -408,6 +495,18 @@ namespace mongo {
         }
 
         // Returning results.
+        if (_spillIterator) {
+            // Spilled results are owned copies that no longer track their RecordId.
+            SpillSorter::Data next = _spillIterator->next();
+            *out = _ws->allocate();
+            WorkingSetMember* member = _ws->get(*out);
+            member->obj = next.second.obj.getOwned();
+            member->state = WorkingSetMember::OWNED_OBJ;
+
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
         verify(_resultIterator != _data.end());
         verify(_sorted);
         *out = _resultIterator->wsid;
@@ -504,10 +603,11 @@ namespace mongo {
      *                     Updates memory usage if item was replaced.
      *     sortBuffer() - Does nothing.
      * limit > 1:
-     *     addToBuffer() - Does not update vector. Adds item to set.
-     *                     If size of set exceeds limit, remove item from set
-     *                     with lowest key. Updates memory usage accordingly.
-     *     sortBuffer() - Copies items from set to vectors.
+     *     addToBuffer() - Keeps the vector a max-heap of at most limit items.
+     *                     Once it is full, a new item with a lower key than
+     *                     the top of the heap replaces it, in O(log limit).
+     *                     Updates memory usage accordingly.
+     *     sortBuffer() - Turns the heap into a sorted vector.
      */
     void SortStage::addToBuffer(const SortableDataItem& item) {
         // Holds ID of working set member to be freed at end of this function.
@@ -533,31 +633,27 @@ namespace mongo {
             }
         }
         else {
-            // Update data item set instead of vector
+            const WorkingSetComparator& cmp = *_sortKeyComparator;
+
             // Limit not reached - insert and return
-            vector<SortableDataItem>::size_type limit(_limit);
-            if (_dataSet->size() < limit) {
-                _dataSet->insert(item);
+            if (_data.size() < _limit) {
+                _data.push_back(item);
+                std::push_heap(_data.begin(), _data.end(), cmp);
                 _memUsage += _ws->get(item.wsid)->getMemUsage();
                 return;
             }
-            // Limit will be exceeded - compare with item with lowest key
-            // If new item does not have a lower key value than last item,
-            // do nothing.
+
+            // Limit will be exceeded - compare with the item with the highest key, at the top
+            // of the heap. If new item does not have a lower key value, do nothing.
             wsidToFree = item.wsid;
-            SortableDataItemSet::const_iterator lastItemIt = --(_dataSet->end());
-            const SortableDataItem& lastItem = *lastItemIt;
-            const WorkingSetComparator& cmp = *_sortKeyComparator;
-            if (cmp(item, lastItem)) {
-                _memUsage -= _ws->get(lastItem.wsid)->getMemUsage();
+            if (cmp(item, _data.front())) {
+                _memUsage -= _ws->get(_data.front().wsid)->getMemUsage();
                 _memUsage += _ws->get(item.wsid)->getMemUsage();
-                wsidToFree = lastItem.wsid;
-                // According to std::set iterator validity rules,
-                // it does not matter which of erase()/insert() happens first.
-                // Here, we choose to erase first to release potential resources
-                // used by the last item and to keep the scope of the iterator to a minimum.
-                _dataSet->erase(lastItemIt);
-                _dataSet->insert(item);
+                wsidToFree = _data.front().wsid;
+
+                std::pop_heap(_data.begin(), _data.end(), cmp);
+                _data.back() = item;
+                std::push_heap(_data.begin(), _data.end(), cmp);
             }
         }
 
@@ -573,8 +669,8 @@ namespace mongo {
     }
 
     void SortStage::sortBuffer() {
+        const WorkingSetComparator& cmp = *_sortKeyComparator;
         if (_limit == 0) {
-            const WorkingSetComparator& cmp = *_sortKeyComparator;
             std::sort(_data.begin(), _data.end(), cmp);
         }
         else if (_limit == 1) {
@@ -582,13 +678,55 @@ namespace mongo {
             return;
         }
         else {
-            // Set already contains items in sorted order, so we simply copy the items
-            // from the set to the vector.
-            // Release the memory for the set after the copy.
-            vector<SortableDataItem> newData(_dataSet->begin(), _dataSet->end());
-            _data.swap(newData);
-            _dataSet.reset();
+            std::sort_heap(_data.begin(), _data.end(), cmp);
         }
     }
 
+    bool SortStage::spillBuffer() {
+        if (!internalQueryExecAllowBlockingSortSpill || _limit != 0) {
+            return false;
+        }
+
+        for (size_t i = 0; i < _data.size(); ++i) {
+            if (hasComputedData(*_ws->get(_data[i].wsid))) {
+                return false;
+            }
+        }
+
+        if (!_spillSorter) {
+            SortOptions opts;
+            opts.maxMemoryUsageBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
+            opts.extSortAllowed = true;
+            opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+            _spillSorter.reset(SpillSorter::make(opts,
+                                                 SpillComparator(_sortKeyComparator->pattern)));
+        }
+
+        for (size_t i = 0; i < _data.size(); ++i) {
+            addToSpill(_data[i]);
+        }
+        _data.clear();
+        _memUsage = 0;
+        return true;
+    }
+
+    void SortStage::addToSpill(const SortableDataItem& item) {
+        WorkingSetMember* member = _ws->get(item.wsid);
+
+        // The sorter keeps what it is given, so both must be owned.
+        SortStageSpilledDoc doc;
+        doc.loc = item.loc;
+        doc.obj = member->obj.getOwned();
+        _spillSorter->add(item.sortKey.getOwned(), doc);
+        ++_specificStats.spilledDocs;
+
+        if (member->hasLoc()) {
+            _wsidByDiskLoc.erase(member->loc);
+        }
+        _ws->free(item.wsid);
+    }
+
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+MONGO_CREATE_SORTER(mongo::BSONObj, mongo::SortStageSpilledDoc, mongo::SpillComparator);
@@ -30,13 +30,14 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <vector>
-#include <set>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/memory_broker.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
 
 
@@ -134,6 +135,23 @@ namespace mongo {
         boost::scoped_ptr<IndexBoundsChecker> _boundsChecker;
     };
 
+    /**
+     * A result that a SortStage handed to the external sorter: the document, and the RecordId
+     * that breaks ties between equal sort keys.
+     */
+    struct SortStageSpilledDoc {
+        struct SorterDeserializeSettings {};
+
+        void serializeForSorter(BufBuilder& buf) const;
+        static SortStageSpilledDoc deserializeForSorter(BufReader& buf,
+                                                        const SorterDeserializeSettings&);
+        int memUsageForSorter() const;
+        SortStageSpilledDoc getOwned() const;
+
+        RecordId loc;
+        BSONObj obj;
+    };
+
     /**
      * Sorts the input received from the child according to the sort pattern provided.
      *
@@ -214,7 +232,7 @@ namespace mongo {
             RecordId loc;
         };
 
-        // Comparison object for data buffers (vector and set).
+        // Comparison object for the data buffer.
         // Items are compared on (sortKey, loc). This is also how the items are
         // ordered in the indices.
         // Keys are compared using BSONObj::woCompare() with RecordId as a tie-breaker.
@@ -227,19 +245,29 @@ namespace mongo {
         };
 
         /**
-         * Inserts one item into data buffer (vector or set).
-         * If limit is exceeded, remove item with lowest key.
+         * Inserts one item into data buffer.
+         * If limit is exceeded, remove item with highest key.
          */
         void addToBuffer(const SortableDataItem& item);
 
         /**
          * Sorts data buffer.
          * Assumes no more items will be added to buffer.
-         * If data is stored in set, copy set
-         * contents to vector and clear set.
          */
         void sortBuffer();
 
+        /**
+         * Moves the buffered items to the external sorter, which every later item then goes
+         * straight to. Returns false, leaving the buffer alone, if spilling is disabled, there is
+         * a limit, or an item carries computed data that the sorter can't keep.
+         */
+        bool spillBuffer();
+
+        /**
+         * Copies the document of 'item' into the external sorter and frees its working set member.
+         */
+        void addToSpill(const SortableDataItem& item);
+
         // Comparator for data buffer
         // Initialization follows sort key generator
         boost::scoped_ptr<WorkingSetComparator> _sortKeyComparator;
@@ -248,12 +276,9 @@ namespace mongo {
         // _data will contain sorted data when all data is gathered
         // and sorted.
         // When _limit is greater than 1 and not all data has been gathered from child stage,
-        // _dataSet is used instead to maintain an ordered set of the incomplete data set.
-        // When the data set is complete, we copy the items from _dataSet to _data which will
-        // be used to provide the results of this stage through _resultIterator.
+        // _data is a max-heap of at most _limit items, so the item to evict when a lower one
+        // arrives is always at the front.
         std::vector<SortableDataItem> _data;
-        typedef std::set<SortableDataItem, WorkingSetComparator> SortableDataItemSet;
-        boost::scoped_ptr<SortableDataItemSet> _dataSet;
 
         // Iterates through _data post-sort returning it.
         std::vector<SortableDataItem>::iterator _resultIterator;
@@ -262,6 +287,13 @@ namespace mongo {
         typedef unordered_map<RecordId, WorkingSetID, RecordId::Hasher> DataMap;
         DataMap _wsidByDiskLoc;
 
+        // Once an unlimited sort outgrows its memory limit, the data goes through the external
+        // sorter instead of _data, and the results are read back from _spillIterator. Spilled
+        // documents are owned copies, so invalidations no longer apply to them.
+        typedef Sorter<BSONObj, SortStageSpilledDoc> SpillSorter;
+        boost::scoped_ptr<SpillSorter> _spillSorter;
+        boost::scoped_ptr<SpillSorter::Iterator> _spillIterator;
+
         //
         // Stats
         //
@@ -271,6 +303,10 @@ namespace mongo {
 
         // The usage in bytes of all buffered data that we're sorting.
         size_t _memUsage;
+
+        // Covers _memUsage. Under server-wide memory pressure we spill early if we can.
+        MemoryReservation _memory;
+        bool _earlySpillFailed;
     };
 
 }  // namespace mongo
@@ -34,6 +34,9 @@
 
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 
 using namespace mongo;
@@ -203,6 +206,12 @@ namespace {
                  "{output: [{a: 3}, {a: 2}]}");
     }
 
+    TEST(SortStageTest, SortWithLimitReplacesLargestRetainedItem) {
+        testWork("{a: 1}", "{}", 3,
+                 "{input: [{a: 5}, {a: 4}, {a: 6}, {a: 1}, {a: 7}, {a: 3}, {a: 2}]}",
+                 "{output: [{a: 1}, {a: 2}, {a: 3}]}");
+    }
+
     //
     // Sorting with limit > size of data set
     // Implementation should retain top N items
@@ -238,4 +247,28 @@ namespace {
                  "{output: [{a: 3}]}");
     }
 
+    //
+    // Sorting past the memory limit
+    // With spilling enabled, implementation should sort the remainder on disk
+    // instead of failing.
+    //
+
+    TEST(SortStageTest, SortSpillsPastMemoryLimit) {
+        unittest::TempDir tempDir("sortStageTests");
+        const std::string oldDbpath = storageGlobalParams.dbpath;
+        const int oldMaxBytes = internalQueryExecMaxBlockingSortBytes;
+        const bool oldAllowSpill = internalQueryExecAllowBlockingSortSpill;
+        storageGlobalParams.dbpath = tempDir.path();
+        internalQueryExecMaxBlockingSortBytes = 30;
+        internalQueryExecAllowBlockingSortSpill = true;
+
+        testWork("{a: -1}", "{}", 0,
+                 "{input: [{a: 2}, {a: 5}, {a: 1}, {a: 3}, {a: 6}, {a: 4}]}",
+                 "{output: [{a: 6}, {a: 5}, {a: 4}, {a: 3}, {a: 2}, {a: 1}]}");
+
+        storageGlobalParams.dbpath = oldDbpath;
+        internalQueryExecMaxBlockingSortBytes = oldMaxBytes;
+        internalQueryExecAllowBlockingSortSpill = oldAllowSpill;
+    }
+
 }  // namespace
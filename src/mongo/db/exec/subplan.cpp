@@ -106,7 +106,7 @@ namespace mongo {
     Status SubplanStage::planSubqueries() {
         // Adds the amount of time taken by planSubqueries() to executionTimeMillis. There's lots of
         // work that happens here, so this is needed for the time accounting to make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         MatchExpression* orExpr = _query->root();
 
@@ -118,6 +118,14 @@ namespace mongo {
 
         const WhereCallbackReal whereCallback(_txn, _collection->ns().db());
 
+        // Branches with the same shape get the same index assignment, so only the first branch
+        // of each shape is planned. The rest reuse its winning plan's tags.
+        std::map<PlanCacheKey, size_t> firstBranchForShape;
+
+        // The cache is consulted for all of the planned branches under a single lock.
+        std::vector<const CanonicalQuery*> cacheLookups;
+        std::vector<size_t> cacheLookupBranches;
+
         for (size_t i = 0; i < orExpr->numChildren(); ++i) {
             // We need a place to shove the results from planning this branch.
             _branchResults.push_back(new BranchPlanningResult());
@@ -142,43 +150,67 @@ namespace mongo {
                 branchResult->canonicalQuery.reset(orChildCQ);
             }
 
-            // Plan the i-th child. We might be able to find a plan for the i-th child in the plan
-            // cache. If there's no cached plan, then we generate and rank plans using the MPS.
-            CachedSolution* rawCS;
-            if (PlanCache::shouldCacheQuery(*branchResult->canonicalQuery.get()) &&
-                _collection->infoCache()->getPlanCache()->get(*branchResult->canonicalQuery.get(),
-                                                              &rawCS).isOK()) {
+            const CanonicalQuery& branchQuery = *branchResult->canonicalQuery.get();
+            std::map<PlanCacheKey, size_t>::const_iterator sameShape =
+                firstBranchForShape.find(branchQuery.getPlanCacheKey());
+            if (sameShape != firstBranchForShape.end()) {
+                QLOG() << "Subplanner: child " << i << " has the same shape as child "
+                       << sameShape->second;
+                branchResult->sameShapeAs = sameShape->second;
+                continue;
+            }
+            firstBranchForShape[branchQuery.getPlanCacheKey()] = i;
+
+            if (PlanCache::shouldCacheQuery(branchQuery)) {
+                cacheLookups.push_back(&branchQuery);
+                cacheLookupBranches.push_back(i);
+            }
+        }
+
+        // Plan each branch. We might be able to find a plan for a branch in the plan cache. If
+        // there's no cached plan, then we generate and rank plans using the MPS.
+        std::vector<CachedSolution*> cachedSolutions;
+        _collection->infoCache()->getPlanCache()->getMany(cacheLookups, &cachedSolutions);
+        for (size_t i = 0; i < cachedSolutions.size(); ++i) {
+            if (NULL != cachedSolutions[i]) {
                 // We have a CachedSolution. Store it for later.
-                QLOG() << "Subplanner: cached plan found for child " << i << " of "
-                       << orExpr->numChildren();
+                QLOG() << "Subplanner: cached plan found for child " << cacheLookupBranches[i]
+                       << " of " << orExpr->numChildren();
 
-                branchResult->cachedSolution.reset(rawCS);
+                _branchResults[cacheLookupBranches[i]]->cachedSolution.reset(cachedSolutions[i]);
             }
-            else {
-                // No CachedSolution found. We'll have to plan from scratch.
-                QLOG() << "Subplanner: planning child " << i << " of " << orExpr->numChildren();
+        }
 
-                // We don't set NO_TABLE_SCAN because peeking at the cache data will keep us from
-                // considering any plan that's a collscan.
-                Status status = QueryPlanner::plan(*branchResult->canonicalQuery.get(),
-                                                   _plannerParams,
-                                                   &branchResult->solutions.mutableVector());
+        for (size_t i = 0; i < _branchResults.size(); ++i) {
+            BranchPlanningResult* branchResult = _branchResults[i];
+            if (BranchPlanningResult::kNoBranch != branchResult->sameShapeAs ||
+                NULL != branchResult->cachedSolution.get()) {
+                continue;
+            }
 
-                if (!status.isOK()) {
-                    mongoutils::str::stream ss;
-                    ss << "Can't plan for subchild "
-                       << branchResult->canonicalQuery->toString()
-                       << " " << status.reason();
-                    return Status(ErrorCodes::BadValue, ss);
-                }
-                QLOG() << "Subplanner: got " << branchResult->solutions.size() << " solutions";
+            // No CachedSolution found. We'll have to plan from scratch.
+            QLOG() << "Subplanner: planning child " << i << " of " << orExpr->numChildren();
 
-                if (0 == branchResult->solutions.size()) {
-                    // If one child doesn't have an indexed solution, bail out.
-                    mongoutils::str::stream ss;
-                    ss << "No solutions for subchild " << branchResult->canonicalQuery->toString();
-                    return Status(ErrorCodes::BadValue, ss);
-                }
+            // We don't set NO_TABLE_SCAN because peeking at the cache data will keep us from
+            // considering any plan that's a collscan.
+            Status status = QueryPlanner::plan(*branchResult->canonicalQuery.get(),
+                                               _plannerParams,
+                                               &branchResult->solutions.mutableVector());
+
+            if (!status.isOK()) {
+                mongoutils::str::stream ss;
+                ss << "Can't plan for subchild "
+                   << branchResult->canonicalQuery->toString()
+                   << " " << status.reason();
+                return Status(ErrorCodes::BadValue, ss);
+            }
+            QLOG() << "Subplanner: got " << branchResult->solutions.size() << " solutions";
+
+            if (0 == branchResult->solutions.size()) {
+                // If one child doesn't have an indexed solution, bail out.
+                mongoutils::str::stream ss;
+                ss << "No solutions for subchild " << branchResult->canonicalQuery->toString();
+                return Status(ErrorCodes::BadValue, ss);
             }
         }
 
@@ -244,7 +276,23 @@ namespace mongo {
             MatchExpression* orChild = orExpr->getChild(i);
             BranchPlanningResult* branchResult = _branchResults[i];
 
-            if (branchResult->cachedSolution.get()) {
+            if (BranchPlanningResult::kNoBranch != branchResult->sameShapeAs) {
+                // An earlier branch of the same shape was planned, and its index assignment is
+                // already in 'cacheData'.
+                PlanCacheIndexTree* sameShapeTree = cacheData->children[branchResult->sameShapeAs];
+                Status tagStatus = QueryPlanner::tagAccordingToCache(orChild,
+                                                                     sameShapeTree,
+                                                                     _indexMap);
+                if (!tagStatus.isOK()) {
+                    mongoutils::str::stream ss;
+                    ss << "Failed to extract indices from subchild "
+                       << orChild->toString();
+                    return Status(ErrorCodes::BadValue, ss);
+                }
+
+                cacheData->children.push_back(sameShapeTree->clone());
+            }
+            else if (branchResult->cachedSolution.get()) {
                 // We can get the index tags we need out of the cache.
                 Status tagStatus = tagOrChildAccordingToCache(
                     cacheData.get(),
@@ -444,7 +492,7 @@ namespace mongo {
     Status SubplanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
         // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
         // work that happens here, so this is needed for the time accounting to make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         // Plan each branch of the $or.
         Status subplanningStatus = planSubqueries();
@@ -472,7 +520,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -542,6 +590,10 @@ namespace mongo {
         return NULL != _branchResults[i]->cachedSolution.get();
     }
 
+    bool SubplanStage::branchPlannedWithSameShape(size_t i) const {
+        return BranchPlanningResult::kNoBranch != _branchResults[i]->sameShapeAs;
+    }
+
     const CommonStats* SubplanStage::getCommonStats() {
         return &_commonStats;
     }
@@ -118,6 +118,12 @@ namespace mongo {
          */
         bool branchPlannedFromCache(size_t i) const;
 
+        /**
+         * Returns true if the i-th branch reused the index assignment chosen for an earlier
+         * branch with the same shape, otherwise returns false.
+         */
+        bool branchPlannedWithSameShape(size_t i) const;
+
     private:
         /**
          * A class used internally in order to keep track of the results of planning
@@ -126,7 +132,9 @@ namespace mongo {
         struct BranchPlanningResult {
             MONGO_DISALLOW_COPYING(BranchPlanningResult);
         public:
-            BranchPlanningResult() { }
+            static const size_t kNoBranch = static_cast<size_t>(-1);
+
+            BranchPlanningResult() : sameShapeAs(kNoBranch) { }
 
             // A parsed version of one branch of the $or.
             boost::scoped_ptr<CanonicalQuery> canonicalQuery;
@@ -139,11 +147,17 @@ namespace mongo {
 
             // Query solutions resulting from planning the $or branch.
             OwnedPointerVector<QuerySolution> solutions;
+
+            // The index of an earlier branch with the same plan cache key, or kNoBranch. Such
+            // a branch is not planned itself; it takes the index tags chosen for that branch.
+            size_t sameShapeAs;
         };
 
         /**
          * Plan each branch of the $or independently, and store the resulting
-         * lists of query solutions in '_solutions'.
+         * lists of query solutions in '_solutions'. Branches repeating the shape of an
+         * earlier branch are not planned, and the plan cache is consulted for all of the
+         * remaining branches in one batch.
          *
          * Called from SubplanStage::make so that construction of the subplan stage
          * fails immediately, rather than returning a plan executor and subsequently
@@ -28,6 +28,9 @@
 
 #include "mongo/db/exec/text.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -43,6 +46,8 @@ namespace mongo {
     using std::string;
     using std::vector;
 
+    using fts::TermFrequencyMap;
+
     // static
     const char* TextStage::kStageType = "TEXT";
 
@@ -57,7 +62,8 @@ namespace mongo {
           _filter(filter),
           _commonStats(kStageType),
           _internalState(INIT_SCANS),
-          _currentIndexScanner(0) {
+          _currentIndexScanner(0),
+          _readingTopK(false) {
         _scoreIterator = _scores.end();
         _specificStats.indexPrefix = _params.indexPrefix;
         _specificStats.indexName = _params.index->indexName();
@@ -73,7 +79,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
         invariant(_internalState != DONE);
@@ -149,6 +155,14 @@ namespace mongo {
                 _scoreIterator++;
             }
             _scores.erase(scoreIt);
+
+            for (size_t i = 0; i < _topK.size(); ++i) {
+                if (_topK[i].second == dl) {
+                    _topK.erase(_topK.begin() + i);
+                    std::make_heap(_topK.begin(), _topK.end(), std::greater<ScoredRecord>());
+                    break;
+                }
+            }
         }
     }
 
@@ -210,6 +224,13 @@ namespace mongo {
             return PlanStage::IS_EOF;
         }
 
+        // Phrases and negated terms are only checked once we are returning results, so they could
+        // reject documents that we counted among the best.
+        if (_params.limit > 0 && !_params.query.hasNonTermPieces()) {
+            _readingTopK = true;
+            _termScoreBounds.assign(_scanners.size(), MAX_WEIGHT);
+        }
+
         // Transition to the next state.
         _internalState = READING_TERMS;
         return PlanStage::NEED_TIME;
@@ -229,24 +250,20 @@ namespace mongo {
             invariant(wsm->hasLoc());
             IndexKeyDatum& keyDatum = wsm->keyData.back();
             addTerm(keyDatum.keyData, id);
-            return PlanStage::NEED_TIME;
+
+            if (!_readingTopK) {
+                return PlanStage::NEED_TIME;
+            }
         }
         else if (PlanStage::IS_EOF == childState) {
             // Done with this scan.
-            ++_currentIndexScanner;
-
-            if (_currentIndexScanner < _scanners.size()) {
+            if (_readingTopK) {
+                _termScoreBounds[_currentIndexScanner] = 0;
+            }
+            else if (++_currentIndexScanner < _scanners.size()) {
                 // We have another scan to read from.
                 return PlanStage::NEED_TIME;
             }
-
-            // If we're here we are done reading results.  Move to the next state.
-            _scoreIterator = _scores.begin();
-            _internalState = RETURNING_RESULTS;
-
-            // Don't need to keep these around.
-            _scanners.clear();
-            return PlanStage::NEED_TIME;
         }
         else {
             if (PlanStage::FAILURE == childState) {
@@ -264,6 +281,37 @@ namespace mongo {
             }
             return childState;
         }
+
+        if (_readingTopK && !haveTopK()) {
+            // Move on to the next term that still has entries to read.
+            for (size_t i = 1; i <= _scanners.size(); ++i) {
+                size_t next = (_currentIndexScanner + i) % _scanners.size();
+                if (!_scanners.vector()[next]->isEOF()) {
+                    _currentIndexScanner = next;
+                    return PlanStage::NEED_TIME;
+                }
+            }
+        }
+
+        // If we're here we are done reading results.  Move to the next state.
+        _scoreIterator = _scores.begin();
+        _internalState = RETURNING_RESULTS;
+
+        // Don't need to keep these around.
+        _scanners.clear();
+        return PlanStage::NEED_TIME;
+    }
+
+    bool TextStage::haveTopK() const {
+        if (_topK.size() < _params.limit) {
+            return false;
+        }
+
+        double unseenScoreBound = 0;
+        for (size_t i = 0; i < _termScoreBounds.size(); ++i) {
+            unseenScoreBound += _termScoreBounds[i];
+        }
+        return _topK.front().first >= unseenScoreBound;
     }
 
     PlanStage::StageState TextStage::returnResults(WorkingSetID* out) {
@@ -371,8 +419,9 @@ namespace mongo {
     void TextStage::addTerm(const BSONObj key, WorkingSetID wsid) {
         WorkingSetMember* wsm = _ws->get(wsid);
         TextRecordData* textRecordData = &_scores[wsm->loc];
+        const bool newDocument = (WorkingSet::INVALID_ID == textRecordData->wsid);
 
-        if (WorkingSet::INVALID_ID == textRecordData->wsid) {
+        if (newDocument) {
             // We haven't seen this RecordId before. Keep the working set member around
             // (it may be force-fetched on saveState()).
             textRecordData->wsid = wsid;
@@ -400,12 +449,22 @@ namespace mongo {
         BSONElement scoreElement = keyIt.next();
         double documentTermScore = scoreElement.number();
 
+        if (_readingTopK) {
+            // Entries come in descending score order, so no later entry scores higher.
+            _termScoreBounds[_currentIndexScanner] = documentTermScore;
+        }
+
         // Handle filtering.
         if (*documentAggregateScore < 0) {
             // We have already rejected this document.
             return;
         }
 
+        if (_readingTopK && !newDocument) {
+            // We scored this document in full when we first saw it.
+            return;
+        }
+
         if (*documentAggregateScore == 0) {
             if (_filter) {
                 // We have not seen this document before and need to apply a filter.
@@ -432,8 +491,53 @@ namespace mongo {
             }
         }
 
+        if (_readingTopK) {
+            addTopKCandidate(wsm, documentAggregateScore);
+            return;
+        }
+
         // Aggregate relevance score, term keys.
         *documentAggregateScore += documentTermScore;
     }
 
+    void TextStage::addTopKCandidate(WorkingSetMember* wsm, double* documentAggregateScore) {
+        // Score the document the way its index keys were, then add up the scores of our terms
+        // just as reading every one of their entries would.
+        BSONObj doc = _params.index->getCollection()->docFor(_txn, wsm->loc);
+        TermFrequencyMap termFreqs;
+        _params.spec.scoreDocument(doc, &termFreqs);
+
+        double score = 0;
+        const vector<string>& terms = _params.query.getTerms();
+        for (size_t i = 0; i < terms.size(); ++i) {
+            TermFrequencyMap::const_iterator it = termFreqs.find(terms[i]);
+            if (it != termFreqs.end()) {
+                score += it->second;
+            }
+        }
+
+        const std::greater<ScoredRecord> minHeapCmp;
+        if (_topK.size() < _params.limit) {
+            _topK.push_back(ScoredRecord(score, wsm->loc));
+            std::push_heap(_topK.begin(), _topK.end(), minHeapCmp);
+            *documentAggregateScore = score;
+            return;
+        }
+
+        if (score <= _topK.front().first) {
+            *documentAggregateScore = -1;
+            return;
+        }
+
+        // Replace the worst of the best with this document, which we now won't return.
+        std::pop_heap(_topK.begin(), _topK.end(), minHeapCmp);
+        ScoreMap::iterator evicted = _scores.find(_topK.back().second);
+        if (evicted != _scores.end()) {
+            evicted->second.score = -1;
+        }
+        _topK.back() = ScoredRecord(score, wsm->loc);
+        std::push_heap(_topK.begin(), _topK.end(), minHeapCmp);
+        *documentAggregateScore = score;
+    }
+
 }  // namespace mongo
@@ -55,7 +55,7 @@ namespace mongo {
     class OperationContext;
 
     struct TextStageParams {
-        TextStageParams(const FTSSpec& s) : spec(s) {}
+        TextStageParams(const FTSSpec& s) : spec(s), limit(0) {}
 
         // Text index descriptor.  IndexCatalog owns this.
         IndexDescriptor* index;
@@ -68,6 +68,10 @@ namespace mongo {
 
         // The text query.
         FTSQuery query;
+
+        // If nonzero, our parent only wants the 'limit' results with the highest text scores, in
+        // any order.
+        size_t limit;
     };
 
     /**
@@ -76,6 +80,11 @@ namespace mongo {
      * Prerequisites: None; is a leaf node.
      * Output type: LOC_AND_OBJ_UNOWNED.
      *
+     * Each term is read from the index in descending score order. Given a limit, and a query with
+     * no phrases or negated terms, the terms are read in turn and every new document is scored in
+     * full when it is first seen. Reading stops once the lowest of the best 'limit' scores is at
+     * least the sum of the scores the terms last produced, which bounds any unseen document.
+     *
      * TODO: Should the TextStage ever generate NEED_FETCH requests? Right now this stage could
      * reduce concurrency by failing to request a yield during fetch.
      */
@@ -143,6 +152,19 @@ namespace mongo {
          */
         void addTerm(const BSONObj key, WorkingSetID wsid);
 
+        /**
+         * Helper called from addTerm when reading for the best _params.limit results.  Computes
+         * the full score of a document seen for the first time and keeps it if it is among the
+         * best so far.
+         */
+        void addTopKCandidate(WorkingSetMember* wsm, double* documentAggregateScore);
+
+        /**
+         * Returns true if no document that we haven't seen yet can outscore the worst of the best
+         * _params.limit documents we have.
+         */
+        bool haveTopK() const;
+
         /**
          * Possibly return a result.  FYI, this may perform a fetch directly if it is needed to
          * evaluate all filters.
@@ -178,6 +200,17 @@ namespace mongo {
         // Which _scanners are we currently reading from?
         size_t _currentIndexScanner;
 
+        // True if we read _scanners in turn and stop once we have the best _params.limit results.
+        bool _readingTopK;
+
+        // Used when _readingTopK.  The score each scanner last produced, or 0 once it is EOF.
+        // Each is an upper bound on the term's score in any document the scanner hasn't reached.
+        std::vector<double> _termScoreBounds;
+
+        // Used when _readingTopK.  A min-heap, by score, of the best documents seen so far.
+        typedef std::pair<double, RecordId> ScoredRecord;
+        std::vector<ScoredRecord> _topK;
+
         // Map each buffered record id to this data.
         struct TextRecordData {
             TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0) { }
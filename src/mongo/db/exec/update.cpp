@@ -451,7 +451,7 @@ namespace mongo {
         _specificStats.isDocReplacement = params.driver->isDocReplacement();
     }
 
-    void UpdateStage::transformAndUpdate(BSONObj& oldObj, RecordId& loc) {
+    BSONObj UpdateStage::transformAndUpdate(BSONObj& oldObj, RecordId& loc) {
         const UpdateRequest* request = _params.request;
         UpdateDriver* driver = _params.driver;
         CanonicalQuery* cq = _params.canonicalQuery;
@@ -520,6 +520,7 @@ namespace mongo {
             docWasModified = false;
         }
 
+        BSONObj newObj = oldObj;
         if (docWasModified) {
 
             // Verify that no immutable fields were changed and data is valid for storage.
@@ -538,7 +539,6 @@ namespace mongo {
 
 
             // Prepare to write back the modified document
-            BSONObj newObj;
             WriteUnitOfWork wunit(_txn);
 
             if (inPlace) {
@@ -550,7 +550,11 @@ namespace mongo {
                     _collection->updateDocumentWithDamages(_txn, loc, oldRec, source, _damages);
                 }
 
-                newObj = oldObj;
+                // 'oldObj' only reflects the damages if it points at the record itself, so
+                // build the new document when the caller wants it back.
+                if (request->shouldReturnNewDocs()) {
+                    newObj = _doc.getObject();
+                }
                 _specificStats.fastmod = true;
 
             }
@@ -570,7 +574,8 @@ namespace mongo {
                         _txn,
                         loc, oldObj, newObj,
                         true, driver->modsAffectIndices(),
-                        _params.opDebug);
+                        _params.opDebug,
+                        driver->modifiedPaths());
                     uassertStatusOK(res.getStatus());
                     RecordId newLoc = res.getValue();
 
@@ -606,6 +611,8 @@ namespace mongo {
         if (docWasModified || request->isExplain()) {
             _specificStats.nModified++;
         }
+
+        return newObj;
     }
 
     void UpdateStage::doInsert() {
@@ -729,7 +736,7 @@ namespace mongo {
         ++_commonStats.works;
 
         // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -737,6 +744,16 @@ namespace mongo {
             // Even if we're done updating, we may have some inserting left to do.
             if (needInsert()) {
                 doInsert();
+
+                if (_params.request->shouldReturnNewDocs()) {
+                    invariant(isEOF());
+                    *out = _ws->allocate();
+                    WorkingSetMember* member = _ws->get(*out);
+                    member->obj = _specificStats.objInserted;
+                    member->state = WorkingSetMember::OWNED_OBJ;
+                    ++_commonStats.advanced;
+                    return PlanStage::ADVANCED;
+                }
             }
 
             // At this point either we're done updating and there was no insert to do,
@@ -818,13 +835,20 @@ namespace mongo {
             // Save state before making changes
             _child->saveState();
 
+            // An in-place update rewrites the record 'oldObj' may point at, so take a copy first
+            // if it is the version the caller wants back.
+            if (_params.request->shouldReturnOldDocs()) {
+                oldObj = oldObj.getOwned();
+            }
+
             // Do the update and return.
             BSONObj reFetched;
+            BSONObj newObj;
             uint64_t attempt = 1;
 
             while ( attempt++ ) {
                 try {
-                    transformAndUpdate(reFetched.isEmpty() ? oldObj : reFetched , loc);
+                    newObj = transformAndUpdate(reFetched.isEmpty() ? oldObj : reFetched , loc);
                     break;
                 }
                 catch ( const WriteConflictException& de ) {
@@ -875,6 +899,17 @@ namespace mongo {
 
             _child->restoreState(_txn);
 
+            if (_params.request->shouldReturnAnyDocs()) {
+                // Only single updates return documents, and those rethrow write conflicts above,
+                // so the update happened.
+                *out = _ws->allocate();
+                WorkingSetMember* member = _ws->get(*out);
+                member->obj = _params.request->shouldReturnOldDocs() ? oldObj : newObj.getOwned();
+                member->state = WorkingSetMember::OWNED_OBJ;
+                ++_commonStats.advanced;
+                return PlanStage::ADVANCED;
+            }
+
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
@@ -72,7 +72,8 @@ namespace mongo {
 
     /**
      * Execution stage responsible for updates to documents and upserts. NEED_TIME is returned
-     * after performing an update or an insert.
+     * after performing an update or an insert, unless the request asks for documents back, in
+     * which case ADVANCED is returned with an owned copy of the old or new document.
      *
      * Callers of work() must be holding a write lock.
      */
@@ -118,9 +119,10 @@ namespace mongo {
     private:
         /**
          * Computes the result of applying mods to the document 'oldObj' at RecordId 'loc' in
-         * memory, then commits these changes to the database.
+         * memory, then commits these changes to the database.  Returns the document as it is
+         * after the update; it is not necessarily owned.
          */
-        void transformAndUpdate(BSONObj& oldObj, RecordId& loc);
+        BSONObj transformAndUpdate(BSONObj& oldObj, RecordId& loc);
 
         /**
          * Computes the document to insert and inserts it into the collection. Used if the
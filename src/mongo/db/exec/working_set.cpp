@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/working_set.h"
 
+#include <algorithm>
+
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/storage/record_fetcher.h"
 
@@ -38,12 +40,32 @@ namespace mongo {
     WorkingSet::MemberHolder::MemberHolder() : member(NULL) { }
     WorkingSet::MemberHolder::~MemberHolder() {}
 
-    WorkingSet::WorkingSet() : _freeList(INVALID_ID) { }
+    namespace {
+
+        // The first chunk of WorkingSetMembers is this big, and later ones double in size up to
+        // kMaxMembersPerChunk.
+        const size_t kMinMembersPerChunk = 4;
+        const size_t kMaxMembersPerChunk = 1024;
+
+    }  // namespace
+
+    WorkingSet::WorkingSet() : _freeList(INVALID_ID), _lastChunkSize(0), _lastChunkUsed(0) { }
 
     WorkingSet::~WorkingSet() {
-        for (size_t i = 0; i < _data.size(); i++) {
-            delete _data[i].member;
+        for (size_t i = 0; i < _memberChunks.size(); i++) {
+            delete[] _memberChunks[i];
+        }
+    }
+
+    WorkingSetMember* WorkingSet::newMember() {
+        if (_lastChunkUsed == _lastChunkSize) {
+            _lastChunkSize = _memberChunks.empty()
+                ? kMinMembersPerChunk
+                : std::min(_lastChunkSize * 2, kMaxMembersPerChunk);
+            _memberChunks.push_back(new WorkingSetMember[_lastChunkSize]);
+            _lastChunkUsed = 0;
         }
+        return &_memberChunks.back()[_lastChunkUsed++];
     }
 
     WorkingSetID WorkingSet::allocate() {
@@ -54,7 +76,7 @@ namespace mongo {
             WorkingSetID id = _data.size();
             _data.resize(_data.size() + 1);
             _data.back().nextFreeOrSelf = id;
-            _data.back().member = new WorkingSetMember();
+            _data.back().member = newMember();
             return id;
         }
 
@@ -92,9 +114,12 @@ namespace mongo {
     }
 
     void WorkingSet::clear() {
-        for (size_t i = 0; i < _data.size(); i++) {
-            delete _data[i].member;
+        for (size_t i = 0; i < _memberChunks.size(); i++) {
+            delete[] _memberChunks[i];
         }
+        _memberChunks.clear();
+        _lastChunkSize = 0;
+        _lastChunkUsed = 0;
         _data.clear();
 
         // Since working set is now empty, the free list pointer should
@@ -161,6 +161,13 @@ namespace mongo {
         WorkingSet::iterator end();
 
     private:
+        /**
+         * Returns a WorkingSetMember which no MemberHolder has yet. Members are carved out of
+         * chunks rather than allocated one by one, and are only deleted, a chunk at a time, by
+         * clear() and the destructor.
+         */
+        WorkingSetMember* newMember();
+
         struct MemberHolder {
             MemberHolder();
             ~MemberHolder();
@@ -168,7 +175,7 @@ namespace mongo {
             // Free list link if freed. Points to self if in use.
             WorkingSetID nextFreeOrSelf;
 
-            // Owning pointer
+            // Points into one of '_memberChunks'.
             WorkingSetMember* member;
         };
 
@@ -183,6 +190,14 @@ namespace mongo {
 
         // An insert-only set of WorkingSetIDs that have been flagged for review.
         unordered_set<WorkingSetID> _flagged;
+
+        // Owned arrays holding every WorkingSetMember. Each chunk is twice the size of the one
+        // before, up to a limit, so that small queries don't pay for a large one.
+        std::vector<WorkingSetMember*> _memberChunks;
+
+        // Size of the last of '_memberChunks', and how many of its members have been handed out.
+        size_t _lastChunkSize;
+        size_t _lastChunkUsed;
     };
 
     /**
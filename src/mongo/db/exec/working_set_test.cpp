@@ -31,6 +31,7 @@
  */
 
 #include <boost/scoped_ptr.hpp>
+#include <set>
 
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/json.h"
@@ -245,4 +246,45 @@ namespace {
         ASSERT_EQ(counter, 1);
     }
 
+    //
+    // WorkingSetMember storage tests
+    //
+
+    TEST(WorkingSetStorageTest, ManyMembers) {
+        WorkingSet ws;
+
+        // Enough members to fill several chunks of them.
+        const int kNumMembers = 3000;
+        std::vector<WorkingSetID> ids;
+        std::set<WorkingSetMember*> members;
+        for (int i = 0; i < kNumMembers; i++) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* member = ws.get(id);
+            member->state = WorkingSetMember::OWNED_OBJ;
+            member->obj = BSON("a" << i);
+            ids.push_back(id);
+            members.insert(member);
+        }
+        ASSERT_EQUALS(static_cast<size_t>(kNumMembers), members.size());
+
+        // Members keep their data as more are allocated.
+        for (int i = 0; i < kNumMembers; i++) {
+            ASSERT_EQUALS(i, ws.get(ids[i])->obj["a"].numberInt());
+        }
+
+        // Freed members are reused rather than new ones being made.
+        for (int i = 0; i < kNumMembers; i++) {
+            ws.free(ids[i]);
+        }
+        for (int i = 0; i < kNumMembers; i++) {
+            WorkingSetMember* member = ws.get(ws.allocate());
+            ASSERT_EQUALS(WorkingSetMember::INVALID, member->state);
+            ASSERT_TRUE(members.count(member));
+        }
+
+        ws.clear();
+        WorkingSetID id = ws.allocate();
+        ASSERT_EQUALS(WorkingSetMember::INVALID, ws.get(id)->state);
+    }
+
 }  // namespace
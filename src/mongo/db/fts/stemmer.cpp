@@ -28,7 +28,9 @@
 *    it in the license file.
 */
 
+#include <boost/thread/tss.hpp>
 #include <cstdlib>
+#include <map>
 #include <string>
 
 #include "mongo/db/fts/stemmer.h"
@@ -40,23 +42,75 @@ namespace mongo {
 
         using std::string;
 
+        namespace {
+
+            // Words stemmed per language and thread that we remember.  Past this we start over.
+            const size_t kMaxCachedStems = 4096;
+
+            /**
+             * A thread's stemmers, by language name.  Text indexing makes a Stemmer for every
+             * string it scores, and making a libstemmer stemmer allocates.
+             */
+            class ThreadStemmers {
+            public:
+                struct Entry {
+                    Entry() : stemmer( NULL ) { }
+                    struct sb_stemmer* stemmer;
+                    Stemmer::StemCache cache;
+                };
+
+                ~ThreadStemmers() {
+                    for ( EntryMap::iterator i = _entries.begin(); i != _entries.end(); ++i ) {
+                        sb_stemmer_delete( i->second.stemmer );
+                    }
+                }
+
+                Entry* get( const string& language ) {
+                    Entry* entry = &_entries[language];
+                    if ( !entry->stemmer ) {
+                        entry->stemmer = sb_stemmer_new( language.c_str(), "UTF_8" );
+                    }
+                    return entry;
+                }
+
+            private:
+                typedef std::map<string, Entry> EntryMap;
+                EntryMap _entries;
+            };
+
+            boost::thread_specific_ptr<ThreadStemmers> threadStemmers;
+
+        }  // namespace
+
         Stemmer::Stemmer( const FTSLanguage& language ) {
             _stemmer = NULL;
-            if ( language.str() != "none" )
-                _stemmer = sb_stemmer_new(language.str().c_str(), "UTF_8");
+            _cache = NULL;
+            if ( language.str() != "none" ) {
+                if ( !threadStemmers.get() ) {
+                    threadStemmers.reset( new ThreadStemmers() );
+                }
+                ThreadStemmers::Entry* entry = threadStemmers->get( language.str() );
+                _stemmer = entry->stemmer;
+                _cache = &entry->cache;
+            }
         }
 
         Stemmer::~Stemmer() {
-            if ( _stemmer ) {
-                sb_stemmer_delete(_stemmer);
-                _stemmer = NULL;
-            }
+            // The thread's stemmer outlives us.
+            _stemmer = NULL;
+            _cache = NULL;
         }
 
         string Stemmer::stem( const StringData& word ) const {
             if ( !_stemmer )
                 return word.toString();
 
+            string key = word.toString();
+            StemCache::const_iterator cached = _cache->find( key );
+            if ( cached != _cache->end() ) {
+                return cached->second;
+            }
+
             const sb_symbol* sb_sym = sb_stemmer_stem( _stemmer,
                                                        (const sb_symbol*)word.rawData(),
                                                        word.size() );
@@ -66,7 +120,12 @@ namespace mongo {
                 abort();
             }
 
-            return string( (const char*)(sb_sym), sb_stemmer_length( _stemmer ) );
+            string stemmed( (const char*)(sb_sym), sb_stemmer_length( _stemmer ) );
+            if ( _cache->size() >= kMaxCachedStems ) {
+                _cache->clear();
+            }
+            _cache->insert( std::make_pair( key, stemmed ) );
+            return stemmed;
         }
 
     }
@@ -35,6 +35,7 @@
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/fts/fts_language.h"
+#include "mongo/platform/unordered_map.h"
 #include "third_party/libstemmer_c/include/libstemmer.h"
 
 namespace mongo {
@@ -45,6 +46,10 @@ namespace mongo {
          * maintains case
          * but works
          * running/Running -> run/Run
+         *
+         * Uses the calling thread's libstemmer stemmer for the language, which lives as long as
+         * the thread, along with a bounded cache of the words it stemmed last.  So a Stemmer is
+         * cheap to make, and must not be used from another thread.
          */
         class Stemmer {
         public:
@@ -52,8 +57,12 @@ namespace mongo {
             ~Stemmer();
 
             std::string stem( const StringData& word ) const;
+
+            typedef unordered_map<std::string, std::string> StemCache;
+
         private:
             struct sb_stemmer* _stemmer;
+            StemCache* _cache;
         };
     }
 }
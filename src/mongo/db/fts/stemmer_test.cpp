@@ -49,5 +49,17 @@ namespace mongo {
             ASSERT_EQUALS( "Unite", s.stem( "United" ) );
         }
 
+        TEST( Stemmer, RepeatedWordsAndLanguagesOnOneThread ) {
+            Stemmer english( languageEnglishV2 );
+            Stemmer french( languageFrenchV2 );
+            for ( int i = 0; i < 3; i++ ) {
+                ASSERT_EQUALS( "run", english.stem( "running" ) );
+                ASSERT_EQUALS( "running", french.stem( "running" ) );
+            }
+
+            Stemmer again( languageEnglishV2 );
+            ASSERT_EQUALS( "run", again.stem( "running" ) );
+        }
+
     }
 }
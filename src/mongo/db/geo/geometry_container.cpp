@@ -1210,6 +1210,15 @@ namespace mongo {
         }
     }
 
+    bool GeometryContainer::isPoint() const {
+        return NULL != _point;
+    }
+
+    const PointWithCRS& GeometryContainer::getPoint() const {
+        invariant(NULL != _point);
+        return *_point;
+    }
+
     const CapWithCRS* GeometryContainer::getCapGeometryHack() const {
         return _cap.get();
     }
@@ -104,6 +104,11 @@ namespace mongo {
          */
         bool intersects(const GeometryContainer& otherContainer) const;
 
+        // Whether the geometry is a single point, and that point.  The covering of a point in
+        // the S2 space at any level is the one cell containing it.
+        bool isPoint() const;
+        const PointWithCRS& getPoint() const;
+
         // Region which can be used to generate a covering of the query object in the S2 space.
         bool hasS2Region() const;
         const S2Region& getS2Region() const;
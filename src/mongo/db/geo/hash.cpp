@@ -565,6 +565,10 @@ namespace mongo {
     static BSONField<int> bitsField("bits", 26);
     static BSONField<double> maxField("max", 180.0);
     static BSONField<double> minField("min", -180.0);
+    static BSONField<int> indexVersionField("2dIndexVersion", 1);
+
+    // Keys of 2dIndexVersion 2 are in Hilbert order, see GeoHashConverter::toKeyOrder.
+    static const int kHilbertOrderIndexVersion = 2;
 
     //      a   x     b
     //      |   |     |
@@ -601,6 +605,20 @@ namespace mongo {
             return Status(ErrorCodes::InvalidOptions, errMsg);
         }
 
+        int indexVersion;
+        if (FieldParser::FIELD_INVALID
+            == FieldParser::extractNumber(paramDoc, indexVersionField, &indexVersion, &errMsg)) {
+            return Status(ErrorCodes::InvalidOptions, errMsg);
+        }
+
+        if (indexVersion != 1 && indexVersion != kHilbertOrderIndexVersion) {
+            return Status(ErrorCodes::InvalidOptions,
+                          str::stream() << "unsupported 2d index version "
+                                        << indexVersionField.name() << ": " << indexVersion
+                                        << ", only support versions: [1,2]");
+        }
+        params->hilbertOrder = (indexVersion == kHilbertOrderIndexVersion);
+
         if (params->bits < 1 || params->bits > 32) {
             return Status(ErrorCodes::InvalidOptions,
                           str::stream() << "bits for hash must be > 0 and <= 32, "
@@ -655,6 +673,77 @@ namespace mongo {
         return sqrt((dx * dx) + (dy * dy));
     }
 
+    /**
+     * Walks the quadrant digits of 'hash' from the most significant level down, keeping the
+     * rotation of the current Hilbert sub-curve as a pair of flags.  Each level's digit is the
+     * (x, y) bit pair of that level; it is the Z order quadrant on one side and the position
+     * along the Hilbert curve on the other.
+     */
+    static long long convertCurveOrder(long long hash, unsigned bits, bool toHilbert) {
+        // The rotations of a Hilbert sub-curve are a mirror about a diagonal, an inversion of
+        // both axes, or both, and these commute.
+        bool swapXY = false;
+        bool invertXY = false;
+
+        long long result = 0;
+        for (unsigned level = 0; level < bits; ++level) {
+            const bool highBit = hash & mask64For(level * 2);
+            const bool lowBit = hash & mask64For(level * 2 + 1);
+
+            // (rx, ry) is the quadrant in the sub-curve's own frame
+            bool rx, ry;
+            bool outHigh, outLow;
+            if (toHilbert) {
+                rx = highBit;
+                ry = lowBit;
+                if (invertXY) {
+                    rx = !rx;
+                    ry = !ry;
+                }
+                if (swapXY) {
+                    std::swap(rx, ry);
+                }
+                // Quadrants (0,0) (0,1) (1,1) (1,0) are visited in that order
+                outHigh = rx;
+                outLow = rx != ry;
+            }
+            else {
+                rx = highBit;
+                ry = highBit != lowBit;
+                outHigh = rx;
+                outLow = ry;
+                if (swapXY) {
+                    std::swap(outHigh, outLow);
+                }
+                if (invertXY) {
+                    outHigh = !outHigh;
+                    outLow = !outLow;
+                }
+            }
+
+            if (outHigh) result |= mask64For(level * 2);
+            if (outLow) result |= mask64For(level * 2 + 1);
+
+            // The first and last quadrants hold the sub-curve mirrored about a diagonal
+            if (!ry) {
+                if (rx) invertXY = !invertXY;
+                swapXY = !swapXY;
+            }
+        }
+
+        return result;
+    }
+
+    GeoHash GeoHashConverter::toKeyOrder(const GeoHash& cell) const {
+        if (!_params.hilbertOrder) return cell;
+        return GeoHash(convertCurveOrder(cell.getHash(), cell.getBits(), true), cell.getBits());
+    }
+
+    GeoHash GeoHashConverter::fromKeyOrder(const GeoHash& key) const {
+        if (!_params.hilbertOrder) return key;
+        return GeoHash(convertCurveOrder(key.getHash(), key.getBits(), false), key.getBits());
+    }
+
     /**
      * Hashing functions.  Convert the following types (which have a double precision point)
      * to a GeoHash:
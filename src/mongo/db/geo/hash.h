@@ -166,6 +166,8 @@ namespace mongo {
         static double const kMachinePrecision; // = 1.1e-16
 
         struct Parameters {
+            Parameters() : bits(0), min(0), max(0), scaling(0), hilbertOrder(false) { }
+
             // How many bits to use for the hash?
             int bits;
             // X/Y values must be [min, max]
@@ -173,6 +175,8 @@ namespace mongo {
             double max;
             // Values are scaled by this when converted to/from hash scale.
             double scaling;
+            // Are index keys stored in Hilbert curve order ({2dIndexVersion: 2})?
+            bool hilbertOrder;
         };
 
         GeoHashConverter(const Parameters &params);
@@ -198,6 +202,18 @@ namespace mongo {
 
         double distanceBetweenHashes(const GeoHash& a, const GeoHash& b) const;
 
+        /**
+         * GeoHash cells are always in Z order.  Version 2 2d indexes store their keys on a
+         * Hilbert curve instead, which keeps neighboring cells in neighboring key ranges across
+         * quadrant boundaries.  Both curves nest, so a cell of either order covers one contiguous
+         * range of keys.
+         *
+         * toKeyOrder converts a cell to the order used by index keys, fromKeyOrder converts a
+         * cell read from an index key back to Z order.  Both are the identity for version 1.
+         */
+        GeoHash toKeyOrder(const GeoHash& cell) const;
+        GeoHash fromKeyOrder(const GeoHash& key) const;
+
         /**
          * Hashing functions.  Convert the following types to a GeoHash:
          * BSONElement
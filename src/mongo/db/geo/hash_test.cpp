@@ -105,6 +105,63 @@ namespace {
         ASSERT_APPROX_EQUAL(25.0, converter.sizeEdge(2), kError);
     }
 
+    GeoHashConverter::Parameters makeHilbertParams() {
+        GeoHashConverter::Parameters params;
+        ASSERT_OK(GeoHashConverter::parseParameters(BSON("2dIndexVersion" << 2), &params));
+        ASSERT(params.hilbertOrder);
+        return params;
+    }
+
+    TEST(GeoHashConvertor, ParseIndexVersion) {
+        GeoHashConverter::Parameters params;
+        ASSERT_OK(GeoHashConverter::parseParameters(mongo::BSONObj(), &params));
+        ASSERT_FALSE(params.hilbertOrder);
+        ASSERT_NOT_OK(GeoHashConverter::parseParameters(BSON("2dIndexVersion" << 3), &params));
+    }
+
+    TEST(GeoHashConvertor, KeyOrderRoundTrip) {
+        GeoHashConverter hilbert(makeHilbertParams());
+        mongo::PseudoRandom random(31337);
+        for (int i = 0; i < 1000; i++) {
+            GeoHash cell(static_cast<long long>(random.nextInt64()),
+                         1 + (random.nextInt32() & 31));
+            ASSERT_EQUALS(cell, hilbert.fromKeyOrder(hilbert.toKeyOrder(cell)));
+            ASSERT_EQUALS(cell.getBits(), hilbert.toKeyOrder(cell).getBits());
+        }
+    }
+
+    // A cell's children cover the keys of the cell, so covering intervals stay contiguous
+    TEST(GeoHashConvertor, KeyOrderNests) {
+        GeoHashConverter hilbert(makeHilbertParams());
+        mongo::PseudoRandom random(31337);
+        for (int i = 0; i < 1000; i++) {
+            GeoHash cell(static_cast<long long>(random.nextInt64()),
+                         std::max(2, 1 + (random.nextInt32() & 31)));
+            ASSERT_EQUALS(hilbert.toKeyOrder(cell.parent()), hilbert.toKeyOrder(cell).parent());
+        }
+    }
+
+    // Consecutive keys at a level are always edge neighbors, unlike Z order
+    TEST(GeoHashConvertor, KeyOrderIsContinuous) {
+        GeoHashConverter hilbert(makeHilbertParams());
+        const unsigned bits = 5;
+        unsigned lastX = 0;
+        unsigned lastY = 0;
+        for (long long key = 0; key < (1LL << (2 * bits)); key++) {
+            GeoHash cell = hilbert.fromKeyOrder(GeoHash(key << (64 - 2 * bits), bits));
+            unsigned x, y;
+            cell.unhash(&x, &y);
+            x >>= 32 - bits;
+            y >>= 32 - bits;
+            if (key > 0) {
+                ASSERT_EQUALS(1U, (x > lastX ? x - lastX : lastX - x)
+                                  + (y > lastY ? y - lastY : lastY - y));
+            }
+            lastX = x;
+            lastY = y;
+        }
+    }
+
     /**
      * ==========================
      * Error Bound of UnhashToBox
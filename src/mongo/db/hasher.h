@@ -39,6 +39,7 @@
 #include <boost/noncopyable.hpp>
 
 #include "mongo/bson/bsonelement.h"
+#include "mongo/bson/util/builder.h"
 #include "mongo/util/md5.hpp"
 
 namespace mongo {
@@ -46,10 +47,24 @@ namespace mongo {
     typedef int HashSeed;
     typedef unsigned char HashDigest[16];
 
+    /* Hash versions, as stored in the "hashVersion" field of a hashed index spec.
+     *
+     * WARNING: the output of an existing version must never change. Hashed indexes and
+     * hashed shard keys store these values, so a new hash function needs a new version.
+     */
+    enum HashVersion {
+        // md5 of the canonical element encoding. The default for specs without "hashVersion".
+        HASH_VERSION_MD5 = 0,
+
+        // MurmurHash3 x64 128-bit of the same canonical encoding, seeded with the hash seed.
+        // Considerably cheaper than md5 for the short values shard keys usually hold.
+        HASH_VERSION_MURMUR3 = 1,
+    };
+
     class Hasher : private boost::noncopyable {
     public:
 
-        explicit Hasher( HashSeed seed );
+        explicit Hasher( HashSeed seed , int hashVersion = HASH_VERSION_MD5 );
         ~Hasher() { };
 
         //pointer to next part of input key, length in bytes to read
@@ -60,17 +75,21 @@ namespace mongo {
         void finish( HashDigest out );
 
     private:
-        md5_state_t _md5State;
+        const int _hashVersion;
         HashSeed _seed;
+
+        // HASH_VERSION_MD5 hashes incrementally
+        md5_state_t _md5State;
+
+        // HASH_VERSION_MURMUR3 has no incremental form, so the input is gathered here and
+        // hashed in one pass by finish()
+        StackBufBuilder _buf;
     };
 
     class HasherFactory : private boost::noncopyable  {
     public:
-        /* Eventually this may be a more sophisticated factory
-         * for creating other hashers, but for now use MD5.
-         */
-        static Hasher* createHasher( HashSeed seed ) {
-            return new Hasher( seed );
+        static Hasher* createHasher( HashSeed seed , int hashVersion = HASH_VERSION_MD5 ) {
+            return new Hasher( seed , hashVersion );
         }
 
     private:
@@ -103,6 +122,17 @@ namespace mongo {
          */
         static long long int hash64( const BSONElement& e , HashSeed seed );
 
+        /* As above, but using the hash function of the given hash version. The element
+         * squashing rules are the same for every version; only the digest differs.
+         */
+        static long long int hash64( const BSONElement& e , HashSeed seed , int hashVersion );
+
+        /* Returns true if "hashVersion" names a hash function this server can compute.
+         */
+        static bool isValidHashVersion( int hashVersion ) {
+            return hashVersion == HASH_VERSION_MD5 || hashVersion == HASH_VERSION_MURMUR3;
+        }
+
         /* This incrementally computes the hash of BSONElement "e"
          * using hash function "h".  If "includeFieldName" is true,
          * then the name of the field is hashed in between the type of
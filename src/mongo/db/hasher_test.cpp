@@ -46,6 +46,9 @@ namespace {
         int seed = 0;
         return hashIt( object, seed );
     }
+    long long murmurHashIt( const BSONObj& object, int seed = 0 ) {
+        return BSONElementHasher::hash64( object.firstElement(), seed, HASH_VERSION_MURMUR3 );
+    }
 
     // Test different oids hash to different things
     TEST( BSONElementHasher, DifferentOidsAreDifferentHashes ) {
@@ -381,5 +384,46 @@ namespace {
         ASSERT_EQUALS( hashIt( o ), 501342939894575968LL );
     }
 
+    TEST( BSONElementHasher, DefaultHashVersionIsMD5 ) {
+        BSONObj o = BSON( "check" << 42 );
+        ASSERT_EQUALS( hashIt( o ),
+                       BSONElementHasher::hash64( o.firstElement(), 0, HASH_VERSION_MD5 ) );
+    }
+
+    TEST( BSONElementHasher, ValidHashVersions ) {
+        ASSERT( BSONElementHasher::isValidHashVersion( HASH_VERSION_MD5 ) );
+        ASSERT( BSONElementHasher::isValidHashVersion( HASH_VERSION_MURMUR3 ) );
+        ASSERT_FALSE( BSONElementHasher::isValidHashVersion( -1 ) );
+        ASSERT_FALSE( BSONElementHasher::isValidHashVersion( 2 ) );
+    }
+
+    // The murmur3 version hashes the same canonical encoding, so it must squash the same way
+    TEST( BSONElementHasher, Murmur3ConsistentHashOfIntLongAndDouble ) {
+        long long int intHash = murmurHashIt( BSON( "a" << 3 ) );
+        ASSERT_EQUALS( intHash, murmurHashIt( BSON( "a" << 3LL ) ) );
+        ASSERT_EQUALS( intHash, murmurHashIt( BSON( "a" << 3.1 ) ) );
+        ASSERT_EQUALS( murmurHashIt( fromjson( "{x : {a : 3, b : [3.1, {c : 3}]}}" ) ),
+                       murmurHashIt( fromjson( "{x : {a : 3.1, b : [3, {c : 3.0}]}}" ) ) );
+    }
+
+    TEST( BSONElementHasher, Murmur3SeedMatters ) {
+        BSONObj o = BSON( "check" << 42 );
+        ASSERT_NOT_EQUALS( murmurHashIt( o, 0 ), murmurHashIt( o, 1 ) );
+    }
+
+    TEST( BSONElementHasher, Murmur3DiffersFromMD5 ) {
+        BSONObj o = BSON( "check" << 42 );
+        ASSERT_NOT_EQUALS( hashIt( o ), murmurHashIt( o ) );
+    }
+
+    TEST( BSONElementHasher, Murmur3HashValues ) {
+        ASSERT_EQUALS( murmurHashIt( BSON( "check" << 42 ) ), 8715208212397937794LL );
+        ASSERT_EQUALS( murmurHashIt( BSON( "check" << 42 ), 1 ), -9087602108468514688LL );
+        ASSERT_EQUALS( murmurHashIt( BSON( "check" << "abc" ) ), 1087612813366940559LL );
+        ASSERT_EQUALS( murmurHashIt( BSON( "check" << BSONNULL ) ), 6655367218388208063LL );
+        ASSERT_EQUALS( murmurHashIt( BSON( "check" << MINKEY ) ), 4889297221962843713LL );
+        ASSERT_EQUALS( murmurHashIt( BSON( "check" << MAXKEY ) ), -4169747260214026520LL );
+    }
+
 } // namespace
 } // namespace mongo
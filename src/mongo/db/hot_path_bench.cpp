@@ -0,0 +1,806 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+/**
+ * Micro benchmarks of the server's CPU bound hot paths: BSON validation, matching, index key
+ * generation, KeyString encoding, plan cache lookups, sorting and $group.
+ *
+ * Every benchmark is first calibrated, by doubling the number of operations in a batch until a
+ * batch takes at least --minBatchMillis, then warmed up for --warmupMillis, and then timed
+ * --repetitions times for --repetitionMillis each. The report gives the mean, median, standard
+ * deviation and range of the nanoseconds per operation across the repetitions, so a result can
+ * be judged against its own noise, and optionally writes them as JSON. Given the JSON report of
+ * an earlier run as --baseline, the run fails if any benchmark's median is more than
+ * --maxRegression slower than it was.
+ *
+ * dbtests/perftests still covers the end to end insert and query paths, which need a database.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mongo/base/initializer.h"
+#include "mongo/base/status.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/index/btree_key_generator.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/debug_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/options_parser/environment.h"
+#include "mongo/util/options_parser/option_section.h"
+#include "mongo/util/options_parser/options_parser.h"
+#include "mongo/util/options_parser/startup_option_init.h"
+#include "mongo/util/options_parser/startup_options.h"
+#include "mongo/util/quick_exit.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/signal_handlers_synchronous.h"
+#include "mongo/util/timer.h"
+#include "mongo/util/version.h"
+
+using namespace mongo;
+
+namespace {
+    const int DEFAULT_REPETITIONS = 10;
+    const int DEFAULT_REPETITION_MILLIS = 200;
+    const int DEFAULT_WARMUP_MILLIS = 500;
+    const int DEFAULT_MIN_BATCH_MILLIS = 10;
+    const double DEFAULT_MAX_REGRESSION = 0.1;
+
+    // Folded into by every benchmark so the work it times can't be optimized away.
+    volatile long long benchSink = 0;
+}
+
+struct BenchmarkParams {
+    int repetitions;
+    int repetitionMillis;
+    int warmupMillis;
+    int minBatchMillis;
+    std::string filter;         // only run benchmarks whose name contains this
+    bool list;
+    bool quiet;
+    bool jsonReportEnabled;
+    std::string jsonReportOut;
+    std::string baseline;       // JSON report of an earlier run to gate against, if set
+    double maxRegression;
+} benchParams;
+
+/**
+ * One benchmark. setUp() prepares its inputs, outside of any timing, and run() does
+ * 'iterations' operations on them.
+ */
+class HotPathBenchmark {
+public:
+    virtual ~HotPathBenchmark() {}
+    virtual std::string name() const = 0;
+    virtual void setUp() {}
+    virtual long long run(long long iterations) = 0;
+};
+
+namespace {
+
+    /** A document shaped like a typical small application record. */
+    BSONObj makeRecord(PseudoRandom& random, int i) {
+        BSONObjBuilder b;
+        b.append("_id", OID::gen());
+        b.append("a", i);
+        b.append("b", static_cast<int>(random.nextInt32(1000)));
+        b.append("name", str::stream() << "user" << i);
+        b.append("score", random.nextInt32(10000) / 100.0);
+        b.append("active", i % 3 != 0);
+        b.appendDate("created", Date_t(1420070400000ULL + i * 1000ULL));
+        BSONArrayBuilder tags(b.subarrayStart("tags"));
+        for (int t = 0; t < 5; t++) {
+            tags.append(str::stream() << "tag" << random.nextInt32(50));
+        }
+        tags.done();
+        BSONObjBuilder address(b.subobjStart("address"));
+        address.append("city", str::stream() << "city" << random.nextInt32(100));
+        address.append("zip", static_cast<int>(random.nextInt32(99999)));
+        address.done();
+        return b.obj();
+    }
+
+    std::vector<BSONObj> makeRecords(int n) {
+        PseudoRandom random(17);
+        std::vector<BSONObj> records;
+        for (int i = 0; i < n; i++) {
+            records.push_back(makeRecord(random, i));
+        }
+        return records;
+    }
+
+    /** An array of 'records' under the empty field name, as DocumentSourceBsonArray reads. */
+    BSONObj makeRecordArray(const std::vector<BSONObj>& records) {
+        BSONArrayBuilder b;
+        for (size_t i = 0; i < records.size(); i++) {
+            b.append(records[i]);
+        }
+        return b.arr();
+    }
+
+    class BsonValidate : public HotPathBenchmark {
+    public:
+        BsonValidate(const std::string& name, int nestedDepth)
+            : _name(name), _nestedDepth(nestedDepth) {}
+
+        virtual std::string name() const { return _name; }
+
+        virtual void setUp() {
+            PseudoRandom random(17);
+            _obj = makeRecord(random, 0);
+            for (int i = 0; i < _nestedDepth; i++) {
+                _obj = BSON("level" << i << "child" << _obj << "sibling" << _obj);
+            }
+        }
+
+        virtual long long run(long long iterations) {
+            long long valid = 0;
+            for (long long i = 0; i < iterations; i++) {
+                valid += validateBSON(_obj.objdata(), _obj.objsize()).isOK();
+            }
+            return valid;
+        }
+
+    private:
+        const std::string _name;
+        const int _nestedDepth;
+        BSONObj _obj;
+    };
+
+    class Matcher : public HotPathBenchmark {
+    public:
+        Matcher(const std::string& name, const std::string& query)
+            : _name(name), _query(fromjson(query)) {}
+
+        virtual std::string name() const { return _name; }
+
+        virtual void setUp() {
+            StatusWithMatchExpression parsed = MatchExpressionParser::parse(_query);
+            invariantOK(parsed.getStatus());
+            _expr.reset(parsed.getValue());
+            _records = makeRecords(1000);
+        }
+
+        virtual long long run(long long iterations) {
+            long long matched = 0;
+            for (long long i = 0; i < iterations; i++) {
+                matched += _expr->matchesBSON(_records[i % _records.size()]);
+            }
+            return matched;
+        }
+
+    private:
+        const std::string _name;
+        const BSONObj _query;
+        boost::scoped_ptr<MatchExpression> _expr;
+        std::vector<BSONObj> _records;
+    };
+
+    class KeyGeneration : public HotPathBenchmark {
+    public:
+        KeyGeneration(const std::string& name, const BSONObj& keyPattern)
+            : _name(name), _keyPattern(keyPattern) {}
+
+        virtual std::string name() const { return _name; }
+
+        virtual void setUp() {
+            std::vector<const char*> fieldNames;
+            std::vector<BSONElement> fixed;
+            BSONObjIterator it(_keyPattern);
+            while (it.more()) {
+                fieldNames.push_back(it.next().fieldName());
+                fixed.push_back(BSONElement());
+            }
+            _keyGen.reset(new BtreeKeyGeneratorV1(fieldNames, fixed, false));
+            _records = makeRecords(1000);
+        }
+
+        virtual long long run(long long iterations) {
+            long long keys = 0;
+            for (long long i = 0; i < iterations; i++) {
+                BSONObjSet keySet;
+                _keyGen->getKeys(_records[i % _records.size()], &keySet);
+                keys += keySet.size();
+            }
+            return keys;
+        }
+
+    private:
+        const std::string _name;
+        const BSONObj _keyPattern;
+        boost::scoped_ptr<BtreeKeyGenerator> _keyGen;
+        std::vector<BSONObj> _records;
+    };
+
+    class KeyStringEncode : public HotPathBenchmark {
+    public:
+        KeyStringEncode() : _ord(Ordering::make(BSON("a" << 1 << "name" << -1 << "score" << 1))) {}
+
+        virtual std::string name() const { return "keystring_encode"; }
+
+        virtual void setUp() {
+            PseudoRandom random(17);
+            for (int i = 0; i < 1000; i++) {
+                const BSONObj record = makeRecord(random, i);
+                _keys.push_back(BSON("" << record["a"] << "" << record["name"]
+                                        << "" << record["score"]));
+            }
+        }
+
+        virtual long long run(long long iterations) {
+            long long bytes = 0;
+            KeyString ks;
+            for (long long i = 0; i < iterations; i++) {
+                ks.resetToKey(_keys[i % _keys.size()], _ord, RecordId(i + 1));
+                bytes += ks.getSize();
+            }
+            return bytes;
+        }
+
+    private:
+        const Ordering _ord;
+        std::vector<BSONObj> _keys;
+    };
+
+    class KeyStringDecode : public HotPathBenchmark {
+    public:
+        KeyStringDecode() : _ord(Ordering::make(BSON("a" << 1 << "name" << -1 << "score" << 1))) {}
+
+        virtual std::string name() const { return "keystring_decode"; }
+
+        virtual void setUp() {
+            PseudoRandom random(17);
+            for (int i = 0; i < 1000; i++) {
+                const BSONObj record = makeRecord(random, i);
+                KeyString ks(BSON("" << record["a"] << "" << record["name"]
+                                     << "" << record["score"]), _ord);
+                _encoded.push_back(std::string(ks.getBuffer(), ks.getSize()));
+                _typeBits.push_back(ks.getTypeBits());
+            }
+        }
+
+        virtual long long run(long long iterations) {
+            long long fields = 0;
+            for (long long i = 0; i < iterations; i++) {
+                const size_t n = i % _encoded.size();
+                fields += KeyString::toBson(_encoded[n], _ord, _typeBits[n]).nFields();
+            }
+            return fields;
+        }
+
+    private:
+        const Ordering _ord;
+        std::vector<std::string> _encoded;
+        std::vector<KeyString::TypeBits> _typeBits;
+    };
+
+    /**
+     * Looks up queries of many shapes in a plan cache that has an entry for each, as every
+     * query the planner might answer from the cache does.
+     */
+    class PlanCacheLookup : public HotPathBenchmark {
+    public:
+        virtual std::string name() const { return "plancache_get"; }
+
+        virtual void setUp() {
+            static const char* const fields[] = {"a", "b", "name", "score", "active", "tags"};
+            static const char* const ops[] = {"$gt", "$lt", "$in", "$exists"};
+            const int nFields = sizeof(fields) / sizeof(fields[0]);
+
+            for (int i = 0; i < 64; i++) {
+                BSONObjBuilder query;
+                for (int f = 0; f < nFields; f++) {
+                    if (!(i & (1 << f)) && f != i % nFields) {
+                        continue;
+                    }
+                    const char* op = ops[(i + f) % 4];
+                    if (op == std::string("$in")) {
+                        query.append(fields[f], BSON(op << BSON_ARRAY(1 << 2 << 3)));
+                    }
+                    else if (op == std::string("$exists")) {
+                        query.append(fields[f], BSON(op << true));
+                    }
+                    else {
+                        query.append(fields[f], BSON(op << i));
+                    }
+                }
+                const BSONObj sort = i % 3 ? BSONObj() : BSON("a" << 1);
+
+                CanonicalQuery* rawCq;
+                invariantOK(CanonicalQuery::canonicalize("bench.plancache", query.obj(), sort,
+                                                         BSONObj(), &rawCq));
+                _queries.push_back(boost::shared_ptr<CanonicalQuery>(rawCq));
+
+                QuerySolution qs;
+                qs.cacheData.reset(new SolutionCacheData());
+                qs.cacheData->solnType = SolutionCacheData::COLLSCAN_SOLN;
+                qs.cacheData->tree.reset(new PlanCacheIndexTree());
+                std::vector<QuerySolution*> solns;
+                solns.push_back(&qs);
+                invariantOK(_planCache.add(*rawCq, solns, makeDecision()));
+            }
+        }
+
+        virtual long long run(long long iterations) {
+            long long found = 0;
+            for (long long i = 0; i < iterations; i++) {
+                CachedSolution* rawCachedSoln;
+                if (_planCache.get(*_queries[i % _queries.size()], &rawCachedSoln).isOK()) {
+                    delete rawCachedSoln;
+                    found++;
+                }
+            }
+            return found;
+        }
+
+    private:
+        static PlanRankingDecision* makeDecision() {
+            std::auto_ptr<PlanRankingDecision> why(new PlanRankingDecision());
+            CommonStats common("COLLSCAN");
+            std::auto_ptr<PlanStageStats> stats(new PlanStageStats(common, STAGE_COLLSCAN));
+            stats->specific.reset(new CollectionScanStats());
+            why->stats.mutableVector().push_back(stats.release());
+            why->scores.push_back(0U);
+            why->candidateOrder.push_back(0);
+            return why.release();
+        }
+
+        PlanCache _planCache;
+        std::vector<boost::shared_ptr<CanonicalQuery> > _queries;
+    };
+
+    /**
+     * Runs a pipeline stage over documents read from a BSON array. One operation is a pass over
+     * all of them, and includes turning the BSON into Documents, as the server's pipelines do.
+     */
+    class PipelineStage : public HotPathBenchmark {
+    public:
+        PipelineStage(const std::string& name, const BSONObj& stageSpec, int nDocs)
+            : _name(name), _stageSpec(stageSpec), _nDocs(nDocs) {}
+
+        virtual std::string name() const { return _name; }
+
+        virtual void setUp() {
+            _expCtx = new ExpressionContext(&_txn, NamespaceString("bench.pipeline"));
+            _input = makeRecordArray(makeRecords(_nDocs));
+        }
+
+        virtual long long run(long long iterations) {
+            long long out = 0;
+            for (long long i = 0; i < iterations; i++) {
+                boost::intrusive_ptr<DocumentSourceBsonArray> source =
+                    DocumentSourceBsonArray::create(_input, _expCtx);
+                boost::intrusive_ptr<DocumentSource> stage = makeStage();
+                stage->setSource(source.get());
+                while (boost::optional<Document> next = stage->getNext()) {
+                    out++;
+                }
+            }
+            return out;
+        }
+
+    private:
+        boost::intrusive_ptr<DocumentSource> makeStage() {
+            const BSONElement spec = _stageSpec.firstElement();
+            if (spec.fieldNameStringData() == "$sort") {
+                return DocumentSourceSort::createFromBson(spec, _expCtx);
+            }
+            invariant(spec.fieldNameStringData() == "$group");
+            return DocumentSourceGroup::createFromBson(spec, _expCtx);
+        }
+
+        const std::string _name;
+        const BSONObj _stageSpec;
+        const int _nDocs;
+        OperationContextNoop _txn;
+        boost::intrusive_ptr<ExpressionContext> _expCtx;
+        BSONObj _input;
+    };
+
+    void makeBenchmarks(std::vector<HotPathBenchmark*>* out) {
+        out->push_back(new BsonValidate("bson_validate_record", 0));
+        out->push_back(new BsonValidate("bson_validate_nested", 4));
+
+        out->push_back(new Matcher("matcher_equality", "{a: 500}"));
+        out->push_back(new Matcher("matcher_range_and_in",
+                                   "{score: {$gte: 10, $lt: 60}, tags: {$in: ['tag1', 'tag7']}}"));
+        out->push_back(new Matcher("matcher_or_dotted",
+                                   "{$or: [{'address.city': 'city7'}, {active: false, b: {$gt: 900}}]}"));
+
+        out->push_back(new KeyGeneration("keygen_compound", BSON("a" << 1 << "name" << 1)));
+        out->push_back(new KeyGeneration("keygen_dotted", BSON("address.zip" << 1)));
+        out->push_back(new KeyGeneration("keygen_multikey", BSON("tags" << 1 << "a" << 1)));
+
+        out->push_back(new KeyStringEncode());
+        out->push_back(new KeyStringDecode());
+
+        out->push_back(new PlanCacheLookup());
+
+        out->push_back(new PipelineStage("sorter_sort_10k",
+                                         BSON("$sort" << BSON("score" << -1 << "a" << 1)),
+                                         10000));
+        out->push_back(new PipelineStage("group_100_keys_10k",
+                                         fromjson("{$group: {_id: '$address.city',"
+                                                  " total: {$sum: '$score'},"
+                                                  " n: {$sum: 1},"
+                                                  " last: {$last: '$name'}}}"),
+                                         10000));
+    }
+
+    struct BenchmarkResult {
+        std::string name;
+        long long batchIterations;
+        std::vector<double> nanosPerOp;     // one per repetition, sorted
+    };
+
+    double mean(const std::vector<double>& values) {
+        return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    }
+
+    double median(const std::vector<double>& sorted) {
+        const size_t n = sorted.size();
+        return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+    }
+
+    double stddev(const std::vector<double>& values) {
+        if (values.size() < 2) {
+            return 0;
+        }
+        const double m = mean(values);
+        double sumSquares = 0;
+        for (size_t i = 0; i < values.size(); i++) {
+            sumSquares += (values[i] - m) * (values[i] - m);
+        }
+        return std::sqrt(sumSquares / (values.size() - 1));
+    }
+
+    /** Runs batches until 'millis' have passed and returns the nanoseconds per operation. */
+    double timeBatches(HotPathBenchmark* bench, long long batchIterations, int millis) {
+        long long iterations = 0;
+        Timer timer;
+        do {
+            benchSink += bench->run(batchIterations);
+            iterations += batchIterations;
+        } while (timer.millis() < millis);
+        return timer.micros() * 1000.0 / iterations;
+    }
+
+    BenchmarkResult runBenchmark(HotPathBenchmark* bench, const BenchmarkParams& params) {
+        bench->setUp();
+
+        BenchmarkResult result;
+        result.name = bench->name();
+
+        result.batchIterations = 1;
+        for (;;) {
+            Timer timer;
+            benchSink += bench->run(result.batchIterations);
+            if (timer.millis() >= params.minBatchMillis) {
+                break;
+            }
+            result.batchIterations *= 2;
+        }
+
+        timeBatches(bench, result.batchIterations, params.warmupMillis);
+
+        for (int i = 0; i < params.repetitions; i++) {
+            result.nanosPerOp.push_back(
+                timeBatches(bench, result.batchIterations, params.repetitionMillis));
+        }
+        std::sort(result.nanosPerOp.begin(), result.nanosPerOp.end());
+        return result;
+    }
+
+    void textReport(const std::vector<BenchmarkResult>& results) {
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult& r = results[i];
+            const double m = mean(r.nanosPerOp);
+            std::cout << r.name
+                      << " ns/op median: " << median(r.nanosPerOp)
+                      << " mean: " << m
+                      << " stddev: " << stddev(r.nanosPerOp)
+                      << " (" << 100 * stddev(r.nanosPerOp) / m << "%)"
+                      << " min: " << r.nanosPerOp.front()
+                      << " max: " << r.nanosPerOp.back()
+                      << " batch: " << r.batchIterations << std::endl;
+        }
+    }
+
+    BSONObj makeJsonReport(const BenchmarkParams& params,
+                           const std::vector<BenchmarkResult>& results) {
+        BSONObjBuilder obj;
+
+        BSONObjBuilder info(obj.subobjStart("info"));
+        info.append("version", versionString);
+        info.append("git", gitVersion());
+        info.append("debug", debug);
+        info.append("repetitions", params.repetitions);
+        info.append("repetitionMillis", params.repetitionMillis);
+        info.append("warmupMillis", params.warmupMillis);
+        info.done();
+
+        BSONArrayBuilder benchmarks(obj.subarrayStart("benchmarks"));
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult& r = results[i];
+            BSONObjBuilder result(benchmarks.subobjStart());
+            result.append("name", r.name);
+            result.append("batchIterations", r.batchIterations);
+
+            BSONObjBuilder nanos(result.subobjStart("nanosPerOp"));
+            nanos.append("median", median(r.nanosPerOp));
+            nanos.append("mean", mean(r.nanosPerOp));
+            nanos.append("stddev", stddev(r.nanosPerOp));
+            nanos.append("min", r.nanosPerOp.front());
+            nanos.append("max", r.nanosPerOp.back());
+            nanos.append("raw", r.nanosPerOp);
+            nanos.done();
+            result.done();
+        }
+        benchmarks.done();
+        return obj.obj();
+    }
+
+    void jsonReport(const std::string& jsonReportOut, const BSONObj& report) {
+        const std::string outStr = report.jsonString();
+
+        if (jsonReportOut == "-") {
+            std::cout << outStr << std::endl;
+        } else {
+            std::ofstream outfile(jsonReportOut.c_str());
+            if (!outfile.is_open()) {
+                std::cerr << "Error: couldn't create output file " << jsonReportOut << std::endl;
+                return;
+            }
+            ON_BLOCK_EXIT(&std::ofstream::close, outfile);
+            outfile << outStr << std::endl;
+        }
+    }
+
+    /**
+     * Compares the medians in 'report' with those in the report at 'baselinePath'. Returns the
+     * number of benchmarks more than 'maxRegression' slower than in the baseline.
+     */
+    int compareWithBaseline(const BSONObj& report,
+                            const std::string& baselinePath,
+                            double maxRegression) {
+        std::ifstream infile(baselinePath.c_str());
+        uassert(28628, str::stream() << "couldn't open baseline " << baselinePath,
+                infile.is_open());
+        std::stringstream contents;
+        contents << infile.rdbuf();
+        const BSONObj baseline = fromjson(contents.str());
+
+        int regressions = 0;
+        BSONObjIterator it(report["benchmarks"].Obj());
+        while (it.more()) {
+            const BSONObj result = it.next().Obj();
+            const std::string name = result["name"].String();
+
+            double baselineMedian = -1;
+            BSONObjIterator baseIt(baseline["benchmarks"].Obj());
+            while (baseIt.more()) {
+                const BSONObj base = baseIt.next().Obj();
+                if (base["name"].String() == name) {
+                    baselineMedian = base["nanosPerOp"]["median"].Number();
+                }
+            }
+            if (baselineMedian <= 0) {
+                std::cout << name << ": not in baseline" << std::endl;
+                continue;
+            }
+
+            const double change = result["nanosPerOp"]["median"].Number() / baselineMedian - 1;
+            const bool regressed = change > maxRegression;
+            std::cout << name << ": " << (change >= 0 ? "+" : "") << 100 * change
+                      << "% against baseline" << (regressed ? " REGRESSION" : "") << std::endl;
+            regressions += regressed;
+        }
+        return regressions;
+    }
+
+} // namespace
+
+namespace moe = mongo::optionenvironment;
+
+Status addHotPathBenchOptions(moe::OptionSection& options) {
+    options.addOptionChaining("help", "help", moe::Switch, "Display help");
+    options.addOptionChaining("list", "list", moe::Switch,
+                              "List the benchmarks instead of running them");
+
+    options.addOptionChaining("filter", "filter", moe::String,
+                              "Only run the benchmarks whose names contain this string");
+
+    options.addOptionChaining("repetitions", "repetitions", moe::Int,
+                              "The number of timed repetitions of each benchmark")
+        .setDefault(moe::Value(DEFAULT_REPETITIONS));
+
+    options.addOptionChaining("repetitionMillis", "repetitionMillis", moe::Int,
+                              "How long each repetition runs for")
+        .setDefault(moe::Value(DEFAULT_REPETITION_MILLIS));
+
+    options.addOptionChaining("warmupMillis", "warmupMillis", moe::Int,
+                              "How long each benchmark runs before it is timed")
+        .setDefault(moe::Value(DEFAULT_WARMUP_MILLIS));
+
+    options.addOptionChaining("minBatchMillis", "minBatchMillis", moe::Int,
+                              str::stream() << "The shortest a batch of operations may take; "
+                                            << "the timer is read once per batch")
+        .setDefault(moe::Value(DEFAULT_MIN_BATCH_MILLIS));
+
+    options.addOptionChaining("quiet", "quiet", moe::Switch,
+                              "Suppress the plaintext report");
+
+    options.addOptionChaining("jsonReport", "jsonReport", moe::String,
+                              str::stream() << "If set, results will be saved as a JSON document to "
+                                            << "the specified file path. If specified with no "
+                                            << "arguments the report will be printed to standard "
+                                            << "out")
+        .setImplicit(moe::Value(std::string("-")));
+
+    options.addOptionChaining("baseline", "baseline", moe::String,
+                              str::stream() << "The JSON report of an earlier run. The run fails "
+                                            << "if any benchmark's median is more than "
+                                            << "maxRegression slower than in it");
+
+    options.addOptionChaining("maxRegression", "maxRegression", moe::Double,
+                              "The slowdown against the baseline allowed, as a fraction")
+        .setDefault(moe::Value(DEFAULT_MAX_REGRESSION));
+
+    return Status::OK();
+}
+
+Status validateHotPathBenchOptions(const moe::OptionSection& options,
+                                   moe::Environment& env) {
+    Status ret = env.validate();
+    if (!ret.isOK()) {
+        return ret;
+    }
+    bool displayHelp = false;
+    ret = env.get(moe::Key("help"), &displayHelp);
+    if (displayHelp) {
+        std::cout << options.helpString() << std::endl;
+        quickExit(EXIT_SUCCESS);
+    }
+    return Status::OK();
+}
+
+Status storeHotPathBenchOptions(const moe::Environment& env) {
+    // don't actually need to check Status since we set default values
+    Status ret = env.get(moe::Key("repetitions"), &benchParams.repetitions);
+    ret = env.get(moe::Key("repetitionMillis"), &benchParams.repetitionMillis);
+    ret = env.get(moe::Key("warmupMillis"), &benchParams.warmupMillis);
+    ret = env.get(moe::Key("minBatchMillis"), &benchParams.minBatchMillis);
+    if (benchParams.repetitions <= 0 || benchParams.repetitionMillis <= 0 ||
+        benchParams.warmupMillis < 0 || benchParams.minBatchMillis <= 0) {
+        return Status(ErrorCodes::BadValue,
+                      "repetitions, repetitionMillis and minBatchMillis must be positive");
+    }
+    ret = env.get(moe::Key("maxRegression"), &benchParams.maxRegression);
+    ret = env.get(moe::Key("list"), &benchParams.list);
+    ret = env.get(moe::Key("quiet"), &benchParams.quiet);
+
+    ret = env.get(moe::Key("filter"), &benchParams.filter);
+    ret = env.get(moe::Key("baseline"), &benchParams.baseline);
+
+    benchParams.jsonReportEnabled = true;
+    ret = env.get(moe::Key("jsonReport"), &benchParams.jsonReportOut);
+    if (!ret.isOK()) {
+        benchParams.jsonReportEnabled = false;
+    }
+    return Status::OK();
+}
+
+int main(int argc, char** argv, char** envp) {
+    ::mongo::setupSynchronousSignalHandlers();
+    ::mongo::runGlobalInitializersOrDie(argc, argv, envp);
+
+    std::vector<HotPathBenchmark*> benchmarks;
+    makeBenchmarks(&benchmarks);
+
+    int regressions = 0;
+    try {
+        std::vector<BenchmarkResult> results;
+        for (size_t i = 0; i < benchmarks.size(); i++) {
+            const std::string name = benchmarks[i]->name();
+            if (name.find(benchParams.filter) == std::string::npos) {
+                continue;
+            }
+            if (benchParams.list) {
+                std::cout << name << std::endl;
+                continue;
+            }
+            results.push_back(runBenchmark(benchmarks[i], benchParams));
+        }
+        if (benchParams.list) {
+            quickExit(EXIT_SUCCESS);
+        }
+
+        if (!benchParams.quiet) {
+            textReport(results);
+        }
+
+        const BSONObj report = makeJsonReport(benchParams, results);
+        if (benchParams.jsonReportEnabled) {
+            jsonReport(benchParams.jsonReportOut, report);
+        }
+
+        if (!benchParams.baseline.empty()) {
+            regressions = compareWithBaseline(report,
+                                              benchParams.baseline,
+                                              benchParams.maxRegression);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Benchmark ended in failure: " << ex.what() << std::endl;
+        quickExit(EXIT_FAILURE);
+    }
+
+    if (regressions) {
+        std::cerr << regressions << " benchmark(s) regressed by more than "
+                  << 100 * benchParams.maxRegression << "%" << std::endl;
+        quickExit(EXIT_FAILURE);
+    }
+    quickExit(EXIT_SUCCESS);
+}
+
+MONGO_GENERAL_STARTUP_OPTIONS_REGISTER(HotPathBenchOptions)(InitializerContext* context) {
+    return addHotPathBenchOptions(moe::startupOptions);
+}
+
+MONGO_STARTUP_OPTIONS_VALIDATE(HotPathBenchOptions)(InitializerContext* context) {
+    return validateHotPathBenchOptions(moe::startupOptions,
+                                       moe::startupOptionsParsed);
+}
+
+MONGO_STARTUP_OPTIONS_STORE(HotPathBenchOptions)(InitializerContext* context) {
+    return storeHotPathBenchOptions(moe::startupOptionsParsed);
+}
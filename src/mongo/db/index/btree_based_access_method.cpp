@@ -30,6 +30,7 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/base/error_codes.h"
@@ -41,6 +42,7 @@
 #include "mongo/db/keypattern.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
 
@@ -53,6 +55,48 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(failIndexKeyTooLong, bool, true);
 
+    /**
+     * The committed writes to an index made while a bulk build of it is in progress.
+     */
+    class BtreeBasedAccessMethod::SideWrites {
+    public:
+        struct Write {
+            Write(const BSONObj& key, const RecordId& loc, bool isInsert, bool dupsAllowed)
+                : key(key), loc(loc), isInsert(isInsert), dupsAllowed(dupsAllowed) { }
+
+            BSONObj key;
+            RecordId loc;
+            bool isInsert;
+            bool dupsAllowed;
+        };
+
+        SideWrites() : mutex("indexSideWrites") { }
+
+        // Writers only hold intent locks, so they may commit concurrently.
+        SimpleMutex mutex;
+        vector<Write> writes;
+    };
+
+    /**
+     * On commit, adds a write to the side writes of an index.
+     */
+    class BtreeBasedAccessMethod::RecordSideWrite : public RecoveryUnit::Change {
+    public:
+        RecordSideWrite(SideWrites* sideWrites, const SideWrites::Write& write)
+            : _sideWrites(sideWrites), _write(write) { }
+
+        virtual void commit() {
+            SimpleMutex::scoped_lock lk(_sideWrites->mutex);
+            _sideWrites->writes.push_back(_write);
+        }
+
+        virtual void rollback() { }
+
+    private:
+        SideWrites* const _sideWrites;
+        const SideWrites::Write _write;
+    };
+
     BtreeBasedAccessMethod::BtreeBasedAccessMethod(IndexCatalogEntry* btreeState,
                                                    SortedDataInterface* btree)
         : _btreeState(btreeState),
@@ -61,11 +105,79 @@ namespace mongo {
         verify(0 == _descriptor->version() || 1 == _descriptor->version());
     }
 
+    BtreeBasedAccessMethod::~BtreeBasedAccessMethod() { }
+
+    Status BtreeBasedAccessMethod::insertKey(OperationContext* txn,
+                                             const BSONObj& key,
+                                             const RecordId& loc,
+                                             bool dupsAllowed) {
+        if (_sideWrites) {
+            txn->recoveryUnit()->registerChange(new RecordSideWrite(
+                _sideWrites.get(), SideWrites::Write(key.getOwned(), loc, true, dupsAllowed)));
+            return Status::OK();
+        }
+        return _newInterface->insert(txn, key, loc, dupsAllowed);
+    }
+
+    void BtreeBasedAccessMethod::unindexKey(OperationContext* txn,
+                                            const BSONObj& key,
+                                            const RecordId& loc,
+                                            bool dupsAllowed) {
+        if (_sideWrites) {
+            txn->recoveryUnit()->registerChange(new RecordSideWrite(
+                _sideWrites.get(), SideWrites::Write(key.getOwned(), loc, false, dupsAllowed)));
+            return;
+        }
+        _newInterface->unindex(txn, key, loc, dupsAllowed);
+    }
+
     bool BtreeBasedAccessMethod::ignoreKeyTooLong(OperationContext *txn) {
         // Ignore this error if we're on a secondary or if the user requested it
         return !txn->isPrimaryFor(_btreeState->ns()) || !failIndexKeyTooLong;
     }
 
+    namespace {
+
+        // Does the document hold an array anywhere along the dotted path?
+        bool pathHasArray(const BSONObj& obj, StringData path) {
+            BSONObj current = obj;
+            while (true) {
+                const size_t dot = path.find('.');
+                BSONElement e = current.getField(dot == std::string::npos ? path : path.substr(0, dot));
+                if (Array == e.type()) {
+                    return true;
+                }
+                if (dot == std::string::npos || Object != e.type()) {
+                    return false;
+                }
+                current = e.embeddedObject();
+                path = path.substr(dot + 1);
+            }
+        }
+
+    }  // namespace
+
+    unsigned long long BtreeBasedAccessMethod::getMultikeyPaths(const BSONObj& obj,
+                                                                const BSONObjSet& keys) const {
+        // Arrays in documents with a single key only matter once others make the index multikey
+        if (keys.size() <= 1 && !_btreeState->isMultikey()) {
+            return 0;
+        }
+
+        const unsigned long long known = _btreeState->getMultikeyPaths();
+
+        unsigned long long paths = 0;
+        BSONObjIterator it(_descriptor->keyPattern());
+        for (int pos = 0; it.more() && pos < 64; ++pos) {
+            const unsigned long long bit = 1ULL << pos;
+            const BSONElement field = it.next();
+            if (!(known & bit) && pathHasArray(obj, field.fieldName())) {
+                paths |= bit;
+            }
+        }
+        return paths;
+    }
+
     // Find the keys for obj, put them in the tree pointing to loc
     Status BtreeBasedAccessMethod::insert(OperationContext* txn,
                                           const BSONObj& obj,
@@ -78,9 +190,13 @@ namespace mongo {
         // Delegate to the subclass.
         getKeys(obj, &keys);
 
+        if (unsigned long long multikeyPaths = getMultikeyPaths(obj, keys)) {
+            _btreeState->addMultikeyPaths(multikeyPaths);
+        }
+
         Status ret = Status::OK();
         for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
-            Status status = _newInterface->insert(txn, *i, loc, options.dupsAllowed);
+            Status status = insertKey(txn, *i, loc, options.dupsAllowed);
 
             // Everything's OK, carry on.
             if (status.isOK()) {
@@ -119,12 +235,109 @@ namespace mongo {
         return ret;
     }
 
+    namespace {
+
+        // A key of one of the documents passed to insertMany, with the document's position
+        struct KeyToInsert {
+            KeyToInsert(const BSONObj& key, size_t docIndex) : key(key), docIndex(docIndex) { }
+
+            BSONObj key;
+            size_t docIndex;
+        };
+
+        class KeyToInsertLess {
+        public:
+            KeyToInsertLess(const Ordering& ordering, const vector<RecordId>& locs)
+                : _ordering(ordering), _locs(locs) { }
+
+            bool operator()(const KeyToInsert& lhs, const KeyToInsert& rhs) const {
+                int cmp = lhs.key.woCompare(rhs.key, _ordering, false);
+                if (cmp != 0) {
+                    return cmp < 0;
+                }
+                return _locs[lhs.docIndex] < _locs[rhs.docIndex];
+            }
+
+        private:
+            const Ordering _ordering;
+            const vector<RecordId>& _locs;
+        };
+
+    }  // namespace
+
+    Status BtreeBasedAccessMethod::insertMany(OperationContext* txn,
+                                              const vector<BSONObj>& objs,
+                                              const vector<RecordId>& locs,
+                                              const InsertDeleteOptions& options,
+                                              int64_t* numInserted) {
+        invariant(objs.size() == locs.size());
+        *numInserted = 0;
+
+        vector<KeyToInsert> keys;
+        for (size_t i = 0; i < objs.size(); ++i) {
+            BSONObjSet docKeys;
+            // Delegate to the subclass.
+            getKeys(objs[i], &docKeys);
+            if (unsigned long long multikeyPaths = getMultikeyPaths(objs[i], docKeys)) {
+                _btreeState->addMultikeyPaths(multikeyPaths);
+            }
+            for (BSONObjSet::const_iterator it = docKeys.begin(); it != docKeys.end(); ++it) {
+                keys.push_back(KeyToInsert(*it, i));
+            }
+        }
+
+        std::sort(keys.begin(), keys.end(),
+                  KeyToInsertLess(Ordering::make(_descriptor->keyPattern()), locs));
+
+        // Counts the keys inserted for each document, to find out if the index is multikey
+        vector<int64_t> keysPerDoc(objs.size(), 0);
+
+        for (vector<KeyToInsert>::const_iterator i = keys.begin(); i != keys.end(); ++i) {
+            const RecordId& loc = locs[i->docIndex];
+            Status status = insertKey(txn, i->key, loc, options.dupsAllowed);
+
+            if (status.isOK()) {
+                ++keysPerDoc[i->docIndex];
+                ++*numInserted;
+                continue;
+            }
+
+            // Error cases, as in insert().
+
+            if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
+                continue;
+            }
+
+            if (status.code() == ErrorCodes::DuplicateKeyValue && !_btreeState->isReady(txn)) {
+                LOG(3) << "key " << i->key << " already in index during background indexing (ok)";
+                continue;
+            }
+
+            // Clean up after ourselves.
+            for (vector<KeyToInsert>::const_iterator j = keys.begin(); j != i; ++j) {
+                removeOneKey(txn, j->key, locs[j->docIndex], options.dupsAllowed);
+            }
+            *numInserted = 0;
+
+            return status;
+        }
+
+        for (size_t i = 0; i < keysPerDoc.size(); ++i) {
+            if (keysPerDoc[i] > 1) {
+                _btreeState->setMultikey(txn);
+                break;
+            }
+        }
+
+        return Status::OK();
+    }
+
     void BtreeBasedAccessMethod::removeOneKey(OperationContext* txn,
                                               const BSONObj& key,
                                               const RecordId& loc,
                                               bool dupsAllowed) {
         try {
-            _newInterface->unindex(txn, key, loc, dupsAllowed);
+            unindexKey(txn, key, loc, dupsAllowed);
         } catch (AssertionException& e) {
             log() << "Assertion failure: _unindex failed "
                   << _descriptor->indexNamespace() << endl;
@@ -200,6 +413,10 @@ namespace mongo {
         return _newInterface->touch(txn);
     }
 
+    Status BtreeBasedAccessMethod::compact(OperationContext* txn) {
+        return _newInterface->compact(txn);
+    }
+
     RecordId BtreeBasedAccessMethod::findSingle(OperationContext* txn, const BSONObj& key) const {
         boost::scoped_ptr<SortedDataInterface::Cursor> cursor(_newInterface->newCursor(txn, 1));
         cursor->locate(key, RecordId::min());
@@ -250,6 +467,7 @@ namespace mongo {
 
         getKeys(from, &data->oldKeys);
         getKeys(to, &data->newKeys);
+        data->multikeyPaths = getMultikeyPaths(to, data->newKeys);
         data->loc = record;
         data->dupsAllowed = options.dupsAllowed;
 
@@ -271,22 +489,20 @@ namespace mongo {
         BtreeBasedPrivateUpdateData* data =
             static_cast<BtreeBasedPrivateUpdateData*>(ticket._indexSpecificUpdateData.get());
 
+        if (data->multikeyPaths) {
+            _btreeState->addMultikeyPaths(data->multikeyPaths);
+        }
+
         if (data->oldKeys.size() + data->added.size() - data->removed.size() > 1) {
             _btreeState->setMultikey( txn );
         }
 
         for (size_t i = 0; i < data->removed.size(); ++i) {
-            _newInterface->unindex(txn,
-                                   *data->removed[i],
-                                   data->loc,
-                                   data->dupsAllowed);
+            unindexKey(txn, *data->removed[i], data->loc, data->dupsAllowed);
         }
 
         for (size_t i = 0; i < data->added.size(); ++i) {
-            Status status = _newInterface->insert(txn,
-                                                  *data->added[i],
-                                                  data->loc,
-                                                  data->dupsAllowed);
+            Status status = insertKey(txn, *data->added[i], data->loc, data->dupsAllowed);
             if ( !status.isOK() ) {
                 return status;
             }
@@ -323,4 +539,54 @@ namespace mongo {
         return bulk->commit(dupsToDrop, mayInterrupt, dupsAllowed);
     }
 
+    Status BtreeBasedAccessMethod::startSideWrites() {
+        if (_sideWrites) {
+            return Status(ErrorCodes::InternalError, "side writes already started");
+        }
+        _sideWrites.reset(new SideWrites());
+        return Status::OK();
+    }
+
+    Status BtreeBasedAccessMethod::drainSideWrites(OperationContext* txn) {
+        if (!_sideWrites) {
+            return Status(ErrorCodes::InternalError, "side writes not started");
+        }
+
+        // Writes from here on go straight to the index.
+        boost::scoped_ptr<SideWrites> sideWrites;
+        sideWrites.swap(_sideWrites);
+
+        const vector<SideWrites::Write>& writes = sideWrites->writes;
+        LOG(1) << "\t applying " << writes.size() << " side writes to index: "
+               << _descriptor->indexName();
+
+        for (vector<SideWrites::Write>::const_iterator i = writes.begin(); i != writes.end(); ++i) {
+            WriteUnitOfWork wunit(txn);
+
+            if (!i->isInsert) {
+                // The key may never have reached the index if the document was removed before
+                // the collection scan got to it.
+                _newInterface->unindex(txn, i->key, i->loc, i->dupsAllowed);
+                wunit.commit();
+                continue;
+            }
+
+            Status status = _newInterface->insert(txn, i->key, i->loc, i->dupsAllowed);
+            if (!status.isOK()) {
+                if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
+                    continue;
+                }
+
+                // The collection scan also saw this document after the write.
+                if (status.code() != ErrorCodes::DuplicateKeyValue) {
+                    return status;
+                }
+            }
+
+            wunit.commit();
+        }
+
+        return Status::OK();
+    }
+
 }  // namespace mongo
@@ -60,7 +60,7 @@ namespace mongo {
         BtreeBasedAccessMethod( IndexCatalogEntry* btreeState,
                                 SortedDataInterface* btree );
 
-        virtual ~BtreeBasedAccessMethod() { }
+        virtual ~BtreeBasedAccessMethod();
 
         virtual Status insert(OperationContext* txn,
                               const BSONObj& obj,
@@ -68,6 +68,12 @@ namespace mongo {
                               const InsertDeleteOptions& options,
                               int64_t* numInserted);
 
+        virtual Status insertMany(OperationContext* txn,
+                                  const std::vector<BSONObj>& objs,
+                                  const std::vector<RecordId>& locs,
+                                  const InsertDeleteOptions& options,
+                                  int64_t* numInserted);
+
         virtual Status remove(OperationContext* txn,
                               const BSONObj& obj,
                               const RecordId& loc,
@@ -98,10 +104,16 @@ namespace mongo {
                                    bool dupsAllowed,
                                    std::set<RecordId>* dups );
 
+        virtual Status startSideWrites();
+
+        virtual Status drainSideWrites(OperationContext* txn);
+
         virtual Status touch(OperationContext* txn, const BSONObj& obj);
 
         virtual Status touch(OperationContext* txn) const;
 
+        virtual Status compact(OperationContext* txn);
+
         virtual Status validate(OperationContext* txn, bool full, int64_t* numKeys,
                                 BSONObjBuilder* output);
 
@@ -121,6 +133,12 @@ namespace mongo {
 
         virtual void getKeys(const BSONObj &obj, BSONObjSet *keys) = 0;
 
+        /**
+         * Returns the multikey path bits (see IndexCatalogEntry::getMultikeyPaths()) for a
+         * document with the given keys, which are only worked out once the index is multikey.
+         */
+        unsigned long long getMultikeyPaths(const BSONObj& obj, const BSONObjSet& keys) const;
+
         // Determines whether it's OK to ignore ErrorCodes::KeyTooLong for this OperationContext
         bool ignoreKeyTooLong(OperationContext* txn);
 
@@ -128,12 +146,29 @@ namespace mongo {
         const IndexDescriptor* _descriptor;
 
     private:
+        // See the .cpp for body.
+        class SideWrites;
+        class RecordSideWrite;
+
         void removeOneKey(OperationContext* txn,
                           const BSONObj& key,
                           const RecordId& loc,
                           bool dupsAllowed);
 
+        // Inserts or removes one key, or records the write if side writes are on.
+        Status insertKey(OperationContext* txn,
+                         const BSONObj& key,
+                         const RecordId& loc,
+                         bool dupsAllowed);
+        void unindexKey(OperationContext* txn,
+                        const BSONObj& key,
+                        const RecordId& loc,
+                        bool dupsAllowed);
+
         boost::scoped_ptr<SortedDataInterface> _newInterface;
+
+        // Non-NULL between startSideWrites and drainSideWrites.
+        boost::scoped_ptr<SideWrites> _sideWrites;
     };
 
     /**
@@ -151,6 +186,9 @@ namespace mongo {
 
         RecordId loc;
         bool dupsAllowed;
+
+        // For the new version of the document.
+        unsigned long long multikeyPaths;
     };
 
 }  // namespace mongo
@@ -32,11 +32,15 @@
 
 #include "mongo/db/index/btree_based_bulk_access_method.h"
 
+#include <algorithm>
 #include <boost/scoped_ptr.hpp>
 
 #include "mongo/db/curop.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
 
@@ -75,6 +79,28 @@ namespace mongo {
         const int _version;
     };
 
+    // Number of threads that sort and write spilled runs for bulk index builds. At most this many
+    // runs are pending at once, and they share the build's memory limit. 0 sorts on the building
+    // thread only.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(indexBuildSorterThreads, int, 0);
+
+    // Memory each index being built through the external sorter may use before it spills a run
+    // to disk.  Read when the build starts.
+    MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildMemoryUsageMegabytes, int, 100);
+
+    namespace {
+        SimpleMutex sorterPoolMutex("indexBuildSorterPool");
+        ThreadPool* sorterPool = NULL; // created on first use and never destroyed
+
+        ThreadPool* getSorterPool() {
+            SimpleMutex::scoped_lock lk(sorterPoolMutex);
+            if (!sorterPool) {
+                sorterPool = new ThreadPool(indexBuildSorterThreads, "indexBuildSorter");
+            }
+            return sorterPool;
+        }
+    }
+
     BtreeBasedBulkAccessMethod::BtreeBasedBulkAccessMethod(OperationContext* txn,
                                                            BtreeBasedAccessMethod* real,
                                                            SortedDataInterface* interface,
@@ -86,11 +112,19 @@ namespace mongo {
         _docsInserted = 0;
         _keysInserted = 0;
         _isMultiKey = false;
+        _multikeyPaths = 0;
+
+        SortOptions opts = SortOptions().TempDir(storageGlobalParams.dbpath + "/_tmp")
+                                        .ExtSortAllowed()
+                                        .MaxMemoryUsageBytes(
+                                            std::max(maxIndexBuildMemoryUsageMegabytes, 1) *
+                                            1024LL * 1024);
+        if (indexBuildSorterThreads > 0) {
+            opts.SpillPool(getSorterPool(), indexBuildSorterThreads);
+        }
 
         _sorter.reset(BSONObjExternalSorter::make(
-                    SortOptions().TempDir(storageGlobalParams.dbpath + "/_tmp")
-                                 .ExtSortAllowed()
-                                 .MaxMemoryUsageBytes(100*1024*1024),
+                    opts,
                     BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version())));
     }
 
@@ -103,6 +137,7 @@ namespace mongo {
         _real->getKeys(obj, &keys);
 
         _isMultiKey = _isMultiKey || (keys.size() > 1);
+        _multikeyPaths |= _real->getMultikeyPaths(obj, keys);
 
         for (BSONObjSet::iterator it = keys.begin(); it != keys.end(); ++it) {
             // False is for mayInterrupt.
@@ -136,6 +171,10 @@ namespace mongo {
         {
             WriteUnitOfWork wunit(_txn);
 
+            if (_multikeyPaths) {
+                _real->_btreeState->addMultikeyPaths( _multikeyPaths );
+            }
+
             if (_isMultiKey) {
                 _real->_btreeState->setMultikey( _txn );
             }
@@ -60,6 +60,24 @@ namespace mongo {
                               const InsertDeleteOptions& options,
                               int64_t* numInserted);
 
+        virtual Status insertMany(OperationContext* txn,
+                                  const std::vector<BSONObj>& objs,
+                                  const std::vector<RecordId>& locs,
+                                  const InsertDeleteOptions& options,
+                                  int64_t* numInserted) {
+            // The keys are sorted at commit time anyway
+            *numInserted = 0;
+            for (size_t i = 0; i < objs.size(); ++i) {
+                int64_t inserted;
+                Status status = insert(txn, objs[i], locs[i], options, &inserted);
+                if (!status.isOK()) {
+                    return status;
+                }
+                *numInserted += inserted;
+            }
+            return Status::OK();
+        }
+
         Status commit(std::set<RecordId>* dupsToDrop, bool mayInterrupt, bool dupsAllowed);
 
         // Exposed for testing.
@@ -85,10 +103,18 @@ namespace mongo {
             return _notAllowed();
         }
 
+        virtual Status compact(OperationContext* txn) {
+            return _notAllowed();
+        }
+
         virtual Status validate(OperationContext* txn, bool full, int64_t* numKeys, BSONObjBuilder* output) {
             return _notAllowed();
         }
 
+        virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) {
+            _real->getKeys(obj, keys);
+        }
+
         virtual bool appendCustomStats(OperationContext* txn, BSONObjBuilder* output, double scale)
             const {
             return false;
@@ -135,6 +161,14 @@ namespace mongo {
             return NULL;
         }
 
+        virtual Status startSideWrites() {
+            return _notAllowed();
+        }
+
+        virtual Status drainSideWrites(OperationContext* txn) {
+            return _notAllowed();
+        }
+
         OperationContext* getOperationContext() { return _txn; }
 
     private:
@@ -162,6 +196,9 @@ namespace mongo {
         // Does any document have >1 key?
         bool _isMultiKey;
 
+        // Which key pattern fields did documents hold arrays for?
+        unsigned long long _multikeyPaths;
+
         OperationContext* _txn;
     };
 
@@ -92,6 +92,10 @@ namespace mongo {
         return _cursor->getKey();
     }
 
+    const KeyString* BtreeIndexCursor::getKeyString() const {
+        return _cursor->getKeyString();
+    }
+
     RecordId BtreeIndexCursor::getValue() const {
         return _cursor->getRecordId();
     }
@@ -65,6 +65,14 @@ namespace mongo {
                     const std::vector<bool>& keyEndInclusive);
 
         virtual BSONObj getKey() const;
+
+        /**
+         * BtreeIndexCursor-only.
+         * Returns the KeyString encoding of the current key, or NULL if the underlying index
+         * does not store KeyStrings.  See SortedDataInterface::Cursor::getKeyString().
+         */
+        const KeyString* getKeyString() const;
+
         virtual RecordId getValue() const;
         virtual void next();
 
@@ -27,11 +27,13 @@
 */
 
 #include "mongo/db/index/btree_key_generator.h"
+
+#include <cstring>
+
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
-    using std::set;
     using std::string;
     using std::stringstream;
     using std::vector;
@@ -224,7 +226,8 @@ namespace mongo {
     BSONElement BtreeKeyGeneratorV1::extractNextElement(const BSONObj &obj, const BSONObj &arr,
                                                         const char *&field,
                                                         bool &arrayNestedArray) const {
-        string firstField = mongoutils::str::before( field, '.' );
+        const char* dot = strchr( field, '.' );
+        const StringData firstField = dot ? StringData( field, dot - field ) : StringData( field );
         bool haveObjField = !obj.getField( firstField ).eoo();
         BSONElement arrField = arr.getField( firstField );
         bool haveArrField = !arrField.eoo();
@@ -251,22 +254,26 @@ namespace mongo {
         return BSONElement();
     }
 
-    void BtreeKeyGeneratorV1::_getKeysArrEltFixed(vector<const char*> &fieldNames,
+    void BtreeKeyGeneratorV1::_getKeysArrEltFixed(const vector<const char*> &fieldNames,
                                                   vector<BSONElement> &fixed,
                                                   const BSONElement &arrEntry, BSONObjSet *keys,
                                                   unsigned numNotFound,
                                                   const BSONElement &arrObjElt,
-                                                  const set<unsigned> &arrIdxs,
-                                                  bool mayExpandArrayUnembedded) const {
+                                                  const vector<unsigned> &arrIdxs,
+                                                  bool mayExpandArrayUnembedded,
+                                                  vector<const char*>* childFieldNames,
+                                                  vector<BSONElement>* childFixed) const {
         // set up any terminal array values
-        for( set<unsigned>::const_iterator j = arrIdxs.begin(); j != arrIdxs.end(); ++j ) {
+        for( vector<unsigned>::const_iterator j = arrIdxs.begin(); j != arrIdxs.end(); ++j ) {
             if ( *fieldNames[ *j ] == '\0' ) {
                 fixed[ *j ] = mayExpandArrayUnembedded ? arrEntry : arrObjElt;
             }
         }
-        // recurse
-        getKeysImplWithArray(fieldNames,
-                             fixed,
+        // recurse on a copy, which keeps the capacity of the previous array member's copy
+        *childFieldNames = fieldNames;
+        *childFixed = fixed;
+        getKeysImplWithArray(childFieldNames,
+                             childFixed,
                              arrEntry.type() == Object ? arrEntry.embeddedObject() : BSONObj(),
                              keys,
                              numNotFound,
@@ -275,15 +282,18 @@ namespace mongo {
 
     void BtreeKeyGeneratorV1::getKeysImpl(vector<const char*> fieldNames, vector<BSONElement> fixed,
                                           const BSONObj &obj, BSONObjSet *keys) const {
-        getKeysImplWithArray(fieldNames, fixed, obj, keys, 0, BSONObj());
+        getKeysImplWithArray(&fieldNames, &fixed, obj, keys, 0, BSONObj());
     }
 
-    void BtreeKeyGeneratorV1::getKeysImplWithArray(vector<const char*> fieldNames,
-                                                   vector<BSONElement> fixed, const BSONObj &obj,
+    void BtreeKeyGeneratorV1::getKeysImplWithArray(vector<const char*>* fieldNamesOut,
+                                                   vector<BSONElement>* fixedOut,
+                                                   const BSONObj &obj,
                                                    BSONObjSet *keys, unsigned numNotFound,
                                                    const BSONObj &array) const {
+        vector<const char*>& fieldNames = *fieldNamesOut;
+        vector<BSONElement>& fixed = *fixedOut;
         BSONElement arrElt;
-        set<unsigned> arrIdxs;
+        vector<unsigned> arrIdxs;
         bool mayExpandArrayUnembedded = true;
         for( unsigned i = 0; i < fieldNames.size(); ++i ) {
             if ( *fieldNames[ i ] == '\0' ) {
@@ -302,7 +312,7 @@ namespace mongo {
                 numNotFound++;
             }
             else if ( e.type() == Array ) {
-                arrIdxs.insert( i );
+                arrIdxs.push_back( i );
                 if ( arrElt.eoo() ) {
                     // we only expand arrays on a single path -- track the path here
                     arrElt = e;
@@ -332,18 +342,24 @@ namespace mongo {
             }
             keys->insert( b.obj() );
         }
-        else if ( arrElt.embeddedObject().firstElement().eoo() ) {
-            // Empty array, so set matching fields to undefined.
-            _getKeysArrEltFixed(fieldNames, fixed, _undefinedElt, keys, numNotFound, arrElt,
-                                arrIdxs, true );
-        }
         else {
-            // Non empty array that can be expanded, so generate a key for each member.
-            BSONObj arrObj = arrElt.embeddedObject();
-            BSONObjIterator i( arrObj );
-            while( i.more() ) {
-                _getKeysArrEltFixed(fieldNames, fixed, i.next(), keys, numNotFound, arrElt, arrIdxs,
-                        mayExpandArrayUnembedded );
+            vector<const char*> childFieldNames;
+            vector<BSONElement> childFixed;
+
+            if ( arrElt.embeddedObject().firstElement().eoo() ) {
+                // Empty array, so set matching fields to undefined.
+                _getKeysArrEltFixed(fieldNames, fixed, _undefinedElt, keys, numNotFound, arrElt,
+                                    arrIdxs, true, &childFieldNames, &childFixed );
+            }
+            else {
+                // Non empty array that can be expanded, so generate a key for each member.
+                BSONObj arrObj = arrElt.embeddedObject();
+                BSONObjIterator i( arrObj );
+                while( i.more() ) {
+                    _getKeysArrEltFixed(fieldNames, fixed, i.next(), keys, numNotFound, arrElt,
+                                        arrIdxs, mayExpandArrayUnembedded,
+                                        &childFieldNames, &childFixed );
+                }
             }
         }
     }
@@ -29,7 +29,6 @@
 #pragma once
 
 #include <vector>
-#include <set>
 #include "mongo/db/jsobj.h"
 
 namespace mongo {
@@ -94,7 +93,11 @@ namespace mongo {
                                  const BSONObj &obj, BSONObjSet *keys) const;
 
         // These guys are called by getKeysImpl.
-        void getKeysImplWithArray(std::vector<const char*> fieldNames, std::vector<BSONElement> fixed,
+        // 'fieldNames' and 'fixed' belong to this level of the recursion and are mutated. Each
+        // level reuses one pair of vectors for all the members of the array it expands, so key
+        // generation allocates per level of array nesting rather than per array member.
+        void getKeysImplWithArray(std::vector<const char*>* fieldNames,
+                                  std::vector<BSONElement>* fixed,
                                   const BSONObj &obj, BSONObjSet *keys, unsigned numNotFound,
                                   const BSONObj &array) const;
         /**
@@ -103,10 +106,14 @@ namespace mongo {
          */
         BSONElement extractNextElement(const BSONObj &obj, const BSONObj &arr, const char *&field,
                                        bool &arrayNestedArray ) const;
-        void _getKeysArrEltFixed(std::vector<const char*> &fieldNames, std::vector<BSONElement> &fixed,
+        void _getKeysArrEltFixed(const std::vector<const char*> &fieldNames,
+                                 std::vector<BSONElement> &fixed,
                                  const BSONElement &arrEntry, BSONObjSet *keys,
                                  unsigned numNotFound, const BSONElement &arrObjElt,
-                                 const std::set<unsigned> &arrIdxs, bool mayExpandArrayUnembedded) const;
+                                 const std::vector<unsigned> &arrIdxs,
+                                 bool mayExpandArrayUnembedded,
+                                 std::vector<const char*>* childFieldNames,
+                                 std::vector<BSONElement>* childFixed) const;
 
         BSONObj _undefinedObj;
         BSONElement _undefinedElt;
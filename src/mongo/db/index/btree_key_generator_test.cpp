@@ -593,4 +593,16 @@ namespace {
         ASSERT(testKeygen(keyPattern, genKeysFrom, expectedKeys));
     }
 
+    // Each array member starts from the same state, whatever the previous member filled in.
+    TEST(BtreeKeyGeneratorTest, GetKeysArrayMembersAreIndependent) {
+        BSONObj keyPattern = fromjson("{'a.b': 1, 'a.c': 1}");
+        BSONObj genKeysFrom = fromjson("{a: [{b: 1, c: 2}, {b: 3}, {c: 4}, {}]}");
+        BSONObjSet expectedKeys;
+        expectedKeys.insert(fromjson("{'': 1, '': 2}"));
+        expectedKeys.insert(fromjson("{'': 3, '': null}"));
+        expectedKeys.insert(fromjson("{'': null, '': 4}"));
+        expectedKeys.insert(fromjson("{'': null, '': null}"));
+        ASSERT(testKeygen(keyPattern, genKeysFrom, expectedKeys));
+    }
+
 } // namespace
@@ -30,6 +30,8 @@
 
 #include "mongo/db/index/expression_keys_private.h"
 
+#include <boost/thread/tss.hpp>
+#include <cstring>
 #include <utility>
 
 #include "mongo/db/fts/fts_index_format.h"
@@ -41,6 +43,7 @@
 #include "mongo/db/index_names.h"
 #include "mongo/db/index/2d_common.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "third_party/s2/s2cell.h"
@@ -84,17 +87,130 @@ namespace {
         }
     }
 
+    /**
+     * The covering of a point is the cell at the finest indexed level which contains it, which
+     * is the ancestor of the point's leaf cell at that level.  No coverer is needed to find it.
+     */
+    static void S2KeysFromPoint(const PointWithCRS& point, const S2IndexingParams& params,
+                                vector<string>* out) {
+        out->push_back(point.cell.id().parent(params.finestIndexedLevel).toString());
+
+        if (debug) {
+            S2RegionCoverer coverer;
+            params.configureCoverer(&coverer);
+            vector<string> covering;
+            S2KeysFromRegion(&coverer, point.cell, &covering);
+            dassert(covering.size() == 1 && covering[0] == out->back());
+        }
+    }
+
+    /**
+     * Remembers the cells of the last few geometries other than points indexed on this thread.
+     * A batch of inserts often carries the same shape many times over, and its covering is
+     * expensive to compute.
+     */
+    class S2CoveringCache {
+    public:
+        S2CoveringCache() : _next(0) { }
+
+        static S2CoveringCache* get();
+
+        bool find(const BSONElement& element, const S2IndexingParams& params,
+                  vector<string>* out) const {
+            for (size_t i = 0; i < _entries.size(); ++i) {
+                if (_entries[i].matches(element, params)) {
+                    out->insert(out->end(), _entries[i].cells.begin(), _entries[i].cells.end());
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void add(const BSONElement& element, const S2IndexingParams& params,
+                 const vector<string>& cells) {
+            if (element.valuesize() > kMaxGeometrySize) {
+                return;
+            }
+
+            Entry entry;
+            entry.type = element.type();
+            entry.geometry.assign(element.value(), element.valuesize());
+            entry.coarsestIndexedLevel = params.coarsestIndexedLevel;
+            entry.finestIndexedLevel = params.finestIndexedLevel;
+            entry.maxCellsInCovering = params.maxCellsInCovering;
+            entry.indexVersion = params.indexVersion;
+            entry.cells = cells;
+
+            if (_entries.size() < kMaxEntries) {
+                _entries.push_back(entry);
+            }
+            else {
+                _entries[_next].swap(entry);
+                _next = (_next + 1) % kMaxEntries;
+            }
+        }
+
+    private:
+        static const size_t kMaxEntries = 8;
+        static const int kMaxGeometrySize = 16 * 1024;
+
+        struct Entry {
+            bool matches(const BSONElement& element, const S2IndexingParams& params) const {
+                return type == element.type()
+                    && static_cast<int>(geometry.size()) == element.valuesize()
+                    && 0 == memcmp(geometry.data(), element.value(), geometry.size())
+                    && coarsestIndexedLevel == params.coarsestIndexedLevel
+                    && finestIndexedLevel == params.finestIndexedLevel
+                    && maxCellsInCovering == params.maxCellsInCovering
+                    && indexVersion == params.indexVersion;
+            }
+
+            void swap(Entry& other) {
+                std::swap(type, other.type);
+                geometry.swap(other.geometry);
+                std::swap(coarsestIndexedLevel, other.coarsestIndexedLevel);
+                std::swap(finestIndexedLevel, other.finestIndexedLevel);
+                std::swap(maxCellsInCovering, other.maxCellsInCovering);
+                std::swap(indexVersion, other.indexVersion);
+                cells.swap(other.cells);
+            }
+
+            BSONType type;
+            string geometry;
+            int coarsestIndexedLevel;
+            int finestIndexedLevel;
+            int maxCellsInCovering;
+            S2IndexVersion indexVersion;
+            vector<string> cells;
+        };
+
+        vector<Entry> _entries;
+        size_t _next;
+    };
+
+    boost::thread_specific_ptr<S2CoveringCache> threadCoveringCache;
+
+    S2CoveringCache* S2CoveringCache::get() {
+        S2CoveringCache* cache = threadCoveringCache.get();
+        if (NULL == cache) {
+            cache = new S2CoveringCache();
+            threadCoveringCache.reset(cache);
+        }
+        return cache;
+    }
 
     Status S2GetKeysForElement(const BSONElement& element,
                             const S2IndexingParams& params,
                             vector<string>* out) {
+        S2CoveringCache* cache = S2CoveringCache::get();
+        if (cache->find(element, params, out)) {
+            return Status::OK();
+        }
+
         GeometryContainer geoContainer;
         Status status = geoContainer.parseFromStorage(element);
         if (!status.isOK()) return status;
 
-        S2RegionCoverer coverer;
-        params.configureCoverer(&coverer);
-
         // Don't index big polygon
         if (geoContainer.getNativeCRS() == STRICT_SPHERE) {
             return Status(ErrorCodes::BadValue, "can't index geometry with strict winding order");
@@ -118,7 +234,18 @@ namespace {
 
         invariant(geoContainer.hasS2Region());
 
-        S2KeysFromRegion(&coverer, geoContainer.getS2Region(), out);
+        if (geoContainer.isPoint()) {
+            // Cheaper to recompute than to look up, so points are not cached.
+            S2KeysFromPoint(geoContainer.getPoint(), params, out);
+            return Status::OK();
+        }
+
+        vector<string> cells;
+        S2RegionCoverer coverer;
+        params.configureCoverer(&coverer);
+        S2KeysFromRegion(&coverer, geoContainer.getS2Region(), &cells);
+        cache->add(element, params, cells);
+        out->insert(out->end(), cells.begin(), cells.end());
         return Status::OK();
     }
 
@@ -283,7 +410,8 @@ namespace mongo {
                     else continue;
                 }
 
-                params.geoHashConverter->hash(locObj, &obj).appendHashMin(&b, "");
+                const GeoHashConverter& converter = *params.geoHashConverter;
+                converter.toKeyOrder(converter.hash(locObj, &obj)).appendHashMin(&b, "");
 
                 // Go through all the other index keys
                 for (vector<pair<string, int> >::const_iterator i = params.other.begin();
@@ -348,8 +476,9 @@ namespace mongo {
     long long int ExpressionKeysPrivate::makeSingleHashKey(const BSONElement& e,
                                                            HashSeed seed,
                                                            int v) {
-        massert(16767, "Only HashVersion 0 has been defined" , v == 0 );
-        return BSONElementHasher::hash64(e, seed);
+        massert(16767, "Only HashVersions 0 and 1 have been defined",
+                BSONElementHasher::isValidHashVersion(v));
+        return BSONElementHasher::hash64(e, seed, v);
     }
 
     // static
@@ -30,6 +30,7 @@
 #include "mongo/db/index/expression_keys_private.h"
 #include "mongo/db/index/expression_params.h"
 #include "mongo/db/index/hash_access_method.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -49,6 +50,10 @@ namespace mongo {
                                           &_seed,
                                           &_hashVersion,
                                           &_hashedField);
+
+        uassert(28631, str::stream() << "Unsupported hashVersion " << _hashVersion
+                                     << " for hashed index, must be 0 or 1",
+                BSONElementHasher::isValidHashVersion(_hashVersion));
     }
 
     void HashAccessMethod::getKeys(const BSONObj& obj, BSONObjSet* keys) {
@@ -32,7 +32,9 @@
 
 #include "mongo/db/index/haystack_access_method.h"
 
+#include <algorithm>
 #include <boost/scoped_ptr.hpp>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/db/geo/hash.h"
@@ -46,6 +48,9 @@
 namespace mongo {
 
     using boost::scoped_ptr;
+    using std::make_pair;
+    using std::pair;
+    using std::vector;
 
     HaystackAccessMethod::HaystackAccessMethod(IndexCatalogEntry* btreeState, SortedDataInterface* btree)
         : BtreeBasedAccessMethod(btreeState, btree) {
@@ -61,6 +66,17 @@ namespace mongo {
         uassert(16774, "no non-geo fields specified", _otherFields.size());
     }
 
+    double HaystackAccessMethod::distanceToHaystackBucket(double nearX, double nearY,
+                                                          int hashedX, int hashedY) const {
+        // Bucket i holds the coordinates in [i * bucketSize - 180, (i + 1) * bucketSize - 180),
+        // see ExpressionKeysPrivate::hashHaystackElement.
+        double minX = hashedX * _bucketSize - 180;
+        double minY = hashedY * _bucketSize - 180;
+        double dx = std::max(0.0, std::max(minX - nearX, nearX - (minX + _bucketSize)));
+        double dy = std::max(0.0, std::max(minY - nearY, nearY - (minY + _bucketSize)));
+        return sqrt(dx * dx + dy * dy);
+    }
+
     void HaystackAccessMethod::getKeys(const BSONObj& obj, BSONObjSet* keys) {
         ExpressionKeysPrivate::getHaystackKeys(obj, _geoField, _otherFields, _bucketSize, keys);
     }
@@ -73,51 +89,68 @@ namespace mongo {
 
         LOG(1) << "SEARCH near:" << nearObj << " maxDistance:" << maxDistance
                << " search: " << search << endl;
+        double nearX, nearY;
         int x, y;
         {
             BSONObjIterator i(nearObj);
-            x = ExpressionKeysPrivate::hashHaystackElement(i.next(), _bucketSize);
-            y = ExpressionKeysPrivate::hashHaystackElement(i.next(), _bucketSize);
+            BSONElement xElt = i.next();
+            BSONElement yElt = i.next();
+            x = ExpressionKeysPrivate::hashHaystackElement(xElt, _bucketSize);
+            y = ExpressionKeysPrivate::hashHaystackElement(yElt, _bucketSize);
+            nearX = xElt.numberDouble();
+            nearY = yElt.numberDouble();
         }
         int scale = static_cast<int>(ceil(maxDistance / _bucketSize));
 
+        // Only buckets that may hold points within maxDistance are scanned, nearest first, so
+        // that a limited search fills up with the closest matches and stops early.
+        vector<pair<double, pair<int, int> > > buckets;
+        for (int a = -scale; a <= scale; ++a) {
+            for (int b = -scale; b <= scale; ++b) {
+                const double distance = distanceToHaystackBucket(nearX, nearY, x + a, y + b);
+                if (distance <= maxDistance) {
+                    buckets.push_back(make_pair(distance, make_pair(x + a, y + b)));
+                }
+            }
+        }
+        std::sort(buckets.begin(), buckets.end());
+
         GeoHaystackSearchHopper hopper(txn, nearObj, maxDistance, limit, _geoField, collection);
 
         long long btreeMatches = 0;
 
-        for (int a = -scale; a <= scale && !hopper.limitReached(); ++a) {
-            for (int b = -scale; b <= scale && !hopper.limitReached(); ++b) {
-                BSONObjBuilder bb;
-                bb.append("", ExpressionKeysPrivate::makeHaystackString(x + a, y + b));
-
-                for (unsigned i = 0; i < _otherFields.size(); i++) {
-                    // See if the non-geo field we're indexing on is in the provided search term.
-                    BSONElement e = search.getFieldDotted(_otherFields[i]);
-                    if (e.eoo())
-                        bb.appendNull("");
-                    else
-                        bb.appendAs(e, "");
-                }
+        for (size_t bucket = 0; bucket < buckets.size() && !hopper.limitReached(); ++bucket) {
+            BSONObjBuilder bb;
+            bb.append("", ExpressionKeysPrivate::makeHaystackString(buckets[bucket].second.first,
+                                                                    buckets[bucket].second.second));
+
+            for (unsigned i = 0; i < _otherFields.size(); i++) {
+                // See if the non-geo field we're indexing on is in the provided search term.
+                BSONElement e = search.getFieldDotted(_otherFields[i]);
+                if (e.eoo())
+                    bb.appendNull("");
+                else
+                    bb.appendAs(e, "");
+            }
+
+            BSONObj key = bb.obj();
+
+            unordered_set<RecordId, RecordId::Hasher> thisPass;
+
 
-                BSONObj key = bb.obj();
-
-                unordered_set<RecordId, RecordId::Hasher> thisPass;
-
-
-                scoped_ptr<PlanExecutor> exec(InternalPlanner::indexScan(txn,  collection,
-                                                                     _descriptor, key, key, true));
-                PlanExecutor::ExecState state;
-                RecordId loc;
-                while (PlanExecutor::ADVANCED == (state = exec->getNext(NULL, &loc))) {
-                    if (hopper.limitReached()) { break; }
-                    pair<unordered_set<RecordId, RecordId::Hasher>::iterator, bool> p
-                        = thisPass.insert(loc);
-                    // If a new element was inserted (haven't seen the RecordId before), p.second
-                    // is true.
-                    if (p.second) {
-                        hopper.consider(loc);
-                        btreeMatches++;
-                    }
+            scoped_ptr<PlanExecutor> exec(InternalPlanner::indexScan(txn,  collection,
+                                                                 _descriptor, key, key, true));
+            PlanExecutor::ExecState state;
+            RecordId loc;
+            while (PlanExecutor::ADVANCED == (state = exec->getNext(NULL, &loc))) {
+                if (hopper.limitReached()) { break; }
+                pair<unordered_set<RecordId, RecordId::Hasher>::iterator, bool> p
+                    = thisPass.insert(loc);
+                // If a new element was inserted (haven't seen the RecordId before), p.second
+                // is true.
+                if (p.second) {
+                    hopper.consider(loc);
+                    btreeMatches++;
                 }
             }
         }
@@ -70,6 +70,9 @@ namespace mongo {
     private:
         virtual void getKeys(const BSONObj& obj, BSONObjSet* keys);
 
+        // Returns the distance from (nearX, nearY) to the closest point of the given bucket
+        double distanceToHaystackBucket(double nearX, double nearY, int hashedX, int hashedY) const;
+
         std::string _geoField;
         std::vector<std::string> _otherFields;
         double _bucketSize;
@@ -74,6 +74,19 @@ namespace mongo {
                               const InsertDeleteOptions& options,
                               int64_t* numInserted) = 0;
 
+        /**
+         * Inserts the keys of several documents, where 'objs[i]' is at location 'locs[i]'.  The
+         * keys of all the documents are inserted in index order, which touches each part of the
+         * index once rather than once per document.  If any key can't be inserted, the keys
+         * inserted by this call are removed and the error is returned.  If not NULL,
+         * 'numInserted' will be set to the total number of keys added to the index.
+         */
+        virtual Status insertMany(OperationContext* txn,
+                                  const std::vector<BSONObj>& objs,
+                                  const std::vector<RecordId>& locs,
+                                  const InsertDeleteOptions& options,
+                                  int64_t* numInserted) = 0;
+
         /**
          * Analogous to above, but remove the records instead of inserting them.  If not NULL,
          * numDeleted will be set to the number of keys removed from the index for the document.
@@ -142,6 +155,13 @@ namespace mongo {
          */
         virtual Status touch(OperationContext* txn) const = 0;
 
+        /**
+         * Try to give the space the index no longer needs back to the filesystem, while the
+         * index stays usable.  Returns ErrorCodes::CommandNotSupported if the storage engine
+         * can't.
+         */
+        virtual Status compact(OperationContext* txn) = 0;
+
         /**
          * Walk the entire index, checking the internal structure for consistency.
          * Set numKeys to the number of keys in the index.
@@ -157,6 +177,13 @@ namespace mongo {
         virtual Status validate(OperationContext* txn, bool full, int64_t* numKeys,
                                 BSONObjBuilder* output) = 0;
 
+        /**
+         * Fills 'keys' with the keys this index has for the document 'obj', without looking at
+         * the index itself. Used by online validation to recompute what the index should hold.
+         * May be called from several threads at once.
+         */
+        virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) = 0;
+
         /**
          * Add custom statistics about this index to BSON object builder, for display.
          *
@@ -209,6 +236,20 @@ namespace mongo {
                                    bool mayInterrupt,
                                    bool dupsAllowed,
                                    std::set<RecordId>* dups ) = 0;
+
+        /**
+         * Starts recording the writes other operations make to this index instead of applying
+         * them, so that a bulk build of this index can run while the collection is modified.
+         * Writes are recorded when their unit of work commits.
+         */
+        virtual Status startSideWrites() = 0;
+
+        /**
+         * Applies the writes recorded since startSideWrites, in the order they were committed,
+         * and stops recording.  Call this after commitBulk, while holding a lock that keeps
+         * other writers out of the collection.
+         */
+        virtual Status drainSideWrites(OperationContext* txn) = 0;
     };
 
     /**
@@ -132,6 +132,12 @@ namespace mongo {
             return _collection->getIndexCatalog()->isMultikey( txn, this );
         }
 
+        // Which key pattern fields hold arrays, a bit per field?
+        unsigned long long getMultikeyPaths( OperationContext* txn ) const {
+            _checkOk();
+            return _collection->getIndexCatalog()->getMultikeyPaths( txn, this );
+        }
+
         bool isIdIndex() const { _checkOk(); return _isIdIndex; }
 
         //
@@ -66,10 +66,20 @@ namespace {
 } // namespace
 
     IndexBuilder::IndexBuilder(const BSONObj& index) :
-        BackgroundJob(true /* self-delete */), _index(index.getOwned()),
+        BackgroundJob(true /* self-delete */), _indexes(1, index.getOwned()),
         _name(str::stream() << "repl index builder " << _indexBuildCount.addAndFetch(1)) {
     }
 
+    IndexBuilder::IndexBuilder(const std::vector<BSONObj>& indexes) :
+        BackgroundJob(true /* self-delete */),
+        _name(str::stream() << "repl index builder " << _indexBuildCount.addAndFetch(1)) {
+        invariant(!indexes.empty());
+        for (size_t i = 0; i < indexes.size(); i++) {
+            invariant(indexes[i]["ns"].str() == indexes[0]["ns"].str());
+            _indexes.push_back(indexes[i].getOwned());
+        }
+    }
+
     IndexBuilder::~IndexBuilder() {}
 
     std::string IndexBuilder::name() const {
@@ -78,7 +88,8 @@ namespace {
 
     void IndexBuilder::run() {
         Client::initThread(name().c_str());
-        LOG(2) << "IndexBuilder building index " << _index;
+        LOG(2) << "IndexBuilder building " << _indexes.size() << " index(es), first: "
+               << _indexes[0];
 
         OperationContextImpl txn;
 
@@ -87,7 +98,7 @@ namespace {
         txn.getClient()->getAuthorizationSession()->grantInternalAuthorization();
 
         txn.getCurOp()->reset(HostAndPort(), dbInsert);
-        NamespaceString ns(_index["ns"].String());
+        NamespaceString ns(_indexes[0]["ns"].String());
 
         ScopedTransaction transaction(&txn, MODE_IX);
         Lock::DBLock dlk(txn.lockState(), ns.db(), MODE_X);
@@ -121,7 +132,7 @@ namespace {
                                 Database* db,
                                 bool allowBackgroundBuilding,
                                 Lock::DBLock* dbLock) const {
-        const NamespaceString ns(_index["ns"].String());
+        const NamespaceString ns(_indexes[0]["ns"].String());
 
         Collection* c = db->getCollection( ns.ns() );
         if ( !c ) {
@@ -132,7 +143,7 @@ namespace {
         }
 
         // Show which index we're building in the curop display.
-        txn->getCurOp()->setQuery(_index);
+        txn->getCurOp()->setQuery(_indexes[0]);
 
         MultiIndexBlock indexer(txn, c);
         indexer.allowInterruption();
@@ -140,10 +151,17 @@ namespace {
         if (allowBackgroundBuilding)
             indexer.allowBackgroundBuilding();
 
+        // A replayed oplog may ask for some of the indexes again.
+        std::vector<BSONObj> indexes(_indexes);
+        if (indexes.size() > 1) {
+            indexer.removeExistingIndexes(&indexes);
+        }
+
         Status status = Status::OK();
-        IndexDescriptor* descriptor(NULL);
+        std::vector<IndexDescriptor*> descriptors;
         try {
-            status = indexer.init(_index);
+            status = indexes.empty() ? Status(ErrorCodes::IndexAlreadyExists, "index(es) exist")
+                                     : indexer.init(indexes);
             if ( status.code() == ErrorCodes::IndexAlreadyExists ) {
                 if (allowBackgroundBuilding) {
                     // Must set this in case anyone is waiting for this build.
@@ -154,7 +172,7 @@ namespace {
 
             if (status.isOK()) {
                 if (allowBackgroundBuilding) {
-                    descriptor = indexer.registerIndexBuild();
+                    descriptors = indexer.registerIndexBuild();
                     _setBgIndexStarting();
                     invariant(dbLock);
                     dbLock->relockWithMode(MODE_IX);
@@ -182,7 +200,7 @@ namespace {
             Database* db = dbHolder().get(txn, ns.db());
             fassert(28553, db);
             fassert(28554, db->getCollection(ns.ns()));
-            indexer.unregisterIndexBuild(descriptor);
+            indexer.unregisterIndexBuild(descriptors);
         }
 
         if (status.code() == ErrorCodes::InterruptedAtShutdown) {
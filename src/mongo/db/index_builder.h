@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -59,10 +60,13 @@ namespace mongo {
      * ensured by the replication system, since commands are effectively run single-threaded
      * by the replication applier, and index builds are treated as commands even though they look
      * like inserts on system.indexes.
+     * Several indexes on the same collection may be given to one IndexBuilder, in which case
+     * they are all built with a single collection scan.
      */
     class IndexBuilder : public BackgroundJob {
     public:
         IndexBuilder(const BSONObj& index);
+        IndexBuilder(const std::vector<BSONObj>& indexes);
         virtual ~IndexBuilder();
 
         virtual void run();
@@ -103,7 +107,7 @@ namespace mongo {
                       bool allowBackgroundBuilding,
                       Lock::DBLock* dbLock) const;
 
-        const BSONObj _index;
+        std::vector<BSONObj> _indexes;
         std::string _name; // name of this builder, not related to the index
         static AtomicUInt32 _indexBuildCount;
     };
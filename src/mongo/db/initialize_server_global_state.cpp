@@ -50,6 +50,9 @@
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/auth/security_key.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/logger/async_log_writer.h"
+#include "mongo/logger/async_rotatable_file_appender.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logger/console_appender.h"
 #include "mongo/logger/message_event.h"
@@ -197,6 +200,12 @@ namespace mongo {
             quickExit(EXIT_FAILURE);
     }
 
+    // When non-zero, writes to the --logpath file happen on a separate thread, and this many bytes
+    // of log messages are buffered for it. What happens when the buffer is full is decided by
+    // logAsyncBlockWhenFull: either the logging thread waits, or the message is dropped.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(logAsyncBufferBytes, int, 0);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(logAsyncBlockWhenFull, bool, false);
+
     MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
                               ("GlobalLogManager", "EndStartupOptionHandling", "ForkServer"),
                               ("default"))(
@@ -206,6 +215,8 @@ namespace mongo {
         using logger::MessageEventEphemeral;
         using logger::MessageEventDetailsEncoder;
         using logger::MessageEventWithContextEncoder;
+        using logger::AsyncLogWriter;
+        using logger::AsyncRotatableFileAppender;
         using logger::MessageLogDomain;
         using logger::RotatableFileAppender;
         using logger::StatusWithRotatableFileWriter;
@@ -282,14 +293,32 @@ namespace mongo {
 
             LogManager* manager = logger::globalLogManager();
             manager->getGlobalDomain()->clearAppenders();
-            manager->getGlobalDomain()->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
-            manager->getNamedDomain("javascriptOutput")->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
+            if (logAsyncBufferBytes > 0) {
+                // Lives for the rest of the process, like the file writer
+                AsyncLogWriter* asyncWriter = new AsyncLogWriter(
+                        writer.getValue(),
+                        logAsyncBufferBytes,
+                        logAsyncBlockWhenFull ? AsyncLogWriter::kBlockWhenFull :
+                                                AsyncLogWriter::kDropWhenFull);
+                manager->getGlobalDomain()->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new AsyncRotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, asyncWriter)));
+                manager->getNamedDomain("javascriptOutput")->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new AsyncRotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, asyncWriter)));
+            }
+            else {
+                manager->getGlobalDomain()->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new RotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, writer.getValue())));
+                manager->getNamedDomain("javascriptOutput")->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new RotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, writer.getValue())));
+            }
 
             if (serverGlobalParams.logAppend && exists) {
                 log() << "***** SERVER RESTARTED *****" << endl;
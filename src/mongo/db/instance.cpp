@@ -42,9 +42,11 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/background.h"
+#include "mongo/db/catalog/capped_insert_notifier.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/fsync.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
@@ -79,7 +81,9 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/top.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/d_state.h"
@@ -90,6 +94,7 @@
 #include "mongo/util/gcov.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message_buffer_pool.h"
 #include "mongo/util/quick_exit.h"
 #include "mongo/util/time_support.h"
 
@@ -106,6 +111,11 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    static ServerStatusMetricField<Counter64> displayMessageBufferPoolHits(
+        "network.bufferPool.hits", &MessageBufferPool::hits);
+    static ServerStatusMetricField<Counter64> displayMessageBufferPoolMisses(
+        "network.bufferPool.misses", &MessageBufferPool::misses);
+
     // for diaglog
     inline void opread(Message& m) {
         if (_diaglog.getLevel() & 2) {
@@ -490,6 +500,14 @@ namespace mongo {
         currentOp.done();
         debug.executionTime = currentOp.totalTimeMillis();
 
+        if ( !fromDBDirectClient ) {
+            const string ns = currentOp.getNS();
+            Top::global.recordLatency( !ns.empty() ? ns : debug.ns.toString(),
+                                       op,
+                                       isCommand,
+                                       currentOp.totalTimeMicros() );
+        }
+
         logThreshold += currentOp.getExpectedLatencyMs();
 
         if ( shouldLog || debug.executionTime > logThreshold ) {
@@ -728,6 +746,27 @@ namespace mongo {
 
     QueryResult::View emptyMoreResult(long long);
 
+    /**
+     * Returns the insert notifier of the capped collection 'nss', or NULL if there is no such
+     * capped collection.
+     */
+    static boost::shared_ptr<CappedInsertNotifier> getCappedInsertNotifier(
+            OperationContext* txn,
+            const NamespaceString& nss) {
+        ScopedTransaction transaction(txn, MODE_IS);
+        AutoGetDb autoDb(txn, nss.db(), MODE_IS);
+        if (!autoDb.getDb()) {
+            return boost::shared_ptr<CappedInsertNotifier>();
+        }
+
+        Lock::CollectionLock collLock(txn->lockState(), nss.ns(), MODE_IS);
+        Collection* collection = autoDb.getDb()->getCollection(nss);
+        if (!collection) {
+            return boost::shared_ptr<CappedInsertNotifier>();
+        }
+        return collection->getCappedInsertNotifier();
+    }
+
     bool receivedGetMore(OperationContext* txn,
                          DbResponse& dbresponse,
                          Message& m,
@@ -749,8 +788,15 @@ namespace mongo {
         scoped_ptr<Timer> timer;
         int pass = 0;
         bool exhaust = false;
-        QueryResult::View msgdata = 0;
+        auto_ptr<Message> resp(new Message());
+        bool haveReply = false;
         OpTime last;
+
+        // Set once an awaitData getMore has found nothing, and from then on read before each
+        // further attempt, so that an insert committed during the attempt is never missed.
+        boost::shared_ptr<CappedInsertNotifier> notifier;
+        uint64_t notifierVersion = 0;
+
         while( 1 ) {
             bool isCursorAuthorized = false;
             try {
@@ -775,15 +821,16 @@ namespace mongo {
                     }
                 }
 
-                msgdata = getMore(txn,
-                                  ns,
-                                  ntoreturn,
-                                  cursorid,
-                                  curop,
-                                  pass,
-                                  exhaust,
-                                  &isCursorAuthorized,
-                                  fromDBDirectClient);
+                haveReply = getMore(txn,
+                                    ns,
+                                    ntoreturn,
+                                    cursorid,
+                                    curop,
+                                    pass,
+                                    exhaust,
+                                    &isCursorAuthorized,
+                                    fromDBDirectClient,
+                                    resp.get());
             }
             catch ( AssertionException& e ) {
                 if ( isCursorAuthorized ) {
@@ -799,7 +846,7 @@ namespace mongo {
                 break;
             }
             
-            if (msgdata.view2ptr() == 0) {
+            if (!haveReply) {
                 // this should only happen with QueryOption_AwaitData
                 exhaust = false;
                 massert(13073, "shutting down", !inShutdown() );
@@ -814,10 +861,29 @@ namespace mongo {
                     }
                 }
                 pass++;
-                if (debug)
-                    sleepmillis(20);
-                else
-                    sleepmillis(2);
+
+                if (notifier && notifier->isDead()) {
+                    // The collection object went away. Look it up again.
+                    notifier.reset();
+                }
+
+                if (!notifier) {
+                    // Try again right away with the version in hand. Cursors over something
+                    // other than a capped collection keep polling.
+                    notifier = getCappedInsertNotifier(txn, NamespaceString(ns));
+                    if (notifier) {
+                        notifierVersion = notifier->getVersion();
+                    }
+                    else {
+                        sleepmillis(2);
+                    }
+                }
+                else {
+                    const long long remainingMillis = 4000 - timer->millis();
+                    notifier->waitForInsert(notifierVersion,
+                                            remainingMillis > 0 ? remainingMillis : 0);
+                    notifierVersion = notifier->getVersion();
+                }
                 
                 // note: the 1100 is beacuse of the waitForDifferent above
                 // should eventually clean this up a bit
@@ -841,18 +907,21 @@ namespace mongo {
             return ok;
         }
 
-        Message *resp = new Message();
-        resp->setData(msgdata.view2ptr(), true);
         curop.debug().responseLength = resp->header().dataLen();
-        curop.debug().nreturned = msgdata.getNReturned();
+        curop.debug().nreturned = QueryResult::View(resp->header().view2ptr()).getNReturned();
 
-        dbresponse.response = resp;
+        dbresponse.response = resp.release();
         dbresponse.responseTo = m.header().getId();
 
         if( exhaust ) {
             curop.debug().exhaust = true;
             dbresponse.exhaustNS = ns;
         }
+        else if ( !fromDBDirectClient &&
+                  shouldPrefetchGetMore( QueryResult::View(
+                          dbresponse.response->header().view2ptr()).getCursorId() ) ) {
+            dbresponse.prefetchNS = ns;
+        }
 
         return ok;
     }
@@ -1155,6 +1224,7 @@ namespace mongo {
         audit::logShutdown(currentClient.get());
 
         log(LogComponent::kControl) << "dbexit: " << why << " rc: " << rc;
+        logger::AsyncLogWriter::flushAll();
 
 #ifdef _WIN32
         // Windows Service Controller wants to be told when we are down,
@@ -36,9 +36,16 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_set.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/profile_buffer.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -46,6 +53,18 @@ namespace mongo {
     using boost::scoped_ptr;
     using std::endl;
     using std::string;
+    using std::vector;
+
+    // When non-zero, profiled operations are kept in an in-memory buffer of this many documents
+    // instead of being written to system.profile.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(profileBufferSize, int, 0);
+
+    // Fraction of the operations selected by the profiling level that are recorded in the
+    // profile buffer.  Ignored when profiled operations go straight to system.profile.
+    MONGO_EXPORT_SERVER_PARAMETER(profileSampleRate, double, 1.0);
+
+    // How often buffered profile documents are moved to system.profile; 0 keeps them in memory.
+    MONGO_EXPORT_SERVER_PARAMETER(profileBufferOffloadSecs, int, 0);
 
 namespace {
 
@@ -77,10 +96,139 @@ namespace {
 
     }
 
+    /**
+     * Inserts 'p' into the system.profile collection of 'dbName', creating the collection if it
+     * is missing and that is safe to do without lock conversion.  'wasLocked' tells whether the
+     * caller already held locks when the operation was profiled.
+     */
+    void _insertProfileDocument(OperationContext* txn,
+                                const string& dbName,
+                                const BSONObj& p,
+                                bool wasLocked) {
+        bool acquireDbXLock = false;
+        while (true) {
+            ScopedTransaction scopedXact(txn, MODE_IX);
+
+            boost::scoped_ptr<AutoGetDb> autoGetDb;
+            if (acquireDbXLock) {
+                autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_X));
+                if (autoGetDb->getDb()) {
+                    createProfileCollection(txn, autoGetDb->getDb());
+                }
+            }
+            else {
+                autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_IX));
+            }
+
+            Database* const db = autoGetDb->getDb();
+            if (!db) {
+                // Database disappeared
+                log() << "note: not profiling because db went away for " << dbName;
+                break;
+            }
+
+            Lock::CollectionLock collLock(txn->lockState(), db->getProfilingNS(), MODE_IX);
+
+            Collection* const coll = db->getCollection(db->getProfilingNS());
+            if (coll) {
+                WriteUnitOfWork wuow(txn);
+                coll->insertDocument(txn, p, false);
+                wuow.commit();
+
+                break;
+            }
+            else if (!acquireDbXLock &&
+                        (!wasLocked || txn->lockState()->isDbLockedForMode(dbName, MODE_X))) {
+                // Try to create the collection only if we are not under lock, in order to
+                // avoid deadlocks due to lock conversion. This would only be hit if someone
+                // deletes the profiler collection after setting profile level.
+                acquireDbXLock = true;
+            }
+            else {
+                // Cannot write the profile information
+                break;
+            }
+        }
+    }
+
+    size_t _shardHintFor(OperationContext* txn) {
+        // Each connection has its own Client, so connections spread over the buffer's shards.
+        // The low bits of the pointer are the same for every Client; drop them.
+        return reinterpret_cast<size_t>(txn->getClient()) >> 4;
+    }
+
+    class ProfileBufferOffloader : public BackgroundJob {
+    public:
+        virtual string name() const { return "ProfileBufferOffloader"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            cc().getAuthorizationSession()->grantInternalAuthorization();
+
+            ProfileBuffer* const buffer = getProfileBuffer();
+            vector<ProfileBuffer::Entry> entries;
+            while (!inShutdown()) {
+                const int offloadSecs = profileBufferOffloadSecs;
+                sleepsecs(offloadSecs > 0 ? offloadSecs : 1);
+                if (offloadSecs <= 0 || lockedForWriting()) {
+                    continue;
+                }
+
+                entries.clear();
+                buffer->drain(&entries);
+                if (entries.empty()) {
+                    continue;
+                }
+
+                LOG(2) << "moving " << entries.size() << " buffered profile documents to "
+                       << "system.profile";
+
+                OperationContextImpl txn;
+                for (size_t i = 0; i < entries.size() && !inShutdown(); i++) {
+                    try {
+                        _insertProfileDocument(&txn, entries[i].dbName, entries[i].doc, false);
+                    }
+                    catch (const DBException& ex) {
+                        warning() << "Caught exception while moving a buffered profile document "
+                                  << "to " << entries[i].dbName << ".system.profile: "
+                                  << ex.toString();
+                    }
+                }
+            }
+
+            cc().shutdown();
+        }
+    };
+
 } // namespace
 
 
+    ProfileBuffer* getProfileBuffer() {
+        if (profileBufferSize <= 0) {
+            return NULL;
+        }
+
+        // Created on first use so that the startup parameter has already been parsed.
+        static ProfileBuffer* const buffer = new ProfileBuffer(profileBufferSize);
+        return buffer;
+    }
+
+    void startProfileBufferOffloader() {
+        if (!getProfileBuffer()) {
+            return;
+        }
+
+        ProfileBufferOffloader* offloader = new ProfileBufferOffloader();
+        offloader->go();
+    }
+
     void profile(OperationContext* txn, int op) {
+        ProfileBuffer* const buffer = getProfileBuffer();
+        const size_t shardHint = _shardHintFor(txn);
+        if (buffer && !buffer->sample(shardHint, profileSampleRate)) {
+            return;
+        }
+
         // Initialize with 1kb at start in order to avoid realloc later
         BufBuilder profileBufBuilder(1024);
 
@@ -96,56 +244,17 @@ namespace {
 
         const BSONObj p = b.done();
 
-        const bool wasLocked = txn->lockState()->isLocked();
-
         const string dbName(nsToDatabase(txn->getCurOp()->getNS()));
 
-        try {
-            bool acquireDbXLock = false;
-            while (true) {
-                ScopedTransaction scopedXact(txn, MODE_IX);
-
-                boost::scoped_ptr<AutoGetDb> autoGetDb;
-                if (acquireDbXLock) {
-                    autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_X));
-                    if (autoGetDb->getDb()) {
-                        createProfileCollection(txn, autoGetDb->getDb());
-                    }
-                }
-                else {
-                    autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_IX));
-                }
-
-                Database* const db = autoGetDb->getDb();
-                if (!db) {
-                    // Database disappeared
-                    log() << "note: not profiling because db went away for "
-                          << txn->getCurOp()->getNS();
-                    break;
-                }
-
-                Lock::CollectionLock collLock(txn->lockState(), db->getProfilingNS(), MODE_IX);
+        if (buffer) {
+            buffer->append(shardHint, dbName, p);
+            return;
+        }
 
-                Collection* const coll = db->getCollection(db->getProfilingNS());
-                if (coll) {
-                    WriteUnitOfWork wuow(txn);
-                    coll->insertDocument(txn, p, false);
-                    wuow.commit();
+        const bool wasLocked = txn->lockState()->isLocked();
 
-                    break;
-                }
-                else if (!acquireDbXLock &&
-                            (!wasLocked || txn->lockState()->isDbLockedForMode(dbName, MODE_X))) {
-                    // Try to create the collection only if we are not under lock, in order to
-                    // avoid deadlocks due to lock conversion. This would only be hit if someone
-                    // deletes the profiler collection after setting profile level.
-                    acquireDbXLock = true;
-                }
-                else {
-                    // Cannot write the profile information
-                    break;
-                }
-            }
+        try {
+            _insertProfileDocument(txn, dbName, p, wasLocked);
         }
         catch (const AssertionException& assertionEx) {
             warning() << "Caught Assertion while trying to profile "
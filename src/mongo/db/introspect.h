@@ -34,6 +34,7 @@ namespace mongo {
 
     class Database;
     class OperationContext;
+    class ProfileBuffer;
 
     /**
      * Invoked when database profile is enabled.
@@ -45,4 +46,16 @@ namespace mongo {
      */
     Status createProfileCollection(OperationContext* txn, Database *db);
 
+    /**
+     * Returns the in-memory buffer profiled operations are recorded into, or NULL when they are
+     * written to system.profile directly (profileBufferSize is 0).
+     */
+    ProfileBuffer* getProfileBuffer();
+
+    /**
+     * Starts the thread that moves buffered profile documents to system.profile every
+     * profileBufferOffloadSecs.  Does nothing unless the profile buffer is enabled.
+     */
+    void startProfileBufferOffloader();
+
 } // namespace mongo
@@ -30,6 +30,7 @@
 #include "mongo/db/json.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <cstring>
 
 #include "mongo/base/parse_number.h"
 #include "mongo/db/jsobj.h"
@@ -64,8 +65,8 @@ namespace mongo {
         ID_RESERVE_SIZE = 64,
         PAT_RESERVE_SIZE = 4096,
         OPT_RESERVE_SIZE = 64,
-        FIELD_RESERVE_SIZE = 4096,
-        STRINGVAL_RESERVE_SIZE = 4096,
+        FIELD_RESERVE_SIZE = 64,
+        STRINGVAL_RESERVE_SIZE = 64,
         BINDATA_RESERVE_SIZE = 4096,
         BINDATATYPE_RESERVE_SIZE = 4096,
         NS_RESERVE_SIZE = 64,
@@ -86,6 +87,70 @@ namespace mongo {
                  *SINGLEQUOTE = "'",
                  *DOUBLEQUOTE = "\"";
 
+namespace {
+    // Longest part of the input repeated in a parse error message
+    const std::ptrdiff_t kMaxErrorContext = 4096;
+
+    // Characters allowed in an unquoted field name, as a lookup table
+    class FieldCharTable {
+    public:
+        FieldCharTable() {
+            memset(_allowed, 0, sizeof(_allowed));
+            for (const char* c = ALPHA DIGIT "_$"; *c; ++c) {
+                _allowed[static_cast<unsigned char>(*c)] = true;
+            }
+        }
+
+        bool operator()(char c) const { return _allowed[static_cast<unsigned char>(c)]; }
+
+    private:
+        bool _allowed[256];
+    };
+
+    const FieldCharTable isFieldChar;
+
+    inline uint64_t loadWord(const char* p) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        return word;
+    }
+
+    const uint64_t kOnes = 0x0101010101010101ULL;
+    const uint64_t kHighBits = 0x8080808080808080ULL;
+
+    // Whether 'word' has a zero byte, or a byte less than 'n' (n <= 128)
+    inline bool hasZeroByte(uint64_t word) {
+        return (word - kOnes) & ~word & kHighBits;
+    }
+    inline bool hasByteLessThan(uint64_t word, unsigned char n) {
+        return (word - kOnes * n) & ~word & kHighBits;
+    }
+
+    /**
+     * Returns the first character in [p, end) that a quoted string cannot take as is: the
+     * closing 'quote', a backslash or a control character.  Returns 'end' if there is none.
+     *
+     * Checks eight characters at a time, so that the plain runs that make up most strings
+     * are copied in one go.
+     */
+    const char* findStringSpecialChar(const char* p, const char* end, char quote) {
+        const uint64_t quotes = kOnes * static_cast<unsigned char>(quote);
+        const uint64_t backslashes = kOnes * static_cast<unsigned char>('\\');
+        while (end - p >= static_cast<std::ptrdiff_t>(sizeof(uint64_t))) {
+            const uint64_t word = loadWord(p);
+            if (hasZeroByte(word ^ quotes) || hasZeroByte(word ^ backslashes) ||
+                    hasByteLessThan(word, 0x20)) {
+                break;
+            }
+            p += sizeof(uint64_t);
+        }
+        while (p < end && *p != quote && *p != '\\' && !(0x00 <= *p && *p <= 0x1F)) {
+            ++p;
+        }
+        return p;
+    }
+} // namespace
+
     JParse::JParse(const StringData& str)
         : _buf(str.rawData())
         , _input(_buf)
@@ -98,73 +163,81 @@ namespace mongo {
         ossmsg << ": offset:";
         ossmsg << offset();
         ossmsg << " of:";
-        ossmsg << _buf;
+        if (_input_end - _buf > kMaxErrorContext) {
+            ossmsg << StringData(_buf, kMaxErrorContext) << "...";
+        }
+        else {
+            ossmsg << _buf;
+        }
         return Status(ErrorCodes::FailedToParse, ossmsg.str());
     }
 
     Status JParse::value(const StringData& fieldName, BSONObjBuilder& builder) {
         MONGO_JSON_DEBUG("fieldName: " << fieldName);
-        if (peekToken(LBRACE)) {
+        // Only the tokens starting with the next character can match, so most values skip
+        // straight to the right case.
+        const char c = peekChar();
+        if (c == '{' && peekToken(LBRACE)) {
             Status ret = object(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (peekToken(LBRACKET)) {
+        else if (c == '[' && peekToken(LBRACKET)) {
             Status ret = array(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (readToken("new")) {
+        else if (c == 'n' && readToken("new")) {
             Status ret = constructor(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (readToken("Date")) {
+        else if (c == 'D' && readToken("Date")) {
             Status ret = date(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (readToken("Timestamp")) {
+        else if (c == 'T' && readToken("Timestamp")) {
             Status ret = timestamp(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (readToken("ObjectId")) {
+        else if (c == 'O' && readToken("ObjectId")) {
             Status ret = objectId(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (readToken("NumberLong")) {
+        else if (c == 'N' && readToken("NumberLong")) {
             Status ret = numberLong(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (readToken("NumberInt")) {
+        else if (c == 'N' && readToken("NumberInt")) {
             Status ret = numberInt(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (readToken("Dbref") || readToken("DBRef")) {
+        else if (c == 'D' && (readToken("Dbref") || readToken("DBRef"))) {
             Status ret = dbRef(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (peekToken(FORWARDSLASH)) {
+        else if (c == '/' && peekToken(FORWARDSLASH)) {
             Status ret = regex(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
             }
         }
-        else if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
+        else if (c == '"' || c == '\'') {
             std::string valueString;
             valueString.reserve(STRINGVAL_RESERVE_SIZE);
             Status ret = quotedString(&valueString);
@@ -173,25 +246,25 @@ namespace mongo {
             }
             builder.append(fieldName, valueString);
         }
-        else if (readToken("true")) {
+        else if (c == 't' && readToken("true")) {
             builder.append(fieldName, true);
         }
-        else if (readToken("false")) {
+        else if (c == 'f' && readToken("false")) {
             builder.append(fieldName, false);
         }
-        else if (readToken("null")) {
+        else if (c == 'n' && readToken("null")) {
             builder.appendNull(fieldName);
         }
-        else if (readToken("undefined")) {
+        else if (c == 'u' && readToken("undefined")) {
             builder.appendUndefined(fieldName);
         }
-        else if (readToken("NaN")) {
+        else if (c == 'N' && readToken("NaN")) {
             builder.append(fieldName, std::numeric_limits<double>::quiet_NaN());
         }
-        else if (readToken("Infinity")) {
+        else if (c == 'I' && readToken("Infinity")) {
             builder.append(fieldName, std::numeric_limits<double>::infinity());
         }
-        else if (readToken("-Infinity")) {
+        else if (c == '-' && readToken("-Infinity")) {
             builder.append(fieldName, -std::numeric_limits<double>::infinity());
         }
         else {
@@ -979,6 +1052,13 @@ namespace mongo {
     }
 
     Status JParse::number(const StringData& fieldName, BSONObjBuilder& builder) {
+        if (integer(fieldName, builder)) {
+            if (_input >= _input_end) {
+                return parseError("Trailing number at end of input");
+            }
+            return Status::OK();
+        }
+
         char* endptrll;
         char* endptrd;
         long long retll;
@@ -1024,6 +1104,41 @@ namespace mongo {
         return Status::OK();
     }
 
+    bool JParse::integer(const StringData& fieldName, BSONObjBuilder& builder) {
+        // Skip whitespace as strtod would
+        const char* p = _input;
+        while (p < _input_end && isspace(*reinterpret_cast<const unsigned char*>(p))) {
+            ++p;
+        }
+        const bool negative = p < _input_end && *p == '-';
+        if (negative) {
+            ++p;
+        }
+
+        // Up to 18 digits always fit in a long long
+        const char* const digits = p;
+        long long value = 0;
+        while (p < _input_end && p - digits < 18 && '0' <= *p && *p <= '9') {
+            value = value * 10 + (*p++ - '0');
+        }
+        if (p == digits || (p < _input_end && *p != '\0' &&
+                                      strchr(DIGIT ".eExX", *p) != NULL)) {
+            return false;
+        }
+
+        if (negative) {
+            value = -value;
+        }
+        if (value == static_cast<int>(value)) {
+            builder.append(fieldName, static_cast<int>(value));
+        }
+        else {
+            builder.append(fieldName, value);
+        }
+        _input = p;
+        return true;
+    }
+
     Status JParse::field(std::string* result) {
         MONGO_JSON_DEBUG("");
         if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
@@ -1046,7 +1161,16 @@ namespace mongo {
             if (!match(*_input, ALPHA "_$")) {
                 return parseError("First character in field must be [A-Za-z$_]");
             }
-            return chars(result, "", ALPHA DIGIT "_$");
+            const char* q = _input;
+            while (q < _input_end && isFieldChar(*q)) {
+                ++q;
+            }
+            if (q >= _input_end) {
+                return parseError("Unexpected end of input");
+            }
+            result->append(_input, q - _input);
+            _input = q;
+            return Status::OK();
         }
     }
 
@@ -1086,9 +1210,20 @@ namespace mongo {
         if (_input >= _input_end) {
             return parseError("Unexpected end of input");
         }
+        // A quoted string ends at a single terminal character, and can copy runs of plain
+        // characters without checking each against the character sets.
+        const bool quoted = allowedSet == NULL && terminalSet[0] != '\0' && terminalSet[1] == '\0';
         const char* q = _input;
         while (q < _input_end && !match(*q, terminalSet)) {
             MONGO_JSON_DEBUG("q: " << q);
+            if (quoted) {
+                const char* special = findStringSpecialChar(q, _input_end, terminalSet[0]);
+                if (special != q) {
+                    result->append(q, special - q);
+                    q = special;
+                    continue;
+                }
+            }
             if (allowedSet != NULL) {
                 if (!match(*q, allowedSet)) {
                     _input = q;
@@ -1175,6 +1310,14 @@ namespace mongo {
         return oss.str();
     }
 
+    inline char JParse::peekChar() const {
+        const char* check = _input;
+        while (check < _input_end && isspace(*reinterpret_cast<const unsigned char*>(check))) {
+            ++check;
+        }
+        return check < _input_end ? *check : '\0';
+    }
+
     inline bool JParse::peekToken(const char* token) {
         return readTokenImpl(token, false);
     }
@@ -1284,6 +1427,41 @@ namespace mongo {
         return builder.obj();
     }
 
+    JSONStreamParser::JSONStreamParser(const char* json)
+        : _json(json)
+        , _input(json)
+        , _inputEnd(json + strlen(json))
+    {}
+
+    bool JSONStreamParser::more() {
+        while (_input < _inputEnd && isspace(*reinterpret_cast<const unsigned char*>(_input))) {
+            ++_input;
+        }
+        return _input < _inputEnd;
+    }
+
+    Status JSONStreamParser::next(BufBuilder* buf, BSONObj* out) {
+        JParse jparse(StringData(_input, _inputEnd - _input));
+        buf->reset();
+        BSONObjBuilder builder(*buf);
+        Status ret = Status::OK();
+        try {
+            ret = jparse.parse(builder);
+        }
+        catch(std::exception& e) {
+            std::ostringstream message;
+            message << "caught exception from within JSON parser: " << e.what();
+            ret = Status(ErrorCodes::FailedToParse, message.str());
+        }
+        if (!ret.isOK()) {
+            return ret;
+        }
+
+        *out = BSONObj(builder.done());
+        _input += jparse.offset();
+        return Status::OK();
+    }
+
     BSONObj fromjson(const std::string& str) {
         return fromjson( str.c_str() );
     }
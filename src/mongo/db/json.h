@@ -31,6 +31,7 @@
 #include <string>
 
 #include "mongo/bson/bsonobj.h"
+#include "mongo/base/disallow_copying.h"
 #include "mongo/base/status.h"
 #include "mongo/client/export_macros.h"
 
@@ -96,6 +97,52 @@ namespace mongo {
         bool pretty = false
     );
 
+    /**
+     * Parses a stream of JSON documents, concatenated with optional whitespace between them,
+     * such as a mongoexport file.  Each document is built straight into a BufBuilder the
+     * caller reuses, so that once the buffer has grown to fit no memory is allocated per
+     * document.  The same extended JSON as fromjson is accepted.
+     *
+     * Example:
+     *  JSONStreamParser parser(json);
+     *  BufBuilder buf;
+     *  BSONObj doc;
+     *  while (parser.more()) {
+     *      uassertStatusOK(parser.next(&buf, &doc));
+     *      ...  // 'doc' points into 'buf'
+     *  }
+     */
+    class MONGO_CLIENT_API JSONStreamParser {
+        MONGO_DISALLOW_COPYING(JSONStreamParser);
+    public:
+        /**
+         * 'json' must be null terminated, and must outlive the parser.
+         */
+        explicit JSONStreamParser(const char* json);
+
+        /**
+         * @return true if there is anything but whitespace left in the input.
+         */
+        bool more();
+
+        /**
+         * Resets 'buf' and parses the next document into it.  On success 'out' is set to the
+         * document, which is only valid until 'buf' is next modified.  On failure the parser
+         * does not advance and the FailedToParse status gives the offset in the document.
+         */
+        Status next(BufBuilder* buf, BSONObj* out);
+
+        /**
+         * @return how far into the input the parser is.
+         */
+        int offset() const { return _input - _json; }
+
+    private:
+        const char* const _json;
+        const char* _input;
+        const char* const _inputEnd;
+    };
+
     /**
      * Parser class.  A BSONObj is constructed incrementally by passing a
      * BSONObjBuilder to the recursive parsing methods.  The grammar for the
@@ -350,6 +397,13 @@ namespace mongo {
              */
             Status number(const StringData& fieldName, BSONObjBuilder&);
 
+            /**
+             * Appends the next number if it is a plain integer of up to 18 digits, which is
+             * the common case and needs neither strtod nor strtoll.
+             * @return false, having consumed nothing, for any other number
+             */
+            bool integer(const StringData& fieldName, BSONObjBuilder&);
+
             /*
              * FIELD :
              *     STRING
@@ -414,6 +468,13 @@ namespace mongo {
              */
             std::string encodeUTF8(unsigned char first, unsigned char second) const;
 
+            /**
+             * @return the next non whitespace character in our buffer, or the
+             * null character at the end of our buffer.  Does not update the
+             * pointer to our buffer.
+             */
+            inline char peekChar() const;
+
             /**
              * @return true if the given token matches the next non whitespace
              * sequence in our buffer, and false if the token doesn't match or
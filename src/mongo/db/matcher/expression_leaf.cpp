@@ -48,6 +48,10 @@ namespace mongo {
 
 
     bool LeafMatchExpression::matches( const MatchableDocument* doc, MatchDetails* details ) const {
+        BSONElement single;
+        if ( doc->getSingleElement( &_elementPath, &single ) )
+            return matchesSingleElement( single );
+
         MatchableDocument::IteratorHolder cursor( doc, &_elementPath );
         while ( cursor->more() ) {
             ElementIterator::Context e = cursor->next();
@@ -105,6 +109,27 @@ namespace mongo {
         //log() << "\t ComparisonMatchExpression e: " << e << " _rhs: " << _rhs << "\n"
         //<< toString() << std::endl;
 
+        // Fast paths for the most common operand types, skipping the canonical type and NaN
+        // checks below that cannot matter for them.
+        if ( e.type() == _rhs.type() ) {
+            if ( e.type() == NumberInt ) {
+                int l = e._numberInt();
+                int r = _rhs._numberInt();
+                switch ( matchType() ) {
+                case LT: return l < r;
+                case LTE: return l <= r;
+                case EQ: return l == r;
+                case GT: return l > r;
+                case GTE: return l >= r;
+                default: break;
+                }
+            }
+            else if ( e.type() == String && matchType() == EQ ) {
+                return e.valuestrsize() == _rhs.valuestrsize() &&
+                    memcmp( e.valuestr(), _rhs.valuestr(), e.valuestrsize() ) == 0;
+            }
+        }
+
         if ( e.canonicalType() != _rhs.canonicalType() ) {
             // some special cases
             //  jstNULL and undefined are treated the same
@@ -382,6 +407,10 @@ namespace mongo {
     }
 
     bool TypeMatchExpression::matches( const MatchableDocument* doc, MatchDetails* details ) const {
+        BSONElement single;
+        if ( doc->getSingleElement( &_elementPath, &single ) )
+            return matchesSingleElement( single );
+
         MatchableDocument::IteratorHolder cursor( doc, &_elementPath );
         while ( cursor->more() ) {
             ElementIterator::Context e = cursor->next();
@@ -439,6 +468,9 @@ namespace mongo {
 
     // --------
 
+    // static
+    const size_t ArrayFilterEntries::kHashedEqualitiesMinSize;
+
     ArrayFilterEntries::ArrayFilterEntries(){
         _hasNull = false;
         _hasEmptyArray = false;
@@ -466,7 +498,15 @@ namespace mongo {
         if ( e.type() == Array && e.Obj().isEmpty() )
             _hasEmptyArray = true;
 
-        _equalities.insert( e );
+        if ( !_equalities.insert( e ).second )
+            return Status::OK();
+
+        if ( _equalities.size() == kHashedEqualitiesMinSize ) {
+            _hashedEqualities.insert( _equalities.begin(), _equalities.end() );
+        }
+        else if ( _equalities.size() > kHashedEqualitiesMinSize ) {
+            _hashedEqualities.insert( e );
+        }
         return Status::OK();
     }
 
@@ -492,6 +532,7 @@ namespace mongo {
         toFillIn._hasNull = _hasNull;
         toFillIn._hasEmptyArray = _hasEmptyArray;
         toFillIn._equalities = _equalities;
+        toFillIn._hashedEqualities = _hashedEqualities;
         for ( unsigned i = 0; i < _regexes.size(); i++ )
             toFillIn._regexes.push_back( static_cast<RegexMatchExpression*>(_regexes[i]->shallowClone()) );
     }
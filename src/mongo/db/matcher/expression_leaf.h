@@ -35,6 +35,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/platform/unordered_set.h"
 
 namespace pcrecpp {
     class RE;
@@ -100,6 +101,12 @@ namespace mongo {
 
         const BSONElement& getData() const { return _rhs; }
 
+        /**
+         * Replaces the operand with 'rhs', which must be of the same type. Used to bind the
+         * literal of a new query into a cached copy of an already canonicalized tree.
+         */
+        void rebindRHS( const BSONElement& rhs ) { _rhs = rhs; }
+
     protected:
         BSONElement _rhs;
     };
@@ -295,7 +302,11 @@ namespace mongo {
         Status addRegex( RegexMatchExpression* expr );
 
         const BSONElementSet& equalities() const { return _equalities; }
-        bool contains( const BSONElement& elem ) const { return _equalities.count(elem) > 0; }
+        bool contains( const BSONElement& elem ) const {
+            if ( _equalities.size() < kHashedEqualitiesMinSize )
+                return _equalities.count(elem) > 0;
+            return _hashedEqualities.count(elem) > 0;
+        }
 
         size_t numRegexes() const { return _regexes.size(); }
         RegexMatchExpression* regex( int idx ) const { return _regexes[idx]; }
@@ -314,9 +325,22 @@ namespace mongo {
         void toBSON(BSONArrayBuilder* out) const;
 
     private:
+        // Large $in lists, such as batched lookups by _id, also keep their equalities hashed so
+        // that each probe from a scan of many documents costs O(1).
+        static const size_t kHashedEqualitiesMinSize = 16;
+
+        struct ValueEquals {
+            bool operator()( const BSONElement& l, const BSONElement& r ) const {
+                return l.woCompare( r, false ) == 0;
+            }
+        };
+        typedef unordered_set<BSONElement, BSONElement::ValueHasher, ValueEquals>
+            HashedEqualities;
+
         bool _hasNull; // if _equalities has a jstNULL element in it
         bool _hasEmptyArray;
         BSONElementSet _equalities;
+        HashedEqualities _hashedEqualities; // same as _equalities once it is large enough
         std::vector<RegexMatchExpression*> _regexes;
     };
 
@@ -1478,6 +1478,37 @@ namespace mongo {
         ASSERT( !in.matchesSingleElement( notMatch[ "a" ] ) );
     }
 
+    TEST( InMatchExpression, MatchesElementLargeList ) {
+        BSONArrayBuilder bab;
+        for ( int i = 0; i < 1000; i += 2 ) {
+            bab.append( i );
+        }
+        bab.append( "r" );
+        bab.append( BSON( "b" << 1 ) );
+        bab.append( -0.0 );
+        BSONObj operand = bab.arr();
+
+        InMatchExpression in;
+        BSONObjIterator it( operand );
+        while ( it.more() ) {
+            in.getArrayFilterEntries()->addEquality( it.next() );
+        }
+        // -0.0 is the same value as 0
+        ASSERT_EQUALS( 502, in.getArrayFilterEntries()->size() );
+
+        // Numbers compare equal across types, as with a short list
+        ASSERT( in.matchesSingleElement( BSON( "a" << 998 ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "a" << 998LL ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "a" << 4.0 ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "a" << 0 ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "a" << 4.5 ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "a" << 999 ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "a" << "r" ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "a" << "s" ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "a" << BSON( "b" << 1.0 ) ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "a" << BSON( "c" << 1 ) ).firstElement() ) );
+    }
+
 
     TEST( InMatchExpression, MatchesScalar ) {
         BSONObj operand = BSON_ARRAY( 5 );
@@ -181,6 +181,41 @@ namespace mongo {
         ASSERT( !andOp.matchesBSON( BSON( "a" << 10 << "b" << 6 ), NULL ) );
     }
 
+    TEST( AndOp, MatchesClausesOnSameDottedPath ) {
+        BSONObj baseOperand1 = BSON( "$gte" << 1 );
+        BSONObj baseOperand2 = BSON( "$lt" << 10 );
+        BSONObj baseOperand3 = BSON( "$ne" << "x" );
+
+        auto_ptr<ComparisonMatchExpression> sub1( new GTEMatchExpression() );
+        ASSERT( sub1->init( "a.b", baseOperand1[ "$gte" ] ).isOK() );
+
+        auto_ptr<ComparisonMatchExpression> sub2( new LTMatchExpression() );
+        ASSERT( sub2->init( "a.b", baseOperand2[ "$lt" ] ).isOK() );
+
+        auto_ptr<ComparisonMatchExpression> eq( new EqualityMatchExpression() );
+        ASSERT( eq->init( "a.c", baseOperand3[ "$ne" ] ).isOK() );
+        auto_ptr<NotMatchExpression> sub3( new NotMatchExpression() );
+        ASSERT( sub3->init( eq.release() ).isOK() );
+
+        AndMatchExpression andOp;
+        andOp.add( sub1.release() );
+        andOp.add( sub2.release() );
+        andOp.add( sub3.release() );
+
+        ASSERT( andOp.matchesBSON( BSON( "a" << BSON( "b" << 1 ) ), NULL ) );
+        ASSERT( andOp.matchesBSON( BSON( "a" << BSON( "b" << 9.5 << "c" << "y" ) ), NULL ) );
+        ASSERT( !andOp.matchesBSON( BSON( "a" << BSON( "b" << 5 << "c" << "x" ) ), NULL ) );
+        ASSERT( !andOp.matchesBSON( BSON( "a" << BSON( "b" << 10 ) ), NULL ) );
+        ASSERT( !andOp.matchesBSON( BSON( "a" << BSON( "c" << "y" ) ), NULL ) );
+        ASSERT( !andOp.matchesBSON( BSON( "a" << 5 ), NULL ) );
+        // Each clause may be satisfied by a different array element.
+        ASSERT( andOp.matchesBSON( BSON( "a" << BSON( "b" << BSON_ARRAY( 0 << 20 ) ) ), NULL ) );
+        ASSERT( andOp.matchesBSON( BSON( "a" << BSON_ARRAY( BSON( "b" << 0 ) <<
+                                                         BSON( "b" << 20 ) ) ), NULL ) );
+        ASSERT( !andOp.matchesBSON( BSON( "a" << BSON_ARRAY( BSON( "b" << 0 ) <<
+                                                          BSON( "c" << "x" ) ) ), NULL ) );
+    }
+
     TEST( AndOp, ElemMatchKey ) {
         BSONObj baseOperand1 = BSON( "a" << 1 );
         BSONObj baseOperand2 = BSON( "b" << 2 );
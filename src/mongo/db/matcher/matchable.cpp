@@ -31,15 +31,48 @@
 #include "mongo/platform/basic.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/matchable.h"
+#include "mongo/db/matcher/path_internal.h"
 
 namespace mongo {
 
     BSONMatchableDocument::BSONMatchableDocument( const BSONObj& obj )
         : _obj( obj ) {
         _iteratorUsed = false;
+        _numResolved = 0;
     }
 
     BSONMatchableDocument::~BSONMatchableDocument() {
     }
 
+    bool BSONMatchableDocument::getSingleElement( const ElementPath* path,
+                                                  BSONElement* out ) const {
+        const FieldRef& ref = path->fieldRef();
+        StringData dotted = ref.dottedField();
+
+        for ( int i = 0; i < _numResolved; i++ ) {
+            if ( _resolved[i].path == dotted ) {
+                *out = _resolved[i].element;
+                return _resolved[i].single;
+            }
+        }
+
+        size_t idxPath = 0;
+        BSONElement e = getFieldDottedOrArray( _obj, ref, &idxPath );
+
+        // Without arrays BSONElementIterator yields exactly the element found, even if EOO, and
+        // with no array offset.  Paths ending at an array whose traversal is turned off would
+        // too, but they are rare enough to leave to the iterator.
+        bool single = e.type() != Array;
+
+        if ( _numResolved < kResolvedPathsCacheSize ) {
+            ResolvedPath& resolved = _resolved[_numResolved++];
+            resolved.path = dotted;
+            resolved.element = e;
+            resolved.single = single;
+        }
+
+        *out = e;
+        return single;
+    }
+
 }
@@ -53,6 +53,15 @@ namespace mongo {
 
         virtual void releaseIterator( ElementIterator* iterator ) const = 0;
 
+        /**
+         * If no array lies along 'path', sets *out to the one element the path reaches (EOO if
+         * none) and returns true, so the caller can skip allocating an ElementIterator.
+         * Returns false if the caller has to iterate.
+         */
+        virtual bool getSingleElement( const ElementPath* path, BSONElement* out ) const {
+            return false;
+        }
+
         class IteratorHolder {
         public:
             IteratorHolder( const MatchableDocument* doc, const ElementPath* path ) {
@@ -97,9 +106,22 @@ namespace mongo {
             }
         }
 
+        virtual bool getSingleElement( const ElementPath* path, BSONElement* out ) const;
+
     private:
+        // Predicates on the same path resolve it once per document
+        enum { kResolvedPathsCacheSize = 4 };
+
+        struct ResolvedPath {
+            StringData path;
+            BSONElement element;
+            bool single;
+        };
+
         BSONObj _obj;
         mutable BSONElementIterator _iterator;
         mutable bool _iteratorUsed;
+        mutable ResolvedPath _resolved[kResolvedPathsCacheSize];
+        mutable int _numResolved;
     };
 }
@@ -0,0 +1,182 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/memory_broker.h"
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    // Total bytes that query, aggregation and sort stages may buffer before they are asked to
+    // spill and new heavy operations are queued.  0 means no limit.
+    MONGO_EXPORT_SERVER_PARAMETER(memoryBrokerLimitBytes, long long, 0);
+
+    // Longest an operation waits for admission while the server is over memoryBrokerLimitBytes
+    MONGO_EXPORT_SERVER_PARAMETER(memoryBrokerAdmissionTimeoutMS, int, 5000);
+
+namespace {
+
+    const size_t kReservationUnitBytes = 1024 * 1024;
+
+    AtomicInt64 usedBytesTotal;
+    AtomicInt64 shedRequests;
+    AtomicInt64 admissionWaits;
+    AtomicInt64 admissionTimeouts;
+
+    boost::mutex admissionMutex;
+    boost::condition_variable admissionCondition;
+
+    struct OpAccount {
+        long long* bytes;
+    };
+
+#if defined(MONGO_HAVE___THREAD)
+    __thread OpAccount _opAccount;
+    OpAccount* getThreadOpAccount() {
+        return &_opAccount;
+    }
+#elif defined(MONGO_HAVE___DECLSPEC_THREAD)
+    __declspec( thread ) OpAccount _opAccount;
+    OpAccount* getThreadOpAccount() {
+        return &_opAccount;
+    }
+#else
+    TSP_DEFINE(OpAccount, _opAccount);
+    OpAccount* getThreadOpAccount() {
+        return _opAccount.getMake();
+    }
+#endif
+
+    bool overLimit(long long used) {
+        const long long limit = memoryBrokerLimitBytes;
+        return limit > 0 && used > limit;
+    }
+
+    void adjustUsed(long long delta) {
+        const long long used = usedBytesTotal.addAndFetch(delta);
+        if (long long* account = getThreadOpAccount()->bytes) {
+            *account += delta;
+        }
+
+        // Wake up operations waiting for admission once we drop back under the limit
+        if (delta < 0 && overLimit(used - delta) && !overLimit(used)) {
+            admissionCondition.notify_all();
+        }
+    }
+
+} // namespace
+
+    long long MemoryBroker::usedBytes() {
+        return usedBytesTotal.load();
+    }
+
+    bool MemoryBroker::underPressure() {
+        return overLimit(usedBytesTotal.load());
+    }
+
+    void MemoryBroker::waitForAdmission(OperationContext* txn) {
+        if (!underPressure()) {
+            return;
+        }
+
+        admissionWaits.fetchAndAdd(1);
+        Timer timer;
+
+        boost::unique_lock<boost::mutex> lk(admissionMutex);
+        while (underPressure()) {
+            if (timer.millis() >= memoryBrokerAdmissionTimeoutMS) {
+                admissionTimeouts.fetchAndAdd(1);
+                LOG(1) << "admitting operation after waiting " << timer.millis()
+                       << "ms for memory, " << usedBytes() << " bytes in use";
+                return;
+            }
+
+            admissionCondition.timed_wait(lk, boost::posix_time::milliseconds(100));
+
+            lk.unlock();
+            txn->checkForInterrupt();
+            lk.lock();
+        }
+    }
+
+    long long* MemoryBroker::setOpAccount(long long* account) {
+        OpAccount* opAccount = getThreadOpAccount();
+        long long* previous = opAccount->bytes;
+        opAccount->bytes = account;
+        return previous;
+    }
+
+    long long* MemoryBroker::getOpAccount() {
+        return getThreadOpAccount()->bytes;
+    }
+
+    void MemoryBroker::appendStats(BSONObjBuilder* builder) {
+        builder->appendNumber("limitBytes", static_cast<long long>(memoryBrokerLimitBytes));
+        builder->appendNumber("usedBytes", usedBytes());
+        builder->appendNumber("shedRequests", shedRequests.load());
+        builder->appendNumber("admissionWaits", admissionWaits.load());
+        builder->appendNumber("admissionTimeouts", admissionTimeouts.load());
+    }
+
+    MemoryReservation::MemoryReservation() : _reserved(0) { }
+
+    MemoryReservation::~MemoryReservation() {
+        set(0);
+    }
+
+    bool MemoryReservation::set(size_t bytes) {
+        const size_t reserved =
+            (bytes + kReservationUnitBytes - 1) / kReservationUnitBytes * kReservationUnitBytes;
+        if (reserved != _reserved) {
+            adjustUsed(static_cast<long long>(reserved) - static_cast<long long>(_reserved));
+            _reserved = reserved;
+        }
+
+        // A single unit isn't worth spilling for
+        if (_reserved > kReservationUnitBytes && MemoryBroker::underPressure()) {
+            shedRequests.fetchAndAdd(1);
+            return false;
+        }
+        return true;
+    }
+
+} // namespace mongo
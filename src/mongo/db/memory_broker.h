@@ -0,0 +1,96 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class OperationContext;
+
+    /**
+     * Server-wide accounting of the memory that queries, aggregations and sorts buffer.  Stages
+     * that buffer data hold a MemoryReservation for it, on top of their own per-stage limits.
+     * When the total goes over memoryBrokerLimitBytes, stages that can spill to disk are asked
+     * to do so early and heavy operations wait for admission before they start.  With the
+     * default limit of 0 only the accounting is done.
+     */
+    class MemoryBroker {
+    public:
+        /** Bytes held by all reservations. */
+        static long long usedBytes();
+
+        /** Returns true if there is a limit and usedBytes() is over it. */
+        static bool underPressure();
+
+        /**
+         * Blocks a heavy operation while the server is under pressure, for up to
+         * memoryBrokerAdmissionTimeoutMS, after which it is let in anyway.  Throws if 'txn' is
+         * interrupted while waiting.
+         */
+        static void waitForAdmission(OperationContext* txn);
+
+        /**
+         * Sets the per-operation counter that reservations changed on this thread are charged
+         * to, see CurOp.  Returns the previous one.
+         */
+        static long long* setOpAccount(long long* account);
+        static long long* getOpAccount();
+
+        static void appendStats(BSONObjBuilder* builder);
+    };
+
+    /**
+     * Memory held by one stage, reserved from the MemoryBroker in 1MB units.
+     * Not thread safe.
+     */
+    class MemoryReservation {
+        MONGO_DISALLOW_COPYING(MemoryReservation);
+    public:
+        MemoryReservation();
+        ~MemoryReservation();
+
+        /**
+         * Sets the reservation to cover 'bytes', which the stage holds whether or not the server
+         * has room for them.  Returns false if the server is under pressure and this reservation
+         * is large enough to be worth shedding: the caller should spill if it can.
+         */
+        bool set(size_t bytes);
+
+        size_t reservedBytes() const { return _reserved; }
+
+    private:
+        size_t _reserved;
+    };
+
+} // namespace mongo
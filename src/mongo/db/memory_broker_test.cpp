@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/memory_broker.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::MemoryBroker;
+    using mongo::MemoryReservation;
+
+    const long long kMB = 1024 * 1024;
+
+    TEST(MemoryBroker, ReservationsRoundUpToWholeMegabytes) {
+        const long long before = MemoryBroker::usedBytes();
+        {
+            MemoryReservation reservation;
+            ASSERT_TRUE(reservation.set(1));
+            ASSERT_EQUALS(static_cast<size_t>(kMB), reservation.reservedBytes());
+            ASSERT_EQUALS(before + kMB, MemoryBroker::usedBytes());
+
+            ASSERT_TRUE(reservation.set(3 * kMB + 1));
+            ASSERT_EQUALS(before + 4 * kMB, MemoryBroker::usedBytes());
+
+            ASSERT_TRUE(reservation.set(0));
+            ASSERT_EQUALS(before, MemoryBroker::usedBytes());
+
+            reservation.set(2 * kMB);
+        }
+        // Released on destruction
+        ASSERT_EQUALS(before, MemoryBroker::usedBytes());
+    }
+
+    TEST(MemoryBroker, NoLimitByDefault) {
+        MemoryReservation reservation;
+        ASSERT_TRUE(reservation.set(1024 * kMB));
+        ASSERT_FALSE(MemoryBroker::underPressure());
+
+        BSONObjBuilder b;
+        MemoryBroker::appendStats(&b);
+        BSONObj stats = b.obj();
+        ASSERT_EQUALS(0, stats["limitBytes"].numberLong());
+        ASSERT_EQUALS(1024 * kMB, stats["usedBytes"].numberLong());
+    }
+
+    TEST(MemoryBroker, ChargesTheOpAccount) {
+        long long opBytes = 0;
+        long long* previous = MemoryBroker::setOpAccount(&opBytes);
+        {
+            MemoryReservation reservation;
+            reservation.set(5 * kMB);
+            ASSERT_EQUALS(5 * kMB, opBytes);
+        }
+        ASSERT_EQUALS(0, opBytes);
+        ASSERT_EQUALS(&opBytes, MemoryBroker::setOpAccount(previous));
+    }
+
+} // namespace
@@ -46,23 +46,31 @@ namespace mongo {
             _god(false),
             _fromMigrate(false),
             _isExplain(false),
+            _returnDeleted(false),
+            _limit(0),
             _yieldPolicy(PlanExecutor::YIELD_MANUAL) {}
 
         void setQuery(const BSONObj& query) { _query = query; }
+        void setSort(const BSONObj& sort) { _sort = sort; }
         void setMulti(bool multi = true) { _multi = multi; }
         void setUpdateOpLog(bool logop = true) { _logop = logop; }
         void setGod(bool god = true) { _god = god; }
         void setFromMigrate(bool fromMigrate = true) { _fromMigrate = fromMigrate; }
         void setExplain(bool isExplain = true) { _isExplain = isExplain; }
+        void setReturnDeleted(bool returnDeleted = true) { _returnDeleted = returnDeleted; }
+        void setLimit(long long limit) { _limit = limit; }
         void setYieldPolicy(PlanExecutor::YieldPolicy yieldPolicy) { _yieldPolicy = yieldPolicy; }
 
         const NamespaceString& getNamespaceString() const { return _nsString; }
         const BSONObj& getQuery() const { return _query; }
+        const BSONObj& getSort() const { return _sort; }
         bool isMulti() const { return _multi; }
         bool shouldCallLogOp() const { return _logop; }
         bool isGod() const { return _god; }
         bool isFromMigrate() const { return _fromMigrate; }
         bool isExplain() const { return _isExplain; }
+        bool shouldReturnDeleted() const { return _returnDeleted; }
+        long long getLimit() const { return _limit; }
         PlanExecutor::YieldPolicy getYieldPolicy() const { return _yieldPolicy; }
 
         std::string toString() const;
@@ -70,11 +78,14 @@ namespace mongo {
     private:
         const NamespaceString& _nsString;
         BSONObj _query;
+        BSONObj _sort;
         bool _multi;
         bool _logop;
         bool _god;
         bool _fromMigrate;
         bool _isExplain;
+        bool _returnDeleted;
+        long long _limit;
         PlanExecutor::YieldPolicy _yieldPolicy;
     };
 
@@ -0,0 +1,74 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ops/hashed_value_set.h"
+
+#include "mongo/db/hasher.h"
+
+namespace mongo {
+
+    const size_t HashedValueSet::kMinValues;
+    const size_t HashedValueSet::npos;
+
+    size_t HashedValueSet::insert(const BSONElement& value) {
+        std::vector<size_t>& bucket = _buckets[hash(value)];
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            if (_values[bucket[i]].woCompare(value, false) == 0)
+                return bucket[i];
+        }
+
+        bucket.push_back(_values.size());
+        _values.push_back(value);
+        return _values.size() - 1;
+    }
+
+    size_t HashedValueSet::find(const BSONElement& value) const {
+        Buckets::const_iterator it = _buckets.find(hash(value));
+        if (it == _buckets.end())
+            return npos;
+
+        const std::vector<size_t>& bucket = it->second;
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            if (_values[bucket[i]].woCompare(value, false) == 0)
+                return bucket[i];
+        }
+        return npos;
+    }
+
+    long long HashedValueSet::hash(const BSONElement& value) {
+        // The element hasher squashes values of the same canonical type (e.g. 1, 1.0 and
+        // NumberLong(1)), which is exactly the equivalence woCompare applies, so equal values
+        // always share a bucket.
+        return BSONElementHasher::hash64(value,
+                                         BSONElementHasher::DEFAULT_HASH_SEED,
+                                         HASH_VERSION_MURMUR3);
+    }
+
+} // namespace mongo
@@ -0,0 +1,81 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/platform/unordered_map.h"
+
+namespace mongo {
+
+    /**
+     * A set of BSON values, compared the way array modifiers compare array entries: by value
+     * with field names ignored. Lookups hash the canonical form of a value (numbers of
+     * different types that compare equal hash alike) and compare only within the bucket, so
+     * testing an array of n entries against m values costs O(n + m) instead of O(n * m).
+     *
+     * The set does not own the values; the BSON they point into must outlive it.
+     */
+    class HashedValueSet {
+        MONGO_DISALLOW_COPYING(HashedValueSet);
+    public:
+        /** Below this many values a linear scan is cheaper than hashing every array entry. */
+        static const size_t kMinValues = 8;
+
+        /** Returned by find() when no equal value is present. */
+        static const size_t npos = static_cast<size_t>(-1);
+
+        HashedValueSet() { }
+
+        /**
+         * Adds 'value' and returns its position, the number of distinct values inserted
+         * before it. If an equal value is already present, returns that value's position.
+         */
+        size_t insert(const BSONElement& value);
+
+        /** Returns the position of the value equal to 'value', or npos if there is none. */
+        size_t find(const BSONElement& value) const;
+
+        /** Returns the number of distinct values in the set. */
+        size_t size() const {
+            return _values.size();
+        }
+
+    private:
+        static long long hash(const BSONElement& value);
+
+        typedef unordered_map<long long, std::vector<size_t> > Buckets;
+
+        Buckets _buckets;
+        std::vector<BSONElement> _values;
+    };
+
+} // namespace mongo
@@ -207,6 +207,25 @@ namespace mongo {
             valCursor = valCursor.rightSibling();
         }
 
+        // Hash a large $each once here, so that prepare tests each array entry against it in
+        // constant time rather than comparing it with every value. The values were already
+        // de-duplicated above, so the set positions line up with the children of _val.
+        size_t numValues = 0;
+        for (mb::ConstElement v = _val.leftChild(); v.ok(); v = v.rightSibling())
+            ++numValues;
+
+        if (numValues >= HashedValueSet::kMinValues) {
+            BSONArrayBuilder values;
+            for (mb::ConstElement v = _val.leftChild(); v.ok(); v = v.rightSibling())
+                values.append(v.getValue());
+            _eachValues = values.arr();
+
+            _eachSet.reset(new HashedValueSet);
+            BSONObjIterator it(_eachValues);
+            while (it.more())
+                _eachSet->insert(it.next());
+        }
+
         return Status::OK();
     }
 
@@ -279,18 +298,24 @@ namespace mongo {
             return Status::OK();
         }
 
-        // For each value in the $each clause, compare it against the values in the array. If
-        // the element is not present, record it as one to add.
-        mb::Element eachIter = _val.leftChild();
-        while (eachIter.ok()) {
-            mb::Element where = mb::findElement(
-                _preparedState->elemFound.leftChild(),
-                mb::woEqualTo(eachIter, false));
-            if (!where.ok()) {
-                // The element was not found. Record the element from $each as one to be added.
-                _preparedState->elementsToAdd.push_back(eachIter);
+        if (_eachSet) {
+            prepareHashed();
+        }
+        else {
+            // For each value in the $each clause, compare it against the values in the array.
+            // If the element is not present, record it as one to add.
+            mb::Element eachIter = _val.leftChild();
+            while (eachIter.ok()) {
+                mb::Element where = mb::findElement(
+                    _preparedState->elemFound.leftChild(),
+                    mb::woEqualTo(eachIter, false));
+                if (!where.ok()) {
+                    // The element was not found. Record the element from $each as one to be
+                    // added.
+                    _preparedState->elementsToAdd.push_back(eachIter);
+                }
+                eachIter = eachIter.rightSibling();
             }
-            eachIter = eachIter.rightSibling();
         }
 
         // If we didn't find any elements to add, then this is a no-op.
@@ -301,6 +326,43 @@ namespace mongo {
         return Status::OK();
     }
 
+    void ModifierAddToSet::prepareHashed() {
+        // Walk the array once, marking each $each value seen in it. The walk stops early once
+        // every value has been seen.
+        std::vector<bool> present(_eachSet->size(), false);
+        size_t numPresent = 0;
+
+        mb::ConstElement arrayIter = _preparedState->elemFound.leftChild();
+        while (arrayIter.ok() && numPresent < present.size()) {
+            if (arrayIter.hasValue()) {
+                const size_t pos = _eachSet->find(arrayIter.getValue());
+                if (pos != HashedValueSet::npos && !present[pos]) {
+                    present[pos] = true;
+                    ++numPresent;
+                }
+            }
+            else {
+                // An entry changed earlier in this update has no serialized value to hash, so
+                // fall back to comparing it with each value.
+                size_t pos = 0;
+                for (mb::ConstElement v = _val.leftChild(); v.ok(); v = v.rightSibling(), ++pos) {
+                    if (!present[pos] && arrayIter.compareWithElement(v, false) == 0) {
+                        present[pos] = true;
+                        ++numPresent;
+                        break;
+                    }
+                }
+            }
+            arrayIter = arrayIter.rightSibling();
+        }
+
+        size_t pos = 0;
+        for (mb::Element v = _val.leftChild(); v.ok(); v = v.rightSibling(), ++pos) {
+            if (!present[pos])
+                _preparedState->elementsToAdd.push_back(v);
+        }
+    }
+
     Status ModifierAddToSet::apply() const {
         dassert(_preparedState->noOp == false);
 
@@ -33,6 +33,8 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/mutable/document.h"
 #include "mongo/db/field_ref.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/ops/hashed_value_set.h"
 #include "mongo/db/ops/modifier_interface.h"
 
 namespace mongo {
@@ -69,6 +71,9 @@ namespace mongo {
         virtual Status log(LogBuilder* logBuilder) const;
 
     private:
+        /** prepare() for a hashed $each: collects the values missing from the array. */
+        void prepareHashed();
+
         // Access to each component of fieldName that's the target of this mod.
         FieldRef _fieldRef;
 
@@ -79,6 +84,12 @@ namespace mongo {
         mutablebson::Document _valDoc;
         mutablebson::Element _val;
 
+        // For a large $each, an owned copy of its values and a set over them, so prepare can
+        // test each array entry in constant time. Position i in the set is the i-th child of
+        // _val. Null when the $each is small enough to scan.
+        BSONObj _eachValues;
+        boost::scoped_ptr<HashedValueSet> _eachSet;
+
         struct PreparedState;
         boost::scoped_ptr<PreparedState> _preparedState;
     };
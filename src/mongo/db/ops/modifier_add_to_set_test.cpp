@@ -390,4 +390,28 @@ namespace {
         ASSERT_EQUALS(fromjson("{ $set : { 'a.1' : [ 1 ] } }"), logDoc);
     }
 
+    TEST(Hashed, AddsOnlyMissingValues) {
+        // Enough $each values that the array is tested against a hashed set.
+        Document doc(fromjson("{ a : [ 1, 'x', { b : 1 }, [ 2 ], 5.0 ] }"));
+        Mod mod(fromjson("{ $addToSet : { a : { $each : "
+                         "[ 1.0, 'x', { b : 1.0 }, [ 2 ], 5, 'y', { b : 2 }, [ 3 ], 6 ] } } }"));
+
+        ModifierInterface::ExecInfo execInfo;
+        ASSERT_OK(mod.prepare(doc.root(), "", &execInfo));
+        ASSERT_FALSE(execInfo.noOp);
+
+        ASSERT_OK(mod.apply());
+        ASSERT_EQUALS(fromjson("{ a : [ 1, 'x', { b : 1 }, [ 2 ], 5.0, "
+                               "'y', { b : 2 }, [ 3 ], 6 ] }"), doc);
+    }
+
+    TEST(Hashed, AllExistingIsNoOp) {
+        Document doc(fromjson("{ a : [ 8, 7, 6, 5, 4, 3, 2, 1, 0 ] }"));
+        Mod mod(fromjson("{ $addToSet : { a : { $each : [ 0, 1, 2, 3, 4, 5, 6, 7, 8 ] } } }"));
+
+        ModifierInterface::ExecInfo execInfo;
+        ASSERT_OK(mod.prepare(doc.root(), "", &execInfo));
+        ASSERT_TRUE(execInfo.noOp);
+    }
+
 } // namespace
@@ -133,6 +133,13 @@ namespace mongo {
         // store the stuff to remove later
         _elementsToFind = modExpr.Array();
 
+        // Hash a long list once so prepare can test each array entry in constant time.
+        if (_elementsToFind.size() >= HashedValueSet::kMinValues) {
+            _elementsToFindSet.reset(new HashedValueSet);
+            for (size_t i = 0; i < _elementsToFind.size(); ++i)
+                _elementsToFindSet->insert(_elementsToFind[i]);
+        }
+
         return Status::OK();
     }
 
@@ -186,10 +193,7 @@ namespace mongo {
                 } else {
                     mutablebson::Element elem = _preparedState->pathFoundElement.leftChild();
                     while (elem.ok()) {
-                        if (std::find_if(_elementsToFind.begin(),
-                                         _elementsToFind.end(),
-                                         mutableElementEqualsBSONElement(elem))
-                                            != _elementsToFind.end()) {
+                        if (isToBeRemoved(elem)) {
                             _preparedState->elementsToRemove.push_back(elem);
                         }
                         elem = elem.rightSibling();
@@ -216,6 +220,16 @@ namespace mongo {
         return status;
     }
 
+    bool ModifierPullAll::isToBeRemoved(const mutablebson::Element& elem) const {
+        // Entries without a serialized value can't be hashed and are compared one by one.
+        if (_elementsToFindSet && elem.hasValue())
+            return _elementsToFindSet->find(elem.getValue()) != HashedValueSet::npos;
+
+        return std::find_if(_elementsToFind.begin(),
+                            _elementsToFind.end(),
+                            mutableElementEqualsBSONElement(elem)) != _elementsToFind.end();
+    }
+
     Status ModifierPullAll::apply() const {
         _preparedState->applyCalled = true;
 
@@ -35,6 +35,7 @@
 #include "mongo/bson/mutable/element.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/ops/hashed_value_set.h"
 #include "mongo/db/ops/modifier_interface.h"
 
 namespace mongo {
@@ -68,6 +69,8 @@ namespace mongo {
         virtual Status log(LogBuilder* logBuilder) const;
 
     private:
+        /** Returns true if 'elem' equals one of the values to remove. */
+        bool isToBeRemoved(const mutablebson::Element& elem) const;
 
         // Access to each component of fieldName that's the target of this mod.
         FieldRef _fieldRef;
@@ -83,6 +86,9 @@ namespace mongo {
         // User specified elements to remove
         std::vector<BSONElement> _elementsToFind;
 
+        // The same elements hashed, when there are enough of them to be worth it.
+        boost::scoped_ptr<HashedValueSet> _elementsToFindSet;
+
     };
 
 } // namespace mongo
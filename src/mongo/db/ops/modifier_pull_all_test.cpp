@@ -148,6 +148,19 @@ namespace {
         ASSERT_EQUALS(fromjson("{ a : [{r:1, b:2}] }"), doc);
     }
 
+    TEST(PrepareApply, ManyElementsHashed) {
+        // Enough values that the array entries are tested against a hashed set.
+        Document doc(fromjson("{ a : [1, 'a', {r:1, b:2}, 2, 3, [4], 'b', 5, 6, 7] }"));
+        Mod mod(fromjson("{ $pullAll : { a : [1.0, {r:1.0, b:2}, [4], 'b', 'c', 9, 10, 11] } }"));
+
+        ModifierInterface::ExecInfo execInfo;
+        ASSERT_OK(mod.prepare(doc.root(), "", &execInfo));
+        ASSERT_FALSE(execInfo.noOp);
+
+        ASSERT_OK(mod.apply());
+        ASSERT_EQUALS(fromjson("{ a : ['a', 2, 3, 5, 6, 7] }"), doc);
+    }
+
     TEST(EmptyResult, RemoveEverythingOutOfOrder) {
         Document doc(fromjson("{ a : [1, 'a', {r:1, b:2}] }"));
         Mod mod(fromjson("{ $pullAll : {a : [ {r:1, b:2}, 1, 'a' ] }}"));
@@ -52,6 +52,8 @@ namespace mongo {
 
     Status ParsedDelete::parseRequest() {
         dassert(!_canonicalQuery.get());
+        // Only a single-document delete can return the document it deleted.
+        invariant(!_request->isMulti() || !_request->shouldReturnDeleted());
 
         if (CanonicalQuery::isSimpleIdQuery(_request->getQuery())) {
             return Status::OK();
@@ -66,8 +68,20 @@ namespace mongo {
         CanonicalQuery* cqRaw;
         const WhereCallbackReal whereCallback(_txn, _request->getNamespaceString().db());
 
+        // A sort picks the one document to delete, so the planner can use a top-1 sort.
+        const BSONObj& sort = _request->getSort();
+        const long long limit = sort.isEmpty() ? 0 : -1;
+
         Status status = CanonicalQuery::canonicalize(_request->getNamespaceString().ns(),
                                                      _request->getQuery(),
+                                                     sort,
+                                                     BSONObj(), // proj
+                                                     0, // skip
+                                                     limit,
+                                                     BSONObj(), // hint
+                                                     BSONObj(), // min
+                                                     BSONObj(), // max
+                                                     false, // snapshot
                                                      _request->isExplain(),
                                                      &cqRaw,
                                                      whereCallback);
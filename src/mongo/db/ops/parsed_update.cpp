@@ -42,6 +42,9 @@ namespace mongo {
         _canonicalQuery() { }
 
     Status ParsedUpdate::parseRequest() {
+        // Only a single-document update can return the document it updated.
+        invariant(!_request->isMulti() || !_request->shouldReturnAnyDocs());
+
         // We parse the update portion before the query portion because the dispostion of the update
         // may determine whether or not we need to produce a CanonicalQuery at all.  For example, if
         // the update involves the positional-dollar operator, we must have a CanonicalQuery even if
@@ -71,8 +74,20 @@ namespace mongo {
         CanonicalQuery* cqRaw;
         const WhereCallbackReal whereCallback(_txn, _request->getNamespaceString().db());
 
+        // A sort picks the one document to update, so the planner can use a top-1 sort.
+        const BSONObj& sort = _request->getSort();
+        const long long limit = sort.isEmpty() ? 0 : -1;
+
         Status status = CanonicalQuery::canonicalize(_request->getNamespaceString().ns(),
                                                      _request->getQuery(),
+                                                     sort,
+                                                     BSONObj(), // proj
+                                                     0, // skip
+                                                     limit,
+                                                     BSONObj(), // hint
+                                                     BSONObj(), // min
+                                                     BSONObj(), // max
+                                                     false, // snapshot
                                                      _request->isExplain(),
                                                      &cqRaw,
                                                      whereCallback);
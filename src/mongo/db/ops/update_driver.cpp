@@ -240,6 +240,7 @@ namespace mongo {
         }
 
         _affectIndices = (isDocReplacement() && (_indexedFields != NULL));
+        _modifiedPaths.clear();
 
         _logDoc.reset();
         LogBuilder logBuilder(_logDoc.root());
@@ -284,6 +285,10 @@ namespace mongo {
                                                 << "' at the same time");
                 }
 
+                if (!execInfo.noOp) {
+                    _modifiedPaths.insert(execInfo.fieldRef[i]);
+                }
+
                 // We start with the expectation that a mod will be in-place. But if the mod
                 // touched an indexed field and the mod will indeed be executed -- that is, it
                 // is not a no-op and it is in a valid context -- then we switch back to a
@@ -338,6 +343,10 @@ namespace mongo {
         return _affectIndices;
     }
 
+    const FieldRefSet* UpdateDriver::modifiedPaths() const {
+        return isDocReplacement() ? NULL : &_modifiedPaths;
+    }
+
     void UpdateDriver::refreshIndexKeys(const UpdateIndexData* indexedFields) {
         _indexedFields = indexedFields;
     }
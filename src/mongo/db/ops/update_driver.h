@@ -110,6 +110,12 @@ namespace mongo {
         bool isDocReplacement() const;
 
         bool modsAffectIndices() const;
+
+        /**
+         * Returns the paths changed by the last call to update(), or NULL if it replaced the
+         * whole document.  The paths are owned by the mods and are valid until the next update().
+         */
+        const FieldRefSet* modifiedPaths() const;
         void refreshIndexKeys(const UpdateIndexData* indexedFields);
 
         bool logOp() const;
@@ -172,6 +178,9 @@ namespace mongo {
         // at each call to update.
         bool _affectIndices;
 
+        // The fields changed by the mods that weren't no-ops in the last call to update.
+        FieldRefSet _modifiedPaths;
+
         // Do any of the mods require positional match details when calling 'prepare'?
         bool _positional;
 
@@ -30,6 +30,7 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include <iterator>
 #include <map>
 
 #include "mongo/base/owned_pointer_vector.h"
@@ -37,6 +38,7 @@
 #include "mongo/bson/mutable/document.h"
 #include "mongo/bson/mutable/mutable_bson_test_utils.h"
 #include "mongo/db/field_ref.h"
+#include "mongo/db/field_ref_set.h"
 #include "mongo/db/json.h"
 #include "mongo/db/update_index_data.h"
 #include "mongo/unittest/unittest.h"
@@ -126,6 +128,37 @@ namespace {
         ASSERT_FALSE(driver.isDocReplacement());
     }
 
+    TEST(Update, ModifiedPaths) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        // The mods refer into the update, so it has to outlive them
+        BSONObj updateObj(fromjson("{$set:{a:1, 'b.c':2}, $inc:{d:1}}"));
+        ASSERT_OK(driver.parse(updateObj));
+
+        // 'a' already has the value being set, so only 'b.c' and 'd' change
+        Document doc(fromjson("{a:1, b:{c:1}, d:1}"));
+        ASSERT_OK(driver.update(StringData(), &doc));
+        ASSERT(driver.modifiedPaths());
+        ASSERT_EQUALS(std::distance(driver.modifiedPaths()->begin(),
+                                    driver.modifiedPaths()->end()), 2);
+        FieldRef bc("b.c");
+        FieldRef d("d");
+        FieldRef a("a");
+        ASSERT_TRUE(driver.modifiedPaths()->findConflicts(&bc, NULL));
+        ASSERT_TRUE(driver.modifiedPaths()->findConflicts(&d, NULL));
+        ASSERT_FALSE(driver.modifiedPaths()->findConflicts(&a, NULL));
+    }
+
+    TEST(Update, ModifiedPathsOfReplacement) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        BSONObj updateObj(fromjson("{a:2}"));
+        ASSERT_OK(driver.parse(updateObj));
+        Document doc(fromjson("{a:1}"));
+        ASSERT_OK(driver.update(StringData(), &doc));
+        ASSERT_FALSE(driver.modifiedPaths());
+    }
+
     //
     // Tests of creating a base for an upsert from a query document
     // $or, $and, $all get special handling, as does the _id field
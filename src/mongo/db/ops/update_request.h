@@ -43,6 +43,17 @@ namespace mongo {
 
     class UpdateRequest {
     public:
+        enum ReturnDocOption {
+            // Return no documents.
+            RETURN_NONE,
+
+            // Return the document as it was before the update.
+            RETURN_OLD,
+
+            // Return the document as it is after the update (or the upserted document).
+            RETURN_NEW
+        };
+
         inline UpdateRequest(const NamespaceString& nsString)
             : _nsString(nsString)
             , _god(false)
@@ -53,6 +64,7 @@ namespace mongo {
             , _fromReplication(false)
             , _lifecycle(NULL)
             , _isExplain(false)
+            , _returnDocs(RETURN_NONE)
             , _yieldPolicy(PlanExecutor::YIELD_MANUAL) {}
 
         const NamespaceString& getNamespaceString() const {
@@ -67,6 +79,14 @@ namespace mongo {
             return _query;
         }
 
+        inline void setSort(const BSONObj& sort) {
+            _sort = sort;
+        }
+
+        inline const BSONObj& getSort() const {
+            return _sort;
+        }
+
         inline void setUpdates(const BSONObj& updates) {
             _updates = updates;
         }
@@ -142,6 +162,22 @@ namespace mongo {
             return _isExplain;
         }
 
+        inline void setReturnDocs(ReturnDocOption value) {
+            _returnDocs = value;
+        }
+
+        inline bool shouldReturnOldDocs() const {
+            return _returnDocs == RETURN_OLD;
+        }
+
+        inline bool shouldReturnNewDocs() const {
+            return _returnDocs == RETURN_NEW;
+        }
+
+        inline bool shouldReturnAnyDocs() const {
+            return shouldReturnOldDocs() || shouldReturnNewDocs();
+        }
+
         inline void setYieldPolicy(PlanExecutor::YieldPolicy yieldPolicy) {
             _yieldPolicy = yieldPolicy;
         }
@@ -153,6 +189,7 @@ namespace mongo {
         const std::string toString() const {
             return str::stream()
                         << " query: " << _query
+                        << " sort: " << _sort
                         << " updated: " << _updates
                         << " god: " << _god
                         << " upsert: " << _upsert
@@ -160,7 +197,8 @@ namespace mongo {
                         << " callLogOp: " << _callLogOp
                         << " fromMigration: " << _fromMigration
                         << " fromReplications: " << _fromReplication
-                        << " isExplain: " << _isExplain;
+                        << " isExplain: " << _isExplain
+                        << " returnDocs: " << _returnDocs;
         }
     private:
 
@@ -169,6 +207,10 @@ namespace mongo {
         // Contains the query that selects documents to update.
         BSONObj _query;
 
+        // Contains the sort order that picks the document to update when the query matches
+        // several.  Only meaningful for non-multi updates.
+        BSONObj _sort;
+
         // Contains the modifiers to apply to matched objects, or a replacement document.
         BSONObj _updates;
 
@@ -199,6 +241,10 @@ namespace mongo {
         // Whether or not we are requesting an explained update. Explained updates are read-only.
         bool _isExplain;
 
+        // Which version of the updated document, if any, the update stage returns. Only
+        // non-multi updates may return documents.
+        ReturnDocOption _returnDocs;
+
         // Whether or not the update should yield. Defaults to YIELD_MANUAL.
         PlanExecutor::YieldPolicy _yieldPolicy;
 
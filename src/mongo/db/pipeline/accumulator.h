@@ -32,6 +32,7 @@
 
 #include <boost/intrusive_ptr.hpp>
 #include <boost/unordered_set.hpp>
+#include <vector>
 
 #include "mongo/bson/bsontypes.h"
 #include "mongo/db/pipeline/value.h"
@@ -182,10 +183,52 @@ namespace mongo {
 
         static boost::intrusive_ptr<Accumulator> create();
 
+        /**
+         * The partial state a shard sends to the merger for a total and a count: the pair
+         * [total, count] when internalAggCompactAvgPartials is on, otherwise the older
+         * {subTotal: total, count: count} document. parsePartial() accepts either form so that
+         * a merger can combine partials from shards running with the knob either way.
+         */
+        static Value makePartial(double total, long long count);
+        static void parsePartial(const Value& partial, double* total, long long* count);
+
     private:
         AccumulatorAvg();
 
         double _total;
         long long _count;
     };
+
+
+    /**
+     * Holds the state of one accumulator for every group of a $group in flat arrays indexed by
+     * group ordinal, rather than as one heap-allocated Accumulator per group. Only the
+     * accumulators with fixed-shape state have a column form; each produces exactly the same
+     * values as its Accumulator counterpart so the two can be mixed across a spill.
+     */
+    class AccumulatorColumn {
+    public:
+        virtual ~AccumulatorColumn() {}
+
+        /// Appends fresh state for the next group ordinal and returns the bytes it uses.
+        virtual int addGroup() = 0;
+
+        /** Updates the state of 'group' with 'input' and returns the change in bytes used.
+         *  merging has the same meaning as in Accumulator::process().
+         */
+        virtual int process(size_t group, const Value& input, bool merging) = 0;
+
+        /// Same as Accumulator::getValue() for the given group.
+        virtual Value getValue(size_t group, bool toBeMerged) const = 0;
+
+        /// Drops the state of all groups.
+        virtual void clear() = 0;
+
+        static AccumulatorColumn* createAvg();
+        static AccumulatorColumn* createFirst();
+        static AccumulatorColumn* createLast();
+        static AccumulatorColumn* createMax();
+        static AccumulatorColumn* createMin();
+        static AccumulatorColumn* createSum();
+    };
 }
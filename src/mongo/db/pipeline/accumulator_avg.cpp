@@ -32,16 +32,48 @@
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
     using boost::intrusive_ptr;
+    using std::vector;
+
+    // Turn off while any node that may merge $group results still expects the document form.
+    MONGO_EXPORT_SERVER_PARAMETER(internalAggCompactAvgPartials, bool, true);
 
 namespace {
     const char subTotalName[] = "subTotal";
     const char countName[] = "count";
 }
 
+    Value AccumulatorAvg::makePartial(double total, long long count) {
+        if (!internalAggCompactAvgPartials)
+            return Value(DOC(subTotalName << total
+                          << countName << count));
+
+        vector<Value> partial;
+        partial.reserve(2);
+        partial.push_back(Value(total));
+        partial.push_back(Value(count));
+        return Value(partial);
+    }
+
+    void AccumulatorAvg::parsePartial(const Value& partial, double* total, long long* count) {
+        if (partial.getType() == Array) {
+            const vector<Value>& pair = partial.getArray();
+            verify(pair.size() == 2);
+            *total = pair[0].getDouble();
+            *count = pair[1].getLong();
+            return;
+        }
+
+        // We expect an object that contains both a subtotal and a count.
+        verify(partial.getType() == Object);
+        *total = partial[subTotalName].getDouble();
+        *count = partial[countName].getLong();
+    }
+
     void AccumulatorAvg::processInternal(const Value& input, bool merging) {
         if (!merging) {
             // non numeric types have no impact on average
@@ -52,11 +84,12 @@ namespace {
             _count += 1;
         }
         else {
-            // We expect an object that contains both a subtotal and a count.
             // This is what getValue(true) produced below.
-            verify(input.getType() == Object);
-            _total += input[subTotalName].getDouble();
-            _count += input[countName].getLong();
+            double total;
+            long long count;
+            parsePartial(input, &total, &count);
+            _total += total;
+            _count += count;
         }
     }
 
@@ -72,8 +105,7 @@ namespace {
             return Value(_total / static_cast<double>(_count));
         }
         else {
-            return Value(DOC(subTotalName << _total
-                          << countName << _count));
+            return makePartial(_total, _count);
         }
     }
 
@@ -0,0 +1,282 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/accumulator.h"
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/value.h"
+
+namespace mongo {
+
+    using std::vector;
+
+namespace {
+
+    /**
+     * The column form of AccumulatorSum. The running type, integral total and floating point
+     * total live in three parallel arrays.
+     */
+    class SumColumn : public AccumulatorColumn {
+    public:
+        virtual int addGroup() {
+            _totalType.push_back(NumberInt);
+            _longTotal.push_back(0);
+            _doubleTotal.push_back(0);
+            return sizeof(signed char) + sizeof(long long) + sizeof(double);
+        }
+
+        virtual int process(size_t group, const Value& input, bool merging) {
+            // do nothing with non numeric types
+            if (!input.numeric())
+                return 0;
+
+            // upgrade to the widest type required to hold the result
+            const BSONType totalType =
+                Value::getWidestNumeric(BSONType(_totalType[group]), input.getType());
+            _totalType[group] = totalType;
+
+            if (totalType == NumberInt || totalType == NumberLong) {
+                long long v = input.coerceToLong();
+                _longTotal[group] += v;
+                _doubleTotal[group] += v;
+            }
+            else if (totalType == NumberDouble) {
+                _doubleTotal[group] += input.coerceToDouble();
+            }
+            else {
+                // non numerics should have returned above so we should never get here
+                verify(false);
+            }
+            return 0;
+        }
+
+        virtual Value getValue(size_t group, bool toBeMerged) const {
+            const BSONType totalType = BSONType(_totalType[group]);
+            if (totalType == NumberLong) {
+                return Value(_longTotal[group]);
+            }
+            else if (totalType == NumberDouble) {
+                return Value(_doubleTotal[group]);
+            }
+            else if (totalType == NumberInt) {
+                return Value::createIntOrLong(_longTotal[group]);
+            }
+            else {
+                massert(16000, "$sum resulted in a non-numeric type", false);
+            }
+        }
+
+        virtual void clear() {
+            vector<signed char>().swap(_totalType);
+            vector<long long>().swap(_longTotal);
+            vector<double>().swap(_doubleTotal);
+        }
+
+    private:
+        vector<signed char> _totalType;
+        vector<long long> _longTotal;
+        vector<double> _doubleTotal;
+    };
+
+    /**
+     * The column form of AccumulatorAvg.
+     */
+    class AvgColumn : public AccumulatorColumn {
+    public:
+        virtual int addGroup() {
+            _total.push_back(0);
+            _count.push_back(0);
+            return sizeof(double) + sizeof(long long);
+        }
+
+        virtual int process(size_t group, const Value& input, bool merging) {
+            if (!merging) {
+                // non numeric types have no impact on average
+                if (!input.numeric())
+                    return 0;
+
+                _total[group] += input.getDouble();
+                _count[group] += 1;
+            }
+            else {
+                // This is what getValue(true) produced below.
+                double total;
+                long long count;
+                AccumulatorAvg::parsePartial(input, &total, &count);
+                _total[group] += total;
+                _count[group] += count;
+            }
+            return 0;
+        }
+
+        virtual Value getValue(size_t group, bool toBeMerged) const {
+            if (!toBeMerged) {
+                if (_count[group] == 0)
+                    return Value(0.0);
+
+                return Value(_total[group] / static_cast<double>(_count[group]));
+            }
+            else {
+                return AccumulatorAvg::makePartial(_total[group], _count[group]);
+            }
+        }
+
+        virtual void clear() {
+            vector<double>().swap(_total);
+            vector<long long>().swap(_count);
+        }
+
+    private:
+        vector<double> _total;
+        vector<long long> _count;
+    };
+
+    /**
+     * Base for the columns whose per-group state is a single Value.
+     */
+    class ValueColumn : public AccumulatorColumn {
+    public:
+        virtual int addGroup() {
+            _vals.push_back(Value());
+            return sizeof(Value);
+        }
+
+        virtual Value getValue(size_t group, bool toBeMerged) const {
+            return _vals[group];
+        }
+
+        virtual void clear() {
+            vector<Value>().swap(_vals);
+        }
+
+    protected:
+        /// Replaces the state of 'group' with 'val' and returns the change in bytes used.
+        int set(size_t group, const Value& val) {
+            const int delta = val.getApproximateSize() - _vals[group].getApproximateSize();
+            _vals[group] = val;
+            return delta;
+        }
+
+        vector<Value> _vals;
+    };
+
+    /**
+     * The column form of AccumulatorMinMax.
+     */
+    class MinMaxColumn : public ValueColumn {
+    public:
+        explicit MinMaxColumn(int sense) : _sense(sense) {
+            verify((_sense == 1) || (_sense == -1));
+        }
+
+        virtual int process(size_t group, const Value& input, bool merging) {
+            // nullish values should have no impact on result
+            if (input.nullish())
+                return 0;
+
+            /* compare with the current value; swap if appropriate */
+            const Value& cur = _vals[group];
+            int cmp = Value::compare(cur, input) * _sense;
+            if (cmp > 0 || cur.missing()) // missing is lower than all other values
+                return set(group, input);
+            return 0;
+        }
+
+    private:
+        const int _sense; /* 1 for min, -1 for max; used to "scale" comparison */
+    };
+
+    /**
+     * The column form of AccumulatorFirst.
+     */
+    class FirstColumn : public ValueColumn {
+    public:
+        virtual int addGroup() {
+            _haveFirst.push_back(false);
+            return ValueColumn::addGroup() + sizeof(bool);
+        }
+
+        virtual int process(size_t group, const Value& input, bool merging) {
+            /* only remember the first value seen */
+            if (_haveFirst[group])
+                return 0;
+
+            // can't use missing() since we want the first value even if missing
+            _haveFirst[group] = true;
+            return set(group, input);
+        }
+
+        virtual void clear() {
+            ValueColumn::clear();
+            vector<bool>().swap(_haveFirst);
+        }
+
+    private:
+        vector<bool> _haveFirst;
+    };
+
+    /**
+     * The column form of AccumulatorLast.
+     */
+    class LastColumn : public ValueColumn {
+    public:
+        virtual int process(size_t group, const Value& input, bool merging) {
+            /* always remember the last value seen */
+            return set(group, input);
+        }
+    };
+
+} // namespace
+
+    AccumulatorColumn* AccumulatorColumn::createAvg() {
+        return new AvgColumn();
+    }
+
+    AccumulatorColumn* AccumulatorColumn::createFirst() {
+        return new FirstColumn();
+    }
+
+    AccumulatorColumn* AccumulatorColumn::createLast() {
+        return new LastColumn();
+    }
+
+    AccumulatorColumn* AccumulatorColumn::createMax() {
+        return new MinMaxColumn(-1);
+    }
+
+    AccumulatorColumn* AccumulatorColumn::createMin() {
+        return new MinMaxColumn(1);
+    }
+
+    AccumulatorColumn* AccumulatorColumn::createSum() {
+        return new SumColumn();
+    }
+}
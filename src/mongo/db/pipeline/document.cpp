@@ -31,9 +31,9 @@
 #include "mongo/db/pipeline/document.h"
 
 #include <boost/functional/hash.hpp>
-#include <boost/scoped_array.hpp>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/pipeline/document_storage_pool.h"
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -44,6 +44,12 @@ namespace mongo {
     using std::vector;
 
     Position DocumentStorage::findField(StringData requested) const {
+        // An overlay has its base's fields at the same positions.
+        if (_overlayBase)
+            return _overlayBase->findField(requested);
+
+        materialize();
+
         int reqSize = requested.size(); // get size calculation out of the way if needed
 
         if (_numFields >= HASH_TAB_MIN) { // hash lookup
@@ -133,6 +139,7 @@ namespace mongo {
         const bool firstAlloc = !_buffer;
         const bool doingRehash = needRehash();
         const size_t oldCapacity = _bufferEnd - _buffer;
+        const size_t oldHashTabBytes = hashTabBytes();
 
         // make new bucket count big enough
         while (needRehash() || hashTabBuckets() < HASH_TAB_INIT_SIZE)
@@ -146,13 +153,13 @@ namespace mongo {
         uassert(16490, "Tried to make oversized document",
                 capacity <= size_t(BufferMaxSize));
 
-        boost::scoped_array<char> oldBuf(_buffer);
-        _buffer = new char[capacity];
+        char* oldBuf = _buffer;
+        _buffer = DocumentStoragePool::allocate(capacity);
         _bufferEnd = _buffer + capacity - hashTabBytes();
 
         if (!firstAlloc) {
             // This just copies the elements
-            memcpy(_buffer, oldBuf.get(), _usedBytes);
+            memcpy(_buffer, oldBuf, _usedBytes);
 
             if (_numFields >= HASH_TAB_MIN) {
                 // if we were hashing, deal with the hash table
@@ -161,9 +168,11 @@ namespace mongo {
                 }
                 else {
                     // no rehash needed so just slide table down to new position
-                    memcpy(_hashTab, oldBuf.get() + oldCapacity, hashTabBytes());
+                    memcpy(_hashTab, oldBuf + oldCapacity, hashTabBytes());
                 }
             }
+
+            DocumentStoragePool::release(oldBuf, oldCapacity + oldHashTabBytes);
         }
     }
 
@@ -178,44 +187,104 @@ namespace mongo {
         // Using expectedFields+1 to allow space for long field names
         const size_t newSize = (expectedFields+1) * ValueElement::align(sizeof(ValueElement));
 
+        // same power-of-two sizes as alloc() so that buffers can be recycled
+        size_t capacity = 128;
+        while (capacity < newSize + hashTabBytes())
+            capacity *= 2;
+
         uassert(16491, "Tried to make oversized document",
-                newSize <= size_t(BufferMaxSize));
+                capacity <= size_t(BufferMaxSize));
 
-        _buffer = new char[newSize + hashTabBytes()];
-        _bufferEnd = _buffer + newSize;
+        _buffer = DocumentStoragePool::allocate(capacity);
+        _bufferEnd = _buffer + capacity - hashTabBytes();
     }
 
     intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
+        materialize();
+
         intrusive_ptr<DocumentStorage> out (new DocumentStorage());
+        out->copyFieldsFrom(*this);
+        return out;
+    }
 
+    void DocumentStorage::copyFieldsFrom(const DocumentStorage& source) {
         // Make a copy of the buffer.
         // It is very important that the positions of each field are the same after cloning.
-        const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
-        out->_buffer = new char[bufferBytes];
-        out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
-        memcpy(out->_buffer, _buffer, bufferBytes);
+        const size_t bufferBytes = (source._bufferEnd + source.hashTabBytes()) - source._buffer;
+        _buffer = DocumentStoragePool::allocate(bufferBytes);
+        _bufferEnd = _buffer + (source._bufferEnd - source._buffer);
+        memcpy(_buffer, source._buffer, bufferBytes);
 
         // Copy remaining fields
-        out->_usedBytes = _usedBytes;
-        out->_numFields = _numFields;
-        out->_hashTabMask = _hashTabMask;
-        out->_hasTextScore = _hasTextScore;
-        out->_textScore = _textScore;
+        _usedBytes = source._usedBytes;
+        _numFields = source._numFields;
+        _hashTabMask = source._hashTabMask;
+        _hasTextScore = source._hasTextScore;
+        _textScore = source._textScore;
 
         // Tell values that they have been memcpyed (updates ref counts)
-        for (DocumentStorageIterator it = out->iteratorAll(); !it.atEnd(); it.advance()) {
+        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
             it->val.memcpyed();
         }
+    }
 
-        return out;
+    void DocumentStorage::initOverlay(const DocumentStorage* base, Position pos, const Value& val) {
+        fassert(28643, !_buffer && !_lazy && !_overlayBase && base && pos.found());
+        _overlayBase = base;
+        _overlayPos = pos;
+        _overlayValue = val;
+    }
+
+    void DocumentStorage::copyOverlayFields() {
+        intrusive_ptr<const DocumentStorage> base;
+        base.swap(_overlayBase);
+        base->materialize();
+
+        copyFieldsFrom(*base);
+        getField(_overlayPos).val = _overlayValue;
+        _overlayValue = Value();
+    }
+
+    void DocumentStorage::initLazy(const BSONObj& bson,
+                                   const SharedBuffer& owner,
+                                   bool withMetaData) {
+        fassert(28618, !_buffer && !_lazy);
+        _lazy = true;
+        _lazyMetaData = withMetaData;
+        _lazyBson = bson;
+        _lazyOwner = owner;
+    }
+
+    void DocumentStorage::convertLazyFields() {
+        BSONObj bson;
+        bson.swap(_lazyBson);
+        SharedBuffer owner;
+        owner.swap(_lazyOwner); // keeps bson alive until the end of this function
+        _lazy = false;
+
+        reserveFields(bson.nFields());
+
+        BSONForEach(elem, bson) {
+            if (_lazyMetaData
+                    && elem.fieldName()[0] == '$'
+                    && elem.fieldNameStringData() == Document::metaFieldTextScore) {
+                setTextScore(elem.Double());
+                continue;
+            }
+
+            appendField(elem.fieldNameStringData()) = Value::fromBsonLazily(elem, owner);
+        }
     }
 
     DocumentStorage::~DocumentStorage() {
-        boost::scoped_array<char> deleteBufferAtScopeEnd (_buffer);
+        if (_overlayBase)
+            return; // nothing was copied, the members release the base and the value
 
         for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
             it->val.~Value(); // explicit destructor call
         }
+
+        DocumentStoragePool::release(_buffer, allocatedBytes());
     }
 
     Document::Document(const BSONObj& bson) {
@@ -259,6 +328,34 @@ namespace mongo {
         return bb.obj();
     }
 
+    Document Document::fromBsonLazily(const BSONObj& bson,
+                                      const SharedBuffer& owner,
+                                      bool withMetaData) {
+        intrusive_ptr<DocumentStorage> storage(new DocumentStorage());
+        storage->initLazy(bson, owner, withMetaData);
+        return Document(storage.get());
+    }
+
+    Document Document::overlay(const Document& base,
+                               const vector<Position>& positions,
+                               const Value& val) {
+        fassert(28644, !positions.empty());
+
+        // The documents along the path, each of which gets an overlay replacing the next one.
+        vector<Document> docs(1, base);
+        for (size_t i = 0; i + 1 < positions.size(); i++) {
+            docs.push_back(docs.back().getField(positions[i]).getDocument());
+        }
+
+        Value replacement = val;
+        for (size_t i = positions.size(); i-- > 0; ) {
+            intrusive_ptr<DocumentStorage> storage(new DocumentStorage());
+            storage->initOverlay(docs[i]._storage.get(), positions[i], replacement);
+            replacement = Value(Document(storage.get()));
+        }
+        return replacement.getDocument();
+    }
+
     Document Document::fromBsonWithMetaData(const BSONObj& bson) {
         MutableDocument md;
 
@@ -357,6 +454,9 @@ namespace mongo {
         size_t size = sizeof(DocumentStorage);
         size += storage().allocatedBytes();
 
+        if (storage().isLazy() || storage().isOverlay())
+            return size; // allocatedBytes() covered the unconverted BSON or the replaced value
+
         for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
             size += it->val.getApproximateSize();
             size -= sizeof(Value); // already accounted for above
@@ -82,7 +82,7 @@ namespace mongo {
 
         /// Look up a field by Position. See positionOf and getNestedField.
         const Value operator[] (Position pos) const { return getField(pos); }
-        const Value getField(Position pos) const { return storage().getField(pos).val; }
+        const Value getField(Position pos) const { return storage().getValue(pos); }
 
         /** Similar to BSONObj::getFieldDotted, but using FieldPath rather than a dotted string.
          *  If you pass a non-NULL positions vector, you get back a path suitable
@@ -158,6 +158,26 @@ namespace mongo {
          */
         static Document fromBsonWithMetaData(const BSONObj& bson);
 
+        /**
+         * Like fromBsonWithMetaData (or Document(BSONObj) if 'withMetaData' is false), but the
+         * fields are only converted to Values the first time the document is read, and nested
+         * objects only when they are read in turn. 'owner' must keep bson's data alive, so this
+         * is usually called as fromBsonLazily(obj, obj.sharedBuffer(), ...) on an owned obj.
+         */
+        static Document fromBsonLazily(const BSONObj& bson,
+                                       const SharedBuffer& owner,
+                                       bool withMetaData);
+
+        /**
+         * Returns a document that reads as 'base' with the field at 'positions', as filled in by
+         * getNestedField(), set to 'val'. Unlike MutableDocument::setNestedField() on a copy of
+         * 'base', this shares base's fields and those of the documents along the path instead of
+         * copying them, until the result is changed or read as a whole (e.g. by toBson()).
+         */
+        static Document overlay(const Document& base,
+                                const std::vector<Position>& positions,
+                                const Value& val);
+
         // Support BSONObjBuilder and BSONArrayBuilder "stream" API
         friend BSONObjBuilder& operator << (BSONObjBuilderValueStream& builder, const Document& d);
 
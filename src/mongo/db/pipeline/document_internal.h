@@ -171,9 +171,39 @@ namespace mongo {
                           , _hashTabMask(0)
                           , _hasTextScore(false)
                           , _textScore(0)
+                          , _lazy(false)
+                          , _lazyMetaData(false)
         {}
         ~DocumentStorage();
 
+        /**
+         * Makes this empty storage stand for the fields of 'bson', which are only converted to
+         * Values the first time anything about this document is asked for. 'owner' keeps bson's
+         * buffer alive until then, and nested objects are converted lazily in the same way. If
+         * 'withMetaData' is true, metadata fields are parsed as in fromBsonWithMetaData().
+         *
+         * The conversion happens behind const accessors, so a lazy document must not be read
+         * from several threads at once before it has been converted.
+         */
+        void initLazy(const BSONObj& bson, const SharedBuffer& owner, bool withMetaData);
+
+        /// True until the fields of a lazy document have been converted
+        bool isLazy() const { return _lazy; }
+
+        /**
+         * Makes this empty storage read as 'base' with the value at 'pos' replaced by 'val',
+         * sharing base's fields instead of copying them. Looking up single fields reads through
+         * to base; anything else, including any change, first copies base's fields into this
+         * storage the way clone() does.
+         *
+         * Like a lazy document, an overlay must not be read from several threads at once before
+         * it has been copied.
+         */
+        void initOverlay(const DocumentStorage* base, Position pos, const Value& val);
+
+        /// True until the fields of an overlay have been copied from its base
+        bool isOverlay() const { return _overlayBase != NULL; }
+
         static const DocumentStorage& emptyDoc() {
             static const char emptyBytes[sizeof(DocumentStorage)] = {0};
             return *reinterpret_cast<const DocumentStorage*>(emptyBytes);
@@ -188,13 +218,22 @@ namespace mongo {
         }
 
         /// Returns the position of the next field to be inserted
-        Position getNextPosition() const { return Position(_usedBytes); }
+        Position getNextPosition() const {
+            materialize();
+            return Position(_usedBytes);
+        }
 
         /// Returns the position of the named field (may be missing) or Position()
         Position findField(StringData name) const;
 
         // Document uses these
+        Value getValue(Position pos) const {
+            if (MONGO_unlikely(_overlayBase != NULL))
+                return pos == _overlayPos ? _overlayValue : _overlayBase->getValue(pos);
+            return getField(pos).val;
+        }
         const ValueElement& getField(Position pos) const {
+            materialize();
             verify(pos.found());
             return *(_firstElement->plusBytes(pos.index));
         }
@@ -202,11 +241,12 @@ namespace mongo {
             Position pos = findField(name);
             if (!pos.found())
                 return Value();
-            return getField(pos).val;
+            return getValue(pos);
         }
 
         // MutableDocument uses these
         ValueElement& getField(Position pos) {
+            materialize();
             verify(pos.found());
             return *(_firstElement->plusBytes(pos.index));
         }
@@ -227,18 +267,26 @@ namespace mongo {
 
         /// This skips missing values
         DocumentStorageIterator iterator() const {
+            materialize();
             return DocumentStorageIterator(_firstElement, end(), false);
         }
 
         /// This includes missing values
         DocumentStorageIterator iteratorAll() const {
+            materialize();
             return DocumentStorageIterator(_firstElement, end(), true);
         }
 
         /// Shallow copy of this. Caller owns memory.
         boost::intrusive_ptr<DocumentStorage> clone() const;
 
+        /// For a lazy document this is the size of the BSON it has yet to convert, and for an
+        /// overlay the size of the value it replaces
         size_t allocatedBytes() const {
+            if (_lazy)
+                return _lazyBson.objsize();
+            if (_overlayBase)
+                return _overlayValue.getApproximateSize();
             return !_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes());
         }
 
@@ -252,15 +300,32 @@ namespace mongo {
             }
         }
 
-        bool hasTextScore() const { return _hasTextScore; }
-        double getTextScore() const { return _textScore; }
+        bool hasTextScore() const { materialize(); return _hasTextScore; }
+        double getTextScore() const { materialize(); return _textScore; }
         void setTextScore(double score) {
+            materialize();
             _hasTextScore = true;
             _textScore = score;
         }
 
     private:
 
+        void materialize() const {
+            if (MONGO_unlikely(_lazy))
+                const_cast<DocumentStorage*>(this)->convertLazyFields();
+            else if (MONGO_unlikely(_overlayBase != NULL))
+                const_cast<DocumentStorage*>(this)->copyOverlayFields();
+        }
+
+        /// Converts the fields of _lazyBson and releases it
+        void convertLazyFields();
+
+        /// Copies the fields of _overlayBase, substitutes _overlayValue and releases both
+        void copyOverlayFields();
+
+        /// Copies the buffer of 'source', which must be materialized, into this empty storage
+        void copyFieldsFrom(const DocumentStorage& source);
+
         /// Same as lastElement->next() or firstElement() if empty.
         const ValueElement* end() const { return _firstElement->plusBytes(_usedBytes); }
 
@@ -330,6 +395,19 @@ namespace mongo {
 
         bool _hasTextScore; // When adding more metadata fields, this should become a bitvector
         double _textScore;
+
+        // Set by initLazy() until the fields are converted. emptyDoc() leaves these zeroed rather
+        // than constructed, which is fine since they are only looked at while _lazy is true.
+        bool _lazy;
+        bool _lazyMetaData;
+        BSONObj _lazyBson;
+        SharedBuffer _lazyOwner;
+
+        // Set by initOverlay() until the fields are copied. Zero in emptyDoc() as well, and the
+        // other two are only looked at while _overlayBase is set.
+        boost::intrusive_ptr<const DocumentStorage> _overlayBase;
+        Position _overlayPos;
+        Value _overlayValue;
         // When adding a field, make sure to update clone() method
     };
 }
@@ -34,16 +34,21 @@
 #include <boost/intrusive_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/unordered_map.hpp>
 #include <deque>
 
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/memory_broker.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/matcher/matcher.h"
+#include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/group_key_table.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/sorter/sorter.h"
 #include "mongo/s/shard.h"
@@ -207,6 +212,23 @@ namespace mongo {
     };
 
 
+    /** This class marks DocumentSources that pass some fields through unchanged, possibly under
+     *  a new name. A $match that follows one can run its predicates on those fields ahead of it.
+     *  See Pipeline::Optimizations::Local::moveMatchBeforePathPreservingStages() for details.
+     */
+    class PathPreservingDocumentSource {
+    public:
+        /** Returns true if every document this stage outputs holds, at 'path', exactly what the
+         *  single input document it came from held at '*inputPath', and sets '*inputPath'.
+         *  Returns false if the stage may compute or remove anything at 'path'.
+         */
+        virtual bool getInputPath(const std::string& path, std::string* inputPath) const = 0;
+    protected:
+        // It is invalid to delete through a PathPreservingDocumentSource-typed pointer.
+        virtual ~PathPreservingDocumentSource() {}
+    };
+
+
     /** This class marks DocumentSources which need mongod-specific functionality.
      *  It causes a MongodInterface to be injected when in a mongod and prevents mongos from
      *  merging pipelines containing this stage.
@@ -231,6 +253,12 @@ namespace mongo {
 
             virtual bool isCapped(const NamespaceString& ns) = 0;
 
+            /**
+             * Inserts 'objs' into the existing collection 'ns' in a single storage transaction,
+             * through the same grouped insert path as batched write commands. Throws on error.
+             */
+            virtual void insert(const NamespaceString& ns, const std::vector<BSONObj>& objs) = 0;
+
             // Add new methods as needed.
         };
 
@@ -458,10 +486,13 @@ namespace mongo {
                 result documents
           @param pAccumulatorFactory used to create the accumulator for the
                 group field
+          @param pColumnFactory if not NULL, creates the column form of the
+                same accumulator (see AccumulatorColumn)
          */
         void addAccumulator(const std::string& fieldName,
                             boost::intrusive_ptr<Accumulator> (*pAccumulatorFactory)(),
-                            const boost::intrusive_ptr<Expression> &pExpression);
+                            const boost::intrusive_ptr<Expression> &pExpression,
+                            AccumulatorColumn* (*pColumnFactory)() = NULL);
 
         /// Tell this source if it is doing a merge from shards. Defaults to false.
         void setDoingMerge(bool doingMerge) { _doingMerge = doingMerge; }
@@ -493,6 +524,9 @@ namespace mongo {
         /// Spill groups map to disk and returns an iterator to the file.
         boost::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+        /// Same as spill() but for the columnar groups.
+        boost::shared_ptr<Sorter<Value, Value>::Iterator> spillColumns();
+
         // Only used by spill. Would be function-local if that were legal in C++03.
         class SpillSTLComparator;
 
@@ -541,14 +575,27 @@ namespace mongo {
         std::vector<std::string> vFieldName;
         std::vector<boost::intrusive_ptr<Accumulator> (*)()> vpAccumulatorFactory;
         std::vector<boost::intrusive_ptr<Expression> > vpExpression;
+        std::vector<AccumulatorColumn* (*)()> vpColumnFactory; // entries may be NULL
 
+        /*
+          When every accumulator has a column form, groups are kept in
+          _groupKeys and _columns instead of in the groups map: each group
+          is an ordinal into the key table, and each accumulator's state for
+          all groups lives in one AccumulatorColumn.
+        */
+        bool _columnar;
+        GroupKeyTable _groupKeys;
+        OwnedPointerVector<AccumulatorColumn> _columns; // parallel to vFieldName
+        size_t _nextGroupOrdinal; // only used when _columnar && !_spilled
 
         Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
+        Document makeDocument(size_t groupOrdinal, bool mergeableOutput);
 
         bool _doingMerge;
         bool _spilled;
         const bool _extSortAllowed;
         const int _maxMemoryUsageBytes;
+        MemoryReservation _memory; // covers the groups held in memory
         boost::scoped_ptr<Variables> _variables;
         std::vector<std::string> _idFieldNames; // used when id is a document
         std::vector<boost::intrusive_ptr<Expression> > _idExpressions;
@@ -600,6 +647,15 @@ namespace mongo {
          */
         BSONObj redactSafePortion() const;
 
+        /** Splits this match for promotion ahead of 'previous'. Returns the predicates that only
+         *  read paths 'previous' passes through, rewritten to the names they have in its input,
+         *  and sets '*remaining' to the predicates that must stay behind it. Either may be empty.
+         *
+         *  $and is split by clause, $or and $nor move only as a whole and $where never moves.
+         */
+        BSONObj splitForPromotion(const PathPreservingDocumentSource& previous,
+                                  BSONObj* remaining) const;
+
         static bool isTextQuery(const BSONObj& query);
         bool isTextQuery() const { return _isTextQuery; }
 
@@ -634,11 +690,40 @@ namespace mongo {
 
         static const char name[];
 
+        /**
+         * Reads the results of one shard cursor, asking the shard for the next batch in the
+         * background as soon as the current one has been received. A merge then doesn't wait on
+         * each shard in turn, and holds at most two batches per shard.
+         */
+        class PrefetchingCursor {
+            MONGO_DISALLOW_COPYING(PrefetchingCursor);
+        public:
+            explicit PrefetchingCursor(DBClientCursor* cursor);
+
+            // Waits for a getMore that is still outstanding.
+            ~PrefetchingCursor();
+
+            bool more();
+            Document next();
+
+        private:
+            // Moves the received batch into _buffered and requests the next one.
+            void refill();
+
+            // Runs on _fetcher to receive the next batch.
+            void fetch();
+
+            DBClientCursor* const _cursor;
+            std::deque<Document> _buffered;
+            boost::scoped_ptr<boost::thread> _fetcher;
+            Status _fetchStatus;
+        };
+
         /** Returns non-owning pointers to cursors managed by this stage.
          *  Call this instead of getNext() if you want access to the raw streams.
          *  This method should only be called at most once.
          */
-        std::vector<DBClientCursor*> getCursors();
+        std::vector<PrefetchingCursor*> getCursors();
 
         /**
          * Returns the next object from the cursor, throwing an appropriate exception if the cursor
@@ -652,6 +737,7 @@ namespace mongo {
             CursorAndConnection(ConnectionString host, NamespaceString ns, CursorId id);
             ScopedDbConnection connection;
             DBClientCursor cursor;
+            PrefetchingCursor prefetching; // must be destroyed before cursor
         };
 
         // using list to enable removing arbitrary elements
@@ -714,7 +800,10 @@ namespace mongo {
         // Sets _tempsNs and prepares it to receive data.
         void prepTempCollection();
 
-        void spill(DBClientBase* conn, const std::vector<BSONObj>& toInsert);
+        // Builds the indexes of _outputNs on _tempNs.
+        void copyIndexes();
+
+        void spill(const std::vector<BSONObj>& toInsert);
 
         bool _done;
 
@@ -723,7 +812,8 @@ namespace mongo {
     };
 
     
-    class DocumentSourceProject : public DocumentSource {
+    class DocumentSourceProject : public DocumentSource
+                                , public PathPreservingDocumentSource {
     public:
         // virtuals from DocumentSource
         virtual boost::optional<Document> getNext();
@@ -733,6 +823,9 @@ namespace mongo {
 
         virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
 
+        // Virtuals for PathPreservingDocumentSource
+        virtual bool getInputPath(const std::string& path, std::string* inputPath) const;
+
         /**
           Create a new projection DocumentSource from BSON.
 
@@ -791,7 +884,8 @@ namespace mongo {
     };
 
     class DocumentSourceSort : public DocumentSource
-                             , public SplittableDocumentSource {
+                             , public SplittableDocumentSource
+                             , public PathPreservingDocumentSource {
     public:
         // virtuals from DocumentSource
         virtual boost::optional<Document> getNext();
@@ -802,6 +896,9 @@ namespace mongo {
 
         virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
 
+        // Virtuals for PathPreservingDocumentSource
+        virtual bool getInputPath(const std::string& path, std::string* inputPath) const;
+
         virtual boost::intrusive_ptr<DocumentSource> getShardSource();
         virtual boost::intrusive_ptr<DocumentSource> getMergeSource();
 
@@ -871,7 +968,8 @@ namespace mongo {
         // not.
         class IteratorFromCursor;
         class IteratorFromBsonArray;
-        void populateFromCursors(const std::vector<DBClientCursor*>& cursors);
+        void populateFromCursors(
+                const std::vector<DocumentSourceMergeCursors::PrefetchingCursor*>& cursors);
         void populateFromBsonArrays(const std::vector<BSONArray>& arrays);
 
         /* these two parallel each other */
@@ -1017,7 +1115,8 @@ namespace mongo {
 
 
     class DocumentSourceUnwind :
-        public DocumentSource {
+        public DocumentSource,
+        public PathPreservingDocumentSource {
     public:
         // virtuals from DocumentSource
         virtual boost::optional<Document> getNext();
@@ -1026,6 +1125,9 @@ namespace mongo {
 
         virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
 
+        // Virtuals for PathPreservingDocumentSource
+        virtual bool getInputPath(const std::string& path, std::string* inputPath) const;
+
         /**
           Create a new projection DocumentSource from BSON.
 
@@ -38,6 +38,7 @@
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/find_constants.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/s/d_state.h"
 
@@ -48,6 +49,9 @@ namespace mongo {
     using boost::shared_ptr;
     using std::string;
 
+    // Whole documents from the cursor are converted to Values only as the pipeline reads them.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorLazyDocuments, bool, true);
+
     DocumentSourceCursor::~DocumentSourceCursor() {
         dispose();
     }
@@ -98,6 +102,14 @@ namespace mongo {
             if (_dependencies) {
                 _currentBatch.push_back(_dependencies->extractFields(obj));
             }
+            else if (internalDocumentSourceCursorLazyDocuments) {
+                // Copies unowned records once so that their fields can be converted after
+                // the executor yields.
+                BSONObj owned = obj.getOwned();
+                _currentBatch.push_back(Document::fromBsonLazily(owned,
+                                                                 owned.sharedBuffer(),
+                                                                 true));
+            }
             else {
                 _currentBatch.push_back(Document::fromBsonWithMetaData(obj));
             }
@@ -35,6 +35,7 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/expression_program.h"
 #include "mongo/db/pipeline/value.h"
 
 namespace mongo {
@@ -100,6 +101,17 @@ namespace mongo {
 
             return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
 
+        } else if (_columnar) {
+            if (_nextGroupOrdinal >= _groupKeys.size())
+                return boost::none;
+
+            Document out = makeDocument(_nextGroupOrdinal, pExpCtx->inShard);
+
+            if (++_nextGroupOrdinal == _groupKeys.size())
+                dispose();
+
+            return out;
+
         } else {
             if (groups.empty())
                 return boost::none;
@@ -118,10 +130,14 @@ namespace mongo {
     void DocumentSourceGroup::dispose() {
         // free our resources
         GroupsMap().swap(groups);
+        _groupKeys.clear();
+        _columns.clear();
         _sorterIterator.reset();
+        _memory.set(0);
 
         // make us look done
         groupsIterator = groups.end();
+        _nextGroupOrdinal = 0;
 
         // free our source's resources
         pSource->dispose();
@@ -132,11 +148,11 @@ namespace mongo {
         // will only be one group. We should take advantage of that to avoid going through the hash
         // table.
         for (size_t i = 0; i < _idExpressions.size(); i++) {
-            _idExpressions[i] = _idExpressions[i]->optimize();
+            _idExpressions[i] = ExpressionCompiled::create(_idExpressions[i]->optimize());
         }
 
         for (size_t i = 0; i < vFieldName.size(); i++) {
-             vpExpression[i] = vpExpression[i]->optimize();
+             vpExpression[i] = ExpressionCompiled::create(vpExpression[i]->optimize());
         }
     }
 
@@ -203,6 +219,8 @@ namespace mongo {
         , populated(false)
         , _doingMerge(false)
         , _spilled(false)
+        , _columnar(false)
+        , _nextGroupOrdinal(0)
         , _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter)
         , _maxMemoryUsageBytes(100*1024*1024)
     {}
@@ -210,16 +228,19 @@ namespace mongo {
     void DocumentSourceGroup::addAccumulator(
             const std::string& fieldName,
             intrusive_ptr<Accumulator> (*pAccumulatorFactory)(),
-            const intrusive_ptr<Expression> &pExpression) {
+            const intrusive_ptr<Expression> &pExpression,
+            AccumulatorColumn* (*pColumnFactory)()) {
         vFieldName.push_back(fieldName);
         vpAccumulatorFactory.push_back(pAccumulatorFactory);
         vpExpression.push_back(pExpression);
+        vpColumnFactory.push_back(pColumnFactory);
     }
 
 
     struct GroupOpDesc {
         const char* name;
         intrusive_ptr<Accumulator> (*factory)();
+        AccumulatorColumn* (*columnFactory)(); // NULL if there is no column form
     };
 
     static int GroupOpDescCmp(const void *pL, const void *pR) {
@@ -232,14 +253,14 @@ namespace mongo {
       GroupOpDescCmp() above.
     */
     static const GroupOpDesc GroupOpTable[] = {
-        {"$addToSet", AccumulatorAddToSet::create},
-        {"$avg", AccumulatorAvg::create},
-        {"$first", AccumulatorFirst::create},
-        {"$last", AccumulatorLast::create},
-        {"$max", AccumulatorMinMax::createMax},
-        {"$min", AccumulatorMinMax::createMin},
-        {"$push", AccumulatorPush::create},
-        {"$sum", AccumulatorSum::create},
+        {"$addToSet", AccumulatorAddToSet::create, NULL},
+        {"$avg", AccumulatorAvg::create, AccumulatorColumn::createAvg},
+        {"$first", AccumulatorFirst::create, AccumulatorColumn::createFirst},
+        {"$last", AccumulatorLast::create, AccumulatorColumn::createLast},
+        {"$max", AccumulatorMinMax::createMax, AccumulatorColumn::createMax},
+        {"$min", AccumulatorMinMax::createMin, AccumulatorColumn::createMin},
+        {"$push", AccumulatorPush::create, NULL},
+        {"$sum", AccumulatorSum::create, AccumulatorColumn::createSum},
     };
 
     static const size_t NGroupOp = sizeof(GroupOpTable)/sizeof(GroupOpTable[0]);
@@ -325,7 +346,8 @@ namespace mongo {
                         pGroupExpr = Expression::parseOperand(subElement, vps);
                     }
 
-                    pGroup->addAccumulator(pFieldName, pOp->factory, pGroupExpr);
+                    pGroup->addAccumulator(pFieldName, pOp->factory, pGroupExpr,
+                                           pOp->columnFactory);
                 }
 
                 uassert(15954, str::stream() <<
@@ -361,6 +383,21 @@ namespace mongo {
         vector<shared_ptr<Sorter<Value, Value>::Iterator> > sortedFiles;
         int memoryUsageBytes = 0;
 
+        // Use the flat per-accumulator columns if every accumulator has one.
+        _columnar = true;
+        for (size_t i = 0; i < numAccumulators; i++) {
+            if (!vpColumnFactory[i]) {
+                _columnar = false;
+                break;
+            }
+        }
+        if (_columnar) {
+            _columns.clear();
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _columns.push_back(vpColumnFactory[i]());
+            }
+        }
+
         // This loop consumes all input from pSource and buckets it based on pIdExpression.
         while (boost::optional<Document> input = pSource->getNext()) {
             if (memoryUsageBytes > _maxMemoryUsageBytes) {
@@ -370,6 +407,11 @@ namespace mongo {
                 sortedFiles.push_back(spill());
                 memoryUsageBytes = 0;
             }
+            else if (!_memory.set(memoryUsageBytes) && _extSortAllowed) {
+                // The server is short of memory, spill early.
+                sortedFiles.push_back(spill());
+                memoryUsageBytes = 0;
+            }
 
             _variables->setRoot(*input);
 
@@ -380,34 +422,52 @@ namespace mongo {
             if (id.missing())
                 id = Value(BSONNULL);
 
-            /*
-              Look for the _id value in the map; if it's not there, add a
-              new entry with a blank accumulator.
-            */
-            const size_t oldSize = groups.size();
-            vector<intrusive_ptr<Accumulator> >& group = groups[id];
-            const bool inserted = groups.size() != oldSize;
-
-            if (inserted) {
-                memoryUsageBytes += id.getApproximateSize();
-
-                // Add the accumulators
-                group.reserve(numAccumulators);
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    group.push_back(vpAccumulatorFactory[i]());
+            bool inserted;
+            if (_columnar) {
+                // Look up the group ordinal, adding fresh column state for a new group.
+                const size_t group = _groupKeys.findOrInsert(id, &inserted);
+                if (inserted) {
+                    memoryUsageBytes += id.getApproximateSize();
+                    for (size_t i = 0; i < numAccumulators; i++) {
+                        memoryUsageBytes += _columns[i]->addGroup();
+                    }
                 }
-            } else {
+
                 for (size_t i = 0; i < numAccumulators; i++) {
-                    // subtract old mem usage. New usage added back after processing.
-                    memoryUsageBytes -= group[i]->memUsageForSorter();
+                    memoryUsageBytes += _columns[i]->process(
+                        group, vpExpression[i]->evaluate(_variables.get()), _doingMerge);
                 }
             }
+            else {
+                /*
+                  Look for the _id value in the map; if it's not there, add a
+                  new entry with a blank accumulator.
+                */
+                const size_t oldSize = groups.size();
+                vector<intrusive_ptr<Accumulator> >& group = groups[id];
+                inserted = groups.size() != oldSize;
 
-            /* tickle all the accumulators for the group we found */
-            dassert(numAccumulators == group.size());
-            for (size_t i = 0; i < numAccumulators; i++) {
-                group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
-                memoryUsageBytes += group[i]->memUsageForSorter();
+                if (inserted) {
+                    memoryUsageBytes += id.getApproximateSize();
+
+                    // Add the accumulators
+                    group.reserve(numAccumulators);
+                    for (size_t i = 0; i < numAccumulators; i++) {
+                        group.push_back(vpAccumulatorFactory[i]());
+                    }
+                } else {
+                    for (size_t i = 0; i < numAccumulators; i++) {
+                        // subtract old mem usage. New usage added back after processing.
+                        memoryUsageBytes -= group[i]->memUsageForSorter();
+                    }
+                }
+
+                /* tickle all the accumulators for the group we found */
+                dassert(numAccumulators == group.size());
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
+                    memoryUsageBytes += group[i]->memUsageForSorter();
+                }
             }
 
             // We are done with the ROOT document so release it.
@@ -425,15 +485,20 @@ namespace mongo {
             }
         }
 
+        _memory.set(memoryUsageBytes);
+
         // These blocks do any final steps necessary to prepare to output results.
         if (!sortedFiles.empty()) {
             _spilled = true;
-            if (!groups.empty()) {
+            if (!groups.empty() || !_groupKeys.empty()) {
                 sortedFiles.push_back(spill());
             }
 
             // We won't be using groups again so free its memory.
             GroupsMap().swap(groups);
+            _groupKeys.clear();
+            _columns.clear();
+            _memory.set(0);
 
             _sorterIterator.reset(
                     Sorter<Value,Value>::Iterator::merge(
@@ -463,6 +528,9 @@ namespace mongo {
     };
 
     shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+        if (_columnar)
+            return spillColumns();
+
         vector<const GroupsMap::value_type*> ptrs; // using pointers to speed sorting
         ptrs.reserve(groups.size());
         for (GroupsMap::const_iterator it=groups.begin(), end=groups.end(); it != end; ++it) {
@@ -502,6 +570,63 @@ namespace mongo {
         return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
     }
 
+    namespace {
+        class OrdinalKeyComparator {
+        public:
+            explicit OrdinalKeyComparator(const GroupKeyTable& keys) : _keys(keys) {}
+            bool operator() (size_t lhs, size_t rhs) const {
+                return Value::compare(_keys.key(lhs), _keys.key(rhs)) < 0;
+            }
+        private:
+            const GroupKeyTable& _keys;
+        };
+    }
+
+    shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spillColumns() {
+        const size_t numGroups = _groupKeys.size();
+        vector<size_t> ordinals(numGroups);
+        for (size_t i = 0; i < numGroups; i++) {
+            ordinals[i] = i;
+        }
+
+        stable_sort(ordinals.begin(), ordinals.end(), OrdinalKeyComparator(_groupKeys));
+
+        // This must write exactly what spill() writes for the same groups since the merge side
+        // always reads them back with regular Accumulators.
+        SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
+        switch (_columns.size()) {
+        case 0: // no values, essentially a distinct
+            for (size_t i=0; i < numGroups; i++) {
+                writer.addAlreadySorted(_groupKeys.key(ordinals[i]), Value());
+            }
+            break;
+
+        case 1: // just one value, use optimized serialization as single Value
+            for (size_t i=0; i < numGroups; i++) {
+                writer.addAlreadySorted(_groupKeys.key(ordinals[i]),
+                                        _columns[0]->getValue(ordinals[i], /*toBeMerged=*/true));
+            }
+            break;
+
+        default: // multiple values, serialize as array-typed Value
+            for (size_t i=0; i < numGroups; i++) {
+                vector<Value> accums;
+                for (size_t j=0; j < _columns.size(); j++) {
+                    accums.push_back(_columns[j]->getValue(ordinals[i], /*toBeMerged=*/true));
+                }
+                writer.addAlreadySorted(_groupKeys.key(ordinals[i]), Value::consume(accums));
+            }
+            break;
+        }
+
+        _groupKeys.clear();
+        for (size_t i = 0; i < _columns.size(); i++) {
+            _columns[i]->clear();
+        }
+
+        return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+    }
+
     void DocumentSourceGroup::parseIdExpression(BSONElement groupField,
                                                 const VariablesParseState& vps) {
         if (groupField.type() == Object && !groupField.Obj().isEmpty()) {
@@ -593,6 +718,28 @@ namespace mongo {
         return out.freeze();
     }
 
+    Document DocumentSourceGroup::makeDocument(size_t groupOrdinal, bool mergeableOutput) {
+        const size_t n = vFieldName.size();
+        MutableDocument out (1 + n);
+
+        /* add the _id field */
+        out.addField("_id", expandId(_groupKeys.key(groupOrdinal)));
+
+        /* add the rest of the fields */
+        for(size_t i = 0; i < n; ++i) {
+            Value val = _columns[i]->getValue(groupOrdinal, mergeableOutput);
+            if (val.missing()) {
+                // we return null in this case so return objects are predictable
+                out.addField(vFieldName[i], Value(BSONNULL));
+            }
+            else {
+                out.addField(vFieldName[i], val);
+            }
+        }
+
+        return out.freeze();
+    }
+
     intrusive_ptr<DocumentSource> DocumentSourceGroup::getShardSource() {
         return this; // No modifications necessary when on shard
     }
@@ -618,7 +765,8 @@ namespace mongo {
             */
             pMerger->addAccumulator(
                 vFieldName[i], vpAccumulatorFactory[i],
-                ExpressionFieldPath::parse("$$ROOT." + vFieldName[i], vps));
+                ExpressionFieldPath::parse("$$ROOT." + vFieldName[i], vps),
+                vpColumnFactory[i]);
         }
 
         pMerger->_variables.reset(new Variables(idGenerator.getIdCount()));
@@ -296,6 +296,82 @@ namespace {
         return redactSafePortionTopLevel(getQuery()).toBson();
     }
 
+namespace {
+    // This block contains the functions that make up the implementation of
+    // DocumentSourceMatch::splitForPromotion(). Like the block above they only see queries the
+    // Matcher has already parsed.
+
+    // Appends 'clause' to 'out' with every path it reads renamed to the path 'previous' takes
+    // it from. Returns false, leaving 'out' partly built, if any path isn't passed through.
+    bool renameClause(const BSONElement& clause,
+                      const PathPreservingDocumentSource& previous,
+                      BSONObjBuilder* out) {
+        const StringData fieldName = clause.fieldNameStringData();
+        if (fieldName[0] != '$') {
+            // Operators below a field name, including $elemMatch, only read paths relative to it.
+            string inputPath;
+            if (!previous.getInputPath(fieldName.toString(), &inputPath))
+                return false;
+            out->appendAs(clause, inputPath);
+            return true;
+        }
+
+        if (fieldName != "$and" && fieldName != "$or" && fieldName != "$nor")
+            return false;
+
+        BSONArrayBuilder clauses(out->subarrayStart(fieldName));
+        BSONForEach(elem, clause.Obj()) {
+            BSONObjBuilder sub(clauses.subobjStart());
+            BSONForEach(subClause, elem.Obj()) {
+                if (!renameClause(subClause, previous, &sub))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void splitTopLevel(const BSONObj& query,
+                       const PathPreservingDocumentSource& previous,
+                       BSONArrayBuilder* movable,
+                       BSONArrayBuilder* remaining) {
+        BSONForEach(clause, query) {
+            if (str::equals(clause.fieldName(), "$and")) {
+                // $and can be split by clause, unlike $or and $nor.
+                BSONForEach(elem, clause.Obj()) {
+                    splitTopLevel(elem.Obj(), previous, movable, remaining);
+                }
+                continue;
+            }
+
+            BSONObjBuilder renamed;
+            if (renameClause(clause, previous, &renamed)) {
+                movable->append(renamed.obj());
+            }
+            else {
+                remaining->append(clause.wrap());
+            }
+        }
+    }
+
+    BSONObj combineClauses(const BSONArray& clauses) {
+        if (clauses.isEmpty())
+            return BSONObj();
+        if (clauses.nFields() == 1)
+            return clauses.firstElement().Obj().getOwned();
+        return BSON("$and" << clauses);
+    }
+}
+
+    BSONObj DocumentSourceMatch::splitForPromotion(const PathPreservingDocumentSource& previous,
+                                                   BSONObj* remaining) const {
+        BSONArrayBuilder movable;
+        BSONArrayBuilder rest;
+        splitTopLevel(getQuery(), previous, &movable, &rest);
+
+        *remaining = combineClauses(rest.arr());
+        return combineClauses(movable.arr());
+    }
+
     void DocumentSourceMatch::setSource(DocumentSource* source) {
         uassert(17313, "$match with $text is only allowed as the first pipeline stage",
                 !_isTextQuery);
@@ -32,6 +32,8 @@
 
 #include <boost/make_shared.hpp>
 
+#include "mongo/stdx/functional.h"
+
 namespace mongo {
 
     using boost::intrusive_ptr;
@@ -99,14 +101,69 @@ namespace mongo {
             CursorId id)
         : connection(host)
         , cursor(connection.get(), ns, id, 0, 0)
+        , prefetching(&cursor)
+    {}
+
+    DocumentSourceMergeCursors::PrefetchingCursor::PrefetchingCursor(DBClientCursor* cursor)
+        : _cursor(cursor)
+        , _fetchStatus(Status::OK())
     {}
 
-    vector<DBClientCursor*> DocumentSourceMergeCursors::getCursors() {
+    DocumentSourceMergeCursors::PrefetchingCursor::~PrefetchingCursor() {
+        if (_fetcher)
+            _fetcher->join();
+    }
+
+    bool DocumentSourceMergeCursors::PrefetchingCursor::more() {
+        if (_buffered.empty())
+            refill();
+        return !_buffered.empty();
+    }
+
+    Document DocumentSourceMergeCursors::PrefetchingCursor::next() {
+        verify(more());
+        const Document next = _buffered.front();
+        _buffered.pop_front();
+        return next;
+    }
+
+    void DocumentSourceMergeCursors::PrefetchingCursor::refill() {
+        if (_fetcher) {
+            _fetcher->join(); // blocks here until the shard returns the batch
+            _fetcher.reset();
+            uassertStatusOK(_fetchStatus);
+        }
+
+        while (_cursor->moreInCurrentBatch()) {
+            _buffered.push_back(nextSafeFrom(_cursor));
+        }
+
+        // The cursor is only used by _fetcher until the next refill(), so the getMore can run
+        // while the documents just buffered are merged.
+        if (!_cursor->isDead()) {
+            _fetcher.reset(new boost::thread(stdx::bind(&PrefetchingCursor::fetch, this)));
+        }
+    }
+
+    void DocumentSourceMergeCursors::PrefetchingCursor::fetch() {
+        try {
+            _cursor->more();
+        }
+        catch (const DBException& e) {
+            _fetchStatus = e.toStatus(str::stream() << "error reading response from "
+                                                    << _cursor->originalHost());
+        }
+        catch (const std::exception& e) {
+            _fetchStatus = Status(ErrorCodes::InternalError, e.what());
+        }
+    }
+
+    vector<DocumentSourceMergeCursors::PrefetchingCursor*> DocumentSourceMergeCursors::getCursors() {
         verify(_unstarted);
         start();
-        vector<DBClientCursor*> out;
+        vector<PrefetchingCursor*> out;
         for (Cursors::const_iterator it = _cursors.begin(); it !=_cursors.end(); ++it) {
-            out.push_back(&((*it)->cursor));
+            out.push_back(&((*it)->prefetching));
         }
 
         return out;
@@ -154,7 +211,7 @@ namespace mongo {
             start();
 
         // purge eof cursors and release their connections
-        while (!_cursors.empty() && !(*_currentCursor)->cursor.more()) {
+        while (!_cursors.empty() && !(*_currentCursor)->prefetching.more()) {
             (*_currentCursor)->connection.done();
             _cursors.erase(_currentCursor);
             _currentCursor = _cursors.begin();
@@ -163,7 +220,7 @@ namespace mongo {
         if (_cursors.empty())
             return boost::none;
 
-        const Document next = nextSafeFrom(&((*_currentCursor)->cursor));
+        const Document next = (*_currentCursor)->prefetching.next();
 
         // advance _currentCursor, wrapping if needed
         if (++_currentCursor == _cursors.end())
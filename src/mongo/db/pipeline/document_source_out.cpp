@@ -30,11 +30,18 @@
 
 #include "mongo/db/pipeline/document_source.h"
 
+#include "mongo/db/server_parameters.h"
+
 namespace mongo {
 
     using boost::intrusive_ptr;
     using std::vector;
 
+    // Build the output collection's indexes on the temporary collection once all documents are
+    // in, with the bulk index builder, instead of maintaining them through every insert. The _id
+    // index is always there from the start.
+    MONGO_EXPORT_SERVER_PARAMETER(aggOutDeferIndexBuilds, bool, true);
+
     const char DocumentSourceOut::outName[] = "$out";
 
     DocumentSourceOut::~DocumentSourceOut() {
@@ -83,6 +90,13 @@ namespace mongo {
                     ok);
         }
 
+        if (!aggOutDeferIndexBuilds)
+            copyIndexes();
+    }
+
+    void DocumentSourceOut::copyIndexes() {
+        DBClientBase* conn = _mongod->directClient();
+
         // copy indexes on _outputNs to _tempNs
         const std::list<BSONObj> indexes = conn->getIndexSpecs(_outputNs);
         for (std::list<BSONObj>::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
@@ -100,11 +114,16 @@ namespace mongo {
         }
     }
 
-    void DocumentSourceOut::spill(DBClientBase* conn, const vector<BSONObj>& toInsert) {
-        conn->insert(_tempNs.ns(), toInsert);
-        BSONObj err = conn->getLastErrorDetailed();
-        uassert(16996, str::stream() << "insert for $out failed: " << err,
-                DBClientWithCommands::getLastErrorString(err).empty());
+    void DocumentSourceOut::spill(const vector<BSONObj>& toInsert) {
+        try {
+            _mongod->insert(_tempNs, toInsert);
+        }
+        catch (const DBException& ex) {
+            Status status(ex.toStatus());
+            if (ErrorCodes::isInterruption(status.code()))
+                throw;
+            uasserted(16996, str::stream() << "insert for $out failed: " << status.toString());
+        }
     }
 
     boost::optional<Document> DocumentSourceOut::getNext() {
@@ -116,7 +135,6 @@ namespace mongo {
         _done = true;
 
         verify(_mongod);
-        DBClientBase* conn = _mongod->directClient();
 
         prepTempCollection();
         verify(_tempNs.size() != 0);
@@ -127,7 +145,7 @@ namespace mongo {
             BSONObj toInsert = next->toBson();
             bufferedBytes += toInsert.objsize();
             if (!bufferedObjects.empty() && bufferedBytes > BSONObjMaxUserSize) {
-                spill(conn, bufferedObjects);
+                spill(bufferedObjects);
                 bufferedObjects.clear();
                 bufferedBytes = toInsert.objsize();
             }
@@ -135,7 +153,10 @@ namespace mongo {
         }
 
         if (!bufferedObjects.empty())
-            spill(conn, bufferedObjects);
+            spill(bufferedObjects);
+
+        if (aggOutDeferIndexBuilds)
+            copyIndexes();
 
         // Checking again to make sure we didn't become sharded while running.
         uassert(17018, str::stream() << "namespace '" << _outputNs.ns()
@@ -147,7 +168,7 @@ namespace mongo {
                            << "dropTarget" << true
                            );
         BSONObj info;
-        bool ok = conn->runCommand("admin", rename, info);
+        bool ok = _mongod->directClient()->runCommand("admin", rename, info);
         uassert(16997,  str::stream() << "renameCollection for $out failed: " << info,
                 ok);
 
@@ -35,6 +35,7 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/util/stringutils.h"
 
 namespace mongo {
 
@@ -124,4 +125,10 @@ namespace mongo {
         pEO->addDependencies(deps, &path);
         return EXHAUSTIVE_FIELDS;
     }
+
+    bool DocumentSourceProject::getInputPath(const string& path, string* inputPath) const {
+        vector<string> fieldNames;
+        splitStringDelim(path, &fieldNames, '.');
+        return pEO->getInputPath(fieldNames, inputPath);
+    }
 }
@@ -147,6 +147,16 @@ namespace mongo {
         return SEE_NEXT;
     }
 
+    bool DocumentSourceSort::getInputPath(const string& path, string* inputPath) const {
+        // A sort only reorders, but filtering before a coalesced $limit changes which documents
+        // survive it.
+        if (limitSrc)
+            return false;
+
+        *inputPath = path;
+        return true;
+    }
+
 
     intrusive_ptr<DocumentSource> DocumentSourceSort::createFromBson(
             BSONElement elem,
@@ -250,22 +260,24 @@ namespace mongo {
 
     class DocumentSourceSort::IteratorFromCursor : public MySorter::Iterator {
     public:
-        IteratorFromCursor(DocumentSourceSort* sorter, DBClientCursor* cursor)
+        IteratorFromCursor(DocumentSourceSort* sorter,
+                           DocumentSourceMergeCursors::PrefetchingCursor* cursor)
             : _sorter(sorter)
             , _cursor(cursor)
         {}
 
         bool more() { return _cursor->more(); }
         Data next() {
-            const Document doc = DocumentSourceMergeCursors::nextSafeFrom(_cursor);
+            const Document doc = _cursor->next();
             return make_pair(_sorter->extractKey(doc), doc);
         }
     private:
         DocumentSourceSort* _sorter;
-        DBClientCursor* _cursor;
+        DocumentSourceMergeCursors::PrefetchingCursor* _cursor;
     };
 
-    void DocumentSourceSort::populateFromCursors(const vector<DBClientCursor*>& cursors) {
+    void DocumentSourceSort::populateFromCursors(
+            const vector<DocumentSourceMergeCursors::PrefetchingCursor*>& cursors) {
         vector<boost::shared_ptr<MySorter::Iterator> > iterators;
         for (size_t i = 0; i < cursors.size(); i++) {
             iterators.push_back(boost::make_shared<IteratorFromCursor>(this, cursors[i]));
@@ -61,7 +61,7 @@ namespace mongo {
         const FieldPath _unwindPath;
 
         Value _inputArray;
-        MutableDocument _output;
+        Document _input;
 
         // Document indexes of the field path components.
         vector<Position> _unwindPathFieldIndexes;
@@ -77,7 +77,7 @@ namespace mongo {
 
         // Reset document specific attributes.
         _inputArray = Value();
-        _output.reset(document);
+        _input = document;
         _unwindPathFieldIndexes.clear();
         _index = 0;
 
@@ -100,16 +100,12 @@ namespace mongo {
         if (_inputArray.missing() || _index == _inputArray.getArrayLength())
             return boost::none;
 
-        // If needed, this will automatically clone all the documents along the
-        // field path so that the end values are not shared across documents
-        // that have come out of this pipeline operator.  This is a partial deep
-        // clone. Because the value at the end will be replaced, everything
-        // along the path leading to that will be replaced in order not to share
-        // that change with any other clones (or the original).
-
-        _output.setNestedField(_unwindPathFieldIndexes, _inputArray[_index]);
+        // Each output document shares the fields of the input document, and of the documents
+        // along the field path, and only replaces the array with the current element. The
+        // fields are copied only if a later stage changes the output or reads all of it.
+        Document output = Document::overlay(_input, _unwindPathFieldIndexes, _inputArray[_index]);
         _index++;
-        return _output.peek();
+        return output;
     }
 
     const char DocumentSourceUnwind::unwindName[] = "$unwind";
@@ -152,6 +148,21 @@ namespace mongo {
         return SEE_NEXT;
     }
 
+    bool DocumentSourceUnwind::getInputPath(const string& path, string* inputPath) const {
+        // Only the unwound array, the documents holding it and the values inside it change.
+        const string unwound = _unwindPath->getPath(false);
+        if (str::startsWith(path, unwound)) {
+            if (path.size() == unwound.size() || path[unwound.size()] == '.')
+                return false;
+        }
+        else if (str::startsWith(unwound, path) && unwound[path.size()] == '.') {
+            return false;
+        }
+
+        *inputPath = path;
+        return true;
+    }
+
     void DocumentSourceUnwind::unwindPath(const FieldPath &fieldPath) {
         // Can't set more than one unwind path.
         uassert(15979, str::stream() << unwindName << "can't unwind more than one path",
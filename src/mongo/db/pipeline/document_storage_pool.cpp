@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_storage_pool.h"
+
+#include "mongo/util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+namespace {
+    ThreadLocalValue<DocumentStoragePool*> currentPool;
+}
+
+    DocumentStoragePool::DocumentStoragePool() : _cachedBytes(0) {}
+
+    DocumentStoragePool::~DocumentStoragePool() {
+        for (int i = 0; i < kNumSizeClasses; i++) {
+            for (size_t j = 0; j < _free[i].size(); j++) {
+                delete [] _free[i][j];
+            }
+        }
+    }
+
+    DocumentStoragePool::Scope::Scope(DocumentStoragePool* pool)
+        : _previous(currentPool.get()) {
+        currentPool.set(pool);
+    }
+
+    DocumentStoragePool::Scope::~Scope() {
+        currentPool.set(_previous);
+    }
+
+    int DocumentStoragePool::sizeClass(size_t bytes) {
+        size_t size = kMinCachedSize;
+        for (int i = 0; i < kNumSizeClasses; i++, size *= 2) {
+            if (bytes == size)
+                return i;
+        }
+        return -1;
+    }
+
+    char* DocumentStoragePool::allocate(size_t bytes) {
+        DocumentStoragePool* pool = currentPool.get();
+        if (pool) {
+            const int sc = sizeClass(bytes);
+            if (sc >= 0 && !pool->_free[sc].empty()) {
+                char* buffer = pool->_free[sc].back();
+                pool->_free[sc].pop_back();
+                pool->_cachedBytes -= bytes;
+                return buffer;
+            }
+        }
+        return new char[bytes];
+    }
+
+    void DocumentStoragePool::release(char* buffer, size_t bytes) {
+        if (!buffer)
+            return;
+
+        DocumentStoragePool* pool = currentPool.get();
+        if (pool && pool->_cachedBytes + bytes <= size_t(kMaxCachedBytes)) {
+            const int sc = sizeClass(bytes);
+            if (sc >= 0) {
+                pool->_free[sc].push_back(buffer);
+                pool->_cachedBytes += bytes;
+                return;
+            }
+        }
+        delete [] buffer;
+    }
+}
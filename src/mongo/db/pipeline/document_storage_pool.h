@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace mongo {
+
+    /**
+     * Keeps the buffers of freed DocumentStorage objects for reuse by the pipeline that owns the
+     * pool. While a Scope is active on a thread, DocumentStorage allocates from and frees to
+     * that pool instead of the heap. Every buffer still comes from operator new[], so documents
+     * may outlive the pool or die on another thread. Cached buffers are freed in bulk when the
+     * pool is destroyed.
+     */
+    class DocumentStoragePool : boost::noncopyable {
+    public:
+        DocumentStoragePool();
+        ~DocumentStoragePool();
+
+        /**
+         * Makes 'pool' the current thread's pool until destroyed, restoring the previous one
+         * after. A NULL pool turns pooling off for the scope.
+         */
+        class Scope : boost::noncopyable {
+        public:
+            explicit Scope(DocumentStoragePool* pool);
+            ~Scope();
+
+        private:
+            DocumentStoragePool* _previous;
+        };
+
+        /** Returns a buffer of 'bytes', recycled from the current thread's pool if possible. */
+        static char* allocate(size_t bytes);
+
+        /** Hands a buffer from allocate() back to the current thread's pool, or frees it. */
+        static void release(char* buffer, size_t bytes);
+
+        size_t cachedBytes() const { return _cachedBytes; }
+
+    private:
+        enum {
+            kMinCachedSize = 128, // smallest buffer DocumentStorage allocates
+            kNumSizeClasses = 9, // powers of two from 128 bytes to 32KB
+            kMaxCachedBytes = 4 * 1024 * 1024,
+        };
+
+        /** Returns the free list index for 'bytes', or -1 if buffers that size are not kept. */
+        static int sizeClass(size_t bytes);
+
+        std::vector<char*> _free[kNumSizeClasses];
+        size_t _cachedBytes;
+    };
+}
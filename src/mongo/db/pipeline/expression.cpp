@@ -36,8 +36,10 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/path_internal.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/expression_program.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/string_map.h"
@@ -375,6 +377,10 @@ namespace {
         }
     }
 
+    int Expression::compile(ExpressionProgram* program) const {
+        return program->emit(ExpressionProgram::kEval, this, vector<int>());
+    }
+
     /* ------------------------- ExpressionAdd ----------------------------- */
 
     Value ExpressionAdd::evaluateInternal(Variables* vars) const {
@@ -443,6 +449,10 @@ namespace {
         return "$add";
     }
 
+    int ExpressionAdd::compile(ExpressionProgram* program) const {
+        return compileOperands(program, ExpressionProgram::kAdd);
+    }
+
     /* ------------------------- ExpressionAllElementsTrue -------------------------- */
 
     Value ExpressionAllElementsTrue::evaluateInternal(Variables* vars) const {
@@ -689,6 +699,10 @@ namespace {
         return cmpLookup[cmpOp].name;
     }
 
+    int ExpressionCompare::compile(ExpressionProgram* program) const {
+        return compileOperands(program, ExpressionProgram::kCompare, cmpOp);
+    }
+
     /* ------------------------- ExpressionConcat ----------------------------- */
 
     Value ExpressionConcat::evaluateInternal(Variables* vars) const {
@@ -715,6 +729,10 @@ namespace {
         return "$concat";
     }
 
+    int ExpressionConcat::compile(ExpressionProgram* program) const {
+        return compileOperands(program, ExpressionProgram::kConcat);
+    }
+
     /* ----------------------- ExpressionCond ------------------------------ */
 
     Value ExpressionCond::evaluateInternal(Variables* vars) const {
@@ -794,6 +812,10 @@ namespace {
         return pValue;
     }
 
+    int ExpressionConstant::compile(ExpressionProgram* program) const {
+        return program->emitConstant(this, pValue);
+    }
+
     Value ExpressionConstant::serialize(bool explain) const {
         return serializeConstant(pValue);
     }
@@ -1057,6 +1079,10 @@ namespace {
         return "$divide";
     }
 
+    int ExpressionDivide::compile(ExpressionProgram* program) const {
+        return compileOperands(program, ExpressionProgram::kDivide);
+    }
+
     /* ---------------------- ExpressionObject --------------------------- */
 
     intrusive_ptr<ExpressionObject> ExpressionObject::create() {
@@ -1075,7 +1101,7 @@ namespace {
     intrusive_ptr<Expression> ExpressionObject::optimize() {
         for (FieldMap::iterator it(_expressions.begin()); it!=_expressions.end(); ++it) {
             if (it->second)
-                it->second = it->second->optimize();
+                it->second = ExpressionCompiled::create(it->second->optimize());
         }
 
         return intrusive_ptr<Expression>(this);
@@ -1261,6 +1287,55 @@ namespace {
         return _expressions.size() + (_excludeId ? 0 : 1);
     }
 
+    bool ExpressionObject::getInputPath(const vector<string>& path, string* inputPath) const {
+        if (path.empty())
+            return false;
+        return getInputPath(path, 0, inputPath);
+    }
+
+    bool ExpressionObject::getInputPath(const vector<string>& path,
+                                        size_t index,
+                                        string* inputPath) const {
+        const string& fieldName = path[index];
+        FieldMap::const_iterator it = _expressions.find(fieldName);
+        if (it == _expressions.end()) {
+            if (_atRoot && !_excludeId && fieldName == "_id") {
+                *inputPath = boost::algorithm::join(path, ".");
+                return true;
+            }
+            return false;
+        }
+
+        const Expression* expr = it->second.get();
+        if (!expr) {
+            // an inclusion copies the whole field
+            *inputPath = boost::algorithm::join(path, ".");
+            return true;
+        }
+
+        if (const ExpressionObject* exprObj = dynamic_cast<const ExpressionObject*>(expr)) {
+            // Below a nested object, arrays lose their non-object elements, so positions shift.
+            if (index + 1 == path.size() || isAllDigits(path[index + 1]))
+                return false;
+            return exprObj->getInputPath(path, index + 1, inputPath);
+        }
+
+        // Only a rename of a whole top-level field keeps its value as is. Longer field paths
+        // fan out over arrays and variables other than the input document hold other values.
+        const ExpressionFieldPath* fieldPath = dynamic_cast<const ExpressionFieldPath*>(expr);
+        if (!_atRoot || !fieldPath
+                || fieldPath->getVariableId() != Variables::ROOT_ID
+                || fieldPath->getFieldPath().getPathLength() != 2)
+            return false;
+
+        *inputPath = fieldPath->getFieldPath().getFieldName(1);
+        for (size_t i = index + 1; i < path.size(); ++i) {
+            *inputPath += '.';
+            *inputPath += path[i];
+        }
+        return true;
+    }
+
     Document ExpressionObject::evaluateDocument(Variables* vars) const {
         /* create and populate the result */
         MutableDocument out (getSizeHint());
@@ -1462,6 +1537,10 @@ namespace {
         }
     }
 
+    int ExpressionFieldPath::compile(ExpressionProgram* program) const {
+        return program->emit(ExpressionProgram::kFieldPath, this, vector<int>());
+    }
+
     Value ExpressionFieldPath::serialize(bool explain) const {
         if (_fieldPath.getFieldName(0) == "CURRENT" && _fieldPath.getPathLength() > 1) {
             // use short form for "$$CURRENT.foo" but not just "$$CURRENT"
@@ -1802,6 +1881,10 @@ namespace {
         return "$mod";
     }
 
+    int ExpressionMod::compile(ExpressionProgram* program) const {
+        return compileOperands(program, ExpressionProgram::kMod);
+    }
+
     /* ------------------------ ExpressionMonth ----------------------------- */
 
     Value ExpressionMonth::evaluateInternal(Variables* vars) const {
@@ -1861,6 +1944,10 @@ namespace {
         return "$multiply";
     }
 
+    int ExpressionMultiply::compile(ExpressionProgram* program) const {
+        return compileOperands(program, ExpressionProgram::kMultiply);
+    }
+
     /* ------------------------- ExpressionHour ----------------------------- */
 
     Value ExpressionHour::evaluateInternal(Variables* vars) const {
@@ -1891,6 +1978,15 @@ namespace {
 
     /* ------------------------ ExpressionNary ----------------------------- */
 
+    int ExpressionNary::compileOperands(ExpressionProgram* program, int opCode, int arg) const {
+        vector<int> operands;
+        operands.reserve(vpOperand.size());
+        for (size_t i = 0; i < vpOperand.size(); ++i) {
+            operands.push_back(vpOperand[i]->compile(program));
+        }
+        return program->emit(static_cast<ExpressionProgram::OpCode>(opCode), this, operands, arg);
+    }
+
     intrusive_ptr<Expression> ExpressionNary::optimize() {
         const size_t n = vpOperand.size();
 
@@ -2453,6 +2549,10 @@ namespace {
         return "$subtract";
     }
 
+    int ExpressionSubtract::compile(ExpressionProgram* program) const {
+        return compileOperands(program, ExpressionProgram::kSubtract);
+    }
+
     /* ------------------------- ExpressionToLower ----------------------------- */
 
     Value ExpressionToLower::evaluateInternal(Variables* vars) const {
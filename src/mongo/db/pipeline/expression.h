@@ -46,6 +46,7 @@ namespace mongo {
     class BSONElement;
     class BSONObjBuilder;
     class DocumentSource;
+    class ExpressionProgram;
 
     // TODO: Look into merging with ExpressionContext and possibly ObjectCtx.
     /// The state used as input and working space for Expressions.
@@ -283,6 +284,13 @@ namespace mongo {
          */
         virtual Value evaluateInternal(Variables* vars) const = 0;
 
+        /**
+         * Appends instructions computing this expression to 'program' and returns the register
+         * holding the result. By default the whole subtree is evaluated by evaluateInternal();
+         * expressions with a bytecode form override this.
+         */
+        virtual int compile(ExpressionProgram* program) const;
+
     protected:
         typedef std::vector<boost::intrusive_ptr<Expression> > ExpressionVector;
     };
@@ -326,6 +334,12 @@ namespace mongo {
     protected:
         ExpressionNary() {}
 
+        /**
+         * Compiles the operands in order, then an instruction applying 'opCode' (an
+         * ExpressionProgram::OpCode) to their registers.
+         */
+        int compileOperands(ExpressionProgram* program, int opCode, int arg = 0) const;
+
         ExpressionVector vpOperand;
     };
 
@@ -366,6 +380,7 @@ namespace mongo {
     public:
         // virtuals from Expression
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual const char *getOpName() const;
         virtual bool isAssociativeAndCommutative() const { return true; }
     };
@@ -434,6 +449,7 @@ namespace mongo {
 
         // virtuals from ExpressionNary
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual const char *getOpName() const;
 
         static boost::intrusive_ptr<Expression> parse(
@@ -452,6 +468,7 @@ namespace mongo {
     public:
         // virtuals from ExpressionNary
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual const char *getOpName() const;
     };
 
@@ -475,6 +492,7 @@ namespace mongo {
         virtual boost::intrusive_ptr<Expression> optimize();
         virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual const char *getOpName() const;
         virtual Value serialize(bool explain) const;
 
@@ -563,6 +581,7 @@ namespace mongo {
     public:
         // virtuals from ExpressionNary
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual const char *getOpName() const;
     };
 
@@ -573,6 +592,7 @@ namespace mongo {
         virtual boost::intrusive_ptr<Expression> optimize();
         virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual Value serialize(bool explain) const;
 
         /*
@@ -596,6 +616,7 @@ namespace mongo {
             const VariablesParseState& vps);
 
         const FieldPath& getFieldPath() const { return _fieldPath; }
+        Variables::Id getVariableId() const { return _variable; }
 
     private:
         ExpressionFieldPath(const std::string& fieldPath, Variables::Id variable);
@@ -734,6 +755,7 @@ namespace mongo {
     public:
         // virtuals from ExpressionNary
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual const char *getOpName() const;
     };
     
@@ -742,6 +764,7 @@ namespace mongo {
     public:
         // virtuals from Expression
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual const char *getOpName() const;
         virtual bool isAssociativeAndCommutative() const { return true; }
     };
@@ -860,9 +883,21 @@ namespace mongo {
 
         void excludeId(bool b) { _excludeId = b; }
 
+        /**
+         * Returns true if the field named by the components of 'path' holds, in the document
+         * this object builds, exactly the values the input document holds at '*inputPath', and
+         * sets '*inputPath'. Inclusions pass their fields through; a top-level "$field" rename
+         * passes through the named field.
+         */
+        bool getInputPath(const std::vector<std::string>& path, std::string* inputPath) const;
+
     private:
         ExpressionObject(bool atRoot);
 
+        bool getInputPath(const std::vector<std::string>& path,
+                          size_t index,
+                          std::string* inputPath) const;
+
         // Mapping from fieldname to the Expression that generates its value.
         // NULL expression means inclusion from source document.
         typedef std::map<std::string, boost::intrusive_ptr<Expression> > FieldMap;
@@ -971,6 +1006,7 @@ namespace mongo {
     public:
         // virtuals from ExpressionNary
         virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
         virtual const char *getOpName() const;
     };
 
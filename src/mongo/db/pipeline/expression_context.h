@@ -32,6 +32,7 @@
 
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/document_storage_pool.h"
 #include "mongo/util/intrusive_counter.h"
 
 namespace mongo {
@@ -67,5 +68,8 @@ namespace mongo {
         OperationContext* opCtx;
         static const int interruptCheckPeriod = 128;
         int interruptCounter; // when 0, check interruptStatus
+
+        // Recycles document buffers while the pipeline runs. See DocumentStoragePool::Scope.
+        DocumentStoragePool documentPool;
     };
 }
@@ -0,0 +1,350 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/expression_program.h"
+
+#include <cmath>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    using boost::intrusive_ptr;
+    using std::vector;
+
+    // Evaluate arithmetic, comparison and $concat expressions in $project and $group through
+    // ExpressionProgram rather than the expression tree.
+    MONGO_EXPORT_SERVER_PARAMETER(internalAggCompileExpressions, bool, true);
+
+    /* ------------------------- ExpressionProgram ----------------------------- */
+
+    ExpressionProgram::ExpressionProgram(const Expression* root)
+        : _root(root) {
+        // The root's instruction comes last, after everything it depends on.
+        _root->compile(this);
+        _registers.resize(_code.size());
+        _failed.resize(_code.size());
+    }
+
+    int ExpressionProgram::emit(OpCode op,
+                                const Expression* expr,
+                                const vector<int>& operands,
+                                int arg) {
+        Instruction ins;
+        ins.op = op;
+        ins.expr = expr;
+        ins.firstOperand = _operands.size();
+        ins.numOperands = operands.size();
+        ins.arg = arg;
+
+        _operands.insert(_operands.end(), operands.begin(), operands.end());
+        _code.push_back(ins);
+        return _code.size() - 1;
+    }
+
+    int ExpressionProgram::emitConstant(const Expression* expr, const Value& value) {
+        _constants.push_back(value);
+        return emit(kConstant, expr, vector<int>(), _constants.size() - 1);
+    }
+
+    bool ExpressionProgram::isWorthCompiling(const Expression* expr) {
+        // A lone constant, field path or operator without a bytecode form would run just as it
+        // does in the tree.
+        return dynamic_cast<const ExpressionAdd*>(expr)
+            || dynamic_cast<const ExpressionSubtract*>(expr)
+            || dynamic_cast<const ExpressionMultiply*>(expr)
+            || dynamic_cast<const ExpressionDivide*>(expr)
+            || dynamic_cast<const ExpressionMod*>(expr)
+            || dynamic_cast<const ExpressionCompare*>(expr)
+            || dynamic_cast<const ExpressionConcat*>(expr);
+    }
+
+    Value ExpressionProgram::run(Variables* vars) {
+        const size_t n = _code.size();
+        for (size_t pc = 0; pc < n; ++pc) {
+            const Instruction& ins = _code[pc];
+            Value* out = &_registers[pc];
+            _failed[pc] = false;
+
+            bool done = false;
+            switch (ins.op) {
+            case kConstant:
+                *out = _constants[ins.arg];
+                continue;
+            case kFieldPath:
+                // Field paths never fail; call the implementation directly.
+                *out = static_cast<const ExpressionFieldPath*>(ins.expr)->
+                    ExpressionFieldPath::evaluateInternal(vars);
+                continue;
+            case kEval:
+                break;
+            case kAdd:
+                done = add(ins, out);
+                break;
+            case kSubtract:
+                done = subtract(ins, out);
+                break;
+            case kMultiply:
+                done = multiply(ins, out);
+                break;
+            case kDivide:
+                done = divide(ins, out);
+                break;
+            case kMod:
+                done = mod(ins, out);
+                break;
+            case kCompare:
+                done = compare(ins, out);
+                break;
+            case kConcat:
+                done = concat(ins, out);
+                break;
+            }
+
+            if (!done)
+                evaluateNode(ins, vars, pc);
+        }
+
+        if (_failed[n - 1]) {
+            // Raise the error the tree interpreter raises.
+            return _root->evaluateInternal(vars);
+        }
+
+        Value result = _registers[n - 1];
+
+        // Don't keep the documents this run read from alive until the next one.
+        for (size_t i = 0; i < n; ++i) {
+            _registers[i] = Value();
+        }
+        return result;
+    }
+
+    void ExpressionProgram::evaluateNode(const Instruction& ins, Variables* vars, size_t reg) {
+        try {
+            _registers[reg] = ins.expr->evaluateInternal(vars);
+        }
+        catch (const DBException&) {
+            // Whether this error is raised depends on the operators above this node, which
+            // will evaluate their own nodes in turn.
+            _failed[reg] = true;
+        }
+    }
+
+    // The fast paths below mirror the numeric branches of the corresponding evaluateInternal()
+    // implementations in expression.cpp, which handle every other case.
+
+    bool ExpressionProgram::add(const Instruction& ins, Value* out) const {
+        double doubleTotal = 0;
+        long long longTotal = 0;
+        BSONType totalType = NumberInt;
+
+        for (int i = 0; i < ins.numOperands; ++i) {
+            if (_failed[_operands[ins.firstOperand + i]])
+                return false;
+
+            const Value& val = operand(ins, i);
+            if (!val.numeric())
+                return false;
+
+            totalType = Value::getWidestNumeric(totalType, val.getType());
+            doubleTotal += val.coerceToDouble();
+            longTotal += val.coerceToLong();
+        }
+
+        if (totalType == NumberLong)
+            *out = Value(longTotal);
+        else if (totalType == NumberDouble)
+            *out = Value(doubleTotal);
+        else
+            *out = Value::createIntOrLong(longTotal);
+        return true;
+    }
+
+    bool ExpressionProgram::subtract(const Instruction& ins, Value* out) const {
+        if (_failed[_operands[ins.firstOperand]] || _failed[_operands[ins.firstOperand + 1]])
+            return false;
+
+        const Value& lhs = operand(ins, 0);
+        const Value& rhs = operand(ins, 1);
+        if (!lhs.numeric() || !rhs.numeric())
+            return false;
+
+        const BSONType diffType = Value::getWidestNumeric(rhs.getType(), lhs.getType());
+        if (diffType == NumberDouble)
+            *out = Value(lhs.coerceToDouble() - rhs.coerceToDouble());
+        else if (diffType == NumberLong)
+            *out = Value(lhs.coerceToLong() - rhs.coerceToLong());
+        else
+            *out = Value::createIntOrLong(lhs.coerceToLong() - rhs.coerceToLong());
+        return true;
+    }
+
+    bool ExpressionProgram::multiply(const Instruction& ins, Value* out) const {
+        double doubleProduct = 1;
+        long long longProduct = 1;
+        BSONType productType = NumberInt;
+
+        for (int i = 0; i < ins.numOperands; ++i) {
+            if (_failed[_operands[ins.firstOperand + i]])
+                return false;
+
+            const Value& val = operand(ins, i);
+            if (!val.numeric())
+                return false;
+
+            productType = Value::getWidestNumeric(productType, val.getType());
+            doubleProduct *= val.coerceToDouble();
+            longProduct *= val.coerceToLong();
+        }
+
+        if (productType == NumberDouble)
+            *out = Value(doubleProduct);
+        else if (productType == NumberLong)
+            *out = Value(longProduct);
+        else
+            *out = Value::createIntOrLong(longProduct);
+        return true;
+    }
+
+    bool ExpressionProgram::divide(const Instruction& ins, Value* out) const {
+        if (_failed[_operands[ins.firstOperand]] || _failed[_operands[ins.firstOperand + 1]])
+            return false;
+
+        const Value& lhs = operand(ins, 0);
+        const Value& rhs = operand(ins, 1);
+        if (!lhs.numeric() || !rhs.numeric())
+            return false;
+
+        const double denom = rhs.coerceToDouble();
+        if (denom == 0)
+            return false;
+
+        *out = Value(lhs.coerceToDouble() / denom);
+        return true;
+    }
+
+    bool ExpressionProgram::mod(const Instruction& ins, Value* out) const {
+        if (_failed[_operands[ins.firstOperand]] || _failed[_operands[ins.firstOperand + 1]])
+            return false;
+
+        const Value& lhs = operand(ins, 0);
+        const Value& rhs = operand(ins, 1);
+        if (!lhs.numeric() || !rhs.numeric())
+            return false;
+
+        const double right = rhs.coerceToDouble();
+        if (right == 0)
+            return false;
+
+        const BSONType leftType = lhs.getType();
+        const BSONType rightType = rhs.getType();
+        if (leftType == NumberDouble
+            || (rightType == NumberDouble && rhs.coerceToInt() != right)) {
+            *out = Value(fmod(lhs.coerceToDouble(), right));
+        }
+        else if (leftType == NumberLong || rightType == NumberLong) {
+            *out = Value(lhs.coerceToLong() % rhs.coerceToLong());
+        }
+        else {
+            *out = Value(lhs.coerceToInt() % rhs.coerceToInt());
+        }
+        return true;
+    }
+
+    bool ExpressionProgram::compare(const Instruction& ins, Value* out) const {
+        if (_failed[_operands[ins.firstOperand]] || _failed[_operands[ins.firstOperand + 1]])
+            return false;
+
+        const int cmp = Value::compare(operand(ins, 0), operand(ins, 1));
+        switch (static_cast<ExpressionCompare::CmpOp>(ins.arg)) {
+        case ExpressionCompare::EQ: *out = Value(cmp == 0); break;
+        case ExpressionCompare::NE: *out = Value(cmp != 0); break;
+        case ExpressionCompare::GT: *out = Value(cmp > 0); break;
+        case ExpressionCompare::GTE: *out = Value(cmp >= 0); break;
+        case ExpressionCompare::LT: *out = Value(cmp < 0); break;
+        case ExpressionCompare::LTE: *out = Value(cmp <= 0); break;
+        case ExpressionCompare::CMP: *out = Value(cmp < 0 ? -1 : cmp > 0 ? 1 : 0); break;
+        }
+        return true;
+    }
+
+    bool ExpressionProgram::concat(const Instruction& ins, Value* out) const {
+        for (int i = 0; i < ins.numOperands; ++i) {
+            if (_failed[_operands[ins.firstOperand + i]]
+                    || operand(ins, i).getType() != String) {
+                return false;
+            }
+        }
+
+        StringBuilder result;
+        for (int i = 0; i < ins.numOperands; ++i) {
+            result << operand(ins, i).getString();
+        }
+        *out = Value(result.str());
+        return true;
+    }
+
+    /* ------------------------- ExpressionCompiled ----------------------------- */
+
+    intrusive_ptr<Expression> ExpressionCompiled::create(const intrusive_ptr<Expression>& expr) {
+        if (!internalAggCompileExpressions || !ExpressionProgram::isWorthCompiling(expr.get()))
+            return expr;
+
+        return new ExpressionCompiled(expr);
+    }
+
+    ExpressionCompiled::ExpressionCompiled(const intrusive_ptr<Expression>& expr)
+        : _expr(expr)
+        , _program(expr.get())
+    {}
+
+    intrusive_ptr<Expression> ExpressionCompiled::optimize() {
+        // The tree may still fold further; compile whatever it becomes.
+        return create(_expr->optimize());
+    }
+
+    void ExpressionCompiled::addDependencies(DepsTracker* deps, vector<std::string>* path) const {
+        _expr->addDependencies(deps, path);
+    }
+
+    Value ExpressionCompiled::serialize(bool explain) const {
+        return _expr->serialize(explain);
+    }
+
+    Value ExpressionCompiled::evaluateInternal(Variables* vars) const {
+        return _program.run(vars);
+    }
+
+    int ExpressionCompiled::compile(ExpressionProgram* program) const {
+        return _expr->compile(program);
+    }
+
+} // namespace mongo
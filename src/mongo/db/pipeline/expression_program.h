@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/pipeline/expression.h"
+
+namespace mongo {
+
+    /**
+     * A flat, register-based form of an Expression tree. Each instruction computes one node of
+     * the tree into its own register from the registers of the node's operands, so evaluating
+     * the program is a single loop over the instructions, with no virtual calls or recursion
+     * for the nodes that have a bytecode form and typed fast paths for numeric and string
+     * operands.
+     *
+     * The program never changes what an expression returns or which error it raises. Operators
+     * only take their fast path when every operand is of a type they handle directly. Otherwise
+     * the instruction evaluates its original node with evaluateInternal(), so null, date and
+     * error handling is exactly the interpreter's. Because operands are computed before their
+     * operator, an error raised by an operand is held back rather than thrown. The operator
+     * then re-evaluates its node, which either short-circuits past the failing operand, as
+     * $add does after a null, or raises the same error.
+     *
+     * A program keeps its registers between runs and so may only be run by one thread at a
+     * time, as is already the case for the pipeline that owns the expression.
+     */
+    class ExpressionProgram {
+        MONGO_DISALLOW_COPYING(ExpressionProgram);
+    public:
+        enum OpCode {
+            kConstant,  // the constant 'arg'
+            kFieldPath, // 'expr', an ExpressionFieldPath
+            kEval,      // 'expr' evaluated by the tree interpreter
+            kAdd,
+            kSubtract,
+            kMultiply,
+            kDivide,
+            kMod,
+            kCompare,   // 'arg' is the ExpressionCompare::CmpOp
+            kConcat,
+        };
+
+        /**
+         * Compiles 'root'. The program refers to the nodes of the tree, which must outlive it.
+         */
+        explicit ExpressionProgram(const Expression* root);
+
+        /** Returns the value of the compiled expression. */
+        Value run(Variables* vars);
+
+        //
+        // Used by Expression::compile() implementations.
+        //
+
+        /**
+         * Appends an instruction computing 'expr' from the registers in 'operands' and returns
+         * the register it writes.
+         */
+        int emit(OpCode op, const Expression* expr, const std::vector<int>& operands, int arg = 0);
+
+        /** Appends an instruction loading 'value' and returns the register it writes. */
+        int emitConstant(const Expression* expr, const Value& value);
+
+        /** Returns true if 'expr' has a bytecode form worth running instead of the tree. */
+        static bool isWorthCompiling(const Expression* expr);
+
+    private:
+        struct Instruction {
+            OpCode op;
+            const Expression* expr;
+            int firstOperand; // index of the first operand register in _operands
+            int numOperands;
+            int arg;
+        };
+
+        // Fast paths. Each returns false, leaving 'out' untouched, if an operand is not of a
+        // type it handles.
+        bool add(const Instruction& ins, Value* out) const;
+        bool subtract(const Instruction& ins, Value* out) const;
+        bool multiply(const Instruction& ins, Value* out) const;
+        bool divide(const Instruction& ins, Value* out) const;
+        bool mod(const Instruction& ins, Value* out) const;
+        bool compare(const Instruction& ins, Value* out) const;
+        bool concat(const Instruction& ins, Value* out) const;
+
+        // Evaluates the instruction's node with the tree interpreter into register 'reg',
+        // marking the register failed instead of throwing.
+        void evaluateNode(const Instruction& ins, Variables* vars, size_t reg);
+
+        const Value& operand(const Instruction& ins, int i) const {
+            return _registers[_operands[ins.firstOperand + i]];
+        }
+
+        const Expression* const _root;
+
+        std::vector<Instruction> _code;
+        std::vector<int> _operands;
+        std::vector<Value> _constants;
+
+        // One register per instruction, written by that instruction.
+        std::vector<Value> _registers;
+
+        // Set for a register whose node raised an error.
+        std::vector<char> _failed;
+    };
+
+    /**
+     * Evaluates an expression tree through an ExpressionProgram. Everything other than
+     * evaluation, such as serialization and dependency tracking, is delegated to the tree, so
+     * the wrapper is invisible in explain output and when the pipeline is split.
+     */
+    class ExpressionCompiled : public Expression {
+    public:
+        /**
+         * Returns 'expr' wrapped in a compiled program if compilation is enabled and worthwhile
+         * for it, or 'expr' itself otherwise. 'expr' should already be optimized.
+         */
+        static boost::intrusive_ptr<Expression> create(const boost::intrusive_ptr<Expression>& expr);
+
+        // virtuals from Expression
+        virtual boost::intrusive_ptr<Expression> optimize();
+        virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
+        virtual Value serialize(bool explain) const;
+        virtual Value evaluateInternal(Variables* vars) const;
+        virtual int compile(ExpressionProgram* program) const;
+
+    private:
+        explicit ExpressionCompiled(const boost::intrusive_ptr<Expression>& expr);
+
+        const boost::intrusive_ptr<Expression> _expr;
+
+        // Mutable because running the program writes its registers.
+        mutable ExpressionProgram _program;
+    };
+
+} // namespace mongo
@@ -0,0 +1,99 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/group_key_table.h"
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+    const size_t kInitialSlots = 16; // must be a power of two
+}
+
+    // static
+    const unsigned GroupKeyTable::kEmptySlot;
+
+    GroupKeyTable::GroupKeyTable()
+        : _slots(kInitialSlots, kEmptySlot)
+        , _mask(kInitialSlots - 1)
+    {}
+
+    size_t GroupKeyTable::findOrInsert(const Value& key, bool* inserted) {
+        const size_t hash = Value::Hash()(key);
+
+        size_t pos = hash & _mask;
+        while (_slots[pos] != kEmptySlot) {
+            const size_t ordinal = _slots[pos] - 1;
+            if (_hashes[ordinal] == hash && Value::compare(_keys[ordinal], key) == 0) {
+                *inserted = false;
+                return ordinal;
+            }
+            pos = (pos + 1) & _mask;
+        }
+
+        const size_t ordinal = _keys.size();
+        massert(28611, "too many groups in $group", ordinal < 0xFFFFFFFFu);
+        _keys.push_back(key);
+        _hashes.push_back(hash);
+        _slots[pos] = ordinal + 1;
+
+        // Keep the load factor at or below one half so probe sequences stay short.
+        if (_keys.size() * 2 > _slots.size())
+            grow();
+
+        *inserted = true;
+        return ordinal;
+    }
+
+    void GroupKeyTable::clear() {
+        std::vector<Value>().swap(_keys);
+        std::vector<size_t>().swap(_hashes);
+        std::vector<unsigned>(kInitialSlots, kEmptySlot).swap(_slots);
+        _mask = kInitialSlots - 1;
+    }
+
+    void GroupKeyTable::grow() {
+        std::vector<unsigned> slots(_slots.size() * 2, kEmptySlot);
+        const size_t mask = slots.size() - 1;
+
+        for (size_t ordinal = 0; ordinal < _keys.size(); ordinal++) {
+            size_t pos = _hashes[ordinal] & mask;
+            while (slots[pos] != kEmptySlot)
+                pos = (pos + 1) & mask;
+            slots[pos] = ordinal + 1;
+        }
+
+        _slots.swap(slots);
+        _mask = mask;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,76 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/pipeline/value.h"
+
+namespace mongo {
+
+    /**
+     * Maps $group keys to dense ordinals 0, 1, 2, ... in order of first appearance, so that
+     * per-group state can be kept in flat arrays indexed by ordinal.
+     *
+     * The table is open-addressed with linear probing. Slots hold ordinals rather than keys, and
+     * each key's hash is remembered alongside it so that probing and growth compare hashes
+     * before ever comparing Values.
+     */
+    class GroupKeyTable {
+    public:
+        GroupKeyTable();
+
+        /**
+         * Returns the ordinal of 'key', giving it the next free ordinal if it is not yet in the
+         * table. Sets *inserted to whether it was added.
+         */
+        size_t findOrInsert(const Value& key, bool* inserted);
+
+        size_t size() const { return _keys.size(); }
+        bool empty() const { return _keys.empty(); }
+
+        const Value& key(size_t ordinal) const { return _keys[ordinal]; }
+
+        /// Removes all keys and releases the memory used by the table.
+        void clear();
+
+    private:
+        static const unsigned kEmptySlot = 0;
+
+        /// Doubles the number of slots and reinserts every ordinal.
+        void grow();
+
+        std::vector<Value> _keys;
+        std::vector<size_t> _hashes;   // parallel to _keys
+        std::vector<unsigned> _slots;  // ordinal + 1, or kEmptySlot
+        size_t _mask;                  // _slots.size() - 1
+    };
+
+}  // namespace mongo
@@ -216,6 +216,7 @@ namespace mongo {
 
         // The order in which optimizations are applied can have significant impact on the
         // efficiency of the final pipeline. Be Careful!
+        Optimizations::Local::moveMatchBeforePathPreservingStages(pPipeline.get());
         Optimizations::Local::moveMatchBeforeSort(pPipeline.get());
         Optimizations::Local::moveLimitBeforeSkip(pPipeline.get());
         Optimizations::Local::coalesceAdjacent(pPipeline.get());
@@ -225,6 +226,42 @@ namespace mongo {
         return pPipeline;
     }
 
+    void Pipeline::Optimizations::Local::moveMatchBeforePathPreservingStages(Pipeline* pipeline) {
+        SourceContainer& sources = pipeline->sources;
+        for (size_t srci = 1; srci < sources.size(); ++srci) {
+            DocumentSourceMatch* match = dynamic_cast<DocumentSourceMatch*>(sources[srci].get());
+            if (!match || match->isTextQuery())
+                continue;
+
+            PathPreservingDocumentSource* previous =
+                dynamic_cast<PathPreservingDocumentSource*>(sources[srci - 1].get());
+            if (!previous)
+                continue;
+
+            BSONObj remaining;
+            const BSONObj movable = match->splitForPromotion(*previous, &remaining);
+            if (movable.isEmpty())
+                continue;
+
+            const intrusive_ptr<DocumentSource> promoted =
+                DocumentSourceMatch::createFromBson(BSON("$match" << movable).firstElement(),
+                                                    pipeline->pCtx);
+            if (remaining.isEmpty()) {
+                sources[srci] = sources[srci - 1];
+                sources[srci - 1] = promoted;
+            }
+            else {
+                sources[srci] =
+                    DocumentSourceMatch::createFromBson(BSON("$match" << remaining).firstElement(),
+                                                        pipeline->pCtx);
+                sources.insert(sources.begin() + (srci - 1), promoted);
+            }
+
+            // Look at the promoted match again; it may be able to move further.
+            srci = std::max(srci - 1, size_t(1)) - 1;
+        }
+    }
+
     void Pipeline::Optimizations::Local::moveMatchBeforeSort(Pipeline* pipeline) {
         // TODO Keep moving matches across multiple sorts as moveLimitBeforeSkip does below.
         // TODO Check sort for limit. Not an issue currently due to order optimizations are applied,
@@ -500,6 +537,8 @@ namespace mongo {
         // should not get here in the explain case
         verify(!explain);
 
+        DocumentStoragePool::Scope poolScope(&pCtx->documentPool);
+
         // the array in which the aggregation results reside
         // cant use subArrayStart() due to error handling
         BSONArrayBuilder resultArray;
@@ -33,14 +33,24 @@
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/ops/insert.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/parallel_scan.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/s/d_state.h"
 
 namespace mongo {
@@ -48,6 +58,7 @@ namespace mongo {
     using boost::intrusive_ptr;
     using boost::shared_ptr;
     using std::string;
+    using std::vector;
 
 namespace {
     class MongodImplementation : public DocumentSourceNeedsMongod::MongodInterface {
@@ -75,10 +86,262 @@ namespace {
             return collection && collection->isCapped();
         }
 
+        void insert(const NamespaceString& ns, const vector<BSONObj>& objs) {
+            OperationContext* txn = _ctx->opCtx;
+
+            // Documents get their _id here, as they would on the way in from a client.
+            vector<BSONObj> docs;
+            docs.reserve(objs.size());
+            for (vector<BSONObj>::const_iterator it = objs.begin(); it != objs.end(); ++it) {
+                StatusWith<BSONObj> fixed = fixDocumentForInsert(*it);
+                uassertStatusOK(fixed.getStatus());
+                docs.push_back(fixed.getValue().isEmpty() ? *it : fixed.getValue());
+            }
+
+            for (int attempt = 1; ; ++attempt) {
+                try {
+                    ScopedTransaction transaction(txn, MODE_IX);
+                    Lock::DBLock dbLock(txn->lockState(), ns.db(), MODE_IX);
+                    Lock::CollectionLock collLock(txn->lockState(), ns.ns(), MODE_IX);
+
+                    uassert(ErrorCodes::NotMaster,
+                            str::stream() << "not master while writing to " << ns.ns(),
+                            repl::getGlobalReplicationCoordinator()->
+                                canAcceptWritesForDatabase(ns.db()));
+
+                    Database* db = dbHolder().get(txn, ns.db());
+                    Collection* collection = db ? db->getCollection(ns) : NULL;
+                    uassert(28641, str::stream() << "collection " << ns.ns()
+                                                 << " was dropped during the insert",
+                            collection);
+
+                    WriteUnitOfWork wunit(txn);
+                    uassertStatusOK(collection->insertDocuments(txn, docs, true));
+                    repl::logInsertOps(txn, ns.ns().c_str(), docs);
+                    wunit.commit();
+                    return;
+                }
+                catch (const WriteConflictException&) {
+                    txn->getCurOp()->debug().writeConflicts++;
+                    WriteConflictException::logAndBackoff(attempt, "$out insert", ns.ns());
+                }
+            }
+        }
+
     private:
         intrusive_ptr<ExpressionContext> _ctx;
         DBDirectClient _client;
     };
+
+    /**
+     * Feeds the documents returned by one partition of a parallel scan into a pipeline. Stops at
+     * the first error, which is kept in getStatus().
+     */
+    class PartitionSource : public DocumentSource {
+    public:
+        PartitionSource(const intrusive_ptr<ExpressionContext>& ctx, PlanExecutor* exec)
+            : DocumentSource(ctx)
+            , _exec(exec)
+            , _status(Status::OK())
+        {}
+
+        virtual boost::optional<Document> getNext() {
+            pExpCtx->checkForInterrupt();
+
+            if (!_status.isOK()) {
+                return boost::none;
+            }
+
+            BSONObj obj;
+            const PlanExecutor::ExecState state = _exec->getNext(&obj, NULL);
+            if (PlanExecutor::ADVANCED == state) {
+                return Document::fromBsonWithMetaData(obj);
+            }
+
+            if (PlanExecutor::DEAD == state) {
+                _status = Status(ErrorCodes::OperationFailed,
+                                 "collection or index disappeared during parallel scan");
+            }
+            else if (PlanExecutor::FAILURE == state) {
+                _status = Status(ErrorCodes::OperationFailed,
+                                 str::stream() << "parallel scan encountered an error: "
+                                               << WorkingSetCommon::toStatusString(obj));
+            }
+            return boost::none;
+        }
+
+        virtual void setSource(DocumentSource* pSource) {
+            // this doesn't take a source
+            verify(false);
+        }
+
+        virtual bool isValidInitialSource() const { return true; }
+
+        Status getStatus() const { return _status; }
+
+    private:
+        virtual Value serialize(bool explain) const { return Value(); }
+
+        PlanExecutor* _exec;
+        Status _status;
+    };
+
+    /**
+     * Runs the shard half of a $group over one partition of a parallel scan, keeping the
+     * mergeable partial groups.
+     */
+    class GroupPartitionWorker : public ParallelScanWorker {
+    public:
+        GroupPartitionWorker(const intrusive_ptr<ExpressionContext>& pipelineCtx,
+                             const BSONObj& groupSpec)
+            : _pipelineCtx(pipelineCtx)
+            , _groupSpec(groupSpec)
+        {}
+
+        virtual Status run(OperationContext* txn, PlanExecutor* exec) {
+            // The expression context is per operation, so each worker gets its own. Asking for
+            // shard output keeps the groups mergeable.
+            intrusive_ptr<ExpressionContext> ctx(new ExpressionContext(txn, _pipelineCtx->ns));
+            ctx->inShard = true;
+            ctx->extSortAllowed = _pipelineCtx->extSortAllowed;
+            ctx->tempDir = _pipelineCtx->tempDir;
+
+            intrusive_ptr<PartitionSource> source(new PartitionSource(ctx, exec));
+            intrusive_ptr<DocumentSource> group =
+                DocumentSourceGroup::createFromBson(_groupSpec.firstElement(), ctx);
+            group->setSource(source.get());
+
+            while (boost::optional<Document> next = group->getNext()) {
+                partialGroups.push_back(next->toBson());
+            }
+            group->dispose();
+
+            return source->getStatus();
+        }
+
+        vector<BSONObj> partialGroups;
+
+    private:
+        const intrusive_ptr<ExpressionContext> _pipelineCtx;
+        const BSONObj _groupSpec;
+    };
+
+    /**
+     * Replaces the collection scan and the shard half of a leading $group. The scan is split
+     * across parallelScanWorkers() threads, each grouping its own partition, and this source
+     * returns their partial groups for the merging half of the $group to combine.
+     */
+    class DocumentSourceParallelGroup : public DocumentSource {
+    public:
+        DocumentSourceParallelGroup(const intrusive_ptr<ExpressionContext>& ctx,
+                                    const BSONObj& query,
+                                    const BSONObj& groupSpec,
+                                    size_t numWorkers)
+            : DocumentSource(ctx)
+            , _query(query.getOwned())
+            , _groupSpec(groupSpec.getOwned())
+            , _numWorkers(numWorkers)
+            , _populated(false)
+            , _next(0)
+        {}
+
+        virtual boost::optional<Document> getNext() {
+            pExpCtx->checkForInterrupt();
+
+            if (!_populated) {
+                populate();
+            }
+
+            if (_next == _partialGroups.size()) {
+                return boost::none;
+            }
+            return Document(_partialGroups[_next++]);
+        }
+
+        virtual const char* getSourceName() const { return "$parallelCollectionScan"; }
+
+        virtual void setSource(DocumentSource* pSource) {
+            // this doesn't take a source
+            verify(false);
+        }
+
+        virtual bool isValidInitialSource() const { return true; }
+
+        virtual void dispose() {
+            _partialGroups.clear();
+            _next = 0;
+        }
+
+    private:
+        virtual Value serialize(bool explain) const {
+            return Value(DOC(getSourceName() << DOC("query" << _query
+                                                    << "group" << _groupSpec.firstElement().Obj()
+                                                    << "workers" << int(_numWorkers))));
+        }
+
+        void populate() {
+            OwnedPointerVector<GroupPartitionWorker> groupers;
+            vector<ParallelScanWorker*> workers;
+            for (size_t i = 0; i < _numWorkers; i++) {
+                groupers.push_back(new GroupPartitionWorker(pExpCtx, _groupSpec));
+                workers.push_back(groupers[i]);
+            }
+
+            uassertStatusOK(runParallelCollectionScan(pExpCtx->opCtx,
+                                                      pExpCtx->ns.ns(),
+                                                      _query,
+                                                      workers));
+
+            for (size_t i = 0; i < groupers.size(); i++) {
+                _partialGroups.insert(_partialGroups.end(),
+                                      groupers[i]->partialGroups.begin(),
+                                      groupers[i]->partialGroups.end());
+            }
+            _populated = true;
+        }
+
+        const BSONObj _query;
+        const BSONObj _groupSpec;
+        const size_t _numWorkers;
+
+        bool _populated;
+        vector<BSONObj> _partialGroups;
+        size_t _next;
+    };
+
+    /**
+     * Returns true if some ready btree index of 'collection' has every field in 'deps' in its
+     * key pattern and is not multikey, so that a plan over it could answer the pipeline from
+     * index keys without fetching documents.
+     */
+    bool indexCanCoverDeps(OperationContext* txn,
+                           const Collection* collection,
+                           const DepsTracker& deps) {
+        if (!collection || deps.needWholeDocument || deps.needTextScore || deps.fields.empty()) {
+            return false;
+        }
+
+        IndexCatalog::IndexIterator it =
+            collection->getIndexCatalog()->getIndexIterator(txn, false);
+        while (it.more()) {
+            const IndexDescriptor* desc = it.next();
+            if (!IndexNames::findPluginName(desc->keyPattern()).empty()
+                    || desc->isMultikey(txn)) {
+                continue;
+            }
+
+            bool coversAll = true;
+            for (std::set<string>::const_iterator field = deps.fields.begin();
+                 coversAll && field != deps.fields.end();
+                 ++field) {
+                coversAll = desc->keyPattern().hasField(*field);
+            }
+            if (coversAll) {
+                return true;
+            }
+        }
+        return false;
+    }
 }
 
     shared_ptr<PlanExecutor> PipelineD::prepareCursorSource(
@@ -126,11 +389,6 @@ namespace {
         // Find the set of fields in the source documents depended on by this pipeline.
         const DepsTracker deps = pPipeline->getDependencies(queryObj);
 
-        // Passing query an empty projection since it is faster to use ParsedDeps::extractFields().
-        // This will need to change to support covering indexes (SERVER-12015). There is an
-        // exception for textScore since that can only be retrieved by a query projection.
-        const BSONObj projectionForQuery = deps.needTextScore ? deps.toProjection() : BSONObj();
-
         /*
           Look for an initial sort; we'll try to add this to the
           Cursor we create.  If we're successful in doing that (further down),
@@ -148,6 +406,16 @@ namespace {
             }
         }
 
+        // Passing query an empty projection since it is faster to use ParsedDeps::extractFields().
+        // There are two exceptions: textScore can only be retrieved by a query projection, and
+        // when the query or sort can use an index that holds every field the pipeline reads, the
+        // projection lets the planner answer it (and so a $match+$group on indexed fields) from
+        // the index keys.
+        const bool mayCoverDeps = (!queryObj.isEmpty() || sortStage.get())
+                               && indexCanCoverDeps(txn, collection, deps);
+        const BSONObj projectionForQuery =
+            (deps.needTextScore || mayCoverDeps) ? deps.toProjection() : BSONObj();
+
         // Create the PlanExecutor.
         //
         // If we try to create a PlanExecutor that includes both the match and the
@@ -225,6 +493,30 @@ namespace {
             exec.reset(rawExec);
         }
 
+        // A $group straight over a full collection scan can be split into partial groups computed
+        // on worker threads, the same way a sharded $group is split across shards. A sharded
+        // collection gets a SHARDING_FILTER root, so it never qualifies.
+        if (!pPipeline->isExplain()
+                && !sources.empty()
+                && STAGE_COLLSCAN == exec->getRootStage()->stageType()) {
+            DocumentSourceGroup* group = dynamic_cast<DocumentSourceGroup*>(sources.front().get());
+            const size_t numWorkers = group ? parallelScanWorkers(txn, collection) : 0;
+            if (numWorkers > 0) {
+                const BSONObj groupSpec = group->serialize().getDocument().toBson();
+                intrusive_ptr<DocumentSource> mergeSource = group->getMergeSource();
+
+                // The plan is not needed: the workers build their own.
+                exec.reset();
+
+                sources.pop_front();
+                sources.push_front(mergeSource);
+                pPipeline->addInitialSource(new DocumentSourceParallelGroup(pExpCtx,
+                                                                            queryObj,
+                                                                            groupSpec,
+                                                                            numWorkers));
+                return exec;
+            }
+        }
 
         // DocumentSourceCursor expects a yielding PlanExecutor that has had its state saved. We
         // deregister the PlanExecutor so that it can be registered with ClientCursor.
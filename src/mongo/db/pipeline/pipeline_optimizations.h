@@ -43,6 +43,18 @@ namespace mongo {
      */
     class Pipeline::Optimizations::Local {
     public:
+        /**
+         * Moves the predicates of each match ahead of the $project, $unwind and $sort stages
+         * before it whose output holds the fields they read, renaming fields a $project renames.
+         * A match is split when only some of its predicates can move.
+         *
+         * Predicates that reach the front of the pipeline become part of the query the cursor
+         * runs, where they can use indexes, and later stages see fewer documents.
+         *
+         * NOTE: uses the PathPreservingDocumentSource and DocumentSourceMatch::splitForPromotion()
+         */
+        static void moveMatchBeforePathPreservingStages(Pipeline* pipeline);
+
         /** 
          * Moves matches before any adjacent sort phases.
          *
@@ -226,6 +226,26 @@ namespace mongo {
         }
     }
 
+    Value Value::fromBsonLazily(const BSONElement& elem, const SharedBuffer& owner) {
+        switch (elem.type()) {
+        case Object:
+            return Value(Document::fromBsonLazily(elem.embeddedObject(), owner, false));
+
+        case Array: {
+            intrusive_ptr<RCVector> vec (new RCVector);
+            BSONForEach(sub, elem.embeddedObject()) {
+                vec->vec.push_back(fromBsonLazily(sub, owner));
+            }
+            ValueStorage storage (Array);
+            storage.putVector(vec.get());
+            return Value(storage);
+        }
+
+        default:
+            return Value(elem);
+        }
+    }
+
     Value::Value(const BSONArray& arr) : _storage(Array) {
         intrusive_ptr<RCVector> vec (new RCVector);
         BSONForEach(sub, arr) {
@@ -711,17 +731,27 @@ namespace mongo {
             boost::hash_combine(seed, _storage.dateValue);
             break;
 
-        // This converts all numbers to doubles, which ignores the low-order bits of
-        // NumberLongs > 2**53, but that is ok since the hash will still be the same for
-        // equal numbers and is still likely to be different for different numbers.
-        // SERVER-16851
-        case NumberDouble:
+        // Integral numbers of any type hash as a long long, so equal numbers hash the same and
+        // NumberLongs > 2**53 keep their low-order bits.  Only non-integral doubles, and doubles
+        // too large for a long long, hash as doubles.
+        case NumberInt:
+            boost::hash_combine(seed, static_cast<long long>(_storage.intValue));
+            break;
+
         case NumberLong:
-        case NumberInt: {
-            const double dbl = getDouble();
+            boost::hash_combine(seed, _storage.longValue);
+            break;
+
+        case NumberDouble: {
+            const double dbl = _storage.doubleValue;
+            const double kLongLongLimit = 9223372036854775808.0; // 2**63
             if (isNaN(dbl)) {
                 boost::hash_combine(seed, numeric_limits<double>::quiet_NaN());
             }
+            else if (dbl >= -kLongLongLimit && dbl < kLongLongLimit
+                     && static_cast<long long>(dbl) == dbl) {
+                boost::hash_combine(seed, static_cast<long long>(dbl));
+            }
             else {
                 boost::hash_combine(seed, dbl);
             }
@@ -99,6 +99,12 @@ namespace mongo {
         /// Deep-convert from BSONElement to Value
         explicit Value(const BSONElement& elem);
 
+        /**
+         * Like Value(elem), but objects within elem become documents that are converted on first
+         * access. See Document::fromBsonLazily.
+         */
+        static Value fromBsonLazily(const BSONElement& elem, const SharedBuffer& owner);
+
         /** Construct a long or integer-valued Value.
          *
          *  Used when preforming arithmetic operations with int where the
@@ -208,6 +214,18 @@ namespace mongo {
                 // Simple case
                 return true;
             }
+
+            // Values of the same type that $group and $addToSet see most often don't need the
+            // canonical type handling of compare().
+            const BSONType type = v1.getType();
+            if (type == v2.getType()) {
+                switch (type) {
+                case String: return v1.getStringData() == v2.getStringData();
+                case NumberInt: return v1._storage.intValue == v2._storage.intValue;
+                case NumberLong: return v1._storage.longValue == v2._storage.longValue;
+                default: break;
+                }
+            }
             return (Value::compare(v1, v2) == 0);
         }
         
@@ -32,17 +32,21 @@
 
 #include "mongo/db/prefetch.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/global_environment_experiment.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/bgsync.h"
+#include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mmap.h"
 
@@ -65,6 +69,14 @@ namespace {
     ServerStatusMetricField<TimerStats> displayPrefetchDocPages("repl.preload.docs",
                                                                 &prefetchDocStats );
 
+    // Whether the _id lookups for update ops found the document to page in
+    Counter64 prefetchDocHits;
+    ServerStatusMetricField<Counter64> displayPrefetchDocHits("repl.preload.docHits",
+                                                              &prefetchDocHits );
+    Counter64 prefetchDocMisses;
+    ServerStatusMetricField<Counter64> displayPrefetchDocMisses("repl.preload.docMisses",
+                                                                &prefetchDocMisses );
+
     // page in pages needed for all index lookups on a given object
     void prefetchIndexPages(OperationContext* txn,
                             Collection* collection,
@@ -134,7 +146,12 @@ namespace {
             builder.append(_id);
             BSONObj result;
             try {
-                if (Helpers::findById(txn, db, ns, builder.done(), result)) {
+                if (!Helpers::findById(txn, db, ns, builder.done(), result)) {
+                    prefetchDocMisses.increment();
+                }
+                else {
+                    prefetchDocHits.increment();
+
                     // do we want to use Record::touch() here?  it's pretty similar.
                     volatile char _dummy_char = '\0';
 
@@ -178,10 +195,11 @@ namespace {
         BSONObj obj = op.getObjectField(opField);
         const char *ns = op.getStringField("ns");
 
-        // This will have to change for engines other than MMAP V1, because they might not have
-        // means for directly prefetching pages from the collection. For this purpose, acquire S
-        // lock on the database, instead of optimizing with IS.
-        Lock::CollectionLock collLock(txn->lockState(), ns, MODE_S);
+        // MMAP V1 keeps taking S here.  Engines with document-level locking only need IS, so
+        // a prefetch does not serialize against the writers applying the previous batch.
+        const bool docLocking =
+            getGlobalEnvironment()->getGlobalStorageEngine()->supportsDocLocking();
+        Lock::CollectionLock collLock(txn->lockState(), ns, docLocking ? MODE_IS : MODE_S);
 
         Collection* collection = db->getCollection( ns );
         if (!collection) {
@@ -205,6 +223,14 @@ namespace {
         // a way to achieve that would be to prefetch the record first, and then afterwards do 
         // this part.
         //
+        if (repl::isMultiInsertOp(op)) {
+            // an insert of several documents: prefetch the index pages each one goes into
+            BSONForEach(doc, obj) {
+                prefetchIndexPages(txn, collection, prefetchConfig, doc.Obj());
+            }
+            return;
+        }
+
         prefetchIndexPages(txn, collection, prefetchConfig, obj);
 
         // do not prefetch the data for inserts; it doesn't exist yet
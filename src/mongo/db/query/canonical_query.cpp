@@ -33,7 +33,9 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/query/query_template_cache.h"
 #include "mongo/util/log.h"
 
 
@@ -42,6 +44,7 @@ namespace {
     using boost::shared_ptr;
     using std::auto_ptr;
     using std::string;
+    using std::vector;
     using namespace mongo;
 
     // Delimiters for cache key encoding.
@@ -280,8 +283,9 @@ namespace {
 
     /**
      * Encodes parsed projection into cache key.
-     * Does a simple toString() on each projected field
-     * in the BSON object.
+     * Plain inclusions and exclusions are encoded as 1 and 0 whatever number or boolean
+     * spelled them, so that {a: 1}, {a: true} and {a: 1.0} share a cache entry.  Any other
+     * projected field is encoded with a simple toString() of its BSON element.
      * Orders the encoded elements in the projection by field name.
      * This handles all the special projection types ($meta, $elemMatch, etc.)
      */
@@ -306,10 +310,15 @@ namespace {
         for (std::map<StringData, BSONElement>::const_iterator i = elements.begin();
              i != elements.end(); ++i) {
             const BSONElement& elt = (*i).second;
-            // BSONElement::toString() arguments
-            // includeFieldName - skip field name (appending after toString() result). false.
-            // full: choose less verbose representation of child/data values. false.
-            encodeUserString(elt.toString(false, false), os);
+            if (elt.isNumber() || elt.isBoolean()) {
+                *os << (elt.trueValue() ? "1" : "0");
+            }
+            else {
+                // BSONElement::toString() arguments
+                // includeFieldName - skip field name (appending after toString() result). false.
+                // full: choose less verbose representation of child/data values. false.
+                encodeUserString(elt.toString(false, false), os);
+            }
             encodeUserString(elt.fieldName(), os);
         }
     }
@@ -437,6 +446,27 @@ namespace mongo {
                                         const MatchExpressionParser::WhereCallback& whereCallback) {
         auto_ptr<LiteParsedQuery> autoLpq(lpq);
 
+        // A query of a shape we have canonicalized before gets the tree of that shape with its
+        // own literals bound into it rather than being parsed, normalized and sorted again.
+        string templateKey;
+        vector<BSONElement> literals;
+        const bool templated = internalQueryTemplateCacheSize > 0 &&
+            QueryTemplateCache::makeKey(autoLpq->getFilter(), autoLpq->getSort(),
+                                        autoLpq->getProj(), &templateKey, &literals);
+        if (templated) {
+            shared_ptr<const QueryTemplate> queryTemplate =
+                QueryTemplateCache::get().find(templateKey);
+            if (queryTemplate) {
+                auto_ptr<CanonicalQuery> cq(new CanonicalQuery());
+                Status initStatus = cq->init(autoLpq.release(), whereCallback,
+                                             *queryTemplate, literals);
+
+                if (!initStatus.isOK()) { return initStatus; }
+                *out = cq.release();
+                return Status::OK();
+            }
+        }
+
         // Make MatchExpression.
         StatusWithMatchExpression swme = MatchExpressionParser::parse(autoLpq->getFilter(),
                                                                       whereCallback);
@@ -450,6 +480,16 @@ namespace mongo {
         Status initStatus = cq->init(autoLpq.release(), whereCallback, swme.getValue());
 
         if (!initStatus.isOK()) { return initStatus; }
+
+        if (templated) {
+            shared_ptr<const QueryTemplate> queryTemplate(
+                QueryTemplate::make(cq->getParsed().getFilter(), cq->root(),
+                                    cq->getPlanCacheKey(), literals));
+            if (queryTemplate) {
+                QueryTemplateCache::get().add(templateKey, queryTemplate);
+            }
+        }
+
         *out = cq.release();
         return Status::OK();
     }
@@ -509,23 +549,8 @@ namespace mongo {
         if (!parseStatus.isOK()) {
             return parseStatus;
         }
-        auto_ptr<LiteParsedQuery> lpq(lpqRaw);
-
-        // Build a parse tree from the BSONObj in the parsed query.
-        StatusWithMatchExpression swme = 
-                            MatchExpressionParser::parse(lpq->getFilter(), whereCallback);
-        if (!swme.isOK()) {
-            return swme.getStatus();
-        }
-
-        // Make the CQ we'll hopefully return.
-        auto_ptr<CanonicalQuery> cq(new CanonicalQuery());
-        // Takes ownership of lpq and the MatchExpression* in swme.
-        Status initStatus = cq->init(lpq.release(), whereCallback, swme.getValue());
 
-        if (!initStatus.isOK()) { return initStatus; }
-        *out = cq.release();
-        return Status::OK();
+        return CanonicalQuery::canonicalize(lpqRaw, out, whereCallback);
     }
 
     Status CanonicalQuery::init(LiteParsedQuery* lpq,
@@ -539,13 +564,31 @@ namespace mongo {
 
         sortTree(root);
         _root.reset(root);
-        Status validStatus = isValid(root, *_pq);
+        this->generateCacheKey();
+
+        return finishInit(whereCallback);
+    }
+
+    Status CanonicalQuery::init(LiteParsedQuery* lpq,
+                                const MatchExpressionParser::WhereCallback& whereCallback,
+                                const QueryTemplate& queryTemplate,
+                                const vector<BSONElement>& literals) {
+        _isForWrite = false;
+        _pq.reset(lpq);
+
+        // The template's tree is already normalized and sorted.
+        _root.reset(queryTemplate.bind(literals));
+        _cacheKey = queryTemplate.getPlanCacheKey();
+
+        return finishInit(whereCallback);
+    }
+
+    Status CanonicalQuery::finishInit(const MatchExpressionParser::WhereCallback& whereCallback) {
+        Status validStatus = isValid(_root.get(), *_pq);
         if (!validStatus.isOK()) {
             return validStatus;
         }
 
-        this->generateCacheKey();
-
         // Validate the projection if there is one.
         if (!_pq->getProj().isEmpty()) {
             ParsedProjection* pp;
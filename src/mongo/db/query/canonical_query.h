@@ -42,6 +42,8 @@ namespace mongo {
     // TODO: Is this binary data really?
     typedef std::string PlanCacheKey;
 
+    class QueryTemplate;
+
     class CanonicalQuery {
     public:
         /**
@@ -229,6 +231,20 @@ namespace mongo {
                     const MatchExpressionParser::WhereCallback& whereCallback,
                     MatchExpression* root);
 
+        /**
+         * Takes ownership of 'lpq'. Builds the tree by binding 'literals', the literals of the
+         * filter of 'lpq', into 'queryTemplate' instead of parsing the filter.
+         */
+        Status init(LiteParsedQuery* lpq,
+                    const MatchExpressionParser::WhereCallback& whereCallback,
+                    const QueryTemplate& queryTemplate,
+                    const std::vector<BSONElement>& literals);
+
+        /**
+         * Validates the tree and parses the projection once _root is set.
+         */
+        Status finishInit(const MatchExpressionParser::WhereCallback& whereCallback);
+
         boost::scoped_ptr<LiteParsedQuery> _pq;
 
         // _root points into _pq->getFilter()
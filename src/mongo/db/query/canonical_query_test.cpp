@@ -29,6 +29,8 @@
 #include "mongo/db/query/canonical_query.h"
 
 #include "mongo/db/json.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_template_cache.h"
 #include "mongo/unittest/unittest.h"
 
 using namespace mongo;
@@ -37,6 +39,7 @@ namespace {
 
     using std::auto_ptr;
     using std::string;
+    using std::vector;
 
     static const char* ns = "somebogusns";
 
@@ -576,7 +579,10 @@ namespace {
         // With projection
         testGetPlanCacheKey("{}", "{}", "{a: 1}", "an|1a");
         testGetPlanCacheKey("{}", "{}", "{a: 0}", "an|0a");
-        testGetPlanCacheKey("{}", "{}", "{a: 99}", "an|99a");
+        testGetPlanCacheKey("{}", "{}", "{a: 99}", "an|1a");
+        testGetPlanCacheKey("{}", "{}", "{a: true}", "an|1a");
+        testGetPlanCacheKey("{}", "{}", "{a: 1.0}", "an|1a");
+        testGetPlanCacheKey("{}", "{}", "{a: false}", "an|0a");
         testGetPlanCacheKey("{}", "{}", "{a: 'foo'}", "an|\"foo\"a");
         testGetPlanCacheKey("{}", "{}", "{a: {$slice: [3, 5]}}", "an|{ $slice: \\[ 3\\, 5 \\] }a");
         testGetPlanCacheKey("{}", "{}", "{a: {$elemMatch: {x: 2}}}",
@@ -634,4 +640,82 @@ namespace {
                             "gnanrsp");
     }
 
+    //
+    // Tests for the query template cache
+    //
+
+    /**
+     * Canonicalizes 'queryStr' through the template built from 'templateStr', a query of the same
+     * shape, and checks the result against canonicalizing 'queryStr' from scratch.
+     */
+    void testQueryTemplate(const char* templateStr, const char* queryStr,
+                           const char* sortStr, const char* projStr) {
+        QueryTemplateCache& cache = QueryTemplateCache::get();
+        cache.clear();
+
+        auto_ptr<CanonicalQuery> first(canonicalize(templateStr, sortStr, projStr));
+        ASSERT_EQUALS(cache.size(), 1U);
+
+        const long long hitsBefore = cache.hits.get();
+        auto_ptr<CanonicalQuery> templated(canonicalize(queryStr, sortStr, projStr));
+        ASSERT_EQUALS(cache.hits.get(), hitsBefore + 1);
+
+        const int oldCacheSize = internalQueryTemplateCacheSize;
+        internalQueryTemplateCacheSize = 0;
+        auto_ptr<CanonicalQuery> parsed(canonicalize(queryStr, sortStr, projStr));
+        internalQueryTemplateCacheSize = oldCacheSize;
+
+        assertEquivalent(queryStr, parsed->root(), templated->root());
+        ASSERT_EQUALS(parsed->getPlanCacheKey(), templated->getPlanCacheKey());
+        ASSERT_EQUALS(parsed->root()->toString(), templated->root()->toString());
+    }
+
+    TEST(QueryTemplateCacheTest, BindsNewLiterals) {
+        testQueryTemplate("{a: 1}", "{a: 2}", "{}", "{}");
+        testQueryTemplate("{a: 1, b: 'x'}", "{a: 5, b: 'y'}", "{b: 1}", "{a: 1}");
+        testQueryTemplate("{a: {$gt: 1, $lt: 10}}", "{a: {$gt: 3, $lt: 4}}", "{}", "{}");
+        testQueryTemplate("{$or: [{a: 1}, {b: {$lte: 2}}], c: true}",
+                          "{$or: [{a: 7}, {b: {$lte: 8}}], c: false}", "{}", "{}");
+        testQueryTemplate("{$and: [{$or: [{b: 1}, {b: 2}]}, {$or: [{a: 1}, {a: 2}]}]}",
+                          "{$and: [{$or: [{b: 3}, {b: 4}]}, {$or: [{a: 5}, {a: 6}]}]}",
+                          "{}", "{}");
+    }
+
+    TEST(QueryTemplateCacheTest, KeyDependsOnTypesAndLayout) {
+        string intKey, doubleKey, otherFieldKey, sortedKey;
+        vector<BSONElement> literals;
+        ASSERT_TRUE(QueryTemplateCache::makeKey(fromjson("{a: 1}"), BSONObj(), BSONObj(),
+                                                &intKey, &literals));
+        ASSERT_TRUE(QueryTemplateCache::makeKey(fromjson("{a: 1.5}"), BSONObj(), BSONObj(),
+                                                &doubleKey, &literals));
+        ASSERT_TRUE(QueryTemplateCache::makeKey(fromjson("{b: 1}"), BSONObj(), BSONObj(),
+                                                &otherFieldKey, &literals));
+        ASSERT_TRUE(QueryTemplateCache::makeKey(fromjson("{a: 2}"), fromjson("{a: 1}"),
+                                                BSONObj(), &sortedKey, &literals));
+        ASSERT_NOT_EQUALS(intKey, doubleKey);
+        ASSERT_NOT_EQUALS(intKey, otherFieldKey);
+        ASSERT_NOT_EQUALS(intKey, sortedKey);
+        ASSERT_EQUALS(literals.size(), 4U);
+    }
+
+    TEST(QueryTemplateCacheTest, OtherOperatorsAreNotTemplated) {
+        const char* queries[] = {
+            "{a: {$in: [1, 2]}}",
+            "{a: {b: 1}}",
+            "{a: [1, 2]}",
+            "{a: null}",
+            "{a: /x/}",
+            "{a: {$ne: 1}}",
+            "{a: {$gt: {b: 1}}}",
+            "{$or: [{a: {$exists: true}}, {b: 1}]}",
+        };
+
+        for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); ++i) {
+            string key;
+            vector<BSONElement> literals;
+            ASSERT_FALSE(QueryTemplateCache::makeKey(fromjson(queries[i]), BSONObj(), BSONObj(),
+                                                     &key, &literals));
+        }
+    }
+
 }
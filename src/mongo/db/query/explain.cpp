@@ -34,6 +34,7 @@
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/exec/multi_plan.h"
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/query_planner.h"
@@ -228,6 +229,9 @@ namespace mongo {
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("nReturned", stats.common.advanced);
             bob->appendNumber("executionTimeMillisEstimate", stats.common.executionTimeMillis);
+            if (stats.common.executionTimeNanos > 0) {
+                bob->appendNumber("executionTimeNanosEstimate", stats.common.executionTimeNanos);
+            }
             bob->appendNumber("works", stats.common.works);
             bob->appendNumber("advanced", stats.common.advanced);
             bob->appendNumber("needTime", stats.common.needTime);
@@ -266,6 +270,12 @@ namespace mongo {
                 }
             }
         }
+        else if (STAGE_CACHED_PLAN == stats.stageType) {
+            CachedPlanStats* spec = static_cast<CachedPlanStats*>(stats.specific.get());
+            if (verbosity >= ExplainCommon::EXEC_STATS) {
+                bob->appendBool("replanned", spec->replanned);
+            }
+        }
         else if (STAGE_COLLSCAN == stats.stageType) {
             CollectionScanStats* spec = static_cast<CollectionScanStats*>(stats.specific.get());
             bob->append("direction", spec->direction > 0 ? "forward" : "backward");
@@ -305,6 +315,9 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("docsExamined", spec->docsExamined);
                 bob->appendNumber("alreadyHasObj", spec->alreadyHasObj);
+                if (spec->docsPrefetched > 0) {
+                    bob->appendNumber("docsPrefetched", spec->docsPrefetched);
+                }
             }
         }
         else if (STAGE_GEO_NEAR_2D == stats.stageType
@@ -337,6 +350,9 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("keysExamined", spec->keysExamined);
                 bob->appendNumber("docsExamined", spec->docsExamined);
+                if (spec->documentCacheHits > 0) {
+                    bob->appendNumber("documentCacheHits", spec->documentCacheHits);
+                }
             }
         }
         else if (STAGE_IXSCAN == stats.stageType) {
@@ -354,6 +370,10 @@ namespace mongo {
                 bob->append("indexBounds", spec->indexBounds);
             }
 
+            if (spec->estimatedKeys >= 0) {
+                bob->appendNumber("estimatedKeys", spec->estimatedKeys);
+            }
+
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("keysExamined", spec->keysExamined);
                 bob->appendNumber("dupsTested", spec->dupsTested);
@@ -369,6 +389,7 @@ namespace mongo {
                 bob->appendNumber("dupsTested", spec->dupsTested);
                 bob->appendNumber("dupsDropped", spec->dupsDropped);
                 bob->appendNumber("locsForgotten", spec->locsForgotten);
+                bob->appendNumber("memUsage", spec->memUsage);
                 for (size_t i = 0; i < spec->matchTested.size(); ++i) {
                     bob->appendNumber(string(stream() << "matchTested_" << i),
                                       spec->matchTested[i]);
@@ -401,6 +422,9 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("memUsage", spec->memUsage);
                 bob->appendNumber("memLimit", spec->memLimit);
+                if (spec->spilledDocs > 0) {
+                    bob->appendNumber("spilledDocs", spec->spilledDocs);
+                }
             }
 
             if (spec->limit > 0) {
@@ -606,6 +630,7 @@ namespace mongo {
         // If we need execution stats, then run the plan in order to gather the stats.
         Status executePlanStatus = Status::OK();
         if (verbosity >= ExplainCommon::EXEC_STATS) {
+            ScopedTimer::TimeAllWork timeAllWork;
             executePlanStatus = exec->executePlan();
         }
 
@@ -733,6 +758,9 @@ namespace mongo {
             if (STAGE_SORT == stages[i]->stageType()) {
                 statsOut->hasSortStage = true;
             }
+            if (STAGE_CACHED_PLAN == stages[i]->stageType()) {
+                statsOut->fromPlanCache = true;
+            }
         }
     }
 
@@ -52,7 +52,8 @@ namespace mongo {
                              totalDocsExamined(0),
                              executionTimeMillis(0),
                              isIdhack(false),
-                             hasSortStage(false) { }
+                             hasSortStage(false),
+                             fromPlanCache(false) { }
 
         // The number of results returned by the plan.
         size_t nReturned;
@@ -71,6 +72,9 @@ namespace mongo {
 
         // Did this plan use an in-memory sort stage?
         bool hasSortStage;
+
+        // Was this plan taken from the plan cache?
+        bool fromPlanCache;
     };
 
     /**
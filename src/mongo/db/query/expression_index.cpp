@@ -28,6 +28,8 @@
 
 #include "mongo/db/query/expression_index.h"
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <iostream>
 
 #include "third_party/s2/s2regioncoverer.h"
@@ -36,14 +38,69 @@
 #include "mongo/db/geo/hash.h"
 #include "mongo/db/geo/r2_region_coverer.h"
 #include "mongo/db/hasher.h"
+#include "mongo/db/query/expression_index_knobs.h"
+#include "mongo/db/query/lru_key_value.h"
 
 namespace mongo {
 
     using std::set;
 
-    BSONObj ExpressionMapping::hash(const BSONElement& value) {
+namespace {
+
+    int getCoarsestIndexedLevel(const BSONObj& indexInfoObj) {
+        BSONElement ce = indexInfoObj["coarsestIndexedLevel"];
+        if (ce.isNumber()) {
+            return ce.numberInt();
+        }
+        return S2::kAvgEdge.GetClosestLevel(100 * 1000.0 / kRadiusOfEarthInMeters);
+    }
+
+    /**
+     * The intervals of recently computed 2dsphere coverings, keyed by the bytes of the query
+     * geometry followed by the coarsest indexed level.  The same few polygons tend to be queried
+     * over and over, and covering one is costly.
+     */
+    class S2CoveringCache {
+    public:
+        typedef std::vector<Interval> Intervals;
+
+        S2CoveringCache()
+            : _enabled(internalGeoPredicateQuery2DSphereCoveringCacheSize > 0),
+              _cache(std::max(0, internalGeoPredicateQuery2DSphereCoveringCacheSize)) { }
+
+        bool enabled() const {
+            return _enabled;
+        }
+
+        bool get(const std::string& key, OrderedIntervalList* oilOut) {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            Intervals* cached;
+            if (!_cache.get(key, &cached).isOK()) {
+                return false;
+            }
+            oilOut->intervals.insert(oilOut->intervals.end(), cached->begin(), cached->end());
+            return true;
+        }
+
+        void add(const std::string& key, const OrderedIntervalList& oil) {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            // Replaced or evicted entries are deleted by the auto_ptr.
+            _cache.add(key, new Intervals(oil.intervals));
+        }
+
+    private:
+        const bool _enabled;
+        boost::mutex _mutex;
+        LRUKeyValue<std::string, Intervals> _cache;
+    };
+
+}  // namespace
+
+    BSONObj ExpressionMapping::hash(const BSONElement& value, int hashVersion) {
         BSONObjBuilder bob;
-        bob.append("", BSONElementHasher::hash64(value, BSONElementHasher::DEFAULT_HASH_SEED));
+        bob.append("", BSONElementHasher::hash64(value,
+                                                 BSONElementHasher::DEFAULT_HASH_SEED,
+                                                 hashVersion));
         return bob.obj();
     }
 
@@ -65,6 +122,18 @@ namespace mongo {
         return result + "]";
     }
 
+    // Appends the inclusive range of 2d index keys [hashMin, hashMax] to 'oil'
+    static void appendHashInterval(unsigned long long hashMin,
+                                   unsigned long long hashMax,
+                                   OrderedIntervalList* oil) {
+        BSONObjBuilder builder;
+        GeoHash(static_cast<long long>(hashMin), GeoHash::kMaxBits).appendHashMin(&builder, "");
+        GeoHash(static_cast<long long>(hashMax), GeoHash::kMaxBits).appendHashMin(&builder, "");
+        oil->intervals.push_back(IndexBoundsBuilder::makeRangeInterval(builder.obj(),
+                                                                       true,
+                                                                       true));
+    }
+
     void ExpressionMapping::cover2d(const R2Region& region,
                                     const BSONObj& indexInfoObj,
                                     int maxCoveringCells,
@@ -82,19 +151,36 @@ namespace mongo {
         // TODO: Maybe slightly optimize by returning results in order
         vector<GeoHash> unorderedCovering;
         coverer.getCovering(region, &unorderedCovering);
-        set<GeoHash> covering(unorderedCovering.begin(), unorderedCovering.end());
+        set<GeoHash> covering;
+        for (size_t i = 0; i < unorderedCovering.size(); ++i) {
+            covering.insert(hashConverter.toKeyOrder(unorderedCovering[i]));
+        }
 
+        // Cells that are next to each other in key order are scanned as one interval.  This
+        // matters most for Hilbert order keys, where neighboring cells usually are.
+        unsigned long long intervalMin = 0;
+        unsigned long long intervalMax = 0;
         for (set<GeoHash>::const_iterator it = covering.begin(); it != covering.end();
             ++it) {
 
-            const GeoHash& geoHash = *it;
-            BSONObjBuilder builder;
-            geoHash.appendHashMin(&builder, "");
-            geoHash.appendHashMax(&builder, "");
+            const unsigned long long cellMin = static_cast<unsigned long long>(it->getHash());
+            const unsigned long long cellMax = cellMin | (it->getBits() >= GeoHash::kMaxBits ?
+                                                          0 : ~0ULL >> (2 * it->getBits()));
 
-            oil->intervals.push_back(IndexBoundsBuilder::makeRangeInterval(builder.obj(),
-                                                                           true,
-                                                                           true));
+            if (it != covering.begin() && intervalMax + 1 == cellMin) {
+                intervalMax = cellMax;
+                continue;
+            }
+
+            if (it != covering.begin()) {
+                appendHashInterval(intervalMin, intervalMax, oil);
+            }
+            intervalMin = cellMin;
+            intervalMax = cellMax;
+        }
+
+        if (!covering.empty()) {
+            appendHashInterval(intervalMin, intervalMax, oil);
         }
     }
 
@@ -103,15 +189,7 @@ namespace mongo {
                                           const BSONObj& indexInfoObj,
                                           OrderedIntervalList* oilOut) {
 
-        int coarsestIndexedLevel;
-        BSONElement ce = indexInfoObj["coarsestIndexedLevel"];
-        if (ce.isNumber()) {
-            coarsestIndexedLevel = ce.numberInt();
-        }
-        else {
-            coarsestIndexedLevel =
-                S2::kAvgEdge.GetClosestLevel(100 * 1000.0 / kRadiusOfEarthInMeters);
-        }
+        int coarsestIndexedLevel = getCoarsestIndexedLevel(indexInfoObj);
 
         // The min level of our covering is the level whose cells are the closest match to the
         // *area* of the region (or the max indexed level, whichever is smaller) The max level
@@ -209,4 +287,29 @@ namespace mongo {
         }
     }
 
+    void ExpressionMapping::cover2dsphere(const S2Region& region,
+                                          const BSONObj& geometry,
+                                          const BSONObj& indexInfoObj,
+                                          OrderedIntervalList* oilOut) {
+        // Made on first use, so that the size knob can be set at startup.
+        static S2CoveringCache* coveringCache = new S2CoveringCache();
+
+        if (!coveringCache->enabled() || !oilOut->intervals.empty()) {
+            cover2dsphere(region, indexInfoObj, oilOut);
+            return;
+        }
+
+        const int coarsestIndexedLevel = getCoarsestIndexedLevel(indexInfoObj);
+        std::string key(geometry.objdata(), geometry.objsize());
+        key.append(reinterpret_cast<const char*>(&coarsestIndexedLevel),
+                   sizeof(coarsestIndexedLevel));
+
+        if (coveringCache->get(key, oilOut)) {
+            return;
+        }
+
+        cover2dsphere(region, indexInfoObj, oilOut);
+        coveringCache->add(key, *oilOut);
+    }
+
 }  // namespace mongo
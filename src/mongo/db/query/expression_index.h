@@ -44,7 +44,10 @@ namespace mongo {
     class ExpressionMapping {
     public:
 
-        static BSONObj hash(const BSONElement& value);
+        /**
+         * Returns the hashed index key for 'value' using the given hash version.
+         */
+        static BSONObj hash(const BSONElement& value, int hashVersion);
 
         static void cover2d(const R2Region& region,
                             const BSONObj& indexInfoObj,
@@ -55,6 +58,17 @@ namespace mongo {
         static void cover2dsphere(const S2Region& region,
                                   const BSONObj& indexInfoObj,
                                   OrderedIntervalList* oilOut);
+
+        /**
+         * Like cover2dsphere, but reuses the covering from the last time the same geometry was
+         * covered for an index with the same coarsest indexed level.  'geometry' is the query
+         * predicate that 'region' was parsed from.  Recent coverings are kept in a cache of
+         * internalGeoPredicateQuery2DSphereCoveringCacheSize entries.
+         */
+        static void cover2dsphere(const S2Region& region,
+                                  const BSONObj& geometry,
+                                  const BSONObj& indexInfoObj,
+                                  OrderedIntervalList* oilOut);
     };
 
 }  // namespace mongo
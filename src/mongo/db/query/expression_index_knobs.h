@@ -44,4 +44,16 @@ namespace mongo {
      */
     extern int internalGeoNearQuery2DMaxCoveringCells;
 
+    /**
+     * The number of 2dsphere predicate query coverings to keep for reuse.  Read once, when the
+     * cache is first used.  0 disables the cache.
+     */
+    extern int internalGeoPredicateQuery2DSphereCoveringCacheSize;
+
+    /**
+     * The number of results $near aims to buffer per annulus.  The width of each annulus is
+     * picked from the density of results seen in the previous one.
+     */
+    extern int internalGeoNearQueryTargetResultsPerAnnulus;
+
 }  // namespace mongo
@@ -34,9 +34,11 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "mongo/base/counter.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/oplogstart.h"
@@ -49,6 +51,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/qlog.h"
 #include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_reply_builder.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
@@ -124,6 +127,18 @@ namespace mongo {
     // Failpoint for checking whether we've received a getmore.
     MONGO_FP_DECLARE(failReceivedGetmore);
 
+    // How many bytes of results to produce for a cursor's next getMore after replying to one,
+    // while the client is busy receiving that reply.  0 turns prefetching off.
+    MONGO_EXPORT_SERVER_PARAMETER(getMorePrefetchBytes, int, 0);
+
+    static Counter64 getMorePrefetchedDocs;
+    static ServerStatusMetricField<Counter64> displayGetMorePrefetchedDocs(
+        "cursor.prefetch.docs", &getMorePrefetchedDocs);
+
+    static Counter64 getMoreAnsweredFromPrefetch;
+    static ServerStatusMetricField<Counter64> displayGetMoreAnsweredFromPrefetch(
+        "cursor.prefetch.docsReturned", &getMoreAnsweredFromPrefetch);
+
     // TODO: Move this and the other command stuff in runQuery outta here and up a level.
     static bool runCommands(OperationContext* txn,
                             const char *ns,
@@ -178,18 +193,19 @@ namespace mongo {
      * Called by db/instance.cpp.  This is the getMore entry point.
      *
      * pass - when QueryOption_AwaitData is in use, the caller will make repeated calls 
-     *        when this method returns an empty result, incrementing pass on each call.  
+     *        when this method returns false, incrementing pass on each call.  
      *        Thus, pass == 0 indicates this is the first "attempt" before any 'awaiting'.
      */
-    QueryResult::View getMore(OperationContext* txn,
-                              const char* ns,
-                              int ntoreturn,
-                              long long cursorid,
-                              CurOp& curop,
-                              int pass,
-                              bool& exhaust,
-                              bool* isCursorAuthorized,
-                              bool fromDBDirectClient) {
+    bool getMore(OperationContext* txn,
+                 const char* ns,
+                 int ntoreturn,
+                 long long cursorid,
+                 CurOp& curop,
+                 int pass,
+                 bool& exhaust,
+                 bool* isCursorAuthorized,
+                 bool fromDBDirectClient,
+                 Message* result) {
 
         // For testing, we may want to fail if we receive a getmore.
         if (MONGO_FAIL_POINT(failReceivedGetmore)) {
@@ -268,8 +284,7 @@ namespace mongo {
         const int InitialBufSize =
             512 + sizeof(QueryResult::Value) + MaxBytesToReturnToClientAtOnce;
 
-        BufBuilder bb(InitialBufSize);
-        bb.skip(sizeof(QueryResult::Value));
+        QueryReplyBuilder reply(InitialBufSize);
 
         if (NULL == cc) {
             cursorid = 0;
@@ -334,11 +349,25 @@ namespace mongo {
             // Get results out of the executor.
             exec->restoreState(txn);
 
+            // Results prefetched since the last getMore come first, and the executor carries
+            // on from where the prefetch stopped.
             BSONObj obj;
             PlanExecutor::ExecState state;
-            while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
+            while (true) {
+                if (cc->nextPrefetched(&state, &obj)) {
+                    if (PlanExecutor::ADVANCED == state) {
+                        getMoreAnsweredFromPrefetch.increment();
+                    }
+                }
+                else {
+                    state = exec->getNext(&obj, NULL);
+                }
+                if (PlanExecutor::ADVANCED != state) {
+                    break;
+                }
+
                 // Add result to output buffer.
-                bb.appendBuf((void*)obj.objdata(), obj.objsize());
+                reply.append(obj);
 
                 // Count the result.
                 ++numResults;
@@ -352,7 +381,7 @@ namespace mongo {
                 }
 
                 if ((ntoreturn && numResults >= ntoreturn)
-                    || bb.len() > MaxBytesToReturnToClientAtOnce) {
+                    || reply.len() > MaxBytesToReturnToClientAtOnce) {
                     break;
                 }
             }
@@ -447,7 +476,7 @@ namespace mongo {
                             && (pass < 1000)) {
                         // Bubble up to the AwaitData handling code in receivedGetMore which will
                         // try again.
-                        return NULL;
+                        return false;
                     }
                 }
 
@@ -464,16 +493,87 @@ namespace mongo {
             }
         }
 
-        QueryResult::View qr = bb.buf();
-        qr.msgdata().setLen(bb.len());
+        QueryResult::View qr = reply.done(result);
         qr.msgdata().setOperation(opReply);
         qr.setResultFlags(resultFlags);
         qr.setCursorId(cursorid);
         qr.setStartingFrom(startingResult);
         qr.setNReturned(numResults);
-        bb.decouple();
         QLOG() << "getMore returned " << numResults << " results\n";
-        return qr;
+        return true;
+    }
+
+    bool shouldPrefetchGetMore(long long cursorid) {
+        return getMorePrefetchBytes > 0
+            && 0 != cursorid
+            && !CursorManager::getGlobalCursorManager()->ownsCursorId(cursorid);
+    }
+
+    void prefetchGetMore(OperationContext* txn,
+                         const HostAndPort& remote,
+                         const std::string& ns,
+                         long long cursorid) {
+        const NamespaceString nss(ns);
+        const size_t budget = std::min(getMorePrefetchBytes, 16 * 1024 * 1024);
+
+        CurOp& curop = *txn->getClient()->curop();
+        curop.reset(remote, dbGetMore);
+        curop.debug().op = dbGetMore;
+        curop.debug().ns = ns;
+        curop.debug().cursorid = cursorid;
+        curop.setMessage("prefetching getMore results");
+
+        try {
+            AutoGetCollectionForRead ctx(txn, nss);
+            Collection* collection = ctx.getCollection();
+            if (NULL == collection) {
+                curop.done();
+                return;
+            }
+
+            // Fails if somebody else has the cursor pinned, in which case they are already
+            // producing its results.
+            ClientCursorPin ccPin(collection->getCursorManager(), cursorid);
+            ClientCursor* cc = ccPin.c();
+            const int unsupportedOptions = QueryOption_CursorTailable | QueryOption_OplogReplay |
+                QueryOption_Exhaust;
+            if (NULL == cc || cc->isAggCursor() || (cc->queryOptions() & unsupportedOptions) ||
+                !cc->hasRecoveryUnit() || cc->prefetchEnded()) {
+                curop.done();
+                return;
+            }
+
+            try {
+                ScopedRecoveryUnitSwapper ruSwapper(cc, txn);
+                PlanExecutor* exec = cc->getExecutor();
+                exec->restoreState(txn);
+
+                BSONObj obj;
+                while (cc->prefetchedBytes() < budget) {
+                    PlanExecutor::ExecState state = exec->getNext(&obj, NULL);
+                    if (PlanExecutor::ADVANCED != state) {
+                        cc->setPrefetchEnd(state, obj);
+                        break;
+                    }
+                    cc->stashPrefetched(obj.getOwned());
+                    getMorePrefetchedDocs.increment();
+                }
+
+                exec->saveState();
+            }
+            catch (const DBException& e) {
+                // The executor may be anywhere now, so the cursor can't go on.  The next getMore
+                // reports that it is gone, as after getMore itself fails.
+                LOG(1) << "prefetching results for cursor " << cursorid << " on " << ns
+                       << " failed, killing the cursor: " << e.toString();
+                ccPin.deleteUnderlying();
+            }
+        }
+        catch (const DBException& e) {
+            LOG(1) << "not prefetching results for cursor " << cursorid << " on " << ns << ": "
+                   << e.toString();
+        }
+        curop.done();
     }
 
     Status getOplogStartHack(OperationContext* txn,
@@ -745,11 +845,10 @@ namespace mongo {
         }
 
         // Run the query.
-        // bb is used to hold query results
+        // reply is used to hold query results
         // this buffer should contain either requested documents per query or
         // explain information, but not both
-        BufBuilder bb(32768);
-        bb.skip(sizeof(QueryResult::Value));
+        QueryReplyBuilder reply(32768);
 
         // How many results have we obtained from the executor?
         int numResults = 0;
@@ -769,7 +868,7 @@ namespace mongo {
 
         while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
             // Add result to output buffer.
-            bb.appendBuf((void*)obj.objdata(), obj.objsize());
+            reply.append(obj);
 
             // Count the result.
             ++numResults;
@@ -786,10 +885,10 @@ namespace mongo {
             // of CanonicalQuery. :(
             const bool supportsGetMore = true;
             if (!supportsGetMore && (enough(pq, numResults)
-                                     || bb.len() >= MaxBytesToReturnToClientAtOnce)) {
+                                     || reply.len() >= MaxBytesToReturnToClientAtOnce)) {
                 break;
             }
-            else if (enoughForFirstBatch(pq, numResults, bb.len())) {
+            else if (enoughForFirstBatch(pq, numResults, reply.len())) {
                 QLOG() << "Enough for first batch, wantMore=" << pq.wantMore()
                        << " numToReturn=" << pq.getNumToReturn()
                        << " numResults=" << numResults
@@ -854,6 +953,18 @@ namespace mongo {
         curop.debug().nscannedObjects = summaryStats.totalDocsExamined;
         curop.debug().idhack = summaryStats.isIdhack;
 
+        // The collection may be gone if the executor died while yielding.
+        if (collection && PlanExecutor::DEAD != state && exec->getCanonicalQuery()) {
+            QueryShapeExecution shapeExecution;
+            shapeExecution.micros = curop.elapsedMicros();
+            shapeExecution.keysExamined = summaryStats.totalKeysExamined;
+            shapeExecution.docsExamined = summaryStats.totalDocsExamined;
+            shapeExecution.nReturned = numResults;
+            shapeExecution.fromPlanCache = summaryStats.fromPlanCache;
+            collection->infoCache()->getQueryShapeStats()->record(*exec->getCanonicalQuery(),
+                                                                  shapeExecution);
+        }
+
         // Set debug information for consumption by the profiler.
         if (dbProfilingLevel > 0 ||
             curop.elapsedMillis() > serverGlobalParams.slowMS ||
@@ -927,12 +1038,8 @@ namespace mongo {
             QLOG() << "Not caching executor but returning " << numResults << " results.\n";
         }
 
-        // Add the results from the query into the output buffer.
-        result.appendData(bb.buf(), bb.len());
-        bb.decouple();
-
-        // Fill out the output buffer's header.
-        QueryResult::View qr = result.header().view2ptr();
+        // Add the results from the query into the output buffer, and fill out its header.
+        QueryResult::View qr = reply.done(&result);
         qr.setCursorId(ccId);
         curop.debug().cursorid = (0 == ccId ? -1 : ccId);
         qr.setResultFlagsToOk();
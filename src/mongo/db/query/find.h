@@ -56,17 +56,38 @@ namespace mongo {
                              PlanExecutor** execOut);
 
     /**
-     * Called from the getMore entry point in ops/query.cpp.
+     * Called from the getMore entry point in ops/query.cpp. Places the reply in 'result', which
+     * must be empty, and returns true; returns false without a reply when an AwaitData cursor
+     * has nothing to return yet.
      */
-    QueryResult::View getMore(OperationContext* txn,
-                              const char* ns,
-                              int ntoreturn,
-                              long long cursorid,
-                              CurOp& curop,
-                              int pass,
-                              bool& exhaust,
-                              bool* isCursorAuthorized,
-                              bool fromDBDirectClient);
+    bool getMore(OperationContext* txn,
+                 const char* ns,
+                 int ntoreturn,
+                 long long cursorid,
+                 CurOp& curop,
+                 int pass,
+                 bool& exhaust,
+                 bool* isCursorAuthorized,
+                 bool fromDBDirectClient,
+                 Message* result);
+
+    /**
+     * Returns true if, after replying to a getMore on a cursor that is still open, the results
+     * for the next getMore should be produced by prefetchGetMore.
+     */
+    bool shouldPrefetchGetMore(long long cursorid);
+
+    /**
+     * Called on the connection's thread after a getMore reply has been sent.  Runs the cursor's
+     * executor until it has produced the getMorePrefetchBytes server parameter's worth of
+     * results, which it stashes in the ClientCursor for the next getMore to return.  Does
+     * nothing for cursors it can't support, such as tailable and aggregation cursors, or if
+     * the cursor is in use.
+     */
+    void prefetchGetMore(OperationContext* txn,
+                         const HostAndPort& remote,
+                         const std::string& ns,
+                         long long cursorid);
 
     /**
      * Run the query 'q' and place the result in 'result'.
@@ -34,6 +34,7 @@
 
 #include <limits>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/error_codes.h"
 #include "mongo/base/parse_number.h"
 #include "mongo/client/dbclientinterface.h"
@@ -48,14 +49,17 @@
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/subplan.h"
 #include "mongo/db/exec/update.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/global_environment_experiment.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/index_stats.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cost_estimator.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/planner_access.h"
@@ -109,6 +113,7 @@ namespace mongo {
     namespace {
         // The body is below in the "count hack" section but getExecutor calls it.
         bool turnIxscanIntoCount(QuerySolution* soln);
+        bool dropFetchForCount(QuerySolution* soln);
     }  // namespace
 
 
@@ -128,6 +133,21 @@ namespace mongo {
                                                         desc->unique(),
                                                         desc->indexName(),
                                                         desc->infoObj()));
+
+            // A skip scan seeks once or twice per leading value, so it is only worth offering
+            // when there are few of them.
+            IndexEntry& entry = plannerParams->indices.back();
+            entry.multikeyPaths = desc->getMultikeyPaths(txn);
+            if (internalQuerySkipScanMaxLeadingValues > 0
+                    && INDEX_BTREE == entry.type
+                    && !entry.multikey
+                    && !entry.sparse
+                    && entry.keyPattern.nFields() > 1) {
+                const IndexKeyStats stats =
+                    collection->infoCache()->getIndexStatsCache()->get(txn, collection, desc);
+                entry.allowSkipScan = stats.leadingValues >= 0
+                    && stats.leadingValues <= internalQuerySkipScanMaxLeadingValues;
+            }
         }
 
         // If query supports index filters, filter params.indices by indices in query settings.
@@ -140,6 +160,7 @@ namespace mongo {
             boost::scoped_ptr<AllowedIndices> allowedIndices(allowedIndicesRaw);
             filterAllowedIndexEntries(*allowedIndices, &plannerParams->indices);
             plannerParams->indexFiltersApplied = true;
+            plannerParams->pinnedPlan = allowedIndices->pinnedPlan;
         }
 
         // We will not output collection scans unless there are no indexed solutions. NO_TABLE_SCAN
@@ -192,6 +213,34 @@ namespace mongo {
 
     namespace {
 
+        Counter64 pinnedPlanUsedCounter;
+        Counter64 pinnedPlanInvalidCounter;
+
+        ServerStatusMetricField<Counter64> displayPinnedPlanUsed(
+            "queryExecutor.pinnedPlan.used", &pinnedPlanUsedCounter);
+        ServerStatusMetricField<Counter64> displayPinnedPlanInvalid(
+            "queryExecutor.pinnedPlan.invalid", &pinnedPlanInvalidCounter);
+
+        /**
+         * Plans 'canonicalQuery' straight from the plan an index filter pinned to its shape,
+         * without enumerating or ranking candidates. The pinned plan is checked against the
+         * filtered indexes every time, so a plan that refers to a dropped or changed index is
+         * rejected and the query is planned as usual.
+         */
+        Status planFromPinnedPlan(const CanonicalQuery& canonicalQuery,
+                                  const QueryPlannerParams& plannerParams,
+                                  QuerySolution** out) {
+            SolutionCacheData* rawData;
+            Status status = SolutionCacheData::parse(plannerParams.pinnedPlan,
+                                                     plannerParams.indices,
+                                                     &rawData);
+            if (!status.isOK()) {
+                return status;
+            }
+            boost::scoped_ptr<SolutionCacheData> data(rawData);
+            return QueryPlanner::planFromCache(canonicalQuery, plannerParams, *data, out);
+        }
+
         /**
          * Build an execution tree for the query described in 'canonicalQuery'.  Does not take
          * ownership of arguments.
@@ -285,6 +334,30 @@ namespace mongo {
                 }
             }
 
+            if (!plannerParams.pinnedPlan.isEmpty()) {
+                QuerySolution* qs;
+                Status status = planFromPinnedPlan(*canonicalQuery, plannerParams, &qs);
+                if (status.isOK()) {
+                    pinnedPlanUsedCounter.increment();
+                    if (plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT) {
+                        if (!turnIxscanIntoCount(qs)) {
+                            dropFetchForCount(qs);
+                        }
+                    }
+
+                    verify(StageBuilder::build(opCtx, collection, *qs, ws, rootOut));
+                    LOG(2) << "Using pinned plan: " << canonicalQuery->toStringShort()
+                           << ", planSummary: " << Explain::getPlanSummary(*rootOut);
+
+                    *querySolutionOut = qs;
+                    return Status::OK();
+                }
+
+                pinnedPlanInvalidCounter.increment();
+                LOG(1) << "Pinned plan no longer applies, planning normally: "
+                       << canonicalQuery->toStringShort() << ": " << status.reason();
+            }
+
             // Try to look up a cached solution for the query.
             CachedSolution* rawCS;
             if (PlanCache::shouldCacheQuery(*canonicalQuery) &&
@@ -297,11 +370,20 @@ namespace mongo {
 
                 if (status.isOK()) {
                     PlanStage *backupRoot = NULL;
+                    bool isFastCount = false;
+                    if (plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT) {
+                        isFastCount = turnIxscanIntoCount(qs);
+                        if (!isFastCount) {
+                            dropFetchForCount(qs);
+                            if (NULL != backupQs) {
+                                dropFetchForCount(backupQs);
+                            }
+                        }
+                    }
+
                     // The working set is shared by the root and backupRoot plans.
                     verify(StageBuilder::build(opCtx, collection, *qs, ws, rootOut));
-                    if ((plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT)
-                        && turnIxscanIntoCount(qs)) {
-
+                    if (isFastCount) {
                         LOG(2) << "Using fast count: " << canonicalQuery->toStringShort()
                                << ", planSummary: " << Explain::getPlanSummary(*rootOut);
                     }
@@ -310,8 +392,14 @@ namespace mongo {
                     }
 
                     // Add a CachedPlanStage on top of the previous root. Takes ownership of
-                    // '*rootOut', 'backupRoot', 'qs', and 'backupQs'.
-                    *rootOut = new CachedPlanStage(collection, canonicalQuery,
+                    // '*rootOut', 'backupRoot', 'qs', and 'backupQs'. Replanning would lose the
+                    // count rewrites above, so counts never replan.
+                    const size_t decisionWorks =
+                        (plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT)
+                            ? 0 : cs->decisionWorks;
+                    *rootOut = new CachedPlanStage(opCtx, collection, ws, canonicalQuery,
+                                                   plannerParams, decisionWorks,
+                                                   cs->replanBackoff,
                                                    *rootOut, qs,
                                                    backupRoot, backupQs);
                     return Status::OK();
@@ -367,6 +455,20 @@ namespace mongo {
                         return Status::OK();
                     }
                 }
+
+                // No single interval to count, but the candidates that answer the predicate from
+                // index keys alone still don't need to fetch anything.
+                for (size_t i = 0; i < solutions.size(); ++i) {
+                    dropFetchForCount(solutions[i]);
+                }
+            }
+
+            // Drop the candidates the cost model is sure would lose the trial period. If that
+            // leaves a single candidate, it runs without being ranked.
+            size_t numPruned = PlanCostEstimator(opCtx, collection).pruneSolutions(&solutions);
+            if (numPruned > 0) {
+                LOG(2) << "Pruned " << numPruned << " candidate plans by estimated cost: "
+                       << canonicalQuery->toStringShort();
             }
 
             if (1 == solutions.size()) {
@@ -511,6 +613,8 @@ namespace mongo {
         deleteStageParams.shouldCallLogOp = request->shouldCallLogOp();
         deleteStageParams.fromMigrate = request->isFromMigrate();
         deleteStageParams.isExplain = request->isExplain();
+        deleteStageParams.returnDeleted = request->shouldReturnDeleted();
+        deleteStageParams.limit = request->getLimit();
 
         auto_ptr<WorkingSet> ws(new WorkingSet());
         PlanExecutor::YieldPolicy policy = parsedDelete->canYield() ? PlanExecutor::YIELD_AUTO :
@@ -567,6 +671,7 @@ namespace mongo {
             return status;
         }
         invariant(root);
+        deleteStageParams.canonicalQuery = cq.get();
 
         root = new DeleteStage(txn, deleteStageParams, ws.get(), collection, root);
         // We must have a tree of stages in order to have a valid plan executor, but the query
@@ -833,6 +938,58 @@ namespace mongo {
             return true;
         }
 
+        /**
+         * Returns true if 'node' produces exactly the RecordIds matching its part of the query
+         * using nothing but index keys: index scans over btree indices, and unions of them.
+         */
+        bool isIndexOnlyForCount(const QuerySolutionNode* node) {
+            if (STAGE_IXSCAN == node->getType()) {
+                // The planner only puts a filter on an IXSCAN if it can be applied to the keys.
+                const IndexScanNode* isn = static_cast<const IndexScanNode*>(node);
+                return IndexNames::findPluginName(isn->indexKeyPattern).empty();
+            }
+
+            if (STAGE_OR != node->getType() && STAGE_SORT_MERGE != node->getType()) {
+                return false;
+            }
+
+            if (NULL != node->filter.get()) {
+                return false;
+            }
+
+            for (size_t i = 0; i < node->children.size(); ++i) {
+                if (!isIndexOnlyForCount(node->children[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Returns 'true' if the FETCH at the root of 'soln' only exists to produce documents,
+         * which a count throws away, and removes it. The index scans under it are left to count
+         * from, with their bounds (any number of intervals) and filters on the keys intact.
+         *
+         * Otherwise, returns 'false'.
+         */
+        bool dropFetchForCount(QuerySolution* soln) {
+            QuerySolutionNode* root = soln->root.get();
+
+            if (STAGE_FETCH != root->getType() || NULL != root->filter.get()) {
+                return false;
+            }
+
+            QuerySolutionNode* child = root->children[0];
+            if (!isIndexOnlyForCount(child)) {
+                return false;
+            }
+
+            // Takes ownership of 'child' and deletes the old root.
+            root->children.clear();
+            soln->root.reset(child);
+            return true;
+        }
+
         /**
          * Returns true if indices contains an index that can be
          * used with DistinctNode. Sets indexOut to the array index
@@ -1075,6 +1232,19 @@ namespace mongo {
         return false;
     }
 
+    namespace {
+
+        /**
+         * Returns true if 'soln' is a projection over an index scan, with no fetch.
+         */
+        bool isCoveredIxscan(const QuerySolution* soln) {
+            const QuerySolutionNode* root = soln->root.get();
+            return STAGE_PROJECTION == root->getType() &&
+                   STAGE_IXSCAN == root->children[0]->getType();
+        }
+
+    }  // namespace
+
     Status getExecutorDistinct(OperationContext* txn,
                                Collection* collection,
                                const BSONObj& query,
@@ -1214,6 +1384,30 @@ namespace mongo {
             }
         }
 
+        // No solution can skip from one value to the next, but a covered index scan whose filter
+        // is applied to the keys still avoids fetching any document, which regular planning
+        // without the projection could not.
+        for (size_t i = 0; i < solutions.size(); ++i) {
+            if (isCoveredIxscan(solutions[i])) {
+                for (size_t j = 0; j < solutions.size(); ++j) {
+                    if (j != i) {
+                        delete solutions[j];
+                    }
+                }
+
+                WorkingSet* ws = new WorkingSet();
+                PlanStage* root;
+                verify(StageBuilder::build(txn, collection, *solutions[i], ws, &root));
+
+                LOG(2) << "Using covered distinct: " << cq->toStringShort()
+                       << ", planSummary: " << Explain::getPlanSummary(root);
+
+                // Takes ownership of 'ws', 'root', 'solutions[i]', and 'autoCq'.
+                return PlanExecutor::make(txn, ws, root, solutions[i], autoCq.release(),
+                                          collection, yieldPolicy, out);
+            }
+        }
+
         // If we're here, the planner made a soln with the restricted index set but we couldn't
         // translate any of them into a distinct-compatible soln.  So, delete the solutions and just
         // go through normal planning.
@@ -240,8 +240,11 @@ namespace mongo {
         oilOut->name = elt.fieldName();
 
         bool isHashed = false;
+        int hashVersion = 0;
         if (mongoutils::str::equals("hashed", elt.valuestrsafe())) {
             isHashed = true;
+            // The bounds must hash with the same function the index keys were built with
+            hashVersion = index.infoObj["hashVersion"].numberInt();
         }
 
         if (isHashed) {
@@ -345,7 +348,7 @@ namespace mongo {
         }
         else if (MatchExpression::EQ == expr->matchType()) {
             const EqualityMatchExpression* node = static_cast<const EqualityMatchExpression*>(expr);
-            translateEquality(node->getData(), isHashed, oilOut, tightnessOut);
+            translateEquality(node->getData(), isHashed, hashVersion, oilOut, tightnessOut);
         }
         else if (MatchExpression::LTE == expr->matchType()) {
             const LTEMatchExpression* node = static_cast<const LTEMatchExpression*>(expr);
@@ -543,7 +546,7 @@ namespace mongo {
             IndexBoundsBuilder::BoundsTightness tightness;
             for (BSONElementSet::iterator it = afr.equalities().begin();
                  it != afr.equalities().end(); ++it) {
-                translateEquality(*it, isHashed, oilOut, &tightness);
+                translateEquality(*it, isHashed, hashVersion, oilOut, &tightness);
                 if (tightness != IndexBoundsBuilder::EXACT) {
                     *tightnessOut = tightness;
                 }
@@ -580,7 +583,7 @@ namespace mongo {
             if (mongoutils::str::equals("2dsphere", elt.valuestrsafe())) {
                 verify(gme->getGeoExpression().getGeometry().hasS2Region());
                 const S2Region& region = gme->getGeoExpression().getGeometry().getS2Region();
-                ExpressionMapping::cover2dsphere(region, index.infoObj, oilOut);
+                ExpressionMapping::cover2dsphere(region, gme->getRawObj(), index.infoObj, oilOut);
                 *tightnessOut = IndexBoundsBuilder::INEXACT_FETCH;
             }
             else if (mongoutils::str::equals("2d", elt.valuestrsafe())) {
@@ -810,13 +813,14 @@ namespace mongo {
 
     // static
     void IndexBoundsBuilder::translateEquality(const BSONElement& data, bool isHashed,
-                                               OrderedIntervalList* oil, BoundsTightness* tightnessOut) {
+                                               int hashVersion, OrderedIntervalList* oil,
+                                               BoundsTightness* tightnessOut) {
         // We have to copy the data out of the parse tree and stuff it into the index
         // bounds.  BSONValue will be useful here.
         if (Array != data.type()) {
             BSONObj dataObj;
             if (isHashed) {
-                dataObj = ExpressionMapping::hash(data);
+                dataObj = ExpressionMapping::hash(data, hashVersion);
             }
             else {
                 dataObj = objFromElement(data);
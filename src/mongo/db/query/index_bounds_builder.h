@@ -161,6 +161,7 @@ namespace mongo {
 
         static void translateEquality(const BSONElement& data,
                                       bool isHashed,
+                                      int hashVersion,
                                       OrderedIntervalList* oil,
                                       BoundsTightness* tightnessOut);
 
@@ -1181,6 +1181,65 @@ namespace {
         ASSERT(tightness == IndexBoundsBuilder::INEXACT_FETCH);
     }
 
+    // The covering of a repeated 2dsphere query geometry is reused, and must match a fresh one.
+    TEST(IndexBoundsBuilderTest, Translate2dsphereRepeatedGeometry) {
+        IndexEntry testIndex = IndexEntry(BSON("a" << "2dsphere"));
+        BSONObj obj = fromjson("{a: {$geoWithin: {$geometry: {type: 'Polygon', coordinates: "
+                               "[[[0, 0], [0, 1], [1, 1], [1, 0], [0, 0]]]}}}}");
+        BSONElement elt = testIndex.keyPattern.firstElement();
+
+        OrderedIntervalList first;
+        OrderedIntervalList second;
+        for (int i = 0; i < 2; i++) {
+            auto_ptr<MatchExpression> expr(parseMatchExpression(obj.copy()));
+            IndexBoundsBuilder::BoundsTightness tightness;
+            IndexBoundsBuilder::translate(expr.get(), elt, testIndex,
+                                          0 == i ? &first : &second, &tightness);
+            ASSERT(tightness == IndexBoundsBuilder::INEXACT_FETCH);
+        }
+
+        ASSERT_GREATER_THAN(first.intervals.size(), 0U);
+        ASSERT_EQUALS(first.intervals.size(), second.intervals.size());
+        for (size_t i = 0; i < first.intervals.size(); i++) {
+            ASSERT_EQUALS(Interval::INTERVAL_EQUALS,
+                          first.intervals[i].compare(second.intervals[i]));
+        }
+
+        // An index with a different coarsest level gets its own covering.
+        IndexEntry coarseIndex = testIndex;
+        coarseIndex.infoObj = BSON("coarsestIndexedLevel" << 2);
+        OrderedIntervalList coarse;
+        auto_ptr<MatchExpression> expr(parseMatchExpression(obj));
+        IndexBoundsBuilder::BoundsTightness tightness;
+        IndexBoundsBuilder::translate(expr.get(), elt, coarseIndex, &coarse, &tightness);
+        ASSERT_GREATER_THAN(coarse.intervals.size(), first.intervals.size());
+    }
+
+    // Hilbert order keys put the cells of a box that straddles quadrant boundaries into fewer,
+    // longer intervals than Z order keys.
+    TEST(IndexBoundsBuilderTest, Translate2dBoxHilbertOrder) {
+        IndexEntry zOrderIndex = IndexEntry(BSON("a" << "2d"));
+        IndexEntry hilbertIndex = zOrderIndex;
+        hilbertIndex.infoObj = BSON("2dIndexVersion" << 2);
+        BSONObj obj = fromjson("{a: {$within: {$box: [[-10, -10], [10, 10]]}}}");
+        BSONElement elt = zOrderIndex.keyPattern.firstElement();
+
+        OrderedIntervalList zOrder;
+        OrderedIntervalList hilbert;
+        for (int i = 0; i < 2; i++) {
+            auto_ptr<MatchExpression> expr(parseMatchExpression(obj));
+            IndexBoundsBuilder::BoundsTightness tightness;
+            IndexBoundsBuilder::translate(expr.get(), elt,
+                                          0 == i ? zOrderIndex : hilbertIndex,
+                                          0 == i ? &zOrder : &hilbert, &tightness);
+            ASSERT(tightness == IndexBoundsBuilder::INEXACT_FETCH);
+        }
+
+        ASSERT_GREATER_THAN(hilbert.intervals.size(), 0U);
+        ASSERT_LESS_THAN(hilbert.intervals.size(), zOrder.intervals.size());
+        ASSERT(hilbert.isValidFor(1));
+    }
+
     // Test $type bounds for Code With Scoped BSON type.
     TEST(IndexBoundsBuilderTest, CodeWithScopeTypeBounds) {
         IndexEntry testIndex = IndexEntry(BSONObj());
@@ -52,10 +52,12 @@ namespace mongo {
                    const BSONObj& io)
             : keyPattern(kp),
               multikey(mk),
+              multikeyPaths(mk ? ~0ULL : 0),
               sparse(sp),
               unique(unq),
               name(n),
-              infoObj(io) {
+              infoObj(io),
+              allowSkipScan(false) {
 
             type = IndexNames::nameToType(accessMethod);
         }
@@ -71,10 +73,12 @@ namespace mongo {
                    const BSONObj& io)
             : keyPattern(kp),
               multikey(mk),
+              multikeyPaths(mk ? ~0ULL : 0),
               sparse(sp),
               unique(unq),
               name(n),
-              infoObj(io) {
+              infoObj(io),
+              allowSkipScan(false) {
 
             type = IndexNames::nameToType(IndexNames::findPluginName(keyPattern));
         }
@@ -85,10 +89,12 @@ namespace mongo {
         IndexEntry(const BSONObj& kp)
             : keyPattern(kp),
               multikey(false),
+              multikeyPaths(0),
               sparse(false),
               unique(false),
               name("test_foo"),
-              infoObj(BSONObj()) {
+              infoObj(BSONObj()),
+              allowSkipScan(false) {
 
             type = IndexNames::nameToType(IndexNames::findPluginName(keyPattern));
         }
@@ -97,6 +103,10 @@ namespace mongo {
 
         bool multikey;
 
+        // A bit per key pattern field, set if documents may hold an array on the path to it.
+        // Fields whose bit is clear can be covered even if the index is multikey.
+        unsigned long long multikeyPaths;
+
         bool sparse;
 
         bool unique;
@@ -110,6 +120,11 @@ namespace mongo {
         // by the keyPattern?)
         IndexType type;
 
+        // Can the planner scan this index for predicates over its later fields alone, seeking
+        // from one value of the leading field to the next?  Set from the index statistics when
+        // the leading field has few distinct values.
+        bool allowSkipScan;
+
         std::string toString() const {
             mongoutils::str::stream ss;
             ss << "kp: "  << keyPattern.toString();
@@ -122,6 +137,10 @@ namespace mongo {
                 ss << " sparse";
             }
 
+            if (allowSkipScan) {
+                ss << " skipScan";
+            }
+
             if (!infoObj.isEmpty()) {
                 ss << " io: " << infoObj.toString();
             }
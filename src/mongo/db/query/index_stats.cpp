@@ -0,0 +1,231 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_stats.h"
+
+#include <algorithm>
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/index/btree_index_cursor.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_cursor.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/query_knobs.h"
+
+namespace mongo {
+
+namespace {
+
+    /**
+     * Returns a key that sorts before every key of an index over 'keyPattern': the lowest value
+     * of every ascending field and the highest value of every descending one.
+     */
+    BSONObj firstKeyInIndexOrder(const BSONObj& keyPattern) {
+        BSONObjBuilder bob;
+        BSONObjIterator it(keyPattern);
+        while (it.more()) {
+            BSONElement elt = it.next();
+            if (elt.isNumber() && elt.number() < 0) {
+                bob.appendMaxKey("");
+            }
+            else {
+                bob.appendMinKey("");
+            }
+        }
+        return bob.obj();
+    }
+
+}  // namespace
+
+    double IndexKeyStats::keysPerValue(size_t numFields) const {
+        invariant(numFields > 0);
+        if (distinctPrefixes.empty()) {
+            return 1;
+        }
+
+        size_t ix = std::min(numFields, distinctPrefixes.size()) - 1;
+        return static_cast<double>(keysSampled) / distinctPrefixes[ix];
+    }
+
+    void IndexKeyStatsBuilder::addKey(const BSONObj& key) {
+        if (0 == _stats.keysSampled) {
+            _stats.distinctPrefixes.assign(key.nFields(), 1);
+        }
+        else {
+            // Find the first field that differs from the previous key. Every prefix that
+            // includes it starts a new distinct value.
+            BSONObjIterator it(key);
+            BSONObjIterator lastIt(_lastKey);
+            size_t field = 0;
+            while (it.more() && lastIt.more()) {
+                if (0 != it.next().woCompare(lastIt.next(), false)) {
+                    break;
+                }
+                ++field;
+            }
+            for (size_t i = field; i < _stats.distinctPrefixes.size(); ++i) {
+                ++_stats.distinctPrefixes[i];
+            }
+        }
+
+        _lastKey = key.getOwned();
+        ++_stats.keysSampled;
+    }
+
+    IndexKeyStats IndexKeyStatsBuilder::done(bool complete) {
+        _stats.complete = complete;
+        return _stats;
+    }
+
+    IndexKeyStats IndexStatsCache::get(OperationContext* txn,
+                                       const Collection* collection,
+                                       const IndexDescriptor* desc) {
+        const long long numRecords = collection->numRecords(txn);
+        {
+            boost::mutex::scoped_lock lk(_mutex);
+            std::map<std::string, Entry>::const_iterator it = _entries.find(desc->indexName());
+            if (it != _entries.end()) {
+                const Entry& entry = it->second;
+                if (numRecords <= 2 * entry.numRecords && 2 * numRecords >= entry.numRecords) {
+                    return entry.stats;
+                }
+            }
+        }
+
+        // Read the index without holding the mutex; a concurrent reader may sample the same
+        // index, in which case the last one to finish wins.
+        Entry entry;
+        entry.stats = sampleIndex(txn, collection, desc);
+        entry.numRecords = numRecords;
+
+        boost::mutex::scoped_lock lk(_mutex);
+        _entries[desc->indexName()] = entry;
+        return entry.stats;
+    }
+
+    void IndexStatsCache::clear() {
+        boost::mutex::scoped_lock lk(_mutex);
+        _entries.clear();
+    }
+
+    // static
+    IndexKeyStats IndexStatsCache::sampleIndex(OperationContext* txn,
+                                               const Collection* collection,
+                                               const IndexDescriptor* desc) {
+        const std::string pluginName = desc->getAccessMethodName();
+        if (IndexNames::BTREE != pluginName && IndexNames::HASHED != pluginName) {
+            return IndexKeyStats();
+        }
+
+        const IndexAccessMethod* iam = collection->getIndexCatalog()->getIndex(desc);
+        CursorOptions cursorOptions;
+        cursorOptions.direction = CursorOptions::INCREASING;
+
+        IndexCursor* rawCursor;
+        if (!iam->newCursor(txn, cursorOptions, &rawCursor).isOK()) {
+            return IndexKeyStats();
+        }
+        boost::scoped_ptr<IndexCursor> cursor(rawCursor);
+
+        cursor->seek(firstKeyInIndexOrder(desc->keyPattern()));
+
+        IndexKeyStatsBuilder builder;
+        const long long maxKeys = std::max(1, internalQueryIndexStatsSampleKeys);
+        for (long long n = 0; n < maxKeys && !cursor->isEOF(); ++n) {
+            builder.addKey(cursor->getKey());
+            cursor->next();
+        }
+
+        IndexKeyStats stats = builder.done(cursor->isEOF());
+        if (IndexNames::BTREE != pluginName || desc->keyPattern().nFields() < 2) {
+            return stats;
+        }
+
+        if (stats.complete) {
+            // The sample already saw every leading value.
+            const long long values = stats.distinctPrefixes.empty() ? 0 : stats.distinctPrefixes[0];
+            stats.leadingValues = (values <= internalQuerySkipScanMaxLeadingValues) ? values : -1;
+        }
+        else {
+            stats.leadingValues = countLeadingValues(txn, iam, desc);
+        }
+        return stats;
+    }
+
+    // static
+    long long IndexStatsCache::countLeadingValues(OperationContext* txn,
+                                                  const IndexAccessMethod* iam,
+                                                  const IndexDescriptor* desc) {
+        const BSONObj keyPattern = desc->keyPattern();
+        const long long maxValues = internalQuerySkipScanMaxLeadingValues;
+        if (maxValues <= 0) {
+            return -1;
+        }
+
+        CursorOptions cursorOptions;
+        cursorOptions.direction = CursorOptions::INCREASING;
+
+        IndexCursor* rawCursor;
+        if (!iam->newCursor(txn, cursorOptions, &rawCursor).isOK()) {
+            return -1;
+        }
+        // Btree indices always give btree cursors.
+        boost::scoped_ptr<BtreeIndexCursor> cursor(static_cast<BtreeIndexCursor*>(rawCursor));
+        cursor->seek(firstKeyInIndexOrder(keyPattern));
+
+        long long values = 0;
+        while (!cursor->isEOF()) {
+            if (++values > maxValues) {
+                return -1;
+            }
+
+            // Seek past the last key with this leading value: the one with the highest value of
+            // every later ascending field and the lowest of every later descending one.
+            BSONObjBuilder skipBob;
+            skipBob.appendAs(cursor->getKey().firstElement(), "");
+            BSONObjIterator it(keyPattern);
+            it.next();
+            while (it.more()) {
+                BSONElement elt = it.next();
+                if (elt.isNumber() && elt.number() < 0) {
+                    skipBob.appendMinKey("");
+                }
+                else {
+                    skipBob.appendMaxKey("");
+                }
+            }
+            cursor->seek(skipBob.obj(), true);
+        }
+        return values;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,135 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    class Collection;
+    class IndexAccessMethod;
+    class IndexDescriptor;
+    class OperationContext;
+
+    /**
+     * How many keys of an index share a value, per leading prefix of the key pattern. Derived
+     * from a run of keys read in index order, so it is exact when the run covers the whole
+     * index and an estimate otherwise.
+     */
+    struct IndexKeyStats {
+        IndexKeyStats() : keysSampled(0), complete(false), leadingValues(-1) { }
+
+        /**
+         * Returns the average number of keys sharing one value of the first 'numFields' fields,
+         * or 1 if nothing was sampled. 'numFields' must be at least 1.
+         */
+        double keysPerValue(size_t numFields) const;
+
+        long long keysSampled;
+
+        // distinctPrefixes[i] is the number of distinct values of the first i + 1 key fields.
+        std::vector<long long> distinctPrefixes;
+
+        // Whether the sampled keys were all the keys in the index.
+        bool complete;
+
+        // The number of distinct values of the leading field across the whole index, counted by
+        // seeking from one value to the next. -1 if the index is not a compound btree index or
+        // there are more than internalQuerySkipScanMaxLeadingValues of them.
+        long long leadingValues;
+    };
+
+    /**
+     * Accumulates IndexKeyStats from keys fed in index order.
+     */
+    class IndexKeyStatsBuilder {
+    public:
+        void addKey(const BSONObj& key);
+
+        IndexKeyStats done(bool complete);
+
+    private:
+        BSONObj _lastKey;
+        IndexKeyStats _stats;
+    };
+
+    /**
+     * Per-collection cache of IndexKeyStats, keyed by index name. Entries are filled by reading
+     * the first internalQueryIndexStatsSampleKeys keys of an index the first time a plan over
+     * it is costed, and are read again once the collection has grown or shrunk by half.
+     *
+     * Thread-safe.
+     */
+    class IndexStatsCache {
+        MONGO_DISALLOW_COPYING(IndexStatsCache);
+    public:
+        IndexStatsCache() { }
+
+        /**
+         * Returns the statistics for 'desc', sampling the index if they are missing or stale.
+         * The caller must hold a lock on 'collection'. Indices that are not btree-backed get
+         * empty statistics.
+         */
+        IndexKeyStats get(OperationContext* txn,
+                          const Collection* collection,
+                          const IndexDescriptor* desc);
+
+        /**
+         * Drops every entry. Called when the set of indices changes.
+         */
+        void clear();
+
+    private:
+        struct Entry {
+            IndexKeyStats stats;
+
+            // Collection size when the index was sampled.
+            long long numRecords;
+        };
+
+        static IndexKeyStats sampleIndex(OperationContext* txn,
+                                         const Collection* collection,
+                                         const IndexDescriptor* desc);
+
+        static long long countLeadingValues(OperationContext* txn,
+                                            const IndexAccessMethod* iam,
+                                            const IndexDescriptor* desc);
+
+        boost::mutex _mutex;
+
+        // Protected by _mutex.
+        std::map<std::string, Entry> _entries;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,301 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/parallel_scan.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/multi_iterator.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    using boost::scoped_ptr;
+    using std::auto_ptr;
+    using std::string;
+    using std::vector;
+
+namespace {
+
+    /**
+     * Shared between the thread running a parallel scan and its workers.
+     */
+    class ParallelScanState {
+    public:
+        ParallelScanState(const string& ns,
+                          const BSONObj& filter,
+                          const vector<ParallelScanWorker*>& workers)
+            : ns(ns),
+              filter(filter),
+              workers(workers),
+              _running(0),
+              _killed(false),
+              _opIds(workers.size(), 0),
+              _statuses(workers.size(), Status::OK()) { }
+
+        const string ns;
+        const BSONObj filter;
+        const vector<ParallelScanWorker*>& workers;
+
+        void workerStarting() {
+            boost::mutex::scoped_lock lk(_mutex);
+            _running++;
+        }
+
+        /**
+         * Records the operation of the worker for 'partition' so that it can be killed. Returns
+         * false if the scan was already killed, in which case the worker should not start.
+         */
+        bool registerOp(size_t partition, unsigned int opId) {
+            boost::mutex::scoped_lock lk(_mutex);
+            if (_killed) {
+                return false;
+            }
+            _opIds[partition] = opId;
+            return true;
+        }
+
+        void workerDone(size_t partition, const Status& status) {
+            boost::mutex::scoped_lock lk(_mutex);
+            _opIds[partition] = 0;
+            _statuses[partition] = status;
+            _running--;
+            _doneCondition.notify_all();
+        }
+
+        /**
+         * Waits for all workers to finish, killing the ones still running if 'txn' is
+         * interrupted or one of them fails. Returns the status of the scan.
+         */
+        Status waitForWorkers(OperationContext* txn) {
+            Status interruptStatus = Status::OK();
+
+            boost::mutex::scoped_lock lk(_mutex);
+            while (_running > 0) {
+                _doneCondition.timed_wait(lk, boost::posix_time::milliseconds(100));
+                if (_killed) {
+                    continue;
+                }
+
+                interruptStatus = txn->checkForInterruptNoAssert();
+                if (!interruptStatus.isOK() || !_firstFailure().isOK()) {
+                    _killAll_inlock();
+                }
+            }
+
+            if (!interruptStatus.isOK()) {
+                return interruptStatus;
+            }
+            return _firstFailure();
+        }
+
+        void kill() {
+            boost::mutex::scoped_lock lk(_mutex);
+            _killAll_inlock();
+        }
+
+    private:
+        void _killAll_inlock() {
+            _killed = true;
+            for (size_t i = 0; i < _opIds.size(); i++) {
+                if (_opIds[i] != 0) {
+                    getGlobalEnvironment()->killOperation(_opIds[i]);
+                }
+            }
+        }
+
+        Status _firstFailure() const {
+            for (size_t i = 0; i < _statuses.size(); i++) {
+                if (!_statuses[i].isOK()) {
+                    return _statuses[i];
+                }
+            }
+            return Status::OK();
+        }
+
+        boost::mutex _mutex;
+        boost::condition_variable _doneCondition;
+
+        // All protected by _mutex.
+        size_t _running;
+        bool _killed;
+        vector<unsigned int> _opIds;
+        vector<Status> _statuses;
+    };
+
+    /**
+     * Scans partition number 'partition' of the collection on the worker's thread.
+     */
+    Status scanPartition(OperationContext* txn, ParallelScanState* state, size_t partition) {
+        const NamespaceString nss(state->ns);
+        AutoGetCollectionForRead ctx(txn, nss.ns());
+        Collection* collection = ctx.getCollection();
+        if (NULL == collection) {
+            return Status::OK();
+        }
+
+        // Each worker parses its own filter, so that nothing which is evaluated is shared
+        // between threads.
+        StatusWithMatchExpression swme =
+            MatchExpressionParser::parse(state->filter, WhereCallbackReal(txn, nss.db()));
+        if (!swme.isOK()) {
+            return swme.getStatus();
+        }
+        const auto_ptr<MatchExpression> filter(swme.getValue());
+
+        // Every worker gets the same iterators, so taking every n-th one partitions the record
+        // store without any coordination.
+        OwnedPointerVector<RecordIterator> iterators(collection->getManyIterators(txn));
+
+        auto_ptr<WorkingSet> ws(new WorkingSet());
+        auto_ptr<MultiIteratorStage> scan(new MultiIteratorStage(txn, ws.get(), collection));
+        for (size_t i = partition; i < iterators.size(); i += state->workers.size()) {
+            scan->addIterator(iterators.releaseAt(i));
+        }
+
+        auto_ptr<PlanStage> root(
+            new FetchStage(txn, ws.get(), scan.release(), filter.get(), collection));
+
+        PlanExecutor* rawExec;
+        Status makeStatus = PlanExecutor::make(txn,
+                                               ws.release(),
+                                               root.release(),
+                                               collection,
+                                               PlanExecutor::YIELD_AUTO,
+                                               &rawExec);
+        if (!makeStatus.isOK()) {
+            return makeStatus;
+        }
+        const scoped_ptr<PlanExecutor> exec(rawExec);
+
+        return state->workers[partition]->run(txn, exec.get());
+    }
+
+    void runWorker(ParallelScanState* state, size_t partition) {
+        Client::initThread("parallelScan");
+
+        Status status = Status::OK();
+        try {
+            OperationContextImpl txn;
+            if (state->registerOp(partition, txn.getCurOp()->opNum())) {
+                status = scanPartition(&txn, state, partition);
+            }
+            else {
+                status = Status(ErrorCodes::Interrupted, "parallel collection scan was killed");
+            }
+        }
+        catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+        catch (const std::exception& ex) {
+            status = Status(ErrorCodes::InternalError, ex.what());
+        }
+
+        state->workerDone(partition, status);
+        cc().shutdown();
+    }
+
+}  // namespace
+
+    size_t parallelScanWorkers(OperationContext* txn, const Collection* collection) {
+        if (NULL == collection || internalQueryExecParallelScanWorkers < 2) {
+            return 0;
+        }
+
+        const long long minRecords = internalQueryExecParallelScanMinRecords;
+        if (collection->getRecordStore()->numRecords(txn) < minRecords) {
+            return 0;
+        }
+
+        return internalQueryExecParallelScanWorkers;
+    }
+
+    Status runParallelCollectionScan(OperationContext* txn,
+                                     const string& ns,
+                                     const BSONObj& filter,
+                                     const vector<ParallelScanWorker*>& workers) {
+        invariant(!workers.empty());
+
+        ParallelScanState state(ns, filter, workers);
+
+        // Workers on other threads would queue behind the locks held here, so a caller which is
+        // already locked gets the partitions scanned one after the other on its own thread.
+        if (txn->lockState()->isLocked()) {
+            for (size_t i = 0; i < workers.size(); i++) {
+                Status status = scanPartition(txn, &state, i);
+                if (!status.isOK()) {
+                    return status;
+                }
+            }
+            return Status::OK();
+        }
+
+        boost::thread_group threads;
+        try {
+            for (size_t i = 0; i < workers.size(); i++) {
+                state.workerStarting();
+                try {
+                    threads.create_thread(stdx::bind(&runWorker, &state, i));
+                }
+                catch (...) {
+                    state.workerDone(i, Status(ErrorCodes::InternalError,
+                                               "couldn't start parallel scan worker"));
+                    throw;
+                }
+            }
+        }
+        catch (const std::exception& ex) {
+            warning() << "parallel scan of " << ns << " failed to start: " << ex.what();
+            state.kill();
+        }
+
+        const Status status = state.waitForWorkers(txn);
+        threads.join_all();
+        return status;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,81 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    class Collection;
+    class OperationContext;
+    class PlanExecutor;
+
+    /**
+     * Consumes one partition of a parallel collection scan. Each worker is run on its own thread
+     * with its own OperationContext, while holding a read lock on the collection.
+     */
+    class ParallelScanWorker {
+    public:
+        virtual ~ParallelScanWorker() { }
+
+        /**
+         * Drains 'exec', which returns the documents of this worker's partition which match the
+         * scan's filter. 'exec' yields on its own. Returns a non-OK status to fail the scan.
+         */
+        virtual Status run(OperationContext* txn, PlanExecutor* exec) = 0;
+    };
+
+    /**
+     * Returns how many workers a full scan of 'collection' should be split into, or 0 if it
+     * should run on the calling thread. Governed by internalQueryExecParallelScanWorkers and
+     * internalQueryExecParallelScanMinRecords.
+     */
+    size_t parallelScanWorkers(OperationContext* txn, const Collection* collection);
+
+    /**
+     * Scans the collection 'ns' for documents matching 'filter', splitting the record store into
+     * as many partitions as there are 'workers' and running each worker on its own thread.
+     * Partitions are made from RecordStore::getManyIterators(), so storage engines which return
+     * a single iterator get no parallelism, only the first worker sees any documents.
+     *
+     * The workers take their own locks and yield independently. If the caller already holds
+     * locks, the partitions are instead scanned one after the other on the calling thread.
+     * Waits for all workers to finish. If 'txn' is killed, the workers' operations are killed too.
+     * Returns the first non-OK status from a worker.
+     */
+    Status runParallelCollectionScan(OperationContext* txn,
+                                     const std::string& ns,
+                                     const BSONObj& filter,
+                                     const std::vector<ParallelScanWorker*>& workers);
+
+}  // namespace mongo
@@ -112,6 +112,8 @@ namespace mongo {
         : plannerData(entry.plannerData.size()),
           backupSoln(entry.backupSoln),
           key(key),
+          decisionWorks(0),
+          replanBackoff(entry.replanBackoff),
           query(entry.query.getOwned()),
           sort(entry.sort.getOwned()),
           projection(entry.projection.getOwned()) {
@@ -121,6 +123,12 @@ namespace mongo {
             verify(entry.plannerData[i]);
             plannerData[i] = entry.plannerData[i]->clone();
         }
+
+        // The winner's stats come first. Restored entries only have placeholders.
+        if (!entry.decision->stats.empty()
+            && STAGE_UNKNOWN != entry.decision->stats[0]->stageType) {
+            decisionWorks = entry.decision->stats[0]->common.works;
+        }
     }
 
     CachedSolution::~CachedSolution() {
@@ -138,7 +146,8 @@ namespace mongo {
     PlanCacheEntry::PlanCacheEntry(const std::vector<QuerySolution*>& solutions,
                                    PlanRankingDecision* why)
         : plannerData(solutions.size()),
-          decision(why) {
+          decision(why),
+          replanBackoff(1) {
         invariant(why);
 
         // The caller of this constructor is responsible for ensuring
@@ -186,6 +195,7 @@ namespace mongo {
         }
         entry->averageScore = averageScore;
         entry->stddevScore = stddevScore;
+        entry->replanBackoff = replanBackoff;
         return entry;
     }
 
@@ -292,6 +302,148 @@ namespace mongo {
         return ss;
     }
 
+    BSONObj PlanCacheIndexTree::toBSON() const {
+        BSONObjBuilder bob;
+        if (NULL != entry.get()) {
+            bob.append("index", BSON("name" << entry->name << "keyPattern" << entry->keyPattern));
+            bob.append("pos", static_cast<long long>(index_pos));
+        }
+        if (!children.empty()) {
+            BSONArrayBuilder childrenBob(bob.subarrayStart("children"));
+            for (vector<PlanCacheIndexTree*>::const_iterator it = children.begin();
+                    it != children.end(); ++it) {
+                childrenBob.append((*it)->toBSON());
+            }
+            childrenBob.doneFast();
+        }
+        return bob.obj();
+    }
+
+    // static
+    Status PlanCacheIndexTree::parse(const BSONObj& obj,
+                                     const std::vector<IndexEntry>& indices,
+                                     PlanCacheIndexTree** out) {
+        std::auto_ptr<PlanCacheIndexTree> tree(new PlanCacheIndexTree());
+
+        BSONElement indexElt = obj["index"];
+        if (!indexElt.eoo()) {
+            if (Object != indexElt.type()) {
+                return Status(ErrorCodes::BadValue, "index must be an object");
+            }
+            BSONObj indexObj = indexElt.Obj();
+            const string name = indexObj["name"].str();
+            BSONElement keyPatternElt = indexObj["keyPattern"];
+            if (Object != keyPatternElt.type()) {
+                return Status(ErrorCodes::BadValue, "index keyPattern must be an object");
+            }
+            BSONObj keyPattern = keyPatternElt.Obj();
+
+            const IndexEntry* ie = NULL;
+            for (size_t i = 0; i < indices.size(); ++i) {
+                if (indices[i].name == name && 0 == indices[i].keyPattern.woCompare(keyPattern)) {
+                    ie = &indices[i];
+                    break;
+                }
+            }
+            if (NULL == ie) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "index " << name << " " << keyPattern
+                                            << " no longer exists");
+            }
+            tree->setIndexEntry(*ie);
+
+            BSONElement posElt = obj["pos"];
+            if (!posElt.isNumber() || posElt.numberLong() < 0) {
+                return Status(ErrorCodes::BadValue, "pos must be a non-negative number");
+            }
+            tree->index_pos = static_cast<size_t>(posElt.numberLong());
+        }
+
+        BSONElement childrenElt = obj["children"];
+        if (!childrenElt.eoo()) {
+            if (Array != childrenElt.type()) {
+                return Status(ErrorCodes::BadValue, "children must be an array");
+            }
+            BSONObjIterator it(childrenElt.Obj());
+            while (it.more()) {
+                BSONElement childElt = it.next();
+                if (Object != childElt.type()) {
+                    return Status(ErrorCodes::BadValue, "children must be objects");
+                }
+                PlanCacheIndexTree* child;
+                Status status = parse(childElt.Obj(), indices, &child);
+                if (!status.isOK()) {
+                    return status;
+                }
+                tree->children.push_back(child);
+            }
+        }
+
+        *out = tree.release();
+        return Status::OK();
+    }
+
+    BSONObj SolutionCacheData::toBSON() const {
+        BSONObjBuilder bob;
+        switch (this->solnType) {
+        case WHOLE_IXSCAN_SOLN:
+            bob.append("type", "wholeIndexScan");
+            bob.append("direction", this->wholeIXSolnDir);
+            break;
+        case COLLSCAN_SOLN:
+            bob.append("type", "collectionScan");
+            break;
+        case USE_INDEX_TAGS_SOLN:
+            bob.append("type", "indexTags");
+            break;
+        }
+        bob.appendBool("indexFilterApplied", this->indexFilterApplied);
+        if (NULL != this->tree.get()) {
+            bob.append("tree", this->tree->toBSON());
+        }
+        return bob.obj();
+    }
+
+    // static
+    Status SolutionCacheData::parse(const BSONObj& obj,
+                                    const std::vector<IndexEntry>& indices,
+                                    SolutionCacheData** out) {
+        std::auto_ptr<SolutionCacheData> data(new SolutionCacheData());
+
+        const string type = obj["type"].str();
+        if ("wholeIndexScan" == type) {
+            data->solnType = WHOLE_IXSCAN_SOLN;
+            data->wholeIXSolnDir = obj["direction"].numberInt() < 0 ? -1 : 1;
+        }
+        else if ("collectionScan" == type) {
+            data->solnType = COLLSCAN_SOLN;
+        }
+        else if ("indexTags" == type) {
+            data->solnType = USE_INDEX_TAGS_SOLN;
+        }
+        else {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "unknown cached solution type: " << type);
+        }
+        data->indexFilterApplied = obj["indexFilterApplied"].trueValue();
+
+        BSONElement treeElt = obj["tree"];
+        if (COLLSCAN_SOLN != data->solnType) {
+            if (Object != treeElt.type()) {
+                return Status(ErrorCodes::BadValue, "cached solution is missing its index tree");
+            }
+            PlanCacheIndexTree* tree;
+            Status status = PlanCacheIndexTree::parse(treeElt.Obj(), indices, &tree);
+            if (!status.isOK()) {
+                return status;
+            }
+            data->tree.reset(tree);
+        }
+
+        *out = data.release();
+        return Status::OK();
+    }
+
     //
     // PlanCache
     //
@@ -327,10 +479,6 @@ namespace mongo {
         }
 
         PlanCacheEntry* entry = new PlanCacheEntry(solns, why);
-        const LiteParsedQuery& pq = query.getParsed();
-        entry->query = pq.getFilter().getOwned();
-        entry->sort = pq.getSort().getOwned();
-        entry->projection = pq.getProj().getOwned();
 
         // If the winning solution uses a blocking stage, then try and
         // find a fallback solution that has no blocking stage.
@@ -343,16 +491,66 @@ namespace mongo {
             }
         }
 
+        _addEntry(query, entry);
+        return Status::OK();
+    }
+
+    Status PlanCache::addRestored(const CanonicalQuery& query,
+                                  const std::vector<SolutionCacheData*>& plannerData,
+                                  const std::vector<double>& scores,
+                                  boost::optional<size_t> backupSoln) {
+        // The solutions take ownership of the planner data right away, so that it is freed on
+        // every error path.
+        OwnedPointerVector<QuerySolution> solutions;
+        for (size_t i = 0; i < plannerData.size(); ++i) {
+            QuerySolution* qs = new QuerySolution();
+            qs->cacheData.reset(plannerData[i]);
+            solutions.mutableVector().push_back(qs);
+        }
+
+        if (solutions.empty()) {
+            return Status(ErrorCodes::BadValue, "no solutions provided");
+        }
+
+        if (scores.size() != solutions.size()) {
+            return Status(ErrorCodes::BadValue, "number of scores must match solutions");
+        }
+
+        if (backupSoln && *backupSoln >= solutions.size()) {
+            return Status(ErrorCodes::BadValue, "backup solution is out of range");
+        }
+
+        // There are no trial period stats to keep, so record a placeholder for each plan.
+        PlanRankingDecision* why = new PlanRankingDecision();
+        for (size_t i = 0; i < solutions.size(); ++i) {
+            why->stats.mutableVector().push_back(new PlanStageStats(CommonStats("RESTORED"),
+                                                                    STAGE_UNKNOWN));
+            why->candidateOrder.push_back(i);
+        }
+        why->scores = scores;
+
+        PlanCacheEntry* entry = new PlanCacheEntry(solutions.vector(), why);
+        entry->backupSoln = backupSoln;
+
+        _addEntry(query, entry);
+        return Status::OK();
+    }
+
+    void PlanCache::_addEntry(const CanonicalQuery& query, PlanCacheEntry* entry) {
+        const LiteParsedQuery& pq = query.getParsed();
+        entry->query = pq.getFilter().getOwned();
+        entry->sort = pq.getSort().getOwned();
+        entry->projection = pq.getProj().getOwned();
+
         boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
         std::auto_ptr<PlanCacheEntry> evictedEntry = _cache.add(query.getPlanCacheKey(), entry);
 
         if (NULL != evictedEntry.get()) {
+            _evictions.fetchAndAdd(1);
             LOG(1) << _ns << ": plan cache maximum size exceeded - "
                    << "removed least recently used entry "
                    << evictedEntry->toString();
         }
-
-        return Status::OK();
     }
 
     Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const {
@@ -363,15 +561,38 @@ namespace mongo {
         PlanCacheEntry* entry;
         Status cacheStatus = _cache.get(key, &entry);
         if (!cacheStatus.isOK()) {
+            _misses.fetchAndAdd(1);
             return cacheStatus;
         }
         invariant(entry);
+        _hits.fetchAndAdd(1);
 
         *crOut = new CachedSolution(key, *entry);
 
         return Status::OK();
     }
 
+    void PlanCache::getMany(const std::vector<const CanonicalQuery*>& queries,
+                            std::vector<CachedSolution*>* crsOut) const {
+        verify(crsOut);
+        crsOut->clear();
+        crsOut->reserve(queries.size());
+
+        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const PlanCacheKey& key = queries[i]->getPlanCacheKey();
+            PlanCacheEntry* entry;
+            if (!_cache.get(key, &entry).isOK()) {
+                _misses.fetchAndAdd(1);
+                crsOut->push_back(NULL);
+                continue;
+            }
+            invariant(entry);
+            _hits.fetchAndAdd(1);
+            crsOut->push_back(new CachedSolution(key, *entry));
+        }
+    }
+
     // TODO: Figure out what the right policy is here for determining if the cached solution is bad.
     // This is a solution but may not be the right one, if there even is a right one...
     static bool hasCachedPlanPerformanceDegraded(PlanCacheEntry* entry,
@@ -460,6 +681,19 @@ namespace mongo {
         return _cache.remove(canonicalQuery.getPlanCacheKey());
     }
 
+    Status PlanCache::setReplanBackoff(const CanonicalQuery& cq, unsigned replanBackoff) {
+        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        PlanCacheEntry* entry;
+        Status cacheStatus = _cache.get(cq.getPlanCacheKey(), &entry);
+        if (!cacheStatus.isOK()) {
+            return cacheStatus;
+        }
+        invariant(entry);
+
+        entry->replanBackoff = replanBackoff;
+        return Status::OK();
+    }
+
     void PlanCache::clear() {
         boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
         _cache.clear();
@@ -518,4 +752,11 @@ namespace mongo {
         clear();
     }
 
+    void PlanCache::appendStats(BSONObjBuilder* builder) const {
+        builder->appendNumber("entries", static_cast<long long>(size()));
+        builder->appendNumber("hits", _hits.load());
+        builder->appendNumber("misses", _misses.load());
+        builder->appendNumber("evictions", _evictions.load());
+    }
+
 }  // namespace mongo
@@ -107,6 +107,22 @@ namespace mongo {
          */
         std::string toString(int indents = 0) const;
 
+        /**
+         * Serializes the tree so that it can be persisted and read back with parse(). Index
+         * entries are recorded by name and key pattern only.
+         */
+        BSONObj toBSON() const;
+
+        /**
+         * Rebuilds a tree serialized by toBSON(), looking up its index entries by name in
+         * 'indices'. Fails if an index no longer exists or has a different key pattern.
+         *
+         * On success, caller owns '*out'.
+         */
+        static Status parse(const BSONObj& obj,
+                            const std::vector<IndexEntry>& indices,
+                            PlanCacheIndexTree** out);
+
         // Children owned here.
         std::vector<PlanCacheIndexTree*> children;
 
@@ -136,6 +152,19 @@ namespace mongo {
         // For debugging.
         std::string toString() const;
 
+        /**
+         * Serializes this data so that it can be persisted and read back with parse().
+         */
+        BSONObj toBSON() const;
+
+        /**
+         * Rebuilds data serialized by toBSON() against the current 'indices'. See
+         * PlanCacheIndexTree::parse(). On success, caller owns '*out'.
+         */
+        static Status parse(const BSONObj& obj,
+                            const std::vector<IndexEntry>& indices,
+                            SolutionCacheData** out);
+
         // Owned here. If 'wholeIXSoln' is false, then 'tree'
         // can be used to tag an isomorphic match expression. If 'wholeIXSoln'
         // is true, then 'tree' is used to store the relevant IndexEntry.
@@ -187,6 +216,13 @@ namespace mongo {
         // Key used to provide feedback on the entry.
         PlanCacheKey key;
 
+        // How many works the winning plan needed in the trial period that cached it, or zero if
+        // the entry was restored without trial stats.
+        size_t decisionWorks;
+
+        // See PlanCacheEntry::replanBackoff.
+        unsigned replanBackoff;
+
         // For debugging.
         std::string toString() const;
 
@@ -264,6 +300,11 @@ namespace mongo {
         // The standard deviation of the scores from stored as feedback.
         boost::optional<double> stddevScore;
 
+        // Multiplies the works a cached run may take before it is replanned. Doubled each time
+        // a run of this query shape is replanned, so shapes whose best plan depends on their
+        // parameters don't replan on every run.
+        unsigned replanBackoff;
+
         // In order to justify eviction, the deviation from the mean must exceed a
         // minimum threshold.
         static const double kMinDeviation;
@@ -310,6 +351,19 @@ namespace mongo {
                    const std::vector<QuerySolution*>& solns,
                    PlanRankingDecision* why);
 
+        /**
+         * Record planner data restored from a persisted copy of a cache entry, best plan first,
+         * along with the scores the plans had when they were ranked and the index of the backup
+         * plan, if any. Used to warm the cache up at startup. Takes ownership of the elements of
+         * 'plannerData'.
+         *
+         * Returns an error Status if 'plannerData' is empty or doesn't match 'scores'.
+         */
+        Status addRestored(const CanonicalQuery& query,
+                           const std::vector<SolutionCacheData*>& plannerData,
+                           const std::vector<double>& scores,
+                           boost::optional<size_t> backupSoln);
+
         /**
          * Look up the cached data access for the provided 'query'.  Used by the query planner
          * to shortcut planning.
@@ -321,6 +375,14 @@ namespace mongo {
          */
         Status get(const CanonicalQuery& query, CachedSolution** crOut) const;
 
+        /**
+         * Looks up the cached data access for each of 'queries' under a single acquisition of
+         * the cache lock. On return, '*crsOut' has one element per query: the CachedSolution
+         * for that query, owned by the caller, or NULL if the query has no entry.
+         */
+        void getMany(const std::vector<const CanonicalQuery*>& queries,
+                     std::vector<CachedSolution*>* crsOut) const;
+
         /**
          * When the CachedPlanStage runs a plan out of the cache, we want to record data about the
          * plan's performance.  The CachedPlanStage calls feedback(...) at the end of query
@@ -345,6 +407,12 @@ namespace mongo {
          */
         Status remove(const CanonicalQuery& canonicalQuery);
 
+        /**
+         * Sets the replan backoff of the entry corresponding to 'cq'. Returns Status::OK() if the
+         * entry was present and an error status otherwise.
+         */
+        Status setReplanBackoff(const CanonicalQuery& cq, unsigned replanBackoff);
+
         /**
          * Remove *all* entries.
          */
@@ -387,6 +455,13 @@ namespace mongo {
          */
         void notifyOfWriteOp();
 
+        /**
+         * Appends the number of entries and the hit, miss and eviction counters of this cache.
+         * The counters count get() lookups and least-recently-used evictions since the cache
+         * was created; clear() does not reset them.
+         */
+        void appendStats(BSONObjBuilder* builder) const;
+
     private:
 
         /**
@@ -396,6 +471,12 @@ namespace mongo {
          */
         void _clear();
 
+        /**
+         * Fills in the query shape of 'entry' and adds it to the cache, evicting the least
+         * recently used entry if the cache is full. Takes ownership of 'entry'.
+         */
+        void _addEntry(const CanonicalQuery& query, PlanCacheEntry* entry);
+
         LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
 
         /**
@@ -409,6 +490,12 @@ namespace mongo {
          */
         AtomicInt32 _writeOperations;
 
+        // Lookup and eviction counters reported by appendStats().  Updated without holding
+        // _cacheMutex.
+        mutable AtomicInt64 _hits;
+        mutable AtomicInt64 _misses;
+        AtomicInt64 _evictions;
+
         /**
          * Full namespace of collection.
          */
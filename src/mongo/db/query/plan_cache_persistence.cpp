@@ -0,0 +1,317 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cache_persistence.h"
+
+#include <algorithm>
+#include <boost/scoped_ptr.hpp>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(planCachePersistenceEnabled, bool, false);
+    MONGO_EXPORT_SERVER_PARAMETER(planCachePersistIntervalSecs, int, 60);
+
+    namespace {
+
+        const char kPlanCacheNamespace[] = "local.plan_cache";
+
+        // How many entries are written per insert.
+        const size_t kInsertBatchSize = 1000;
+
+        BSONObj entryToBSON(const string& ns, const PlanCacheEntry& entry) {
+            BSONObjBuilder bob;
+            bob.append("ns", ns);
+            bob.append("query", entry.query);
+            bob.append("sort", entry.sort);
+            bob.append("projection", entry.projection);
+
+            BSONArrayBuilder plansBob(bob.subarrayStart("plans"));
+            for (size_t i = 0; i < entry.plannerData.size(); ++i) {
+                plansBob.append(entry.plannerData[i]->toBSON());
+            }
+            plansBob.doneFast();
+
+            BSONArrayBuilder scoresBob(bob.subarrayStart("scores"));
+            for (size_t i = 0; i < entry.decision->scores.size(); ++i) {
+                scoresBob.append(entry.decision->scores[i]);
+            }
+            scoresBob.doneFast();
+
+            if (entry.backupSoln) {
+                bob.append("backupSoln", static_cast<int>(*entry.backupSoln));
+            }
+            return bob.obj();
+        }
+
+        /**
+         * Appends a document for every plan cache entry of every collection in 'dbName'.
+         */
+        void collectEntries(OperationContext* txn, const string& dbName, vector<BSONObj>* out) {
+            ScopedTransaction transaction(txn, MODE_IS);
+            Lock::DBLock dbLock(txn->lockState(), dbName, MODE_IS);
+
+            Database* db = dbHolder().get(txn, dbName);
+            if (!db) {
+                return;
+            }
+
+            std::list<string> namespaces;
+            db->getDatabaseCatalogEntry()->getCollectionNamespaces(&namespaces);
+
+            for (std::list<string>::const_iterator it = namespaces.begin();
+                 it != namespaces.end(); ++it) {
+                Lock::CollectionLock collLock(txn->lockState(), *it, MODE_IS);
+                Collection* collection = db->getCollection(*it);
+                if (!collection) {
+                    continue;
+                }
+
+                OwnedPointerVector<PlanCacheEntry> entries;
+                entries.mutableVector() =
+                    collection->infoCache()->getPlanCache()->getAllEntries();
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    out->push_back(entryToBSON(*it, *entries[i]));
+                }
+            }
+        }
+
+        /**
+         * Replaces the contents of local.plan_cache with the current plan cache entries.
+         */
+        void savePlanCaches(OperationContext* txn) {
+            std::set<string> dbNames;
+            dbHolder().getAllShortNames(dbNames);
+
+            vector<BSONObj> docs;
+            for (std::set<string>::const_iterator it = dbNames.begin();
+                 it != dbNames.end(); ++it) {
+                if ("local" != *it) {
+                    collectEntries(txn, *it, &docs);
+                }
+            }
+
+            DBDirectClient client(txn);
+            client.remove(kPlanCacheNamespace, Query());
+            for (size_t i = 0; i < docs.size(); i += kInsertBatchSize) {
+                vector<BSONObj> batch(docs.begin() + i,
+                                      docs.begin() + std::min(docs.size(), i + kInsertBatchSize));
+                client.insert(kPlanCacheNamespace, batch);
+            }
+
+            LOG(1) << "saved " << docs.size() << " plan cache entries to "
+                   << kPlanCacheNamespace;
+        }
+
+        /**
+         * Adds the entry saved in 'doc' to its collection's plan cache, if the collection still
+         * has every index the entry's plans use.
+         */
+        Status restoreEntry(OperationContext* txn, const BSONObj& doc) {
+            const string ns = doc["ns"].str();
+            const NamespaceString nss(ns);
+            if (!nss.isValid()) {
+                return Status(ErrorCodes::InvalidNamespace,
+                              str::stream() << "invalid namespace: " << ns);
+            }
+
+            AutoGetCollectionForRead ctx(txn, nss);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return Status(ErrorCodes::NamespaceNotFound,
+                              str::stream() << "collection " << ns << " no longer exists");
+            }
+
+            CanonicalQuery* rawCq;
+            const WhereCallbackReal whereCallback(txn, nss.db());
+            Status status = CanonicalQuery::canonicalize(ns,
+                                                         doc["query"].Obj(),
+                                                         doc["sort"].Obj(),
+                                                         doc["projection"].Obj(),
+                                                         &rawCq,
+                                                         whereCallback);
+            if (!status.isOK()) {
+                return status;
+            }
+            boost::scoped_ptr<CanonicalQuery> cq(rawCq);
+
+            if (!PlanCache::shouldCacheQuery(*cq)) {
+                return Status(ErrorCodes::BadValue, "query shape is no longer cacheable");
+            }
+
+            vector<IndexEntry> indices;
+            IndexCatalog::IndexIterator ii =
+                collection->getIndexCatalog()->getIndexIterator(txn, false);
+            while (ii.more()) {
+                const IndexDescriptor* desc = ii.next();
+                indices.push_back(IndexEntry(desc->keyPattern(),
+                                             desc->getAccessMethodName(),
+                                             desc->isMultikey(txn),
+                                             desc->isSparse(),
+                                             desc->unique(),
+                                             desc->indexName(),
+                                             desc->infoObj()));
+            }
+
+            OwnedPointerVector<SolutionCacheData> plannerData;
+            BSONObjIterator plansIt(doc["plans"].Obj());
+            while (plansIt.more()) {
+                SolutionCacheData* data;
+                status = SolutionCacheData::parse(plansIt.next().Obj(), indices, &data);
+                if (!status.isOK()) {
+                    return status;
+                }
+                plannerData.push_back(data);
+
+                // Index filters are not saved, so a plan chosen under one can't be trusted.
+                if (data->indexFilterApplied) {
+                    return Status(ErrorCodes::BadValue, "plan was chosen under an index filter");
+                }
+            }
+
+            vector<double> scores;
+            BSONObjIterator scoresIt(doc["scores"].Obj());
+            while (scoresIt.more()) {
+                scores.push_back(scoresIt.next().numberDouble());
+            }
+
+            boost::optional<size_t> backupSoln;
+            BSONElement backupElt = doc["backupSoln"];
+            if (backupElt.isNumber() && backupElt.numberInt() >= 0) {
+                backupSoln.reset(backupElt.numberInt());
+            }
+
+            PlanCache* planCache = collection->infoCache()->getPlanCache();
+            return planCache->addRestored(*cq, plannerData.release(), scores, backupSoln);
+        }
+
+        class PlanCachePersister : public BackgroundJob {
+        public:
+            virtual string name() const { return "PlanCachePersister"; }
+
+            virtual void run() {
+                Client::initThread(name().c_str());
+                cc().getAuthorizationSession()->grantInternalAuthorization();
+
+                while (!inShutdown()) {
+                    sleepsecs(planCachePersistIntervalSecs);
+
+                    if (inShutdown() || lockedForWriting()) {
+                        continue;
+                    }
+
+                    try {
+                        OperationContextImpl txn;
+                        savePlanCaches(&txn);
+                    }
+                    catch (const DBException& ex) {
+                        warning() << "failed to save plan cache entries: " << ex.toString();
+                    }
+                }
+
+                cc().shutdown();
+            }
+        };
+
+    }  // namespace
+
+    void restorePersistedPlanCaches(OperationContext* txn) {
+        if (!planCachePersistenceEnabled) {
+            return;
+        }
+
+        vector<BSONObj> docs;
+        {
+            DBDirectClient client(txn);
+            std::auto_ptr<DBClientCursor> cursor = client.query(kPlanCacheNamespace, Query());
+            while (cursor.get() && cursor->more()) {
+                docs.push_back(cursor->nextSafe().getOwned());
+            }
+        }
+
+        size_t numRestored = 0;
+        for (size_t i = 0; i < docs.size(); ++i) {
+            Status status(ErrorCodes::InternalError, "");
+            try {
+                status = restoreEntry(txn, docs[i]);
+            }
+            catch (const DBException& ex) {
+                status = ex.toStatus();
+            }
+
+            if (status.isOK()) {
+                ++numRestored;
+            }
+            else {
+                LOG(1) << "not restoring plan cache entry " << docs[i] << ": " << status;
+            }
+        }
+
+        log() << "restored " << numRestored << " of " << docs.size()
+              << " saved plan cache entries";
+    }
+
+    void startPlanCachePersisterBackgroundJob() {
+        if (!planCachePersistenceEnabled) {
+            return;
+        }
+
+        PlanCachePersister* persister = new PlanCachePersister();
+        persister->go();
+    }
+
+}  // namespace mongo
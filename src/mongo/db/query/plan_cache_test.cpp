@@ -384,6 +384,129 @@ namespace {
         ASSERT_EQUALS(planCache.size(), 1U);
     }
 
+    TEST(PlanCacheTest, AppendStats) {
+        PlanCache planCache;
+        auto_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+        QuerySolution qs;
+        qs.cacheData.reset(new SolutionCacheData());
+        qs.cacheData->tree.reset(new PlanCacheIndexTree());
+        std::vector<QuerySolution*> solns;
+        solns.push_back(&qs);
+
+        CachedSolution* rawCachedSoln;
+        ASSERT_NOT_OK(planCache.get(*cq, &rawCachedSoln));
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+        ASSERT_OK(planCache.get(*cq, &rawCachedSoln));
+        delete rawCachedSoln;
+
+        // Shapes that differ only in the literal used for an inclusion share an entry.
+        auto_ptr<CanonicalQuery> trueProjection(canonicalize("{a: 5}", "{}", "{b: true}"));
+        auto_ptr<CanonicalQuery> numberProjection(canonicalize("{a: 6}", "{}", "{b: 1}"));
+        ASSERT_OK(planCache.add(*trueProjection, solns, createDecision(1U)));
+        ASSERT_OK(planCache.get(*numberProjection, &rawCachedSoln));
+        delete rawCachedSoln;
+
+        BSONObjBuilder bob;
+        planCache.appendStats(&bob);
+        BSONObj stats = bob.obj();
+        ASSERT_EQUALS(2, stats["entries"].numberLong());
+        ASSERT_EQUALS(2, stats["hits"].numberLong());
+        ASSERT_EQUALS(1, stats["misses"].numberLong());
+        ASSERT_EQUALS(0, stats["evictions"].numberLong());
+
+        // Clearing the cache drops the entries but keeps the counters.
+        planCache.clear();
+        BSONObjBuilder afterClear;
+        planCache.appendStats(&afterClear);
+        stats = afterClear.obj();
+        ASSERT_EQUALS(0, stats["entries"].numberLong());
+        ASSERT_EQUALS(2, stats["hits"].numberLong());
+    }
+
+    TEST(PlanCacheTest, AddRestored) {
+        PlanCache planCache;
+        auto_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+
+        std::vector<SolutionCacheData*> plannerData;
+        std::vector<double> scores;
+        ASSERT_NOT_OK(planCache.addRestored(*cq, plannerData, scores, boost::none));
+
+        plannerData.push_back(new SolutionCacheData());
+        plannerData.back()->solnType = SolutionCacheData::COLLSCAN_SOLN;
+        ASSERT_NOT_OK(planCache.addRestored(*cq, plannerData, scores, boost::none));
+        ASSERT_FALSE(planCache.contains(*cq));
+
+        plannerData.clear();
+        plannerData.push_back(new SolutionCacheData());
+        plannerData.back()->solnType = SolutionCacheData::COLLSCAN_SOLN;
+        scores.push_back(1.5);
+        ASSERT_OK(planCache.addRestored(*cq, plannerData, scores, boost::none));
+        ASSERT_TRUE(planCache.contains(*cq));
+
+        PlanCacheEntry* rawEntry;
+        ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+        auto_ptr<PlanCacheEntry> entry(rawEntry);
+        ASSERT_EQUALS(1U, entry->plannerData.size());
+        ASSERT_EQUALS(1.5, entry->decision->scores[0]);
+        ASSERT_EQUALS(fromjson("{a: 1}"), entry->query);
+
+        // A restored entry has no trial to compare against.
+        CachedSolution* rawCachedSoln;
+        ASSERT_OK(planCache.get(*cq, &rawCachedSoln));
+        auto_ptr<CachedSolution> cachedSoln(rawCachedSoln);
+        ASSERT_EQUALS(0U, cachedSoln->decisionWorks);
+    }
+
+    TEST(PlanCacheTest, ReplanBackoff) {
+        PlanCache planCache;
+        auto_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+        QuerySolution qs;
+        qs.cacheData.reset(new SolutionCacheData());
+        qs.cacheData->tree.reset(new PlanCacheIndexTree());
+        std::vector<QuerySolution*> solns;
+        solns.push_back(&qs);
+
+        ASSERT_NOT_OK(planCache.setReplanBackoff(*cq, 2U));
+
+        PlanRankingDecision* decision = createDecision(1U);
+        decision->stats[0]->common.works = 50;
+        ASSERT_OK(planCache.add(*cq, solns, decision));
+
+        CachedSolution* rawCachedSoln;
+        ASSERT_OK(planCache.get(*cq, &rawCachedSoln));
+        auto_ptr<CachedSolution> cachedSoln(rawCachedSoln);
+        ASSERT_EQUALS(50U, cachedSoln->decisionWorks);
+        ASSERT_EQUALS(1U, cachedSoln->replanBackoff);
+
+        ASSERT_OK(planCache.setReplanBackoff(*cq, 4U));
+        ASSERT_OK(planCache.get(*cq, &rawCachedSoln));
+        cachedSoln.reset(rawCachedSoln);
+        ASSERT_EQUALS(4U, cachedSoln->replanBackoff);
+    }
+
+    TEST(PlanCacheTest, ParseCacheDataRejectsMissingIndex) {
+        std::vector<IndexEntry> indices;
+        indices.push_back(IndexEntry(BSON("a" << 1), false, false, false, "a_1", BSONObj()));
+
+        SolutionCacheData data;
+        data.tree.reset(new PlanCacheIndexTree());
+        data.tree->setIndexEntry(indices[0]);
+        BSONObj serialized = data.toBSON();
+
+        SolutionCacheData* rawParsed;
+        ASSERT_OK(SolutionCacheData::parse(serialized, indices, &rawParsed));
+        boost::scoped_ptr<SolutionCacheData> parsed(rawParsed);
+        ASSERT_EQUALS("a_1", parsed->tree->entry->name);
+
+        // An index with the same name over different fields is not the same index.
+        std::vector<IndexEntry> rebuilt;
+        rebuilt.push_back(IndexEntry(BSON("b" << 1), false, false, false, "a_1", BSONObj()));
+        ASSERT_NOT_OK(SolutionCacheData::parse(serialized, rebuilt, &rawParsed));
+        ASSERT_NOT_OK(SolutionCacheData::parse(serialized, std::vector<IndexEntry>(),
+                                               &rawParsed));
+        ASSERT_NOT_OK(SolutionCacheData::parse(BSON("type" << "bogus"), indices, &rawParsed));
+    }
+
     TEST(PlanCacheTest, NotifyOfWriteOp) {
         PlanCache planCache;
         auto_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
@@ -723,6 +846,17 @@ namespace {
             QuerySolution* planSoln = planQueryFromCache(query, sort, proj, *bestSoln);
             assertSolutionMatches(planSoln, solnJson);
             delete planSoln;
+
+            // The cache data must also survive being persisted and read back.
+            SolutionCacheData* rawParsed;
+            ASSERT_OK(SolutionCacheData::parse(bestSoln->cacheData->toBSON(),
+                                               params.indices,
+                                               &rawParsed));
+            QuerySolution parsedSoln;
+            parsedSoln.cacheData.reset(rawParsed);
+            planSoln = planQueryFromCache(query, sort, proj, parsedSoln);
+            assertSolutionMatches(planSoln, solnJson);
+            delete planSoln;
         }
 
         /**
@@ -0,0 +1,248 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/query/qlog.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Keeps products of interval counts from overflowing; no scan gets anywhere near this.
+        const long long kMaxPointCount = 1LL << 40;
+
+        /**
+         * Returns true if 'oil' is the single interval from MinKey to MaxKey, in either direction.
+         */
+        bool isAllValues(const OrderedIntervalList& oil) {
+            if (1 != oil.intervals.size()) {
+                return false;
+            }
+            const BSONType startType = oil.intervals[0].start.type();
+            const BSONType endType = oil.intervals[0].end.type();
+            return (MinKey == startType && MaxKey == endType)
+                || (MaxKey == startType && MinKey == endType);
+        }
+
+    }  // namespace
+
+    const long long PlanCostEstimator::kUnknownCost;
+
+    PlanCostEstimator::PlanCostEstimator(OperationContext* txn, const Collection* collection)
+        : _txn(txn),
+          _collection(collection) { }
+
+    long long PlanCostEstimator::estimate(QuerySolution* solution) {
+        if (NULL == _collection || NULL == solution->root.get()) {
+            return kUnknownCost;
+        }
+        return estimateNode(solution->root.get());
+    }
+
+    long long PlanCostEstimator::estimateNode(QuerySolutionNode* node) {
+        if (STAGE_COLLSCAN == node->getType()) {
+            return static_cast<long long>(_collection->numRecords(_txn));
+        }
+
+        if (STAGE_IXSCAN == node->getType()) {
+            IndexScanNode* ixn = static_cast<IndexScanNode*>(node);
+            const IndexDescriptor* desc =
+                _collection->getIndexCatalog()->findIndexByKeyPattern(_txn, ixn->indexKeyPattern);
+            if (NULL == desc) {
+                return kUnknownCost;
+            }
+
+            IndexKeyStats stats =
+                _collection->infoCache()->getIndexStatsCache()->get(_txn, _collection, desc);
+            ixn->estimatedKeys = estimateIndexScan(ixn->bounds, desc->unique(), stats);
+            return ixn->estimatedKeys;
+        }
+
+        if (node->children.empty()) {
+            return kUnknownCost;
+        }
+
+        // Every child is run to completion in the worst case, so the costs add up. Keep walking
+        // after an unknown child so that all index scans get their estimate recorded.
+        long long total = 0;
+        for (size_t i = 0; i < node->children.size(); ++i) {
+            long long childCost = estimateNode(node->children[i]);
+            if (kUnknownCost == childCost || kUnknownCost == total) {
+                total = kUnknownCost;
+            }
+            else {
+                total += childCost;
+            }
+        }
+        return total;
+    }
+
+    size_t PlanCostEstimator::pruneSolutions(std::vector<QuerySolution*>* solutions) {
+        const double ratio = internalQueryPlanCostPruneRatio;
+        if (ratio <= 0 || solutions->size() < 2) {
+            return 0;
+        }
+
+        std::vector<long long> costs;
+        std::vector<bool> blocking;
+        for (size_t i = 0; i < solutions->size(); ++i) {
+            costs.push_back(estimate((*solutions)[i]));
+            blocking.push_back((*solutions)[i]->hasBlockingStage);
+        }
+
+        std::vector<bool> pruned = choosePruned(costs, blocking, ratio,
+                                                internalQueryPlanEvaluationWorks);
+
+        std::vector<QuerySolution*> kept;
+        for (size_t i = 0; i < solutions->size(); ++i) {
+            if (pruned[i]) {
+                QLOG() << "Pruning candidate with estimated cost " << costs[i] << ":\n"
+                       << (*solutions)[i]->toString();
+                delete (*solutions)[i];
+            }
+            else {
+                kept.push_back((*solutions)[i]);
+            }
+        }
+
+        size_t numPruned = solutions->size() - kept.size();
+        solutions->swap(kept);
+        return numPruned;
+    }
+
+    // static
+    long long PlanCostEstimator::estimateIndexScan(const IndexBounds& bounds,
+                                                   bool unique,
+                                                   const IndexKeyStats& stats) {
+        if (bounds.isSimpleRange || 0 == stats.keysSampled) {
+            return kUnknownCost;
+        }
+
+        // Count the point lookups the leading point-only fields expand to. Fields after the
+        // first range can only filter keys out, so they don't add to the estimate.
+        size_t pointFields = 0;
+        long long numPoints = 1;
+        for (size_t i = 0; i < bounds.fields.size(); ++i) {
+            const std::vector<Interval>& intervals = bounds.fields[i].intervals;
+            if (intervals.empty()) {
+                return 0;
+            }
+
+            // A skip scan visits each value of the leading field like a point.
+            if (0 == i && stats.leadingValues >= 0 && isAllValues(bounds.fields[0])) {
+                ++pointFields;
+                numPoints = std::max(1LL, stats.leadingValues);
+                continue;
+            }
+
+            bool allPoints = true;
+            for (size_t j = 0; j < intervals.size(); ++j) {
+                if (!intervals[j].isPoint()) {
+                    allPoints = false;
+                    break;
+                }
+            }
+            if (!allPoints) {
+                break;
+            }
+
+            ++pointFields;
+            numPoints = std::min(kMaxPointCount,
+                                 numPoints * static_cast<long long>(intervals.size()));
+        }
+
+        if (0 == pointFields) {
+            return kUnknownCost;
+        }
+
+        if (unique && pointFields == bounds.fields.size()) {
+            return numPoints;
+        }
+
+        return static_cast<long long>(std::ceil(numPoints * stats.keysPerValue(pointFields)));
+    }
+
+    // static
+    std::vector<bool> PlanCostEstimator::choosePruned(const std::vector<long long>& costs,
+                                                      const std::vector<bool>& blocking,
+                                                      double ratio,
+                                                      long long minCost) {
+        invariant(costs.size() == blocking.size());
+        std::vector<bool> pruned(costs.size(), false);
+
+        long long cheapest = kUnknownCost;
+        for (size_t i = 0; i < costs.size(); ++i) {
+            if (kUnknownCost != costs[i] && (kUnknownCost == cheapest || costs[i] < cheapest)) {
+                cheapest = costs[i];
+            }
+        }
+        if (kUnknownCost == cheapest) {
+            return pruned;
+        }
+
+        const double limit = ratio * std::max(cheapest, 1LL);
+        bool keptNonBlocking = false;
+        for (size_t i = 0; i < costs.size(); ++i) {
+            if (kUnknownCost != costs[i] && costs[i] > limit && costs[i] > minCost) {
+                pruned[i] = true;
+            }
+            else if (!blocking[i]) {
+                keptNonBlocking = true;
+            }
+        }
+
+        if (!keptNonBlocking) {
+            // Everything left sorts in memory; keep the cheapest plan that doesn't.
+            size_t backup = costs.size();
+            for (size_t i = 0; i < costs.size(); ++i) {
+                if (!blocking[i] && (backup == costs.size() || costs[i] < costs[backup])) {
+                    backup = i;
+                }
+            }
+            if (backup < costs.size()) {
+                pruned[backup] = false;
+            }
+        }
+
+        return pruned;
+    }
+
+}  // namespace mongo
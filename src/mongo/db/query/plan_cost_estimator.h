@@ -0,0 +1,101 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/query/index_stats.h"
+
+namespace mongo {
+
+    class Collection;
+    class OperationContext;
+    struct QuerySolution;
+    struct QuerySolutionNode;
+
+    /**
+     * Estimates how many index keys and documents a candidate plan will examine, from sampled
+     * index statistics and the collection size. The estimates let the planner drop candidates
+     * that are certain to lose the trial period before any of them is run, and are reported in
+     * explain next to each index scan.
+     *
+     * Only scans whose bounds start with point intervals are costed; a plan with any other
+     * leaf has no estimate and is never pruned.
+     */
+    class PlanCostEstimator {
+    public:
+        static const long long kUnknownCost = -1;
+
+        PlanCostEstimator(OperationContext* txn, const Collection* collection);
+
+        /**
+         * Returns how many keys and documents 'solution' is expected to examine, or
+         * kUnknownCost. Records the estimate of every costed index scan in the solution.
+         */
+        long long estimate(QuerySolution* solution);
+
+        /**
+         * Deletes and removes from 'solutions' the candidates whose estimate is more than
+         * internalQueryPlanCostPruneRatio times the cheapest estimate. Returns the number of
+         * candidates removed.
+         */
+        size_t pruneSolutions(std::vector<QuerySolution*>* solutions);
+
+        //
+        // Exposed for testing.
+        //
+
+        /**
+         * Estimates the keys examined by a scan over 'bounds' of an index with 'stats'.
+         */
+        static long long estimateIndexScan(const IndexBounds& bounds,
+                                           bool unique,
+                                           const IndexKeyStats& stats);
+
+        /**
+         * Given the estimate of each candidate and whether it has a blocking stage, returns which
+         * candidates to prune. A candidate is pruned only if its estimate is known, exceeds
+         * 'ratio' times the cheapest one and exceeds 'minCost'. The cheapest candidate without a
+         * blocking stage is kept so that a backup plan remains.
+         */
+        static std::vector<bool> choosePruned(const std::vector<long long>& costs,
+                                              const std::vector<bool>& blocking,
+                                              double ratio,
+                                              long long minCost);
+
+    private:
+        long long estimateNode(QuerySolutionNode* node);
+
+        OperationContext* _txn;
+
+        // Not owned.
+        const Collection* _collection;
+    };
+
+}  // namespace mongo
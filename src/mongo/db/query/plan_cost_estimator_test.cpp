@@ -0,0 +1,195 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/plan_cost_estimator.cpp
+ */
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    using std::vector;
+
+    const long long kUnknown = PlanCostEstimator::kUnknownCost;
+
+    /**
+     * Statistics over the keys {a: i / 10, b: i} for i in [0, 100).
+     */
+    IndexKeyStats tenKeysPerValue() {
+        IndexKeyStatsBuilder builder;
+        for (int i = 0; i < 100; ++i) {
+            builder.addKey(BSON("" << (i / 10) << "" << i));
+        }
+        return builder.done(true);
+    }
+
+    OrderedIntervalList pointList(const char* name, int numPoints) {
+        OrderedIntervalList oil(name);
+        for (int i = 0; i < numPoints; ++i) {
+            oil.intervals.push_back(Interval(BSON("" << i << "" << i), true, true));
+        }
+        return oil;
+    }
+
+    OrderedIntervalList rangeList(const char* name) {
+        OrderedIntervalList oil(name);
+        oil.intervals.push_back(Interval(BSON("" << 0 << "" << 50), true, false));
+        return oil;
+    }
+
+    TEST(IndexKeyStatsTest, CountsDistinctPrefixes) {
+        IndexKeyStats stats = tenKeysPerValue();
+        ASSERT_EQUALS(100, stats.keysSampled);
+        ASSERT_EQUALS(2U, stats.distinctPrefixes.size());
+        ASSERT_EQUALS(10, stats.distinctPrefixes[0]);
+        ASSERT_EQUALS(100, stats.distinctPrefixes[1]);
+        ASSERT(stats.complete);
+        ASSERT_EQUALS(10.0, stats.keysPerValue(1));
+        ASSERT_EQUALS(1.0, stats.keysPerValue(2));
+        ASSERT_EQUALS(1.0, stats.keysPerValue(3));
+    }
+
+    TEST(IndexKeyStatsTest, EmptySample) {
+        IndexKeyStatsBuilder builder;
+        IndexKeyStats stats = builder.done(true);
+        ASSERT_EQUALS(0, stats.keysSampled);
+        ASSERT_EQUALS(1.0, stats.keysPerValue(1));
+    }
+
+    TEST(PlanCostEstimatorTest, PointBoundsUseKeysPerValue) {
+        IndexBounds bounds;
+        bounds.fields.push_back(pointList("a", 3));
+        bounds.fields.push_back(rangeList("b"));
+        ASSERT_EQUALS(30, PlanCostEstimator::estimateIndexScan(bounds, false,
+                                                               tenKeysPerValue()));
+
+        bounds.fields[1] = pointList("b", 2);
+        ASSERT_EQUALS(6, PlanCostEstimator::estimateIndexScan(bounds, false,
+                                                              tenKeysPerValue()));
+    }
+
+    TEST(PlanCostEstimatorTest, UniqueIndexPointsExamineOneKeyEach) {
+        IndexKeyStatsBuilder builder;
+        builder.addKey(BSON("" << 1 << "" << 1));
+        builder.addKey(BSON("" << 1 << "" << 1));
+        IndexBounds bounds;
+        bounds.fields.push_back(pointList("a", 4));
+        bounds.fields.push_back(pointList("b", 5));
+        ASSERT_EQUALS(20, PlanCostEstimator::estimateIndexScan(bounds, true,
+                                                               builder.done(true)));
+    }
+
+    TEST(PlanCostEstimatorTest, LeadingRangeIsUnknown) {
+        IndexBounds bounds;
+        bounds.fields.push_back(rangeList("a"));
+        bounds.fields.push_back(pointList("b", 1));
+        ASSERT_EQUALS(kUnknown, PlanCostEstimator::estimateIndexScan(bounds, false,
+                                                                     tenKeysPerValue()));
+
+        IndexBounds simple;
+        simple.isSimpleRange = true;
+        ASSERT_EQUALS(kUnknown, PlanCostEstimator::estimateIndexScan(simple, false,
+                                                                     tenKeysPerValue()));
+    }
+
+    TEST(PlanCostEstimatorTest, SkipScanCountsLeadingValuesAsPoints) {
+        IndexBounds bounds;
+        OrderedIntervalList all("a");
+        all.intervals.push_back(Interval(BSON("" << MINKEY << "" << MAXKEY), true, true));
+        bounds.fields.push_back(all);
+        bounds.fields.push_back(pointList("b", 2));
+
+        // Without a count of the leading values it is just a leading range.
+        IndexKeyStats stats = tenKeysPerValue();
+        ASSERT_EQUALS(kUnknown, PlanCostEstimator::estimateIndexScan(bounds, false, stats));
+
+        stats.leadingValues = 10;
+        ASSERT_EQUALS(20, PlanCostEstimator::estimateIndexScan(bounds, false, stats));
+    }
+
+    TEST(PlanCostEstimatorTest, EmptyBoundsCostNothing) {
+        IndexBounds bounds;
+        bounds.fields.push_back(OrderedIntervalList("a"));
+        ASSERT_EQUALS(0, PlanCostEstimator::estimateIndexScan(bounds, false,
+                                                              tenKeysPerValue()));
+    }
+
+    TEST(PlanCostEstimatorTest, NoStatisticsIsUnknown) {
+        IndexBounds bounds;
+        bounds.fields.push_back(pointList("a", 1));
+        ASSERT_EQUALS(kUnknown, PlanCostEstimator::estimateIndexScan(bounds, false,
+                                                                     IndexKeyStats()));
+    }
+
+    TEST(PlanCostEstimatorTest, PrunesOnlyExpensiveKnownCandidates) {
+        vector<long long> costs;
+        costs.push_back(5);
+        costs.push_back(100000);
+        costs.push_back(kUnknown);
+        costs.push_back(40);
+        vector<bool> blocking(costs.size(), false);
+
+        vector<bool> pruned = PlanCostEstimator::choosePruned(costs, blocking, 10, 1000);
+        ASSERT_FALSE(pruned[0]);
+        ASSERT_TRUE(pruned[1]);
+        ASSERT_FALSE(pruned[2]);
+        // Over the ratio but cheap enough that the trial period won't suffer.
+        ASSERT_FALSE(pruned[3]);
+    }
+
+    TEST(PlanCostEstimatorTest, NothingPrunedWithoutEstimates) {
+        vector<long long> costs(3, kUnknown);
+        vector<bool> blocking(costs.size(), false);
+        vector<bool> pruned = PlanCostEstimator::choosePruned(costs, blocking, 10, 0);
+        for (size_t i = 0; i < pruned.size(); ++i) {
+            ASSERT_FALSE(pruned[i]);
+        }
+    }
+
+    TEST(PlanCostEstimatorTest, KeepsNonBlockingBackup) {
+        vector<long long> costs;
+        costs.push_back(10);
+        costs.push_back(50000);
+        costs.push_back(90000);
+        vector<bool> blocking;
+        blocking.push_back(true);
+        blocking.push_back(false);
+        blocking.push_back(false);
+
+        vector<bool> pruned = PlanCostEstimator::choosePruned(costs, blocking, 10, 1000);
+        ASSERT_FALSE(pruned[0]);
+        ASSERT_FALSE(pruned[1]);
+        ASSERT_TRUE(pruned[2]);
+    }
+
+}  // namespace
@@ -31,6 +31,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/exec/cached_plan.h"
 #include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/pipeline_proxy.h"
 #include "mongo/db/exec/plan_stage.h"
@@ -181,6 +182,13 @@ namespace mongo {
             return subplan->pickBestPlan(_yieldPolicy.get());
         }
 
+        // A plan from the cache gets a bounded trial run, and is replanned if it exceeds it.
+        foundStage = getStageByType(_root.get(), STAGE_CACHED_PLAN);
+        if (foundStage) {
+            CachedPlanStage* cachedPlan = static_cast<CachedPlanStage*>(foundStage);
+            return cachedPlan->pickBestPlan(_yieldPolicy.get());
+        }
+
         // If we didn't have to do subplanning, we might still have to do regular
         // multi plan selection.
         foundStage = getStageByType(_root.get(), STAGE_MULTI_PLAN);
@@ -69,7 +69,7 @@ namespace mongo {
      */
     struct CandidatePlan {
         CandidatePlan(QuerySolution* s, PlanStage* r, WorkingSet* w)
-            : solution(s), root(r), ws(w), failed(false) { }
+            : solution(s), root(r), ws(w), failed(false), pruned(false) { }
 
         QuerySolution* solution;
         PlanStage* root;
@@ -79,6 +79,10 @@ namespace mongo {
         std::list<WorkingSetID> results;
 
         bool failed;
+
+        // Set when the plan fell too far behind the leader to win and stopped being worked. It
+        // is still ranked on what it did before.
+        bool pruned;
     };
 
     /**
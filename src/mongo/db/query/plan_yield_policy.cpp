@@ -38,15 +38,46 @@ namespace mongo {
 
     PlanYieldPolicy::PlanYieldPolicy(PlanExecutor* exec)
         : _elapsedTracker(internalQueryExecYieldIterations, internalQueryExecYieldPeriodMS),
-          _planYielding(exec) { }
+          _planYielding(exec),
+          _checksSinceYield(0),
+          _uncontendedSkips(0) { }
 
     bool PlanYieldPolicy::shouldYield() {
-        invariant(!_planYielding->getOpCtx()->lockState()->inAWriteUnitOfWork());
-        return _elapsedTracker.intervalHasElapsed();
+        OperationContext* opCtx = _planYielding->getOpCtx();
+        invariant(!opCtx->lockState()->inAWriteUnitOfWork());
+
+        ++_checksSinceYield;
+
+        // Somebody waiting for one of our locks gets them back promptly, without waiting for the
+        // regular schedule.
+        const int contendedIterations = internalQueryExecYieldContendedIterations;
+        if (contendedIterations > 0 && _checksSinceYield >= contendedIterations &&
+                opCtx->lockState()->hasConflictingWaiters()) {
+            return true;
+        }
+
+        if (!_elapsedTracker.intervalHasElapsed()) {
+            return false;
+        }
+
+        // Giving up the locks helps nobody if nobody is waiting for them, but do not go without
+        // yielding for too long, because yielding also releases storage engine resources.
+        if (_uncontendedSkips < internalQueryExecYieldMaxUncontendedSkips &&
+                !opCtx->lockState()->hasConflictingWaiters()) {
+            _uncontendedSkips++;
+
+            // The interrupt check normally happens as part of the yield
+            opCtx->checkForInterrupt();
+            return false;
+        }
+
+        return true;
     }
 
     void PlanYieldPolicy::resetTimer() {
         _elapsedTracker.resetLastTime();
+        _checksSinceYield = 0;
+        _uncontendedSkips = 0;
     }
 
     bool PlanYieldPolicy::yield(RecordFetcher* fetcher) {
@@ -43,7 +43,8 @@ namespace mongo {
         /**
          * Used by YIELD_AUTO plan executors in order to check whether it is time to yield.
          * PlanExecutors give up their locks periodically in order to be fair to other
-         * threads.
+         * threads. Yields are skipped while no other thread waits for a lock the executor
+         * holds, and brought forward when one does.
          */
         bool shouldYield();
 
@@ -74,6 +75,12 @@ namespace mongo {
         // The plan executor which this yield policy is responsible for yielding. Must
         // not outlive the plan executor.
         PlanExecutor* _planYielding;
+
+        // Number of calls to shouldYield() since the last yield.
+        int _checksSinceYield;
+
+        // Number of times in a row the yield was skipped because nobody was waiting for our locks.
+        int _uncontendedSkips;
     };
 
 } // namespace mongo
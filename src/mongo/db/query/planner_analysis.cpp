@@ -207,6 +207,7 @@ namespace mongo {
                 child->maxScan = isn->maxScan;
                 child->addKeyMetadata = isn->addKeyMetadata;
                 child->indexIsMultiKey = isn->indexIsMultiKey;
+                child->indexMultikeyPaths = isn->indexMultikeyPaths;
 
                 // Copy the filter, if there is one.
                 if (isn->filter.get()) {
@@ -475,6 +476,14 @@ namespace mongo {
             sort->limit = size_t(query.getParsed().getNumToReturn()) +
                           size_t(query.getParsed().getSkip());
 
+            // A text stage whose results we only sort by text score can stop reading the index
+            // once it has the best 'limit' of them.
+            QuerySolutionNode* sortChild = sort->children[0];
+            if (STAGE_TEXT == sortChild->getType() && 1 == sortObj.nFields()
+                && LiteParsedQuery::isTextScoreMeta(sortObj.firstElement())) {
+                static_cast<TextNode*>(sortChild)->limit = sort->limit;
+            }
+
             // This is a SORT with a limit. The wire protocol has a single quantity
             // called "numToReturn" which could mean either limit or batchSize.
             // We have no idea what the client intended. One way to handle the ambiguity
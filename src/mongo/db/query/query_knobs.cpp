@@ -38,6 +38,14 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationTrialPruneRatio, double, 10.0);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanCostPruneRatio, double, 10.0);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryIndexStatsSampleKeys, int, 1000);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQuerySkipScanMaxLeadingValues, int, 100);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
@@ -46,6 +54,12 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheWriteOpsBetweenFlush, int, 1000);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheReplanRatio, double, 10.0);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryShapeStatsSize, int, 1000);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryTemplateCacheSize, int, 5000);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxOrSolutions, int, 10);
@@ -62,10 +76,24 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerInListCollscanMinValues, int, 5000);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecAllowBlockingSortSpill, bool, false);
+
     // Yield every 128 cycles or 10ms.
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldMaxUncontendedSkips, int, 10);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldContendedIterations, int, 16);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecFetchReadAheadDocs, int, 0);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecParallelScanWorkers, int, 0);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecParallelScanMinRecords, int, 100 * 1000);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecReplyShareMinBytes, int, 8 * 1024);
+
 }  // namespace mongo
@@ -45,6 +45,10 @@ namespace mongo {
     // Stop working plans once a plan returns this many results.
     extern int internalQueryPlanEvaluationMaxResults;
 
+    // Once the leading candidate is halfway to the result limit, stop working candidates that
+    // have returned fewer than its results divided by this ratio. Zero turns trial pruning off.
+    extern double internalQueryPlanEvaluationTrialPruneRatio;
+
     // Do we give a big ranking bonus to intersection plans?
     extern bool internalQueryForceIntersectionPlans;
 
@@ -54,6 +58,17 @@ namespace mongo {
     // Do we use hash-based intersection for rooted $and queries?
     extern bool internalQueryPlannerEnableHashIntersection;
 
+    // Candidates whose estimated keys examined exceed the cheapest estimate by this factor are
+    // dropped before ranking. Zero turns cost-based pruning off.
+    extern double internalQueryPlanCostPruneRatio;
+
+    // How many leading keys of an index we read to estimate how many keys share a value.
+    extern int internalQueryIndexStatsSampleKeys;
+
+    // A compound index whose leading field has at most this many distinct values may be scanned
+    // for predicates over its other fields alone. Zero turns skip scans off.
+    extern int internalQuerySkipScanMaxLeadingValues;
+
     //
     // plan cache
     //
@@ -72,6 +87,21 @@ namespace mongo {
     // How many write ops should we allow in a collection before tossing all cache entries?
     extern int internalQueryCacheWriteOpsBetweenFlush;
 
+    // A cached plan that needs this many times the works it took to win its trial period, before
+    // returning a first batch, is evicted and the query replanned. Zero turns replanning off.
+    extern double internalQueryCacheReplanRatio;
+
+    //
+    // query shape statistics
+    //
+
+    // How many query shapes per collection do we keep execution statistics for?
+    extern int internalQueryShapeStatsSize;
+
+    // How many query shapes do we keep parsed and canonicalized templates for? Zero disables
+    // the template cache.
+    extern int internalQueryTemplateCacheSize;
+
     //
     // Planning and enumeration.
     //
@@ -92,16 +122,48 @@ namespace mongo {
     // during explodeForSort?
     extern int internalQueryMaxScansToExplode;
 
+    // An $in with at least this many values also gets a collection scan plan, which checks each
+    // document against the $in's hash set instead of seeking the index once per value. Plan
+    // ranking then picks between the two. Zero disables.
+    extern int internalQueryPlannerInListCollscanMinValues;
+
     //
     // Query execution.
     //
 
     extern int internalQueryExecMaxBlockingSortBytes;
 
+    // Whether a blocking sort without a limit that outgrows internalQueryExecMaxBlockingSortBytes
+    // spills to disk through the external sorter, rather than failing.
+    extern bool internalQueryExecAllowBlockingSortSpill;
+
     // Yield after this many "should yield?" checks.
     extern int internalQueryExecYieldIterations;
 
     // Yield if it's been at least this many milliseconds since we last yielded.
     extern int internalQueryExecYieldPeriodMS;
 
+    // When it is time to yield but no other operation waits for a lock we hold, skip the yield
+    // up to this many times in a row. Zero yields every time.
+    extern int internalQueryExecYieldMaxUncontendedSkips;
+
+    // While another operation waits for a lock we hold, yield after this many "should yield?"
+    // checks instead of waiting for the iteration count or period. Zero disables this.
+    extern int internalQueryExecYieldContendedIterations;
+
+    // How many RecordIds a FETCH stage reads ahead of the document it returns, asking the
+    // storage engine to page them in. Zero disables read ahead.
+    extern int internalQueryExecFetchReadAheadDocs;
+
+    // How many threads a full collection scan for count, or for an aggregation starting with
+    // $group, is split across. Values below 2 disable parallel scans.
+    extern int internalQueryExecParallelScanWorkers;
+
+    // Collections with fewer records than this are always scanned on a single thread.
+    extern int internalQueryExecParallelScanMinRecords;
+
+    // Query and getMore replies send documents of at least this many bytes straight from the
+    // storage engine's buffer instead of copying them into the reply. Zero always copies.
+    extern int internalQueryExecReplyShareMinBytes;
+
 }  // namespace mongo
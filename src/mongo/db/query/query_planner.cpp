@@ -32,18 +32,23 @@
 
 #include "mongo/db/query/query_planner.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/client/dbclientinterface.h"   // For QueryOption_foobar
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/matcher/expression_text.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/index_tag.h"
+#include "mongo/db/query/indexability.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/plan_enumerator.h"
 #include "mongo/db/query/qlog.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/util/log.h"
@@ -217,6 +222,21 @@ namespace mongo {
         }
     }
 
+    /**
+     * Returns the number of values in the longest $in of 'node' or its children.
+     */
+    static size_t largestInList(const MatchExpression* node) {
+        size_t largest = 0;
+        if (MatchExpression::MATCH_IN == node->matchType()) {
+            const InMatchExpression* in = static_cast<const InMatchExpression*>(node);
+            largest = in->getData().size();
+        }
+        for (size_t i = 0; i < node->numChildren(); ++i) {
+            largest = std::max(largest, largestInList(node->getChild(i)));
+        }
+        return largest;
+    }
+
     QuerySolution* buildCollscanSoln(const CanonicalQuery& query,
                                      bool tailable,
                                      const QueryPlannerParams& params) {
@@ -234,6 +254,86 @@ namespace mongo {
         return QueryPlannerAnalysis::analyzeDataAccess(query, params, solnRoot);
     }
 
+    /**
+     * Returns a solution that scans params.indices[indexNum] with every value of its leading
+     * field and the bounds of the query's predicates over its later fields, which must be the
+     * root or children of a root AND. The scan seeks from one leading value to the next. Returns
+     * NULL if no such predicate is usable or the leading field has one, since the enumerator
+     * already plans those.
+     */
+    static QuerySolution* buildSkipScanSoln(const CanonicalQuery& query,
+                                            const QueryPlannerParams& params,
+                                            size_t indexNum) {
+        const IndexEntry& index = params.indices[indexNum];
+        const StringData leadingField = index.keyPattern.firstElementFieldName();
+
+        auto_ptr<MatchExpression> taggedTree(query.root()->shallowClone());
+        vector<MatchExpression*> preds;
+        if (MatchExpression::AND == taggedTree->matchType()) {
+            for (size_t i = 0; i < taggedTree->numChildren(); ++i) {
+                preds.push_back(taggedTree->getChild(i));
+            }
+        }
+        else {
+            preds.push_back(taggedTree.get());
+        }
+
+        bool tagged = false;
+        for (size_t i = 0; i < preds.size(); ++i) {
+            MatchExpression* pred = preds[i];
+            if (!Indexability::isBoundsGenerating(pred)
+                    || MatchExpression::NOT == pred->matchType()) {
+                continue;
+            }
+            if (pred->path() == leadingField) {
+                return NULL;
+            }
+
+            BSONObjIterator it(index.keyPattern);
+            it.next();
+            for (size_t pos = 1; it.more(); ++pos) {
+                BSONElement elt = it.next();
+                if (pred->path() == elt.fieldName()) {
+                    if (QueryPlannerIXSelect::compatible(elt, index, pred)) {
+                        pred->setTag(new IndexTag(indexNum, pos));
+                        tagged = true;
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (!tagged) {
+            return NULL;
+        }
+
+        boost::scoped_ptr<MatchExpression> sortedTree(taggedTree->shallowClone());
+        CanonicalQuery::sortTree(sortedTree.get());
+        PlanCacheIndexTree* cacheData;
+        Status indexTreeStatus =
+            QueryPlanner::cacheDataFromTaggedTree(sortedTree.get(), params.indices, &cacheData);
+        auto_ptr<PlanCacheIndexTree> autoData(cacheData);
+
+        // The planner requires a defined sort order.
+        sortUsingTags(taggedTree.get());
+
+        // Takes ownership of the tagged tree.
+        QuerySolutionNode* solnRoot =
+            QueryPlannerAccess::buildIndexedDataAccess(query, taggedTree.release(), false,
+                                                       params.indices, params);
+        if (NULL == solnRoot) {
+            return NULL;
+        }
+
+        QuerySolution* soln = QueryPlannerAnalysis::analyzeDataAccess(query, params, solnRoot);
+        if (NULL != soln && indexTreeStatus.isOK()) {
+            SolutionCacheData* scd = new SolutionCacheData();
+            scd->tree.reset(autoData.release());
+            soln->cacheData.reset(scd);
+        }
+        return soln;
+    }
+
     bool providesSort(const CanonicalQuery& query, const BSONObj& kp) {
         return query.getParsed().getSort().isPrefixOf(kp);
     }
@@ -841,6 +941,28 @@ namespace mongo {
             return Status::OK();
         }
 
+        // A compound index whose leading field has few values can answer predicates over its
+        // other fields by skipping from one leading value to the next. The number of matching
+        // documents isn't known here, so a collection scan competes with it.
+        bool skipScanPlanned = false;
+        if (!QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR)
+            && !QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT)) {
+            for (size_t i = 0; i < params.indices.size(); ++i) {
+                if (!params.indices[i].allowSkipScan
+                    || INDEX_BTREE != params.indices[i].type
+                    || params.indices[i].multikey) {
+                    continue;
+                }
+
+                QuerySolution* soln = buildSkipScanSoln(query, params, i);
+                if (NULL != soln) {
+                    QLOG() << "Planner: outputting skip scan soln:" << endl << soln->toString();
+                    out->push_back(soln);
+                    skipScanPlanned = true;
+                }
+            }
+        }
+
         // If a sort order is requested, there may be an index that provides it, even if that
         // index is not over any predicates in the query.
         //
@@ -936,7 +1058,17 @@ namespace mongo {
         // No indexed plans?  We must provide a collscan if possible or else we can't run the query.
         bool collscanNeeded = (0 == out->size() && canTableScan);
 
-        if (possibleToCollscan && (collscanRequested || collscanNeeded)) {
+        // The index plans seek once per value of a huge $in. A scan probing the $in's hash set
+        // can be cheaper, e.g. when the values cover much of the collection, so let plan ranking
+        // compare them.
+        bool collscanCompetes = canTableScan
+                             && internalQueryPlannerInListCollscanMinValues > 0
+                             && largestInList(query.root())
+                                    >= size_t(internalQueryPlannerInListCollscanMinValues);
+
+        collscanCompetes = collscanCompetes || (canTableScan && skipScanPlanned);
+
+        if (possibleToCollscan && (collscanRequested || collscanNeeded || collscanCompetes)) {
             QuerySolution* collscan = buildCollscanSoln(query, false, params);
             if (NULL != collscan) {
                 SolutionCacheData* scd = new SolutionCacheData();
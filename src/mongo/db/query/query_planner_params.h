@@ -102,6 +102,10 @@ namespace mongo {
         // Were index filters applied to indices?
         bool indexFiltersApplied;
 
+        // Plan an index filter pins to the query shape, serialized by SolutionCacheData::toBSON().
+        // Empty if there is none.
+        BSONObj pinnedPlan;
+
         // What's the max number of indexed solutions we want to output?  It's expensive to compare
         // plans via the MultiPlanStage, and the set of possible plans is very large for certain
         // index+query combinations.
@@ -368,6 +368,80 @@ namespace {
         assertSolutionExists("{fetch: {filter: null, node: {ixscan: {pattern: {x: 1, y: 1}}}}}");
     }
 
+    TEST_F(QueryPlannerTest, LargeInListAlsoGetsCollscan) {
+        params.options = QueryPlannerParams::DEFAULT;
+        addIndex(BSON("x" << 1));
+
+        int oldMinValues = internalQueryPlannerInListCollscanMinValues;
+        internalQueryPlannerInListCollscanMinValues = 3;
+
+        runQuery(fromjson("{x: {$in: [1, 2]}}"));
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}");
+
+        runQuery(fromjson("{x: {$in: [1, 2, 3]}}"));
+        assertNumSolutions(2U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {x: {$in: [1, 2, 3]}}}}");
+        assertSolutionExists("{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}");
+
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        runQuery(fromjson("{x: {$in: [1, 2, 3]}}"));
+        assertNumSolutions(1U);
+
+        internalQueryPlannerInListCollscanMinValues = oldMinValues;
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanOverLaterIndexFields) {
+        params.options = QueryPlannerParams::DEFAULT;
+        addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+
+        // Without statistics showing few leading values, only a collscan is possible.
+        runQuery(fromjson("{b: 5}"));
+        assertNumSolutions(1U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+
+        params.indices.back().allowSkipScan = true;
+        runQuery(fromjson("{b: 5, c: {$gt: 1}, d: 3}"));
+        assertNumSolutions(2U);
+        assertSolutionExists("{cscan: {dir: 1}}");
+        assertSolutionExists("{fetch: {filter: {d: 3}, node: {ixscan: {pattern: {a: 1, b: 1, c: 1},"
+                             "bounds: {a: [['MinKey','MaxKey',true,true]], b: [[5,5,true,true]],"
+                             "c: [[1,Infinity,false,true]]}}}}}");
+
+        // A predicate on the leading field is planned as usual.
+        runQuery(fromjson("{a: 1, b: 5}"));
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1, c: 1},"
+                             "bounds: {a: [[1,1,true,true]], b: [[5,5,true,true]],"
+                             "c: [['MinKey','MaxKey',true,true]]}}}}}");
+
+        // Neither field is in the index.
+        runQuery(fromjson("{d: 3}"));
+        assertNumSolutions(1U);
+        assertSolutionExists("{cscan: {dir: 1}}");
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanCanBeCovered) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1 << "b" << 1));
+        params.indices.back().allowSkipScan = true;
+
+        runQuerySortProj(fromjson("{b: {$in: [1, 2]}}"), BSONObj(), fromjson("{_id: 0, a: 1}"));
+        assertNumSolutions(1U);
+        assertSolutionExists("{proj: {spec: {_id: 0, a: 1}, node: {ixscan: {pattern: {a: 1, b: 1},"
+                             "bounds: {a: [['MinKey','MaxKey',true,true]],"
+                             "b: [[1,1,true,true], [2,2,true,true]]}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, NoSkipScanOverMultikeyIndex) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1 << "b" << 1), true);
+        params.indices.back().allowSkipScan = true;
+
+        runQuery(fromjson("{b: 5}"));
+        assertNumSolutions(0U);
+    }
+
     //
     // indexFilterApplied
     // Check that index filter flag is passed from planner params
@@ -267,7 +267,7 @@ namespace mongo {
             return geoObj == node->indexKeyPattern;
         }
         else if (STAGE_TEXT == trueSoln->getType()) {
-            // {text: {search: "somestr", language: "something", filter: {blah: 1}}}
+            // {text: {search: "somestr", language: "something", filter: {blah: 1}, limit: 5}}
             const TextNode* node = static_cast<const TextNode*>(trueSoln);
             BSONElement el = testSoln["text"];
             if (el.eoo() || !el.isABSONObj()) { return false; }
@@ -298,6 +298,13 @@ namespace mongo {
                 }
             }
 
+            BSONElement limitElt = textObj["limit"];
+            if (!limitElt.eoo()) {
+                if (!limitElt.isNumber() || size_t(limitElt.numberInt()) != node->limit) {
+                    return false;
+                }
+            }
+
             BSONElement filter = textObj["filter"];
             if (!filter.eoo()) {
                 if (filter.isNull()) {
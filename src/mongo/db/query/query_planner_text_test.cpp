@@ -599,6 +599,46 @@ namespace {
         assertSolutionExists("{fetch: {node: {text: {search: 'foo'}}}}");
     }
 
+    TEST_F(QueryPlannerTest, TextSortedByScoreWithLimit) {
+        addIndex(BSON("_fts" << "text" << "_ftsx" << 1));
+        runQuerySortProjSkipLimit(fromjson("{$text: {$search: 'foo bar'}}"),
+                                  fromjson("{s: {$meta: 'textScore'}}"),
+                                  fromjson("{s: {$meta: 'textScore'}}"), 2, 3);
+
+        // The text stage only needs the best skip + limit results.
+        assertNumSolutions(1U);
+        assertSolutionExists("{skip: {n: 2, node: "
+                                "{proj: {spec: {s: {$meta: 'textScore'}}, node: "
+                                    "{sort: {pattern: {s: {$meta: 'textScore'}}, limit: 5, node: "
+                                        "{text: {search: 'foo bar', limit: 5}}}}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, TextSortedByScoreAndFieldWithLimit) {
+        addIndex(BSON("_fts" << "text" << "_ftsx" << 1));
+        runQuerySortProjSkipLimit(fromjson("{$text: {$search: 'foo'}}"),
+                                  fromjson("{s: {$meta: 'textScore'}, a: 1}"),
+                                  fromjson("{s: {$meta: 'textScore'}}"), 0, 3);
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{proj: {spec: {s: {$meta: 'textScore'}}, node: "
+                                "{sort: {pattern: {s: {$meta: 'textScore'}, a: 1}, limit: 3, node: "
+                                    "{text: {search: 'foo', limit: 0}}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, TextSortedByScoreWithLimitAndFetchFilter) {
+        addIndex(BSON("_fts" << "text" << "_ftsx" << 1));
+        runQuerySortProjSkipLimit(fromjson("{$text: {$search: 'foo'}, a: {$geoIntersects: "
+                                           "{$geometry: {type: 'Point', coordinates: [3.0, 1.0]}}}}"),
+                                  fromjson("{s: {$meta: 'textScore'}}"),
+                                  fromjson("{s: {$meta: 'textScore'}}"), 0, 3);
+
+        // The fetch filter could reject text results, so the text stage must read them all.
+        assertNumSolutions(1U);
+        assertSolutionExists("{proj: {spec: {s: {$meta: 'textScore'}}, node: "
+                                "{sort: {pattern: {s: {$meta: 'textScore'}}, limit: 3, node: "
+                                    "{fetch: {node: {text: {search: 'foo', limit: 0}}}}}}}}");
+    }
+
     // SERVER-13960: $text beneath $or with exact predicates.
     TEST_F(QueryPlannerTest, OrTextExact) {
         addIndex(BSON("pre" << 1 << "_fts" << "text" << "_ftsx" << 1));
@@ -0,0 +1,95 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_reply_builder.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/query_knobs.h"
+
+namespace mongo {
+
+namespace {
+
+    // Documents, and their bytes, sent straight from their own buffer rather than copied
+    Counter64 sharedDocuments;
+    ServerStatusMetricField<Counter64> displaySharedDocuments(
+                                            "queryExecutor.reply.sharedDocuments",
+                                            &sharedDocuments);
+    Counter64 sharedBytes;
+    ServerStatusMetricField<Counter64> displaySharedBytes("queryExecutor.reply.sharedBytes",
+                                                          &sharedBytes);
+
+} // namespace
+
+    QueryReplyBuilder::QueryReplyBuilder(int initialBufSize)
+        : _shareMinBytes(internalQueryExecReplyShareMinBytes),
+          _len(sizeof(QueryResult::Value)),
+          _copied(new BufBuilder(initialBufSize)) {
+        _copied->skip(sizeof(QueryResult::Value));
+    }
+
+    void QueryReplyBuilder::append(const BSONObj& obj) {
+        const int size = obj.objsize();
+        _len += size;
+
+        if (_shareMinBytes <= 0 || size < _shareMinBytes || !obj.isOwned()) {
+            if (!_copied) {
+                _copied.reset(new BufBuilder(32768));
+            }
+            _copied->appendBuf(obj.objdata(), size);
+            return;
+        }
+
+        // The header always goes first, so the reply is never empty here
+        _flushCopied();
+        _reply.appendSharedData(obj.sharedBuffer(), obj.objdata(), size);
+
+        sharedDocuments.increment();
+        sharedBytes.increment(size);
+    }
+
+    QueryResult::View QueryReplyBuilder::done(Message* result) {
+        _flushCopied();
+        *result = _reply;
+        return result->header().view2ptr();
+    }
+
+    void QueryReplyBuilder::_flushCopied() {
+        if (!_copied) {
+            return;
+        }
+        _reply.appendData(_copied->buf(), _copied->len());
+        _copied->decouple();
+        _copied.reset();
+    }
+
+} // namespace mongo
@@ -0,0 +1,81 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#pragma once
+
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/db/dbmessage.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+    class BSONObj;
+
+    /**
+     * Assembles the documents of an OP_REPLY behind its QueryResult header.
+     *
+     * Documents are normally copied into the reply. Owned documents of at least
+     * internalQueryExecReplyShareMinBytes are referenced instead: the reply keeps their
+     * SharedBuffer alive and the socket layer sends them with the rest of the reply in a single
+     * scatter/gather write. Unowned documents, such as ones pointing into MMAPv1 data files,
+     * are always copied since their memory is only valid while the collection is locked.
+     */
+    class QueryReplyBuilder {
+        MONGO_DISALLOW_COPYING(QueryReplyBuilder);
+    public:
+        explicit QueryReplyBuilder(int initialBufSize);
+
+        void append(const BSONObj& obj);
+
+        /** Size of the reply so far, including the QueryResult header. */
+        int len() const { return _len; }
+
+        /**
+         * Moves the reply into 'result', which must be empty, and returns its header for the
+         * caller to fill in. The builder must not be used afterwards.
+         */
+        QueryResult::View done(Message* result);
+
+    private:
+        // Moves the documents copied so far into _reply, as a piece of their own.
+        void _flushCopied();
+
+        const int _shareMinBytes;
+        int _len;
+
+        // Where documents are copied to. Starts with the header and is recreated after every
+        // shared document.
+        boost::scoped_ptr<BufBuilder> _copied;
+
+        Message _reply;
+    };
+
+} // namespace mongo
@@ -38,7 +38,9 @@ namespace mongo {
     // HintOverride
     //
 
-    AllowedIndices::AllowedIndices(const std::vector<BSONObj>& indexKeyPatterns) {
+    AllowedIndices::AllowedIndices(const std::vector<BSONObj>& indexKeyPatterns,
+                                   const BSONObj& pinnedPlan)
+        : pinnedPlan(pinnedPlan.getOwned()) {
         for (std::vector<BSONObj>::const_iterator i = indexKeyPatterns.begin();
              i != indexKeyPatterns.end(); ++i) {
             const BSONObj& indexKeyPattern = *i;
@@ -54,10 +56,12 @@ namespace mongo {
 
     AllowedIndexEntry::AllowedIndexEntry(const BSONObj& query, const BSONObj& sort,
                                    const BSONObj& projection,
-                                   const std::vector<BSONObj>& indexKeyPatterns)
+                                   const std::vector<BSONObj>& indexKeyPatterns,
+                                   const BSONObj& pinnedPlan)
         : query(query.getOwned()),
           sort(sort.getOwned()),
-          projection(projection.getOwned()) {
+          projection(projection.getOwned()),
+          pinnedPlan(pinnedPlan.getOwned()) {
         for (std::vector<BSONObj>::const_iterator i = indexKeyPatterns.begin();
              i != indexKeyPatterns.end(); ++i) {
             const BSONObj& indexKeyPattern = *i;
@@ -68,7 +72,8 @@ namespace mongo {
     AllowedIndexEntry::~AllowedIndexEntry() { }
 
     AllowedIndexEntry* AllowedIndexEntry::clone() const {
-        AllowedIndexEntry* entry = new AllowedIndexEntry(query, sort, projection, indexKeyPatterns);
+        AllowedIndexEntry* entry = new AllowedIndexEntry(query, sort, projection, indexKeyPatterns,
+                                                         pinnedPlan);
         return entry;
     }
 
@@ -100,7 +105,7 @@ namespace mongo {
         AllowedIndexEntry* entry = cacheIter->second;
 
         // Create a AllowedIndices from entry.
-        *allowedIndicesOut = new AllowedIndices(entry->indexKeyPatterns);
+        *allowedIndicesOut = new AllowedIndices(entry->indexKeyPatterns, entry->pinnedPlan);
 
         return true;
     }
@@ -116,12 +121,14 @@ namespace mongo {
     }
 
     void QuerySettings::setAllowedIndices(const CanonicalQuery& canonicalQuery,
-                                          const std::vector<BSONObj>& indexes) {
+                                          const std::vector<BSONObj>& indexes,
+                                          const BSONObj& pinnedPlan) {
         const LiteParsedQuery& lpq = canonicalQuery.getParsed();
         const BSONObj& query = lpq.getFilter();
         const BSONObj& sort = lpq.getSort();
         const BSONObj& projection = lpq.getProj();
-        AllowedIndexEntry* entry = new AllowedIndexEntry(query, sort, projection, indexes);
+        AllowedIndexEntry* entry = new AllowedIndexEntry(query, sort, projection, indexes,
+                                                         pinnedPlan);
 
         const PlanCacheKey& key = canonicalQuery.getPlanCacheKey();
         boost::lock_guard<boost::mutex> cacheLock(_mutex);
@@ -46,13 +46,17 @@ namespace mongo {
     private:
         MONGO_DISALLOW_COPYING(AllowedIndices);
     public:
-        AllowedIndices(const std::vector<BSONObj>& indexKeyPatterns);
+        AllowedIndices(const std::vector<BSONObj>& indexKeyPatterns,
+                       const BSONObj& pinnedPlan = BSONObj());
         ~AllowedIndices();
 
         // These are the index key patterns that
         // we will use to override the indexes retrieved from
         // the index catalog.
         std::vector<BSONObj> indexKeyPatterns;
+
+        // Plan pinned to the query shape, serialized by SolutionCacheData::toBSON(), or empty.
+        BSONObj pinnedPlan;
     };
 
     /**
@@ -60,6 +64,7 @@ namespace mongo {
      * Holds:
      *     query shape (query, sort, projection)
      *     vector of index specs
+     *     optional pinned plan
      */
     class AllowedIndexEntry {
     private:
@@ -67,7 +72,8 @@ namespace mongo {
     public:
         AllowedIndexEntry(const BSONObj& query, const BSONObj& sort,
                           const BSONObj& projection,
-                          const std::vector<BSONObj>& indexKeyPatterns);
+                          const std::vector<BSONObj>& indexKeyPatterns,
+                          const BSONObj& pinnedPlan = BSONObj());
         ~AllowedIndexEntry();
         AllowedIndexEntry* clone() const;
 
@@ -81,6 +87,10 @@ namespace mongo {
         // we will use to override the indexes retrieved from
         // the index catalog.
         std::vector<BSONObj> indexKeyPatterns;
+
+        // If not empty, a SolutionCacheData serialized by toBSON() that queries of this shape
+        // are planned from directly, with no enumeration or trial period.
+        BSONObj pinnedPlan;
     };
 
     /**
@@ -113,9 +123,11 @@ namespace mongo {
          * Adds or replaces entry in query settings.
          * If existing entry is found for the same key,
          * frees resources for existing entry before replacing.
+         * A non-empty 'pinnedPlan' pins that plan to the query shape.
          */
         void setAllowedIndices(const CanonicalQuery& canonicalQuery,
-                               const std::vector<BSONObj>& indexes);
+                               const std::vector<BSONObj>& indexes,
+                               const BSONObj& pinnedPlan = BSONObj());
 
         /**
          * Removes single entry from query settings. No effect if query shape is not found.
@@ -0,0 +1,104 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <algorithm>
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_knobs.h"
+
+namespace mongo {
+
+    void QueryShapeStatsEntry::toBSON(BSONObjBuilder* builder) const {
+        builder->append("query", query);
+        builder->append("sort", sort);
+        builder->append("projection", projection);
+        builder->appendNumber("count", count);
+        builder->appendNumber("totalMicros", totalMicros);
+        builder->appendNumber("maxMicros", maxMicros);
+        builder->appendNumber("totalKeysExamined", keysExamined);
+        builder->appendNumber("totalDocsExamined", docsExamined);
+        builder->appendNumber("nReturned", nReturned);
+        builder->appendNumber("planCacheHits", planCacheHits);
+    }
+
+    QueryShapeStats::QueryShapeStats()
+        : _entries(std::max(1, internalQueryShapeStatsSize)) { }
+
+    QueryShapeStats::QueryShapeStats(size_t maxShapes)
+        : _entries(maxShapes) { }
+
+    void QueryShapeStats::record(const CanonicalQuery& query,
+                                 const QueryShapeExecution& execution) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+
+        QueryShapeStatsEntry* entry;
+        if (!_entries.get(query.getPlanCacheKey(), &entry).isOK()) {
+            entry = new QueryShapeStatsEntry();
+            const LiteParsedQuery& pq = query.getParsed();
+            entry->query = pq.getFilter().getOwned();
+            entry->sort = pq.getSort().getOwned();
+            entry->projection = pq.getProj().getOwned();
+            _entries.add(query.getPlanCacheKey(), entry);
+        }
+
+        entry->count++;
+        entry->totalMicros += execution.micros;
+        entry->maxMicros = std::max(entry->maxMicros, execution.micros);
+        entry->keysExamined += execution.keysExamined;
+        entry->docsExamined += execution.docsExamined;
+        entry->nReturned += execution.nReturned;
+        if (execution.fromPlanCache) {
+            entry->planCacheHits++;
+        }
+    }
+
+    std::vector<QueryShapeStatsEntry> QueryShapeStats::getAllEntries() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        std::vector<QueryShapeStatsEntry> entries;
+        entries.reserve(_entries.size());
+        for (LRUKeyValue<PlanCacheKey, QueryShapeStatsEntry>::KVListConstIt it = _entries.begin();
+             it != _entries.end(); ++it) {
+            entries.push_back(*it->second);
+        }
+        return entries;
+    }
+
+    void QueryShapeStats::clear() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _entries.clear();
+    }
+
+    size_t QueryShapeStats::size() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _entries.size();
+    }
+
+} // namespace mongo
@@ -0,0 +1,120 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/mutex.hpp>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/plan_cache.h"
+
+namespace mongo {
+
+    class CanonicalQuery;
+
+    /**
+     * What one execution of a query contributed to the statistics of its shape.
+     */
+    struct QueryShapeExecution {
+        QueryShapeExecution() : micros(0),
+                                keysExamined(0),
+                                docsExamined(0),
+                                nReturned(0),
+                                fromPlanCache(false) { }
+
+        long long micros;
+        long long keysExamined;
+        long long docsExamined;
+        long long nReturned;
+
+        // Was the plan taken from the plan cache rather than chosen by the planner?
+        bool fromPlanCache;
+    };
+
+    /**
+     * Cumulative statistics of every execution of one query shape.
+     */
+    struct QueryShapeStatsEntry {
+        QueryShapeStatsEntry() : count(0),
+                                 totalMicros(0),
+                                 maxMicros(0),
+                                 keysExamined(0),
+                                 docsExamined(0),
+                                 nReturned(0),
+                                 planCacheHits(0) { }
+
+        void toBSON(BSONObjBuilder* builder) const;
+
+        // The query shape, taken from the first query of the shape that was recorded.
+        BSONObj query;
+        BSONObj sort;
+        BSONObj projection;
+
+        long long count;
+        long long totalMicros;
+        long long maxMicros;
+        long long keysExamined;
+        long long docsExamined;
+        long long nReturned;
+        long long planCacheHits;
+    };
+
+    /**
+     * Per collection table of QueryShapeStatsEntry keyed by the plan cache key of the shape.
+     * Holds at most internalQueryShapeStatsSize shapes; the least recently executed shape is
+     * dropped to make room for a new one.
+     *
+     * Thread safe: queries record into it while holding the collection in a shared mode.
+     */
+    class QueryShapeStats {
+        MONGO_DISALLOW_COPYING(QueryShapeStats);
+    public:
+        QueryShapeStats();
+
+        explicit QueryShapeStats(size_t maxShapes);
+
+        void record(const CanonicalQuery& query, const QueryShapeExecution& execution);
+
+        /**
+         * Returns a copy of every entry, most recently executed first.
+         */
+        std::vector<QueryShapeStatsEntry> getAllEntries() const;
+
+        void clear();
+
+        size_t size() const;
+
+    private:
+        LRUKeyValue<PlanCacheKey, QueryShapeStatsEntry> _entries;
+
+        mutable boost::mutex _mutex;
+    };
+
+} // namespace mongo
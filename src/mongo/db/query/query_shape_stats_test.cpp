@@ -0,0 +1,115 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/db/json.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    using boost::scoped_ptr;
+    using std::vector;
+
+    static const char* ns = "somebogusns";
+
+    CanonicalQuery* canonicalize(const char* queryStr, const char* sortStr = "{}") {
+        CanonicalQuery* cq;
+        Status result = CanonicalQuery::canonicalize(ns, fromjson(queryStr), fromjson(sortStr),
+                                                     BSONObj(), &cq);
+        ASSERT_OK(result);
+        return cq;
+    }
+
+    QueryShapeExecution execution(long long micros, bool fromPlanCache) {
+        QueryShapeExecution exec;
+        exec.micros = micros;
+        exec.keysExamined = 10;
+        exec.docsExamined = 5;
+        exec.nReturned = 2;
+        exec.fromPlanCache = fromPlanCache;
+        return exec;
+    }
+
+    TEST(QueryShapeStatsTest, QueriesOfOneShapeShareAnEntry) {
+        QueryShapeStats stats(10);
+        scoped_ptr<CanonicalQuery> first(canonicalize("{a: 1, b: {$gt: 3}}"));
+        scoped_ptr<CanonicalQuery> second(canonicalize("{a: 7, b: {$gt: 0}}"));
+        stats.record(*first, execution(100, false));
+        stats.record(*second, execution(300, true));
+        stats.record(*second, execution(200, true));
+
+        vector<QueryShapeStatsEntry> entries = stats.getAllEntries();
+        ASSERT_EQUALS(1U, entries.size());
+        const QueryShapeStatsEntry& entry = entries[0];
+        ASSERT_EQUALS(fromjson("{a: 1, b: {$gt: 3}}"), entry.query);
+        ASSERT_EQUALS(3, entry.count);
+        ASSERT_EQUALS(600, entry.totalMicros);
+        ASSERT_EQUALS(300, entry.maxMicros);
+        ASSERT_EQUALS(30, entry.keysExamined);
+        ASSERT_EQUALS(15, entry.docsExamined);
+        ASSERT_EQUALS(6, entry.nReturned);
+        ASSERT_EQUALS(2, entry.planCacheHits);
+    }
+
+    TEST(QueryShapeStatsTest, SortIsPartOfTheShape) {
+        QueryShapeStats stats(10);
+        scoped_ptr<CanonicalQuery> unsorted(canonicalize("{a: 1}"));
+        scoped_ptr<CanonicalQuery> sorted(canonicalize("{a: 1}", "{b: 1}"));
+        stats.record(*unsorted, execution(1, false));
+        stats.record(*sorted, execution(1, false));
+        ASSERT_EQUALS(2U, stats.size());
+    }
+
+    TEST(QueryShapeStatsTest, LeastRecentlyExecutedShapeIsDropped) {
+        QueryShapeStats stats(2);
+        scoped_ptr<CanonicalQuery> a(canonicalize("{a: 1}"));
+        scoped_ptr<CanonicalQuery> b(canonicalize("{b: 1}"));
+        scoped_ptr<CanonicalQuery> c(canonicalize("{c: 1}"));
+        stats.record(*a, execution(1, false));
+        stats.record(*b, execution(1, false));
+        stats.record(*a, execution(1, false));
+        stats.record(*c, execution(1, false));
+
+        vector<QueryShapeStatsEntry> entries = stats.getAllEntries();
+        ASSERT_EQUALS(2U, entries.size());
+        ASSERT_EQUALS(fromjson("{c: 1}"), entries[0].query);
+        ASSERT_EQUALS(fromjson("{a: 1}"), entries[1].query);
+        ASSERT_EQUALS(2, entries[1].count);
+
+        stats.clear();
+        ASSERT_EQUALS(0U, stats.size());
+    }
+
+} // namespace
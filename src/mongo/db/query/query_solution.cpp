@@ -78,6 +78,10 @@ namespace mongo {
         *ss << "language = " << language << '\n';
         addIndent(ss, indent + 1);
         *ss << "indexPrefix = " << indexPrefix.toString() << '\n';
+        if (0 != limit) {
+            addIndent(ss, indent + 1);
+            *ss << "limit = " << limit << '\n';
+        }
         if (NULL != filter) {
             addIndent(ss, indent + 1);
             *ss << " filter = " << filter->toString();
@@ -94,6 +98,7 @@ namespace mongo {
         copy->query = this->query;
         copy->language = this->language;
         copy->indexPrefix = this->indexPrefix;
+        copy->limit = this->limit;
 
         return copy;
     }
@@ -394,7 +399,12 @@ namespace mongo {
     //
 
     IndexScanNode::IndexScanNode()
-        : indexIsMultiKey(false), direction(1), maxScan(0), addKeyMetadata(false) { }
+        : indexIsMultiKey(false),
+          indexMultikeyPaths(0),
+          direction(1),
+          maxScan(0),
+          addKeyMetadata(false),
+          estimatedKeys(-1) { }
 
     void IndexScanNode::appendToString(mongoutils::str::stream* ss, int indent) const {
         addIndent(ss, indent);
@@ -413,17 +423,18 @@ namespace mongo {
     }
 
     bool IndexScanNode::hasField(const string& field) const {
-        // There is no covering in a multikey index because you don't know whether or not the field
-        // in the key was extracted from an array in the original document.
-        if (indexIsMultiKey) { return false; }
-
         // Custom index access methods may return non-exact key data - this function is currently
         // used for covering exact key data only.
         if (IndexNames::BTREE != IndexNames::findPluginName(indexKeyPattern)) { return false; }
 
         BSONObjIterator it(indexKeyPattern);
-        while (it.more()) {
+        for (int pos = 0; it.more(); ++pos) {
             if (field == it.next().fieldName()) {
+                // A field of a multikey index can't be covered if it was extracted from an array
+                // in the original document, since the key only holds one of its elements.
+                if (indexIsMultiKey) {
+                    return pos < 64 && !(indexMultikeyPaths & (1ULL << pos));
+                }
                 return true;
             }
         }
@@ -567,10 +578,12 @@ namespace mongo {
         copy->_sorts = this->_sorts;
         copy->indexKeyPattern = this->indexKeyPattern;
         copy->indexIsMultiKey = this->indexIsMultiKey;
+        copy->indexMultikeyPaths = this->indexMultikeyPaths;
         copy->direction = this->direction;
         copy->maxScan = this->maxScan;
         copy->addKeyMetadata = this->addKeyMetadata;
         copy->bounds = this->bounds;
+        copy->estimatedKeys = this->estimatedKeys;
 
         return copy;
     }
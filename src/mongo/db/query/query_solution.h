@@ -218,7 +218,7 @@ namespace mongo {
     };
 
     struct TextNode : public QuerySolutionNode {
-        TextNode() { }
+        TextNode() : limit(0) { }
         virtual ~TextNode() { }
 
         virtual StageType getType() const { return STAGE_TEXT; }
@@ -244,6 +244,9 @@ namespace mongo {
         // text node while creating the text leaf node and convert them into a BSONObj index prefix
         // when we finish the text leaf node.
         BSONObj indexPrefix;
+
+        // If nonzero, the parent is a sort by text score that only keeps this many results.
+        size_t limit;
     };
 
     struct CollectionScanNode : public QuerySolutionNode {
@@ -405,6 +408,9 @@ namespace mongo {
         BSONObj indexKeyPattern;
         bool indexIsMultiKey;
 
+        // See IndexEntry::multikeyPaths
+        unsigned long long indexMultikeyPaths;
+
         int direction;
 
         // maxScan option to .find() limits how many docs we look at.
@@ -418,6 +424,10 @@ namespace mongo {
         // If you use the complex bounds, we force Btree access.
         // The complex bounds require Btree access.
         IndexBounds bounds;
+
+        // How many keys the plan cost estimator expects this scan to examine, or -1 if the
+        // scan was not costed.
+        long long estimatedKeys;
     };
 
     struct ProjectionNode : public QuerySolutionNode {
@@ -0,0 +1,333 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_template_cache.h"
+
+#include <map>
+
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using boost::shared_ptr;
+    using std::auto_ptr;
+    using std::string;
+    using std::vector;
+
+    namespace {
+
+        bool isComparison(MatchExpression::MatchType type) {
+            switch (type) {
+            case MatchExpression::EQ:
+            case MatchExpression::LT:
+            case MatchExpression::LTE:
+            case MatchExpression::GT:
+            case MatchExpression::GTE:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        bool isComparisonOperator(const StringData& name) {
+            return name == "$eq" || name == "$lt" || name == "$lte" ||
+                   name == "$gt" || name == "$gte";
+        }
+
+        /**
+         * Literals whose comparison the parser turns into a single leaf regardless of value.
+         */
+        bool isScalarLiteral(const BSONElement& elt) {
+            switch (elt.type()) {
+            case NumberDouble:
+            case NumberInt:
+            case NumberLong:
+            case String:
+            case Bool:
+            case Date:
+            case Timestamp:
+            case jstOID:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        void appendElementShape(const BSONElement& elt, string* key) {
+            key->push_back(static_cast<char>(elt.type()));
+            key->append(elt.fieldName(), elt.fieldNameSize());
+        }
+
+        bool appendFilterShape(const BSONObj& filter, string* key, vector<BSONElement>* literals) {
+            BSONObjIterator it(filter);
+            while (it.more()) {
+                const BSONElement elt = it.next();
+                const StringData name = elt.fieldNameStringData();
+
+                if (name.startsWith("$")) {
+                    if (name != "$and" && name != "$or" && name != "$nor") {
+                        return false;
+                    }
+                    if (elt.type() != Array || elt.Obj().isEmpty()) {
+                        return false;
+                    }
+
+                    appendElementShape(elt, key);
+                    BSONObjIterator clauses(elt.Obj());
+                    while (clauses.more()) {
+                        const BSONElement clause = clauses.next();
+                        if (clause.type() != Object) {
+                            return false;
+                        }
+                        appendElementShape(clause, key);
+                        if (!appendFilterShape(clause.Obj(), key, literals)) {
+                            return false;
+                        }
+                    }
+                    key->push_back(static_cast<char>(EOO));
+                }
+                else if (elt.type() == Object) {
+                    // Only an object of comparison operators; an object literal is left to the
+                    // parser.
+                    const BSONObj operators = elt.Obj();
+                    if (operators.isEmpty()) {
+                        return false;
+                    }
+
+                    appendElementShape(elt, key);
+                    BSONObjIterator opIt(operators);
+                    while (opIt.more()) {
+                        const BSONElement op = opIt.next();
+                        if (!isComparisonOperator(op.fieldNameStringData()) ||
+                            !isScalarLiteral(op)) {
+                            return false;
+                        }
+                        appendElementShape(op, key);
+                        literals->push_back(op);
+                    }
+                    key->push_back(static_cast<char>(EOO));
+                }
+                else if (isScalarLiteral(elt)) {
+                    appendElementShape(elt, key);
+                    literals->push_back(elt);
+                }
+                else {
+                    return false;
+                }
+            }
+            key->push_back(static_cast<char>(EOO));
+            return true;
+        }
+
+        /**
+         * Collects the comparisons of 'root' in preorder. Returns false if 'root' holds anything
+         * other than comparisons under $and, $or and $nor.
+         */
+        template <typename Expression>
+        bool collectComparisons(Expression* root, vector<Expression*>* out) {
+            const MatchExpression::MatchType type = root->matchType();
+            if (isComparison(type)) {
+                out->push_back(root);
+                return true;
+            }
+
+            if (type != MatchExpression::AND &&
+                type != MatchExpression::OR &&
+                type != MatchExpression::NOR) {
+                return false;
+            }
+
+            for (size_t i = 0; i < root->numChildren(); ++i) {
+                if (!collectComparisons<Expression>(root->getChild(i), out)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void bindComparisons(MatchExpression* root,
+                             const vector<size_t>& leafLiterals,
+                             const vector<BSONElement>& literals) {
+            vector<MatchExpression*> leaves;
+            invariant(collectComparisons(root, &leaves));
+            invariant(leaves.size() == leafLiterals.size());
+
+            for (size_t i = 0; i < leaves.size(); ++i) {
+                const BSONElement& literal = literals[leafLiterals[i]];
+                ComparisonMatchExpression* leaf = static_cast<ComparisonMatchExpression*>(leaves[i]);
+                dassert(leaf->getData().canonicalType() == literal.canonicalType());
+                leaf->rebindRHS(literal);
+            }
+        }
+
+    }  // namespace
+
+    //
+    // QueryTemplate
+    //
+
+    // static
+    QueryTemplate* QueryTemplate::make(const BSONObj& filter,
+                                       const MatchExpression* root,
+                                       const PlanCacheKey& planCacheKey,
+                                       const vector<BSONElement>& literals) {
+        vector<const MatchExpression*> leaves;
+        if (!collectComparisons(root, &leaves) || leaves.size() != literals.size()) {
+            return NULL;
+        }
+
+        // Each comparison points at the literal it was parsed from.
+        std::map<const char*, size_t> literalOrdinals;
+        for (size_t i = 0; i < literals.size(); ++i) {
+            literalOrdinals[literals[i].rawdata()] = i;
+        }
+
+        auto_ptr<QueryTemplate> queryTemplate(new QueryTemplate());
+        vector<bool> bound(literals.size(), false);
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            const ComparisonMatchExpression* leaf =
+                static_cast<const ComparisonMatchExpression*>(leaves[i]);
+            std::map<const char*, size_t>::const_iterator ordinal =
+                literalOrdinals.find(leaf->getData().rawdata());
+            if (ordinal == literalOrdinals.end() || bound[ordinal->second]) {
+                return NULL;
+            }
+            bound[ordinal->second] = true;
+            queryTemplate->_leafLiterals.push_back(ordinal->second);
+        }
+
+        // Point the template's own tree at its own copy of the literals.
+        queryTemplate->_filter = filter.getOwned();
+        string unusedKey;
+        vector<BSONElement> ownedLiterals;
+        invariant(appendFilterShape(queryTemplate->_filter, &unusedKey, &ownedLiterals));
+
+        queryTemplate->_root.reset(root->shallowClone());
+        bindComparisons(queryTemplate->_root.get(), queryTemplate->_leafLiterals, ownedLiterals);
+
+        queryTemplate->_planCacheKey = planCacheKey;
+        return queryTemplate.release();
+    }
+
+    MatchExpression* QueryTemplate::bind(const vector<BSONElement>& literals) const {
+        invariant(literals.size() == _leafLiterals.size());
+        auto_ptr<MatchExpression> root(_root->shallowClone());
+        bindComparisons(root.get(), _leafLiterals, literals);
+        return root.release();
+    }
+
+    //
+    // QueryTemplateCache
+    //
+
+    // static
+    QueryTemplateCache& QueryTemplateCache::get() {
+        static QueryTemplateCache* cache = new QueryTemplateCache();
+        return *cache;
+    }
+
+    // static
+    bool QueryTemplateCache::makeKey(const BSONObj& filter,
+                                     const BSONObj& sort,
+                                     const BSONObj& proj,
+                                     string* key,
+                                     vector<BSONElement>* literals) {
+        if (!appendFilterShape(filter, key, literals)) {
+            return false;
+        }
+
+        // Sort and projection are part of the plan cache key, so they are kept whole.
+        key->append(sort.objdata(), sort.objsize());
+        key->append(proj.objdata(), proj.objsize());
+        return true;
+    }
+
+    QueryTemplateCache::Partition& QueryTemplateCache::_partitionFor(const string& key) {
+        return _partitions[Map::hasher()(key) % kNumPartitions];
+    }
+
+    shared_ptr<const QueryTemplate> QueryTemplateCache::find(const string& key) {
+        shared_ptr<const QueryTemplate> entry;
+        {
+            Partition& partition = _partitionFor(key);
+            scoped_spinlock lk(partition.lock);
+            Map::const_iterator it = partition.entries.find(key);
+            if (it != partition.entries.end()) {
+                entry = it->second;
+            }
+        }
+
+        if (entry) {
+            hits.increment();
+        }
+        else {
+            misses.increment();
+        }
+        return entry;
+    }
+
+    void QueryTemplateCache::add(const string& key,
+                                 const shared_ptr<const QueryTemplate>& entry) {
+        const int maxEntries = internalQueryTemplateCacheSize;
+        if (maxEntries <= 0) {
+            return;
+        }
+        const size_t maxPerPartition = maxEntries / kNumPartitions + 1;
+
+        Partition& partition = _partitionFor(key);
+        scoped_spinlock lk(partition.lock);
+        if (partition.entries.size() >= maxPerPartition) {
+            // Shapes that are still in use come back on their next query.
+            partition.entries.clear();
+        }
+        partition.entries[key] = entry;
+    }
+
+    void QueryTemplateCache::clear() {
+        for (size_t i = 0; i < kNumPartitions; ++i) {
+            scoped_spinlock lk(_partitions[i].lock);
+            _partitions[i].entries.clear();
+        }
+    }
+
+    size_t QueryTemplateCache::size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < kNumPartitions; ++i) {
+            scoped_spinlock lk(_partitions[i].lock);
+            total += _partitions[i].entries.size();
+        }
+        return total;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/counter.h"
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/spin_lock.h"
+
+namespace mongo {
+
+    /**
+     * The normalized and sorted parse tree of one query shape, with the literals of the query it
+     * was built from parameterized out. Binding the literals of another query of the same shape
+     * yields the tree CanonicalQuery would have built for it, without parsing it again.
+     *
+     * Only filters made of $and, $or, $nor and comparisons ($eq, $lt, $lte, $gt, $gte or an
+     * implicit equality) against scalar literals are templated: the shape of their canonical tree
+     * does not depend on the values compared against.
+     */
+    class QueryTemplate {
+        MONGO_DISALLOW_COPYING(QueryTemplate);
+    public:
+        /**
+         * Builds the template from 'root', the canonicalized tree of 'filter', whose literals in
+         * the order makeKey() returns them are 'literals'. Returns NULL if a node of 'root' does
+         * not map onto exactly one of 'literals'.
+         */
+        static QueryTemplate* make(const BSONObj& filter,
+                                   const MatchExpression* root,
+                                   const PlanCacheKey& planCacheKey,
+                                   const std::vector<BSONElement>& literals);
+
+        /**
+         * Returns a new tree with 'literals' bound into it. The caller owns the tree, which
+         * points into 'literals' and must not outlive the object they came from.
+         */
+        MatchExpression* bind(const std::vector<BSONElement>& literals) const;
+
+        const PlanCacheKey& getPlanCacheKey() const { return _planCacheKey; }
+
+    private:
+        QueryTemplate() { }
+
+        // The template's tree points into its own copy of the filter.
+        BSONObj _filter;
+        boost::scoped_ptr<MatchExpression> _root;
+
+        // The ordinal of the literal bound into each comparison of _root, in preorder.
+        std::vector<size_t> _leafLiterals;
+
+        PlanCacheKey _planCacheKey;
+    };
+
+    /**
+     * Process wide cache of QueryTemplates keyed by query shape. Holds at most
+     * internalQueryTemplateCacheSize templates; a partition that fills up is emptied.
+     *
+     * Thread safe.
+     */
+    class QueryTemplateCache {
+        MONGO_DISALLOW_COPYING(QueryTemplateCache);
+    public:
+        QueryTemplateCache() { }
+
+        static QueryTemplateCache& get();
+
+        /**
+         * Computes the shape of a query into 'key': the field names and types of 'filter' with
+         * the literal values left out, followed by the bytes of 'sort' and 'proj'. Appends the
+         * literals of 'filter', in order, to 'literals'.
+         *
+         * Returns false if 'filter' uses anything QueryTemplate does not handle.
+         */
+        static bool makeKey(const BSONObj& filter,
+                            const BSONObj& sort,
+                            const BSONObj& proj,
+                            std::string* key,
+                            std::vector<BSONElement>* literals);
+
+        /**
+         * Returns the template for 'key', or an empty pointer if there is none.
+         */
+        boost::shared_ptr<const QueryTemplate> find(const std::string& key);
+
+        void add(const std::string& key, const boost::shared_ptr<const QueryTemplate>& entry);
+
+        void clear();
+
+        size_t size() const;
+
+        Counter64 hits;
+        Counter64 misses;
+
+    private:
+        static const size_t kNumPartitions = 16;
+
+        typedef unordered_map<std::string, boost::shared_ptr<const QueryTemplate> > Map;
+
+        struct Partition {
+            mutable SpinLock lock;
+            Map entries;
+        };
+
+        Partition& _partitionFor(const std::string& key);
+
+        Partition _partitions[kNumPartitions];
+    };
+
+}  // namespace mongo
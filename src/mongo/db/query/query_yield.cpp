@@ -56,6 +56,8 @@ namespace mongo {
             return;
         }
 
+        const unsigned long long startMicros = curTimeMicros64();
+
         // Top-level locks are freed, release any potential low-level (storage engine-specific
         // locks). If we are yielding, we are at a safe place to do so.
         txn->recoveryUnit()->commitAndRestart();
@@ -68,6 +70,8 @@ namespace mongo {
         }
 
         locker->restoreLockState(snapshot);
+
+        txn->getCurOp()->recordYieldMicros(curTimeMicros64() - startMicros);
     }
 
 } // namespace mongo
@@ -94,6 +94,7 @@ namespace mongo {
             params.direction = ixn->direction;
             params.maxScan = ixn->maxScan;
             params.addKeyMetadata = ixn->addKeyMetadata;
+            params.estimatedKeys = ixn->estimatedKeys;
             return new IndexScan(txn, params, ws, ixn->filter.get());
         }
         else if (STAGE_FETCH == root->getType()) {
@@ -259,6 +260,7 @@ namespace mongo {
             params.index = index;
             params.spec = fam->getSpec();
             params.indexPrefix = node->indexPrefix;
+            params.limit = node->limit;
 
             const std::string& language = ("" == node->language
                                            ? fam->getSpec().defaultLanguage().str()
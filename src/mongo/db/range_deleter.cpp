@@ -32,6 +32,7 @@
 
 #include "mongo/db/range_deleter.h"
 
+#include <algorithm>
 #include <boost/date_time/posix_time/posix_time_duration.hpp>
 #include <memory>
 
@@ -192,9 +193,13 @@ namespace mongo {
 
     }
 
-    void RangeDeleter::startWorkers() {
-        if (!_worker) {
-            _worker.reset(new boost::thread(stdx::bind(&RangeDeleter::doWork, this)));
+    void RangeDeleter::startWorkers(int numWorkers) {
+        if (_workers.size() > 0) {
+            return;
+        }
+
+        for (int i = 0; i < std::max(1, numWorkers); i++) {
+            _workers.create_thread(stdx::bind(&RangeDeleter::doWork, this));
         }
     }
 
@@ -204,9 +209,7 @@ namespace mongo {
             _stopRequested = true;
         }
 
-        if (_worker) {
-            _worker->join();
-        }
+        _workers.join_all();
 
         scoped_lock sl(_queueMutex);
         while (_deletesInProgress > 0) {
@@ -593,6 +596,10 @@ namespace {
         return _deletesInProgress;
     }
 
+    size_t RangeDeleter::getNumWorkers() const {
+        return _workers.size();
+    }
+
     void RangeDeleter::recordDelStats(DeleteJobStats* newStat) {
         scoped_lock sl(_statsHistoryMutex);
         if (_statsHistory.size() == kDeleteJobsHistory) {
@@ -62,9 +62,9 @@ namespace mongo {
      *
      * Threading assumptions:
      *
-     *   This class has (currently) one worker thread attacking the queue, one
-     *   job at a time. If we want an immediate deletion, that job is going to
-     *   be performed on the thread that is requesting it.
+     *   This class has one or more worker threads attacking the queue, each one
+     *   working on one job at a time. If we want an immediate deletion, that job
+     *   is going to be performed on the thread that is requesting it.
      *
      *   All calls regarding deletion are synchronized.
      *
@@ -98,15 +98,15 @@ namespace mongo {
         //
 
         /**
-         * Starts the background thread to work on this queue. Does nothing if the worker
-         * thread is already active.
+         * Starts numWorkers background threads to work on this queue. Does nothing if the
+         * worker threads are already active.
          *
          * This call is _not_ thread safe and must be issued before any other call.
          */
-        void startWorkers();
+        void startWorkers(int numWorkers = 1);
 
         /**
-         * Stops the background thread working on this queue. This will block if there are
+         * Stops the background threads working on this queue. This will block if there are
          * tasks that are being deleted, but will leave the pending tasks in the queue.
          *
          * Steps:
@@ -119,7 +119,7 @@ namespace mongo {
          *
          * + restarting this deleter with startWorkers after stopping it is not supported.
          *
-         * + the worker thread could be running a call in the environment. The thread is
+         * + a worker thread could be running a call in the environment. The thread is
          *   only going to be returned when the environment decides so. In production,
          *   KillCurrentOp::killAll can be used to get the thread back from the environment.
          */
@@ -164,6 +164,7 @@ namespace mongo {
         size_t getTotalDeletes() const;
         size_t getPendingDeletes() const;
         size_t getDeletesInProgress() const;
+        size_t getNumWorkers() const;
 
         //
         // Methods meant to be only used for testing. Should be treated like private
@@ -202,8 +203,8 @@ namespace mongo {
 
         boost::scoped_ptr<RangeDeleterEnv> _env;
 
-        // Initially not active. Must be started explicitly.
-        boost::scoped_ptr<boost::thread> _worker;
+        // Initially empty. Must be started explicitly.
+        boost::thread_group _workers;
 
         // Protects _stopRequested.
         mutable mutex _stopMutex;
@@ -36,4 +36,10 @@ namespace mongo {
      * Gets the global instance of the deleter and starts it.
      */
     RangeDeleter* getDeleter();
+
+    /**
+     * Number of worker threads the global deleter is started with, so that ranges of different
+     * migrations are cleaned up concurrently.
+     */
+    extern int rangeDeleterWorkers;
 }
@@ -404,4 +404,56 @@ namespace {
         mongo::repl::setGlobalReplicationCoordinator(NULL);
     }
 
+    // Several workers should delete ready ranges at the same time.
+    TEST(QueuedDelete, MultipleWorkers) {
+        const string ns("test.user");
+
+        boost::scoped_ptr<mongo::repl::ReplicationCoordinatorMock> mock(
+            new mongo::repl::ReplicationCoordinatorMock(replSettings));
+
+        mongo::repl::setGlobalReplicationCoordinator(mock.get());
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+
+        deleter.startWorkers(2);
+        ASSERT_EQUALS(2U, deleter.getNumWorkers());
+
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        RangeDeleterOptions(KeyRange(ns,
+                                                                     BSON("x" << 0),
+                                                                     BSON("x" << 10),
+                                                                     BSON("x" << 1))),
+                                        &notifyDone1,
+                                        NULL /* don't care errMsg */));
+
+        Notification notifyDone2;
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        RangeDeleterOptions(KeyRange(ns,
+                                                                     BSON("x" << 10),
+                                                                     BSON("x" << 20),
+                                                                     BSON("x" << 1))),
+                                        &notifyDone2,
+                                        NULL /* don't care errMsg */));
+
+        // Both deletes are paused inside the environment at once.
+        env->waitForNthPausedDelete(2u);
+        ASSERT_EQUALS(2U, deleter.getDeletesInProgress());
+        ASSERT_EQUALS(0U, deleter.getPendingDeletes());
+
+        env->resumeOneDelete();
+        env->resumeOneDelete();
+        notifyDone1.waitToBeNotified();
+        notifyDone2.waitToBeNotified();
+
+        ASSERT_EQUALS(0U, deleter.getTotalDeletes());
+
+        deleter.stopWorkers();
+
+        mongo::repl::setGlobalReplicationCoordinator(NULL);
+    }
+
 } // unnamed namespace
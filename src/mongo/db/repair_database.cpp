@@ -33,6 +33,9 @@
 #include "mongo/db/repair_database.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
 
 #include "mongo/db/background.h"
 #include "mongo/base/status.h"
@@ -45,9 +48,17 @@
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/catalog/index_key_validate.h"
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_engine.h"
 #include "mongo/db/storage/storage_engine.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/log.h"
+#include "mongo/util/progress_meter.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -55,6 +66,72 @@ namespace mongo {
     using std::string;
 
 namespace {
+
+    // Number of collections of a database whose record stores repairDatabase salvages at once.
+    MONGO_EXPORT_SERVER_PARAMETER(repairWorkerThreads, int, 4);
+
+    /**
+     * The collections of a database whose record stores are left to repair, shared by the
+     * repair workers.
+     */
+    struct ParallelRepair {
+        explicit ParallelRepair(StorageEngine* engine)
+            : engine(engine), done(0), exited(0), stop(0), status(Status::OK()) {}
+
+        bool next(std::string* ns) {
+            boost::mutex::scoped_lock lk(mutex);
+            if (stop.load() || todo.empty())
+                return false;
+            *ns = todo.front();
+            todo.pop_front();
+            return true;
+        }
+
+        void finished(const std::string& ns, const Status& s) {
+            boost::mutex::scoped_lock lk(mutex);
+            if (s.isOK()) {
+                repaired.push_back(ns);
+            }
+            else if (status.isOK()) {
+                status = s;
+                stop.store(1);
+            }
+            done.fetchAndAdd(1);
+        }
+
+        StorageEngine* const engine;
+        AtomicUInt32 done;  // collections finished, whether or not they were repaired
+        AtomicUInt32 exited;  // workers which have run out of collections
+        AtomicUInt32 stop;  // set to keep the workers from starting on more collections
+
+        boost::mutex mutex;
+        std::deque<std::string> todo;
+        std::vector<std::string> repaired;
+        Status status;  // first failure of any collection, guarded by 'mutex'
+    };
+
+    void repairRecordStoreWorker(ParallelRepair* state) {
+        Client::initThread("repairWorker");
+        {
+            OperationContextImpl txn;
+            std::string ns;
+            while (state->next(&ns)) {
+                log() << "Repairing collection " << ns;
+
+                Status status = Status::OK();
+                try {
+                    status = state->engine->repairRecordStore(&txn, ns);
+                }
+                catch (const DBException& ex) {
+                    status = ex.toStatus();
+                }
+                state->finished(ns, status);
+            }
+        }
+        cc().shutdown();
+        state->exited.fetchAndAdd(1);
+    }
+
     Status rebuildIndexesOnCollection(OperationContext* txn,
                                       DatabaseCatalogEntry* dbce,
                                       const std::string& collectionName) {
@@ -126,6 +203,10 @@ namespace {
         long long dataSize = 0;
 
         RecordStore* rs = collection->getRecordStore();
+        const std::string curopMessage = "repairDatabase: rebuilding indexes on " + collectionName;
+        ProgressMeterHolder progress(*txn->setMessage(curopMessage.c_str(),
+                                                      "Repair Index Build Progress",
+                                                      rs->numRecords(txn)));
         boost::scoped_ptr<RecordIterator> it(rs->getIterator(txn));
         while (!it->isEOF()) {
             RecordId id = it->curr();
@@ -154,7 +235,9 @@ namespace {
             status = indexer->insert(data.releaseToBson(), id);
             if (!status.isOK()) return status;
             wunit.commit();
+            progress.hit();
         }
+        progress.finished();
 
         Status status = indexer->doneInserting();
         if (!status.isOK()) return status;
@@ -225,23 +308,71 @@ namespace {
         std::list<std::string> colls;
         dbce->getCollectionNamespaces(&colls);
 
-        for (std::list<std::string>::const_iterator it = colls.begin(); it != colls.end(); ++it) {
-            // Don't check for interrupt after starting to repair a collection otherwise we can
-            // leave data in an inconsistent state. Interrupting between collections is ok, however.
-            txn->checkForInterrupt();
+        // Salvaging the record stores is the bulk of the work for a damaged database, and each
+        // collection's is independent of the others, so a pool of workers does it. The indexes of
+        // each repaired collection are then rebuilt here, under the lock held by the caller.
+        //
+        // Don't stop after starting to repair a collection otherwise we can leave data in an
+        // inconsistent state. An interrupt keeps the workers from starting on more collections,
+        // and the indexes of those already repaired are still rebuilt.
+        txn->checkForInterrupt();
 
-            log() << "Repairing collection " << *it;
+        ParallelRepair state(engine);
+        state.todo.assign(colls.begin(), colls.end());
+        const size_t numColls = state.todo.size();
+        const size_t workers = std::min(static_cast<size_t>(std::max(repairWorkerThreads, 1)),
+                                        numColls);
 
-            Status status = engine->repairRecordStore(txn, *it);
-            if (!status.isOK()) return status;
+        log() << "repairing " << numColls << " collections of " << dbName << " with "
+              << workers << " workers";
+        {
+            const std::string curopMessage = "repairDatabase: repairing collections of " + dbName;
+            ProgressMeterHolder progress(*txn->setMessage(curopMessage.c_str(),
+                                                          "Repair Progress",
+                                                          numColls));
+            boost::thread_group threads;
+            try {
+                for (size_t i = 0; i < workers; i++) {
+                    threads.create_thread(stdx::bind(&repairRecordStoreWorker, &state));
+                }
+            }
+            catch (const std::exception& ex) {
+                // Any workers which did start carry on through the whole queue.
+                warning() << "couldn't start repair worker: " << ex.what();
+                if (threads.size() == 0) {
+                    return Status(ErrorCodes::InternalError,
+                                  str::stream() << "couldn't start repair worker: " << ex.what());
+                }
+            }
 
-            status = rebuildIndexesOnCollection(txn, dbce, *it);
+            // The workers have no operation context of their own, so watch for a kill on theirs.
+            unsigned done = 0;
+            while (state.exited.load() < threads.size()) {
+                if (!txn->checkForInterruptNoAssert().isOK())
+                    state.stop.store(1);
+
+                const unsigned nowDone = state.done.load();
+                progress.hit(nowDone - done);
+                done = nowDone;
+                sleepmillis(10);
+            }
+            threads.join_all();
+            progress.finished();
+        }
+
+        for (size_t i = 0; i < state.repaired.size(); i++) {
+            Status status = rebuildIndexesOnCollection(txn, dbce, state.repaired[i]);
             if (!status.isOK()) return status;
 
             // TODO: uncomment once SERVER-16869
             // engine->flushAllFiles(true);
         }
 
+        if (!state.status.isOK())
+            return state.status;
+
+        txn->checkForInterrupt();
+
         return Status::OK();
     }
 }
@@ -39,15 +39,18 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/find_constants.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/repl/replication_coordinator_impl.h"
 #include "mongo/db/repl/rs_rollback.h"
 #include "mongo/db/repl/rs_sync.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -61,6 +64,10 @@ namespace {
     const int BatchIsSmallish = 40000; // bytes
 } // namespace
 
+    // The most getMores the producer keeps outstanding on its sync source's oplog, so that
+    // high latency links don't limit it to a batch per round trip.  1 turns pipelining off.
+    MONGO_EXPORT_SERVER_PARAMETER(replOplogFetcherMaxGetMoresInFlight, int, 4);
+
     MONGO_FP_DECLARE(rsBgSyncProduce);
 
     BackgroundSync* BackgroundSync::s_instance = 0;
@@ -108,6 +115,8 @@ namespace {
                                        _lastFetchedHash(0),
                                        _pause(true),
                                        _appliedBuffer(true),
+                                       _fetcherTuning(BatchIsSmallish,
+                                                      MaxBytesToReturnToClientAtOnce),
                                        _replCoord(getGlobalReplicationCoordinator()),
                                        _initialSyncRequestedFlag(false),
                                        _indexPrefetchConfig(PREFETCH_ALL) {
@@ -263,6 +272,13 @@ namespace {
             return;
         }
 
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _fetcherTuning.reset();
+        }
+        // When the producer started on the batch it is pushing into the buffer
+        unsigned long long batchStartMicros = curTimeMicros64();
+
         while (!inShutdown()) {
             if (!_syncSourceReader.moreInCurrentBatch()) {
                 // Check some things periodically
@@ -294,6 +310,21 @@ namespace {
                     return;
                 }
 
+                const long long headroomBytes =
+                    static_cast<long long>(_buffer.maxSize()) - _buffer.size();
+                const unsigned long long waitStartMicros = curTimeMicros64();
+                int getMoresInFlight;
+                int batchSize;
+                {
+                    boost::lock_guard<boost::mutex> lock(_mutex);
+                    _fetcherTuning.recordConsumed(waitStartMicros - batchStartMicros);
+                    _fetcherTuning.update(headroomBytes, replOplogFetcherMaxGetMoresInFlight);
+                    getMoresInFlight = _fetcherTuning.getMoresInFlight();
+                    batchSize = _fetcherTuning.batchSize();
+                }
+                _syncSourceReader.setGetMoresInFlight(getMoresInFlight);
+                _syncSourceReader.setBatchSize(batchSize);
+
                 {
                     //record time for each getmore
                     TimerHolder batchTimer(&getmoreReplStats);
@@ -302,7 +333,15 @@ namespace {
                     // It can wait up to five seconds for more data.
                     _syncSourceReader.more();
                 }
+                batchStartMicros = curTimeMicros64();
                 networkByteStats.increment(_syncSourceReader.currentBatchMessageSize());
+                {
+                    boost::lock_guard<boost::mutex> lock(_mutex);
+                    _fetcherTuning.recordBatch(_syncSourceReader.objsLeftInBatch(),
+                                               _syncSourceReader.currentBatchMessageSize(),
+                                               _syncSourceReader.lastGetMoreMicros(),
+                                               batchStartMicros - waitStartMicros);
+                }
 
                 if (!_syncSourceReader.moreInCurrentBatch()) {
                     // If there is still no data from upstream, check a few more things
@@ -359,6 +398,15 @@ namespace {
         }
     }
 
+    void BackgroundSync::appendOplogFetcherStats(BSONObjBuilder* builder) const {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        BSONObjBuilder stats(builder->subobjStart("oplogFetcher"));
+        stats.append("syncingTo", _syncSourceHost.toString());
+        _fetcherTuning.append(&stats);
+        stats.append("maxGetMoresInFlight", replOplogFetcherMaxGetMoresInFlight);
+        stats.done();
+    }
+
     bool BackgroundSync::shouldChangeSyncSource() {
         // is it even still around?
         if (getSyncTarget().empty() || _syncSourceReader.getHost().empty()) {
@@ -382,6 +430,10 @@ namespace {
         _buffer.blockingPeek(op, 1);
     }
 
+    bool BackgroundSync::isBufferEmpty() const {
+        return _buffer.empty();
+    }
+
     void BackgroundSync::consume() {
         // this is just to get the op off the queue, it's been peeked at
         // and queued for application already
@@ -31,6 +31,7 @@
 #include <boost/thread/mutex.hpp>
 
 #include "mongo/util/queue.h"
+#include "mongo/db/repl/oplog_fetcher_tuning.h"
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/jsobj.h"
 
@@ -98,9 +99,15 @@ namespace repl {
         virtual void clearSyncTarget();
         virtual void waitForMore();
 
+        // Returns true if every op fetched so far has been handed to the applier.
+        bool isBufferEmpty() const;
+
         // For monitoring
         BSONObj getCounters();
 
+        // Reports how the producer is fetching from its sync source, for replSetGetStatus
+        void appendOplogFetcherStats(BSONObjBuilder* builder) const;
+
         long long getLastAppliedHash() const;
         void setLastAppliedHash(long long oldH);
         void loadLastAppliedHash(OperationContext* txn);
@@ -143,6 +150,9 @@ namespace repl {
 
         HostAndPort _syncSourceHost;
 
+        // Pipelining and batch sizing of the getMores on the sync source's oplog
+        OplogFetcherTuning _fetcherTuning;
+
         BackgroundSync();
         BackgroundSync(const BackgroundSync& s);
         BackgroundSync operator=(const BackgroundSync& s);
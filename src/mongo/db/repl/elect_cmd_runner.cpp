@@ -84,7 +84,7 @@ namespace repl {
                         *it,
                         "admin",
                         replSetElectCmd,
-                        Milliseconds(30*1000)));   // trying to match current Socket timeout
+                        _rsConfig.getElectionTimeoutPeriodMillis()));
         }
 
         return requests;
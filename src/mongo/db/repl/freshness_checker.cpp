@@ -104,7 +104,7 @@ namespace repl {
                         *it,
                         "admin",
                         replSetFreshCmd,
-                        Milliseconds(30*1000)));   // trying to match current Socket timeout
+                        _rsConfig.getElectionTimeoutPeriodMillis()));
         }
 
         return requests;
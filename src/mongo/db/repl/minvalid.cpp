@@ -32,12 +32,15 @@
 
 #include "mongo/db/repl/minvalid.h"
 
+#include <boost/thread/mutex.hpp>
+
 #include "mongo/bson/optime.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/storage/recovery_unit.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -47,6 +50,28 @@ namespace {
     const char* initialSyncFlagString = "doingInitialSync";
     const BSONObj initialSyncFlag(BSON(initialSyncFlagString << true));
     const char* minvalidNS = "local.replset.minvalid";
+
+    // The minValid this process last stored, so advanceMinValid can tell when a write would
+    // not move it.  Only updated once the write has committed.
+    boost::mutex minValidCacheMutex;
+    bool minValidCached = false;
+    OpTime minValidCache;
+
+    class MinValidCacheUpdate : public RecoveryUnit::Change {
+    public:
+        explicit MinValidCacheUpdate(const OpTime& ts) : _ts(ts) {}
+
+        virtual void commit() {
+            boost::lock_guard<boost::mutex> lk(minValidCacheMutex);
+            minValidCached = true;
+            minValidCache = _ts;
+        }
+
+        virtual void rollback() {}
+
+    private:
+        const OpTime _ts;
+    };
 } // namespace
 
     void clearInitialSyncFlag(OperationContext* txn) {
@@ -77,7 +102,24 @@ namespace {
     void setMinValid(OperationContext* ctx, OpTime ts) {
         ScopedTransaction transaction(ctx, MODE_IX);
         Lock::DBLock lk(ctx->lockState(), "local", MODE_X);
+        WriteUnitOfWork wunit(ctx);
         Helpers::putSingleton(ctx, minvalidNS, BSON("$set" << BSON("ts" << ts)));
+        ctx->recoveryUnit()->registerChange(new MinValidCacheUpdate(ts));
+        wunit.commit();
+    }
+
+    bool advanceMinValid(OperationContext* txn, OpTime ts) {
+        // Holding the lock keeps other writers of minValid from changing it under the check.
+        ScopedTransaction transaction(txn, MODE_IX);
+        Lock::DBLock lk(txn->lockState(), "local", MODE_X);
+        {
+            boost::lock_guard<boost::mutex> cacheLk(minValidCacheMutex);
+            if (minValidCached && ts <= minValidCache) {
+                return false;
+            }
+        }
+        setMinValid(txn, ts);
+        return true;
     }
 
     OpTime getMinValid(OperationContext* txn) {
@@ -62,6 +62,14 @@ namespace repl {
      * before the minValid time.
      */
     void setMinValid(OperationContext* ctx, OpTime ts);
+
+    /**
+     * Sets minValid to 'ts' unless the value last stored by this process is already at or past
+     * it, so that a batch whose minValid was written ahead of time costs no write of its own.
+     * Like setMinValid, the write joins any WriteUnitOfWork the caller has open.  Returns
+     * whether it wrote.
+     */
+    bool advanceMinValid(OperationContext* txn, OpTime ts);
     OpTime getMinValid(OperationContext* txn);
 }
 }
@@ -55,9 +55,11 @@
 #include "mongo/db/ops/update_lifecycle_impl.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/repl/bgsync.h"
+#include "mongo/db/repl/oplog_compact.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/catalog/collection.h"
@@ -76,6 +78,17 @@ namespace mongo {
 
 namespace repl {
 
+    // Write replica set oplog entries in the compact format (see oplog_compact.h).  Readers
+    // decode either format, so members can differ on this.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(compactOplog, bool, false);
+
+    // Log the documents of a multi-document insert in as few oplog entries as possible (see
+    // logInsertOps()).  Members older than this one cannot apply such entries.
+    MONGO_EXPORT_SERVER_PARAMETER(oplogGroupInserts, bool, false);
+
+    // Largest total size of the documents grouped into one oplog entry
+    const int kMaxGroupedInsertBytes = 1024 * 1024;
+
 namespace {
     // cached copies of these...so don't rename them, drop them, etc.!!!
     Database* localDB = NULL;
@@ -152,8 +165,8 @@ namespace {
      */
     class OplogDocWriter : public DocWriter {
     public:
-        OplogDocWriter( const BSONObj& frame, const BSONObj& oField )
-            : _frame( frame ), _oField( oField ) {
+        OplogDocWriter( const BSONObj& frame, const BSONObj& oField, BSONType oType = Object )
+            : _frame( frame ), _oField( oField ), _oType( oType ) {
         }
 
         ~OplogDocWriter(){}
@@ -166,7 +179,7 @@ namespace {
             reinterpret_cast<int*>( buf )[0] = documentSize();
 
             buf += ( _frame.objsize() - 1 );
-            buf[0] = (char)Object;
+            buf[0] = (char)_oType;
             buf[1] = 'o';
             buf[2] = 0;
             memcpy( buf+3, _oField.objdata(), _oField.objsize() );
@@ -183,6 +196,7 @@ namespace {
     private:
         BSONObj _frame;
         BSONObj _oField;
+        BSONType _oType;
     };
 
     /* we write to local.oplog.rs:
@@ -202,16 +216,20 @@ namespace {
          if not null, specifies a boolean to pass along to the other side as b: param.
          used for "justOne" or "upsert" flags on 'd', 'u'
 
+       oType param:
+         Array for an "i" entry holding several documents (see logInsertOps())
+
     */
 
-    void _logOpRS(OperationContext* txn,
-                         const char *opstr,
-                         const char *ns,
-                         const char *logNS,
-                         const BSONObj& obj,
-                         BSONObj *o2,
-                         bool *bb,
-                         bool fromMigrate ) {
+    void _logOpRSOfType(OperationContext* txn,
+                        const char *opstr,
+                        const char *ns,
+                        const char *logNS,
+                        const BSONObj& obj,
+                        BSONType oType,
+                        BSONObj *o2,
+                        bool *bb,
+                        bool fromMigrate ) {
         if ( strncmp(ns, "local.", 6) == 0 ) {
             return;
         }
@@ -262,10 +280,21 @@ namespace {
             b.appendBool("b", *bb);
         if ( o2 )
             b.append("o2", *o2);
-        BSONObj partial = b.done();
+        if (compactOplog) {
+            // The compact entry is a new buffer anyway, so there is no copy to save.
+            if (oType == Array)
+                b.appendArray("o", obj);
+            else
+                b.append("o", obj);
+            const BSONObj entry = compactOplogEntry(b.done());
+            checkOplogInsert( localOplogRSCollection->insertDocument( txn, entry, false ) );
+        }
+        else {
+            BSONObj partial = b.done();
 
-        OplogDocWriter writer( partial, obj );
-        checkOplogInsert( localOplogRSCollection->insertDocument( txn, &writer, false ) );
+            OplogDocWriter writer( partial, obj, oType );
+            checkOplogInsert( localOplogRSCollection->insertDocument( txn, &writer, false ) );
+        }
 
         ctx.getClient()->setLastOp( slot.first );
 
@@ -273,6 +302,17 @@ namespace {
 
     }
 
+    void _logOpRS(OperationContext* txn,
+                         const char *opstr,
+                         const char *ns,
+                         const char *logNS,
+                         const BSONObj& obj,
+                         BSONObj *o2,
+                         bool *bb,
+                         bool fromMigrate ) {
+        _logOpRSOfType(txn, opstr, ns, logNS, obj, Object, o2, bb, fromMigrate);
+    }
+
     void _logOpOld(OperationContext* txn,
                           const char *opstr,
                           const char *ns,
@@ -360,20 +400,20 @@ namespace {
         _logOpRS(txn, "n", "", 0, obj, 0, 0, false);
     }
 
-    /*@ @param opstr:
-          c userCreateNS
-          i insert
-          n no-op / keepalive
-          d delete / remove
-          u update
-    */
-    void logOp(OperationContext* txn,
-               const char* opstr,
-               const char* ns,
-               const BSONObj& obj,
-               BSONObj* patt,
-               bool* b,
-               bool fromMigrate) {
+namespace {
+    /**
+     * Writes the oplog entry and tells the other listeners about the op.  For an "i" entry
+     * holding several documents 'oType' is Array, 'obj' is the array of documents, and the
+     * listeners hear about each document as its own insert.
+     */
+    void _logOpAndNotify(OperationContext* txn,
+                         const char* opstr,
+                         const char* ns,
+                         const BSONObj& obj,
+                         BSONType oType,
+                         BSONObj* patt,
+                         bool* b,
+                         bool fromMigrate) {
         try {
             // TODO SERVER-15192 remove this once all listeners are rollback-safe.
             class RollbackPreventer : public RecoveryUnit::Change {
@@ -385,17 +425,26 @@ namespace {
             };
             txn->recoveryUnit()->registerChange(new RollbackPreventer());
 
-            if ( getGlobalReplicationCoordinator()->isReplEnabled() ) {
+            if (oType == Array) {
+                // Only logInsertOps() groups documents, and only into a replica set oplog.
+                _logOpRSOfType(txn, opstr, ns, 0, obj, Array, patt, b, fromMigrate);
+            }
+            else if ( getGlobalReplicationCoordinator()->isReplEnabled() ) {
                 _logOp(txn, opstr, ns, 0, obj, patt, b, fromMigrate);
             }
 
-            logOpForSharding(txn, opstr, ns, obj, patt, fromMigrate);
-            logOpForDbHash(ns);
-            getGlobalAuthorizationManager()->logOp(opstr, ns, obj, patt, b);
+            BSONObjIterator docs(obj);
+            do {
+                const BSONObj doc = oType == Array ? docs.next().Obj() : obj;
 
-            if ( strstr( ns, ".system.js" ) ) {
-                Scope::storedFuncMod(); // this is terrible
-            }
+                logOpForSharding(txn, opstr, ns, doc, patt, fromMigrate);
+                logOpForDbHash(ns);
+                getGlobalAuthorizationManager()->logOp(opstr, ns, doc, patt, b);
+
+                if ( strstr( ns, ".system.js" ) ) {
+                    Scope::storedFuncMod(); // this is terrible
+                }
+            } while (oType == Array && docs.more());
         }
         catch (const DBException& ex) {
             severe() << "Fatal DBException in logOp(): " << ex.toString();
@@ -410,6 +459,97 @@ namespace {
             std::terminate();
         }
     }
+} // namespace
+
+    /*@ @param opstr:
+          c userCreateNS
+          i insert
+          n no-op / keepalive
+          d delete / remove
+          u update
+    */
+    void logOp(OperationContext* txn,
+               const char* opstr,
+               const char* ns,
+               const BSONObj& obj,
+               BSONObj* patt,
+               bool* b,
+               bool fromMigrate) {
+        _logOpAndNotify(txn, opstr, ns, obj, Object, patt, b, fromMigrate);
+    }
+
+    void logInsertOps(OperationContext* txn,
+                      const char* ns,
+                      const std::vector<BSONObj>& docs,
+                      bool fromMigrate) {
+        const bool group = oplogGroupInserts &&
+            getGlobalReplicationCoordinator()->getReplicationMode() ==
+                ReplicationCoordinator::modeReplSet &&
+            !nsToCollectionSubstring(ns).startsWith("system.");
+
+        size_t begin = 0;
+        while (begin < docs.size()) {
+            // Take documents while the entry stays under kMaxGroupedInsertBytes, but at least one
+            size_t end = begin + 1;
+            int bytes = docs[begin].objsize();
+            while (group &&
+                   end < docs.size() &&
+                   bytes + docs[end].objsize() <= kMaxGroupedInsertBytes) {
+                bytes += docs[end].objsize();
+                ++end;
+            }
+
+            if (end - begin == 1) {
+                logOp(txn, "i", ns, docs[begin], NULL, NULL, fromMigrate);
+            }
+            else {
+                BSONArrayBuilder arrayBuilder(bytes + 8 * static_cast<int>(end - begin) + 16);
+                for (size_t i = begin; i < end; ++i) {
+                    arrayBuilder.append(docs[i]);
+                }
+                _logOpAndNotify(txn, "i", ns, arrayBuilder.arr(), Array, NULL, NULL, fromMigrate);
+            }
+            begin = end;
+        }
+    }
+
+    bool isMultiInsertOp(const BSONObj& op) {
+        return op["o"].type() == Array && *op.getStringField("op") == 'i';
+    }
+
+namespace {
+    /**
+     * Inserts 'op' into local.oplog.rs, checking that it is newer than '*lastTs', which it then
+     * becomes.  The caller holds the local database lock in MODE_X.
+     */
+    void _insertOpObjRS(OperationContext* txn, const BSONObj& op, OpTime* lastTs) {
+        const OpTime ts = op["ts"]._opTime();
+
+        if ( localOplogRSCollection == 0 ) {
+            Client::Context ctx(txn, rsoplog);
+
+            localDB = ctx.db();
+            verify( localDB );
+            localOplogRSCollection = localDB->getCollection(rsoplog);
+            massert(13389,
+                    "local.oplog.rs missing. did you drop it? if so restart server",
+                    localOplogRSCollection);
+        }
+        Client::Context ctx(txn, rsoplog, localDB);
+        WriteUnitOfWork wunit(txn);
+        checkOplogInsert(localOplogRSCollection->insertDocument(
+                txn, compactOplog ? compactOplogEntry(op) : op, false));
+
+        if (!(*lastTs < ts)) {
+            severe() << "replication oplog stream went back in time. previous timestamp: "
+                     << *lastTs << " newest timestamp: " << ts << ". Op being applied: "
+                     << op;
+            fassertFailedNoTrace(18905);
+        }
+        wunit.commit();
+        *lastTs = ts;
+    }
+} // namespace
 
     /** write an op to the oplog that is already built.
         todo : make _logOpRS() call this so we don't repeat ourself?
@@ -422,47 +562,38 @@ namespace {
         ScopedTransaction transaction(txn, MODE_IX);
         Lock::DBLock lk(txn->lockState(), "local", MODE_X);
 
+        OpTime ts = getGlobalReplicationCoordinator()->getMyLastOptime();
+        // TODO(geert): soon this needs to be part of an outer WUOW not its own.
+        // We can't do this yet due to locking limitations.
+        _insertOpObjRS(txn, op, &ts);
+        _setLastAppliedOpRS(txn, op);
+        return ts;
+    }
+
+    OpTime _writeOpObjsRS(OperationContext* txn, const std::deque<BSONObj>& ops) {
+        ScopedTransaction transaction(txn, MODE_IX);
+        Lock::DBLock lk(txn->lockState(), "local", MODE_X);
+
+        OpTime ts = getGlobalReplicationCoordinator()->getMyLastOptime();
+        for (std::deque<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+            _insertOpObjRS(txn, *it, &ts);
+        }
+        return ts;
+    }
+
+    void _setLastAppliedOpRS(OperationContext* txn, const BSONObj& op) {
         const OpTime ts = op["ts"]._opTime();
-        long long hash = op["h"].numberLong();
-
-        {
-            if ( localOplogRSCollection == 0 ) {
-                Client::Context ctx(txn, rsoplog);
-
-                localDB = ctx.db();
-                verify( localDB );
-                localOplogRSCollection = localDB->getCollection(rsoplog);
-                massert(13389,
-                        "local.oplog.rs missing. did you drop it? if so restart server",
-                        localOplogRSCollection);
-            }
-            Client::Context ctx(txn, rsoplog, localDB);
-            // TODO(geert): soon this needs to be part of an outer WUOW not its own.
-            // We can't do this yet due to locking limitations.
-            WriteUnitOfWork wunit(txn);
-            checkOplogInsert(localOplogRSCollection->insertDocument(txn, op, false));
-
-            ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
-            OpTime myLastOptime = replCoord->getMyLastOptime();
-            if (!(myLastOptime < ts)) {
-                severe() << "replication oplog stream went back in time. previous timestamp: "
-                         << myLastOptime << " newest timestamp: " << ts << ". Op being applied: "
-                         << op;
-                fassertFailedNoTrace(18905);
-            }
-            wunit.commit();
 
-            BackgroundSync* bgsync = BackgroundSync::get();
-            // Keep this up-to-date, in case we step up to primary.
-            bgsync->setLastAppliedHash(hash);
+        // Keep this up-to-date, in case we step up to primary.
+        BackgroundSync::get()->setLastAppliedHash(op["h"].numberLong());
 
-            ctx.getClient()->setLastOp( ts );
+        txn->getClient()->setLastOp(ts);
 
-            replCoord->setMyLastOptime(ts);
-        }
+        // This only signals the sync source feedback thread, which reports our progress
+        // upstream on its own.
+        getGlobalReplicationCoordinator()->setMyLastOptime(ts);
 
         setNewOptime(ts);
-        return ts;
     }
 
     void createOplog(OperationContext* txn) {
@@ -549,6 +680,124 @@ namespace {
 
     // -------------------------------------
 
+namespace {
+    // Builds the indexes in 'specs', which are all on one collection, with one collection scan
+    void buildIndexes_inlock(OperationContext* txn,
+                             Database* db,
+                             const std::vector<BSONObj>& specs) {
+        if (specs[0]["background"].trueValue()) {
+            IndexBuilder* builder = new IndexBuilder(specs);
+            // This spawns a new thread and returns immediately.
+            builder->go();
+            // Wait for thread to start and register itself
+            Lock::TempRelease release(txn->lockState());
+            IndexBuilder::waitForBgIndexStarting();
+        }
+        else {
+            IndexBuilder builder(specs);
+            Status status = builder.buildInForeground(txn, db);
+            uassertStatusOK(status);
+        }
+    }
+} // namespace
+
+    void applyIndexBuildOps_inlock(OperationContext* txn,
+                                   Database* db,
+                                   const std::vector<BSONObj>& ops) {
+        std::vector<BSONObj> specs;
+        for (size_t i = 0; i < ops.size(); i++) {
+            LOG(3) << "applying op: " << ops[i];
+            replOpCounters.gotInsert();
+            specs.push_back(ops[i]["o"].Obj());
+        }
+        buildIndexes_inlock(txn, db, specs);
+    }
+
+namespace {
+    // Applies the insert of 'o' into 'ns' as an upsert, as we might get replayed more than once
+    void applyInsert_inlock(OperationContext* txn,
+                            Database* db,
+                            const char* ns,
+                            const BSONObj& o) {
+        OpDebug debug;
+        BSONElement _id;
+        if( !o.getObjectID(_id) ) {
+            /* No _id.  This will be very slow. */
+            Timer t;
+
+            const NamespaceString requestNs(ns);
+            UpdateRequest request(requestNs);
+
+            request.setQuery(o);
+            request.setUpdates(o);
+            request.setUpsert();
+            request.setFromReplication();
+            UpdateLifecycleImpl updateLifecycle(true, requestNs);
+            request.setLifecycle(&updateLifecycle);
+
+            update(txn, db, request, &debug);
+
+            if( t.millis() >= 2 ) {
+                RARELY OCCASIONALLY log() << "warning, repl doing slow updates (no _id field) for " << ns << endl;
+            }
+        }
+        else {
+            /* todo : it may be better to do an insert here, and then catch the dup key exception and do update
+                      then.  very few upserts will not be inserts...
+                      */
+            BSONObjBuilder b;
+            b.append(_id);
+
+            const NamespaceString requestNs(ns);
+            UpdateRequest request(requestNs);
+
+            request.setQuery(b.done());
+            request.setUpdates(o);
+            request.setUpsert();
+            request.setFromReplication();
+            UpdateLifecycleImpl updateLifecycle(true, requestNs);
+            request.setLifecycle(&updateLifecycle);
+
+            update(txn, db, request, &debug);
+        }
+    }
+
+    /**
+     * Applies an insert entry holding several documents.  When none of them are in the
+     * collection yet, which is the usual case, they go in through the batched insert path.
+     * Otherwise the entry is being replayed, and each document is applied as an upsert.
+     */
+    void applyMultiInsert_inlock(OperationContext* txn,
+                                 Database* db,
+                                 const char* ns,
+                                 Collection* collection,
+                                 const BSONObj& docsArray,
+                                 OpCounters* opCounters) {
+        std::vector<BSONObj> docs;
+        BSONForEach(elem, docsArray) {
+            opCounters->gotInsert();
+            docs.push_back(elem.Obj());
+        }
+
+        bool batched = collection &&
+                       !collection->isCapped() &&
+                       collection->getIndexCatalog()->haveIdIndex(txn);
+        for (size_t i = 0; batched && i < docs.size(); ++i) {
+            const BSONElement id = docs[i]["_id"];
+            batched = !id.eoo() && Helpers::findById(txn, collection, id.wrap()).isNull();
+        }
+
+        if (batched) {
+            uassertStatusOK(collection->insertDocuments(txn, docs, false));
+            return;
+        }
+
+        for (size_t i = 0; i < docs.size(); ++i) {
+            applyInsert_inlock(txn, db, ns, docs[i]);
+        }
+    }
+} // namespace
+
     /** @param fromRepl false if from ApplyOpsCmd
         @return true if was and update should have happened and the document DNE.  see replset initial sync code.
      */
@@ -600,68 +849,18 @@ namespace {
         // operation type -- see logOp() comments for types
         const char *opType = fieldOp.valuestrsafe();
 
-        if ( *opType == 'i' ) {
+        if ( *opType == 'i' && fieldO.type() == Array ) {
+            applyMultiInsert_inlock(txn, db, ns, collection, o, opCounters);
+        }
+        else if ( *opType == 'i' ) {
             opCounters->gotInsert();
 
             const char *p = strchr(ns, '.');
             if ( p && nsToCollectionSubstring( p ) == "system.indexes" ) {
-                if (o["background"].trueValue()) {
-                    IndexBuilder* builder = new IndexBuilder(o);
-                    // This spawns a new thread and returns immediately.
-                    builder->go();
-                    // Wait for thread to start and register itself
-                    Lock::TempRelease release(txn->lockState());
-                    IndexBuilder::waitForBgIndexStarting();
-                }
-                else {
-                    IndexBuilder builder(o);
-                    Status status = builder.buildInForeground(txn, db);
-                    uassertStatusOK(status);
-                }
+                buildIndexes_inlock(txn, db, std::vector<BSONObj>(1, o));
             }
             else {
-                // do upserts for inserts as we might get replayed more than once
-                OpDebug debug;
-                BSONElement _id;
-                if( !o.getObjectID(_id) ) {
-                    /* No _id.  This will be very slow. */
-                    Timer t;
-
-                    const NamespaceString requestNs(ns);
-                    UpdateRequest request(requestNs);
-
-                    request.setQuery(o);
-                    request.setUpdates(o);
-                    request.setUpsert();
-                    request.setFromReplication();
-                    UpdateLifecycleImpl updateLifecycle(true, requestNs);
-                    request.setLifecycle(&updateLifecycle);
-
-                    update(txn, db, request, &debug);
-
-                    if( t.millis() >= 2 ) {
-                        RARELY OCCASIONALLY log() << "warning, repl doing slow updates (no _id field) for " << ns << endl;
-                    }
-                }
-                else {
-                    /* todo : it may be better to do an insert here, and then catch the dup key exception and do update
-                              then.  very few upserts will not be inserts...
-                              */
-                    BSONObjBuilder b;
-                    b.append(_id);
-
-                    const NamespaceString requestNs(ns);
-                    UpdateRequest request(requestNs);
-
-                    request.setQuery(b.done());
-                    request.setUpdates(o);
-                    request.setUpsert();
-                    request.setFromReplication();
-                    UpdateLifecycleImpl updateLifecycle(true, requestNs);
-                    request.setLifecycle(&updateLifecycle);
-
-                    update(txn, db, request, &debug);
-                }
+                applyInsert_inlock(txn, db, ns, o);
             }
         }
         else if ( *opType == 'u' ) {
@@ -771,12 +970,15 @@ namespace {
         else {
             throw MsgAssertionException( 14825 , ErrorMsg("error in applyOperation : unknown opType ", *opType) );
         }
-        getGlobalAuthorizationManager()->logOp(
-                opType,
-                ns,
-                o,
-                fieldO2.isABSONObj() ? &o2 : NULL,
-                !fieldB.eoo() ? &valueB : NULL );
+        BSONObjIterator inserted(o);
+        do {
+            getGlobalAuthorizationManager()->logOp(
+                    opType,
+                    ns,
+                    fieldO.type() == Array ? inserted.next().Obj() : o,
+                    fieldO2.isABSONObj() ? &o2 : NULL,
+                    !fieldB.eoo() ? &valueB : NULL );
+        } while (fieldO.type() == Array && inserted.more());
         return failedUpdate;
     }
 
@@ -29,7 +29,9 @@
 #pragma once
 
 #include <cstddef>
+#include <deque>
 #include <string>
+#include <vector>
 
 namespace mongo {
     class BSONObj;
@@ -52,6 +54,16 @@ namespace repl {
     // Returns the newly-generated optime for the applied op.
     OpTime _logOpObjRS(OperationContext* txn, const BSONObj& op);
 
+    // Writes ops which have already been applied into the replica-set oplog, in order, as part
+    // of the caller's WriteUnitOfWork.  Unlike _logOpObjRS this publishes nothing: once the
+    // unit of work has committed, pass the last op to _setLastAppliedOpRS.
+    // Returns the optime of the last op.
+    OpTime _writeOpObjsRS(OperationContext* txn, const std::deque<BSONObj>& ops);
+
+    // Makes 'op' the last op applied: advances the replication coordinator's optime, which
+    // signals sync source feedback, the global optime, and the hash kept for stepping up.
+    void _setLastAppliedOpRS(OperationContext* txn, const BSONObj& op);
+
     const char rsoplog[] = "local.oplog.rs";
     static const int OPLOG_VERSION = 2;
 
@@ -79,6 +91,25 @@ namespace repl {
                 bool *b = NULL,
                 bool fromMigrate = false);
 
+    /**
+     * Logs the insertion of 'docs' into 'ns', all in the caller's unit of work.
+     *
+     * With the oplogGroupInserts server parameter set, a replica set primary logs the documents
+     * in as few "i" entries as it can, each holding an array of documents in its "o" field
+     * rather than a single one.  Otherwise, or for system collections, this is the same as
+     * calling logOp() for each document.
+     */
+    void logInsertOps(OperationContext* txn,
+                      const char* ns,
+                      const std::vector<BSONObj>& docs,
+                      bool fromMigrate = false);
+
+    /**
+     * Returns true if 'op' is an insert entry logged by logInsertOps() that holds several
+     * documents.
+     */
+    bool isMultiInsertOp(const BSONObj& op);
+
     // Log an empty no-op operation to the local oplog
     void logKeepalive(OperationContext* txn);
 
@@ -108,6 +139,15 @@ namespace repl {
                                bool fromRepl = true,
                                bool convertUpdateToUpsert = false);
 
+    /**
+     * Applies 'ops', inserts into system.indexes from the oplog which build indexes on the same
+     * collection and are all foreground or all background builds, building the indexes with
+     * one collection scan.
+     */
+    void applyIndexBuildOps_inlock(OperationContext* txn,
+                                   Database* db,
+                                   const std::vector<BSONObj>& ops);
+
     /**
      * Waits one second for the OpTime from the oplog to change.
      */
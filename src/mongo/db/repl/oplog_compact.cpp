@@ -0,0 +1,245 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_compact.h"
+
+#include <cstring>
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+    const char kPayloadFieldName[] = "c";
+
+    // Bits of the flags byte that starts the payload
+    const unsigned char kHasO2 = 1 << 0;
+    const unsigned char kHasB = 1 << 1;
+    const unsigned char kBValue = 1 << 2;
+    const unsigned char kFromMigrate = 1 << 3;
+    const unsigned char kCompressed = 1 << 4;
+    const unsigned char kOIsArray = 1 << 5;
+
+    // Objects smaller than this rarely shrink enough to pay for the decompression
+    const int kMinCompressBytes = 256;
+
+    void appendVarint(BufBuilder& b, unsigned long long value) {
+        while (value >= 0x80) {
+            b.appendUChar(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        b.appendUChar(static_cast<unsigned char>(value));
+    }
+
+    void appendString(BufBuilder& b, const StringData& str) {
+        appendVarint(b, str.size());
+        b.appendStr(str, false);
+    }
+
+    /**
+     * Reads the pieces of a payload, throwing if it runs out before they do.
+     */
+    class PayloadReader {
+    public:
+        PayloadReader(const char* data, size_t len) : _pos(data), _end(data + len) { }
+
+        bool atEnd() const { return _pos == _end; }
+
+        unsigned char readByte() {
+            check(1);
+            return static_cast<unsigned char>(*_pos++);
+        }
+
+        unsigned long long readVarint() {
+            unsigned long long value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const unsigned char byte = readByte();
+                value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    return value;
+                }
+            }
+            uasserted(28619, "corrupt compact oplog entry: varint too long");
+            return 0;
+        }
+
+        StringData readString() {
+            const unsigned long long len = readVarint();
+            check(len);
+            const StringData str(_pos, len);
+            _pos += len;
+            return str;
+        }
+
+        BSONObj readObj() {
+            check(sizeof(int));
+            int size;
+            std::memcpy(&size, _pos, sizeof(int));
+            uassert(28620,
+                    str::stream() << "corrupt compact oplog entry: bad object size " << size,
+                    size >= BSONObj().objsize());
+            check(size);
+            const BSONObj obj(_pos);
+            _pos += size;
+            return obj;
+        }
+
+        const char* pos() const { return _pos; }
+        size_t remaining() const { return _end - _pos; }
+
+    private:
+        void check(unsigned long long needed) const {
+            uassert(28621,
+                    "corrupt compact oplog entry: payload truncated",
+                    needed <= static_cast<unsigned long long>(_end - _pos));
+        }
+
+        const char* _pos;
+        const char* _end;
+    };
+
+} // namespace
+
+    BSONObj compactOplogEntry(const BSONObj& entry) {
+        if (isCompactOplogEntry(entry))
+            return entry;
+
+        const char* names[] = { "ts", "h", "op", "ns", "fromMigrate", "b", "o2", "o" };
+        BSONElement fields[8];
+        entry.getFields(8, names, fields);
+        const BSONElement& ts = fields[0];
+        const BSONElement& h = fields[1];
+        const BSONElement& b = fields[5];
+        const BSONElement& o2 = fields[6];
+        const BSONElement& o = fields[7];
+
+        unsigned char flags = 0;
+        if (fields[4].trueValue())
+            flags |= kFromMigrate;
+        if (!b.eoo()) {
+            flags |= kHasB;
+            if (b.trueValue())
+                flags |= kBValue;
+        }
+
+        BufBuilder body;
+        if (o2.isABSONObj()) {
+            flags |= kHasO2;
+            const BSONObj o2Obj = o2.Obj();
+            body.appendBuf(o2Obj.objdata(), o2Obj.objsize());
+        }
+        if (o.type() == Array)
+            flags |= kOIsArray;
+        const BSONObj oObj = o.isABSONObj() ? o.embeddedObject() : BSONObj();
+        body.appendBuf(oObj.objdata(), oObj.objsize());
+
+        std::string compressed;
+        if (body.len() >= kMinCompressBytes) {
+            compress(body.buf(), body.len(), &compressed);
+            if (compressed.size() < static_cast<size_t>(body.len()))
+                flags |= kCompressed;
+        }
+
+        BufBuilder payload(body.len() + 64);
+        payload.appendUChar(flags);
+        appendString(payload, fields[2].valuestrsafe());
+        appendString(payload, fields[3].valuestrsafe());
+        if (flags & kCompressed)
+            payload.appendBuf(compressed.data(), compressed.size());
+        else
+            payload.appendBuf(body.buf(), body.len());
+
+        BSONObjBuilder out(payload.len() + 64);
+        out.append(ts);
+        out.append(h);
+        out.append("v", kCompactOplogVersion);
+        out.appendBinData(kPayloadFieldName, payload.len(), BinDataGeneral, payload.buf());
+        return out.obj();
+    }
+
+    bool isCompactOplogEntry(const BSONObj& entry) {
+        return entry[kPayloadFieldName].type() == BinData &&
+               entry["v"].numberInt() == kCompactOplogVersion;
+    }
+
+    BSONObj expandOplogEntry(const BSONObj& entry) {
+        if (!isCompactOplogEntry(entry))
+            return entry;
+
+        int len;
+        const char* data = entry[kPayloadFieldName].binData(len);
+        PayloadReader reader(data, len);
+
+        const unsigned char flags = reader.readByte();
+        const StringData op = reader.readString();
+        const StringData ns = reader.readString();
+
+        std::string uncompressed;
+        PayloadReader bodyReader(reader.pos(), reader.remaining());
+        if (flags & kCompressed) {
+            uassert(28622,
+                    "corrupt compact oplog entry: cannot decompress",
+                    uncompress(reader.pos(), reader.remaining(), &uncompressed));
+            bodyReader = PayloadReader(uncompressed.data(), uncompressed.size());
+        }
+
+        BSONObj o2;
+        if (flags & kHasO2)
+            o2 = bodyReader.readObj();
+        const BSONObj o = bodyReader.readObj();
+        uassert(28623, "corrupt compact oplog entry: trailing bytes", bodyReader.atEnd());
+
+        BSONObjBuilder out(len + 128);
+        out.append(entry["ts"]);
+        out.append(entry["h"]);
+        out.append("v", OPLOG_VERSION);
+        out.append("op", op);
+        out.append("ns", ns);
+        if (flags & kFromMigrate)
+            out.appendBool("fromMigrate", true);
+        if (flags & kHasB)
+            out.appendBool("b", (flags & kBValue) != 0);
+        if (flags & kHasO2)
+            out.append("o2", o2);
+        if (flags & kOIsArray)
+            out.appendArray("o", o);
+        else
+            out.append("o", o);
+        return out.obj();
+    }
+
+} // namespace repl
+} // namespace mongo
@@ -0,0 +1,69 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    class BSONObj;
+
+namespace repl {
+
+    /**
+     * Value of the "v" field of an oplog entry in the compact format.
+     */
+    const int kCompactOplogVersion = 3;
+
+    /**
+     * Rewrites the replica set oplog entry 'entry' in the compact format:
+     *
+     *     { ts: <Timestamp>, h: <NumberLong>, v: 3, c: <BinData> }
+     *
+     * "ts" and "h" stay top-level fields so that oplog scans, rollback's common point search and
+     * the optime bookkeeping can read them without decoding anything.  Everything else is packed
+     * into "c": a flags byte, the op and namespace as varint-length-prefixed strings, then the
+     * "o2" and "o" objects back to back, snappy-compressed when that makes them smaller.
+     *
+     * 'entry' must have the fields _logOpRS writes.  Entries already in the compact format are
+     * returned as is.
+     */
+    BSONObj compactOplogEntry(const BSONObj& entry);
+
+    /**
+     * Returns true if 'entry' is in the compact format.
+     */
+    bool isCompactOplogEntry(const BSONObj& entry);
+
+    /**
+     * Returns 'entry' as a regular oplog entry, with the same fields in the same order as
+     * _logOpRS would have written it.  Entries not in the compact format are returned as is.
+     * Throws if the "c" field is corrupt.
+     */
+    BSONObj expandOplogEntry(const BSONObj& entry);
+
+} // namespace repl
+} // namespace mongo
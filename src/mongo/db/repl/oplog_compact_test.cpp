@@ -0,0 +1,126 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_compact.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/assert_util.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::OpTime;
+    using mongo::UserException;
+    using mongo::repl::compactOplogEntry;
+    using mongo::repl::expandOplogEntry;
+    using mongo::repl::isCompactOplogEntry;
+
+    BSONObj makeEntry(const char* op, const BSONObj& o, const BSONObj* o2, const bool* b) {
+        BSONObjBuilder builder;
+        builder.appendTimestamp("ts", OpTime(1234, 5).asDate());
+        builder.append("h", 987654321LL);
+        builder.append("v", mongo::repl::OPLOG_VERSION);
+        builder.append("op", op);
+        builder.append("ns", "test.coll");
+        if (b)
+            builder.appendBool("b", *b);
+        if (o2)
+            builder.append("o2", *o2);
+        builder.append("o", o);
+        return builder.obj();
+    }
+
+    TEST(OplogCompact, InsertRoundTrips) {
+        const BSONObj entry = makeEntry("i", BSON("_id" << 1 << "x" << "hello"), NULL, NULL);
+        const BSONObj compact = compactOplogEntry(entry);
+        ASSERT_TRUE(isCompactOplogEntry(compact));
+        ASSERT_FALSE(isCompactOplogEntry(entry));
+        ASSERT_EQUALS(entry["ts"].timestampValue(), compact["ts"].timestampValue());
+        ASSERT_EQUALS(entry["h"].numberLong(), compact["h"].numberLong());
+        ASSERT_EQUALS(entry, expandOplogEntry(compact));
+    }
+
+    TEST(OplogCompact, UpdateWithCriteriaAndFlagRoundTrips) {
+        const BSONObj o2 = BSON("_id" << 1);
+        const bool upsert = true;
+        const BSONObj entry = makeEntry("u", BSON("$set" << BSON("x" << 2)), &o2, &upsert);
+        ASSERT_EQUALS(entry, expandOplogEntry(compactOplogEntry(entry)));
+    }
+
+    TEST(OplogCompact, InsertOfSeveralDocumentsRoundTrips) {
+        BSONObjBuilder builder;
+        builder.appendTimestamp("ts", OpTime(1234, 5).asDate());
+        builder.append("h", 987654321LL);
+        builder.append("v", mongo::repl::OPLOG_VERSION);
+        builder.append("op", "i");
+        builder.append("ns", "test.coll");
+        builder.append("o", BSON_ARRAY(BSON("_id" << 1) << BSON("_id" << 2)));
+        const BSONObj entry = builder.obj();
+
+        const BSONObj expanded = expandOplogEntry(compactOplogEntry(entry));
+        ASSERT_EQUALS(mongo::Array, expanded["o"].type());
+        ASSERT_EQUALS(entry, expanded);
+    }
+
+    TEST(OplogCompact, LargeDocumentIsCompressed) {
+        const std::string filler(10 * 1000, 'a');
+        const BSONObj entry = makeEntry("i", BSON("_id" << 1 << "filler" << filler), NULL, NULL);
+        const BSONObj compact = compactOplogEntry(entry);
+        ASSERT_LESS_THAN(compact.objsize(), entry.objsize() / 10);
+        ASSERT_EQUALS(entry, expandOplogEntry(compact));
+    }
+
+    TEST(OplogCompact, ExpandLeavesRegularEntriesAlone) {
+        const BSONObj entry = makeEntry("d", BSON("_id" << 1), NULL, NULL);
+        ASSERT_EQUALS(entry.objdata(), expandOplogEntry(entry).objdata());
+    }
+
+    TEST(OplogCompact, CompactLeavesCompactEntriesAlone) {
+        const BSONObj compact = compactOplogEntry(makeEntry("n", BSONObj(), NULL, NULL));
+        ASSERT_EQUALS(compact.objdata(), compactOplogEntry(compact).objdata());
+    }
+
+    TEST(OplogCompact, TruncatedPayloadThrows) {
+        const BSONObj compact = compactOplogEntry(makeEntry("i", BSON("_id" << 1), NULL, NULL));
+        int len;
+        const char* payload = compact["c"].binData(len);
+
+        BSONObjBuilder builder;
+        builder.append(compact["ts"]);
+        builder.append(compact["h"]);
+        builder.append(compact["v"]);
+        builder.appendBinData("c", len - 3, mongo::BinDataGeneral, payload);
+        ASSERT_THROWS(expandOplogEntry(builder.obj()), UserException);
+    }
+
+} // namespace
@@ -0,0 +1,141 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_fetcher_tuning.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+    // Weight of the newest sample in the moving averages
+    const double kSampleWeight = 0.2;
+
+    // The server treats a getMore batch size of 1 like a limit
+    const int kMinBatchSize = 2;
+
+    void addSample(double* average, double sample) {
+        if (*average < 0) {
+            *average = sample;
+        }
+        else {
+            *average += kSampleWeight * (sample - *average);
+        }
+    }
+
+    double sampleOrZero(double average) {
+        return average < 0 ? 0 : average;
+    }
+
+} // namespace
+
+    OplogFetcherTuning::OplogFetcherTuning(int smallBatchBytes, int maxBatchBytes)
+        : _smallBatchBytes(smallBatchBytes), _maxBatchBytes(maxBatchBytes) {
+        reset();
+    }
+
+    void OplogFetcherTuning::reset() {
+        _getMoresInFlight = 1;
+        _batchSize = 0;
+        _batches = 0;
+        _caughtUp = false;
+        _latencyMicros = -1;
+        _waitMicros = -1;
+        _consumeMicros = -1;
+        _opBytes = -1;
+        _bytesPerSec = -1;
+        _opsPerSec = -1;
+        _lastConsumeMicros = 0;
+    }
+
+    void OplogFetcherTuning::recordBatch(int numOps,
+                                         int bytes,
+                                         long long latencyMicros,
+                                         long long waitMicros) {
+        _batches++;
+        _caughtUp = bytes < _smallBatchBytes;
+        if (!_caughtUp) {
+            addSample(&_latencyMicros, latencyMicros);
+        }
+        addSample(&_waitMicros, waitMicros);
+        if (numOps > 0) {
+            addSample(&_opBytes, static_cast<double>(bytes) / numOps);
+        }
+
+        // About the time since the previous batch arrived
+        const long long elapsedMicros = _lastConsumeMicros + waitMicros;
+        if (elapsedMicros > 0) {
+            addSample(&_bytesPerSec, bytes * 1000000.0 / elapsedMicros);
+            addSample(&_opsPerSec, numOps * 1000000.0 / elapsedMicros);
+        }
+    }
+
+    void OplogFetcherTuning::recordConsumed(long long micros) {
+        addSample(&_consumeMicros, micros);
+        _lastConsumeMicros = micros;
+    }
+
+    void OplogFetcherTuning::update(long long bufferHeadroomBytes, int maxInFlight) {
+        _getMoresInFlight = 1;
+        if (maxInFlight > 1 && _latencyMicros > 0 && !_caughtUp) {
+            const double consumeMicros = std::max(_consumeMicros, 1.0);
+            const double needed = std::ceil(_latencyMicros / consumeMicros);
+            _getMoresInFlight = static_cast<int>(std::min(needed, static_cast<double>(maxInFlight)));
+            _getMoresInFlight = std::max(_getMoresInFlight, 1);
+        }
+
+        _batchSize = 0;
+        const long long wanted = static_cast<long long>(_getMoresInFlight) * _maxBatchBytes;
+        if (_opBytes > 0 && bufferHeadroomBytes < wanted) {
+            const double ops =
+                std::max(bufferHeadroomBytes, 0LL) / _getMoresInFlight / _opBytes;
+            _batchSize = std::max(kMinBatchSize, static_cast<int>(ops));
+        }
+    }
+
+    void OplogFetcherTuning::append(BSONObjBuilder* builder) const {
+        builder->append("getMoresInFlight", _getMoresInFlight);
+        builder->append("batchSize", _batchSize);
+        builder->appendNumber("batches", _batches);
+        builder->append("latencyMillis", sampleOrZero(_latencyMicros) / 1000);
+        builder->append("waitMillis", sampleOrZero(_waitMicros) / 1000);
+        builder->append("consumeMillis", sampleOrZero(_consumeMicros) / 1000);
+        builder->appendNumber("bytesPerSec",
+                              static_cast<long long>(sampleOrZero(_bytesPerSec)));
+        builder->appendNumber("opsPerSec", static_cast<long long>(sampleOrZero(_opsPerSec)));
+    }
+
+} // namespace repl
+} // namespace mongo
@@ -0,0 +1,106 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#pragma once
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+namespace repl {
+
+    /**
+     * Decides how the background sync producer fetches batches from its sync source's oplog:
+     * how many getMores to keep in flight, and how many ops to ask for in each.
+     *
+     * Enough getMores need to be in flight that a reply arrives about as often as the producer
+     * finishes with a batch, so the number follows the ratio of the getMore latency to the time
+     * the producer spends on a batch.  Once the producer has caught up there's nothing to fetch
+     * ahead, so it goes back to one getMore at a time.  Batches are left at the server's default size unless the
+     * buffer is too full to take that much from every getMore in flight.
+     *
+     * Not thread safe.
+     */
+    class OplogFetcherTuning {
+    public:
+        /**
+         * Batches under 'smallBatchBytes' mean the server had to wait for new ops, so their
+         * latency is not a round trip.  'maxBatchBytes' is the most the server returns to one
+         * getMore.
+         */
+        OplogFetcherTuning(int smallBatchBytes, int maxBatchBytes);
+
+        /** Starts over, for a new sync source. */
+        void reset();
+
+        /**
+         * Records a batch of 'numOps' ops taking 'bytes', whose getMore took 'latencyMicros'
+         * to be answered, and for which the producer waited 'waitMicros'.
+         */
+        void recordBatch(int numOps, int bytes, long long latencyMicros, long long waitMicros);
+
+        /** Records that the producer spent 'micros' on the last batch before asking for more. */
+        void recordConsumed(long long micros);
+
+        /**
+         * Recomputes getMoresInFlight() and batchSize() for the next getMore, given the room
+         * left in the buffer.  At most 'maxInFlight' getMores are kept in flight.
+         */
+        void update(long long bufferHeadroomBytes, int maxInFlight);
+
+        int getMoresInFlight() const { return _getMoresInFlight; }
+
+        /** In ops; 0 lets the server decide. */
+        int batchSize() const { return _batchSize; }
+
+        void append(BSONObjBuilder* builder) const;
+
+    private:
+        const int _smallBatchBytes;
+        const int _maxBatchBytes;
+
+        int _getMoresInFlight;
+        int _batchSize;
+
+        long long _batches;
+        // The last batch was small: the sync source had no more ops to send
+        bool _caughtUp;
+        // Moving averages; negative until there's a sample
+        double _latencyMicros;
+        double _waitMicros;
+        double _consumeMicros;
+        double _opBytes;
+        double _bytesPerSec;
+        double _opsPerSec;
+
+        // The consume time of the batch whose throughput is recorded next
+        long long _lastConsumeMicros;
+    };
+
+} // namespace repl
+} // namespace mongo
@@ -0,0 +1,144 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_fetcher_tuning.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::repl::OplogFetcherTuning;
+
+    const int kSmallBatchBytes = 40 * 1000;
+    const int kMaxBatchBytes = 4 * 1024 * 1024;
+    const long long kLotsOfHeadroom = 256 * 1024 * 1024;
+
+    TEST(OplogFetcherTuning, StartsWithOneGetMoreOfDefaultSize) {
+        OplogFetcherTuning tuning(kSmallBatchBytes, kMaxBatchBytes);
+        tuning.update(kLotsOfHeadroom, 8);
+        ASSERT_EQUALS(1, tuning.getMoresInFlight());
+        ASSERT_EQUALS(0, tuning.batchSize());
+    }
+
+    TEST(OplogFetcherTuning, KeepsEnoughInFlightToCoverLatency) {
+        OplogFetcherTuning tuning(kSmallBatchBytes, kMaxBatchBytes);
+        // 30ms round trips for batches the producer gets through in 10ms
+        tuning.recordConsumed(10 * 1000);
+        tuning.recordBatch(1000, 1000 * 1000, 30 * 1000, 25 * 1000);
+        tuning.update(kLotsOfHeadroom, 8);
+        ASSERT_EQUALS(3, tuning.getMoresInFlight());
+
+        tuning.update(kLotsOfHeadroom, 2);
+        ASSERT_EQUALS(2, tuning.getMoresInFlight());
+
+        tuning.update(kLotsOfHeadroom, 1);
+        ASSERT_EQUALS(1, tuning.getMoresInFlight());
+    }
+
+    TEST(OplogFetcherTuning, SmallBatchesAreNotRoundTrips) {
+        OplogFetcherTuning tuning(kSmallBatchBytes, kMaxBatchBytes);
+        // Caught up: the server held each getMore until there was a new op
+        tuning.recordConsumed(100);
+        tuning.recordBatch(1, 200, 1000 * 1000, 1000 * 1000);
+        tuning.update(kLotsOfHeadroom, 8);
+        ASSERT_EQUALS(1, tuning.getMoresInFlight());
+
+        BSONObjBuilder builder;
+        tuning.append(&builder);
+        ASSERT_EQUALS(0.0, builder.obj()["latencyMillis"].numberDouble());
+    }
+
+    TEST(OplogFetcherTuning, StopsPipeliningOnceCaughtUp) {
+        OplogFetcherTuning tuning(kSmallBatchBytes, kMaxBatchBytes);
+        tuning.recordConsumed(10 * 1000);
+        tuning.recordBatch(1000, 1000 * 1000, 30 * 1000, 25 * 1000);
+        tuning.update(kLotsOfHeadroom, 8);
+        ASSERT_EQUALS(3, tuning.getMoresInFlight());
+
+        tuning.recordConsumed(100);
+        tuning.recordBatch(1, 200, 1000 * 1000, 1000 * 1000);
+        tuning.update(kLotsOfHeadroom, 8);
+        ASSERT_EQUALS(1, tuning.getMoresInFlight());
+
+        // Falling behind again
+        tuning.recordConsumed(10 * 1000);
+        tuning.recordBatch(1000, 1000 * 1000, 30 * 1000, 25 * 1000);
+        tuning.update(kLotsOfHeadroom, 8);
+        ASSERT_LESS_THAN(1, tuning.getMoresInFlight());
+    }
+
+    TEST(OplogFetcherTuning, ShrinksBatchesWhenBufferIsFilling) {
+        OplogFetcherTuning tuning(kSmallBatchBytes, kMaxBatchBytes);
+        tuning.recordConsumed(10 * 1000);
+        tuning.recordBatch(1000, 1000 * 1000, 20 * 1000, 20 * 1000);
+        tuning.update(kLotsOfHeadroom, 2);
+        ASSERT_EQUALS(2, tuning.getMoresInFlight());
+        ASSERT_EQUALS(0, tuning.batchSize());
+
+        // Room for 2000 ops of 1000 bytes, split between two getMores
+        tuning.update(2 * 1000 * 1000, 2);
+        ASSERT_EQUALS(1000, tuning.batchSize());
+
+        // Always ask for something
+        tuning.update(0, 2);
+        ASSERT_EQUALS(2, tuning.batchSize());
+    }
+
+    TEST(OplogFetcherTuning, ResetForgetsSamples) {
+        OplogFetcherTuning tuning(kSmallBatchBytes, kMaxBatchBytes);
+        tuning.recordConsumed(10 * 1000);
+        tuning.recordBatch(1000, 1000 * 1000, 30 * 1000, 25 * 1000);
+        tuning.reset();
+        tuning.update(0, 8);
+        ASSERT_EQUALS(1, tuning.getMoresInFlight());
+        ASSERT_EQUALS(0, tuning.batchSize());
+    }
+
+    TEST(OplogFetcherTuning, ReportsThroughputAndLatency) {
+        OplogFetcherTuning tuning(kSmallBatchBytes, kMaxBatchBytes);
+        tuning.recordConsumed(10 * 1000);
+        tuning.recordBatch(1000, 1000 * 1000, 30 * 1000, 40 * 1000);
+        tuning.update(kLotsOfHeadroom, 8);
+
+        BSONObjBuilder builder;
+        tuning.append(&builder);
+        const BSONObj stats = builder.obj();
+        ASSERT_EQUALS(3, stats["getMoresInFlight"].numberInt());
+        ASSERT_EQUALS(1, stats["batches"].numberLong());
+        ASSERT_EQUALS(30.0, stats["latencyMillis"].numberDouble());
+        ASSERT_EQUALS(40.0, stats["waitMillis"].numberDouble());
+        // 1000 ops and 1MB in the 50ms since the previous batch
+        ASSERT_EQUALS(20 * 1000 * 1000, stats["bytesPerSec"].numberLong());
+        ASSERT_EQUALS(20 * 1000, stats["opsPerSec"].numberLong());
+    }
+
+} // namespace
@@ -35,6 +35,7 @@
 
 #include "mongo/client/constants.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/db/repl/oplog_compact.h"
 #include "mongo/util/net/hostandport.h"
 
 namespace mongo {
@@ -53,6 +54,8 @@ namespace repl {
 
     /* started abstracting out the querying of the primary/master's oplog
        still fairly awkward but a start.
+
+       Entries the sync source wrote in the compact format come back expanded.
     */
 
     class OplogReader {
@@ -75,7 +78,7 @@ namespace repl {
         }
         DBClientConnection* conn() { return _conn.get(); }
         BSONObj findOne(const char *ns, const Query& q) {
-            return conn()->findOne(ns, q, 0, QueryOption_SlaveOk);
+            return expandOplogEntry(conn()->findOne(ns, q, 0, QueryOption_SlaveOk));
         }
         BSONObj getLastOp(const char *ns) {
             return findOne(ns, Query().sort(reverseNaturalObj));
@@ -123,15 +126,25 @@ namespace repl {
             return cursor->getMessage()->size();
         }
 
+        int objsLeftInBatch() const { return cursor->objsLeftInBatch(); }
+
+        /** See DBClientCursor::setGetMoresInFlight(). */
+        void setGetMoresInFlight(int n) { cursor->setGetMoresInFlight(n); }
+        void setBatchSize(int n) { cursor->setBatchSize(n); }
+        long long lastGetMoreMicros() const { return cursor->lastGetMoreMicros(); }
+
         int getTailingQueryOptions() const { return _tailingQueryOptions; }
         void setTailingQueryOptions( int tailingQueryOptions ) { _tailingQueryOptions = tailingQueryOptions; }
 
         void peek(std::vector<BSONObj>& v, int n) {
-            if( cursor.get() )
+            if( cursor.get() ) {
                 cursor->peek(v,n);
+                for (size_t i = 0; i < v.size(); i++)
+                    v[i] = expandOplogEntry(v[i]);
+            }
         }
-        BSONObj nextSafe() { return cursor->nextSafe(); }
-        BSONObj next() { return cursor->next(); }
+        BSONObj nextSafe() { return expandOplogEntry(cursor->nextSafe()); }
+        BSONObj next() { return expandOplogEntry(cursor->next()); }
         void putBack(BSONObj op) { cursor->putBack(op); }
 
         HostAndPort getHost() const;
@@ -46,6 +46,7 @@ namespace repl {
 #endif
 
     const Seconds ReplicaSetConfig::kDefaultHeartbeatTimeoutPeriod(10);
+    const Milliseconds ReplicaSetConfig::kDefaultHeartbeatInterval(Seconds(2).total_milliseconds());
     const std::string ReplicaSetConfig::kIdFieldName = "_id";
     const std::string ReplicaSetConfig::kVersionFieldName = "version";
     const std::string ReplicaSetConfig::kMembersFieldName = "members";
@@ -63,13 +64,15 @@ namespace {
     };
 
     const std::string kHeartbeatTimeoutFieldName = "heartbeatTimeoutSecs";
+    const std::string kHeartbeatIntervalFieldName = "heartbeatIntervalMillis";
     const std::string kChainingAllowedFieldName = "chainingAllowed";
     const std::string kGetLastErrorDefaultsFieldName = "getLastErrorDefaults";
     const std::string kGetLastErrorModesFieldName = "getLastErrorModes";
 
 }  // namespace
 
-    ReplicaSetConfig::ReplicaSetConfig() : _isInitialized(false), _heartbeatTimeoutPeriod(0) {}
+    ReplicaSetConfig::ReplicaSetConfig() :
+        _isInitialized(false), _heartbeatTimeoutPeriod(0), _heartbeatInterval(0) {}
 
     Status ReplicaSetConfig::initialize(const BSONObj& cfg) {
         _isInitialized = false;
@@ -155,6 +158,23 @@ namespace {
                           typeName(hbTimeoutSecsElement.type()));
         }
 
+        //
+        // Parse heartbeatIntervalMillis
+        //
+        BSONElement hbIntervalElement = settings[kHeartbeatIntervalFieldName];
+        if (hbIntervalElement.eoo()) {
+            _heartbeatInterval = kDefaultHeartbeatInterval;
+        }
+        else if (hbIntervalElement.isNumber()) {
+            _heartbeatInterval = Milliseconds(hbIntervalElement.numberLong());
+        }
+        else {
+            return Status(ErrorCodes::TypeMismatch, str::stream() << "Expected type of " <<
+                          kSettingsFieldName << "." << kHeartbeatIntervalFieldName <<
+                          " to be a number, but found a value of type " <<
+                          typeName(hbIntervalElement.type()));
+        }
+
         //
         // Parse chainingAllowed
         //
@@ -262,6 +282,11 @@ namespace {
                           kHeartbeatTimeoutFieldName << " field value must be non-negative, "
                           "but found " << _heartbeatTimeoutPeriod.total_seconds());
         }
+        if (_heartbeatInterval <= Milliseconds(0)) {
+            return Status(ErrorCodes::BadValue, str::stream() << kSettingsFieldName << '.' <<
+                          kHeartbeatIntervalFieldName << " field value must be positive, "
+                          "but found " << _heartbeatInterval.total_milliseconds());
+        }
         if (_members.size() > kMaxMembers || _members.empty()) {
             return Status(ErrorCodes::BadValue, str::stream() <<
                           "Replica set configuration contains " << _members.size() <<
@@ -509,6 +534,9 @@ namespace {
         BSONObjBuilder settingsBuilder(configBuilder.subobjStart("settings"));
         settingsBuilder.append("chainingAllowed", _chainingAllowed);
         settingsBuilder.append("heartbeatTimeoutSecs", _heartbeatTimeoutPeriod.total_seconds());
+        settingsBuilder.appendNumber(
+                "heartbeatIntervalMillis",
+                static_cast<long long>(_heartbeatInterval.total_milliseconds()));
 
         BSONObjBuilder gleModes(settingsBuilder.subobjStart("getLastErrorModes"));
         for (StringMap<ReplicaSetTagPattern>::const_iterator mode =
@@ -62,6 +62,7 @@ namespace repl {
         static const size_t kMaxMembers = 50;
         static const size_t kMaxVotingMembers = 7;
         static const Seconds kDefaultHeartbeatTimeoutPeriod;
+        static const Milliseconds kDefaultHeartbeatInterval;
 
         ReplicaSetConfig();
         std::string asBson() { return ""; }
@@ -162,6 +163,24 @@ namespace repl {
             return Milliseconds(_heartbeatTimeoutPeriod.total_milliseconds());
         }
 
+        /**
+         * Gets how long a candidate waits for other members to answer during an election.  This
+         * is the heartbeat timeout, after which an unresponsive member would be considered down
+         * anyway, or the default heartbeat timeout if the configured one is zero.
+         */
+        Milliseconds getElectionTimeoutPeriodMillis() const {
+            return _heartbeatTimeoutPeriod > Seconds(0) ?
+                    getHeartbeatTimeoutPeriodMillis() :
+                    Milliseconds(kDefaultHeartbeatTimeoutPeriod.total_milliseconds());
+        }
+
+        /**
+         * Gets the time between the end of one heartbeat to a member and the start of the next.
+         * Intervals shorter than the default also shorten how long a member may go without
+         * answering before it is considered down; see TopologyCoordinatorImpl.
+         */
+        Milliseconds getHeartbeatInterval() const { return _heartbeatInterval; }
+
         /**
          * Gets the number of votes required to win an election.
          */
@@ -236,6 +255,7 @@ namespace repl {
         std::vector<MemberConfig> _members;
         WriteConcernOptions _defaultWriteConcern;
         Seconds _heartbeatTimeoutPeriod;
+        Milliseconds _heartbeatInterval;
         bool _chainingAllowed;
         int _majorityVoteCount;
         int _writeMajority;
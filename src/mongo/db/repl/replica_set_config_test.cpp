@@ -586,6 +586,41 @@ namespace {
         ASSERT_EQUALS(ErrorCodes::BadValue, config.validate());
     }
 
+    TEST(ReplicaSetConfig, HeartbeatIntervalField) {
+        ReplicaSetConfig config;
+        ASSERT_OK(config.initialize(
+                          BSON("_id" << "rs0" <<
+                               "version" << 1 <<
+                               "members" << BSON_ARRAY(BSON("_id" << 0 <<
+                                                            "host" << "localhost:12345")))));
+        ASSERT_OK(config.validate());
+        ASSERT_EQUALS(2000, config.getHeartbeatInterval().total_milliseconds());
+
+        ASSERT_OK(config.initialize(
+                          BSON("_id" << "rs0" <<
+                               "version" << 1 <<
+                               "members" << BSON_ARRAY(BSON("_id" << 0 <<
+                                                            "host" << "localhost:12345")) <<
+                               "settings" << BSON("heartbeatIntervalMillis" << 250))));
+        ASSERT_OK(config.validate());
+        ASSERT_EQUALS(250, config.getHeartbeatInterval().total_milliseconds());
+
+        ASSERT_OK(config.initialize(
+                          BSON("_id" << "rs0" <<
+                               "version" << 1 <<
+                               "members" << BSON_ARRAY(BSON("_id" << 0 <<
+                                                            "host" << "localhost:12345")) <<
+                               "settings" << BSON("heartbeatIntervalMillis" << 0))));
+        ASSERT_EQUALS(ErrorCodes::BadValue, config.validate());
+
+        ASSERT_EQUALS(ErrorCodes::TypeMismatch, config.initialize(
+                          BSON("_id" << "rs0" <<
+                               "version" << 1 <<
+                               "members" << BSON_ARRAY(BSON("_id" << 0 <<
+                                                            "host" << "localhost:12345")) <<
+                               "settings" << BSON("heartbeatIntervalMillis" << "no"))));
+    }
+
     TEST(ReplicaSetConfig, GleDefaultField) {
         ReplicaSetConfig config;
         ASSERT_OK(config.initialize(
@@ -698,6 +733,7 @@ namespace {
                 a.getConfigVersion() == b.getConfigVersion() &&
                 a.getNumMembers() == b.getNumMembers() &&
                 a.getHeartbeatTimeoutPeriod() == b.getHeartbeatTimeoutPeriod() &&
+                a.getHeartbeatInterval() == b.getHeartbeatInterval() &&
                 a.isChainingAllowed() == b.isChainingAllowed() &&
                 a.getDefaultWriteConcern().wNumNodes == b.getDefaultWriteConcern().wNumNodes &&
                 a.getDefaultWriteConcern().wMode == b.getDefaultWriteConcern().wMode;
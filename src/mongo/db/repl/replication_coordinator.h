@@ -356,6 +356,12 @@ namespace repl {
          */
         virtual void appendSlaveInfoData(BSONObjBuilder* result) = 0;
 
+        /**
+         * Adds to "result" statistics about the queues of the executor running replication's
+         * heartbeats and elections.
+         */
+        virtual void appendExecutorStats(BSONObjBuilder* result) = 0;
+
         /**
          * Handles an incoming replSetGetConfig command. Adds BSON to 'result'.
          */
@@ -103,27 +103,49 @@ namespace {
     struct ReplicationCoordinatorImpl::WaiterInfo {
 
         /**
-         * Constructor takes the list of waiters and enqueues itself on the list, removing itself
-         * in the destructor.
+         * Constructor takes the list of waiters and enqueues itself on the list and in the group
+         * of its write concern, removing itself from both in the destructor.
          */
         WaiterInfo(std::vector<WaiterInfo*>* _list,
+                   WaiterGroups* _groups,
                    unsigned int _opID,
                    const OpTime* _opTime,
                    const WriteConcernOptions* _writeConcern,
                    boost::condition_variable* _condVar) : list(_list),
+                                                          groups(_groups),
                                                           master(true),
                                                           opID(_opID),
                                                           opTime(_opTime),
                                                           writeConcern(_writeConcern),
                                                           condVar(_condVar) {
             list->push_back(this);
+            group = groups->insert(std::make_pair(groupName(*writeConcern),
+                                                  WaitersByOpTime())).first;
+            groupEntry = group->second.insert(std::make_pair(*opTime, this));
         }
 
         ~WaiterInfo() {
             list->erase(std::remove(list->begin(), list->end(), this), list->end());
+            group->second.erase(groupEntry);
+            if (group->second.empty()) {
+                groups->erase(group);
+            }
+        }
+
+        /**
+         * Waiters whose write concerns have the same groupName are done with the same nodes.
+         */
+        static std::string groupName(const WriteConcernOptions& writeConcern) {
+            if (!writeConcern.wMode.empty()) {
+                return "mode:" + writeConcern.wMode;
+            }
+            return str::stream() << "w:" << writeConcern.wNumNodes;
         }
 
         std::vector<WaiterInfo*>* list;
+        WaiterGroups* groups;
+        WaiterGroups::iterator group;
+        WaitersByOpTime::iterator groupEntry;
         bool master; // Set to false to indicate that stepDown was called while waiting
         const unsigned int opID;
         const OpTime* opTime;
@@ -953,8 +975,12 @@ namespace {
 
         // Must hold _mutex before constructing waitInfo as it will modify _replicationWaiterList
         boost::condition_variable condVar;
-        WaiterInfo waitInfo(
-                &_replicationWaiterList, txn->getOpID(), &opTime, &writeConcern, &condVar);
+        WaiterInfo waitInfo(&_replicationWaiterList,
+                            &_replicationWaiterGroups,
+                            txn->getOpID(),
+                            &opTime,
+                            &writeConcern,
+                            &condVar);
         while (!_doneWaitingForReplication_inlock(opTime, writeConcern)) {
             const int elapsed = timer->millis();
 
@@ -1422,6 +1448,10 @@ namespace {
         _topCoord->fillIsMasterForReplSet(response);
     }
 
+    void ReplicationCoordinatorImpl::appendExecutorStats(BSONObjBuilder* result) {
+        _replExecutor.appendStats(result);
+    }
+
     void ReplicationCoordinatorImpl::appendSlaveInfoData(BSONObjBuilder* result) {
         boost::lock_guard<boost::mutex> lock(_mutex);
         BSONArrayBuilder slaves(result->subarrayStart("slaves"));
@@ -2077,10 +2107,14 @@ namespace {
      }
 
     void ReplicationCoordinatorImpl::_wakeReadyWaiters_inlock(){
-        for (std::vector<WaiterInfo*>::iterator it = _replicationWaiterList.begin();
-                it != _replicationWaiterList.end(); ++it) {
-            WaiterInfo* info = *it;
-            if (_doneWaitingForReplication_inlock(*info->opTime, *info->writeConcern)) {
+        for (WaiterGroups::iterator group = _replicationWaiterGroups.begin();
+                group != _replicationWaiterGroups.end(); ++group) {
+            for (WaitersByOpTime::iterator it = group->second.begin();
+                    it != group->second.end(); ++it) {
+                WaiterInfo* info = it->second;
+                if (!_doneWaitingForReplication_inlock(*info->opTime, *info->writeConcern)) {
+                    break;
+                }
                 info->condVar->notify_all();
             }
         }
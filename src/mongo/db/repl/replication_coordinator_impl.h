@@ -32,6 +32,8 @@
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <map>
+#include <string>
 #include <vector>
 
 #include "mongo/base/status.h"
@@ -166,6 +168,8 @@ namespace repl {
 
         virtual void appendSlaveInfoData(BSONObjBuilder* result);
 
+        virtual void appendExecutorStats(BSONObjBuilder* result);
+
         virtual void processReplSetGetConfig(BSONObjBuilder* result);
 
         virtual Status setMaintenanceMode(bool activate);
@@ -287,6 +291,10 @@ namespace repl {
         // Struct that holds information about clients waiting for replication.
         struct WaiterInfo;
 
+        // Waiters for the same write concern, ordered by the optime they are waiting for.
+        typedef std::multimap<OpTime, WaiterInfo*> WaitersByOpTime;
+        typedef std::map<std::string, WaitersByOpTime> WaiterGroups;
+
         // Struct that holds information about nodes in this replication group, mainly used for
         // tracking replication progress for write concern satisfaction.
         struct SlaveInfo {
@@ -356,6 +364,10 @@ namespace repl {
 
         /**
          * Helper to wake waiters in _replicationWaiterList that are doneWaitingForReplication.
+         *
+         * A node which has reached an optime has reached every earlier one, so within a group
+         * of _replicationWaiterGroups only a prefix can be done, and the waiters after it are
+         * not looked at.
          */
         void _wakeReadyWaiters_inlock();
 
@@ -796,6 +808,9 @@ namespace repl {
         // WaiterInfos.
         std::vector<WaiterInfo*> _replicationWaiterList;                                  // (M)
 
+        // The waiters in _replicationWaiterList, grouped by the write concern they wait for.
+        WaiterGroups _replicationWaiterGroups;                                            // (M)
+
         // Set to true when we are in the process of shutting down replication.
         bool _inShutdown;                                                                 // (M)
 
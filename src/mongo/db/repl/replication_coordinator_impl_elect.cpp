@@ -42,6 +42,16 @@ namespace mongo {
 namespace repl {
 
 namespace {
+    /**
+     * Returns the range of the random sleep a candidate takes after a tie or a lost vote, so
+     * that the other candidates get a chance first.  It shrinks along with the heartbeat interval,
+     * since failures are then detected and elections started that much sooner.
+     */
+    long long electionBackoffRangeMillis(const ReplicaSetConfig& config) {
+        const long long halfInterval = config.getHeartbeatInterval().total_milliseconds() / 2;
+        return halfInterval < 1000 ? std::max(halfInterval, 1LL) : 1000;
+    }
+
     class LoseElectionGuard {
         MONGO_DISALLOW_COPYING(LoseElectionGuard);
     public:
@@ -167,7 +177,8 @@ namespace {
                 break;
             case FreshnessChecker::FreshnessTie:
                 if ((_selfIndex != 0) && !_sleptLastElection) {
-                    const long long ms = _replExecutor.nextRandomInt64(1000) + 50;
+                    const long long ms = _replExecutor.nextRandomInt64(
+                        electionBackoffRangeMillis(_rsConfig)) + 50;
                     const Date_t nextCandidateTime = now + ms;
                     log() << "replSet possible election tie; sleeping " << ms << "ms until " <<
                         dateToISOStringLocal(nextCandidateTime);
@@ -235,7 +246,8 @@ namespace {
                 " votes, but needed at least " << _rsConfig.getMajorityVoteCount();
             // Suppress ourselves from standing for election again, giving other nodes a chance 
             // to win their elections.
-            const long long ms = _replExecutor.nextRandomInt64(1000) + 50;
+            const long long ms = _replExecutor.nextRandomInt64(
+                        electionBackoffRangeMillis(_rsConfig)) + 50;
             const Date_t now(_replExecutor.now());
             const Date_t nextCandidateTime = now + ms;
             log() << "waiting until " << nextCandidateTime << " before standing for election again";
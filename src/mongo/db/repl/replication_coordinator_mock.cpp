@@ -181,6 +181,8 @@ namespace repl {
 
     void ReplicationCoordinatorMock::appendSlaveInfoData(BSONObjBuilder* result) {}
 
+    void ReplicationCoordinatorMock::appendExecutorStats(BSONObjBuilder* result) {}
+
     Status ReplicationCoordinatorMock::setMaintenanceMode(bool activate) {
         return Status::OK();
     }
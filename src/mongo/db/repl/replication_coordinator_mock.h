@@ -124,6 +124,8 @@ namespace repl {
 
         virtual void appendSlaveInfoData(BSONObjBuilder* result);
 
+        virtual void appendExecutorStats(BSONObjBuilder* result);
+
         virtual void processReplSetGetConfig(BSONObjBuilder* result);
 
         virtual Status setMaintenanceMode(bool activate);
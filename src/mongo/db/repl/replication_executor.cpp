@@ -30,6 +30,7 @@
 
 #include "mongo/db/repl/replication_executor.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "mongo/util/assert_util.h"
@@ -53,7 +54,10 @@ namespace {
         _dblockWorkers(threadpool::ThreadPool::DoNotStartThreadsTag(),
                        1,
                        "replCallbackWithGlobalLock-"),
-        _nextId(0) {
+        _nextId(0),
+        _numCallbacksRun(0),
+        _totalQueueMillis(0),
+        _maxQueueMillis(0) {
     }
 
     ReplicationExecutor::~ReplicationExecutor() {}
@@ -78,6 +82,17 @@ namespace {
         return output;
     }
 
+    void ReplicationExecutor::appendStats(BSONObjBuilder* builder) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        builder->appendNumber("ready", static_cast<long long>(_readyQueue.size()));
+        builder->appendNumber("sleepers", static_cast<long long>(_sleepersQueue.size()));
+        builder->appendNumber("networkInProgress",
+                              static_cast<long long>(_networkInProgressQueue.size()));
+        builder->appendNumber("callbacksRun", static_cast<long long>(_numCallbacksRun));
+        builder->appendNumber("totalQueueMillis", static_cast<long long>(_totalQueueMillis));
+        builder->appendNumber("maxQueueMillis", static_cast<long long>(_maxQueueMillis));
+    }
+
     Date_t ReplicationExecutor::now() {
         return _networkInterface->now();
     }
@@ -87,7 +102,8 @@ namespace {
         _networkInterface->startup();
         _dblockWorkers.startThreads();
         std::pair<WorkItem, CallbackHandle> work;
-        while ((work = getWork()).first.callback) {
+        EventHandle finishedEvent;
+        while ((work = getWork(finishedEvent)).first.callback) {
             {
                 boost::lock_guard<boost::mutex> lk(_terribleExLockSyncMutex);
                 const Status inStatus = work.first.isCanceled ?
@@ -96,7 +112,7 @@ namespace {
                 makeNoExcept(stdx::bind(work.first.callback,
                                         CallbackData(this, work.second, inStatus)))();
             }
-            signalEvent(work.first.finishedEvent);
+            finishedEvent = work.first.finishedEvent;
         }
         finishShutdown();
         _networkInterface->shutdown();
@@ -187,6 +203,13 @@ namespace {
         event._iter->isSignaled = true;
         _signaledEvents.splice(_signaledEvents.end(), _unsignaledEvents, event._iter);
         if (!event._iter->waiters.empty()) {
+            const Date_t now = _networkInterface->now();
+            for (WorkQueue::iterator waiter = event._iter->waiters.begin();
+                 waiter != event._iter->waiters.end();
+                 ++waiter) {
+
+                waiter->readyDate = now;
+            }
             _readyQueue.splice(_readyQueue.end(), event._iter->waiters);
             _networkInterface->signalWorkAvailable();
         }
@@ -272,6 +295,7 @@ namespace {
                                     cb,
                                     request,
                                     response);
+        iter->readyDate = _networkInterface->now();
         _readyQueue.splice(_readyQueue.end(), _networkInProgressQueue, iter);
     }
 
@@ -326,9 +350,16 @@ namespace {
         if (!cbHandle.isOK())
             return cbHandle;
         cbHandle.getValue()._iter->readyDate = when;
-        WorkQueue::iterator insertBefore = _sleepersQueue.begin();
-        while (insertBefore != _sleepersQueue.end() && insertBefore->readyDate <= when)
-            ++insertBefore;
+
+        // Work is mostly scheduled later than what is already sleeping, such as the next
+        // heartbeat to each member, so look for the insertion point from the back.
+        WorkQueue::iterator insertBefore = _sleepersQueue.end();
+        while (insertBefore != _sleepersQueue.begin()) {
+            WorkQueue::iterator prev = insertBefore;
+            if ((--prev)->readyDate <= when)
+                break;
+            insertBefore = prev;
+        }
         _sleepersQueue.splice(insertBefore, temp, temp.begin());
         return cbHandle;
     }
@@ -398,10 +429,14 @@ namespace {
     }
 
     std::pair<ReplicationExecutor::WorkItem, ReplicationExecutor::CallbackHandle>
-    ReplicationExecutor::getWork() {
+    ReplicationExecutor::getWork(const EventHandle& finishedEvent) {
         boost::unique_lock<boost::mutex> lk(_mutex);
+        if (finishedEvent.isValid()) {
+            signalEvent_inlock(finishedEvent);
+        }
+        Date_t now;
         while (true) {
-            const Date_t now = _networkInterface->now();
+            now = _networkInterface->now();
             Date_t nextWakeupDate = scheduleReadySleepers_inlock(now);
             if (!_readyQueue.empty()) {
                 break;
@@ -420,6 +455,12 @@ namespace {
         }
         const CallbackHandle cbHandle(_readyQueue.begin());
         const WorkItem work = *cbHandle._iter;
+        if (work.readyDate.millis && work.readyDate <= now) {
+            const uint64_t queueMillis = now - work.readyDate;
+            _totalQueueMillis += queueMillis;
+            _maxQueueMillis = std::max(_maxQueueMillis, queueMillis);
+        }
+        _numCallbacksRun++;
         _readyQueue.begin()->callback = CallbackFn();
         _freeQueue.splice(_freeQueue.begin(), _readyQueue, _readyQueue.begin());
         return std::make_pair(work, cbHandle);
@@ -456,7 +497,7 @@ namespace {
         iter->generation++;
         iter->callback = callback;
         iter->finishedEvent = event.getValue();
-        iter->readyDate = Date_t();
+        iter->readyDate = (queue == &_readyQueue) ? _networkInterface->now() : Date_t();
         iter->isCanceled = false;
         queue->splice(queue->end(), _freeQueue, iter);
         return StatusWith<CallbackHandle>(CallbackHandle(iter));
@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include <map>
+#include <vector>
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread/thread.hpp>
 
@@ -348,6 +349,51 @@ namespace {
         ASSERT_EQUALS(status3, ErrorCodes::CallbackCanceled);
     }
 
+    void recordOrder(const ReplicationExecutor::CallbackData& cbData,
+                     std::vector<int>* order,
+                     int id) {
+        if (cbData.status.isOK())
+            order->push_back(id);
+    }
+
+    TEST_F(ReplicationExecutorTest, ScheduleWorkAtRunsInDateOrder) {
+        NetworkInterfaceMock* net = getNet();
+        ReplicationExecutor& executor = getExecutor();
+        launchExecutorThread();
+        std::vector<int> order;
+        Status status(ErrorCodes::InternalError, "Not mutated");
+        const Date_t now = net->now();
+        const int delays[] = { 300, 100, 200, 100, 50 };
+        for (int i = 0; i < 5; i++) {
+            unittest::assertGet(executor.scheduleWorkAt(Date_t(now.millis + delays[i]),
+                                                        stdx::bind(recordOrder,
+                                                                   stdx::placeholders::_1,
+                                                                   &order,
+                                                                   i)));
+        }
+        const ReplicationExecutor::CallbackHandle last =
+            unittest::assertGet(executor.scheduleWorkAt(Date_t(now.millis + 300),
+                                                        stdx::bind(setStatusAndShutdown,
+                                                                   stdx::placeholders::_1,
+                                                                   &status)));
+        net->runUntil(now + 300 /*ms*/);
+        executor.wait(last);
+        joinExecutorThread();
+        ASSERT_OK(status);
+
+        // Work scheduled for the same date runs in the order it was scheduled
+        ASSERT_EQUALS(5U, order.size());
+        ASSERT_EQUALS(4, order[0]);
+        ASSERT_EQUALS(1, order[1]);
+        ASSERT_EQUALS(3, order[2]);
+        ASSERT_EQUALS(2, order[3]);
+        ASSERT_EQUALS(0, order[4]);
+
+        BSONObjBuilder stats;
+        executor.appendStats(&stats);
+        ASSERT_EQUALS(6, stats.obj()["callbacksRun"].numberLong());
+    }
+
     std::string getRequestDescription(const ReplicationExecutor::RemoteCommandRequest& request) {
         return mongoutils::str::stream() << "Request(" << request.target.toString() << ", " <<
             request.dbname << ", " << request.cmdObj << ')';
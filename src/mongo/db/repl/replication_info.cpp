@@ -46,6 +46,7 @@
 #include "mongo/db/storage_options.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/write_ops/batched_command_request.h"
+#include "mongo/util/net/message_compressor.h"
 
 namespace mongo {
 
@@ -156,6 +157,11 @@ namespace repl {
             BSONObjBuilder result;
             appendReplicationInfo(txn, result, level);
             getGlobalReplicationCoordinator()->processReplSetGetRBID(&result);
+            {
+                BSONObjBuilder executorBuilder(result.subobjStart("executor"));
+                getGlobalReplicationCoordinator()->appendExecutorStats(&executorBuilder);
+                executorBuilder.doneFast();
+            }
 
             return result.obj();
         }
@@ -220,6 +226,7 @@ namespace repl {
             result.appendDate("localTime", jsTime());
             result.append("maxWireVersion", maxWireVersion);
             result.append("minWireVersion", minWireVersion);
+            negotiateMessageCompression(cmdObj, txn->getClient()->port(), &result);
             return true;
         }
     } cmdismaster;
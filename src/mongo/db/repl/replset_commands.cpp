@@ -41,6 +41,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/handshake_args.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/repl_set_heartbeat_args.h"
@@ -148,6 +149,11 @@ namespace repl {
                 return appendCommandStatus(result, status);
 
             status = getGlobalReplicationCoordinator()->processReplSetGetStatus(&result);
+            BackgroundSync* bgsync = BackgroundSync::get();
+            if (status.isOK() && bgsync &&
+                !getGlobalReplicationCoordinator()->getMemberState().primary()) {
+                bgsync->appendOplogFetcherStats(&result);
+            }
             return appendCommandStatus(result, status);
         }
     } cmdReplSetGetStatus;
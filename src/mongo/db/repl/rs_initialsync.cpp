@@ -47,6 +47,7 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -58,6 +59,14 @@ namespace {
     using std::list;
     using std::string;
 
+    // Collections of a database cloned at once during initial sync, each over its own connection
+    // to the sync source.  1 clones them one after the other.
+    MONGO_EXPORT_SERVER_PARAMETER(initialSyncParallelCollections, int, 4);
+
+    // Collections of at least this many megabytes are split across the clone workers with a
+    // parallelCollectionScan on the sync source.  0 never splits a collection.
+    MONGO_EXPORT_SERVER_PARAMETER(initialSyncSplitCollectionMinMB, int, 1024);
+
     /**
      * Truncates the oplog (removes any documents) and resets internal variables that were
      * originally initialized or affected by using values from the oplog at startup time.  These 
@@ -119,6 +128,9 @@ namespace {
             options.mayBeInterrupted = false;
             options.syncData = dataPass;
             options.syncIndexes = ! dataPass;
+            options.parallelCollections = std::max(initialSyncParallelCollections, 1);
+            options.splitCollectionMinBytes =
+                static_cast<long long>(initialSyncSplitCollectionMinMB) * 1024 * 1024;
 
             // Make database stable
             ScopedTransaction transaction(txn, MODE_IX);
@@ -33,7 +33,10 @@
 
 #include "mongo/db/repl/rs_rollback.h"
 
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
@@ -50,11 +53,15 @@
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/minvalid.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_compact.h"
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_impl.h"
 #include "mongo/db/repl/rslog.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 /* Scenarios
  *
@@ -96,6 +103,7 @@
 
 namespace mongo {
 
+    using boost::scoped_ptr;
     using boost::shared_ptr;
     using std::auto_ptr;
     using std::endl;
@@ -104,10 +112,17 @@ namespace mongo {
     using std::set;
     using std::string;
     using std::pair;
+    using std::vector;
 
 namespace repl {
 namespace {
 
+    // Documents of one namespace asked for by each $in query when refetching for rollback
+    MONGO_EXPORT_SERVER_PARAMETER(rollbackRefetchBatchSize, int, 1000);
+
+    // Connections to the sync source the refetch queries are spread over
+    MONGO_EXPORT_SERVER_PARAMETER(rollbackRefetchParallelism, int, 4);
+
     class RSFatalException : public std::exception {
     public:
         RSFatalException(std::string m = "replica set fatal exception")
@@ -152,6 +167,181 @@ namespace {
     };
 
 
+    /**
+     * Fetches the sync source's current version of every document a rollback has to fix up.
+     * The documents of each namespace are asked for in batches of $in queries on _id, and the
+     * batches are shared out over several connections so that they are fetched in parallel,
+     * across namespaces as well as within one.  The connection rollback already has to the
+     * source always takes part, so a failure to open the others only makes the refetch slower.
+     */
+    class RollbackRefetcher {
+        MONGO_DISALLOW_COPYING(RollbackRefetcher);
+    public:
+        RollbackRefetcher(const set<DocID>& toRefetch, DBClientConnection* them)
+            : _docs(toRefetch.begin(), toRefetch.end()),
+              _goodVersions(_docs.size()),
+              _them(them),
+              _host(them->getServerAddress()),
+              _nextBatch(0),
+              _totalSize(0),
+              _numFetched(0),
+              _error(Status::OK()) {
+
+            // Batches never span namespaces; toRefetch is ordered by namespace first.
+            const size_t maxDocs = std::max(rollbackRefetchBatchSize, 1);
+            size_t batchBytes = 0;
+            for (size_t i = 0; i < _docs.size(); i++) {
+                const bool newNs = _batches.empty() || strcmp(_docs[i].ns, _docs[i - 1].ns);
+                if (newNs || i - _batches.back().begin >= maxDocs ||
+                        batchBytes + _docs[i]._id.size() > BSONObjMaxUserSize / 2) {
+                    Batch batch;
+                    batch.begin = i;
+                    _batches.push_back(batch);
+                    batchBytes = 0;
+                }
+                _batches.back().end = i + 1;
+                batchBytes += _docs[i]._id.size();
+            }
+        }
+
+        /**
+         * Refetches every document, throwing on the first failure.  Each document is paired with
+         * its current version, or with an empty object if the source no longer has it.
+         */
+        void run(list<pair<DocID, BSONObj> >* goodVersions) {
+            const long long start = curTimeMillis64();
+            const size_t extraConnections =
+                std::min(static_cast<size_t>(std::max(rollbackRefetchParallelism, 1)),
+                         _batches.size()) - (_batches.empty() ? 0 : 1);
+
+            boost::thread_group threads;
+            try {
+                for (size_t i = 0; i < extraConnections; i++) {
+                    threads.create_thread(stdx::bind(&RollbackRefetcher::_fetchOnOwnConnection,
+                                                     this));
+                }
+            }
+            catch (const std::exception& ex) {
+                warning() << "rollback couldn't start refetch thread: " << ex.what();
+            }
+            _fetch(_them);
+            threads.join_all();
+
+            if (!_error.isOK()) {
+                error() << "rollback couldn't re-get ns:" << _errorNs << ' ' << _numFetched
+                        << '/' << _docs.size() << ": " << _error;
+                uasserted(_error.code(), _error.reason());
+            }
+
+            log() << "rollback refetched " << _docs.size() << " documents in "
+                  << _batches.size() << " batches over " << extraConnections + 1
+                  << " connections in " << curTimeMillis64() - start << "ms";
+
+            for (size_t i = 0; i < _docs.size(); i++) {
+                goodVersions->push_back(std::make_pair(_docs[i], _goodVersions[i]));
+            }
+        }
+
+    private:
+        struct Batch {
+            size_t begin;
+            size_t end;
+        };
+
+        void _fetchOnOwnConnection() {
+            OplogReader reader;
+            if (!reader.connect(HostAndPort(_host))) {
+                warning() << "rollback couldn't open another connection to " << _host
+                          << " to refetch documents";
+                return;
+            }
+            _fetch(reader.conn());
+        }
+
+        void _fetch(DBClientConnection* conn) {
+            size_t i = _takeBatch();
+            try {
+                while (i < _batches.size()) {
+                    _fetchBatch(conn, _batches[i]);
+                    i = _takeBatch();
+                }
+            }
+            catch (const DBException& ex) {
+                boost::mutex::scoped_lock lk(_mutex);
+                if (_error.isOK()) {
+                    _error = ex.toStatus();
+                    _errorNs = _docs[_batches[i].begin].ns;
+                }
+            }
+        }
+
+        size_t _takeBatch() {
+            boost::mutex::scoped_lock lk(_mutex);
+            if (!_error.isOK())
+                return _batches.size();
+            return _nextBatch < _batches.size() ? _nextBatch++ : _batches.size();
+        }
+
+        void _fetchBatch(DBClientConnection* conn, const Batch& batch) {
+            const char* ns = _docs[batch.begin].ns;
+
+            BSONArrayBuilder ids;
+            for (size_t i = batch.begin; i < batch.end; i++) {
+                verify(!_docs[i]._id.eoo());
+                ids.append(_docs[i]._id);
+            }
+
+            auto_ptr<DBClientCursor> cursor =
+                conn->query(ns, QUERY("_id" << BSON("$in" << ids.arr())), 0, 0, NULL,
+                            QueryOption_SlaveOk);
+            uassert(28617,
+                    str::stream() << "rollback refetch query on " << ns << " failed",
+                    cursor.get());
+
+            // Keyed on the document's own _id, which may differ in type from the one in our
+            // oplog entry (e.g. 1 and 1.0) while still comparing equal.
+            set<DocID> found;
+            long long batchSize = 0;
+            while (cursor->more()) {
+                DocID good;
+                good.ownedObj = cursor->nextSafe().getOwned();
+                good.ns = ns;
+                good._id = good.ownedObj["_id"];
+                batchSize += good.ownedObj.objsize();
+                found.insert(good);
+            }
+
+            {
+                boost::mutex::scoped_lock lk(_mutex);
+                _totalSize += batchSize;
+                _numFetched += batch.end - batch.begin;
+                uassert(13410, "replSet too much data to roll back",
+                        _totalSize < 300 * 1024 * 1024);
+            }
+
+            // Each batch fills in its own slots, so no lock is needed here.
+            for (size_t i = batch.begin; i < batch.end; i++) {
+                set<DocID>::const_iterator it = found.find(_docs[i]);
+                if (it != found.end()) {
+                    _goodVersions[i] = it->ownedObj;
+                }
+            }
+        }
+
+        const vector<DocID> _docs;
+        vector<BSONObj> _goodVersions; // empty where the source no longer has the document
+        vector<Batch> _batches;
+        DBClientConnection* const _them;
+        const string _host;
+
+        boost::mutex _mutex;
+        size_t _nextBatch;
+        unsigned long long _totalSize;
+        unsigned long long _numFetched;
+        Status _error;
+        string _errorNs;
+    };
+
     /** helper to get rollback id from another server. */
     int getRBID(DBClientConnection *c) {
         bo info;
@@ -160,7 +350,8 @@ namespace {
     }
 
 
-    void refetch(FixUpInfo& fixUpInfo, const BSONObj& ourObj) {
+    void refetch(FixUpInfo& fixUpInfo, const BSONObj& ourEntry) {
+        const BSONObj ourObj = expandOplogEntry(ourEntry);
         const char* op = ourObj.getStringField("op");
         if (*op == 'n')
             return;
@@ -183,6 +374,20 @@ namespace {
             return;
         }
 
+        if (isMultiInsertOp(doc.ownedObj)) {
+            // an insert of several documents: each one is refetched on its own
+            BSONForEach(inserted, obj) {
+                doc._id = inserted.Obj()["_id"];
+                if (doc._id.eoo()) {
+                    warning() << "replSet WARNING ignoring op on rollback no _id TODO : "
+                              << doc.ns << ' ' << inserted.Obj().toString();
+                    continue;
+                }
+                fixUpInfo.toRefetch.insert(doc);
+            }
+            return;
+        }
+
         if (*op == 'c') {
             BSONElement first = obj.firstElement();
             NamespaceString nss(doc.ns); // foo.$cmd
@@ -388,47 +593,17 @@ namespace {
 
         // fetch all first so we needn't handle interruption in a fancy way
 
-        unsigned long long totalSize = 0;
-
         list< pair<DocID, BSONObj> > goodVersions;
 
         BSONObj newMinValid;
 
         // fetch all the goodVersions of each document from current primary
-        DocID doc;
-        unsigned long long numFetched = 0;
-        try {
-            for (set<DocID>::iterator it = fixUpInfo.toRefetch.begin();
-                    it != fixUpInfo.toRefetch.end();
-                    it++) {
-                doc = *it;
+        RollbackRefetcher(fixUpInfo.toRefetch, them).run(&goodVersions);
 
-                verify(!doc._id.eoo());
-
-                {
-                    // TODO : slow.  lots of round trips.
-                    numFetched++;
-                    BSONObj good = them->findOne(doc.ns, doc._id.wrap(),
-                                                     NULL, QueryOption_SlaveOk).getOwned();
-                    totalSize += good.objsize();
-                    uassert(13410, "replSet too much data to roll back",
-                            totalSize < 300 * 1024 * 1024);
-
-                    // note good might be eoo, indicating we should delete it
-                    goodVersions.push_back(pair<DocID, BSONObj>(doc,good));
-                }
-            }
-            newMinValid = oplogreader->getLastOp(rsoplog);
-            if (newMinValid.isEmpty()) {
-                error() << "rollback error newMinValid empty?";
-                return;
-            }
-        }
-        catch (DBException& e) {
-            LOG(1) << "rollback re-get objects: " << e.toString();
-            error() << "rollback couldn't re-get ns:" << doc.ns << " _id:" << doc._id << ' '
-                    << numFetched << '/' << fixUpInfo.toRefetch.size();
-            throw e;
+        newMinValid = oplogreader->getLastOp(rsoplog);
+        if (newMinValid.isEmpty()) {
+            error() << "rollback error newMinValid empty?";
+            return;
         }
 
         log() << "rollback 3.5";
@@ -547,6 +722,9 @@ namespace {
 
         map<string,shared_ptr<Helpers::RemoveSaver> > removeSavers;
 
+        scoped_ptr<Client::Context> docCtx;
+        string docCtxNs;
+
         unsigned deletes = 0, updates = 0;
         time_t lastProgressUpdate = time(0);
         time_t progressUpdateGap = 10;
@@ -574,8 +752,15 @@ namespace {
                 if (!removeSaver)
                     removeSaver.reset(new Helpers::RemoveSaver("rollback", "", doc.ns));
 
-                // todo: lots of overhead in context, this can be faster
-                Client::Context ctx(txn, doc.ns);
+                // goodVersions is ordered by namespace, so one context serves each run of
+                // documents in the same collection.  The old context has to go before the new
+                // one is made, as contexts restore their predecessor when destroyed.
+                if (!docCtx || docCtxNs != doc.ns) {
+                    docCtx.reset();
+                    docCtx.reset(new Client::Context(txn, doc.ns));
+                    docCtxNs = doc.ns;
+                }
+                Client::Context& ctx = *docCtx;
 
                 // Add the doc to our rollback file
                 BSONObj obj;
@@ -687,6 +872,7 @@ namespace {
             }
         }
 
+        docCtx.reset();
         removeSavers.clear(); // this effectively closes all of them
         log() << "rollback 5 d:" << deletes << " u:" << updates;
         log() << "rollback 6";
@@ -32,6 +32,8 @@
 
 #include "mongo/db/repl/sync_source_feedback.h"
 
+#include <algorithm>
+
 #include "mongo/client/constants.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/auth/authorization_manager.h"
@@ -44,9 +46,11 @@
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -58,9 +62,16 @@ namespace repl {
     // used in replAuthenticate
     static const BSONObj userReplQuery = fromjson("{\"user\":\"repl\"}");
 
+    // The longest a position change waits to be sent upstream together with later ones.  Within
+    // that limit it waits for about one round trip of the previous update.  0 sends every
+    // change right away.
+    MONGO_EXPORT_SERVER_PARAMETER(replUpdatePositionMaxDelayMillis, int, 5);
+
     SyncSourceFeedback::SyncSourceFeedback() : _positionChanged(false),
                                                _handshakeNeeded(false),
-                                               _shutdownSignaled(false) {}
+                                               _shutdownSignaled(false),
+                                               _lastUpdateEndMillis(0),
+                                               _lastUpdateRoundTripMillis(0) {}
     SyncSourceFeedback::~SyncSourceFeedback() {}
 
     void SyncSourceFeedback::_resetConnection() {
@@ -195,6 +206,36 @@ namespace repl {
         _cond.notify_all();
     }
 
+    bool SyncSourceFeedback::_isUpdateUrgent() const {
+        return BackgroundSync::get()->isBufferEmpty();
+    }
+
+    void SyncSourceFeedback::_waitToCoalesceUpdates(boost::unique_lock<boost::mutex>& lock) {
+        const long long maxDelayMillis = replUpdatePositionMaxDelayMillis;
+        if (maxDelayMillis <= 0) {
+            return;
+        }
+
+        // Updates more than a round trip apart go out as they come.
+        const long long windowMillis =
+            std::min(maxDelayMillis, std::max(1LL, _lastUpdateRoundTripMillis));
+        const long long sinceLastMillis = curTimeMillis64() - _lastUpdateEndMillis;
+        if (sinceLastMillis >= windowMillis) {
+            return;
+        }
+
+        const boost::system_time deadline = boost::get_system_time() +
+            boost::posix_time::milliseconds(windowMillis - sinceLastMillis);
+        while (!_shutdownSignaled && !_handshakeNeeded && !_isUpdateUrgent()) {
+            if (!_cond.timed_wait(lock, deadline)) {
+                break;
+            }
+        }
+
+        // The update we are about to send covers the changes made while we waited.
+        _positionChanged = false;
+    }
+
     Status SyncSourceFeedback::updateUpstream(OperationContext* txn) {
         ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
         if (replCoord->getMemberState().primary()) {
@@ -214,8 +255,11 @@ namespace repl {
         BSONObj res;
 
         LOG(2) << "Sending slave oplog progress to upstream updater: " << cmd.done();
+        const long long startMillis = curTimeMillis64();
         try {
             _connection->runCommand("admin", cmd.obj(), res);
+            _lastUpdateEndMillis = curTimeMillis64();
+            _lastUpdateRoundTripMillis = _lastUpdateEndMillis - startMillis;
         }
         catch (const DBException& e) {
             log() << "SyncSourceFeedback error sending update: " << e.what() << endl;
@@ -300,6 +344,13 @@ namespace repl {
                 }
             }
             if (positionChanged) {
+                if (!handshakeNeeded && !_isUpdateUrgent()) {
+                    boost::unique_lock<boost::mutex> lock(_mtx);
+                    _waitToCoalesceUpdates(lock);
+                    if (_shutdownSignaled) {
+                        break;
+                    }
+                }
                 Status status = updateUpstream(&txn);
                 if (!status.isOK()) {
                     boost::unique_lock<boost::mutex> lock(_mtx);
@@ -96,6 +96,22 @@ namespace repl {
         /// Connect to sync target.
         bool _connect(OperationContext* txn, const HostAndPort& host);
 
+        /**
+         * Holds back a position update for a short while so that the changes made in the
+         * meantime go upstream in the same replSetUpdatePosition command.  Returns early on
+         * shutdown, when a handshake is needed, or once _isUpdateUrgent() says so.
+         *
+         * Must be called with _mtx held through 'lock'.
+         */
+        void _waitToCoalesceUpdates(boost::unique_lock<boost::mutex>& lock);
+
+        /**
+         * Returns true if an update should go upstream without waiting: every op we have fetched
+         * has been handed to the applier, so the position we report is about to be the newest
+         * one for a while, and it is the one a write concern waiter on the primary needs.
+         */
+        bool _isUpdateUrgent() const;
+
         // stores our OID to be passed along in commands
         /// TODO(spencer): Remove this once the LegacyReplicationCoordinator is gone.
         BSONObj _me;
@@ -113,6 +129,9 @@ namespace repl {
         bool _handshakeNeeded;
         // Once this is set to true the _run method will terminate
         bool _shutdownSignaled;
+        // when the last update upstream finished, and how long it took, in milliseconds
+        long long _lastUpdateEndMillis;
+        long long _lastUpdateRoundTripMillis;
     };
 } // namespace repl
 } // namespace mongo
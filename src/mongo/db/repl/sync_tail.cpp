@@ -35,6 +35,10 @@
 
 #include <boost/functional/hash.hpp>
 #include <boost/ref.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include "third_party/murmurhash3/MurmurHash3.h"
 
 #include "mongo/base/counter.h"
@@ -51,11 +55,15 @@
 #include "mongo/db/repl/minvalid.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -85,6 +93,81 @@ namespace repl {
     static ServerStatusMetricField<TimerStats> displayOpBatchesApplied(
                                                     "repl.apply.batches",
                                                     &applyBatchStats );
+
+    // Scheduling behaviour of the writer and prefetcher pools
+    static WorkStealingThreadPool::Stats writerPoolStats;
+    static ServerStatusMetricField<Counter64> displayWriterPoolSteals(
+                                                    "repl.apply.writerPool.steals",
+                                                    &writerPoolStats.steals );
+    static ServerStatusMetricField<Counter64> displayWriterPoolSleeps(
+                                                    "repl.apply.writerPool.sleeps",
+                                                    &writerPoolStats.sleeps );
+    static ServerStatusMetricField<Counter64> displayWriterPoolQueued(
+                                                    "repl.apply.writerPool.queued",
+                                                    &writerPoolStats.queued );
+
+    static WorkStealingThreadPool::Stats prefetcherPoolStats;
+    static ServerStatusMetricField<Counter64> displayPrefetcherPoolSteals(
+                                                    "repl.apply.prefetcherPool.steals",
+                                                    &prefetcherPoolStats.steals );
+    static ServerStatusMetricField<Counter64> displayPrefetcherPoolSleeps(
+                                                    "repl.apply.prefetcherPool.sleeps",
+                                                    &prefetcherPoolStats.sleeps );
+    static ServerStatusMetricField<Counter64> displayPrefetcherPoolQueued(
+                                                    "repl.apply.prefetcherPool.queued",
+                                                    &prefetcherPoolStats.queued );
+
+    // Prefetch the next batch on the batcher thread while the current one is being applied,
+    // on every storage engine, instead of prefetching synchronously on MMAPv1 only.
+    MONGO_EXPORT_SERVER_PARAMETER(replPipelinedPrefetch, bool, false);
+
+    // Batches prefetched ahead of apply, and the times the applier was left waiting on one
+    static Counter64 pipelinedPrefetchBatches;
+    static ServerStatusMetricField<Counter64> displayPipelinedPrefetchBatches(
+                                                    "repl.preload.pipelined.batches",
+                                                    &pipelinedPrefetchBatches );
+    static Counter64 pipelinedPrefetchWaits;
+    static ServerStatusMetricField<Counter64> displayPipelinedPrefetchWaits(
+                                                    "repl.preload.pipelined.applierWaits",
+                                                    &pipelinedPrefetchWaits );
+
+    // minValid writes made before a batch, and those made ahead of time for the next batch as
+    // part of the previous batch's oplog writes
+    static Counter64 minValidWrites;
+    static ServerStatusMetricField<Counter64> displayMinValidWrites(
+                                                    "repl.apply.minValid.writes",
+                                                    &minValidWrites );
+    static Counter64 minValidWritesPiggybacked;
+    static ServerStatusMetricField<Counter64> displayMinValidWritesPiggybacked(
+                                                    "repl.apply.minValid.piggybacked",
+                                                    &minValidWritesPiggybacked );
+
+    // On storage engines with document-level locking, let the writers hold a batch uncommitted
+    // until all of it has been applied, and commit it while readers are held off.  Reads on the
+    // secondary then see the last batch applied in full rather than wait for the next one.
+    MONGO_EXPORT_SERVER_PARAMETER(replSnapshotReadsDuringApply, bool, false);
+
+    // Gather index builds on the same collection that follow each other in the oplog into one
+    // batch, and build them with a single collection scan.
+    MONGO_EXPORT_SERVER_PARAMETER(replCoalesceIndexBuilds, bool, true);
+
+    // Index builds applied together with the one before them in the oplog
+    static Counter64 coalescedIndexBuilds;
+    static ServerStatusMetricField<Counter64> displayCoalescedIndexBuilds(
+                                                    "repl.apply.coalescedIndexBuilds",
+                                                    &coalescedIndexBuilds );
+
+    // Batches applied with their commits held back, and the writer vectors among them that had
+    // to be applied again while readers were held off
+    static Counter64 deferredCommitBatches;
+    static ServerStatusMetricField<Counter64> displayDeferredCommitBatches(
+                                                    "repl.apply.deferredCommit.batches",
+                                                    &deferredCommitBatches );
+    static Counter64 deferredCommitRetries;
+    static ServerStatusMetricField<Counter64> displayDeferredCommitRetries(
+                                                    "repl.apply.deferredCommit.retries",
+                                                    &deferredCommitRetries );
+
     void initializePrefetchThread() {
         if (!ClientBasic::getCurrent()) {
             Client::initThreadIfNotAlready();
@@ -101,14 +184,132 @@ namespace repl {
             }
             return false;
         }
+
+        // Index builds are acheived through the use of an insert op on system.indexes.
+        bool isIndexBuildOp(const BSONObj& op) {
+            const char* ns = op["ns"].valuestrsafe();
+            return *ns != '\0' && op["op"].valuestrsafe()[0] == 'i' &&
+                nsToCollectionSubstring(ns) == "system.indexes" && op["o"].isABSONObj();
+        }
+
+        // Whether the index build 'op' can share a collection scan with the index build
+        // 'first': both must be on the same collection and built the same way.
+        bool canBuildIndexesTogether(const BSONObj& first, const BSONObj& op) {
+            if (!isIndexBuildOp(op)) {
+                return false;
+            }
+            const BSONObj firstSpec = first["o"].Obj();
+            const BSONObj spec = op["o"].Obj();
+            return firstSpec["ns"].str() == spec["ns"].str() &&
+                firstSpec["background"].trueValue() == spec["background"].trueValue();
+        }
+
+        /**
+         * Returns the last op of the run of index builds starting at 'it' which can be built
+         * together, or 'it' itself if there is no such run.
+         */
+        std::vector<BSONObj>::const_iterator lastIndexBuildToCoalesce(
+                std::vector<BSONObj>::const_iterator it,
+                std::vector<BSONObj>::const_iterator end) {
+            if (!replCoalesceIndexBuilds || !isIndexBuildOp(*it)) {
+                return it;
+            }
+            std::vector<BSONObj>::const_iterator last = it;
+            while (last + 1 != end && canBuildIndexesTogether(*it, *(last + 1))) {
+                ++last;
+            }
+            return last;
+        }
+
+        /**
+         * Hands the go-ahead to commit from the applier to the writers of a batch applied with
+         * its commits held back.  Each writer applies its ops in one unit of work and then waits
+         * here until the applier holds ParallelBatchWriterMode.
+         *
+         * A reader that holds ParallelBatchWriterMode shared may itself be waiting on a lock the
+         * writers hold until they commit, so a writer which has waited too long for the applier
+         * rolls back instead and is applied again once readers are held off.
+         */
+        class DeferredCommitBatch {
+            MONGO_DISALLOW_COPYING(DeferredCommitBatch);
+        public:
+            explicit DeferredCommitBatch(size_t writers)
+                : _pending(writers),
+                  _allAppliedMillis(0),
+                  _commit(false) {
+            }
+
+            /**
+             * Called by a writer once its ops are applied, or with ok=false once it has rolled
+             * them back.  Returns true when the writer is to commit, false when it is to roll
+             * back.
+             */
+            bool applied(size_t writer, bool ok) {
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                if (!ok) {
+                    _failed.push_back(writer);
+                }
+                if (--_pending == 0) {
+                    _allAppliedMillis = curTimeMillis64();
+                    _cv.notify_all();
+                }
+                if (!ok) {
+                    return false;
+                }
+
+                while (!_commit) {
+                    if (_pending == 0 &&
+                            curTimeMillis64() - _allAppliedMillis > kMaxCommitWaitMillis) {
+                        _failed.push_back(writer);
+                        return false;
+                    }
+                    _cv.timed_wait(lk, boost::posix_time::milliseconds(10));
+                }
+                return true;
+            }
+
+            void waitForWriters() {
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                while (_pending > 0) {
+                    _cv.wait(lk);
+                }
+            }
+
+            void allowCommit() {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _commit = true;
+                _cv.notify_all();
+            }
+
+            /** The writers which rolled back; stable once they have all returned. */
+            std::vector<size_t> failed() {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                return _failed;
+            }
+
+        private:
+            static const long long kMaxCommitWaitMillis = 500;
+
+            boost::mutex _mutex;
+            boost::condition_variable _cv;
+            size_t _pending;
+            long long _allAppliedMillis;
+            bool _commit;
+            std::vector<size_t> _failed;
+        };
+
+        void multiSyncApplyDeferringCommit(const std::vector<BSONObj>* ops,
+                                           SyncTail* st,
+                                           DeferredCommitBatch* batch,
+                                           size_t writer);
     }
 
     SyncTail::SyncTail(BackgroundSyncInterface *q, MultiSyncApplyFunc func) :
         Sync(""), 
         _networkQueue(q), 
         _applyFunc(func),
-        _writerPool(replWriterThreadCount, "repl writer worker "),
-        _prefetcherPool(replPrefetcherThreadCount, "repl prefetch worker ")
+        _writerPool(replWriterThreadCount, "repl writer worker ", &writerPoolStats),
+        _prefetcherPool(replPrefetcherThreadCount, "repl prefetch worker ", &prefetcherPoolStats)
     {}
 
     SyncTail::~SyncTail() {}
@@ -192,6 +393,10 @@ namespace repl {
                 return ok;
             }
             catch ( const WriteConflictException& wce ) {
+                // The unit of work this op is part of has to be retried as a whole.
+                if (txn->lockState()->inAWriteUnitOfWork()) {
+                    throw;
+                }
                 log() << "WriteConflictException while doing oplog application on: " << ns
                       << ", retrying.";
                 createCollection--;
@@ -200,8 +405,31 @@ namespace repl {
         invariant(!"impossible");
     }
 
+    bool SyncTail::syncApplyIndexBuilds(OperationContext* txn, const std::vector<BSONObj>& ops) {
+        if (inShutdown()) {
+            return true;
+        }
+
+        const char* ns = ops[0].getStringField("ns");
+        while (true) {
+            try {
+                Lock::DBLock lk(txn->lockState(), nsToDatabaseSubstring(ns), MODE_X);
+                Client::Context ctx(txn, ns);
+                ctx.getClient()->curop()->reset();
+
+                applyIndexBuildOps_inlock(txn, ctx.db(), ops);
+                opsAppliedStats.increment(ops.size());
+                return true;
+            }
+            catch ( const WriteConflictException& wce ) {
+                log() << "WriteConflictException while building indexes on: " << ns
+                      << ", retrying.";
+            }
+        }
+    }
+
     // The pool threads call this to prefetch each op
-    void SyncTail::prefetchOp(const BSONObj& op) {
+    void SyncTail::prefetchOp(const BSONObj& op, bool batchParticipant) {
         initializePrefetchThread();
 
         const char *ns = op.getStringField("ns");
@@ -210,6 +438,9 @@ namespace repl {
                 // one possible tweak here would be to stay in the read lock for this database 
                 // for multiple prefetches if they are for the same database.
                 OperationContextImpl txn;
+                if (batchParticipant) {
+                    Lock::ParallelBatchWriterMode::iAmABatchParticipant(txn.lockState());
+                }
                 AutoGetCollectionForRead ctx(&txn, ns);
                 Database* db = ctx.getDb();
                 if (db) {
@@ -227,11 +458,11 @@ namespace repl {
     }
 
     // Doles out all the work to the reader pool threads and waits for them to complete
-    void SyncTail::prefetchOps(const std::deque<BSONObj>& ops) {
+    void SyncTail::prefetchOps(const std::deque<BSONObj>& ops, bool batchParticipant) {
         for (std::deque<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
-            _prefetcherPool.schedule(&prefetchOp, *it);
+            _prefetcherPool.schedule(&prefetchOp, *it, batchParticipant);
         }
         _prefetcherPool.join();
     }
@@ -239,20 +470,101 @@ namespace repl {
     // Doles out all the work to the writer pool threads and waits for them to complete
     void SyncTail::applyOps(const std::vector< std::vector<BSONObj> >& writerVectors) {
         TimerHolder timer(&applyBatchStats);
-        for (std::vector< std::vector<BSONObj> >::const_iterator it = writerVectors.begin();
-             it != writerVectors.end();
-             ++it) {
-            if (!it->empty()) {
-                _writerPool.schedule(_applyFunc, boost::cref(*it), this);
+        for (size_t i = 0; i < writerVectors.size(); i++) {
+            if (!writerVectors[i].empty()) {
+                // Writer vectors are filled by namespace hash, so keeping each on the same
+                // worker from batch to batch keeps a namespace's ops on one thread.
+                _writerPool.scheduleWithAffinity(
+                    stdx::bind(_applyFunc, boost::cref(writerVectors[i]), this), i);
+            }
+        }
+        _writerPool.join();
+    }
+
+    bool SyncTail::_canDeferCommits(OperationContext* txn, const std::deque<BSONObj>& ops) {
+        if (!replSnapshotReadsDuringApply || _applyFunc != multiSyncApply ||
+                !getGlobalEnvironment()->getGlobalStorageEngine()->supportsDocLocking()) {
+            return false;
+        }
+
+        // The writers may only take intent locks: one holding an exclusive lock until the batch
+        // commits would stall the other writers on it.  So every op has to be a CRUD op on a
+        // collection which already exists.
+        std::set<std::string> checked;
+        for (std::deque<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+            const char* ns = it->getField("ns").valuestrsafe();
+            if (*ns == '\0' || *ns == '.') {
+                continue;
+            }
+            if (!isCrudOpType(it->getField("op").valuestrsafe()) ||
+                    nsToCollectionSubstring(ns) == "system.indexes") {
+                return false;
+            }
+            if (!checked.insert(ns).second) {
+                continue;
+            }
+
+            ScopedTransaction transaction(txn, MODE_IS);
+            Lock::DBLock dbLock(txn->lockState(), nsToDatabaseSubstring(ns), MODE_IS);
+            Lock::CollectionLock collLock(txn->lockState(), ns, MODE_IS);
+            Database* db = dbHolder().get(txn, nsToDatabaseSubstring(ns));
+            if (!db || !db->getCollection(ns)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void SyncTail::_applyOpsDeferringCommits(
+            const std::vector< std::vector<BSONObj> >& writerVectors,
+            boost::scoped_ptr<Lock::ParallelBatchWriterMode>* pbwm) {
+        TimerHolder timer(&applyBatchStats);
+
+        size_t writers = 0;
+        for (size_t i = 0; i < writerVectors.size(); i++) {
+            if (!writerVectors[i].empty()) {
+                writers++;
             }
         }
+
+        DeferredCommitBatch batch(writers);
+        for (size_t i = 0; i < writerVectors.size(); i++) {
+            if (!writerVectors[i].empty()) {
+                // There is a pool thread for every writer vector, and each holds its vector's
+                // thread until the batch commits, so they all run at once.
+                _writerPool.scheduleWithAffinity(
+                    stdx::bind(&multiSyncApplyDeferringCommit, &writerVectors[i], this, &batch, i),
+                    i);
+            }
+        }
+
+        // Readers are held off only while the batch commits
+        batch.waitForWriters();
+        pbwm->reset(new Lock::ParallelBatchWriterMode());
+        batch.allowCommit();
         _writerPool.join();
+        deferredCommitBatches.increment();
+
+        const std::vector<size_t> failed = batch.failed();
+        for (size_t i = 0; i < failed.size(); i++) {
+            deferredCommitRetries.increment();
+            _writerPool.scheduleWithAffinity(
+                stdx::bind(_applyFunc, boost::cref(writerVectors[failed[i]]), this), failed[i]);
+        }
+        if (!failed.empty()) {
+            LOG(1) << "reapplying " << failed.size() << " of " << writers
+                   << " writer vectors which could not commit with their batch";
+            _writerPool.join();
+        }
     }
 
     // Doles out all the work to the writer pool threads and waits for them to complete
-    OpTime SyncTail::multiApply(OperationContext* txn, std::deque<BSONObj>& ops) {
+    OpTime SyncTail::multiApply(OperationContext* txn,
+                                std::deque<BSONObj>& ops,
+                                bool prefetched,
+                                OpQueueBatcher* batcher) {
 
-        if (getGlobalEnvironment()->getGlobalStorageEngine()->isMmapV1()) {
+        if (!prefetched && getGlobalEnvironment()->getGlobalStorageEngine()->isMmapV1()) {
             // Use a ThreadPool to prefetch all the operations in a batch.
             prefetchOps(ops);
         }
@@ -260,13 +572,19 @@ namespace repl {
         std::vector< std::vector<BSONObj> > writerVectors(replWriterThreadCount);
         fillWriterVectors(ops, &writerVectors);
         LOG(2) << "replication batch size is " << ops.size() << endl;
+        const bool deferCommits = _canDeferCommits(txn, ops);
+
         // We must grab this because we're going to grab write locks later.
         // We hold this mutex the entire time we're writing; it doesn't matter
         // because all readers are blocked anyway.
         SimpleMutex::scoped_lock fsynclk(filesLockedFsync);
 
-        // stop all readers until we're done
-        Lock::ParallelBatchWriterMode pbwm;
+        // stop all readers until we're done.  When the writers hold back their commits, readers
+        // are only stopped once the batch is ready to commit, and see the previous one until then.
+        boost::scoped_ptr<Lock::ParallelBatchWriterMode> pbwm;
+        if (!deferCommits) {
+            pbwm.reset(new Lock::ParallelBatchWriterMode());
+        }
 
         ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
         if (replCoord->getMemberState().primary() &&
@@ -276,14 +594,36 @@ namespace repl {
             fassertFailed(28527);
         }
 
-        applyOps(writerVectors);
-        return applyOpsToOplog(txn, &ops);
+        if (deferCommits) {
+            _applyOpsDeferringCommits(writerVectors, &pbwm);
+        }
+        else {
+            applyOps(writerVectors);
+        }
+
+        // By now the batcher has usually assembled the next batch.
+        const OpTime nextMinValid = batcher ? _nextBatchEnd(batcher) : OpTime();
+        return applyOpsToOplog(txn, &ops, nextMinValid);
     }
 
 
     void SyncTail::fillWriterVectors(const std::deque<BSONObj>& ops,
                                      std::vector< std::vector<BSONObj> >* writerVectors) {
 
+        const bool docLocking =
+            getGlobalEnvironment()->getGlobalStorageEngine()->supportsDocLocking();
+
+        // An insert entry holding several documents has no single _id to hash on, so every op
+        // on its namespace goes to the same writer to keep them in oplog order.
+        std::set<std::string> groupedInsertNamespaces;
+        if (docLocking) {
+            for (std::deque<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+                if (isMultiInsertOp(*it)) {
+                    groupedInsertNamespaces.insert(it->getStringField("ns"));
+                }
+            }
+        }
+
         for (std::deque<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
@@ -296,8 +636,9 @@ namespace repl {
 
             const char* opType = it->getField( "op" ).valuestrsafe();
 
-            if (getGlobalEnvironment()->getGlobalStorageEngine()->supportsDocLocking() &&
-                isCrudOpType(opType)) {
+            if (docLocking &&
+                isCrudOpType(opType) &&
+                (groupedInsertNamespaces.empty() || !groupedInsertNamespaces.count(ns))) {
                 BSONElement id;
                 switch (opType[0]) {
                 case 'u':
@@ -408,81 +749,247 @@ namespace {
     }
 }
 
-    /* tail an oplog.  ok to return, will be re-called. */
-    void SyncTail::oplogApplication() {
-        ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
+    /**
+     * Fills batches from the network queue on its own thread so that the next batch is already
+     * assembled by the time the applier finishes the current one.  At most one complete batch
+     * is buffered; the batcher blocks until the applier has taken it.
+     */
+    class SyncTail::OpQueueBatcher {
+        MONGO_DISALLOW_COPYING(OpQueueBatcher);
+    public:
+        explicit OpQueueBatcher(SyncTail* syncTail)
+            : _syncTail(syncTail),
+              _applierBusy(false),
+              _prefetching(false),
+              _inShutdown(false),
+              _thread(stdx::bind(&OpQueueBatcher::run, this)) {
+        }
 
-        while(!inShutdown()) {
-            OpQueue ops;
+        ~OpQueueBatcher() {
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _inShutdown = true;
+            }
+            _cv.notify_all();
+            _thread.join();
+        }
+
+        /**
+         * Waits up to a second for the next batch.  Returns false if none was ready.  When a
+         * batch is returned the applier is considered busy until batchApplied() is called.
+         */
+        bool getNextBatch(OpQueue* ops) {
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            if (_ready.empty()) {
+                if (_prefetching) {
+                    pipelinedPrefetchWaits.increment();
+                }
+                _cv.timed_wait(lk, boost::posix_time::seconds(1));
+            }
+            if (_ready.empty()) {
+                return false;
+            }
+            _ready.swap(*ops);
+            _applierBusy = true;
+            _cv.notify_all();
+            return true;
+        }
+
+        void batchApplied() {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _applierBusy = false;
+        }
+
+        /**
+         * Returns the optime of the last op in the next batch, or a null OpTime if that batch is
+         * not complete yet.  A complete batch does not change before getNextBatch hands it out.
+         */
+        OpTime peekNextBatchEnd() {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_ready.empty()) {
+                return OpTime();
+            }
+            return _ready.back()["ts"]._opTime();
+        }
+
+    private:
+        /**
+         * Drain may only be signalled when no op taken off the network queue is still waiting
+         * to be applied.  Only this thread fills _ready, so the answer cannot go stale before
+         * the caller acts on it.
+         */
+        bool _nothingInFlight() {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _ready.empty() && !_applierBusy;
+        }
+
+        bool _shouldStop() {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _inShutdown || inShutdown();
+        }
+
+        void run() {
+            Client::initThread("ReplBatcher");
+            cc().getAuthorizationSession()->grantInternalAuthorization();
+
+            try {
+                _run();
+            }
+            catch (const std::exception& e) {
+                // Ops already taken off the network queue would be lost if we carried on.
+                severe() << "replication batcher caught exception: " << e.what();
+                fassertFailed(28610);
+            }
+
+            cc().shutdown();
+        }
+
+        void _run() {
             OperationContextImpl txn;
+            ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
 
-            Timer batchTimer;
-            int lastTimeChecked = 0;
+            while (!_shouldStop()) {
+                OpQueue ops;
+                Timer batchTimer;
 
-            do {
-                int now = batchTimer.seconds();
+                do {
+                    if (ops.empty()) {
+                        BSONObj op;
+                        if (_nothingInFlight() && !_syncTail->peek(&op)) {
+                            replCoord->signalDrainComplete(&txn);
+                        }
+                        continue;
+                    }
 
-                // apply replication batch limits
-                if (!ops.empty()) {
-                    if (now > replBatchLimitSeconds)
+                    // apply replication batch limits
+                    if (batchTimer.seconds() > replBatchLimitSeconds)
                         break;
                     if (ops.getDeque().size() > replBatchLimitOperations)
                         break;
-                }
-                // occasionally check some things
-                // (always checked in the first iteration of this do-while loop, because
-                // ops is empty)
-                if (ops.empty() || now > lastTimeChecked) {
-                    BackgroundSync* bgsync = BackgroundSync::get();
-                    if (bgsync->getInitialSyncRequestedFlag()) {
-                        // got a resync command
-                        return;
-                    }
-                    lastTimeChecked = now;
-                    // can we become secondary?
-                    // we have to check this before calling mgr, as we must be a secondary to
-                    // become primary
-                    tryToGoLiveAsASecondary(&txn, replCoord);
-                }
-
-                const int slaveDelaySecs = replCoord->getSlaveDelaySecs().total_seconds();
-                if (!ops.empty() && slaveDelaySecs > 0) {
-                    const BSONObj& lastOp = ops.getDeque().back();
-                    const unsigned int opTimestampSecs = lastOp["ts"]._opTime().getSecs();
-
-                    // Stop the batch as the lastOp is too new to be applied. If we continue
-                    // on, we can get ops that are way ahead of the delay and this will
-                    // make this thread sleep longer when handleSlaveDelay is called
-                    // and apply ops much sooner than we like.
-                    if (opTimestampSecs > static_cast<unsigned int>(time(0) - slaveDelaySecs)) {
-                        break;
+
+                    const int slaveDelaySecs = replCoord->getSlaveDelaySecs().total_seconds();
+                    if (slaveDelaySecs > 0) {
+                        const BSONObj& lastOp = ops.getDeque().back();
+                        const unsigned int opTimestampSecs = lastOp["ts"]._opTime().getSecs();
+
+                        // Stop the batch as the lastOp is too new to be applied. If we continue
+                        // on, we can get ops that are way ahead of the delay and this will
+                        // make the applier sleep longer when handleSlaveDelay is called
+                        // and apply ops much sooner than we like.
+                        if (opTimestampSecs > static_cast<unsigned int>(time(0) - slaveDelaySecs)) {
+                            break;
+                        }
                     }
+                    // keep fetching more ops as long as we haven't filled up a full batch yet
+                } while (!_syncTail->tryPopAndWaitForMore(&txn, &ops, replCoord) &&
+                         (ops.getSize() < replBatchLimitBytes) &&
+                         !_shouldStop());
+
+                if (ops.empty()) {
+                    continue;
                 }
-                // keep fetching more ops as long as we haven't filled up a full batch yet
-            } while (!tryPopAndWaitForMore(&txn, &ops, replCoord) && // tryPopAndWaitForMore returns
-                                                                     // true when we need to end a
-                                                                     // batch early
-                   (ops.getSize() < replBatchLimitBytes) &&
-                   !inShutdown());
 
-            // For pausing replication in tests
-            while (MONGO_FAIL_POINT(rsSyncApplyStop)) {
-                sleepmillis(0);
+                if (replPipelinedPrefetch) {
+                    _prefetch(&ops);
+                }
+
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                while (!_ready.empty() && !_inShutdown) {
+                    _cv.wait(lk);
+                }
+                if (_inShutdown) {
+                    return;
+                }
+                _ready.swap(ops);
+                _cv.notify_all();
             }
+        }
 
-            if (ops.empty()) {
+        /**
+         * Brings in the pages the batch will touch while the applier is still busy with the
+         * previous one.  The prefetchers run as batch participants so that the applier's
+         * ParallelBatchWriterMode does not hold them off.
+         */
+        void _prefetch(OpQueue* ops) {
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _prefetching = true;
+            }
+            _syncTail->prefetchOps(ops->getDeque(), true);
+            ops->setPrefetched();
+            pipelinedPrefetchBatches.increment();
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _prefetching = false;
+            }
+        }
+
+        SyncTail* const _syncTail;
+
+        // Protects everything below.
+        boost::mutex _mutex;
+        boost::condition_variable _cv;
+
+        // The next batch to apply, empty until the batcher has finished filling one.
+        OpQueue _ready;
+
+        // Whether the applier holds a batch it has not finished applying.
+        bool _applierBusy;
+
+        // Whether the batcher is prefetching a finished batch before handing it over.
+        bool _prefetching;
+
+        bool _inShutdown;
+
+        boost::thread _thread;
+    };
+
+    OpTime SyncTail::_nextBatchEnd(OpQueueBatcher* batcher) {
+        return batcher->peekNextBatchEnd();
+    }
+
+    /* tail an oplog.  ok to return, will be re-called. */
+    void SyncTail::oplogApplication() {
+        ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
+        OpQueueBatcher batcher(this);
+
+        while(!inShutdown()) {
+            OperationContextImpl txn;
+
+            BackgroundSync* bgsync = BackgroundSync::get();
+            if (bgsync->getInitialSyncRequestedFlag()) {
+                // got a resync command
+                return;
+            }
+
+            // can we become secondary?
+            // we have to check this before calling mgr, as we must be a secondary to
+            // become primary
+            tryToGoLiveAsASecondary(&txn, replCoord);
+
+            OpQueue ops;
+            if (!batcher.getNextBatch(&ops)) {
                 continue;
             }
 
+            // For pausing replication in tests
+            while (MONGO_FAIL_POINT(rsSyncApplyStop)) {
+                sleepmillis(0);
+            }
+
             const BSONObj& lastOp = ops.getDeque().back();
             handleSlaveDelay(lastOp);
 
             // Set minValid to the last op to be applied in this next batch.
             // This will cause this node to go into RECOVERING state
-            // if we should crash and restart before updating the oplog
+            // if we should crash and restart before updating the oplog.
+            // The previous batch usually wrote it already, along with its oplog entries.
             OpTime minValid = lastOp["ts"]._opTime();
-            setMinValid(&txn, minValid);
-            multiApply(&txn, ops.getDeque());
+            if (advanceMinValid(&txn, minValid)) {
+                minValidWrites.increment();
+            }
+            multiApply(&txn, ops.getDeque(), ops.prefetched(), &batcher);
+            batcher.batchApplied();
         }
     }
 
@@ -503,7 +1010,6 @@ namespace {
         if (!peek_success) {
             // if we don't have anything in the queue, wait a bit for something to appear
             if (ops->empty()) {
-                replCoord->signalDrainComplete(txn);
                 // block up to 1 second
                 _networkQueue->waitForMore();
                 return false;
@@ -515,6 +1021,17 @@ namespace {
 
         const char* ns = op["ns"].valuestrsafe();
 
+        // a run of index builds which can share a collection scan is applied as one batch
+        if (replCoalesceIndexBuilds && !ops->empty() && isIndexBuildOp(ops->getDeque().front())) {
+            if (!canBuildIndexesTogether(ops->getDeque().front(), op)) {
+                return true;
+            }
+            ops->push_back(op);
+            _networkQueue->consume();
+            coalescedIndexBuilds.increment();
+            return false;
+        }
+
         // check for commands
         if ((op["op"].valuestrsafe()[0] == 'c') ||
             // Index builds are acheived through the use of an insert op, not a command op.
@@ -525,6 +1042,11 @@ namespace {
                 // apply commands one-at-a-time
                 ops->push_back(op);
                 _networkQueue->consume();
+
+                // but look for more index builds to go with this one
+                if (replCoalesceIndexBuilds && isIndexBuildOp(op)) {
+                    return false;
+                }
             }
 
             // otherwise, apply what we have so far and come back for the command
@@ -554,22 +1076,29 @@ namespace {
         return false;
     }
 
-    OpTime SyncTail::applyOpsToOplog(OperationContext* txn, std::deque<BSONObj>* ops) {
+    OpTime SyncTail::applyOpsToOplog(OperationContext* txn,
+                                     std::deque<BSONObj>* ops,
+                                     const OpTime& nextMinValid) {
         OpTime lastOpTime;
         {
             ScopedTransaction transaction(txn, MODE_IX);
             Lock::DBLock lk(txn->lockState(), "local", MODE_X);
             WriteUnitOfWork wunit(txn);
 
-            while (!ops->empty()) {
-                const BSONObj& op = ops->front();
-                // this updates lastOpTimeApplied
-                lastOpTime = _logOpObjRS(txn, op);
-                ops->pop_front();
-             }
+            lastOpTime = _writeOpObjsRS(txn, *ops);
+
+            // Covering the next batch here saves it a separate minValid write before it starts.
+            if (!nextMinValid.isNull() && advanceMinValid(txn, nextMinValid)) {
+                minValidWritesPiggybacked.increment();
+            }
             wunit.commit();
         }
 
+        // Publish the batch's last optime once, rather than once per op, and only after the
+        // lock on the local database has been released.
+        _setLastAppliedOpRS(txn, ops->back());
+        ops->clear();
+
         // This call may result in us assuming PRIMARY role if we'd been waiting for our sync
         // buffer to drain and it's now empty.  This will acquire a global lock to drop all
         // temp collections, so we must release the above lock on the local database before
@@ -639,6 +1168,16 @@ namespace {
              it != ops.end();
              ++it) {
             try {
+                std::vector<BSONObj>::const_iterator last = lastIndexBuildToCoalesce(it, ops.end());
+                if (last != it) {
+                    std::vector<BSONObj> indexBuilds(it, last + 1);
+                    it = last;
+                    if (!st->syncApplyIndexBuilds(&txn, indexBuilds)) {
+                        fassertFailedNoTrace(16359);
+                    }
+                    continue;
+                }
+
                 if (!st->syncApply(&txn, *it, convertUpdatesToUpserts)) {
                     fassertFailedNoTrace(16359);
                 }
@@ -656,6 +1195,55 @@ namespace {
         }
     }
 
+namespace {
+    // The writer threads call this to apply their share of a batch whose commits are held back
+    void multiSyncApplyDeferringCommit(const std::vector<BSONObj>* ops,
+                                       SyncTail* st,
+                                       DeferredCommitBatch* batch,
+                                       size_t writer) {
+        initializeWriterThread();
+
+        OperationContextImpl txn;
+
+        // allow us to get through the magic barrier
+        Lock::ParallelBatchWriterMode::iAmABatchParticipant(txn.lockState());
+
+        boost::scoped_ptr<WriteUnitOfWork> wunit(new WriteUnitOfWork(&txn));
+        bool ok = true;
+        for (std::vector<BSONObj>::const_iterator it = ops->begin();
+             ok && it != ops->end();
+             ++it) {
+            try {
+                if (!st->syncApply(&txn, *it, true)) {
+                    fassertFailedNoTrace(16359);
+                }
+            }
+            catch (const WriteConflictException&) {
+                LOG(1) << "write conflict applying a batch with its commit held back, will "
+                       << "apply again once readers are held off";
+                ok = false;
+            }
+            catch (const DBException& e) {
+                error() << "writer worker caught exception: " << causedBy(e)
+                        << " on: " << it->toString();
+
+                if (!inShutdown()) {
+                    fassertFailedNoTrace(16360);
+                }
+                ok = false;
+            }
+        }
+
+        if (!ok) {
+            // Roll back now, so that the locks this writer holds do not wait for the batch
+            wunit.reset();
+        }
+        if (batch->applied(writer, ok)) {
+            wunit->commit();
+        }
+    }
+}  // namespace
+
     // This free function is used by the initial sync writer threads to apply each op
     void multiInitialSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
         initializeWriterThread();
@@ -669,6 +1257,16 @@ namespace {
              it != ops.end();
              ++it) {
             try {
+                std::vector<BSONObj>::const_iterator last = lastIndexBuildToCoalesce(it, ops.end());
+                if (last != it) {
+                    std::vector<BSONObj> indexBuilds(it, last + 1);
+                    it = last;
+                    if (!st->syncApplyIndexBuilds(&txn, indexBuilds)) {
+                        fassertFailedNoTrace(15915);
+                    }
+                    continue;
+                }
+
                 if (!st->syncApply(&txn, *it)) {
 
                     if (st->shouldRetry(&txn, *it)) {
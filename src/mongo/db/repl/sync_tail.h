@@ -28,11 +28,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <deque>
 
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/repl/sync.h"
-#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
 
 namespace mongo {
 
@@ -54,6 +58,12 @@ namespace repl {
                                const BSONObj &o,
                                bool convertUpdateToUpsert = false);
 
+        /**
+         * Applies index build ops on one collection that can share a collection scan, as
+         * gathered into a batch by tryPopAndWaitForMore.
+         */
+        bool syncApplyIndexBuilds(OperationContext* txn, const std::vector<BSONObj>& ops);
+
         /**
          * Runs _applyOplogUntil(stopOpTime)
          */
@@ -64,7 +74,7 @@ namespace repl {
 
         class OpQueue {
         public:
-            OpQueue() : _size(0) {}
+            OpQueue() : _size(0), _prefetched(false) {}
             size_t getSize() { return _size; }
             std::deque<BSONObj>& getDeque() { return _deque; }
             void push_back(BSONObj& op) {
@@ -80,18 +90,33 @@ namespace repl {
                 return _deque.back();
             }
 
+            // Whether the pages for every op in the queue have already been prefetched.
+            bool prefetched() const { return _prefetched; }
+            void setPrefetched() { _prefetched = true; }
+
+            void swap(OpQueue& other) {
+                _deque.swap(other._deque);
+                std::swap(_size, other._size);
+                std::swap(_prefetched, other._prefetched);
+            }
+
         private:
             std::deque<BSONObj> _deque;
             size_t _size;
+            bool _prefetched;
         };
 
-        // returns true if we should continue waiting for BSONObjs, false if we should
-        // stop waiting and apply the queue we have.  Only returns false if !ops.empty().
+        // returns true if we should stop waiting for BSONObjs and apply the queue we have,
+        // false if we should continue waiting.  Does not signal drain completion; callers
+        // that may be draining are responsible for that once nothing is left in flight.
         bool tryPopAndWaitForMore(OperationContext* txn,
                                   OpQueue* ops,
                                   ReplicationCoordinator* replCoord);
 
     protected:
+        // Gathers the next batch from the network queue while the current one is being applied.
+        class OpQueueBatcher;
+
         // Cap the batches using the limit on journal commits.
         // This works out to be 100 MB (64 bit) or 50 MB (32 bit)
         static const unsigned int replBatchLimitBytes = dur::UncommittedBytesLimit;
@@ -100,8 +125,14 @@ namespace repl {
 
         // Prefetch and write a deque of operations, using the supplied function.
         // Initial Sync and Sync Tail each use a different function.
-        // Returns the last OpTime applied.
-        OpTime multiApply(OperationContext* txn, std::deque<BSONObj>& ops);
+        // Returns the last OpTime applied.  Pass prefetched=true when the ops' pages have
+        // already been brought in, so that the batch is not prefetched a second time.  Given
+        // the batcher, minValid is advanced to the end of its next batch, if that is ready,
+        // along with this batch's oplog writes.
+        OpTime multiApply(OperationContext* txn,
+                          std::deque<BSONObj>& ops,
+                          bool prefetched = false,
+                          OpQueueBatcher* batcher = NULL);
 
         /**
          * Applies oplog entries until reaching "endOpTime".
@@ -111,34 +142,53 @@ namespace repl {
         void _applyOplogUntil(OperationContext* txn, const OpTime& endOpTime);
 
     private:
+        // Returns the optime of the last op in the batcher's next batch, or a null OpTime if it
+        // is not ready.
+        static OpTime _nextBatchEnd(OpQueueBatcher* batcher);
+
         // After ops have been written to db, call this
         // to update local oplog.rs, as well as notify the primary
-        // that we have applied the ops.
+        // that we have applied the ops.  The ops are written in one unit of work, which also
+        // advances minValid to 'nextMinValid' unless that is null.
         // Ops are removed from the deque.
         // Returns the optime of the last op applied.
-        OpTime applyOpsToOplog(OperationContext* txn, std::deque<BSONObj>* ops);
+        OpTime applyOpsToOplog(OperationContext* txn,
+                               std::deque<BSONObj>* ops,
+                               const OpTime& nextMinValid);
 
         BackgroundSyncInterface* _networkQueue;
 
         // Function to use during applyOps
         MultiSyncApplyFunc _applyFunc;
 
-        // Doles out all the work to the reader pool threads and waits for them to complete
-        void prefetchOps(const std::deque<BSONObj>& ops);
+        // Doles out all the work to the reader pool threads and waits for them to complete.
+        // With batchParticipant set the readers are not held off by ParallelBatchWriterMode,
+        // which lets the next batch be prefetched while the current one is being applied.
+        void prefetchOps(const std::deque<BSONObj>& ops, bool batchParticipant = false);
         // Used by the thread pool readers to prefetch an op
-        static void prefetchOp(const BSONObj& op);
+        static void prefetchOp(const BSONObj& op, bool batchParticipant);
 
         // Doles out all the work to the writer pool threads and waits for them to complete
         void applyOps(const std::vector< std::vector<BSONObj> >& writerVectors);
 
+        // Whether the writers can hold back their commits until the whole batch is applied,
+        // which needs replSnapshotReadsDuringApply, document-level locking and ops which only
+        // take intent locks.
+        bool _canDeferCommits(OperationContext* txn, const std::deque<BSONObj>& ops);
+
+        // Like applyOps, but the writers commit only once the batch has been applied in full and
+        // this has acquired 'pbwm', so that until then readers see the previous batch.
+        void _applyOpsDeferringCommits(const std::vector< std::vector<BSONObj> >& writerVectors,
+                                       boost::scoped_ptr<Lock::ParallelBatchWriterMode>* pbwm);
+
         void fillWriterVectors(const std::deque<BSONObj>& ops, 
                                std::vector< std::vector<BSONObj> >* writerVectors);
         void handleSlaveDelay(const BSONObj& op);
 
         // persistent pool of worker threads for writing ops to the databases
-        threadpool::ThreadPool _writerPool;
+        WorkStealingThreadPool _writerPool;
         // persistent pool of worker threads for prefetching
-        threadpool::ThreadPool _prefetcherPool;
+        WorkStealingThreadPool _prefetcherPool;
 
     };
 
@@ -63,9 +63,11 @@ namespace {
         return static_cast<int>(it - vec.begin());
     }
 
-    // Interval between the time the last heartbeat from a node was received successfully, or
-    // the time when we gave up retrying, and when the next heartbeat should be sent to a target.
-    const Milliseconds kHeartbeatInterval(Seconds(2).total_milliseconds());
+    // When the heartbeat interval is configured below the default, a target is considered down
+    // once it has gone this many intervals without answering, or this many of its average round
+    // trips if that is longer, unless the configured heartbeat timeout is shorter still.
+    const int kHeartbeatIntervalsBeforeTimeout = 5;
+    const int kRoundTripsBeforeTimeout = 10;
 
     // Maximum number of retries for a failed heartbeat.
     const int kMaxHeartbeatRetries = 2;
@@ -743,6 +745,38 @@ namespace {
         return -1;
     }
 
+    Milliseconds TopologyCoordinatorImpl::_getHeartbeatInterval() const {
+        return _rsConfig.isInitialized() ?
+                _rsConfig.getHeartbeatInterval() : ReplicaSetConfig::kDefaultHeartbeatInterval;
+    }
+
+    Milliseconds TopologyCoordinatorImpl::_getHeartbeatTimeoutPeriod(
+            const PingStats& hbStats) const {
+        if (!_rsConfig.isInitialized()) {
+            return Milliseconds(
+                    ReplicaSetConfig::kDefaultHeartbeatTimeoutPeriod.total_milliseconds());
+        }
+
+        const Milliseconds configured = _rsConfig.getHeartbeatTimeoutPeriodMillis();
+        const Milliseconds interval = _rsConfig.getHeartbeatInterval();
+        if (interval >= ReplicaSetConfig::kDefaultHeartbeatInterval) {
+            return configured;
+        }
+
+        long long adaptive = interval.total_milliseconds() * kHeartbeatIntervalsBeforeTimeout;
+        if (hbStats.getCount() > 0) {
+            const long long roundTrips =
+                    static_cast<long long>(hbStats.getMillis()) * kRoundTripsBeforeTimeout;
+            if (roundTrips > adaptive) {
+                adaptive = roundTrips;
+            }
+        }
+        if (adaptive >= configured.total_milliseconds()) {
+            return configured;
+        }
+        return Milliseconds(adaptive);
+    }
+
     std::pair<ReplSetHeartbeatArgs, Milliseconds> TopologyCoordinatorImpl::prepareHeartbeatRequest(
                 Date_t now,
                 const std::string& ourSetName,
@@ -752,7 +786,7 @@ namespace {
         Milliseconds alreadyElapsed(now.asInt64() - hbStats.getLastHeartbeatStartDate().asInt64());
         if (!_rsConfig.isInitialized() ||
             (hbStats.getNumFailuresSinceLastStart() > kMaxHeartbeatRetries) ||
-            (alreadyElapsed >= _rsConfig.getHeartbeatTimeoutPeriodMillis())) {
+            (alreadyElapsed >= _getHeartbeatTimeoutPeriod(hbStats))) {
 
             // This is either the first request ever for "target", or the heartbeat timeout has
             // passed, so we're starting a "new" heartbeat.
@@ -776,11 +810,7 @@ namespace {
             hbArgs.setConfigVersion(-2);
         }
 
-        const Milliseconds timeoutPeriod(
-                _rsConfig.isInitialized() ?
-                _rsConfig.getHeartbeatTimeoutPeriodMillis() :
-                Milliseconds(
-                        ReplicaSetConfig::kDefaultHeartbeatTimeoutPeriod.total_milliseconds()));
+        const Milliseconds timeoutPeriod(_getHeartbeatTimeoutPeriod(hbStats));
         const Milliseconds timeout(
                 timeoutPeriod.total_milliseconds() - alreadyElapsed.total_milliseconds());
         return std::make_pair(hbArgs, timeout);
@@ -815,7 +845,7 @@ namespace {
         Date_t nextHeartbeatStartDate;
         if (_rsConfig.isInitialized() &&
             (hbStats.getNumFailuresSinceLastStart() <= kMaxHeartbeatRetries) &&
-            (alreadyElapsed < _rsConfig.getHeartbeatTimeoutPeriodMillis())) {
+            (alreadyElapsed < _getHeartbeatTimeoutPeriod(hbStats))) {
 
             if (!hbResponse.isOK() && !isUnauthorized) {
                 LOG(1) << "Bad heartbeat response from " << target <<
@@ -824,13 +854,13 @@ namespace {
                     "; " << alreadyElapsed.total_milliseconds() << "ms have already elapsed";
             }
             if (isUnauthorized) {
-                nextHeartbeatStartDate = now + kHeartbeatInterval.total_milliseconds();
+                nextHeartbeatStartDate = now + _getHeartbeatInterval().total_milliseconds();
             } else {
                 nextHeartbeatStartDate = now;
             }
         }
         else {
-            nextHeartbeatStartDate = now + kHeartbeatInterval.total_milliseconds();
+            nextHeartbeatStartDate = now + _getHeartbeatInterval().total_milliseconds();
         }
 
         if (hbResponse.isOK() && hbResponse.getValue().hasConfig()) {
@@ -977,7 +1007,7 @@ namespace {
                               << " seconds behind me";
                         const Date_t until = now +
                             LastVote::leaseTime.total_milliseconds() +
-                            kHeartbeatInterval.total_milliseconds();
+                            _getHeartbeatInterval().total_milliseconds();
                         if (_electionSleepUntil < until) {
                             _electionSleepUntil = until;
                         }
@@ -282,6 +282,13 @@ namespace repl {
         // Helper shortcut to self config
         const MemberConfig& _selfConfig() const;
 
+        // Returns the configured heartbeat interval, or the default one if there is no config
+        Milliseconds _getHeartbeatInterval() const;
+
+        // Returns how long a heartbeat to the target with the given stats, including its
+        // retries, may go unanswered before the target is considered down
+        Milliseconds _getHeartbeatTimeoutPeriod(const PingStats& hbStats) const;
+
         // Returns NULL if there is no primary, or the MemberConfig* for the current primary
         const MemberConfig* _currentPrimaryMember() const;
 
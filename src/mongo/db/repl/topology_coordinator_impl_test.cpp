@@ -1662,6 +1662,54 @@ namespace {
         ASSERT_EQUALS(Date_t(firstRequestDate + 7000), action.getNextHeartbeatStartDate());
     }
 
+    TEST_F(TopoCoordTest, ShortHeartbeatIntervalShortensHeartbeatTimeout) {
+        // With a heartbeat interval below the default, a member is considered down after five
+        // intervals without an answer, or ten of its average round trips if that is longer.
+        updateConfig(BSON("_id" << "rs0" <<
+                          "version" << 5 <<
+                          "members" << BSON_ARRAY(
+                              BSON("_id" << 0 << "host" << "host1:27017") <<
+                              BSON("_id" << 1 << "host" << "host2:27017")) <<
+                          "settings" << BSON("heartbeatTimeoutSecs" << 10 <<
+                                             "heartbeatIntervalMillis" << 200)),
+                     0);
+
+        HostAndPort target("host2", 27017);
+        Date_t firstRequestDate = unittest::assertGet(dateFromISOString("2014-08-29T13:00Z"));
+
+        std::pair<ReplSetHeartbeatArgs, Milliseconds> request =
+            getTopoCoord().prepareHeartbeatRequest(firstRequestDate, "rs0", target);
+        ASSERT_EQUALS(1000, request.second.total_milliseconds());
+
+        // A slow but successful heartbeat raises the timeout to ten round trips.
+        ReplSetHeartbeatResponse hb;
+        hb.setVersion(5);
+        hb.setState(MemberState::RS_SECONDARY);
+        HeartbeatResponseAction action =
+            getTopoCoord().processHeartbeatResponse(
+                    firstRequestDate + 300,
+                    Milliseconds(300),
+                    target,
+                    StatusWith<ReplSetHeartbeatResponse>(hb),
+                    OpTime(0, 0));
+        ASSERT_EQUALS(Date_t(firstRequestDate + 500), action.getNextHeartbeatStartDate());
+
+        request = getTopoCoord().prepareHeartbeatRequest(firstRequestDate + 500, "rs0", target);
+        ASSERT_EQUALS(3000, request.second.total_milliseconds());
+
+        // The configured heartbeat timeout remains the upper bound.
+        updateConfig(BSON("_id" << "rs0" <<
+                          "version" << 6 <<
+                          "members" << BSON_ARRAY(
+                              BSON("_id" << 0 << "host" << "host1:27017") <<
+                              BSON("_id" << 1 << "host" << "host2:27017")) <<
+                          "settings" << BSON("heartbeatTimeoutSecs" << 2 <<
+                                             "heartbeatIntervalMillis" << 200)),
+                     0);
+        request = getTopoCoord().prepareHeartbeatRequest(firstRequestDate + 4000, "rs0", target);
+        ASSERT_EQUALS(2000, request.second.total_milliseconds());
+    }
+
     TEST_F(HeartbeatResponseTestOneRetry, HeartbeatTimeoutSuppressesSecondRetry) {
         // Confirm that the topology coordinator does not schedule an second heartbeat retry if
         // the heartbeat timeout period expired before the first retry completed.
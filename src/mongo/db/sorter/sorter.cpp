@@ -50,14 +50,21 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <snappy.h>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/memory_broker.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/checksum.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/huge_pages.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/print.h"
 #include "mongo/util/ptr.h"
@@ -211,10 +218,19 @@ namespace mongo {
                 const bool compressed = rawSize < 0;
                 const int32_t blockSize = std::abs(rawSize);
 
+                Checksum expected;
+                read(expected.bytes, sizeof(expected.bytes));
+                massert(16816, "file too short?", !_done);
+
                 _buffer.reset(new char[blockSize]);
                 read(_buffer.get(), blockSize);
                 massert(16816, "file too short?", !_done);
 
+                Checksum actual;
+                actual.gen(_buffer.get(), blockSize);
+                massert(28612, str::stream() << "checksum mismatch in sort file " << _fileName,
+                        actual == expected);
+
                 if (!compressed) {
                     _reader.reset(new BufReader(_buffer.get(), blockSize));
                     return;
@@ -401,7 +417,22 @@ namespace mongo {
                 , _settings(settings)
                 , _opts(opts)
                 , _memUsed(0)
-            { verify(_opts.limit == 0); }
+                , _runMemoryLimit(opts.spillPool
+                                      ? opts.maxMemoryUsageBytes / (opts.maxPendingSpills + 1)
+                                      : opts.maxMemoryUsageBytes)
+                , _spillsInFlight(0)
+            {
+                verify(_opts.limit == 0);
+                verify(!_opts.spillPool || _opts.maxPendingSpills > 0);
+            }
+
+            ~NoLimitSorter() {
+                // Spills on the pool refer to this sorter so wait for them even if we are
+                // unwinding from an error.
+                boost::unique_lock<boost::mutex> lk(_spillMutex);
+                while (_spillsInFlight > 0)
+                    _spillDone.wait(lk);
+            }
 
             void add(const Key& key, const Value& val) {
                 _data.push_back(std::make_pair(key, val));
@@ -409,22 +440,48 @@ namespace mongo {
                 _memUsed += key.memUsageForSorter();
                 _memUsed += val.memUsageForSorter();
 
-                if (_memUsed > _opts.maxMemoryUsageBytes)
+                // Spill early if the server is short of memory and we are allowed to
+                if (_memUsed > _runMemoryLimit
+                        || (!_memory.set(_memUsed) && _opts.extSortAllowed)) {
                     spill();
+                    _memory.set(_memUsed);
+                }
             }
 
             Iterator* done() {
-                if (_iters.empty()) {
-                    sort();
+                if (_iters.empty() && _pendingSpills.empty()) {
+                    sort(&_data);
                     return new InMemIterator<Key, Value>(_data);
                 }
 
-                spill();
+                if (_opts.spillPool) {
+                    // Write the last run from this thread while the pool finishes the others.
+                    boost::shared_ptr<Iterator> last;
+                    if (!_data.empty()) {
+                        checkExtSortAllowed();
+                        last.reset(writeRun(&_data));
+                        _memUsed = 0;
+                    }
+
+                    waitForSpills(0);
+                    for (size_t i = 0; i < _pendingSpills.size(); i++) {
+                        // The pool may hold on to its copy of the run, so don't leave the
+                        // iterator (and through it the file) there.
+                        _iters.push_back(_pendingSpills[i]->iter);
+                        _pendingSpills[i]->iter.reset();
+                    }
+                    _pendingSpills.clear();
+                    if (last)
+                        _iters.push_back(last);
+                }
+                else {
+                    spill();
+                }
                 return Iterator::merge(_iters, _opts, _comp);
             }
 
             // TEMP these are here for compatibility. Will be replaced with a general stats API
-            int numFiles() const { return _iters.size(); }
+            int numFiles() const { return _iters.size() + _pendingSpills.size(); }
             size_t memUsed() const { return _memUsed; }
 
         private:
@@ -439,19 +496,26 @@ namespace mongo {
                 const Comparator& _comp;
             };
 
-            void sort() {
+            /** A run handed off to SortOptions::spillPool. */
+            struct PendingSpill {
+                PendingSpill() : status(Status::OK()), finished(false) {}
+
+                std::deque<Data> data; // released once written
+                boost::shared_ptr<Iterator> iter; // set once written
+                Status status;
+                bool finished;
+            };
+
+            void sort(std::deque<Data>* data) const {
                 STLComparator less(_comp);
-                std::stable_sort(_data.begin(), _data.end(), less);
+                std::stable_sort(data->begin(), data->end(), less);
 
                 // Does 2x more compares than stable_sort
                 // TODO test on windows
                 //std::sort(_data.begin(), _data.end(), comp);
             }
 
-            void spill() {
-                if (_data.empty())
-                    return;
-
+            void checkExtSortAllowed() const {
                 if (!_opts.extSortAllowed) {
                     // XXX This error message is only correct for aggregation, but it is also the
                     // only way this code could be hit at the moment. If the Sorter is used
@@ -463,25 +527,99 @@ namespace mongo {
                         << " Pass allowDiskUse:true to opt in."
                         );
                 }
+            }
 
-                sort();
+            /// Sorts 'data' and writes it to a new file, leaving 'data' empty.
+            Iterator* writeRun(std::deque<Data>* data) const {
+                sort(data);
 
                 SortedFileWriter<Key, Value> writer(_opts, _settings);
-                for ( ; !_data.empty(); _data.pop_front()) {
-                    writer.addAlreadySorted(_data.front().first, _data.front().second);
+                for ( ; !data->empty(); data->pop_front()) {
+                    writer.addAlreadySorted(data->front().first, data->front().second);
                 }
 
-                _iters.push_back(boost::shared_ptr<Iterator>(writer.done()));
+                return writer.done();
+            }
+
+            void spill() {
+                if (_data.empty())
+                    return;
+
+                checkExtSortAllowed();
+
+                if (!_opts.spillPool) {
+                    _iters.push_back(boost::shared_ptr<Iterator>(writeRun(&_data)));
+                    _memUsed = 0;
+                    return;
+                }
+
+                // Bound the memory held by runs that have not been written yet.
+                waitForSpills(_opts.maxPendingSpills - 1);
 
+                boost::shared_ptr<PendingSpill> run = boost::make_shared<PendingSpill>();
+                run->data.swap(_data);
+                _pendingSpills.push_back(run);
                 _memUsed = 0;
+
+                {
+                    boost::lock_guard<boost::mutex> lk(_spillMutex);
+                    _spillsInFlight++;
+                }
+                _opts.spillPool->schedule(&NoLimitSorter::spillInBackground, this, run);
+            }
+
+            /// Runs on SortOptions::spillPool.
+            void spillInBackground(boost::shared_ptr<PendingSpill> run) {
+                boost::shared_ptr<Iterator> iter;
+                Status status = Status::OK();
+                try {
+                    iter.reset(writeRun(&run->data));
+                }
+                catch (const DBException& e) {
+                    status = e.toStatus();
+                }
+                catch (const std::exception& e) {
+                    status = Status(ErrorCodes::UnknownError, e.what());
+                }
+                std::deque<Data>().swap(run->data);
+
+                boost::lock_guard<boost::mutex> lk(_spillMutex);
+                run->iter.swap(iter); // our reference must be gone once the sorter is told
+                run->status = status;
+                run->finished = true;
+                _spillsInFlight--;
+                _spillDone.notify_all();
+            }
+
+            /**
+             * Waits until at most 'maxInFlight' spills are still running on the pool, then throws
+             * the error from any spill that failed.
+             */
+            void waitForSpills(size_t maxInFlight) {
+                boost::unique_lock<boost::mutex> lk(_spillMutex);
+                while (_spillsInFlight > maxInFlight)
+                    _spillDone.wait(lk);
+
+                for (size_t i = 0; i < _pendingSpills.size(); i++) {
+                    if (_pendingSpills[i]->finished)
+                        massertStatusOK(_pendingSpills[i]->status);
+                }
             }
 
             const Comparator _comp;
             const Settings _settings;
             SortOptions _opts;
             size_t _memUsed;
+            const size_t _runMemoryLimit; // spill once _data uses more than this
+            MemoryReservation _memory; // covers _memUsed
             std::deque<Data> _data; // the "current" data
             std::vector<boost::shared_ptr<Iterator> > _iters; // data that has already been spilled
+
+            // Only used with SortOptions::spillPool. Runs are merged in the order they were added.
+            std::vector<boost::shared_ptr<PendingSpill> > _pendingSpills;
+            boost::mutex _spillMutex; // guards _spillsInFlight and the state of _pendingSpills
+            boost::condition_variable _spillDone;
+            size_t _spillsInFlight;
         };
 
         template <typename Key, typename Value, typename Comparator>
@@ -534,6 +672,8 @@ namespace mongo {
         class TopKSorter : public Sorter<Key, Value> {
         public:
             typedef std::pair<Key, Value> Data;
+            // Heapified and sorted in place, so large limits benefit from huge pages
+            typedef std::vector<Data, HugePageAllocator<Data> > DataVector;
             typedef SortIteratorInterface<Key, Value> Iterator;
             typedef std::pair<typename Key::SorterDeserializeSettings
                              ,typename Value::SorterDeserializeSettings
@@ -577,9 +717,7 @@ namespace mongo {
                     if (_data.size() == _opts.limit)
                         std::make_heap(_data.begin(), _data.end(), less);
 
-                    if (_memUsed > _opts.maxMemoryUsageBytes)
-                        spill();
-
+                    spillIfNeeded();
                     return;
                 }
 
@@ -600,8 +738,7 @@ namespace mongo {
                 _data.back() = contender;
                 std::push_heap(_data.begin(), _data.end(), less);
 
-                if (_memUsed > _opts.maxMemoryUsageBytes)
-                    spill();
+                spillIfNeeded();
             }
 
             Iterator* done() {
@@ -696,7 +833,7 @@ namespace mongo {
 
                 // Add the counters of kept objects better than or equal to _worstSeen/_lastMedian.
                 _worstCount += _data.size(); // everything is better or equal
-                typename std::vector<Data>::iterator firstWorseThanLastMedian =
+                typename DataVector::iterator firstWorseThanLastMedian =
                     std::upper_bound(_data.begin(), _data.end(), _lastMedian, less);
                 _medianCount += std::distance(_data.begin(), firstWorseThanLastMedian);
 
@@ -719,6 +856,16 @@ namespace mongo {
 
             }
 
+            // Spills if over our own limit, or early if the server is short of memory and we
+            // are allowed to.
+            void spillIfNeeded() {
+                if (_memUsed > _opts.maxMemoryUsageBytes
+                        || (!_memory.set(_memUsed) && _opts.extSortAllowed)) {
+                    spill();
+                    _memory.set(_memUsed);
+                }
+            }
+
             void spill() {
                 if (_data.empty())
                     return;
@@ -744,7 +891,7 @@ namespace mongo {
                 }
 
                 // clear _data and release backing array's memory
-                std::vector<Data>().swap(_data);
+                DataVector().swap(_data);
 
                 _iters.push_back(boost::shared_ptr<Iterator>(writer.done()));
 
@@ -755,7 +902,8 @@ namespace mongo {
             const Settings _settings;
             SortOptions _opts;
             size_t _memUsed;
-            std::vector<Data> _data; // the "current" data. Organized as max-heap if size == limit.
+            MemoryReservation _memory; // covers _memUsed
+            DataVector _data; // the "current" data. Organized as max-heap if size == limit.
             std::vector<boost::shared_ptr<Iterator> > _iters; // data that has already been spilled
 
             // See updateCutoff() for a full description of how these members are used.
@@ -783,6 +931,7 @@ namespace mongo {
     SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts,
                                                    const Settings& settings)
         : _settings(settings)
+        , _compress(opts.compressSpills)
     {
         namespace str = mongoutils::str;
 
@@ -828,20 +977,29 @@ namespace mongo {
         if (_buffer.len() == 0)
             return;
 
+        // Each block is its size (negative means compressed), a checksum of the bytes as
+        // written, then the bytes.
+        const char* data = _buffer.buf();
+        int32_t size = _buffer.len();
+
         std::string compressed;
-        snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
-        verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
+        if (_compress) {
+            snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
+            verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
-        try {
             if (compressed.size() < size_t(_buffer.len()/10*9)) {
-                const int32_t size = -int32_t(compressed.size()); // negative means compressed
-                _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-                _file.write(compressed.data(), compressed.size());
-            } else {
-                const int32_t size = _buffer.len();
-                _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-                _file.write(_buffer.buf(), _buffer.len());
+                data = compressed.data();
+                size = -int32_t(compressed.size());
             }
+        }
+
+        Checksum checksum;
+        checksum.gen(data, std::abs(size));
+
+        try {
+            _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            _file.write(reinterpret_cast<const char*>(checksum.bytes), sizeof(checksum.bytes));
+            _file.write(data, std::abs(size));
         } catch (const std::exception&) {
             msgasserted(16821, str::stream() << "error writing to file \"" << _fileName << "\": "
                                              << sorter::myErrnoWithDescription());
@@ -89,6 +89,10 @@ namespace mongo {
         class FileDeleter;
     }
 
+    namespace threadpool {
+        class ThreadPool;
+    }
+
     /**
      * Runtime options that control the Sorter's behavior
      */
@@ -99,10 +103,21 @@ namespace mongo {
         std::string tempDir; /// Directory to directly place files in.
                              /// Must be explicitly set if extSortAllowed is true.
 
+        /// If set, spilled runs are sorted and written on this pool while more data is added.
+        /// Only used when there is no limit. Not owned; must outlive the Sorter.
+        threadpool::ThreadPool* spillPool;
+        /// Most runs that may be waiting on or running in spillPool at once. Each holds up to
+        /// maxMemoryUsageBytes / (maxPendingSpills + 1) so that the total stays the same.
+        size_t maxPendingSpills;
+        bool compressSpills; /// If true, spilled blocks are snappy compressed when that helps.
+
         SortOptions()
             : limit(0)
             , maxMemoryUsageBytes(64*1024*1024)
             , extSortAllowed(false)
+            , spillPool(NULL)
+            , maxPendingSpills(0)
+            , compressSpills(true)
         {}
 
         /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
@@ -126,6 +141,17 @@ namespace mongo {
             tempDir = newTempDir;
             return *this;
         }
+
+        SortOptions& SpillPool(threadpool::ThreadPool* newSpillPool, size_t newMaxPendingSpills) {
+            spillPool = newSpillPool;
+            maxPendingSpills = newMaxPendingSpills;
+            return *this;
+        }
+
+        SortOptions& CompressSpills(bool newCompressSpills=true) {
+            compressSpills = newCompressSpills;
+            return *this;
+        }
     };
 
     /// This is the output from the sorting framework
@@ -201,6 +227,7 @@ namespace mongo {
         void spill();
 
         const Settings _settings;
+        const bool _compress;
         std::string _fileName;
         boost::shared_ptr<sorter::FileDeleter> _fileDeleter; // Must outlive _file
         std::ofstream _file;
@@ -37,6 +37,7 @@
 
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/mongoutils/str.h"
 
 // Need access to internal classes
@@ -243,6 +244,34 @@ namespace mongo {
                 ASSERT_ITERATORS_EQUIVALENT(boost::shared_ptr<IWIterator>(sorter.done()),
                                             make_shared<IntIterator>(0,10*1000*1000));
             }
+            { // big, uncompressed
+                SortedFileWriter<IntWrapper, IntWrapper> sorter(
+                    SortOptions(opts).CompressSpills(false));
+                for (int i=0; i< 1000*1000; i++)
+                    sorter.addAlreadySorted(i,-i);
+
+                ASSERT_ITERATORS_EQUIVALENT(boost::shared_ptr<IWIterator>(sorter.done()),
+                                            make_shared<IntIterator>(0,1000*1000));
+            }
+            { // corrupted block
+                SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+                for (int i=0; i< 100; i++)
+                    sorter.addAlreadySorted(i,-i);
+                boost::shared_ptr<IWIterator> iter(sorter.done());
+
+                // flip a byte of data past the block's size and checksum
+                const boost::filesystem::path file =
+                    boost::filesystem::directory_iterator(tempDir.path())->path();
+                std::fstream stream(file.string().c_str(),
+                                    std::ios::in | std::ios::out | std::ios::binary);
+                stream.seekg(sizeof(int32_t) + sizeof(Checksum) + 10);
+                const char byte = stream.get();
+                stream.seekp(sizeof(int32_t) + sizeof(Checksum) + 10);
+                stream.put(~byte);
+                stream.close();
+
+                ASSERT_THROWS(iter->more(), MsgAssertionException);
+            }
 
             ASSERT(boost::filesystem::is_empty(tempDir.path()));
         }
@@ -500,6 +529,29 @@ namespace mongo {
         };
 
 
+        template <bool Random=true>
+        class LotsOfDataWithSpillPool : public LotsOfDataLittleMemory<Random> {
+            typedef LotsOfDataLittleMemory<Random> Parent;
+        public:
+            LotsOfDataWithSpillPool() : _pool(4, "sorterTestSpill") {}
+
+            SortOptions adjustSortOptions(SortOptions opts) {
+                return Parent::adjustSortOptions(opts).SpillPool(&_pool, 3);
+            }
+
+            void addData(ptr<IWSorter> sorter) {
+                Parent::addData(sorter);
+
+                // each of the up to 4 runs in memory at once gets a quarter of the limit
+                ASSERT_GREATER_THAN_OR_EQUALS(static_cast<size_t>(sorter->numFiles()),
+                                              (Parent::NUM_ITEMS * sizeof(IWPair))
+                                                  / (Parent::MEM_LIMIT / 4));
+            }
+
+        private:
+            ThreadPool _pool;
+        };
+
         template <long long Limit, bool Random=true>
         class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
             typedef LotsOfDataLittleMemory<Random> Parent;
@@ -540,6 +592,8 @@ namespace mongo {
             add<SorterTests::Dupes>();
             add<SorterTests::LotsOfDataLittleMemory</*random=*/false> >();
             add<SorterTests::LotsOfDataLittleMemory</*random=*/true> >();
+            add<SorterTests::LotsOfDataWithSpillPool</*random=*/false> >();
+            add<SorterTests::LotsOfDataWithSpillPool</*random=*/true> >();
             add<SorterTests::LotsOfDataWithLimit<1,/*random=*/false> >(); // limit=1 is special case
             add<SorterTests::LotsOfDataWithLimit<1,/*random=*/true> >();  // limit=1 is special case
             add<SorterTests::LotsOfDataWithLimit<100,/*random=*/false> >(); // fits in mem
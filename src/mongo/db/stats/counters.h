@@ -31,16 +31,16 @@
 
 #include "mongo/platform/basic.h"
 #include "mongo/db/jsobj.h"
-#include "mongo/platform/atomic_word.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/processinfo.h"
-#include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/concurrency/partitioned_counter.h"
 
 namespace mongo {
 
     /**
      * for storing operation counters
-     * note: not thread safe.  ok with that for speed
+     * each counter is partitioned by cpu, so recording an op doesn't contend across cores and
+     * reading the counters sums the partitions
      */
     class OpCounters {
     public:
@@ -59,24 +59,20 @@ namespace mongo {
         BSONObj getObj() const;
         
         // thse are used by snmp, and other things, do not remove
-        const AtomicUInt32 * getInsert() const { return &_insert; }
-        const AtomicUInt32 * getQuery() const { return &_query; }
-        const AtomicUInt32 * getUpdate() const { return &_update; }
-        const AtomicUInt32 * getDelete() const { return &_delete; }
-        const AtomicUInt32 * getGetMore() const { return &_getmore; }
-        const AtomicUInt32 * getCommand() const { return &_command; }
+        long long getInsert() const { return _insert.get(); }
+        long long getQuery() const { return _query.get(); }
+        long long getUpdate() const { return _update.get(); }
+        long long getDelete() const { return _delete.get(); }
+        long long getGetMore() const { return _getmore.get(); }
+        long long getCommand() const { return _command.get(); }
 
     private:
-        void _checkWrap();
-        
-        // todo: there will be a lot of cache line contention on these.  need to do something 
-        //       else eventually.
-        AtomicUInt32 _insert;
-        AtomicUInt32 _query;
-        AtomicUInt32 _update;
-        AtomicUInt32 _delete;
-        AtomicUInt32 _getmore;
-        AtomicUInt32 _command;
+        PartitionedCounter64 _insert;
+        PartitionedCounter64 _query;
+        PartitionedCounter64 _update;
+        PartitionedCounter64 _delete;
+        PartitionedCounter64 _getmore;
+        PartitionedCounter64 _command;
     };
 
     extern OpCounters globalOpCounters;
@@ -84,17 +80,12 @@ namespace mongo {
 
     class NetworkCounter {
     public:
-        NetworkCounter() : _bytesIn(0), _bytesOut(0), _requests(0), _overflows(0) {}
         void hit( long long bytesIn , long long bytesOut );
         void append( BSONObjBuilder& b );
     private:
-        long long _bytesIn;
-        long long _bytesOut;
-        long long _requests;
-
-        long long _overflows;
-
-        SpinLock _lock;
+        PartitionedCounter64 _bytesIn;
+        PartitionedCounter64 _bytesOut;
+        PartitionedCounter64 _requests;
     };
 
     extern NetworkCounter networkCounter;
@@ -0,0 +1,121 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/latency_histogram.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+    LatencyHistogram::LatencyHistogram() {
+        reset();
+    }
+
+    // static
+    size_t LatencyHistogram::bucketFor(uint64_t micros) {
+        if (micros < SubBuckets) {
+            return micros;
+        }
+
+        const int highBit = 63 - countLeadingZeros64(micros);
+        if (highBit >= MaxBits) {
+            return NumBuckets - 1;
+        }
+
+        // Buckets for [2^highBit, 2^(highBit+1)) start after the exact ones below SubBuckets, and
+        // are indexed by the SubBucketBits bits below the highest one.
+        const int shift = highBit - SubBucketBits;
+        return (shift + 1) * SubBuckets + ((micros >> shift) & (SubBuckets - 1));
+    }
+
+    // static
+    uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+        if (bucket < SubBuckets) {
+            return bucket;
+        }
+
+        const int shift = bucket / SubBuckets - 1;
+        const uint64_t subBucket = bucket % SubBuckets;
+        return ((SubBuckets + subBucket + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::record(uint64_t micros) {
+        _buckets[bucketFor(micros)]++;
+        _count++;
+        _totalMicros += micros;
+        _maxMicros = std::max(_maxMicros, static_cast<long long>(micros));
+    }
+
+    void LatencyHistogram::add(const LatencyHistogram& other) {
+        for (size_t i = 0; i < NumBuckets; i++) {
+            _buckets[i] += other._buckets[i];
+        }
+        _count += other._count;
+        _totalMicros += other._totalMicros;
+        _maxMicros = std::max(_maxMicros, other._maxMicros);
+    }
+
+    void LatencyHistogram::reset() {
+        _count = 0;
+        _totalMicros = 0;
+        _maxMicros = 0;
+        memset(_buckets, 0, sizeof(_buckets));
+    }
+
+    long long LatencyHistogram::percentile(double fraction) const {
+        if (_count == 0) {
+            return 0;
+        }
+
+        // The rank of the latency we are looking for, counting from 1.
+        const long long rank = std::max(1LL, static_cast<long long>(fraction * _count + 0.5));
+
+        long long seen = 0;
+        for (size_t i = 0; i < NumBuckets; i++) {
+            seen += _buckets[i];
+            if (seen >= rank) {
+                return std::min(static_cast<long long>(bucketUpperBound(i)), _maxMicros);
+            }
+        }
+        return _maxMicros;
+    }
+
+    void LatencyHistogram::append(BSONObjBuilder* builder) const {
+        builder->appendNumber("count", _count);
+        builder->appendNumber("totalMicros", _totalMicros);
+        builder->appendNumber("p50", percentile(0.50));
+        builder->appendNumber("p99", percentile(0.99));
+        builder->appendNumber("p999", percentile(0.999));
+        builder->appendNumber("max", _maxMicros);
+    }
+
+} // namespace mongo
@@ -0,0 +1,89 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Log-linear histogram of latencies in microseconds, in the style of HDR histograms.
+     *
+     * Each power of two is split into SubBuckets equally sized buckets, so a reported percentile
+     * is at most 1/SubBuckets above the true value. Latencies below SubBuckets micros are exact,
+     * and ones above 2^MaxBits micros (about 19 hours) are counted in the last bucket.
+     *
+     * Not thread safe: callers serialize record() and the readers.
+     */
+    class LatencyHistogram {
+    public:
+        LatencyHistogram();
+
+        void record(uint64_t micros);
+
+        /** Adds the latencies recorded in 'other' to this histogram. */
+        void add(const LatencyHistogram& other);
+
+        void reset();
+
+        long long count() const { return _count; }
+
+        /**
+         * Returns the latency that at least 'fraction' of the recorded latencies don't exceed,
+         * rounded up to the end of its bucket. Returns 0 if nothing has been recorded.
+         */
+        long long percentile(double fraction) const;
+
+        /**
+         * Appends the count, total, p50, p99, p999 and max to 'builder'.
+         */
+        void append(BSONObjBuilder* builder) const;
+
+        static size_t bucketFor(uint64_t micros);
+
+        /** Returns the largest latency which falls into 'bucket'. */
+        static uint64_t bucketUpperBound(size_t bucket);
+
+        enum {
+            SubBucketBits = 3,
+            SubBuckets = 1 << SubBucketBits,
+            MaxBits = 36,
+            NumBuckets = SubBuckets * (MaxBits - SubBucketBits + 1)
+        };
+
+    private:
+        long long _count;
+        long long _totalMicros;
+        long long _maxMicros;
+        long long _buckets[NumBuckets];
+    };
+
+} // namespace mongo
@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::LatencyHistogram;
+
+    TEST(LatencyHistogramTest, SmallLatenciesAreExact) {
+        for (uint64_t micros = 0; micros < LatencyHistogram::SubBuckets; micros++) {
+            ASSERT_EQUALS(micros, LatencyHistogram::bucketFor(micros));
+            ASSERT_EQUALS(micros, LatencyHistogram::bucketUpperBound(micros));
+        }
+    }
+
+    TEST(LatencyHistogramTest, BucketsCoverEveryLatency) {
+        // Each latency falls in a bucket whose upper bound is at or above it, and below the upper
+        // bound of the previous bucket.
+        for (uint64_t micros = 1; micros < 100 * 1000; micros++) {
+            const size_t bucket = LatencyHistogram::bucketFor(micros);
+            ASSERT_LESS_THAN(bucket, size_t(LatencyHistogram::NumBuckets));
+            ASSERT_GREATER_THAN_OR_EQUALS(LatencyHistogram::bucketUpperBound(bucket), micros);
+            ASSERT_LESS_THAN(LatencyHistogram::bucketUpperBound(bucket - 1), micros);
+        }
+    }
+
+    TEST(LatencyHistogramTest, BucketErrorIsBounded) {
+        for (uint64_t micros = LatencyHistogram::SubBuckets; micros < (1ULL << 30); micros *= 3) {
+            const uint64_t upper =
+                LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(micros));
+            ASSERT_LESS_THAN_OR_EQUALS(upper - micros, micros / LatencyHistogram::SubBuckets);
+        }
+    }
+
+    TEST(LatencyHistogramTest, HugeLatenciesGoInTheLastBucket) {
+        ASSERT_EQUALS(size_t(LatencyHistogram::NumBuckets - 1),
+                      LatencyHistogram::bucketFor(1ULL << LatencyHistogram::MaxBits));
+        ASSERT_EQUALS(size_t(LatencyHistogram::NumBuckets - 1),
+                      LatencyHistogram::bucketFor(~0ULL));
+    }
+
+    TEST(LatencyHistogramTest, Percentiles) {
+        LatencyHistogram histogram;
+        ASSERT_EQUALS(0, histogram.percentile(0.5));
+
+        // 1..1000 micros, once each.
+        for (uint64_t micros = 1; micros <= 1000; micros++) {
+            histogram.record(micros);
+        }
+        ASSERT_EQUALS(1000, histogram.count());
+
+        const long long p50 = histogram.percentile(0.5);
+        ASSERT_GREATER_THAN_OR_EQUALS(p50, 500);
+        ASSERT_LESS_THAN_OR_EQUALS(p50, 500 + 500 / LatencyHistogram::SubBuckets);
+
+        const long long p99 = histogram.percentile(0.99);
+        ASSERT_GREATER_THAN_OR_EQUALS(p99, 990);
+        ASSERT_LESS_THAN_OR_EQUALS(p99, 1000);
+
+        // Never reports more than the largest latency recorded.
+        ASSERT_EQUALS(1000, histogram.percentile(1.0));
+    }
+
+    TEST(LatencyHistogramTest, AddAndReset) {
+        LatencyHistogram a;
+        LatencyHistogram b;
+        a.record(10);
+        b.record(20);
+        b.record(30);
+
+        a.add(b);
+        ASSERT_EQUALS(3, a.count());
+        ASSERT_EQUALS(30, a.percentile(1.0));
+
+        BSONObjBuilder builder;
+        a.append(&builder);
+        const BSONObj obj = builder.obj();
+        ASSERT_EQUALS(3, obj["count"].numberLong());
+        ASSERT_EQUALS(60, obj["totalMicros"].numberLong());
+        ASSERT_EQUALS(30, obj["max"].numberLong());
+
+        a.reset();
+        ASSERT_EQUALS(0, a.count());
+        ASSERT_EQUALS(0, a.percentile(0.99));
+    }
+
+} // namespace
@@ -28,8 +28,13 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/concurrency/lock_contention_profiler.h"
 #include "mongo/db/concurrency/lock_stats.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
@@ -122,6 +127,10 @@ namespace {
     } globalLockServerStatusSection;
 
 
+    /**
+     * { locks: { contention: N } } adds the N most contended resources, as reported by the
+     * lockContention command, under "contention".
+     */
     class LockStatsServerStatusSection : public ServerStatusSection {
     public:
         LockStatsServerStatusSection() : ServerStatusSection("locks") { }
@@ -137,10 +146,78 @@ namespace {
 
             stats.report(&ret);
 
+            if (configElement.type() == Object) {
+                const BSONElement contention = configElement.Obj()["contention"];
+                if (contention.trueValue()) {
+                    const long long topN = contention.isNumber() ? contention.numberLong() : 0;
+                    BSONObjBuilder contentionBuilder(ret.subobjStart("contention"));
+                    LockContentionProfiler::global.report(
+                        &contentionBuilder, topN > 0 ? topN : defaultTopN);
+                    contentionBuilder.done();
+                }
+            }
+
             return ret.obj();
         }
 
+    private:
+        enum { defaultTopN = 10 };
+
     } lockStatsServerStatusSection;
 
+
+    /**
+     * { lockContention: 1, top: <N>, reset: <bool> } reports the wait time histograms of the N
+     * resources (default 10) whose lock acquisitions have waited longest, and optionally starts
+     * the profile over.
+     */
+    class LockContentionCmd : public Command {
+    public:
+        LockContentionCmd() : Command("lockContention") { }
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+
+        virtual void help(std::stringstream& help) const {
+            help << "resources with the most lock wait time, with wait time histograms in micros"
+                 << "\n{ lockContention: 1, top: <number of resources>, reset: <bool> }";
+        }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::serverStatus);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const std::string& dbname,
+                         BSONObj& cmdObj,
+                         int options,
+                         std::string& errmsg,
+                         BSONObjBuilder& result,
+                         bool fromRepl) {
+            long long topN = 10;
+            const BSONElement topElement = cmdObj["top"];
+            if (!topElement.eoo()) {
+                if (!topElement.isNumber() || topElement.numberLong() <= 0) {
+                    return appendCommandStatus(result,
+                                               Status(ErrorCodes::BadValue,
+                                                      "top must be a positive number"));
+                }
+                topN = topElement.numberLong();
+            }
+
+            LockContentionProfiler::global.report(&result, topN);
+            if (cmdObj["reset"].trueValue()) {
+                LockContentionProfiler::global.reset();
+            }
+            return true;
+        }
+
+    } lockContentionCmd;
+
 } // namespace
 } // namespace mongo
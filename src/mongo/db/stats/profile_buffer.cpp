@@ -0,0 +1,153 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/profile_buffer.h"
+
+#include <algorithm>
+
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+    bool entrySeqLess(const ProfileBuffer::Entry& lhs, const ProfileBuffer::Entry& rhs) {
+        return lhs.seq < rhs.seq;
+    }
+
+} // namespace
+
+    ProfileBuffer::Shard::Shard()
+        : mutex("ProfileBuffer"),
+          random(static_cast<int64_t>(curTimeMicros64() ^ reinterpret_cast<uintptr_t>(this))),
+          start(0),
+          size(0) {
+    }
+
+    ProfileBuffer::ProfileBuffer(size_t capacity)
+        : _shardCapacity(std::max<size_t>(1, (capacity + NumShards - 1) / NumShards)),
+          _shards(new Shard[NumShards]) {
+        for (int i = 0; i < NumShards; i++) {
+            _shards[i].ring.resize(_shardCapacity);
+        }
+    }
+
+    bool ProfileBuffer::sample(size_t shardHint, double rate) {
+        if (rate >= 1.0) {
+            return true;
+        }
+        if (rate <= 0.0) {
+            return false;
+        }
+
+        Shard& shard = _shardFor(shardHint);
+        SimpleMutex::scoped_lock lk(shard.mutex);
+        const int32_t resolution = 1 << 20;
+        return shard.random.nextInt32(resolution) < static_cast<int32_t>(rate * resolution);
+    }
+
+    void ProfileBuffer::append(size_t shardHint, const std::string& dbName, const BSONObj& doc) {
+        Shard& shard = _shardFor(shardHint);
+        SimpleMutex::scoped_lock lk(shard.mutex);
+
+        size_t slot;
+        if (shard.size < _shardCapacity) {
+            slot = (shard.start + shard.size) % _shardCapacity;
+            shard.size++;
+        }
+        else {
+            slot = shard.start;
+            shard.start = (shard.start + 1) % _shardCapacity;
+            _overwritten.fetchAndAdd(1);
+        }
+
+        Entry& entry = shard.ring[slot];
+        entry.seq = _nextSeq.fetchAndAdd(1);
+        entry.dbName = dbName;
+        entry.doc = doc.getOwned();
+    }
+
+    void ProfileBuffer::copy(const std::string& dbName, std::vector<BSONObj>* docs) const {
+        std::vector<Entry> entries;
+        for (int i = 0; i < NumShards; i++) {
+            const Shard& shard = _shards[i];
+            SimpleMutex::scoped_lock lk(shard.mutex);
+            for (size_t j = 0; j < shard.size; j++) {
+                const Entry& entry = shard.ring[(shard.start + j) % _shardCapacity];
+                if (entry.dbName == dbName) {
+                    entries.push_back(entry);
+                }
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(), entrySeqLess);
+        for (size_t i = 0; i < entries.size(); i++) {
+            docs->push_back(entries[i].doc);
+        }
+    }
+
+    void ProfileBuffer::drain(std::vector<Entry>* entries) {
+        const size_t firstNew = entries->size();
+        for (int i = 0; i < NumShards; i++) {
+            Shard& shard = _shards[i];
+            SimpleMutex::scoped_lock lk(shard.mutex);
+            for (size_t j = 0; j < shard.size; j++) {
+                Entry& entry = shard.ring[(shard.start + j) % _shardCapacity];
+                entries->push_back(entry);
+                entry = Entry();
+            }
+            shard.start = 0;
+            shard.size = 0;
+        }
+
+        std::sort(entries->begin() + firstNew, entries->end(), entrySeqLess);
+    }
+
+    void ProfileBuffer::clear(const std::string& dbName) {
+        for (int i = 0; i < NumShards; i++) {
+            Shard& shard = _shards[i];
+            SimpleMutex::scoped_lock lk(shard.mutex);
+
+            // Compact the entries of other databases to the front of the ring.
+            size_t kept = 0;
+            for (size_t j = 0; j < shard.size; j++) {
+                Entry& entry = shard.ring[(shard.start + j) % _shardCapacity];
+                if (entry.dbName != dbName) {
+                    std::swap(shard.ring[(shard.start + kept) % _shardCapacity], entry);
+                    kept++;
+                }
+            }
+            for (size_t j = kept; j < shard.size; j++) {
+                shard.ring[(shard.start + j) % _shardCapacity] = Entry();
+            }
+            shard.size = kept;
+        }
+    }
+
+} // namespace mongo
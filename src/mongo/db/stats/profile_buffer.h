@@ -0,0 +1,118 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/scoped_array.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * Fixed size in-memory store for profiler documents, used in place of system.profile writes.
+     *
+     * The buffer is split into NumShards rings, each with its own mutex, so that operations
+     * running on different threads rarely contend.  Callers pick a ring with a 'shardHint' that
+     * is stable per thread or client.  Once a ring is full, new documents overwrite its oldest
+     * ones.  Readers merge the rings back into insertion order.
+     */
+    class ProfileBuffer {
+        MONGO_DISALLOW_COPYING(ProfileBuffer);
+    public:
+        struct Entry {
+            Entry() : seq(0) {}
+
+            long long seq;
+            std::string dbName;
+            BSONObj doc;
+        };
+
+        enum { NumShards = 16 };
+
+        /**
+         * Creates a buffer holding about 'capacity' documents, at least one per ring.
+         */
+        explicit ProfileBuffer(size_t capacity);
+
+        /**
+         * Returns true for about 'rate' of the calls, using the random generator of the ring
+         * picked by 'shardHint'.
+         */
+        bool sample(size_t shardHint, double rate);
+
+        void append(size_t shardHint, const std::string& dbName, const BSONObj& doc);
+
+        /**
+         * Appends copies of the buffered documents of 'dbName', oldest first, to 'docs'.
+         */
+        void copy(const std::string& dbName, std::vector<BSONObj>* docs) const;
+
+        /**
+         * Removes every buffered document and appends them, oldest first, to 'entries'.
+         */
+        void drain(std::vector<Entry>* entries);
+
+        /**
+         * Removes the buffered documents of 'dbName'.
+         */
+        void clear(const std::string& dbName);
+
+        size_t capacity() const { return _shardCapacity * NumShards; }
+
+        /** Number of documents appended since startup. */
+        long long appended() const { return _nextSeq.load(); }
+
+        /** Number of documents overwritten before anyone read or drained them. */
+        long long overwritten() const { return _overwritten.load(); }
+
+    private:
+        struct Shard {
+            Shard();
+
+            mutable SimpleMutex mutex;
+            PseudoRandom random;
+            std::vector<Entry> ring;
+            size_t start;
+            size_t size;
+        };
+
+        Shard& _shardFor(size_t shardHint) { return _shards[shardHint % NumShards]; }
+
+        const size_t _shardCapacity;
+        boost::scoped_array<Shard> _shards;
+        AtomicInt64 _nextSeq;
+        AtomicInt64 _overwritten;
+    };
+
+} // namespace mongo
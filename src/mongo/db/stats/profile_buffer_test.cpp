@@ -0,0 +1,140 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/profile_buffer.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::ProfileBuffer;
+    using std::vector;
+
+    BSONObj doc(int i) {
+        return BSON("i" << i);
+    }
+
+    TEST(ProfileBufferTest, CopyMergesShardsInInsertionOrder) {
+        ProfileBuffer buffer(100);
+        for (int i = 0; i < 50; i++) {
+            buffer.append(i * 7, i % 2 ? "a" : "b", doc(i));
+        }
+
+        vector<BSONObj> docs;
+        buffer.copy("a", &docs);
+        ASSERT_EQUALS(25U, docs.size());
+        for (size_t i = 0; i < docs.size(); i++) {
+            ASSERT_EQUALS(static_cast<int>(2 * i + 1), docs[i]["i"].numberInt());
+        }
+        ASSERT_EQUALS(50, buffer.appended());
+        ASSERT_EQUALS(0, buffer.overwritten());
+    }
+
+    TEST(ProfileBufferTest, FullShardOverwritesItsOldestDocuments) {
+        ProfileBuffer buffer(ProfileBuffer::NumShards * 4);
+        for (int i = 0; i < 10; i++) {
+            buffer.append(3, "db", doc(i));
+        }
+
+        vector<BSONObj> docs;
+        buffer.copy("db", &docs);
+        ASSERT_EQUALS(4U, docs.size());
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQUALS(6 + i, docs[i]["i"].numberInt());
+        }
+        ASSERT_EQUALS(6, buffer.overwritten());
+    }
+
+    TEST(ProfileBufferTest, DrainEmptiesTheBuffer) {
+        ProfileBuffer buffer(64);
+        for (int i = 0; i < 20; i++) {
+            buffer.append(i, "db" + std::string(1, 'a' + i % 3), doc(i));
+        }
+
+        vector<ProfileBuffer::Entry> entries;
+        buffer.drain(&entries);
+        ASSERT_EQUALS(20U, entries.size());
+        for (int i = 0; i < 20; i++) {
+            ASSERT_EQUALS(i, entries[i].doc["i"].numberInt());
+            ASSERT_EQUALS("db" + std::string(1, 'a' + i % 3), entries[i].dbName);
+        }
+
+        entries.clear();
+        buffer.drain(&entries);
+        ASSERT_TRUE(entries.empty());
+
+        // The rings are reusable after a drain.
+        buffer.append(0, "db", doc(100));
+        vector<BSONObj> docs;
+        buffer.copy("db", &docs);
+        ASSERT_EQUALS(1U, docs.size());
+    }
+
+    TEST(ProfileBufferTest, ClearOnlyRemovesOneDatabase) {
+        ProfileBuffer buffer(ProfileBuffer::NumShards * 8);
+        for (int i = 0; i < 24; i++) {
+            // Wrap the ring of shard 5 so that compaction starts mid-ring.
+            buffer.append(5, i % 2 ? "keep" : "drop", doc(i));
+        }
+
+        buffer.clear("drop");
+
+        vector<BSONObj> docs;
+        buffer.copy("drop", &docs);
+        ASSERT_TRUE(docs.empty());
+
+        buffer.copy("keep", &docs);
+        ASSERT_EQUALS(4U, docs.size());
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQUALS(17 + 2 * i, docs[i]["i"].numberInt());
+        }
+
+        buffer.append(5, "keep", doc(24));
+        docs.clear();
+        buffer.copy("keep", &docs);
+        ASSERT_EQUALS(5U, docs.size());
+        ASSERT_EQUALS(24, docs.back()["i"].numberInt());
+    }
+
+    TEST(ProfileBufferTest, SampleRate) {
+        ProfileBuffer buffer(16);
+        int sampled = 0;
+        for (int i = 0; i < 10000; i++) {
+            ASSERT_TRUE(buffer.sample(i, 1.0));
+            ASSERT_FALSE(buffer.sample(i, 0.0));
+            if (buffer.sample(i, 0.25)) {
+                sampled++;
+            }
+        }
+        ASSERT_GREATER_THAN(sampled, 2000);
+        ASSERT_LESS_THAN(sampled, 3000);
+    }
+
+} // namespace
@@ -38,6 +38,9 @@ namespace mongo {
      * Sample format:
      *
      * rangeDeleter: {
+     *   workers: 1,
+     *   pendingDeletes: 2,
+     *   deletesInProgress: 1,
      *   lastDeleteStats: [
      *     {
      *       deleteDocs: NumberLong(5);
@@ -65,6 +68,10 @@ namespace mongo {
             }
 
             BSONObjBuilder result;
+            result.append("workers", static_cast<int>(deleter->getNumWorkers()));
+            result.append("pendingDeletes", static_cast<int>(deleter->getPendingDeletes()));
+            result.append("deletesInProgress",
+                          static_cast<int>(deleter->getDeletesInProgress()));
 
             OwnedPointerVector<DeleteJobStats> statsList;
             deleter->getStatsHistory(&statsList.mutableVector());
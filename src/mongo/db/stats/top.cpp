@@ -37,6 +37,8 @@
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/util/concurrency/partitioned_counter.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
 #include "mongo/db/commands.h"
@@ -67,19 +69,71 @@ namespace mongo {
 
     }
 
+    void Top::CollectionData::add( const CollectionData& other ) {
+        total.add( other.total );
+        readLock.add( other.readLock );
+        writeLock.add( other.writeLock );
+        queries.add( other.queries );
+        getmore.add( other.getmore );
+        insert.add( other.insert );
+        update.add( other.update );
+        remove.add( other.remove );
+        commands.add( other.commands );
+    }
+
+    void Top::OperationLatencies::record( Kind kind, long long micros ) {
+        boost::shared_ptr<LatencyHistogram>& histogram = histograms[kind];
+        if ( !histogram ) {
+            histogram.reset( new LatencyHistogram() );
+        }
+        histogram->record( micros );
+    }
+
+    void Top::OperationLatencies::add( const OperationLatencies& other ) {
+        for ( int i = 0; i < NumKinds; i++ ) {
+            if ( !other.histograms[i] ) {
+                continue;
+            }
+            if ( !histograms[i] ) {
+                histograms[i].reset( new LatencyHistogram() );
+            }
+            histograms[i]->add( *other.histograms[i] );
+        }
+    }
+
+    void Top::OperationLatencies::append( BSONObjBuilder& b, bool includeEmpty ) const {
+        static const char* const kindNames[NumKinds] = { "reads", "writes", "commands", "getmores" };
+
+        for ( int i = 0; i < NumKinds; i++ ) {
+            if ( !histograms[i] && !includeEmpty ) {
+                continue;
+            }
+            BSONObjBuilder bb( b.subobjStart( kindNames[i] ) );
+            if ( histograms[i] )
+                histograms[i]->append( &bb );
+            else
+                LatencyHistogram().append( &bb );
+            bb.done();
+        }
+    }
+
     void Top::record( const StringData& ns, int op, int lockType, long long micros, bool command ) {
         if ( ns[0] == '?' )
             return;
 
         //cout << "record: " << ns << "\t" << op << "\t" << command << endl;
-        SimpleMutex::scoped_lock lk(_lock);
-
-        if ( ( command || op == dbQuery ) && ns == _lastDropped ) {
-            _lastDropped = "";
-            return;
+        if ( ( command || op == dbQuery ) && _haveLastDropped.loadRelaxed() ) {
+            SimpleMutex::scoped_lock lk(_lastDroppedLock);
+            if ( ns == _lastDropped ) {
+                _lastDropped = "";
+                _haveLastDropped.store(0);
+                return;
+            }
         }
 
-        CollectionData& coll = _usage[ns];
+        Partition& partition = _partitions[currentCpuPartition(NumPartitions)];
+        SimpleMutex::scoped_lock lk(partition.lock);
+        CollectionData& coll = partition.usage[ns];
         _record( coll, op, lockType, micros, command );
     }
 
@@ -126,19 +180,102 @@ namespace mongo {
     }
 
     void Top::collectionDropped( const StringData& ns ) {
-        SimpleMutex::scoped_lock lk(_lock);
-        _usage.erase(ns);
-        _lastDropped = ns.toString();
+        {
+            SimpleMutex::scoped_lock lk(_lastDroppedLock);
+            _lastDropped = ns.toString();
+            _haveLastDropped.store(1);
+        }
+
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            SimpleMutex::scoped_lock lk(_partitions[i].lock);
+            _partitions[i].usage.erase(ns);
+            _partitions[i].latencies.erase(ns);
+        }
+    }
+
+    void Top::recordLatency( const StringData& ns, int op, bool command, long long micros ) {
+        OperationLatencies::Kind kind;
+        switch ( op ) {
+        case dbQuery:
+            kind = command ? OperationLatencies::Commands : OperationLatencies::Reads;
+            break;
+        case dbGetMore:
+            kind = OperationLatencies::GetMores;
+            break;
+        case dbInsert:
+        case dbUpdate:
+        case dbDelete:
+            kind = OperationLatencies::Writes;
+            break;
+        default:
+            return;
+        }
+
+        Partition& partition = _partitions[currentCpuPartition(NumPartitions)];
+        SimpleMutex::scoped_lock lk(partition.lock);
+        partition.totalLatencies.record( kind, micros );
+        if ( !ns.empty() && ns[0] != '?' )
+            partition.latencies[ns].record( kind, micros );
+    }
+
+    void Top::appendLatencies( BSONObjBuilder& b, bool includeNamespaces ) const {
+        OperationLatencies total;
+        LatencyMap byNamespace;
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            SimpleMutex::scoped_lock lk(_partitions[i].lock);
+            total.add( _partitions[i].totalLatencies );
+            if ( !includeNamespaces )
+                continue;
+
+            const LatencyMap& latencies = _partitions[i].latencies;
+            for ( LatencyMap::const_iterator it = latencies.begin(); it != latencies.end(); ++it ) {
+                byNamespace[it->first].add( it->second );
+            }
+        }
+
+        b.append( "note", "all times in microseconds" );
+        total.append( b, true );
+
+        if ( includeNamespaces ) {
+            vector<string> names;
+            for ( LatencyMap::const_iterator i = byNamespace.begin(); i != byNamespace.end(); ++i ) {
+                names.push_back( i->first );
+            }
+            std::sort( names.begin(), names.end() );
+
+            BSONObjBuilder nsBuilder( b.subobjStart( "namespaces" ) );
+            for ( size_t i = 0; i < names.size(); i++ ) {
+                BSONObjBuilder bb( nsBuilder.subobjStart( names[i] ) );
+                byNamespace.find( names[i] )->second.append( bb, false );
+                bb.done();
+            }
+            nsBuilder.done();
+        }
+    }
+
+    void Top::resetLatencies() {
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            SimpleMutex::scoped_lock lk(_partitions[i].lock);
+            _partitions[i].totalLatencies = OperationLatencies();
+            _partitions[i].latencies = LatencyMap();
+        }
     }
 
     void Top::cloneMap(Top::UsageMap& out) const {
-        SimpleMutex::scoped_lock lk(_lock);
-        out = _usage;
+        out = UsageMap();
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            SimpleMutex::scoped_lock lk(_partitions[i].lock);
+            const UsageMap& usage = _partitions[i].usage;
+            for ( UsageMap::const_iterator it = usage.begin(); it != usage.end(); ++it ) {
+                out[it->first].add( it->second );
+            }
+        }
     }
 
     void Top::append( BSONObjBuilder& b ) {
-        SimpleMutex::scoped_lock lk( _lock );
-        _appendToUsageMap( b, _usage );
+        UsageMap usage;
+        cloneMap( usage );
+        _appendToUsageMap( b, usage );
     }
 
     void Top::_appendToUsageMap( BSONObjBuilder& b, const UsageMap& map ) const {
@@ -206,6 +343,34 @@ namespace mongo {
 
     } topCmd;
 
+    /**
+     * { opLatencies: { namespaces: true } } breaks the latencies out by namespace, and
+     * { opLatencies: { reset: true } } starts the histograms over once they have been reported.
+     */
+    class OpLatenciesServerStatusSection : public ServerStatusSection {
+    public:
+        OpLatenciesServerStatusSection() : ServerStatusSection( "opLatencies" ) {}
+        virtual bool includeByDefault() const { return true; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            bool includeNamespaces = false;
+            bool reset = false;
+            if ( configElement.type() == Object ) {
+                const BSONObj config = configElement.Obj();
+                includeNamespaces = config["namespaces"].trueValue();
+                reset = config["reset"].trueValue();
+            }
+
+            BSONObjBuilder b;
+            Top::global.appendLatencies( b, includeNamespaces );
+            if ( reset )
+                Top::global.resetLatencies();
+            return b.obj();
+        }
+
+    } opLatenciesServerStatusSection;
+
     Top Top::global;
 
 }
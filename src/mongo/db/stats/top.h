@@ -30,7 +30,10 @@
 #pragma once
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/shared_ptr.hpp>
 
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
 
@@ -38,11 +41,15 @@ namespace mongo {
 
     /**
      * tracks usage by collection
+     *
+     * usage is recorded into one of several partitions, picked by the cpu the recording thread
+     * is on, so that threads on different cores don't serialize on one mutex. readers merge the
+     * partitions.
      */
     class Top {
 
     public:
-        Top() : _lock("Top") { }
+        Top() : _lastDroppedLock("Top::lastDropped") { }
 
         struct UsageData {
             UsageData() : time(0), count(0) {}
@@ -54,6 +61,11 @@ namespace mongo {
                 count++;
                 time += micros;
             }
+
+            void add( const UsageData& other ) {
+                count += other.count;
+                time += other.time;
+            }
         };
 
         struct CollectionData {
@@ -74,16 +86,41 @@ namespace mongo {
             UsageData update;
             UsageData remove;
             UsageData commands;
+
+            void add( const CollectionData& other );
         };
 
         typedef StringMap<CollectionData> UsageMap;
 
+        /**
+         * latency histograms of whole operations, by kind of operation
+         */
+        struct OperationLatencies {
+            enum Kind { Reads, Writes, Commands, GetMores, NumKinds };
+
+            void record( Kind kind, long long micros );
+            void add( const OperationLatencies& other );
+            void append( BSONObjBuilder& b, bool includeEmpty ) const;
+
+            // allocated by the first record() of each kind, since most namespaces only see a few
+            boost::shared_ptr<LatencyHistogram> histograms[NumKinds];
+        };
+
+        typedef StringMap<OperationLatencies> LatencyMap;
+
     public:
         void record( const StringData& ns, int op, int lockType, long long micros, bool command );
         void append( BSONObjBuilder& b );
         void cloneMap(UsageMap& out) const;
         void collectionDropped( const StringData& ns );
 
+        /**
+         * records how long a whole operation on 'ns' took, from arrival to reply
+         */
+        void recordLatency( const StringData& ns, int op, bool command, long long micros );
+        void appendLatencies( BSONObjBuilder& b, bool includeNamespaces ) const;
+        void resetLatencies();
+
     public: // static stuff
         static Top global;
 
@@ -92,8 +129,23 @@ namespace mongo {
         void _appendStatsEntry( BSONObjBuilder& b, const char * statsName, const UsageData& map ) const;
         void _record( CollectionData& c, int op, int lockType, long long micros, bool command );
 
-        mutable SimpleMutex _lock;
-        UsageMap _usage;
+        enum { NumPartitions = 16 };
+
+        struct Partition {
+            Partition() : lock("Top") { }
+
+            SimpleMutex lock;
+            UsageMap usage;
+            OperationLatencies totalLatencies;
+            LatencyMap latencies;
+        };
+
+        mutable Partition _partitions[NumPartitions];
+
+        // set when _lastDropped is non-empty, so that record() only takes _lastDroppedLock
+        // right after a drop
+        AtomicUInt32 _haveLastDropped;
+        SimpleMutex _lastDroppedLock;
         std::string _lastDropped;
     };
 
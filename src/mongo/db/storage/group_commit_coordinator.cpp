@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/group_commit_coordinator.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    // How long, in microseconds, a group commit leader waits for other committers to join its
+    // batch before syncing the log. Zero syncs immediately; commits arriving during a sync are
+    // still batched into the next one.
+    MONGO_EXPORT_SERVER_PARAMETER(groupCommitWindowMicros, int, 0);
+
+    GroupCommitCoordinator::Histogram::Histogram() {
+        for (int i = 0; i < NumBuckets; i++) {
+            _buckets[i] = 0;
+        }
+    }
+
+    void GroupCommitCoordinator::Histogram::record(unsigned long long value) {
+        int bucket = 0;
+        while (value > 1 && bucket < NumBuckets - 1) {
+            value >>= 1;
+            bucket++;
+        }
+        _buckets[bucket]++;
+    }
+
+    void GroupCommitCoordinator::Histogram::append(BSONObjBuilder* builder,
+                                                   const char* name) const {
+        int last = NumBuckets - 1;
+        while (last > 0 && _buckets[last] == 0) {
+            last--;
+        }
+
+        BSONArrayBuilder arr(builder->subarrayStart(name));
+        for (int i = 0; i <= last; i++) {
+            arr.append(_buckets[i]);
+        }
+        arr.done();
+    }
+
+    GroupCommitCoordinator::GroupCommitCoordinator()
+        : _lastStarted(0),
+          _lastDone(0),
+          _syncInProgress(false),
+          _nextBatchSize(0),
+          _numSyncs(0),
+          _numWaits(0) {
+    }
+
+    GroupCommitCoordinator::~GroupCommitCoordinator() {
+        boost::mutex::scoped_lock lk(_mutex);
+        invariant(!_syncInProgress);
+    }
+
+    void GroupCommitCoordinator::waitUntilDurable() {
+        const unsigned long long start = curTimeMicros64();
+
+        boost::mutex::scoped_lock lk(_mutex);
+        const unsigned long long needed = _lastStarted + 1;
+        _nextBatchSize++;
+
+        while (_lastDone < needed) {
+            if (_syncInProgress) {
+                _syncDone.wait(lk);
+                continue;
+            }
+
+            // Become the leader for the next batch
+            _syncInProgress = true;
+
+            const int window = groupCommitWindowMicros;
+            if (window > 0) {
+                lk.unlock();
+                sleepmicros(window);
+                lk.lock();
+            }
+
+            const unsigned long long syncNumber = ++_lastStarted;
+            const long long batchSize = _nextBatchSize;
+            _nextBatchSize = 0;
+
+            lk.unlock();
+            _syncLog();
+            lk.lock();
+
+            _lastDone = syncNumber;
+            _syncInProgress = false;
+            _numSyncs++;
+            _batchSizes.record(batchSize);
+            _syncDone.notify_all();
+        }
+
+        _numWaits++;
+        _waitMicros.record(curTimeMicros64() - start);
+    }
+
+    void GroupCommitCoordinator::appendStats(BSONObjBuilder* builder) const {
+        boost::mutex::scoped_lock lk(_mutex);
+        builder->append("windowMicros", groupCommitWindowMicros);
+        builder->append("syncs", _numSyncs);
+        builder->append("waits", _numWaits);
+        _batchSizes.append(builder, "batchSizes");
+        _waitMicros.append(builder, "waitMicros");
+    }
+
+}  // namespace mongo
@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Batches durability requests from concurrent committers into shared log syncs.
+     *
+     * The first thread to ask for durability while no sync is running becomes the leader. It
+     * waits up to groupCommitWindowMicros for others to join, then issues a single sync on
+     * behalf of everyone who arrived before the sync started. Threads arriving while a sync is
+     * in progress wait for the next one, which one of them leads.
+     *
+     * Engines provide the actual sync by implementing _syncLog().
+     */
+    class GroupCommitCoordinator {
+        MONGO_DISALLOW_COPYING(GroupCommitCoordinator);
+    public:
+        GroupCommitCoordinator();
+        virtual ~GroupCommitCoordinator();
+
+        /**
+         * Blocks until everything the calling thread committed before the call is durable.
+         */
+        void waitUntilDurable();
+
+        /**
+         * Appends sync counts and the batch size and wait time histograms.
+         */
+        void appendStats(BSONObjBuilder* builder) const;
+
+    protected:
+        /**
+         * Makes every commit which completed before the call durable. Called without any
+         * coordinator lock held and never concurrently with itself.
+         */
+        virtual void _syncLog() = 0;
+
+    private:
+        /**
+         * Counts of values bucketed by powers of two: bucket i holds values in [2^i, 2^(i+1)),
+         * with zero counted in bucket 0 and anything too large in the last bucket.
+         */
+        class Histogram {
+        public:
+            enum { NumBuckets = 24 };
+
+            Histogram();
+            void record(unsigned long long value);
+            void append(BSONObjBuilder* builder, const char* name) const;
+
+        private:
+            long long _buckets[NumBuckets];
+        };
+
+        mutable boost::mutex _mutex;
+        boost::condition _syncDone;
+
+        // Number of the last sync which has started and the last one which has finished. A
+        // waiter needs the first sync which starts after it arrived, i.e. _lastStarted + 1.
+        unsigned long long _lastStarted;
+        unsigned long long _lastDone;
+        bool _syncInProgress;
+
+        // Waiters which will be covered by the next sync to start
+        long long _nextBatchSize;
+
+        // All of the below are protected by _mutex
+        long long _numSyncs;
+        long long _numWaits;
+        Histogram _batchSizes;
+        Histogram _waitMicros;
+    };
+
+}  // namespace mongo
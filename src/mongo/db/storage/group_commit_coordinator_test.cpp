@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/group_commit_coordinator.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    /**
+     * Pretends that every commit numbered up to 'committed' at sync time becomes durable.
+     */
+    class CountingCoordinator : public GroupCommitCoordinator {
+    public:
+        CountingCoordinator() : committed(0), durable(0), syncs(0) { }
+
+        AtomicUInt32 committed;
+        AtomicUInt32 durable;
+        AtomicUInt32 syncs;
+
+    protected:
+        virtual void _syncLog() {
+            durable.store(committed.load());
+            syncs.fetchAndAdd(1);
+        }
+    };
+
+    void commitAndWait(CountingCoordinator* coordinator, int commits, AtomicUInt32* failures) {
+        for (int i = 0; i < commits; i++) {
+            const unsigned myCommit = coordinator->committed.addAndFetch(1);
+            coordinator->waitUntilDurable();
+            if (coordinator->durable.load() < myCommit) {
+                failures->fetchAndAdd(1);
+            }
+        }
+    }
+
+    TEST(GroupCommitCoordinatorTest, SingleWaiterSyncs) {
+        CountingCoordinator coordinator;
+        coordinator.committed.store(7);
+        coordinator.waitUntilDurable();
+        ASSERT_EQUALS(7U, coordinator.durable.load());
+        ASSERT_EQUALS(1U, coordinator.syncs.load());
+
+        // Every wait needs a sync which starts after it arrived
+        coordinator.waitUntilDurable();
+        ASSERT_EQUALS(2U, coordinator.syncs.load());
+    }
+
+    TEST(GroupCommitCoordinatorTest, ConcurrentWaitersAreDurable) {
+        const int kThreads = 16;
+        const int kCommitsPerThread = 200;
+
+        CountingCoordinator coordinator;
+        AtomicUInt32 failures(0);
+
+        boost::thread_group threads;
+        for (int i = 0; i < kThreads; i++) {
+            threads.add_thread(new boost::thread(boost::bind(commitAndWait,
+                                                             &coordinator,
+                                                             kCommitsPerThread,
+                                                             &failures)));
+        }
+        threads.join_all();
+
+        ASSERT_EQUALS(0U, failures.load());
+        ASSERT_LESS_THAN_OR_EQUALS(coordinator.syncs.load(),
+                                   static_cast<unsigned>(kThreads * kCommitsPerThread));
+
+        BSONObjBuilder bob;
+        coordinator.appendStats(&bob);
+        BSONObj stats = bob.obj();
+        ASSERT_EQUALS(kThreads * kCommitsPerThread, stats["waits"].numberLong());
+        ASSERT_EQUALS(static_cast<long long>(coordinator.syncs.load()),
+                      stats["syncs"].numberLong());
+    }
+
+}  // namespace
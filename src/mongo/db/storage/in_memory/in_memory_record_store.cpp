@@ -37,6 +37,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/recovery_unit.h"
 #include "mongo/util/log.h"
@@ -47,6 +48,9 @@ namespace mongo {
 
     using boost::shared_ptr;
 
+    // 0 means no limit
+    MONGO_EXPORT_SERVER_PARAMETER(inMemoryExperimentMaxDataBytes, long long, 0);
+
     class InMemoryRecordStore::InsertChange : public RecoveryUnit::Change {
     public:
         InsertChange(Data* data, RecordId loc) :_data(data), _loc(loc) {}
@@ -54,7 +58,7 @@ namespace mongo {
         virtual void rollback() {
             Records::iterator it = _data->records.find(_loc);
             if (it != _data->records.end()) {
-                _data->dataSize -= it->second.size;
+                _data->changeDataSize(-it->second.size);
                 _data->records.erase(it);
             }
         }
@@ -75,10 +79,10 @@ namespace mongo {
         virtual void rollback() {
             Records::iterator it = _data->records.find(_loc);
             if (it != _data->records.end()) {
-                _data->dataSize -= it->second.size;
+                _data->changeDataSize(-it->second.size);
             }
 
-            _data->dataSize += _rec.size;
+            _data->changeDataSize(_rec.size);
             _data->records[_loc] = _rec;
         }
 
@@ -90,17 +94,15 @@ namespace mongo {
 
     class InMemoryRecordStore::TruncateChange : public RecoveryUnit::Change {
     public:
-        TruncateChange(Data* data) : _data(data), _dataSize(0) {
-            using std::swap;
-            swap(_dataSize, _data->dataSize);
-            swap(_records, _data->records);
+        TruncateChange(Data* data) : _data(data), _dataSize(data->dataSize) {
+            _data->changeDataSize(-_dataSize);
+            _records.swap(_data->records);
         }
 
         virtual void commit() {}
         virtual void rollback() {
-            using std::swap;
-            swap(_dataSize, _data->dataSize);
-            swap(_records, _data->records);
+            _data->changeDataSize(_dataSize);
+            _records.swap(_data->records);
         }
 
     private:
@@ -109,6 +111,21 @@ namespace mongo {
         Records _records;
     };
 
+    //
+    // Data
+    //
+
+    AtomicInt64 InMemoryRecordStore::_totalDataSize;
+
+    InMemoryRecordStore::Data::~Data() {
+        _totalDataSize.fetchAndSubtract(dataSize);
+    }
+
+    void InMemoryRecordStore::Data::changeDataSize(int64_t diff) {
+        dataSize += diff;
+        _totalDataSize.fetchAndAdd(diff);
+    }
+
     //
     // RecordStore
     //
@@ -180,7 +197,7 @@ namespace mongo {
     void InMemoryRecordStore::deleteRecord(OperationContext* txn, const RecordId& loc) {
         InMemoryRecord* rec = recordFor(loc);
         txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *rec));
-        _data->dataSize -= rec->size;
+        _data->changeDataSize(-rec->size);
         invariant(_data->records.erase(loc) == 1);
     }
 
@@ -222,6 +239,17 @@ namespace mongo {
         return status;
     }
 
+    Status InMemoryRecordStore::checkMemoryBudget(int64_t bytes) {
+        const long long maxBytes = inMemoryExperimentMaxDataBytes;
+        if (maxBytes > 0 && bytes > 0 && _totalDataSize.load() + bytes > maxBytes) {
+            return Status(ErrorCodes::ExceededMemoryLimit,
+                          mongoutils::str::stream() << "in-memory data would exceed "
+                                                    << "inMemoryExperimentMaxDataBytes of "
+                                                    << maxBytes << " bytes");
+        }
+        return Status::OK();
+    }
+
     StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
                                                           const char* data,
                                                           int len,
@@ -233,6 +261,11 @@ namespace mongo {
                                        "object to insert exceeds cappedMaxSize");
         }
 
+        Status budgetStatus = checkMemoryBudget(len);
+        if (!budgetStatus.isOK()) {
+            return StatusWith<RecordId>(budgetStatus);
+        }
+
         InMemoryRecord rec(len);
         memcpy(rec.data.get(), data, len);
 
@@ -248,7 +281,7 @@ namespace mongo {
         }
 
         txn->recoveryUnit()->registerChange(new InsertChange(_data, loc));
-        _data->dataSize += len;
+        _data->changeDataSize(len);
         _data->records[loc] = rec;
 
         cappedDeleteAsNeeded(txn);
@@ -267,6 +300,11 @@ namespace mongo {
                                        "object to insert exceeds cappedMaxSize");
         }
 
+        Status budgetStatus = checkMemoryBudget(len);
+        if (!budgetStatus.isOK()) {
+            return StatusWith<RecordId>(budgetStatus);
+        }
+
         InMemoryRecord rec(len);
         doc->writeDocument(rec.data.get());
 
@@ -282,7 +320,7 @@ namespace mongo {
         }
 
         txn->recoveryUnit()->registerChange(new InsertChange(_data, loc));
-        _data->dataSize += len;
+        _data->changeDataSize(len);
         _data->records[loc] = rec;
 
         cappedDeleteAsNeeded(txn);
@@ -305,6 +343,11 @@ namespace mongo {
                                         10003 );
         }
 
+        Status budgetStatus = checkMemoryBudget(len - oldLen);
+        if (!budgetStatus.isOK()) {
+            return StatusWith<RecordId>(budgetStatus);
+        }
+
         if (notifier) {
             // The in-memory KV engine uses the invalidation framework (does not support
             // doc-locking), and therefore must notify that it is updating a document.
@@ -318,7 +361,7 @@ namespace mongo {
         memcpy(newRecord.data.get(), data, len);
 
         txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *oldRecord));
-        _data->dataSize += len - oldLen;
+        _data->changeDataSize(len - oldLen);
         *oldRecord = newRecord;
 
         cappedDeleteAsNeeded(txn);
@@ -400,7 +443,7 @@ namespace mongo {
                                          : _data->records.upper_bound(end);
         while(it != _data->records.end()) {
             txn->recoveryUnit()->registerChange(new RemoveChange(_data, it->first, it->second));
-            _data->dataSize -= it->second.size;
+            _data->changeDataSize(-it->second.size);
             _data->records.erase(it++);
         }
     }
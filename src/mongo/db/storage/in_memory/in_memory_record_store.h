@@ -36,6 +36,7 @@
 
 #include "mongo/db/storage/capped_callback.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -134,7 +135,7 @@ namespace mongo {
                                             long long numRecords,
                                             long long dataSize) {
             invariant(_data->records.size() == size_t(numRecords));
-            _data->dataSize = dataSize;
+            _data->changeDataSize(dataSize - _data->dataSize);
         }
 
     protected:
@@ -165,6 +166,12 @@ namespace mongo {
         bool cappedMaxDocs() const { invariant(_isCapped); return _cappedMaxDocs; }
         bool cappedMaxSize() const { invariant(_isCapped); return _cappedMaxSize; }
 
+        /**
+         * The size of the records in all InMemoryRecordStores of the process, which the
+         * inMemoryExperimentMaxDataBytes server parameter limits.
+         */
+        static int64_t totalDataSize() { return _totalDataSize.load(); }
+
     private:
         class InsertChange;
         class RemoveChange;
@@ -172,6 +179,9 @@ namespace mongo {
 
         StatusWith<RecordId> extractAndCheckLocForOplog(const char* data, int len) const;
 
+        // Fails a write that would grow the data by 'bytes' past the memory budget.
+        static Status checkMemoryBudget(int64_t bytes);
+
         RecordId allocateLoc();
         bool cappedAndNeedDelete(OperationContext* txn) const;
         void cappedDeleteAsNeeded(OperationContext* txn);
@@ -185,6 +195,10 @@ namespace mongo {
         // This is the "persistent" data.
         struct Data {
             Data(bool isOplog) :dataSize(0), nextId(1), isOplog(isOplog) {}
+            ~Data();
+
+            // All changes to dataSize go through here to keep _totalDataSize up to date.
+            void changeDataSize(int64_t diff);
 
             int64_t dataSize;
             Records records;
@@ -193,6 +207,8 @@ namespace mongo {
         };
 
         Data* const _data;
+
+        static AtomicInt64 _totalDataSize;
     };
 
     class InMemoryRecordIterator : public RecordIterator {
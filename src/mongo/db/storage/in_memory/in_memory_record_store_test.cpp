@@ -30,11 +30,15 @@
 
 #include "mongo/db/storage/in_memory/in_memory_record_store.h"
 
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -58,4 +62,56 @@ namespace mongo {
         return new InMemoryHarnessHelper();
     }
 
+    void setMaxDataBytes(long long bytes) {
+        const ServerParameterSet::Map& parameters = ServerParameterSet::getGlobal()->getMap();
+        ServerParameterSet::Map::const_iterator it =
+            parameters.find("inMemoryExperimentMaxDataBytes");
+        ASSERT(it != parameters.end());
+        ASSERT_OK(it->second->setFromString(mongoutils::str::stream() << bytes));
+    }
+
+    TEST(InMemoryRecordStore, MemoryBudget) {
+        InMemoryHarnessHelper helper;
+        boost::scoped_ptr<RecordStore> rs(helper.newNonCappedRecordStore());
+        boost::scoped_ptr<OperationContext> opCtx(helper.newOperationContext());
+        const char data[60] = "in memory";
+
+        setMaxDataBytes(InMemoryRecordStore::totalDataSize() + 100);
+
+        RecordId loc;
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), data, 60, false);
+            ASSERT_OK(res.getStatus());
+            loc = res.getValue();
+            uow.commit();
+        }
+
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit,
+                          rs->insertRecord(opCtx.get(), data, 60, false).getStatus());
+            ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit,
+                          rs->updateRecord(opCtx.get(), loc, data, 120, false, NULL).getStatus());
+            ASSERT_OK(rs->updateRecord(opCtx.get(), loc, data, 30, false, NULL).getStatus());
+        }
+
+        // The update was rolled back, so the budget is used by the first insert again
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit,
+                          rs->insertRecord(opCtx.get(), data, 60, false).getStatus());
+            rs->deleteRecord(opCtx.get(), loc);
+            ASSERT_OK(rs->insertRecord(opCtx.get(), data, 60, false).getStatus());
+            uow.commit();
+        }
+
+        setMaxDataBytes(0);
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(rs->insertRecord(opCtx.get(), data, 60, false).getStatus());
+            uow.commit();
+        }
+    }
+
 }
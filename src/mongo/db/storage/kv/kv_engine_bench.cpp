@@ -0,0 +1,507 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/**
+ * Throughput and latency benchmark for KVEngine implementations.
+ *
+ * The driver is linked with an engine's KVHarnessHelper::create(), the same one its
+ * kv_engine_test_harness tests use, into one benchmark program per engine. For each requested
+ * thread count it creates a record store and an index, runs insert, point-read, range-scan and
+ * update phases against them from that many threads, and drops them again.
+ *
+ * Engines without document level locking rely on the server's collection lock to keep writers
+ * apart, so for those the benchmark takes a reader/writer lock around every operation instead.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "mongo/base/initializer.h"
+#include "mongo/base/status.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/kv/kv_engine.h"
+#include "mongo/db/storage/kv/kv_engine_test_harness.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/concurrency/simplerwlock.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/options_parser/environment.h"
+#include "mongo/util/options_parser/option_section.h"
+#include "mongo/util/options_parser/options_parser.h"
+#include "mongo/util/options_parser/startup_option_init.h"
+#include "mongo/util/options_parser/startup_options.h"
+#include "mongo/util/quick_exit.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/signal_handlers_synchronous.h"
+#include "mongo/util/text.h"
+#include "mongo/util/timer.h"
+
+using namespace mongo;
+
+namespace {
+    typedef long long micros_t;
+
+    const std::string DEFAULT_THREADS = "1,2,4,8,16,32,64";
+    const int DEFAULT_NRECORDS = 100000;
+    const int DEFAULT_NOPS = 100000;
+    const int DEFAULT_RECORD_SIZE = 512;
+    const int DEFAULT_SCAN_LENGTH = 100;
+}
+
+struct BenchmarkParams {
+    std::vector<int> threads;
+    int nrecords;       // inserted per thread count, split between the threads
+    int nops;           // per read and update phase, split between the threads
+    int recordSize;
+    int scanLength;
+    bool quiet;
+    bool jsonReportEnabled;
+    std::string jsonReportOut;
+} benchParams;
+
+class KVEngineBenchmark {
+public:
+    KVEngineBenchmark(const BenchmarkParams& params)
+        : _params(params),
+          _helper(KVHarnessHelper::create()),
+          _engine(_helper->getEngine()) {
+        invariant(_engine);
+    }
+
+    void run() {
+        for (size_t i = 0; i < _params.threads.size(); i++) {
+            runThreads(_params.threads[i]);
+        }
+
+        if (!_params.quiet) {
+            textReport();
+        }
+
+        if (_params.jsonReportEnabled) {
+            jsonReport(_params.jsonReportOut);
+        }
+    }
+
+private:
+    struct PhaseResult {
+        std::string phase;
+        int threads;
+        micros_t wallMicros;
+        long long writeConflicts;
+        std::vector<micros_t> latencies; // one per operation, sorted
+    };
+
+    // One operation of a phase. 'n' counts the calling thread's operations from 0.
+    typedef void (KVEngineBenchmark::*Op)(OperationContext* txn, PseudoRandom& random,
+                                          int thread, int n);
+
+    void runThreads(int nthreads) {
+        const std::string ns = str::stream() << "bench.threads" << nthreads;
+        const std::string indexIdent = ns + ".idx";
+        IndexDescriptor desc(NULL, "", BSON("key" << BSON("_id" << 1) << "name" << "_id_"));
+
+        {
+            OperationContextNoop txn(_engine->newRecoveryUnit());
+            invariantOK(_engine->createRecordStore(&txn, ns, ns, CollectionOptions()));
+            _rs.reset(_engine->getRecordStore(&txn, ns, ns, CollectionOptions()));
+            invariantOK(_engine->createSortedDataInterface(&txn, indexIdent, &desc));
+            _index.reset(_engine->getSortedDataInterface(&txn, indexIdent, &desc));
+        }
+
+        _recordsPerThread = std::max(1, _params.nrecords / nthreads);
+        _numRecords = _recordsPerThread * nthreads;
+        const int opsPerThread = std::max(1, _params.nops / nthreads);
+
+        runPhase("insert", nthreads, _recordsPerThread, &KVEngineBenchmark::insertOp, true);
+        runPhase("pointRead", nthreads, opsPerThread, &KVEngineBenchmark::pointReadOp, false);
+        runPhase("rangeScan", nthreads, std::max(1, opsPerThread / _params.scanLength),
+                 &KVEngineBenchmark::rangeScanOp, false);
+        runPhase("update", nthreads, opsPerThread, &KVEngineBenchmark::updateOp, true);
+
+        _rs.reset();
+        _index.reset();
+        {
+            OperationContextNoop txn(_engine->newRecoveryUnit());
+            invariantOK(_engine->dropIdent(&txn, ns));
+            invariantOK(_engine->dropIdent(&txn, indexIdent));
+        }
+    }
+
+    void runPhase(const std::string& phase, int nthreads, int opsPerThread, Op op,
+                  bool isWrite) {
+        std::vector<std::vector<micros_t> > latencies(nthreads);
+        std::vector<long long> writeConflicts(nthreads, 0);
+
+        // The wall clock starts once every thread is ready to go
+        boost::barrier ready(nthreads + 1);
+        std::vector<boost::thread*> threads;
+        for (int i = 0; i < nthreads; i++) {
+            threads.push_back(new boost::thread(boost::bind(&KVEngineBenchmark::worker, this,
+                                                            op, isWrite, i, opsPerThread,
+                                                            &ready,
+                                                            &latencies[i],
+                                                            &writeConflicts[i])));
+        }
+        ready.wait();
+        Timer wall;
+        for (int i = 0; i < nthreads; i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+
+        PhaseResult result;
+        result.phase = phase;
+        result.threads = nthreads;
+        result.wallMicros = std::max(1LL, wall.micros());
+        result.writeConflicts = std::accumulate(writeConflicts.begin(),
+                                                writeConflicts.end(), 0LL);
+        for (int i = 0; i < nthreads; i++) {
+            result.latencies.insert(result.latencies.end(),
+                                    latencies[i].begin(), latencies[i].end());
+        }
+        std::sort(result.latencies.begin(), result.latencies.end());
+        _results.push_back(result);
+    }
+
+    void worker(Op op, bool isWrite, int thread, int nops, boost::barrier* ready,
+                std::vector<micros_t>* latencies, long long* writeConflicts) {
+        boost::scoped_ptr<OperationContext> txn(
+            new OperationContextNoop(_engine->newRecoveryUnit()));
+        PseudoRandom random(static_cast<int64_t>(thread) * 7919 + 17);
+        latencies->reserve(nops);
+
+        ready->wait();
+        for (int n = 0; n < nops; n++) {
+            Timer timer;
+            while (true) {
+                try {
+                    runOp(op, isWrite, txn.get(), random, thread, n);
+                    break;
+                }
+                catch (const WriteConflictException&) {
+                    ++*writeConflicts;
+                    txn->recoveryUnit()->commitAndRestart();
+                }
+            }
+            latencies->push_back(timer.micros());
+        }
+    }
+
+    void runOp(Op op, bool isWrite, OperationContext* txn, PseudoRandom& random,
+               int thread, int n) {
+        if (_engine->supportsDocLocking()) {
+            (this->*op)(txn, random, thread, n);
+        }
+        else if (isWrite) {
+            SimpleRWLock::Exclusive lk(_collectionLock);
+            (this->*op)(txn, random, thread, n);
+        }
+        else {
+            SimpleRWLock::Shared lk(_collectionLock);
+            (this->*op)(txn, random, thread, n);
+        }
+    }
+
+    BSONObj makeRecord(int id, int version) const {
+        // Same size for every version so that updates can stay in place
+        const int padding = std::max(0, _params.recordSize - 32);
+        return BSON("_id" << id << "v" << version << "pad" << std::string(padding, 'x'));
+    }
+
+    int randomId(PseudoRandom& random) const {
+        return random.nextInt32(_numRecords);
+    }
+
+    RecordId locate(OperationContext* txn, int id) {
+        boost::scoped_ptr<SortedDataInterface::Cursor> cursor(_index->newCursor(txn, 1));
+        cursor->locate(BSON("" << id), RecordId::min());
+        invariant(!cursor->isEOF());
+        return cursor->getRecordId();
+    }
+
+    void insertOp(OperationContext* txn, PseudoRandom& random, int thread, int n) {
+        const int id = thread * _recordsPerThread + n;
+        const BSONObj record = makeRecord(id, 0);
+
+        WriteUnitOfWork uow(txn);
+        StatusWith<RecordId> loc = _rs->insertRecord(txn, record.objdata(), record.objsize(),
+                                                     false);
+        invariantOK(loc.getStatus());
+        invariantOK(_index->insert(txn, BSON("" << id), loc.getValue(), true));
+        uow.commit();
+    }
+
+    void pointReadOp(OperationContext* txn, PseudoRandom& random, int thread, int n) {
+        const RecordId loc = locate(txn, randomId(random));
+        invariant(_rs->dataFor(txn, loc).size() > 0);
+        txn->recoveryUnit()->commitAndRestart();
+    }
+
+    void rangeScanOp(OperationContext* txn, PseudoRandom& random, int thread, int n) {
+        boost::scoped_ptr<SortedDataInterface::Cursor> cursor(_index->newCursor(txn, 1));
+        cursor->locate(BSON("" << randomId(random)), RecordId::min());
+        for (int i = 0; i < _params.scanLength && !cursor->isEOF(); i++) {
+            invariant(_rs->dataFor(txn, cursor->getRecordId()).size() > 0);
+            cursor->advance();
+        }
+        cursor.reset();
+        txn->recoveryUnit()->commitAndRestart();
+    }
+
+    void updateOp(OperationContext* txn, PseudoRandom& random, int thread, int n) {
+        const int id = randomId(random);
+        const BSONObj record = makeRecord(id, n + 1);
+
+        WriteUnitOfWork uow(txn);
+        const RecordId loc = locate(txn, id);
+        StatusWith<RecordId> newLoc = _rs->updateRecord(txn, loc, record.objdata(),
+                                                        record.objsize(), false, NULL);
+        invariantOK(newLoc.getStatus());
+        invariant(newLoc.getValue() == loc);
+        uow.commit();
+    }
+
+    static micros_t percentile(const std::vector<micros_t>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        size_t i = static_cast<size_t>(p * (sorted.size() - 1));
+        return sorted[i];
+    }
+
+    static double opsPerSec(const PhaseResult& result) {
+        return result.latencies.size() * 1e6 / result.wallMicros;
+    }
+
+    static micros_t average(const std::vector<micros_t>& values) {
+        if (values.empty()) {
+            return 0;
+        }
+        return std::accumulate(values.begin(), values.end(), 0LL) / values.size();
+    }
+
+    void textReport() {
+        for (size_t i = 0; i < _results.size(); i++) {
+            const PhaseResult& r = _results[i];
+            std::cout << r.phase << " threads: " << r.threads
+                      << " ops: " << r.latencies.size()
+                      << " ops/sec: " << opsPerSec(r)
+                      << " usec avg: " << average(r.latencies)
+                      << " p50: " << percentile(r.latencies, 0.5)
+                      << " p95: " << percentile(r.latencies, 0.95)
+                      << " p99: " << percentile(r.latencies, 0.99)
+                      << " max: " << (r.latencies.empty() ? 0 : r.latencies.back())
+                      << " writeConflicts: " << r.writeConflicts << std::endl;
+        }
+    }
+
+    void jsonReport(const std::string& jsonReportOut) {
+        BSONObjBuilder obj;
+        obj.append("recordSize", _params.recordSize);
+        obj.append("records", _params.nrecords);
+        obj.append("scanLength", _params.scanLength);
+        obj.append("durable", _engine->isDurable());
+
+        BSONArrayBuilder results(obj.subarrayStart("results"));
+        for (size_t i = 0; i < _results.size(); i++) {
+            const PhaseResult& r = _results[i];
+            BSONObjBuilder result(results.subobjStart());
+            result.append("phase", r.phase);
+            result.append("threads", r.threads);
+            result.append("ops", static_cast<long long>(r.latencies.size()));
+            result.append("opsPerSec", opsPerSec(r));
+            result.append("writeConflicts", r.writeConflicts);
+
+            BSONObjBuilder latency(result.subobjStart("latencyMicros"));
+            latency.append("avg", average(r.latencies));
+            latency.append("p50", percentile(r.latencies, 0.5));
+            latency.append("p95", percentile(r.latencies, 0.95));
+            latency.append("p99", percentile(r.latencies, 0.99));
+            latency.append("max", r.latencies.empty() ? 0LL : r.latencies.back());
+            latency.done();
+            result.done();
+        }
+        results.done();
+
+        const std::string outStr = obj.done().jsonString();
+
+        if (jsonReportOut == "-") {
+            std::cout << outStr << std::endl;
+        } else {
+            std::ofstream outfile(jsonReportOut.c_str());
+            if (!outfile.is_open()) {
+                std::cerr << "Error: couldn't create output file " << jsonReportOut << std::endl;
+                return;
+            }
+            ON_BLOCK_EXIT(&std::ofstream::close, outfile);
+            outfile << outStr << std::endl;
+        }
+    }
+
+    const BenchmarkParams& _params;
+    boost::scoped_ptr<KVHarnessHelper> _helper;
+    KVEngine* const _engine; // owned by _helper
+
+    boost::scoped_ptr<RecordStore> _rs;
+    boost::scoped_ptr<SortedDataInterface> _index;
+    int _recordsPerThread;
+    int _numRecords;
+
+    // Stands in for the collection lock when the engine has no document level locking
+    SimpleRWLock _collectionLock;
+
+    std::vector<PhaseResult> _results;
+};
+
+namespace moe = mongo::optionenvironment;
+
+Status addKVEngineBenchOptions(moe::OptionSection& options) {
+    options.addOptionChaining("help", "help", moe::Switch, "Display help");
+    options.addOptionChaining("threads", "threads", moe::String,
+                              "Comma separated list of thread counts to run every phase with")
+        .setDefault(moe::Value(DEFAULT_THREADS));
+
+    options.addOptionChaining("records", "records", moe::Int,
+                              "The number of records to insert for each thread count")
+        .setDefault(moe::Value(DEFAULT_NRECORDS));
+
+    options.addOptionChaining("ops", "ops", moe::Int,
+                              str::stream() << "The number of point reads and of updates for "
+                                            << "each thread count. Range scans read the same "
+                                            << "number of records")
+        .setDefault(moe::Value(DEFAULT_NOPS));
+
+    options.addOptionChaining("recordSize", "recordSize", moe::Int,
+                              "The approximate size of each record in bytes")
+        .setDefault(moe::Value(DEFAULT_RECORD_SIZE));
+
+    options.addOptionChaining("scanLength", "scanLength", moe::Int,
+                              "The number of records read by each range scan")
+        .setDefault(moe::Value(DEFAULT_SCAN_LENGTH));
+
+    options.addOptionChaining("quiet", "quiet", moe::Switch,
+                              "Suppress the plaintext report");
+
+    options.addOptionChaining("jsonReport", "jsonReport", moe::String,
+                              str::stream() << "If set, results will be saved as a JSON document to "
+                                            << "the specified file path. If specified with no "
+                                            << "arguments the report will be printed to standard "
+                                            << "out")
+        .setImplicit(moe::Value(std::string("-")));
+
+    return Status::OK();
+}
+
+Status validateKVEngineBenchOptions(const moe::OptionSection& options,
+                                    moe::Environment& env) {
+    Status ret = env.validate();
+    if (!ret.isOK()) {
+        return ret;
+    }
+    bool displayHelp = false;
+    ret = env.get(moe::Key("help"), &displayHelp);
+    if (displayHelp) {
+        std::cout << options.helpString() << std::endl;
+        quickExit(EXIT_SUCCESS);
+    }
+    return Status::OK();
+}
+
+Status storeKVEngineBenchOptions(const moe::Environment& env) {
+    // don't actually need to check Status since we set default values
+    std::string threads;
+    Status ret = env.get(moe::Key("threads"), &threads);
+    std::vector<std::string> counts = StringSplitter::split(threads, ",");
+    for (size_t i = 0; i < counts.size(); i++) {
+        const int n = atoi(counts[i].c_str());
+        if (n <= 0) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "invalid thread count: " << counts[i]);
+        }
+        benchParams.threads.push_back(n);
+    }
+
+    ret = env.get(moe::Key("records"), &benchParams.nrecords);
+    ret = env.get(moe::Key("ops"), &benchParams.nops);
+    ret = env.get(moe::Key("recordSize"), &benchParams.recordSize);
+    ret = env.get(moe::Key("scanLength"), &benchParams.scanLength);
+    if (benchParams.nrecords <= 0 || benchParams.nops <= 0 || benchParams.scanLength <= 0) {
+        return Status(ErrorCodes::BadValue, "records, ops and scanLength must be positive");
+    }
+    ret = env.get(moe::Key("quiet"), &benchParams.quiet);
+
+    benchParams.jsonReportEnabled = true;
+    ret = env.get(moe::Key("jsonReport"), &benchParams.jsonReportOut);
+    if (!ret.isOK()) {
+        benchParams.jsonReportEnabled = false;
+    }
+    return Status::OK();
+}
+
+int main(int argc, char** argv, char** envp) {
+    ::mongo::setupSynchronousSignalHandlers();
+    ::mongo::runGlobalInitializersOrDie(argc, argv, envp);
+    try {
+        // this try/catch block needs to exist so that std::terminate is not called and the
+        // engine gets shut down by the harness helper's destructor
+        KVEngineBenchmark(benchParams).run();
+    } catch (const std::exception& ex) {
+        std::cerr << "Benchmark ended in failure: " << ex.what() << std::endl;
+        quickExit(EXIT_FAILURE);
+    }
+    quickExit(EXIT_SUCCESS);
+}
+
+MONGO_GENERAL_STARTUP_OPTIONS_REGISTER(KVEngineBenchOptions)(InitializerContext* context) {
+    return addKVEngineBenchOptions(moe::startupOptions);
+}
+
+MONGO_STARTUP_OPTIONS_VALIDATE(KVEngineBenchOptions)(InitializerContext* context) {
+    return validateKVEngineBenchOptions(moe::startupOptions,
+                                        moe::startupOptionsParsed);
+}
+
+MONGO_STARTUP_OPTIONS_STORE(KVEngineBenchOptions)(InitializerContext* context) {
+    return storeKVEngineBenchOptions(moe::startupOptionsParsed);
+}
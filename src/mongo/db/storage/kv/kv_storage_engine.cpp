@@ -272,6 +272,8 @@ namespace mongo {
         if (!status.isOK())
             return status;
 
+        // Record stores may be repaired from several threads at once.
+        boost::mutex::scoped_lock lk(_dbsLock);
         _dbs[nsToDatabase(ns)]->reinitCollectionAfterRepair(txn, ns);
         return Status::OK();
     }
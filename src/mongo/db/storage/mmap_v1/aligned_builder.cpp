@@ -33,6 +33,7 @@
 #include "mongo/db/storage/mmap_v1/aligned_builder.h"
 
 #include "mongo/util/debug_util.h"
+#include "mongo/util/huge_pages.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -122,9 +123,13 @@ namespace mongo {
 #elif defined(__linux__)
         // in theory #ifdef _POSIX_VERSION should work, but it doesn't on OS X 10.4, and needs to be tested on solaris.
         // so for now, linux only for this.
-        void *p = 0;
-        int res = posix_memalign(&p, Alignment, sz);
-        massert(13524, "out of memory AlignedBuilder", res == 0);
+        // The journal buffer is large and reused for every group commit, so back it with huge
+        // pages if enabled.  Those are always more than Alignment aligned.
+        void *p = HugePages::allocate(sz);
+        if (!p) {
+            int res = posix_memalign(&p, Alignment, sz);
+            massert(13524, "out of memory AlignedBuilder", res == 0);
+        }
         _p._allocationAddress = p;
         _p._data = (char *) p;
 #else
@@ -146,7 +151,8 @@ namespace mongo {
 #if defined(_WIN32)
         VirtualFree(p, 0, MEM_RELEASE);
 #else
-        free(p);
+        if (!HugePages::free(p))
+            free(p);
 #endif
     }
 
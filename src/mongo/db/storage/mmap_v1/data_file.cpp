@@ -36,9 +36,10 @@
 
 #include <boost/filesystem/operations.hpp>
 
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
-#include "mongo/db/operation_context.h"
 #include "mongo/util/file_allocator.h"
 #include "mongo/util/log.h"
 
@@ -46,6 +47,11 @@ namespace mongo {
 
     using std::endl;
 
+    // Maps data files with MADV_RANDOM so that point lookups do not pull in readahead pages,
+    // which would push hot data out of the page cache. Collection scans ask for sequential
+    // access and prefetch extent by extent instead (see MmapV1ExtentManager::cacheHint).
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(mmapv1RandomAccessDataFiles, bool, false);
+
 namespace {
 
     void data_file_check(void *_mb) {
@@ -112,7 +118,7 @@ namespace {
             return Status(ErrorCodes::InvalidPath, "DataFile::openExisting - file does not exist");
         }
 
-        if (!mmf.open(filename, false)) {
+        if (!mmf.open(filename, false, mmapv1RandomAccessDataFiles)) {
             return Status(ErrorCodes::InternalError, "DataFile::openExisting - mmf.open failed");
         }
 
@@ -175,7 +181,7 @@ namespace {
         {
             verify( _mb == 0 );
             unsigned long long sz = size;
-            if( mmf.create(filename, sz, false) )
+            if( mmf.create(filename, sz, false, mmapv1RandomAccessDataFiles) )
                 _mb = mmf.getView();
             verify( sz <= 0x7fffffff );
             size = (int) sz;
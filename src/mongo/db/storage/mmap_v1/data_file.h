@@ -37,6 +37,9 @@ namespace mongo {
 
     class OperationContext;
 
+    // Whether data files are mapped for random access, see data_file.cpp
+    extern bool mmapv1RandomAccessDataFiles;
+
 #pragma pack(1)
     class DataFileVersion {
     public:
@@ -128,9 +128,9 @@ namespace {
         NumCommitsBeforeRemap = 10,
 
         // How many outstanding journal flushes should be allowed before applying writer back
-        // pressure. Size of 1 allows two journal blocks to be in the process of being written -
-        // one on the journal writer's buffer and one blocked waiting to be picked up.
-        NumAsyncJournalWrites = 1,
+        // pressure. One buffer per stage of the journal pipeline (compress, write, apply to the
+        // data files) lets each stage work on a different commit while the next one is prepared.
+        NumAsyncJournalWrites = 3,
     };
 
     // Remap loop state
@@ -470,6 +470,7 @@ namespace {
           << "earlyCommits" << 0
           << "timeMs" << BSON("dt" << _durationMillis <<
                               "prepLogBuffer" << (unsigned) (_prepLogBufferMicros / 1000) <<
+                              "compressJournal" << (unsigned) (_compressJournalMicros / 1000) <<
                               "writeToJournal" << (unsigned) (_writeToJournalMicros / 1000) <<
                               "writeToDataFiles" << (unsigned) (_writeToDataFilesMicros / 1000) <<
                               "remapPrivateView" << (unsigned) (_remapPrivateViewMicros / 1000) <<
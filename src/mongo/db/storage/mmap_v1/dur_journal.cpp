@@ -726,14 +726,25 @@ namespace mongo {
             @param uncompressed - a buffer that will be written to the journal after compression
             will not return until on disk
         */
-        void WRITETOJOURNAL(const JSectHeader& h, const AlignedBuilder& uncompressed) {
+        void COMPRESSJOURNALSECTION(const JSectHeader& h,
+                                    const AlignedBuilder& uncompressed,
+                                    AlignedBuilder* section) {
             Timer t;
-            j.journal(h, uncompressed);
+            Journal::prepSection(h, uncompressed, section);
+            stats.curr()->_compressJournalMicros += t.micros();
+        }
+
+        void WRITETOJOURNAL(const AlignedBuilder& section, unsigned uncompressedLen) {
+            Timer t;
+            j.journal(section, uncompressedLen);
             stats.curr()->_writeToJournalMicros += t.micros();
         }
 
-        void Journal::journal(const JSectHeader& h, const AlignedBuilder& uncompressed) {
-            static AlignedBuilder b(32*1024*1024);
+        // static
+        void Journal::prepSection(const JSectHeader& h,
+                                  const AlignedBuilder& uncompressed,
+                                  AlignedBuilder* section) {
+            AlignedBuilder& b = *section;
             /* buffer to journal will be
                JSectHeader
                compressed operations
@@ -755,12 +766,11 @@ namespace mongo {
             b.skip(compressedLength);
 
             // footer
-            unsigned L = 0xffffffff;
             {
                 // pad to alignment, and set the total section length in the JSectHeader
                 verify( 0xffffe000 == (~(Alignment-1)) );
                 unsigned lenUnpadded = b.len() + sizeof(JSectFooter);
-                L = (lenUnpadded + Alignment-1) & (~(Alignment-1));
+                unsigned L = (lenUnpadded + Alignment-1) & (~(Alignment-1));
                 dassert( L >= lenUnpadded );
 
                 ((JSectHeader*)b.atOfs(0))->setSectionLen(lenUnpadded);
@@ -772,6 +782,11 @@ namespace mongo {
                 b.skip(L - lenUnpadded);
                 dassert( b.len() % Alignment == 0 );
             }
+        }
+
+        void Journal::journal(const AlignedBuilder& section, unsigned uncompressedLen) {
+            const unsigned L = section.len();
+            dassert( L % Alignment == 0 );
 
             try {
                 SimpleMutex::scoped_lock lk(_curLogFileMutex);
@@ -779,12 +794,10 @@ namespace mongo {
                 // must already be open -- so that _curFileId is correct for previous buffer building
                 verify( _curLogFile );
 
-                stats.curr()->_uncompressedBytes += uncompressed.len();
-                unsigned w = b.len();
-                _written += w;
-                verify( w <= L );
+                stats.curr()->_uncompressedBytes += uncompressedLen;
+                _written += L;
                 stats.curr()->_journaledBytes += L;
-                _curLogFile->synchronousAppend((const void *) b.buf(), L);
+                _curLogFile->synchronousAppend((const void *) section.buf(), L);
                 _rotate();
             }
             catch(std::exception& e) {
@@ -77,9 +77,16 @@ namespace mongo {
         bool haveJournalFiles(bool anyFiles=false);
 
         /**
-         * Writes the specified uncompressed buffer to the journal.
+         * Compresses the specified uncompressed buffer into a complete journal section.
          */
-        void WRITETOJOURNAL(const JSectHeader& h, const AlignedBuilder& uncompressed);
+        void COMPRESSJOURNALSECTION(const JSectHeader& h,
+                                    const AlignedBuilder& uncompressed,
+                                    AlignedBuilder* section);
+
+        /**
+         * Appends a section built by COMPRESSJOURNALSECTION to the journal.
+         */
+        void WRITETOJOURNAL(const AlignedBuilder& section, unsigned uncompressedLen);
 
         // in case disk controller buffers writes
         const long long ExtraKeepTimeMs = 10000;
@@ -113,6 +113,8 @@ namespace {
           _shutdownRequested(false),
           _journalQueue(numBuffers),
           _lastCommitNumber(0),
+          _writeQueue(numBuffers),
+          _dataFileQueue(numBuffers),
           _readyQueue(numBuffers) {
 
         invariant(_journalQueue.maxSize() == _readyQueue.maxSize());
@@ -121,6 +123,8 @@ namespace {
     JournalWriter::~JournalWriter() {
         // Never close the journal writer with outstanding or unaccounted writes
         invariant(_journalQueue.empty());
+        invariant(_writeQueue.empty());
+        invariant(_dataFileQueue.empty());
         invariant(_readyQueue.empty());
     }
 
@@ -133,9 +137,24 @@ namespace {
             _readyQueue.push(new Buffer(InitialBufferSizeBytes));
         }
 
-        // Start the thread
-        boost::thread t(stdx::bind(&JournalWriter::_journalWriterThread, this));
-        _journalWriterThreadHandle.swap(t);
+        // Start the pipeline threads, last stage first
+        boost::thread dataFileWriter(stdx::bind(&JournalWriter::_runStage,
+                                                this,
+                                                "journal data file writer",
+                                                &JournalWriter::_journalDataFileWriterThread));
+        _journalDataFileWriterThreadHandle.swap(dataFileWriter);
+
+        boost::thread writer(stdx::bind(&JournalWriter::_runStage,
+                                        this,
+                                        "journal writer",
+                                        &JournalWriter::_journalWriterThread));
+        _journalWriterThreadHandle.swap(writer);
+
+        boost::thread compressor(stdx::bind(&JournalWriter::_runStage,
+                                            this,
+                                            "journal compressor",
+                                            &JournalWriter::_journalCompressorThread));
+        _journalCompressorThreadHandle.swap(compressor);
     }
 
     void JournalWriter::shutdown() {
@@ -149,12 +168,14 @@ namespace {
         Buffer* const shutdownBuffer = newBuffer();
         shutdownBuffer->_setShutdown();
 
-        // This will terminate the journal thread. No need to specify commit number, since we are
-        // shutting down and nothing will be notified anyways.
+        // This will terminate the journal threads, as it moves down the pipeline. No need to
+        // specify commit number, since we are shutting down and nothing will be notified anyways.
         writeBuffer(shutdownBuffer, 0);
 
-        // Ensure the journal thread has stopped and everything accounted for.
+        // Ensure the journal threads have stopped and everything accounted for.
+        _journalCompressorThreadHandle.join();
         _journalWriterThreadHandle.join();
+        _journalDataFileWriterThreadHandle.join();
         assertIdle();
 
         // Delete the buffers (this deallocates the journal buffer memory)
@@ -167,6 +188,8 @@ namespace {
     void JournalWriter::assertIdle() {
         // All buffers are in the ready queue means there is nothing pending.
         invariant(_journalQueue.empty());
+        invariant(_writeQueue.empty());
+        invariant(_dataFileQueue.empty());
         invariant(_readyQueue.count() == _readyQueue.maxSize());
     }
 
@@ -202,74 +225,114 @@ namespace {
         }
     }
 
+    void JournalWriter::_journalCompressorThread() {
+        while (true) {
+            Buffer* const buffer = _journalQueue.blockingPop();
+
+            if (!buffer->_isShutdown && !buffer->_isNoop) {
+                COMPRESSJOURNALSECTION(buffer->_header, buffer->_builder, &buffer->_section);
+            }
+
+            // The next stage has as many slots as there are buffers, so this never blocks
+            _writeQueue.push(buffer);
+
+            if (buffer->_isShutdown) {
+                break;
+            }
+        }
+    }
+
     void JournalWriter::_journalWriterThread() {
-        Client::initThread("journal writer");
+        while (true) {
+            Buffer* const buffer = _writeQueue.blockingPop();
 
-        log() << "Journal writer thread started";
+            if (buffer->_isShutdown) {
+                invariant(buffer->_builder.len() == 0);
 
-        try {
-            while (true) {
-                Buffer* const buffer = _journalQueue.blockingPop();
-                BufferGuard bufferGuard(buffer, &_readyQueue);
+                // Nothing to notify or write, just let the last stage terminate too.
+                _dataFileQueue.push(buffer);
+                break;
+            }
 
-                if (buffer->_isShutdown) {
-                    invariant(buffer->_builder.len() == 0);
+            if (buffer->_isNoop) {
+                invariant(buffer->_builder.len() == 0);
+
+                // There's nothing to be writen, but we still need to notify this commit number
+                _commitNotify->notifyAll(buffer->_commitNumber);
+                _dataFileQueue.push(buffer);
+                continue;
+            }
 
-                    // The journal writer thread is terminating. Nothing to notify or write.
-                    break;
-                }
+            LOG(4) << "Journaling commit number " << buffer->_commitNumber
+                   << " (journal file " << buffer->_header.fileId
+                   << ", sequence " << buffer->_header.seqNumber
+                   << ", size " << buffer->_builder.len() << " bytes)";
 
-                if (buffer->_isNoop) {
-                    invariant(buffer->_builder.len() == 0);
+            // This performs synchronous I/O to the journal file and will block.
+            WRITETOJOURNAL(buffer->_section, buffer->_builder.len());
 
-                    // There's nothing to be writen, but we still need to notify this commit number
-                    _commitNotify->notifyAll(buffer->_commitNumber);
-                    continue;
-                }
+            // Data is now persisted in the journal, which is sufficient for acknowledging
+            // getLastError
+            _commitNotify->notifyAll(buffer->_commitNumber);
 
-                LOG(4) << "Journaling commit number " << buffer->_commitNumber
-                       << " (journal file " << buffer->_header.fileId
-                       << ", sequence " << buffer->_header.seqNumber
-                       << ", size " << buffer->_builder.len() << " bytes)";
+            _dataFileQueue.push(buffer);
+        }
+    }
 
-                // This performs synchronous I/O to the journal file and will block.
-                WRITETOJOURNAL(buffer->_header, buffer->_builder);
+    void JournalWriter::_journalDataFileWriterThread() {
+        while (true) {
+            Buffer* const buffer = _dataFileQueue.blockingPop();
+            BufferGuard bufferGuard(buffer, &_readyQueue);
 
-                // Data is now persisted in the journal, which is sufficient for acknowledging
-                // getLastError
-                _commitNotify->notifyAll(buffer->_commitNumber);
+            if (buffer->_isShutdown) {
+                // The journal pipeline is terminating
+                break;
+            }
 
-                // Apply the journal entries on top of the shared view so that when flush is
-                // requested it would write the latest.
-                WRITETODATAFILES(buffer->_header, buffer->_builder);
+            if (buffer->_isNoop) {
+                continue;
             }
+
+            // Apply the journal entries on top of the shared view so that when flush is
+            // requested it would write the latest.
+            WRITETODATAFILES(buffer->_header, buffer->_builder);
+        }
+    }
+
+    void JournalWriter::_runStage(const char* threadName, void (JournalWriter::*stage)()) {
+        Client::initThread(threadName);
+
+        log() << "Journal pipeline thread started";
+
+        try {
+            (this->*stage)();
         }
         catch (const DBException& e) {
-            severe() << "dbexception in journalWriterThread causing immediate shutdown: "
+            severe() << "dbexception in " << threadName << " causing immediate shutdown: "
                      << e.toString();
             invariant(false);
         }
         catch (const std::ios_base::failure& e) {
-            severe() << "ios_base exception in journalWriterThread causing immediate shutdown: "
-                     << e.what();
+            severe() << "ios_base exception in " << threadName
+                     << " causing immediate shutdown: " << e.what();
             invariant(false);
         }
         catch (const std::bad_alloc& e) {
-            severe() << "bad_alloc exception in journalWriterThread causing immediate shutdown: "
-                     << e.what();
+            severe() << "bad_alloc exception in " << threadName
+                     << " causing immediate shutdown: " << e.what();
             invariant(false);
         }
         catch (const std::exception& e) {
-            severe() << "exception in journalWriterThread causing immediate shutdown: "
+            severe() << "exception in " << threadName << " causing immediate shutdown: "
                      << e.what();
             invariant(false);
         }
         catch (...) {
-            severe() << "unhandled exception in journalWriterThread causing immediate shutdown";
+            severe() << "unhandled exception in " << threadName << " causing immediate shutdown";
             invariant(false);
         }
 
-        log() << "Journal writer thread stopped";
+        log() << "Journal pipeline thread stopped";
 
         cc().shutdown();
     }
@@ -284,7 +347,8 @@ namespace {
           _isNoop(false),
           _isShutdown(false),
           _header(),
-          _builder(initialSize) {
+          _builder(initialSize),
+          _section(initialSize) {
 
     }
 
@@ -301,6 +365,7 @@ namespace {
         _commitNumber = 0;
         _isNoop = false;
         _builder.reset();
+        _section.reset();
     }
 
 } // namespace dur
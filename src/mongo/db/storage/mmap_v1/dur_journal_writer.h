@@ -40,9 +40,15 @@ namespace mongo {
 namespace dur {
 
     /**
-     * Manages the thread and queues used for writing the journal to disk and notify parties with
+     * Manages the threads and queues used for writing the journal to disk and notify parties with
      * are waiting on the write concern.
      *
+     * Submitted buffers go through a pipeline of three threads connected by bounded queues:
+     * the compressor builds the journal section, the writer appends it to the journal file and
+     * notifies the commit number, and the data file writer applies it to the shared view. Each
+     * stage handles buffers in submission order, so a large section being compressed or applied
+     * no longer holds up the write of the one before or after it.
+     *
      * NOTE: Not thread-safe and must not be used from more than one thread.
      */
     class JournalWriter {
@@ -87,6 +93,9 @@ namespace dur {
 
             JSectHeader _header;
             AlignedBuilder _builder;
+
+            // Compressed and framed journal section built from _builder by the compressor thread
+            AlignedBuilder _section;
         };
 
 
@@ -155,23 +164,39 @@ namespace dur {
         enum { InitialBufferSizeBytes = 4 * 1024 * 1024 };
 
 
+        void _journalCompressorThread();
         void _journalWriterThread();
+        void _journalDataFileWriterThread();
+
+        /**
+         * Runs one stage of the pipeline on the calling thread, terminating the process if it
+         * throws, since a journal stage cannot recover from errors.
+         */
+        void _runStage(const char* threadName, void (JournalWriter::*stage)());
 
 
         // This gets notified as journal buffers are written. It is not owned and needs to outlive
         // the journal writer object.
         NotifyAll* const _commitNotify;
 
-        // Wraps and controls the journal writer thread
+        // Wrap and control the journal pipeline threads
+        boost::thread _journalCompressorThreadHandle;
         boost::thread _journalWriterThreadHandle;
+        boost::thread _journalDataFileWriterThreadHandle;
 
         // Indicates that shutdown has been requested. Used for idempotency of the shutdown call.
         bool _shutdownRequested;
 
-        // Queue of buffers, which need to be written by the journal writer thread
+        // Queue of buffers, which need to be compressed by the journal compressor thread
         BufferQueue _journalQueue;
         NotifyAll::When _lastCommitNumber;
 
+        // Queue of compressed buffers, which need to be written by the journal writer thread
+        BufferQueue _writeQueue;
+
+        // Queue of journaled buffers, which need to be applied to the shared view
+        BufferQueue _dataFileQueue;
+
         // Queue of buffers, whose write has been completed by the journal writer thread.
         BufferQueue _readyQueue;
     };
@@ -53,9 +53,17 @@ namespace mongo {
              */
             void rotate();
 
-            /** append to the journal file
+            /** compress uncompressed and frame it with its header and footer into section, ready
+                to be appended by journal(). Touches no journal state, so it can run ahead of
+                the write of the previous section.
             */
-            void journal(const JSectHeader& h, const AlignedBuilder& b);
+            static void prepSection(const JSectHeader& h,
+                                    const AlignedBuilder& uncompressed,
+                                    AlignedBuilder* section);
+
+            /** append a section built by prepSection() to the journal file
+            */
+            void journal(const AlignedBuilder& section, unsigned uncompressedLen);
 
             boost::filesystem::path getFilePathFor(int filenumber) const;
 
@@ -40,6 +40,7 @@
 #include <sys/stat.h>
 
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/dur_commitjob.h"
 #include "mongo/db/storage/mmap_v1/dur_journal.h"
 #include "mongo/db/storage/mmap_v1/dur_journalformat.h"
@@ -54,6 +55,7 @@
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/startup_test.h"
 
 namespace mongo {
@@ -80,6 +82,11 @@ namespace mongo {
 
     namespace dur {
 
+        // Threads used while recovering. With at least one, the next journal section is checked
+        // and decompressed while the current one is applied. With more than one, the writes of
+        // a section to different data files are applied in parallel. 0 recovers serially.
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalRecoveryThreads, int, 4);
+
         // The singleton recovery job object
         RecoveryJob& RecoveryJob::_instance = *(new RecoveryJob());
 
@@ -160,6 +167,16 @@ namespace mongo {
                 _entries = auto_ptr<BufReader>(new BufReader(p, _uncompressed.size()));
             }
 
+            // Recovery with a section which was already checked and decompressed. Takes the
+            // contents of 'uncompressed'.
+            JournalSectionIterator(const JSectHeader& h, string* uncompressed)
+                : _h(h),
+                  _lastDbName(0),
+                  _doDurOps(true) {
+                _uncompressed.swap(*uncompressed);
+                _entries.reset(new BufReader(_uncompressed.c_str(), _uncompressed.size()));
+            }
+
             // We work with the uncompressed buffer when doing a WRITETODATAFILES (for speed)
             JournalSectionIterator(const JSectHeader &h, const void *p, unsigned len)
                 : _entries(new BufReader((const char *)p, len)),
@@ -366,6 +383,73 @@ namespace mongo {
             }
         }
 
+        namespace {
+
+            /** The writes of a journal section to one data file, in journal order. */
+            struct DataFileWrites {
+                DataFileWrites() : view(NULL), bytes(0) { }
+
+                char* view;
+                vector<const JEntry*> writes;
+                unsigned long long bytes;
+            };
+
+            void copyWrites(const DataFileWrites* dataFileWrites) {
+                for (size_t i = 0; i < dataFileWrites->writes.size(); ++i) {
+                    const JEntry* e = dataFileWrites->writes[i];
+                    memcpy(dataFileWrites->view + e->ofs, e->srcData(), e->len);
+                }
+            }
+
+        } // namespace
+
+        void RecoveryJob::applyWritesInParallel(Last& last,
+                                                const vector<ParsedJournalEntry>& entries,
+                                                size_t begin,
+                                                size_t end) {
+            // Files are looked up and bounds checked here, so that the tasks only copy.
+            vector<DataFileWrites> byFile;
+            map<DurableMappedFile*, size_t> fileIndexes;
+            for (size_t i = begin; i < end; ++i) {
+                const ParsedJournalEntry& entry = entries[i];
+                verify(entry.e);
+                verify(entry.dbName);
+
+                DurableMappedFile* mmf = last.newEntry(entry, *this);
+                if ((entry.e->ofs + entry.e->len) > mmf->length()) {
+                    // The data file was truncated after this write, see write().
+                    continue;
+                }
+
+                pair<map<DurableMappedFile*, size_t>::iterator, bool> inserted =
+                    fileIndexes.insert(std::make_pair(mmf, byFile.size()));
+                if (inserted.second) {
+                    byFile.push_back(DataFileWrites());
+                    verify(mmf->view_write());
+                    byFile.back().view = static_cast<char*>(mmf->view_write());
+                }
+
+                DataFileWrites& dataFileWrites = byFile[inserted.first->second];
+                verify(entry.e->srcData());
+                dataFileWrites.writes.push_back(entry.e);
+                dataFileWrites.bytes += entry.e->len;
+            }
+
+            if (byFile.size() > 1) {
+                for (size_t i = 0; i < byFile.size(); ++i) {
+                    _applyPool->schedule(copyWrites, &byFile[i]);
+                }
+                _applyPool->join();
+            }
+            else if (byFile.size() == 1) {
+                copyWrites(&byFile[0]);
+            }
+
+            for (size_t i = 0; i < byFile.size(); ++i) {
+                stats.curr()->_writeToDataFilesBytes += byFile[i].bytes;
+            }
+        }
+
         void RecoveryJob::applyEntries(const vector<ParsedJournalEntry> &entries) {
             const bool apply =
                 (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalScanOnly) == 0;
@@ -377,8 +461,24 @@ namespace mongo {
             }
 
             Last last;
-            for (vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
-                applyEntry(last, *i, apply, dump);
+            if (apply && _applyPool) {
+                // DurOps may close or drop files, so the writes are applied in parallel between
+                // them and the DurOps themselves one at a time.
+                size_t begin = 0;
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    if (entries[i].e) {
+                        continue;
+                    }
+                    applyWritesInParallel(last, entries, begin, i);
+                    applyEntry(last, entries[i], apply, dump);
+                    begin = i + 1;
+                }
+                applyWritesInParallel(last, entries, begin, entries.size());
+            }
+            else {
+                for (vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+                    applyEntry(last, *i, apply, dump);
+                }
             }
 
             if (dump) {
@@ -386,6 +486,28 @@ namespace mongo {
             }
         }
 
+        bool RecoveryJob::isSectionSynced(const JSectHeader& h) const {
+            return _lastDataSyncedFromLastRun > h.seqNumber + ExtraKeepTimeMs;
+        }
+
+        bool RecoveryJob::skipSection(const JSectHeader& h) {
+            if( !_recovering || !isSectionSynced(h) ) {
+                return false;
+            }
+
+            if( h.seqNumber != _lastSeqMentionedInConsoleLog ) {
+                static int n;
+                if( ++n < 10 ) {
+                    log() << "recover skipping application of section seq:" << h.seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
+                }
+                else if( n == 10 ) { 
+                    log() << "recover skipping application of section more..." << endl;
+                }
+                _lastSeqMentionedInConsoleLog = h.seqNumber;
+            }
+            return true;
+        }
+
         void RecoveryJob::processSection(const JSectHeader *h, const void *p, unsigned len, const JSectFooter *f) {
             LockMongoFilesShared lkFiles; // for RecoveryJob::Last
             scoped_lock lk(_mx);
@@ -399,17 +521,7 @@ namespace mongo {
                 }
             }
 
-            if( _recovering && _lastDataSyncedFromLastRun > h->seqNumber + ExtraKeepTimeMs ) {
-                if( h->seqNumber != _lastSeqMentionedInConsoleLog ) {
-                    static int n;
-                    if( ++n < 10 ) {
-                        log() << "recover skipping application of section seq:" << h->seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
-                    }
-                    else if( n == 10 ) { 
-                        log() << "recover skipping application of section more..." << endl;
-                    }
-                    _lastSeqMentionedInConsoleLog = h->seqNumber;
-                }
+            if( skipSection(*h) ) {
                 return;
             }
 
@@ -421,6 +533,48 @@ namespace mongo {
                 i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, /*after header*/p, /*w/out header*/len));
             }
 
+            applySection(i.get());
+        }
+
+        void RecoveryJob::prepareSection(PreparedSection* section) const {
+            // Runs on _readAheadPool, so it only reads the journal file and the section.
+            section->corruption = NULL;
+            section->uncompressed.clear();
+
+            if (!section->f->checkHash(section->h, section->len + sizeof(JSectHeader))) {
+                section->corruption = "journal section checksum doesn't match";
+                return;
+            }
+
+            if (isSectionSynced(*section->h)) {
+                return;
+            }
+
+            // We check the checksum before we uncompress, but this may still fail as the
+            // checksum isn't foolproof.
+            if (!uncompress(section->data, section->len, &section->uncompressed)) {
+                section->corruption = "couldn't uncompress journal section";
+            }
+        }
+
+        void RecoveryJob::processPreparedSection(PreparedSection* section) {
+            LockMongoFilesShared lkFiles; // for RecoveryJob::Last
+            scoped_lock lk(_mx);
+
+            if (section->corruption) {
+                log() << section->corruption;
+                throw JournalSectionCorruptException();
+            }
+
+            if( skipSection(*section->h) ) {
+                return;
+            }
+
+            JournalSectionIterator i(*section->h, &section->uncompressed);
+            applySection(&i);
+        }
+
+        void RecoveryJob::applySection(JournalSectionIterator* i) {
             // we use a static so that we don't have to reallocate every time through.  occasionally we 
             // go back to a small allocation so that if there were a spiky growth it won't stick forever.
             static vector<ParsedJournalEntry> entries;
@@ -445,6 +599,75 @@ namespace mongo {
             applyEntries(entries);
         }
 
+        bool RecoveryJob::readSection(BufReader& br,
+                                      unsigned long long fileId,
+                                      PreparedSection* section,
+                                      bool* abruptEnd) const {
+            if (br.atEof()) {
+                *abruptEnd = false;
+                return false;
+            }
+
+            try {
+                JSectHeader h;
+                br.peek(h);
+                if( h.fileId != fileId ) {
+                    if (debug) {
+                        log() << "Ending processFileBuffer at differing fileId want:" << fileId << " got:" << h.fileId << endl;
+                        log() << "  sect len:" << h.sectionLen() << " seqnum:" << h.seqNumber << endl;
+                    }
+                    *abruptEnd = true;
+                    return false;
+                }
+                unsigned slen = h.sectionLen();
+                unsigned dataLen = slen - sizeof(JSectHeader) - sizeof(JSectFooter);
+                const char *hdr = (const char *) br.skip(h.sectionLenWithPadding());
+                section->h = (const JSectHeader*) hdr;
+                section->data = hdr + sizeof(JSectHeader);
+                section->len = dataLen;
+                section->f = (const JSectFooter*) (section->data + dataLen);
+            }
+            catch (const BufReader::eof&) {
+                *abruptEnd = true;
+                return false;
+            }
+            return true;
+        }
+
+        bool RecoveryJob::processSectionsReadingAhead(BufReader& br, unsigned long long fileId) {
+            PreparedSection sections[2];
+            PreparedSection* current = &sections[0];
+            PreparedSection* next = &sections[1];
+
+            // The section being prepared is on this frame, so wait for it however we leave.
+            ON_BLOCK_EXIT(&ThreadPool::join, _readAheadPool.get());
+
+            bool abruptEnd;
+            if (!readSection(br, fileId, current, &abruptEnd)) {
+                return abruptEnd;
+            }
+            _readAheadPool->schedule(&RecoveryJob::prepareSection, this, current);
+
+            while (true) {
+                const bool haveNext = readSection(br, fileId, next, &abruptEnd);
+
+                _readAheadPool->join();
+                if (haveNext) {
+                    _readAheadPool->schedule(&RecoveryJob::prepareSection, this, next);
+                }
+
+                processPreparedSection(current);
+
+                // ctrl c check
+                uassert(ErrorCodes::Interrupted, "interrupted during journal recovery", !inShutdown());
+
+                if (!haveNext) {
+                    return abruptEnd;
+                }
+                std::swap(current, next);
+            }
+        }
+
         /** apply a specific journal file, that is already mmap'd
             @param p start of the memory mapped file
             @return true if this is detected to be the last file (ends abruptly)
@@ -482,6 +705,10 @@ namespace mongo {
                     }
                 }
 
+                if (_readAheadPool) {
+                    return processSectionsReadingAhead(br, fileId);
+                }
+
                 // read sections
                 while ( !br.atEof() ) {
                     JSectHeader h;
@@ -549,6 +776,15 @@ namespace mongo {
             _lastDataSyncedFromLastRun = journalReadLSN();
             log() << "recover lsn: " << _lastDataSyncedFromLastRun << endl;
 
+            // Dumping logs every entry in order, so it stays serial.
+            if (journalRecoveryThreads > 0 &&
+                !(mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalDumpJournal)) {
+                _readAheadPool.reset(new ThreadPool(1, "journalReadAhead"));
+                if (journalRecoveryThreads > 1) {
+                    _applyPool.reset(new ThreadPool(journalRecoveryThreads, "journalRecovery"));
+                }
+            }
+
             for( unsigned i = 0; i != files.size(); ++i ) {
                 bool abruptEnd = processFile(files[i]);
                 if( abruptEnd && i+1 < files.size() ) {
@@ -559,6 +795,8 @@ namespace mongo {
             }
 
             close();
+            _readAheadPool.reset();
+            _applyPool.reset();
 
             if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalScanOnly) {
                 uasserted(13545, str::stream() << "--durOptions "
@@ -31,18 +31,22 @@
 #pragma once
 
 #include <boost/filesystem/operations.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <list>
 
 #include "mongo/db/storage/mmap_v1/dur_journalformat.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
 
+    class BufReader;
     class DurableMappedFile;
 
     namespace dur {
 
+        class JournalSectionIterator;
         struct ParsedJournalEntry;
 
         /** call go() to execute a recovery from existing journal files.
@@ -77,11 +81,62 @@ namespace mongo {
             };
 
 
+            /** A journal section checked and decompressed ahead of being applied. */
+            struct PreparedSection {
+                const JSectHeader* h;
+                const char* data;
+                unsigned len;
+                const JSectFooter* f;
+
+                // NULL, or what is wrong with the section
+                const char* corruption;
+
+                std::string uncompressed;
+            };
+
             void write(Last& last, const ParsedJournalEntry& entry); // actually writes to the file
             void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
             void applyEntries(const std::vector<ParsedJournalEntry> &entries);
+
+            /**
+             * Applies the basic writes entries[begin, end) on _applyPool, one task per data
+             * file. Writes to the same file stay in journal order.
+             */
+            void applyWritesInParallel(Last& last,
+                                       const std::vector<ParsedJournalEntry>& entries,
+                                       size_t begin,
+                                       size_t end);
+
             bool processFileBuffer(const void *, unsigned len);
+
+            /**
+             * Like the section loop of processFileBuffer(), but checks and decompresses the
+             * next section on _readAheadPool while the current one is applied.
+             */
+            bool processSectionsReadingAhead(BufReader& br, unsigned long long fileId);
+
+            /**
+             * Reads the location of the next section of file 'fileId' from 'br' into 'section'.
+             * Returns false at the end of the file's sections, setting '*abruptEnd' if they
+             * ended abruptly.
+             */
+            bool readSection(BufReader& br,
+                             unsigned long long fileId,
+                             PreparedSection* section,
+                             bool* abruptEnd) const;
+
+            void prepareSection(PreparedSection* section) const;
+            void processPreparedSection(PreparedSection* section);
+
             bool processFile(boost::filesystem::path journalfile);
+
+            /** True if the data files already held the writes of this section at the crash. */
+            bool isSectionSynced(const JSectHeader& h) const;
+
+            /** Logs and returns true if the section's writes should not be applied. */
+            bool skipSection(const JSectHeader& h);
+
+            void applySection(JournalSectionIterator* i); // doesn't lock
             void _close(); // doesn't lock
 
 
@@ -95,6 +150,10 @@ namespace mongo {
             unsigned long long _lastDataSyncedFromLastRun;
             unsigned long long _lastSeqMentionedInConsoleLog;
 
+            // Only set while recovering. See journalRecoveryThreads.
+            boost::scoped_ptr<ThreadPool> _readAheadPool;
+            boost::scoped_ptr<ThreadPool> _applyPool;
+
 
             static RecoveryJob& _instance;
         };
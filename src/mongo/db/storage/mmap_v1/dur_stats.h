@@ -65,6 +65,7 @@ namespace mongo {
                 uint64_t _writeToDataFilesBytes;
 
                 uint64_t _prepLogBufferMicros;
+                uint64_t _compressJournalMicros;
                 uint64_t _writeToJournalMicros;
                 uint64_t _writeToDataFilesMicros;
                 uint64_t _remapPrivateViewMicros;
@@ -245,17 +245,24 @@ namespace mongo {
         _p = RelativePath::fromFullPath(storageGlobalParams.dbpath, prefix);
     }
 
-    bool DurableMappedFile::open(const std::string& fname, bool sequentialHint) {
+    bool DurableMappedFile::open(const std::string& fname, bool sequentialHint, bool randomHint) {
         LOG(3) << "mmf open " << fname;
         setPath(fname);
-        _view_write = mapWithOptions(fname.c_str(), sequentialHint ? SEQUENTIAL : 0);
+        _view_write = mapWithOptions(fname.c_str(),
+                                     (sequentialHint ? SEQUENTIAL : 0) |
+                                     (randomHint ? RANDOM : 0));
         return finishOpening();
     }
 
-    bool DurableMappedFile::create(const std::string& fname, unsigned long long& len, bool sequentialHint) {
+    bool DurableMappedFile::create(const std::string& fname,
+                                   unsigned long long& len,
+                                   bool sequentialHint,
+                                   bool randomHint) {
         LOG(3) << "mmf create " << fname;
         setPath(fname);
-        _view_write = map(fname.c_str(), len, sequentialHint ? SEQUENTIAL : 0);
+        _view_write = map(fname.c_str(),
+                          len,
+                          (sequentialHint ? SEQUENTIAL : 0) | (randomHint ? RANDOM : 0));
         return finishOpening();
     }
 
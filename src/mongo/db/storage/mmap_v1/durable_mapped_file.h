@@ -48,8 +48,11 @@ namespace mongo {
         DurableMappedFile();
         virtual ~DurableMappedFile();
 
-        /** @return true if opened ok. */
-        bool open(const std::string& fname, bool sequentialHint /*typically we open with this false*/);
+        /** @param randomHint if true will be accessed by point lookups, see MongoFile::RANDOM
+            @return true if opened ok. */
+        bool open(const std::string& fname,
+                  bool sequentialHint /*typically we open with this false*/,
+                  bool randomHint = false);
 
         /** @return file length */
         unsigned long long length() const { return MemoryMappedFile::length(); }
@@ -61,9 +64,13 @@ namespace mongo {
         /* Creates with length if DNE, otherwise uses existing file length,
            passed length.
            @param sequentialHint if true will be sequentially accessed
+           @param randomHint if true will be accessed by point lookups
            @return true for ok
         */
-        bool create(const std::string& fname, unsigned long long& len, bool sequentialHint);
+        bool create(const std::string& fname,
+                    unsigned long long& len,
+                    bool sequentialHint,
+                    bool randomHint = false);
 
         /* Get the "standard" view (which is the private one).
            @return the private view.
@@ -31,9 +31,17 @@
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
 
 #include "mongo/db/storage/mmap_v1/extent.h"
+#include "mongo/db/storage/record_fetcher.h"
 
 namespace mongo {
 
+    void ExtentManager::recordsNeedFetch( const std::vector<DiskLoc>& locs,
+                                          OwnedPointerVector<RecordFetcher>* fetchers ) const {
+        for ( size_t i = 0; i < locs.size(); i++ ) {
+            fetchers->push_back( recordNeedsFetch( locs[i] ) );
+        }
+    }
+
     int ExtentManager::quantizeExtentSize( int size ) const {
 
         if ( size == maxSize() ) {
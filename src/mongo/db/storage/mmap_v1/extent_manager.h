@@ -33,6 +33,7 @@
 #include <string>
 #include <vector>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/status.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/storage/mmap_v1/diskloc.h"
@@ -118,6 +119,19 @@ namespace mongo {
          */
         virtual RecordFetcher* recordNeedsFetch( const DiskLoc& loc ) const = 0;
 
+        /**
+         * Appends to 'fetchers' what recordNeedsFetch() returns for each of 'locs', in order.
+         * Implementations may answer for all of them at once.
+         */
+        virtual void recordsNeedFetch( const std::vector<DiskLoc>& locs,
+                                       OwnedPointerVector<RecordFetcher>* fetchers ) const;
+
+        /**
+         * Starts reading the record at 'loc' into physical memory without waiting for it.
+         * Does nothing by default.
+         */
+        virtual void prefetchRecord( const DiskLoc& loc ) const { }
+
         /**
          * @param loc - has to be for a specific Record (not an Extent)
          * Note(erh) see comment on recordFor
@@ -162,13 +176,17 @@ namespace mongo {
         virtual int quantizeExtentSize( int size ) const;
 
         // see cacheHint methods
-        enum HintType { Sequential, Random };
+        //   Sequential - the extent is being scanned in order
+        //   Random - the extent is accessed by point lookups
+        //   WillNeed - the extent is about to be scanned, start reading its beginning now
+        enum HintType { Sequential, Random, WillNeed };
         class CacheHint {
         public:
             virtual ~CacheHint(){}
         };
         /**
-         * Tell the system that for this extent, it will have this kind of disk access.
+         * Tell the system that for this extent, it will have this kind of disk access, until
+         * the returned CacheHint is destroyed.
          * Caller takes owernship of CacheHint
          */
         virtual CacheHint* cacheHint( const DiskLoc& extentLoc, const HintType& hint ) = 0;
@@ -36,7 +36,9 @@
 #include <boost/filesystem/operations.hpp>
 #include <fstream>
 
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/mongod_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/data_file_sync.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/storage/mmap_v1/dur_journal.h"
@@ -59,8 +61,34 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    // Number of threads filling data file allocation requests. More than one lets the files
+    // preallocated ahead of a growing database be created in parallel.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(mmapv1FileAllocatorThreads, int, 2);
+
 namespace {
 
+    /**
+     * Data file allocation counts and latencies.
+     */
+    class FileAllocatorSSS : public ServerStatusSection {
+    public:
+        FileAllocatorSSS() : ServerStatusSection("fileAllocator") { }
+
+        virtual bool includeByDefault() const { return true; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            if (storageGlobalParams.engine != "mmapv1") {
+                return BSONObj();
+            }
+
+            BSONObjBuilder b;
+            FileAllocator::get()->appendStats(&b);
+            return b.obj();
+        }
+
+    } fileAllocatorSSS;
+
 #if !defined(__sunos__)
     // if doingRepair is true don't consider unclean shutdown an error
     void acquirePathLock(MMAPV1Engine* storageEngine,
@@ -222,7 +250,7 @@ namespace {
 
         acquirePathLock(this, storageGlobalParams.repair, lockFile);
 
-        FileAllocator::get()->start();
+        FileAllocator::get()->start(mmapv1FileAllocatorThreads);
 
         MONGO_ASSERT_ON_EXCEPTION_WITH_MSG( clearTmpFiles(), "clear tmp files" );
     }
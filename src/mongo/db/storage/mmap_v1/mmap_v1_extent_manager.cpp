@@ -37,6 +37,7 @@
 #include "mongo/base/counter.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/global_environment_experiment.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/storage/mmap_v1/data_file.h"
@@ -47,10 +48,13 @@
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/file.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mmap.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -67,6 +71,13 @@ namespace mongo {
     static Counter64 needsFetchFailCounter;
     MONGO_FP_DECLARE(recordNeedsFetchFail);
 
+    // Upper bound on the number of data files requested from the FileAllocator ahead of the
+    // one being added. The actual count follows the database's recent growth rate.
+    MONGO_EXPORT_SERVER_PARAMETER(mmapv1MaxFilesToPreallocate, int, 4);
+
+    // Preallocate enough files to cover this much time at the current growth rate.
+    static const double kPreallocateWindowMillis = 60 * 1000;
+
     // Used to make sure the compiler doesn't get too smart on us when we're
     // trying to touch records.
     volatile int __record_touch_dummy = 1;
@@ -113,7 +124,9 @@ namespace mongo {
         : _dbname(dbname.toString()),
           _path(path.toString()),
           _directoryPerDB(directoryPerDB),
-          _rid(RESOURCE_METADATA, dbname) {
+          _rid(RESOURCE_METADATA, dbname),
+          _lastFileAddMillis(0),
+          _fileAddIntervalMillis(0) {
         StorageEngine* engine = getGlobalEnvironment()->getGlobalStorageEngine();
         invariant(engine->isMmapV1());
         MMAPV1Engine* mmapEngine = static_cast<MMAPV1Engine*>(engine);
@@ -253,16 +266,43 @@ namespace mongo {
 
         // Preallocate is asynchronous
         if (preallocateNextFile) {
-            auto_ptr<DataFile> nextFile(new DataFile(allocFileId + 1));
-            const string nextFileName = _fileName(allocFileId + 1).string();
+            const int filesAhead = _forecastFilesAhead();
+            const int nextMinSize = _files[allocFileId]->getHeader()->fileLength;
+
+            for (int i = 1; i <= filesAhead && allocFileId + i < DiskLoc::MaxFiles; i++) {
+                auto_ptr<DataFile> nextFile(new DataFile(allocFileId + i));
+                const string nextFileName = _fileName(allocFileId + i).string();
 
-            nextFile->open(txn, nextFileName.c_str(), minSize, false);
+                nextFile->open(txn, nextFileName.c_str(), nextMinSize, true);
+            }
         }
 
         // Returns the last file added
         return _files[allocFileId];
     }
 
+    int MmapV1ExtentManager::_forecastFilesAhead() {
+        const unsigned long long now = curTimeMillis64();
+        if (_lastFileAddMillis != 0) {
+            const double interval = static_cast<double>(now - _lastFileAddMillis);
+            _fileAddIntervalMillis = (_fileAddIntervalMillis == 0)
+                ? interval
+                : (_fileAddIntervalMillis + interval) / 2;
+        }
+        _lastFileAddMillis = now;
+
+        const int maxAhead = std::max(mmapv1MaxFilesToPreallocate, 1);
+        if (_fileAddIntervalMillis <= 0) {
+            return 1;
+        }
+
+        const double forecast = kPreallocateWindowMillis / _fileAddIntervalMillis;
+        if (forecast >= maxAhead) {
+            return maxAhead;
+        }
+        return std::max(static_cast<int>(forecast + 0.5), 1);
+    }
+
     int MmapV1ExtentManager::numFiles() const {
         return _files.size();
     }
@@ -313,6 +353,33 @@ namespace mongo {
         return NULL;
     }
 
+    void MmapV1ExtentManager::recordsNeedFetch( const std::vector<DiskLoc>& locs,
+                                                OwnedPointerVector<RecordFetcher>* fetchers ) const {
+        std::vector<const void*> records;
+        records.reserve( locs.size() );
+        for ( size_t i = 0; i < locs.size(); i++ ) {
+            records.push_back( _recordForV1( locs[i] ) );
+        }
+
+        std::vector<bool> inMemory;
+        _recordAccessTracker->checkAccessedAndMarkMany( records, &inMemory );
+
+        for ( size_t i = 0; i < locs.size(); i++ ) {
+            const Record* record = static_cast<const Record*>( records[i] );
+            bool needsFetch = !inMemory[i];
+
+            // For testing: as in recordNeedsFetch().
+            if ( MONGO_FAIL_POINT( recordNeedsFetchFail ) ) {
+                needsFetchFailCounter.increment();
+                if ( ( needsFetchFailCounter.get() % kNeedsFetchFailFreq ) == 0 ) {
+                    needsFetch = true;
+                }
+            }
+
+            fetchers->push_back( needsFetch ? new MmapV1RecordFetcher( record ) : NULL );
+        }
+    }
+
     DiskLoc MmapV1ExtentManager::extentLocForV1( const DiskLoc& loc ) const {
         Record* record = recordForV1( loc );
         return DiskLoc( loc.a(), record->extentOfs() );
@@ -396,7 +463,7 @@ namespace mongo {
         // no space in an existing file
         // allocate files until we either get one big enough or hit maxSize
         for ( int i = 0; i < 8; i++ ) {
-            DataFile* f = _addAFile( txn, size, false );
+            DataFile* f = _addAFile( txn, size, i == 0 );
 
             if ( f->getHeader()->unusedLength >= size ) {
                 return _createExtentInFile( txn, numFiles() - 1, f, size, enforceQuota );
@@ -633,21 +700,100 @@ namespace mongo {
     namespace {
         class CacheHintMadvise : public ExtentManager::CacheHint {
         public:
-            CacheHintMadvise(void *p, unsigned len, MAdvise::Advice a)
-                : _advice( p, len, a ) {
+            CacheHintMadvise(void *p, unsigned len, MAdvise::Advice a, MAdvise::Advice restoreTo)
+                : _advice( p, len, a, restoreTo ) {
             }
         private:
             MAdvise _advice;
         };
+
+        // At most this much of an extent is read ahead by a WillNeed hint. Kernel readahead
+        // takes over once a sequential scan is inside the extent.
+        const unsigned kMaxPrefetchBytes = 4 * 1024 * 1024;
+
+        Counter64 sequentialHints;
+        Counter64 prefetchHints;
+        Counter64 prefetchedPagesNotResident;
+        Counter64 prefetchedRecords;
+
+        ServerStatusMetricField<Counter64> dSequentialHints( "storage.readahead.sequentialExtents",
+                                                             &sequentialHints );
+        ServerStatusMetricField<Counter64> dPrefetchHints( "storage.readahead.prefetchedExtents",
+                                                           &prefetchHints );
+        ServerStatusMetricField<Counter64> dFaultsAvoided( "storage.readahead.faultsAvoided",
+                                                           &prefetchedPagesNotResident );
+        ServerStatusMetricField<Counter64> dPrefetchedRecords( "storage.readahead.prefetchedRecords",
+                                                               &prefetchedRecords );
+
+        /**
+         * Counts the pages of the range which are not resident yet. Each one would have been a
+         * page fault on first access, had it not been read ahead.
+         */
+        void countNonResidentPages(const void* p, unsigned len) {
+            if (!ProcessInfo::blockCheckSupported()) {
+                return;
+            }
+
+            const size_t pageSize = ProcessInfo::getPageSize();
+            const char* start = static_cast<const char*>(ProcessInfo::alignToStartOfPage(p));
+            const size_t numPages =
+                (static_cast<const char*>(p) + len - start + pageSize - 1) / pageSize;
+
+            std::vector<char> resident;
+            if (!ProcessInfo::pagesInMemory(start, numPages, &resident)) {
+                return;
+            }
+
+            long long missing = 0;
+            for (size_t i = 0; i < resident.size(); i++) {
+                if (!resident[i]) {
+                    missing++;
+                }
+            }
+            prefetchedPagesNotResident.increment(missing);
+        }
     }
 
     ExtentManager::CacheHint* MmapV1ExtentManager::cacheHint( const DiskLoc& extentLoc,
                                                               const ExtentManager::HintType& hint ) {
-        invariant ( hint == Sequential );
         Extent* e = getExtent( extentLoc );
-        return new CacheHintMadvise( reinterpret_cast<void*>( e ),
-                                     e->length,
-                                     MAdvise::Sequential );
+        const MAdvise::Advice restoreTo =
+            mmapv1RandomAccessDataFiles ? MAdvise::Random : MAdvise::Normal;
+
+        switch ( hint ) {
+        case Sequential:
+            sequentialHints.increment();
+            return new CacheHintMadvise( reinterpret_cast<void*>( e ),
+                                         e->length,
+                                         MAdvise::Sequential,
+                                         restoreTo );
+        case Random:
+            return new CacheHintMadvise( reinterpret_cast<void*>( e ),
+                                         e->length,
+                                         MAdvise::Random,
+                                         restoreTo );
+        case WillNeed: {
+            const unsigned len = std::min( static_cast<unsigned>( e->length ),
+                                           kMaxPrefetchBytes );
+            prefetchHints.increment();
+            countNonResidentPages( e, len );
+            return new CacheHintMadvise( reinterpret_cast<void*>( e ),
+                                         len,
+                                         MAdvise::WillNeed,
+                                         MAdvise::WillNeed );
+        }
+        }
+
+        invariant( false );
+        return NULL;
+    }
+
+    void MmapV1ExtentManager::prefetchRecord( const DiskLoc& loc ) const {
+        // Only the page holding the record header is advised: reading the record length to size
+        // the range would fault the page in synchronously, which is what we want to avoid.
+        Record* record = _recordForV1( loc );
+        prefetchedRecords.increment();
+        MAdvise advice( record, Record::HeaderSize, MAdvise::WillNeed, MAdvise::WillNeed );
     }
 
     MmapV1ExtentManager::FilesArray::~FilesArray() {
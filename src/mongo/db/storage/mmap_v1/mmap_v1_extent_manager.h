@@ -126,6 +126,11 @@ namespace mongo {
 
         RecordFetcher* recordNeedsFetch( const DiskLoc& loc ) const;
 
+        void recordsNeedFetch( const std::vector<DiskLoc>& locs,
+                               OwnedPointerVector<RecordFetcher>* fetchers ) const;
+
+        void prefetchRecord( const DiskLoc& loc ) const;
+
         /**
          * @param loc - has to be for a specific Record (not an Extent)
          * Note(erh) see comment on recordFor
@@ -167,6 +172,12 @@ namespace mongo {
 
         DataFile* _addAFile( OperationContext* txn, int sizeNeeded, bool preallocateNextFile );
 
+        /**
+         * Updates the file growth forecast for a file added now and returns how many of the
+         * following files should be preallocated.
+         */
+        int _forecastFilesAhead();
+
 
         /**
          * Shared record retrieval logic used by the public recordForV1() and likelyInPhysicalMem()
@@ -197,6 +208,11 @@ namespace mongo {
         const bool _directoryPerDB;
         const ResourceId _rid;
 
+        // Time the last data file was added and a moving average of the time between additions.
+        // Only accessed under the extent manager lock.
+        unsigned long long _lastFileAddMillis;
+        double _fileAddIntervalMillis;
+
         // This reference points into the MMAPv1 engine and is only valid as long as the
         // engine is valid. Not owned here.
         RecordAccessTracker* _recordAccessTracker;
@@ -30,6 +30,7 @@
 
 #include "mongo/db/storage/mmap_v1/record_access_tracker.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "mongo/base/init.h"
@@ -319,20 +320,25 @@ namespace mongo {
     }
 
 
-    bool RecordAccessTracker::checkAccessedAndMark(const void* record) {
+    bool RecordAccessTracker::_accessedRecentlyAndMark(const void* record) {
         const size_t page = reinterpret_cast<size_t>(record) >> 12;
         const size_t region = page >> 6;
         const size_t offset = page & 0x3f;
 
         // This is like the "L1 cache". If we're a miss then we fall through and check the
-        // "L2 cache". If we're still a miss, then we defer to a system-specific system
-        // call (or give up and return false if deferring to the system call is not enabled).
+        // "L2 cache".
         if (PointerTable::seen(PointerTable::getData(), reinterpret_cast<size_t>(record))) {
             return true;
         }
 
         // We were a miss in the PointerTable. See if we can find 'record' in the Rolling table.
-        if (_rollingTable[bigHash(region)].access(region, offset, false)) {
+        return _rollingTable[bigHash(region)].access(region, offset, false);
+    }
+
+    bool RecordAccessTracker::checkAccessedAndMark(const void* record) {
+        // If we're a miss in both caches, then we defer to a system-specific system call (or
+        // give up and return false if deferring to the system call is not enabled).
+        if (_accessedRecentlyAndMark(record)) {
             return true;
         }
 
@@ -346,6 +352,57 @@ namespace mongo {
         return ProcessInfo::blockInMemory(const_cast<void*>(record));
     }
 
+    void RecordAccessTracker::checkAccessedAndMarkMany(const std::vector<const void*>& records,
+                                                       std::vector<bool>* inMemory) {
+        inMemory->assign(records.size(), true);
+
+        // The address of each record which missed both caches, paired with the record's index.
+        std::vector<std::pair<size_t, size_t> > misses;
+        for (size_t i = 0; i < records.size(); i++) {
+            if (!_accessedRecentlyAndMark(records[i])) {
+                (*inMemory)[i] = false;
+                misses.push_back(std::make_pair(reinterpret_cast<size_t>(records[i]), i));
+            }
+        }
+
+        if (misses.empty() || !_blockSupported) {
+            return;
+        }
+
+        // Ask about each run of pages spanning at most MaxPagesPerBlockCheck pages at once. The
+        // pages between the records may not all be mapped, in which case the run is checked one
+        // record at a time instead.
+        std::sort(misses.begin(), misses.end());
+        const size_t pageSize = ProcessInfo::getPageSize();
+        for (size_t i = 0; i < misses.size(); i++) {
+            misses[i].first /= pageSize;
+        }
+
+        std::vector<char> resident;
+        size_t runStart = 0;
+        while (runStart < misses.size()) {
+            const size_t firstPage = misses[runStart].first;
+            size_t runEnd = runStart + 1;
+            while (runEnd < misses.size()
+                   && misses[runEnd].first - firstPage < MaxPagesPerBlockCheck) {
+                runEnd++;
+            }
+
+            const size_t numPages = misses[runEnd - 1].first - firstPage + 1;
+            const bool checked =
+                ProcessInfo::pagesInMemory(reinterpret_cast<const void*>(firstPage * pageSize),
+                                           numPages, &resident);
+            for (size_t i = runStart; i < runEnd; i++) {
+                const size_t index = misses[i].second;
+                (*inMemory)[index] = checked
+                    ? resident[misses[i].first - firstPage]
+                    : ProcessInfo::blockInMemory(records[index]);
+            }
+
+            runStart = runEnd;
+        }
+    }
+
     void RecordAccessTracker::disableSystemBlockInMemCheck() {
         _blockSupported = false;
     }
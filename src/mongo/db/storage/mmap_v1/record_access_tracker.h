@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/scoped_array.hpp>
+#include <vector>
 
 #include "mongo/util/concurrency/mutex.h"
 
@@ -53,7 +54,8 @@ namespace mongo {
             MaxChain = 20, // intentionally very low
             NumSlices = 10,
             RotateTimeSecs = 90,
-            BigHashSize = 128
+            BigHashSize = 128,
+            MaxPagesPerBlockCheck = 64
         };
 
         /**
@@ -69,6 +71,16 @@ namespace mongo {
          */
         bool checkAccessedAndMark(const void* record);
 
+        /**
+         * Batch version of checkAccessedAndMark(). Sets the i-th element of 'inMemory' to whether
+         * 'records[i]' is likely in physical memory, marking each record as accessed.
+         *
+         * Records which have not been accessed recently are grouped into runs of nearby pages,
+         * and each run costs a single system call rather than one per record.
+         */
+        void checkAccessedAndMarkMany(const std::vector<const void*>& records,
+                                      std::vector<bool>* inMemory);
+
         /**
          * Clears out any history of record accesses.
          */
@@ -86,6 +98,11 @@ namespace mongo {
         void disableSystemBlockInMemCheck();
 
     private:
+        /**
+         * checkAccessedAndMark() without the system call fallback.
+         */
+        bool _accessedRecentlyAndMark(const void* record);
+
         enum State {
             In, Out, Unk
         };
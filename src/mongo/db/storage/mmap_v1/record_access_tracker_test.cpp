@@ -139,4 +139,30 @@ namespace {
         }
     }
 
+    // Tests RecordAccessTracker::checkAccessedAndMarkMany().
+    TEST(RecordAccessTrackerTest, CheckMany) {
+        RecordAccessTracker tracker;
+        tracker.disableSystemBlockInMemCheck();
+
+        tracker.markAccessed(pointerOf(0x41000));
+
+        std::vector<const void*> records;
+        records.push_back(pointerOf(0x41100)); // on a page which was accessed
+        records.push_back(pointerOf(0x43000)); // on a page which was not
+        records.push_back(pointerOf(0x43100)); // on the page of the previous record
+
+        std::vector<bool> inMemory;
+        tracker.checkAccessedAndMarkMany(records, &inMemory);
+        ASSERT_EQUALS(3U, inMemory.size());
+        ASSERT_TRUE(inMemory[0]);
+        ASSERT_FALSE(inMemory[1]);
+        ASSERT_TRUE(inMemory[2]);
+
+        // All of the records have now been marked as accessed.
+        tracker.checkAccessedAndMarkMany(records, &inMemory);
+        ASSERT_TRUE(inMemory[0]);
+        ASSERT_TRUE(inMemory[1]);
+        ASSERT_TRUE(inMemory[2]);
+    }
+
 }  // namespace
@@ -40,6 +40,7 @@
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
 #include "mongo/db/storage/mmap_v1/record.h"
 #include "mongo/db/storage/mmap_v1/record_store_v1_repair_iterator.h"
+#include "mongo/platform/bits.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/timer.h"
@@ -287,6 +288,24 @@ namespace mongo {
         return _extentManager->recordNeedsFetch( DiskLoc::fromRecordId(loc) );
     }
 
+    void RecordStoreV1Base::recordsNeedFetch( OperationContext* txn,
+                                              const std::vector<RecordId>& locs,
+                                              OwnedPointerVector<RecordFetcher>* fetchers ) const {
+        std::vector<DiskLoc> diskLocs;
+        diskLocs.reserve( locs.size() );
+        for ( size_t i = 0; i < locs.size(); i++ ) {
+            diskLocs.push_back( DiskLoc::fromRecordId( locs[i] ) );
+        }
+        _extentManager->recordsNeedFetch( diskLocs, fetchers );
+    }
+
+    void RecordStoreV1Base::prefetchRecords( OperationContext* txn,
+                                             const std::vector<RecordId>& locs ) const {
+        for ( size_t i = 0; i < locs.size(); i++ ) {
+            _extentManager->prefetchRecord( DiskLoc::fromRecordId( locs[i] ) );
+        }
+    }
+
 
     StatusWith<RecordId> RecordStoreV1Base::insertRecord( OperationContext* txn,
                                                           const DocWriter* doc,
@@ -719,6 +738,7 @@ namespace mongo {
                 long long bsonLen = 0;
                 int outOfOrder = 0;
                 DiskLoc cl_last;
+                std::map<DiskLoc, long long> extentBytesUsed;
 
                 scoped_ptr<RecordIterator> iterator( getIterator(txn) );
                 DiskLoc cl;
@@ -736,6 +756,7 @@ namespace mongo {
                     Record *r = recordFor(cl);
                     len += r->lengthWithHeaders();
                     nlen += r->netLength();
+                    extentBytesUsed[DiskLoc(cl.a(), r->extentOfs())] += r->lengthWithHeaders();
 
                     if ( isQuantized( r->lengthWithHeaders() ) ) {
                         // Count the number of records having a size consistent with
@@ -781,6 +802,10 @@ namespace mongo {
                 if (full) {
                     output->appendNumber("bytesBson", bsonLen);
                 }
+
+                if ( !isCapped() ) {
+                    _appendExtentOccupancy(txn, extentBytesUsed, full, output);
+                }
             } // end scanData
 
             // 55555555555555555555555555
@@ -854,6 +879,48 @@ namespace mongo {
         return Status::OK();
     }
 
+    void RecordStoreV1Base::_appendExtentOccupancy(
+                                OperationContext* txn,
+                                const std::map<DiskLoc, long long>& extentBytesUsed,
+                                bool full,
+                                BSONObjBuilder* output ) const {
+        // An extent is sparse when fewer than half of its bytes hold records. The free space of
+        // sparse extents is what an extent-at-a-time compact would give back.
+        int sparseExtents = 0;
+        long long reclaimableBytes = 0;
+        BSONArrayBuilder extents;
+        for (DiskLoc extLoc = _details->firstExtent(txn);
+             !extLoc.isNull();
+             extLoc = _getExtent(txn, extLoc)->xnext) {
+            const Extent* ext = _getExtent(txn, extLoc);
+            const long long capacity = ext->length - Extent::HeaderSize();
+            std::map<DiskLoc, long long>::const_iterator it = extentBytesUsed.find(extLoc);
+            const long long used = (it == extentBytesUsed.end()) ? 0 : it->second;
+            const double occupancy = capacity > 0 ? double(used) / capacity : 1.0;
+
+            // The last extent is where new records go, so it is not expected to be full yet.
+            if (occupancy < 0.5 && extLoc != _details->lastExtent(txn)) {
+                sparseExtents++;
+                reclaimableBytes += capacity - used;
+            }
+
+            if (full) {
+                extents << BSON("loc" << extLoc.toString()
+                                << "length" << ext->length
+                                << "bytesUsed" << used
+                                << "occupancy" << occupancy);
+            }
+        }
+
+        BSONObjBuilder b(output->subobjStart("extentOccupancy"));
+        b.append("sparseExtents", sparseExtents);
+        b.appendNumber("reclaimableBytes", reclaimableBytes);
+        if (full) {
+            b.append("extents", extents.arr());
+        }
+        b.done();
+    }
+
     void RecordStoreV1Base::appendCustomStats( OperationContext* txn,
                                                BSONObjBuilder* result,
                                                double scale ) const {
@@ -938,7 +1005,14 @@ namespace mongo {
 
     int RecordStoreV1Base::quantizeAllocationSpace(int allocSize) {
         invariant(allocSize <= MaxAllowedAllocation);
-        for ( int i = 0; i < Buckets - 2; i++ ) { // last two bucketSizes are invalid
+        if (allocSize <= bucketSizes[0]) {
+            return bucketSizes[0];
+        }
+        if (allocSize <= bucketSizes[LastPowerOfTwoBucket]) {
+            // The smallest power of two >= allocSize
+            return 1 << (64 - countLeadingZeros64(allocSize - 1));
+        }
+        for ( int i = LastPowerOfTwoBucket + 1; i < Buckets - 2; i++ ) { // last two bucketSizes are invalid
             if ( bucketSizes[i] >= allocSize ) {
                 // Return the size of the first bucket sized >= the requested size.
                 return bucketSizes[i];
@@ -955,7 +1029,16 @@ namespace mongo {
     }
 
     int RecordStoreV1Base::bucket(int size) {
-        for ( int i = 0; i < Buckets; i++ ) {
+        if (size < bucketSizes[0]) {
+            return 0;
+        }
+        if (size < bucketSizes[LastPowerOfTwoBucket]) {
+            // Bucket n holds sizes in [32 << (n - 1), 32 << n), so the highest set bit of the size
+            // picks the bucket without scanning.
+            const int highestBit = 63 - countLeadingZeros64(size);
+            return highestBit - 4;
+        }
+        for ( int i = LastPowerOfTwoBucket + 1; i < Buckets; i++ ) {
             if ( bucketSizes[i] > size ) {
                 // Return the first bucket sized _larger_ than the requested size. This is important
                 // since we want all records in a bucket to be >= the quantized size, therefore the
@@ -31,6 +31,8 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <map>
+
 #include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/platform/unordered_set.h"
 
@@ -160,6 +162,9 @@ namespace mongo {
 
         static const int bucketSizes[];
 
+        // bucketSizes[i] == 32 << i for every bucket up to and including this one (4MB)
+        static const int LastPowerOfTwoBucket = 17;
+
         enum UserFlags {
             Flag_UsePowerOf2Sizes = 1 << 0,
             Flag_NoPadding = 1 << 1,
@@ -197,6 +202,15 @@ namespace mongo {
         virtual RecordFetcher* recordNeedsFetch( OperationContext* txn,
                                                  const RecordId& loc ) const;
 
+        virtual void recordsNeedFetch( OperationContext* txn,
+                                       const std::vector<RecordId>& locs,
+                                       OwnedPointerVector<RecordFetcher>* fetchers ) const;
+
+        virtual bool supportsPrefetch() const { return true; }
+
+        virtual void prefetchRecords( OperationContext* txn,
+                                      const std::vector<RecordId>& locs ) const;
+
         StatusWith<RecordId> insertRecord( OperationContext* txn,
                                            const char* data,
                                            int len,
@@ -310,6 +324,15 @@ namespace mongo {
         */
         void _addRecordToRecListInExtent(OperationContext* txn, Record* r, DiskLoc loc);
 
+        /**
+         * Appends how full each extent is, given the bytes validate() found in each of them, along
+         * with how many extents are sparse enough to be worth compacting.
+         */
+        void _appendExtentOccupancy( OperationContext* txn,
+                                     const std::map<DiskLoc, long long>& extentBytesUsed,
+                                     bool full,
+                                     BSONObjBuilder* output ) const;
+
         /**
          * internal
          * doesn't check inputs or change padding
@@ -37,6 +37,7 @@
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
 #include "mongo/db/storage/mmap_v1/record.h"
 #include "mongo/db/storage/mmap_v1/record_store_v1_capped_iterator.h"
+#include "mongo/db/storage/oplog_hack.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mmap.h"
 #include "mongo/util/mongoutils/str.h"
@@ -609,6 +610,19 @@ namespace mongo {
     vector<RecordIterator*> CappedRecordStoreV1::getManyIterators( OperationContext* txn ) const {
         OwnedPointerVector<RecordIterator> iterators;
 
+        vector<DiskLoc> runStarts;
+        _getRunStarts(txn, &runStarts);
+        for (size_t i = 0; i < runStarts.size(); i++) {
+            iterators.push_back(new RecordStoreV1Base::IntraExtentIterator(txn,
+                                                                           runStarts[i],
+                                                                           this));
+        }
+
+        return iterators.release();
+    }
+
+    void CappedRecordStoreV1::_getRunStarts( OperationContext* txn,
+                                             vector<DiskLoc>* out ) const {
         if (!_details->capLooped()) {
             // if we haven't looped yet, just spit out all extents (same as non-capped impl)
             const Extent* ext;
@@ -617,50 +631,74 @@ namespace mongo {
                 if (ext->firstRecord.isNull())
                     continue;
 
-                iterators.push_back(new RecordStoreV1Base::IntraExtentIterator(txn,
-                                                                               ext->firstRecord,
-                                                                               this));
+                out->push_back(ext->firstRecord);
             }
+            return;
         }
-        else {
-            // if we've looped we need to iterate the extents, starting and ending with the
-            // capExtent
-            const DiskLoc capExtent = details()->capExtent();
-            invariant(!capExtent.isNull());
-            invariant(capExtent.isValid());
-
-            // First do the "old" portion of capExtent if there is any
-            DiskLoc extLoc = capExtent;
-            {
-                const Extent* ext = _getExtent(txn, extLoc);
-                if (ext->firstRecord != details()->capFirstNewRecord()) {
-                    // this means there is old data in capExtent
-                    iterators.push_back(new RecordStoreV1Base::IntraExtentIterator(txn,
-                                                                                   ext->firstRecord,
-                                                                                   this));
-                }
 
-                extLoc = ext->xnext.isNull() ? details()->firstExtent(txn) : ext->xnext;
+        // if we've looped we need to iterate the extents, starting and ending with the
+        // capExtent
+        const DiskLoc capExtent = details()->capExtent();
+        invariant(!capExtent.isNull());
+        invariant(capExtent.isValid());
+
+        // First do the "old" portion of capExtent if there is any
+        DiskLoc extLoc = capExtent;
+        {
+            const Extent* ext = _getExtent(txn, extLoc);
+            if (ext->firstRecord != details()->capFirstNewRecord()) {
+                // this means there is old data in capExtent
+                out->push_back(ext->firstRecord);
             }
 
-            // Next handle all the other extents
-            while (extLoc != capExtent) {
-                const Extent* ext = _getExtent(txn, extLoc);
-                iterators.push_back(new RecordStoreV1Base::IntraExtentIterator(txn,
-                                                                               ext->firstRecord,
-                                                                               this));
+            extLoc = ext->xnext.isNull() ? details()->firstExtent(txn) : ext->xnext;
+        }
+
+        // Next handle all the other extents
+        while (extLoc != capExtent) {
+            const Extent* ext = _getExtent(txn, extLoc);
+            if (!ext->firstRecord.isNull())
+                out->push_back(ext->firstRecord);
+
+            extLoc = ext->xnext.isNull() ? details()->firstExtent(txn) : ext->xnext;
+        }
+
+        // Finally handle the "new" data in the capExtent
+        out->push_back(details()->capFirstNewRecord());
+    }
 
-                extLoc = ext->xnext.isNull() ? details()->firstExtent(txn) : ext->xnext;
+    boost::optional<RecordId> CappedRecordStoreV1::oplogStartHack(
+            OperationContext* txn,
+            const RecordId& startingPosition) const {
+
+        // Each run of records is in insertion order, so the 'ts' of its first record is a sparse
+        // index over the whole collection and only O(log(runs)) records need to be read.
+        vector<DiskLoc> runStarts;
+        _getRunStarts(txn, &runStarts);
+
+        size_t lo = 0;
+        size_t hi = runStarts.size();
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            const RecordData data = dataFor(txn, runStarts[mid].toRecordId());
+            const StatusWith<RecordId> key = oploghack::extractKey(data.data(), data.size());
+            if (!key.isOK()) {
+                // Not an oplog, let the caller fall back to scanning.
+                return boost::none;
             }
 
-            // Finally handle the "new" data in the capExtent
-            iterators.push_back(
-                new RecordStoreV1Base::IntraExtentIterator(txn,
-                                                           details()->capFirstNewRecord(),
-                                                           this));
+            if (key.getValue() <= startingPosition) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
         }
 
-        return iterators.release();
+        if (lo == 0)
+            return RecordId(); // nothing <= startingPosition
+
+        return runStarts[lo - 1].toRecordId();
     }
 
     void CappedRecordStoreV1::_maybeComplain( OperationContext* txn, int len ) const {
@@ -68,6 +68,15 @@ namespace mongo {
 
         virtual std::vector<RecordIterator*> getManyIterators( OperationContext* txn ) const;
 
+        /**
+         * Binary searches the extents, in insertion order, on the 'ts' of their first record.
+         * Returns the first record of the last extent that starts at or before
+         * 'startingPosition', RecordId() if none does, or boost::none if the collection does
+         * not hold oplog entries.
+         */
+        virtual boost::optional<RecordId> oplogStartHack(OperationContext* txn,
+                                                         const RecordId& startingPosition) const;
+
         // Start from firstExtent by default.
         DiskLoc firstRecord( OperationContext* txn,
                              const DiskLoc &startExtent = DiskLoc() ) const;
@@ -120,6 +129,12 @@ namespace mongo {
 
         void _maybeComplain( OperationContext* txn, int len ) const;
 
+        /**
+         * Fills 'out' with the first record of each run of records in insertion order: one per
+         * non-empty extent, with the capExtent split in two once the collection has looped.
+         */
+        void _getRunStarts( OperationContext* txn, std::vector<DiskLoc>* out ) const;
+
         // -- end copy from cap.cpp --
 
         CappedDocumentDeleteCallback* _deleteCallback;
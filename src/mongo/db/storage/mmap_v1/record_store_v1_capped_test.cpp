@@ -645,10 +645,11 @@ namespace {
         // Insert bypasses standard alloc/insert routines to use the extent we want.
         // TODO: Directly declare resulting record store state instead of procedurally creating it
         DiskLoc insert( const DiskLoc& ext, int i ) {
+            return insert( ext, BSON( "a" << i ) );
+        }
+
+        DiskLoc insert( const DiskLoc& ext, const BSONObj& o ) {
             // Copied verbatim.
-            BSONObjBuilder b;
-            b.append( "a", i );
-            BSONObj o = b.done();
             int len = o.objsize();
             Extent *e = em.getExtent(ext);
             e = txn.recoveryUnit()->writing(e);
@@ -709,6 +710,10 @@ namespace {
 
         static const char *ns() { return "unittests.QueryStageCollectionScanCapped"; }
 
+        boost::optional<RecordId> oplogStartHack(unsigned secs) {
+            return rs.oplogStartHack(&txn, RecordId(secs, 0));
+        }
+
         OperationContextNoop txn;
         DummyRecordStoreV1MetaData* md;
         DummyExtentManager em;
@@ -817,4 +822,45 @@ namespace {
         h.md->setCapFirstNewRecord( &h.txn, h.insert( h.md->capExtent(), 3 ) );
         h.walkAndCount(4);
     }
+
+    BSONObj oplogEntry(unsigned secs) {
+        return BSON( "ts" << OpTime(secs, 0) );
+    }
+
+    TEST(CappedRecordStoreV1QueryStage, OplogStartHackUnlooped) {
+        CollscanHelper h(3);
+        const DiskLoc first = h.insert( h.md->firstExtent(&h.txn), oplogEntry(10) );
+        h.insert( h.md->firstExtent(&h.txn), oplogEntry(11) );
+        const DiskLoc second = h.insert( h.em.getExtent(h.md->firstExtent(&h.txn))->xnext,
+                                         oplogEntry(20) );
+
+        ASSERT_EQUALS( RecordId(), h.oplogStartHack(5).get() );
+        ASSERT_EQUALS( first.toRecordId(), h.oplogStartHack(10).get() );
+        ASSERT_EQUALS( first.toRecordId(), h.oplogStartHack(19).get() );
+        ASSERT_EQUALS( second.toRecordId(), h.oplogStartHack(20).get() );
+        ASSERT_EQUALS( second.toRecordId(), h.oplogStartHack(99).get() );
+    }
+
+    TEST(CappedRecordStoreV1QueryStage, OplogStartHackLooped) {
+        CollscanHelper h(3);
+        h.md->setCapExtent( &h.txn, h.em.getExtent(h.md->firstExtent(&h.txn))->xnext );
+        const DiskLoc oldCap = h.insert( h.md->capExtent(), oplogEntry(10) );
+        const DiskLoc last = h.insert( h.md->lastExtent(&h.txn), oplogEntry(20) );
+        const DiskLoc first = h.insert( h.md->firstExtent(&h.txn), oplogEntry(30) );
+        const DiskLoc newCap = h.insert( h.md->capExtent(), oplogEntry(40) );
+        h.md->setCapFirstNewRecord( &h.txn, newCap );
+        h.insert( h.md->capExtent(), oplogEntry(41) );
+
+        ASSERT_EQUALS( RecordId(), h.oplogStartHack(9).get() );
+        ASSERT_EQUALS( oldCap.toRecordId(), h.oplogStartHack(15).get() );
+        ASSERT_EQUALS( last.toRecordId(), h.oplogStartHack(20).get() );
+        ASSERT_EQUALS( first.toRecordId(), h.oplogStartHack(39).get() );
+        ASSERT_EQUALS( newCap.toRecordId(), h.oplogStartHack(41).get() );
+    }
+
+    TEST(CappedRecordStoreV1QueryStage, OplogStartHackNotOplog) {
+        CollscanHelper h(2);
+        h.insert( h.md->firstExtent(&h.txn), 0 );
+        ASSERT( !h.oplogStartHack(10) );
+    }
 }
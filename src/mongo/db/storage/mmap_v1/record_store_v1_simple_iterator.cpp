@@ -85,6 +85,29 @@ namespace mongo {
                 _curr = e->lastRecord;
             }
         }
+
+        _updateCacheHints();
+    }
+
+    void SimpleRecordStoreV1Iterator::_updateCacheHints() {
+        if (CollectionScanParams::FORWARD != _direction || _curr.isNull()) {
+            return;
+        }
+
+        ExtentManager* em = _recordStore->_extentManager;
+        const DiskLoc extentLoc = em->extentLocForV1(_curr);
+        if (extentLoc == _hintedExtent) {
+            return;
+        }
+
+        _hintedExtent = extentLoc;
+        _scanHint.reset(em->cacheHint(extentLoc, ExtentManager::Sequential));
+
+        const DiskLoc nextExtent = em->getExtent(extentLoc)->xnext;
+        if (!nextExtent.isNull() && nextExtent != _prefetchedExtent) {
+            _prefetchedExtent = nextExtent;
+            _prefetchHint.reset(em->cacheHint(nextExtent, ExtentManager::WillNeed));
+        }
     }
 
     bool SimpleRecordStoreV1Iterator::isEOF() {
@@ -100,6 +123,7 @@ namespace mongo {
         if (!isEOF()) {
             if (CollectionScanParams::FORWARD == _direction) {
                 _curr = _recordStore->getNextRecord( _txn, _curr );
+                _updateCacheHints();
             }
             else {
                 _curr = _recordStore->getPrevRecord( _txn, _curr );
@@ -119,6 +143,10 @@ namespace mongo {
     }
 
     void SimpleRecordStoreV1Iterator::saveState() {
+        // The extents may go away while we are yielded, so do not keep advice on them
+        _scanHint.reset();
+        _prefetchHint.reset();
+        _hintedExtent = DiskLoc();
     }
 
     bool SimpleRecordStoreV1Iterator::restoreState(OperationContext* txn) {
@@ -28,7 +28,10 @@
 
 #pragma once
 
+#include <boost/scoped_ptr.hpp>
+
 #include "mongo/db/storage/mmap_v1/diskloc.h"
+#include "mongo/db/storage/mmap_v1/extent_manager.h"
 #include "mongo/db/storage/record_store.h"
 
 namespace mongo {
@@ -60,6 +63,13 @@ namespace mongo {
         virtual RecordData dataFor( const RecordId& loc ) const;
 
     private:
+        /**
+         * Forward scans advise sequential access on the extent they are in and read ahead the
+         * start of the next one, so the scan neither faults page by page at extent boundaries
+         * nor leaves its pages competing with hot point-read data.
+         */
+        void _updateCacheHints();
+
          // for getNext, not owned
         OperationContext* _txn;
 
@@ -69,6 +79,13 @@ namespace mongo {
         const SimpleRecordStoreV1* _recordStore;
 
         CollectionScanParams::Direction _direction;
+
+        // Extent the scan hints are for and the extent last read ahead. The hints are dropped
+        // on saveState, so they never outlive a yield.
+        DiskLoc _hintedExtent;
+        DiskLoc _prefetchedExtent;
+        boost::scoped_ptr<ExtentManager::CacheHint> _scanHint;
+        boost::scoped_ptr<ExtentManager::CacheHint> _prefetchHint;
     };
 
 }  // namespace mongo
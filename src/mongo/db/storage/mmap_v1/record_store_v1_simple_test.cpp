@@ -114,6 +114,23 @@ namespace {
         }
     }
 
+    TEST( SimpleRecordStoreV1, bucketAroundBucketSizes ) {
+        for (int i = 0; i <= RecordStoreV1Base::LastPowerOfTwoBucket; i++) {
+            ASSERT_EQUALS( 32 << i, RecordStoreV1Base::bucketSizes[i] );
+        }
+
+        // A record exactly the size of a bucket goes in the next one up.
+        ASSERT_EQUALS( 0, RecordStoreV1Base::bucket( 1 ) );
+        for (int bucket = 0; bucket < RecordStoreV1Base::Buckets - 1; bucket++) {
+            const int size = RecordStoreV1Base::bucketSizes[bucket];
+            ASSERT_EQUALS( bucket, RecordStoreV1Base::bucket( size - 1 ) );
+            ASSERT_EQUALS( bucket + 1, RecordStoreV1Base::bucket( size ) );
+            if (size + 1 < RecordStoreV1Base::bucketSizes[bucket + 1]) {
+                ASSERT_EQUALS( bucket + 1, RecordStoreV1Base::bucket( size + 1 ) );
+            }
+        }
+    }
+
     BSONObj docForRecordSize( int size ) {
         BSONObjBuilder b;
         b.append( "_id", 5 );
@@ -564,4 +581,38 @@ namespace {
             assertStateV1RS(&txn, recs, drecs, NULL, &em, md);
         }
     }
+
+    // -----------------
+
+    TEST( SimpleRecordStoreV1, ValidateReportsSparseExtents ) {
+        OperationContextNoop txn;
+        DummyExtentManager em;
+        DummyRecordStoreV1MetaData* md = new DummyRecordStoreV1MetaData( false, 0 );
+        SimpleRecordStoreV1 rs( &txn, "test.foo", md, &em, false );
+
+        {
+            LocAndSize recs[] = {
+                {DiskLoc(0, 1000), 100},
+                {DiskLoc(1, 1000), 20000},
+                {DiskLoc(2, 1000), 100},
+                {}
+            };
+            LocAndSize drecs[] = {
+                {DiskLoc(0, 1100), 20000},
+                {}
+            };
+            initializeV1RS(&txn, recs, drecs, NULL, &em, md);
+        }
+
+        ValidateResults results;
+        BSONObjBuilder output;
+        ASSERT_OK( rs.validate( &txn, false, true, NULL, &results, &output ) );
+        BSONObj occupancy = output.obj()["extentOccupancy"].Obj();
+
+        // Extent 1 is mostly full and extent 2 is the last extent, so only extent 0 counts.
+        const Extent* sparse = em.getExtent( DiskLoc(0, 0) );
+        ASSERT_EQUALS( 1, occupancy["sparseExtents"].numberInt() );
+        ASSERT_EQUALS( sparse->length - Extent::HeaderSize() - 100,
+                       occupancy["reclaimableBytes"].numberLong() );
+    }
 }
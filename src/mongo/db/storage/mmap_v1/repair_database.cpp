@@ -43,6 +43,7 @@
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/client.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_database_catalog_entry.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
@@ -51,6 +52,7 @@
 #include "mongo/util/file_allocator.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mmap.h"
+#include "mongo/util/progress_meter.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -402,6 +404,10 @@ namespace mongo {
                         return status;
                 }
 
+                const string curopMessage = "repairDatabase: copying " + ns;
+                ProgressMeterHolder progress(*txn->setMessage(curopMessage.c_str(),
+                                                              "Repair Progress",
+                                                              originalCollection->numRecords(txn)));
                 scoped_ptr<RecordIterator> iterator(originalCollection->getIterator(txn));
                 while ( !iterator->isEOF() ) {
                     RecordId loc = iterator->getNext();
@@ -418,9 +424,11 @@ namespace mongo {
                         return result.getStatus();
 
                     wunit.commit();
+                    progress.hit();
                     txn->checkForInterrupt();
                 }
-                
+                progress.finished();
+
                 Status status = indexer.doneInserting();
                 if (!status.isOK())
                     return status;
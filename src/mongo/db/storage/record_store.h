@@ -220,6 +220,35 @@ namespace mongo {
         virtual RecordFetcher* recordNeedsFetch( OperationContext* txn,
                                                  const RecordId& loc ) const { return NULL; }
 
+        /**
+         * Appends to 'fetchers' what recordNeedsFetch() returns for each of 'locs', in order.
+         * Storage engines may override this to find out whether many records are in memory at
+         * once rather than asking about them one at a time.
+         */
+        virtual void recordsNeedFetch( OperationContext* txn,
+                                       const std::vector<RecordId>& locs,
+                                       OwnedPointerVector<RecordFetcher>* fetchers ) const {
+            for ( size_t i = 0; i < locs.size(); i++ ) {
+                fetchers->push_back( recordNeedsFetch( txn, locs[i] ) );
+            }
+        }
+
+        /**
+         * @return Returns 'true' if this record store can start reading records in the background
+         * through 'prefetchRecords'. Callers may then hold on to RecordIds across yields in order
+         * to read ahead, so this must only return true for storage engines which invalidate
+         * RecordIds, i.e. those without document-level locking.
+         */
+        virtual bool supportsPrefetch() const { return false; }
+
+        /**
+         * Hints that the records at 'locs' are about to be read, so that the storage engine can
+         * start bringing them into memory without blocking the caller. Only called if
+         * 'supportsPrefetch' returns true.
+         */
+        virtual void prefetchRecords( OperationContext* txn,
+                                      const std::vector<RecordId>& locs ) const { }
+
         /**
          * returned iterator owned by caller
          * Default arguments return all items in record store.
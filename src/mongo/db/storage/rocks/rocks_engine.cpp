@@ -33,14 +33,20 @@
 
 #include "mongo/db/storage/rocks/rocks_engine.h"
 
+#include <cstring>
+
 #include <boost/filesystem/operations.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <rocksdb/cache.h>
 #include <rocksdb/comparator.h>
 #include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/merge_operator.h>
 #include <rocksdb/slice.h>
 #include <rocksdb/options.h>
+#include <rocksdb/table.h>
 #include <rocksdb/utilities/write_batch_with_index.h>
 
 #include "mongo/db/catalog/collection_options.h"
@@ -60,12 +66,48 @@ namespace mongo {
 
     using boost::shared_ptr;
 
+    namespace {
+        const size_t kBlockCacheSizeBytes = 256 * 1024 * 1024;
+        const int kBloomFilterBitsPerKey = 10;
+
+        /**
+         * Adds up the native long long deltas of the size and count counters, so that a commit
+         * only has to Merge its own delta instead of Put-ing a total that can race with other
+         * commits.
+         */
+        class CounterMergeOperator : public rocksdb::AssociativeMergeOperator {
+        public:
+            virtual bool Merge(const rocksdb::Slice& key, const rocksdb::Slice* existingValue,
+                               const rocksdb::Slice& value, std::string* newValue,
+                               rocksdb::Logger* logger) const override {
+                if (value.size() != sizeof(long long)) {
+                    return false;
+                }
+                long long total = 0;
+                if (existingValue) {
+                    if (existingValue->size() != sizeof(long long)) {
+                        return false;
+                    }
+                    memcpy(&total, existingValue->data(), sizeof(long long));
+                }
+                long long delta;
+                memcpy(&delta, value.data(), sizeof(long long));
+                total += delta;
+                newValue->assign(reinterpret_cast<const char*>(&total), sizeof(long long));
+                return true;
+            }
+
+            virtual const char* Name() const override { return "mongo.CounterMergeOperator"; }
+        };
+    }  // namespace
+
     const std::string RocksEngine::kOrderingPrefix("indexordering-");
     const std::string RocksEngine::kCollectionPrefix("collection-");
 
     RocksEngine::RocksEngine(const std::string& path, bool durable)
         : _path(path),
-          _durable(durable) {
+          _durable(durable),
+          _blockCache(rocksdb::NewLRUCache(kBlockCacheSizeBytes)) {
 
         auto columnFamilyNames = _loadColumnFamilies();       // vector of column family names
         std::unordered_map<std::string, Ordering> orderings;  // column family name -> Ordering
@@ -314,17 +356,28 @@ namespace mongo {
 
     rocksdb::ColumnFamilyOptions RocksEngine::_defaultCFOptions() {
         rocksdb::ColumnFamilyOptions options;
-        // TODO pass or set appropriate options for default CF.
+        // the default column family holds the metadata and the size and count counters, which
+        // RocksRecoveryUnit updates with Merge
+        options.merge_operator.reset(new CounterMergeOperator());
         return options;
     }
 
     rocksdb::ColumnFamilyOptions RocksEngine::_collectionOptions() const {
-        rocksdb::ColumnFamilyOptions options;
-        return options;
+        return _tableOptions();
     }
 
     rocksdb::ColumnFamilyOptions RocksEngine::_indexOptions(const Ordering& order) const {
-        return rocksdb::ColumnFamilyOptions();
+        return _tableOptions();
+    }
+
+    rocksdb::ColumnFamilyOptions RocksEngine::_tableOptions() const {
+        rocksdb::BlockBasedTableOptions tableOptions;
+        tableOptions.block_cache = _blockCache;
+        tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(kBloomFilterBitsPerKey));
+
+        rocksdb::ColumnFamilyOptions options;
+        options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(tableOptions));
+        return options;
     }
 
     Status toMongoStatus( rocksdb::Status s ) {
@@ -48,6 +48,7 @@
 #include "mongo/util/string_map.h"
 
 namespace rocksdb {
+    class Cache;
     class ColumnFamilyHandle;
     struct ColumnFamilyDescriptor;
     struct ColumnFamilyOptions;
@@ -139,6 +140,9 @@ namespace mongo {
 
         rocksdb::ColumnFamilyOptions _collectionOptions() const;
         rocksdb::ColumnFamilyOptions _indexOptions(const Ordering& order) const;
+        // Options shared by the collection and index column families: the engine's block cache
+        // and a bloom filter over whole keys, which lets point lookups skip SST files
+        rocksdb::ColumnFamilyOptions _tableOptions() const;
 
         rocksdb::Options _dbOptions() const;
 
@@ -149,6 +153,10 @@ namespace mongo {
 
         const bool _durable;
 
+        // One block cache for all column families, so that the memory budget doesn't grow with
+        // the number of collections and indexes
+        std::shared_ptr<rocksdb::Cache> _blockCache;
+
         // Default column family is owned by the rocksdb::DB instance.
         rocksdb::ColumnFamilyHandle* _defaultHandle;
 
@@ -128,11 +128,12 @@ namespace mongo {
         for (auto pair : _deltaCounters) {
             auto& counter = pair.second;
             counter._value->fetch_add(counter._delta, std::memory_order::memory_order_relaxed);
-            long long newValue = counter._value->load(std::memory_order::memory_order_relaxed);
 
+            // Only the delta is written; the default column family's merge operator adds it to
+            // the stored total, so concurrent commits can't overwrite each other's counts.
             // TODO: make the encoding platform indepdent.
-            const char* nr_ptr = reinterpret_cast<char*>(&newValue);
-            writeBatch()->Put(pair.first, rocksdb::Slice(nr_ptr, sizeof(long long)));
+            const char* nr_ptr = reinterpret_cast<const char*>(&counter._delta);
+            writeBatch()->Merge(pair.first, rocksdb::Slice(nr_ptr, sizeof(long long)));
         }
 
         if (_writeBatch->GetWriteBatch()->Count() != 0) {
@@ -41,6 +41,7 @@
 
 #include <rocksdb/db.h>
 #include <rocksdb/iterator.h>
+#include <rocksdb/write_batch.h>
 #include <rocksdb/utilities/write_batch_with_index.h>
 
 #include "mongo/bson/bsonobjbuilder.h"
@@ -329,31 +330,85 @@ namespace mongo {
             RecordId _savePositionLoc;
         };
 
-        class RocksBulkSortedBuilderImpl : public SortedDataBuilderInterface {
-        public:
-            RocksBulkSortedBuilderImpl(RocksSortedDataImpl* index, OperationContext* txn,
-                                       bool dupsAllowed)
-                : _index(index), _txn(txn), _dupsAllowed(dupsAllowed) {
-                invariant(index->isEmpty(txn));
+    } // namespace
+
+    /**
+     * Builds a new, empty index from keys that arrive in sorted order. Since nothing else can see
+     * the index yet, keys are written straight to the column family in large write batches instead
+     * of piling the whole index up in the recovery unit's indexed write batch, and duplicates are
+     * found by comparing against the previous key rather than by looking each key up.
+     */
+    class RocksSortedDataImpl::BulkBuilder : public SortedDataBuilderInterface {
+    public:
+        BulkBuilder(RocksSortedDataImpl* index, OperationContext* txn, bool dupsAllowed)
+            : _index(index), _txn(txn), _dupsAllowed(dupsAllowed), _numKeys(0) {
+            invariant(index->isEmpty(txn));
+        }
+
+        Status addKey(const BSONObj& key, const RecordId& loc) {
+            if (key.objsize() >= kTempKeyMaxSize) {
+                string msg = mongoutils::str::stream()
+                             << "RocksSortedDataImpl::addKey: key too large to index, failing "
+                             << ' ' << key.objsize() << ' ' << key;
+                return Status(ErrorCodes::KeyTooLong, msg);
             }
 
-            Status addKey(const BSONObj& key, const RecordId& loc) {
-                // TODO maybe optimize based on a fact that index is empty?
-                return _index->insert(_txn, key, loc, _dupsAllowed);
+            if (!_dupsAllowed) {
+                KeyString keyWithoutLoc(key, _index->_order);
+                if (_numKeys > 0 && keyWithoutLoc == _previousKey) {
+                    return Status(ErrorCodes::DuplicateKey, dupKeyError(key));
+                }
+                _previousKey.resetToKey(key, _index->_order);
             }
 
-            void commit(bool mayInterrupt) {
-                WriteUnitOfWork uow(_txn);
-                uow.commit();
+            KeyString encodedKey(key, _index->_order, loc);
+            rocksdb::Slice value;
+            if (!encodedKey.getTypeBits().isAllZeros()) {
+                value = rocksdb::Slice(
+                    reinterpret_cast<const char*>(encodedKey.getTypeBits().getBuffer()),
+                    encodedKey.getTypeBits().getSize());
             }
+            _batch.Put(_index->_columnFamily.get(),
+                       rocksdb::Slice(encodedKey.getBuffer(), encodedKey.getSize()), value);
+            _numKeys++;
 
-        private:
-            RocksSortedDataImpl* _index;
-            OperationContext* _txn;
-            bool _dupsAllowed;
-        };
+            if (_batch.GetDataSize() >= kMaxBatchBytes) {
+                return _flush();
+            }
+            return Status::OK();
+        }
 
-    } // namespace
+        void commit(bool mayInterrupt) {
+            invariantOK(_flush());
+
+            WriteUnitOfWork uow(_txn);
+            auto ru = RocksRecoveryUnit::getRocksRecoveryUnit(_txn);
+            ru->incrementCounter(_index->_numEntriesKey, &_index->_numEntries, _numKeys);
+            uow.commit();
+        }
+
+    private:
+        static const size_t kMaxBatchBytes = 4 * 1024 * 1024;
+
+        Status _flush() {
+            if (_batch.Count() == 0) {
+                return Status::OK();
+            }
+            auto status = _index->_db->Write(rocksdb::WriteOptions(), &_batch);
+            _batch.Clear();
+            return toMongoStatus(status);
+        }
+
+        RocksSortedDataImpl* _index;
+        OperationContext* _txn;
+        const bool _dupsAllowed;
+
+        rocksdb::WriteBatch _batch;
+        long long _numKeys;
+
+        // The last key added without its RecordId, used to find duplicates in the sorted input
+        KeyString _previousKey;
+    };
 
     // RocksSortedDataImpl***********
 
@@ -380,7 +435,7 @@ namespace mongo {
 
     SortedDataBuilderInterface* RocksSortedDataImpl::getBulkBuilder(OperationContext* txn,
                                                                     bool dupsAllowed) {
-        return new RocksBulkSortedBuilderImpl(this, txn, dupsAllowed);
+        return new BulkBuilder(this, txn, dupsAllowed);
     }
 
     Status RocksSortedDataImpl::insert(OperationContext* txn,
@@ -98,6 +98,8 @@ namespace mongo {
         virtual long long getSpaceUsedBytes( OperationContext* txn ) const;
 
     private:
+        class BulkBuilder;
+
         std::string _getTransactionID(const KeyString& key) const;
 
         rocksdb::DB* _db; // not owned
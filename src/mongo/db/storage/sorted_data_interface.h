@@ -39,6 +39,7 @@ namespace mongo {
 
     class BSONObjBuilder;
     class BucketDeletionNotification;
+    class KeyString;
     class SortedDataBuilderInterface;
 
     /**
@@ -166,6 +167,18 @@ namespace mongo {
                           "this storage engine does not support touch");
         }
 
+        /**
+         * Attempt to reduce the storage space used by 'this' index, in place and without
+         * blocking reads or writes to it.
+         *
+         * If the underlying storage engine does not support the operation,
+         * returns ErrorCodes::CommandNotSupported
+         */
+        virtual Status compact(OperationContext* txn) {
+            return Status(ErrorCodes::CommandNotSupported,
+                          "this storage engine does not support compacting indexes");
+        }
+
         /**
          * Return the number of entries in 'this' index.
          *
@@ -294,6 +307,16 @@ namespace mongo {
              */
             virtual BSONObj getKey() const = 0;
 
+            /**
+             * If this index stores its keys as KeyStrings, return the encoded form of the key at
+             * the current position of 'this' cursor, without decoding it to BSON. The encoding
+             * may be followed by the RecordId. Returns NULL for indexes that do not store
+             * KeyStrings.
+             *
+             * The returned pointer is only valid until 'this' cursor is moved.
+             */
+            virtual const KeyString* getKeyString() const { return NULL; }
+
             /**
              * Return the RecordId associated with the current position of 'this' cursor.
              */
@@ -178,7 +178,8 @@ namespace mongo {
          * This only recovers the record data, not indexes or anything else.
          *
          * Generally, this method should not be called directly except by the repairDatabase()
-         * free function.
+         * free function, which calls it for several record stores at once from worker threads
+         * holding no locks.
          *
          * NOTE: MMAPv1 does not support this method and has its own repairDatabase() method.
          */
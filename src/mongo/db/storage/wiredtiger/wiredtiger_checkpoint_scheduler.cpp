@@ -0,0 +1,248 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    // Replaces WiredTiger's checkpoint timer with WiredTigerCheckpointScheduler.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerAdaptiveCheckpoints, bool, true);
+
+    // Checkpoint once this percentage of the cache is dirty. 0 disables the trigger.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCheckpointDirtyTriggerPercent, int, 5);
+
+    // Checkpoint once this much has been written to the journal since the last checkpoint.
+    // 0 disables the trigger.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCheckpointJournalTriggerMB, int, 1024);
+
+    // Write rate checkpoints are paced to, averaged from the start of one checkpoint to the
+    // start of the next. 0 is unlimited.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCheckpointIOBudgetMBPerSec, int, 0);
+
+namespace {
+
+    // How often the dirty cache size and journal size are checked.
+    const long long kPollMillis = 1000;
+
+    const unsigned long long kMB = 1024 * 1024;
+
+}  // namespace
+
+    // static
+    WiredTigerCheckpointPolicy::Trigger WiredTigerCheckpointPolicy::checkpointDue(
+            const Settings& settings,
+            unsigned long long dirtyBytes,
+            unsigned long long logBytesSinceCheckpoint,
+            long long millisSinceCheckpoint) {
+        if (settings.dirtyTriggerBytes && dirtyBytes >= settings.dirtyTriggerBytes) {
+            return kDirtyBytes;
+        }
+        if (settings.logTriggerBytes && logBytesSinceCheckpoint >= settings.logTriggerBytes) {
+            return kLogBytes;
+        }
+        if (settings.maxWaitMillis && millisSinceCheckpoint >= settings.maxWaitMillis) {
+            return kTimer;
+        }
+        return kNotDue;
+    }
+
+    // static
+    long long WiredTigerCheckpointPolicy::budgetDelayMillis(const Settings& settings,
+                                                            unsigned long long lastBytesWritten,
+                                                            long long millisSinceLastStart) {
+        if (!settings.ioBudgetBytesPerSec) {
+            return 0;
+        }
+        const long long budgetMillis =
+            static_cast<long long>(lastBytesWritten * 1000 / settings.ioBudgetBytesPerSec);
+        return budgetMillis > millisSinceLastStart ? budgetMillis - millisSinceLastStart : 0;
+    }
+
+    WiredTigerCheckpointScheduler::WiredTigerCheckpointScheduler(WT_CONNECTION* conn,
+                                                                 long long maxWaitSecs)
+        : _conn(conn),
+          _maxWaitMillis(maxWaitSecs * 1000),
+          _shutdown(false),
+          _checkpoints(0),
+          _byDirtyBytes(0),
+          _byLogBytes(0),
+          _byTimer(0),
+          _lastDurationMillis(0),
+          _totalDurationMillis(0),
+          _lastBytesWritten(0),
+          _totalBytesWritten(0),
+          _budgetStallMillis(0) { }
+
+    // static
+    bool WiredTigerCheckpointScheduler::isEnabled() {
+        return wiredTigerAdaptiveCheckpoints;
+    }
+
+    void WiredTigerCheckpointScheduler::shutdown() {
+        {
+            boost::lock_guard<boost::mutex> lk(_shutdownMutex);
+            _shutdown = true;
+        }
+        _shutdownCondition.notify_all();
+        wait();
+    }
+
+    bool WiredTigerCheckpointScheduler::_sleep(long long millis) {
+        boost::unique_lock<boost::mutex> lk(_shutdownMutex);
+        if (!_shutdown) {
+            _shutdownCondition.timed_wait(lk, boost::posix_time::milliseconds(millis));
+        }
+        return !_shutdown;
+    }
+
+    // static
+    unsigned long long WiredTigerCheckpointScheduler::_connectionStat(WT_SESSION* session,
+                                                                      int key) {
+        StatusWith<uint64_t> result =
+            WiredTigerUtil::getStatisticsValue(session, "statistics:", "statistics=(fast)", key);
+        return result.isOK() ? result.getValue() : 0;
+    }
+
+    WiredTigerCheckpointPolicy::Settings WiredTigerCheckpointScheduler::_currentSettings(
+            WT_SESSION* session) const {
+        WiredTigerCheckpointPolicy::Settings settings;
+        if (wiredTigerCheckpointDirtyTriggerPercent > 0) {
+            settings.dirtyTriggerBytes = _connectionStat(session, WT_STAT_CONN_CACHE_BYTES_MAX) *
+                wiredTigerCheckpointDirtyTriggerPercent / 100;
+        }
+        if (wiredTigerCheckpointJournalTriggerMB > 0) {
+            settings.logTriggerBytes = wiredTigerCheckpointJournalTriggerMB * kMB;
+        }
+        settings.maxWaitMillis = _maxWaitMillis;
+        if (wiredTigerCheckpointIOBudgetMBPerSec > 0) {
+            settings.ioBudgetBytesPerSec = wiredTigerCheckpointIOBudgetMBPerSec * kMB;
+        }
+        return settings;
+    }
+
+    void WiredTigerCheckpointScheduler::run() {
+        WiredTigerSession sessionWrapper(_conn);
+        WT_SESSION* session = sessionWrapper.getSession();
+
+        Timer sinceCheckpoint;
+        Timer sinceLastStart;
+        unsigned long long logBytesAtCheckpoint =
+            _connectionStat(session, WT_STAT_CONN_LOG_BYTES_WRITTEN);
+        unsigned long long lastBytesWritten = 0;
+
+        while (_sleep(kPollMillis)) {
+            const WiredTigerCheckpointPolicy::Settings settings = _currentSettings(session);
+            const WiredTigerCheckpointPolicy::Trigger trigger =
+                WiredTigerCheckpointPolicy::checkpointDue(
+                    settings,
+                    _connectionStat(session, WT_STAT_CONN_CACHE_BYTES_DIRTY),
+                    _connectionStat(session, WT_STAT_CONN_LOG_BYTES_WRITTEN) -
+                        logBytesAtCheckpoint,
+                    sinceCheckpoint.millis());
+            if (WiredTigerCheckpointPolicy::kNotDue == trigger) {
+                continue;
+            }
+
+            const long long delay = WiredTigerCheckpointPolicy::budgetDelayMillis(
+                settings, lastBytesWritten, sinceLastStart.millis());
+            if (delay > 0) {
+                Timer stall;
+                const bool running = _sleep(delay);
+                {
+                    boost::lock_guard<boost::mutex> lk(_statsMutex);
+                    _budgetStallMillis += stall.millis();
+                }
+                if (!running) {
+                    break;
+                }
+            }
+
+            const unsigned long long bytesBefore =
+                _connectionStat(session, WT_STAT_CONN_BLOCK_BYTE_WRITE);
+            sinceLastStart.reset();
+
+            const int ret = session->checkpoint(session, NULL);
+            if (ret != 0) {
+                error() << "WiredTiger checkpoint failed: " << wtRCToStatus(ret).reason();
+                continue;
+            }
+
+            const long long duration = sinceLastStart.millis();
+            lastBytesWritten = _connectionStat(session, WT_STAT_CONN_BLOCK_BYTE_WRITE) -
+                bytesBefore;
+            logBytesAtCheckpoint = _connectionStat(session, WT_STAT_CONN_LOG_BYTES_WRITTEN);
+            sinceCheckpoint.reset();
+
+            LOG(1) << "WiredTiger checkpoint took " << duration << "ms and wrote "
+                   << lastBytesWritten << " bytes";
+
+            boost::lock_guard<boost::mutex> lk(_statsMutex);
+            _checkpoints++;
+            switch (trigger) {
+            case WiredTigerCheckpointPolicy::kDirtyBytes: _byDirtyBytes++; break;
+            case WiredTigerCheckpointPolicy::kLogBytes: _byLogBytes++; break;
+            case WiredTigerCheckpointPolicy::kTimer: _byTimer++; break;
+            case WiredTigerCheckpointPolicy::kNotDue: invariant(false);
+            }
+            _lastDurationMillis = duration;
+            _totalDurationMillis += duration;
+            _lastBytesWritten = lastBytesWritten;
+            _totalBytesWritten += lastBytesWritten;
+        }
+    }
+
+    void WiredTigerCheckpointScheduler::appendStats(BSONObjBuilder* builder) const {
+        boost::lock_guard<boost::mutex> lk(_statsMutex);
+        builder->append("checkpoints", _checkpoints);
+
+        BSONObjBuilder triggers(builder->subobjStart("triggeredBy"));
+        triggers.append("dirtyBytes", _byDirtyBytes);
+        triggers.append("journalBytes", _byLogBytes);
+        triggers.append("timer", _byTimer);
+        triggers.done();
+
+        builder->append("lastDurationMillis", _lastDurationMillis);
+        builder->append("totalDurationMillis", _totalDurationMillis);
+        builder->append("lastBytesWritten", static_cast<long long>(_lastBytesWritten));
+        builder->append("totalBytesWritten", static_cast<long long>(_totalBytesWritten));
+        builder->append("budgetStallMillis", _budgetStallMillis);
+    }
+
+}  // namespace mongo
@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <string>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <wiredtiger.h>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Decides when the next checkpoint is due. Kept apart from the thread so it can be tested
+     * without a connection.
+     *
+     * A checkpoint is due once the cache holds 'dirtyTriggerBytes' of dirty data, once
+     * 'logTriggerBytes' have been written to the journal since the last checkpoint, or once
+     * 'maxWaitMillis' have passed since it. A zero threshold disables that trigger.
+     *
+     * A due checkpoint is then held back until the bytes written by the previous one, spread
+     * over the time since it started, fit in 'ioBudgetBytesPerSec'. Frequent small checkpoints
+     * are allowed as long as they stay in budget, rather than one large one per interval.
+     */
+    class WiredTigerCheckpointPolicy {
+    public:
+        enum Trigger {
+            kNotDue,
+            kDirtyBytes,
+            kLogBytes,
+            kTimer,
+        };
+
+        struct Settings {
+            Settings()
+                : dirtyTriggerBytes(0),
+                  logTriggerBytes(0),
+                  maxWaitMillis(0),
+                  ioBudgetBytesPerSec(0) { }
+
+            unsigned long long dirtyTriggerBytes;
+            unsigned long long logTriggerBytes;
+            long long maxWaitMillis;
+            unsigned long long ioBudgetBytesPerSec;
+        };
+
+        static Trigger checkpointDue(const Settings& settings,
+                                     unsigned long long dirtyBytes,
+                                     unsigned long long logBytesSinceCheckpoint,
+                                     long long millisSinceCheckpoint);
+
+        /**
+         * Returns how many more milliseconds a due checkpoint has to wait for the previous one,
+         * which wrote 'lastBytesWritten' and started 'millisSinceLastStart' ago, to fit in the
+         * budget. Returns 0 if it may start now.
+         */
+        static long long budgetDelayMillis(const Settings& settings,
+                                           unsigned long long lastBytesWritten,
+                                           long long millisSinceLastStart);
+    };
+
+    /**
+     * Runs the checkpoints of a WiredTigerKVEngine in place of WiredTiger's fixed timer. Polls
+     * the connection statistics for the dirty cache size and the journal bytes written, and
+     * checkpoints when WiredTigerCheckpointPolicy says so.
+     */
+    class WiredTigerCheckpointScheduler : public BackgroundJob {
+        MONGO_DISALLOW_COPYING(WiredTigerCheckpointScheduler);
+    public:
+        /**
+         * 'maxWaitSecs' bounds the time between checkpoints, as checkpoint=(wait) did. 0 leaves
+         * only the dirty and journal triggers.
+         */
+        WiredTigerCheckpointScheduler(WT_CONNECTION* conn, long long maxWaitSecs);
+
+        /** False if wiredTigerAdaptiveCheckpoints was turned off at startup. */
+        static bool isEnabled();
+
+        virtual std::string name() const { return "WTCheckpointScheduler"; }
+
+        /** Stops the thread and waits for a running checkpoint to finish. */
+        void shutdown();
+
+        void appendStats(BSONObjBuilder* builder) const;
+
+    protected:
+        virtual void run();
+
+    private:
+        WiredTigerCheckpointPolicy::Settings _currentSettings(WT_SESSION* session) const;
+
+        /** Reads a connection statistic, 0 if it isn't available. */
+        static unsigned long long _connectionStat(WT_SESSION* session, int key);
+
+        /** Returns false if the scheduler was shut down meanwhile. */
+        bool _sleep(long long millis);
+
+        WT_CONNECTION* const _conn;
+        const long long _maxWaitMillis;
+
+        boost::mutex _shutdownMutex;
+        boost::condition_variable _shutdownCondition;
+        bool _shutdown;  // guarded by _shutdownMutex
+
+        // Guards the stats below, which are written by the thread and read by appendStats().
+        mutable boost::mutex _statsMutex;
+        long long _checkpoints;
+        long long _byDirtyBytes;
+        long long _byLogBytes;
+        long long _byTimer;
+        long long _lastDurationMillis;
+        long long _totalDurationMillis;
+        unsigned long long _lastBytesWritten;
+        unsigned long long _totalBytesWritten;
+
+        // time due checkpoints were held back by the I/O budget
+        long long _budgetStallMillis;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    WiredTigerCheckpointPolicy::Settings makeSettings() {
+        WiredTigerCheckpointPolicy::Settings settings;
+        settings.dirtyTriggerBytes = 1000;
+        settings.logTriggerBytes = 5000;
+        settings.maxWaitMillis = 60 * 1000;
+        return settings;
+    }
+
+    TEST(WiredTigerCheckpointPolicyTest, NotDueBelowAllTriggers) {
+        ASSERT_EQUALS(WiredTigerCheckpointPolicy::kNotDue,
+                      WiredTigerCheckpointPolicy::checkpointDue(makeSettings(), 999, 4999, 100));
+    }
+
+    TEST(WiredTigerCheckpointPolicyTest, EachTriggerFires) {
+        const WiredTigerCheckpointPolicy::Settings settings = makeSettings();
+        ASSERT_EQUALS(WiredTigerCheckpointPolicy::kDirtyBytes,
+                      WiredTigerCheckpointPolicy::checkpointDue(settings, 1000, 0, 0));
+        ASSERT_EQUALS(WiredTigerCheckpointPolicy::kLogBytes,
+                      WiredTigerCheckpointPolicy::checkpointDue(settings, 0, 5000, 0));
+        ASSERT_EQUALS(WiredTigerCheckpointPolicy::kTimer,
+                      WiredTigerCheckpointPolicy::checkpointDue(settings, 0, 0, 60 * 1000));
+    }
+
+    TEST(WiredTigerCheckpointPolicyTest, ZeroDisablesTrigger) {
+        const WiredTigerCheckpointPolicy::Settings settings;
+        ASSERT_EQUALS(WiredTigerCheckpointPolicy::kNotDue,
+                      WiredTigerCheckpointPolicy::checkpointDue(settings, 1ULL << 40,
+                                                                1ULL << 40, 1LL << 40));
+    }
+
+    TEST(WiredTigerCheckpointPolicyTest, BudgetDelay) {
+        WiredTigerCheckpointPolicy::Settings settings = makeSettings();
+
+        // No budget, no delay.
+        ASSERT_EQUALS(0, WiredTigerCheckpointPolicy::budgetDelayMillis(settings, 1ULL << 30, 0));
+
+        // 100MB at 50MB/s takes two seconds of budget from the start of the last checkpoint.
+        settings.ioBudgetBytesPerSec = 50 * 1024 * 1024;
+        const unsigned long long written = 100 * 1024 * 1024;
+        ASSERT_EQUALS(2000, WiredTigerCheckpointPolicy::budgetDelayMillis(settings, written, 0));
+        ASSERT_EQUALS(500, WiredTigerCheckpointPolicy::budgetDelayMillis(settings, written, 1500));
+        ASSERT_EQUALS(0, WiredTigerCheckpointPolicy::budgetDelayMillis(settings, written, 2500));
+    }
+
+}  // namespace
+}  // namespace mongo
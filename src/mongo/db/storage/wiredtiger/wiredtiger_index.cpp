@@ -343,6 +343,16 @@ namespace {
                                                                      _uri ) );
     }
 
+    Status WiredTigerIndex::compact(OperationContext* txn) {
+        WiredTigerSessionCache* cache = WiredTigerRecoveryUnit::get(txn)->getSessionCache();
+        return WiredTigerUtil::compact(txn, cache, _uri);
+    }
+
+    Status WiredTigerIndex::touch(OperationContext* txn) const {
+        WiredTigerSessionCache* cache = WiredTigerRecoveryUnit::get(txn)->getSessionCache();
+        return WiredTigerUtil::touch(txn, cache, _uri, NULL);
+    }
+
     bool WiredTigerIndex::isDup(WT_CURSOR *c, const BSONObj& key, const RecordId& loc ) {
         invariant( unique() );
         // First check whether the key exists.
@@ -641,6 +651,11 @@ namespace {
             return _keyBson;
         }
 
+        const KeyString* getKeyString() const {
+            loadKeyIfNeeded();
+            return &_key;
+        }
+
         void savePosition() {
             _savedForCheck = _txn->recoveryUnit();
 
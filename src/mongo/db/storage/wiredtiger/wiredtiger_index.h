@@ -102,6 +102,10 @@ namespace mongo {
 
         virtual long long getSpaceUsedBytes( OperationContext* txn ) const;
 
+        virtual Status compact(OperationContext* txn);
+
+        virtual Status touch(OperationContext* txn) const;
+
         bool isDup(WT_CURSOR *c, const BSONObj& key, const RecordId& loc );
 
         virtual Status initAsEmpty(OperationContext* txn);
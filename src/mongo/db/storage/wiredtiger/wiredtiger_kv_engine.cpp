@@ -38,6 +38,7 @@
 
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -150,8 +151,12 @@ namespace mongo {
             ss << "log=(enabled=true,archive=true,path=journal,compressor=";
             ss << wiredTigerGlobalOptions.journalCompressor << "),";
         }
-        ss << "checkpoint=(wait=" << wiredTigerGlobalOptions.checkpointDelaySecs;
-        ss << ",log_size=2GB),";
+        // The checkpoint scheduler started below replaces WiredTiger's own checkpoint timer.
+        const bool adaptiveCheckpoints = WiredTigerCheckpointScheduler::isEnabled();
+        if (!adaptiveCheckpoints) {
+            ss << "checkpoint=(wait=" << wiredTigerGlobalOptions.checkpointDelaySecs;
+            ss << ",log_size=2GB),";
+        }
         ss << "statistics_log=(wait=" << wiredTigerGlobalOptions.statisticsLogDelaySecs << "),";
         ss << extraOpenOptions;
         string config = ss.str();
@@ -180,6 +185,12 @@ namespace mongo {
             ss->loadFrom( &session, _sizeStorerUri );
             _sizeStorer.reset( ss );
         }
+
+        if (adaptiveCheckpoints) {
+            _checkpointScheduler.reset(new WiredTigerCheckpointScheduler(
+                _conn, wiredTigerGlobalOptions.checkpointDelaySecs));
+            _checkpointScheduler->go();
+        }
     }
 
 
@@ -196,6 +207,10 @@ namespace mongo {
     void WiredTigerKVEngine::cleanShutdown() {
         log() << "WiredTigerKVEngine shutting down";
         syncSizeInfo(true);
+        if (_checkpointScheduler) {
+            _checkpointScheduler->shutdown();
+            _checkpointScheduler.reset();
+        }
         if (_conn) {
             // this must be the last thing we do before _conn->close();
             _sessionCache->shuttingDown();
@@ -271,6 +286,12 @@ namespace mongo {
         return 1;
     }
 
+    void WiredTigerKVEngine::appendCheckpointStats(BSONObjBuilder* builder) const {
+        if (_checkpointScheduler) {
+            _checkpointScheduler->appendStats(builder);
+        }
+    }
+
     void WiredTigerKVEngine::syncSizeInfo( bool sync ) const {
         if ( !_sizeStorer )
             return;
@@ -46,6 +46,8 @@
 
 namespace mongo {
 
+    class BSONObjBuilder;
+    class WiredTigerCheckpointScheduler;
     class WiredTigerSessionCache;
     class WiredTigerSizeStorer;
 
@@ -120,6 +122,19 @@ namespace mongo {
 
         void syncSizeInfo(bool sync) const;
 
+        /** Appends the checkpoint scheduler's stats, if wiredTigerAdaptiveCheckpoints is on. */
+        void appendCheckpointStats(BSONObjBuilder* builder) const;
+
+        /**
+         * Starts the thread that truncates the oplog 'ns' in the background, unless one is
+         * already running. Returns false if this build has no such thread, in which case
+         * inserting into the oplog deletes from its front inline.
+         *
+         * Defined in wiredtiger_record_store_mongod.cpp, and always false in the record store
+         * unit tests (wiredtiger_record_store_mock.cpp).
+         */
+        static bool initRsOplogBackgroundThread(const StringData& ns);
+
     private:
 
         Status _salvageIfNeeded(const char* uri);
@@ -145,6 +160,8 @@ namespace mongo {
         boost::scoped_ptr<WiredTigerSizeStorer> _sizeStorer;
         std::string _sizeStorerUri;
         mutable ElapsedTracker _sizeStorerSyncTracker;
+
+        boost::scoped_ptr<WiredTigerCheckpointScheduler> _checkpointScheduler;
     };
 
 }
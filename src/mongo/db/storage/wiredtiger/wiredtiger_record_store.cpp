@@ -35,6 +35,8 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 
+#include <deque>
+
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_array.hpp>
 #include <wiredtiger.h>
@@ -45,6 +47,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
@@ -83,6 +86,149 @@ namespace {
 
     const long long WiredTigerRecordStore::kCollectionScanOnCreationThreshold = 10000;
 
+    /**
+     * Splits the oplog into "stones", runs of consecutive records with known record and byte
+     * counts, so that once the oplog is over its capped size it can be truncated a whole stone at
+     * a time.  The newest records are in the current stone, which becomes a full stone once it
+     * reaches 1/kNumStones of the capped size.
+     *
+     * The stones for the records present at startup are estimated by splitting the range of
+     * RecordIds evenly, as the oplog's RecordIds follow its timestamps.
+     */
+    class WiredTigerRecordStore::OplogStones {
+    public:
+        struct Stone {
+            Stone() : records(0), bytes(0) {}
+            Stone(int64_t records, int64_t bytes, const RecordId& lastRecord)
+                : records(records), bytes(bytes), lastRecord(lastRecord) {}
+
+            int64_t records;
+            int64_t bytes;
+            RecordId lastRecord; // the newest record in the stone
+        };
+
+        class InsertChange;
+
+        static const int64_t kNumStones = 100;
+
+        OplogStones(OperationContext* txn, WiredTigerRecordStore* rs)
+            : _minBytesPerStone(std::max(rs->cappedMaxSize() / kNumStones, int64_t(1))),
+              _currentRecords(0),
+              _currentBytes(0) {
+            const int64_t numRecords = rs->numRecords(txn);
+            const int64_t dataSize = rs->dataSize(txn);
+            const int64_t numStones = dataSize / _minBytesPerStone;
+            if (numStones == 0) {
+                _currentRecords = numRecords;
+                _currentBytes = dataSize;
+                return;
+            }
+
+            scoped_ptr<RecordIterator> forward(rs->getIterator(txn));
+            scoped_ptr<RecordIterator> backward(
+                rs->getIterator(txn, RecordId(), CollectionScanParams::BACKWARD));
+            if (forward->isEOF() || backward->isEOF()) {
+                return;
+            }
+            const int64_t first = forward->curr().repr();
+            const int64_t last = backward->curr().repr();
+
+            for (int64_t i = 1; i <= numStones; i++) {
+                const int64_t lastRecord = (i == numStones) ?
+                    last : first + (last - first) / numStones * i;
+                const int64_t records =
+                    numRecords * i / numStones - numRecords * (i - 1) / numStones;
+                const int64_t bytes = dataSize * i / numStones - dataSize * (i - 1) / numStones;
+                _stones.push_back(Stone(records, bytes, RecordId(lastRecord)));
+            }
+        }
+
+        bool peekOldestStone(Stone* stone) const {
+            boost::mutex::scoped_lock lk(_mutex);
+            if (_stones.empty()) {
+                return false;
+            }
+            *stone = _stones.front();
+            return true;
+        }
+
+        void popOldestStone() {
+            boost::mutex::scoped_lock lk(_mutex);
+            _stones.pop_front();
+        }
+
+        // Counts a committed insert into the current stone, which is full after it.
+        void addToCurrentStone(int64_t bytes, const RecordId& loc) {
+            boost::mutex::scoped_lock lk(_mutex);
+            _currentRecords++;
+            _currentBytes += bytes;
+            if (_currentBytes >= _minBytesPerStone) {
+                // Inserts can commit out of order, the stone ends at the newest record.
+                RecordId lastRecord = loc;
+                if (!_stones.empty() && _stones.back().lastRecord > lastRecord) {
+                    lastRecord = _stones.back().lastRecord;
+                }
+                _stones.push_back(Stone(_currentRecords, _currentBytes, lastRecord));
+                _currentRecords = 0;
+                _currentBytes = 0;
+            }
+        }
+
+        /**
+         * Removes the stones that end after 'end' (or at it, if 'inclusive') and returns the
+         * newest remaining stone's last record, or a null RecordId.  The records after it are to
+         * be recounted into the current stone with resetCurrentStone().
+         */
+        RecordId removeStonesAfter(const RecordId& end, bool inclusive) {
+            boost::mutex::scoped_lock lk(_mutex);
+            while (!_stones.empty() &&
+                   (_stones.back().lastRecord > end ||
+                    (inclusive && _stones.back().lastRecord == end))) {
+                _stones.pop_back();
+            }
+            return _stones.empty() ? RecordId() : _stones.back().lastRecord;
+        }
+
+        void resetCurrentStone(int64_t records, int64_t bytes) {
+            boost::mutex::scoped_lock lk(_mutex);
+            _currentRecords = records;
+            _currentBytes = bytes;
+        }
+
+        void clear() {
+            boost::mutex::scoped_lock lk(_mutex);
+            _stones.clear();
+            _currentRecords = 0;
+            _currentBytes = 0;
+        }
+
+    private:
+        const int64_t _minBytesPerStone;
+
+        mutable boost::mutex _mutex; // protects the members below
+        std::deque<Stone> _stones; // oldest first
+        int64_t _currentRecords;
+        int64_t _currentBytes;
+    };
+
+    class WiredTigerRecordStore::OplogStones::InsertChange : public RecoveryUnit::Change {
+    public:
+        InsertChange(OplogStones* stones, int64_t bytes, const RecordId& loc)
+            : _stones(stones), _bytes(bytes), _loc(loc) {
+        }
+
+        virtual void commit() {
+            _stones->addToCurrentStone(_bytes, _loc);
+        }
+
+        virtual void rollback() {}
+
+    private:
+        OplogStones* _stones;
+        int64_t _bytes;
+        RecordId _loc;
+    };
+
     // static
     StatusWith<std::string> WiredTigerRecordStore::generateCreateString(
         const StringData& ns,
@@ -173,8 +319,7 @@ namespace {
               _cappedDeleteCallback( cappedDeleteCallback ),
               _cappedDeleteCheckCount(0),
               _useOplogHack(shouldUseOplogHack(ctx, _uri)),
-              _sizeStorer( sizeStorer ),
-              _sizeStorerCounter(0)
+              _sizeStorer( sizeStorer )
     {
         Status versionStatus = WiredTigerUtil::checkApplicationMetadataFormatVersion(
             ctx, uri, kMinimumRecordStoreVersion, kMaximumRecordStoreVersion);
@@ -237,6 +382,9 @@ namespace {
 
         }
 
+        if ( _isOplog && WiredTigerKVEngine::initRsOplogBackgroundThread( ns ) ) {
+            _oplogStones.reset( new OplogStones( ctx, this ) );
+        }
     }
 
     WiredTigerRecordStore::~WiredTigerRecordStore() {
@@ -460,6 +608,43 @@ namespace {
         txn->setRecoveryUnit( realRecoveryUnit );
     }
 
+    int64_t WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
+        invariant(_oplogStones);
+
+        int64_t recordsRemoved = 0;
+        OplogStones::Stone stone;
+        while (_dataSize.load() > _cappedMaxSize && _oplogStones->peekOldestStone(&stone)) {
+            // The oplog has no indexes, so unlike cappedDeleteAsNeeded there is no need to go
+            // through the delete callback record by record.
+            WriteUnitOfWork wuow(txn);
+            WiredTigerCursor curwrap(_uri, _instanceId, true, txn);
+            WT_CURSOR* c = curwrap.get();
+
+            int cmp;
+            c->set_key(c, _makeKey(stone.lastRecord));
+            int ret = c->search_near(c, &cmp);
+            if (ret == 0 && cmp > 0) ret = c->prev(c); // landed past the end of the stone
+            if (ret == 0) {
+                ret = c->session->truncate(c->session, NULL, NULL, c, NULL);
+            }
+            if (ret != WT_NOTFOUND) {
+                uassertStatusOK(wtRCToStatus(ret, "WiredTigerRecordStore::reclaimOplog"));
+            }
+
+            _changeNumRecords(txn, -stone.records);
+            _increaseDataSize(txn, -stone.bytes);
+            wuow.commit();
+
+            _oplogStones->popOldestStone();
+            recordsRemoved += stone.records;
+        }
+
+        if (recordsRemoved > 0) {
+            LOG(1) << "truncated " << recordsRemoved << " records from " << ns();
+        }
+        return recordsRemoved;
+    }
+
     StatusWith<RecordId> WiredTigerRecordStore::extractAndCheckLocForOplog(const char* data,
                                                                            int len) {
         return oploghack::extractKey(data, len);
@@ -513,7 +698,13 @@ namespace {
         _changeNumRecords( txn, 1 );
         _increaseDataSize( txn, len );
 
-        cappedDeleteAsNeeded(txn, loc);
+        if ( _oplogStones ) {
+            txn->recoveryUnit()->registerChange(
+                new OplogStones::InsertChange( _oplogStones.get(), len, loc ) );
+        }
+        else {
+            cappedDeleteAsNeeded(txn, loc);
+        }
 
         return StatusWith<RecordId>( loc );
     }
@@ -574,13 +765,15 @@ namespace {
 
         _increaseDataSize(txn, len - old_length);
 
-        cappedDeleteAsNeeded(txn, loc);
+        if ( !_oplogStones ) {
+            cappedDeleteAsNeeded(txn, loc);
+        }
 
         return StatusWith<RecordId>( loc );
     }
 
     bool WiredTigerRecordStore::updateWithDamagesSupported() const {
-        return false;
+        return true;
     }
 
     Status WiredTigerRecordStore::updateWithDamages( OperationContext* txn,
@@ -588,7 +781,33 @@ namespace {
                                                      const RecordData& oldRec,
                                                      const char* damageSource,
                                                      const mutablebson::DamageVector& damages ) {
-        invariant(false);
+        // This version of WiredTiger can't update part of a value, so the damages are applied to
+        // a copy of the old record, which is then written whole.  That still saves the caller
+        // from rebuilding the document and from recomputing its index keys.
+        const int len = oldRec.size();
+        boost::shared_array<char> buf( new char[len] );
+        std::memcpy( buf.get(), oldRec.data(), len );
+
+        mutablebson::DamageVector::const_iterator where = damages.begin();
+        const mutablebson::DamageVector::const_iterator end = damages.end();
+        for( ; where != end; ++where ) {
+            invariant( where->targetOffset + where->size <= static_cast<size_t>( len ) );
+            std::memcpy( buf.get() + where->targetOffset,
+                         damageSource + where->sourceOffset,
+                         where->size );
+        }
+
+        WiredTigerCursor curwrap( _uri, _instanceId, true, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+        invariant( c );
+        c->set_key(c, _makeKey(loc));
+        WiredTigerItem value(buf.get(), len);
+        c->set_value(c, value.Get());
+        int ret = c->insert(c);
+        invariantWTOK(ret);
+
+        return Status::OK();
     }
 
     void WiredTigerRecordStore::_oplogSetStartHack( WiredTigerRecoveryUnit* wru ) const {
@@ -638,6 +857,10 @@ namespace {
             deleteRecord( txn, loc );
         }
 
+        if ( _oplogStones ) {
+            _oplogStones->clear();
+        }
+
         // WiredTigerRecoveryUnit* ru = _getRecoveryUnit( txn );
 
         return Status::OK();
@@ -648,12 +871,12 @@ namespace {
                                            const CompactOptions* options,
                                            CompactStats* stats ) {
         WiredTigerSessionCache* cache = WiredTigerRecoveryUnit::get(txn)->getSessionCache();
-        WiredTigerSession* session = cache->getSession();
-        WT_SESSION *s = session->getSession();
-        int ret = s->compact(s, getURI().c_str(), NULL);
-        invariantWTOK(ret);
-        cache->releaseSession(session);
-        return Status::OK();
+        return WiredTigerUtil::compact(txn, cache, getURI());
+    }
+
+    Status WiredTigerRecordStore::touch( OperationContext* txn, BSONObjBuilder* output ) const {
+        WiredTigerSessionCache* cache = WiredTigerRecoveryUnit::get(txn)->getSessionCache();
+        return WiredTigerUtil::touch(txn, cache, getURI(), output);
     }
 
     Status WiredTigerRecordStore::validate( OperationContext* txn,
@@ -902,7 +1125,7 @@ namespace {
 
     class WiredTigerRecordStore::DataSizeChange : public RecoveryUnit::Change {
     public:
-        DataSizeChange(WiredTigerRecordStore* rs, int amount) :_rs(rs), _amount(amount) {}
+        DataSizeChange(WiredTigerRecordStore* rs, int64_t amount) :_rs(rs), _amount(amount) {}
         virtual void commit() {}
         virtual void rollback() {
             _rs->_increaseDataSize( NULL, -_amount );
@@ -910,10 +1133,10 @@ namespace {
 
     private:
         WiredTigerRecordStore* _rs;
-        bool _amount;
+        int64_t _amount;
     };
 
-    void WiredTigerRecordStore::_increaseDataSize( OperationContext* txn, int amount ) {
+    void WiredTigerRecordStore::_increaseDataSize( OperationContext* txn, int64_t amount ) {
         if ( txn )
             txn->recoveryUnit()->registerChange(new DataSizeChange(this, amount));
 
@@ -925,10 +1148,6 @@ namespace {
                 _dataSize.store( 0 );
             }
         }
-
-        if ( _sizeStorer && _sizeStorerCounter++ % 1000 == 0 ) {
-            _sizeStorer->store( _uri, _numRecords.load(), _dataSize.load() );
-        }
     }
 
     int64_t WiredTigerRecordStore::_makeKey( const RecordId& loc ) {
@@ -1173,5 +1392,36 @@ namespace {
             }
         }
         wuow.commit();
+
+        if ( _oplogStones ) {
+            // The stones past the truncation point are gone, recount what follows the newest
+            // remaining stone.
+            RecordId lastStoneRecord = _oplogStones->removeStonesAfter( end, inclusive );
+            int64_t records = 0;
+            int64_t bytes = 0;
+
+            WiredTigerCursor curwrap( _uri, _instanceId, true, txn );
+            WT_CURSOR* c = curwrap.get();
+            int ret;
+            if ( lastStoneRecord.isNull() ) {
+                ret = c->next(c);
+            }
+            else {
+                // The stone's last record may be an estimate that doesn't exist.
+                int cmp;
+                c->set_key(c, _makeKey(lastStoneRecord));
+                ret = c->search_near(c, &cmp);
+                if ( ret == 0 && cmp <= 0 ) ret = c->next(c);
+            }
+            for ( ; ret == 0; ret = c->next(c) ) {
+                WT_ITEM value;
+                invariantWTOK( c->get_value(c, &value) );
+                records++;
+                bytes += value.size;
+            }
+            if ( ret != WT_NOTFOUND ) invariantWTOK( ret );
+
+            _oplogStones->resetCurrentStone( records, bytes );
+        }
     }
 }
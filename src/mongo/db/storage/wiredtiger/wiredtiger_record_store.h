@@ -149,6 +149,8 @@ namespace mongo {
                                 const CompactOptions* options,
                                 CompactStats* stats );
 
+        virtual Status touch( OperationContext* txn, BSONObjBuilder* output ) const;
+
         virtual Status validate( OperationContext* txn,
                                  bool full,
                                  bool scanData,
@@ -195,6 +197,13 @@ namespace mongo {
         void dealtWithCappedLoc( const RecordId& loc );
         bool isCappedHidden( const RecordId& loc ) const;
 
+        /**
+         * Truncates whole stones from the front of the oplog until it is within its capped size
+         * again. Returns the number of records removed. Only for an oplog with a background
+         * truncation thread, which is the caller.
+         */
+        int64_t reclaimOplog(OperationContext* txn);
+
     private:
 
         class Iterator : public RecordIterator {
@@ -236,6 +245,7 @@ namespace mongo {
         class CappedInsertChange;
         class NumRecordsChange;
         class DataSizeChange;
+        class OplogStones;
 
         static WiredTigerRecoveryUnit* _getRecoveryUnit( OperationContext* txn );
 
@@ -249,7 +259,7 @@ namespace mongo {
         bool cappedAndNeedDelete() const;
         void cappedDeleteAsNeeded(OperationContext* txn, const RecordId& justInserted );
         void _changeNumRecords(OperationContext* txn, int64_t diff);
-        void _increaseDataSize(OperationContext* txn, int amount);
+        void _increaseDataSize(OperationContext* txn, int64_t amount);
         RecordData _getData( const WiredTigerCursor& cursor) const;
         StatusWith<RecordId> extractAndCheckLocForOplog(const char* data, int len);
         void _oplogSetStartHack( WiredTigerRecoveryUnit* wru ) const;
@@ -266,6 +276,10 @@ namespace mongo {
         int _cappedDeleteCheckCount; // see comment in ::cappedDeleteAsNeeded
         boost::mutex _cappedDeleterMutex; // see comment in ::cappedDeleteAsNeeded
 
+        // Only set for an oplog truncated by a background thread, which then replaces
+        // cappedDeleteAsNeeded.  See reclaimOplog.
+        boost::scoped_ptr<OplogStones> _oplogStones;
+
         const bool _useOplogHack;
 
         typedef std::vector<RecordId> SortedDiskLocs;
@@ -278,7 +292,8 @@ namespace mongo {
         AtomicInt64 _dataSize;
         AtomicInt64 _numRecords;
 
-        WiredTigerSizeStorer* _sizeStorer; // not owned, can be NULL
-        int _sizeStorerCounter;
+        // not owned, can be NULL. It reads _numRecords and _dataSize itself when it syncs, so the
+        // write paths never have to call into it.
+        WiredTigerSizeStorer* _sizeStorer;
     };
 }
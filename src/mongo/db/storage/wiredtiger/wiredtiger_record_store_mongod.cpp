@@ -0,0 +1,149 @@
+// wiredtiger_record_store_mongod.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+namespace {
+
+    std::set<NamespaceString> _backgroundThreadNamespaces;
+    boost::mutex _backgroundThreadMutex;
+
+    /**
+     * Truncates an oplog whenever it has grown past its capped size, so that inserting into the
+     * oplog never has to delete from its front.
+     */
+    class WiredTigerRecordStoreThread : public BackgroundJob {
+    public:
+        explicit WiredTigerRecordStoreThread(const NamespaceString& ns)
+            : BackgroundJob(true /* deleteSelf */),
+              _ns(ns),
+              _name(std::string("WTOplogTruncator-") + ns.toString()) {
+        }
+
+        virtual std::string name() const {
+            return _name;
+        }
+
+        virtual void run() {
+            Client::initThread(_name.c_str());
+
+            while (!inShutdown()) {
+                if (!_reclaimOplog()) {
+                    sleepmillis(100);
+                }
+            }
+
+            cc().shutdown();
+        }
+
+    private:
+        // Returns true if it removed anything, so there may be more to do right away.
+        bool _reclaimOplog() {
+            if (!getGlobalEnvironment()->getGlobalStorageEngine()) {
+                return false;
+            }
+
+            OperationContextImpl txn;
+            try {
+                ScopedTransaction transaction(&txn, MODE_IX);
+                AutoGetDb autoDb(&txn, _ns.db(), MODE_IX);
+                Database* db = autoDb.getDb();
+                if (!db) {
+                    return false;
+                }
+
+                Lock::CollectionLock collectionLock(txn.lockState(), _ns.ns(), MODE_IX);
+                Collection* collection = db->getCollection(_ns);
+                if (!collection) {
+                    return false;
+                }
+
+                WiredTigerRecordStore* rs =
+                    checked_cast<WiredTigerRecordStore*>(collection->getRecordStore());
+                return rs->reclaimOplog(&txn) > 0;
+            }
+            catch (const WriteConflictException&) {
+                LOG(1) << "got conflict truncating " << _ns << ", will retry";
+                return false;
+            }
+            catch (const DBException& e) {
+                warning() << "error truncating " << _ns << ": " << e.toString();
+                return false;
+            }
+        }
+
+        const NamespaceString _ns;
+        const std::string _name;
+    };
+
+} // namespace
+
+    // static
+    bool WiredTigerKVEngine::initRsOplogBackgroundThread(const StringData& ns) {
+        NamespaceString nss(ns);
+        if (!nss.isOplog()) {
+            return false;
+        }
+
+        boost::mutex::scoped_lock lock(_backgroundThreadMutex);
+        if (_backgroundThreadNamespaces.count(nss)) {
+            // The oplog was reopened, e.g. after a resync. The thread finds the new one.
+            return true;
+        }
+
+        WiredTigerRecordStoreThread* thread = new WiredTigerRecordStoreThread(nss);
+        thread->go();
+        _backgroundThreadNamespaces.insert(nss);
+        return true;
+    }
+
+} // namespace mongo
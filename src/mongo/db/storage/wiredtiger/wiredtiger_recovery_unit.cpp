@@ -30,9 +30,6 @@
 
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
 
-#include <boost/thread/condition.hpp>
-#include <boost/thread/mutex.hpp>
-
 #include "mongo/base/checked_cast.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
@@ -43,37 +40,6 @@
 
 namespace mongo {
 
-    namespace {
-        struct AwaitCommitData {
-            AwaitCommitData() :
-                numWaitingForSync(0),
-                lastSyncTime(0) {
-            }
-
-            void syncHappend() {
-                boost::mutex::scoped_lock lk( mutex );
-                lastSyncTime++;
-                condvar.notify_all();
-            }
-
-            // return true if happened
-            bool awaitCommit() {
-                boost::mutex::scoped_lock lk( mutex );
-                long long start = lastSyncTime;
-                numWaitingForSync.fetchAndAdd(1);
-                condvar.timed_wait(lk,boost::posix_time::milliseconds(50));
-                numWaitingForSync.fetchAndAdd(-1);
-                return lastSyncTime > start;
-            }
-
-            AtomicUInt32 numWaitingForSync;
-
-            boost::mutex mutex; // this just protects lastSyncTime
-            boost::condition condvar;
-            long long lastSyncTime;
-        } awaitCommitData;
-    }
-
     WiredTigerRecoveryUnit::WiredTigerRecoveryUnit(WiredTigerSessionCache* sc) :
         _sessionCache( sc ),
         _session( NULL ),
@@ -81,8 +47,7 @@ namespace mongo {
         _active( false ),
         _myTransactionCount( 0 ),
         _everStartedWrite( false ),
-        _currentlySquirreled( false ),
-        _syncing( false ) {
+        _currentlySquirreled( false ) {
     }
 
     WiredTigerRecoveryUnit::~WiredTigerRecoveryUnit() {
@@ -145,20 +110,12 @@ namespace mongo {
     }
 
     void WiredTigerRecoveryUnit::goingToAwaitCommit() {
-        if ( _active ) {
-            // too late, can't change config
-            return;
-        }
-        // yay, we've configured ourselves for sync
-        _syncing = true;
+        // Nothing to configure: transactions commit without syncing and awaitCommit() joins a
+        // group commit, which shares one log sync across all concurrent waiters.
     }
 
     bool WiredTigerRecoveryUnit::awaitCommit() {
-        if ( _syncing && _everStartedWrite ) {
-            // we did a sync, so we're good
-            return true;
-        }
-        awaitCommitData.awaitCommit();
+        _sessionCache->waitUntilDurable();
         return true;
     }
 
@@ -204,8 +161,6 @@ namespace mongo {
         if ( commit ) {
             invariantWTOK( s->commit_transaction(s, NULL) );
             LOG(2) << "WT commit_transaction";
-            if ( _syncing )
-                awaitCommitData.syncHappend();
         }
         else {
             invariantWTOK( s->rollback_transaction(s, NULL) );
@@ -222,8 +177,7 @@ namespace mongo {
     void WiredTigerRecoveryUnit::_txnOpen() {
         invariant( !_active );
         WT_SESSION *s = _session->getSession();
-        _syncing = _syncing || awaitCommitData.numWaitingForSync.load() > 0;
-        invariantWTOK( s->begin_transaction(s, _syncing ? "sync=true" : NULL) );
+        invariantWTOK( s->begin_transaction(s, NULL) );
         LOG(2) << "WT begin_transaction";
         _timer.reset();
         _active = true;
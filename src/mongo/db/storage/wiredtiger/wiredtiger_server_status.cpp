@@ -61,8 +61,8 @@ namespace mongo {
                 OperationContext* txn,
                 const BSONElement& configElement) const {
 
-        WiredTigerSession* session =
-            checked_cast<WiredTigerRecoveryUnit*>(txn->recoveryUnit())->getSession();
+        WiredTigerRecoveryUnit* ru = checked_cast<WiredTigerRecoveryUnit*>(txn->recoveryUnit());
+        WiredTigerSession* session = ru->getSession();
         invariant(session);
 
         WT_SESSION* s = session->getSession();
@@ -78,6 +78,18 @@ namespace mongo {
             bob.append("reason", status.reason());
         }
 
+        {
+            BSONObjBuilder cacheBuilder(bob.subobjStart("mongodb session cache"));
+            ru->getSessionCache()->appendStats(&cacheBuilder);
+            cacheBuilder.done();
+        }
+
+        {
+            BSONObjBuilder checkpointBuilder(bob.subobjStart("mongodb checkpoint scheduler"));
+            _engine->appendCheckpointStats(&checkpointBuilder);
+            checkpointBuilder.done();
+        }
+
         return bob.obj();
     }
 
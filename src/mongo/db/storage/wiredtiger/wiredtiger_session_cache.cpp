@@ -33,6 +33,14 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/util/log.h"
@@ -43,6 +51,8 @@ namespace mongo {
         : _cachePartition(cachePartition),
           _epoch(epoch),
           _session(NULL),
+          _cursorsCached(0),
+          _cursorGen(0),
           _cursorsOut(0) {
 
         int ret = conn->open_session(conn, NULL, "isolation=snapshot", &_session);
@@ -60,14 +70,18 @@ namespace mongo {
                                             uint64_t id,
                                             bool forRecordStore) {
         {
-            Cursors& cursors = _curmap[id];
-            if ( !cursors.empty() ) {
+            CursorMap::iterator it = _curmap.find(id);
+            if ( it != _curmap.end() && !it->second.cursors.empty() ) {
+                Cursors& cursors = it->second.cursors;
                 WT_CURSOR* save = cursors.back();
                 cursors.pop_back();
+                _cursorsCached--;
                 _cursorsOut++;
+                _cursorStats.hits++;
                 return save;
             }
         }
+        _cursorStats.misses++;
         WT_CURSOR* c = NULL;
         int ret = _session->open_cursor(_session,
                                         uri.c_str(),
@@ -76,7 +90,10 @@ namespace mongo {
                                         &c);
         if (ret != ENOENT)
             invariantWTOK(ret);
-        if ( c ) _cursorsOut++;
+        if ( c ) {
+            _cursorsOut++;
+            _cursorStats.opened++;
+        }
         return c;
     }
 
@@ -85,20 +102,43 @@ namespace mongo {
         invariant( cursor );
         _cursorsOut--;
 
-        Cursors& cursors = _curmap[id];
-        if ( cursors.size() > 10u ) {
+        CachedCursors& cached = _curmap[id];
+        cached.lastUsed = ++_cursorGen;
+        if ( cached.cursors.size() > 10u ) {
             invariantWTOK( cursor->close(cursor) );
         }
         else {
             invariantWTOK( cursor->reset( cursor ) );
-            cursors.push_back( cursor );
+            cached.cursors.push_back( cursor );
+            if ( ++_cursorsCached > kMaxCachedCursors ) {
+                _evictCursors();
+            }
+        }
+    }
+
+    void WiredTigerSession::_evictCursors() {
+        std::vector<std::pair<uint64_t, uint64_t> > byAge; // (lastUsed, id)
+        byAge.reserve(_curmap.size());
+        for (CursorMap::const_iterator i = _curmap.begin(); i != _curmap.end(); ++i) {
+            byAge.push_back(std::make_pair(i->second.lastUsed, i->first));
+        }
+        std::sort(byAge.begin(), byAge.end());
+
+        for (size_t i = 0; i < byAge.size() && _cursorsCached > kMaxCachedCursors / 2; i++) {
+            CursorMap::iterator it = _curmap.find(byAge[i].second);
+            Cursors& cursors = it->second.cursors;
+            for (size_t j = 0; j < cursors.size(); j++) {
+                invariantWTOK(cursors[j]->close(cursors[j]));
+            }
+            _cursorsCached -= cursors.size();
+            _curmap.erase(it);
         }
     }
 
     void WiredTigerSession::closeAllCursors() {
         invariant( _session );
         for (CursorMap::iterator i = _curmap.begin(); i != _curmap.end(); ++i ) {
-            Cursors& cursors = i->second;
+            Cursors& cursors = i->second.cursors;
             for ( size_t j = 0; j < cursors.size(); j++ ) {
                 WT_CURSOR *cursor = cursors[j];
                 if (cursor) {
@@ -108,6 +148,13 @@ namespace mongo {
             }
         }
         _curmap.clear();
+        _cursorsCached = 0;
+    }
+
+    WiredTigerCursorCacheStats WiredTigerSession::_takeCursorStats() {
+        WiredTigerCursorCacheStats stats = _cursorStats;
+        _cursorStats = WiredTigerCursorCacheStats();
+        return stats;
     }
 
     namespace {
@@ -122,12 +169,15 @@ namespace mongo {
     // -----------------------
 
     WiredTigerSessionCache::WiredTigerSessionCache( WiredTigerKVEngine* engine )
-        : _engine( engine ), _conn( engine->getConnection() ), _shuttingDown(0) {
+        : _engine( engine ),
+          _conn( engine->getConnection() ),
+          _groupCommit( this ),
+          _shuttingDown(0) {
 
     }
 
     WiredTigerSessionCache::WiredTigerSessionCache( WT_CONNECTION* conn )
-        : _engine( NULL ), _conn( conn ), _shuttingDown(0) {
+        : _engine( NULL ), _conn( conn ), _groupCommit( this ), _shuttingDown(0) {
 
     }
 
@@ -168,6 +218,59 @@ namespace mongo {
         }
     }
 
+    void WiredTigerSessionCache::GroupCommit::_syncLog() {
+        WiredTigerSession* session = _cache->getSession();
+        WT_SESSION* s = session->getSession();
+        invariantWTOK(s->log_flush(s));
+        _cache->releaseSession(session);
+    }
+
+    void WiredTigerSessionCache::waitUntilDurable() {
+        _groupCommit.waitUntilDurable();
+    }
+
+    void WiredTigerSessionCache::appendStats(BSONObjBuilder* builder) const {
+        long long sessionHits = 0;
+        long long sessionMisses = 0;
+        WiredTigerCursorCacheStats cursorStats;
+
+        for (int i = 0; i < NumSessionCachePartitions; i++) {
+            boost::unique_lock<SpinLock> scopedLock(_cache[i].lock);
+            sessionHits += _cache[i].sessionHits;
+            sessionMisses += _cache[i].sessionMisses;
+            cursorStats.add(_cache[i].cursorStats);
+        }
+
+        BSONObjBuilder sessions(builder->subobjStart("sessions"));
+        sessions.append("cacheHits", sessionHits);
+        sessions.append("cacheMisses", sessionMisses);
+        sessions.done();
+
+        BSONObjBuilder cursors(builder->subobjStart("cursors"));
+        cursors.append("cacheHits", cursorStats.hits);
+        cursors.append("cacheMisses", cursorStats.misses);
+        cursors.append("opened", cursorStats.opened);
+        cursors.done();
+
+        BSONObjBuilder groupCommit(builder->subobjStart("groupCommit"));
+        _groupCommit.appendStats(&groupCommit);
+        groupCommit.done();
+    }
+
+    // static
+    int WiredTigerSessionCache::_pickPartition() {
+#ifdef __linux__
+        // Partitions follow the CPU, so with numaThreadPinning a thread's sessions are created
+        // and reused on its own NUMA node.
+        const int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return cpu % NumSessionCachePartitions;
+        }
+#endif
+        // Spread sessions uniformly across the cache partitions
+        return cachePartitionGen.addAndFetch(1) % NumSessionCachePartitions;
+    }
+
     WiredTigerSession* WiredTigerSessionCache::getSession() {
         boost::shared_lock<boost::shared_mutex> shutdownLock(_shutdownLock);
 
@@ -175,8 +278,7 @@ namespace mongo {
         // operations should be allowed to start.
         invariant(!_shuttingDown.loadRelaxed());
 
-        // Spread sessions uniformly across the cache partitions
-        const int cachePartition = cachePartitionGen.addAndFetch(1) % NumSessionCachePartitions;
+        const int cachePartition = _pickPartition();
 
         int epoch;
 
@@ -187,9 +289,12 @@ namespace mongo {
             if (!_cache[cachePartition].pool.empty()) {
                 WiredTigerSession* cachedSession = _cache[cachePartition].pool.back();
                 _cache[cachePartition].pool.pop_back();
+                _cache[cachePartition].sessionHits++;
 
                 return cachedSession;
             }
+
+            _cache[cachePartition].sessionMisses++;
         }
 
         // Outside of the cache partition lock, but on release will be put back on the cache
@@ -222,9 +327,12 @@ namespace mongo {
         bool returnedToCache = false;
 
         if (cachePartition >= 0) {
+            const WiredTigerCursorCacheStats cursorStats = session->_takeCursorStats();
+
             boost::unique_lock<SpinLock> cachePartitionLock(_cache[cachePartition].lock);
 
             invariant(session->_getEpoch() <= _cache[cachePartition].epoch);
+            _cache[cachePartition].cursorStats.add(cursorStats);
 
             if (session->_getEpoch() == _cache[cachePartition].epoch) {
                 _cache[cachePartition].pool.push_back(session);
@@ -31,7 +31,6 @@
 
 #pragma once
 
-#include <map>
 #include <string>
 #include <vector>
 
@@ -40,13 +39,34 @@
 
 #include <wiredtiger.h>
 
+#include "mongo/db/storage/group_commit_coordinator.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
+    class BSONObjBuilder;
     class WiredTigerKVEngine;
 
+    /**
+     * Cursor cache counters. Each session counts into its own copy without synchronization and
+     * the totals are folded into its cache partition, under the partition lock, on release.
+     */
+    struct WiredTigerCursorCacheStats {
+        WiredTigerCursorCacheStats() : hits(0), misses(0), opened(0) { }
+
+        void add(const WiredTigerCursorCacheStats& other) {
+            hits += other.hits;
+            misses += other.misses;
+            opened += other.opened;
+        }
+
+        long long hits;     // getCursor() served from the cache
+        long long misses;   // getCursor() found nothing cached for the id
+        long long opened;   // cursors actually opened on the WT session
+    };
+
     /**
      * This is a structure that caches 1 cursor for each uri.
      * The idea is that there is a pool of these somewhere.
@@ -80,6 +100,8 @@ namespace mongo {
 
         int cursorsOut() const { return _cursorsOut; }
 
+        const WiredTigerCursorCacheStats& cursorStats() const { return _cursorStats; }
+
         static uint64_t genCursorId();
 
         /**
@@ -91,19 +113,38 @@ namespace mongo {
         friend class WiredTigerSessionCache;
 
         typedef std::vector<WT_CURSOR*> Cursors;
-        typedef std::map<uint64_t, Cursors> CursorMap;
 
+        struct CachedCursors {
+            CachedCursors() : lastUsed(0) { }
+            Cursors cursors;
+            uint64_t lastUsed; // value of _cursorGen when a cursor for this id was last released
+        };
+
+        typedef unordered_map<uint64_t, CachedCursors> CursorMap;
+
+        // Upper bound on idle cursors kept open by one session. Without it a long-lived session
+        // keeps a cursor, and so an open table handle, for every table it ever touched.
+        static const size_t kMaxCachedCursors = 1000;
+
+        // Closes the cached cursors of the least recently used ids until at most half of
+        // kMaxCachedCursors are left.
+        void _evictCursors();
 
         // Used internally by WiredTigerSessionCache
         int _getEpoch() const { return _epoch; }
         int _getCachePartition() const { return _cachePartition; }
 
+        // Hands the counters accumulated since the last call over to the caller.
+        WiredTigerCursorCacheStats _takeCursorStats();
 
         const int _cachePartition;
         const int _epoch;
         WT_SESSION* _session; // owned
         CursorMap _curmap; // owned
+        size_t _cursorsCached;
+        uint64_t _cursorGen;
         int _cursorsOut;
+        WiredTigerCursorCacheStats _cursorStats;
     };
 
     class WiredTigerSessionCache {
@@ -120,31 +161,72 @@ namespace mongo {
 
         void shuttingDown();
 
+        /**
+         * Blocks until everything committed before the call is in the durable log. Concurrent
+         * callers share log syncs through the group commit coordinator.
+         */
+        void waitUntilDurable();
+
+        /**
+         * Appends session and cursor cache counters, summed over all partitions, and the group
+         * commit statistics.
+         */
+        void appendStats(BSONObjBuilder* builder) const;
+
     private:
+        class GroupCommit : public GroupCommitCoordinator {
+        public:
+            explicit GroupCommit(WiredTigerSessionCache* cache) : _cache(cache) { }
+
+        protected:
+            virtual void _syncLog();
+
+        private:
+            WiredTigerSessionCache* const _cache;
+        };
+
         typedef std::vector<WiredTigerSession*> SessionPool;
 
         enum { NumSessionCachePartitions = 64 };
 
         struct SessionCachePartition {
-            SessionCachePartition() : epoch(0) { }
+            SessionCachePartition() : epoch(0), sessionHits(0), sessionMisses(0) { }
             ~SessionCachePartition() {
                 invariant(pool.empty());
             }
 
-            SpinLock lock;
+            mutable SpinLock lock;
             int epoch;
             SessionPool pool;
+
+            // Protected by lock
+            long long sessionHits;
+            long long sessionMisses;
+            WiredTigerCursorCacheStats cursorStats;
+
+            // Keeps neighbouring partitions, which are taken from different CPUs, off each
+            // other's cache lines.
+            char pad[64];
         };
 
+        /**
+         * Picks the partition for a new checkout. Uses the CPU the caller runs on where the
+         * platform can tell, so that threads on one core keep hitting the same, mostly
+         * uncontended, partition; otherwise spreads checkouts round-robin.
+         */
+        static int _pickPartition();
+
 
         WiredTigerKVEngine* _engine; // not owned, might be NULL
         WT_CONNECTION* _conn; // not owned
 
-        // Partitioned cache of WT sessions. The partition key is not important, but it is
-        // important that sessions be returned to the same partition they were taken from in order
-        // to have some form of balance between the partitions.
+        // Partitioned cache of WT sessions, keyed by CPU (see _pickPartition). Sessions are
+        // returned to the partition they were taken from in order to have some form of balance
+        // between the partitions.
         SessionCachePartition _cache[NumSessionCachePartitions];
 
+        GroupCommit _groupCommit;
+
         // Regular operations take it in shared mode. Shutdown sets the _shuttingDown flag and
         // then takes it in exclusive mode. This ensures that all threads, which would return
         // sessions to the cache would leak them.
@@ -184,7 +184,7 @@ namespace mongo {
 
         for ( Map::iterator it = myMap.begin(); it != myMap.end(); ++it ) {
             string uriKey = it->first;
-            Entry& entry = it->second;
+            const Entry& entry = it->second;
 
             BSONObj data;
             {
@@ -201,13 +201,26 @@ namespace mongo {
             c->set_key( c, key.Get() );
             c->set_value( c, value.Get() );
             invariantWTOK( c->insert(c) );
-            entry.dirty = false;
 
             c->reset(c);
         }
 
         invariantWTOK( c->close(c) );
 
+        // Only mark entries clean that haven't changed again since we copied them, so the next
+        // sync writes just the idents that changed in between instead of every one ever dirtied.
+        boost::mutex::scoped_lock lk( _entriesMutex );
+        for ( Map::const_iterator it = myMap.begin(); it != myMap.end(); ++it ) {
+            Map::iterator current = _entries.find( it->first );
+            if ( current == _entries.end() )
+                continue;
+            Entry& entry = current->second;
+            if ( entry.numRecords == it->second.numRecords &&
+                 entry.dataSize == it->second.dataSize ) {
+                entry.dirty = false;
+            }
+        }
+
     }
 
 
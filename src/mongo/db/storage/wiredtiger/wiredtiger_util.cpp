@@ -35,22 +35,43 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 
+#include <algorithm>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <limits>
+#include <vector>
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/unordered_set.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
     using std::string;
 
+    // Longest a single WT_SESSION::compact call made by WiredTigerUtil::compact may run before
+    // the operation is checked for interruption.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCompactChunkSecs, int, 1);
+
+    // Pause between compact calls, to leave I/O for other work on the node.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCompactThrottleMillis, int, 0);
+
+    // Number of key ranges, each read on a thread of its own, WiredTigerUtil::touch splits an
+    // object into.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerTouchThreads, int, 4);
+
     Status wtRCToStatus_slow(int retCode, const char* prefix ) {
         if (retCode == 0)
             return Status::OK();
@@ -290,6 +311,238 @@ namespace mongo {
     }
 
 
+    Status WiredTigerUtil::compact(OperationContext* txn,
+                                   WiredTigerSessionCache* sessionCache,
+                                   const std::string& uri) {
+        WiredTigerSession* session = sessionCache->getSession();
+        ON_BLOCK_EXIT(&WiredTigerSessionCache::releaseSession, sessionCache, session);
+        WT_SESSION* s = session->getSession();
+
+        const std::string config = str::stream()
+            << "timeout=" << std::max(wiredTigerCompactChunkSecs, 1);
+
+        for (int passes = 1; ; ++passes) {
+            Status interrupted = txn->checkForInterruptNoAssert();
+            if (!interrupted.isOK())
+                return interrupted;
+
+            // Each call compacts and checkpoints the object until there is nothing left worth
+            // moving, or until the timeout, keeping the work done so far.
+            const int ret = s->compact(s, uri.c_str(), config.c_str());
+            if (ret == 0) {
+                LOG(1) << "compacted " << uri << " in " << passes << " passes";
+                return Status::OK();
+            }
+            if (ret != ETIMEDOUT)
+                return wtRCToStatus(ret, "compact");
+
+            LOG(2) << "compacting " << uri << ": pass " << passes << " done";
+            if (wiredTigerCompactThrottleMillis > 0)
+                sleepmillis(wiredTigerCompactThrottleMillis);
+        }
+    }
+
+    namespace {
+
+        // Random keys sampled per range boundary, so that the ranges come out about even.
+        const int kTouchSamplesPerRange = 8;
+
+        int compareItems(const WT_ITEM& a, const WT_ITEM& b) {
+            const int cmp = memcmp(a.data, b.data, std::min(a.size, b.size));
+            if (cmp != 0)
+                return cmp;
+            return a.size < b.size ? -1 : (a.size > b.size ? 1 : 0);
+        }
+
+        /**
+         * Work shared by the threads WiredTigerUtil::touch() starts.  Range i runs from
+         * boundaries[i - 1], inclusive, to boundaries[i], exclusive; the first and last ranges
+         * are open ended.  Keys are compared as raw bytes, which is the order WiredTiger keeps
+         * them in since MongoDB never configures a custom collator.
+         */
+        struct TouchState {
+            TouchState(WiredTigerSessionCache* cache, const std::string& uri)
+                : sessionCache(cache), uri(uri), entries(0), bytes(0), done(0), stop(0),
+                  status(Status::OK()) {}
+
+            WiredTigerSessionCache* const sessionCache;
+            const std::string uri;
+            std::vector<std::string> boundaries;
+
+            AtomicInt64 entries;
+            AtomicInt64 bytes;
+            AtomicUInt32 done;
+            AtomicUInt32 stop;
+
+            boost::mutex mutex;
+            Status status;  // first failure of any range, guarded by 'mutex'
+        };
+
+        Status touchRange(TouchState* state, size_t range) {
+            WiredTigerSession* session = state->sessionCache->getSession();
+            ON_BLOCK_EXIT(&WiredTigerSessionCache::releaseSession, state->sessionCache, session);
+            WT_SESSION* s = session->getSession();
+
+            WT_CURSOR* c = NULL;
+            int ret = s->open_cursor(s, state->uri.c_str(), NULL, "raw", &c);
+            if (ret != 0)
+                return wtRCToStatus(ret, "touch");
+            ON_BLOCK_EXIT(c->close, c);
+
+            const bool hasEnd = range < state->boundaries.size();
+            WT_ITEM end = {};
+            if (hasEnd) {
+                end.data = state->boundaries[range].data();
+                end.size = state->boundaries[range].size();
+            }
+
+            if (range == 0) {
+                ret = c->next(c);
+            }
+            else {
+                const std::string& start = state->boundaries[range - 1];
+                WT_ITEM startItem = {};
+                startItem.data = start.data();
+                startItem.size = start.size();
+                c->set_key(c, &startItem);
+                int exact;
+                ret = c->search_near(c, &exact);
+                if (ret == 0 && exact < 0)
+                    ret = c->next(c);
+            }
+
+            long long entries = 0;
+            long long bytes = 0;
+            for (; ret == 0; ret = c->next(c)) {
+                WT_ITEM key;
+                WT_ITEM value;
+                if ((ret = c->get_key(c, &key)) != 0)
+                    break;
+                if (hasEnd && compareItems(key, end) >= 0)
+                    break;
+                if ((ret = c->get_value(c, &value)) != 0)
+                    break;
+
+                ++entries;
+                bytes += key.size + value.size;
+                if (entries % 1024 == 0 && state->stop.load())
+                    break;
+            }
+
+            state->entries.addAndFetch(entries);
+            state->bytes.addAndFetch(bytes);
+            if (ret != 0 && ret != WT_NOTFOUND)
+                return wtRCToStatus(ret, "touch");
+            return Status::OK();
+        }
+
+        void touchWorker(TouchState* state, size_t range) {
+            Status status(ErrorCodes::InternalError, "touch range not read");
+            try {
+                status = touchRange(state, range);
+            }
+            catch (const DBException& e) {
+                status = e.toStatus();
+            }
+
+            if (!status.isOK()) {
+                boost::mutex::scoped_lock lk(state->mutex);
+                if (state->status.isOK())
+                    state->status = status;
+                state->stop.store(1);
+            }
+            state->done.fetchAndAdd(1);
+        }
+
+        /**
+         * Returns up to 'ranges' - 1 sorted, distinct keys of the object, sampled with a random
+         * cursor, to split its key space at.
+         */
+        Status sampleBoundaries(WT_SESSION* s,
+                                const std::string& uri,
+                                int ranges,
+                                std::vector<std::string>* boundaries) {
+            if (ranges <= 1)
+                return Status::OK();
+
+            WT_CURSOR* c = NULL;
+            int ret = s->open_cursor(s, uri.c_str(), NULL, "raw,next_random=true", &c);
+            if (ret != 0)
+                return wtRCToStatus(ret, "touch");
+            ON_BLOCK_EXIT(c->close, c);
+
+            std::vector<std::string> samples;
+            for (int i = 0; i < (ranges - 1) * kTouchSamplesPerRange; i++) {
+                ret = c->next(c);
+                if (ret == WT_NOTFOUND)
+                    return Status::OK(); // empty, one range will do
+                if (ret != 0)
+                    return wtRCToStatus(ret, "touch");
+
+                WT_ITEM key;
+                if ((ret = c->get_key(c, &key)) != 0)
+                    return wtRCToStatus(ret, "touch");
+                samples.push_back(std::string(static_cast<const char*>(key.data), key.size));
+            }
+            std::sort(samples.begin(), samples.end());
+
+            for (size_t i = kTouchSamplesPerRange; i < samples.size(); i += kTouchSamplesPerRange) {
+                if (boundaries->empty() || boundaries->back() != samples[i])
+                    boundaries->push_back(samples[i]);
+            }
+            return Status::OK();
+        }
+
+    } // namespace
+
+    Status WiredTigerUtil::touch(OperationContext* txn,
+                                 WiredTigerSessionCache* sessionCache,
+                                 const std::string& uri,
+                                 BSONObjBuilder* output) {
+        Timer t;
+        TouchState state(sessionCache, uri);
+        {
+            WiredTigerSession* session = sessionCache->getSession();
+            ON_BLOCK_EXIT(&WiredTigerSessionCache::releaseSession, sessionCache, session);
+            Status status = sampleBoundaries(session->getSession(),
+                                             uri,
+                                             std::max(wiredTigerTouchThreads, 1),
+                                             &state.boundaries);
+            if (!status.isOK())
+                return status;
+        }
+
+        const size_t numRanges = state.boundaries.size() + 1;
+        boost::thread_group threads;
+        for (size_t i = 0; i < numRanges; i++) {
+            threads.create_thread(stdx::bind(&touchWorker, &state, i));
+        }
+
+        // The workers have no operation context of their own, so watch for a kill on theirs.
+        while (state.done.load() < numRanges) {
+            if (!txn->checkForInterruptNoAssert().isOK())
+                state.stop.store(1);
+            sleepmillis(10);
+        }
+        threads.join_all();
+
+        Status interrupted = txn->checkForInterruptNoAssert();
+        if (!interrupted.isOK())
+            return interrupted;
+        if (!state.status.isOK())
+            return state.status;
+
+        LOG(1) << "touched " << uri << ": " << state.entries.load() << " entries, "
+               << state.bytes.load() << " bytes in " << numRanges << " ranges";
+        if (output) {
+            output->append("numRanges", static_cast<int>(numRanges));
+            output->append("entries", state.entries.load());
+            output->append("bytes", state.bytes.load());
+            output->append("millis", t.millis());
+        }
+        return Status::OK();
+    }
+
     Status WiredTigerUtil::exportTableToBSON(WT_SESSION* session,
                                              const std::string& uri, const std::string& config,
                                              BSONObjBuilder* bob) {
@@ -44,6 +44,7 @@ namespace mongo {
     class BSONObjBuilder;
     class OperationContext;
     class WiredTigerConfigParser;
+    class WiredTigerSessionCache;
 
     inline bool wt_keeptxnopen() {
         return false;
@@ -167,6 +168,28 @@ namespace mongo {
         static int64_t getIdentSize(WT_SESSION* s,
                                     const std::string& uri );
 
+        /**
+         * Compacts the object at 'uri' on a session of its own, in passes of about
+         * wiredTigerCompactChunkSecs seconds.  Between passes it sleeps for
+         * wiredTigerCompactThrottleMillis and stops with the interruption status if the
+         * operation has been killed.  The caller may hold intent locks only: WiredTiger lets reads
+         * and writes to the object go on while it is compacted.
+         */
+        static Status compact(OperationContext* txn,
+                              WiredTigerSessionCache* sessionCache,
+                              const std::string& uri);
+
+        /**
+         * Reads every entry of the object at 'uri' into the WiredTiger cache.  The key space is
+         * split at randomly sampled keys into wiredTigerTouchThreads ranges, and each range is
+         * scanned in key order on a thread and session of its own.  Appends the number of
+         * ranges, entries and bytes read to 'output' when it is not NULL.
+         */
+        static Status touch(OperationContext* txn,
+                            WiredTigerSessionCache* sessionCache,
+                            const std::string& uri,
+                            BSONObjBuilder* output);
+
     private:
         /**
          * Casts unsigned 64-bit statistics value to T.
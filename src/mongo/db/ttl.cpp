@@ -34,6 +34,11 @@
 
 #include "mongo/db/ttl.h"
 
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
@@ -46,13 +51,18 @@
 #include "mongo/db/catalog/database_catalog_entry.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/delete.h"
 #include "mongo/db/operation_context_impl.h"
-#include "mongo/db/ops/delete.h"
+#include "mongo/db/ops/delete_request.h"
+#include "mongo/db/ops/parsed_delete.h"
+#include "mongo/db/query/get_executor.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -71,6 +81,126 @@ namespace mongo {
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorEnabled, bool, true );
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorSleepSecs, int, 60 ); //used for testing
 
+    // Each TTL index has at most this many documents deleted per pass, so that one collection
+    // with a large backlog neither holds its locks for long, nor delays the other collections.
+    // Zero deletes everything expired in one go.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlDeleteBatchSize, int, 10000 );
+
+    // Upper bound on the TTL deletes per second across all collections. Zero means no limit.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlDeleteMaxPerSecond, int, 0 );
+
+    // After a pass which left expired documents behind, the next one starts after this much
+    // time rather than after ttlMonitorSleepSecs, so that a backlog is worked off continuously.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorBacklogSleepMillis, int, 1000 );
+
+    // Number of threads deleting from different collections at the same time during a pass.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorWorkers, int, 1 );
+
+namespace {
+
+    /**
+     * Reports a value the TTL monitor computes at the end of every pass.
+     */
+    class TTLPassMetric : public ServerStatusMetric {
+    public:
+        explicit TTLPassMetric(const string& name) : ServerStatusMetric(name) { }
+
+        void set(long long value) { _value.store(value); }
+
+        virtual void appendAtLeaf( BSONObjBuilder& b ) const {
+            b.appendNumber( _leafName, _value.load() );
+        }
+
+    private:
+        AtomicInt64 _value;
+    };
+
+    // Number of TTL indexes which still had expired documents at the end of the last pass
+    TTLPassMetric ttlBacklogIndexes("ttl.backlogIndexes");
+
+    // How long ago the oldest document still present at the end of the last pass expired
+    TTLPassMetric ttlOldestExpiredSecs("ttl.oldestExpiredSecs");
+
+    /**
+     * The TTL indexes of one collection, which are processed by one worker together.
+     */
+    struct TTLCollectionWork {
+        string dbName;
+        vector<BSONObj> indexes;
+    };
+
+    /**
+     * State of one pass, shared between the workers.
+     */
+    class TTLPass {
+        MONGO_DISALLOW_COPYING(TTLPass);
+    public:
+        explicit TTLPass(const vector<TTLCollectionWork>& work)
+            : _mutex("TTLPass"),
+              _work(work),
+              _next(0),
+              _deleted(0),
+              _backlogIndexes(0),
+              _oldestExpiredSecs(0) { }
+
+        /**
+         * Returns the next collection to process, or NULL once all of them were handed out.
+         */
+        const TTLCollectionWork* next() {
+            SimpleMutex::scoped_lock lk(_mutex);
+            if (_next == _work.size()) {
+                return NULL;
+            }
+            return &_work[_next++];
+        }
+
+        /**
+         * Accounts for a batch of deletes and sleeps if that exceeds ttlDeleteMaxPerSecond.
+         */
+        void recordDeleted(long long numDeleted) {
+            const int maxPerSecond = ttlDeleteMaxPerSecond;
+
+            long long sleepMillis = 0;
+            {
+                SimpleMutex::scoped_lock lk(_mutex);
+                _deleted += numDeleted;
+
+                if (maxPerSecond > 0) {
+                    const long long dueMillis = _deleted * 1000 / maxPerSecond;
+                    sleepMillis = dueMillis - _timer.millis();
+                }
+            }
+
+            if (sleepMillis > 0) {
+                sleepmillis(sleepMillis);
+            }
+        }
+
+        /**
+         * Records that an index still has expired documents, the oldest of which expired
+         * 'expiredSecs' seconds ago.
+         */
+        void recordBacklog(long long expiredSecs) {
+            SimpleMutex::scoped_lock lk(_mutex);
+            _backlogIndexes++;
+            _oldestExpiredSecs = std::max(_oldestExpiredSecs, expiredSecs);
+        }
+
+        long long backlogIndexes() const { return _backlogIndexes; }
+        long long oldestExpiredSecs() const { return _oldestExpiredSecs; }
+
+    private:
+        SimpleMutex _mutex;
+        const vector<TTLCollectionWork>& _work;
+        size_t _next;
+        Timer _timer;
+        long long _deleted;
+        long long _backlogIndexes;
+        long long _oldestExpiredSecs;
+    };
+
+}  // namespace
+
     class TTLMonitor : public BackgroundJob {
     public:
         TTLMonitor(){}
@@ -84,8 +214,15 @@ namespace mongo {
             Client::initThread( name().c_str() );
             cc().getAuthorizationSession()->grantInternalAuthorization();
 
+            bool hadBacklog = false;
             while ( ! inShutdown() ) {
-                sleepsecs( ttlMonitorSleepSecs );
+                if ( hadBacklog ) {
+                    sleepmillis( ttlMonitorBacklogSleepMillis );
+                }
+                else {
+                    sleepsecs( ttlMonitorSleepSecs );
+                }
+                hadBacklog = false;
 
                 LOG(3) << "TTLMonitor thread awake" << endl;
 
@@ -115,32 +252,80 @@ namespace mongo {
 
                 ttlPasses.increment();
 
+                vector<TTLCollectionWork> work;
                 for ( set<string>::const_iterator i=dbs.begin(); i!=dbs.end(); ++i ) {
-                    string db = *i;
-
                     vector<BSONObj> indexes;
-                    getTTLIndexesForDB(&txn, db, &indexes);
+                    getTTLIndexesForDB(&txn, *i, &indexes);
 
+                    // The indexes come grouped by collection
                     for ( vector<BSONObj>::const_iterator it = indexes.begin();
                           it != indexes.end(); ++it ) {
-
-                        BSONObj idx = *it;
-                        try {
-                            if ( !doTTLForIndex( &txn, db, idx ) ) {
-                                break;  // stop processing TTL indexes on this database
-                            }
-                        } catch (const DBException& dbex) {
-                            error() << "Error processing ttl index: " << idx
-                                    << " -- " << dbex.toString();
-                            // continue on to the next index
-                            continue;
+                        if ( work.empty() || work.back().dbName != *i ||
+                             work.back().indexes.back()["ns"].String() != (*it)["ns"].String() ) {
+                            work.push_back( TTLCollectionWork() );
+                            work.back().dbName = *i;
                         }
+                        work.back().indexes.push_back( *it );
                     }
                 }
+
+                TTLPass pass( work );
+                const size_t numWorkers =
+                    std::min( work.size(), static_cast<size_t>( std::max( 1, ttlMonitorWorkers ) ) );
+
+                if ( numWorkers <= 1 ) {
+                    doTTLForCollections( &txn, &pass );
+                }
+                else {
+                    boost::thread_group workers;
+                    for ( size_t i = 0; i < numWorkers; i++ ) {
+                        workers.create_thread( boost::bind( &TTLMonitor::runWorker, &pass ) );
+                    }
+                    workers.join_all();
+                }
+
+                ttlBacklogIndexes.set( pass.backlogIndexes() );
+                ttlOldestExpiredSecs.set( pass.oldestExpiredSecs() );
+                hadBacklog = pass.backlogIndexes() > 0;
             }
         }
 
     private:
+        static void runWorker( TTLPass* pass ) {
+            Client::initThread( "TTLMonitorWorker" );
+            cc().getAuthorizationSession()->grantInternalAuthorization();
+
+            {
+                OperationContextImpl txn;
+                doTTLForCollections( &txn, pass );
+            }
+
+            cc().shutdown();
+        }
+
+        /**
+         * Processes the collections handed out by 'pass' until there are none left.
+         */
+        static void doTTLForCollections( OperationContext* txn, TTLPass* pass ) {
+            while ( const TTLCollectionWork* coll = pass->next() ) {
+                for ( vector<BSONObj>::const_iterator it = coll->indexes.begin();
+                      it != coll->indexes.end(); ++it ) {
+
+                    const BSONObj& idx = *it;
+                    try {
+                        if ( !doTTLForIndex( txn, coll->dbName, idx, pass ) ) {
+                            break;  // stop processing TTL indexes on this collection
+                        }
+                    } catch (const DBException& dbex) {
+                        error() << "Error processing ttl index: " << idx
+                                << " -- " << dbex.toString();
+                        // continue on to the next index
+                        continue;
+                    }
+                }
+            }
+        }
+
         /**
          * Acquire an IS-mode lock on the specified database and for each
          * collection in the database, append the specification of all
@@ -193,12 +378,13 @@ namespace mongo {
         /**
          * Remove documents from the collection using the specified TTL index
          * after a sufficient amount of time has passed according to its expiry
-         * specification.
+         * specification. At most ttlDeleteBatchSize documents are removed per call.
          *
-         * @return true if caller should continue processing TTL indexes of collections
-         *         on the specified database, and false otherwise
+         * @return true if caller should continue processing TTL indexes of the
+         *         collection, and false otherwise
          */
-        bool doTTLForIndex( OperationContext* txn, const string& dbName, const BSONObj& idx ) {
+        static bool doTTLForIndex( OperationContext* txn, const string& dbName,
+                                   const BSONObj& idx, TTLPass* pass ) {
             BSONObj key = idx["key"].Obj();
             const string ns = idx["ns"].String();
             if ( key.nFields() != 1 ) {
@@ -212,17 +398,23 @@ namespace mongo {
                 return true;
             }
 
+            const string field = key.firstElement().fieldName();
+            const long long expireMs = 1000 * idx[secondsExpireField].numberLong();
+            const long long cutoffMs = curTimeMillis64() - expireMs;
+
             BSONObj query;
             {
                 BSONObjBuilder b;
-                long long expireMs = 1000 * idx[secondsExpireField].numberLong();
-                b.appendDate( "$lt", curTimeMillis64() - expireMs );
-                query = BSON( key.firstElement().fieldName() << b.obj() );
+                b.appendDate( "$lt", cutoffMs );
+                query = BSON( field << b.obj() );
             }
 
             LOG(1) << "TTL -- ns: " << ns << "key:" << key << " query: " << query << endl;
 
+            const long long batchSize = std::max( 0, ttlDeleteBatchSize );
+
             long long numDeleted = 0;
+            long long oldestExpiredMs = -1;
             int attempt = 1;
             while (1) {
                 ScopedTransaction scopedXact(txn, MODE_IX);
@@ -237,7 +429,7 @@ namespace mongo {
                 Collection* collection = db->getCollection( ns );
                 if ( !collection ) {
                     // collection was dropped
-                    return true;
+                    return false;
                 }
 
                 if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(dbName)) {
@@ -253,13 +445,29 @@ namespace mongo {
                 }
 
                 try {
-                    numDeleted = deleteObjects(txn,
-                                               db,
-                                               ns,
-                                               query,
-                                               PlanExecutor::YIELD_AUTO,
-                                               false,
-                                               true);
+                    const NamespaceString nsString( ns );
+                    DeleteRequest request( nsString );
+                    request.setQuery( query );
+                    request.setMulti();
+                    request.setUpdateOpLog();
+                    request.setLimit( batchSize );
+                    request.setYieldPolicy( PlanExecutor::YIELD_AUTO );
+
+                    ParsedDelete parsedDelete( txn, &request );
+                    uassertStatusOK( parsedDelete.parseRequest() );
+
+                    PlanExecutor* rawExec;
+                    uassertStatusOK( getExecutorDelete( txn, collection, &parsedDelete,
+                                                        &rawExec ) );
+                    boost::scoped_ptr<PlanExecutor> exec( rawExec );
+
+                    uassertStatusOK( exec->executePlan() );
+                    numDeleted = DeleteStage::getNumDeleted( exec.get() );
+
+                    // A full batch means there is more to delete, so find out how far behind
+                    if ( batchSize > 0 && numDeleted >= batchSize ) {
+                        oldestExpiredMs = findOldestExpired( txn, collection, field, query );
+                    }
                     break;
                 }
                 catch (const WriteConflictException& dle) {
@@ -269,8 +477,58 @@ namespace mongo {
 
             ttlDeletedDocuments.increment(numDeleted);
             LOG(1) << "\tTTL deleted: " << numDeleted << endl;
+
+            if ( oldestExpiredMs >= 0 ) {
+                pass->recordBacklog( ( cutoffMs - oldestExpiredMs ) / 1000 );
+            }
+            pass->recordDeleted( numDeleted );
             return true;
         }
+
+        /**
+         * Returns the smallest date in 'field' among the documents matching the TTL 'query',
+         * or -1 if there are none left.
+         */
+        static long long findOldestExpired( OperationContext* txn,
+                                            Collection* collection,
+                                            const string& field,
+                                            const BSONObj& query ) {
+            CanonicalQuery* rawCq;
+            uassertStatusOK( CanonicalQuery::canonicalize( collection->ns().ns(),
+                                                           query,
+                                                           BSON( field << 1 ),
+                                                           BSONObj(),
+                                                           &rawCq ) );
+
+            PlanExecutor* rawExec;
+            uassertStatusOK( getExecutor( txn, collection, rawCq, PlanExecutor::YIELD_AUTO,
+                                          &rawExec ) );
+            boost::scoped_ptr<PlanExecutor> exec( rawExec );
+
+            BSONObj doc;
+            if ( PlanExecutor::ADVANCED != exec->getNext( &doc, NULL ) ) {
+                return -1;
+            }
+
+            // The sort key of an array is its smallest element
+            BSONElement value = doc.getFieldDotted( field );
+            if ( value.type() == Date ) {
+                return value.date().millis;
+            }
+
+            long long oldest = -1;
+            if ( value.type() == Array ) {
+                BSONObjIterator it( value.Obj() );
+                while ( it.more() ) {
+                    BSONElement elem = it.next();
+                    if ( elem.type() == Date &&
+                         ( oldest < 0 || static_cast<long long>( elem.date().millis ) < oldest ) ) {
+                        oldest = elem.date().millis;
+                    }
+                }
+            }
+            return oldest;
+        }
     };
 
     void startTTLBackgroundJob() {
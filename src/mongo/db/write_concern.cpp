@@ -36,9 +36,11 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/write_concern_options.h"
+#include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
@@ -52,6 +54,37 @@ namespace mongo {
     static ServerStatusMetricField<Counter64> gleWtimeoutsDisplay("getLastError.wtimeouts",
                                                                   &gleWtimeouts );
 
+namespace {
+
+    // Distribution of the times counted by getLastError.wtime
+    class GleWtimeHistogramMetric : public ServerStatusMetric {
+    public:
+        GleWtimeHistogramMetric()
+            : ServerStatusMetric("getLastError.wtimeHistogram"),
+              _mutex("gleWtimeHistogram") { }
+
+        void recordMillis(long long millis) {
+            SimpleMutex::scoped_lock lk(_mutex);
+            _histogram.record(millis * 1000);
+        }
+
+        virtual void appendAtLeaf(BSONObjBuilder& b) const {
+            BSONObjBuilder histogramBuilder(b.subobjStart(_leafName));
+            {
+                SimpleMutex::scoped_lock lk(_mutex);
+                _histogram.append(&histogramBuilder);
+            }
+            histogramBuilder.doneFast();
+        }
+
+    private:
+        mutable SimpleMutex _mutex;
+        LatencyHistogram _histogram;
+
+    } gleWtimeHistogram;
+
+}  // namespace
+
     Status validateWriteConcern( const WriteConcernOptions& writeConcern ) {
         const bool isJournalEnabled = getGlobalEnvironment()->getGlobalStorageEngine()->isDurable();
 
@@ -201,6 +234,7 @@ namespace mongo {
         // Add stats
         result->writtenTo = repl::getGlobalReplicationCoordinator()->getHostsWrittenTo(replOpTime);
         gleWtimeStats.recordMillis(replStatus.duration.total_milliseconds());
+        gleWtimeHistogram.recordMillis(replStatus.duration.total_milliseconds());
         result->wTime = replStatus.duration.total_milliseconds();
 
         return replStatus.status;
@@ -170,7 +170,7 @@ namespace AccumulatorTests {
                     createAccumulator();
                     accumulator()->process(operand(), false);
                     assertBinaryEqual( expectedResult(),
-                                       fromDocument(accumulator()->getValue(true).getDocument()));
+                                       fromValue(accumulator()->getValue(true)));
                 }
             protected:
                 virtual Value operand() = 0;
@@ -180,19 +180,19 @@ namespace AccumulatorTests {
             /** Shard result for one integer. */
             class Int : public SingleOperandBase {
                 Value operand() { return Value(3); }
-                BSONObj expectedResult() { return BSON( "subTotal" << 3.0 << "count" << 1LL ); }
+                BSONObj expectedResult() { return BSON( "" << BSON_ARRAY( 3.0 << 1LL ) ); }
             };
             
             /** Shard result for one long. */
             class Long : public SingleOperandBase {
                 Value operand() { return Value(5LL); }
-                BSONObj expectedResult() { return BSON( "subTotal" << 5.0 << "count" << 1LL ); }
+                BSONObj expectedResult() { return BSON( "" << BSON_ARRAY( 5.0 << 1LL ) ); }
             };
             
             /** Shard result for one double. */
             class Double : public SingleOperandBase {
                 Value operand() { return Value(116.0); }
-                BSONObj expectedResult() { return BSON( "subTotal" << 116.0 << "count" << 1LL ); }
+                BSONObj expectedResult() { return BSON( "" << BSON_ARRAY( 116.0 << 1LL ) ); }
             };
 
             class TwoOperandBase : public Base {
@@ -211,7 +211,7 @@ namespace AccumulatorTests {
                     accumulator()->process(a, false);
                     accumulator()->process(b, false);
                     assertBinaryEqual(expectedResult(),
-                                      fromDocument(accumulator()->getValue(true).getDocument()));
+                                      fromValue(accumulator()->getValue(true)));
                 }
             };
 
@@ -220,7 +220,7 @@ namespace AccumulatorTests {
                 Value operand1() { return Value(numeric_limits<int>::max()); }
                 Value operand2() { return Value(3); }
                 BSONObj expectedResult() {
-                    return BSON( "subTotal" << numeric_limits<int>::max() + 3.0 << "count" << 2LL );
+                    return BSON( "" << BSON_ARRAY( numeric_limits<int>::max() + 3.0 << 2LL ) );
                 }
             };
 
@@ -228,21 +228,21 @@ namespace AccumulatorTests {
             class IntLong : public TwoOperandBase {
                 Value operand1() { return Value(5); }
                 Value operand2() { return Value(3LL); }
-                BSONObj expectedResult() { return BSON( "subTotal" << 8.0 << "count" << 2LL ); }
+                BSONObj expectedResult() { return BSON( "" << BSON_ARRAY( 8.0 << 2LL ) ); }
             };
             
             /** Shard avg an int and a double. */
             class IntDouble : public TwoOperandBase {
                 Value operand1() { return Value(5); }
                 Value operand2() { return Value(6.2); }
-                BSONObj expectedResult() { return BSON( "subTotal" << 11.2 << "count" << 2LL ); }
+                BSONObj expectedResult() { return BSON( "" << BSON_ARRAY( 11.2 << 2LL ) ); }
             };
             
             /** Shard avg a long and a double. */
             class LongDouble : public TwoOperandBase {
                 Value operand1() { return Value(5LL); }
                 Value operand2() { return Value(1.0); }
-                BSONObj expectedResult() { return BSON( "subTotal" << 6.0 << "count" << 2LL ); }
+                BSONObj expectedResult() { return BSON( "" << BSON_ARRAY( 6.0 << 2LL ) ); }
             };
 
             /** Shard avg an int, long, and double. */
@@ -253,8 +253,8 @@ namespace AccumulatorTests {
                     accumulator()->process(Value(1), false);
                     accumulator()->process(Value(2LL), false);
                     accumulator()->process(Value(4.0), false);
-                    assertBinaryEqual(BSON( "subTotal" << 7.0 << "count" << 3LL ),
-                                      fromDocument(accumulator()->getValue(true).getDocument()));
+                    assertBinaryEqual(BSON( "" << BSON_ARRAY( 7.0 << 3LL ) ),
+                                      fromValue(accumulator()->getValue(true)));
                 }
             };
 
@@ -284,6 +284,19 @@ namespace AccumulatorTests {
                 }
             };
 
+            /** Router result from a shard sending the [total, count] pair and one sending the
+                document form. */
+            class CompactAndDocumentShards : public Base {
+            public:
+                void run() {
+                    createAccumulator();
+                    accumulator()->process(Value(BSON_ARRAY(6.0 << 1LL)), true);
+                    accumulator()->process(Value(DOC("subTotal" << 5.0 << "count" << 2LL)), true);
+                    assertBinaryEqual( BSON( "" << 11.0 / 3 ),
+                                       fromValue( accumulator()->getValue(false) ) );
+                }
+            };
+
         } // namespace Router
         
     } // namespace Avg
@@ -864,6 +877,7 @@ namespace AccumulatorTests {
             add<Avg::Shard::IntLongDouble>();
             add<Avg::Router::OneShard>();
             add<Avg::Router::TwoShards>();
+            add<Avg::Router::CompactAndDocumentShards>();
 
             add<First::None>();
             add<First::One>();
@@ -797,6 +797,31 @@ namespace DocumentSourceTests {
             virtual string expectedResultSetString() { return "[{_id:null,sum:110}]"; }
         };
 
+        /** Every accumulator with a column form, over several keys including an empty group. */
+        class ColumnarAccumulators : public CheckResultsBase {
+            void populateData() {
+                client.insert( ns, BSON( "id" << 0 << "a" << 1 ) );
+                client.insert( ns, BSON( "id" << 1 << "a" << 2 ) );
+                client.insert( ns, BSON( "id" << 0 << "a" << 3 ) );
+                client.insert( ns, BSON( "id" << 1 << "a" << 4 ) );
+                client.insert( ns, BSON( "id" << 2 ) );
+            }
+            virtual BSONObj groupSpec() {
+                return BSON( "_id" << "$id"
+                             << "sum" << BSON( "$sum" << "$a" )
+                             << "avg" << BSON( "$avg" << "$a" )
+                             << "min" << BSON( "$min" << "$a" )
+                             << "max" << BSON( "$max" << "$a" )
+                             << "first" << BSON( "$first" << "$a" )
+                             << "last" << BSON( "$last" << "$a" ) );
+            }
+            virtual string expectedResultSetString() {
+                return "[{_id:0,sum:4,avg:2,min:1,max:3,first:1,last:3},"
+                        "{_id:1,sum:6,avg:3,min:2,max:4,first:2,last:4},"
+                        "{_id:2,sum:0,avg:0,min:null,max:null,first:null,last:null}]";
+            }
+        };
+
         /** A complex _id expression. */
         class ComplexId : public CheckResultsBase {
             void populateData() {
@@ -1934,6 +1959,7 @@ namespace DocumentSourceTests {
             add<DocumentSourceGroup::FourValuesTwoKeys>();
             add<DocumentSourceGroup::FourValuesTwoKeysTwoAccumulators>();
             add<DocumentSourceGroup::GroupNullUndefinedIds>();
+            add<DocumentSourceGroup::ColumnarAccumulators>();
             add<DocumentSourceGroup::ComplexId>();
             add<DocumentSourceGroup::UndefinedAccumulatorValue>();
             add<DocumentSourceGroup::RouterMerger>();
@@ -31,6 +31,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_storage_pool.h"
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/dbtests/dbtests.h"
@@ -341,6 +342,121 @@ namespace DocumentTests {
             }
         };
 
+        /** Document buffers are recycled through the current DocumentStoragePool. */
+        class StoragePool {
+        public:
+            void run() {
+                BSONObj bson = BSON( "a" << 1 << "b" << "x" << "c" << BSON( "d" << 2 ) );
+                Document outlivesPool;
+                {
+                    mongo::DocumentStoragePool pool;
+                    mongo::DocumentStoragePool::Scope scope( &pool );
+                    {
+                        Document first = fromBson( bson );
+                        outlivesPool = fromBson( bson );
+                        ASSERT_EQUALS( 0U, pool.cachedBytes() );
+                    }
+                    // 'first' and its nested document returned their buffers
+                    const size_t cached = pool.cachedBytes();
+                    ASSERT_GREATER_THAN( cached, 0U );
+
+                    Document second = fromBson( bson );
+                    ASSERT_EQUALS( 0U, pool.cachedBytes() );
+                    ASSERT_EQUALS( bson, second.toBson() );
+
+                    MutableDocument md( second );
+                    md.addField( "e", mongo::Value( 3 ) );
+                    ASSERT_EQUALS( 4U, md.peek().size() );
+                }
+                // Documents freed outside of any scope go back to the heap
+                ASSERT_EQUALS( bson, outlivesPool.toBson() );
+                outlivesPool = Document();
+            }
+        };
+
+        /** A lazily converted Document behaves like one converted up front. */
+        class Lazy {
+        public:
+            void run() {
+                BSONObj bson = BSON( "a" << 1 <<
+                                     "b" << BSON( "c" << "x" << "d" << BSON( "e" << 2 ) ) <<
+                                     "f" << BSON_ARRAY( BSON( "g" << 3 ) << 4 ) <<
+                                     "$textScore" << 5.5 );
+                Document eager = Document::fromBsonWithMetaData( bson );
+
+                Document lazy = Document::fromBsonLazily( bson, bson.sharedBuffer(), true );
+                ASSERT_EQUALS( 0, Document::compare( eager, lazy ) );
+                ASSERT_EQUALS( 5.5, lazy.getTextScore() );
+                ASSERT_EQUALS( bson, lazy.toBsonWithMetaData() );
+
+                // Nested documents outlive the Document they were read from
+                mongo::Value nested;
+                {
+                    BSONObj copy = bson.copy();
+                    Document other = Document::fromBsonLazily( copy, copy.sharedBuffer(), false );
+                    nested = other["b"];
+                    ASSERT( other.hasTextScore() == false );
+                    ASSERT_EQUALS( 4U, other.size() );
+                }
+                ASSERT_EQUALS( 2, nested.getDocument().getNestedField( FieldPath( "d.e" ) )
+                                      .getInt() );
+                ASSERT_EQUALS( 3, eager["f"][0]["g"].getInt() );
+
+                Document modifiedLazy = Document::fromBsonLazily( bson, bson.sharedBuffer(), true );
+                MutableDocument md( modifiedLazy );
+                md.setField( "a", mongo::Value( 10 ) );
+                md.setNestedField( FieldPath( "b.d.e" ), mongo::Value( 20 ) );
+                Document modified = md.freeze();
+                ASSERT_EQUALS( 10, modified["a"].getInt() );
+                ASSERT_EQUALS( 20, modified.getNestedField( FieldPath( "b.d.e" ) ).getInt() );
+                ASSERT_EQUALS( "x", modified.getNestedField( FieldPath( "b.c" ) ).getString() );
+                ASSERT_EQUALS( 5.5, modified.getTextScore() );
+            }
+        };
+
+        class Overlay {
+        public:
+            void run() {
+                Document base = fromBson( fromjson( "{a: 1, b: {c: 'x', d: [1, 2]}, e: 3}" ) );
+                vector<Position> positions;
+                ASSERT_EQUALS( 2U, base.getNestedField( FieldPath( "b.d" ), &positions )
+                                       .getArrayLength() );
+
+                Document first = Document::overlay( base, positions, mongo::Value( 1 ) );
+                Document second = Document::overlay( base, positions, mongo::Value( 2 ) );
+
+                // Single fields read through to the base, without copying it.
+                ASSERT_EQUALS( 1, first["a"].getInt() );
+                ASSERT_EQUALS( 1, first.getNestedField( FieldPath( "b.d" ) ).getInt() );
+                ASSERT_EQUALS( 2, second.getNestedField( FieldPath( "b.d" ) ).getInt() );
+                ASSERT_EQUALS( "x", second.getNestedField( FieldPath( "b.c" ) ).getString() );
+                ASSERT( first["missing"].missing() );
+
+                // Reading the whole document or changing it copies the fields.
+                ASSERT_EQUALS( fromjson( "{a: 1, b: {c: 'x', d: 1}, e: 3}" ), first.toBson() );
+                MutableDocument md( second );
+                md.setField( "e", mongo::Value( 4 ) );
+                md.setNestedField( FieldPath( "b.c" ), mongo::Value( "y" ) );
+                ASSERT_EQUALS( fromjson( "{a: 1, b: {c: 'y', d: 2}, e: 4}" ), md.freeze().toBson() );
+
+                // None of this changes the base or the other overlays.
+                ASSERT_EQUALS( fromjson( "{a: 1, b: {c: 'x', d: 2}, e: 3}" ), second.toBson() );
+                ASSERT_EQUALS( fromjson( "{a: 1, b: {c: 'x', d: [1, 2]}, e: 3}" ), base.toBson() );
+
+                // Overlays of overlays, as two $unwind stages produce.
+                Document top = fromBson( fromjson( "{a: [1, 2], b: [3, 4]}" ) );
+                vector<Position> aPos;
+                vector<Position> bPos;
+                top.getNestedField( FieldPath( "a" ), &aPos );
+                top.getNestedField( FieldPath( "b" ), &bPos );
+                Document both = Document::overlay( Document::overlay( top, aPos,
+                                                                      mongo::Value( 2 ) ),
+                                                   bPos, mongo::Value( 3 ) );
+                ASSERT_EQUALS( 2, both["a"].getInt() );
+                ASSERT_EQUALS( fromjson( "{a: 2, b: 3}" ), both.toBson() );
+            }
+        };
+
         class AllTypesDoc {
         public:
             void run() {
@@ -1212,6 +1328,12 @@ namespace DocumentTests {
                 assertComparison( 0, 5, 5LL );
                 assertComparison( 0, -2, -2.0 );
                 assertComparison( 0, 90LL, 90.0 );
+                assertComparison( 0, -0.0, 0 );
+                assertComparison( 0, 1LL << 60, static_cast<double>( 1LL << 60 ) );
+                assertComparison( 1, ( 1LL << 53 ) + 1, 1LL << 53 );
+                assertComparison( 1, ( 1LL << 53 ) + 1, static_cast<double>( 1LL << 53 ) );
+                assertComparison( 1, 1e19, numeric_limits<long long>::max() );
+                assertComparison( -1, -1e19, numeric_limits<long long>::min() );
                 assertComparison( -1, 5, 6LL );
                 assertComparison( -1, -2, 2.1 );
                 assertComparison( 1, 90LL, 89.999 );
@@ -1332,6 +1454,10 @@ namespace DocumentTests {
                 ASSERT_EQUALS( expectedResult, cmp( a, b ) );
                 ASSERT_EQUALS( -expectedResult, cmp( b, a ) );
 
+                // operator== agrees with compare()
+                ASSERT_EQUALS( expectedResult == 0, a == b );
+                ASSERT_EQUALS( expectedResult == 0, b == a );
+
                 if ( expectedResult == 0 ) {
                     // equal values must hash equally.
                     ASSERT_EQUALS( hash( a ), hash( b ) );
@@ -1424,6 +1550,9 @@ namespace DocumentTests {
             add<Document::FieldIteratorEmpty>();
             add<Document::FieldIteratorSingle>();
             add<Document::FieldIteratorMultiple>();
+            add<Document::StoragePool>();
+            add<Document::Lazy>();
+            add<Document::Overlay>();
             add<Document::AllTypesDoc>();
 
             add<Value::BSONArrayTest>();
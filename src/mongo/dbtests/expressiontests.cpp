@@ -32,6 +32,7 @@
 
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_program.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace ExpressionTests {
@@ -887,6 +888,110 @@ namespace ExpressionTests {
         
     } // namespace Compare
     
+    namespace Compiled {
+
+        /** The compiled form must give the same results and errors as the expression tree. */
+        class ExpectedResultBase {
+        public:
+            virtual ~ExpectedResultBase() {}
+            void run() {
+                BSONObj specObject = BSON( "" << spec() );
+                BSONElement specElement = specObject.firstElement();
+                VariablesIdGenerator idGenerator;
+                VariablesParseState vps(&idGenerator);
+                intrusive_ptr<Expression> tree =
+                        Expression::parseOperand(specElement, vps)->optimize();
+                intrusive_ptr<Expression> compiled = ExpressionCompiled::create(tree);
+                ASSERT( compiled != tree );
+                ASSERT_EQUALS( expressionToBson( tree ), expressionToBson( compiled ) );
+
+                const vector<BSONObj> inputs = documents();
+                for (size_t i = 0; i < inputs.size(); ++i) {
+                    const Document input = fromBson( inputs[i] );
+                    int treeCode = 0;
+                    BSONObj treeResult;
+                    try {
+                        treeResult = toBson( tree->evaluate( input ) );
+                    }
+                    catch (const UserException& e) {
+                        treeCode = e.getCode();
+                    }
+
+                    int compiledCode = 0;
+                    BSONObj compiledResult;
+                    try {
+                        compiledResult = toBson( compiled->evaluate( input ) );
+                    }
+                    catch (const UserException& e) {
+                        compiledCode = e.getCode();
+                    }
+
+                    ASSERT_EQUALS( treeCode, compiledCode );
+                    if (!treeCode) {
+                        assertBinaryEqual( treeResult, compiledResult );
+                    }
+                }
+            }
+        protected:
+            virtual BSONObj spec() = 0;
+            virtual vector<BSONObj> documents() {
+                vector<BSONObj> docs;
+                docs.push_back( BSON( "a" << 1 << "b" << 2 << "c" << 3 ) );
+                docs.push_back( BSON( "a" << numeric_limits<int>::max() << "b" << 2 << "c" << 1 ) );
+                docs.push_back( BSON( "a" << 1LL << "b" << 2.5 << "c" << -3 ) );
+                docs.push_back( BSON( "a" << 7.5 << "b" << 0 << "c" << 0.0 ) );
+                docs.push_back( BSON( "a" << BSONNULL << "b" << 2 << "c" << 3 ) );
+                docs.push_back( BSON( "b" << 2 << "c" << 3 ) );
+                docs.push_back( BSON( "a" << Date_t(1000) << "b" << 2 << "c" << 3 ) );
+                docs.push_back( BSON( "a" << "x" << "b" << "y" << "c" << 3 ) );
+                docs.push_back( BSON( "a" << true << "b" << 2 << "c" << 3 ) );
+                return docs;
+            }
+        };
+
+        class Arithmetic : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON( "$add" << BSON_ARRAY( "$a"
+                                                   << BSON( "$multiply" << BSON_ARRAY( "$b" << 2 ) )
+                                                   << BSON( "$subtract" << BSON_ARRAY( "$c" << 1.5 ) ) ) );
+            }
+        };
+
+        class DivideAndMod : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON( "$divide" << BSON_ARRAY( BSON( "$mod" << BSON_ARRAY( "$a" << "$c" ) )
+                                                      << "$b" ) );
+            }
+        };
+
+        /** A null operand must stop $add before an operand that would fail. */
+        class ShortCircuit : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON( "$add" << BSON_ARRAY( "$a"
+                                                   << BSON( "$divide" << BSON_ARRAY( "$c" << 0 ) ) ) );
+            }
+        };
+
+        class CompareAndConcat : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON( "$cmp" << BSON_ARRAY(
+                                 BSON( "$concat" << BSON_ARRAY( "$a" << "-" << "$b" ) )
+                                 << "x-y" ) );
+            }
+        };
+
+        /** Operators without a bytecode form run through the tree inside the program. */
+        class MixedWithTree : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON( "$gt" << BSON_ARRAY(
+                                 BSON( "$add" << BSON_ARRAY( BSON( "$ifNull" << BSON_ARRAY( "$a" << 0 ) )
+                                                             << "$b" ) )
+                                 << 3 ) );
+            }
+        };
+
+    } // namespace Compiled
+
     namespace Constant {
 
         /** Create an ExpressionConstant from a Value. */
@@ -3543,6 +3648,11 @@ namespace ExpressionTests {
             add<Compare::OptimizeGte>();
             add<Compare::OptimizeGteReverse>();
 
+            add<Compiled::Arithmetic>();
+            add<Compiled::DivideAndMod>();
+            add<Compiled::ShortCircuit>();
+            add<Compiled::CompareAndConcat>();
+            add<Compiled::MixedWithTree>();
             add<Constant::Create>();
             add<Constant::CreateFromBsonElement>();
             add<Constant::Optimize>();
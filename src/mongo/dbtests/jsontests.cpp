@@ -2675,6 +2675,67 @@ namespace JsonTests {
             }
         };
 
+        class LongStringWithEscapes : public Base {
+            virtual BSONObj bson() const {
+                BSONObjBuilder b;
+                b.append("a", string(100, 'x') + "\"" + string(9, 'y') + "\\\n" + string(7, 'z'));
+                return b.obj();
+            }
+            virtual string json() const {
+                return "{ \"a\" : \"" + string(100, 'x') + "\\\"" + string(9, 'y') +
+                    "\\\\\\n" + string(7, 'z') + "\" }";
+            }
+        };
+
+        class LongIntegers : public Base {
+            virtual BSONObj bson() const {
+                BSONObjBuilder b;
+                b.append("a", 123456789012345678LL);
+                b.append("b", numeric_limits<int>::min());
+                b.append("c", 1234567890123456789LL);
+                return b.obj();
+            }
+            virtual string json() const {
+                return "{ \"a\" : 123456789012345678, \"b\" : -2147483648, "
+                    "\"c\" : 1234567890123456789 }";
+            }
+        };
+
+        class Stream {
+        public:
+            void run() {
+                JSONStreamParser parser("{ a : 1 }{\"b\":\"x\"}\n  { c : [ 1, { d : 2 } ] }\n");
+                BufBuilder buf;
+                BSONObj doc;
+
+                ASSERT(parser.more());
+                ASSERT_OK(parser.next(&buf, &doc));
+                ASSERT_EQUALS(BSON("a" << 1), doc);
+                ASSERT(parser.more());
+                ASSERT_OK(parser.next(&buf, &doc));
+                ASSERT_EQUALS(BSON("b" << "x"), doc);
+                ASSERT(parser.more());
+                ASSERT_OK(parser.next(&buf, &doc));
+                ASSERT_EQUALS(BSON("c" << BSON_ARRAY(1 << BSON("d" << 2))), doc);
+                ASSERT(!parser.more());
+            }
+        };
+
+        class StreamBadDocument {
+        public:
+            void run() {
+                JSONStreamParser parser("{ a : 1 } { b : }");
+                BufBuilder buf;
+                BSONObj doc;
+
+                ASSERT_OK(parser.next(&buf, &doc));
+                ASSERT(parser.more());
+                int offset = parser.offset();
+                ASSERT_EQUALS(ErrorCodes::FailedToParse, parser.next(&buf, &doc).code());
+                ASSERT_EQUALS(offset, parser.offset());
+            }
+        };
+
     } // namespace FromJsonTests
 
     class All : public Suite {
@@ -2938,6 +2999,10 @@ namespace JsonTests {
             add< FromJsonTests::NullFieldUnquoted >();
             add< FromJsonTests::MinKey >();
             add< FromJsonTests::MaxKey >();
+            add< FromJsonTests::LongStringWithEscapes >();
+            add< FromJsonTests::LongIntegers >();
+            add< FromJsonTests::Stream >();
+            add< FromJsonTests::StreamBadDocument >();
         }
     };
 
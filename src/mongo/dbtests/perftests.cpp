@@ -63,6 +63,7 @@
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mmap.h"
+#include "mongo/util/string_map.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
 #include "mongo/util/version_reporting.h"
@@ -986,6 +987,35 @@ namespace PerfTests {
         virtual bool showDurStats() { return false; }
     };
 
+    // lookups in a StringMap holding about as many keys as a large projection or update has
+    // field names, half of them hits
+    class StringMapLookup : public B {
+    public:
+        virtual int howLongMillis() { return 2000; }
+        string name() { return "stringmap-lookup"; }
+        void prep() {
+            char buf[32];
+            for ( int i = 0; i < 1000; i++ ) {
+                sprintf( buf, "field%d", i );
+                _keys.push_back( buf );
+                if ( i % 2 == 0 )
+                    _map[buf] = i;
+            }
+            _next = 0;
+        }
+        void timed() {
+            if ( _map.find( _keys[_next] ) != _map.end() )
+                dontOptimizeOutHopefully++;
+            if ( ++_next == _keys.size() )
+                _next = 0;
+        }
+        virtual bool showDurStats() { return false; }
+    private:
+        StringMap<int> _map;
+        vector<string> _keys;
+        size_t _next;
+    };
+
     class Compress : public B {
     public:
         const unsigned sz;
@@ -1447,6 +1477,7 @@ namespace PerfTests {
 #endif
                 add< New8 >();
                 add< New128 >();
+                add< StringMapLookup >();
                 add< Throw< thr1 > >();
                 add< Throw< thr2 > >();
                 add< Throw< thr3 > >();
@@ -238,6 +238,100 @@ namespace PipelineTests {
     namespace Optimizations {
         using namespace mongo;
 
+        namespace Local {
+            class Base {
+            public:
+                // These return json arrays of pipeline operators
+                virtual string inputPipeJson() = 0;
+                virtual string outputPipeJson() = 0;
+
+                BSONObj pipelineFromJsonArray(const string& array) {
+                    return fromjson("{pipeline: " + array + "}");
+                }
+                virtual void run() {
+                    const BSONObj inputBson = pipelineFromJsonArray(inputPipeJson());
+                    const BSONObj outputPipeExpected = pipelineFromJsonArray(outputPipeJson());
+
+                    intrusive_ptr<ExpressionContext> ctx =
+                        new ExpressionContext(&_opCtx, NamespaceString("a.collection"));
+                    string errmsg;
+                    intrusive_ptr<Pipeline> outputPipe =
+                        Pipeline::parseCommand(errmsg, inputBson, ctx);
+                    ASSERT_EQUALS(errmsg, "");
+                    ASSERT(outputPipe != NULL);
+
+                    ASSERT_EQUALS(outputPipe->serialize()["pipeline"],
+                                  Value(outputPipeExpected["pipeline"]));
+                }
+
+                virtual ~Base() {};
+
+            private:
+                OperationContextImpl _opCtx;
+            };
+
+            namespace moveMatchBeforePathPreservingStages {
+
+                class RenamedField : public Base {
+                    string inputPipeJson() {
+                        return "[{$project: {x: '$a', b: true}}, {$match: {x: 1, b: 2}}]";
+                    }
+                    string outputPipeJson() {
+                        return "[{$match: {$and: [{a: 1}, {b: 2}]}},"
+                               " {$project: {x: '$a', b: true}}]";
+                    }
+                };
+
+                class ComputedFieldStays : public Base {
+                    string inputPipeJson() {
+                        return "[{$project: {x: {$add: ['$a', 1]}}}, {$match: {x: 2}}]";
+                    }
+                    string outputPipeJson() {
+                        return "[{$project: {x: {$add: ['$a', {$const: 1}]}}}, {$match: {x: 2}}]";
+                    }
+                };
+
+                class ExcludedIdStays : public Base {
+                    string inputPipeJson() {
+                        return "[{$project: {_id: false, a: true}}, {$match: {_id: 1}}]";
+                    }
+                    string outputPipeJson() {
+                        return "[{$project: {_id: false, a: true}}, {$match: {_id: 1}}]";
+                    }
+                };
+
+                class SplitAcrossUnwind : public Base {
+                    string inputPipeJson() {
+                        return "[{$unwind: '$a'}, {$match: {'a.b': 1, c: 2}}]";
+                    }
+                    string outputPipeJson() {
+                        return "[{$match: {c: 2}}, {$unwind: '$a'}, {$match: {'a.b': 1}}]";
+                    }
+                };
+
+                class OrMovesOnlyAsWhole : public Base {
+                    string inputPipeJson() {
+                        return "[{$unwind: '$a'}, {$match: {$or: [{a: 1}, {b: 1}]}}]";
+                    }
+                    string outputPipeJson() {
+                        return "[{$unwind: '$a'}, {$match: {$or: [{a: 1}, {b: 1}]}}]";
+                    }
+                };
+
+                class ThroughSeveralStages : public Base {
+                    string inputPipeJson() {
+                        return "[{$project: {a: true, b: true}}, {$unwind: '$a'},"
+                               " {$sort: {b: 1}}, {$match: {b: 5}}]";
+                    }
+                    string outputPipeJson() {
+                        return "[{$match: {b: 5}}, {$project: {a: true, b: true}},"
+                               " {$unwind: '$a'}, {$sort: {b: 1}}]";
+                    }
+                };
+
+            } // namespace moveMatchBeforePathPreservingStages
+        } // namespace Local
+
         namespace Sharded {
             class Base {
             public:
@@ -425,6 +519,13 @@ namespace PipelineTests {
             add<FieldPath::Tail>();
             add<FieldPath::TailThreeFields>();
 
+            add<Optimizations::Local::moveMatchBeforePathPreservingStages::RenamedField>();
+            add<Optimizations::Local::moveMatchBeforePathPreservingStages::ComputedFieldStays>();
+            add<Optimizations::Local::moveMatchBeforePathPreservingStages::ExcludedIdStays>();
+            add<Optimizations::Local::moveMatchBeforePathPreservingStages::SplitAcrossUnwind>();
+            add<Optimizations::Local::moveMatchBeforePathPreservingStages::OrMovesOnlyAsWhole>();
+            add<Optimizations::Local::moveMatchBeforePathPreservingStages::ThroughSeveralStages>();
+
             add<Optimizations::Sharded::Empty>();
             add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::OneUnwind>();
             add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::TwoUnwind>();
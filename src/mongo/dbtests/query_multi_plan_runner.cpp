@@ -28,6 +28,7 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/dbdirectclient.h"
@@ -164,6 +165,14 @@ namespace QueryMultiPlanRunner {
             ASSERT(mps->bestPlanChosen());
             ASSERT_EQUALS(0, mps->bestPlanIdx());
 
+            // The collection scan fell far enough behind to stop being worked before the index
+            // scan reached the result limit.
+            OwnedPointerVector<PlanStageStats> losingStats;
+            losingStats.mutableVector() = mps->generateCandidateStats();
+            ASSERT_EQUALS(1U, losingStats.size());
+            scoped_ptr<PlanStageStats> winningStats(mps->getStats());
+            ASSERT_LESS_THAN(losingStats[0]->common.works, winningStats->common.works);
+
             // Takes ownership of arguments other than 'collection'.
             PlanExecutor* rawExec;
             Status status = PlanExecutor::make(&_txn, sharedWs.release(), mps, cq, coll,
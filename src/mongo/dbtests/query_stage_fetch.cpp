@@ -42,6 +42,9 @@
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/storage/record_fetcher.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace QueryStageFetch {
@@ -49,6 +52,7 @@ namespace QueryStageFetch {
     using boost::shared_ptr;
     using std::auto_ptr;
     using std::set;
+    using std::vector;
 
     class QueryStageFetchBase {
     public:
@@ -209,6 +213,97 @@ namespace QueryStageFetch {
         }
     };
 
+    //
+    // Test that reading ahead returns results in the child's order and handles invalidation of
+    // a queued result.
+    //
+    class FetchStageReadAhead : public QueryStageFetchBase {
+    public:
+        FetchStageReadAhead() : _oldReadAheadDocs(internalQueryExecFetchReadAheadDocs) {
+            internalQueryExecFetchReadAheadDocs = 3;
+        }
+
+        virtual ~FetchStageReadAhead() {
+            internalQueryExecFetchReadAheadDocs = _oldReadAheadDocs;
+        }
+
+        void run() {
+            Client::WriteContext ctx(&_txn, ns());
+            Database* db = ctx.ctx().db();
+            Collection* coll = db->getCollection(ns());
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            WorkingSet ws;
+
+            for (int i = 0; i < 5; ++i) {
+                insert(BSON("foo" << i));
+            }
+            set<RecordId> locs;
+            getLocs(&locs, coll);
+            ASSERT_EQUALS(size_t(5), locs.size());
+
+            auto_ptr<QueuedDataStage> mockStage(new QueuedDataStage(&ws));
+            vector<RecordId> order;
+            vector<BSONObj> expected;
+            for (set<RecordId>::const_iterator it = locs.begin(); it != locs.end(); ++it) {
+                WorkingSetMember mockMember;
+                mockMember.state = WorkingSetMember::LOC_AND_IDX;
+                mockMember.loc = *it;
+                mockStage->pushBack(mockMember);
+                order.push_back(*it);
+                expected.push_back(coll->docFor(&_txn, *it).getOwned());
+            }
+
+            auto_ptr<FetchStage> fetchStage(new FetchStage(&_txn, &ws, mockStage.release(),
+                                                           NULL, coll));
+
+            vector<BSONObj> results;
+            bool invalidated = false;
+            while (!fetchStage->isEOF()) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = fetchStage->work(&id);
+
+                if (PlanStage::NEED_FETCH == state) {
+                    WorkingSetMember* member = ws.get(id);
+                    auto_ptr<RecordFetcher> fetcher(member->releaseFetcher());
+                    fetcher->setup();
+                    fetcher->fetch();
+                }
+                else if (PlanStage::ADVANCED == state) {
+                    results.push_back(ws.get(id)->obj.getOwned());
+
+                    // After the first result, the third is queued waiting to be fetched.
+                    if (!invalidated) {
+                        fetchStage->invalidate(&_txn, order[2], INVALIDATION_DELETION);
+                        invalidated = true;
+                    }
+                }
+            }
+
+            ASSERT_EQUALS(expected.size(), results.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_EQUALS(expected[i], results[i]);
+            }
+
+            const FetchStats* stats =
+                static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+            if (coll->getRecordStore()->supportsPrefetch()) {
+                ASSERT_EQUALS(size_t(5), stats->docsPrefetched);
+                ASSERT_EQUALS(size_t(1), stats->forcedFetches);
+            }
+            else {
+                ASSERT_EQUALS(size_t(0), stats->docsPrefetched);
+            }
+        }
+
+    private:
+        const int _oldReadAheadDocs;
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "query_stage_fetch" ) { }
@@ -216,6 +311,7 @@ namespace QueryStageFetch {
         void setupTests() {
             add<FetchStageAlreadyFetched>();
             add<FetchStageFilter>();
+            add<FetchStageReadAhead>();
         }
     };
 
@@ -155,6 +155,58 @@ namespace QueryStageSubplan {
         }
     };
 
+    /**
+     * Test that a branch with the same shape as an earlier branch is not planned on its own,
+     * and that the composite plan still returns the documents matching every branch.
+     */
+    class QueryStageSubplanSameShapeBranches : public QueryStageSubplanBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(&_txn, ns());
+
+            addIndex(BSON("a" << 1 << "b" << 1));
+            addIndex(BSON("a" << 1 << "c" << 1));
+            addIndex(BSON("c" << 1));
+
+            for (int i = 0; i < 10; i++) {
+                insert(BSON("a" << 1 << "b" << i << "c" << i));
+            }
+
+            BSONObj query = fromjson("{$or: [{a: 1, b: 3}, {c: 5}, {a: 1, b: 4}]}");
+
+            Collection* collection = ctx.getCollection();
+
+            CanonicalQuery* rawCq;
+            ASSERT_OK(CanonicalQuery::canonicalize(ns(), query, &rawCq));
+            boost::scoped_ptr<CanonicalQuery> cq(rawCq);
+
+            // Get planner params.
+            QueryPlannerParams plannerParams;
+            fillOutPlannerParams(&_txn, collection, cq.get(), &plannerParams);
+
+            WorkingSet ws;
+            boost::scoped_ptr<SubplanStage> subplan(new SubplanStage(&_txn, collection, &ws,
+                                                                     plannerParams, cq.get()));
+
+            // NULL means that 'subplan' should not yield during plan selection.
+            ASSERT_OK(subplan->pickBestPlan(NULL));
+
+            ASSERT_FALSE(subplan->branchPlannedWithSameShape(0));
+            ASSERT_FALSE(subplan->branchPlannedWithSameShape(1));
+            ASSERT_TRUE(subplan->branchPlannedWithSameShape(2));
+
+            int count = 0;
+            while (!subplan->isEOF()) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = subplan->work(&id);
+                if (PlanStage::ADVANCED == state) {
+                    ++count;
+                }
+            }
+            ASSERT_EQUALS(3, count);
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite("query_stage_subplan") {}
@@ -162,6 +214,7 @@ namespace QueryStageSubplan {
         void setupTests() {
             add<QueryStageSubplanGeo2dOr>();
             add<QueryStageSubplanPlanFromCache>();
+            add<QueryStageSubplanSameShapeBranches>();
         }
     };
 
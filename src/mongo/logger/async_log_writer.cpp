@@ -0,0 +1,198 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_log_writer.h"
+
+#include <boost/bind.hpp>
+#include <set>
+#include <sstream>
+
+#include "mongo/logger/rotatable_file_writer.h"
+#include "mongo/util/concurrency/thread_name.h"
+
+namespace mongo {
+namespace logger {
+
+namespace {
+
+    // All live AsyncLogWriters, so they can be flushed before exit. Allocated on first use and
+    // never freed, because writers are still being used during static destruction.
+    boost::mutex* writersMutex = new boost::mutex;
+    std::set<AsyncLogWriter*>* writers = new std::set<AsyncLogWriter*>;
+
+}  // namespace
+
+    AsyncLogWriter::AsyncLogWriter(RotatableFileWriter* writer,
+                                   size_t bufferBytes,
+                                   OverflowPolicy policy)
+        : _writer(writer),
+          _bufferBytes(bufferBytes),
+          _policy(policy),
+          _writing(false),
+          _shutdown(false),
+          _queuedCount(0),
+          _writtenCount(0),
+          _reportedDroppedCount(0) {
+
+        _buffer.reserve(_bufferBytes);
+        _thread.reset(new boost::thread(boost::bind(&AsyncLogWriter::_run, this)));
+
+        boost::lock_guard<boost::mutex> lk(*writersMutex);
+        writers->insert(this);
+    }
+
+    AsyncLogWriter::~AsyncLogWriter() {
+        {
+            boost::lock_guard<boost::mutex> lk(*writersMutex);
+            writers->erase(this);
+        }
+
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _shutdown = true;
+        }
+        _bufferNotEmpty.notify_all();
+        _thread->join();
+    }
+
+    void AsyncLogWriter::write(StringData message) {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+
+        // A message larger than the whole buffer is still accepted once the buffer is empty
+        while (!_buffer.empty() && _buffer.size() + message.size() > _bufferBytes) {
+            if (_policy == kDropWhenFull || _shutdown) {
+                _droppedCount.fetchAndAdd(1);
+                return;
+            }
+            _batchWritten.wait(lk);
+        }
+
+        const bool wasEmpty = _buffer.empty();
+        _buffer.append(message.rawData(), message.size());
+        _queuedCount++;
+
+        if (wasEmpty) {
+            _bufferNotEmpty.notify_one();
+        }
+    }
+
+    void AsyncLogWriter::writeNow(StringData message) {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (_writing) {
+            _batchWritten.wait(lk);
+        }
+        _writeBatch(lk, message);
+    }
+
+    void AsyncLogWriter::flush() {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        const unsigned long long target = _queuedCount;
+        while (_writtenCount < target) {
+            _batchWritten.wait(lk);
+        }
+    }
+
+    void AsyncLogWriter::flushAll() {
+        boost::lock_guard<boost::mutex> lk(*writersMutex);
+        for (std::set<AsyncLogWriter*>::const_iterator it = writers->begin();
+                it != writers->end(); ++it) {
+            (*it)->flush();
+        }
+    }
+
+    void AsyncLogWriter::_run() {
+        setThreadName("AsyncLogWriter");
+
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (true) {
+            while ((_buffer.empty() || _writing) && !_shutdown) {
+                _bufferNotEmpty.wait(lk);
+            }
+
+            if (_shutdown) {
+                while (_writing) {
+                    _batchWritten.wait(lk);
+                }
+                _writeBatch(lk, StringData());
+                return;
+            }
+
+            _writeBatch(lk, StringData());
+        }
+    }
+
+    void AsyncLogWriter::_writeBatch(boost::unique_lock<boost::mutex>& lock, StringData extra) {
+        std::string batch;
+        batch.reserve(_bufferBytes);
+        batch.swap(_buffer);
+        const unsigned long long batchEnd = _queuedCount;
+
+        const long long dropped = _droppedCount.load();
+        const long long newlyDropped = dropped - _reportedDroppedCount;
+        _reportedDroppedCount = dropped;
+
+        if (batch.empty() && extra.empty() && !newlyDropped) {
+            return;
+        }
+
+        _writing = true;
+        lock.unlock();
+
+        // Buffered messages which did not make it into the batch are waiting for room
+        _batchWritten.notify_all();
+
+        {
+            RotatableFileWriter::Use useWriter(_writer);
+            if (useWriter.status().isOK()) {
+                std::ostream& os = useWriter.stream();
+                if (newlyDropped) {
+                    os << "*** " << newlyDropped
+                       << " log messages were dropped because the log buffer was full ***\n";
+                }
+                os.write(batch.data(), batch.size());
+                os.write(extra.rawData(), extra.size());
+                os.flush();
+            }
+        }
+
+        lock.lock();
+        _writing = false;
+        if (_writtenCount < batchEnd) {
+            _writtenCount = batchEnd;
+        }
+        _batchWritten.notify_all();
+
+        // Messages may have arrived while writing, without waking up the writer thread
+        if (!_buffer.empty()) {
+            _bufferNotEmpty.notify_one();
+        }
+    }
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,144 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+namespace logger {
+
+    class RotatableFileWriter;
+
+    /**
+     * Moves file writes for log messages off the threads which log them.
+     *
+     * Messages are appended to an in-memory buffer and a dedicated thread writes whatever has
+     * accumulated to the RotatableFileWriter in one go, so a slow disk delays the writer thread
+     * rather than every thread that logs. When the buffer is full, the message is either dropped
+     * and counted, or the logging thread waits for room, depending on the OverflowPolicy. The
+     * number of dropped messages is written to the file with the next batch.
+     *
+     * Writes still happen through RotatableFileWriter::Use, so log rotation keeps working. Call
+     * flush() before rotating in order to have the buffered messages end up in the old file.
+     *
+     * Thread safe.
+     */
+    class AsyncLogWriter {
+        MONGO_DISALLOW_COPYING(AsyncLogWriter);
+    public:
+        enum OverflowPolicy {
+            kDropWhenFull,
+            kBlockWhenFull
+        };
+
+        /**
+         * Starts the writer thread. Does not take ownership of "writer", which must outlive this
+         * object. At most "bufferBytes" bytes of messages are buffered at a time.
+         */
+        AsyncLogWriter(RotatableFileWriter* writer, size_t bufferBytes, OverflowPolicy policy);
+
+        /**
+         * Writes out what is buffered and stops the writer thread.
+         */
+        ~AsyncLogWriter();
+
+        /**
+         * Queues "message" to be written to the file. Only blocks if the buffer is full and the
+         * policy is kBlockWhenFull.
+         */
+        void write(StringData message);
+
+        /**
+         * Writes "message" from the calling thread, after everything queued before it. Used for
+         * messages which must be in the file before the caller proceeds, e.g. because the process
+         * is about to terminate.
+         */
+        void writeNow(StringData message);
+
+        /**
+         * Waits until all messages queued before the call have been written out.
+         */
+        void flush();
+
+        /**
+         * Number of messages dropped because the buffer was full.
+         */
+        long long getDroppedCount() const { return _droppedCount.load(); }
+
+        /**
+         * Flushes every AsyncLogWriter in the process. Called before exit and log rotation.
+         */
+        static void flushAll();
+
+    private:
+        void _run();
+
+        /**
+         * Takes what is buffered and writes it, followed by "extra". Must be called with "lock"
+         * held and while nobody else is writing; releases the lock during the file write.
+         */
+        void _writeBatch(boost::unique_lock<boost::mutex>& lock, StringData extra);
+
+        RotatableFileWriter* const _writer;
+        const size_t _bufferBytes;
+        const OverflowPolicy _policy;
+
+        // Protects all members below
+        boost::mutex _mutex;
+
+        // Signaled when messages are appended to _buffer, or on shutdown
+        boost::condition_variable _bufferNotEmpty;
+
+        // Signaled when a batch has been written, which makes room and advances _writtenCount
+        boost::condition_variable _batchWritten;
+
+        std::string _buffer;
+        bool _writing;
+        bool _shutdown;
+
+        // Messages queued and written out so far, used by flush()
+        unsigned long long _queuedCount;
+        unsigned long long _writtenCount;
+
+        // Messages dropped so far, and how many of those have been reported in the file
+        AtomicInt64 _droppedCount;
+        long long _reportedDroppedCount;
+
+        boost::scoped_ptr<boost::thread> _thread;
+    };
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,155 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <fstream>
+#include <sstream>
+
+#include "mongo/logger/async_log_writer.h"
+#include "mongo/logger/rotatable_file_writer.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+    using namespace mongo;
+    using namespace mongo::logger;
+
+    const std::string logFileName("LogTest_AsyncLogWriter.txt");
+    const std::string logFileNameRotated("LogTest_AsyncLogWriter_Rotated.txt");
+
+    class AsyncLogWriterTest : public mongo::unittest::Test {
+    public:
+        AsyncLogWriterTest() {
+            unlink(logFileName.c_str());
+            unlink(logFileNameRotated.c_str());
+            ASSERT_OK(RotatableFileWriter::Use(&_fileWriter).setFileName(logFileName, false));
+        }
+
+        virtual ~AsyncLogWriterTest() {
+            unlink(logFileName.c_str());
+            unlink(logFileNameRotated.c_str());
+        }
+
+    protected:
+        std::vector<std::string> readLines(const std::string& fileName) {
+            std::vector<std::string> lines;
+            std::ifstream ifs(fileName.c_str());
+            std::string line;
+            while (std::getline(ifs, line)) {
+                lines.push_back(line);
+            }
+            return lines;
+        }
+
+        RotatableFileWriter _fileWriter;
+    };
+
+    TEST_F(AsyncLogWriterTest, FlushWritesQueuedMessagesInOrder) {
+        AsyncLogWriter writer(&_fileWriter, 1024 * 1024, AsyncLogWriter::kBlockWhenFull);
+        for (int i = 0; i < 1000; i++) {
+            writer.write(std::string(str::stream() << "message " << i << "\n"));
+        }
+        writer.writeNow("last\n");
+        writer.flush();
+
+        std::vector<std::string> lines = readLines(logFileName);
+        ASSERT_EQUALS(1001U, lines.size());
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_EQUALS(std::string(str::stream() << "message " << i), lines[i]);
+        }
+        ASSERT_EQUALS("last", lines[1000]);
+        ASSERT_EQUALS(0, writer.getDroppedCount());
+    }
+
+    TEST_F(AsyncLogWriterTest, BlockWhenFullLosesNothing) {
+        {
+            // Room for about two messages at a time
+            AsyncLogWriter writer(&_fileWriter, 20, AsyncLogWriter::kBlockWhenFull);
+            for (int i = 0; i < 500; i++) {
+                writer.write(std::string(str::stream() << "message " << i << "\n"));
+            }
+        }
+
+        std::vector<std::string> lines = readLines(logFileName);
+        ASSERT_EQUALS(500U, lines.size());
+        ASSERT_EQUALS("message 499", lines.back());
+    }
+
+    TEST_F(AsyncLogWriterTest, DropWhenFullCountsDroppedMessages) {
+        boost::scoped_ptr<AsyncLogWriter> writer;
+        {
+            // Hold the file, so the writer thread cannot empty the buffer
+            RotatableFileWriter::Use holdFile(&_fileWriter);
+
+            writer.reset(new AsyncLogWriter(&_fileWriter, 20, AsyncLogWriter::kDropWhenFull));
+            for (int i = 0; i < 100; i++) {
+                writer->write(std::string(str::stream() << "message " << i << "\n"));
+            }
+            ASSERT_GREATER_THAN(writer->getDroppedCount(), 90);
+        }
+        const long long dropped = writer->getDroppedCount();
+        writer.reset();
+
+        // The messages which fit, along with notes saying how many did not
+        std::vector<std::string> lines = readLines(logFileName);
+        long long written = 0;
+        long long reported = 0;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (lines[i].find("message ") == 0) {
+                written++;
+            }
+            else {
+                long long count = 0;
+                std::istringstream(lines[i].substr(4)) >> count;
+                ASSERT_NOT_EQUALS(std::string::npos, lines[i].find("log messages were dropped"));
+                reported += count;
+            }
+        }
+        ASSERT_EQUALS(100, written + dropped);
+        ASSERT_EQUALS(dropped, reported);
+    }
+
+    TEST_F(AsyncLogWriterTest, RotationAfterFlush) {
+        AsyncLogWriter writer(&_fileWriter, 1024, AsyncLogWriter::kBlockWhenFull);
+        writer.write("before\n");
+        writer.flush();
+        ASSERT_OK(RotatableFileWriter::Use(&_fileWriter).rotate(true, logFileNameRotated));
+        writer.write("after\n");
+        writer.flush();
+
+        std::vector<std::string> rotated = readLines(logFileNameRotated);
+        ASSERT_EQUALS(1U, rotated.size());
+        ASSERT_EQUALS("before", rotated[0]);
+
+        std::vector<std::string> current = readLines(logFileName);
+        ASSERT_EQUALS(1U, current.size());
+        ASSERT_EQUALS("after", current[0]);
+    }
+
+}  // namespace
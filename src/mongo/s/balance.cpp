@@ -37,6 +37,8 @@
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/s/chunk.h"
@@ -71,6 +73,61 @@ namespace mongo {
 
     MONGO_FP_DECLARE(skipBalanceRound);
 
+    // Balance untagged collections by the bytes each shard holds instead of the chunk count
+    MONGO_EXPORT_SERVER_PARAMETER(balancerBalanceByDataSize, bool, false);
+
+    // Pause between migrations in a round, so back to back migrations don't saturate the shards
+    MONGO_EXPORT_SERVER_PARAMETER(balancerMigrationIntervalMS, int, 0);
+
+    namespace {
+
+        /**
+         * Records on the distribution how many bytes of ns each shard holds, taken from collStats
+         * on the shards.  Leaves the distribution without data sizes if any shard with chunks
+         * can't be asked, so that the policy falls back to counting chunks.
+         */
+        void loadDataSizes( const string& ns,
+                            const ShardInfoMap& shardInfo,
+                            DistributionStatus* status ) {
+            const NamespaceString nss( ns );
+            map<string, long long> sizes;
+
+            for ( ShardInfoMap::const_iterator i = shardInfo.begin(); i != shardInfo.end(); ++i ) {
+                if ( status->numberOfChunksInShard( i->first ) == 0 ) {
+                    // Nothing to move off, and the collection may not even exist there
+                    sizes[i->first] = 0;
+                    continue;
+                }
+
+                try {
+                    ScopedDbConnection conn( Shard::make( i->first ).getConnString(), 30 );
+                    BSONObj res;
+                    bool ok = conn->runCommand( nss.db().toString(),
+                                                BSON( "collStats" << nss.coll() ),
+                                                res );
+                    conn.done();
+
+                    if ( !ok || !res["size"].isNumber() ) {
+                        warning() << "could not get size of " << ns << " on " << i->first
+                                  << ", balancing it by chunk count: " << res << endl;
+                        return;
+                    }
+
+                    sizes[i->first] = res["size"].numberLong();
+                }
+                catch ( const DBException& ex ) {
+                    warning() << "could not get size of " << ns << " on " << i->first
+                              << ", balancing it by chunk count" << causedBy( ex ) << endl;
+                    return;
+                }
+            }
+
+            for ( map<string, long long>::const_iterator i = sizes.begin(); i != sizes.end(); ++i ) {
+                status->setDataSize( i->first, i->second );
+            }
+        }
+    }
+
     Balancer balancer;
 
     Balancer::Balancer() : _balancedLastTime(0), _policy( new BalancerPolicy() ) {}
@@ -121,6 +178,11 @@ namespace mongo {
                                      0, /* maxTimeMS */
                                      res)) {
                     movedCount++;
+
+                    if ( balancerMigrationIntervalMS > 0 &&
+                         it + 1 != candidateChunks->end() ) {
+                        sleepmillis( balancerMigrationIntervalMS );
+                    }
                     continue;
                 }
 
@@ -454,6 +516,10 @@ namespace mongo {
             }
             cursor.reset();
 
+            if ( balancerBalanceByDataSize && ranges.empty() ) {
+                loadDataSizes( ns, shardInfo, &status );
+            }
+
             DBConfigPtr cfg = grid.getDBConfig( ns );
             if ( !cfg ) {
                 warning() << "could not load db config to balance " << ns << " collection" << endl;
@@ -157,6 +157,25 @@ namespace mongo {
         return worst;
     }
 
+    void DistributionStatus::setDataSize( const string& shard, long long bytes ) {
+        _dataSizes[shard] = bytes;
+    }
+
+    bool DistributionStatus::hasDataSizes() const {
+        for ( set<string>::const_iterator i = _shards.begin(); i != _shards.end(); ++i ) {
+            if ( _dataSizes.find( *i ) == _dataSizes.end() )
+                return false;
+        }
+        return !_shards.empty();
+    }
+
+    long long DistributionStatus::dataSizeInShard( const string& shard ) const {
+        map<string, long long>::const_iterator i = _dataSizes.find( shard );
+        if ( i == _dataSizes.end() )
+            return -1;
+        return i->second;
+    }
+
     const vector<ChunkType*>& DistributionStatus::getChunks(
             const string& shard) const {
         ShardToChunksMap::const_iterator i = _shardChunks.find(shard);
@@ -475,6 +494,10 @@ namespace mongo {
             std::random_shuffle( tags.begin(), tags.end() );
         }
 
+        if ( distribution.tags().empty() && distribution.hasDataSizes() ) {
+            return balanceByDataSize( ns, distribution, threshold );
+        }
+
         for ( unsigned i=0; i<tags.size(); i++ ) {
             string tag = tags[i];
 
@@ -537,6 +560,65 @@ namespace mongo {
         return NULL;
     }
 
+    MigrateInfo* BalancerPolicy::balanceByDataSize( const string& ns,
+                                                    const DistributionStatus& distribution,
+                                                    int threshold ) {
+        string from;
+        long long maxBytes = -1;
+        string to;
+        long long minBytes = numeric_limits<long long>::max();
+
+        const set<string>& shards = distribution.shards();
+        for ( set<string>::const_iterator i = shards.begin(); i != shards.end(); ++i ) {
+            const long long bytes = distribution.dataSizeInShard( *i );
+
+            if ( distribution.numberOfChunksInShard( *i ) > 0 && bytes > maxBytes ) {
+                from = *i;
+                maxBytes = bytes;
+            }
+
+            const ShardInfo& info = distribution.shardInfo( *i );
+            if ( info.isSizeMaxed() || info.isDraining() )
+                continue;
+
+            if ( bytes < minBytes ) {
+                to = *i;
+                minBytes = bytes;
+            }
+        }
+
+        if ( from.empty() || to.empty() || from == to )
+            return NULL;
+
+        const vector<ChunkType*>& chunks = distribution.getChunks( from );
+        const long long avgChunkBytes = std::max( 1LL, maxBytes / (long long)chunks.size() );
+        const long long imbalance = maxBytes - minBytes;
+
+        LOG(1) << "collection : " << ns << endl;
+        LOG(1) << "donor      : " << from << " bytes on " << maxBytes << endl;
+        LOG(1) << "receiver   : " << to << " bytes on " << minBytes << endl;
+        LOG(1) << "threshold  : " << threshold << " chunks of " << avgChunkBytes << " bytes"
+               << endl;
+
+        if ( imbalance < threshold * avgChunkBytes )
+            return NULL;
+
+        for ( unsigned j = 0; j < chunks.size(); j++ ) {
+            const ChunkType& chunk = *chunks[j];
+            if (chunk.isJumboSet() && chunk.getJumbo())
+                continue;
+
+            log() << " ns: " << ns << " going to move " << chunk
+                  << " from: " << from << " to: " << to << " to even out data size ("
+                  << maxBytes << " vs " << minBytes << " bytes)" << endl;
+            return new MigrateInfo(ns, to, from, chunk.toBSON());
+        }
+
+        error() << "shard: " << from << " ns: " << ns
+                << " has too much data, but all its chunks are jumbo" << endl;
+        return NULL;
+    }
+
 
     ShardInfo::ShardInfo(long long maxSizeMB,
                          long long currSizeMB,
@@ -180,6 +180,15 @@ namespace mongo {
 
         /** @return the ShardInfo for the shard */
         const ShardInfo& shardInfo( const std::string& shard ) const;
+
+        /** records how many bytes of this collection the shard holds */
+        void setDataSize( const std::string& shard, long long bytes );
+
+        /** @return true if a data size was recorded for every shard */
+        bool hasDataSizes() const;
+
+        /** @return bytes of this collection on the shard, -1 if not recorded */
+        long long dataSizeInShard( const std::string& shard ) const;
         
         /** writes all state to log() */
         void dump() const;
@@ -212,6 +221,7 @@ namespace mongo {
         std::map<BSONObj,TagRange> _tagRanges;
         std::set<std::string> _allTags;
         std::set<std::string> _shards;
+        std::map<std::string, long long> _dataSizes;
     };
 
     class BalancerPolicy {
@@ -231,6 +241,18 @@ namespace mongo {
         static MigrateInfo* balance( const std::string& ns,
                                      const DistributionStatus& distribution,
                                      int balancedLastTime );
+
+    private:
+
+        /**
+         * Balances an untagged collection by the bytes each shard holds rather than its chunk
+         * count, so that runs of empty or oversized chunks don't leave a shard with most of the
+         * data.  A chunk is moved from the shard with the most data to the one with the least
+         * while they differ by at least 'threshold' of the donor's average chunk size.
+         */
+        static MigrateInfo* balanceByDataSize( const std::string& ns,
+                                               const DistributionStatus& distribution,
+                                               int threshold );
     };
 
 
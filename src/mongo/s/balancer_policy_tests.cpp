@@ -134,6 +134,77 @@ namespace mongo {
         }
 
 
+        /**
+         * Adds 'numChunks' consecutive chunks on x, starting at 'start', to the shard.
+         */
+        void addChunks( OwnedShardToChunksMap* chunkMap,
+                        const string& shard,
+                        int start,
+                        int numChunks ) {
+            OwnedPointerVector<ChunkType>*& chunks = chunkMap->mutableMap()[shard];
+            if ( chunks == NULL ) {
+                chunks = new OwnedPointerVector<ChunkType>();
+            }
+
+            for ( int i = start; i < start + numChunks; i++ ) {
+                auto_ptr<ChunkType> chunk(new ChunkType());
+                chunk->setMin(BSON("x" << i * 10));
+                chunk->setMax(BSON("x" << (i + 1) * 10));
+                chunks->push_back(chunk.release());
+            }
+        }
+
+        TEST( BalancerPolicyTests , BalanceByDataSizeWithEvenChunkCounts ) {
+            OwnedShardToChunksMap chunkMap;
+            addChunks(&chunkMap, "shard0", 0, 3);
+            addChunks(&chunkMap, "shard1", 3, 3);
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo(0, 0, false);
+            info["shard1"] = ShardInfo(0, 0, false);
+
+            DistributionStatus status(info, chunkMap.map());
+
+            // Same chunk count, no move
+            boost::scoped_ptr<MigrateInfo> c(BalancerPolicy::balance( "ns", status, 0 ));
+            ASSERT( !c );
+
+            // All the data is on shard1
+            status.setDataSize("shard0", 0);
+            status.setDataSize("shard1", 600 * 1024 * 1024);
+            c.reset(BalancerPolicy::balance( "ns", status, 0 ));
+            ASSERT( c );
+            ASSERT_EQUALS( "shard1", c->from );
+            ASSERT_EQUALS( "shard0", c->to );
+        }
+
+        TEST( BalancerPolicyTests , BalanceByDataSizeWithUnevenChunkCounts ) {
+            OwnedShardToChunksMap chunkMap;
+            addChunks(&chunkMap, "shard0", 0, 6);
+            addChunks(&chunkMap, "shard1", 6, 2);
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo(0, 0, false);
+            info["shard1"] = ShardInfo(0, 0, false);
+
+            DistributionStatus status(info, chunkMap.map());
+
+            // Without data sizes the chunk count decides
+            boost::scoped_ptr<MigrateInfo> c(BalancerPolicy::balance( "ns", status, 0 ));
+            ASSERT( c );
+            ASSERT_EQUALS( "shard0", c->from );
+
+            // Only one shard's size known, still by chunk count
+            status.setDataSize("shard0", 100);
+            c.reset(BalancerPolicy::balance( "ns", status, 0 ));
+            ASSERT( c );
+
+            // Both shards hold the same amount of data, nothing to move
+            status.setDataSize("shard1", 100);
+            c.reset(BalancerPolicy::balance( "ns", status, 0 ));
+            ASSERT( !c );
+        }
+
         TEST( BalanceNormalTests ,  BalanceDrainingTest ) {
             // one normal, one draining
             // 2 chunks and 0 chunk shards
@@ -41,10 +41,12 @@
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/query/lite_parsed_query.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/balancer_policy.h"
 #include "mongo/s/chunk_diff.h"
@@ -111,8 +113,8 @@ namespace mongo {
      * Returns true if the chunk was actually moved.
      */
     static bool tryMoveToOtherShard(const ChunkManager& manager, const ChunkType& chunk) {
-        // reload sharding metadata before starting migration
-        ChunkManagerPtr chunkMgr = manager.reload(false /* just reloaded in mulitsplit */);
+        // reload sharding metadata before starting migration, the auto-split only scheduled it
+        ChunkManagerPtr chunkMgr = manager.reload();
 
         ShardInfoMap shardInfo;
         Status loadStatus = DistributionStatus::populateShardInfoMap(&shardInfo);
@@ -451,12 +453,19 @@ namespace mongo {
             return Status(ErrorCodes::CannotSplit, msg);
         }
 
-        Status status = multiSplit(splitPoints, res);
+        // Auto-splits happen on a client's write, don't make it wait for the reload
+        Status status = _multiSplit(splitPoints, res, mode == Chunk::autoSplitInternal);
         *resultingSplits = splitPoints.size();
         return status;
     }
 
     Status Chunk::multiSplit(const vector<BSONObj>& m, BSONObj* res) const {
+        return _multiSplit(m, res, false);
+    }
+
+    Status Chunk::_multiSplit(const vector<BSONObj>& m,
+                              BSONObj* res,
+                              bool reloadInBackground) const {
         const size_t maxSplitPoints = 8192;
 
         uassert( 10165 , "can't split as shard doesn't have a manager" , _manager );
@@ -495,7 +504,12 @@ namespace mongo {
         conn.done();
         
         // force reload of config
-        _manager->reload();
+        if (reloadInBackground) {
+            grid.getDBConfig(_manager->getns())->reloadChunkManagerInBackground(_manager->getns());
+        }
+        else {
+            _manager->reload();
+        }
 
         return Status::OK();
     }
@@ -797,7 +811,7 @@ namespace mongo {
 
     ChunkManager::ChunkManager( const string& ns, const ShardKeyPattern& pattern , bool unique ) :
         _ns( ns ),
-        _keyPattern( pattern.getKeyPattern() ),
+        _keyPattern( pattern.getKeyPattern(), pattern.getHashVersion() ),
         _unique( unique ),
         _chunkRanges(),
         _mutex("ChunkManager"),
@@ -816,7 +830,8 @@ namespace mongo {
                                                         ""),
         _keyPattern(collDoc[CollectionType::keyPattern()].type() == Object ?
                                                         collDoc[CollectionType::keyPattern()].Obj().getOwned() :
-                                                        BSONObj()),
+                                                        BSONObj(),
+                    collDoc[CollectionType::hashVersion()].numberInt()),
         _unique(collDoc[CollectionType::unique()].trueValue()),
         _chunkRanges(),
         _mutex("ChunkManager"),
@@ -832,6 +847,10 @@ namespace mongo {
 
         verify( _ns != ""  );
         verify( ! _keyPattern.toBSON().isEmpty() );
+        uassert( 28632,
+                 str::stream() << "collection " << _ns << " uses unsupported hashVersion "
+                               << _keyPattern.getHashVersion() << " for its shard key",
+                 BSONElementHasher::isValidHashVersion( _keyPattern.getHashVersion() ) );
 
         _version = ChunkVersion::fromBSON( collDoc );
     }
@@ -867,6 +886,7 @@ namespace mongo {
                     const_cast<set<Shard>&>(_shards).swap(shards);
                     const_cast<ShardVersionMap&>(_shardVersions).swap(shardVersions);
                     const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(_chunkMap);
+                    const_cast<ChunkRoutingTable&>(_routingTable).reloadAll(_chunkMap);
 
                     return;
                 }
@@ -1175,6 +1195,15 @@ namespace mongo {
     }
 
     ChunkPtr ChunkManager::findIntersectingChunk( const BSONObj& shardKey ) const {
+        {
+            ChunkPtr chunk = _routingTable.upperBound( shardKey );
+            if ( chunk && chunk->containsKey( shardKey ) ) {
+                return chunk;
+            }
+
+            // Keys the flat table can't place fall back to the map, which has the final word
+        }
+
         {
             BSONObj chunkMin;
             ChunkPtr chunk;
@@ -1230,7 +1259,9 @@ namespace mongo {
         //   Query { a : { $gte : 1, $lt : 2 },
         //            b : { $gte : 3, $lt : 4 } }
         //   => Bounds { a : [1, 2), b : [3, 4) }
-        IndexBounds bounds = getIndexBoundsForQuery(_keyPattern.toBSON(), canonicalQuery);
+        IndexBounds bounds = getIndexBoundsForQuery(_keyPattern.toBSON(),
+                                                    canonicalQuery,
+                                                    _keyPattern.getHashVersion());
 
         // Transforms bounds for each shard key field into full shard key ranges
         // for example :
@@ -1280,7 +1311,9 @@ namespace mongo {
         all.insert(_shards.begin(), _shards.end());
     }
 
-    IndexBounds ChunkManager::getIndexBoundsForQuery(const BSONObj& key, const CanonicalQuery* canonicalQuery) {
+    IndexBounds ChunkManager::getIndexBoundsForQuery(const BSONObj& key,
+                                                     const CanonicalQuery* canonicalQuery,
+                                                     int hashVersion) {
         // $text is not allowed in planning since we don't have text index on mongos.
         //
         // TODO: Treat $text query as a no-op in planning. So with shard key {a: 1},
@@ -1299,8 +1332,12 @@ namespace mongo {
         QueryPlannerParams plannerParams;
         // Must use "shard key" index
         plannerParams.options = QueryPlannerParams::NO_TABLE_SCAN;
+        BSONObj infoObj;
+        if (hashVersion != HASH_VERSION_MD5) {
+            infoObj = BSON("hashVersion" << hashVersion);
+        }
         IndexEntry indexEntry(key, accessMethod, false /* multiKey */, false /* sparse */,
-                              false /* unique */, "shardkey", BSONObj());
+                              false /* unique */, "shardkey", infoObj);
         plannerParams.indices.push_back(indexEntry);
 
         OwnedPointerVector<QuerySolution> solutions;
@@ -1502,6 +1539,9 @@ namespace mongo {
     void ChunkManager::getInfo( BSONObjBuilder& b ) const {
         b.append(CollectionType::keyPattern(), _keyPattern.toBSON());
         b.appendBool(CollectionType::unique(), _unique);
+        if (_keyPattern.getHashVersion() != HASH_VERSION_MD5) {
+            b.append(CollectionType::hashVersion(), _keyPattern.getHashVersion());
+        }
         _version.addEpochToBSON(b, CollectionType::DEPRECATED_lastmod());
     }
 
@@ -1586,6 +1626,64 @@ namespace mongo {
         }
     }
 
+    void ChunkRoutingTable::clear() {
+        _keyData.clear();
+        _keyEnds.clear();
+        _chunks.clear();
+    }
+
+    void ChunkRoutingTable::reloadAll(const ChunkMap& chunks) {
+        clear();
+        _keyEnds.reserve(chunks.size());
+        _chunks.reserve(chunks.size());
+
+        const Ordering ascending = Ordering::make(BSONObj());
+        KeyString encoded;
+        for (ChunkMap::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            encoded.resetToKey(it->first, ascending);
+            _keyData.insert(_keyData.end(),
+                            encoded.getBuffer(),
+                            encoded.getBuffer() + encoded.getSize());
+            _keyEnds.push_back(_keyData.size());
+            _chunks.push_back(it->second);
+        }
+    }
+
+    int ChunkRoutingTable::_compare(size_t i, const char* key, size_t keySize) const {
+        const size_t begin = i == 0 ? 0 : _keyEnds[i - 1];
+        const size_t boundSize = _keyEnds[i] - begin;
+
+        const int cmp = memcmp(&_keyData[begin], key, std::min(boundSize, keySize));
+        if (cmp != 0) {
+            return cmp;
+        }
+
+        return boundSize == keySize ? 0 : (boundSize < keySize ? -1 : 1);
+    }
+
+    ChunkPtr ChunkRoutingTable::upperBound(const BSONObj& shardKey) const {
+        if (_chunks.empty()) {
+            return ChunkPtr();
+        }
+
+        const KeyString key(shardKey, Ordering::make(BSONObj()));
+
+        // First bound strictly greater than the key
+        size_t low = 0;
+        size_t high = _chunks.size();
+        while (low < high) {
+            const size_t mid = low + (high - low) / 2;
+            if (_compare(mid, key.getBuffer(), key.getSize()) <= 0) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+
+        return low == _chunks.size() ? ChunkPtr() : _chunks[low];
+    }
+
     int ChunkManager::getCurrentDesiredChunkSize() const {
         // split faster in early chunks helps spread out an initial load better
         const int minChunkSize = 1 << 20;  // 1 MBytes
@@ -33,6 +33,7 @@
 #include <boost/next_prior.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
+#include <vector>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/keypattern.h"
@@ -297,6 +298,14 @@ namespace mongo {
          */
         void determineSplitPoints(bool atMedian, std::vector<BSONObj>* splitPoints) const;
 
+        /**
+         * multiSplit, optionally leaving the chunk manager reload to a background thread. A split
+         * doesn't move any data, so routing with the old chunk manager stays correct meanwhile.
+         */
+        Status _multiSplit(const std::vector<BSONObj>& splitPoints,
+                           BSONObj* res,
+                           bool reloadInBackground) const;
+
         /** initializes _dataWritten with a random value so that a mongos restart wouldn't cause delay in splitting */
         static int mkDataWritten();
     };
@@ -375,6 +384,36 @@ namespace mongo {
         ChunkRangeMap _ranges;
     };
 
+    /**
+     * A flat, read-only copy of a ChunkMap for routing single keys.  The max bound of every chunk
+     * is stored KeyString-encoded, back to back in one buffer in ascending order, so a lookup
+     * encodes the key once and binary searches with memcmp instead of walking the map with a
+     * BSON comparison at every node.
+     */
+    class ChunkRoutingTable {
+    public:
+        void clear();
+
+        void reloadAll(const ChunkMap& chunks);
+
+        /**
+         * Returns the first chunk whose max bound is greater than the given shard key, which is
+         * what ChunkMap::upper_bound would find, or an empty pointer if there is none.
+         */
+        ChunkPtr upperBound(const BSONObj& shardKey) const;
+
+        size_t size() const { return _chunks.size(); }
+
+    private:
+        // Returns <0, 0 or >0 as the i'th max bound sorts before, equal to or after the key
+        int _compare(size_t i, const char* key, size_t keySize) const;
+
+        std::vector<char> _keyData;
+        // End offset in _keyData of each bound, the start is the previous bound's end
+        std::vector<size_t> _keyEnds;
+        std::vector<ChunkPtr> _chunks;
+    };
+
     /* config.sharding
          { ns: 'alleyinsider.fs.chunks' ,
            key: { ts : 1 } ,
@@ -451,7 +490,10 @@ namespace mongo {
         //   Query { a : { $gte : 1, $lt : 2 },
         //            b : { $gte : 3, $lt : 4 } }
         //   => Bounds { a : [1, 2), b : [3, 4) }
-        static IndexBounds getIndexBoundsForQuery(const BSONObj& key, const CanonicalQuery* canonicalQuery);
+        // A hashed key's bounds are hashed with 'hashVersion'.
+        static IndexBounds getIndexBoundsForQuery(const BSONObj& key,
+                                                  const CanonicalQuery* canonicalQuery,
+                                                  int hashVersion = 0);
 
         // Collapse query solution tree.
         //
@@ -512,6 +554,7 @@ namespace mongo {
 
         const ChunkMap _chunkMap;
         const ChunkRangeManager _chunkRanges;
+        const ChunkRoutingTable _routingTable;
 
         const std::set<Shard> _shards;
 
@@ -30,6 +30,8 @@
 
 #include "mongo/s/chunk_manager_targeter.h"
 
+#include <algorithm>
+
 #include "mongo/s/config.h"
 #include "mongo/s/grid.h"
 #include "mongo/util/log.h"
@@ -96,13 +98,20 @@ namespace mongo {
 
         if ( _manager ) {
 
+            if ( _insertChunksManager == _manager ) {
+                InsertChunkMap::const_iterator it = _insertChunks.find( doc.objdata() );
+                if ( it != _insertChunks.end() ) {
+                    return targetChunk( it->second, doc.objsize(), endpoint );
+                }
+            }
+
             //
             // Sharded collections have the following requirements for targeting:
             //
             // Inserts must contain the exact shard key.
             //
 
-            shardKey = _manager->getShardKeyPattern().extractShardKeyFromDoc(doc);
+            shardKey = extractInsertShardKey(doc);
 
             // Check shard key exists
             if (shardKey.isEmpty()) {
@@ -135,6 +144,98 @@ namespace mongo {
         }
     }
 
+    namespace {
+
+        typedef std::pair<BSONObj, const char*> ShardKeyAndDoc;
+
+        struct ShardKeyAndDocLess {
+            bool operator()(const ShardKeyAndDoc& l, const ShardKeyAndDoc& r) const {
+                return cmp(l.first, r.first);
+            }
+
+            BSONObjCmp cmp;
+        };
+
+    } // namespace
+
+    void ChunkManagerTargeter::prepareInserts(const vector<BSONObj>& docs) const {
+
+        // Ordered batches are targeted a piece at a time, the placements stay good until the
+        // metadata is refreshed
+        if (_insertChunksManager == _manager && !_insertChunks.empty()) {
+            return;
+        }
+
+        _insertChunks.clear();
+        _insertChunksManager = _manager;
+
+        if (!_manager || docs.size() < 2) {
+            return;
+        }
+
+        vector<ShardKeyAndDoc> keys;
+        keys.reserve(docs.size());
+
+        for (vector<BSONObj>::const_iterator it = docs.begin(); it != docs.end(); ++it) {
+            BSONObj shardKey = extractInsertShardKey(*it);
+
+            // Left for targetInsert() to report
+            if (shardKey.isEmpty() || !ShardKeyPattern::checkShardKeySize(shardKey).isOK()) {
+                continue;
+            }
+
+            keys.push_back(ShardKeyAndDoc(shardKey, it->objdata()));
+        }
+
+        std::sort(keys.begin(), keys.end(), ShardKeyAndDocLess());
+
+        // Chunks are keyed by max bound, so each key belongs to the first chunk whose max is
+        // above it, and with the keys in order that chunk never moves backwards
+        const ChunkMap& chunkMap = _manager->getChunkMap();
+        const ChunkMap::key_compare keyLess = chunkMap.key_comp();
+        ChunkMap::const_iterator chunkIt = chunkMap.begin();
+
+        for (vector<ShardKeyAndDoc>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+            while (chunkIt != chunkMap.end() && !keyLess(it->first, chunkIt->first)) {
+                ++chunkIt;
+            }
+
+            if (chunkIt == chunkMap.end()) {
+                break;
+            }
+
+            // Anything the sweep can't place goes through findIntersectingChunk() as before
+            if (chunkIt->second->containsKey(it->first)) {
+                _insertChunks[it->second] = chunkIt->second;
+            }
+        }
+    }
+
+    BSONObj ChunkManagerTargeter::extractInsertShardKey(const BSONObj& doc) const {
+
+        const ShardKeyPattern& shardKeyPattern = _manager->getShardKeyPattern();
+
+        // Only hashing costs enough to be worth remembering
+        if (!shardKeyPattern.isHashedPattern()) {
+            return shardKeyPattern.extractShardKeyFromDoc(doc);
+        }
+
+        // A refresh may have replaced the shard key, e.g. if the collection was resharded
+        if (_hashedInsertKeysManager != _manager) {
+            _hashedInsertKeys.clear();
+            _hashedInsertKeysManager = _manager;
+        }
+
+        HashedShardKeyMap::const_iterator it = _hashedInsertKeys.find(doc.objdata());
+        if (it != _hashedInsertKeys.end()) {
+            return it->second;
+        }
+
+        BSONObj shardKey = shardKeyPattern.extractShardKeyFromDoc(doc);
+        _hashedInsertKeys[doc.objdata()] = shardKey;
+        return shardKey;
+    }
+
     namespace {
 
         // TODO: Expose these for unit testing via dbtests
@@ -395,7 +496,13 @@ namespace mongo {
                                                 ShardEndpoint** endpoint) const {
         invariant(NULL != _manager);
 
-        ChunkPtr chunk = _manager->findIntersectingChunk(shardKey);
+        return targetChunk(_manager->findIntersectingChunk(shardKey), estDataSize, endpoint);
+    }
+
+    Status ChunkManagerTargeter::targetChunk(const ChunkPtr& chunk,
+                                             long long estDataSize,
+                                             ShardEndpoint** endpoint) const {
+        invariant(NULL != _manager);
 
         // Track autosplit stats for sharded collections
         // Note: this is only best effort accounting and is not accurate.
@@ -66,6 +66,9 @@ namespace mongo {
         // Returns ShardKeyNotFound if document does not have a full shard key.
         Status targetInsert( const BSONObj& doc, ShardEndpoint** endpoint ) const;
 
+        // Sorts the shard keys of the documents and places them all with one pass over the chunks
+        void prepareInserts( const std::vector<BSONObj>& docs ) const;
+
         // Returns ShardKeyNotFound if the update can't be targeted without a shard key.
         Status targetUpdate( const BatchedUpdateDocument& updateDoc,
                              std::vector<ShardEndpoint*>* endpoints ) const;
@@ -140,6 +143,23 @@ namespace mongo {
                               long long estDataSize,
                               ShardEndpoint** endpoint) const;
 
+        /**
+         * Returns a ShardEndpoint for the shard owning the chunk, updating the chunk stats as
+         * targetShardKey() does.
+         */
+        Status targetChunk(const ChunkPtr& chunk,
+                           long long estDataSize,
+                           ShardEndpoint** endpoint) const;
+
+        /**
+         * Returns the shard key of an inserted document, or an empty object if it has none.
+         *
+         * A batch is retargeted from scratch after every stale shard version, so hashed shard
+         * keys are remembered by document for the life of the targeter (one write batch) and
+         * each document is hashed once.
+         */
+        BSONObj extractInsertShardKey(const BSONObj& doc) const;
+
         NamespaceString _nss;
 
         // Zero or one of these are filled at all times
@@ -154,6 +174,18 @@ namespace mongo {
         // Stores whether we need to check the remote server on refresh
         bool _needsTargetingRefresh;
 
+        // Hashed shard keys of the batch's inserted documents, keyed by document data, and the
+        // manager whose shard key pattern they were extracted with
+        typedef std::map<const char*, BSONObj> HashedShardKeyMap;
+        mutable HashedShardKeyMap _hashedInsertKeys;
+        mutable ChunkManagerPtr _hashedInsertKeysManager;
+
+        // Chunks placed by prepareInserts(), keyed by document data like the hashed keys, and the
+        // manager they were placed with
+        typedef std::map<const char*, ChunkPtr> InsertChunkMap;
+        mutable InsertChunkMap _insertChunks;
+        mutable ChunkManagerPtr _insertChunksManager;
+
         // Represents only the view and not really part of the targeter state.
         mutable boost::scoped_ptr<TargeterStats> _stats;
     };
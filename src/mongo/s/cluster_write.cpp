@@ -63,9 +63,12 @@ namespace mongo {
         // TODO: consider writing a type for index instead
         /**
          * Constructs the BSON specification document for the given namespace, index key
-         * and options.
+         * and options.  Fields of 'options' are appended to the spec as they are.
          */
-        BSONObj createIndexDoc( const string& ns, const BSONObj& keys, bool unique ) {
+        BSONObj createIndexDoc( const string& ns,
+                                const BSONObj& keys,
+                                bool unique,
+                                const BSONObj& options ) {
             BSONObjBuilder indexDoc;
             indexDoc.append( "ns" , ns );
             indexDoc.append( "key" , keys );
@@ -98,6 +101,8 @@ namespace mongo {
                 indexDoc.appendBool( "unique", unique );
             }
 
+            indexDoc.appendElements( options );
+
             return indexDoc.obj();
         }
     }
@@ -283,8 +288,17 @@ namespace mongo {
                                bool unique,
                                const BSONObj& writeConcern,
                                BatchedCommandResponse* response ) {
+        return clusterCreateIndex( ns, keys, unique, BSONObj(), writeConcern, response );
+    }
+
+    Status clusterCreateIndex( const string& ns,
+                               BSONObj keys,
+                               bool unique,
+                               const BSONObj& options,
+                               const BSONObj& writeConcern,
+                               BatchedCommandResponse* response ) {
         return clusterInsert( NamespaceString( ns ).getSystemIndexesCollection(),
-                              createIndexDoc( ns, keys, unique ),
+                              createIndexDoc( ns, keys, unique, options ),
                               writeConcern,
                               response );
     }
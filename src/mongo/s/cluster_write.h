@@ -124,4 +124,14 @@ namespace mongo {
                                const BSONObj& writeConcern,
                                BatchedCommandResponse* response );
 
+    /**
+     * As above, with additional index spec fields (e.g. "hashVersion") in 'options'.
+     */
+    Status clusterCreateIndex( const std::string& ns,
+                               BSONObj keys,
+                               bool unique,
+                               const BSONObj& options,
+                               const BSONObj& writeConcern,
+                               BatchedCommandResponse* response );
+
 } // namespace mongo
@@ -478,6 +478,43 @@ namespace mongo {
         return good;
     }
 
+    bool CollectionMetadata::keyBelongsToMe( const BSONObj& key, RangeCursor* cursor ) const {
+        if ( _keyPattern.isEmpty() ) {
+            return true;
+        }
+
+        if ( _rangesMap.empty() ) {
+            return false;
+        }
+
+        if ( cursor->_positioned ) {
+            RangeMap::const_iterator it = cursor->_range;
+            if ( key.woCompare( it->first ) >= 0 ) {
+                if ( key.woCompare( it->second ) < 0 ) {
+                    return true;
+                }
+
+                // Past the current range: the key is either in the gap before the next range,
+                // past the last range, or (most likely, for ordered keys) in the next range.
+                ++it;
+                if ( it == _rangesMap.end() || key.woCompare( it->first ) < 0 ) {
+                    return false;
+                }
+                if ( key.woCompare( it->second ) < 0 ) {
+                    cursor->_range = it;
+                    return true;
+                }
+            }
+        }
+
+        RangeMap::const_iterator it = _rangesMap.upper_bound( key );
+        if ( it != _rangesMap.begin() ) it--;
+
+        cursor->_positioned = true;
+        cursor->_range = it;
+        return rangeContains( it->first, it->second, key );
+    }
+
     bool CollectionMetadata::keyIsPending( const BSONObj& key ) const {
         // If we aren't sharded, then the key is never pending (though it belongs-to-me)
         if ( _keyPattern.isEmpty() ) {
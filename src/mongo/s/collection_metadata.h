@@ -62,6 +62,23 @@ namespace mongo {
     MONGO_DISALLOW_COPYING(CollectionMetadata);
     public:
 
+        /**
+         * Remembers which owned range held the last key checked through it, so that keys
+         * looked up in shard key order are usually answered against that range or the one
+         * after it instead of by a search of all ranges. A cursor is only meaningful for the
+         * metadata instance it was used with.
+         */
+        class RangeCursor {
+        public:
+            RangeCursor() : _positioned(false) { }
+
+        private:
+            friend class CollectionMetadata;
+
+            bool _positioned;
+            RangeMap::const_iterator _range;
+        };
+
         ~CollectionMetadata();
 
         //
@@ -148,6 +165,13 @@ namespace mongo {
          */
         bool keyBelongsToMe( const BSONObj& key ) const;
 
+        /**
+         * Same as above, but starts from the range 'cursor' was left at and leaves it at the
+         * range found for 'key'. Checking a key in the same range as the previous one takes two
+         * comparisons.
+         */
+        bool keyBelongsToMe( const BSONObj& key, RangeCursor* cursor ) const;
+
         /**
          * Returns true if the document key 'key' is or has been migrated to this shard, and may
          * belong to us after a subsequent config reload.  Key must be the full shard key.
@@ -1231,6 +1231,21 @@ namespace {
         ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << MAXKEY)) );
     }
 
+    TEST_F(ThreeChunkWithRangeGapFixture, OwnershipWithRangeCursor) {
+        // Keys in order, through the gap and into the second range, then back again.
+        CollectionMetadata::RangeCursor cursor;
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << MINKEY), &cursor) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 5), &cursor) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 19), &cursor) );
+        ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << 20), &cursor) );
+        ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << 29), &cursor) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 30), &cursor) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 40), &cursor) );
+        ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << MAXKEY), &cursor) );
+        ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << 25), &cursor) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 10), &cursor) );
+    }
+
     TEST_F(ThreeChunkWithRangeGapFixture, GetNextFromEmpty) {
         ChunkType nextChunk;
         ASSERT( getCollMetadata().getNextChunk( getCollMetadata().getMinKey(), &nextChunk ) );
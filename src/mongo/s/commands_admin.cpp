@@ -73,6 +73,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/print.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
@@ -463,6 +464,7 @@ namespace mongo {
             virtual void help( stringstream& help ) const {
                 help
                         << "Shard a collection.  Requires key.  Optional unique. Sharding must already be enabled for the database.\n"
+                        << "  Hashed keys take an optional hashVersion: 0 (md5, default) or 1 (murmur3).\n"
                         << "  { enablesharding : \"<dbname>\" }\n";
             }
             virtual Status checkAuthForCommand(ClientBasic* client,
@@ -531,6 +533,23 @@ namespace mongo {
                     return false;
                 }
 
+                // The hash function of a hashed shard key is fixed when the collection is
+                // sharded; it must match the hashVersion of the hashed index on the key.
+                int hashVersion = HASH_VERSION_MD5;
+                if (cmdObj.hasField("hashVersion")) {
+                    if (!isHashedShardKey) {
+                        errmsg = "hashVersion is only valid with a hashed shard key";
+                        return false;
+                    }
+                    if (!cmdObj["hashVersion"].isNumber()
+                        || !BSONElementHasher::isValidHashVersion(
+                                cmdObj["hashVersion"].numberInt())) {
+                        errmsg = "hashVersion must be 0 or 1";
+                        return false;
+                    }
+                    hashVersion = cmdObj["hashVersion"].numberInt();
+                }
+
                 if ( ns.find( ".system." ) != string::npos ) {
                     errmsg = "can't shard system namespaces";
                     return false;
@@ -574,6 +593,7 @@ namespace mongo {
                 //         iii. contains no null values
                 //         iv. is not multikey (maybe lift this restriction later)
                 //         v. if a hashed index, has default seed (lift this restriction later)
+                //            and the requested hashVersion
                 //
                 // 3. If the proposed shard key is specified as unique, there must exist a useful,
                 //    unique index exactly equal to the proposedKey (not just a prefix).
@@ -589,7 +609,7 @@ namespace mongo {
                 list<BSONObj> indexes = conn->getIndexSpecs( ns );
 
                 // 1.  Verify consistency with existing unique indexes
-                ShardKeyPattern proposedShardKey(proposedKey);
+                ShardKeyPattern proposedShardKey(proposedKey, hashVersion);
                 for ( list<BSONObj>::iterator it = indexes.begin(); it != indexes.end(); ++it ) {
                     BSONObj idx = *it;
                     BSONObj currentKey = idx["key"].embeddedObject();
@@ -629,6 +649,16 @@ namespace mongo {
                             return false;
                         }
 
+                        if ( isHashedShardKey && idx["hashVersion"].numberInt() != hashVersion ) {
+                            errmsg = str::stream()
+                                    << "can't shard collection " << ns << " with hashed shard key "
+                                    << proposedKey << " and hashVersion " << hashVersion
+                                    << " because the hashed index uses hashVersion "
+                                    << idx["hashVersion"].numberInt();
+                            conn.done();
+                            return false;
+                        }
+
                         hasUsefulIndexForKey = true;
                     }
                 }
@@ -689,9 +719,14 @@ namespace mongo {
                 //    receiving shard whenever a migrate occurs.
                 else {
                     // call ensureIndex with cache=false, see SERVER-1691
+                    BSONObj indexOptions;
+                    if ( hashVersion != HASH_VERSION_MD5 ) {
+                        indexOptions = BSON( "hashVersion" << hashVersion );
+                    }
                     Status result = clusterCreateIndex( ns,
                                                         proposedKey,
                                                         careAboutUnique,
+                                                        indexOptions,
                                                         WriteConcernOptions::Default,
                                                         NULL );
 
@@ -1594,6 +1629,7 @@ namespace mongo {
                 // compiled for.
                 result.append("maxWireVersion", maxWireVersion);
                 result.append("minWireVersion", minWireVersion);
+                negotiateMessageCompression(cmdObj, ClientBasic::getCurrent()->port(), &result);
 
                 return true;
             }
@@ -1192,6 +1192,9 @@ namespace mongo {
                         else if ( str::equals( e.fieldName() , "wiredTiger" ) ) {
                             //skip this field in the rollup
                         }
+                        else if ( str::equals( e.fieldName() , "planCache" ) ) {
+                            //skip this field in the rollup
+                        }
                         else if ( str::equals( e.fieldName() , "nindexes" ) ) {
                             int myIndexes = e.numberInt();
                             
@@ -2418,6 +2421,12 @@ namespace mongo {
             if (!pPipeline.get())
                 return false; // there was some parsing error
 
+            // mongos relays getMores one reply at a time, so it can't serve exhaust cursors.
+            if (!cmdObj.getFieldDotted("cursor.exhaust").eoo()) {
+                errmsg = "cursor.exhaust is not supported through mongos";
+                return false;
+            }
+
             /*
               If the system isn't running sharded, or the target collection
               isn't sharded, pass this on to a mongod.
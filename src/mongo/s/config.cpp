@@ -33,6 +33,7 @@
 #include "mongo/platform/basic.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include "pcrecpp.h"
 
 #include "mongo/client/connpool.h"
@@ -54,10 +55,12 @@
 #include "mongo/s/type_lockpings.h"
 #include "mongo/s/type_settings.h"
 #include "mongo/s/type_shard.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/stringutils.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -367,9 +370,11 @@ namespace mongo {
         BSONObj key;
         ChunkVersion oldVersion;
         ChunkManagerPtr oldManager;
+        unsigned long long loadsBeforeRequest;
 
         {
             scoped_lock lk( _lock );
+            loadsBeforeRequest = _chunkManagerLoads;
             
             bool earlyReload = ! _collections[ns].isSharded() && ( shouldReload || forceReload );
             if ( earlyReload ) {
@@ -423,9 +428,23 @@ namespace mongo {
         // we are not locked now, and want to load a new ChunkManager
         
         auto_ptr<ChunkManager> temp;
+        unsigned long long load;
 
         {
             scoped_lock lll ( _hitConfigServerLock );
+
+            {
+                // Coalesce with a load of this ns which started after we were asked to reload
+                // and finished while we waited for the config server lock
+                scoped_lock lk( _lock );
+                CollectionInfo& ci = _collections[ns];
+                if ( ! forceReload && ci.isSharded() && ci.getCM() &&
+                     _finishedChunkManagerLoads[ns] > loadsBeforeRequest ) {
+                    return ci.getCM();
+                }
+
+                load = ++_chunkManagerLoads;
+            }
             
             if ( ! newest.isEmpty() && ! forceReload ) {
                 // if we have a target we're going for
@@ -466,6 +485,9 @@ namespace mongo {
         CollectionInfo& ci = _collections[ns];
         uassert( 14822 ,  (string)"state changed in the middle: " + ns , ci.isSharded() );
 
+        unsigned long long& finishedLoad = _finishedChunkManagerLoads[ns];
+        finishedLoad = std::max( finishedLoad, load );
+
         // Reset if our versions aren't the same
         bool shouldReset = ! temp->getVersion().equals( ci.getCM()->getVersion() );
         
@@ -500,6 +522,47 @@ namespace mongo {
         return ci.getCM();
     }
 
+    void DBConfig::reloadChunkManagerInBackground( const string& ns ) {
+        {
+            scoped_lock lk( _lock );
+            if ( ! _backgroundReloads.insert( ns ).second ) {
+                return;
+            }
+        }
+
+        try {
+            boost::thread t( stdx::bind( &DBConfig::_backgroundChunkManagerReload, ns ) );
+            t.detach();
+        }
+        catch ( const boost::thread_resource_error& ) {
+            scoped_lock lk( _lock );
+            _backgroundReloads.erase( ns );
+            warning() << "could not start background chunk manager reload for " << ns
+                      << ", it will be reloaded the next time it is found stale" << endl;
+        }
+    }
+
+    void DBConfig::_backgroundChunkManagerReload( const string& ns ) {
+        setThreadName( "chunkManagerReload" );
+
+        DBConfigPtr config = grid.getDBConfig( ns, false );
+        if ( ! config ) {
+            return;
+        }
+
+        {
+            // Requests from here on need a load which starts after them
+            scoped_lock lk( config->_lock );
+            config->_backgroundReloads.erase( ns );
+        }
+
+        Timer t;
+        ChunkManagerPtr manager = config->getChunkManagerIfExists( ns, true );
+        LOG( 1 ) << "background chunk manager reload for " << ns << " took " << t.millis()
+                 << "ms, version is " << ( manager ? manager->getVersion().toString() : "(none)" )
+                 << endl;
+    }
+
     void DBConfig::setPrimary( const std::string& s ) {
         scoped_lock lk( _lock );
         _primary.reset( s );
@@ -111,7 +111,8 @@ namespace mongo {
                        false /* draining */),
               _shardingEnabled(false),
               _lock("DBConfig") ,
-              _hitConfigServerLock( "DBConfig::_hitConfigServerLock" ) {
+              _hitConfigServerLock( "DBConfig::_hitConfigServerLock" ),
+              _chunkManagerLoads( 0 ) {
             verify( name.size() );
         }
         virtual ~DBConfig() {}
@@ -158,6 +159,13 @@ namespace mongo {
         ChunkManagerPtr getChunkManager( const std::string& ns , bool reload = false, bool forceReload = false );
         ChunkManagerPtr getChunkManagerIfExists( const std::string& ns , bool reload = false, bool forceReload = false );
 
+        /**
+         * Reloads the chunk manager for ns on a background thread, operations keep routing with
+         * the current one until the new one is swapped in.  Does nothing if a background reload
+         * of ns is already waiting to start.
+         */
+        void reloadChunkManagerInBackground( const std::string& ns );
+
         const Shard& getShard( const std::string& ns );
         /**
          * @return the correct for shard for the ns
@@ -210,8 +218,17 @@ namespace mongo {
 
         Collections _collections;
 
+        static void _backgroundChunkManagerReload( const std::string& ns );
+
         mutable mongo::mutex _lock; // TODO: change to r/w lock ??
         mutable mongo::mutex _hitConfigServerLock;
+
+        // Chunk manager loads are numbered as they start, a caller which has to reload can use a
+        // load of the same ns that started after it asked instead of hitting the config server
+        // again.  Protected by _lock.
+        unsigned long long _chunkManagerLoads;
+        std::map<std::string, unsigned long long> _finishedChunkManagerLoads;
+        std::set<std::string> _backgroundReloads;
     };
 
     class ConfigServer : public DBConfig {
@@ -48,6 +48,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/max_time.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
@@ -60,10 +61,16 @@ namespace mongo {
     using std::stringstream;
 
     const int ShardedClientCursor::INIT_REPLY_BUFFER_SIZE = 32768;
+    const int ShardedClientCursor::THROTTLED_BATCH_SIZE = 100;
+
+    // Once the sharded cursors together hold this much, they ask the shards for small batches
+    // until enough of what they hold has been returned. 0 means no limit.
+    MONGO_EXPORT_SERVER_PARAMETER(mongosCursorBufferBudgetMB, int, 512);
 
     // Note: There is no counter for shardedEver from cursorInfo since it is deprecated
     static Counter64 cursorStatsMultiTarget;
     static Counter64 cursorStatsSingleTarget;
+    static Counter64 cursorStatsBufferedBytes;
 
     // Simple class to report the sum total open cursors = sharded + refs
     class CursorStatsSum {
@@ -84,6 +91,8 @@ namespace mongo {
                                                                         &cursorStatsSingleTarget);
     static ServerStatusMetricField<CursorStatsSum> dCursorStatsTotalOpen( "cursor.open.total",
                                                                           &cursorStatsTotalOpen);
+    static ServerStatusMetricField<Counter64> dCursorStatsBufferedBytes( "cursor.bufferedBytes",
+                                                                         &cursorStatsBufferedBytes);
 
 
     // --------  ShardedCursor -----------
@@ -107,6 +116,10 @@ namespace mongo {
         else
             _lastAccessMillis = Listener::getElapsedTimeMillis();
 
+        _bufferedBytes = 0;
+        _throttled = false;
+        _updateBufferedBytes();
+
         cursorStatsMultiTarget.increment();
     }
 
@@ -114,9 +127,19 @@ namespace mongo {
         verify( _cursor );
         delete _cursor;
         _cursor = 0;
+        cursorStatsBufferedBytes.decrement( _bufferedBytes );
         cursorStatsMultiTarget.decrement();
     }
 
+    void ShardedClientCursor::_updateBufferedBytes() {
+        const long long bytes = _cursor->getBufferedBytes();
+        if ( bytes > _bufferedBytes )
+            cursorStatsBufferedBytes.increment( bytes - _bufferedBytes );
+        else
+            cursorStatsBufferedBytes.decrement( _bufferedBytes - bytes );
+        _bufferedBytes = bytes;
+    }
+
     long long ShardedClientCursor::getId() {
         if ( _id <= 0 ) {
             _id = cursorCache.genId();
@@ -168,6 +191,14 @@ namespace mongo {
         const bool sendMoreBatches = ntoreturn == 0 || ntoreturn > 1;
         ntoreturn = abs( ntoreturn );
 
+        // Without a batch size the shards send as much as fits in a reply, which this cursor
+        // then holds until the client asks for it. Ask for small batches instead while the
+        // cursors hold more than their budget.
+        if ( ntoreturn == 0 && _throttled != CursorCache::isOverBufferBudget() ) {
+            _throttled = !_throttled;
+            _cursor->setBatchSize( _throttled ? THROTTLED_BATCH_SIZE : 0 );
+        }
+
         bool cursorHasMore = true;
         while ( ( cursorHasMore = _cursor->more() ) ) {
             BSONObj o = _cursor->next();
@@ -225,6 +256,8 @@ namespace mongo {
         _totalSent += docCount;
         _done = ! hasMoreBatches;
 
+        _updateBufferedBytes();
+
         return hasMoreBatches;
     }
 
@@ -237,31 +270,60 @@ namespace mongo {
         return sr->nextInt64();
     }
 
+    CursorCache::Stripe::Stripe()
+        : mutex( "CursorCache" ) {
+    }
+
     CursorCache::CursorCache()
-        :_mutex( "CursorCache" ),
+        :_randomMutex( "CursorCacheRandom" ),
          _random( getCCRandomSeed() ),
          _shardedTotal(0) {
     }
 
     CursorCache::~CursorCache() {
         // TODO: delete old cursors?
+        size_t sharded = 0;
+        size_t passthrough = 0;
+        for ( int i = 0; i < _numStripes; i++ ) {
+            verify(_stripes[i].refs.size() == _stripes[i].refsNS.size());
+            sharded += _stripes[i].cursors.size();
+            passthrough += _stripes[i].refs.size();
+        }
+
         bool print = shouldLog(logger::LogSeverity::Debug(1));
-        if ( _cursors.size() || _refs.size() )
+        if ( sharded || passthrough )
             print = true;
-        verify(_refs.size() == _refsNS.size());
-        
+
         if ( print ) 
             log() << " CursorCache at shutdown - "
-                  << " sharded: " << _cursors.size()
-                  << " passthrough: " << _refs.size()
+                  << " sharded: " << sharded
+                  << " passthrough: " << passthrough
                   << endl;
     }
 
+    long long CursorCache::getBufferedBytes() {
+        return cursorStatsBufferedBytes.get();
+    }
+
+    bool CursorCache::isOverBufferBudget() {
+        const long long budgetMB = mongosCursorBufferBudgetMB;
+        return budgetMB > 0 && getBufferedBytes() > budgetMB * 1024 * 1024;
+    }
+
+    CursorCache::Stripe& CursorCache::_stripe( long long id ) {
+        return _stripes[static_cast<unsigned long long>( id ) % _numStripes];
+    }
+
+    const CursorCache::Stripe& CursorCache::_stripe( long long id ) const {
+        return _stripes[static_cast<unsigned long long>( id ) % _numStripes];
+    }
+
     ShardedClientCursorPtr CursorCache::get( long long id ) const {
         LOG(_myLogLevel) << "CursorCache::get id: " << id << endl;
-        scoped_lock lk( _mutex );
-        MapSharded::const_iterator i = _cursors.find( id );
-        if ( i == _cursors.end() ) {
+        const Stripe& stripe = _stripe( id );
+        scoped_lock lk( stripe.mutex );
+        MapSharded::const_iterator i = stripe.cursors.find( id );
+        if ( i == stripe.cursors.end() ) {
             return ShardedClientCursorPtr();
         }
         i->second->accessed();
@@ -270,9 +332,10 @@ namespace mongo {
 
     int CursorCache::getMaxTimeMS( long long id ) const {
         verify( id );
-        scoped_lock lk( _mutex );
-        MapShardedInt::const_iterator i = _cursorsMaxTimeMS.find( id );
-        return ( i != _cursorsMaxTimeMS.end() ) ? i->second : 0;
+        const Stripe& stripe = _stripe( id );
+        scoped_lock lk( stripe.mutex );
+        MapShardedInt::const_iterator i = stripe.cursorsMaxTimeMS.find( id );
+        return ( i != stripe.cursorsMaxTimeMS.end() ) ? i->second : 0;
     }
 
     void CursorCache::store( ShardedClientCursorPtr cursor, int maxTimeMS ) {
@@ -284,10 +347,11 @@ namespace mongo {
         verify( maxTimeMS == kMaxTimeCursorTimeLimitExpired
                 || maxTimeMS == kMaxTimeCursorNoTimeLimit
                 || maxTimeMS > 0 );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS[cursor->getId()] = maxTimeMS;
-        _cursors[cursor->getId()] = cursor;
-        _shardedTotal++;
+        Stripe& stripe = _stripe( cursor->getId() );
+        scoped_lock lk( stripe.mutex );
+        stripe.cursorsMaxTimeMS[cursor->getId()] = maxTimeMS;
+        stripe.cursors[cursor->getId()] = cursor;
+        _shardedTotal.fetchAndAdd(1);
     }
 
     void CursorCache::updateMaxTimeMS( long long id, int maxTimeMS ) {
@@ -295,55 +359,61 @@ namespace mongo {
         verify( maxTimeMS == kMaxTimeCursorTimeLimitExpired
                 || maxTimeMS == kMaxTimeCursorNoTimeLimit
                 || maxTimeMS > 0 );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS[id] = maxTimeMS;
+        Stripe& stripe = _stripe( id );
+        scoped_lock lk( stripe.mutex );
+        stripe.cursorsMaxTimeMS[id] = maxTimeMS;
     }
 
     void CursorCache::remove( long long id ) {
         verify( id );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS.erase( id );
-        _cursors.erase( id );
+        Stripe& stripe = _stripe( id );
+        scoped_lock lk( stripe.mutex );
+        stripe.cursorsMaxTimeMS.erase( id );
+        stripe.cursors.erase( id );
     }
     
     void CursorCache::removeRef( long long id ) {
         verify( id );
-        scoped_lock lk( _mutex );
-        _refs.erase( id );
-        _refsNS.erase( id );
+        Stripe& stripe = _stripe( id );
+        scoped_lock lk( stripe.mutex );
+        stripe.refs.erase( id );
+        stripe.refsNS.erase( id );
         cursorStatsSingleTarget.decrement();
     }
 
     void CursorCache::storeRef(const std::string& server, long long id, const std::string& ns) {
         LOG(_myLogLevel) << "CursorCache::storeRef server: " << server << " id: " << id << endl;
         verify( id );
-        scoped_lock lk( _mutex );
-        _refs[id] = server;
-        _refsNS[id] = ns;
+        Stripe& stripe = _stripe( id );
+        scoped_lock lk( stripe.mutex );
+        stripe.refs[id] = server;
+        stripe.refsNS[id] = ns;
         cursorStatsSingleTarget.increment();
     }
 
     string CursorCache::getRef( long long id ) const {
         verify( id );
-        scoped_lock lk( _mutex );
-        MapNormal::const_iterator i = _refs.find( id );
+        const Stripe& stripe = _stripe( id );
+        scoped_lock lk( stripe.mutex );
+        MapNormal::const_iterator i = stripe.refs.find( id );
 
-        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == _refs.end() ? " NONE " : i->second ) << endl;
+        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == stripe.refs.end() ? " NONE " : i->second ) << endl;
 
-        if ( i == _refs.end() )
+        if ( i == stripe.refs.end() )
             return "";
         return i->second;
     }
 
     std::string CursorCache::getRefNS(long long id) const {
         verify(id);
-        scoped_lock lk(_mutex);
-        MapNormal::const_iterator i = _refsNS.find(id);
+        const Stripe& stripe = _stripe(id);
+        scoped_lock lk(stripe.mutex);
+        MapNormal::const_iterator i = stripe.refsNS.find(id);
 
         LOG(_myLogLevel) << "CursorCache::getRefNs id: " << id
-                << " out: " << ( i == _refsNS.end() ? " NONE " : i->second ) << std::endl;
+                << " out: " << ( i == stripe.refsNS.end() ? " NONE " : i->second ) << std::endl;
 
-        if ( i == _refsNS.end() )
+        if ( i == stripe.refsNS.end() )
             return "";
         return i->second;
     }
@@ -351,10 +421,11 @@ namespace mongo {
 
     long long CursorCache::genId() {
         while ( true ) {
-            scoped_lock lk( _mutex );
-
             long long x = Listener::getElapsedTimeMillis() << 32;
-            x |= _random.nextInt32();
+            {
+                scoped_lock lk( _randomMutex );
+                x |= _random.nextInt32();
+            }
 
             if ( x == 0 )
                 continue;
@@ -362,12 +433,15 @@ namespace mongo {
             if ( x < 0 )
                 x *= -1;
 
-            MapSharded::iterator i = _cursors.find( x );
-            if ( i != _cursors.end() )
+            const Stripe& stripe = _stripe( x );
+            scoped_lock lk( stripe.mutex );
+
+            MapSharded::const_iterator i = stripe.cursors.find( x );
+            if ( i != stripe.cursors.end() )
                 continue;
 
-            MapNormal::iterator j = _refs.find( x );
-            if ( j != _refs.end() )
+            MapNormal::const_iterator j = stripe.refs.find( x );
+            if ( j != stripe.refs.end() )
                 continue;
 
             return x;
@@ -403,10 +477,11 @@ namespace mongo {
 
             string server;
             {
-                scoped_lock lk( _mutex );
+                Stripe& stripe = _stripe( id );
+                scoped_lock lk( stripe.mutex );
 
-                MapSharded::iterator i = _cursors.find( id );
-                if ( i != _cursors.end() ) {
+                MapSharded::iterator i = stripe.cursors.find( id );
+                if ( i != stripe.cursors.end() ) {
                     Status authorizationStatus = authSession->checkAuthForKillCursors(
                             NamespaceString(i->second->getNS()), id);
                     audit::logKillCursorsAuthzCheck(
@@ -415,19 +490,19 @@ namespace mongo {
                             id,
                             authorizationStatus.isOK() ? ErrorCodes::OK : ErrorCodes::Unauthorized);
                     if (authorizationStatus.isOK()) {
-                        _cursorsMaxTimeMS.erase( i->second->getId() );
-                        _cursors.erase( i );
+                        stripe.cursorsMaxTimeMS.erase( i->second->getId() );
+                        stripe.cursors.erase( i );
                     }
                     continue;
                 }
 
-                MapNormal::iterator refsIt = _refs.find(id);
-                MapNormal::iterator refsNSIt = _refsNS.find(id);
-                if (refsIt == _refs.end()) {
+                MapNormal::iterator refsIt = stripe.refs.find(id);
+                MapNormal::iterator refsNSIt = stripe.refsNS.find(id);
+                if (refsIt == stripe.refs.end()) {
                     warning() << "can't find cursor: " << id << endl;
                     continue;
                 }
-                verify(refsNSIt != _refsNS.end());
+                verify(refsNSIt != stripe.refsNS.end());
                 Status authorizationStatus = authSession->checkAuthForKillCursors(
                         NamespaceString(refsNSIt->second), id);
                 audit::logKillCursorsAuthzCheck(
@@ -439,8 +514,8 @@ namespace mongo {
                     continue;
                 }
                 server = refsIt->second;
-                _refs.erase(refsIt);
-                _refsNS.erase(refsNSIt);
+                stripe.refs.erase(refsIt);
+                stripe.refsNS.erase(refsNSIt);
                 cursorStatsSingleTarget.decrement();
             }
 
@@ -454,28 +529,31 @@ namespace mongo {
     }
 
     void CursorCache::appendInfo( BSONObjBuilder& result ) const {
-        scoped_lock lk( _mutex );
         result.append( "sharded", static_cast<int>(cursorStatsMultiTarget.get()));
-        result.appendNumber( "shardedEver" , _shardedTotal );
+        result.appendNumber( "shardedEver" , _shardedTotal.load() );
         result.append( "refs", static_cast<int>(cursorStatsSingleTarget.get()));
         result.append( "totalOpen", static_cast<int>(cursorStatsTotalOpen.get()));
+        result.appendNumber( "bufferedBytes", getBufferedBytes() );
     }
 
     void CursorCache::doTimeouts() {
         long long now = Listener::getElapsedTimeMillis();
-        scoped_lock lk( _mutex );
-        for ( MapSharded::iterator i=_cursors.begin(); i!=_cursors.end(); ++i ) {
-            // Note: cursors with no timeout will always have an idleTime of 0
-            long long idleFor = i->second->idleTime( now );
-            if ( idleFor < TIMEOUT ) {
-                continue;
+        for ( int s = 0; s < _numStripes; s++ ) {
+            Stripe& stripe = _stripes[s];
+            scoped_lock lk( stripe.mutex );
+            for ( MapSharded::iterator i=stripe.cursors.begin(); i!=stripe.cursors.end(); ++i ) {
+                // Note: cursors with no timeout will always have an idleTime of 0
+                long long idleFor = i->second->idleTime( now );
+                if ( idleFor < TIMEOUT ) {
+                    continue;
+                }
+                log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
+                stripe.cursorsMaxTimeMS.erase( i->second->getId() );
+                stripe.cursors.erase( i );
+                i = stripe.cursors.begin(); // possible 2nd entry will get skipped, will get on next pass
+                if ( i == stripe.cursors.end() )
+                    break;
             }
-            log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
-            _cursorsMaxTimeMS.erase( i->second->getId() );
-            _cursors.erase( i );
-            i = _cursors.begin(); // possible 2nd entry will get skipped, will get on next pass
-            if ( i == _cursors.end() )
-                break;
         }
     }
 
@@ -39,6 +39,7 @@
 #include "mongo/client/parallel.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/request.h"
 
@@ -83,11 +84,22 @@ namespace mongo {
 
         std::string getNS() { return _cursor->getNS(); }
 
+        /** @return the bytes held in the batches received from the shards */
+        long long getBufferedBytes() const { return _bufferedBytes; }
+
         // The default initial buffer size for sending responses.
         static const int INIT_REPLY_BUFFER_SIZE;
 
+        // The shard batch size asked for while the cursors are over their buffer budget.
+        static const int THROTTLED_BATCH_SIZE;
+
     protected:
 
+        /**
+         * Refreshes _bufferedBytes from _cursor and the total buffered by all cursors.
+         */
+        void _updateBufferedBytes();
+
         ParallelSortClusteredCursor * _cursor;
 
         int _skip;
@@ -99,6 +111,9 @@ namespace mongo {
         long long _id;
         long long _lastAccessMillis; // 0 means no timeout
 
+        long long _bufferedBytes;
+        bool _throttled;
+
     };
 
     typedef boost::shared_ptr<ShardedClientCursor> ShardedClientCursorPtr;
@@ -112,6 +127,17 @@ namespace mongo {
         typedef std::map<long long,int> MapShardedInt;
         typedef std::map<long long,std::string> MapNormal;
 
+        /**
+         * @return the bytes buffered from the shards by all sharded cursors.
+         */
+        static long long getBufferedBytes();
+
+        /**
+         * @return whether the sharded cursors hold more than mongosCursorBufferBudgetMB of
+         * results, in which case they stop asking the shards for full batches.
+         */
+        static bool isOverBufferBudget();
+
         CursorCache();
         ~CursorCache();
 
@@ -138,26 +164,43 @@ namespace mongo {
         void doTimeouts();
         void startTimeoutThread();
     private:
-        mutable mongo::mutex _mutex;
+        /**
+         * The cursors are spread by ID over independently locked stripes, so that getMores on
+         * different cursors don't all contend for one mutex.
+         */
+        struct Stripe {
+            Stripe();
 
-        PseudoRandom _random;
+            mutable mongo::mutex mutex;
 
-        // Maps sharded cursor ID to ShardedClientCursorPtr.
-        MapSharded _cursors;
+            // Maps sharded cursor ID to ShardedClientCursorPtr.
+            MapSharded cursors;
 
-        // Maps sharded cursor ID to remaining max time.  Value can be any of:
-        // - the constant "kMaxTimeCursorNoTimeLimit", or
-        // - the constant "kMaxTimeCursorTimeLimitExpired", or
-        // - a positive integer representing milliseconds of remaining time
-        MapShardedInt _cursorsMaxTimeMS;
+            // Maps sharded cursor ID to remaining max time.  Value can be any of:
+            // - the constant "kMaxTimeCursorNoTimeLimit", or
+            // - the constant "kMaxTimeCursorTimeLimitExpired", or
+            // - a positive integer representing milliseconds of remaining time
+            MapShardedInt cursorsMaxTimeMS;
 
-        // Maps passthrough cursor ID to shard name.
-        MapNormal _refs;
+            // Maps passthrough cursor ID to shard name.
+            MapNormal refs;
 
-        // Maps passthrough cursor ID to namespace.
-        MapNormal _refsNS;
-        
-        long long _shardedTotal;
+            // Maps passthrough cursor ID to namespace.
+            MapNormal refsNS;
+        };
+
+        static const int _numStripes = 16;
+
+        Stripe& _stripe( long long id );
+        const Stripe& _stripe( long long id ) const;
+
+        Stripe _stripes[_numStripes];
+
+        // Protects _random.
+        mongo::mutex _randomMutex;
+        PseudoRandom _random;
+
+        AtomicInt64 _shardedTotal;
 
         static const int _myLogLevel;
     };
@@ -53,6 +53,7 @@
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
@@ -78,7 +79,9 @@
 #include "mongo/s/d_state.h"
 #include "mongo/s/distlock.h"
 #include "mongo/s/shard.h"
+#include "mongo/s/split_point_estimates.h"
 #include "mongo/s/type_chunk.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/exit.h"
@@ -240,11 +243,31 @@ namespace mongo {
 
     };
 
+    /**
+     * Returns the hashVersion of the hashed index backing a hashed 'shardKeyPattern', or 0 if
+     * the pattern is not hashed.  Shard keys extracted from documents on this shard must be
+     * hashed the way the index, and so the chunk bounds, were.
+     */
+    static int getShardKeyHashVersion( OperationContext* txn,
+                                       Collection* collection,
+                                       const BSONObj& shardKeyPattern ) {
+        if ( !collection || !KeyPattern::isHashedKeyPattern( shardKeyPattern ) )
+            return 0;
+
+        IndexDescriptor* idx =
+            collection->getIndexCatalog()->findIndexByPrefix( txn, shardKeyPattern, false );
+        if ( !idx )
+            return 0;
+
+        return idx->infoObj()["hashVersion"].numberInt();
+    }
+
     bool isInRange( const BSONObj& obj ,
                     const BSONObj& min ,
                     const BSONObj& max ,
-                    const BSONObj& shardKeyPattern ) {
-        ShardKeyPattern shardKey( shardKeyPattern );
+                    const BSONObj& shardKeyPattern ,
+                    int hashVersion = HASH_VERSION_MD5 ) {
+        ShardKeyPattern shardKey( shardKeyPattern , hashVersion );
         BSONObj k = shardKey.extractShardKeyFromDoc( obj );
         return k.woCompare( min ) >= 0 && k.woCompare( max ) < 0;
     }
@@ -256,6 +279,7 @@ namespace mongo {
             _inCriticalSection(false),
             _memoryUsed(0),
             _active(false),
+            _shardKeyHashVersion(0),
             _cloneLocsMutex("MigrateFromTrackerMutex") {
         }
 
@@ -286,6 +310,11 @@ namespace mongo {
             _max = max;
             _shardKeyPattern = shardKeyPattern;
 
+            Database* db = dbHolder().get(txn, nsToDatabaseSubstring(ns));
+            _shardKeyHashVersion = getShardKeyHashVersion(txn,
+                                                          db ? db->getCollection(ns) : NULL,
+                                                          shardKeyPattern);
+
             verify(_deleted.size() == 0);
             verify(_reload.size() == 0);
             verify(_memoryUsed == 0);
@@ -387,7 +416,7 @@ namespace mongo {
 
             }
 
-            if (!isInRange(it, _min, _max, _shardKeyPattern)) {
+            if (!isInRange(it, _min, _max, _shardKeyPattern, _shardKeyHashVersion)) {
                 return;
             }
 
@@ -818,6 +847,7 @@ namespace mongo {
         BSONObj _min;                                                                    // (MG)
         BSONObj _max;                                                                    // (MG)
         BSONObj _shardKeyPattern;                                                        // (MG)
+        int _shardKeyHashVersion;                                                        // (MG)
 
         mutable mongo::mutex _cloneLocsMutex;
 
@@ -866,6 +896,7 @@ namespace mongo {
                           BSONObj * patt,
                           bool notInActiveChunk) {
         migrateFromStatus.logOp(txn, opstr, ns, obj, patt, notInActiveChunk);
+        splitPointEstimates.logOp(opstr, ns, obj, notInActiveChunk);
     }
 
     class TransferModsCommand : public ChunkCommandHelper {
@@ -1410,6 +1441,7 @@ namespace mongo {
                     // until the commit it done
                     shardingState.donateChunk(txn, ns, min, max, myVersion);
                 }
+                splitPointEstimates.forgetRange(ns, min, max);
 
                 log() << "moveChunk setting version to: " << myVersion << migrateLog;
 
@@ -1760,6 +1792,53 @@ namespace mongo {
     MONGO_FP_DECLARE(migrateThreadHangAtStep4);
     MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+    /**
+     * Fetches the next _migrateClone batch from the donor on its own thread, so the recipient can
+     * insert one batch while the donor reads and sends the next.  The connection must not be used
+     * by anyone else until wait() returns.
+     */
+    class CloneBatchFetcher {
+        MONGO_DISALLOW_COPYING(CloneBatchFetcher);
+    public:
+        explicit CloneBatchFetcher(DBClientBase* conn) :
+            _conn(conn),
+            _ok(false),
+            _status(Status::OK()),
+            _thread(stdx::bind(&CloneBatchFetcher::_fetch, this)) {
+        }
+
+        ~CloneBatchFetcher() {
+            _thread.join();
+        }
+
+        /**
+         * Waits for the batch to arrive.  Returns false if the command failed, throws if the
+         * request couldn't be sent or the response received.
+         */
+        bool wait(BSONObj* res) {
+            _thread.join();
+            uassertStatusOK(_status);
+            *res = _res;
+            return _ok;
+        }
+
+    private:
+        void _fetch() {
+            try {
+                _ok = _conn->runCommand("admin", BSON("_migrateClone" << 1), _res);
+            }
+            catch (const DBException& ex) {
+                _status = ex.toStatus();
+            }
+        }
+
+        DBClientBase* const _conn;
+        bool _ok;
+        BSONObj _res;
+        Status _status;
+        boost::thread _thread;
+    };
+
     class MigrateStatus {
     public:
         enum State {
@@ -1776,6 +1855,7 @@ namespace mongo {
         MigrateStatus():
             _mutex("MigrateStatus"),
             _active(false),
+            _shardKeyHashVersion(0),
             _numCloned(0),
             _clonedBytes(0),
             _numCatchup(0),
@@ -1996,6 +2076,8 @@ namespace mongo {
                     wunit.commit();
                 }
 
+                _shardKeyHashVersion = getShardKeyHashVersion(txn, collection, shardKeyPattern);
+
                 timing.done(1);
                 MONGO_FP_PAUSE_WHILE(migrateThreadHangAtStep1);
             }
@@ -2062,9 +2144,15 @@ namespace mongo {
                 // 3. initial bulk clone
                 setState(CLONE);
 
+                // gets array of objects to copy, in disk order
+                scoped_ptr<CloneBatchFetcher> fetcher(new CloneBatchFetcher(conn.get()));
+
                 while ( true ) {
                     BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    bool fetched = fetcher->wait( &res );
+                    fetcher.reset();
+
+                    if ( ! fetched ) {
                         setState(FAIL);
                         errmsg = "_migrateClone failed: ";
                         errmsg += res.toString();
@@ -2076,6 +2164,11 @@ namespace mongo {
                     BSONObj arr = res["objects"].Obj();
                     int thisTime = 0;
 
+                    // Ask for the next batch while this one is inserted
+                    if ( ! arr.isEmpty() ) {
+                        fetcher.reset(new CloneBatchFetcher(conn.get()));
+                    }
+
                     BSONObjIterator i( arr );
                     while( i.more() ) {
                         txn->checkForInterrupt();
@@ -2341,7 +2434,8 @@ namespace mongo {
                     // do not apply deletes if they do not belong to the chunk being migrated
                     BSONObj fullObj;
                     if (Helpers::findById(txn, ctx.db(), ns.c_str(), id, fullObj)) {
-                        if (!isInRange(fullObj , min , max , shardKeyPattern)) {
+                        if (!isInRange(fullObj , min , max , shardKeyPattern,
+                                       _shardKeyHashVersion)) {
                             log() << "not applying out of range deletion: " << fullObj << migrateLog;
 
                             continue;
@@ -2423,7 +2517,8 @@ namespace mongo {
 
             *localDoc = BSONObj();
             if ( Helpers::findById( txn, db, ns.c_str(), remoteDoc, *localDoc ) ) {
-                return !isInRange( *localDoc , min , max , shardKeyPattern );
+                return !isInRange( *localDoc , min , max , shardKeyPattern ,
+                                   _shardKeyHashVersion );
             }
 
             return false;
@@ -2556,6 +2651,9 @@ namespace mongo {
         BSONObj _max;
         BSONObj _shardKeyPattern;
 
+        // Only used by the migration thread, which sets it once the indexes are in place
+        int _shardKeyHashVersion;
+
         long long _numCloned;
         long long _clonedBytes;
         long long _numCatchup;
@@ -2843,6 +2941,15 @@ namespace mongo {
             verify( ! isInRange( BSON( "x" << 3 ) , min , max , hashedKey ) );
             verify( ! isInRange( BSON( "x" << 4 ) , min2 , max2 , hashedKey ) );
 
+            BSONObj min3 = BSON( "x" << BSONElementHasher::hash64( obj.firstElement() , 0 ,
+                                                                   HASH_VERSION_MURMUR3 ) - 2 );
+            BSONObj max3 = BSON( "x" << BSONElementHasher::hash64( obj.firstElement() , 0 ,
+                                                                   HASH_VERSION_MURMUR3 ) + 2 );
+
+            verify( isInRange( BSON( "x" << 3 ) , min3 , max3 , hashedKey ,
+                               HASH_VERSION_MURMUR3 ) );
+            verify( ! isInRange( BSON( "x" << 3 ) , min3 , max3 , hashedKey ) );
+
             LOG(1) << "isInRangeTest passed" << migrateLog;
         }
     } isInRangeTest;
@@ -32,10 +32,12 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/auth/action_set.h"
@@ -45,17 +47,20 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/chunk.h" // for static genID only
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
 #include "mongo/s/d_state.h"
 #include "mongo/s/distlock.h"
 #include "mongo/s/shard_key_pattern.h"
+#include "mongo/s/split_point_estimates.h"
 #include "mongo/s/type_chunk.h"
 #include "mongo/util/log.h"
 #include "mongo/util/timer.h"
@@ -70,6 +75,22 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    // When set, splitVector answers from the shard's estimate of the chunk when it has one
+    // instead of scanning the chunk's range of the shard key index.
+    MONGO_EXPORT_SERVER_PARAMETER(splitVectorUseEstimates, bool, true);
+
+    // Number of samples splitVector keeps for a chunk's worth of documents
+    static const long long kSplitVectorSamplesPerChunk = 64;
+
+    static Counter64 splitVectorEstimatedCounter;
+    static Counter64 splitVectorScannedCounter;
+    static ServerStatusMetricField<Counter64> displaySplitVectorEstimated(
+                                                    "sharding.splitVector.estimated",
+                                                    &splitVectorEstimatedCounter);
+    static ServerStatusMetricField<Counter64> displaySplitVectorScanned(
+                                                    "sharding.splitVector.scanned",
+                                                    &splitVectorScannedCounter);
+
     class CmdMedianKey : public Command {
     public:
         CmdMedianKey() : Command( "medianKey" ) {}
@@ -308,6 +329,11 @@ namespace mongo {
                              keyPattern.clientReadable().toString();
                     return false;
                 }
+                // The estimates are kept over the shard key alone
+                KeyPattern shardKeyPattern( keyPattern );
+                const BSONObj estimateMin = shardKeyPattern.extendRangeBound( min, false );
+                const BSONObj estimateMax = shardKeyPattern.extendRangeBound( max, max.isEmpty() );
+
                 // extend min to get (min, MinKey, MinKey, ....)
                 KeyPattern kp( idx->keyPattern() );
                 min = Helpers::toKeyFormat( kp.extendRangeBound ( min, false ) );
@@ -380,13 +406,49 @@ namespace mongo {
                     keyCount = maxChunkObjects;
                 }
                 
+                Timer timer;
+
+                //
+                // 2.a If an earlier scan left an estimate of this range behind, pick the split
+                //     points from it instead of going over the index again.
+                //
+
+                OID epoch;
+                CollectionMetadataPtr metadata = shardingState.getCollectionMetadata( ns );
+                if ( metadata ) {
+                    epoch = metadata->getCollVersion().epoch();
+                }
+
+                if ( !forceMedianSplit && splitVectorUseEstimates &&
+                     splitPointEstimates.findSplitPoints( ns, keyPattern, epoch,
+                                                          estimateMin, estimateMax,
+                                                          keyCount, maxSplitPoints,
+                                                          &splitKeys ) ) {
+                    splitVectorEstimatedCounter.increment();
+                    LOG(1) << "estimated " << splitKeys.size() << " split points for chunk "
+                           << ns << " " << min << " -->> " << max << endl;
+                    result.append( "timeMillis", timer.millis() );
+                    result.append( "splitKeys" , splitKeys );
+                    return true;
+                }
+                splitVectorScannedCounter.increment();
+
                 //
-                // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
+                // 2.b Traverse the index and add the keyCount-th key to the result vector. If that key
                 //    appeared in the vector before, we omit it. The invariant here is that all the
                 //    instances of a given key value live in the same chunk.
                 //
-                
-                Timer timer;
+                //    While at it, keep a key every 'docsPerSample' keys. A complete scan of the
+                //    range becomes the estimate used by later requests.
+                //
+
+                const bool seedEstimate = !forceMedianSplit && splitVectorUseEstimates;
+                const unsigned long long seedSequence = splitPointEstimates.currentSequence();
+                const long long docsPerSample =
+                    std::max( 2 * keyCount / kSplitVectorSamplesPerChunk, 1LL );
+                long long docsSinceSample = 0;
+                vector<SplitPointEstimates::Sample> samples;
+
                 long long currCount = 0;
                 long long numChunks = 0;
                 
@@ -411,7 +473,14 @@ namespace mongo {
                 while ( 1 ) {
                     while (PlanExecutor::ADVANCED == state) {
                         currCount++;
-                        
+
+                        if ( seedEstimate && ++docsSinceSample >= docsPerSample ) {
+                            samples.push_back( SplitPointEstimates::Sample(
+                                prettyKey(idx->keyPattern(), currKey).extractFields(keyPattern),
+                                docsSinceSample ) );
+                            docsSinceSample = 0;
+                        }
+
                         if ( currCount > keyCount && !forceMedianSplit ) {
                             currKey = prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields(keyPattern);
                             // Do not use this split key if it is the same used in the previous split point.
@@ -457,6 +526,17 @@ namespace mongo {
                     state = exec->getNext(&currKey, NULL);
                 }
 
+                if ( seedEstimate && PlanExecutor::IS_EOF == state ) {
+                    if ( docsSinceSample && !samples.empty() ) {
+                        samples.back().docs += docsSinceSample;
+                    }
+                    const int hashVersion = KeyPattern::isHashedKeyPattern( keyPattern ) ?
+                        idx->infoObj()["hashVersion"].numberInt() : 0;
+                    splitPointEstimates.seed( ns, keyPattern, hashVersion, epoch,
+                                              estimateMin, estimateMax,
+                                              docsPerSample, samples, seedSequence );
+                }
+
                 //
                 // 3. Format the result and issue any warnings about the data we gathered while traversing the
                 //    index
@@ -38,6 +38,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -48,6 +49,7 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/db.h"
 #include "mongo/db/operation_context.h"
@@ -77,7 +79,9 @@ namespace mongo {
 
     ShardingState::ShardingState()
         : _enabled(false) , _mutex( "ShardingState" ),
-          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ) {
+          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ),
+          _metadataLoads( 0 ),
+          _coalescedMetadataLoads( 0 ) {
     }
 
     void ShardingState::enable( const string& server ) {
@@ -162,6 +166,7 @@ namespace mongo {
         _configServer.clear();
         _shardName.clear();
         _collMetadata.clear();
+        _finishedMetadataLoads.clear();
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
@@ -389,6 +394,7 @@ namespace mongo {
                   << endl;
 
         _collMetadata.erase( ns );
+        _finishedMetadataLoads.erase( ns );
     }
 
     Status ShardingState::refreshMetadataIfNeeded( OperationContext* txn,
@@ -402,6 +408,12 @@ namespace mongo {
         LOG( 2 ) << "metadata refresh requested for " << ns << " at shard version "
                  << reqShardVersion << endl;
 
+        unsigned long long loadsBeforeRequest;
+        {
+            scoped_lock lk( _mutex );
+            loadsBeforeRequest = _metadataLoads;
+        }
+
         //
         // Queuing of refresh requests starts here when remote reload is needed. This may take time.
         // TODO: Explicitly expose the queuing discipline.
@@ -416,10 +428,17 @@ namespace mongo {
         //
 
         CollectionMetadataPtr storedMetadata;
+        bool refreshedSinceRequest;
         {
             scoped_lock lk( _mutex );
             CollectionMetadataMap::iterator it = _collMetadata.find( ns );
             if ( it != _collMetadata.end() ) storedMetadata = it->second;
+
+            std::map<string, unsigned long long>::const_iterator loadIt =
+                _finishedMetadataLoads.find( ns );
+            refreshedSinceRequest = loadIt != _finishedMetadataLoads.end() &&
+                                    loadIt->second > loadsBeforeRequest;
+            if ( refreshedSinceRequest ) _coalescedMetadataLoads++;
         }
         ChunkVersion storedShardVersion;
         if ( storedMetadata ) storedShardVersion = storedMetadata->getShardVersion();
@@ -432,6 +451,15 @@ namespace mongo {
             return Status::OK();
         }
 
+        if ( refreshedSinceRequest ) {
+
+            // A refresh which started after this request arrived has already seen everything
+            // the config server knew when it was made, so asking again can't get anything newer.
+            LOG( 1 ) << "metadata for " << ns << " was refreshed while waiting, shard version is "
+                     << storedShardVersion << endl;
+            return Status::OK();
+        }
+
         //
         // Slow path - remotely reload
         //
@@ -481,6 +509,7 @@ namespace mongo {
         CollectionMetadataPtr beforeMetadata;
         string shardName;
         string configServer;
+        unsigned long long load;
 
         {
             scoped_lock lk( _mutex );
@@ -512,6 +541,8 @@ namespace mongo {
 
             CollectionMetadataMap::iterator it = _collMetadata.find( ns );
             if ( it != _collMetadata.end() ) beforeMetadata = it->second;
+
+            load = ++_metadataLoads;
         }
 
         ChunkVersion beforeShardVersion;
@@ -675,6 +706,11 @@ namespace mongo {
                                                         afterCollVersion,
                                                         remoteCollVersion );
 
+            if ( choice != ChunkVersion::VersionChoice_Unknown ) {
+                unsigned long long& finishedLoad = _finishedMetadataLoads[ns];
+                finishedLoad = std::max( finishedLoad, load );
+            }
+
             if ( choice == ChunkVersion::VersionChoice_Remote ) {
                 dassert(!remoteCollVersion.epoch().isSet() ||
                         remoteShardVersion >= beforeShardVersion);
@@ -1269,6 +1305,54 @@ namespace mongo {
 
     } getShardVersion;
 
+    void ShardingState::appendRefreshTicketStats(BSONObjBuilder* builder) const {
+        builder->append("out", _configServerTickets.used());
+        builder->append("available", _configServerTickets.available());
+        {
+            scoped_lock lk(_mutex);
+            builder->appendNumber("coalesced", static_cast<long long>(_coalescedMetadataLoads));
+        }
+
+        static const char* const priorityNames[] = { "normal", "high" };
+        for (int i = 0; i < TicketHolder::kNumPriorities; i++) {
+            const TicketHolder::WaitStats stats = _configServerTickets.getWaitStats(
+                    static_cast<TicketHolder::Priority>(i));
+
+            BSONObjBuilder priorityBuilder(builder->subobjStart(priorityNames[i]));
+            priorityBuilder.appendNumber("waits", stats.waits);
+            priorityBuilder.appendNumber("totalWaitMicros", stats.totalWaitMicros);
+
+            BSONArrayBuilder bucketsBuilder(priorityBuilder.subarrayStart("waitMicrosHistogram"));
+            for (int b = 0; b < TicketHolder::kNumWaitBuckets; b++) {
+                BSONObjBuilder bucketBuilder(bucketsBuilder.subobjStart());
+                if (b < TicketHolder::kNumWaitBuckets - 1) {
+                    bucketBuilder.appendNumber("lessThan", TicketHolder::kWaitBucketBoundsMicros[b]);
+                }
+                bucketBuilder.appendNumber("count", stats.buckets[b]);
+                bucketBuilder.doneFast();
+            }
+            bucketsBuilder.doneFast();
+            priorityBuilder.doneFast();
+        }
+    }
+
+namespace {
+
+    class MetadataRefreshTicketsMetric : public ServerStatusMetric {
+    public:
+        MetadataRefreshTicketsMetric()
+            : ServerStatusMetric("sharding.metadataRefreshTickets") { }
+
+        virtual void appendAtLeaf(BSONObjBuilder& b) const {
+            BSONObjBuilder ticketsBuilder(b.subobjStart(_leafName));
+            shardingState.appendRefreshTicketStats(&ticketsBuilder);
+            ticketsBuilder.doneFast();
+        }
+
+    } metadataRefreshTicketsMetric;
+
+}  // namespace
+
     class ShardingStateCmd : public MongodShardCommand {
     public:
         ShardingStateCmd() : MongodShardCommand( "shardingState" ) {}
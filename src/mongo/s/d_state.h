@@ -128,6 +128,12 @@ namespace mongo {
 
         void appendInfo( BSONObjBuilder& b );
 
+        /**
+         * Appends usage and queueing statistics of the tickets limiting concurrent metadata
+         * refreshes from the config server.
+         */
+        void appendRefreshTicketStats(BSONObjBuilder* builder) const;
+
         // querying support
 
         bool needCollectionMetadata( const std::string& ns ) const;
@@ -290,6 +296,13 @@ namespace mongo {
         // Map from a namespace into the metadata we need for each collection on this shard
         typedef std::map<std::string,CollectionMetadataPtr> CollectionMetadataMap;
         CollectionMetadataMap _collMetadata;
+
+        // Remote metadata refreshes are numbered as they start, a stale request which had to wait
+        // for a ticket can use a refresh of the same ns that started after it arrived instead of
+        // asking the config server again.  Protected by _mutex.
+        unsigned long long _metadataLoads;
+        std::map<std::string, unsigned long long> _finishedMetadataLoads;
+        unsigned long long _coalescedMetadataLoads;
     };
 
     extern ShardingState shardingState;
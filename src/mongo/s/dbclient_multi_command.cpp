@@ -29,6 +29,7 @@
 #include "mongo/s/dbclient_multi_command.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <vector>
 
 #include "mongo/bson/mutable/document.h"
 #include "mongo/db/audit.h"
@@ -39,12 +40,14 @@
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/socket_poll.h"
 
 namespace mongo {
 
     using boost::scoped_ptr;
     using std::deque;
     using std::string;
+    using std::vector;
 
     DBClientMultiCommand::PendingCommand::PendingCommand( const ConnectionString& endpoint,
                                                           const StringData& dbName,
@@ -171,10 +174,75 @@ namespace mongo {
         return static_cast<int>( _pendingCommands.size() );
     }
 
+    namespace {
+
+        /**
+         * Returns the socket a pending command's response will arrive on, or NULL if the
+         * connection isn't a plain DBClientConnection we can poll.
+         */
+        Socket* pollableSocket( DBClientBase* conn ) {
+            DBClientConnection* dbConn = dynamic_cast<DBClientConnection*>( conn );
+            if ( NULL == dbConn ) return NULL;
+            return dbConn->port().psock.get();
+        }
+    }
+
+    DBClientMultiCommand::PendingQueue::iterator DBClientMultiCommand::waitForAny() {
+
+        // Commands which failed to send are already done, report them first
+        for ( PendingQueue::iterator it = _pendingCommands.begin();
+            it != _pendingCommands.end(); ++it ) {
+            if ( !( *it )->status.isOK() ) return it;
+        }
+
+        if ( _pendingCommands.size() == 1 || !isPollSupported() ) {
+            return _pendingCommands.begin();
+        }
+
+        vector<pollfd> pollInfo;
+        pollInfo.reserve( _pendingCommands.size() );
+
+        // Never wait longer than the shortest socket timeout, which is how long a plain recv on
+        // that connection would have waited
+        int timeoutMillis = _timeoutMillis > 0 ? _timeoutMillis : -1;
+
+        for ( PendingQueue::iterator it = _pendingCommands.begin();
+            it != _pendingCommands.end(); ++it ) {
+
+            Socket* socket = pollableSocket( ( *it )->conn );
+            if ( NULL == socket || socket->rawFD() < 0 ) return _pendingCommands.begin();
+
+            int soTimeoutMillis = static_cast<int>( ( *it )->conn->getSoTimeout() * 1000 );
+            if ( soTimeoutMillis > 0 && ( timeoutMillis < 0 || soTimeoutMillis < timeoutMillis ) ) {
+                timeoutMillis = soTimeoutMillis;
+            }
+
+            pollfd info;
+            info.fd = socket->rawFD();
+            info.events = POLLIN;
+            info.revents = 0;
+            pollInfo.push_back( info );
+        }
+
+        // A timeout or a poll error falls back to waiting on the oldest command, whose recv then
+        // reports the problem through the usual socket timeout and error handling
+        int nEvents = socketPoll( &pollInfo[0], pollInfo.size(), timeoutMillis );
+        if ( nEvents <= 0 ) return _pendingCommands.begin();
+
+        for ( size_t i = 0; i < pollInfo.size(); ++i ) {
+            if ( pollInfo[i].revents != 0 ) return _pendingCommands.begin() + i;
+        }
+
+        return _pendingCommands.begin();
+    }
+
     Status DBClientMultiCommand::recvAny( ConnectionString* endpoint, BSONSerializable* response ) {
 
-        scoped_ptr<PendingCommand> command( _pendingCommands.front() );
-        _pendingCommands.pop_front();
+        // Responses are handled in the order the shards answer, so one slow shard doesn't hold
+        // up processing of the others
+        PendingQueue::iterator next = waitForAny();
+        scoped_ptr<PendingCommand> command( *next );
+        _pendingCommands.erase( next );
 
         *endpoint = command->endpoint;
         if ( !command->status.isOK() ) return command->status;
@@ -82,6 +82,14 @@ namespace mongo {
         };
 
         typedef std::deque<PendingCommand*> PendingQueue;
+
+        /**
+         * Blocks until one of the pending commands has a response (or an error) ready, and
+         * returns it.  Falls back to the oldest pending command if the connections can't be
+         * polled.
+         */
+        PendingQueue::iterator waitForAny();
+
         PendingQueue _pendingCommands;
         int _timeoutMillis;
     };
@@ -125,7 +125,11 @@ namespace mongo {
                                                << " and process " << process
                                                << " (sleeping for " << sleepTime << "ms)" << endl;
 
-            static int loops = 0;
+            // The lockpings cleanup below only removes entries which have not pinged for days, so
+            // it is only done every few pings instead of costing two more round trips in each.
+            static const int pingsPerCleanup = 10;
+
+            int loops = 0;
             Date_t lastPingTime = jsTime();
             while( ! inShutdown() && ! shouldKill( addr, process ) ) {
 
@@ -168,46 +172,49 @@ namespace mongo {
                     // and no new instance came up to replace it for a quite a while.
                     // NOTE this is NOT the same as the standard take-over mechanism, which forces
                     // the lock entry.
-                    BSONObj fieldsToReturn = BSON( LocksType::state() << 1 <<
-                                                   LocksType::process() << 1 );
-                    auto_ptr<DBClientCursor> activeLocks =
-                        conn->query( LocksType::ConfigNS,
-                                     BSON( LocksType::state() << GT << 0 ) );
-
-                    uassert( 16060,
-                             str::stream() << "cannot query locks collection on config server "
-                                           << conn.getHost(),
-                             activeLocks.get() );
-
-                    set<string> pids;
-                    while ( activeLocks->more() ) {
-                        BSONObj lock = activeLocks->nextSafe();
-
-                        if ( !lock[LocksType::process()].eoo() ) {
-                            pids.insert( lock[LocksType::process()].str() );
-                        }
-                        else {
-                            warning() << "found incorrect lock document during lock ping cleanup: "
-                                      << lock.toString() << endl;
+                    if ( loops % pingsPerCleanup == 0 ) {
+                        BSONObj fieldsToReturn = BSON( LocksType::state() << 1 <<
+                                                       LocksType::process() << 1 );
+                        auto_ptr<DBClientCursor> activeLocks =
+                            conn->query( LocksType::ConfigNS,
+                                         BSON( LocksType::state() << GT << 0 ),
+                                         0, 0, &fieldsToReturn );
+
+                        uassert( 16060,
+                                 str::stream() << "cannot query locks collection on config server "
+                                               << conn.getHost(),
+                                 activeLocks.get() );
+
+                        set<string> pids;
+                        while ( activeLocks->more() ) {
+                            BSONObj lock = activeLocks->nextSafe();
+
+                            if ( !lock[LocksType::process()].eoo() ) {
+                                pids.insert( lock[LocksType::process()].str() );
+                            }
+                            else {
+                                warning() << "found incorrect lock document during lock ping cleanup: "
+                                          << lock.toString() << endl;
+                            }
                         }
-                    }
-
-                    Date_t fourDays = pingTime - ( 4 * 86400 * 1000 ); // 4 days
-                    conn->remove( LockpingsType::ConfigNS,
-                                  BSON( LockpingsType::process() << NIN << pids <<
-                                        LockpingsType::ping() << LT << fourDays ) );
-                    err = conn->getLastError();
-                    if ( ! err.empty() ) {
-                        warning() << "ping cleanup for distributed lock pinger '" << pingId << " failed."
-                                  << causedBy( err ) << endl;
-                        conn.done();
 
-                        // Sleep for normal ping time
-                        sleepmillis(sleepTime);
-                        continue;
+                        Date_t fourDays = pingTime - ( 4 * 86400 * 1000 ); // 4 days
+                        conn->remove( LockpingsType::ConfigNS,
+                                      BSON( LockpingsType::process() << NIN << pids <<
+                                            LockpingsType::ping() << LT << fourDays ) );
+                        err = conn->getLastError();
+                        if ( ! err.empty() ) {
+                            warning() << "ping cleanup for distributed lock pinger '" << pingId << " failed."
+                                      << causedBy( err ) << endl;
+                            conn.done();
+
+                            // Sleep for normal ping time
+                            sleepmillis(sleepTime);
+                            continue;
+                        }
                     }
 
-                    LOG( DistributedLock::logLvl - ( loops % 10 == 0 ? 1 : 0 ) ) << "cluster " << addr << " pinged successfully at " << pingTime
+                    LOG( DistributedLock::logLvl - ( loops++ % 10 == 0 ? 1 : 0 ) ) << "cluster " << addr << " pinged successfully at " << pingTime
                             << " by distributed lock pinger '" << pingId
                             << "', sleeping for " << sleepTime << "ms" << endl;
 
@@ -220,30 +227,34 @@ namespace mongo {
                         LOG( DistributedLock::logLvl - 1 ) << "trying to delete " << _oldLockOIDs.size() << " old lock entries for process " << process << endl;
                     }
 
-                    bool removed = false;
-                    for( list<OID>::iterator i = _oldLockOIDs.begin(); i != _oldLockOIDs.end();
-                            i = ( removed ? _oldLockOIDs.erase( i ) : ++i ) ) {
-                        removed = false;
+                    // All the old locks are released by one update, since each ts is unique
+                    if( numOldLocks > 0 ) {
+                        BSONArrayBuilder oldLockIDs;
+                        for( list<OID>::const_iterator i = _oldLockOIDs.begin();
+                                i != _oldLockOIDs.end(); ++i ) {
+                            oldLockIDs.append( *i );
+                        }
+
                         try {
-                            // Got OID from lock with id, so we don't need to specify id again
+                            // Got OIDs from locks with ids, so we don't need to specify ids again
                             conn->update( LocksType::ConfigNS ,
-                                          BSON( LocksType::lockID(*i) ),
-                                          BSON( "$set" << BSON( LocksType::state(0) ) ) );
+                                          BSON( LocksType::lockID() << BSON( "$in" << oldLockIDs.arr() ) ),
+                                          BSON( "$set" << BSON( LocksType::state(0) ) ),
+                                          false, true );
 
                             // Either the update went through or it didn't, either way we're done trying to
                             // unlock
-                            LOG( DistributedLock::logLvl - 1 ) << "handled late remove of old distributed lock with ts " << *i << endl;
-                            removed = true;
+                            LOG( DistributedLock::logLvl - 1 ) << "handled late remove of " << numOldLocks << " old distributed locks" << endl;
+                            _oldLockOIDs.clear();
                         }
                         catch( UpdateNotTheSame& ) {
-                            LOG( DistributedLock::logLvl - 1 ) << "partially removed old distributed lock with ts " << *i << endl;
-                            removed = true;
+                            LOG( DistributedLock::logLvl - 1 ) << "partially removed " << numOldLocks << " old distributed locks" << endl;
+                            _oldLockOIDs.clear();
                         }
                         catch ( std::exception& e) {
-                            warning() << "could not remove old distributed lock with ts " << *i
+                            warning() << "could not remove " << numOldLocks << " old distributed locks"
                                       << causedBy( e ) <<  endl;
                         }
-
                     }
 
                     if( numOldLocks > 0 && _oldLockOIDs.size() > 0 ){
@@ -900,10 +911,9 @@ namespace mongo {
             BSONObj err = conn->getLastErrorDetailed();
             string errMsg = DBClientWithCommands::getLastErrorString(err);
 
-            currLock = conn->findOne( LocksType::ConfigNS , BSON( LocksType::name(_name) ) );
-
             if ( !errMsg.empty() || !err["n"].type() || err["n"].numberInt() < 1 ) {
                 logErrMsgOrWarn("could not acquire lock", lockName, errMsg, "(another update won)");
+                currLock = conn->findOne( LocksType::ConfigNS , BSON( LocksType::name(_name) ) );
                 *other = currLock;
                 other->getOwned();
                 gotLock = false;
@@ -1026,20 +1036,25 @@ namespace mongo {
                     else finalLockDetails.append( el );
                 }
 
-                conn->update( LocksType::ConfigNS , BSON( LocksType::name(_name) ) , BSON( "$set" << finalLockDetails.obj() ) );
+                BSONObj finalLock = finalLockDetails.obj();
+                conn->update( LocksType::ConfigNS , BSON( LocksType::name(_name) ) , BSON( "$set" << finalLock ) );
 
                 BSONObj err = conn->getLastErrorDetailed();
                 string errMsg = DBClientWithCommands::getLastErrorString(err);
 
-                currLock = conn->findOne( LocksType::ConfigNS , BSON( LocksType::name(_name) ) );
-
                 if ( !errMsg.empty() || !err["n"].type() || err["n"].numberInt() < 1 ) {
                     warning() << "could not finalize winning lock " << lockName
                               << ( !errMsg.empty() ? causedBy( errMsg ) : " (did not update lock) " ) << endl;
+                    currLock = conn->findOne( LocksType::ConfigNS , BSON( LocksType::name(_name) ) );
                     gotLock = false;
                 }
                 else {
-                    // SUCCESS!
+                    // SUCCESS!  The lock document is now exactly what we set, so there is no need
+                    // to read it back.
+                    BSONObjBuilder lockBuilder;
+                    lockBuilder.append( LocksType::name(), _name );
+                    lockBuilder.appendElements( finalLock );
+                    currLock = lockBuilder.obj();
                     gotLock = true;
                 }
 
@@ -85,6 +85,14 @@ namespace mongo {
          */
         virtual Status targetInsert( const BSONObj& doc, ShardEndpoint** endpoint ) const = 0;
 
+        /**
+         * Called with the documents of an insert batch before they are passed one at a time to
+         * targetInsert(), so that implementations can route the whole batch at once.  Results
+         * and errors are still only reported by targetInsert().
+         */
+        virtual void prepareInserts( const std::vector<BSONObj>& docs ) const {
+        }
+
         /**
          * Returns a vector of ShardEndpoints for a potentially multi-shard update.
          *
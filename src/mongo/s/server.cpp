@@ -57,6 +57,7 @@
 #include "mongo/db/log_process_details.h"
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/startup_warnings_common.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/balance.h"
 #include "mongo/s/chunk.h"
@@ -495,6 +496,7 @@ void mongo::dbexit( ExitCode rc, const char *why ) {
     log() << "dbexit: " << why
           << " rc:" << rc
           << endl;
+    logger::AsyncLogWriter::flushAll();
     flushForGcov();
     quickExit(rc);
 }
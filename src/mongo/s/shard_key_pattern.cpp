@@ -116,12 +116,20 @@ namespace mongo {
 
     ShardKeyPattern::ShardKeyPattern(const BSONObj& keyPattern)
         : _keyPatternPaths(parseShardKeyPattern(keyPattern)),
-          _keyPattern(_keyPatternPaths.empty() ? BSONObj() : keyPattern) {
+          _keyPattern(_keyPatternPaths.empty() ? BSONObj() : keyPattern),
+          _hashVersion(HASH_VERSION_MD5) {
     }
 
     ShardKeyPattern::ShardKeyPattern(const KeyPattern& keyPattern)
         : _keyPatternPaths(parseShardKeyPattern(keyPattern.toBSON())),
-          _keyPattern(_keyPatternPaths.empty() ? KeyPattern(BSONObj()) : keyPattern) {
+          _keyPattern(_keyPatternPaths.empty() ? KeyPattern(BSONObj()) : keyPattern),
+          _hashVersion(HASH_VERSION_MD5) {
+    }
+
+    ShardKeyPattern::ShardKeyPattern(const KeyPattern& keyPattern, int hashVersion)
+        : _keyPatternPaths(parseShardKeyPattern(keyPattern.toBSON())),
+          _keyPattern(_keyPatternPaths.empty() ? KeyPattern(BSONObj()) : keyPattern),
+          _hashVersion(hashVersion) {
     }
 
     bool ShardKeyPattern::isValid() const {
@@ -132,6 +140,10 @@ namespace mongo {
         return isHashedPatternEl(_keyPattern.toBSON().firstElement());
     }
 
+    int ShardKeyPattern::getHashVersion() const {
+        return isHashedPattern() ? _hashVersion : static_cast<int>(HASH_VERSION_MD5);
+    }
+
     const KeyPattern& ShardKeyPattern::getKeyPattern() const {
         return _keyPattern;
     }
@@ -241,7 +253,8 @@ namespace mongo {
             if (isHashedPatternEl(patternEl)) {
                 keyBuilder.append(patternEl.fieldName(),
                                   BSONElementHasher::hash64(matchEl,
-                                                            BSONElementHasher::DEFAULT_HASH_SEED));
+                                                            BSONElementHasher::DEFAULT_HASH_SEED,
+                                                            _hashVersion));
             }
             else {
                 // NOTE: The matched element may *not* have the same field name as the path -
@@ -322,7 +335,8 @@ namespace mongo {
             if (isHashedPattern()) {
                 keyBuilder.append(patternPath.dottedField(),
                                   BSONElementHasher::hash64(equalEl,
-                                                            BSONElementHasher::DEFAULT_HASH_SEED));
+                                                            BSONElementHasher::DEFAULT_HASH_SEED,
+                                                            _hashVersion));
             }
             else {
                 // NOTE: The equal element may *not* have the same field name as the path -
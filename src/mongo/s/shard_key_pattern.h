@@ -84,10 +84,22 @@ namespace mongo {
          */
         explicit ShardKeyPattern(const KeyPattern& keyPattern);
 
+        /**
+         * Constructs a shard key pattern whose hashed field, if any, is hashed with the given
+         * hash version (see HashVersion in hasher.h).  The version must be valid and must match
+         * the hashVersion of the hashed index backing the shard key.
+         */
+        ShardKeyPattern(const KeyPattern& keyPattern, int hashVersion);
+
         bool isValid() const;
 
         bool isHashedPattern() const;
 
+        /**
+         * The hash version used for hashed shard key values.  Always 0 for non-hashed patterns.
+         */
+        int getHashVersion() const;
+
         const KeyPattern& getKeyPattern() const;
 
         const BSONObj& toBSON() const;
@@ -224,6 +236,8 @@ namespace mongo {
         const OwnedPointerVector<FieldRef> _keyPatternPaths;
 
         const KeyPattern _keyPattern;
+
+        const int _hashVersion;
     };
 
 }
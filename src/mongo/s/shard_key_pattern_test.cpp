@@ -246,6 +246,34 @@ namespace {
         ASSERT_EQUALS(docKey(pattern, BSON("a" << BSON_ARRAY(BSON("b" << value)))), BSONObj());
     }
 
+    TEST(ShardKeyPattern, ExtractShardKeyHashedVersion) {
+
+        //
+        // Hashed ShardKeyPattern using the murmur3 hash version
+        //
+
+        const string value = "12345";
+        const BSONObj bsonValue = BSON("" << value);
+        const long long hashValue = BSONElementHasher::hash64(bsonValue.firstElement(),
+                                                              BSONElementHasher::DEFAULT_HASH_SEED,
+                                                              HASH_VERSION_MURMUR3);
+
+        ShardKeyPattern pattern(KeyPattern(BSON("a.b" << "hashed")), HASH_VERSION_MURMUR3);
+        ASSERT_EQUALS(pattern.getHashVersion(), HASH_VERSION_MURMUR3);
+        ASSERT_EQUALS(docKey(pattern, BSON("a" << BSON("b" << value))), BSON("a.b" << hashValue));
+
+        StatusWith<BSONObj> queryStatus =
+            pattern.extractShardKeyFromQuery(BSON("a.b" << value));
+        ASSERT_OK(queryStatus.getStatus());
+        ASSERT_EQUALS(queryStatus.getValue(), BSON("a.b" << hashValue));
+
+        // The default pattern keeps hashing with md5
+        ShardKeyPattern md5Pattern(BSON("a.b" << "hashed"));
+        ASSERT_EQUALS(md5Pattern.getHashVersion(), HASH_VERSION_MD5);
+        ASSERT_NOT_EQUALS(docKey(md5Pattern, BSON("a" << BSON("b" << value))),
+                          BSON("a.b" << hashValue));
+    }
+
     static BSONObj queryKey(const ShardKeyPattern& pattern, const BSONObj& query) {
         StatusWith<BSONObj> status = pattern.extractShardKeyFromQuery(query);
         if (!status.isOK())
@@ -0,0 +1,287 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/split_point_estimates.h"
+
+#include "mongo/s/shard_key_pattern.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    using boost::shared_ptr;
+    using std::make_pair;
+    using std::string;
+    using std::vector;
+
+    const size_t SplitPointEstimates::kMaxSamplesPerCollection = 100000;
+
+    SplitPointEstimates splitPointEstimates;
+
+    namespace {
+
+        bool rangesOverlap(const BSONObj& minA, const BSONObj& maxA,
+                           const BSONObj& minB, const BSONObj& maxB) {
+            return minA.woCompare(maxB) < 0 && minB.woCompare(maxA) < 0;
+        }
+
+    }  // namespace
+
+    SplitPointEstimates::CollectionEstimate::CollectionEstimate(const BSONObj& keyPattern,
+                                                                int hashVersion,
+                                                                const OID& epoch)
+        : keyPattern(keyPattern.getOwned()),
+          shardKeyPattern(new ShardKeyPattern(KeyPattern(keyPattern), hashVersion)),
+          epoch(epoch),
+          totalDocs(0),
+          deletedDocs(0),
+          docsPerSample(1),
+          docsSinceSample(0) {
+    }
+
+    SplitPointEstimates::SplitPointEstimates()
+        : _mutex("SplitPointEstimates"),
+          _sequence(0) {
+    }
+
+    unsigned long long SplitPointEstimates::currentSequence() {
+        SimpleMutex::scoped_lock lk(_mutex);
+        return _sequence;
+    }
+
+    void SplitPointEstimates::seed(const string& ns,
+                                   const BSONObj& keyPattern,
+                                   int hashVersion,
+                                   const OID& epoch,
+                                   const BSONObj& min,
+                                   const BSONObj& max,
+                                   long long docsPerSample,
+                                   const vector<Sample>& samples,
+                                   unsigned long long startSequence) {
+        SimpleMutex::scoped_lock lk(_mutex);
+
+        CollectionMap::iterator it = _collections.find(ns);
+        if (it != _collections.end() &&
+            (it->second->epoch != epoch ||
+             it->second->keyPattern.woCompare(keyPattern) != 0 ||
+             it->second->shardKeyPattern->getHashVersion() != hashVersion)) {
+            _forget_inlock(it);
+            it = _collections.end();
+        }
+        if (it == _collections.end()) {
+            it = _collections.insert(make_pair(ns, shared_ptr<CollectionEstimate>(
+                new CollectionEstimate(keyPattern, hashVersion, epoch)))).first;
+            _numCollections.store(_collections.size());
+        }
+        CollectionEstimate* estimate = it->second.get();
+
+        // Samples added by inserts while the scan ran may or may not have been seen by it.
+        // Keeping them over-counts a little, which only makes the next split come sooner.
+        _forgetRange_inlock(estimate, min, max, startSequence);
+
+        if (estimate->samples.size() + samples.size() > kMaxSamplesPerCollection) {
+            LOG(1) << "not keeping split point estimates for " << ns << ", more than "
+                   << kMaxSamplesPerCollection << " samples";
+            _forget_inlock(it);
+            return;
+        }
+
+        for (vector<Sample>::const_iterator sample = samples.begin();
+             sample != samples.end();
+             ++sample) {
+            estimate->samples.insert(make_pair(sample->key.getOwned(),
+                                               SampleInfo(sample->docs, ++_sequence)));
+            estimate->totalDocs += sample->docs;
+        }
+        estimate->coveredRanges.push_back(make_pair(min.getOwned(), max.getOwned()));
+        estimate->docsPerSample = docsPerSample > 0 ? docsPerSample : 1;
+    }
+
+    bool SplitPointEstimates::findSplitPoints(const string& ns,
+                                              const BSONObj& keyPattern,
+                                              const OID& epoch,
+                                              const BSONObj& min,
+                                              const BSONObj& max,
+                                              long long keyCount,
+                                              long long maxSplitPoints,
+                                              vector<BSONObj>* splitKeys) {
+        SimpleMutex::scoped_lock lk(_mutex);
+
+        CollectionMap::iterator it = _collections.find(ns);
+        if (it == _collections.end())
+            return false;
+
+        CollectionEstimate* estimate = it->second.get();
+        if (estimate->epoch != epoch || estimate->keyPattern.woCompare(keyPattern) != 0) {
+            _forget_inlock(it);
+            return false;
+        }
+
+        bool covered = false;
+        for (RangeVector::const_iterator range = estimate->coveredRanges.begin();
+             range != estimate->coveredRanges.end();
+             ++range) {
+            if (range->first.woCompare(min) <= 0 && max.woCompare(range->second) <= 0) {
+                covered = true;
+                break;
+            }
+        }
+        if (!covered)
+            return false;
+
+        SampleMap::const_iterator sample = estimate->samples.lower_bound(min);
+        const SampleMap::const_iterator end = estimate->samples.lower_bound(max);
+
+        // As in the index scan, the first key only serves to avoid splitting at the bottom of
+        // the range.
+        BSONObj lastKey = sample != end ? sample->first : BSONObj();
+        long long currCount = 0;
+        long long numChunks = 0;
+        for (; sample != end; ++sample) {
+            currCount += sample->second.docs;
+            if (currCount <= keyCount || sample->first.woCompare(lastKey) == 0)
+                continue;
+
+            splitKeys->push_back(sample->first.getOwned());
+            lastKey = sample->first;
+            currCount = 0;
+            numChunks++;
+
+            if (maxSplitPoints && numChunks >= maxSplitPoints)
+                break;
+        }
+        return true;
+    }
+
+    void SplitPointEstimates::logOp(const char* opstr,
+                                    const char* ns,
+                                    const BSONObj& obj,
+                                    bool fromMigrate) {
+        if (_numCollections.load() == 0)
+            return;
+
+        const char op = opstr[0];
+        if (opstr[1] != '\0' || (op != 'i' && op != 'd'))
+            return;
+
+        // Deletes of migrated ranges are accounted for by forgetRange()
+        if (op == 'd' && fromMigrate)
+            return;
+
+        SimpleMutex::scoped_lock lk(_mutex);
+
+        CollectionMap::iterator it = _collections.find(ns);
+        if (it == _collections.end())
+            return;
+
+        CollectionEstimate* estimate = it->second.get();
+        if (op == 'd') {
+            if (++estimate->deletedDocs * 4 > estimate->totalDocs) {
+                LOG(1) << "dropping split point estimates for " << ns << " after "
+                       << estimate->deletedDocs << " deletes";
+                _forget_inlock(it);
+            }
+            return;
+        }
+
+        if (++estimate->docsSinceSample < estimate->docsPerSample)
+            return;
+
+        BSONObj key = estimate->shardKeyPattern->extractShardKeyFromDoc(obj);
+        if (key.isEmpty())
+            return;
+
+        if (estimate->samples.size() >= kMaxSamplesPerCollection) {
+            LOG(1) << "dropping split point estimates for " << ns << ", more than "
+                   << kMaxSamplesPerCollection << " samples";
+            _forget_inlock(it);
+            return;
+        }
+
+        estimate->samples.insert(make_pair(key.getOwned(),
+                                           SampleInfo(estimate->docsSinceSample, ++_sequence)));
+        estimate->totalDocs += estimate->docsSinceSample;
+        estimate->docsSinceSample = 0;
+    }
+
+    void SplitPointEstimates::forgetRange(const string& ns,
+                                          const BSONObj& min,
+                                          const BSONObj& max) {
+        if (_numCollections.load() == 0)
+            return;
+
+        SimpleMutex::scoped_lock lk(_mutex);
+
+        CollectionMap::iterator it = _collections.find(ns);
+        if (it == _collections.end())
+            return;
+
+        CollectionEstimate* estimate = it->second.get();
+        _forgetRange_inlock(estimate,
+                            estimate->shardKeyPattern->getKeyPattern().extendRangeBound(min, false),
+                            estimate->shardKeyPattern->getKeyPattern().extendRangeBound(max, false),
+                            _sequence + 1);
+    }
+
+    void SplitPointEstimates::_forget_inlock(CollectionMap::iterator it) {
+        _collections.erase(it);
+        _numCollections.store(_collections.size());
+    }
+
+    void SplitPointEstimates::_forgetRange_inlock(CollectionEstimate* estimate,
+                                                  const BSONObj& min,
+                                                  const BSONObj& max,
+                                                  unsigned long long beforeSequence) {
+        SampleMap::iterator sample = estimate->samples.lower_bound(min);
+        const SampleMap::iterator end = estimate->samples.lower_bound(max);
+        while (sample != end) {
+            if (sample->second.sequence < beforeSequence) {
+                estimate->totalDocs -= sample->second.docs;
+                estimate->samples.erase(sample++);
+            }
+            else {
+                ++sample;
+            }
+        }
+
+        // A partly overlapping range loses its coverage, the rest of its samples stay and are
+        // replaced when it is scanned again.
+        RangeVector::iterator range = estimate->coveredRanges.begin();
+        while (range != estimate->coveredRanges.end()) {
+            if (rangesOverlap(range->first, range->second, min, max)) {
+                range = estimate->coveredRanges.erase(range);
+            }
+            else {
+                ++range;
+            }
+        }
+    }
+
+}  // namespace mongo
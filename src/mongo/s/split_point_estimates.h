@@ -0,0 +1,172 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/oid.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    class ShardKeyPattern;
+
+    /**
+     * Approximate per-range document counts for the sharded collections on this shard, used by
+     * the splitVector command to choose split points without scanning the shard key index.
+     *
+     * A collection is tracked once splitVector has scanned one of its chunks: the scan leaves
+     * behind a sample of shard key values, each standing for the number of documents seen since
+     * the previous sample, and marks the scanned range as covered.  From then on every
+     * 'docsPerSample'-th insert into the collection adds the inserted document's shard key as
+     * another sample, so the estimate follows the chunk as it grows.
+     *
+     * Updates can't move a document between chunks because shard keys are immutable, and deletes
+     * don't carry the shard key, so they are only counted: once a quarter of the estimated
+     * documents have been deleted the collection is dropped and the next splitVector scans again.
+     * Ranges that leave the shard through a migration are forgotten.
+     */
+    class SplitPointEstimates {
+        MONGO_DISALLOW_COPYING(SplitPointEstimates);
+    public:
+
+        // Past this many samples a collection is no longer tracked
+        static const size_t kMaxSamplesPerCollection;
+
+        struct Sample {
+            Sample(const BSONObj& key, long long docs) : key(key), docs(docs) {}
+
+            BSONObj key;
+            long long docs;
+        };
+
+        SplitPointEstimates();
+
+        /**
+         * Returns the sequence number a range scan started now should pass to seed(), so that
+         * samples added by inserts while the scan runs are kept.
+         */
+        unsigned long long currentSequence();
+
+        /**
+         * Replaces the samples of the range [min, max) of 'ns' with the ones collected by an
+         * index scan over the whole range, and marks the range as covered.  'min' and 'max' are
+         * full shard keys over 'keyPattern'.  Later inserts are sampled every 'docsPerSample'
+         * documents; a hashed key is hashed with 'hashVersion', the one of the scanned index.
+         */
+        void seed(const std::string& ns,
+                  const BSONObj& keyPattern,
+                  int hashVersion,
+                  const OID& epoch,
+                  const BSONObj& min,
+                  const BSONObj& max,
+                  long long docsPerSample,
+                  const std::vector<Sample>& samples,
+                  unsigned long long startSequence);
+
+        /**
+         * If [min, max) is covered, fills 'splitKeys' the way splitVector's index scan would:
+         * a split key every time more than 'keyCount' documents have been passed, never
+         * repeating a key, and at most 'maxSplitPoints' keys if that is not 0.  Returns false
+         * without touching 'splitKeys' if there is no usable estimate for the range.
+         */
+        bool findSplitPoints(const std::string& ns,
+                             const BSONObj& keyPattern,
+                             const OID& epoch,
+                             const BSONObj& min,
+                             const BSONObj& max,
+                             long long keyCount,
+                             long long maxSplitPoints,
+                             std::vector<BSONObj>* splitKeys);
+
+        /**
+         * Called for every write logged on this shard, see logOpForSharding().
+         */
+        void logOp(const char* opstr, const char* ns, const BSONObj& obj, bool fromMigrate);
+
+        /**
+         * Drops the samples and coverage of [min, max), for a range that is leaving the shard.
+         */
+        void forgetRange(const std::string& ns, const BSONObj& min, const BSONObj& max);
+
+    private:
+
+        struct SampleInfo {
+            SampleInfo(long long docs, unsigned long long sequence)
+                : docs(docs), sequence(sequence) {}
+
+            long long docs;
+            unsigned long long sequence;
+        };
+
+        typedef std::multimap<BSONObj, SampleInfo, BSONObjCmp> SampleMap;
+        typedef std::vector<std::pair<BSONObj, BSONObj> > RangeVector;
+
+        struct CollectionEstimate {
+            CollectionEstimate(const BSONObj& keyPattern, int hashVersion, const OID& epoch);
+
+            const BSONObj keyPattern;
+            const boost::shared_ptr<ShardKeyPattern> shardKeyPattern;
+            const OID epoch;
+
+            SampleMap samples;
+            RangeVector coveredRanges;
+
+            long long totalDocs;
+            long long deletedDocs;
+
+            long long docsPerSample;
+            long long docsSinceSample;
+        };
+
+        typedef std::map<std::string, boost::shared_ptr<CollectionEstimate> > CollectionMap;
+
+        void _forget_inlock(CollectionMap::iterator it);
+        void _forgetRange_inlock(CollectionEstimate* estimate,
+                                 const BSONObj& min,
+                                 const BSONObj& max,
+                                 unsigned long long beforeSequence);
+
+        SimpleMutex _mutex;
+        CollectionMap _collections;
+        unsigned long long _sequence;
+
+        // Number of entries in '_collections', read without the mutex by logOp()
+        AtomicUInt32 _numCollections;
+    };
+
+    extern SplitPointEstimates splitPointEstimates;
+
+}  // namespace mongo
@@ -43,6 +43,7 @@
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/max_time.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/namespace_string.h"
@@ -78,6 +79,14 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    // Pass queries that target a single shard straight through, without setting up a
+    // ParallelSortClusteredCursor
+    MONGO_EXPORT_SERVER_PARAMETER(mongosSingleShardQueryFastPath, bool, true);
+
+    static Counter64 singleShardFastPathQueries;
+    static ServerStatusMetricField<Counter64> displaySingleShardFastPathQueries(
+            "query.singleShardFastPath", &singleShardFastPathQueries );
+
     static bool _isSystemIndexes( const char* ns ) {
         return nsToCollectionSubstring(ns) == "system.indexes";
     }
@@ -137,6 +146,78 @@ namespace mongo {
         return true;
     }
 
+    /**
+     * Forwards a query which targets exactly one shard to that shard and relays the reply
+     * unchanged. Returns false, with nothing sent to the client, if the query should take the
+     * general path: explains, secondary or partial reads, queries which target several shards,
+     * or a shard version which is still stale after a few retries.
+     */
+    static bool doSingleShardQuery( Request& r, const QueryMessage& q, const QuerySpec& qSpec ) {
+        if ( !mongosSingleShardQueryFastPath || qSpec.isExplain() ) {
+            return false;
+        }
+
+        if ( q.queryOptions & ( QueryOption_SlaveOk | QueryOption_PartialResults ) ) {
+            return false;
+        }
+
+        if ( q.query.hasField( Query::ReadPrefField.name() ) ) {
+            return false;
+        }
+
+        DBConfigPtr config = grid.getDBConfig( q.ns );
+
+        for ( int attempt = 0; attempt < 3; attempt++ ) {
+            ChunkManagerPtr manager;
+            ShardPtr primary;
+            config->getChunkManagerOrPrimary( q.ns, manager, primary );
+
+            Shard shard;
+            if ( manager ) {
+                set<Shard> shards;
+                manager->getShardsForQuery( shards, qSpec.filter() );
+                if ( shards.size() != 1 ) {
+                    return false;
+                }
+                shard = *shards.begin();
+            }
+            else {
+                verify( primary );
+                shard = *primary;
+            }
+
+            ShardConnection dbcon( shard, q.ns, manager );
+            DBClientBase& c = dbcon.conn();
+
+            string actualServer;
+            Message response;
+            bool ok = c.call( r.m(), response, true, &actualServer );
+
+            // Sending renumbers the request, the client expects a reply to its own id
+            r.m().header().setId( r.id() );
+            uassert( 28636, "mongos: error calling db", ok );
+
+            QueryResult::View qr = response.singleData().view2ptr();
+            if ( qr.getResultFlags() & ResultFlag_ShardConfigStale ) {
+                dbcon.done();
+
+                LOG(1) << "retrying single shard query on " << q.ns
+                       << " after stale config, attempt " << attempt << endl;
+
+                config->getChunkManagerIfExists( q.ns, true );
+                continue;
+            }
+
+            r.reply( response, actualServer.size() ? actualServer : c.getServerAddress() );
+            dbcon.done();
+
+            singleShardFastPathQueries.increment();
+            return true;
+        }
+
+        return false;
+    }
+
     void Strategy::queryOp( Request& r ) {
 
         verify( !NamespaceString( r.getns() ).isCommand() );
@@ -176,6 +257,10 @@ namespace mongo {
             return;
         }
 
+        if ( doSingleShardQuery( r, q, qSpec ) ) {
+            return;
+        }
+
         ParallelSortClusteredCursor * cursor = new ParallelSortClusteredCursor( qSpec, CommandInfo() );
         verify( cursor );
 
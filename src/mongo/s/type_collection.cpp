@@ -44,6 +44,7 @@ namespace mongo {
     const BSONField<bool> CollectionType::unique("unique");
     const BSONField<Date_t> CollectionType::updatedAt("updatedAt");
     const BSONField<bool> CollectionType::noBalance("noBalance");
+    const BSONField<int> CollectionType::hashVersion("hashVersion", 0);
     const BSONField<OID> CollectionType::epoch("epoch");
     const BSONField<bool> CollectionType::dropped("dropped");
     const BSONField<OID> CollectionType::DEPRECATED_lastmodEpoch("lastmodEpoch");
@@ -108,6 +109,7 @@ namespace mongo {
         if (_isUniqueSet) builder.append(unique(), _unique);
         if (_isUpdatedAtSet) builder.append(updatedAt(), _updatedAt);
         if (_isNoBalanceSet) builder.append(noBalance(), _noBalance);
+        if (_isHashVersionSet) builder.append(hashVersion(), _hashVersion);
 
         if (_isUpdatedAtSet) builder.append(DEPRECATED_lastmod(), _updatedAt);
         if (_isEpochSet) {
@@ -152,6 +154,10 @@ namespace mongo {
         if (fieldState == FieldParser::FIELD_INVALID) return false;
         _isNoBalanceSet = fieldState == FieldParser::FIELD_SET;
 
+        fieldState = FieldParser::extract(source, hashVersion, &_hashVersion, errMsg);
+        if (fieldState == FieldParser::FIELD_INVALID) return false;
+        _isHashVersionSet = fieldState == FieldParser::FIELD_SET;
+
         fieldState = FieldParser::extract(source, epoch, &_epoch, errMsg);
         if (fieldState == FieldParser::FIELD_INVALID) return false;
         _isEpochSet = fieldState == FieldParser::FIELD_SET;
@@ -208,6 +214,9 @@ namespace mongo {
         _noBalance = false;
         _isNoBalanceSet = false;
 
+        _hashVersion = 0;
+        _isHashVersionSet = false;
+
         _epoch = OID();
         _isEpochSet = false;
 
@@ -237,6 +246,9 @@ namespace mongo {
         other->_noBalance = _noBalance;
         other->_isNoBalanceSet = _isNoBalanceSet;
 
+        other->_hashVersion = _hashVersion;
+        other->_isHashVersionSet = _isHashVersionSet;
+
         other->_epoch = _epoch;
         other->_isEpochSet = _isEpochSet;
 
@@ -75,6 +75,7 @@ namespace mongo {
         static const BSONField<bool> unique;
         static const BSONField<Date_t> updatedAt;
         static const BSONField<bool> noBalance;
+        static const BSONField<int> hashVersion;
         static const BSONField<OID> epoch;
         static const BSONField<bool> dropped;
         static const BSONField<OID> DEPRECATED_lastmodEpoch;
@@ -254,6 +255,27 @@ namespace mongo {
                 return noBalance.getDefault();
             }
         }
+        void setHashVersion(int hashVersion) {
+            _hashVersion = hashVersion;
+            _isHashVersionSet = true;
+        }
+
+        void unsetHashVersion() { _isHashVersionSet = false; }
+
+        bool isHashVersionSet() const {
+            return _isHashVersionSet || hashVersion.hasDefault();
+        }
+
+        // Calling get*() methods when the member is not set and has no default results in undefined
+        // behavior
+        int getHashVersion() const {
+            if (_isHashVersionSet) {
+                return _hashVersion;
+            } else {
+                dassert(hashVersion.hasDefault());
+                return hashVersion.getDefault();
+            }
+        }
         void setDropped(bool dropped) {
             _dropped = dropped;
             _isDroppedSet = true;
@@ -290,6 +312,8 @@ namespace mongo {
         bool _isUpdatedAtSet;
         bool _noBalance;     // (O)  optional if sharded, disable balancing
         bool _isNoBalanceSet;
+        int _hashVersion;     // (O)  hash version of a hashed sharding pattern, 0 if absent
+        bool _isHashVersionSet;
         OID _epoch;     // (M)  disambiguates collection incarnations
         bool _isEpochSet;
         bool _dropped;     // (O)  if true, ignore this entry
@@ -51,7 +51,7 @@ namespace mongo {
 
         ///////////////////////////////////////////////////////////////////////
         // IMPORTANT!
-        // Also update extractGLEErrors in batch_api.js for any changes made here.
+        // Also update extractGLEErrors in shell/bulk_api.js for any changes made here.
 
         const bool isOK = gleResponse["ok"].trueValue();
         const string err = gleResponse["err"].str();
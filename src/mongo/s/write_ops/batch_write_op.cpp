@@ -289,6 +289,19 @@ namespace mongo {
         int numTargetErrors = 0;
 
         size_t numWriteOps = _clientRequest->sizeWriteOps();
+
+        if ( _clientRequest->getBatchType() == BatchedCommandRequest::BatchType_Insert
+             && !_clientRequest->isInsertIndexRequest() ) {
+
+            // Let the targeter route the remaining documents together
+            vector<BSONObj> docs;
+            for ( size_t i = 0; i < numWriteOps; ++i ) {
+                if ( _writeOps[i].getWriteState() == WriteOpState_Ready ) {
+                    docs.push_back( _writeOps[i].getWriteItem().getDocument() );
+                }
+            }
+            targeter.prepareInserts( docs );
+        }
         for ( size_t i = 0; i < numWriteOps; ++i ) {
 
             WriteOp& writeOp = _writeOps[i];
@@ -292,6 +292,20 @@ namespace mongo {
 
         const vector<BSONObj>& inserts = origRequest->getDocuments();
 
+        // Generate all the missing _ids of the batch at once
+        size_t numMissingIds = 0u;
+        for (vector<BSONObj>::const_iterator it = inserts.begin(); it != inserts.end(); ++it) {
+            if ((*it)["_id"].eoo())
+                ++numMissingIds;
+        }
+
+        if (numMissingIds == 0u)
+            return NULL;
+
+        vector<OID> ids(numMissingIds);
+        OID::genMany(&ids[0], numMissingIds);
+        vector<OID>::const_iterator nextId = ids.begin();
+
         size_t i = 0u;
         for (vector<BSONObj>::const_iterator it = inserts.begin(); it != inserts.end(); ++it, ++i) {
 
@@ -300,7 +314,7 @@ namespace mongo {
 
             if (insert["_id"].eoo()) {
                 BSONObjBuilder idInsertB;
-                idInsertB.append("_id", OID::gen());
+                idInsertB.append("_id", *nextId++);
                 idInsertB.appendElements(insert);
                 idInsert = idInsertB.obj();
             }
@@ -33,6 +33,7 @@
 
 #include "mongo/scripting/engine.h"
 
+#include <algorithm>
 #include <cctype>
 #include <boost/filesystem/operations.hpp>
 #include <boost/scoped_array.hpp>
@@ -42,6 +43,7 @@
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/global_environment_experiment.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/platform/unordered_set.h"
 #include "mongo/util/file.h"
 #include "mongo/util/log.h"
@@ -303,6 +305,12 @@ namespace {
     }
 
 namespace {
+    // How many idle scopes are kept across all pools, and how many operations may reuse one
+    // scope before it is thrown away. Building a new scope means a new V8 isolate and running the
+    // core JS files, which can cost more than a short $where query itself.
+    MONGO_EXPORT_SERVER_PARAMETER(internalJavaScriptScopePoolSize, int, 10);
+    MONGO_EXPORT_SERVER_PARAMETER(internalJavaScriptScopeMaxReuse, int, 100);
+
     class ScopeCache {
     public:
         ScopeCache() : _mutex("ScopeCache") {}
@@ -317,13 +325,17 @@ namespace {
                 return;
             }
 
-            if (scope->getTimesUsed() > kMaxScopeReuse)
+            if (scope->getTimesUsed() > internalJavaScriptScopeMaxReuse)
                 return; // used too many times to save
 
             if (!scope->getError().empty())
                 return; // not saving errored scopes
 
-            if (_pools.size() >= kMaxPoolSize) {
+            const size_t maxPoolSize = std::max(internalJavaScriptScopePoolSize, 0);
+            if (maxPoolSize == 0)
+                return;
+
+            while (_pools.size() >= maxPoolSize) {
                 // prefer to keep recently-used scopes
                 _pools.pop_back();
             }
@@ -356,10 +368,7 @@ namespace {
             string poolName;
         };
 
-        // Note: if these numbers change, reconsider choice of datastructure for _pools
-        static const unsigned kMaxPoolSize = 10;
-        static const int kMaxScopeReuse = 10;
-
+        // Note: if the pool is made much larger, reconsider choice of datastructure for _pools
         typedef std::deque<ScopeAndPool> Pools; // More-recently used Scopes are kept at the front.
         Pools _pools;    // protected by _mutex
         mongo::mutex _mutex;
@@ -899,7 +899,7 @@ var _bulk_api_module = (function() {
     /**
      * Parses the getLastError response and properly sets the write errors and
      * write concern errors.
-     * Should kept be up to date with BatchSafeWriter::extractGLEErrors.
+     * Should be kept up to date with extractGLEErrors in s/write_ops/batch_downconvert.cpp.
      *
      * @return {object} an object with the format:
      *
@@ -0,0 +1,379 @@
+/*    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+/**
+ * mongoreplay drives a server with a workload recorded by another server's wire trace (see
+ * util/net/wire_trace.h).  Each traced connection is replayed on a connection of its own,
+ * with its requests sent at the times they were recorded at, divided by --speed.  When the
+ * replay is done it prints, for each kind of request, how long the target took to reply
+ * against how long the traced server took.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "mongo/base/data_view.h"
+#include "mongo/base/initializer.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/wire_trace.h"
+#include "mongo/util/quick_exit.h"
+#include "mongo/util/text.h"
+#include "mongo/util/time_support.h"
+
+using namespace mongo;
+using namespace std;
+
+namespace {
+
+    // Offsets into an OP_QUERY, OP_GET_MORE, OP_KILL_CURSORS and OP_REPLY, past the header.
+    const int kHeaderSize = sizeof(MSGHEADER::Value);
+    const int kQueryOptionsOffset = kHeaderSize;
+    const int kGetMoreNsOffset = kHeaderSize + 4;
+    const int kKillCursorsCountOffset = kHeaderSize + 4;
+    const int kReplyCursorIdOffset = kHeaderSize + 4;
+
+    struct TracedRequest {
+        TracedRequest() : micros(0), recordedLatencyMicros(-1), recordedCursorId(0) {}
+
+        std::string message;
+        long long micros;
+
+        // From the traced reply, if there was one.
+        long long recordedLatencyMicros;
+        long long recordedCursorId;
+    };
+
+    typedef std::vector<TracedRequest> TracedSession;
+
+    struct Latencies {
+        std::vector<long long> replayed;
+        std::vector<long long> recorded;
+    };
+
+    typedef std::map<int, Latencies> LatenciesByOp;
+
+    long long replyCursorId(const char* reply, size_t size) {
+        if (size < static_cast<size_t>(kReplyCursorIdOffset + 8) ||
+            ConstDataView(reply).readLE<int32_t>(12) != opReply) {
+            return 0;
+        }
+        return ConstDataView(reply).readLE<int64_t>(kReplyCursorIdOffset);
+    }
+
+    class SessionReplayer {
+    public:
+        SessionReplayer(const TracedSession& session,
+                        const HostAndPort& target,
+                        long long traceStartMicros,
+                        unsigned long long replayStartMicros,
+                        double speed)
+            : _session(session),
+              _target(target),
+              _traceStartMicros(traceStartMicros),
+              _replayStartMicros(replayStartMicros),
+              _speed(speed) {
+        }
+
+        void run() {
+            DBClientConnection conn;
+            std::string errmsg;
+            if (!conn.connect(_target, errmsg)) {
+                cerr << "couldn't connect to " << _target << ": " << errmsg << endl;
+                return;
+            }
+
+            try {
+                for (size_t i = 0; i < _session.size(); i++) {
+                    replayRequest(conn.port(), _session[i]);
+                }
+            }
+            catch (const std::exception& e) {
+                cerr << "replaying connection stopped: " << e.what() << endl;
+            }
+        }
+
+        const LatenciesByOp& latencies() const { return _latencies; }
+
+    private:
+        void replayRequest(MessagingPort& port, const TracedRequest& request) {
+            const unsigned long long due = _replayStartMicros +
+                static_cast<unsigned long long>((request.micros - _traceStartMicros) / _speed);
+            const unsigned long long now = curTimeMicros64();
+            if (due > now) {
+                sleepmicros(due - now);
+            }
+
+            Message toSend;
+            char* data = static_cast<char*>(mongoMalloc(request.message.size()));
+            memcpy(data, request.message.data(), request.message.size());
+            toSend.setData(data, true);
+
+            const int op = toSend.operation();
+            if (op == dbQuery) {
+                // The traced client got the later batches of an exhaust query without asking
+                // for them, so there is nothing to replay past the first.
+                DataView options(data + kQueryOptionsOffset);
+                options.writeLE<int32_t>(options.readLE<int32_t>() & ~QueryOption_Exhaust);
+            }
+            else if (op == dbGetMore) {
+                const char* ns = data + kGetMoreNsOffset;
+                remapCursorId(data + kGetMoreNsOffset + strlen(ns) + 1 + 4);
+            }
+            else if (op == dbKillCursors) {
+                const int n = ConstDataView(data + kKillCursorsCountOffset).readLE<int32_t>();
+                for (int i = 0; i < n; i++) {
+                    remapCursorId(data + kKillCursorsCountOffset + 4 + i * 8);
+                }
+            }
+
+            if (op != dbQuery && op != dbGetMore && op != dbMsg) {
+                port.say(toSend);
+                return;
+            }
+
+            const unsigned long long start = curTimeMicros64();
+            Message response;
+            uassert(28627, "lost connection to the replay target", port.call(toSend, response));
+            const long long latency = curTimeMicros64() - start;
+
+            Latencies& latencies = _latencies[op];
+            latencies.replayed.push_back(latency);
+            if (request.recordedLatencyMicros >= 0) {
+                latencies.recorded.push_back(request.recordedLatencyMicros);
+            }
+
+            if (request.recordedCursorId) {
+                _cursorIds[request.recordedCursorId] =
+                    replyCursorId(response.singleData().view2ptr(), response.size());
+            }
+        }
+
+        void remapCursorId(char* cursorId) {
+            DataView view(cursorId);
+            const std::map<long long, long long>::const_iterator it =
+                _cursorIds.find(view.readLE<int64_t>());
+            if (it != _cursorIds.end()) {
+                view.writeLE<int64_t>(it->second);
+            }
+        }
+
+        const TracedSession& _session;
+        const HostAndPort _target;
+        const long long _traceStartMicros;
+        const unsigned long long _replayStartMicros;
+        const double _speed;
+
+        // The cursor ids the traced server handed out, to the ones the target did.
+        std::map<long long, long long> _cursorIds;
+
+        LatenciesByOp _latencies;
+    };
+
+    long long percentile(std::vector<long long>* values, double p) {
+        if (values->empty()) {
+            return 0;
+        }
+        const size_t index = std::min(values->size() - 1,
+                                      static_cast<size_t>(values->size() * p));
+        std::nth_element(values->begin(), values->begin() + index, values->end());
+        return (*values)[index];
+    }
+
+    long long mean(const std::vector<long long>& values) {
+        if (values.empty()) {
+            return 0;
+        }
+        long long total = 0;
+        for (size_t i = 0; i < values.size(); i++) {
+            total += values[i];
+        }
+        return total / static_cast<long long>(values.size());
+    }
+
+    void printLatencies(const std::string& name, std::vector<long long>* values) {
+        cout << "    " << name << " micros: mean " << mean(*values)
+             << " p50 " << percentile(values, 0.5)
+             << " p99 " << percentile(values, 0.99) << endl;
+    }
+
+    void usage() {
+        cout <<
+             "Usage: mongoreplay [--help] [--speed <factor>] <trace file> <host:port>\n"
+             "--help          Print this help message.\n"
+             "--speed         Replay this many times faster than the workload was\n"
+             "                recorded.  Defaults to 1.\n"
+             "<trace file>    A file written by a server started with wireTraceFile set.\n"
+             "<host:port>     The server to replay the workload against.\n"
+             << endl;
+    }
+
+} // namespace
+
+int toolMain(int argc, char **argv, char** envp) {
+    mongo::runGlobalInitializersOrDie(argc, argv, envp);
+
+    double speed = 1.0;
+    vector<string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg == "--help") {
+            usage();
+            return 0;
+        }
+        else if (arg == "--speed" && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        }
+        else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2 || !(speed > 0)) {
+        usage();
+        return -1;
+    }
+
+    HostAndPort target;
+    try {
+        target = HostAndPort(positional[1]);
+    }
+    catch (const DBException& e) {
+        cerr << "bad target " << positional[1] << ": " << e.what() << endl;
+        return -1;
+    }
+
+    // Read the trace, pairing each reply with its request by id.
+    std::map<long long, TracedSession> sessions;
+    long long traceStartMicros = 0;
+    size_t requestCount = 0;
+    try {
+        WireTraceReader reader(positional[0]);
+        WireTraceRecord record;
+        std::map<long long, std::map<int, size_t> > pendingByConnection;
+        while (reader.next(&record)) {
+            if (!traceStartMicros) {
+                traceStartMicros = record.micros;
+            }
+
+            TracedSession& session = sessions[record.connectionId];
+            std::map<int, size_t>& pending = pendingByConnection[record.connectionId];
+            const ConstDataView header(record.message.data());
+            if (record.kind == WireTraceRecord::kRequest) {
+                pending[header.readLE<int32_t>(4)] = session.size();
+                session.push_back(TracedRequest());
+                session.back().message.swap(record.message);
+                session.back().micros = record.micros;
+                requestCount++;
+                continue;
+            }
+
+            const std::map<int, size_t>::iterator it =
+                pending.find(header.readLE<int32_t>(8));
+            if (it == pending.end()) {
+                continue;
+            }
+            TracedRequest& request = session[it->second];
+            pending.erase(it);
+            request.recordedLatencyMicros = record.micros - request.micros;
+            request.recordedCursorId = replyCursorId(record.message.data(),
+                                                     record.message.size());
+        }
+    }
+    catch (const DBException& e) {
+        cerr << e.what() << endl;
+        return -1;
+    }
+
+    cout << "replaying " << requestCount << " requests on " << sessions.size()
+         << " connections against " << target << endl;
+
+    const unsigned long long replayStartMicros = curTimeMicros64() + 100 * 1000;
+    std::vector<SessionReplayer*> replayers;
+    boost::thread_group threads;
+    for (std::map<long long, TracedSession>::const_iterator it = sessions.begin();
+         it != sessions.end(); ++it) {
+        replayers.push_back(new SessionReplayer(it->second,
+                                                target,
+                                                traceStartMicros,
+                                                replayStartMicros,
+                                                speed));
+        threads.create_thread(boost::bind(&SessionReplayer::run, replayers.back()));
+    }
+    threads.join_all();
+
+    LatenciesByOp totals;
+    for (size_t i = 0; i < replayers.size(); i++) {
+        const LatenciesByOp& latencies = replayers[i]->latencies();
+        for (LatenciesByOp::const_iterator it = latencies.begin(); it != latencies.end(); ++it) {
+            Latencies& total = totals[it->first];
+            total.replayed.insert(total.replayed.end(),
+                                  it->second.replayed.begin(), it->second.replayed.end());
+            total.recorded.insert(total.recorded.end(),
+                                  it->second.recorded.begin(), it->second.recorded.end());
+        }
+        delete replayers[i];
+    }
+
+    cout << "replay took " << (curTimeMicros64() - replayStartMicros) / 1000 << "ms" << endl;
+    for (LatenciesByOp::iterator it = totals.begin(); it != totals.end(); ++it) {
+        cout << opToString(it->first) << ": " << it->second.replayed.size() << endl;
+        printLatencies("replayed", &it->second.replayed);
+        printLatencies("recorded", &it->second.recorded);
+    }
+
+    return 0;
+}
+
+#if defined(_WIN32)
+// In Windows, wmain() is an alternate entry point for main(), and receives the same parameters
+// as main() but encoded in Windows Unicode (UTF-16); "wide" 16-bit wchar_t characters.  The
+// WindowsCommandLine object converts these wide character strings to a UTF-8 coded equivalent
+// and makes them available through the argv() and envp() members.  This enables toolMain()
+// to process UTF-8 encoded arguments and environment variables without regard to platform.
+int wmain(int argc, wchar_t* argvW[], wchar_t* envpW[]) {
+    WindowsCommandLine wcl(argc, argvW, envpW);
+    int exitCode = toolMain(argc, wcl.argv(), wcl.envp());
+    quickExit(exitCode);
+}
+#else
+int main(int argc, char* argv[], char** envp) {
+    int exitCode = toolMain(argc, argv, envp);
+    quickExit(exitCode);
+}
+#endif
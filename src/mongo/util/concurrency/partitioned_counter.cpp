@@ -0,0 +1,89 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/partitioned_counter.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace mongo {
+
+namespace {
+
+    AtomicUInt32 nextThreadPartition;
+
+#if defined(MONGO_HAVE___THREAD)
+    __thread unsigned threadPartition = 0;
+#elif defined(MONGO_HAVE___DECLSPEC_THREAD)
+    __declspec( thread ) unsigned threadPartition = 0;
+#endif
+
+    /**
+     * Hands each thread a partition once, round robin, so that the shared counter is only
+     * touched the first time a thread asks.
+     */
+    unsigned threadPartitionSeed() {
+#if defined(MONGO_HAVE___THREAD) || defined(MONGO_HAVE___DECLSPEC_THREAD)
+        // 0 marks a thread which hasn't been handed a seed yet; handed out seeds start at 1.
+        if (threadPartition == 0) {
+            threadPartition = nextThreadPartition.addAndFetch(1);
+        }
+        return threadPartition;
+#else
+        return nextThreadPartition.addAndFetch(1);
+#endif
+    }
+
+}  // namespace
+
+    size_t currentCpuPartition(size_t numPartitions) {
+#ifdef __linux__
+        const int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return static_cast<size_t>(cpu) % numPartitions;
+        }
+#endif
+        return threadPartitionSeed() % numPartitions;
+    }
+
+    long long PartitionedCounter64::get() const {
+        long long total = 0;
+        for (int i = 0; i < NumPartitions; i++) {
+            total += _partitions[i].value.loadRelaxed();
+        }
+        return total;
+    }
+
+    void PartitionedCounter64::reset() {
+        for (int i = 0; i < NumPartitions; i++) {
+            _partitions[i].value.store(0);
+        }
+    }
+
+} // namespace mongo
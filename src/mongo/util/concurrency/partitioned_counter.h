@@ -0,0 +1,77 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    /**
+     * Returns a partition in [0, numPartitions) for the calling thread. Where the platform can
+     * tell, this is derived from the CPU the thread is running on, so that threads on different
+     * cores mostly get different partitions. Elsewhere each thread keeps the partition it was
+     * first handed.
+     */
+    size_t currentCpuPartition(size_t numPartitions);
+
+    /**
+     * A 64bit counter split into cache line sized partitions picked by currentCpuPartition(), so
+     * that threads running on different cores don't contend on increment().
+     *
+     * get() sums the partitions. It is more expensive than an increment and, while increments
+     * are in progress, isn't a snapshot of any single instant.
+     */
+    class PartitionedCounter64 {
+        MONGO_DISALLOW_COPYING(PartitionedCounter64);
+    public:
+        PartitionedCounter64() { }
+
+        void increment(uint64_t n = 1) {
+            _partitions[currentCpuPartition(NumPartitions)].value.fetchAndAdd(n);
+        }
+
+        long long get() const;
+
+        operator long long() const { return get(); }
+
+        /** Sets the counter to zero. Increments racing with reset() may be lost. */
+        void reset();
+
+    private:
+        enum { NumPartitions = 32, CacheLineSize = 64 };
+
+        struct Partition {
+            AtomicInt64 value;
+            char pad[CacheLineSize - sizeof(AtomicInt64)];
+        };
+
+        Partition _partitions[NumPartitions];
+    };
+
+} // namespace mongo
@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/partitioned_counter.h"
+
+namespace {
+
+    using mongo::PartitionedCounter64;
+    using mongo::currentCpuPartition;
+
+    void incrementMany(PartitionedCounter64* counter, int n) {
+        for (int i = 0; i < n; i++) {
+            counter->increment();
+        }
+    }
+
+    TEST(PartitionedCounterTest, StartsAtZero) {
+        PartitionedCounter64 counter;
+        ASSERT_EQUALS(0, counter.get());
+    }
+
+    TEST(PartitionedCounterTest, IncrementAndReset) {
+        PartitionedCounter64 counter;
+        counter.increment();
+        counter.increment(41);
+        ASSERT_EQUALS(42, counter.get());
+        ASSERT_EQUALS(42, static_cast<long long>(counter));
+
+        counter.reset();
+        ASSERT_EQUALS(0, counter.get());
+    }
+
+    TEST(PartitionedCounterTest, ConcurrentIncrementsAreNotLost) {
+        const int numThreads = 8;
+        const int perThread = 100 * 1000;
+
+        PartitionedCounter64 counter;
+        boost::thread_group threads;
+        for (int i = 0; i < numThreads; i++) {
+            threads.create_thread(mongo::stdx::bind(&incrementMany, &counter, perThread));
+        }
+        threads.join_all();
+
+        ASSERT_EQUALS(numThreads * perThread, counter.get());
+    }
+
+    TEST(PartitionedCounterTest, PartitionIsInRange) {
+        for (size_t numPartitions = 1; numPartitions < 40; numPartitions++) {
+            ASSERT_LESS_THAN(currentCpuPartition(numPartitions), numPartitions);
+        }
+    }
+
+} // namespace
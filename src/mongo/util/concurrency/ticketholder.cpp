@@ -0,0 +1,181 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/ticketholder.h"
+
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    const long long TicketHolder::kWaitBucketBoundsMicros[] = {
+        1000, 10 * 1000, 100 * 1000, 1000 * 1000
+    };
+
+    TicketHolder::WaitStats::WaitStats() : waits(0), totalWaitMicros(0) {
+        for (int i = 0; i < kNumWaitBuckets; i++) {
+            buckets[i] = 0;
+        }
+    }
+
+    TicketHolder::TicketHolder( int num ) : _outof(num), _num(num), _mutex("TicketHolder") {
+    }
+
+    bool TicketHolder::tryAcquire() {
+        if ( _hasPriorityWaiters( kNormalPriority ) ) {
+            // Leave the ticket to the threads already queued for it.
+            return false;
+        }
+        return _tryAcquire();
+    }
+
+    void TicketHolder::waitForTicket( Priority priority ) {
+        if ( !_hasPriorityWaiters( priority ) && _tryAcquire() ) {
+            return;
+        }
+
+        Timer timer;
+        bool waited = false;
+        {
+            scoped_lock lk( _mutex );
+            _waiters[priority].addAndFetch(1);
+
+            while ( ( priority != kHighPriority && _waiters[kHighPriority].load() > 0 ) ||
+                    !_tryAcquire() ) {
+                waited = true;
+                _newTicket[priority].wait( lk.boost() );
+            }
+
+            _waiters[priority].subtractAndFetch(1);
+
+            // Normal priority waiters skip their turn while high priority waiters are queued, so
+            // the last high priority waiter out hands any remaining ticket back to them.
+            if ( priority == kHighPriority && _waiters[kHighPriority].load() == 0 &&
+                 _num.load() > 0 ) {
+                _newTicket[kNormalPriority].notify_one();
+            }
+        }
+
+        if ( waited ) {
+            _recordWait( priority, timer.micros() );
+        }
+    }
+
+    void TicketHolder::release() {
+        _num.fetchAndAdd(1);
+
+        // The waiter count is raised under the mutex before a waiter looks at _num, so either
+        // the waiter sees our ticket or we see the waiter.  Taking the mutex before notifying
+        // makes sure a waiter that saw no ticket is already blocked on its condition variable.
+        if ( _waiters[kHighPriority].load() == 0 && _waiters[kNormalPriority].load() == 0 ) {
+            return;
+        }
+
+        scoped_lock lk( _mutex );
+        if ( _waiters[kHighPriority].load() > 0 ) {
+            _newTicket[kHighPriority].notify_one();
+        }
+        else {
+            _newTicket[kNormalPriority].notify_one();
+        }
+    }
+
+    void TicketHolder::resize( int newSize ) {
+        {
+            scoped_lock lk( _mutex );
+
+            int used = _outof.load() - _num.load();
+            if ( used > newSize ) {
+                log() << "can't resize since we're using (" << used << ") more than newSize("
+                      << newSize << ")" << std::endl;
+                return;
+            }
+
+            // Concurrent acquires and releases only move _num, so adjust it by the difference
+            // rather than recomputing it from 'used'.
+            _num.fetchAndAdd( newSize - _outof.load() );
+            _outof.store( newSize );
+        }
+
+        // Potentially wasteful, but easier to see is correct
+        for ( int i = 0; i < kNumPriorities; i++ ) {
+            _newTicket[i].notify_all();
+        }
+    }
+
+    TicketHolder::WaitStats TicketHolder::getWaitStats( Priority priority ) const {
+        WaitStats stats;
+        stats.waits = _waitCount[priority].load();
+        stats.totalWaitMicros = _waitMicros[priority].load();
+        for ( int i = 0; i < kNumWaitBuckets; i++ ) {
+            stats.buckets[i] = _waitBuckets[priority][i].load();
+        }
+        return stats;
+    }
+
+    bool TicketHolder::_tryAcquire() {
+        int num = _num.load();
+        while ( num > 0 ) {
+            const int old = _num.compareAndSwap( num, num - 1 );
+            if ( old == num ) {
+                return true;
+            }
+            num = old;
+        }
+
+        if ( num < 0 ) {
+            severe() << "DISASTER! in TicketHolder" << std::endl;
+        }
+        return false;
+    }
+
+    bool TicketHolder::_hasPriorityWaiters( Priority priority ) const {
+        for ( int i = priority; i < kNumPriorities; i++ ) {
+            if ( _waiters[i].load() > 0 ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TicketHolder::_recordWait( Priority priority, long long micros ) {
+        _waitCount[priority].fetchAndAdd(1);
+        _waitMicros[priority].fetchAndAdd(micros);
+
+        int bucket = 0;
+        while ( bucket < kNumWaitBuckets - 1 && micros >= kWaitBucketBoundsMicros[bucket] ) {
+            bucket++;
+        }
+        _waitBuckets[priority][bucket].fetchAndAdd(1);
+    }
+
+}  // namespace mongo
@@ -27,85 +27,91 @@
 #pragma once
 
 #include <boost/thread/condition_variable.hpp>
-#include <iostream>
 
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
+    /**
+     * Counting semaphore handing out a fixed number of tickets.
+     *
+     * Acquiring and releasing a ticket is a compare-and-swap on the ticket count as long as
+     * nobody is queued.  Waiters queue by priority: a ticket released while high priority
+     * waiters are queued goes to one of them, and normal priority callers do not take tickets
+     * from under queued high priority waiters.  Time spent queued is recorded per priority.
+     */
     class TicketHolder {
     public:
-        TicketHolder( int num ) : _mutex("TicketHolder") {
-            _outof = num;
-            _num = num;
-        }
+        enum Priority {
+            kNormalPriority = 0,
+            kHighPriority,
+            kNumPriorities
+        };
 
-        bool tryAcquire() {
-            scoped_lock lk( _mutex );
-            return _tryAcquire();
-        }
+        /**
+         * Upper bounds, in microseconds, of the wait time histogram buckets.  A final bucket
+         * counts every wait longer than the last bound.
+         */
+        static const long long kWaitBucketBoundsMicros[];
+        static const int kNumWaitBuckets = 5;
 
-        void waitForTicket() {
-            scoped_lock lk( _mutex );
+        struct WaitStats {
+            WaitStats();
 
-            while( ! _tryAcquire() ) {
-                _newTicket.wait( lk.boost() );
-            }
-        }
+            // Number of acquisitions that had to queue.
+            long long waits;
+            long long totalWaitMicros;
+            long long buckets[kNumWaitBuckets];
+        };
 
-        void release() {
-            {
-                scoped_lock lk( _mutex );
-                _num++;
-            }
-            _newTicket.notify_one();
-        }
+        TicketHolder( int num );
 
-        void resize( int newSize ) {
-            {
-                scoped_lock lk( _mutex );
+        bool tryAcquire();
 
-                int used = _outof - _num;
-                if ( used > newSize ) {
-                    std::cout << "can't resize since we're using (" << used << ") more than newSize(" << newSize << ")" << std::endl;
-                    return;
-                }
+        void waitForTicket( Priority priority = kNormalPriority );
 
-                _outof = newSize;
-                _num = _outof - used;
-            }
+        void release();
 
-            // Potentially wasteful, but easier to see is correct
-            _newTicket.notify_all();
-        }
+        void resize( int newSize );
 
         int available() const {
-            return _num;
+            return _num.load();
         }
 
         int used() const {
-            return _outof - _num;
+            return outof() - available();
         }
 
-        int outof() const { return _outof; }
+        int outof() const { return _outof.load(); }
+
+        /**
+         * Returns a snapshot of the queueing statistics for 'priority'.  The counters are read
+         * individually, so the snapshot is not atomic with respect to concurrent waits.
+         */
+        WaitStats getWaitStats( Priority priority ) const;
 
     private:
 
-        bool _tryAcquire(){
-            if ( _num <= 0 ) {
-                if ( _num < 0 ) {
-                    std::cerr << "DISASTER! in TicketHolder" << std::endl;
-                }
-                return false;
-            }
-            _num--;
-            return true;
-        }
+        bool _tryAcquire();
+
+        bool _hasPriorityWaiters( Priority priority ) const;
+
+        void _recordWait( Priority priority, long long micros );
+
+        AtomicInt32 _outof;
+        AtomicInt32 _num;
+
+        // Number of threads queued at each priority.  Only changed with _mutex held, but read
+        // without it on the release fast path.
+        AtomicInt32 _waiters[kNumPriorities];
+
+        AtomicInt64 _waitCount[kNumPriorities];
+        AtomicInt64 _waitMicros[kNumPriorities];
+        AtomicInt64 _waitBuckets[kNumPriorities][kNumWaitBuckets];
 
-        int _outof;
-        int _num;
         mongo::mutex _mutex;
-        boost::condition_variable_any _newTicket;
+        boost::condition_variable_any _newTicket[kNumPriorities];
     };
 
     class ScopedTicket {
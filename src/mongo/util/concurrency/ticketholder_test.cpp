@@ -0,0 +1,136 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using mongo::TicketHolder;
+
+    void acquireAndRelease(TicketHolder* holder, TicketHolder::Priority priority) {
+        holder->waitForTicket(priority);
+        holder->release();
+    }
+
+    TEST(TicketHolderTest, BasicAcquireRelease) {
+        TicketHolder holder(2);
+        ASSERT_EQUALS(2, holder.outof());
+        ASSERT_EQUALS(2, holder.available());
+
+        ASSERT(holder.tryAcquire());
+        holder.waitForTicket();
+        ASSERT_EQUALS(0, holder.available());
+        ASSERT_EQUALS(2, holder.used());
+        ASSERT_FALSE(holder.tryAcquire());
+
+        holder.release();
+        ASSERT_EQUALS(1, holder.available());
+        holder.release();
+        ASSERT_EQUALS(2, holder.available());
+        ASSERT_EQUALS(0, holder.used());
+    }
+
+    TEST(TicketHolderTest, Resize) {
+        TicketHolder holder(3);
+        ASSERT(holder.tryAcquire());
+        ASSERT(holder.tryAcquire());
+
+        // Cannot shrink below the number of tickets in use.
+        holder.resize(1);
+        ASSERT_EQUALS(3, holder.outof());
+
+        holder.resize(5);
+        ASSERT_EQUALS(5, holder.outof());
+        ASSERT_EQUALS(3, holder.available());
+
+        holder.release();
+        holder.release();
+        ASSERT_EQUALS(5, holder.available());
+    }
+
+    TEST(TicketHolderTest, UncontendedAcquireIsNotAWait) {
+        TicketHolder holder(1);
+        holder.waitForTicket();
+        holder.release();
+        ASSERT_EQUALS(0, holder.getWaitStats(TicketHolder::kNormalPriority).waits);
+        ASSERT_EQUALS(0, holder.getWaitStats(TicketHolder::kHighPriority).waits);
+    }
+
+    TEST(TicketHolderTest, WaitsAreRecordedPerPriority) {
+        TicketHolder holder(1);
+        holder.waitForTicket();
+
+        boost::thread waiter(mongo::stdx::bind(&acquireAndRelease,
+                                               &holder,
+                                               TicketHolder::kHighPriority));
+        mongo::sleepmillis(20);
+        holder.release();
+        waiter.join();
+
+        ASSERT_EQUALS(1, holder.available());
+
+        const TicketHolder::WaitStats high = holder.getWaitStats(TicketHolder::kHighPriority);
+        ASSERT_EQUALS(1, high.waits);
+        ASSERT_GREATER_THAN(high.totalWaitMicros, 0);
+
+        long long bucketed = 0;
+        for (int i = 0; i < TicketHolder::kNumWaitBuckets; i++) {
+            bucketed += high.buckets[i];
+        }
+        ASSERT_EQUALS(1, bucketed);
+
+        ASSERT_EQUALS(0, holder.getWaitStats(TicketHolder::kNormalPriority).waits);
+    }
+
+    TEST(TicketHolderTest, ManyWaitersAllGetTickets) {
+        TicketHolder holder(2);
+        const int numThreads = 16;
+        boost::thread* threads[numThreads];
+
+        for (int i = 0; i < numThreads; i++) {
+            threads[i] = new boost::thread(mongo::stdx::bind(
+                    &acquireAndRelease,
+                    &holder,
+                    i % 2 ? TicketHolder::kHighPriority : TicketHolder::kNormalPriority));
+        }
+        for (int i = 0; i < numThreads; i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+
+        ASSERT_EQUALS(2, holder.available());
+    }
+
+} // namespace
@@ -0,0 +1,220 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using std::string;
+
+namespace {
+
+    // How many times an idle worker looks for a task before going to sleep.
+    const int kIdleSpins = 1000;
+
+    inline void cpuRelax() {
+#if defined(__i386__) || defined(__x86_64__)
+        asm volatile ( "pause" );
+#endif
+    }
+
+}  // namespace
+
+    WorkStealingThreadPool::WorkStealingThreadPool(int nThreads,
+                                                   const string& threadNamePrefix,
+                                                   Stats* stats)
+        : _stats(stats) {
+        invariant(nThreads > 0);
+
+        for (int i = 0; i < nThreads; i++) {
+            _workers.push_back(new Worker());
+        }
+
+        // Only start the threads once every deque exists: workers steal from each other.
+        for (int i = 0; i < nThreads; i++) {
+            const string threadName = str::stream() << threadNamePrefix << i;
+            _workers[i]->thread.reset(new boost::thread(
+                stdx::bind(&WorkStealingThreadPool::_workerLoop, this, i, threadName)));
+        }
+    }
+
+    WorkStealingThreadPool::~WorkStealingThreadPool() {
+        join();
+
+        {
+            boost::mutex::scoped_lock lk(_sleepMutex);
+            _shutdown.store(1);
+            _wakeCondition.notify_all();
+        }
+
+        for (size_t i = 0; i < _workers.size(); i++) {
+            _workers[i]->thread->join();
+            delete _workers[i];
+        }
+    }
+
+    void WorkStealingThreadPool::schedule(const Task& task) {
+        scheduleWithAffinity(task, _nextWorker.fetchAndAdd(1));
+    }
+
+    void WorkStealingThreadPool::scheduleWithAffinity(const Task& task, size_t affinity) {
+        invariant(task);
+
+        _tasksRemaining.fetchAndAdd(1);
+        if (_stats) {
+            _stats->queued.increment();
+        }
+
+        Worker* worker = _workers[affinity % _workers.size()];
+        {
+            scoped_spinlock lk(worker->lock);
+            worker->tasks.push_back(task);
+            worker->size.fetchAndAdd(1);
+        }
+        _queued.fetchAndAdd(1);
+
+        // A worker going to sleep registers itself before checking _queued, so either it sees
+        // this task or we see it asleep.
+        if (_sleepers.load() > 0) {
+            boost::mutex::scoped_lock lk(_sleepMutex);
+            _wakeCondition.notify_one();
+        }
+    }
+
+    void WorkStealingThreadPool::join() {
+        boost::mutex::scoped_lock lk(_doneMutex);
+        while (_tasksRemaining.load() != 0) {
+            _doneCondition.wait(lk);
+        }
+    }
+
+    bool WorkStealingThreadPool::_takeTask(size_t self, Task* task) {
+        {
+            Worker* own = _workers[self];
+            scoped_spinlock lk(own->lock);
+            if (!own->tasks.empty()) {
+                *task = own->tasks.back();
+                own->tasks.pop_back();
+                own->size.fetchAndSubtract(1);
+                _queued.fetchAndSubtract(1);
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i < _workers.size(); i++) {
+            Worker* victim = _workers[(self + i) % _workers.size()];
+            if (victim->size.loadRelaxed() <= 0) {
+                continue;
+            }
+
+            scoped_spinlock lk(victim->lock);
+            if (!victim->tasks.empty()) {
+                *task = victim->tasks.front();
+                victim->tasks.pop_front();
+                victim->size.fetchAndSubtract(1);
+                _queued.fetchAndSubtract(1);
+                if (_stats) {
+                    _stats->steals.increment();
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void WorkStealingThreadPool::_runTask(const Task& task) {
+        if (_stats) {
+            _stats->queued.decrement();
+        }
+
+        try {
+            task();
+        }
+        catch (const DBException& e) {
+            log() << "Unhandled DBException: " << e.toString();
+        }
+        catch (const std::exception& e) {
+            log() << "Unhandled std::exception in worker thread: " << e.what();
+        }
+        catch (...) {
+            log() << "Unhandled non-exception in worker thread";
+        }
+
+        if (_tasksRemaining.subtractAndFetch(1) == 0) {
+            boost::mutex::scoped_lock lk(_doneMutex);
+            _doneCondition.notify_all();
+        }
+    }
+
+    void WorkStealingThreadPool::_waitForTask() {
+        for (int i = 0; i < kIdleSpins; i++) {
+            if (_queued.loadRelaxed() > 0 || _shutdown.loadRelaxed()) {
+                return;
+            }
+            cpuRelax();
+        }
+
+        boost::mutex::scoped_lock lk(_sleepMutex);
+        _sleepers.fetchAndAdd(1);
+        if (_queued.load() == 0 && !_shutdown.load()) {
+            if (_stats) {
+                _stats->sleeps.increment();
+            }
+            _wakeCondition.wait(lk);
+        }
+        _sleepers.fetchAndSubtract(1);
+    }
+
+    void WorkStealingThreadPool::_workerLoop(size_t self, const string& threadName) {
+        setThreadName(threadName);
+
+        Task task;
+        while (true) {
+            if (_takeTask(self, &task)) {
+                _runTask(task);
+                task = Task();
+                continue;
+            }
+
+            // Tasks queued before the destructor's join() returned have all run by now.
+            if (_shutdown.load()) {
+                return;
+            }
+            _waitForTask();
+        }
+    }
+
+} // namespace mongo
@@ -0,0 +1,149 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/base/counter.h"
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/concurrency/spin_lock.h"
+
+namespace mongo {
+
+    /**
+     * Thread pool for batches of short tasks, such as applying or prefetching oplog entries.
+     *
+     * Every worker has its own deque of tasks. A worker runs the most recently queued task of
+     * its own deque first and, once that is empty, steals the oldest task of another worker's
+     * deque. A worker which finds no task spins for a while before going to sleep, so that a
+     * pool fed in quick successive batches doesn't pay for a wakeup per batch.
+     *
+     * Unlike ThreadPool, scheduling a task only contends with the worker owning the deque it
+     * goes to, and with thieves, rather than with every worker and scheduler.
+     */
+    class WorkStealingThreadPool {
+        MONGO_DISALLOW_COPYING(WorkStealingThreadPool);
+    public:
+        typedef stdx::function<void(void)> Task;
+
+        /**
+         * Counters a pool reports into. Several pools may share one.
+         */
+        struct Stats {
+            Counter64 steals;
+            Counter64 sleeps;
+
+            // tasks waiting to be run, across the pools reporting here
+            Counter64 queued;
+        };
+
+        /**
+         * Starts 'nThreads' workers, named 'threadNamePrefix' followed by their number. If
+         * 'stats' is not NULL the pool reports into it, and it must outlive the pool.
+         */
+        WorkStealingThreadPool(int nThreads, const std::string& threadNamePrefix,
+                               Stats* stats = NULL);
+
+        /** Waits for all tasks to complete, then stops the workers. */
+        ~WorkStealingThreadPool();
+
+        /** Queues 'task' on the next worker in turn. */
+        void schedule(const Task& task);
+
+        /**
+         * Queues 'task' on the worker 'affinity' maps to. Tasks scheduled with the same affinity
+         * tend to run on the same thread, unless that worker falls behind and others steal them.
+         */
+        void scheduleWithAffinity(const Task& task, size_t affinity);
+
+        // Helpers that wrap schedule and stdx::bind.
+        template<typename F, typename A>
+        void schedule(F f, A a) { schedule(Task(stdx::bind(f,a))); }
+        template<typename F, typename A, typename B>
+        void schedule(F f, A a, B b) { schedule(Task(stdx::bind(f,a,b))); }
+
+        /**
+         * Blocks until all tasks are complete (tasks_remaining() == 0). Like ThreadPool::join(),
+         * does not prevent new tasks from being scheduled.
+         */
+        void join();
+
+        int tasks_remaining() const { return _tasksRemaining.load(); }
+
+        size_t numThreads() const { return _workers.size(); }
+
+    private:
+        struct Worker {
+            SpinLock lock;
+            std::deque<Task> tasks;  // guarded by lock
+
+            // tasks.size(), readable without the lock so that thieves only lock deques which
+            // have something to steal
+            AtomicInt32 size;
+
+            boost::scoped_ptr<boost::thread> thread;
+        };
+
+        void _workerLoop(size_t self, const std::string& threadName);
+
+        /**
+         * Takes a task from worker 'self', or else steals one from another worker. Returns false
+         * if every deque is empty.
+         */
+        bool _takeTask(size_t self, Task* task);
+
+        void _runTask(const Task& task);
+
+        /** Waits until there might be a task to take, or the pool is shutting down. */
+        void _waitForTask();
+
+        std::vector<Worker*> _workers;
+        Stats* const _stats;
+
+        AtomicUInt32 _nextWorker;
+        AtomicInt32 _queued;  // tasks in the deques
+        AtomicInt32 _tasksRemaining;  // queued + running
+        AtomicInt32 _sleepers;
+        AtomicUInt32 _shutdown;
+
+        boost::mutex _sleepMutex;
+        boost::condition_variable _wakeCondition;  // signalled when a task is queued
+
+        boost::mutex _doneMutex;
+        boost::condition_variable _doneCondition;  // signalled when _tasksRemaining reaches 0
+    };
+
+} // namespace mongo
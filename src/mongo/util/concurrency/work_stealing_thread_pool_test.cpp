@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using mongo::AtomicInt32;
+    using mongo::WorkStealingThreadPool;
+
+    void increment(AtomicInt32* counter) {
+        counter->fetchAndAdd(1);
+    }
+
+    void sleepThenIncrement(AtomicInt32* counter, int millis) {
+        mongo::sleepmillis(millis);
+        counter->fetchAndAdd(1);
+    }
+
+    TEST(WorkStealingThreadPoolTest, RunsEveryTask) {
+        WorkStealingThreadPool::Stats stats;
+        WorkStealingThreadPool pool(4, "test worker ", &stats);
+        AtomicInt32 counter;
+
+        for (int batch = 0; batch < 10; batch++) {
+            for (int i = 0; i < 1000; i++) {
+                pool.schedule(&increment, &counter);
+            }
+            pool.join();
+            ASSERT_EQUALS(0, pool.tasks_remaining());
+            ASSERT_EQUALS((batch + 1) * 1000, counter.load());
+        }
+        ASSERT_EQUALS(0, stats.queued.get());
+    }
+
+    TEST(WorkStealingThreadPoolTest, IdleWorkersStealFromABusyOne) {
+        WorkStealingThreadPool::Stats stats;
+        WorkStealingThreadPool pool(4, "test worker ", &stats);
+        AtomicInt32 counter;
+
+        // Everything goes to worker 0, so the tasks only finish quickly if the others steal.
+        for (int i = 0; i < 40; i++) {
+            pool.scheduleWithAffinity(mongo::stdx::bind(&sleepThenIncrement, &counter, 5), 0);
+        }
+        pool.join();
+
+        ASSERT_EQUALS(40, counter.load());
+        ASSERT_GREATER_THAN(stats.steals.get(), 0);
+    }
+
+    TEST(WorkStealingThreadPoolTest, DestructorWaitsForTasks) {
+        AtomicInt32 counter;
+        {
+            WorkStealingThreadPool pool(2, "test worker ");
+            for (int i = 0; i < 10; i++) {
+                pool.schedule(&sleepThenIncrement, &counter, 1);
+            }
+        }
+        ASSERT_EQUALS(10, counter.load());
+    }
+
+    TEST(WorkStealingThreadPoolTest, WakesSleepingWorkers) {
+        WorkStealingThreadPool::Stats stats;
+        WorkStealingThreadPool pool(2, "test worker ", &stats);
+        AtomicInt32 counter;
+
+        // Give the workers time to stop spinning and go to sleep.
+        mongo::sleepmillis(100);
+        ASSERT_GREATER_THAN(stats.sleeps.get(), 0);
+
+        pool.schedule(&increment, &counter);
+        pool.join();
+        ASSERT_EQUALS(1, counter.load());
+    }
+
+} // namespace
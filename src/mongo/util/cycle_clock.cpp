@@ -0,0 +1,73 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/cycle_clock.h"
+
+#include "mongo/base/init.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    double CycleClock::_nanosPerTick = 1.0;
+
+    // static
+    unsigned long long CycleClock::_nowGeneric() {
+        return curTimeMicros64();
+    }
+
+    // static
+    long long CycleClock::toNanos(unsigned long long ticks) {
+        return static_cast<long long>(ticks * _nanosPerTick);
+    }
+
+    // static
+    void CycleClock::calibrate() {
+        // A couple of milliseconds against the monotonic clock is accurate to a few parts per
+        // million, far finer than anything the counter is used to time
+        Timer timer;
+        const unsigned long long start = now();
+        while (timer.micros() < 2000) {
+        }
+        const unsigned long long ticks = now() - start;
+        const long long micros = timer.micros();
+
+        if (ticks > 0) {
+            _nanosPerTick = micros * 1000.0 / ticks;
+        }
+    }
+
+    MONGO_INITIALIZER(CycleClockCalibration)(InitializerContext* context) {
+        CycleClock::calibrate();
+        return Status::OK();
+    }
+
+}  // namespace mongo
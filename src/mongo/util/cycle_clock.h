@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+namespace mongo {
+
+    /**
+     * Cheap timestamps for measuring short intervals.  Reads the processor's cycle counter where
+     * there is one (rdtsc on x86, cntvct_el0 on ARMv8) and the system clock elsewhere.
+     *
+     * Readings are only comparable with each other, and only meaningful on the same thread.
+     */
+    class CycleClock {
+    public:
+        static unsigned long long now() {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+            return __rdtsc();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+            unsigned int lo;
+            unsigned int hi;
+            __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+            return (static_cast<unsigned long long>(hi) << 32) | lo;
+#elif defined(__GNUC__) && defined(__aarch64__)
+            unsigned long long ticks;
+            __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+            return ticks;
+#else
+            return _nowGeneric();
+#endif
+        }
+
+        /**
+         * Converts a difference between two now() readings to nanoseconds, using the rate of the
+         * counter measured against the system clock at startup.
+         */
+        static long long toNanos(unsigned long long ticks);
+
+        /**
+         * Measures the rate of the counter.  Called once at startup.
+         */
+        static void calibrate();
+
+    private:
+        static unsigned long long _nowGeneric();
+
+        static double _nanosPerTick;
+    };
+
+}  // namespace mongo
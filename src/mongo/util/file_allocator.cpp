@@ -51,6 +51,7 @@
 #   include <io.h>
 #endif
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/platform/posix_fadvise.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -118,12 +119,29 @@ namespace mongo {
     }
 
     FileAllocator::FileAllocator()
-        : _pendingMutex("FileAllocator"), _failed() {
+        : _pendingMutex("FileAllocator"),
+          _failed(),
+          _numAllocations(0),
+          _numFailures(0),
+          _bytesAllocated(0),
+          _totalAllocMicros(0),
+          _maxAllocMicros(0),
+          _lastAllocMicros(0),
+          _numWaits(0),
+          _totalWaitMicros(0) {
     }
 
 
-    void FileAllocator::start() {
-        boost::thread t( stdx::bind( &FileAllocator::run , this ) );
+    void FileAllocator::start( int numThreads ) {
+        {
+            // initialize unique temporary file name counter
+            // TODO: SERVER-6055 -- Unify temporary file name selection
+            SimpleMutex::scoped_lock lk(_uniqueNumberMutex);
+            _uniqueNumber = curTimeMicros64();
+        }
+        for ( int i = 0; i < std::max( numThreads, 1 ); ++i ) {
+            boost::thread t( stdx::bind( &FileAllocator::run , this ) );
+        }
     }
 
     void FileAllocator::requestAllocation( const string &name, long &size ) {
@@ -155,20 +173,21 @@ namespace mongo {
         }
         checkFailure();
         _pendingSize[ name ] = size;
-        if ( _pending.size() == 0 )
-            _pending.push_back( name );
-        else if ( _pending.front() != name ) {
+        // Workers skip files which are already being allocated, so moving this one to the front
+        // makes it the next file picked up.
+        if ( _claimed.count( name ) == 0 ) {
             _pending.remove( name );
-            list< string >::iterator i = _pending.begin();
-            ++i;
-            _pending.insert( i, name );
+            _pending.push_front( name );
         }
         _pendingUpdated.notify_all();
+
+        Timer t;
         while( inProgress( name ) ) {
             checkFailure();
             _pendingUpdated.wait( lk.boost() );
         }
-
+        _numWaits++;
+        _totalWaitMicros += t.micros();
     }
 
     void FileAllocator::waitUntilFinished() const {
@@ -179,6 +198,20 @@ namespace mongo {
             _pendingUpdated.wait( lk.boost() );
     }
 
+    void FileAllocator::appendStats( BSONObjBuilder* b ) const {
+        scoped_lock lk( _pendingMutex );
+        b->appendNumber( "pending", static_cast<long long>( _pending.size() ) );
+        b->appendNumber( "inProgress", static_cast<long long>( _claimed.size() ) );
+        b->appendNumber( "allocations", _numAllocations );
+        b->appendNumber( "failures", _numFailures );
+        b->appendNumber( "bytesAllocated", _bytesAllocated );
+        b->appendNumber( "totalMicros", _totalAllocMicros );
+        b->appendNumber( "maxMicros", _maxAllocMicros );
+        b->appendNumber( "lastMicros", _lastAllocMicros );
+        b->appendNumber( "waits", _numWaits );
+        b->appendNumber( "waitMicros", _totalWaitMicros );
+    }
+
     // TODO: pull this out to per-OS files once they exist
     static bool useSparseFiles(int fd) {
 
@@ -252,6 +285,16 @@ namespace mongo {
 #endif
 
 #if defined(__linux__)
+#if defined(FALLOC_FL_ZERO_RANGE)
+        // Zero range allocates unwritten extents without touching the data blocks.  Filesystems
+        // (and kernels before 3.15) without support fail with EOPNOTSUPP.
+        if (fallocate(fd, FALLOC_FL_ZERO_RANGE, 0, size) == 0)
+            return;
+
+        LOG(1) << "FileAllocator: fallocate(FALLOC_FL_ZERO_RANGE) failed: "
+               << errnoWithDescription() << " falling back" << endl;
+#endif
+
         int ret = posix_fallocate(fd,0,size);
         if ( ret == 0 )
             return;
@@ -322,6 +365,24 @@ namespace mongo {
         return -1;
     }
 
+    // caller must hold _pendingMutex lock.
+    const string* FileAllocator::nextUnclaimed() const {
+        for( list< string >::const_iterator i = _pending.begin(); i != _pending.end(); ++i )
+            if ( _claimed.count( *i ) == 0 )
+                return &*i;
+        return NULL;
+    }
+
+    // caller must hold _pendingMutex lock.
+    void FileAllocator::recordAllocation( long long micros, long size ) {
+        _numAllocations++;
+        _bytesAllocated += size;
+        _totalAllocMicros += micros;
+        _lastAllocMicros = micros;
+        if ( micros > _maxAllocMicros )
+            _maxAllocMicros = micros;
+    }
+
     // caller must hold _pendingMutex lock.
     bool FileAllocator::inProgress( const string &name ) const {
         for( list< string >::const_iterator i = _pending.begin(); i != _pending.end(); ++i )
@@ -353,112 +414,114 @@ namespace mongo {
 
     void FileAllocator::run( FileAllocator * fa ) {
         setThreadName( "FileAllocator" );
-        {
-            // initialize unique temporary file name counter
-            // TODO: SERVER-6055 -- Unify temporary file name selection
-            SimpleMutex::scoped_lock lk(_uniqueNumberMutex);
-            _uniqueNumber = curTimeMicros64();
-        }
         while( 1 ) {
+            string name;
+            long size = 0;
             {
                 scoped_lock lk( fa->_pendingMutex );
-                if ( fa->_pending.size() == 0 )
+                const string* next;
+                while ( ( next = fa->nextUnclaimed() ) == NULL )
                     fa->_pendingUpdated.wait( lk.boost() );
+                name = *next;
+                size = fa->_pendingSize[ name ];
+                fa->_claimed.insert( name );
             }
-            while( 1 ) {
-                string name;
-                long size = 0;
-                {
-                    scoped_lock lk( fa->_pendingMutex );
-                    if ( fa->_pending.size() == 0 )
-                        break;
-                    name = fa->_pending.front();
-                    size = fa->_pendingSize[ name ];
-                }
 
-                string tmp;
-                long fd = 0;
-                try {
-                    log() << "allocating new datafile " << name << ", filling with zeroes..." << endl;
-                    
-                    boost::filesystem::path parent = ensureParentDirCreated(name);
-                    tmp = fa->makeTempFileName( parent );
-                    ensureParentDirCreated(tmp);
+            string tmp;
+            long fd = 0;
+            long long micros = 0;
+            try {
+                log() << "allocating new datafile " << name << ", filling with zeroes..." << endl;
+
+                boost::filesystem::path parent = ensureParentDirCreated(name);
+                tmp = fa->makeTempFileName( parent );
+                ensureParentDirCreated(tmp);
 
 #if defined(_WIN32)
-                    fd = _open( tmp.c_str(), _O_RDWR | _O_CREAT | O_NOATIME, _S_IREAD | _S_IWRITE );
+                fd = _open( tmp.c_str(), _O_RDWR | _O_CREAT | O_NOATIME, _S_IREAD | _S_IWRITE );
 #else
-                    fd = open(tmp.c_str(), O_CREAT | O_RDWR | O_NOATIME, S_IRUSR | S_IWUSR);
+                fd = open(tmp.c_str(), O_CREAT | O_RDWR | O_NOATIME, S_IRUSR | S_IWUSR);
 #endif
-                    if ( fd < 0 ) {
-                        log() << "FileAllocator: couldn't create " << name << " (" << tmp << ") " << errnoWithDescription() << endl;
-                        uasserted(10439, "");
-                    }
+                if ( fd < 0 ) {
+                    log() << "FileAllocator: couldn't create " << name << " (" << tmp << ") " << errnoWithDescription() << endl;
+                    uasserted(10439, "");
+                }
 
 #if defined(POSIX_FADV_DONTNEED)
-                    if( posix_fadvise(fd, 0, size, POSIX_FADV_DONTNEED) ) {
-                        log() << "warning: posix_fadvise fails " << name << " (" << tmp << ") " << errnoWithDescription() << endl;
-                    }
+                if( posix_fadvise(fd, 0, size, POSIX_FADV_DONTNEED) ) {
+                    log() << "warning: posix_fadvise fails " << name << " (" << tmp << ") " << errnoWithDescription() << endl;
+                }
 #endif
 
-                    Timer t;
+                Timer t;
+
+                /* make sure the file is the full desired length */
+                ensureLength( fd , size );
+
+                close( fd );
+                fd = 0;
+
+                if( rename(tmp.c_str(), name.c_str()) ) {
+                    const string& errStr = errnoWithDescription();
+                    const string& errMessage = str::stream()
+                            << "error: couldn't rename " << tmp
+                            << " to " << name << ' ' << errStr;
+                    msgasserted(13653, errMessage);
+                }
+                flushMyDirectory(name);
 
-                    /* make sure the file is the full desired length */
-                    ensureLength( fd , size );
+                micros = t.micros();
+                log() << "done allocating datafile " << name << ", "
+                      << "size: " << size/1024/1024 << "MB, "
+                      << " took " << ((double)micros)/1000000.0 << " secs"
+                      << endl;
 
+                // no longer in a failed state. allow new writers.
+                fa->_failed = false;
+            }
+            catch ( const std::exception& e ) {
+                log() << "error: failed to allocate new file: " << name
+                      << " size: " << size << ' ' << e.what()
+                      << ".  will try again in 10 seconds" << endl;
+                if ( fd > 0 )
                     close( fd );
-                    fd = 0;
-
-                    if( rename(tmp.c_str(), name.c_str()) ) {
-                        const string& errStr = errnoWithDescription();
-                        const string& errMessage = str::stream()
-                                << "error: couldn't rename " << tmp
-                                << " to " << name << ' ' << errStr;
-                        msgasserted(13653, errMessage);
-                    }
-                    flushMyDirectory(name);
-
-                    log() << "done allocating datafile " << name << ", "
-                          << "size: " << size/1024/1024 << "MB, "
-                          << " took " << ((double)t.millis())/1000.0 << " secs"
-                          << endl;
-
-                    // no longer in a failed state. allow new writers.
-                    fa->_failed = false;
+                try {
+                    if ( ! tmp.empty() )
+                        boost::filesystem::remove( tmp );
+                    boost::filesystem::remove( name );
+                } catch ( const std::exception& e ) {
+                    log() << "error removing files: " << e.what() << endl;
                 }
-                catch ( const std::exception& e ) {
-                    log() << "error: failed to allocate new file: " << name
-                          << " size: " << size << ' ' << e.what()
-                          << ".  will try again in 10 seconds" << endl;
-                    if ( fd > 0 )
-                        close( fd );
-                    try {
-                        if ( ! tmp.empty() )
-                            boost::filesystem::remove( tmp );
-                        boost::filesystem::remove( name );
-                    } catch ( const std::exception& e ) {
-                        log() << "error removing files: " << e.what() << endl;
-                    }
-
-                    {
-                        scoped_lock lk(fa->_pendingMutex);
-                        fa->_failed = true;
-
-                        // TODO: Should we remove the file from pending?
-                        fa->_pendingUpdated.notify_all();
-                    }
-                    
-                    
-                    sleepsecs(10);
-                    continue;
+
+                {
+                    scoped_lock lk(fa->_pendingMutex);
+                    fa->_failed = true;
+                    fa->_numFailures++;
+
+                    // TODO: Should we remove the file from pending?
+                    fa->_pendingUpdated.notify_all();
                 }
 
+
+                sleepsecs(10);
+
                 {
-                    scoped_lock lk( fa->_pendingMutex );
-                    fa->_pendingSize.erase( name );
-                    fa->_pending.pop_front();
+                    // Keep the file claimed while sleeping so other workers don't retry it
+                    // right away.
+                    scoped_lock lk(fa->_pendingMutex);
+                    fa->_claimed.erase( name );
                     fa->_pendingUpdated.notify_all();
                 }
+                continue;
+            }
+
+            {
+                scoped_lock lk( fa->_pendingMutex );
+                fa->recordAllocation( micros, size );
+                fa->_pendingSize.erase( name );
+                fa->_pending.remove( name );
+                fa->_claimed.erase( name );
+                fa->_pendingUpdated.notify_all();
             }
         }
     }
@@ -30,6 +30,7 @@
 #include "mongo/platform/basic.h"
 
 #include <list>
+#include <set>
 #include <boost/filesystem/path.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/thread/condition.hpp>
@@ -38,6 +39,8 @@
 
 namespace mongo {
 
+    class BSONObjBuilder;
+
     /*
      * Handles allocation of contiguous files on disk.  Allocation may be
      * requested asynchronously or synchronously.
@@ -50,7 +53,11 @@ namespace mongo {
          * size specified per file will be used.
         */
     public:
-        void start();
+        /**
+         * Starts 'numThreads' worker threads. Each worker takes the oldest pending file that no
+         * other worker is allocating, so requests for several files are filled in parallel.
+         */
+        void start( int numThreads = 1 );
 
         /**
          * May be called if file exists. If file exists, or its allocation has
@@ -67,6 +74,9 @@ namespace mongo {
 
         void waitUntilFinished() const;
 
+        /** Appends allocation counts and latencies, in microseconds, to 'b'. */
+        void appendStats( BSONObjBuilder* b ) const;
+
         static void ensureLength(int fd, long size);
 
         /** @return the singleton */
@@ -85,7 +95,14 @@ namespace mongo {
         // caller must hold pendingMutex_ lock.
         bool inProgress( const std::string &name ) const;
 
-        /** called from the worked thread */
+        // caller must hold pendingMutex_ lock.  Returns the first pending file no worker has
+        // claimed yet, or NULL if there is none.
+        const std::string* nextUnclaimed() const;
+
+        // caller must hold pendingMutex_ lock.
+        void recordAllocation( long long micros, long size );
+
+        /** called from the worker threads */
         static void run( FileAllocator * fa );
 
         // generate a unique name for temporary files
@@ -97,6 +114,19 @@ namespace mongo {
         std::list< std::string > _pending;
         mutable std::map< std::string, long > _pendingSize;
 
+        // files in _pending which a worker is currently allocating
+        std::set< std::string > _claimed;
+
+        // statistics, protected by _pendingMutex
+        long long _numAllocations;
+        long long _numFailures;
+        long long _bytesAllocated;
+        long long _totalAllocMicros;
+        long long _maxAllocMicros;
+        long long _lastAllocMicros;
+        long long _numWaits;
+        long long _totalWaitMicros;
+
         // unique number for temporary files
         static unsigned long long _uniqueNumber;
 
@@ -66,6 +66,7 @@ namespace {
     const long DEFAULT_FILE_SIZE_MB =  128;
     const file::path DEFAULT_PATH = file::temp_directory_path();
     const int DEFAULT_NTRIALS = 10;
+    const int DEFAULT_NTHREADS = 1;
     const bool DEFAULT_BSON_OUT = false;
 
     // used to convert B/usec to MB/sec
@@ -83,6 +84,8 @@ struct BenchmarkParams {
     bytes_t bytes;
     file::path path;
     int ntrials;
+    int nthreads;
+    bool batch;
     bool quiet;
     bool jsonReportEnabled;
     std::string jsonReportOut;
@@ -93,7 +96,7 @@ public:
     FileAllocatorBenchmark(const BenchmarkParams& params)
         : _fa(FileAllocator::get())
         , _params(params) {
-        _fa->start();
+        _fa->start(_params.nthreads);
 
         if (!file::create_directory(_params.path)) {
             std::cerr << "Error: unable to create temporary directory in "
@@ -110,9 +113,38 @@ public:
     void run() {
         if (!_params.quiet) {
             std::cout << "Allocating " << _params.ntrials << " files of size "
-                      << _params.bytes << " bytes in " << _params.path << std::endl;
+                      << _params.bytes << " bytes in " << _params.path << " using "
+                      << _params.nthreads << " allocator thread(s)"
+                      << (_params.batch ? ", requested as one batch" : "") << std::endl;
         }
 
+        if (_params.batch) {
+            runBatch();
+        }
+        else {
+            runSequential();
+        }
+
+        _fa->waitUntilFinished();
+
+        if (!_params.quiet) {
+            textReport();
+        }
+
+        if (_params.jsonReportEnabled) {
+            jsonReport(_params.jsonReportOut);
+        }
+    }
+
+private:
+    struct benchResults {
+        micros_t avg;
+        micros_t max;
+        micros_t min;
+    };
+
+    // Allocates the files one at a time, waiting for each
+    void runSequential() {
         for (int n = 0; n < _params.ntrials; ++n) {
             const std::string fileName = str::stream() << "garbage-" << n;
             file::path filePath = _params.path / fileName;
@@ -136,25 +168,37 @@ public:
             const ptime::ptime end = ptime::microsec_clock::universal_time();
             _results.push_back((end - start).total_microseconds());
         }
+    }
 
-        _fa->waitUntilFinished();
+    // Queues every file up front, the way preallocation ahead of a growing database does, and
+    // records when each one became available
+    void runBatch() {
+        const ptime::ptime start = ptime::microsec_clock::universal_time();
 
-        if (!_params.quiet) {
-            textReport();
+        for (int n = 0; n < _params.ntrials; ++n) {
+            const std::string fileName = str::stream() << "garbage-" << n;
+            file::path filePath = _params.path / fileName;
+            _files.push_back(filePath);
+            long size_requested = _params.bytes;
+            _fa->requestAllocation(filePath.string(), size_requested);
         }
 
-        if (_params.jsonReportEnabled) {
-            jsonReport(_params.jsonReportOut);
+        for (size_t n = 0; n < _files.size(); ++n) {
+            bytes_t size_allocated = _params.bytes;
+
+            try {
+                _fa->allocateAsap(_files[n].string(), size_allocated);
+            } catch (const DBException& ex) {
+                std::cerr << "Exception thrown while allocating file:"  << std::endl;
+                std::cerr << ex.what() << std::endl;
+                throw; // rethrow so that destructor is called
+            }
+
+            const ptime::ptime end = ptime::microsec_clock::universal_time();
+            _results.push_back((end - start).total_microseconds());
         }
     }
 
-private:
-    struct benchResults {
-        micros_t avg;
-        micros_t max;
-        micros_t min;
-    };
-
     benchResults computeResults() {
         benchResults res;
         const micros_t total = std::accumulate(_results.begin(), _results.end(), 0L);
@@ -194,12 +238,18 @@ private:
         BSONObjBuilder obj;
 
         obj.append("bytes", static_cast<long long>(_params.bytes));
+        obj.append("threads", _params.nthreads);
+        obj.append("batch", _params.batch);
         addResult(obj, "avg", results.avg, _params.bytes);
         addResult(obj, "max", results.max, _params.bytes);
         addResult(obj, "min", results.min, _params.bytes);
 
         obj.append("raw", _results);
 
+        BSONObjBuilder stats(obj.subobjStart("allocator"));
+        _fa->appendStats(&stats);
+        stats.done();
+
         const std::string outStr = obj.done().toString();
 
         if (jsonReportOut == "-") {
@@ -241,6 +291,15 @@ Status addFileAllocatorBenchOptions(moe::OptionSection& options) {
                               "The number of trials to perform")
         .setDefault(moe::Value(DEFAULT_NTRIALS));
 
+    options.addOptionChaining("threads", "threads", moe::Int,
+                              "The number of FileAllocator worker threads")
+        .setDefault(moe::Value(DEFAULT_NTHREADS));
+
+    options.addOptionChaining("batch", "batch", moe::Switch,
+                              str::stream() << "Request all files at once and report the time "
+                                            << "until each became available, instead of "
+                                            << "allocating them one at a time");
+
     options.addOptionChaining("quiet", "quiet", moe::Switch,
                               "Suppress the plaintext report");
 
@@ -288,6 +347,8 @@ Status storeFileAllocatorBenchOptions(const moe::Environment& env) {
     benchParams.path = rootPath / file::unique_path("allocator-bench-%%%%%%%%");
 
     ret = env.get(moe::Key("ntrials"), &benchParams.ntrials);
+    ret = env.get(moe::Key("threads"), &benchParams.nthreads);
+    ret = env.get(moe::Key("batch"), &benchParams.batch);
     ret = env.get(moe::Key("quiet"), &benchParams.quiet);
 
     benchParams.jsonReportEnabled = true;
@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/huge_pages.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(hugePageAllocations, bool, false);
+
+namespace {
+
+    // Mapped length of every live huge page allocation, for free() and the byte count
+    typedef std::map<void*, size_t> Mappings;
+
+    SimpleMutex mappingsMutex("hugePages");
+    Mappings mappings;
+
+    AtomicInt64 allocations;
+    AtomicInt64 failedAllocations;
+    AtomicInt64 currentBytes;
+
+    /**
+     * Reads a field such as "Hugepagesize" from /proc/meminfo.  Returns 0 if it isn't there.
+     */
+    long long readMeminfo(const std::string& name) {
+        std::ifstream in("/proc/meminfo");
+        std::string field;
+        long long value;
+        while (in >> field >> value) {
+            if (field == name + ":") {
+                return value;
+            }
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        return 0;
+    }
+
+    /**
+     * The system default huge page size, or 0 if huge page allocations are off or unsupported.
+     * Fixed at first use so that allocate() and free() agree for the life of the process.
+     */
+    size_t hugePageSize() {
+#if defined(MAP_HUGETLB)
+        static const size_t size = hugePageAllocations ? readMeminfo("Hugepagesize") * 1024 : 0;
+        return size;
+#else
+        return 0;
+#endif
+    }
+
+} // namespace
+
+    void* HugePages::allocate(size_t size) {
+        const size_t pageSize = hugePageSize();
+        if (pageSize == 0 || size < pageSize) {
+            return NULL;
+        }
+
+#if defined(MAP_HUGETLB)
+        const size_t length = (size + pageSize - 1) / pageSize * pageSize;
+        void* p = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p == MAP_FAILED) {
+            if (failedAllocations.fetchAndAdd(1) == 0) {
+                warning() << "could not allocate " << length << " bytes of huge pages, using "
+                          << "ordinary pages instead: " << errnoWithDescription()
+                          << ". Check vm.nr_hugepages.";
+            }
+            return NULL;
+        }
+
+        {
+            SimpleMutex::scoped_lock lk(mappingsMutex);
+            mappings[p] = length;
+        }
+        allocations.fetchAndAdd(1);
+        currentBytes.fetchAndAdd(length);
+        return p;
+#else
+        return NULL;
+#endif
+    }
+
+    bool HugePages::free(void* ptr) {
+        if (hugePageSize() == 0 || ptr == NULL) {
+            return false;
+        }
+
+#if defined(MAP_HUGETLB)
+        size_t length;
+        {
+            SimpleMutex::scoped_lock lk(mappingsMutex);
+            Mappings::iterator it = mappings.find(ptr);
+            if (it == mappings.end()) {
+                return false;
+            }
+            length = it->second;
+            mappings.erase(it);
+        }
+
+        fassert(28633, munmap(ptr, length) == 0);
+        currentBytes.fetchAndSubtract(length);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void HugePages::appendStats(BSONObjBuilder* builder) {
+        builder->append("enabled", hugePageSize() != 0);
+        builder->appendNumber("pageSizeBytes", static_cast<long long>(hugePageSize()));
+        builder->appendNumber("allocations", allocations.load());
+        builder->appendNumber("failedAllocations", failedAllocations.load());
+        builder->appendNumber("currentBytes", currentBytes.load());
+
+#if defined(__linux__)
+        BSONObjBuilder system(builder->subobjStart("system"));
+        system.appendNumber("total", readMeminfo("HugePages_Total"));
+        system.appendNumber("free", readMeminfo("HugePages_Free"));
+        system.appendNumber("reserved", readMeminfo("HugePages_Rsvd"));
+        system.done();
+#endif
+    }
+
+} // namespace mongo
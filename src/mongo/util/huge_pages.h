@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#include "mongo/util/allocator.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Backing for large, long-lived buffers with explicitly reserved huge pages (Linux
+     * MAP_HUGETLB), which cuts TLB misses on buffers that are scanned or sorted repeatedly.
+     * Disabled unless mongod is started with --setParameter hugePageAllocations=true, and only
+     * useful if the administrator reserved pages through vm.nr_hugepages.  The page size is the
+     * system default huge page size (2MB, or 1GB with default_hugepagesz=1G).
+     */
+    class HugePages {
+    public:
+        /**
+         * Maps 'size' bytes, rounded up to a whole number of huge pages.  Returns NULL if huge
+         * pages are disabled, 'size' is less than one huge page or no reserved pages are free,
+         * in which case the caller should fall back to an ordinary allocation.
+         */
+        static void* allocate(size_t size);
+
+        /**
+         * Unmaps 'ptr' if it came from allocate().  Returns false, doing nothing, otherwise.
+         */
+        static bool free(void* ptr);
+
+        /**
+         * Appends the usage counters and the host's huge page pool for serverStatus.
+         */
+        static void appendStats(BSONObjBuilder* builder);
+    };
+
+    /**
+     * Standard library allocator that backs allocations with huge pages when HugePages
+     * allows it, and with mongoMalloc() otherwise.
+     */
+    template <typename T>
+    class HugePageAllocator {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template <typename U>
+        struct rebind { typedef HugePageAllocator<U> other; };
+
+        HugePageAllocator() { }
+
+        template <typename U>
+        HugePageAllocator(const HugePageAllocator<U>&) { }
+
+        pointer allocate(size_type n, const void* hint = 0) {
+            const size_t bytes = n * sizeof(T);
+            void* p = HugePages::allocate(bytes);
+            return static_cast<pointer>(p ? p : mongoMalloc(bytes));
+        }
+
+        void deallocate(pointer p, size_type n) {
+            if (!HugePages::free(p)) {
+                std::free(p);
+            }
+        }
+
+        size_type max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        void construct(pointer p, const T& val) { new (p) T(val); }
+        void destroy(pointer p) { p->~T(); }
+
+        template <typename U>
+        bool operator==(const HugePageAllocator<U>&) const { return true; }
+
+        template <typename U>
+        bool operator!=(const HugePageAllocator<U>&) const { return false; }
+    };
+
+} // namespace mongo
@@ -37,6 +37,7 @@
 #include <unistd.h>
 #endif
 
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/logger/ramlog.h"
 #include "mongo/logger/rotatable_file_manager.h"
 #include "mongo/util/assert_util.h"
@@ -70,6 +71,9 @@ namespace mongo {
     bool rotateLogs(bool renameFiles) {
         using logger::RotatableFileManager;
         RotatableFileManager* manager = logger::globalRotatableFileManager();
+
+        // Buffered messages were logged before the rotation, so they belong to the old file
+        logger::AsyncLogWriter::flushAll();
         RotatableFileManager::FileNameStatusPairVector result(
                 manager->rotateAll(renameFiles, "." + terseCurrentTime(false)));
         for (RotatableFileManager::FileNameStatusPairVector::iterator it = result.begin();
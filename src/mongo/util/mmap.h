@@ -54,12 +54,18 @@ namespace mongo {
     class MAdvise {
         MONGO_DISALLOW_COPYING(MAdvise);
     public:
-        enum Advice { Sequential=1 , Random=2 };
-        MAdvise(void *p, unsigned len, Advice a);
-        ~MAdvise(); // destructor resets the range to MADV_NORMAL
+        enum Advice { Normal=0 , Sequential=1 , Random=2 , WillNeed=3 };
+
+        /**
+         * @param restoreTo advice the range gets back on destruction, for ranges in files which
+         *      are not mapped with the default advice
+         */
+        MAdvise(void *p, unsigned len, Advice a, Advice restoreTo = Normal);
+        ~MAdvise(); // destructor resets the range to restoreTo
     private:
         void *_p;
         unsigned _len;
+        Advice _restoreTo;
     };
 
     // lock order: lock dbMutex before this if you lock both
@@ -105,7 +111,8 @@ namespace mongo {
 
         enum Options {
             SEQUENTIAL = 1, // hint - e.g. FILE_FLAG_SEQUENTIAL_SCAN on windows
-            READONLY = 2    // not contractually guaranteed, but if specified the impl has option to fault writes
+            READONLY = 2,   // not contractually guaranteed, but if specified the impl has option to fault writes
+            RANDOM = 4      // hint - accessed by point lookups, turns kernel readahead off (posix only)
         };
 
         /** @param fun is called for each MongoFile.
@@ -227,11 +234,18 @@ namespace mongo {
     private:
         static void updateLength( const char *filename, unsigned long long &length );
 
+        // Applies MADV_RANDOM to a new view of a file mapped with the RANDOM option
+        void _adviseRandomIfNeeded(void* view);
+
         HANDLE fd;
         HANDLE maphandle;
         std::vector<void *> views;
         unsigned long long len;
         const uint64_t _uniqueId;
+
+        // Whether the file was mapped with the RANDOM option. Private views get the same advice,
+        // including after they are remapped.
+        bool _randomAccess;
 #ifdef _WIN32
         // flush Mutex
         //
@@ -66,7 +66,9 @@ namespace mongo {
         
     
 
-    MemoryMappedFile::MemoryMappedFile() : _uniqueId(mmfNextId.fetchAndAdd(1)) {
+    MemoryMappedFile::MemoryMappedFile()
+        : _uniqueId(mmfNextId.fetchAndAdd(1)),
+          _randomAccess(false) {
         fd = 0;
         maphandle = 0;
         len = 0;
@@ -125,33 +127,43 @@ namespace mongo {
     }
 
 #if defined(__sunos__)
-    MAdvise::MAdvise(void *,unsigned, Advice) { }
+    MAdvise::MAdvise(void *,unsigned, Advice, Advice) { }
     MAdvise::~MAdvise() { }
 #else
-    MAdvise::MAdvise(void *p, unsigned len, Advice a) {
+    namespace {
+        int toMadvise(MAdvise::Advice a) {
+            switch ( a ) {
+            case MAdvise::Normal:
+                return MADV_NORMAL;
+            case MAdvise::Sequential:
+                return MADV_SEQUENTIAL;
+            case MAdvise::Random:
+                return MADV_RANDOM;
+            case MAdvise::WillNeed:
+                return MADV_WILLNEED;
+            }
+            return MADV_NORMAL;
+        }
+    }
+
+    MAdvise::MAdvise(void *p, unsigned len, Advice a, Advice restoreTo)
+        : _restoreTo(restoreTo) {
 
         _p = _pageAlign( p );
 
         _len = len + static_cast<unsigned>( reinterpret_cast<size_t>(p) -
                                             reinterpret_cast<size_t>(_p)  );
 
-        int advice = 0;
-        switch ( a ) {
-        case Sequential:
-            advice = MADV_SEQUENTIAL;
-            break;
-        case Random:
-            advice = MADV_RANDOM;
-            break;
-        }
-
-        if ( madvise(_p,_len,advice ) ) {
+        if ( madvise(_p,_len,toMadvise(a) ) ) {
             error() << "madvise failed: " << errnoWithDescription();
         }
 
     }
     MAdvise::~MAdvise() {
-        madvise(_p,_len,MADV_NORMAL);
+        // WILLNEED only schedules reads and leaves the access pattern alone
+        if ( _restoreTo != WillNeed ) {
+            madvise(_p,_len,toMadvise(_restoreTo));
+        }
     }
 #endif
 
@@ -195,7 +207,13 @@ namespace mongo {
                 warning() << "map: madvise failed for " << filename << ' ' << errnoWithDescription() << endl;
             }
         }
+        else if ( options & RANDOM ) {
+            if ( madvise( view , length , MADV_RANDOM ) ) {
+                warning() << "map: madvise failed for " << filename << ' ' << errnoWithDescription() << endl;
+            }
+        }
 #endif
+        _randomAccess = !( options & SEQUENTIAL ) && ( options & RANDOM );
 
         views.push_back( view );
 
@@ -233,6 +251,8 @@ namespace mongo {
             return 0;
         }
 
+        _adviseRandomIfNeeded(x);
+
         views.push_back(x);
         return x;
     }
@@ -252,9 +272,21 @@ namespace mongo {
             abort();
         }
         verify( x == oldPrivateAddr );
+
+        // The new mapping starts over with the default advice
+        _adviseRandomIfNeeded(x);
+
         return x;
     }
 
+    void MemoryMappedFile::_adviseRandomIfNeeded(void* view) {
+#if !defined(__sunos__)
+        if ( _randomAccess && madvise( view , len , MADV_RANDOM ) ) {
+            warning() << "madvise failed for " << filename() << ' ' << errnoWithDescription();
+        }
+#endif
+    }
+
     void MemoryMappedFile::flush(bool sync) {
         if ( views.empty() || fd == 0 )
             return;
@@ -71,7 +71,7 @@ namespace mongo {
     //  - If taken, must be after previewViews._m to prevent deadlocks
     mutex mapViewMutex("mapView");
 
-    MAdvise::MAdvise(void *,unsigned, Advice) { }
+    MAdvise::MAdvise(void *,unsigned, Advice, Advice) { }
     MAdvise::~MAdvise() { }
 
     const unsigned long long memoryMappedFileLocationFloor = 256LL * 1024LL * 1024LL * 1024LL;
@@ -150,7 +150,8 @@ namespace mongo {
     }
 
     MemoryMappedFile::MemoryMappedFile()
-        : _uniqueId(mmfNextId.fetchAndAdd(1)) {
+        : _uniqueId(mmfNextId.fetchAndAdd(1)),
+          _randomAccess(false) {
         fd = 0;
         maphandle = 0;
         len = 0;
@@ -38,12 +38,14 @@
 #include <boost/shared_ptr.hpp>
 
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message_port.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 #ifndef _WIN32
 
@@ -60,6 +62,7 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <netdb.h>
 #ifdef __openbsd__
 # include <sys/uio.h>
@@ -82,6 +85,15 @@ namespace mongo {
 
     // ----- Listener -------
 
+    // The length of the queue of connections waiting to be accepted on each listening socket.
+    // The kernel caps it, at net.core.somaxconn on Linux.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(listenBacklog, int, 1024);
+
+    namespace {
+        // The most connections accepted from one listening socket before checking the others.
+        const int kMaxAcceptBatch = 128;
+    }  // namespace
+
     const Listener* Listener::_timeTracker;
 
     vector<SockAddr> ipToAddrs(const char* ips, int port, bool useUnixSockets) {
@@ -215,6 +227,16 @@ namespace mongo {
     
  
 #if !defined(_WIN32)
+    // Sets or clears O_NONBLOCK on 'sock'.  Returns false on failure, with errno set.
+    static bool setBlocking(SOCKET sock, bool blocking) {
+        const int flags = fcntl(sock, F_GETFL, 0);
+        if (flags < 0) {
+            return false;
+        }
+        const int newFlags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+        return newFlags == flags || fcntl(sock, F_SETFL, newFlags) == 0;
+    }
+
     void Listener::initAndListen() {
         if (!_setupSocketsSuccessful) {
             return;
@@ -222,11 +244,17 @@ namespace mongo {
 
         SOCKET maxfd = 0; // needed for select()
         for (unsigned i = 0; i < _socks.size(); i++) {
-            if (::listen(_socks[i], 128) != 0) {
+            if (::listen(_socks[i], listenBacklog) != 0) {
                 error() << "listen(): listen() failed " << errnoWithDescription() << endl;
                 return;
             }
 
+            if (!setBlocking(_socks[i], false)) {
+                error() << "listen(): could not make socket non-blocking "
+                        << errnoWithDescription() << endl;
+                return;
+            }
+
             ListeningSockets::get()->add(_socks[i]);
 
             if (_socks[i] > maxfd) {
@@ -297,55 +325,78 @@ namespace mongo {
             for (vector<SOCKET>::iterator it=_socks.begin(), end=_socks.end(); it != end; ++it) {
                 if (! (FD_ISSET(*it, fds)))
                     continue;
-                SockAddr from;
-                int s = accept(*it, from.raw(), &from.addressSize);
-                if ( s < 0 ) {
-                    int x = errno; // so no global issues
-                    if (x == EBADF) {
-                        log() << "Port " << _port << " is no longer valid" << endl;
-                        return;
-                    }
-                    else if (x == ECONNABORTED) {
-                        log() << "Connection on port " << _port << " aborted" << endl;
-                        continue;
-                    }
-                    if ( x == 0 && inShutdown() ) {
-                        return;   // socket closed
-                    }
-                    if( !inShutdown() ) {
-                        log() << "Listener: accept() returns " << s << " " << errnoWithDescription(x) << endl;
-                        if (x == EMFILE || x == ENFILE) {
-                            // Connection still in listen queue but we can't accept it yet
-                            error() << "Out of file descriptors. Waiting one second before trying to accept more connections." << warnings;
-                            sleepsecs(1);
+
+                // The listening sockets are non-blocking, so drain what is queued on this one,
+                // up to a batch, before going back to select().  During a connection storm that
+                // costs one select() per batch rather than one per connection.
+                const long long batchStartMicros = curTimeMicros64();
+                int numAccepted = 0;
+                while (numAccepted < kMaxAcceptBatch) {
+                    SockAddr from;
+                    int s = accept(*it, from.raw(), &from.addressSize);
+                    if ( s < 0 ) {
+                        int x = errno; // so no global issues
+                        if (x == EAGAIN || x == EWOULDBLOCK) {
+                            break;
+                        }
+                        if (x == EBADF) {
+                            log() << "Port " << _port << " is no longer valid" << endl;
+                            return;
+                        }
+                        else if (x == ECONNABORTED) {
+                            log() << "Connection on port " << _port << " aborted" << endl;
+                            continue;
                         }
+                        if ( x == 0 && inShutdown() ) {
+                            return;   // socket closed
+                        }
+                        if( !inShutdown() ) {
+                            log() << "Listener: accept() returns " << s << " " << errnoWithDescription(x) << endl;
+                            if (x == EMFILE || x == ENFILE) {
+                                // Connection still in listen queue but we can't accept it yet
+                                error() << "Out of file descriptors. Waiting one second before trying to accept more connections." << warnings;
+                                sleepsecs(1);
+                            }
+                        }
+                        break;
                     }
-                    continue;
-                }
-                if (from.getType() != AF_UNIX)
-                    disableNagle(s);
+                    ++numAccepted;
+
+#if !defined(__linux__)
+                    // Unlike Linux, BSDs hand out accepted sockets with the listening socket's
+                    // O_NONBLOCK set.
+                    setBlocking(s, true);
+#endif
+                    if (from.getType() != AF_UNIX)
+                        disableNagle(s);
 
 #ifdef SO_NOSIGPIPE
-                // ignore SIGPIPE signals on osx, to avoid process exit
-                const int one = 1;
-                setsockopt( s , SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(int));
+                    // ignore SIGPIPE signals on osx, to avoid process exit
+                    const int one = 1;
+                    setsockopt( s , SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(int));
 #endif
 
-                long long myConnectionNumber = globalConnectionNumber.addAndFetch(1);
+                    long long myConnectionNumber = globalConnectionNumber.addAndFetch(1);
 
-                if (_logConnect && !serverGlobalParams.quiet) {
-                    int conns = globalTicketHolder.used()+1;
-                    const char* word = (conns == 1 ? " connection" : " connections");
-                    log() << "connection accepted from " << from.toString() << " #" << myConnectionNumber << " (" << conns << word << " now open)" << endl;
-                }
-                
-                boost::shared_ptr<Socket> pnewSock( new Socket(s, from) );
+                    if (_logConnect && !serverGlobalParams.quiet) {
+                        int conns = globalTicketHolder.used()+1;
+                        const char* word = (conns == 1 ? " connection" : " connections");
+                        log() << "connection accepted from " << from.toString() << " #" << myConnectionNumber << " (" << conns << word << " now open)" << endl;
+                    }
+
+                    boost::shared_ptr<Socket> pnewSock( new Socket(s, from) );
 #ifdef MONGO_SSL
-                if (_ssl) {
-                    pnewSock->secureAccepted(_ssl);
-                }
+                    if (_ssl) {
+                        pnewSock->secureAccepted(_ssl);
+                    }
 #endif
-                accepted( pnewSock , myConnectionNumber );
+                    accepted( pnewSock , myConnectionNumber );
+                }
+
+                if (numAccepted > 0) {
+                    globalAcceptBatches.addAndFetch(1);
+                    globalAcceptMicros.addAndFetch(curTimeMicros64() - batchStartMicros);
+                }
             }
         }
     }
@@ -407,7 +458,7 @@ namespace mongo {
         }
 
         for (unsigned i = 0; i < _socks.size(); i++) {
-            if (::listen(_socks[i], 128) != 0) {
+            if (::listen(_socks[i], listenBacklog) != 0) {
                 error() << "listen(): listen() failed " << errnoWithDescription() << endl;
                 return;
             }
@@ -637,6 +688,8 @@ namespace mongo {
 
     TicketHolder Listener::globalTicketHolder(DEFAULT_MAX_CONN);
     AtomicInt64 Listener::globalConnectionNumber;
+    AtomicInt64 Listener::globalAcceptBatches;
+    AtomicInt64 Listener::globalAcceptMicros;
 
     void ListeningSockets::closeAll() {
         std::set<int>* sockets;
@@ -132,6 +132,12 @@ namespace mongo {
         /** the "next" connection number.  every connection to this process has a unique number */
         static AtomicInt64 globalConnectionNumber;
 
+        /** how many times a listener woke up and accepted one or more connections */
+        static AtomicInt64 globalAcceptBatches;
+
+        /** time spent accepting connections and handing them off, in microseconds */
+        static AtomicInt64 globalAcceptMicros;
+
         /** keeps track of how many allowed connections there are and how many are being used*/
         static TicketHolder globalTicketHolder;
 
@@ -38,8 +38,10 @@
 #include "mongo/util/allocator.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/net/message_buffer_pool.h"
 #include "mongo/util/net/sock.h"
 #include "mongo/util/print.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 
@@ -63,7 +65,8 @@ namespace mongo {
         dbQuery = 2004,
         dbGetMore = 2005,
         dbDelete = 2006,
-        dbKillCursors = 2007
+        dbKillCursors = 2007,
+        dbCompressed = 2012 /* another message, compressed. see message_compressor.h */
     };
 
     bool doesOpGetAResponse( int op );
@@ -79,6 +82,7 @@ namespace mongo {
         case dbGetMore: return "getmore";
         case dbDelete: return "remove";
         case dbKillCursors: return "killcursors";
+        case dbCompressed: return "compressed";
         default:
             massert( 16141, str::stream() << "cannot translate opcode " << op, !op );
             return "";
@@ -324,12 +328,12 @@ namespace mongo {
     class Message {
     public:
         // we assume here that a vector with initial size 0 does no allocation (0 is the default, but wanted to make it explicit).
-        Message() : _buf( 0 ), _data( 0 ), _freeIt( false ) {}
+        Message() : _buf( 0 ), _data( 0 ), _freeIt( false ), _pooled( false ) {}
         Message( void * data , bool freeIt ) :
-            _buf( 0 ), _data( 0 ), _freeIt( false ) {
+            _buf( 0 ), _data( 0 ), _freeIt( false ), _pooled( false ) {
             _setData( reinterpret_cast< char* >( data ), freeIt );
         };
-        Message(Message& r) : _buf( 0 ), _data( 0 ), _freeIt( false ) {
+        Message(Message& r) : _buf( 0 ), _data( 0 ), _freeIt( false ), _pooled( false ) {
             *this = r;
         }
         ~Message() {
@@ -352,6 +356,9 @@ namespace mongo {
 
         bool empty() const { return !_buf && _data.empty(); }
 
+        /** Whether the whole message is in one buffer, as singleData() requires. */
+        bool isSingleBuffer() const { return _buf != 0; }
+
         int size() const {
             int res = 0;
             if ( _buf ) {
@@ -399,25 +406,31 @@ namespace mongo {
             r._buf = 0;
             if ( r._data.size() > 0 ) {
                 _data.swap( r._data );
+                _shared.swap( r._shared );
             }
             r._freeIt = false;
             _freeIt = true;
+            _pooled = r._pooled;
+            r._pooled = false;
             return *this;
         }
 
         void reset() {
             if ( _freeIt ) {
                 if ( _buf ) {
-                    free( _buf );
+                    _freeBuffer( _buf, true );
                 }
-                for (std::vector< std::pair< char *, int > >::const_iterator i = _data.begin();
-                     i != _data.end(); ++i) {
-                    free(i->first);
+                for (size_t i = 0; i < _data.size(); ++i) {
+                    if (_shared.empty() || !_shared[i].get()) {
+                        _freeBuffer( _data[i].first, i == 0 );
+                    }
                 }
             }
             _buf = 0;
             _data.clear();
+            _shared.clear();
             _freeIt = false;
+            _pooled = false;
         }
 
         // use to add a buffer
@@ -432,13 +445,24 @@ namespace mongo {
                 _setData( md.view2ptr(), true );
                 return;
             }
-            verify( _freeIt );
-            if ( _buf ) {
-                _data.push_back(std::make_pair(_buf, MsgData::ConstView(_buf).getLen()));
-                _buf = 0;
+            _appendPiece(d, size, SharedBuffer());
+        }
+
+        /**
+         * Adds a buffer which stays owned by 'holder': the message keeps a reference on it
+         * rather than freeing it, and sends it without copying. The message must not be empty.
+         */
+        void appendSharedData(const SharedBuffer& holder, const char* d, int size) {
+            verify( !empty() );
+            verify( holder.get() );
+            if ( size <= 0 ) {
+                return;
             }
-            _data.push_back(std::make_pair(d, size));
-            header().setLen(header().getLen() + size);
+            if ( _shared.empty() ) {
+                // All the pieces so far are ours to free
+                _shared.resize( _buf ? 1 : _data.size() );
+            }
+            _appendPiece(const_cast<char*>(d), size, holder);
         }
 
         // use to set first buffer if empty
@@ -446,6 +470,16 @@ namespace mongo {
             verify( empty() );
             _setData( d, freeIt );
         }
+
+        /**
+         * Sets the first buffer to 'd', which came from MessageBufferPool::allocate() and goes
+         * back to the pool once the message is reset.
+         */
+        void setPooledData(char* d) {
+            verify( empty() );
+            _setData( d, true );
+            _pooled = true;
+        }
         void setData(int operation, const char *msgtxt) {
             setData(operation, msgtxt, strlen(msgtxt)+1);
         }
@@ -472,12 +506,40 @@ namespace mongo {
             _freeIt = freeIt;
             _buf = d;
         }
+
+        // 'first' is true for the buffer set with setData(), which may be pooled.
+        void _freeBuffer( char* d, bool first ) {
+            if ( first && _pooled ) {
+                MessageBufferPool::release( d );
+            }
+            else {
+                free( d );
+            }
+        }
+
+        void _appendPiece(char* d, int size, const SharedBuffer& holder) {
+            verify( _freeIt );
+            if ( _buf ) {
+                _data.push_back(std::make_pair(_buf, MsgData::ConstView(_buf).getLen()));
+                _buf = 0;
+            }
+            _data.push_back(std::make_pair(d, size));
+            if ( !_shared.empty() ) {
+                _shared.push_back(holder);
+            }
+            header().setLen(header().getLen() + size);
+        }
         // if just one buffer, keep it in _buf, otherwise keep a sequence of buffers in _data
         char* _buf;
         // byte buffer(s) - the first must contain at least a full MsgData unless using _buf for storage instead
         typedef std::vector< std::pair< char*, int > > MsgVec;
         MsgVec _data;
+        // Empty unless appendSharedData() was used. Otherwise one entry per piece in _data,
+        // holding the buffer of a shared piece and empty for the pieces which must be freed.
+        std::vector<SharedBuffer> _shared;
         bool _freeIt;
+        // Whether the first buffer came from MessageBufferPool.
+        bool _pooled;
     };
 
 
@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_buffer_pool.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+    // How many bytes of freed message buffers each thread keeps for reuse. Zero disables
+    // recycling.
+    MONGO_EXPORT_SERVER_PARAMETER(messageBufferPoolThreadCacheBytes, int, 4 * 1024 * 1024);
+
+    Counter64 MessageBufferPool::hits;
+    Counter64 MessageBufferPool::misses;
+
+    namespace {
+
+        // Every buffer is preceded by a header recording its size class. It is 16 bytes to keep
+        // the buffer as aligned as malloc's.
+        const size_t kHeaderBytes = 16;
+
+        const int kMinClassShift = 10;
+        const int kNumClasses = 11;
+
+        // The class of buffers too large to be recycled.
+        const int kUnpooledClass = kNumClasses;
+
+        // Keep at most this many free buffers of one class per thread.
+        const size_t kMaxBuffersPerClass = 4;
+
+        size_t classBytes(int sizeClass) {
+            return size_t(1) << (sizeClass + kMinClassShift);
+        }
+
+        int sizeClassFor(size_t size) {
+            for (int sizeClass = 0; sizeClass < kNumClasses; ++sizeClass) {
+                if (size <= classBytes(sizeClass)) {
+                    return sizeClass;
+                }
+            }
+            return kUnpooledClass;
+        }
+
+        int& headerOf(char* buf) {
+            return *reinterpret_cast<int*>(buf - kHeaderBytes);
+        }
+
+    }  // namespace
+
+    /**
+     * The free buffers of one thread, by size class. Freed when the thread exits.
+     */
+    struct MessageBufferCache {
+        MessageBufferCache() : bytes(0) { }
+
+        ~MessageBufferCache() {
+            clear();
+        }
+
+        void clear() {
+            for (int sizeClass = 0; sizeClass < kNumClasses; ++sizeClass) {
+                for (size_t i = 0; i < buffers[sizeClass].size(); ++i) {
+                    free(buffers[sizeClass][i] - kHeaderBytes);
+                }
+                buffers[sizeClass].clear();
+            }
+            bytes = 0;
+        }
+
+        std::vector<char*> buffers[kNumClasses];
+        size_t bytes;
+    };
+
+    TSP_DECLARE(MessageBufferCache, messageBufferCache);
+    TSP_DEFINE(MessageBufferCache, messageBufferCache);
+
+    // static
+    char* MessageBufferPool::allocate(size_t size) {
+        const int sizeClass = sizeClassFor(size);
+
+        if (sizeClass != kUnpooledClass) {
+            MessageBufferCache* cache = messageBufferCache.getMake();
+            std::vector<char*>& buffers = cache->buffers[sizeClass];
+            if (!buffers.empty()) {
+                char* buf = buffers.back();
+                buffers.pop_back();
+                cache->bytes -= classBytes(sizeClass);
+                hits.increment();
+                return buf;
+            }
+            misses.increment();
+        }
+
+        const size_t bytes = sizeClass == kUnpooledClass ? size : classBytes(sizeClass);
+        char* buf = static_cast<char*>(mongoMalloc(kHeaderBytes + bytes)) + kHeaderBytes;
+        headerOf(buf) = sizeClass;
+        return buf;
+    }
+
+    // static
+    void MessageBufferPool::release(char* buf) {
+        if (!buf) {
+            return;
+        }
+
+        const int sizeClass = headerOf(buf);
+        dassert(sizeClass >= 0 && sizeClass <= kUnpooledClass);
+
+        if (sizeClass != kUnpooledClass) {
+            MessageBufferCache* cache = messageBufferCache.getMake();
+            std::vector<char*>& buffers = cache->buffers[sizeClass];
+            const size_t bytes = classBytes(sizeClass);
+            const int maxBytes = messageBufferPoolThreadCacheBytes;
+            if (buffers.size() < kMaxBuffersPerClass &&
+                maxBytes > 0 &&
+                cache->bytes + bytes <= static_cast<size_t>(maxBytes)) {
+                buffers.push_back(buf);
+                cache->bytes += bytes;
+                return;
+            }
+        }
+
+        free(buf - kHeaderBytes);
+    }
+
+    // static
+    void MessageBufferPool::releaseThreadCache() {
+        if (MessageBufferCache* cache = messageBufferCache.get()) {
+            cache->clear();
+        }
+    }
+
+}  // namespace mongo
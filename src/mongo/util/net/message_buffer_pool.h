@@ -0,0 +1,66 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/base/counter.h"
+
+namespace mongo {
+
+    /**
+     * Recycles the buffers that incoming messages are read into and that replies are built in.
+     *
+     * Buffers come in power of two size classes from 1KB to 1MB. Each thread keeps a few freed
+     * buffers of every class, bounded by messageBufferPoolThreadCacheBytes, and hands them out
+     * again before going to malloc. Connection threads serve one request at a time, so a
+     * connection mostly reuses the same few buffers. Larger buffers are not recycled.
+     */
+    class MessageBufferPool {
+    public:
+        /**
+         * Returns a buffer of at least 'size' bytes. It must be freed with release(), which
+         * Message does for buffers set with Message::setPooledData().
+         */
+        static char* allocate(size_t size);
+
+        static void release(char* buf);
+
+        /**
+         * Frees the buffers cached by the calling thread.
+         */
+        static void releaseThreadCache();
+
+        // Allocations served from, and missing, a thread's cache.
+        static Counter64 hits;
+        static Counter64 misses;
+    };
+
+}  // namespace mongo
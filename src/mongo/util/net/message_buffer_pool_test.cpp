@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_buffer_pool.h"
+
+#include <cstring>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+namespace {
+
+    TEST(MessageBufferPoolTest, ReusesBuffersOfTheSameSizeClass) {
+        MessageBufferPool::releaseThreadCache();
+
+        char* first = MessageBufferPool::allocate(3000);
+        memset(first, 'x', 3000);
+        MessageBufferPool::release(first);
+
+        // 3000 and 4000 bytes both round up to the 4KB class.
+        const long long hits = MessageBufferPool::hits.get();
+        char* second = MessageBufferPool::allocate(4000);
+        ASSERT_EQUALS(first, second);
+        ASSERT_EQUALS(hits + 1, MessageBufferPool::hits.get());
+
+        // The 4KB buffer is in use, so a 1KB request can't be served from the cache.
+        const long long misses = MessageBufferPool::misses.get();
+        char* third = MessageBufferPool::allocate(1000);
+        ASSERT_NOT_EQUALS(second, third);
+        ASSERT_EQUALS(misses + 1, MessageBufferPool::misses.get());
+
+        MessageBufferPool::release(second);
+        MessageBufferPool::release(third);
+        MessageBufferPool::releaseThreadCache();
+    }
+
+    TEST(MessageBufferPoolTest, LargeBuffersAreNotCached) {
+        MessageBufferPool::releaseThreadCache();
+
+        const size_t size = 4 * 1024 * 1024;
+        char* buf = MessageBufferPool::allocate(size);
+        memset(buf, 'x', size);
+        MessageBufferPool::release(buf);
+
+        const long long hits = MessageBufferPool::hits.get();
+        const long long misses = MessageBufferPool::misses.get();
+        MessageBufferPool::release(MessageBufferPool::allocate(size));
+        ASSERT_EQUALS(hits, MessageBufferPool::hits.get());
+        ASSERT_EQUALS(misses, MessageBufferPool::misses.get());
+    }
+
+    TEST(MessageBufferPoolTest, MessageReturnsPooledBuffer) {
+        MessageBufferPool::releaseThreadCache();
+
+        const int len = 200;
+        MsgData::View md = MessageBufferPool::allocate(len);
+        md.setLen(len);
+        md.setOperation(opReply);
+
+        {
+            Message m;
+            m.setPooledData(md.view2ptr());
+
+            // Moving the message hands the pooled buffer along.
+            Message moved;
+            moved = m;
+            ASSERT_TRUE(m.empty());
+            ASSERT_EQUALS(md.view2ptr(), moved.singleData().view2ptr());
+        }
+
+        ASSERT_EQUALS(md.view2ptr(), MessageBufferPool::allocate(len));
+        MessageBufferPool::release(md.view2ptr());
+        MessageBufferPool::releaseThreadCache();
+    }
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,254 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include <algorithm>
+
+#include "mongo/base/data_view.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+namespace {
+
+    // The header of a dbCompressed message followed by the original opCode, the uncompressed
+    // size and the compressor id.
+    const int kCompressedHeaderSize = sizeof(MSGHEADER::Value) + 2 * sizeof(int32_t) + 1;
+
+    // Small messages, like most commands and their replies, gain too little to pay for the
+    // extra copy.
+    const int kMinCompressedDataBytes = 512;
+
+    // Comma separated, in order of preference.  Empty, the default, turns compression off.
+    std::vector<std::string> networkMessageCompressors;
+
+    class ExportedMessageCompressorsParameter
+        : public ExportedServerParameter<std::vector<std::string> > {
+    public:
+        ExportedMessageCompressorsParameter() :
+            ExportedServerParameter<std::vector<std::string> >(ServerParameterSet::getGlobal(),
+                                                               "networkMessageCompressors",
+                                                               &networkMessageCompressors,
+                                                               true,    // Change at startup
+                                                               false) {} // Change at runtime
+
+        virtual Status validate(const std::vector<std::string>& newValue) {
+            for (size_t i = 0; i < newValue.size(); i++) {
+                MessageCompressor compressor;
+                if (!newValue[i].empty() && !parseMessageCompressor(newValue[i], &compressor)) {
+                    return Status(ErrorCodes::BadValue,
+                                  str::stream() << "unknown message compressor: "
+                                                << newValue[i]);
+                }
+            }
+            return Status::OK();
+        }
+    } exportedMessageCompressorsParam;
+
+} // namespace
+
+    const char* messageCompressorName(MessageCompressor compressor) {
+        switch (compressor) {
+        case MessageCompressor_none: return "none";
+        case MessageCompressor_snappy: return "snappy";
+        }
+        return "unknown";
+    }
+
+    bool parseMessageCompressor(StringData name, MessageCompressor* compressor) {
+        if (name == "snappy") {
+            *compressor = MessageCompressor_snappy;
+            return true;
+        }
+        return false;
+    }
+
+    vector<string> enabledMessageCompressors() {
+        vector<string> enabled;
+        for (size_t i = 0; i < networkMessageCompressors.size(); i++) {
+            if (!networkMessageCompressors[i].empty()) {
+                enabled.push_back(networkMessageCompressors[i]);
+            }
+        }
+        return enabled;
+    }
+
+    bool compressMessage(MessageCompressor compressor, Message& toSend, Message* compressed) {
+        verify(compressed->empty());
+        if (compressor == MessageCompressor_none ||
+            toSend.operation() == dbCompressed ||
+            toSend.dataSize() < kMinCompressedDataBytes) {
+            return false;
+        }
+        invariant(compressor == MessageCompressor_snappy);
+
+        toSend.concat();
+        MsgData::View original = toSend.singleData();
+        const char* data = original.view2ptr() + sizeof(MSGHEADER::Value);
+        const size_t dataLen = toSend.dataSize();
+
+        char* buf = reinterpret_cast<char*>(
+            mongoMalloc(kCompressedHeaderSize + maxCompressedLength(dataLen)));
+        size_t compressedLen;
+        rawCompress(data, dataLen, buf + kCompressedHeaderSize, &compressedLen);
+
+        const int len = kCompressedHeaderSize + compressedLen;
+        if (len >= toSend.size()) {
+            // Not compressible, so don't make the other end do the work for nothing
+            free(buf);
+            return false;
+        }
+
+        MsgData::View md = buf;
+        md.setLen(len);
+        md.setId(original.getId());
+        md.setResponseTo(original.getResponseTo());
+        md.setOperation(dbCompressed);
+        DataView(md.data())
+            .writeLE<int32_t>(original.getOperation(), 0)
+            .writeLE<int32_t>(dataLen, sizeof(int32_t))
+            .writeLE<uint8_t>(compressor, 2 * sizeof(int32_t));
+
+        compressed->setData(buf, true);
+        return true;
+    }
+
+    Status decompressMessage(const Message& compressed, Message* out) {
+        verify(out->empty());
+        MsgData::ConstView md = compressed.singleData();
+        invariant(md.getOperation() == dbCompressed);
+        if (md.getLen() < kCompressedHeaderSize) {
+            return Status(ErrorCodes::ProtocolError, "compressed message is truncated");
+        }
+
+        ConstDataView fields(md.data());
+        const int32_t operation = fields.readLE<int32_t>(0);
+        const int32_t dataLen = fields.readLE<int32_t>(sizeof(int32_t));
+        const uint8_t compressorId = fields.readLE<uint8_t>(2 * sizeof(int32_t));
+        if (compressorId != MessageCompressor_snappy) {
+            return Status(ErrorCodes::ProtocolError,
+                          str::stream() << "unknown message compressor id "
+                                        << static_cast<int>(compressorId));
+        }
+        if (dataLen < 0 ||
+            static_cast<size_t>(dataLen) > MaxMessageSizeBytes - sizeof(MSGHEADER::Value)) {
+            return Status(ErrorCodes::ProtocolError,
+                          str::stream() << "invalid uncompressed message length " << dataLen);
+        }
+
+        const char* data = md.view2ptr() + kCompressedHeaderSize;
+        const size_t compressedLen = md.getLen() - kCompressedHeaderSize;
+        size_t uncompressedLen;
+        if (!uncompressedLength(data, compressedLen, &uncompressedLen) ||
+            uncompressedLen != static_cast<size_t>(dataLen)) {
+            return Status(ErrorCodes::ProtocolError, "compressed message is corrupt");
+        }
+
+        const int len = sizeof(MSGHEADER::Value) + dataLen;
+        char* buf = reinterpret_cast<char*>(mongoMalloc(len));
+        ScopeGuard guard = MakeGuard(free, buf);
+        if (!rawUncompress(data, compressedLen, buf + sizeof(MSGHEADER::Value))) {
+            return Status(ErrorCodes::ProtocolError, "compressed message is corrupt");
+        }
+
+        MsgData::View restored = buf;
+        restored.setLen(len);
+        restored.setId(md.getId());
+        restored.setResponseTo(md.getResponseTo());
+        restored.setOperation(operation);
+
+        guard.Dismiss();
+        out->setData(buf, true);
+        return Status::OK();
+    }
+
+    void appendMessageCompressionRequest(const vector<string>& compressors,
+                                         BSONObjBuilder* isMasterCmd) {
+        if (!compressors.empty()) {
+            isMasterCmd->append("compression", compressors);
+        }
+    }
+
+    MessageCompressor negotiatedMessageCompressor(const BSONObj& isMasterReply) {
+        BSONElement compression = isMasterReply["compression"];
+        if (compression.type() != Array) {
+            return MessageCompressor_none;
+        }
+
+        BSONObjIterator it(compression.Obj());
+        MessageCompressor compressor;
+        if (it.more()) {
+            BSONElement name = it.next();
+            if (name.type() == String &&
+                parseMessageCompressor(name.valueStringData(), &compressor)) {
+                return compressor;
+            }
+        }
+        return MessageCompressor_none;
+    }
+
+    void negotiateMessageCompression(const BSONObj& isMasterCmd,
+                                     AbstractMessagingPort* port,
+                                     BSONObjBuilder* result) {
+        BSONElement compression = isMasterCmd["compression"];
+        if (!port || compression.type() != Array) {
+            return;
+        }
+
+        const vector<string> enabled = enabledMessageCompressors();
+        BSONObjIterator it(compression.Obj());
+        while (it.more()) {
+            BSONElement name = it.next();
+            MessageCompressor compressor;
+            if (name.type() != String ||
+                std::find(enabled.begin(), enabled.end(), name.str()) == enabled.end() ||
+                !parseMessageCompressor(name.valueStringData(), &compressor)) {
+                continue;
+            }
+
+            port->setCompressor(compressor);
+            BSONArrayBuilder picked(result->subarrayStart("compression"));
+            picked.append(name.valueStringData());
+            picked.done();
+            return;
+        }
+    }
+
+} // namespace mongo
@@ -0,0 +1,111 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+    class AbstractMessagingPort;
+    class BSONObj;
+    class BSONObjBuilder;
+    class Message;
+
+    /**
+     * The compressors a connection can use for the messages it sends.  The values are the ids
+     * carried in dbCompressed messages, so they must never be renumbered.
+     */
+    enum MessageCompressor {
+        MessageCompressor_none = 0,
+        MessageCompressor_snappy = 1
+    };
+
+    /**
+     * A dbCompressed message wraps one message of another type.  It has the same header as the
+     * original, except for the opCode, followed by:
+     *
+     *     int32 originalOpCode
+     *     int32 uncompressedSize  // of everything after the original header
+     *     uint8 compressorId
+     *     char  compressedData[]
+     *
+     * Compression is negotiated by isMaster: a client lists the compressors it can use, in
+     * order of preference, as isMaster's "compression" array, and the server replies with the
+     * first of them it has enabled.  From then on both ends may compress what they send; either
+     * end accepts compressed and uncompressed messages alike.
+     */
+
+    const char* messageCompressorName(MessageCompressor compressor);
+
+    bool parseMessageCompressor(StringData name, MessageCompressor* compressor);
+
+    /**
+     * The compressors enabled by the networkMessageCompressors server parameter, in order of
+     * preference.  Outgoing connections ask for these, and servers accept only these.
+     */
+    std::vector<std::string> enabledMessageCompressors();
+
+    /**
+     * Compresses 'toSend', whose header must already carry its id and responseTo, into
+     * 'compressed'.  Returns false, leaving 'compressed' empty, if the message is too small to
+     * be worth compressing.
+     */
+    bool compressMessage(MessageCompressor compressor, Message& toSend, Message* compressed);
+
+    /**
+     * Restores the message wrapped by the dbCompressed message 'compressed' into the empty
+     * message 'out'.
+     */
+    Status decompressMessage(const Message& compressed, Message* out);
+
+    /**
+     * Client side: adds the compressors to offer, if any, to an isMaster command.
+     */
+    void appendMessageCompressionRequest(const std::vector<std::string>& compressors,
+                                         BSONObjBuilder* isMasterCmd);
+
+    /**
+     * Client side: the compressor the server picked in its isMaster reply, or
+     * MessageCompressor_none if it didn't pick any.
+     */
+    MessageCompressor negotiatedMessageCompressor(const BSONObj& isMasterReply);
+
+    /**
+     * Server side: picks a compressor for 'port' from those offered in 'isMasterCmd' and
+     * reports it in the isMaster reply.  Replies sent on 'port' after this may be compressed.
+     */
+    void negotiateMessageCompression(const BSONObj& isMasterCmd,
+                                     AbstractMessagingPort* port,
+                                     BSONObjBuilder* result);
+
+} // namespace mongo
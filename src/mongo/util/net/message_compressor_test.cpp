@@ -0,0 +1,185 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+
+namespace {
+
+    using namespace mongo;
+
+    class TestPort : public AbstractMessagingPort {
+    public:
+        virtual void reply(Message& received, Message& response, MSGID responseTo) {}
+        virtual void reply(Message& received, Message& response) {}
+        virtual HostAndPort remote() const { return HostAndPort(); }
+        virtual unsigned remotePort() const { return 0; }
+        virtual SockAddr remoteAddr() const { return SockAddr(); }
+        virtual SockAddr localAddr() const { return SockAddr(); }
+    };
+
+    void makeMessage(const std::string& data, Message* message) {
+        message->setData(dbQuery, data.c_str(), data.size());
+        message->header().setId(1234);
+        message->header().setResponseTo(5678);
+    }
+
+    ServerParameter* compressorsParameter() {
+        const ServerParameterSet::Map& parameters = ServerParameterSet::getGlobal()->getMap();
+        ServerParameterSet::Map::const_iterator it = parameters.find("networkMessageCompressors");
+        ASSERT(it != parameters.end());
+        return it->second;
+    }
+
+    void setEnabledCompressors(const std::string& compressors) {
+        ASSERT_OK(compressorsParameter()->setFromString(compressors));
+    }
+
+    TEST(MessageCompressor, RoundTrip) {
+        const std::string data(64 * 1024, 'x');
+        Message original;
+        makeMessage(data, &original);
+
+        Message compressed;
+        ASSERT_TRUE(compressMessage(MessageCompressor_snappy, original, &compressed));
+        ASSERT_EQUALS(dbCompressed, compressed.operation());
+        ASSERT_LESS_THAN(compressed.size(), original.size());
+        ASSERT_EQUALS(1234U, compressed.header().getId());
+        ASSERT_EQUALS(5678U, compressed.header().getResponseTo());
+
+        Message restored;
+        ASSERT_OK(decompressMessage(compressed, &restored));
+        ASSERT_EQUALS(original.size(), restored.size());
+        ASSERT_EQUALS(dbQuery, restored.operation());
+        ASSERT_EQUALS(1234U, restored.header().getId());
+        ASSERT_EQUALS(5678U, restored.header().getResponseTo());
+        ASSERT_EQUALS(data, std::string(restored.singleData().data(), data.size()));
+    }
+
+    TEST(MessageCompressor, CompressesMultipleBuffers) {
+        const std::string first(4 * 1024, 'a');
+        Message original;
+        makeMessage(first, &original);
+
+        const std::string second(4 * 1024, 'b');
+        char* piece = reinterpret_cast<char*>(mongoMalloc(second.size()));
+        memcpy(piece, second.data(), second.size());
+        original.appendData(piece, second.size());
+
+        Message compressed;
+        ASSERT_TRUE(compressMessage(MessageCompressor_snappy, original, &compressed));
+
+        Message restored;
+        ASSERT_OK(decompressMessage(compressed, &restored));
+        ASSERT_EQUALS(first + second,
+                      std::string(restored.singleData().data(), restored.dataSize()));
+    }
+
+    TEST(MessageCompressor, SkipsSmallAndIncompressibleMessages) {
+        Message small;
+        makeMessage(std::string(100, 'x'), &small);
+        Message compressed;
+        ASSERT_FALSE(compressMessage(MessageCompressor_snappy, small, &compressed));
+        ASSERT_TRUE(compressed.empty());
+
+        std::string random(4 * 1024, '\0');
+        unsigned state = 1;
+        for (size_t i = 0; i < random.size(); i++) {
+            state = state * 1103515245 + 12345;
+            random[i] = static_cast<char>(state >> 16);
+        }
+        Message incompressible;
+        makeMessage(random, &incompressible);
+        ASSERT_FALSE(compressMessage(MessageCompressor_snappy, incompressible, &compressed));
+        ASSERT_TRUE(compressed.empty());
+
+        ASSERT_FALSE(compressMessage(MessageCompressor_none, small, &compressed));
+    }
+
+    TEST(MessageCompressor, RejectsCorruptMessages) {
+        Message original;
+        makeMessage(std::string(64 * 1024, 'x'), &original);
+        Message compressed;
+        ASSERT_TRUE(compressMessage(MessageCompressor_snappy, original, &compressed));
+
+        // Claim a different uncompressed size
+        MsgData::View md = compressed.singleData();
+        DataView(md.data()).writeLE<int32_t>(original.dataSize() + 1, sizeof(int32_t));
+        Message restored;
+        ASSERT_EQUALS(ErrorCodes::ProtocolError,
+                      decompressMessage(compressed, &restored).code());
+        ASSERT_TRUE(restored.empty());
+
+        // An unknown compressor
+        DataView(md.data()).writeLE<int32_t>(original.dataSize(), sizeof(int32_t));
+        DataView(md.data()).writeLE<uint8_t>(200, 2 * sizeof(int32_t));
+        ASSERT_EQUALS(ErrorCodes::ProtocolError,
+                      decompressMessage(compressed, &restored).code());
+    }
+
+    TEST(MessageCompressor, NegotiatesFirstEnabledCompressorOffered) {
+        TestPort port;
+        const BSONObj isMaster = BSON("isMaster" << 1 << "compression" << BSON_ARRAY("zlib"
+                                                                               << "snappy"));
+        setEnabledCompressors("");
+        BSONObjBuilder disabled;
+        negotiateMessageCompression(isMaster, &port, &disabled);
+        ASSERT_EQUALS(MessageCompressor_none, port.compressor());
+        ASSERT_EQUALS(MessageCompressor_none, negotiatedMessageCompressor(disabled.obj()));
+
+        setEnabledCompressors("snappy");
+        BSONObjBuilder enabled;
+        negotiateMessageCompression(isMaster, &port, &enabled);
+        ASSERT_EQUALS(MessageCompressor_snappy, port.compressor());
+        const BSONObj reply = enabled.obj();
+        ASSERT_EQUALS(BSON("compression" << BSON_ARRAY("snappy")), reply);
+        ASSERT_EQUALS(MessageCompressor_snappy, negotiatedMessageCompressor(reply));
+
+        BSONObjBuilder request;
+        appendMessageCompressionRequest(enabledMessageCompressors(), &request);
+        ASSERT_EQUALS(BSON("compression" << BSON_ARRAY("snappy")), request.obj());
+
+        setEnabledCompressors("");
+    }
+
+    TEST(MessageCompressor, RejectsUnknownCompressorNames) {
+        ASSERT_NOT_OK(compressorsParameter()->setFromString("snappy,bogus"));
+        ASSERT_TRUE(enabledMessageCompressors().empty());
+    }
+
+} // namespace
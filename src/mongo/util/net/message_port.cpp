@@ -42,8 +42,10 @@
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_buffer_pool.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_options.h"
+#include "mongo/util/net/wire_trace.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
 
@@ -232,8 +234,8 @@ again:
             psock->setHandshakeReceived();
             int z = (len+1023)&0xfffffc00;
             verify(z>=len);
-            MsgData::View md = reinterpret_cast<char *>(mongoMalloc(z));
-            ScopeGuard guard = MakeGuard(free, md.view2ptr());
+            MsgData::View md = MessageBufferPool::allocate(z);
+            ScopeGuard guard = MakeGuard(&MessageBufferPool::release, md.view2ptr());
             verify(md.view2ptr());
 
             memcpy(md.view2ptr(), &header, headerLen);
@@ -242,7 +244,22 @@ again:
             psock->recv( md.data(), left );
 
             guard.Dismiss();
-            m.setData(md.view2ptr(), true);
+            if ( md.getOperation() != dbCompressed ) {
+                m.setPooledData(md.view2ptr());
+            }
+            else {
+                Message compressed;
+                compressed.setPooledData(md.view2ptr());
+                Status status = decompressMessage(compressed, &m);
+                if ( !status.isOK() ) {
+                    LOG(0) << "recv(): " << status.reason();
+                    return false;
+                }
+            }
+
+            if ( traced() ) {
+                wireTraceRecord(WireTraceRecord::kRequest, connectionId(), m);
+            }
             return true;
 
         }
@@ -302,10 +319,18 @@ again:
         toSend.header().setId(nextMessageId());
         toSend.header().setResponseTo(responseTo);
 
+        if ( traced() ) {
+            wireTraceRecord(WireTraceRecord::kReply, connectionId(), toSend);
+        }
+
+        Message compressed;
+        const bool compress = compressMessage(compressor(), toSend, &compressed);
+
         if ( piggyBackData && piggyBackData->len() ) {
             mmm( log() << "*     have piggy back" << endl; )
-            if ( ( piggyBackData->len() + toSend.header().getLen() ) > 1300 ) {
-                // won't fit in a packet - so just send it off
+            if ( compress || !toSend.isSingleBuffer() ||
+                 ( piggyBackData->len() + toSend.header().getLen() ) > 1300 ) {
+                // won't fit in a packet, or can't be copied in one go - so just send it off
                 piggyBackData->flush();
             }
             else {
@@ -315,6 +340,10 @@ again:
             }
         }
 
+        if ( compress ) {
+            compressed.send( *this, "say" );
+            return;
+        }
         toSend.send( *this, "say" );
     }
 
@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/sock.h"
 
 namespace mongo {
@@ -43,7 +44,8 @@ namespace mongo {
 
     class AbstractMessagingPort : boost::noncopyable {
     public:
-        AbstractMessagingPort() : tag(0), _connectionId(0) {}
+        AbstractMessagingPort()
+            : tag(0), _connectionId(0), _compressor(MessageCompressor_none), _traced(false) {}
         virtual ~AbstractMessagingPort() { }
         virtual void reply(Message& received, Message& response, MSGID responseTo) = 0; // like the reply below, but doesn't rely on received.data still being available
         virtual void reply(Message& received, Message& response) = 0;
@@ -64,6 +66,20 @@ namespace mongo {
         long long connectionId() const { return _connectionId; }
         void setConnectionId( long long connectionId );
 
+        /**
+         * The compressor for the messages sent on this port, as negotiated by isMaster.
+         * Received messages are decompressed whatever this is set to.
+         */
+        MessageCompressor compressor() const { return _compressor; }
+        void setCompressor(MessageCompressor compressor) { _compressor = compressor; }
+
+        /**
+         * Whether the messages received and sent on this port are recorded in the wire trace.
+         * Only set on ports a server accepted, so what is received is a request.
+         */
+        bool traced() const { return _traced; }
+        void setTraced(bool traced) { _traced = traced; }
+
     public:
         // TODO make this private with some helpers
 
@@ -73,6 +89,8 @@ namespace mongo {
     private:
         long long _connectionId;
         std::string _x509SubjectName;
+        MessageCompressor _compressor;
+        bool _traced;
     };
 
     class MessagingPort : public AbstractMessagingPort {
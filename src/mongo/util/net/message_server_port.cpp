@@ -38,6 +38,7 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -51,6 +52,7 @@
 #include "mongo/util/net/message_port.h"
 #include "mongo/util/net/message_server.h"
 #include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/net/wire_trace.h"
 #include "mongo/util/scopeguard.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
@@ -68,6 +70,29 @@ namespace mongo {
 
 namespace {
 
+    // Stack size, in KB, of the thread started for each accepted connection.  Most of the
+    // memory an idle connection costs is this stack, so deployments with many mostly idle
+    // clients can shrink it.  Only honoured where we create the thread with pthreads.
+    int connectionThreadStackSizeKB = 1024;
+
+    class ExportedConnectionThreadStackSizeParameter : public ExportedServerParameter<int> {
+    public:
+        ExportedConnectionThreadStackSizeParameter() :
+            ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                         "connectionThreadStackSizeKB",
+                                         &connectionThreadStackSizeKB,
+                                         true,    // Change at startup
+                                         false) {} // Change at runtime
+
+        virtual Status validate(const int& newValue) {
+            if (newValue < 256 || newValue > 16 * 1024) {
+                return Status(ErrorCodes::BadValue,
+                              "connectionThreadStackSizeKB must be between 256 and 16384");
+            }
+            return Status::OK();
+        }
+    } exportedConnectionThreadStackSizeParam;
+
     class MessagingPortWithHandler : public MessagingPort {
         MONGO_DISALLOW_COPYING(MessagingPortWithHandler);
 
@@ -77,6 +102,7 @@ namespace {
                                  long long connectionId)
             : MessagingPort(socket), _handler(handler) {
             setConnectionId(connectionId);
+            setTraced(wireTraceSampleConnection(connectionId));
         }
 
         MessageHandler* getHandler() const { return _handler; }
@@ -121,19 +147,20 @@ namespace {
                 pthread_attr_init(&attrs);
                 pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
 
-                static const size_t STACK_SIZE = 1024*1024; // if we change this we need to update the warning
+                const size_t stackSize = static_cast<size_t>(connectionThreadStackSizeKB) * 1024;
 
                 struct rlimit limits;
                 verify(getrlimit(RLIMIT_STACK, &limits) == 0);
-                if (limits.rlim_cur > STACK_SIZE) {
-                    size_t stackSizeToSet = STACK_SIZE;
+                if (limits.rlim_cur > stackSize) {
+                    size_t stackSizeToSet = stackSize;
 #if !__has_feature(address_sanitizer)
                     if (DEBUG_BUILD)
                         stackSizeToSet /= 2;
 #endif
                     pthread_attr_setstacksize(&attrs, stackSizeToSet);
-                } else if (limits.rlim_cur < 1024*1024) {
-                    warning() << "Stack size set to " << (limits.rlim_cur/1024) << "KB. We suggest 1MB" << endl;
+                } else if (limits.rlim_cur < stackSize) {
+                    warning() << "Stack size set to " << (limits.rlim_cur/1024) << "KB. We suggest "
+                              << connectionThreadStackSizeKB << "KB" << endl;
                 }
 
 
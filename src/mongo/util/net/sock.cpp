@@ -33,6 +33,8 @@
 
 #include "mongo/util/net/sock.h"
 
+#include <algorithm>
+
 #if !defined(_WIN32)
 # include <sys/socket.h>
 # include <sys/types.h>
@@ -41,6 +43,7 @@
 # include <netinet/tcp.h>
 # include <arpa/inet.h>
 # include <errno.h>
+# include <limits.h>
 # include <netdb.h>
 # if defined(__openbsd__)
 #  include <sys/uio.h>
@@ -672,12 +675,18 @@ namespace mongo {
                 _bytesOut += j->second;
             }
         }
+        // Messages with many shared pieces can have more buffers than a single sendmsg() call
+        // accepts, so they go out in runs of at most IOV_MAX.
+        struct iovec* next = d.empty() ? NULL : &d[ 0 ];
+        size_t remaining = i;
+
         struct msghdr meta;
         memset( &meta, 0, sizeof( meta ) );
-        meta.msg_iov = &d[ 0 ];
-        meta.msg_iovlen = d.size();
 
-        while( meta.msg_iovlen > 0 ) {
+        while( remaining > 0 ) {
+            meta.msg_iov = next;
+            meta.msg_iovlen = std::min( remaining, static_cast<size_t>( IOV_MAX ) );
+
             int ret = -1;
             if (MONGO_FAIL_POINT(throwSockExcep)) {
 #if defined(_WIN32)
@@ -703,17 +712,16 @@ namespace mongo {
                 }
             }
             else {
-                struct iovec *& i = meta.msg_iov;
                 while( ret > 0 ) {
-                    if ( i->iov_len > unsigned( ret ) ) {
-                        i->iov_len -= ret;
-                        i->iov_base = (char*)(i->iov_base) + ret;
+                    if ( next->iov_len > unsigned( ret ) ) {
+                        next->iov_len -= ret;
+                        next->iov_base = (char*)(next->iov_base) + ret;
                         ret = 0;
                     }
                     else {
-                        ret -= i->iov_len;
-                        ++i;
-                        --(meta.msg_iovlen);
+                        ret -= next->iov_len;
+                        ++next;
+                        --remaining;
                     }
                 }
             }
@@ -40,6 +40,7 @@
 #endif
 
 #include "mongo/db/server_options.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/synchronization.h"
 #include "mongo/util/fail_point_service.h"
@@ -330,6 +331,50 @@ namespace {
         ASSERT_EQUALS(size_t(1), countRecvable(2));
     }
 
+    void sendPieces(Socket* socket, const std::vector<std::pair<char*, int> >* pieces) {
+        socket->send(*pieces, "sendPieces");
+    }
+
+    // More pieces than a single sendmsg() call accepts must still all arrive, in order.
+    TEST(Socket, SendVectorWithManyPieces) {
+        const SocketPair sockets = socketPair(SOCK_STREAM);
+        ASSERT_TRUE(sockets.first);
+        ASSERT_TRUE(sockets.second);
+
+        const int numPieces = 5000;
+        std::vector<char> bytes(numPieces * 4);
+        std::vector<std::pair<char*, int> > pieces;
+        for (int i = 0; i < numPieces; i++) {
+            // Vary the piece sizes, including empty ones, which are skipped
+            const int size = i % 4;
+            char* start = &bytes[i * 4];
+            for (int j = 0; j < size; j++) {
+                start[j] = static_cast<char>(i + j);
+            }
+            pieces.push_back(std::make_pair(start, size));
+        }
+
+        size_t total = 0;
+        for (size_t i = 0; i < pieces.size(); i++) {
+            total += pieces[i].second;
+        }
+
+        // The receiver drains the socket while the pieces are still being sent
+        boost::thread sender(stdx::bind(&sendPieces, sockets.first.get(), &pieces));
+
+        std::vector<char> received(total);
+        sockets.second->recv(&received[0], total);
+        sender.join();
+
+        size_t offset = 0;
+        for (size_t i = 0; i < pieces.size(); i++) {
+            for (int j = 0; j < pieces[i].second; j++) {
+                ASSERT_EQUALS(pieces[i].first[j], received[offset++]);
+            }
+        }
+        ASSERT_EQUALS(total, offset);
+    }
+
     TEST_F(SocketFailPointTest, TestFailedRecvsDontRecv) {
         ASSERT_TRUE(trySend());
         ASSERT_TRUE(tryRecv());
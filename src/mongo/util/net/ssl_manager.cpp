@@ -35,6 +35,7 @@
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/tss.hpp>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -163,7 +164,9 @@ namespace mongo {
                    bool weakCertificateValidation = false,
                    bool allowInvalidCertificates = false,
                    bool allowInvalidHostnames = false,
-                   bool fipsMode = false) :
+                   bool fipsMode = false,
+                   int sessionCacheSize = 0,
+                   int sessionTimeoutSecs = 300) :
                 pemfile(pemfile),
                 pempwd(pempwd),
                 clusterfile(clusterfile),
@@ -173,7 +176,9 @@ namespace mongo {
                 weakCertificateValidation(weakCertificateValidation),
                 allowInvalidCertificates(allowInvalidCertificates),
                 allowInvalidHostnames(allowInvalidHostnames),
-                fipsMode(fipsMode) {};
+                fipsMode(fipsMode),
+                sessionCacheSize(sessionCacheSize),
+                sessionTimeoutSecs(sessionTimeoutSecs) {};
 
             std::string pemfile;
             std::string pempwd;
@@ -185,6 +190,8 @@ namespace mongo {
             bool allowInvalidCertificates;
             bool allowInvalidHostnames;
             bool fipsMode;
+            int sessionCacheSize;
+            int sessionTimeoutSecs;
         };
 
         class SSLManager : public SSLManagerInterface {
@@ -206,6 +213,8 @@ namespace mongo {
                 return _sslConfiguration;
             }
 
+            virtual BSONObj getHandshakeStatsBSON() const;
+
             virtual std::string getSSLErrorMessage(int code);
 
             virtual int SSL_read(SSLConnection* conn, void* buf, int num);
@@ -229,8 +238,39 @@ namespace mongo {
             bool _weakValidation;
             bool _allowInvalidCertificates;
             bool _allowInvalidHostnames;
+            int _sessionCacheSize;
+            int _sessionTimeoutSecs;
             SSLConfiguration _sslConfiguration;
 
+            // Sessions from the last outgoing connection to each remote address, offered for
+            // resumption on the next connection to it.  Owned by this map; guarded by
+            // _clientSessionsMutex.
+            typedef std::map<std::string, SSL_SESSION*> ClientSessionMap;
+            SimpleMutex _clientSessionsMutex;
+            ClientSessionMap _clientSessions;
+
+            // Handshake counters, indexed by HandshakeKind.
+            enum HandshakeKind {
+                kServerHandshake = 0,
+                kClientHandshake,
+                kNumHandshakeKinds
+            };
+            AtomicInt64 _fullHandshakes[kNumHandshakeKinds];
+            AtomicInt64 _resumedHandshakes[kNumHandshakeKinds];
+            AtomicInt64 _handshakeMicros[kNumHandshakeKinds];
+
+            void _recordHandshake(HandshakeKind kind, SSL* ssl, unsigned long long startMicros);
+
+            /**
+             * Sets the session for 'ssl' to the one cached for 'remote', if any.
+             */
+            void _offerClientSession(SSL* ssl, const std::string& remote);
+
+            /**
+             * Remembers the session negotiated by 'ssl' for later connections to 'remote'.
+             */
+            void _saveClientSession(SSL* ssl, const std::string& remote);
+
             /**
              * creates an SSL object to be used for this file descriptor.
              * caller must SSL_free it.
@@ -331,7 +371,9 @@ namespace mongo {
                 sslGlobalParams.sslWeakCertificateValidation,
                 sslGlobalParams.sslAllowInvalidCertificates,
                 sslGlobalParams.sslAllowInvalidHostnames,
-                sslGlobalParams.sslFIPSMode);
+                sslGlobalParams.sslFIPSMode,
+                sslGlobalParams.sslSessionCacheSize,
+                sslGlobalParams.sslSessionTimeoutSecs);
             theSSLManager = new SSLManager(params, isSSLServer);
         }
         return Status::OK();
@@ -420,7 +462,10 @@ namespace mongo {
         _clientContext(NULL),
         _weakValidation(params.weakCertificateValidation),
         _allowInvalidCertificates(params.allowInvalidCertificates),
-        _allowInvalidHostnames(params.allowInvalidHostnames) {
+        _allowInvalidHostnames(params.allowInvalidHostnames),
+        _sessionCacheSize(params.sessionCacheSize),
+        _sessionTimeoutSecs(params.sessionTimeoutSecs),
+        _clientSessionsMutex("SSLClientSessions") {
 
         SSL_library_init();
         SSL_load_error_strings();
@@ -491,6 +536,10 @@ namespace mongo {
         if (NULL != _clientContext) {
             SSL_CTX_free(_clientContext);
         }
+        for (ClientSessionMap::iterator it = _clientSessions.begin();
+             it != _clientSessions.end(); ++it) {
+            SSL_SESSION_free(it->second);
+        }
     }
 
     int SSLManager::password_cb(char *buf,int num, int rwflag,void *userdata) {
@@ -595,8 +644,25 @@ namespace mongo {
         // Note: this is for blocking sockets only.
         SSL_CTX_set_mode(*context, SSL_MODE_AUTO_RETRY);
 
-        // Disable session caching (see SERVER-10261)
-        SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_OFF);
+        if (context == &_serverContext && _sessionCacheSize > 0) {
+            // Let clients resume sessions, either from the server side cache or from a session
+            // ticket.  Resumption fails when peer certificates are verified unless the context
+            // has a session id context (see SERVER-10261).
+            static const unsigned char sessionIdContext[] = "mongodb";
+            SSL_CTX_set_session_id_context(*context,
+                                           sessionIdContext,
+                                           sizeof(sessionIdContext) - 1);
+            SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_sess_set_cache_size(*context, _sessionCacheSize);
+            SSL_CTX_set_timeout(*context, _sessionTimeoutSecs);
+        }
+        else {
+            // Outgoing sessions are cached per remote address by the SSLManager itself
+            SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_OFF);
+            if (context == &_serverContext) {
+                SSL_CTX_set_options(*context, SSL_OP_NO_TICKET);
+            }
+        }
  
         // Use the clusterfile for internal outgoing SSL connections if specified 
         if (context == &_clientContext && !params.clusterfile.empty()) {
@@ -864,7 +930,11 @@ namespace mongo {
         SSLConnection* sslConn = new SSLConnection(_clientContext, socket, NULL, 0);
         ScopeGuard sslGuard = MakeGuard(::SSL_free, sslConn->ssl);
         ScopeGuard bioGuard = MakeGuard(::BIO_free, sslConn->networkBIO);
- 
+
+        const std::string remote = socket->remoteString();
+        _offerClientSession(sslConn->ssl, remote);
+
+        const unsigned long long startMicros = curTimeMicros64();
         int ret;
         do {
             ret = ::SSL_connect(sslConn->ssl);
@@ -872,7 +942,10 @@ namespace mongo {
  
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn, ret), ret);
- 
+
+        _recordHandshake(kClientHandshake, sslConn->ssl, startMicros);
+        _saveClientSession(sslConn->ssl, remote);
+
         sslGuard.Dismiss();
         bioGuard.Dismiss();
         return sslConn;
@@ -882,7 +955,8 @@ namespace mongo {
         SSLConnection* sslConn = new SSLConnection(_serverContext, socket, initialBytes, len);
         ScopeGuard sslGuard = MakeGuard(::SSL_free, sslConn->ssl);
         ScopeGuard bioGuard = MakeGuard(::BIO_free, sslConn->networkBIO);
- 
+
+        const unsigned long long startMicros = curTimeMicros64();
         int ret;
         do {
             ret = ::SSL_accept(sslConn->ssl);
@@ -890,12 +964,76 @@ namespace mongo {
  
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn, ret), ret);
- 
+
+        _recordHandshake(kServerHandshake, sslConn->ssl, startMicros);
+
         sslGuard.Dismiss();
         bioGuard.Dismiss();
         return sslConn;
     }
 
+    void SSLManager::_recordHandshake(HandshakeKind kind,
+                                      SSL* ssl,
+                                      unsigned long long startMicros) {
+        if (SSL_session_reused(ssl)) {
+            _resumedHandshakes[kind].fetchAndAdd(1);
+        }
+        else {
+            _fullHandshakes[kind].fetchAndAdd(1);
+        }
+        _handshakeMicros[kind].fetchAndAdd(
+            static_cast<long long>(curTimeMicros64() - startMicros));
+    }
+
+    void SSLManager::_offerClientSession(SSL* ssl, const std::string& remote) {
+        if (_sessionCacheSize <= 0) {
+            return;
+        }
+        SimpleMutex::scoped_lock lk(_clientSessionsMutex);
+        ClientSessionMap::const_iterator it = _clientSessions.find(remote);
+        if (it != _clientSessions.end()) {
+            // SSL_set_session takes its own reference to the session.
+            SSL_set_session(ssl, it->second);
+        }
+    }
+
+    void SSLManager::_saveClientSession(SSL* ssl, const std::string& remote) {
+        if (_sessionCacheSize <= 0) {
+            return;
+        }
+        SSL_SESSION* session = SSL_get1_session(ssl);
+        if (!session) {
+            return;
+        }
+
+        SimpleMutex::scoped_lock lk(_clientSessionsMutex);
+        ClientSessionMap::iterator it = _clientSessions.find(remote);
+        if (it != _clientSessions.end()) {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+            return;
+        }
+        if (_clientSessions.size() >= static_cast<size_t>(_sessionCacheSize)) {
+            // Evict an arbitrary remote rather than track recency for every connect.
+            SSL_SESSION_free(_clientSessions.begin()->second);
+            _clientSessions.erase(_clientSessions.begin());
+        }
+        _clientSessions.insert(std::make_pair(remote, session));
+    }
+
+    BSONObj SSLManager::getHandshakeStatsBSON() const {
+        static const char* const kindNames[] = { "server", "client" };
+        BSONObjBuilder stats;
+        for (int i = 0; i < kNumHandshakeKinds; i++) {
+            BSONObjBuilder kindBuilder(stats.subobjStart(kindNames[i]));
+            kindBuilder.appendNumber("full", _fullHandshakes[i].load());
+            kindBuilder.appendNumber("resumed", _resumedHandshakes[i].load());
+            kindBuilder.appendNumber("totalMicros", _handshakeMicros[i].load());
+            kindBuilder.doneFast();
+        }
+        return stats.obj();
+    }
+
     // TODO SERVER-11601 Use NFC Unicode canonicalization
     bool SSLManager::_hostNameMatch(const char* nameToMatch, 
                                     const char* certHostName) {
@@ -121,6 +121,12 @@ namespace mongo {
          */
          virtual const SSLConfiguration& getSSLConfiguration() const = 0;
 
+        /**
+         * Gets the number of full and resumed TLS handshakes, and the time spent in them, for
+         * accepted and initiated connections.
+         */
+        virtual BSONObj getHandshakeStatsBSON() const = 0;
+
         /**
         * Fetches the error text for an error code, in a thread-safe manner.
         */
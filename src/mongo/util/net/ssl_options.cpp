@@ -89,6 +89,12 @@ namespace mongo {
         options->addOptionChaining("net.ssl.FIPSMode", "sslFIPSMode", moe::Switch,
                 "activate FIPS 140-2 mode at startup");
 
+        options->addOptionChaining("net.ssl.sessionCacheSize", "sslSessionCacheSize", moe::Int,
+                "number of SSL sessions kept for resumption, 0 disables session resumption");
+
+        options->addOptionChaining("net.ssl.sessionTimeoutSecs", "sslSessionTimeoutSecs",
+                moe::Int, "seconds an SSL session or session ticket can be resumed for");
+
         return Status::OK();
     }
 
@@ -248,6 +254,18 @@ namespace mongo {
         if (params.count("net.ssl.FIPSMode")) {
             sslGlobalParams.sslFIPSMode = params["net.ssl.FIPSMode"].as<bool>();
         }
+        if (params.count("net.ssl.sessionCacheSize")) {
+            sslGlobalParams.sslSessionCacheSize = params["net.ssl.sessionCacheSize"].as<int>();
+            if (sslGlobalParams.sslSessionCacheSize < 0) {
+                return Status(ErrorCodes::BadValue, "sslSessionCacheSize must not be negative");
+            }
+        }
+        if (params.count("net.ssl.sessionTimeoutSecs")) {
+            sslGlobalParams.sslSessionTimeoutSecs = params["net.ssl.sessionTimeoutSecs"].as<int>();
+            if (sslGlobalParams.sslSessionTimeoutSecs <= 0) {
+                return Status(ErrorCodes::BadValue, "sslSessionTimeoutSecs must be positive");
+            }
+        }
 
         int clusterAuthMode = serverGlobalParams.clusterAuthMode.load();
         if (sslGlobalParams.sslMode.load() != SSLGlobalParams::SSLMode_disabled) {
@@ -53,8 +53,12 @@ namespace mongo {
         bool sslFIPSMode; // --sslFIPSMode
         bool sslAllowInvalidCertificates; // --sslAllowInvalidCertificates
         bool sslAllowInvalidHostnames; // --sslAllowInvalidHostnames
+        int sslSessionCacheSize; // --sslSessionCacheSize
+        int sslSessionTimeoutSecs; // --sslSessionTimeoutSecs
 
-        SSLGlobalParams() {
+        SSLGlobalParams() :
+            sslSessionCacheSize(20480),
+            sslSessionTimeoutSecs(300) {
             sslMode.store(SSLMode_disabled);
         }
  
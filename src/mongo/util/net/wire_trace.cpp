@@ -0,0 +1,242 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/wire_trace.h"
+
+#include <boost/scoped_array.hpp>
+#include <cerrno>
+
+#include "mongo/base/data_view.h"
+#include "mongo/base/init.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wireTraceFile, std::string, "");
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wireTraceMaxFileSizeMB, int, 1024);
+
+    double wireTraceSampleRate = 1.0;
+
+    class ExportedWireTraceSampleRateParameter : public ExportedServerParameter<double> {
+    public:
+        ExportedWireTraceSampleRateParameter() :
+            ExportedServerParameter<double>(ServerParameterSet::getGlobal(),
+                                            "wireTraceSampleRate",
+                                            &wireTraceSampleRate,
+                                            true,    // Change at startup
+                                            true) {} // Change at runtime
+
+        virtual Status validate(const double& newValue) {
+            if (!(newValue >= 0.0 && newValue <= 1.0)) {
+                return Status(ErrorCodes::BadValue,
+                              "wireTraceSampleRate must be between 0 and 1");
+            }
+            return Status::OK();
+        }
+    } exportedWireTraceSampleRateParam;
+
+    // The offsets of OP_REPLY's cursorId, startingFrom and nReturned fields end here.
+    const int kReplyPrefixSize = sizeof(MSGHEADER::Value) + 20;
+
+    const unsigned long long kFlushIntervalMicros = 1000 * 1000;
+
+    const size_t kWriteBufferSize = 1024 * 1024;
+
+    WireTraceWriter* serverTraceWriter = NULL;
+
+} // namespace
+
+    MONGO_INITIALIZER_WITH_PREREQUISITES(WireTrace, ("EndStartupOptionStorage"))
+        (InitializerContext* context) {
+        if (wireTraceFile.empty()) {
+            return Status::OK();
+        }
+
+        std::auto_ptr<WireTraceWriter> writer(new WireTraceWriter());
+        if (!writer->open(wireTraceFile, wireTraceMaxFileSizeMB * 1024LL * 1024)) {
+            return Status(ErrorCodes::FileNotOpen,
+                          str::stream() << "couldn't open wireTraceFile " << wireTraceFile);
+        }
+        serverTraceWriter = writer.release();
+        return Status::OK();
+    }
+
+    WireTraceWriter::WireTraceWriter()
+        : _file(NULL), _maxBytes(0), _bytesWritten(0), _lastFlushMicros(0) {
+    }
+
+    WireTraceWriter::~WireTraceWriter() {
+        if (_file) {
+            fclose(_file);
+        }
+    }
+
+    bool WireTraceWriter::open(const std::string& path, long long maxBytes) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        invariant(!_file);
+
+        _file = fopen(path.c_str(), "ab");
+        if (!_file) {
+            error() << "couldn't open wire trace file " << path << ": " << errnoWithDescription();
+            return false;
+        }
+        setvbuf(_file, NULL, _IOFBF, kWriteBufferSize);
+
+        fseek(_file, 0, SEEK_END);
+        _bytesWritten = ftell(_file);
+        _maxBytes = maxBytes;
+        _lastFlushMicros = curTimeMicros64();
+        log() << "tracing wire messages to " << path;
+        return true;
+    }
+
+    void WireTraceWriter::append(WireTraceRecord::Kind kind,
+                                 long long connectionId,
+                                 long long micros,
+                                 const Message& m) {
+        // A message split over several buffers only has its header in the first one.
+        int messageSize = sizeof(MSGHEADER::Value);
+        if (m.isSingleBuffer()) {
+            if (kind == WireTraceRecord::kRequest) {
+                messageSize = m.size();
+            }
+            else if (m.operation() == opReply && m.size() >= kReplyPrefixSize) {
+                messageSize = kReplyPrefixSize;
+            }
+        }
+
+        char header[WireTraceRecord::kHeaderSize];
+        DataView(header)
+            .writeLE<int32_t>(WireTraceRecord::kHeaderSize + messageSize, 0)
+            .writeLE<int32_t>(kind, 4)
+            .writeLE<int64_t>(connectionId, 8)
+            .writeLE<int64_t>(micros, 16);
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (!_file) {
+            return;
+        }
+        if (_bytesWritten + WireTraceRecord::kHeaderSize + messageSize > _maxBytes) {
+            log() << "wire trace file is full, no longer tracing";
+            fclose(_file);
+            _file = NULL;
+            return;
+        }
+
+        if (fwrite(header, sizeof(header), 1, _file) != 1 ||
+            fwrite(m.header().view2ptr(), messageSize, 1, _file) != 1) {
+            error() << "couldn't write to wire trace file, no longer tracing: "
+                    << errnoWithDescription();
+            fclose(_file);
+            _file = NULL;
+            return;
+        }
+        _bytesWritten += WireTraceRecord::kHeaderSize + messageSize;
+
+        const unsigned long long now = curTimeMicros64();
+        if (now - _lastFlushMicros > kFlushIntervalMicros) {
+            fflush(_file);
+            _lastFlushMicros = now;
+        }
+    }
+
+    void WireTraceWriter::flush() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (_file) {
+            fflush(_file);
+            _lastFlushMicros = curTimeMicros64();
+        }
+    }
+
+    WireTraceReader::WireTraceReader(const std::string& path)
+        : _file(fopen(path.c_str(), "rb")) {
+        uassert(28624,
+                str::stream() << "couldn't open wire trace file " << path << ": "
+                              << errnoWithDescription(),
+                _file);
+    }
+
+    WireTraceReader::~WireTraceReader() {
+        fclose(_file);
+    }
+
+    bool WireTraceReader::next(WireTraceRecord* record) {
+        char header[WireTraceRecord::kHeaderSize];
+        if (fread(header, sizeof(header), 1, _file) != 1) {
+            return false;
+        }
+
+        ConstDataView view(header);
+        const int32_t recordLength = view.readLE<int32_t>(0);
+        const int32_t kind = view.readLE<int32_t>(4);
+        uassert(28625,
+                str::stream() << "corrupt wire trace record of length " << recordLength,
+                recordLength >= WireTraceRecord::kHeaderSize +
+                                static_cast<int>(sizeof(MSGHEADER::Value)) &&
+                static_cast<size_t>(recordLength) <=
+                    WireTraceRecord::kHeaderSize + MaxMessageSizeBytes);
+        uassert(28626,
+                str::stream() << "corrupt wire trace record of kind " << kind,
+                kind == WireTraceRecord::kRequest || kind == WireTraceRecord::kReply);
+
+        record->kind = static_cast<WireTraceRecord::Kind>(kind);
+        record->connectionId = view.readLE<int64_t>(8);
+        record->micros = view.readLE<int64_t>(16);
+        record->message.resize(recordLength - WireTraceRecord::kHeaderSize);
+        return fread(&record->message[0], record->message.size(), 1, _file) == 1;
+    }
+
+    bool wireTraceSampleConnection(long long connectionId) {
+        if (!serverTraceWriter) {
+            return false;
+        }
+
+        // Consecutive ids times the golden ratio are spread evenly over [0, 1).
+        const unsigned long long hash =
+            static_cast<unsigned long long>(connectionId) * 0x9E3779B97F4A7C15ULL;
+        return (hash >> 11) * (1.0 / (1ULL << 53)) < wireTraceSampleRate;
+    }
+
+    void wireTraceRecord(WireTraceRecord::Kind kind, long long connectionId, const Message& m) {
+        if (serverTraceWriter) {
+            serverTraceWriter->append(kind, connectionId, curTimeMicros64(), m);
+        }
+    }
+
+} // namespace mongo
@@ -0,0 +1,131 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace mongo {
+
+    class Message;
+
+    /**
+     * Wire tracing records, on a sample of a server's incoming connections, the messages it
+     * receives and the replies it sends, so that the workload can later be replayed against
+     * another server by mongoreplay.  It is enabled by the wireTraceFile startup parameter;
+     * wireTraceSampleRate, which may be changed at runtime, is the fraction of new connections
+     * traced.  Whole connections are sampled, not single messages, so that a replay sees each
+     * traced client's cursors and writes in order.
+     *
+     * A trace file is a sequence of records:
+     *
+     *     int32 recordLength  // of the whole record, including this field
+     *     int32 kind          // WireTraceRecord::Kind
+     *     int64 connectionId
+     *     int64 micros        // wall clock time the message was received or sent
+     *     char  message[]
+     *
+     * all little endian.  Requests are recorded whole, after decompression.  Of a reply only
+     * the header and, for an OP_REPLY, the cursorId, startingFrom and nReturned fields are
+     * kept: that is enough to time the round trip and for a replay to map the cursor ids the
+     * server handed out to the ones it is handed.
+     */
+    struct WireTraceRecord {
+        enum Kind {
+            kRequest = 1,
+            kReply = 2
+        };
+
+        static const int kHeaderSize = 24;
+
+        Kind kind;
+        long long connectionId;
+        long long micros;
+        std::string message;
+    };
+
+    /**
+     * Appends records to a trace file.  Writes are buffered, and pushed to the file once a
+     * second; once the file reaches 'maxBytes' further records are dropped.  Thread safe.
+     */
+    class WireTraceWriter : boost::noncopyable {
+    public:
+        WireTraceWriter();
+        ~WireTraceWriter();
+
+        /** Opens 'path' for appending.  Returns false, after logging why, if it can't. */
+        bool open(const std::string& path, long long maxBytes);
+
+        void append(WireTraceRecord::Kind kind,
+                    long long connectionId,
+                    long long micros,
+                    const Message& m);
+
+        void flush();
+
+    private:
+        boost::mutex _mutex;
+        FILE* _file;
+        long long _maxBytes;
+        long long _bytesWritten;
+        unsigned long long _lastFlushMicros;
+    };
+
+    /**
+     * Reads the records of a trace file in the order they were written.
+     */
+    class WireTraceReader : boost::noncopyable {
+    public:
+        /** uasserts if 'path' can't be opened. */
+        explicit WireTraceReader(const std::string& path);
+        ~WireTraceReader();
+
+        /**
+         * Reads the next record into 'record'.  Returns false at the end of the file, including
+         * when the last record was cut short by a crash.
+         */
+        bool next(WireTraceRecord* record);
+
+    private:
+        FILE* _file;
+    };
+
+    /**
+     * Whether a connection the server just accepted should be traced.  The choice is made by
+     * hashing the connection id, so it is stable for a given id and sample rate.
+     */
+    bool wireTraceSampleConnection(long long connectionId);
+
+    /** Records 'm' in the server's trace file, if there is one. */
+    void wireTraceRecord(WireTraceRecord::Kind kind, long long connectionId, const Message& m);
+
+} // namespace mongo
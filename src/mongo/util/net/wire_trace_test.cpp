@@ -0,0 +1,162 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+#pragma once
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/wire_trace.h"
+
+#include <cstdio>
+#include <string>
+
+#include "mongo/base/data_view.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+
+namespace {
+
+    using namespace mongo;
+
+    void makeRequest(const std::string& data, Message* message) {
+        message->setData(dbQuery, data.c_str(), data.size());
+        message->header().setId(1234);
+        message->header().setResponseTo(0);
+    }
+
+    void makeReply(long long cursorId, const std::string& data, Message* message) {
+        std::string body(20, '\0');
+        DataView(&body[0])
+            .writeLE<int32_t>(0, 0)
+            .writeLE<int64_t>(cursorId, 4)
+            .writeLE<int32_t>(0, 12)
+            .writeLE<int32_t>(1, 16);
+        body += data;
+        message->setData(opReply, body.c_str(), body.size());
+        message->header().setId(5678);
+        message->header().setResponseTo(1234);
+    }
+
+    TEST(WireTrace, RecordsRoundTrip) {
+        unittest::TempDir tempDir("wire_trace_test");
+        const std::string path = tempDir.path() + "/trace";
+
+        Message request;
+        makeRequest(std::string(1000, 'q'), &request);
+        Message reply;
+        makeReply(42, std::string(1000, 'r'), &reply);
+
+        {
+            WireTraceWriter writer;
+            ASSERT_TRUE(writer.open(path, 1024 * 1024));
+            writer.append(WireTraceRecord::kRequest, 7, 100, request);
+            writer.append(WireTraceRecord::kReply, 7, 250, reply);
+        }
+
+        WireTraceReader reader(path);
+        WireTraceRecord record;
+
+        ASSERT_TRUE(reader.next(&record));
+        ASSERT_EQUALS(WireTraceRecord::kRequest, record.kind);
+        ASSERT_EQUALS(7, record.connectionId);
+        ASSERT_EQUALS(100, record.micros);
+        ASSERT_EQUALS(std::string(request.singleData().view2ptr(), request.size()),
+                      record.message);
+
+        // Only the reply's header and cursor fields are kept.
+        ASSERT_TRUE(reader.next(&record));
+        ASSERT_EQUALS(WireTraceRecord::kReply, record.kind);
+        ASSERT_EQUALS(250, record.micros);
+        ASSERT_EQUALS(36U, record.message.size());
+        ASSERT_EQUALS(std::string(reply.singleData().view2ptr(), 36), record.message);
+        ASSERT_EQUALS(42, ConstDataView(record.message.data()).readLE<int64_t>(20));
+
+        ASSERT_FALSE(reader.next(&record));
+    }
+
+    TEST(WireTrace, StopsAtMaxBytes) {
+        unittest::TempDir tempDir("wire_trace_test");
+        const std::string path = tempDir.path() + "/trace";
+
+        Message request;
+        makeRequest(std::string(100, 'q'), &request);
+        const long long recordSize = WireTraceRecord::kHeaderSize + request.size();
+
+        {
+            WireTraceWriter writer;
+            ASSERT_TRUE(writer.open(path, recordSize * 2 + recordSize / 2));
+            for (int i = 0; i < 5; i++) {
+                writer.append(WireTraceRecord::kRequest, 1, i, request);
+            }
+        }
+
+        WireTraceReader reader(path);
+        WireTraceRecord record;
+        ASSERT_TRUE(reader.next(&record));
+        ASSERT_TRUE(reader.next(&record));
+        ASSERT_FALSE(reader.next(&record));
+    }
+
+    TEST(WireTrace, TruncatedRecordEndsTheTrace) {
+        unittest::TempDir tempDir("wire_trace_test");
+        const std::string path = tempDir.path() + "/trace";
+
+        Message request;
+        makeRequest(std::string(100, 'q'), &request);
+
+        {
+            WireTraceWriter writer;
+            ASSERT_TRUE(writer.open(path, 1024 * 1024));
+            writer.append(WireTraceRecord::kRequest, 1, 1, request);
+            writer.append(WireTraceRecord::kRequest, 1, 2, request);
+        }
+
+        // Cut the second record short, as a crash might.
+        std::string contents(2 * (WireTraceRecord::kHeaderSize + request.size()), '\0');
+        FILE* file = fopen(path.c_str(), "rb");
+        ASSERT(file);
+        ASSERT_EQUALS(1U, fread(&contents[0], contents.size(), 1, file));
+        fclose(file);
+        file = fopen(path.c_str(), "wb");
+        ASSERT(file);
+        ASSERT_EQUALS(1U, fwrite(contents.data(), contents.size() - 10, 1, file));
+        fclose(file);
+
+        WireTraceReader reader(path);
+        WireTraceRecord record;
+        ASSERT_TRUE(reader.next(&record));
+        ASSERT_EQUALS(1, record.micros);
+        ASSERT_FALSE(reader.next(&record));
+    }
+
+    TEST(WireTrace, NoConnectionsSampledWithoutTraceFile) {
+        for (long long id = 0; id < 100; id++) {
+            ASSERT_FALSE(wireTraceSampleConnection(id));
+        }
+    }
+
+} // namespace
@@ -97,6 +97,18 @@ namespace mongo {
          */
         bool hasNumaEnabled() const { return sysInfo().hasNuma; }
 
+        /**
+         * Get the number of NUMA nodes of the host, 1 if it isn't NUMA or it can't be determined
+         */
+        unsigned getNumNumaNodes() const { return sysInfo().numNumaNodes; }
+
+        /**
+         * Restricts the calling thread to the CPUs of NUMA node 'node', so that the memory it
+         * touches first is allocated on that node.
+         * @return false if the node doesn't exist or pinning isn't supported on this platform
+         */
+        static bool bindCurrentThreadToNumaNode(unsigned node);
+
         /**
          * Determine if file zeroing is necessary for newly allocated data files.
          */
@@ -160,6 +172,7 @@ namespace mongo {
             unsigned long long pageSize;
             std::string cpuArch;
             bool hasNuma;
+            unsigned numNumaNodes;
             BSONObj _extraStats;
 
             // This is an OS specific value, which determines whether files should be zero-filled
@@ -180,6 +193,7 @@ namespace mongo {
                     numCores( 0 ),
                     pageSize( 0 ),
                     hasNuma( false ),
+                    numNumaNodes( 1 ),
                     fileZeroNeeded (false), 
                     preferMsyncOverFSync (true) { 
                 // populate SystemInfo during construction
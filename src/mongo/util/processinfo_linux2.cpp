@@ -30,7 +30,9 @@
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
 
 #include <malloc.h>
+#include <fstream>
 #include <iostream>
+#include <sched.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <sys/mman.h>
@@ -41,6 +43,7 @@
 #include "boost/filesystem.hpp"
 #include <mongo/util/file.h>
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 using namespace std;
 
@@ -376,6 +379,100 @@ namespace mongo {
     };
 
 
+namespace {
+    // CPUs of each NUMA node, indexed by node number.  Filled once by collectSystemInfo().
+    std::vector<cpu_set_t> numaNodeCpus;
+
+    // Per node allocation counters from numastat, in the order they are reported
+    const char* const kNumaStatFields[] = {
+        "numa_hit", "numa_miss", "numa_foreign", "interleave_hit", "local_node", "other_node"
+    };
+    const size_t kNumNumaStatFields = sizeof(kNumaStatFields) / sizeof(kNumaStatFields[0]);
+
+    /**
+     * Parses a sysfs cpu list such as "0-7,16-23" into 'cpus'.
+     */
+    bool parseCpuList(const string& list, cpu_set_t* cpus) {
+        CPU_ZERO(cpus);
+
+        istringstream in(list);
+        string range;
+        while (getline(in, range, ',')) {
+            unsigned first;
+            unsigned last;
+            const int found = sscanf(range.c_str(), "%u-%u", &first, &last);
+            if (found < 1) {
+                return false;
+            }
+            if (found == 1) {
+                last = first;
+            }
+            for (unsigned cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, cpus);
+            }
+        }
+        return CPU_COUNT(cpus) > 0;
+    }
+
+    /**
+     * Reads the CPUs of every node under /sys/devices/system/node.  Leaves 'numaNodeCpus'
+     * empty if any node can't be read, so no thread gets pinned to a partial view.
+     */
+    void collectNumaNodeCpus() {
+        try {
+            for (unsigned node = 0; ; ++node) {
+                const string dir = str::stream() << "/sys/devices/system/node/node" << node;
+                if (!boost::filesystem::exists(dir)) {
+                    break;
+                }
+
+                cpu_set_t cpus;
+                if (!parseCpuList(LinuxSysHelper::readLineFromFile((dir + "/cpulist").c_str()),
+                                  &cpus)) {
+                    log() << "Cannot read the CPUs of NUMA node " << node;
+                    numaNodeCpus.clear();
+                    return;
+                }
+                numaNodeCpus.push_back(cpus);
+            }
+        } catch(boost::filesystem::filesystem_error& e) {
+            log() << "Cannot detect NUMA nodes. Failed to probe \"" << e.path1().string()
+                  << "\": " << e.code().message();
+            numaNodeCpus.clear();
+        }
+    }
+
+    /**
+     * Appends the numastat counters summed over all nodes, and the number of nodes.  These are
+     * host wide: the kernel doesn't keep per process counters.
+     */
+    void appendNumaStats(BSONObjBuilder& info) {
+        long long totals[kNumNumaStatFields] = {};
+
+        for (size_t node = 0; node < numaNodeCpus.size(); ++node) {
+            const string path = str::stream() << "/sys/devices/system/node/node" << node
+                                              << "/numastat";
+            std::ifstream in(path.c_str());
+            string field;
+            long long value;
+            while (in >> field >> value) {
+                for (size_t i = 0; i < kNumNumaStatFields; ++i) {
+                    if (field == kNumaStatFields[i]) {
+                        totals[i] += value;
+                    }
+                }
+            }
+        }
+
+        BSONObjBuilder numa(info.subobjStart("numa"));
+        numa.append("nodes", static_cast<int>(numaNodeCpus.size()));
+        for (size_t i = 0; i < kNumNumaStatFields; ++i) {
+            numa.appendNumber(kNumaStatFields[i], totals[i]);
+        }
+        numa.done();
+    }
+} // namespace
+
     ProcessInfo::ProcessInfo( ProcessId pid ) : _pid( pid ) {
     }
 
@@ -404,6 +501,10 @@ namespace mongo {
 
         LinuxProc p(_pid);
         info.appendNumber("page_faults", static_cast<long long>(p._maj_flt) );
+
+        if (numaNodeCpus.size() > 1) {
+            appendNumaStats(info);
+        }
     }
 
     /**
@@ -432,7 +533,10 @@ namespace mongo {
         pageSize = static_cast<unsigned long long>(sysconf( _SC_PAGESIZE ));
         cpuArch = unameData.machine;
         hasNuma = checkNumaEnabled();
-        
+
+        collectNumaNodeCpus();
+        numNumaNodes = std::max<size_t>(numaNodeCpus.size(), 1);
+
         BSONObjBuilder bExtra;
         bExtra.append( "versionString", LinuxSysHelper::readLineFromFile( "/proc/version" ) );
         bExtra.append( "libcVersion", gnu_get_libc_version() );
@@ -481,6 +585,20 @@ namespace mongo {
         return false;
     }
 
+    bool ProcessInfo::bindCurrentThreadToNumaNode(unsigned node) {
+        if (node >= numaNodeCpus.size()) {
+            return false;
+        }
+
+        // With pid 0 this only affects the calling thread
+        if (sched_setaffinity(0, sizeof(cpu_set_t), &numaNodeCpus[node])) {
+            log() << "failed to bind thread to NUMA node " << node << ": "
+                  << errnoWithDescription();
+            return false;
+        }
+        return true;
+    }
+
     bool ProcessInfo::blockCheckSupported() {
         return true;
     }
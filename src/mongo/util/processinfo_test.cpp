@@ -49,6 +49,13 @@ namespace mongo_test {
         }
     }
 
+    TEST(ProcessInfo, NumaNodes) {
+        ProcessInfo processInfo;
+        const unsigned numNodes = processInfo.getNumNumaNodes();
+        ASSERT_GREATER_THAN_OR_EQUALS(numNodes, 1u);
+        ASSERT_FALSE(ProcessInfo::bindCurrentThreadToNumaNode(numNodes));
+    }
+
     const size_t PAGES = 10;
 
     TEST(ProcessInfo, BlockInMemoryDoesNotThrowIfSupported) {
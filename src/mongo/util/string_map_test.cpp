@@ -205,4 +205,92 @@ namespace {
         y = m;
         ASSERT_EQUALS( 5, y["eliot"] );
     }
+
+    TEST( StringMapTest, EraseKeepsLaterKeysReachable ) {
+        // enough keys that groups fill up and probes run past their home group
+        StringMap<int> m;
+        char buf[64];
+        for ( int i = 0; i < 5000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+        }
+        for ( int i = 0; i < 5000; i += 2 ) {
+            sprintf( buf, "foo%d", i );
+            ASSERT_EQUALS( 1U, m.erase( buf ) );
+        }
+        ASSERT_EQUALS( 2500U, m.size() );
+
+        for ( int i = 0; i < 5000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            StringMap<int>::const_iterator it = m.find( buf );
+            if ( i % 2 == 0 ) {
+                ASSERT( it == m.end() );
+            }
+            else {
+                ASSERT( it != m.end() );
+                ASSERT_EQUALS( i, it->second );
+            }
+        }
+
+        int count = 0;
+        for ( StringMap<int>::const_iterator it = m.begin(); it != m.end(); ++it ) {
+            ASSERT_EQUALS( 1, it->second % 2 );
+            count++;
+        }
+        ASSERT_EQUALS( 2500, count );
+
+        // erased slots are reused
+        for ( int i = 0; i < 5000; i += 2 ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+        }
+        ASSERT_EQUALS( 5000U, m.size() );
+        for ( int i = 0; i < 5000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            ASSERT_EQUALS( i, m[buf] );
+        }
+    }
+
+    TEST( StringMapTest, CapacityIsWholeGroups ) {
+        StringMap<int> m;
+        ASSERT_EQUALS( 0U, m.capacity() % UnorderedFastKeyTableGroup::kSize );
+        ASSERT_GREATER_THAN_OR_EQUALS( m.capacity(),
+                                       size_t( StringMap<int>::DEFAULT_STARTING_CAPACITY ) );
+    }
+
+    TEST( StringMapTest, LookupSpeed ) {
+        const int iterations = 1000 * 1000;
+        std::vector<std::string> keys;
+        char buf[64];
+        for ( int i = 0; i < 1000; i++ ) {
+            sprintf( buf, "field%d", i );
+            keys.push_back( buf );
+        }
+
+        StringMap<int> m;
+        unordered_map<std::string, int> um;
+        for ( size_t i = 0; i < keys.size(); i += 2 ) {
+            m[keys[i]] = i;
+            um[keys[i]] = i;
+        }
+
+        int hits = 0;
+        Timer t;
+        for ( int i = 0; i < iterations; i++ ) {
+            if ( m.find( keys[i % keys.size()] ) != m.end() )
+                hits++;
+        }
+        const long long stringMapMicros = t.micros();
+
+        t.reset();
+        for ( int i = 0; i < iterations; i++ ) {
+            if ( um.find( keys[i % keys.size()] ) != um.end() )
+                hits--;
+        }
+        const long long unorderedMapMicros = t.micros();
+
+        ASSERT_EQUALS( 0, hits );
+        log() << "StringMap lookups: " << stringMapMicros << "us, "
+              << "unordered_map lookups: " << unorderedMapMicros << "us";
+    }
 }
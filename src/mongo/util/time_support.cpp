@@ -992,4 +992,33 @@ namespace {
     }
 #endif
 
+#if defined(_WIN32)
+    long long curThreadCpuTimeMicros() {
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+            return -1;
+        }
+
+        // FILETIMEs count 100 nanosecond intervals.
+        ULARGE_INTEGER kernel, user;
+        kernel.LowPart = kernelTime.dwLowDateTime;
+        kernel.HighPart = kernelTime.dwHighDateTime;
+        user.LowPart = userTime.dwLowDateTime;
+        user.HighPart = userTime.dwHighDateTime;
+        return static_cast<long long>((kernel.QuadPart + user.QuadPart) / 10);
+    }
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    long long curThreadCpuTimeMicros() {
+        timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+            return -1;
+        }
+        return static_cast<long long>(ts.tv_sec) * 1000 * 1000 + ts.tv_nsec / 1000;
+    }
+#else
+    long long curThreadCpuTimeMicros() {
+        return -1;
+    }
+#endif
+
 }  // namespace mongo
@@ -176,6 +176,12 @@ namespace mongo {
     unsigned long long curTimeMicros64();
     unsigned long long curTimeMillis64();
 
+    /**
+     * CPU time, user plus system, used by the calling thread in microseconds, or -1 where the
+     * platform can't measure it.
+     */
+    long long curThreadCpuTimeMicros();
+
     // these are so that if you use one of them compilation will fail
     char *asctime(const struct tm *tm);
     char *ctime(const time_t *timep);
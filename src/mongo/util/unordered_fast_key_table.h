@@ -35,6 +35,53 @@
 
 namespace mongo {
 
+    /**
+     * The slots of an UnorderedFastKeyTable are split into groups of kSize, each with one control
+     * byte per slot: kEmpty, kDeleted, or the low 7 bits of the hash of the key stored there.
+     * A probe matches a whole group's control bytes at once, with a single SSE2 compare where
+     * available, so only slots whose hash bits match have their full key compared.
+     *
+     * The match functions return a mask with bit i set if slot i of the group matches.
+     */
+    class UnorderedFastKeyTableGroup {
+    public:
+        static const unsigned kSize = 16;
+
+        static const signed char kEmpty = -128; // never held an entry; ends a lookup
+        static const signed char kDeleted = -2; // held an entry that was erased
+
+        explicit UnorderedFastKeyTableGroup( const signed char* ctrl ) : _ctrl( ctrl ) {}
+
+        /**
+         * @return the control byte of a slot holding an entry with the given hash
+         */
+        static signed char tag( size_t hash ) { return static_cast<signed char>( hash & 0x7F ); }
+
+        static bool isFull( signed char ctrl ) { return ctrl >= 0; }
+
+        /**
+         * @return the number of groups needed to hold 'capacity' slots
+         */
+        static unsigned groupsFor( unsigned capacity );
+
+        /**
+         * @return how many groups a probe may visit in a table of 'capacity' slots
+         */
+        static unsigned maxProbe( unsigned capacity, double maxProbeRatio );
+
+        unsigned match( signed char h2 ) const;
+
+        unsigned matchEmpty() const { return match( kEmpty ); }
+
+        /**
+         * Both kEmpty and kDeleted have the high bit set, full slots never do.
+         */
+        unsigned matchEmptyOrDeleted() const;
+
+    private:
+        const signed char* _ctrl;
+    };
+
     template<typename K_L, typename K_S>
     struct UnorderedFastKeyTable_LS_C {
         K_S operator()( const K_L& a ) const {
@@ -57,13 +104,9 @@ namespace mongo {
         typedef V mapped_type;
 
     private:
-        struct Entry {
-            Entry()
-                : used( false ), everUsed( false ) {
-            }
+        typedef UnorderedFastKeyTableGroup Group;
 
-            bool used;
-            bool everUsed;
+        struct Entry {
             size_t curHash;
             value_type data;
         };
@@ -76,15 +119,35 @@ namespace mongo {
 
             bool transfer( Area* newArea, const UnorderedFastKeyTable& sm ) const;
 
+            bool isFull( unsigned pos ) const { return Group::isFull( _ctrl[pos] ); }
+
+            void setFull( unsigned pos, size_t hash ) {
+                _ctrl[pos] = Group::tag( hash );
+                _entries[pos].curHash = hash;
+            }
+
+            /**
+             * A slot whose group still has an empty slot can go back to empty, since no lookup
+             * could have probed past that group looking for a key placed after it.
+             */
+            void setErased( unsigned pos ) {
+                const unsigned groupStart = pos - pos % Group::kSize;
+                _ctrl[pos] = Group( &_ctrl[groupStart] ).matchEmpty() ? Group::kEmpty
+                                                                      : Group::kDeleted;
+                _entries[pos].data.second = V();
+            }
+
             void swap( Area* other ) {
                 using std::swap;
                 swap( _capacity, other->_capacity );
                 swap( _maxProbe, other->_maxProbe );
+                swap( _ctrl, other->_ctrl );
                 swap( _entries, other->_entries );
             }
 
-            unsigned _capacity;
-            unsigned _maxProbe;
+            unsigned _capacity; // a multiple of Group::kSize
+            unsigned _maxProbe; // in groups
+            boost::scoped_array<signed char> _ctrl;
             boost::scoped_array<Entry> _entries;
         };
 
@@ -117,7 +180,7 @@ namespace mongo {
         bool empty() const { return _size == 0; }
 
         /*
-         * @return storage space
+         * @return storage space, rounded up to a whole number of probe groups
          */
         size_t capacity() const { return _area._capacity; }
 
@@ -173,7 +236,7 @@ namespace mongo {
 
             void _skip() {
                 while ( true ) {
-                    if ( _area->_entries[_position].used )
+                    if ( _area->isFull( _position ) )
                         break;
                     if ( _position >= _max ) {
                         _position = -1;
@@ -28,24 +28,84 @@
  *    then also delete it in the license file.
  */
 
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MONGO_UNORDERED_FAST_KEY_TABLE_SSE2
+#endif
+
+#include "mongo/platform/bits.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
+
+#if defined(MONGO_UNORDERED_FAST_KEY_TABLE_SSE2)
+    inline unsigned UnorderedFastKeyTableGroup::match( signed char h2 ) const {
+        const __m128i ctrl = _mm_loadu_si128( reinterpret_cast<const __m128i*>( _ctrl ) );
+        return _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_set1_epi8( h2 ), ctrl ) );
+    }
+
+    inline unsigned UnorderedFastKeyTableGroup::matchEmptyOrDeleted() const {
+        return _mm_movemask_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( _ctrl ) ) );
+    }
+#else
+    inline unsigned UnorderedFastKeyTableGroup::match( signed char h2 ) const {
+        unsigned mask = 0;
+        for ( unsigned i = 0; i < kSize; i++ ) {
+            if ( _ctrl[i] == h2 )
+                mask |= 1U << i;
+        }
+        return mask;
+    }
+
+    inline unsigned UnorderedFastKeyTableGroup::matchEmptyOrDeleted() const {
+        unsigned mask = 0;
+        for ( unsigned i = 0; i < kSize; i++ ) {
+            if ( !isFull( _ctrl[i] ) )
+                mask |= 1U << i;
+        }
+        return mask;
+    }
+#endif
+
+    inline unsigned UnorderedFastKeyTableGroup::groupsFor( unsigned capacity ) {
+        const unsigned groups = ( capacity + kSize - 1 ) / kSize;
+        return groups ? groups : 1;
+    }
+
+    inline unsigned UnorderedFastKeyTableGroup::maxProbe( unsigned capacity,
+                                                          double maxProbeRatio ) {
+        // always allow probing past the home group, so one full group doesn't force a grow
+        const unsigned groups = groupsFor( capacity );
+        unsigned probe = static_cast<unsigned>( groups * maxProbeRatio );
+        if ( probe < 2 )
+            probe = 2;
+        if ( probe > groups )
+            probe = groups;
+        return probe;
+    }
+
     template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
     inline UnorderedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::Area(unsigned capacity,
                                                                    double maxProbeRatio)
-        : _capacity( capacity ),
-          _maxProbe( static_cast<unsigned>( capacity * maxProbeRatio ) ),
+        : _capacity( Group::groupsFor( capacity ) * Group::kSize ),
+          _maxProbe( Group::maxProbe( capacity, maxProbeRatio ) ),
+          _ctrl( new signed char[_capacity] ),
           _entries( new Entry[_capacity] ) {
+        memset( _ctrl.get(), Group::kEmpty, _capacity );
     }
 
     template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
     inline UnorderedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::Area(const Area& other )
         : _capacity( other._capacity ),
           _maxProbe( other._maxProbe ),
+          _ctrl( new signed char[_capacity] ),
           _entries( new Entry[_capacity] ) {
+        memcpy( _ctrl.get(), other._ctrl.get(), _capacity );
         for ( unsigned i = 0; i < _capacity; i++ ) {
-            _entries[i] = other._entries[i];
+            if ( isFull( i ) )
+                _entries[i] = other._entries[i];
         }
     }
 
@@ -58,32 +118,34 @@ namespace mongo {
         if ( firstEmpty )
             *firstEmpty = -1;
 
+        const signed char tag = Group::tag( hash );
+        const unsigned numGroups = _capacity / Group::kSize;
+        unsigned group = ( hash >> 7 ) % numGroups;
+
         for ( unsigned probe = 0; probe < _maxProbe; probe++ ) {
-            unsigned pos = (hash + probe) % _capacity;
-
-            if ( ! _entries[pos].used ) {
-                // space is empty
-                if ( firstEmpty && *firstEmpty == -1 )
-                    *firstEmpty = pos;
-                if ( ! _entries[pos].everUsed )
-                    return -1;
-                continue;
+            const unsigned groupStart = group * Group::kSize;
+            const Group g( &_ctrl[groupStart] );
+
+            // only slots whose control byte matches the hash bits need a full comparison
+            for ( unsigned m = g.match( tag ); m; m &= m - 1 ) {
+                const unsigned pos = groupStart + countTrailingZeros64( m );
+                if ( _entries[pos].curHash == hash &&
+                     sm._equals( key, sm._convertor( _entries[pos].data.first ) ) ) {
+                    return pos;
+                }
             }
 
-            if ( _entries[pos].curHash != hash ) {
-                // space has something else
-                continue;
+            if ( firstEmpty && *firstEmpty == -1 ) {
+                const unsigned available = g.matchEmptyOrDeleted();
+                if ( available )
+                    *firstEmpty = groupStart + countTrailingZeros64( available );
             }
 
-            if ( ! sm._equals(key, sm._convertor( _entries[pos].data.first ) ) ) {
-                // hashes match
-                // strings are not equals
-                continue;
-            }
+            // an insert never skips a group with an empty slot, so the key isn't further along
+            if ( g.matchEmpty() )
+                return -1;
 
-            // hashes and strings are equal
-            // yay!
-            return pos;
+            group = ( group + 1 ) % numGroups;
         }
         return -1;
     }
@@ -93,7 +155,7 @@ namespace mongo {
             Area* newArea,
             const UnorderedFastKeyTable& sm) const {
         for ( unsigned i = 0; i < _capacity; i++ ) {
-            if ( ! _entries[i].used )
+            if ( ! isFull( i ) )
                 continue;
 
             int firstEmpty = -1;
@@ -107,6 +169,7 @@ namespace mongo {
                 return false;
             }
 
+            newArea->_ctrl[firstEmpty] = _ctrl[i];
             newArea->_entries[firstEmpty] = _entries[i];
         }
         return true;
@@ -155,9 +218,7 @@ namespace mongo {
             // need to add
             if ( firstEmpty >= 0 ) {
                 _size++;
-                _area._entries[firstEmpty].used = true;
-                _area._entries[firstEmpty].everUsed = true;
-                _area._entries[firstEmpty].curHash = hash;
+                _area.setFull( firstEmpty, hash );
                 _area._entries[firstEmpty].data.first = _convertorOther(key);
                 return _area._entries[firstEmpty].data.second;
             }
@@ -178,8 +239,7 @@ namespace mongo {
             return 0;
 
         --_size;
-        _area._entries[pos].used = false;
-        _area._entries[pos].data.second = V();
+        _area.setErased( pos );
         return 1;
     }
 
@@ -189,8 +249,7 @@ namespace mongo {
         dassert(it._area == &_area);
 
         --_size;
-        _area._entries[it._position].used = false;
-        _area._entries[it._position].data.second = V();
+        _area.setErased( it._position );
     }
 
     template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
@@ -1110,9 +1110,22 @@ __wt_lex_compare(const WT_ITEM *user_item, const WT_ITEM *tree_item)
 	tsz = tree_item->size;
 	len = WT_MIN(usz, tsz);
 
-	for (userp = user_item->data, treep = tree_item->data;
-	    len > 0;
-	    --len, ++userp, ++treep)
+	userp = user_item->data;
+	treep = tree_item->data;
+#ifdef HAVE_X86INTRINSICS
+	/*
+	 * Skip over equal 16B chunks with vector compares; the byte loop below
+	 * finds the first difference inside the chunk that stopped us.
+	 */
+	for (; len >= WT_VECTOR_SIZE;
+	    len -= WT_VECTOR_SIZE,
+	    userp += WT_VECTOR_SIZE, treep += WT_VECTOR_SIZE)
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(
+		    _mm_loadu_si128((const __m128i *)userp),
+		    _mm_loadu_si128((const __m128i *)treep))) != 0xffff)
+			break;
+#endif
+	for (; len > 0; --len, ++userp, ++treep)
 		if (*userp != *treep)
 			return (*userp < *treep ? -1 : 1);
 
@@ -1160,10 +1173,19 @@ __wt_lex_compare_skip(
 	tsz = tree_item->size;
 	len = WT_MIN(usz, tsz) - *matchp;
 
-	for (userp = (uint8_t *)user_item->data + *matchp,
-	    treep = (uint8_t *)tree_item->data + *matchp;
-	    len > 0;
-	    --len, ++userp, ++treep, ++*matchp)
+	userp = (uint8_t *)user_item->data + *matchp;
+	treep = (uint8_t *)tree_item->data + *matchp;
+#ifdef HAVE_X86INTRINSICS
+	/* See __wt_lex_compare. */
+	for (; len >= WT_VECTOR_SIZE;
+	    len -= WT_VECTOR_SIZE, *matchp += WT_VECTOR_SIZE,
+	    userp += WT_VECTOR_SIZE, treep += WT_VECTOR_SIZE)
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(
+		    _mm_loadu_si128((const __m128i *)userp),
+		    _mm_loadu_si128((const __m128i *)treep))) != 0xffff)
+			break;
+#endif
+	for (; len > 0; --len, ++userp, ++treep, ++*matchp)
 		if (*userp != *treep)
 			return (*userp < *treep ? -1 : 1);
 
@@ -46,6 +46,9 @@
 #define	WT_PTR_IN_RANGE(p, begin, maxlen)				\
 	WT_BLOCK_FITS((p), 1, (begin), (maxlen))
 
+/* Chunk size for vector key comparisons. */
+#define	WT_VECTOR_SIZE	16
+
 /*
  * Align an unsigned value of any type to a specified power-of-2, including the
  * offset result of a pointer subtraction; do the calculation using the largest
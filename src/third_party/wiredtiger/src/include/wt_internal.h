@@ -55,6 +55,15 @@ extern "C" {
 #define	WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #endif
+/* SSE2 is available on every x86-64 target; use it for key comparisons. */
+#if !defined(HAVE_X86INTRINSICS) &&					\
+    (defined(__SSE2__) || defined(_M_X64) ||				\
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define	HAVE_X86INTRINSICS	1
+#endif
+#ifdef HAVE_X86INTRINSICS
+#include <emmintrin.h>
+#endif
 
 /*******************************************
  * WiredTiger externally maintained include files.
@@ -1719,3 +1719,40 @@ __wt_log_vprintf(WT_SESSION_IMPL *session, const char *fmt, va_list ap)
 err:	__wt_scr_free(session, &logrec);
 	return (ret);
 }
+
+/*
+ * __wt_log_flush --
+ *	Write an empty message record and sync the log through it.  Log
+ *	writes complete in LSN order, so every record written before the
+ *	call is durable on return.
+ */
+int
+__wt_log_flush(WT_SESSION_IMPL *session)
+{
+	WT_CONNECTION_IMPL *conn;
+	WT_DECL_ITEM(logrec);
+	WT_DECL_RET;
+	const char *rec_fmt = WT_UNCHECKED_STRING(IS);
+	uint32_t rectype = WT_LOGREC_MESSAGE;
+	size_t rec_size;
+
+	conn = S2C(session);
+
+	if (!FLD_ISSET(conn->log_flags, WT_CONN_LOG_ENABLED))
+		return (0);
+
+	WT_RET(__wt_struct_size(session, &rec_size, rec_fmt, rectype, ""));
+	WT_RET(__wt_logrec_alloc(
+	    session, sizeof(WT_LOG_RECORD) + rec_size, &logrec));
+
+	WT_ERR(__wt_struct_pack(session,
+	    (uint8_t *)logrec->data + logrec->size, rec_size,
+	    rec_fmt, rectype, ""));
+	logrec->size += (uint32_t)rec_size;
+
+	WT_ERR(__wt_log_write(session, logrec, NULL,
+	    FLD_ISSET(conn->txn_logsync, WT_LOG_DSYNC) ?
+	    WT_LOG_DSYNC : WT_LOG_FSYNC));
+err:	__wt_scr_free(session, &logrec);
+	return (ret);
+}
@@ -462,6 +462,24 @@ __session_log_printf(WT_SESSION *wt_session, const char *fmt, ...)
 err:	API_END_RET(session, ret);
 }
 
+/*
+ * __session_log_flush --
+ *	WT_SESSION->log_flush method.
+ */
+static int
+__session_log_flush(WT_SESSION *wt_session)
+{
+	WT_SESSION_IMPL *session;
+	WT_DECL_RET;
+
+	session = (WT_SESSION_IMPL *)wt_session;
+	SESSION_API_CALL_NOCONF(session, log_flush);
+
+	ret = __wt_log_flush(session);
+
+err:	API_END_RET(session, ret);
+}
+
 /*
  * __session_rename --
  *	WT_SESSION->rename method.
@@ -973,7 +991,8 @@ __wt_open_session(WT_CONNECTION_IMPL *conn,
 		__session_commit_transaction,
 		__session_rollback_transaction,
 		__session_checkpoint,
-		__session_transaction_pinned_range
+		__session_transaction_pinned_range,
+		__session_log_flush
 	};
 	WT_DECL_RET;
 	WT_SESSION_IMPL *session, *session_ret;